@@ -0,0 +1,333 @@
+//===- ADTBenchmarks.cpp - Benchmarks for the ADT containers --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/PriorityWorklist.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+/// A deterministic sequence of keys that is not sorted, so that the
+/// benchmarks do not depend on a random number generator.
+std::vector<unsigned> makeKeys(int64_t N) {
+  std::vector<unsigned> Keys;
+  Keys.reserve(N);
+  uint32_t X = 12345;
+  for (int64_t I = 0; I < N; ++I) {
+    X = X * 1664525 + 1013904223;
+    Keys.push_back(X >> 1);
+  }
+  return Keys;
+}
+
+std::vector<std::string> makeNames(int64_t N) {
+  std::vector<std::string> Names;
+  Names.reserve(N);
+  for (unsigned K : makeKeys(N))
+    Names.push_back("symbol." + utostr(K));
+  return Names;
+}
+
+/// Distinct, stable pointers to use as the keys of pointer sets.
+std::vector<int *> makePointers(std::vector<int> &Storage) {
+  std::vector<int *> Ptrs;
+  Ptrs.reserve(Storage.size());
+  for (int &I : Storage)
+    Ptrs.push_back(&I);
+  // Shuffle deterministically so that the insertion order is not the address
+  // order.
+  std::vector<unsigned> Keys = makeKeys(Ptrs.size());
+  for (size_t I = Ptrs.size(); I > 1; --I)
+    std::swap(Ptrs[I - 1], Ptrs[Keys[I - 1] % I]);
+  return Ptrs;
+}
+
+void BM_SmallVectorPushBack(BenchmarkState &State) {
+  int64_t N = State.getArg();
+  while (State.keepRunning()) {
+    SmallVector<unsigned, 8> V;
+    for (int64_t I = 0; I < N; ++I)
+      V.push_back(I);
+    doNotOptimize(V.data());
+  }
+}
+
+void BM_DenseMapInsert(BenchmarkState &State) {
+  std::vector<unsigned> Keys = makeKeys(State.getArg());
+  while (State.keepRunning()) {
+    DenseMap<unsigned, unsigned> M;
+    for (unsigned K : Keys)
+      M[K] = K;
+    doNotOptimize(M.size());
+  }
+}
+
+void BM_DenseMapLookup(BenchmarkState &State) {
+  std::vector<unsigned> Keys = makeKeys(State.getArg());
+  DenseMap<unsigned, unsigned> M;
+  for (unsigned K : Keys)
+    M[K] = K;
+  while (State.keepRunning()) {
+    unsigned Sum = 0;
+    for (unsigned K : Keys)
+      Sum += M.find(K)->second;
+    doNotOptimize(Sum);
+  }
+}
+
+void BM_DenseSetInsert(BenchmarkState &State) {
+  std::vector<unsigned> Keys = makeKeys(State.getArg());
+  while (State.keepRunning()) {
+    DenseSet<unsigned> S;
+    for (unsigned K : Keys)
+      S.insert(K);
+    doNotOptimize(S.size());
+  }
+}
+
+void BM_StringMapInsert(BenchmarkState &State) {
+  std::vector<std::string> Names = makeNames(State.getArg());
+  while (State.keepRunning()) {
+    StringMap<unsigned> M;
+    for (const std::string &Name : Names)
+      M[Name] = 0;
+    doNotOptimize(M.size());
+  }
+}
+
+void BM_StringMapLookup(BenchmarkState &State) {
+  std::vector<std::string> Names = makeNames(State.getArg());
+  StringMap<unsigned> M;
+  for (const std::string &Name : Names)
+    M[Name] = Name.size();
+  while (State.keepRunning()) {
+    unsigned Sum = 0;
+    for (const std::string &Name : Names)
+      Sum += M.find(Name)->second;
+    doNotOptimize(Sum);
+  }
+}
+
+void BM_SmallPtrSetInsert(BenchmarkState &State) {
+  std::vector<int> Storage(State.getArg());
+  std::vector<int *> Ptrs = makePointers(Storage);
+  while (State.keepRunning()) {
+    SmallPtrSet<int *, 16> S;
+    for (int *P : Ptrs)
+      S.insert(P);
+    doNotOptimize(S.size());
+  }
+}
+
+void BM_SmallPtrSetCount(BenchmarkState &State) {
+  std::vector<int> Storage(State.getArg());
+  std::vector<int *> Ptrs = makePointers(Storage);
+  SmallPtrSet<int *, 16> S;
+  for (size_t I = 0; I < Ptrs.size(); I += 2)
+    S.insert(Ptrs[I]);
+  while (State.keepRunning()) {
+    unsigned Found = 0;
+    for (int *P : Ptrs)
+      Found += S.count(P);
+    doNotOptimize(Found);
+  }
+}
+
+/// The usage pattern of a worklist: elements are added, and the set is
+/// drained and refilled many times without leaving small mode.
+void BM_SmallPtrSetWorklist(BenchmarkState &State) {
+  std::vector<int> Storage(State.getArg());
+  std::vector<int *> Ptrs = makePointers(Storage);
+  while (State.keepRunning()) {
+    SmallPtrSet<int *, 16> S;
+    for (size_t I = 0; I < Ptrs.size(); ++I) {
+      S.insert(Ptrs[I]);
+      S.insert(Ptrs[I / 2]);
+      if (S.size() == 16)
+        S.clear();
+    }
+    doNotOptimize(S.size());
+  }
+}
+
+void BM_SetVectorInsert(BenchmarkState &State) {
+  std::vector<int> Storage(State.getArg());
+  std::vector<int *> Ptrs = makePointers(Storage);
+  while (State.keepRunning()) {
+    SmallSetVector<int *, 16> S;
+    for (int *P : Ptrs)
+      S.insert(P);
+    doNotOptimize(S.size());
+  }
+}
+
+/// Re-prioritize the elements of a worklist over and over, as the
+/// inliner's CGSCC walk does.
+void BM_PriorityWorklistReinsert(BenchmarkState &State) {
+  std::vector<int> Storage(State.getArg());
+  std::vector<int *> Ptrs = makePointers(Storage);
+  std::vector<unsigned> Keys = makeKeys(Ptrs.size() * 4);
+  while (State.keepRunning()) {
+    PriorityWorklist<int *> W;
+    for (int *P : Ptrs)
+      W.insert(P);
+    for (unsigned K : Keys)
+      W.insert(Ptrs[K % Ptrs.size()]);
+    while (!W.empty())
+      doNotOptimize(W.pop_back_val());
+  }
+}
+
+class Node : public FoldingSetNode {
+  unsigned A, B;
+
+public:
+  Node(unsigned A, unsigned B) : A(A), B(B) {}
+
+  void Profile(FoldingSetNodeID &ID) const { profile(ID, A, B); }
+
+  static void profile(FoldingSetNodeID &ID, unsigned A, unsigned B) {
+    ID.AddInteger(A);
+    ID.AddInteger(B);
+  }
+};
+
+/// Unique nodes the way SelectionDAG and the type uniquers do: look the node
+/// up by its profile and only create it when it is missing.
+void BM_FoldingSetGetOrInsert(BenchmarkState &State) {
+  std::vector<unsigned> Keys = makeKeys(State.getArg());
+  while (State.keepRunning()) {
+    BumpPtrAllocator Alloc;
+    FoldingSet<Node> S;
+    for (unsigned K : Keys) {
+      FoldingSetNodeID ID;
+      Node::profile(ID, K, K & 7);
+      void *InsertPos;
+      if (!S.FindNodeOrInsertPos(ID, InsertPos))
+        S.InsertNode(new (Alloc.Allocate<Node>()) Node(K, K & 7), InsertPos);
+    }
+    doNotOptimize(S.size());
+  }
+}
+
+/// A node that keeps its interned profile, the way SCEV and SDVTListNode do.
+class InternedNode : public FoldingSetNode {
+public:
+  FoldingSetNodeIDRef FastID;
+
+  InternedNode(FoldingSetNodeIDRef FastID) : FastID(FastID) {}
+};
+
+} // end anonymous namespace
+
+namespace llvm {
+template <>
+struct FoldingSetTrait<InternedNode> : DefaultFoldingSetTrait<InternedNode> {
+  static void Profile(const InternedNode &X, FoldingSetNodeID &ID) {
+    ID = X.FastID;
+  }
+  static bool Equals(const InternedNode &X, const FoldingSetNodeID &ID,
+                     unsigned IDHash, FoldingSetNodeID &TempID) {
+    return X.FastID.ComputeHash() == IDHash && ID == X.FastID;
+  }
+  static unsigned ComputeHash(const InternedNode &X,
+                              FoldingSetNodeID &TempID) {
+    return X.FastID.ComputeHash();
+  }
+};
+} // end namespace llvm
+
+namespace {
+
+void BM_FoldingSetInternedGetOrInsert(BenchmarkState &State) {
+  std::vector<unsigned> Keys = makeKeys(State.getArg());
+  while (State.keepRunning()) {
+    BumpPtrAllocator Alloc;
+    FoldingSet<InternedNode> S;
+    for (unsigned K : Keys) {
+      FoldingSetNodeID ID;
+      Node::profile(ID, K, K & 7);
+      void *InsertPos;
+      if (!S.FindNodeOrInsertPos(ID, InsertPos))
+        S.InsertNode(new (Alloc.Allocate<InternedNode>())
+                         InternedNode(ID.Intern(Alloc)),
+                     InsertPos);
+    }
+    doNotOptimize(S.size());
+  }
+}
+
+void BM_StringSaver(BenchmarkState &State) {
+  std::vector<std::string> Names = makeNames(State.getArg());
+  while (State.keepRunning()) {
+    BumpPtrAllocator Alloc;
+    StringSaver Saver(Alloc);
+    for (const std::string &Name : Names)
+      doNotOptimize(Saver.save(StringRef(Name)));
+  }
+}
+
+void BM_APIntMul(BenchmarkState &State) {
+  unsigned BitWidth = State.getArg();
+  APInt A = APInt::getAllOnesValue(BitWidth).lshr(3);
+  APInt B = APInt::getAllOnesValue(BitWidth).lshr(5);
+  while (State.keepRunning())
+    doNotOptimize(A * B);
+}
+
+void BM_APIntUDiv(BenchmarkState &State) {
+  unsigned BitWidth = State.getArg();
+  APInt A = APInt::getAllOnesValue(BitWidth);
+  APInt B = APInt::getAllOnesValue(BitWidth).lshr(BitWidth / 2);
+  while (State.keepRunning())
+    doNotOptimize(A.udiv(B));
+}
+
+void BM_APIntAddShift(BenchmarkState &State) {
+  unsigned BitWidth = State.getArg();
+  APInt A = APInt::getAllOnesValue(BitWidth).lshr(1);
+  while (State.keepRunning()) {
+    APInt R = (A + A).shl(3) | A;
+    doNotOptimize(R);
+  }
+}
+
+} // end anonymous namespace
+
+BENCHMARK(BM_SmallVectorPushBack)->range(8, 4096);
+BENCHMARK(BM_DenseMapInsert)->range(8, 1 << 16);
+BENCHMARK(BM_DenseMapLookup)->range(8, 1 << 16);
+BENCHMARK(BM_DenseSetInsert)->range(8, 1 << 16);
+BENCHMARK(BM_StringMapInsert)->range(8, 1 << 16);
+BENCHMARK(BM_StringMapLookup)->range(8, 1 << 16);
+BENCHMARK(BM_SmallPtrSetInsert)->range(8, 1 << 16);
+BENCHMARK(BM_SmallPtrSetCount)->range(8, 1 << 16);
+BENCHMARK(BM_SmallPtrSetWorklist)->range(8, 1 << 16);
+BENCHMARK(BM_SetVectorInsert)->range(8, 1 << 16);
+BENCHMARK(BM_PriorityWorklistReinsert)->range(8, 1 << 16);
+BENCHMARK(BM_FoldingSetGetOrInsert)->range(8, 1 << 16);
+BENCHMARK(BM_FoldingSetInternedGetOrInsert)->range(8, 1 << 16);
+BENCHMARK(BM_StringSaver)->range(8, 1 << 16);
+BENCHMARK(BM_APIntMul)->arg(64)->arg(128)->arg(1024);
+BENCHMARK(BM_APIntUDiv)->arg(64)->arg(128)->arg(1024);
+BENCHMARK(BM_APIntAddShift)->arg(64)->arg(128)->arg(1024);
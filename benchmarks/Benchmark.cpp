@@ -0,0 +1,135 @@
+//===- Benchmark.cpp - Minimal microbenchmark harness ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The driver for the benchmarks registered with BENCHMARK(). It runs each of
+// them, or those matching -filter, and prints the time per iteration as text
+// or as JSON for benchmarks/compare.py.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string>
+    Filter("filter", cl::desc("Only run the benchmarks matching this regex"),
+           cl::init(".*"));
+
+static cl::opt<double>
+    MinTime("min-time", cl::desc("Minimum run time of each benchmark, in "
+                                 "seconds (default = 0.5)"),
+            cl::init(0.5));
+
+static cl::opt<bool> JSON("json", cl::desc("Print the results as JSON"));
+
+static std::vector<Benchmark *> &getBenchmarks() {
+  // Constructed on first use, so that the registrations in other files do not
+  // depend on the static initialization order.
+  static std::vector<Benchmark *> Benchmarks;
+  return Benchmarks;
+}
+
+Benchmark::Benchmark(const char *Name, BenchmarkFn Fn) : Name(Name), Fn(Fn) {
+  getBenchmarks().push_back(this);
+}
+
+Benchmark *Benchmark::range(int64_t Lo, int64_t Hi) {
+  assert(Lo > 0 && Lo <= Hi && "Invalid benchmark range");
+  for (int64_t A = Lo; A < Hi; A *= 8)
+    Args.push_back(A);
+  Args.push_back(Hi);
+  return this;
+}
+
+/// Run \p Fn for \p Iterations iterations and return the elapsed seconds.
+static double runOnce(BenchmarkFn Fn, uint64_t Iterations, int64_t Arg) {
+  BenchmarkState State(Iterations, Arg);
+  auto Start = std::chrono::steady_clock::now();
+  Fn(State);
+  auto End = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(End - Start).count();
+}
+
+/// Grow the number of iterations until a run lasts -min-time, and return the
+/// time per iteration in nanoseconds.
+static double measure(BenchmarkFn Fn, int64_t Arg, uint64_t &Iterations) {
+  Iterations = 1;
+  for (;;) {
+    double Seconds = runOnce(Fn, Iterations, Arg);
+    if (Seconds >= MinTime || Iterations >= (UINT64_C(1) << 40))
+      return Seconds * 1e9 / Iterations;
+    // Aim a little past the minimum time, but grow at most tenfold at once so
+    // that a noisy short run does not overshoot by much.
+    double Factor = Seconds > 0 ? MinTime * 1.4 / Seconds : 10;
+    if (Factor > 10)
+      Factor = 10;
+    if (Factor < 2)
+      Factor = 2;
+    Iterations = static_cast<uint64_t>(Iterations * Factor);
+  }
+}
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;
+  cl::ParseCommandLineOptions(argc, argv, "LLVM microbenchmarks\n");
+
+  std::string Error;
+  Regex FilterRE(Filter);
+  if (!FilterRE.isValid(Error)) {
+    errs() << argv[0] << ": invalid -filter: " << Error << "\n";
+    return 1;
+  }
+
+  raw_ostream &OS = outs();
+  if (JSON)
+    OS << "{\n  \"benchmarks\": [";
+  bool First = true;
+  for (const Benchmark *B : getBenchmarks()) {
+    SmallVector<int64_t, 1> Args(B->getArgs().begin(), B->getArgs().end());
+    bool HasArgs = !Args.empty();
+    if (!HasArgs)
+      Args.push_back(0);
+    for (int64_t Arg : Args) {
+      std::string Name = B->getName();
+      if (HasArgs)
+        Name += "/" + itostr(Arg);
+      if (!FilterRE.match(Name))
+        continue;
+      uint64_t Iterations;
+      double NS = measure(B->getFunction(), Arg, Iterations);
+      if (JSON) {
+        OS << (First ? "\n" : ",\n") << "    {\"name\": \"" << Name
+           << "\", \"iterations\": " << Iterations
+           << ", \"ns_per_iteration\": " << format("%.3f", NS) << "}";
+      } else {
+        OS << format("%-48s %14.1f ns %12llu\n", Name.c_str(), NS,
+                     (unsigned long long)Iterations);
+      }
+      First = false;
+      OS.flush();
+    }
+  }
+  if (JSON)
+    OS << "\n  ]\n}\n";
+  return 0;
+}
@@ -0,0 +1,92 @@
+//===- Benchmark.h - Minimal microbenchmark harness -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A small harness for timing hot code paths, in the style of Google
+// benchmark. A benchmark is a function taking a BenchmarkState; it runs its
+// measured code once per iteration of the state's loop:
+//
+//   static void BM_Foo(BenchmarkState &State) {
+//     while (State.keepRunning())
+//       doNotOptimize(foo(State.getArg()));
+//   }
+//   BENCHMARK(BM_Foo)->arg(16)->arg(1024);
+//
+// The harness picks the number of iterations so that each run lasts at least
+// -min-time seconds, and reports the time per iteration.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_BENCHMARKS_BENCHMARK_H
+#define LLVM_BENCHMARKS_BENCHMARK_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include <cstdint>
+
+namespace llvm {
+
+class BenchmarkState {
+  uint64_t Remaining;
+  int64_t Arg;
+
+public:
+  BenchmarkState(uint64_t Iterations, int64_t Arg)
+      : Remaining(Iterations), Arg(Arg) {}
+
+  /// Return true while there are iterations left to run.
+  bool keepRunning() { return Remaining-- != 0; }
+
+  /// The argument this run of the benchmark was registered with, or 0.
+  int64_t getArg() const { return Arg; }
+};
+
+typedef void (*BenchmarkFn)(BenchmarkState &);
+
+class Benchmark {
+  const char *Name;
+  BenchmarkFn Fn;
+  SmallVector<int64_t, 4> Args;
+
+public:
+  Benchmark(const char *Name, BenchmarkFn Fn);
+
+  /// Run the benchmark once more with \p A as its argument.
+  Benchmark *arg(int64_t A) {
+    Args.push_back(A);
+    return this;
+  }
+
+  /// Run the benchmark with every power of 8 between \p Lo and \p Hi, and
+  /// with \p Hi itself.
+  Benchmark *range(int64_t Lo, int64_t Hi);
+
+  const char *getName() const { return Name; }
+  BenchmarkFn getFunction() const { return Fn; }
+  ArrayRef<int64_t> getArgs() const { return Args; }
+};
+
+/// Keep the compiler from optimizing away the computation of \p Value.
+template <typename T> inline void doNotOptimize(const T &Value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "g"(&Value) : "memory");
+#else
+  const volatile void *Sink = &Value;
+  (void)Sink;
+#endif
+}
+
+} // end namespace llvm
+
+#define BENCHMARK_CONCAT2(A, B) A##B
+#define BENCHMARK_CONCAT(A, B) BENCHMARK_CONCAT2(A, B)
+#define BENCHMARK(Fn)                                                          \
+  static ::llvm::Benchmark *BENCHMARK_CONCAT(Registered_, __LINE__) =         \
+      (new ::llvm::Benchmark(#Fn, Fn))
+
+#endif
@@ -0,0 +1,343 @@
+; Branchy, call-heavy code of the kind the inliner, SimplifyCFG, GVN and
+; switch lowering spend their time on: a bytecode interpreter, a hash table
+; and list walks.
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+%struct.VM = type { i64*, i32, i32, i8*, i64 }
+%struct.Entry = type { i8*, i64, %struct.Entry* }
+%struct.Table = type { %struct.Entry**, i32, i32 }
+
+@.str.overflow = private unnamed_addr constant [16 x i8] c"stack overflow\0A\00", align 1
+
+declare i32 @puts(i8*)
+declare i8* @malloc(i64)
+declare void @free(i8*)
+declare i32 @strcmp(i8*, i8*)
+
+define internal void @push(%struct.VM* %vm, i64 %v) {
+entry:
+  %sp.p = getelementptr inbounds %struct.VM, %struct.VM* %vm, i64 0, i32 1
+  %sp = load i32, i32* %sp.p, align 4
+  %cap.p = getelementptr inbounds %struct.VM, %struct.VM* %vm, i64 0, i32 2
+  %cap = load i32, i32* %cap.p, align 4
+  %full = icmp sge i32 %sp, %cap
+  br i1 %full, label %overflow, label %store
+
+overflow:
+  %msg = getelementptr inbounds [16 x i8], [16 x i8]* @.str.overflow, i64 0, i64 0
+  %r = call i32 @puts(i8* %msg)
+  ret void
+
+store:
+  %stack.p = getelementptr inbounds %struct.VM, %struct.VM* %vm, i64 0, i32 0
+  %stack = load i64*, i64** %stack.p, align 8
+  %idx = sext i32 %sp to i64
+  %slot = getelementptr inbounds i64, i64* %stack, i64 %idx
+  store i64 %v, i64* %slot, align 8
+  %sp.next = add nsw i32 %sp, 1
+  store i32 %sp.next, i32* %sp.p, align 4
+  ret void
+}
+
+define internal i64 @pop(%struct.VM* %vm) {
+entry:
+  %sp.p = getelementptr inbounds %struct.VM, %struct.VM* %vm, i64 0, i32 1
+  %sp = load i32, i32* %sp.p, align 4
+  %empty = icmp sle i32 %sp, 0
+  br i1 %empty, label %underflow, label %load
+
+underflow:
+  ret i64 0
+
+load:
+  %sp.next = add nsw i32 %sp, -1
+  store i32 %sp.next, i32* %sp.p, align 4
+  %stack.p = getelementptr inbounds %struct.VM, %struct.VM* %vm, i64 0, i32 0
+  %stack = load i64*, i64** %stack.p, align 8
+  %idx = sext i32 %sp.next to i64
+  %slot = getelementptr inbounds i64, i64* %stack, i64 %idx
+  %v = load i64, i64* %slot, align 8
+  ret i64 %v
+}
+
+define i64 @run(%struct.VM* %vm, i32 %limit) {
+entry:
+  %code.p = getelementptr inbounds %struct.VM, %struct.VM* %vm, i64 0, i32 3
+  %acc.p = getelementptr inbounds %struct.VM, %struct.VM* %vm, i64 0, i32 4
+  br label %dispatch
+
+dispatch:
+  %pc = phi i32 [ 0, %entry ], [ %pc.next, %next ], [ %target, %jump ]
+  %steps = phi i32 [ 0, %entry ], [ %steps.next, %next ], [ %steps.next, %jump ]
+  %steps.next = add nuw nsw i32 %steps, 1
+  %out = icmp sge i32 %steps, %limit
+  br i1 %out, label %halt, label %fetch
+
+fetch:
+  %code = load i8*, i8** %code.p, align 8
+  %pc.64 = sext i32 %pc to i64
+  %op.p = getelementptr inbounds i8, i8* %code, i64 %pc.64
+  %op = load i8, i8* %op.p, align 1
+  %pc.next = add nsw i32 %pc, 2
+  %arg.i = add nsw i64 %pc.64, 1
+  %arg.p = getelementptr inbounds i8, i8* %code, i64 %arg.i
+  %arg = load i8, i8* %arg.p, align 1
+  %arg.64 = sext i8 %arg to i64
+  switch i8 %op, label %halt [
+    i8 0, label %op.const
+    i8 1, label %op.add
+    i8 2, label %op.sub
+    i8 3, label %op.mul
+    i8 4, label %op.div
+    i8 5, label %op.dup
+    i8 6, label %op.drop
+    i8 7, label %op.jmp
+    i8 8, label %op.jz
+    i8 9, label %op.acc
+    i8 10, label %op.shl
+    i8 11, label %op.and
+    i8 12, label %op.or
+    i8 13, label %op.xor
+    i8 14, label %op.lt
+    i8 15, label %op.neg
+  ]
+
+op.const:
+  call void @push(%struct.VM* %vm, i64 %arg.64)
+  br label %next
+
+op.add:
+  %add.b = call i64 @pop(%struct.VM* %vm)
+  %add.a = call i64 @pop(%struct.VM* %vm)
+  %add = add i64 %add.a, %add.b
+  call void @push(%struct.VM* %vm, i64 %add)
+  br label %next
+
+op.sub:
+  %sub.b = call i64 @pop(%struct.VM* %vm)
+  %sub.a = call i64 @pop(%struct.VM* %vm)
+  %sub = sub i64 %sub.a, %sub.b
+  call void @push(%struct.VM* %vm, i64 %sub)
+  br label %next
+
+op.mul:
+  %mul.b = call i64 @pop(%struct.VM* %vm)
+  %mul.a = call i64 @pop(%struct.VM* %vm)
+  %mul = mul i64 %mul.a, %mul.b
+  call void @push(%struct.VM* %vm, i64 %mul)
+  br label %next
+
+op.div:
+  %div.b = call i64 @pop(%struct.VM* %vm)
+  %div.a = call i64 @pop(%struct.VM* %vm)
+  %div.zero = icmp eq i64 %div.b, 0
+  br i1 %div.zero, label %halt, label %op.div.do
+
+op.div.do:
+  %div = sdiv i64 %div.a, %div.b
+  call void @push(%struct.VM* %vm, i64 %div)
+  br label %next
+
+op.dup:
+  %dup = call i64 @pop(%struct.VM* %vm)
+  call void @push(%struct.VM* %vm, i64 %dup)
+  call void @push(%struct.VM* %vm, i64 %dup)
+  br label %next
+
+op.drop:
+  %drop = call i64 @pop(%struct.VM* %vm)
+  br label %next
+
+op.jmp:
+  br label %jump
+
+op.jz:
+  %jz.v = call i64 @pop(%struct.VM* %vm)
+  %jz = icmp eq i64 %jz.v, 0
+  br i1 %jz, label %jump, label %next
+
+jump:
+  %target.off = trunc i64 %arg.64 to i32
+  %target = add nsw i32 %pc, %target.off
+  br label %dispatch
+
+op.acc:
+  %acc.v = call i64 @pop(%struct.VM* %vm)
+  %acc = load i64, i64* %acc.p, align 8
+  %acc.new = add i64 %acc, %acc.v
+  store i64 %acc.new, i64* %acc.p, align 8
+  br label %next
+
+op.shl:
+  %shl.a = call i64 @pop(%struct.VM* %vm)
+  %shl.amt = and i64 %arg.64, 63
+  %shl = shl i64 %shl.a, %shl.amt
+  call void @push(%struct.VM* %vm, i64 %shl)
+  br label %next
+
+op.and:
+  %and.b = call i64 @pop(%struct.VM* %vm)
+  %and.a = call i64 @pop(%struct.VM* %vm)
+  %and = and i64 %and.a, %and.b
+  call void @push(%struct.VM* %vm, i64 %and)
+  br label %next
+
+op.or:
+  %or.b = call i64 @pop(%struct.VM* %vm)
+  %or.a = call i64 @pop(%struct.VM* %vm)
+  %or = or i64 %or.a, %or.b
+  call void @push(%struct.VM* %vm, i64 %or)
+  br label %next
+
+op.xor:
+  %xor.b = call i64 @pop(%struct.VM* %vm)
+  %xor.a = call i64 @pop(%struct.VM* %vm)
+  %xor = xor i64 %xor.a, %xor.b
+  call void @push(%struct.VM* %vm, i64 %xor)
+  br label %next
+
+op.lt:
+  %lt.b = call i64 @pop(%struct.VM* %vm)
+  %lt.a = call i64 @pop(%struct.VM* %vm)
+  %lt = icmp slt i64 %lt.a, %lt.b
+  %lt.64 = zext i1 %lt to i64
+  call void @push(%struct.VM* %vm, i64 %lt.64)
+  br label %next
+
+op.neg:
+  %neg.a = call i64 @pop(%struct.VM* %vm)
+  %neg = sub i64 0, %neg.a
+  call void @push(%struct.VM* %vm, i64 %neg)
+  br label %next
+
+next:
+  br label %dispatch
+
+halt:
+  %res = load i64, i64* %acc.p, align 8
+  ret i64 %res
+}
+
+define internal i64 @hash(i8* %s) {
+entry:
+  br label %loop
+
+loop:
+  %p = phi i8* [ %s, %entry ], [ %p.next, %body ]
+  %h = phi i64 [ 5381, %entry ], [ %h.next, %body ]
+  %c = load i8, i8* %p, align 1
+  %end = icmp eq i8 %c, 0
+  br i1 %end, label %exit, label %body
+
+body:
+  %c.64 = zext i8 %c to i64
+  %h.shl = shl i64 %h, 5
+  %h.mul = add i64 %h.shl, %h
+  %h.next = xor i64 %h.mul, %c.64
+  %p.next = getelementptr inbounds i8, i8* %p, i64 1
+  br label %loop
+
+exit:
+  ret i64 %h
+}
+
+define %struct.Entry* @lookup(%struct.Table* %t, i8* %key, i1 %create) {
+entry:
+  %h = call i64 @hash(i8* %key)
+  %size.p = getelementptr inbounds %struct.Table, %struct.Table* %t, i64 0, i32 1
+  %size = load i32, i32* %size.p, align 4
+  %size.64 = zext i32 %size to i64
+  %bucket = urem i64 %h, %size.64
+  %buckets.p = getelementptr inbounds %struct.Table, %struct.Table* %t, i64 0, i32 0
+  %buckets = load %struct.Entry**, %struct.Entry*** %buckets.p, align 8
+  %head.p = getelementptr inbounds %struct.Entry*, %struct.Entry** %buckets, i64 %bucket
+  %head = load %struct.Entry*, %struct.Entry** %head.p, align 8
+  br label %walk
+
+walk:
+  %e = phi %struct.Entry* [ %head, %entry ], [ %e.next, %mismatch ]
+  %null = icmp eq %struct.Entry* %e, null
+  br i1 %null, label %missing, label %compare
+
+compare:
+  %ekey.p = getelementptr inbounds %struct.Entry, %struct.Entry* %e, i64 0, i32 0
+  %ekey = load i8*, i8** %ekey.p, align 8
+  %cmp = call i32 @strcmp(i8* %ekey, i8* %key)
+  %same = icmp eq i32 %cmp, 0
+  br i1 %same, label %found, label %mismatch
+
+mismatch:
+  %enext.p = getelementptr inbounds %struct.Entry, %struct.Entry* %e, i64 0, i32 2
+  %e.next = load %struct.Entry*, %struct.Entry** %enext.p, align 8
+  br label %walk
+
+found:
+  ret %struct.Entry* %e
+
+missing:
+  br i1 %create, label %insert, label %none
+
+none:
+  ret %struct.Entry* null
+
+insert:
+  %mem = call i8* @malloc(i64 24)
+  %new = bitcast i8* %mem to %struct.Entry*
+  %nkey.p = getelementptr inbounds %struct.Entry, %struct.Entry* %new, i64 0, i32 0
+  store i8* %key, i8** %nkey.p, align 8
+  %nval.p = getelementptr inbounds %struct.Entry, %struct.Entry* %new, i64 0, i32 1
+  store i64 0, i64* %nval.p, align 8
+  %nnext.p = getelementptr inbounds %struct.Entry, %struct.Entry* %new, i64 0, i32 2
+  store %struct.Entry* %head, %struct.Entry** %nnext.p, align 8
+  store %struct.Entry* %new, %struct.Entry** %head.p, align 8
+  %count.p = getelementptr inbounds %struct.Table, %struct.Table* %t, i64 0, i32 2
+  %count = load i32, i32* %count.p, align 4
+  %count.next = add i32 %count, 1
+  store i32 %count.next, i32* %count.p, align 4
+  ret %struct.Entry* %new
+}
+
+define void @clear(%struct.Table* %t) {
+entry:
+  %size.p = getelementptr inbounds %struct.Table, %struct.Table* %t, i64 0, i32 1
+  %size = load i32, i32* %size.p, align 4
+  %buckets.p = getelementptr inbounds %struct.Table, %struct.Table* %t, i64 0, i32 0
+  %buckets = load %struct.Entry**, %struct.Entry*** %buckets.p, align 8
+  %any = icmp ne i32 %size, 0
+  br i1 %any, label %outer, label %exit
+
+outer:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %i.64 = zext i32 %i to i64
+  %head.p = getelementptr inbounds %struct.Entry*, %struct.Entry** %buckets, i64 %i.64
+  %head = load %struct.Entry*, %struct.Entry** %head.p, align 8
+  br label %inner
+
+inner:
+  %e = phi %struct.Entry* [ %head, %outer ], [ %e.next, %inner.body ]
+  %null = icmp eq %struct.Entry* %e, null
+  br i1 %null, label %outer.latch, label %inner.body
+
+inner.body:
+  %enext.p = getelementptr inbounds %struct.Entry, %struct.Entry* %e, i64 0, i32 2
+  %e.next = load %struct.Entry*, %struct.Entry** %enext.p, align 8
+  %mem = bitcast %struct.Entry* %e to i8*
+  call void @free(i8* %mem)
+  br label %inner
+
+outer.latch:
+  store %struct.Entry* null, %struct.Entry** %head.p, align 8
+  %i.next = add i32 %i, 1
+  %more = icmp ult i32 %i.next, %size
+  br i1 %more, label %outer, label %done
+
+done:
+  %count.p = getelementptr inbounds %struct.Table, %struct.Table* %t, i64 0, i32 2
+  store i32 0, i32* %count.p, align 4
+  br label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,172 @@
+; Loop kernels of the kind the vectorizers, LICM and the induction variable
+; passes spend their time on.
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+%struct.Matrix = type { i32, i32, double* }
+
+define void @saxpy(i32 %n, float %a, float* noalias %x, float* noalias %y) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %idx = sext i32 %i to i64
+  %px = getelementptr inbounds float, float* %x, i64 %idx
+  %py = getelementptr inbounds float, float* %y, i64 %idx
+  %vx = load float, float* %px, align 4
+  %vy = load float, float* %py, align 4
+  %mul = fmul float %vx, %a
+  %add = fadd float %mul, %vy
+  store float %add, float* %py, align 4
+  %i.next = add nsw i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+define i64 @dot(i32 %n, i32* %a, i32* %b) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %sum = phi i64 [ 0, %entry ], [ %sum.next, %loop ]
+  %idx = sext i32 %i to i64
+  %pa = getelementptr inbounds i32, i32* %a, i64 %idx
+  %pb = getelementptr inbounds i32, i32* %b, i64 %idx
+  %va = load i32, i32* %pa, align 4
+  %vb = load i32, i32* %pb, align 4
+  %ea = sext i32 %va to i64
+  %eb = sext i32 %vb to i64
+  %mul = mul nsw i64 %ea, %eb
+  %sum.next = add nsw i64 %sum, %mul
+  %i.next = add nsw i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %res = phi i64 [ 0, %entry ], [ %sum.next, %loop ]
+  ret i64 %res
+}
+
+; C = A * B on row-major matrices, with the loads of the dimensions left in
+; the loops for LICM to hoist.
+define void @matmul(%struct.Matrix* %c, %struct.Matrix* %a, %struct.Matrix* %b) {
+entry:
+  %a.rows.p = getelementptr inbounds %struct.Matrix, %struct.Matrix* %a, i64 0, i32 0
+  %a.rows = load i32, i32* %a.rows.p, align 4
+  %has.rows = icmp sgt i32 %a.rows, 0
+  br i1 %has.rows, label %rows, label %exit
+
+rows:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %rows.latch ]
+  br label %cols
+
+cols:
+  %j = phi i32 [ 0, %rows ], [ %j.next, %cols.latch ]
+  br label %inner.check
+
+inner.check:
+  %k0 = phi i32 [ 0, %cols ], [ %k.next, %inner ]
+  %acc = phi double [ 0.0, %cols ], [ %acc.next, %inner ]
+  %a.cols.p = getelementptr inbounds %struct.Matrix, %struct.Matrix* %a, i64 0, i32 1
+  %a.cols = load i32, i32* %a.cols.p, align 4
+  %more = icmp slt i32 %k0, %a.cols
+  br i1 %more, label %inner, label %cols.latch
+
+inner:
+  %a.data.p = getelementptr inbounds %struct.Matrix, %struct.Matrix* %a, i64 0, i32 2
+  %a.data = load double*, double** %a.data.p, align 8
+  %b.data.p = getelementptr inbounds %struct.Matrix, %struct.Matrix* %b, i64 0, i32 2
+  %b.data = load double*, double** %b.data.p, align 8
+  %b.cols.p = getelementptr inbounds %struct.Matrix, %struct.Matrix* %b, i64 0, i32 1
+  %b.cols = load i32, i32* %b.cols.p, align 4
+  %ai.row = mul nsw i32 %i, %a.cols
+  %ai = add nsw i32 %ai.row, %k0
+  %ai.64 = sext i32 %ai to i64
+  %pa = getelementptr inbounds double, double* %a.data, i64 %ai.64
+  %bi.row = mul nsw i32 %k0, %b.cols
+  %bi = add nsw i32 %bi.row, %j
+  %bi.64 = sext i32 %bi to i64
+  %pb = getelementptr inbounds double, double* %b.data, i64 %bi.64
+  %va = load double, double* %pa, align 8
+  %vb = load double, double* %pb, align 8
+  %prod = fmul double %va, %vb
+  %acc.next = fadd double %acc, %prod
+  %k.next = add nsw i32 %k0, 1
+  br label %inner.check
+
+cols.latch:
+  %c.data.p = getelementptr inbounds %struct.Matrix, %struct.Matrix* %c, i64 0, i32 2
+  %c.data = load double*, double** %c.data.p, align 8
+  %c.cols.p = getelementptr inbounds %struct.Matrix, %struct.Matrix* %c, i64 0, i32 1
+  %c.cols = load i32, i32* %c.cols.p, align 4
+  %ci.row = mul nsw i32 %i, %c.cols
+  %ci = add nsw i32 %ci.row, %j
+  %ci.64 = sext i32 %ci to i64
+  %pc = getelementptr inbounds double, double* %c.data, i64 %ci.64
+  store double %acc, double* %pc, align 8
+  %j.next = add nsw i32 %j, 1
+  %more.cols = icmp slt i32 %j.next, %c.cols
+  br i1 %more.cols, label %cols, label %rows.latch
+
+rows.latch:
+  %i.next = add nsw i32 %i, 1
+  %more.rows = icmp slt i32 %i.next, %a.rows
+  br i1 %more.rows, label %rows, label %exit
+
+exit:
+  ret void
+}
+
+; A stencil with a conditional update, for if-conversion and unswitching.
+define void @blur(i32 %n, i32 %clamp, i16* noalias %dst, i16* noalias %src) {
+entry:
+  %last = add nsw i32 %n, -1
+  %cmp = icmp sgt i32 %last, 1
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 1, %entry ], [ %i.next, %latch ]
+  %idx = sext i32 %i to i64
+  %idx.m = add nsw i64 %idx, -1
+  %idx.p = add nsw i64 %idx, 1
+  %p.m = getelementptr inbounds i16, i16* %src, i64 %idx.m
+  %p.c = getelementptr inbounds i16, i16* %src, i64 %idx
+  %p.p = getelementptr inbounds i16, i16* %src, i64 %idx.p
+  %v.m = load i16, i16* %p.m, align 2
+  %v.c = load i16, i16* %p.c, align 2
+  %v.p = load i16, i16* %p.p, align 2
+  %e.m = zext i16 %v.m to i32
+  %e.c = zext i16 %v.c to i32
+  %e.p = zext i16 %v.p to i32
+  %c2 = shl nuw nsw i32 %e.c, 1
+  %s0 = add nuw nsw i32 %e.m, %c2
+  %s1 = add nuw nsw i32 %s0, %e.p
+  %avg = lshr i32 %s1, 2
+  %do.clamp = icmp ne i32 %clamp, 0
+  br i1 %do.clamp, label %clamped, label %latch
+
+clamped:
+  %over = icmp ugt i32 %avg, 255
+  %sat = select i1 %over, i32 255, i32 %avg
+  br label %latch
+
+latch:
+  %val = phi i32 [ %avg, %loop ], [ %sat, %clamped ]
+  %t = trunc i32 %val to i16
+  %pd = getelementptr inbounds i16, i16* %dst, i64 %idx
+  store i16 %t, i16* %pd, align 2
+  %i.next = add nsw i32 %i, 1
+  %done = icmp eq i32 %i.next, %last
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
@@ -0,0 +1,876 @@
+# triple: x86_64-unknown-linux-gnu
+# Generated with llvm-link, opt -O2 and llc -O2 from interp.ll and kernels.ll.
+	.text
+	.file	"<stdin>"
+	.globl	run
+	.p2align	4, 0x90
+	.type	run,@function
+run:                                    # @run
+# BB#0:                                 # %entry
+	pushq	%rbp
+	pushq	%r15
+	pushq	%r14
+	pushq	%r12
+	pushq	%rbx
+	movl	%esi, %r14d
+	movq	%rdi, %rbx
+	testl	%r14d, %r14d
+	jle	.LBB0_49
+# BB#1:                                 # %fetch.lr.ph
+	xorl	%ebp, %ebp
+	xorl	%eax, %eax
+	.p2align	4, 0x90
+.LBB0_2:                                # %fetch
+                                        # =>This Inner Loop Header: Depth=1
+	movq	16(%rbx), %rcx
+	movslq	%eax, %rsi
+	movzbl	(%rcx,%rsi), %edx
+	cmpq	$15, %rdx
+	ja	.LBB0_49
+# BB#3:                                 # %fetch
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leal	2(%rsi), %r15d
+	movsbq	1(%rcx,%rsi), %rcx
+	jmpq	*.LJTI0_0(,%rdx,8)
+.LBB0_4:                                # %op.const
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#6:                                 # %store.i
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movq	(%rbx), %rdx
+	movq	%rcx, (%rdx,%rax,8)
+	leal	1(%rax), %eax
+	movl	%eax, 8(%rbx)
+	jmp	.LBB0_48
+.LBB0_7:                                # %op.add
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	jle	.LBB0_8
+# BB#9:                                 # %pop.exit
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	(%rbx), %rdx
+	movq	-8(%rdx,%rax,8), %rcx
+	cmpl	$1, %eax
+	jne	.LBB0_11
+# BB#10:                                #   in Loop: Header=BB0_2 Depth=1
+	movl	%esi, %eax
+	xorl	%edx, %edx
+	jmp	.LBB0_12
+.LBB0_16:                               # %op.sub
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	jle	.LBB0_17
+# BB#18:                                # %pop.exit88
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	(%rbx), %rdx
+	movq	-8(%rdx,%rax,8), %rcx
+	cmpl	$1, %eax
+	jne	.LBB0_20
+# BB#19:                                #   in Loop: Header=BB0_2 Depth=1
+	movl	%esi, %eax
+	xorl	%edx, %edx
+	jmp	.LBB0_21
+.LBB0_23:                               # %op.mul
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	jle	.LBB0_24
+# BB#25:                                # %pop.exit208
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	(%rbx), %rdx
+	movq	-8(%rdx,%rax,8), %rcx
+	cmpl	$1, %eax
+	jne	.LBB0_27
+# BB#26:                                #   in Loop: Header=BB0_2 Depth=1
+	movl	%esi, %eax
+	xorl	%edx, %edx
+	jmp	.LBB0_28
+.LBB0_30:                               # %op.div
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rdx
+	testq	%rdx, %rdx
+	jle	.LBB0_49
+# BB#31:                                # %pop.exit328
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rdx), %rcx
+	movl	%ecx, 8(%rbx)
+	movq	(%rbx), %rsi
+	movq	-8(%rsi,%rdx,8), %rdi
+	cmpl	$1, %edx
+	movl	$0, %eax
+	je	.LBB0_33
+# BB#32:                                # %load.i405
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leal	-2(%rdx), %ecx
+	movl	%ecx, 8(%rbx)
+	movq	-16(%rsi,%rdx,8), %rax
+.LBB0_33:                               # %pop.exit406
+                                        #   in Loop: Header=BB0_2 Depth=1
+	testq	%rdi, %rdi
+	je	.LBB0_49
+# BB#34:                                # %op.div.do
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %ecx
+	jge	.LBB0_5
+# BB#35:                                # %store.i434
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cqto
+	idivq	%rdi
+	movslq	%ecx, %rdx
+	movq	%rax, (%rsi,%rdx,8)
+	incl	%ecx
+	movl	%ecx, 8(%rbx)
+	jmp	.LBB0_48
+.LBB0_36:                               # %op.dup
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	movl	$0, %r12d
+	jle	.LBB0_38
+# BB#37:                                # %load.i446
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rcx
+	movl	%ecx, 8(%rbx)
+	movq	(%rbx), %rdx
+	movq	-8(%rdx,%rax,8), %r12
+	movl	%ecx, %eax
+.LBB0_38:                               # %pop.exit447
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_39
+# BB#40:                                # %store.i420
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movq	(%rbx), %rcx
+	movslq	%eax, %rdx
+	movq	%r12, (%rcx,%rdx,8)
+	incl	%eax
+	movl	%eax, 8(%rbx)
+	jmp	.LBB0_41
+.LBB0_43:                               # %op.drop
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movl	8(%rbx), %eax
+	testl	%eax, %eax
+	jle	.LBB0_48
+# BB#44:                                # %load.i379
+                                        #   in Loop: Header=BB0_2 Depth=1
+	decl	%eax
+	movl	%eax, 8(%rbx)
+	jmp	.LBB0_48
+.LBB0_45:                               # %op.jz
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rdx
+	testq	%rdx, %rdx
+	jle	.LBB0_47
+# BB#46:                                # %pop.exit367
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rdx), %rsi
+	movl	%esi, 8(%rbx)
+	movq	(%rbx), %rsi
+	cmpq	$0, -8(%rsi,%rdx,8)
+	jne	.LBB0_48
+.LBB0_47:                               # %jump
+                                        #   in Loop: Header=BB0_2 Depth=1
+	addl	%eax, %ecx
+	movl	%ecx, %r15d
+	jmp	.LBB0_48
+.LBB0_50:                               # %op.acc
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	movl	$0, %ecx
+	jle	.LBB0_52
+# BB#51:                                # %load.i353
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rcx
+	movl	%ecx, 8(%rbx)
+	movq	(%rbx), %rcx
+	movq	-8(%rcx,%rax,8), %rcx
+.LBB0_52:                               # %pop.exit354
+                                        #   in Loop: Header=BB0_2 Depth=1
+	addq	%rcx, 24(%rbx)
+	jmp	.LBB0_48
+.LBB0_53:                               # %op.shl
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	movl	$0, %edx
+	jle	.LBB0_55
+# BB#54:                                # %load.i340
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	(%rbx), %rdx
+	movq	-8(%rdx,%rax,8), %rdx
+	movl	%esi, %eax
+.LBB0_55:                               # %pop.exit341
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#56:                                # %store.i301
+                                        #   in Loop: Header=BB0_2 Depth=1
+	shlq	%cl, %rdx
+	jmp	.LBB0_14
+.LBB0_57:                               # %op.and
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	jle	.LBB0_58
+# BB#59:                                # %pop.exit287
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	(%rbx), %rdx
+	movq	-8(%rdx,%rax,8), %rcx
+	cmpl	$1, %eax
+	jne	.LBB0_61
+# BB#60:                                #   in Loop: Header=BB0_2 Depth=1
+	movl	%esi, %eax
+	xorl	%edx, %edx
+	jmp	.LBB0_62
+.LBB0_64:                               # %op.or
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	jle	.LBB0_65
+# BB#66:                                # %pop.exit234
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	(%rbx), %rdx
+	movq	-8(%rdx,%rax,8), %rcx
+	cmpl	$1, %eax
+	jne	.LBB0_68
+# BB#67:                                #   in Loop: Header=BB0_2 Depth=1
+	movl	%esi, %eax
+	xorl	%edx, %edx
+	jmp	.LBB0_69
+.LBB0_71:                               # %op.xor
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	jle	.LBB0_72
+# BB#73:                                # %pop.exit167
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	(%rbx), %rdx
+	movq	-8(%rdx,%rax,8), %rcx
+	cmpl	$1, %eax
+	jne	.LBB0_75
+# BB#74:                                #   in Loop: Header=BB0_2 Depth=1
+	movl	%esi, %eax
+	xorl	%edx, %edx
+	jmp	.LBB0_76
+.LBB0_78:                               # %op.lt
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	jle	.LBB0_79
+# BB#80:                                # %pop.exit114
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	(%rbx), %rdx
+	movq	-8(%rdx,%rax,8), %rcx
+	cmpl	$1, %eax
+	jne	.LBB0_82
+# BB#81:                                #   in Loop: Header=BB0_2 Depth=1
+	movl	%esi, %eax
+	xorl	%edx, %edx
+	jmp	.LBB0_83
+.LBB0_85:                               # %op.neg
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movslq	8(%rbx), %rax
+	testq	%rax, %rax
+	movl	$0, %ecx
+	jle	.LBB0_87
+# BB#86:                                # %load.i46
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-1(%rax), %rdx
+	movl	%edx, 8(%rbx)
+	movq	(%rbx), %rcx
+	movq	-8(%rcx,%rax,8), %rcx
+	movl	%edx, %eax
+.LBB0_87:                               # %pop.exit47
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#88:                                # %store.i21
+                                        #   in Loop: Header=BB0_2 Depth=1
+	negq	%rcx
+	jmp	.LBB0_89
+.LBB0_39:                               # %overflow.i414
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movl	$.L.str.overflow, %edi
+	callq	puts
+	movl	8(%rbx), %eax
+.LBB0_41:                               # %push.exit421
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#42:                                # %store.i393
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movq	(%rbx), %rcx
+	movslq	%eax, %rdx
+	movq	%r12, (%rcx,%rdx,8)
+	jmp	.LBB0_15
+.LBB0_8:                                #   in Loop: Header=BB0_2 Depth=1
+	xorl	%ecx, %ecx
+	xorl	%edx, %edx
+	jmp	.LBB0_12
+.LBB0_17:                               #   in Loop: Header=BB0_2 Depth=1
+	xorl	%ecx, %ecx
+	xorl	%edx, %edx
+	jmp	.LBB0_21
+.LBB0_24:                               #   in Loop: Header=BB0_2 Depth=1
+	xorl	%ecx, %ecx
+	xorl	%edx, %edx
+	jmp	.LBB0_28
+.LBB0_58:                               #   in Loop: Header=BB0_2 Depth=1
+	xorl	%ecx, %ecx
+	xorl	%edx, %edx
+	jmp	.LBB0_62
+.LBB0_65:                               #   in Loop: Header=BB0_2 Depth=1
+	xorl	%ecx, %ecx
+	xorl	%edx, %edx
+	jmp	.LBB0_69
+.LBB0_72:                               #   in Loop: Header=BB0_2 Depth=1
+	xorl	%ecx, %ecx
+	xorl	%edx, %edx
+	jmp	.LBB0_76
+.LBB0_79:                               #   in Loop: Header=BB0_2 Depth=1
+	xorl	%ecx, %ecx
+	xorl	%edx, %edx
+	jmp	.LBB0_83
+.LBB0_11:                               # %load.i33
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-2(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	-16(%rdx,%rax,8), %rdx
+	movl	%esi, %eax
+.LBB0_12:                               # %pop.exit34
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#13:                                # %store.i75
+                                        #   in Loop: Header=BB0_2 Depth=1
+	addq	%rcx, %rdx
+	jmp	.LBB0_14
+.LBB0_20:                               # %load.i140
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-2(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	-16(%rdx,%rax,8), %rdx
+	movl	%esi, %eax
+.LBB0_21:                               # %pop.exit141
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#22:                                # %store.i195
+                                        #   in Loop: Header=BB0_2 Depth=1
+	subq	%rcx, %rdx
+	jmp	.LBB0_14
+.LBB0_27:                               # %load.i260
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-2(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	-16(%rdx,%rax,8), %rdx
+	movl	%esi, %eax
+.LBB0_28:                               # %pop.exit261
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#29:                                # %store.i315
+                                        #   in Loop: Header=BB0_2 Depth=1
+	imulq	%rcx, %rdx
+	jmp	.LBB0_14
+.LBB0_61:                               # %load.i273
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-2(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	-16(%rdx,%rax,8), %rdx
+	movl	%esi, %eax
+.LBB0_62:                               # %pop.exit274
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#63:                                # %store.i248
+                                        #   in Loop: Header=BB0_2 Depth=1
+	andq	%rcx, %rdx
+	jmp	.LBB0_14
+.LBB0_68:                               # %load.i220
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-2(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	-16(%rdx,%rax,8), %rdx
+	movl	%esi, %eax
+.LBB0_69:                               # %pop.exit221
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#70:                                # %store.i181
+                                        #   in Loop: Header=BB0_2 Depth=1
+	orq	%rcx, %rdx
+	jmp	.LBB0_14
+.LBB0_75:                               # %load.i153
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-2(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	-16(%rdx,%rax,8), %rdx
+	movl	%esi, %eax
+.LBB0_76:                               # %pop.exit154
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#77:                                # %store.i128
+                                        #   in Loop: Header=BB0_2 Depth=1
+	xorq	%rcx, %rdx
+	.p2align	4, 0x90
+.LBB0_14:                               # %dispatch.backedge
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movq	(%rbx), %rcx
+	movslq	%eax, %rsi
+	movq	%rdx, (%rcx,%rsi,8)
+	jmp	.LBB0_15
+.LBB0_82:                               # %load.i100
+                                        #   in Loop: Header=BB0_2 Depth=1
+	leaq	-2(%rax), %rsi
+	movl	%esi, 8(%rbx)
+	movq	-16(%rdx,%rax,8), %rdx
+	movl	%esi, %eax
+.LBB0_83:                               # %pop.exit101
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpl	12(%rbx), %eax
+	jge	.LBB0_5
+# BB#84:                                # %store.i61
+                                        #   in Loop: Header=BB0_2 Depth=1
+	cmpq	%rcx, %rdx
+	setl	%cl
+	movzbl	%cl, %ecx
+.LBB0_89:                               # %dispatch.backedge
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movq	(%rbx), %rdx
+	movslq	%eax, %rsi
+	movq	%rcx, (%rdx,%rsi,8)
+	.p2align	4, 0x90
+.LBB0_15:                               # %dispatch.backedge
+                                        #   in Loop: Header=BB0_2 Depth=1
+	incl	%eax
+	movl	%eax, 8(%rbx)
+	jmp	.LBB0_48
+	.p2align	4, 0x90
+.LBB0_5:                                # %overflow.i
+                                        #   in Loop: Header=BB0_2 Depth=1
+	movl	$.L.str.overflow, %edi
+	callq	puts
+.LBB0_48:                               # %dispatch.backedge
+                                        #   in Loop: Header=BB0_2 Depth=1
+	incl	%ebp
+	cmpl	%r14d, %ebp
+	movl	%r15d, %eax
+	jl	.LBB0_2
+.LBB0_49:                               # %halt
+	movq	24(%rbx), %rax
+	popq	%rbx
+	popq	%r12
+	popq	%r14
+	popq	%r15
+	popq	%rbp
+	retq
+.Lfunc_end0:
+	.size	run, .Lfunc_end0-run
+	.section	.rodata,"a",@progbits
+	.p2align	3
+.LJTI0_0:
+	.quad	.LBB0_4
+	.quad	.LBB0_7
+	.quad	.LBB0_16
+	.quad	.LBB0_23
+	.quad	.LBB0_30
+	.quad	.LBB0_36
+	.quad	.LBB0_43
+	.quad	.LBB0_47
+	.quad	.LBB0_45
+	.quad	.LBB0_50
+	.quad	.LBB0_53
+	.quad	.LBB0_57
+	.quad	.LBB0_64
+	.quad	.LBB0_71
+	.quad	.LBB0_78
+	.quad	.LBB0_85
+
+	.text
+	.globl	lookup
+	.p2align	4, 0x90
+	.type	lookup,@function
+lookup:                                 # @lookup
+# BB#0:                                 # %entry
+	pushq	%rbp
+	pushq	%r15
+	pushq	%r14
+	pushq	%r13
+	pushq	%r12
+	pushq	%rbx
+	pushq	%rax
+	movl	%edx, 4(%rsp)           # 4-byte Spill
+	movq	%rsi, %rbx
+	movq	%rdi, %r14
+	movb	(%rbx), %dl
+	movl	$5381, %eax             # imm = 0x1505
+	testb	%dl, %dl
+	je	.LBB1_3
+# BB#1:                                 # %body.i.preheader
+	leaq	1(%rbx), %rcx
+	movl	$5381, %esi             # imm = 0x1505
+	.p2align	4, 0x90
+.LBB1_2:                                # %body.i
+                                        # =>This Inner Loop Header: Depth=1
+	movzbl	%dl, %edx
+	movq	%rsi, %rax
+	shlq	$5, %rax
+	addq	%rsi, %rax
+	xorq	%rdx, %rax
+	movzbl	(%rcx), %edx
+	incq	%rcx
+	testb	%dl, %dl
+	movq	%rax, %rsi
+	jne	.LBB1_2
+.LBB1_3:                                # %hash.exit
+	movl	8(%r14), %ecx
+	xorl	%edx, %edx
+	divq	%rcx
+	movq	%rdx, %r12
+	movq	(%r14), %r13
+	movq	(%r13,%r12,8), %r15
+	testq	%r15, %r15
+	je	.LBB1_7
+# BB#4:                                 # %compare.preheader
+	movq	%r15, %rbp
+	.p2align	4, 0x90
+.LBB1_5:                                # %compare
+                                        # =>This Inner Loop Header: Depth=1
+	movq	(%rbp), %rdi
+	movq	%rbx, %rsi
+	callq	strcmp
+	testl	%eax, %eax
+	je	.LBB1_8
+# BB#6:                                 # %mismatch
+                                        #   in Loop: Header=BB1_5 Depth=1
+	movq	16(%rbp), %rbp
+	testq	%rbp, %rbp
+	jne	.LBB1_5
+.LBB1_7:                                # %missing
+	xorl	%ebp, %ebp
+	movl	4(%rsp), %eax           # 4-byte Reload
+	testb	$1, %al
+	je	.LBB1_8
+# BB#10:                                # %insert
+	movl	$24, %edi
+	callq	malloc
+	movq	%rbx, (%rax)
+	movq	$0, 8(%rax)
+	movq	%r15, 16(%rax)
+	movq	%rax, (%r13,%r12,8)
+	incl	12(%r14)
+	jmp	.LBB1_9
+.LBB1_8:                                # %found
+	movq	%rbp, %rax
+.LBB1_9:                                # %found
+	addq	$8, %rsp
+	popq	%rbx
+	popq	%r12
+	popq	%r13
+	popq	%r14
+	popq	%r15
+	popq	%rbp
+	retq
+.Lfunc_end1:
+	.size	lookup, .Lfunc_end1-lookup
+
+	.globl	clear
+	.p2align	4, 0x90
+	.type	clear,@function
+clear:                                  # @clear
+# BB#0:                                 # %entry
+	pushq	%rbp
+	pushq	%r15
+	pushq	%r14
+	pushq	%r12
+	pushq	%rbx
+	movq	%rdi, %r14
+	movl	8(%r14), %r15d
+	testl	%r15d, %r15d
+	je	.LBB2_6
+# BB#1:                                 # %outer.preheader
+	movq	(%r14), %r12
+	xorl	%ebp, %ebp
+	.p2align	4, 0x90
+.LBB2_2:                                # %outer
+                                        # =>This Loop Header: Depth=1
+                                        #     Child Loop BB2_3 Depth 2
+	movq	(%r12,%rbp,8), %rdi
+	testq	%rdi, %rdi
+	je	.LBB2_4
+	.p2align	4, 0x90
+.LBB2_3:                                # %inner.body
+                                        #   Parent Loop BB2_2 Depth=1
+                                        # =>  This Inner Loop Header: Depth=2
+	movq	16(%rdi), %rbx
+	callq	free
+	testq	%rbx, %rbx
+	movq	%rbx, %rdi
+	jne	.LBB2_3
+.LBB2_4:                                # %outer.latch
+                                        #   in Loop: Header=BB2_2 Depth=1
+	movq	$0, (%r12,%rbp,8)
+	incq	%rbp
+	cmpl	%r15d, %ebp
+	jne	.LBB2_2
+# BB#5:                                 # %done
+	movl	$0, 12(%r14)
+.LBB2_6:                                # %exit
+	popq	%rbx
+	popq	%r12
+	popq	%r14
+	popq	%r15
+	popq	%rbp
+	retq
+.Lfunc_end2:
+	.size	clear, .Lfunc_end2-clear
+
+	.globl	saxpy
+	.p2align	4, 0x90
+	.type	saxpy,@function
+saxpy:                                  # @saxpy
+# BB#0:                                 # %entry
+	testl	%edi, %edi
+	jle	.LBB3_8
+# BB#1:                                 # %loop.preheader
+	movl	%edi, %eax
+	xorl	%r9d, %r9d
+	cmpl	$8, %edi
+	jb	.LBB3_6
+# BB#2:                                 # %min.iters.checked
+	andl	$7, %edi
+	xorl	%r9d, %r9d
+	movq	%rax, %r8
+	subq	%rdi, %r8
+	je	.LBB3_6
+# BB#3:                                 # %vector.ph
+	movaps	%xmm0, %xmm1
+	shufps	$0, %xmm1, %xmm1        # xmm1 = xmm1[0,0,0,0]
+	leaq	16(%rsi), %r9
+	leaq	16(%rdx), %rcx
+	movq	%r8, %r10
+	.p2align	4, 0x90
+.LBB3_4:                                # %vector.body
+                                        # =>This Inner Loop Header: Depth=1
+	movups	-16(%r9), %xmm2
+	movups	(%r9), %xmm3
+	movups	-16(%rcx), %xmm4
+	movups	(%rcx), %xmm5
+	mulps	%xmm1, %xmm2
+	mulps	%xmm1, %xmm3
+	addps	%xmm4, %xmm2
+	addps	%xmm5, %xmm3
+	movups	%xmm2, -16(%rcx)
+	movups	%xmm3, (%rcx)
+	addq	$32, %r9
+	addq	$32, %rcx
+	addq	$-8, %r10
+	jne	.LBB3_4
+# BB#5:                                 # %middle.block
+	testl	%edi, %edi
+	movq	%r8, %r9
+	je	.LBB3_8
+.LBB3_6:                                # %loop.preheader7
+	leaq	(%rsi,%r9,4), %rcx
+	leaq	(%rdx,%r9,4), %rdx
+	subq	%r9, %rax
+	.p2align	4, 0x90
+.LBB3_7:                                # %loop
+                                        # =>This Inner Loop Header: Depth=1
+	movss	(%rcx), %xmm1           # xmm1 = mem[0],zero,zero,zero
+	mulss	%xmm0, %xmm1
+	addss	(%rdx), %xmm1
+	movss	%xmm1, (%rdx)
+	addq	$4, %rcx
+	addq	$4, %rdx
+	decq	%rax
+	jne	.LBB3_7
+.LBB3_8:                                # %exit
+	retq
+.Lfunc_end3:
+	.size	saxpy, .Lfunc_end3-saxpy
+
+	.globl	dot
+	.p2align	4, 0x90
+	.type	dot,@function
+dot:                                    # @dot
+# BB#0:                                 # %entry
+	xorl	%eax, %eax
+	testl	%edi, %edi
+	jle	.LBB4_3
+# BB#1:                                 # %loop.preheader
+	movl	%edi, %ecx
+	xorl	%eax, %eax
+	.p2align	4, 0x90
+.LBB4_2:                                # %loop
+                                        # =>This Inner Loop Header: Depth=1
+	movslq	(%rsi), %r8
+	movslq	(%rdx), %rdi
+	imulq	%r8, %rdi
+	addq	%rdi, %rax
+	addq	$4, %rsi
+	addq	$4, %rdx
+	decq	%rcx
+	jne	.LBB4_2
+.LBB4_3:                                # %exit
+	retq
+.Lfunc_end4:
+	.size	dot, .Lfunc_end4-dot
+
+	.globl	matmul
+	.p2align	4, 0x90
+	.type	matmul,@function
+matmul:                                 # @matmul
+# BB#0:                                 # %entry
+	pushq	%rbp
+	pushq	%r15
+	pushq	%r14
+	pushq	%rbx
+	movl	(%rsi), %r8d
+	testl	%r8d, %r8d
+	jle	.LBB5_8
+# BB#1:                                 # %rows.preheader
+	xorl	%r9d, %r9d
+	.p2align	4, 0x90
+.LBB5_2:                                # %rows
+                                        # =>This Loop Header: Depth=1
+                                        #     Child Loop BB5_3 Depth 2
+                                        #       Child Loop BB5_5 Depth 3
+	xorl	%r10d, %r10d
+	.p2align	4, 0x90
+.LBB5_3:                                # %cols
+                                        #   Parent Loop BB5_2 Depth=1
+                                        # =>  This Loop Header: Depth=2
+                                        #       Child Loop BB5_5 Depth 3
+	movslq	4(%rsi), %r11
+	testq	%r11, %r11
+	xorpd	%xmm0, %xmm0
+	jle	.LBB5_6
+# BB#4:                                 # %inner.lr.ph
+                                        #   in Loop: Header=BB5_3 Depth=2
+	movq	8(%rsi), %r14
+	movslq	4(%rdx), %r15
+	movl	%r9d, %ebx
+	imull	%r11d, %ebx
+	leaq	(,%r10,8), %rax
+	addq	8(%rdx), %rax
+	shlq	$3, %r15
+	xorpd	%xmm0, %xmm0
+	xorl	%ecx, %ecx
+	.p2align	4, 0x90
+.LBB5_5:                                # %inner
+                                        #   Parent Loop BB5_2 Depth=1
+                                        #     Parent Loop BB5_3 Depth=2
+                                        # =>    This Inner Loop Header: Depth=3
+	leal	(%rbx,%rcx), %ebp
+	movslq	%ebp, %rbp
+	movsd	(%r14,%rbp,8), %xmm1    # xmm1 = mem[0],zero
+	mulsd	(%rax), %xmm1
+	addsd	%xmm1, %xmm0
+	incq	%rcx
+	addq	%r15, %rax
+	cmpq	%r11, %rcx
+	jl	.LBB5_5
+.LBB5_6:                                # %cols.latch
+                                        #   in Loop: Header=BB5_3 Depth=2
+	movq	8(%rdi), %rax
+	movslq	4(%rdi), %rbp
+	movl	%ebp, %ecx
+	imull	%r9d, %ecx
+	leal	(%r10,%rcx), %ecx
+	movslq	%ecx, %rcx
+	movsd	%xmm0, (%rax,%rcx,8)
+	incq	%r10
+	cmpq	%rbp, %r10
+	jl	.LBB5_3
+# BB#7:                                 # %rows.latch
+                                        #   in Loop: Header=BB5_2 Depth=1
+	incl	%r9d
+	cmpl	%r8d, %r9d
+	jne	.LBB5_2
+.LBB5_8:                                # %exit
+	popq	%rbx
+	popq	%r14
+	popq	%r15
+	popq	%rbp
+	retq
+.Lfunc_end5:
+	.size	matmul, .Lfunc_end5-matmul
+
+	.globl	blur
+	.p2align	4, 0x90
+	.type	blur,@function
+blur:                                   # @blur
+# BB#0:                                 # %entry
+	pushq	%rbp
+	pushq	%rbx
+	decl	%edi
+	cmpl	$2, %edi
+	jl	.LBB6_3
+# BB#1:                                 # %loop.preheader
+	movl	%edi, %r9d
+	movzwl	(%rcx), %edi
+	movw	2(%rcx), %bp
+	decq	%r9
+	addq	$4, %rcx
+	addq	$2, %rdx
+	movw	$255, %r8w
+	.p2align	4, 0x90
+.LBB6_2:                                # %loop
+                                        # =>This Inner Loop Header: Depth=1
+	movzwl	%di, %r10d
+	movl	%ebp, %edi
+	movzwl	%di, %r11d
+	movzwl	(%rcx), %ebp
+	leal	(%r10,%r11,2), %eax
+	addl	%ebp, %eax
+	movl	%eax, %ebx
+	shrl	$2, %ebx
+	cmpl	$1023, %eax             # imm = 0x3FF
+	movl	%ebx, %eax
+	cmovaw	%r8w, %ax
+	testl	%esi, %esi
+	cmovew	%bx, %ax
+	movw	%ax, (%rdx)
+	addq	$2, %rcx
+	addq	$2, %rdx
+	decq	%r9
+	jne	.LBB6_2
+.LBB6_3:                                # %exit
+	popq	%rbx
+	popq	%rbp
+	retq
+.Lfunc_end6:
+	.size	blur, .Lfunc_end6-blur
+
+	.type	.L.str.overflow,@object # @.str.overflow
+	.section	.rodata.str1.1,"aMS",@progbits,1
+.L.str.overflow:
+	.asciz	"stack overflow\n"
+	.size	.L.str.overflow, 16
+
+
+	.section	".note.GNU-stack","",@progbits
@@ -0,0 +1,72 @@
+//===- TargetBenchmarks.cpp - Benchmarks for creating target machines -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// These benchmarks time what a JIT does each time it creates a target machine
+// for the host: detecting the host CPU, looking up the target and creating the
+// target machine, which parses the CPU and feature string into a subtarget.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include <memory>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+void BM_GetHostCPUName(BenchmarkState &State) {
+  while (State.keepRunning())
+    doNotOptimize(sys::getHostCPUName());
+}
+
+void BM_GetHostCPUFeatures(BenchmarkState &State) {
+  while (State.keepRunning()) {
+    StringMap<bool> Features;
+    doNotOptimize(sys::getHostCPUFeatures(Features));
+  }
+}
+
+std::string getHostFeatureString() {
+  SubtargetFeatures Features;
+  StringMap<bool> HostFeatures;
+  if (sys::getHostCPUFeatures(HostFeatures))
+    for (auto &F : HostFeatures)
+      Features.AddFeature(F.first(), F.second);
+  return Features.getString();
+}
+
+void BM_CreateTargetMachine(BenchmarkState &State) {
+  InitializeNativeTarget();
+  std::string Triple = sys::getProcessTriple();
+  StringRef CPU = sys::getHostCPUName();
+  std::string Features = getHostFeatureString();
+  while (State.keepRunning()) {
+    std::string Error;
+    const Target *T = TargetRegistry::lookupTarget(Triple, Error);
+    if (!T)
+      return;
+    std::unique_ptr<TargetMachine> TM(
+        T->createTargetMachine(Triple, CPU, Features, TargetOptions(), None));
+    doNotOptimize(TM.get());
+  }
+}
+
+} // end anonymous namespace
+
+BENCHMARK(BM_GetHostCPUName);
+BENCHMARK(BM_GetHostCPUFeatures);
+BENCHMARK(BM_CreateTargetMachine);
@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+"""Compare two benchmark result files and report the regressions.
+
+Both llvm-microbench -json and compile_time.py write a list of benchmarks
+with either an 'ns_per_iteration' or a 'seconds' measurement. This prints the
+change of every benchmark found in both files, and exits with 1 if any of them
+got slower by more than --threshold percent.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import sys
+
+
+def measurements(results):
+    values = {}
+    for bench in results.get('benchmarks', []):
+        for key in ('ns_per_iteration', 'seconds'):
+            if key in bench:
+                values[bench['name']] = float(bench[key])
+                break
+    return values
+
+
+def report(old_results, new_results, threshold):
+    """Print the comparison and return the number of regressions."""
+    old = measurements(old_results)
+    new = measurements(new_results)
+    regressions = 0
+    for name in sorted(set(old) & set(new)):
+        if old[name] == 0:
+            continue
+        change = (new[name] - old[name]) * 100.0 / old[name]
+        marker = ''
+        if change > threshold:
+            marker = '  <-- regression'
+            regressions += 1
+        print('%-48s %+7.1f%%%s' % (name, change, marker))
+    for name in sorted(set(old) - set(new)):
+        print('%-48s missing from the new results' % name)
+    if regressions:
+        print('%d benchmark(s) regressed by more than %.1f%%' %
+              (regressions, threshold))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('old', help='baseline results')
+    parser.add_argument('new', help='results to check')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='percentage slowdown to report as a regression '
+                             '(default 5)')
+    args = parser.parse_args()
+    with open(args.old) as f:
+        old = json.load(f)
+    with open(args.new) as f:
+        new = json.load(f)
+    return 1 if report(old, new, args.threshold) else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
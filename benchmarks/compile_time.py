@@ -0,0 +1,130 @@
+#!/usr/bin/env python
+"""Time the LLVM tools on the checked-in benchmark inputs.
+
+For every IR file in the inputs directory this times:
+  opt -O2, llc -O2, llvm-as (bitcode writing) and llvm-dis (bitcode reading).
+For every assembly file it times llvm-mc -filetype=obj. An assembly file names
+its target in a first line of the form '# triple: <triple>'. Inputs for
+targets that are not built are skipped.
+
+Each command runs --repeat times and the fastest run is kept, which is the
+least noisy estimate on a loaded machine. The results are written as JSON and,
+given --baseline, compared with an earlier run by compare.py.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import compare
+
+
+def time_command(cmd, repeat):
+    """Return the fastest wall time of cmd over repeat runs, or None if it
+    fails."""
+    best = None
+    with open(os.devnull, 'w') as devnull:
+        for _ in range(repeat):
+            start = time.time()
+            if subprocess.call(cmd, stdout=devnull, stderr=devnull) != 0:
+                return None
+            elapsed = time.time() - start
+            if best is None or elapsed < best:
+                best = elapsed
+    return best
+
+
+def read_triple(path):
+    with open(path) as f:
+        first = f.readline()
+    prefix = '# triple:'
+    if first.startswith(prefix):
+        return first[len(prefix):].strip()
+    return None
+
+
+def commands_for(path, tool, scratch):
+    """Yield (name, command) pairs for one input."""
+    base = os.path.basename(path)
+    if path.endswith('.ll'):
+        bitcode = os.path.join(scratch, base + '.bc')
+        # Write the bitcode once up front so that llvm-dis reads the same
+        # file every time.
+        subprocess.check_call([tool('llvm-as'), path, '-o', bitcode])
+        yield base + '/opt-O2', [tool('opt'), '-O2', path, '-o', os.devnull]
+        yield base + '/llc-O2', [tool('llc'), '-O2', path, '-o', os.devnull]
+        yield base + '/bitcode-write', [tool('llvm-as'), path, '-o',
+                                        os.devnull]
+        yield base + '/bitcode-read', [tool('llvm-dis'), bitcode, '-o',
+                                       os.devnull]
+    elif path.endswith('.s'):
+        triple = read_triple(path)
+        if triple is None:
+            print('warning: %s has no "# triple:" line, skipping' % path,
+                  file=sys.stderr)
+            return
+        yield base + '/mc-obj', [tool('llvm-mc'), '-triple', triple,
+                                 '-filetype=obj', path, '-o', os.devnull]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--bin-dir', required=True,
+                        help='directory with the LLVM tools to time')
+    parser.add_argument('--inputs',
+                        default=os.path.join(os.path.dirname(__file__),
+                                             'Inputs'),
+                        help='directory with the .ll and .s inputs')
+    parser.add_argument('--repeat', type=int, default=5,
+                        help='number of runs of each command (default 5)')
+    parser.add_argument('--output', help='write the results to this file')
+    parser.add_argument('--baseline',
+                        help='compare with the results in this file')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='percentage slowdown to report as a regression '
+                             '(default 5)')
+    args = parser.parse_args()
+
+    def tool(name):
+        return os.path.join(args.bin_dir, name)
+
+    results = []
+    scratch = tempfile.mkdtemp(prefix='llvm-compile-time-')
+    try:
+        for name in sorted(os.listdir(args.inputs)):
+            path = os.path.join(args.inputs, name)
+            for bench, cmd in commands_for(path, tool, scratch):
+                seconds = time_command(cmd, args.repeat)
+                if seconds is None:
+                    print('warning: %s failed, skipping' % ' '.join(cmd),
+                          file=sys.stderr)
+                    continue
+                print('%-40s %10.4f s' % (bench, seconds))
+                sys.stdout.flush()
+                results.append({'name': bench, 'seconds': seconds})
+    finally:
+        shutil.rmtree(scratch)
+
+    report = {'benchmarks': results}
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+            f.write('\n')
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if compare.report(baseline, report, args.threshold):
+            return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
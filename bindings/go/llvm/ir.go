@@ -1751,6 +1751,29 @@ func (b Builder) CreateResume(ex Value) (v Value) {
 	return
 }
 
+// CreateInstructions builds the instructions encoded in code, as described by
+// LLVMBuildInstructions, with a single call into LLVM. Operands refer to
+// values and types by their index in the given slices; the instruction built
+// for each record is appended to values, so that later records can use it.
+// The returned slice holds the inputs followed by the instructions built.
+func (b Builder) CreateInstructions(code []uint32, values []Value, types []Type) []Value {
+	if len(code) == 0 {
+		return values
+	}
+	// Every record takes at least one word, so this is enough room for the
+	// results.
+	vals := make([]Value, len(values)+len(code))
+	copy(vals, values)
+	var ptypes *C.LLVMTypeRef
+	if len(types) > 0 {
+		ptypes = llvmTypeRefPtr(&types[0])
+	}
+	n := C.LLVMBuildInstructions(b.C, (*C.unsigned)(unsafe.Pointer(&code[0])),
+		C.unsigned(len(code)), llvmValueRefPtr(&vals[0]),
+		C.unsigned(len(values)), ptypes)
+	return vals[:len(values)+int(n)]
+}
+
 //-------------------------------------------------------------------------
 // llvm.ModuleProvider
 //-------------------------------------------------------------------------
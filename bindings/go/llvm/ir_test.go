@@ -95,3 +95,41 @@ func TestAttributes(t *testing.T) {
 		testAttribute(t, a.attr, a.name)
 	}
 }
+
+func TestCreateInstructions(t *testing.T) {
+	mod := NewModule("")
+	defer mod.Dispose()
+
+	i32 := Int32Type()
+	ftyp := FunctionType(i32, []Type{i32, i32}, false)
+	fn := AddFunction(mod, "foo", ftyp)
+	b := NewBuilder()
+	defer b.Dispose()
+	b.SetInsertPointAtEnd(AddBasicBlock(fn, "entry"))
+
+	// %2 = add i32 %a, %b
+	// %3 = mul i32 %2, %a
+	// %4 = icmp slt i32 %3, %b
+	// %5 = select i1 %4, i32 %3, i32 %b
+	// ret i32 %5
+	code := []uint32{
+		uint32(Add), 0, 1,
+		uint32(Mul), 2, 0,
+		uint32(ICmp), uint32(IntSLT), 3, 1,
+		uint32(Select), 4, 3, 1,
+		uint32(Ret), 1, 5,
+	}
+	vals := b.CreateInstructions(code, fn.Params(), nil)
+	if len(vals) != 7 {
+		t.Fatalf("got %d values, want 7", len(vals))
+	}
+	if op := vals[3].InstructionOpcode(); op != Mul {
+		t.Errorf("got opcode %d, want %d", op, Mul)
+	}
+	if op := vals[6].InstructionOpcode(); op != Ret {
+		t.Errorf("got opcode %d, want %d", op, Ret)
+	}
+	if err := VerifyModule(mod, ReturnStatusAction); err != nil {
+		t.Errorf("verification failed: %v", err)
+	}
+}
@@ -1352,6 +1352,11 @@ external build_is_not_null : llvalue -> string -> llbuilder -> llvalue
 external build_ptrdiff : llvalue -> llvalue -> string -> llbuilder -> llvalue
                        = "llvm_build_ptrdiff"
 
+(*--... Bulk construction ..................................................--*)
+external build_instructions : int array -> llvalue array -> lltype array ->
+                              llbuilder -> llvalue array
+                            = "llvm_build_instructions"
+
 
 (*===-- Memory buffers ----------------------------------------------------===*)
 
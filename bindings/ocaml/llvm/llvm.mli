@@ -2541,6 +2541,20 @@ val build_is_not_null : llvalue -> string -> llbuilder -> llvalue
 val build_ptrdiff : llvalue -> llvalue -> string -> llbuilder -> llvalue
 
 
+(** {7 Bulk construction} *)
+
+(** [build_instructions code vs tys b] creates the unnamed instructions encoded
+    in [code] at the position specified by the instruction builder [b], with a
+    single call into LLVM. Each record is an opcode, numbered as in [Opcode.t],
+    followed by operands that index [vs], or [tys] where a type is expected;
+    predicates use the numbering of the C API. The instruction created for each
+    record is appended to [vs], so that later records can refer to it. Returns
+    [vs] followed by the instructions created.
+    See the function [LLVMBuildInstructions] for the encoding. *)
+val build_instructions : int array -> llvalue array -> lltype array ->
+                         llbuilder -> llvalue array
+
+
 (** {6 Memory buffers} *)
 
 module MemoryBuffer : sig
@@ -2343,6 +2343,34 @@ CAMLprim LLVMValueRef llvm_build_ptrdiff(LLVMValueRef LHS, LLVMValueRef RHS,
   return LLVMBuildPtrDiff(Builder_val(B), LHS, RHS, String_val(Name));
 }
 
+/*--... Bulk construction ..................................................--*/
+
+/* int array -> llvalue array -> lltype array -> llbuilder -> llvalue array */
+CAMLprim value llvm_build_instructions(value Code, value Values, value Types,
+                                       value B) {
+  CAMLparam4(Code, Values, Types, B);
+  CAMLlocal1(Result);
+  unsigned CodeLength = Wosize_val(Code);
+  unsigned NumValues = Wosize_val(Values);
+  unsigned *Words = (unsigned *)malloc(CodeLength * sizeof(unsigned));
+  /* Every record takes at least one word. */
+  LLVMValueRef *Vals = (LLVMValueRef *)malloc((NumValues + CodeLength) *
+                                              sizeof(LLVMValueRef));
+  unsigned I, NumBuilt;
+
+  for (I = 0; I != CodeLength; ++I)
+    Words[I] = Int_val(Field(Code, I));
+  memcpy(Vals, Op_val(Values), NumValues * sizeof(LLVMValueRef));
+  NumBuilt = LLVMBuildInstructions(Builder_val(B), Words, CodeLength, Vals,
+                                   NumValues, (LLVMTypeRef *) Op_val(Types));
+
+  Result = alloc(NumValues + NumBuilt, 0);
+  memcpy(Op_val(Result), Vals, (NumValues + NumBuilt) * sizeof(LLVMValueRef));
+  free(Words);
+  free(Vals);
+  CAMLreturn(Result);
+}
+
 /*===-- Memory buffers ----------------------------------------------------===*/
 
 /* string -> llmemorybuffer
@@ -2014,6 +2014,15 @@ void LLVMAddFunctionAttr(LLVMValueRef Fn, LLVMAttribute PA);
 
 void LLVMAddAttributeAtIndex(LLVMValueRef F, LLVMAttributeIndex Idx,
                              LLVMAttributeRef A);
+
+/**
+ * Add NumAttrs attributes to a function at once.
+ *
+ * This is equivalent to calling LLVMAddAttributeAtIndex() for each attribute,
+ * but rebuilds the attribute list of the function only once.
+ */
+void LLVMAddAttributesAtIndex(LLVMValueRef F, LLVMAttributeIndex Idx,
+                              LLVMAttributeRef *Attrs, unsigned NumAttrs);
 LLVMAttributeRef LLVMGetEnumAttributeAtIndex(LLVMValueRef F,
                                              LLVMAttributeIndex Idx,
                                              unsigned KindID);
@@ -2600,6 +2609,8 @@ void LLVMSetInstrParamAlignment(LLVMValueRef Instr, unsigned index,
 
 void LLVMAddCallSiteAttribute(LLVMValueRef C, LLVMAttributeIndex Idx,
                               LLVMAttributeRef A);
+void LLVMAddCallSiteAttributes(LLVMValueRef C, LLVMAttributeIndex Idx,
+                               LLVMAttributeRef *Attrs, unsigned NumAttrs);
 LLVMAttributeRef LLVMGetCallSiteEnumAttribute(LLVMValueRef C,
                                               LLVMAttributeIndex Idx,
                                               unsigned KindID);
@@ -3111,6 +3122,40 @@ LLVMValueRef LLVMBuildAtomicCmpXchg(LLVMBuilderRef B, LLVMValueRef Ptr,
                                     LLVMAtomicOrdering FailureOrdering,
                                     LLVMBool SingleThread);
 
+/* Bulk construction */
+
+/**
+ * Build a sequence of unnamed instructions at the builder's insertion point
+ * from a compact encoding, so that bindings which pay for each call into the
+ * C API can build a whole block with a single call.
+ *
+ * Code holds CodeLength words. Each instruction starts with its LLVMOpcode,
+ * followed by operands that are indices into Values, or into Types where a
+ * type is expected:
+ *
+ *  - binary operators (LLVMAdd to LLVMXor): LHS, RHS
+ *  - casts (LLVMTrunc to LLVMAddrSpaceCast): Val, DestTy
+ *  - LLVMICmp and LLVMFCmp: the LLVMIntPredicate or LLVMRealPredicate, LHS,
+ *    RHS
+ *  - LLVMSelect: If, Then, Else
+ *  - LLVMAlloca: Ty
+ *  - LLVMLoad: Ptr
+ *  - LLVMStore: Val, Ptr
+ *  - LLVMGetElementPtr: Ptr, the number of indices N, then N indices
+ *  - LLVMExtractValue: Agg, the index
+ *  - LLVMInsertValue: Agg, Elt, the index
+ *  - LLVMRet: the number of values N (0 or 1), then N values
+ *
+ * The first NumValues entries of Values are inputs. The instruction built
+ * for the I-th record is stored in Values[NumValues + I], so that later
+ * records can use it; Values must have room for every record.
+ *
+ * @return The number of instructions built.
+ */
+unsigned LLVMBuildInstructions(LLVMBuilderRef B, const unsigned *Code,
+                               unsigned CodeLength, LLVMValueRef *Values,
+                               unsigned NumValues, LLVMTypeRef *Types);
+
 LLVMBool LLVMIsAtomicSingleThread(LLVMValueRef AtomicInst);
 void LLVMSetAtomicSingleThread(LLVMValueRef AtomicInst, LLVMBool SingleThread);
 
@@ -44,7 +44,7 @@ typedef bool lto_bool_t;
  * @{
  */
 
-#define LTO_API_VERSION 19
+#define LTO_API_VERSION 21
 
 /**
  * \since prior to LTO_API_VERSION=3
@@ -98,6 +98,17 @@ typedef struct LLVMOpaqueLTOCodeGenerator *lto_code_gen_t;
 /** opaque reference to a thin code generator */
 typedef struct LLVMOpaqueThinLTOCodeGenerator *thinlto_code_gen_t;
 
+/**
+ * Type to wrap a single object returned by ThinLTO or by
+ * lto_codegen_compile_parallel().
+ *
+ * \since LTO_API_VERSION=18
+ */
+typedef struct {
+  const char *Buffer;
+  size_t Size;
+} LTOObjectBuffer;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -494,6 +505,28 @@ lto_codegen_optimize(lto_code_gen_t cg);
 extern const void*
 lto_codegen_compile_optimized(lto_code_gen_t cg, size_t* length);
 
+/**
+ * Generates code for all added modules into \p parallelism native object
+ * files, each holding a linkable partition of the merged module, with code
+ * generation for the partitions done in parallel, one thread per partition.
+ * This calls lto_codegen_optimize before splitting the merged module. A
+ * parallelism of 0 is treated as 1.
+ *
+ * On success returns an array of the generated mach-o/ELF buffers and sets
+ * num_objects to its size. The array and the buffers are owned by the
+ * lto_code_gen_t and will be freed when lto_codegen_dispose() is called, or
+ * lto_codegen_compile_parallel() is called again. On failure, returns NULL
+ * (check lto_get_error_message() for details).
+ *
+ * With a parallelism greater than 1 the merged module is consumed by the
+ * splitting, so it cannot be written out or compiled again afterwards.
+ *
+ * \since LTO_API_VERSION=20
+ */
+extern const LTOObjectBuffer *
+lto_codegen_compile_parallel(lto_code_gen_t cg, unsigned int parallelism,
+                             unsigned int *num_objects);
+
 /**
  * Returns the runtime API version.
  *
@@ -549,16 +582,6 @@ lto_codegen_set_should_embed_uselists(lto_code_gen_t cg,
  * @{
  */
 
-/**
- * Type to wrap a single object returned by ThinLTO.
- *
- * \since LTO_API_VERSION=18
- */
-typedef struct {
-  const char *Buffer;
-  size_t Size;
-} LTOObjectBuffer;
-
 /**
  * Instantiates a ThinLTO code generator.
  * Returns NULL on error (check lto_get_error_message() for details).
@@ -692,6 +715,26 @@ extern void thinlto_codegen_set_cache_pruning_interval(thinlto_code_gen_t cg,
 extern void thinlto_codegen_set_final_cache_size_relative_to_available_space(
     thinlto_code_gen_t cg, unsigned percentage);
 
+/**
+ * Sets the maximum cache size in bytes. When the cache grows past it, the
+ * least recently used entries are removed first. When a percentage of the
+ * available space is also set, the smaller limit applies. A value of 0 (the
+ * default) sets no limit in bytes.
+ *
+ * \since LTO_API_VERSION=21
+ */
+extern void thinlto_codegen_set_cache_size_bytes(thinlto_code_gen_t cg,
+                                                 unsigned long long max_bytes);
+
+/**
+ * Sets whether the cache is pruned on a separate thread while the modules are
+ * processed, rather than after they are done. Disabled by default.
+ *
+ * \since LTO_API_VERSION=21
+ */
+extern void thinlto_codegen_set_cache_pruning_in_background(
+    thinlto_code_gen_t cg, lto_bool_t enable);
+
 /**
  * Sets the expiration (in seconds) for an entry in the cache. An unspecified
  * default value will be applied. A value of 0 will be ignored.
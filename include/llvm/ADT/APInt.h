@@ -22,6 +22,7 @@
 #include <climits>
 #include <cstring>
 #include <string>
+#include <utility>
 
 namespace llvm {
 class FoldingSetNodeID;
@@ -192,14 +193,22 @@ class APInt {
   /// out-of-line slow case for shl
   APInt shlSlowCase(unsigned shiftAmt) const;
 
-  /// out-of-line slow case for operator&
-  APInt AndSlowCase(const APInt &RHS) const;
+  /// out-of-line slow case for operator&=
+  APInt &AndAssignSlowCase(const APInt &RHS);
 
-  /// out-of-line slow case for operator|
-  APInt OrSlowCase(const APInt &RHS) const;
+  /// out-of-line slow case for operator|=
+  APInt &OrAssignSlowCase(const APInt &RHS);
 
-  /// out-of-line slow case for operator^
-  APInt XorSlowCase(const APInt &RHS) const;
+  /// out-of-line slow case for operator^=
+  APInt &XorAssignSlowCase(const APInt &RHS);
+
+  /// out-of-line slow case for operator+=
+  APInt &AddAssignSlowCase(const APInt &RHS);
+  APInt &AddAssignSlowCase(uint64_t RHS);
+
+  /// out-of-line slow case for operator-=
+  APInt &SubAssignSlowCase(const APInt &RHS);
+  APInt &SubAssignSlowCase(uint64_t RHS);
 
   /// out-of-line slow case for operator=
   APInt &AssignSlowCase(const APInt &RHS);
@@ -500,8 +509,8 @@ public:
     assert(hiBit <= numBits && "hiBit out of range");
     assert(loBit < numBits && "loBit out of range");
     if (hiBit < loBit)
-      return getLowBitsSet(numBits, hiBit) |
-             getHighBitsSet(numBits, numBits - loBit);
+      return getLowBitsSet(numBits, hiBit)
+          .Or(getHighBitsSet(numBits, numBits - loBit));
     return getLowBitsSet(numBits, hiBit - loBit).shl(loBit);
   }
 
@@ -593,7 +602,13 @@ public:
   /// \brief Prefix increment operator.
   ///
   /// \returns *this incremented by one
-  APInt &operator++();
+  APInt &operator++() {
+    if (isSingleWord()) {
+      ++VAL;
+      return clearUnusedBits();
+    }
+    return AddAssignSlowCase(1);
+  }
 
   /// \brief Postfix decrement operator.
   ///
@@ -607,29 +622,12 @@ public:
   /// \brief Prefix decrement operator.
   ///
   /// \returns *this decremented by one.
-  APInt &operator--();
-
-  /// \brief Unary bitwise complement operator.
-  ///
-  /// Performs a bitwise complement operation on this APInt.
-  ///
-  /// \returns an APInt that is the bitwise complement of *this
-  APInt operator~() const {
-    APInt Result(*this);
-    Result.flipAllBits();
-    return Result;
-  }
-
-  /// \brief Unary negation operator
-  ///
-  /// Negates *this using two's complement logic.
-  ///
-  /// \returns An APInt value representing the negation of *this.
-  APInt operator-() const {
-    APInt Result(*this);
-    Result.flipAllBits();
-    ++Result;
-    return Result;
+  APInt &operator--() {
+    if (isSingleWord()) {
+      --VAL;
+      return clearUnusedBits();
+    }
+    return SubAssignSlowCase(1);
   }
 
   /// \brief Logical negation operator.
@@ -704,7 +702,14 @@ public:
   /// assigned to *this.
   ///
   /// \returns *this after ANDing with RHS.
-  APInt &operator&=(const APInt &RHS);
+  APInt &operator&=(const APInt &RHS) {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord()) {
+      VAL &= RHS.VAL;
+      return *this;
+    }
+    return AndAssignSlowCase(RHS);
+  }
 
   /// \brief Bitwise OR assignment operator.
   ///
@@ -712,7 +717,14 @@ public:
   /// assigned *this;
   ///
   /// \returns *this after ORing with RHS.
-  APInt &operator|=(const APInt &RHS);
+  APInt &operator|=(const APInt &RHS) {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord()) {
+      VAL |= RHS.VAL;
+      return *this;
+    }
+    return OrAssignSlowCase(RHS);
+  }
 
   /// \brief Bitwise OR assignment operator.
   ///
@@ -735,7 +747,14 @@ public:
   /// assigned to *this.
   ///
   /// \returns *this after XORing with RHS.
-  APInt &operator^=(const APInt &RHS);
+  APInt &operator^=(const APInt &RHS) {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord()) {
+      VAL ^= RHS.VAL;
+      return clearUnusedBits();
+    }
+    return XorAssignSlowCase(RHS);
+  }
 
   /// \brief Multiplication assignment operator.
   ///
@@ -749,14 +768,42 @@ public:
   /// Adds RHS to *this and assigns the result to *this.
   ///
   /// \returns *this
-  APInt &operator+=(const APInt &RHS);
+  APInt &operator+=(const APInt &RHS) {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord()) {
+      VAL += RHS.VAL;
+      return clearUnusedBits();
+    }
+    return AddAssignSlowCase(RHS);
+  }
+  APInt &operator+=(uint64_t RHS) {
+    if (isSingleWord()) {
+      VAL += RHS;
+      return clearUnusedBits();
+    }
+    return AddAssignSlowCase(RHS);
+  }
 
   /// \brief Subtraction assignment operator.
   ///
   /// Subtracts RHS from *this and assigns the result to *this.
   ///
   /// \returns *this
-  APInt &operator-=(const APInt &RHS);
+  APInt &operator-=(const APInt &RHS) {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord()) {
+      VAL -= RHS.VAL;
+      return clearUnusedBits();
+    }
+    return SubAssignSlowCase(RHS);
+  }
+  APInt &operator-=(uint64_t RHS) {
+    if (isSingleWord()) {
+      VAL -= RHS;
+      return clearUnusedBits();
+    }
+    return SubAssignSlowCase(RHS);
+  }
 
   /// \brief Left-shift assignment function.
   ///
@@ -772,82 +819,26 @@ public:
   /// \name Binary Operators
   /// @{
 
-  /// \brief Bitwise AND operator.
-  ///
-  /// Performs a bitwise AND operation on *this and RHS.
+  /// \brief Bitwise AND function.
   ///
   /// \returns An APInt value representing the bitwise AND of *this and RHS.
-  APInt operator&(const APInt &RHS) const {
-    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
-    if (isSingleWord())
-      return APInt(getBitWidth(), VAL & RHS.VAL);
-    return AndSlowCase(RHS);
-  }
-  APInt LLVM_ATTRIBUTE_UNUSED_RESULT And(const APInt &RHS) const {
-    return this->operator&(RHS);
-  }
-
-  /// \brief Bitwise OR operator.
-  ///
-  /// Performs a bitwise OR operation on *this and RHS.
-  ///
-  /// \returns An APInt value representing the bitwise OR of *this and RHS.
-  APInt operator|(const APInt &RHS) const {
-    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
-    if (isSingleWord())
-      return APInt(getBitWidth(), VAL | RHS.VAL);
-    return OrSlowCase(RHS);
-  }
+  APInt LLVM_ATTRIBUTE_UNUSED_RESULT And(const APInt &RHS) const;
 
   /// \brief Bitwise OR function.
   ///
-  /// Performs a bitwise or on *this and RHS. This is implemented by simply
-  /// calling operator|.
-  ///
   /// \returns An APInt value representing the bitwise OR of *this and RHS.
-  APInt LLVM_ATTRIBUTE_UNUSED_RESULT Or(const APInt &RHS) const {
-    return this->operator|(RHS);
-  }
-
-  /// \brief Bitwise XOR operator.
-  ///
-  /// Performs a bitwise XOR operation on *this and RHS.
-  ///
-  /// \returns An APInt value representing the bitwise XOR of *this and RHS.
-  APInt operator^(const APInt &RHS) const {
-    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
-    if (isSingleWord())
-      return APInt(BitWidth, VAL ^ RHS.VAL);
-    return XorSlowCase(RHS);
-  }
+  APInt LLVM_ATTRIBUTE_UNUSED_RESULT Or(const APInt &RHS) const;
 
   /// \brief Bitwise XOR function.
   ///
-  /// Performs a bitwise XOR operation on *this and RHS. This is implemented
-  /// through the usage of operator^.
-  ///
   /// \returns An APInt value representing the bitwise XOR of *this and RHS.
-  APInt LLVM_ATTRIBUTE_UNUSED_RESULT Xor(const APInt &RHS) const {
-    return this->operator^(RHS);
-  }
+  APInt LLVM_ATTRIBUTE_UNUSED_RESULT Xor(const APInt &RHS) const;
 
   /// \brief Multiplication operator.
   ///
   /// Multiplies this APInt by RHS and returns the result.
   APInt operator*(const APInt &RHS) const;
 
-  /// \brief Addition operator.
-  ///
-  /// Adds RHS to this APInt and returns the result.
-  APInt operator+(const APInt &RHS) const;
-  APInt operator+(uint64_t RHS) const;
-
-  /// \brief Subtraction operator.
-  ///
-  /// Subtracts RHS from this APInt and returns the result.
-  APInt operator-(const APInt &RHS) const;
-  APInt operator-(uint64_t RHS) const;
-
   /// \brief Left logical shift operator.
   ///
   /// Shifts this APInt left by \p Bits and returns the result.
@@ -1168,7 +1159,7 @@ public:
 
   /// This operation tests if there are any pairs of corresponding bits
   /// between this APInt and RHS that are both set.
-  bool intersects(const APInt &RHS) const { return (*this & RHS) != 0; }
+  bool intersects(const APInt &RHS) const { return And(RHS) != 0; }
 
   /// @}
   /// \name Resizing Operators
@@ -1532,7 +1523,9 @@ public:
 
   /// \returns the ceil log base 2 of this APInt.
   unsigned ceilLogBase2() const {
-    return BitWidth - (*this - 1).countLeadingZeros();
+    APInt Tmp(*this);
+    --Tmp;
+    return BitWidth - Tmp.countLeadingZeros();
   }
 
   /// \returns the nearest log base 2 of this APInt. Ties round up.
@@ -1579,9 +1572,12 @@ public:
   ///
   /// If *this is < 0 then return -(*this), otherwise *this;
   APInt LLVM_ATTRIBUTE_UNUSED_RESULT abs() const {
-    if (isNegative())
-      return -(*this);
-    return *this;
+    APInt Result(*this);
+    if (isNegative()) {
+      Result.flipAllBits();
+      ++Result;
+    }
+    return Result;
   }
 
   /// \returns the multiplicative inverse for a given modulo.
@@ -1750,6 +1746,99 @@ inline raw_ostream &operator<<(raw_ostream &OS, const APInt &I) {
   return OS;
 }
 
+/// \brief Unary bitwise complement operator.
+///
+/// \returns an APInt that is the bitwise complement of \p V. The storage of
+/// \p V is reused when it is a temporary.
+inline APInt operator~(APInt V) {
+  V.flipAllBits();
+  return V;
+}
+
+/// \brief Unary negation operator.
+///
+/// \returns the two's complement negation of \p V. The storage of \p V is
+/// reused when it is a temporary.
+inline APInt operator-(APInt V) {
+  V.flipAllBits();
+  ++V;
+  return V;
+}
+
+// The binary operators below take their left operand by value and have an
+// overload taking the right operand as an rvalue reference, so that chains of
+// arithmetic on wide values update an existing temporary in place instead of
+// allocating a fresh buffer for every intermediate result.
+
+inline APInt operator&(APInt LHS, const APInt &RHS) {
+  LHS &= RHS;
+  return LHS;
+}
+
+inline APInt operator&(const APInt &LHS, APInt &&RHS) {
+  RHS &= LHS;
+  return std::move(RHS);
+}
+
+inline APInt operator|(APInt LHS, const APInt &RHS) {
+  LHS |= RHS;
+  return LHS;
+}
+
+inline APInt operator|(const APInt &LHS, APInt &&RHS) {
+  RHS |= LHS;
+  return std::move(RHS);
+}
+
+inline APInt operator^(APInt LHS, const APInt &RHS) {
+  LHS ^= RHS;
+  return LHS;
+}
+
+inline APInt operator^(const APInt &LHS, APInt &&RHS) {
+  RHS ^= LHS;
+  return std::move(RHS);
+}
+
+inline APInt operator+(APInt LHS, const APInt &RHS) {
+  LHS += RHS;
+  return LHS;
+}
+
+inline APInt operator+(const APInt &LHS, APInt &&RHS) {
+  RHS += LHS;
+  return std::move(RHS);
+}
+
+inline APInt operator+(APInt LHS, uint64_t RHS) {
+  LHS += RHS;
+  return LHS;
+}
+
+inline APInt operator-(APInt LHS, const APInt &RHS) {
+  LHS -= RHS;
+  return LHS;
+}
+
+inline APInt operator-(const APInt &LHS, APInt &&RHS) {
+  // LHS - RHS == -RHS + LHS.
+  RHS.flipAllBits();
+  ++RHS;
+  RHS += LHS;
+  return std::move(RHS);
+}
+
+inline APInt operator-(APInt LHS, uint64_t RHS) {
+  LHS -= RHS;
+  return LHS;
+}
+
+inline APInt APInt::And(const APInt &RHS) const { return *this & RHS; }
+
+inline APInt APInt::Or(const APInt &RHS) const { return *this | RHS; }
+
+inline APInt APInt::Xor(const APInt &RHS) const { return *this ^ RHS; }
+
 namespace APIntOps {
 
 /// \brief Determine the smaller of two APInts considered to be signed.
@@ -45,6 +45,9 @@ private:
   /// since we always reduce following a success.
   std::set<changeset_ty> FailedTestsCache;
 
+  /// The number of tests which may be executed at once.
+  unsigned NumThreads = 1;
+
   /// GetTestResult - Get the test result for the \p Changes from the
   /// cache, executing the test if necessary.
   ///
@@ -52,6 +55,11 @@ private:
   /// \return - The test result.
   bool GetTestResult(const changeset_ty &Changes);
 
+  /// GetTestResults - Get the test results for each of \p Batch from the
+  /// cache, executing up to NumThreads of the uncached tests concurrently.
+  void GetTestResults(const changesetlist_ty &Batch,
+                      std::vector<bool> &Results);
+
   /// Split - Partition a set of changes \p S into one or two subsets.
   void Split(const changeset_ty &S, changesetlist_ty &Res);
 
@@ -82,6 +90,15 @@ protected:
 public:
   virtual ~DeltaAlgorithm();
 
+  /// setNumThreads - Allow up to \p N tests to be executed concurrently.
+  ///
+  /// The candidate subsets are then tested \p N at a time, and the first
+  /// passing one in the usual order is taken, so the result is the same as
+  /// with one thread. Some tests may be executed which the sequential search
+  /// would have skipped. With more than one thread, ExecuteOneTest must be
+  /// safe to call from several threads at once.
+  void setNumThreads(unsigned N) { NumThreads = N ? N : 1; }
+
   /// Run - Minimize the set \p Changes by executing \see ExecuteOneTest() on
   /// subsets of changes and returning the smallest set which still satisfies
   /// the test predicate.
@@ -280,15 +280,26 @@ template<typename T, typename Ctx> struct ContextualFoldingSetTrait
 /// allocation means it requires a non-trivial destructor call.
 class FoldingSetNodeIDRef {
   const unsigned *Data;
-  size_t Size;
+  unsigned Size;
+  /// The hash of the data once it has been computed, or zero.  Nodes that
+  /// keep a reference to their interned profile use it to reject mismatches
+  /// and to rehash without touching the data again.
+  mutable unsigned Hash;
+
+  unsigned ComputeHashSlowCase() const;
 
 public:
-  FoldingSetNodeIDRef() : Data(nullptr), Size(0) {}
-  FoldingSetNodeIDRef(const unsigned *D, size_t S) : Data(D), Size(S) {}
+  FoldingSetNodeIDRef() : Data(nullptr), Size(0), Hash(0) {}
+  FoldingSetNodeIDRef(const unsigned *D, size_t S)
+      : Data(D), Size(S), Hash(0) {}
 
   /// ComputeHash - Compute a strong hash value for this FoldingSetNodeIDRef,
   /// used to lookup the node in the FoldingSetImpl.
-  unsigned ComputeHash() const;
+  unsigned ComputeHash() const {
+    if (!Hash)
+      Hash = ComputeHashSlowCase();
+    return Hash;
+  }
 
   bool operator==(FoldingSetNodeIDRef) const;
 
@@ -101,6 +101,7 @@ public:
       V[Index] = T();
       Index = (ptrdiff_t)V.size();
       V.push_back(X);
+      compactIfSparse();
     }
     return false;
   }
@@ -123,7 +124,8 @@ public:
 
   /// Erase an item from the worklist.
   ///
-  /// Note that this is constant time due to the nature of the worklist implementation.
+  /// Note that this is amortized constant time due to the nature of the
+  /// worklist implementation.
   bool erase(const T& X) {
     auto I = M.find(X);
     if (I == M.end())
@@ -138,6 +140,7 @@ public:
       V[I->second] = T();
     }
     M.erase(I);
+    compactIfSparse();
     return true;
   }
 
@@ -174,6 +177,18 @@ public:
   }
 
 private:
+  /// Drop the null entries left behind by re-insertion and erasure once they
+  /// make up most of the vector. Without this, a worklist whose elements are
+  /// re-prioritized over and over grows without bound and pop_back has to
+  /// skip ever longer runs of nulls.
+  void compactIfSparse() {
+    if (V.size() < 4 * M.size() + 64)
+      return;
+    V.erase(std::remove(V.begin(), V.end(), T()), V.end());
+    for (ptrdiff_t I = 0, E = V.size(); I != E; ++I)
+      M.find(V[I])->second = I;
+  }
+
   /// A wrapper predicate designed for use with std::remove_if.
   ///
   /// This predicate wraps a predicate suitable for use with std::remove_if to
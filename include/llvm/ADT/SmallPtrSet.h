@@ -41,11 +41,13 @@ class SmallPtrSetIteratorImpl;
 /// sets are often small.  In this case, no memory allocation is used, and only
 /// light-weight and cache-efficient scanning is used.
 ///
-/// Large sets use a classic exponentially-probed hash table.  Empty buckets are
-/// represented with an illegal pointer value (-1) to allow null pointers to be
-/// inserted.  Tombstones are represented with another illegal pointer value
-/// (-2), to allow deletion.  The hash table is resized when the table is 3/4 or
-/// more.  When this happens, the table is doubled in size.
+/// Large sets use a classic quadratically-probed hash table, indexed by a
+/// multiplicative hash of the pointer so that pointers with common alignment
+/// do not cluster in a few buckets.  Empty buckets are represented with an
+/// illegal pointer value (-1) to allow null pointers to be inserted.
+/// Tombstones are represented with another illegal pointer value (-2), to
+/// allow deletion.  The hash table is resized when the table is 3/4 or more.
+/// When this happens, the table is doubled in size.
 ///
 class SmallPtrSetImplBase {
   friend class SmallPtrSetIteratorImpl;
@@ -0,0 +1,322 @@
+//===--- SwissStringMap.h - Group-probed string hash table ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SwissStringMap class, an open-addressing variant of
+// StringMap that keeps one control byte per bucket and probes a whole group
+// of buckets at a time, using SSE2 or NEON where available.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_SWISSSTRINGMAP_H
+#define LLVM_ADT_SWISSSTRINGMAP_H
+
+#include "llvm/ADT/StringMap.h"
+
+namespace llvm {
+
+/// SwissStringMapImpl - This is the base class of SwissStringMap that is
+/// shared among all of its instantiations.
+class SwissStringMapImpl {
+protected:
+  // Array of NumBuckets pointers to entries, null pointers are holes and
+  // StringMapImpl::getTombstoneVal() marks removed entries, exactly as in
+  // StringMap, so that StringMapIterator can walk it. TheTable[NumBuckets]
+  // contains a sentinel value for easy iteration. It is followed by an array
+  // of the full hash values as unsigned integers, and then by one control
+  // byte per bucket (plus a copy of the first group's bytes, so that a group
+  // can be loaded starting at any bucket).
+  StringMapEntryBase **TheTable;
+  unsigned NumBuckets;
+  unsigned NumItems;
+  unsigned NumTombstones;
+  unsigned ItemSize;
+
+protected:
+  explicit SwissStringMapImpl(unsigned itemSize)
+      : TheTable(nullptr), NumBuckets(0), NumItems(0), NumTombstones(0),
+        ItemSize(itemSize) {}
+  SwissStringMapImpl(SwissStringMapImpl &&RHS)
+      : TheTable(RHS.TheTable), NumBuckets(RHS.NumBuckets),
+        NumItems(RHS.NumItems), NumTombstones(RHS.NumTombstones),
+        ItemSize(RHS.ItemSize) {
+    RHS.TheTable = nullptr;
+    RHS.NumBuckets = 0;
+    RHS.NumItems = 0;
+    RHS.NumTombstones = 0;
+  }
+
+  SwissStringMapImpl(unsigned InitSize, unsigned ItemSize);
+  unsigned RehashTable(unsigned BucketNo = 0);
+
+  /// LookupBucketFor - Look up the bucket that the specified string should end
+  /// up in.  If it already exists as a key in the map, the Item pointer for the
+  /// specified bucket will be non-null.  Otherwise, it will be null or a
+  /// tombstone, and the bucket is claimed for the key: the caller must store
+  /// the new entry in it.
+  unsigned LookupBucketFor(StringRef Key);
+
+  /// FindKey - Look up the bucket that contains the specified key. If it exists
+  /// in the map, return the bucket number of the key.  Otherwise return -1.
+  /// This does not modify the map.
+  int FindKey(StringRef Key) const;
+
+  /// RemoveKey - Remove the specified StringMapEntry from the table, but do not
+  /// delete it.  This aborts if the value isn't in the table.
+  void RemoveKey(StringMapEntryBase *V);
+
+  /// RemoveKey - Remove the StringMapEntry for the specified key from the
+  /// table, returning it.  If the key is not in the table, this returns null.
+  StringMapEntryBase *RemoveKey(StringRef Key);
+
+  /// Allocate the table with the specified number of buckets and otherwise
+  /// setup the map as empty.
+  void init(unsigned Size);
+
+  /// Mark every bucket as empty without touching the entries.
+  void resetBuckets();
+
+  /// Make this table an exact copy of the layout of \p RHS, with null entry
+  /// pointers in place of its live entries.
+  void copyLayoutFrom(const SwissStringMapImpl &RHS);
+
+public:
+  unsigned getNumBuckets() const { return NumBuckets; }
+  unsigned getNumItems() const { return NumItems; }
+
+  bool empty() const { return NumItems == 0; }
+  unsigned size() const { return NumItems; }
+
+  void swap(SwissStringMapImpl &Other) {
+    std::swap(TheTable, Other.TheTable);
+    std::swap(NumBuckets, Other.NumBuckets);
+    std::swap(NumItems, Other.NumItems);
+    std::swap(NumTombstones, Other.NumTombstones);
+  }
+};
+
+/// SwissStringMap - A drop-in replacement for StringMap with a faster lookup
+/// for large tables. Entries are the same StringMapEntry objects, with the
+/// key stored right after the value in a single allocation, and iterators are
+/// StringMap iterators. Only the probing differs: a lookup compares a whole
+/// group of control bytes against a 7-bit tag of the hash at once, and only
+/// looks at the full hash and key of the buckets whose tag matched.
+template<typename ValueTy, typename AllocatorTy = MallocAllocator>
+class SwissStringMap : public SwissStringMapImpl {
+  AllocatorTy Allocator;
+
+public:
+  typedef StringMapEntry<ValueTy> MapEntryTy;
+
+  SwissStringMap()
+      : SwissStringMapImpl(static_cast<unsigned>(sizeof(MapEntryTy))) {}
+  explicit SwissStringMap(unsigned InitialSize)
+      : SwissStringMapImpl(InitialSize,
+                           static_cast<unsigned>(sizeof(MapEntryTy))) {}
+
+  explicit SwissStringMap(AllocatorTy A)
+      : SwissStringMapImpl(static_cast<unsigned>(sizeof(MapEntryTy))),
+        Allocator(A) {}
+
+  SwissStringMap(unsigned InitialSize, AllocatorTy A)
+      : SwissStringMapImpl(InitialSize,
+                           static_cast<unsigned>(sizeof(MapEntryTy))),
+        Allocator(A) {}
+
+  SwissStringMap(std::initializer_list<std::pair<StringRef, ValueTy>> List)
+      : SwissStringMapImpl(List.size(),
+                           static_cast<unsigned>(sizeof(MapEntryTy))) {
+    for (const auto &P : List) {
+      insert(P);
+    }
+  }
+
+  SwissStringMap(SwissStringMap &&RHS)
+      : SwissStringMapImpl(std::move(RHS)),
+        Allocator(std::move(RHS.Allocator)) {}
+
+  SwissStringMap &operator=(SwissStringMap RHS) {
+    SwissStringMapImpl::swap(RHS);
+    std::swap(Allocator, RHS.Allocator);
+    return *this;
+  }
+
+  SwissStringMap(const SwissStringMap &RHS)
+      : SwissStringMapImpl(static_cast<unsigned>(sizeof(MapEntryTy))),
+        Allocator(RHS.Allocator) {
+    if (RHS.empty())
+      return;
+
+    // Copy the buckets, hashes and control bytes as they are, tombstones
+    // included, so that nothing needs to be probed again.
+    copyLayoutFrom(RHS);
+    for (unsigned I = 0, E = NumBuckets; I != E; ++I) {
+      StringMapEntryBase *Bucket = RHS.TheTable[I];
+      if (!Bucket || Bucket == StringMapImpl::getTombstoneVal()) {
+        TheTable[I] = Bucket;
+        continue;
+      }
+
+      TheTable[I] = MapEntryTy::Create(
+          static_cast<MapEntryTy *>(Bucket)->getKey(), Allocator,
+          static_cast<MapEntryTy *>(Bucket)->getValue());
+    }
+  }
+
+  AllocatorTy &getAllocator() { return Allocator; }
+  const AllocatorTy &getAllocator() const { return Allocator; }
+
+  typedef const char* key_type;
+  typedef ValueTy mapped_type;
+  typedef StringMapEntry<ValueTy> value_type;
+  typedef size_t size_type;
+
+  typedef StringMapConstIterator<ValueTy> const_iterator;
+  typedef StringMapIterator<ValueTy> iterator;
+
+  iterator begin() {
+    return iterator(TheTable, NumBuckets == 0);
+  }
+  iterator end() {
+    return iterator(TheTable+NumBuckets, true);
+  }
+  const_iterator begin() const {
+    return const_iterator(TheTable, NumBuckets == 0);
+  }
+  const_iterator end() const {
+    return const_iterator(TheTable+NumBuckets, true);
+  }
+
+  iterator find(StringRef Key) {
+    int Bucket = FindKey(Key);
+    if (Bucket == -1) return end();
+    return iterator(TheTable+Bucket, true);
+  }
+
+  const_iterator find(StringRef Key) const {
+    int Bucket = FindKey(Key);
+    if (Bucket == -1) return end();
+    return const_iterator(TheTable+Bucket, true);
+  }
+
+  /// lookup - Return the entry for the specified key, or a default
+  /// constructed value if no such entry exists.
+  ValueTy lookup(StringRef Key) const {
+    const_iterator it = find(Key);
+    if (it != end())
+      return it->second;
+    return ValueTy();
+  }
+
+  /// Lookup the ValueTy for the \p Key, or create a default constructed value
+  /// if the key is not in the map.
+  ValueTy &operator[](StringRef Key) {
+    return emplace_second(Key).first->second;
+  }
+
+  /// count - Return 1 if the element is in the map, 0 otherwise.
+  size_type count(StringRef Key) const {
+    return find(Key) == end() ? 0 : 1;
+  }
+
+  /// insert - Insert the specified key/value pair into the map.  If the key
+  /// already exists in the map, return false and ignore the request, otherwise
+  /// insert it and return true.
+  bool insert(MapEntryTy *KeyValue) {
+    unsigned BucketNo = LookupBucketFor(KeyValue->getKey());
+    StringMapEntryBase *&Bucket = TheTable[BucketNo];
+    if (Bucket && Bucket != StringMapImpl::getTombstoneVal())
+      return false;  // Already exists in map.
+
+    if (Bucket == StringMapImpl::getTombstoneVal())
+      --NumTombstones;
+    Bucket = KeyValue;
+    ++NumItems;
+    assert(NumItems + NumTombstones <= NumBuckets);
+
+    RehashTable();
+    return true;
+  }
+
+  /// insert - Inserts the specified key/value pair into the map if the key
+  /// isn't already in the map. The bool component of the returned pair is true
+  /// if and only if the insertion takes place, and the iterator component of
+  /// the pair points to the element with key equivalent to the key of the pair.
+  std::pair<iterator, bool> insert(std::pair<StringRef, ValueTy> KV) {
+    return emplace_second(KV.first, std::move(KV.second));
+  }
+
+  /// Emplace a new element for the specified key into the map if the key isn't
+  /// already in the map. The bool component of the returned pair is true
+  /// if and only if the insertion takes place, and the iterator component of
+  /// the pair points to the element with key equivalent to the key of the pair.
+  template <typename... ArgsTy>
+  std::pair<iterator, bool> emplace_second(StringRef Key, ArgsTy &&... Args) {
+    unsigned BucketNo = LookupBucketFor(Key);
+    StringMapEntryBase *&Bucket = TheTable[BucketNo];
+    if (Bucket && Bucket != StringMapImpl::getTombstoneVal())
+      return std::make_pair(iterator(TheTable + BucketNo, false),
+                            false); // Already exists in map.
+
+    if (Bucket == StringMapImpl::getTombstoneVal())
+      --NumTombstones;
+    Bucket = MapEntryTy::Create(Key, Allocator, std::forward<ArgsTy>(Args)...);
+    ++NumItems;
+    assert(NumItems + NumTombstones <= NumBuckets);
+
+    BucketNo = RehashTable(BucketNo);
+    return std::make_pair(iterator(TheTable + BucketNo, false), true);
+  }
+
+  // clear - Empties out the SwissStringMap
+  void clear() {
+    if (empty()) return;
+
+    for (unsigned I = 0, E = NumBuckets; I != E; ++I) {
+      StringMapEntryBase *Bucket = TheTable[I];
+      if (Bucket && Bucket != StringMapImpl::getTombstoneVal())
+        static_cast<MapEntryTy*>(Bucket)->Destroy(Allocator);
+    }
+    resetBuckets();
+  }
+
+  /// remove - Remove the specified key/value pair from the map, but do not
+  /// erase it.  This aborts if the key is not in the map.
+  void remove(MapEntryTy *KeyValue) {
+    RemoveKey(KeyValue);
+  }
+
+  void erase(iterator I) {
+    MapEntryTy &V = *I;
+    remove(&V);
+    V.Destroy(Allocator);
+  }
+
+  bool erase(StringRef Key) {
+    iterator I = find(Key);
+    if (I == end()) return false;
+    erase(I);
+    return true;
+  }
+
+  ~SwissStringMap() {
+    if (!empty()) {
+      for (unsigned I = 0, E = NumBuckets; I != E; ++I) {
+        StringMapEntryBase *Bucket = TheTable[I];
+        if (Bucket && Bucket != StringMapImpl::getTombstoneVal()) {
+          static_cast<MapEntryTy*>(Bucket)->Destroy(Allocator);
+        }
+      }
+    }
+    free(TheTable);
+  }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_SWISSSTRINGMAP_H
@@ -38,6 +38,7 @@
 #ifndef LLVM_ANALYSIS_ALIASANALYSIS_H
 #define LLVM_ANALYSIS_ALIASANALYSIS_H
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/PassManager.h"
@@ -182,6 +183,10 @@ public:
   /// alias analysis implementations.
   AliasResult alias(const MemoryLocation &LocA, const MemoryLocation &LocB);
 
+  /// Query whether each of \p Locs aliases \p Loc, as one batch.
+  SmallVector<AliasResult, 8> alias(ArrayRef<MemoryLocation> Locs,
+                                    const MemoryLocation &Loc);
+
   /// A convenience wrapper around the primary \c alias interface.
   AliasResult alias(const Value *V1, uint64_t V1Size, const Value *V2,
                     uint64_t V2Size) {
@@ -549,6 +554,30 @@ public:
     return canInstructionRangeModRef(I1, I2, MemoryLocation(Ptr, Size), Mode);
   }
 
+  //===--------------------------------------------------------------------===//
+  /// \name Batches of queries
+  /// @{
+
+  /// Tell the alias analyses that the IR won't change until the matching
+  /// \c endBatch, so that they may keep what they compute for one query to
+  /// answer the following ones. Batches may nest.
+  void beginBatch();
+
+  /// End the batch started by the matching \c beginBatch.
+  void endBatch();
+
+  /// A scope in which the IR doesn't change, during which the queries form a
+  /// batch.
+  class BatchQueryScope {
+    AAResults &AAR;
+
+  public:
+    explicit BatchQueryScope(AAResults &AAR) : AAR(AAR) { AAR.beginBatch(); }
+    ~BatchQueryScope() { AAR.endBatch(); }
+  };
+
+  /// @}
+
 private:
   class Concept;
   template <typename T> class Model;
@@ -627,6 +656,14 @@ public:
   virtual ModRefInfo getModRefInfo(ImmutableCallSite CS1,
                                    ImmutableCallSite CS2) = 0;
 
+  /// @}
+  //===--------------------------------------------------------------------===//
+  /// \name Batches of queries
+  /// @{
+
+  virtual void beginBatch() = 0;
+  virtual void endBatch() = 0;
+
   /// @}
 };
 
@@ -678,6 +715,10 @@ public:
                            ImmutableCallSite CS2) override {
     return Result.getModRefInfo(CS1, CS2);
   }
+
+  void beginBatch() override { Result.beginBatch(); }
+
+  void endBatch() override { Result.endBatch(); }
 };
 
 /// A CRTP-driven "mixin" base class to help implement the function alias
@@ -800,6 +841,10 @@ public:
   ModRefInfo getModRefInfo(ImmutableCallSite CS1, ImmutableCallSite CS2) {
     return MRI_ModRef;
   }
+
+  void beginBatch() {}
+
+  void endBatch() {}
 };
 
 
@@ -74,6 +74,14 @@ public:
     Scanned = false;
   }
 
+  /// \brief The cache is never invalidated by changes to the function body.
+  ///
+  /// Deleted assumptions drop out through their weak handles, and passes which
+  /// create new ones register them, just as with the legacy
+  /// \c AssumptionCacheTracker. Keeping the cache also keeps the analyses which
+  /// hold references to it valid.
+  bool invalidate(Function &, const PreservedAnalyses &) { return false; }
+
   /// \brief Access the list of assumption handles currently tracked for this
   /// function.
   ///
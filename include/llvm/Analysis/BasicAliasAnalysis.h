@@ -14,6 +14,7 @@
 #ifndef LLVM_ANALYSIS_BASICALIASANALYSIS_H
 #define LLVM_ANALYSIS_BASICALIASANALYSIS_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/AssumptionCache.h"
@@ -82,6 +83,16 @@ public:
   /// call site is not known.
   FunctionModRefBehavior getModRefBehavior(const Function *F);
 
+  /// Start caching the decomposed GEPs until the matching endBatch.
+  void beginBatch() { ++BatchDepth; }
+
+  /// Drop the decomposed GEPs at the end of the outermost batch.
+  void endBatch() {
+    assert(BatchDepth && "endBatch without beginBatch!");
+    if (--BatchDepth == 0)
+      DecomposedGEPCache.clear();
+  }
+
 private:
   // A linear transformation of a Value; this class represents ZExt(SExt(V,
   // SExtBits), ZExtBits) * Scale + Offset.
@@ -147,6 +158,13 @@ private:
   /// Tracks instructions visited by pointsToConstantMemory.
   SmallPtrSet<const Value *, 16> Visited;
 
+  /// The number of batches of queries in progress.
+  unsigned BatchDepth = 0;
+
+  /// During a batch, the decomposition of the pointers queried so far, and
+  /// whether it reached the search depth limit.
+  DenseMap<const Value *, std::pair<DecomposedGEP, bool>> DecomposedGEPCache;
+
   static const Value *
   GetLinearExpression(const Value *V, APInt &Scale, APInt &Offset,
                       unsigned &ZExtBits, unsigned &SExtBits,
@@ -156,6 +174,9 @@ private:
   static bool DecomposeGEPExpression(const Value *V, DecomposedGEP &Decomposed,
       const DataLayout &DL, AssumptionCache *AC, DominatorTree *DT);
 
+  /// DecomposeGEPExpression, through the cache during a batch.
+  bool decomposeGEPExpression(const Value *V, DecomposedGEP &Decomposed);
+
   static bool isGEPBaseAtNegativeOffset(const GEPOperator *GEPOp,
       const DecomposedGEP &DecompGEP, const DecomposedGEP &DecompObject,
       uint64_t ObjectAccessSize);
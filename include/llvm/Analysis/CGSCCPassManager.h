@@ -63,6 +63,14 @@ typedef OuterAnalysisManagerProxy<ModuleAnalysisManager, LazyCallGraph::SCC>
 /// \c CGSCCAnalysisManagerModuleProxy analysis prior to running the CGSCC
 /// pass over the module to enable a \c FunctionAnalysisManager to be used
 /// within this run safely.
+///
+/// The SCCs are visited one at a time, even when they don't call each other.
+/// Transforming two of them at once would race on the constants and globals
+/// they share through the module's \c LLVMContext, on the use lists of the
+/// functions they reference, and on the caches of the analysis managers. Each
+/// pass may also update the call graph, which changes which SCCs are still
+/// independent. To use several threads, split the module and optimize the
+/// parts in separate contexts instead.
 template <typename CGSCCPassT>
 class ModuleToPostOrderCGSCCPassAdaptor
     : public PassInfoMixin<ModuleToPostOrderCGSCCPassAdaptor<CGSCCPassT>> {
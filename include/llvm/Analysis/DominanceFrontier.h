@@ -141,6 +141,10 @@ public:
   typedef DominanceFrontierBase<BasicBlock>::DomSetType DomSetType;
   typedef DominanceFrontierBase<BasicBlock>::iterator iterator;
   typedef DominanceFrontierBase<BasicBlock>::const_iterator const_iterator;
+
+  /// \brief Handle invalidation explicitly, keeping the frontiers across
+  /// passes which preserve \c CFGAnalyses.
+  bool invalidate(Function &F, const PreservedAnalyses &PA);
 };
 
 class DominanceFrontierWrapperPass : public FunctionPass {
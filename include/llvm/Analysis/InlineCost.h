@@ -20,6 +20,7 @@
 
 namespace llvm {
 class AssumptionCacheTracker;
+class BlockFrequencyInfo;
 class CallSite;
 class DataLayout;
 class Function;
@@ -108,11 +109,16 @@ public:
 /// used to bound the computation necessary to determine whether the cost is
 /// sufficiently low to warrant inlining.
 ///
+/// If \p CallerBFI is given, the profile count it estimates for the callsite
+/// also adjusts the threshold: hot callsites get -hot-callsite-threshold and
+/// cold ones -inline-cold-callsite-threshold.
+///
 /// Also note that calling this function *dynamically* computes the cost of
 /// inlining the callsite. It is an expensive, heavyweight call.
 InlineCost getInlineCost(CallSite CS, int DefaultThreshold,
                          TargetTransformInfo &CalleeTTI,
-                         AssumptionCacheTracker *ACT, ProfileSummaryInfo *PSI);
+                         AssumptionCacheTracker *ACT, ProfileSummaryInfo *PSI,
+                         BlockFrequencyInfo *CallerBFI = nullptr);
 
 /// \brief Get an InlineCost with the callee explicitly specified.
 /// This allows you to calculate the cost of inlining a function via a
@@ -121,7 +127,8 @@ InlineCost getInlineCost(CallSite CS, int DefaultThreshold,
 //
 InlineCost getInlineCost(CallSite CS, Function *Callee, int DefaultThreshold,
                          TargetTransformInfo &CalleeTTI,
-                         AssumptionCacheTracker *ACT, ProfileSummaryInfo *PSI);
+                         AssumptionCacheTracker *ACT, ProfileSummaryInfo *PSI,
+                         BlockFrequencyInfo *CallerBFI = nullptr);
 
 int computeThresholdFromOptLevels(unsigned OptLevel, unsigned SizeOptLevel);
 
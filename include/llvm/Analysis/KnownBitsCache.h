@@ -0,0 +1,94 @@
+//===- llvm/Analysis/KnownBitsCache.h - Memoized known bits -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a cache of the results of computeKnownBits and
+// ComputeNumSignBits for the instructions of a function, which a transform
+// can keep across its queries as long as it reports the instructions it
+// changes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ANALYSIS_KNOWNBITSCACHE_H
+#define LLVM_ANALYSIS_KNOWNBITSCACHE_H
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/ValueHandle.h"
+
+namespace llvm {
+
+/// \brief A cache of known bits and sign bits of instructions.
+///
+/// The ValueTracking queries that are given a cache look up and record the
+/// results of instructions in it, as long as they don't depend on the context
+/// instruction, that is when the function has no assumptions. A result
+/// computed at some depth answers the queries made at that depth or deeper,
+/// which explore less of the expression.
+///
+/// Deleting or replacing an instruction updates the cache by itself. An
+/// instruction that is changed in place, for example by setting an operand or
+/// a flag, must be passed to invalidate() by the transform that changed it.
+class KnownBitsCache {
+  class ValueHandle final : public CallbackVH {
+    KnownBitsCache *Cache;
+    void deleted() override;
+    void allUsesReplacedWith(Value *New) override;
+
+  public:
+    ValueHandle(Value *V, KnownBitsCache *Cache = nullptr)
+        : CallbackVH(V), Cache(Cache) {}
+  };
+
+  struct Entry {
+    APInt KnownZero, KnownOne;
+    /// The depth the known bits were computed at, or ~0U if they weren't.
+    unsigned KnownBitsDepth = ~0U;
+    unsigned NumSignBits = 0;
+    /// The depth the sign bits were computed at, or ~0U if they weren't.
+    unsigned NumSignBitsDepth = ~0U;
+  };
+
+  DenseMap<ValueHandle, Entry, DenseMapInfo<Value *>> Entries;
+
+  Entry &getEntry(const Value *V);
+
+public:
+  KnownBitsCache() = default;
+  KnownBitsCache(const KnownBitsCache &) = delete;
+  KnownBitsCache &operator=(const KnownBitsCache &) = delete;
+
+  /// Set \p KnownZero and \p KnownOne to the known bits of \p V recorded at \p
+  /// Depth or less, and return true, if there are any.
+  bool lookupKnownBits(const Value *V, unsigned Depth, APInt &KnownZero,
+                       APInt &KnownOne) const;
+
+  /// Record the known bits of \p V computed at \p Depth.
+  void insertKnownBits(const Value *V, unsigned Depth, const APInt &KnownZero,
+                       const APInt &KnownOne);
+
+  /// Set \p NumSignBits to the number of sign bits of \p V recorded at \p
+  /// Depth or less, and return true, if there is one.
+  bool lookupNumSignBits(const Value *V, unsigned Depth,
+                         unsigned &NumSignBits) const;
+
+  /// Record the number of sign bits of \p V computed at \p Depth.
+  void insertNumSignBits(const Value *V, unsigned Depth, unsigned NumSignBits);
+
+  /// Forget what is known about \p V, which has been changed in place, and
+  /// about the instructions whose results may have been derived from it.
+  void invalidate(const Value *V);
+
+  void clear() { Entries.clear(); }
+  bool empty() const { return Entries.empty(); }
+  unsigned size() const { return Entries.size(); }
+};
+
+} // end namespace llvm
+
+#endif
@@ -57,6 +57,11 @@ public:
     return *this;
   }
 
+  /// Handle invalidation explicitly. When the result was computed with a
+  /// dominator tree it holds on to it, and is invalidated along with it even
+  /// when a pass claims to preserve this analysis.
+  bool invalidate(Function &F, const PreservedAnalyses &PA);
+
   /// This is used to return true/false/dunno results.
   enum Tristate {
     Unknown = -1, False = 0, True = 1
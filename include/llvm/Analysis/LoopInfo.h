@@ -651,6 +651,10 @@ public:
   /// will remain valid until this LoopInfo's memory is released.
   void markAsRemoved(Loop *L);
 
+  /// \brief Handle invalidation explicitly, keeping the loop forest across
+  /// passes which preserve \c CFGAnalyses.
+  bool invalidate(Function &F, const PreservedAnalyses &PA);
+
   /// Returns true if replacing From with To everywhere is guaranteed to
   /// preserve LCSSA form.
   bool replacementPreservesLCSSAForm(Instruction *From, Value *To) {
@@ -36,6 +36,10 @@
 //   v = b[0]* 0 + b[1]* 1 + b[2]* 0
 // And finally:
 //   v = b[1]
+//
+// The same analyzer can simulate all the iterations of a loop one after the
+// other, in which case what it learns about the loop on the first iteration is
+// reused on the following ones.
 namespace llvm {
 class UnrolledInstAnalyzer : private InstVisitor<UnrolledInstAnalyzer, bool> {
   typedef InstVisitor<UnrolledInstAnalyzer, bool> Base;
@@ -53,10 +57,38 @@ public:
       IterationNumber = SE.getConstant(APInt(64, Iteration));
   }
 
+  /// \brief Start simulating iteration \p Iteration.
+  ///
+  /// The caller is expected to have reset SimplifiedValues to the values known
+  /// on entry to this iteration.
+  void setIteration(unsigned Iteration) {
+    IterationNumber = SE.getConstant(APInt(64, Iteration));
+    SimplifiedAddresses.clear();
+  }
+
   // Allow access to the initial visit method.
   using Base::visit;
 
 private:
+  /// \brief What SCEV tells about an instruction, independently of the
+  /// simulated iteration.
+  struct SCEVInfo {
+    /// The value of the instruction, if SCEV folds it to a constant.
+    Constant *C = nullptr;
+    /// The recurrence of the instruction, if it is one of this loop.
+    const SCEVAddRecExpr *AR = nullptr;
+    /// The base address of the recurrence, if it is an unknown value, and the
+    /// offset from that base.
+    Value *Base = nullptr;
+    const SCEV *Offset = nullptr;
+  };
+
+  /// \brief A cache of SCEVInfo for the instructions of the loop.
+  ///
+  /// Finding the base pointer of a recurrence takes a non-trivial traversal of
+  /// its SCEV expression, which this saves on every iteration but the first.
+  DenseMap<Instruction *, SCEVInfo> SCEVInfos;
+
   /// \brief A cache of pointer bases and constant-folded offsets corresponding
   /// to GEP (or derived from GEP) instructions.
   ///
@@ -82,6 +114,7 @@ private:
   ScalarEvolution &SE;
   const Loop *L;
 
+  const SCEVInfo &getSCEVInfo(Instruction *I);
   bool simplifyInstWithSCEV(Instruction *I);
 
   bool visitInstruction(Instruction &I) { return simplifyInstWithSCEV(&I); }
@@ -350,6 +350,11 @@ public:
                           DominatorTree &DT)
       : AA(AA), AC(AC), TLI(TLI), DT(DT) {}
 
+  /// Handle invalidation explicitly. The results hold references to the alias
+  /// analysis and the dominator tree, so they are invalidated along with them
+  /// even when a pass claims to preserve them.
+  bool invalidate(Function &F, const PreservedAnalyses &PA);
+
   /// Returns the instruction on which a memory operation depends.
   ///
   /// See the class comment for more details.  It is illegal to call this on
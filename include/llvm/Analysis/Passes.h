@@ -82,6 +82,10 @@ namespace llvm {
   // Print module-level debug info metadata in human-readable form.
   ModulePass *createModuleDebugInfoPrinterPass();
 
+  // Print how much memory the IR objects of a module take, and how much of
+  // it goes to operands and use lists.
+  ModulePass *createIRMemoryUsagePrinterPass();
+
   //===--------------------------------------------------------------------===//
   //
   // createMemDepPrinter - This pass exhaustively collects all memdep
@@ -34,6 +34,10 @@ struct PostDominatorTree : public DominatorTreeBase<BasicBlock> {
     Base::operator=(std::move(static_cast<Base &>(RHS)));
     return *this;
   }
+
+  /// \brief Handle invalidation explicitly, keeping the tree across passes
+  /// which preserve \c CFGAnalyses.
+  bool invalidate(Function &F, const PreservedAnalyses &PA);
 };
 
 /// \brief Analysis pass which computes a \c PostDominatorTree.
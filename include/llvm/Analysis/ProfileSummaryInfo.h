@@ -27,6 +27,8 @@
 #include <memory>
 
 namespace llvm {
+class BlockFrequencyInfo;
+class CallSite;
 class ProfileSummary;
 /// \brief Analysis providing profile information.
 ///
@@ -37,7 +39,7 @@ class ProfileSummary;
 /// check whether a function is hot or cold.
 
 // FIXME: Provide convenience methods to determine hotness/coldness of other IR
-// units. This would require making this depend on BFI.
+// units.
 class ProfileSummaryInfo {
 private:
   Module &M;
@@ -51,6 +53,8 @@ public:
   ProfileSummaryInfo(Module &M) : M(M) {}
   ProfileSummaryInfo(ProfileSummaryInfo &&Arg)
       : M(Arg.M), Summary(std::move(Arg.Summary)) {}
+  /// \brief Returns true if the module has a profile summary.
+  bool hasProfileSummary();
   /// \brief Returns true if \p F is a hot function.
   bool isHotFunction(const Function *F);
   /// \brief Returns true if \p F is a cold function.
@@ -59,6 +63,12 @@ public:
   bool isHotCount(uint64_t C);
   /// \brief Returns true if count \p C is considered cold.
   bool isColdCount(uint64_t C);
+  /// \brief Returns true if the call site \p CS is hot, according to the
+  /// profile count \p CallerBFI estimates for its block.
+  bool isHotCallSite(const CallSite &CS, BlockFrequencyInfo *CallerBFI);
+  /// \brief Returns true if the call site \p CS is cold, according to the
+  /// profile count \p CallerBFI estimates for its block.
+  bool isColdCallSite(const CallSite &CS, BlockFrequencyInfo *CallerBFI);
 };
 
 /// An analysis pass based on legacy pass manager to deliver ProfileSummaryInfo.
@@ -146,7 +146,9 @@ namespace llvm {
     }
     static bool Equals(const SCEV &X, const FoldingSetNodeID &ID,
                        unsigned IDHash, FoldingSetNodeID &TempID) {
-      return ID == X.FastID;
+      // The interned profile remembers its hash, so most mismatches within a
+      // bucket are rejected without comparing the data.
+      return X.FastID.ComputeHash() == IDHash && ID == X.FastID;
     }
     static unsigned ComputeHash(const SCEV &X, FoldingSetNodeID &TempID) {
       return X.FastID.ComputeHash();
@@ -229,7 +231,7 @@ namespace llvm {
 
     static bool Equals(const SCEVPredicate &X, const FoldingSetNodeID &ID,
                        unsigned IDHash, FoldingSetNodeID &TempID) {
-      return ID == X.FastID;
+      return X.FastID.ComputeHash() == IDHash && ID == X.FastID;
     }
     static unsigned ComputeHash(const SCEVPredicate &X,
                                 FoldingSetNodeID &TempID) {
@@ -521,6 +523,15 @@ namespace llvm {
     /// predicate by splitting it into a set of independent predicates.
     bool ProvingSplitPredicate;
 
+    /// The number of nested getAddExpr and getMulExpr calls in progress. Past
+    /// a limit, new add and mul expressions are not canonicalized any further.
+    unsigned ArithDepth;
+
+    /// The number of add and mul foldings left to the function. Once it runs
+    /// out, add and mul expressions are not folded any more and the values
+    /// not analyzed yet become SCEVUnknowns.
+    unsigned ArithBudget;
+
     /// Information about the number of loop iterations for which a loop exit's
     /// branch condition evaluates to the not-taken path.  This is a temporary
     /// pair of exact and max expressions that are eventually summarized in
@@ -1158,6 +1169,11 @@ namespace llvm {
     ~ScalarEvolution();
     ScalarEvolution(ScalarEvolution &&Arg);
 
+    /// Handle invalidation explicitly. The result holds references to the
+    /// dominator tree and the loop info, so it is invalidated along with them
+    /// even when a pass claims to preserve it.
+    bool invalidate(Function &F, const PreservedAnalyses &PA);
+
     LLVMContext &getContext() const { return F.getContext(); }
 
     /// Test if values of the given type are analyzable within the SCEV
@@ -1658,6 +1674,19 @@ namespace llvm {
                             bool IsSigned, bool NoWrap);
 
   private:
+    /// Return the add expression of \p Ops, which must be sorted, without
+    /// folding them.
+    const SCEV *getOrCreateAddExpr(SmallVectorImpl<const SCEV *> &Ops,
+                                   SCEV::NoWrapFlags Flags);
+
+    /// Return the mul expression of \p Ops, which must be sorted, without
+    /// folding them.
+    const SCEV *getOrCreateMulExpr(SmallVectorImpl<const SCEV *> &Ops,
+                                   SCEV::NoWrapFlags Flags);
+
+    /// Take one folding from ArithBudget. Returns false if none is left.
+    bool consumeArithBudget();
+
     FoldingSet<SCEV> UniqueSCEVs;
     FoldingSet<SCEVPredicate> UniquePreds;
     BumpPtrAllocator SCEVAllocator;
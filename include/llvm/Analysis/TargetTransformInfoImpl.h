@@ -238,10 +238,19 @@ public:
 
   bool shouldBuildLookupTables() { return true; }
 
+  bool isSuitableForJumpTable(const SwitchInst *SI, uint64_t NumCases,
+                              uint64_t Range) {
+    // The density SelectionDAG requires of jump tables when optimizing for
+    // size, which is also the most any target asks for by default.
+    return Range < UINT64_MAX / 100 && NumCases * 100 >= Range * 40;
+  }
+
   bool enableAggressiveInterleaving(bool LoopHasReductions) { return false; }
 
   bool enableInterleavedAccessVectorization() { return false; }
 
+  bool enableMaskedInterleavedAccessVectorization() { return false; }
+
   bool isFPVectorizationPotentiallyUnsafe() { return false; }
 
   TTI::PopcntSupportKind getPopcntSupport(unsigned IntTyWidthInBit) {
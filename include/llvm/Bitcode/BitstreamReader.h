@@ -15,6 +15,7 @@
 #ifndef LLVM_BITCODE_BITSTREAMREADER_H
 #define LLVM_BITCODE_BITSTREAMREADER_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Bitcode/BitCodes.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/MathExtras.h"
@@ -43,6 +44,11 @@ public:
 private:
   std::unique_ptr<MemoryObject> BitcodeBytes;
 
+  /// The bytes of BitcodeBytes when they are all in memory, which lets the
+  /// cursors read them without going through the MemoryObject. Empty if the
+  /// bitcode is streamed.
+  ArrayRef<uint8_t> Buffer;
+
   std::vector<BlockInfo> BlockInfoRecords;
 
   /// This is set to true if we don't care about the block/record name
@@ -69,6 +75,7 @@ public:
 
   BitstreamReader &operator=(BitstreamReader &&Other) {
     BitcodeBytes = std::move(Other.BitcodeBytes);
+    Buffer = Other.Buffer;
     // Explicitly swap block info, so that nothing gets destroyed twice.
     std::swap(BlockInfoRecords, Other.BlockInfoRecords);
     IgnoreBlockInfoNames = Other.IgnoreBlockInfoNames;
@@ -78,10 +85,15 @@ public:
   void init(const unsigned char *Start, const unsigned char *End) {
     assert(((End-Start) & 3) == 0 &&"Bitcode stream not a multiple of 4 bytes");
     BitcodeBytes.reset(getNonStreamedMemoryObject(Start, End));
+    Buffer = makeArrayRef(Start, End);
   }
 
   MemoryObject &getBitcodeBytes() { return *BitcodeBytes; }
 
+  /// Return the bitcode if it is all in memory, or an empty array if it is
+  /// streamed.
+  ArrayRef<uint8_t> getBuffer() const { return Buffer; }
+
   /// This is called by clients that want block/record name information.
   void CollectBlockInfoNames() { IgnoreBlockInfoNames = false; }
   bool isIgnoringBlockInfoNames() { return IgnoreBlockInfoNames; }
@@ -164,6 +176,9 @@ public:
 
   bool canSkipToPos(size_t pos) const {
     // pos can be skipped to if it is a valid address or one byte past the end.
+    ArrayRef<uint8_t> Buffer = R->getBuffer();
+    if (!Buffer.empty())
+      return pos <= Buffer.size();
     return pos == 0 ||
            R->getBitcodeBytes().isValidAddress(static_cast<uint64_t>(pos - 1));
   }
@@ -223,6 +238,9 @@ public:
 
   /// Get a pointer into the bitstream at the specified byte offset.
   const uint8_t *getPointerToByte(uint64_t ByteNo, uint64_t NumBytes) {
+    ArrayRef<uint8_t> Buffer = R->getBuffer();
+    if (!Buffer.empty())
+      return Buffer.data() + ByteNo;
     return R->getBitcodeBytes().getPointer(ByteNo, NumBytes);
   }
 
@@ -238,6 +256,18 @@ public:
     if (Size != 0 && NextChar >= Size)
       report_fatal_error("Unexpected end of file");
 
+    // If the bitcode is in memory, load whole words from it directly. The
+    // last, partial word goes through the MemoryObject like streamed input.
+    ArrayRef<uint8_t> Buffer = R->getBuffer();
+    if (Buffer.size() >= NextChar + sizeof(word_t)) {
+      CurWord =
+          support::endian::read<word_t, support::little, support::unaligned>(
+              Buffer.data() + NextChar);
+      NextChar += sizeof(word_t);
+      BitsInCurWord = sizeof(word_t) * 8;
+      return;
+    }
+
     // Read the next word from the stream.
     uint8_t Array[sizeof(word_t)] = {0};
 
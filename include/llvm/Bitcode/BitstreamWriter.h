@@ -21,13 +21,38 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Bitcode/BitCodes.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <vector>
 
 namespace llvm {
 
 class BitstreamWriter {
+  /// Out - The buffer holding the part of the bitstream that hasn't been
+  /// flushed to FS yet (the whole bitstream when FS is null).
   SmallVectorImpl<char> &Out;
 
+  /// FS - The stream the buffer is flushed to when it grows past
+  /// FlushThreshold bytes, or null to keep the whole bitstream in memory.
+  raw_pwrite_stream *FS;
+  uint64_t FlushThreshold;
+
+  /// FlushedBytes - The number of bytes already written to FS, starting at
+  /// offset FSStartOffset in FS.
+  uint64_t FlushedBytes;
+  uint64_t FSStartOffset;
+
+  /// A placeholder that is not word aligned shares its first and last bytes
+  /// with the surrounding data. Once flushed, these bytes can't be read back
+  /// from FS, so a copy is kept to be able to backpatch the placeholder.
+  struct Placeholder {
+    uint64_t BitNo;
+    bool Flushed;
+    char Bytes[8];
+    explicit Placeholder(uint64_t BitNo) : BitNo(BitNo), Flushed(false) {}
+  };
+  std::vector<Placeholder> Placeholders;
+
   /// CurBit - Always between 0 and 31 inclusive, specifies the next bit to use.
   unsigned CurBit;
 
@@ -73,7 +98,7 @@ class BitstreamWriter {
                reinterpret_cast<const char *>(&Value + 1));
   }
 
-  size_t GetBufferOffset() const { return Out.size(); }
+  size_t GetBufferOffset() const { return FlushedBytes + Out.size(); }
 
   size_t GetWordIndex() const {
     size_t Offset = GetBufferOffset();
@@ -82,8 +107,14 @@ class BitstreamWriter {
   }
 
 public:
-  explicit BitstreamWriter(SmallVectorImpl<char> &O)
-    : Out(O), CurBit(0), CurValue(0), CurCodeSize(2) {}
+  explicit BitstreamWriter(SmallVectorImpl<char> &O,
+                           raw_pwrite_stream *FS = nullptr,
+                           uint64_t FlushThreshold = 0)
+      : Out(O), FS(FS), FlushThreshold(FlushThreshold), FlushedBytes(0),
+        FSStartOffset(FS ? FS->tell() : 0), CurBit(0), CurValue(0),
+        CurCodeSize(2) {
+    assert((!FS || Out.empty()) && "Can't stream after buffered data");
+  }
 
   ~BitstreamWriter() {
     assert(CurBit == 0 && "Unflushed data remaining");
@@ -104,12 +135,74 @@ public:
   /// with the specified value.
   void BackpatchWord(uint64_t BitNo, unsigned NewWord) {
     using namespace llvm::support;
-    unsigned ByteNo = BitNo / 8;
+    auto P = std::find_if(
+        Placeholders.begin(), Placeholders.end(),
+        [&](const Placeholder &Entry) { return Entry.BitNo == BitNo; });
+    uint64_t ByteNo = BitNo / 8;
+    if (ByteNo >= FlushedBytes) {
+      // The word is still in the buffer.
+      char *Ptr = &Out[ByteNo - FlushedBytes];
+      assert((!endian::readAtBitAlignment<uint32_t, little, unaligned>(
+                 Ptr, BitNo & 7)) &&
+             "Expected to be patching over 0-value placeholders");
+      endian::writeAtBitAlignment<uint32_t, little, unaligned>(Ptr, NewWord,
+                                                               BitNo & 7);
+      if (P != Placeholders.end())
+        Placeholders.erase(P);
+      return;
+    }
+
+    // The word was already flushed to FS, overwrite it there.
+    if ((BitNo & 31) == 0) {
+      // The word is the initial placeholder, no need to merge any bit.
+      char Bytes[4];
+      endian::write<uint32_t, little, unaligned>(Bytes, NewWord);
+      FS->pwrite(Bytes, sizeof(Bytes), FSStartOffset + ByteNo);
+      if (P != Placeholders.end())
+        Placeholders.erase(P);
+      return;
+    }
+    assert(P != Placeholders.end() && P->Flushed &&
+           "Unaligned placeholder flushed without RegisterBackpatchWord()");
     assert((!endian::readAtBitAlignment<uint32_t, little, unaligned>(
-               &Out[ByteNo], BitNo & 7)) &&
+               P->Bytes, BitNo & 7)) &&
            "Expected to be patching over 0-value placeholders");
-    endian::writeAtBitAlignment<uint32_t, little, unaligned>(
-        &Out[ByteNo], NewWord, BitNo & 7);
+    endian::writeAtBitAlignment<uint32_t, little, unaligned>(P->Bytes, NewWord,
+                                                             BitNo & 7);
+    FS->pwrite(P->Bytes, (BitNo & 7) ? 5 : 4, FSStartOffset + ByteNo);
+    Placeholders.erase(P);
+  }
+
+  /// Declare that the 32-bit word at the given bit offset will be backpatched
+  /// with BackpatchWord(). This must be done for every placeholder that isn't
+  /// word aligned and may be flushed to the stream before being patched.
+  void RegisterBackpatchWord(uint64_t BitNo) {
+    if (FS && (BitNo & 31))
+      Placeholders.emplace_back(BitNo);
+  }
+
+  /// Write the buffer to the stream if streaming and the buffer grew past the
+  /// threshold. Everything in the buffer must be final, except for the
+  /// placeholders to be backpatched.
+  void FlushToFile() {
+    if (!FS || Out.size() < FlushThreshold || Out.empty())
+      return;
+    assert(CurBit == 0 && "Flushing a partial word");
+    uint64_t EndByte = FlushedBytes + Out.size();
+    for (auto &P : Placeholders) {
+      uint64_t ByteNo = P.BitNo / 8;
+      if (P.Flushed || ByteNo >= EndByte)
+        continue;
+      assert(ByteNo >= FlushedBytes && ByteNo + 5 <= EndByte &&
+             "Placeholder split across two flushes");
+      size_t Size = std::min<uint64_t>(sizeof(P.Bytes), EndByte - ByteNo);
+      std::fill(std::begin(P.Bytes), std::end(P.Bytes), 0);
+      std::copy_n(&Out[ByteNo - FlushedBytes], Size, P.Bytes);
+      P.Flushed = true;
+    }
+    FS->write(Out.data(), Out.size());
+    FlushedBytes = EndByte;
+    Out.clear();
   }
 
   void Emit(uint32_t Val, unsigned NumBits) {
@@ -250,6 +343,8 @@ public:
     CurCodeSize = B.PrevCodeSize;
     CurAbbrevs = std::move(B.PrevAbbrevs);
     BlockScope.pop_back();
+
+    FlushToFile();
   }
 
   //===--------------------------------------------------------------------===//
@@ -52,7 +52,11 @@ enum BlockIDs {
 
   OPERAND_BUNDLE_TAGS_BLOCK_ID,
 
-  METADATA_KIND_BLOCK_ID
+  METADATA_KIND_BLOCK_ID,
+
+  // Top-level block written after the module block, listing the module's
+  // symbols so that they can be read without parsing the module.
+  SYMTAB_BLOCK_ID
 };
 
 /// Identification block contains a string that describes the producer details,
@@ -170,6 +174,23 @@ enum OperandBundleTagCode {
   OPERAND_BUNDLE_TAG = 1, // TAG: [strchr x N]
 };
 
+// The symbol table block (SYMTAB_BLOCK_ID) has a single record type.
+enum SymtabCodes {
+  SYMTAB_CODE_ENTRY = 1, // ENTRY: [flags, namechar x N]
+};
+
+/// Flags of a SYMTAB_CODE_ENTRY record. These are encoded in the bitcode, so
+/// their values must not change.
+enum SymtabFlags {
+  SYMTAB_FLAG_UNDEFINED = 1 << 0,
+  SYMTAB_FLAG_GLOBAL = 1 << 1,
+  SYMTAB_FLAG_WEAK = 1 << 2,
+  SYMTAB_FLAG_COMMON = 1 << 3,
+  SYMTAB_FLAG_HIDDEN = 1 << 4,
+  SYMTAB_FLAG_CONST = 1 << 5,
+  SYMTAB_FLAG_FORMAT_SPECIFIC = 1 << 6,
+};
+
 // The type symbol table only has one code (TST_ENTRY_CODE).
 enum TypeSymtabCodes {
   TST_CODE_ENTRY = 1 // TST_ENTRY: [typeid, namechar x N]
@@ -193,19 +214,19 @@ enum ModulePathSymtabCodes {
 // The summary section uses different codes in the per-module
 // and combined index cases.
 enum GlobalValueSummarySymtabCodes {
-  // PERMODULE: [valueid, flags, instcount, numrefs, numrefs x valueid,
-  //             n x (valueid, callsitecount)]
+  // PERMODULE: [valueid, flags, instcount, fflags, numrefs,
+  //             numrefs x valueid, n x (valueid, callsitecount)]
   FS_PERMODULE = 1,
-  // PERMODULE_PROFILE: [valueid, flags, instcount, numrefs,
+  // PERMODULE_PROFILE: [valueid, flags, instcount, fflags, numrefs,
   //                     numrefs x valueid,
   //                     n x (valueid, callsitecount, profilecount)]
   FS_PERMODULE_PROFILE = 2,
   // PERMODULE_GLOBALVAR_INIT_REFS: [valueid, flags, n x valueid]
   FS_PERMODULE_GLOBALVAR_INIT_REFS = 3,
-  // COMBINED: [valueid, modid, flags, instcount, numrefs, numrefs x valueid,
-  //            n x (valueid, callsitecount)]
+  // COMBINED: [valueid, modid, flags, instcount, fflags, numrefs,
+  //            numrefs x valueid, n x (valueid, callsitecount)]
   FS_COMBINED = 4,
-  // COMBINED_PROFILE: [valueid, modid, flags, instcount, numrefs,
+  // COMBINED_PROFILE: [valueid, modid, flags, instcount, fflags, numrefs,
   //                    numrefs x valueid,
   //                    n x (valueid, callsitecount, profilecount)]
   FS_COMBINED_PROFILE = 5,
@@ -21,6 +21,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace llvm {
   class BitstreamWriter;
@@ -28,6 +29,7 @@ namespace llvm {
   class LLVMContext;
   class Module;
   class ModulePass;
+  class raw_fd_ostream;
   class raw_ostream;
 
   /// Offsets of the 32-bit fields of bitcode wrapper header.
@@ -66,6 +68,21 @@ namespace llvm {
   std::string getBitcodeProducerString(MemoryBufferRef Buffer,
                                        LLVMContext &Context);
 
+  /// A symbol listed in the symbol table block of a bitcode file.
+  struct BitcodeSymbol {
+    /// The mangled name, pointing into the bitcode buffer.
+    StringRef Name;
+    /// A combination of bitc::SymtabFlags.
+    uint32_t Flags;
+  };
+
+  /// Read the symbol table block that the writer emits after the module
+  /// block, without parsing the module or needing an LLVMContext. Returns
+  /// false if the buffer has no such block, which is the case for bitcode
+  /// from older writers and for modules with module-level inline asm.
+  ErrorOr<bool> readBitcodeSymbolTable(MemoryBufferRef Buffer,
+                                       std::vector<BitcodeSymbol> &Symbols);
+
   /// Read the specified bitcode file, returning the module.
   ErrorOr<std::unique_ptr<Module>> parseBitcodeFile(MemoryBufferRef Buffer,
                                                     LLVMContext &Context);
@@ -96,6 +113,17 @@ namespace llvm {
                           const ModuleSummaryIndex *Index = nullptr,
                           bool GenerateHash = false);
 
+  /// \brief Write the specified module to the specified file.
+  ///
+  /// Same as above, but when the file supports seeking the bitstream is
+  /// flushed to it as it is produced (see -bitcode-flush-threshold) rather than
+  /// buffered entirely in memory, the block sizes being backpatched in place.
+  /// Darwin targets and module hashes still require the whole buffer.
+  void WriteBitcodeToFile(const Module *M, raw_fd_ostream &Out,
+                          bool ShouldPreserveUseListOrder = false,
+                          const ModuleSummaryIndex *Index = nullptr,
+                          bool GenerateHash = false);
+
   /// Write the specified module summary index to the given raw output stream,
   /// where it will be written in a new bitcode block. This is used when
   /// writing the combined index file for ThinLTO. When writing a subset of the
@@ -16,6 +16,7 @@
 #ifndef LLVM_CODEGEN_ASMPRINTER_H
 #define LLVM_CODEGEN_ASMPRINTER_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
@@ -93,6 +94,10 @@ public:
   ///
   Mangler *Mang;
 
+  /// The symbols returned by getSymbol() so far, so that each global is
+  /// mangled and looked up in the MCContext only once per module.
+  mutable DenseMap<const GlobalValue *, MCSymbol *> GlobalSymbols;
+
   /// The symbol for the current function. This is recalculated at the beginning
   /// of each call to runOnMachineFunction().
   ///
@@ -71,19 +71,38 @@ typedef int64_t                 DFAStateInput;
 
 class DFAPacketizer {
 private:
-  typedef std::pair<unsigned, DFAInput> UnsignPair;
-
   const InstrItineraryData *InstrItins;
   int CurrentState;
   const DFAStateInput (*DFAStateInputTable)[2];
   const unsigned *DFAStateEntryTable;
 
-  // CachedTable is a map from <FromState, Input> to ToState.
-  DenseMap<UnsignPair, unsigned> CachedTable;
+  // The inputs are numbered densely in the order they are first seen, so
+  // that the transitions out of a state can be indexed by input number.
+  DenseMap<DFAInput, unsigned> InputNumbers;
+
+  // The input number of each scheduling class, or -1 if it has not been
+  // computed yet.
+  std::vector<int> SchedClassInputs;
+
+  // Transitions[S][N] is the state reached from state S on input number N, or
+  // -1 if there is no such transition. The row of a state is filled in from
+  // the generated tables the first time the state is visited.
+  std::vector<std::vector<int>> Transitions;
+  std::vector<bool> StatesRead;
 
-  // Read the DFA transition table and update CachedTable.
+  // Return the number of an input, numbering it if it has not been seen.
+  unsigned getInputNumber(DFAInput Input);
+
+  // Return the input number of a scheduling class.
+  unsigned getSchedClassInput(unsigned SchedClass);
+
+  // Read the transitions out of a state from the DFA transition table.
   void ReadTable(unsigned state);
 
+  // Return the state reached from the current state by an instruction of the
+  // given scheduling class, or -1 if its resources are not available.
+  int getNextState(unsigned SchedClass);
+
 public:
   DFAPacketizer(const InstrItineraryData *I, const DFAStateInput (*SIT)[2],
                 const unsigned *SET);
@@ -163,6 +163,10 @@ public:
   /// basic blocks.
   SmallVector<unsigned, 50> StatepointStackSlots;
 
+  /// StatepointStackSlotIndices - The position of each frame index in
+  /// StatepointStackSlots.
+  DenseMap<int, unsigned> StatepointStackSlotIndices;
+
   /// MBB - The current block.
   MachineBasicBlock *MBB;
 
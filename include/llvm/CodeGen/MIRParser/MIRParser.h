@@ -45,6 +45,13 @@ public:
   /// Returns null if a parsing error occurred.
   std::unique_ptr<Module> parseLLVMModule();
 
+  /// Parse the machine functions for functions that are already defined in the
+  /// given module, instead of the ones in the embedded LLVM IR.
+  ///
+  /// Only the metadata defined by the embedded LLVM IR is used.
+  /// Return true if an error occurred.
+  bool parseMachineFunctions(Module &M);
+
   /// Initialize the machine function to the state that's described in the MIR
   /// file.
   ///
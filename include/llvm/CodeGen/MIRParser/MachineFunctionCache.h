@@ -0,0 +1,69 @@
+//===- MachineFunctionCache.h - Cache of selected functions -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a cache that stores machine functions right after
+// instruction selection, in the MIR serialization format, and reuses them when
+// the same function is compiled again.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_MIRPARSER_MACHINEFUNCTIONCACHE_H
+#define LLVM_CODEGEN_MIRPARSER_MACHINEFUNCTIONCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/CodeGen/MachineFunctionInitializer.h"
+#include <string>
+
+namespace llvm {
+
+class Function;
+class TargetMachine;
+
+/// This class initializes machine functions from the cache directory given at
+/// construction, and stores the functions it misses once they have been
+/// selected.
+///
+/// Each entry is named after the SHA1 of the code generator configuration,
+/// the IR of the function and the declarations of the globals it references.
+/// A machine function that is read from the cache has the Selected property
+/// set, so that the instruction selectors leave it alone.
+///
+/// Functions whose selection leaves state that the MIR format doesn't
+/// describe, such as a target function info that isn't in its initial state,
+/// debug information or exception handling, are never stored.
+class MachineFunctionCache : public MachineFunctionInitializer {
+public:
+  MachineFunctionCache(StringRef CacheDir, const TargetMachine &TM);
+  ~MachineFunctionCache() override;
+
+  bool initializeMachineFunction(MachineFunction &MF) override;
+
+  /// Add a pass that stores each machine function that was missed.
+  void addPostISelPasses(legacy::PassManagerBase &PM) override;
+
+  /// Store the given machine function, which was just selected, if it was
+  /// missed and can be reused.
+  void storeMachineFunction(const MachineFunction &MF);
+
+  /// Return the path of the cache entry for F.
+  std::string getEntryPath(const Function &F) const;
+
+private:
+  std::string CacheDir;
+  const TargetMachine &TM;
+  std::string TargetKey;
+  // Entry paths computed by initializeMachineFunction, so that storing the
+  // function selected after a miss doesn't hash it again.
+  DenseMap<const Function *, std::string> PendingEntries;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_CODEGEN_MIRPARSER_MACHINEFUNCTIONCACHE_H
@@ -87,6 +87,11 @@ struct MachineFunctionInfo {
   static Ty *create(BumpPtrAllocator &Allocator, MachineFunction &MF) {
     return new (Allocator.Allocate<Ty>()) Ty(MF);
   }
+
+  /// Return true if nothing has been recorded in this object since it was
+  /// created. The MIR serialization does not include this object, so a
+  /// function read back from MIR only matches the original if this holds.
+  virtual bool isInInitialState() const { return false; }
 };
 
 /// Properties which a MachineFunction may have at a given point in time.
@@ -116,10 +121,13 @@ public:
   //  When this property is clear, liveness is no longer reliable.
   // AllVRegsAllocated: All virtual registers have been allocated; i.e. all
   //  register operands are physical registers.
+  // Selected: The function was initialized with already selected instructions,
+  //  so instruction selection must not run on it.
   enum class Property : unsigned {
     IsSSA,
     TracksLiveness,
     AllVRegsAllocated,
+    Selected,
     LastProperty,
   };
 
@@ -192,6 +200,9 @@ class MachineFunction {
   // Pool-allocate MachineFunction-lifetime and IR objects.
   BumpPtrAllocator Allocator;
 
+  // Reports the memory held by Allocator for -print-memory-usage.
+  MemoryUsageReporter AllocatorUsage{"MachineFunction", Allocator};
+
   // Allocation management for instructions in function.
   Recycler<MachineInstr> InstructionRecycler;
 
@@ -363,6 +374,10 @@ public:
      return const_cast<MachineFunction*>(this)->getInfo<Ty>();
   }
 
+  /// Return the target-specific information if it has been created, without
+  /// creating it.
+  const MachineFunctionInfo *getInfoIfCreated() const { return MFInfo; }
+
   /// getBlockNumbered - MachineBasicBlocks are automatically numbered when they
   /// are inserted into the machine function.  The block number for a machine
   /// basic block can be found by using the MBB::getBlockNumber method, this
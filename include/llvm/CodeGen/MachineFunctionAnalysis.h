@@ -24,6 +24,14 @@ class TargetMachine;
 
 /// MachineFunctionAnalysis - This class is a Pass that manages a
 /// MachineFunction object.
+///
+/// The MachineFunction only lives from instruction selection until the
+/// FreeMachineFunction pass at the end of that function's pipeline. A module
+/// pass in the CodeGen pipeline would split it, and the machine passes after
+/// it would see fresh, empty MachineFunctions. Passes that need the machine
+/// code of several functions at once, such as an outliner of repeated
+/// instruction sequences across the module, therefore need the
+/// MachineFunctions to be owned by something with module lifetime.
 struct MachineFunctionAnalysis : public FunctionPass {
 private:
   const TargetMachine &TM;
@@ -19,6 +19,10 @@ namespace llvm {
 
 class MachineFunction;
 
+namespace legacy {
+class PassManagerBase;
+}
+
 /// This interface provides a way to initialize machine functions after they are
 /// created by the machine function analysis pass.
 class MachineFunctionInitializer {
@@ -31,6 +35,11 @@ public:
   ///
   /// Return true if error occurred.
   virtual bool initializeMachineFunction(MachineFunction &MF) = 0;
+
+  /// Add the passes that should see each machine function right after
+  /// instruction selection, before any of the target independent machine
+  /// passes run.
+  virtual void addPostISelPasses(legacy::PassManagerBase &PM) {}
 };
 
 } // end namespace llvm
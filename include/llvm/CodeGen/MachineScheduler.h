@@ -876,6 +876,7 @@ protected:
 /// GenericScheduler shrinks the unscheduled zone using heuristics to balance
 /// the schedule.
 class GenericScheduler : public GenericSchedulerBase {
+protected:
   ScheduleDAGMILive *DAG;
 
   // State of the top and bottom scheduled instruction boundaries.
@@ -13,6 +13,10 @@
 // matrices). Since PBQP graphs can grow very large (E.g. hundreds of thousands
 // of edges on the largest function in SPEC2006).
 //
+// Values handed out by a pool may outlive it, so that they can be shared
+// between graphs, such as the graphs built for successive rounds of register
+// allocation.
+//
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_CODEGEN_PBQP_COSTALLOCATOR_H
@@ -31,16 +35,24 @@ public:
   typedef std::shared_ptr<const ValueT> PoolRef;
 
 private:
+  class PoolEntry;
+  class PoolEntryDSInfo;
+  typedef DenseSet<PoolEntry*, PoolEntryDSInfo> EntrySetT;
 
   class PoolEntry : public std::enable_shared_from_this<PoolEntry> {
   public:
     template <typename ValueKeyT>
-    PoolEntry(ValuePool &Pool, ValueKeyT Value)
+    PoolEntry(const std::shared_ptr<EntrySetT> &Pool, ValueKeyT Value)
         : Pool(Pool), Value(std::move(Value)) {}
-    ~PoolEntry() { Pool.removeEntry(this); }
+    ~PoolEntry() {
+      // The pool may already be gone if this value was shared with a user
+      // that outlived it.
+      if (std::shared_ptr<EntrySetT> P = Pool.lock())
+        P->erase(this);
+    }
     const ValueT& getValue() const { return Value; }
   private:
-    ValuePool &Pool;
+    std::weak_ptr<EntrySetT> Pool;
     ValueT Value;
   };
 
@@ -86,21 +98,17 @@ private:
 
   };
 
-  typedef DenseSet<PoolEntry*, PoolEntryDSInfo> EntrySetT;
-
-  EntrySetT EntrySet;
-
-  void removeEntry(PoolEntry *P) { EntrySet.erase(P); }
+  std::shared_ptr<EntrySetT> EntrySet = std::make_shared<EntrySetT>();
 
 public:
   template <typename ValueKeyT> PoolRef getValue(ValueKeyT ValueKey) {
-    typename EntrySetT::iterator I = EntrySet.find_as(ValueKey);
+    typename EntrySetT::iterator I = EntrySet->find_as(ValueKey);
 
-    if (I != EntrySet.end())
+    if (I != EntrySet->end())
       return PoolRef((*I)->shared_from_this(), &(*I)->getValue());
 
-    auto P = std::make_shared<PoolEntry>(*this, std::move(ValueKey));
-    EntrySet.insert(P.get());
+    auto P = std::make_shared<PoolEntry>(EntrySet, std::move(ValueKey));
+    EntrySet->insert(P.get());
     return PoolRef(std::move(P), &P->getValue());
   }
 };
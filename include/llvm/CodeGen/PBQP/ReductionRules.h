@@ -75,6 +75,7 @@ namespace PBQP {
     typedef typename GraphT::EdgeId EdgeId;
     typedef typename GraphT::Vector Vector;
     typedef typename GraphT::Matrix Matrix;
+    typedef typename GraphT::RawVector RawVector;
     typedef typename GraphT::RawMatrix RawMatrix;
 
     assert(G.getNodeDegree(NId) == 2 &&
@@ -92,25 +93,37 @@ namespace PBQP {
     bool FlipEdge1 = (G.getEdgeNode1Id(YXEId) == NId),
          FlipEdge2 = (G.getEdgeNode1Id(ZXEId) == NId);
 
-    const Matrix *YXECosts = FlipEdge1 ?
-      new Matrix(G.getEdgeCosts(YXEId).transpose()) :
-      &G.getEdgeCosts(YXEId);
-
-    const Matrix *ZXECosts = FlipEdge2 ?
-      new Matrix(G.getEdgeCosts(ZXEId).transpose()) :
-      &G.getEdgeCosts(ZXEId);
+    const Matrix &YXECosts = G.getEdgeCosts(YXEId);
+    const Matrix &ZXECosts = G.getEdgeCosts(ZXEId);
 
     unsigned XLen = XCosts.getLength(),
-      YLen = YXECosts->getRows(),
-      ZLen = ZXECosts->getRows();
+      YLen = FlipEdge1 ? YXECosts.getCols() : YXECosts.getRows(),
+      ZLen = FlipEdge2 ? ZXECosts.getCols() : ZXECosts.getRows();
+
+    // The inner loop walks the X costs of one Z option at a time, so it needs
+    // the Z edge's costs in (Z, X) order. A flipped copy is a plain matrix: it
+    // does not need the solver's metadata.
+    const RawMatrix *ZXCosts = &ZXECosts;
+    RawMatrix FlippedZXECosts(0, 0);
+    if (FlipEdge2) {
+      FlippedZXECosts = ZXECosts.transpose();
+      ZXCosts = &FlippedZXECosts;
+    }
 
     RawMatrix Delta(YLen, ZLen);
 
+    // The costs of X plus those of the Y edge only depend on the Y option, so
+    // they are summed once per row of Delta rather than once per element.
+    RawVector YXCosts(XLen);
     for (unsigned i = 0; i < YLen; ++i) {
+      for (unsigned k = 0; k < XLen; ++k)
+        YXCosts[k] = XCosts[k] + (FlipEdge1 ? YXECosts[k][i] : YXECosts[i][k]);
+
       for (unsigned j = 0; j < ZLen; ++j) {
-        PBQPNum Min = (*YXECosts)[i][0] + (*ZXECosts)[j][0] + XCosts[0];
+        const PBQPNum *ZXRow = (*ZXCosts)[j];
+        PBQPNum Min = YXCosts[0] + ZXRow[0];
         for (unsigned k = 1; k < XLen; ++k) {
-          PBQPNum C = (*YXECosts)[i][k] + (*ZXECosts)[j][k] + XCosts[k];
+          PBQPNum C = YXCosts[k] + ZXRow[k];
           if (C < Min) {
             Min = C;
           }
@@ -119,12 +132,6 @@ namespace PBQP {
       }
     }
 
-    if (FlipEdge1)
-      delete YXECosts;
-
-    if (FlipEdge2)
-      delete ZXECosts;
-
     EdgeId YZEId = G.findEdge(YNId, ZNId);
 
     if (YZEId == G.invalidEdgeId()) {
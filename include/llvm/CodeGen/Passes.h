@@ -345,6 +345,11 @@ namespace llvm {
   /// initializer into the load, which may result in an overflowing evaluation.
   ModulePass *createPreISelIntrinsicLoweringPass();
 
+  /// FreeFunctionBodies - This pass replaces the body of each function by an
+  /// unreachable once the AsmPrinter has emitted it, to release its memory.
+  ///
+  FunctionPass *createFreeFunctionBodiesPass();
+
   /// GlobalMerge - This pass merges internal (by default) globals into structs
   /// to enable reuse of a base pointer by indexed addressing modes.
   /// It can also be configured to focus on size optimizations only.
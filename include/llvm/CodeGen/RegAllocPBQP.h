@@ -137,16 +137,23 @@ inline hash_code hash_value(const AllowedRegVector &OptRegs) {
 
 /// \brief Holds graph-level metadata relevant to PBQP RA problems.
 class GraphMetadata {
-private:
-  typedef ValuePool<AllowedRegVector> AllowedRegVecPool;
 public:
-
+  typedef ValuePool<AllowedRegVector> AllowedRegVecPool;
   typedef AllowedRegVecPool::PoolRef AllowedRegVecRef;
 
   GraphMetadata(MachineFunction &MF,
                 LiveIntervals &LIS,
                 MachineBlockFrequencyInfo &MBFI)
-    : MF(MF), LIS(LIS), MBFI(MBFI) {}
+    : MF(MF), LIS(LIS), MBFI(MBFI),
+      AllowedRegVecs(std::make_shared<AllowedRegVecPool>()) {}
+
+  /// \brief Construct metadata whose allowed register sets are uniqued in
+  /// \p AllowedRegVecs, which may be shared with other graphs.
+  GraphMetadata(MachineFunction &MF,
+                LiveIntervals &LIS,
+                MachineBlockFrequencyInfo &MBFI,
+                std::shared_ptr<AllowedRegVecPool> AllowedRegVecs)
+    : MF(MF), LIS(LIS), MBFI(MBFI), AllowedRegVecs(std::move(AllowedRegVecs)) {}
 
   MachineFunction &MF;
   LiveIntervals &LIS;
@@ -168,12 +175,12 @@ public:
   }
 
   AllowedRegVecRef getAllowedRegs(AllowedRegVector Allowed) {
-    return AllowedRegVecs.getValue(std::move(Allowed));
+    return AllowedRegVecs->getValue(std::move(Allowed));
   }
 
 private:
   DenseMap<unsigned, GraphBase::NodeId> VRegToNodeId;
-  AllowedRegVecPool AllowedRegVecs;
+  std::shared_ptr<AllowedRegVecPool> AllowedRegVecs;
 };
 
 /// \brief Holds solver state and other metadata relevant to each PBQP RA node.
@@ -266,6 +273,12 @@ public:
   }
   const AllowedRegVector& getAllowedRegs() const { return *AllowedRegs; }
 
+  /// \brief Get the uniqued pointer to the allowed registers, which keeps
+  /// them alive. Prefer getAllowedRegs where possible.
+  const GraphMetadata::AllowedRegVecRef& getAllowedRegsPtr() const {
+    return AllowedRegs;
+  }
+
   void setup(const Vector& Costs) {
     NumOpts = Costs.getLength() - 1;
     OptUnsafeEdges = std::unique_ptr<unsigned[]>(new unsigned[NumOpts]());
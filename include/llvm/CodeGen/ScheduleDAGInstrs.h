@@ -162,6 +162,10 @@ namespace llvm {
 
     AliasAnalysis *AAForDep;
 
+    /// Number of chain dependencies checked with AAForDep in this region. See
+    /// -dag-max-alias-queries.
+    unsigned NumAAQueries;
+
     /// Remember a generic side-effecting instruction as we proceed.
     /// No other SU ever gets scheduled around it (except in the special
     /// case of a huge region that gets reduced).
@@ -50,14 +50,9 @@ class SDVTListNode : public FoldingSetNode {
   FoldingSetNodeIDRef FastID;
   const EVT *VTs;
   unsigned int NumVTs;
-  /// The hash value for SDVTList is fixed, so cache it to avoid
-  /// hash calculation.
-  unsigned HashValue;
 public:
   SDVTListNode(const FoldingSetNodeIDRef ID, const EVT *VT, unsigned int Num) :
-      FastID(ID), VTs(VT), NumVTs(Num) {
-    HashValue = ID.ComputeHash();
-  }
+      FastID(ID), VTs(VT), NumVTs(Num) {}
   SDVTList getSDVTList() {
     SDVTList result = {VTs, NumVTs};
     return result;
@@ -72,12 +67,13 @@ template<> struct FoldingSetTrait<SDVTListNode> : DefaultFoldingSetTrait<SDVTLis
   }
   static bool Equals(const SDVTListNode &X, const FoldingSetNodeID &ID,
                      unsigned IDHash, FoldingSetNodeID &TempID) {
-    if (X.HashValue != IDHash)
+    // The interned FastID remembers its hash.
+    if (X.FastID.ComputeHash() != IDHash)
       return false;
     return ID == X.FastID;
   }
   static unsigned ComputeHash(const SDVTListNode &X, FoldingSetNodeID &TempID) {
-    return X.HashValue;
+    return X.FastID.ComputeHash();
   }
 };
 
@@ -396,8 +392,9 @@ public:
   /// This iterates over the nodes in the SelectionDAG, folding
   /// certain types of nodes together, or eliminating superfluous nodes.  The
   /// Level argument controls whether Combine is allowed to produce nodes and
-  /// types that are illegal on the target.
-  void Combine(CombineLevel Level, AliasAnalysis &AA,
+  /// types that are illegal on the target. AA may be null, in which case
+  /// memory operations are only disambiguated by their offsets.
+  void Combine(CombineLevel Level, AliasAnalysis *AA,
                CodeGenOpt::Level OptLevel);
 
   /// This transforms the SelectionDAG into a SelectionDAG that
@@ -433,11 +433,16 @@ private:
   /// Source line information.
   DebugLoc debugLoc;
 
+  /// The hash of this node's profile, or 0 if it has not been computed since
+  /// the node was last added to the CSE map.
+  unsigned CSEHash;
+
   /// Return a pointer to the specified value type.
   static const EVT *getValueTypeList(EVT VT);
 
   friend class SelectionDAG;
   friend struct ilist_traits<SDNode>;
+  friend struct FoldingSetTrait<SDNode>;
   // TODO: unfriend HandleSDNode once we fix its operand handling.
   friend class HandleSDNode;
 
@@ -814,7 +819,7 @@ protected:
       : NodeType(Opc), HasDebugValue(false), SubclassData(0), NodeId(-1),
         OperandList(nullptr), ValueList(VTs.VTs), UseList(nullptr),
         NumOperands(0), NumValues(VTs.NumVTs), IROrder(Order),
-        debugLoc(std::move(dl)) {
+        debugLoc(std::move(dl)), CSEHash(0) {
     assert(debugLoc.hasTrivialDestructor() && "Expected trivial destructor");
     assert(NumValues == VTs.NumVTs &&
            "NumValues wasn't wide enough for its operands!");
@@ -824,6 +829,33 @@ protected:
   void DropOperands();
 };
 
+/// Specialize FoldingSetTrait for SDNode so that the CSE map profiles a node
+/// at most once while it is in the map: the hash of the profile is kept in the
+/// node, and nodes in the same bucket whose hash differs from the one looked
+/// up are skipped without being profiled again. SelectionDAG clears the hash
+/// when it removes a node from the CSE map to modify it.
+template <> struct FoldingSetTrait<SDNode> : DefaultFoldingSetTrait<SDNode> {
+  static bool Equals(SDNode &X, const FoldingSetNodeID &ID, unsigned IDHash,
+                     FoldingSetNodeID &TempID) {
+    if (X.CSEHash && X.CSEHash != IDHash)
+      return false;
+    X.Profile(TempID);
+    if (!X.CSEHash) {
+      X.CSEHash = TempID.ComputeHash();
+      if (X.CSEHash != IDHash)
+        return false;
+    }
+    return TempID == ID;
+  }
+  static unsigned ComputeHash(SDNode &X, FoldingSetNodeID &TempID) {
+    if (!X.CSEHash) {
+      X.Profile(TempID);
+      X.CSEHash = TempID.ComputeHash();
+    }
+    return X.CSEHash;
+  }
+};
+
 /// Wrapper class for IR location info (IR ordering and DebugLoc) to be passed
 /// into SDNode creation functions.
 /// When an SDNode is created from the DAGBuilder, the DebugLoc is extracted
@@ -168,6 +168,7 @@ public:
     CSInfos.clear();
     ConstPool.clear();
     FnStackSize.clear();
+    LocationTable.clear();
   }
 
   /// \brief Generate a stackmap record for a stackmap instruction.
@@ -198,6 +199,8 @@ private:
     uint64_t ID;
     LocationVec Locations;
     LiveOutVec LiveOuts;
+    /// Indices of Locations in the shared location table (version 2 only).
+    SmallVector<unsigned, 8> LocationIndices;
     CallsiteInfo() : CSOffsetExpr(nullptr), ID(0) {}
     CallsiteInfo(const MCExpr *CSOffsetExpr, uint64_t ID,
                  LocationVec &&Locations, LiveOutVec &&LiveOuts)
@@ -211,6 +214,8 @@ private:
   CallsiteInfoList CSInfos;
   ConstantPool ConstPool;
   FnStackSizeMap FnStackSize;
+  /// The distinct locations of all callsites, for version 2.
+  LocationVec LocationTable;
 
   MachineInstr::const_mop_iterator
   parseOperand(MachineInstr::const_mop_iterator MOI,
@@ -244,6 +249,13 @@ private:
   /// \brief Emit the constant pool.
   void emitConstantPoolEntries(MCStreamer &OS);
 
+  /// \brief Build the table of distinct locations and the per-callsite
+  /// indices into it (version 2 only).
+  void buildLocationTable();
+
+  /// \brief Emit the location table (version 2 only).
+  void emitLocationTable(MCStreamer &OS);
+
   /// \brief Emit the callsite info for each stackmap/patchpoint intrinsic call.
   void emitCallsiteEntries(MCStreamer &OS);
 
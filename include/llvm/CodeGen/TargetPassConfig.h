@@ -77,6 +77,15 @@ template <> struct isPodLike<IdentifyingPassPtr> {
 ///
 /// This is an ImmutablePass solely for the purpose of exposing CodeGen options
 /// to the internals of other CodeGen passes.
+///
+/// The pipeline runs each function through every MachineFunction pass before
+/// moving on to the next function, all on one thread. The functions are not
+/// independent enough to use several threads: instruction selection creates
+/// constants and types in the shared LLVMContext, the passes record module
+/// level state such as landing pads and frame moves in a single
+/// MachineModuleInfo, and they share one MCContext for symbols and sections.
+/// To compile a module on several threads, split it with splitCodeGen and run
+/// one pipeline per partition instead.
 class TargetPassConfig : public ImmutablePass {
 public:
   /// Pseudo Pass IDs. These are defined within TargetPassConfig because they
@@ -226,6 +235,12 @@ public:
   /// class or register banks.
   virtual bool addRegBankSelect() { return true; }
 
+  /// This method should install a (global) instruction selector pass, which
+  /// converts possibly generic instructions to fully target-specific
+  /// instructions, thereby constraining all generic virtual registers to
+  /// register classes.
+  virtual bool addGlobalInstructionSelect() { return true; }
+
   /// Add the complete, standard set of LLVM CodeGen passes.
   /// Fully developed targets will not generally override this.
   virtual void addMachinePasses();
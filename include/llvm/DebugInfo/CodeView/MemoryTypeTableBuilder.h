@@ -37,9 +37,31 @@ protected:
   TypeIndex writeRecord(llvm::StringRef Data) override;
 
 private:
+  /// A record's contents along with their hash. The hash is computed once
+  /// per written record, and growing the table does not rehash the contents.
+  struct HashedRecord {
+    StringRef Data;
+    unsigned Hash;
+  };
+
+  struct HashedRecordInfo {
+    static inline HashedRecord getEmptyKey() {
+      return {DenseMapInfo<StringRef>::getEmptyKey(), 0};
+    }
+    static inline HashedRecord getTombstoneKey() {
+      return {DenseMapInfo<StringRef>::getTombstoneKey(), 0};
+    }
+    static unsigned getHashValue(const HashedRecord &Val) { return Val.Hash; }
+    static bool isEqual(const HashedRecord &LHS, const HashedRecord &RHS) {
+      if (LHS.Hash != RHS.Hash)
+        return false;
+      return DenseMapInfo<StringRef>::isEqual(LHS.Data, RHS.Data);
+    }
+  };
+
   std::vector<StringRef> Records;
   BumpPtrAllocator RecordStorage;
-  DenseMap<StringRef, TypeIndex> HashedRecords;
+  DenseMap<HashedRecord, TypeIndex, HashedRecordInfo> HashedRecords;
 };
 
 } // end namespace codeview
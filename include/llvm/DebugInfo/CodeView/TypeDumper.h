@@ -11,10 +11,10 @@
 #define LLVM_DEBUGINFO_CODEVIEW_TYPEDUMPER_H
 
 #include "llvm/ADT/ArrayRef.h"
-#include "llvm/ADT/StringSet.h"
 #include "llvm/DebugInfo/CodeView/TypeIndex.h"
 #include "llvm/DebugInfo/CodeView/TypeRecord.h"
 #include "llvm/DebugInfo/CodeView/TypeVisitorCallbacks.h"
+#include "llvm/Support/StringSaver.h"
 
 namespace llvm {
 class ScopedPrinter;
@@ -54,10 +54,8 @@ public:
   /// Records the name of a type, and reserves its type index.
   void recordType(StringRef Name) { CVUDTNames.push_back(Name); }
 
-  /// Saves the name in a StringSet and creates a stable StringRef.
-  StringRef saveName(StringRef TypeName) {
-    return TypeNames.insert(TypeName).first->getKey();
-  }
+  /// Saves the name and creates a stable StringRef.
+  StringRef saveName(StringRef TypeName) { return TypeNames.save(TypeName); }
 
   void setPrinter(ScopedPrinter *P);
   ScopedPrinter *getPrinter() { return W; }
@@ -96,7 +94,8 @@ private:
   /// index into this vector.
   SmallVector<StringRef, 10> CVUDTNames;
 
-  StringSet<> TypeNames;
+  BumpPtrAllocator TypeNameStorage;
+  UniqueStringSaver TypeNames{TypeNameStorage};
 };
 
 } // end namespace codeview
@@ -263,7 +263,7 @@ private:
 class ArgListRecord : public TypeRecord {
 public:
   ArgListRecord(TypeRecordKind Kind, ArrayRef<TypeIndex> Indices)
-      : TypeRecord(Kind), StringIndices(Indices) {}
+      : TypeRecord(Kind), StringIndices(Indices.begin(), Indices.end()) {}
 
   /// Rewrite member type indices with IndexMap. Returns false if a type index
   /// is not in the map.
@@ -282,7 +282,7 @@ private:
                          // ArgTypes[]: Type indicies of arguments
   };
 
-  std::vector<TypeIndex> StringIndices;
+  SmallVector<TypeIndex, 8> StringIndices;
 };
 
 // LF_POINTER
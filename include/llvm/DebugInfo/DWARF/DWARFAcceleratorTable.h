@@ -47,6 +47,11 @@ public:
 
   bool extract();
   void dump(raw_ostream &OS) const;
+
+  /// Look \p Key up in the table and append the .debug_info offsets of the
+  /// DIEs it names to \p DIEOffsets. Only the hash bucket for \p Key is
+  /// visited, so this is cheap even for very large tables.
+  void lookup(StringRef Key, SmallVectorImpl<uint32_t> &DIEOffsets) const;
 };
 
 }
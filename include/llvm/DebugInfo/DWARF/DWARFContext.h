@@ -22,6 +22,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFDebugRangeList.h"
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/DebugInfo/DWARF/DWARFTypeUnit.h"
+#include <deque>
 
 namespace llvm {
 
@@ -55,6 +56,9 @@ class DWARFContext : public DIContext {
   std::unique_ptr<DWARFDebugAbbrev> AbbrevDWO;
   std::unique_ptr<DWARFDebugLocDWO> LocDWO;
 
+  /// Number of threads used to build the address map.
+  unsigned NumThreads = 1;
+
   DWARFContext(DWARFContext &) = delete;
   DWARFContext &operator=(DWARFContext &) = delete;
 
@@ -166,6 +170,24 @@ public:
   /// Get a pointer to the parsed DebugAranges object.
   const DWARFDebugAranges *getDebugAranges();
 
+  /// Return the compile unit that includes an offset (relative to .debug_info).
+  /// Only the unit headers are read; the DIEs of the unit are left unparsed.
+  DWARFCompileUnit *getCompileUnitForOffset(uint32_t Offset);
+
+  /// Return the compile unit which contains instruction with provided
+  /// address.
+  DWARFCompileUnit *getCompileUnitForAddress(uint64_t Address);
+
+  /// Look \p Name up in the Apple accelerator tables and append the
+  /// .debug_info offsets of the DIEs with that name to \p DIEOffsets, sorted
+  /// and without duplicates.
+  void lookupAppleName(StringRef Name, SmallVectorImpl<uint32_t> &DIEOffsets);
+
+  /// Use \p N threads when the address map has to be built by scanning the
+  /// compile units that .debug_aranges does not cover.  This must be set
+  /// before the first address lookup.
+  void setNumThreads(unsigned N) { NumThreads = N; }
+
   /// Get a pointer to the parsed frame information object.
   const DWARFDebugFrame *getDebugFrame();
 
@@ -214,7 +236,9 @@ public:
   virtual StringRef getStringDWOSection() = 0;
   virtual StringRef getStringOffsetDWOSection() = 0;
   virtual StringRef getRangeDWOSection() = 0;
-  virtual StringRef getAddrSection() = 0;
+  virtual const DWARFSection &getAddrSection() = 0;
+  // The DWARF 5 string offsets table of non-split units.
+  virtual const DWARFSection &getStringOffsetSection() = 0;
   virtual const DWARFSection& getAppleNamesSection() = 0;
   virtual const DWARFSection& getAppleTypesSection() = 0;
   virtual const DWARFSection& getAppleNamespacesSection() = 0;
@@ -225,13 +249,6 @@ public:
   static bool isSupportedVersion(unsigned version) {
     return version == 2 || version == 3 || version == 4 || version == 5;
   }
-private:
-  /// Return the compile unit that includes an offset (relative to .debug_info).
-  DWARFCompileUnit *getCompileUnitForOffset(uint32_t Offset);
-
-  /// Return the compile unit which contains instruction with provided
-  /// address.
-  DWARFCompileUnit *getCompileUnitForAddress(uint64_t Address);
 };
 
 /// DWARFContextInMemory is the simplest possible implementation of a
@@ -266,7 +283,8 @@ class DWARFContextInMemory : public DWARFContext {
   StringRef StringDWOSection;
   StringRef StringOffsetDWOSection;
   StringRef RangeDWOSection;
-  StringRef AddrSection;
+  DWARFSection AddrSection;
+  DWARFSection StringOffsetSection;
   DWARFSection AppleNamesSection;
   DWARFSection AppleTypesSection;
   DWARFSection AppleNamespacesSection;
@@ -274,7 +292,9 @@ class DWARFContextInMemory : public DWARFContext {
   StringRef CUIndexSection;
   StringRef TUIndexSection;
 
-  SmallVector<SmallString<32>, 4> UncompressedSections;
+  /// Storage for the decompressed copies of compressed sections. A deque is
+  /// used because the section StringRefs point into its elements.
+  std::deque<SmallString<0>> UncompressedSections;
 
 public:
   DWARFContextInMemory(const object::ObjectFile &Obj,
@@ -314,9 +334,12 @@ public:
     return StringOffsetDWOSection;
   }
   StringRef getRangeDWOSection() override { return RangeDWOSection; }
-  StringRef getAddrSection() override {
+  const DWARFSection &getAddrSection() override {
     return AddrSection;
   }
+  const DWARFSection &getStringOffsetSection() override {
+    return StringOffsetSection;
+  }
   StringRef getCUIndexSection() override { return CUIndexSection; }
   StringRef getTUIndexSection() override { return TUIndexSection; }
 };
@@ -20,7 +20,10 @@ class DWARFContext;
 
 class DWARFDebugAranges {
 public:
-  void generate(DWARFContext *CTX);
+  /// Build the address map from .debug_aranges, falling back to scanning
+  /// the DIEs of the compile units it does not describe.  The scan is spread
+  /// over \p NumThreads threads, one compile unit at a time.
+  void generate(DWARFContext *CTX, unsigned NumThreads = 1);
   uint32_t findAddress(uint64_t Address) const;
 
 private:
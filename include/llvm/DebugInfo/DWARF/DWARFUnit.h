@@ -111,6 +111,7 @@ class DWARFUnit {
   StringRef LineSection;
   StringRef StringSection;
   StringRef StringOffsetSection;
+  uint32_t StringOffsetSectionBase;
   StringRef AddrOffsetSection;
   uint32_t AddrOffsetSectionBase;
   bool isLittleEndian;
@@ -166,6 +167,9 @@ public:
     RangeSectionBase = Base;
   }
 
+  /// Apply the relocation, if any, recorded at \p Offset in \p Relocs.
+  uint64_t getRelocatedValue(const RelocAddrMap &Relocs, uint32_t Offset,
+                             uint64_t Value) const;
   bool getAddrOffsetSectionItem(uint32_t Index, uint64_t &Result) const;
   // FIXME: Result should be uint64_t in DWARF64.
   bool getStringOffsetSectionItem(uint32_t Index, uint32_t &Result) const;
@@ -11,13 +11,14 @@
 #define LLVM_DEBUGINFO_PDB_RAW_MAPPEDBLOCKSTREAM_H
 
 #include "llvm/ADT/ArrayRef.h"
-#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/DebugInfo/CodeView/StreamInterface.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
 #include <cstdint>
+#include <map>
+#include <mutex>
 #include <vector>
 
 namespace llvm {
@@ -55,9 +56,17 @@ protected:
   const IPDBFile &Pdb;
   std::unique_ptr<IPDBStreamData> Data;
 
+  /// Reads that span discontiguous blocks are copied into the pool and kept,
+  /// keyed by stream offset, so that later reads of the same or a contained
+  /// range reuse the copy. The map is ordered so that a request only has to
+  /// look at the allocations starting at most MaxCachedSize bytes before it.
   typedef MutableArrayRef<uint8_t> CacheEntry;
   mutable llvm::BumpPtrAllocator Pool;
-  mutable DenseMap<uint32_t, std::vector<CacheEntry>> CacheMap;
+  mutable std::map<uint32_t, std::vector<CacheEntry>> CacheMap;
+  mutable uint32_t MaxCachedSize = 0;
+  /// Guards the pool and the cache, so that a stream can be read from several
+  /// threads.
+  mutable std::mutex CacheMutex;
 };
 
 } // end namespace pdb
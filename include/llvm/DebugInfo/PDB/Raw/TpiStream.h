@@ -47,6 +47,11 @@ public:
   codeview::FixedStreamArray<TypeIndexOffset> getTypeIndexOffsets() const;
   codeview::FixedStreamArray<TypeIndexOffset> getHashAdjustments() const;
 
+  /// Return the record for type \p Index. The record is found through the
+  /// type index offsets of the hash stream, so only the records between the
+  /// nearest indexed one and \p Index are parsed.
+  Expected<codeview::CVType> getTypeRecord(codeview::TypeIndex Index) const;
+
   iterator_range<codeview::CVTypeArray::Iterator> types(bool *HadError) const;
 
 private:
@@ -36,6 +36,13 @@ public:
     bool RelativeAddresses : 1;
     std::string DefaultArch;
     std::vector<std::string> DsymHints;
+    /// Number of threads used to build the address map of a module whose
+    /// .debug_aranges is missing or incomplete.
+    unsigned DWARFThreads = 1;
+    /// Maximum number of modules kept loaded at once. When a new module is
+    /// loaded past this limit the least recently used one is released.
+    /// Zero means no limit.
+    unsigned MaxCachedModules = 0;
     Options(FunctionNameKind PrintFunctions = FunctionNameKind::LinkageName,
             bool UseSymbolTable = true, bool Demangle = true,
             bool RelativeAddresses = false, std::string DefaultArch = "")
@@ -88,8 +95,17 @@ private:
   Expected<ObjectFile *> getOrCreateObject(const std::string &Path,
                                           const std::string &ArchName);
 
+  /// \brief Releases least recently used modules until there is room for one
+  /// more entry in Modules.
+  void pruneModuleCache();
+
   std::map<std::string, std::unique_ptr<SymbolizableModule>> Modules;
 
+  /// \brief Last use stamp for each entry of Modules, used to pick the module
+  /// to release when Options.MaxCachedModules is exceeded.
+  std::map<std::string, uint64_t> ModuleLastUse;
+  uint64_t ModuleUseCounter = 0;
+
   /// \brief Contains cached results of getOrCreateObjectPair().
   std::map<std::pair<std::string, std::string>, ObjectPair>
       ObjectPairForPathArch;
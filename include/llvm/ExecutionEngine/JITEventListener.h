@@ -16,6 +16,7 @@
 #define LLVM_EXECUTIONENGINE_JITEVENTLISTENER_H
 
 #include "RuntimeDyld.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/IR/DebugLoc.h"
 #include "llvm/Support/DataTypes.h"
@@ -113,6 +114,23 @@ public:
     return nullptr;
   }
 #endif // USE_OPROFILE
+
+#if defined(LLVM_USE_PERF) && LLVM_USE_PERF
+  // Construct a PerfJITEventListener, which writes /tmp/perf-PID.map and a
+  // jitdump file in $JITDUMPDIR (or /tmp) for Linux perf.
+  static JITEventListener *createPerfJITEventListener();
+
+  // Construct a PerfJITEventListener that writes to the given files
+  static JITEventListener *createPerfJITEventListener(StringRef PerfMapPath,
+                                                      StringRef JitDumpPath);
+#else
+  static JITEventListener *createPerfJITEventListener() { return nullptr; }
+
+  static JITEventListener *createPerfJITEventListener(StringRef PerfMapPath,
+                                                      StringRef JitDumpPath) {
+    return nullptr;
+  }
+#endif // USE_PERF
 private:
   virtual void anchor();
 };
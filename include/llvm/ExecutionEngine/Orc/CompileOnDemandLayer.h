@@ -15,9 +15,11 @@
 #ifndef LLVM_EXECUTIONENGINE_ORC_COMPILEONDEMANDLAYER_H
 #define LLVM_EXECUTIONENGINE_ORC_COMPILEONDEMANDLAYER_H
 
+#include "ConcurrentSymbolTable.h"
 #include "IndirectionUtils.h"
 #include "LambdaResolver.h"
 #include "LogicalDylib.h"
+#include "OrcError.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Transforms/Utils/Cloning.h"
@@ -206,7 +208,12 @@ public:
     for (auto &M : Ms)
       addLogicalModule(LogicalDylibs.back(), std::move(M));
 
-    return std::prev(LogicalDylibs.end());
+    // Index the new symbols. Names defined by earlier module sets keep
+    // resolving to those, as they would if the sets were searched in order.
+    auto H = std::prev(LogicalDylibs.end());
+    H->forEachSymbol([&](StringRef Name) { SymbolIndex.insert(Name, H); });
+
+    return H;
   }
 
   /// @brief Remove the module represented by the given handle.
@@ -214,7 +221,25 @@ public:
   ///   This will remove all modules in the layers below that were derived from
   /// the module represented by H.
   void removeModuleSet(ModuleSetHandleT H) {
+    std::vector<std::string> Names;
+    H->forEachSymbol([&](StringRef Name) {
+      ModuleSetHandleT Owner;
+      if (SymbolIndex.lookup(Name, Owner) && Owner == H)
+        Names.push_back(Name);
+    });
+
     LogicalDylibs.erase(H);
+
+    // Hand each name H owned to the next module set that defines it, if any.
+    for (auto &Name : Names) {
+      SymbolIndex.erase(Name);
+      for (auto LDI = LogicalDylibs.begin(), LDE = LogicalDylibs.end();
+           LDI != LDE; ++LDI)
+        if (LDI->definesSymbol(Name)) {
+          SymbolIndex.insert(Name, LDI);
+          break;
+        }
+    }
   }
 
   /// @brief Search for the given named symbol.
@@ -222,10 +247,17 @@ public:
   /// @param ExportedSymbolsOnly If true, search only for exported symbols.
   /// @return A handle for the given named symbol, if it exists.
   JITSymbol findSymbol(StringRef Name, bool ExportedSymbolsOnly) {
-    for (auto LDI = LogicalDylibs.begin(), LDE = LogicalDylibs.end();
-         LDI != LDE; ++LDI)
-      if (auto Symbol = findSymbolIn(LDI, Name, ExportedSymbolsOnly))
+    ModuleSetHandleT H;
+    if (SymbolIndex.lookup(Name, H)) {
+      if (auto Symbol = findSymbolIn(H, Name, ExportedSymbolsOnly))
         return Symbol;
+
+      // The first definition isn't exported. Some later one may be.
+      for (auto LDI = std::next(H), LDE = LogicalDylibs.end(); LDI != LDE;
+           ++LDI)
+        if (auto Symbol = findSymbolIn(LDI, Name, ExportedSymbolsOnly))
+          return Symbol;
+    }
     return BaseLayer.findSymbol(Name, ExportedSymbolsOnly);
   }
 
@@ -236,6 +268,20 @@ public:
     return H->findSymbol(Name, ExportedSymbolsOnly);
   }
 
+  /// @brief Point the stub for the function with the given mangled name at
+  ///        FnBodyAddr.
+  ///
+  ///   This can be used to replace a function body once it has been compiled,
+  /// for example by a faster version produced by a re-optimizing JIT.
+  Error updatePointer(const std::string &FuncName, TargetAddress FnBodyAddr) {
+    ModuleSetHandleT H;
+    if (SymbolIndex.lookup(FuncName, H))
+      if (auto *LMResources =
+            H->getLogicalModuleResourcesForSymbol(FuncName, false))
+        return LMResources->StubsMgr->updatePointer(FuncName, FnBodyAddr);
+    return orcError(OrcErrorCode::JITSymbolNotFound);
+  }
+
 private:
 
   template <typename ModulePtrT>
@@ -270,7 +316,10 @@ private:
         // and set the compile action to compile the partition containing the
         // function.
         auto CCInfo = CompileCallbackMgr.getCompileCallback();
-        StubInits[mangle(F.getName(), DL)] =
+        std::string Name = mangle(F.getName(), DL);
+        LD.addSymbolToLogicalModule(LMH, Name);
+        LD.addSymbolToLogicalModule(LMH, Name + "$stub_ptr");
+        StubInits[Name] =
           std::make_pair(CCInfo.getAddress(),
                          JITSymbolBase::flagsFromGlobalValue(F));
         CCInfo.setCompileAction([this, &LD, LMH, &F]() {
@@ -301,13 +350,17 @@ private:
 
     // Clone global variable decls.
     for (auto &GV : SrcM.globals())
-      if (!GV.isDeclaration() && !VMap.count(&GV))
+      if (!GV.isDeclaration() && !VMap.count(&GV)) {
         cloneGlobalVariableDecl(*GVsM, GV, &VMap);
+        LD.addSymbolToLogicalModule(LMH, mangle(GV.getName(), DL));
+      }
 
     // And the aliases.
     for (auto &A : SrcM.aliases())
-      if (!VMap.count(&A))
+      if (!VMap.count(&A)) {
         cloneGlobalAliasDecl(*GVsM, A, VMap);
+        LD.addSymbolToLogicalModule(LMH, mangle(A.getName(), DL));
+      }
 
     // Now we need to clone the GV and alias initializers.
 
@@ -506,6 +559,7 @@ private:
   IndirectStubsManagerBuilderT CreateIndirectStubsManager;
 
   LogicalDylibList LogicalDylibs;
+  ConcurrentSymbolTable<ModuleSetHandleT> SymbolIndex;
   bool CloneStubsIntoPartitions;
 };
 
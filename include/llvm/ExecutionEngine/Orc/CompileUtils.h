@@ -19,6 +19,9 @@
 #include "llvm/MC/MCContext.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Target/TargetMachine.h"
+#include <functional>
+#include <memory>
+#include <mutex>
 
 namespace llvm {
 namespace orc {
@@ -56,6 +59,63 @@ private:
   TargetMachine &TM;
 };
 
+/// @brief Compile functor that builds its pass pipeline once and reuses it,
+///        along with the pipeline's MCContext, for every module it compiles.
+///
+///   SimpleCompiler sets up a new pass manager and code generator for every
+/// module, which is most of the cost of compiling a small module. The
+/// objects produced are the same. Copies of a ReusableCompiler share one
+/// pipeline, and compiles through it are serialized.
+class ReusableCompiler {
+public:
+  typedef std::function<void(legacy::PassManagerBase &)> AddIRPassesFtor;
+
+  /// @brief Construct a compile functor with the given target. If AddIRPasses
+  ///        is given, it is called once to add the IR passes to run on each
+  ///        module before code generation, e.g. with
+  ///        PassManagerBuilder::populateJITPassManager.
+  ReusableCompiler(TargetMachine &TM, AddIRPassesFtor AddIRPasses = nullptr)
+      : P(std::make_shared<Pipeline>(TM, std::move(AddIRPasses))) {}
+
+  /// @brief Compile a Module to an ObjectFile.
+  object::OwningBinary<object::ObjectFile> operator()(Module &M) const {
+    std::lock_guard<std::mutex> Lock(P->PipelineMutex);
+    P->PM.run(M);
+    std::unique_ptr<MemoryBuffer> ObjBuffer(
+        new ObjectMemoryBuffer(std::move(P->ObjBufferSV)));
+    P->ObjBufferSV.clear();
+    Expected<std::unique_ptr<object::ObjectFile>> Obj =
+        object::ObjectFile::createObjectFile(ObjBuffer->getMemBufferRef());
+    typedef object::OwningBinary<object::ObjectFile> OwningObj;
+    if (Obj)
+      return OwningObj(std::move(*Obj), std::move(ObjBuffer));
+    // TODO: Actually report errors helpfully.
+    consumeError(Obj.takeError());
+    return OwningObj(nullptr, nullptr);
+  }
+
+private:
+  struct Pipeline {
+    Pipeline(TargetMachine &TM, AddIRPassesFtor AddIRPasses)
+        : ObjStream(ObjBufferSV) {
+      if (AddIRPasses)
+        AddIRPasses(PM);
+      MCContext *Ctx;
+      if (TM.addPassesToEmitMC(PM, Ctx, ObjStream))
+        llvm_unreachable("Target does not support MC emission.");
+    }
+
+    std::mutex PipelineMutex;
+    // The code generator writes each object through ObjStream into
+    // ObjBufferSV, whose contents are moved out after every run.
+    SmallVector<char, 0> ObjBufferSV;
+    raw_svector_ostream ObjStream;
+    legacy::PassManager PM;
+  };
+
+  std::shared_ptr<Pipeline> P;
+};
+
 } // End namespace orc.
 } // End namespace llvm.
 
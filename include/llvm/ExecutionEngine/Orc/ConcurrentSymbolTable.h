@@ -0,0 +1,125 @@
+//===- ConcurrentSymbolTable.h - Read-mostly symbol table -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A string keyed table for the symbol indexes of the ORC layers, which is
+// safe to read and update from several threads at once.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_CONCURRENTSYMBOLTABLE_H
+#define LLVM_EXECUTIONENGINE_ORC_CONCURRENTSYMBOLTABLE_H
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/RWMutex.h"
+
+namespace llvm {
+namespace orc {
+
+/// @brief Map from symbol names to values, for concurrent, read-mostly use.
+///
+///   The names are spread over 2^LogNumShards StringMaps by hash, each guarded
+/// by its own reader/writer lock, so lookups are constant time, never wait for
+/// each other, and only wait for updates to the same shard.
+template <typename ValueT, unsigned LogNumShards = 4>
+class ConcurrentSymbolTable {
+public:
+  ConcurrentSymbolTable() = default;
+
+  /// @brief Move the contents of Other into a new table. Other must not be in
+  ///        use by any other thread.
+  ConcurrentSymbolTable(ConcurrentSymbolTable &&Other) {
+    for (unsigned I = 0; I != NumShards; ++I)
+      Shards[I].Symbols = std::move(Other.Shards[I].Symbols);
+  }
+
+  /// @brief Map Name to V, unless Name is already in the table.
+  /// @return true if Name was added.
+  bool insert(StringRef Name, ValueT V) {
+    Shard &S = getShard(Name);
+    sys::SmartScopedWriter<true> Lock(S.Mutex);
+    return S.Symbols.insert(std::make_pair(Name, std::move(V))).second;
+  }
+
+  /// @brief Map Name to V, replacing any value it had.
+  void set(StringRef Name, ValueT V) {
+    Shard &S = getShard(Name);
+    sys::SmartScopedWriter<true> Lock(S.Mutex);
+    S.Symbols[Name] = std::move(V);
+  }
+
+  /// @brief Remove Name from the table.
+  /// @return true if Name was in the table.
+  bool erase(StringRef Name) {
+    Shard &S = getShard(Name);
+    sys::SmartScopedWriter<true> Lock(S.Mutex);
+    return S.Symbols.erase(Name);
+  }
+
+  /// @brief Look Name up, copying its value into V if it is found.
+  /// @return true if Name is in the table.
+  bool lookup(StringRef Name, ValueT &V) const {
+    const Shard &S = getShard(Name);
+    sys::SmartScopedReader<true> Lock(S.Mutex);
+    auto I = S.Symbols.find(Name);
+    if (I == S.Symbols.end())
+      return false;
+    V = I->second;
+    return true;
+  }
+
+  /// @brief Return the number of names in the table.
+  size_t size() const {
+    size_t Size = 0;
+    for (const Shard &S : Shards) {
+      sys::SmartScopedReader<true> Lock(S.Mutex);
+      Size += S.Symbols.size();
+    }
+    return Size;
+  }
+
+  /// @brief Call Fn(Name, Value) for each entry of the table. Fn must not
+  ///        update the table.
+  template <typename FnT> void forEach(FnT Fn) const {
+    for (const Shard &S : Shards) {
+      sys::SmartScopedReader<true> Lock(S.Mutex);
+      for (const auto &KV : S.Symbols)
+        Fn(KV.first(), KV.second);
+    }
+  }
+
+private:
+  static const unsigned NumShards = 1U << LogNumShards;
+  static_assert(LogNumShards > 0 && LogNumShards < 16,
+                "Unreasonable number of shards");
+
+  struct Shard {
+    mutable sys::SmartRWMutex<true> Mutex;
+    StringMap<ValueT> Symbols;
+  };
+
+  // StringMap picks buckets with the low bits of HashString, so take the shard
+  // number from the top bits of a multiplicative rehash instead. Otherwise
+  // each shard would only ever fill a fraction of its buckets.
+  static unsigned getShardIndex(StringRef Name) {
+    return (HashString(Name) * 0x9E3779B1U) >> (32 - LogNumShards);
+  }
+
+  Shard &getShard(StringRef Name) { return Shards[getShardIndex(Name)]; }
+  const Shard &getShard(StringRef Name) const {
+    return Shards[getShardIndex(Name)];
+  }
+
+  Shard Shards[NumShards];
+};
+
+} // End namespace orc.
+} // End namespace llvm.
+
+#endif // LLVM_EXECUTIONENGINE_ORC_CONCURRENTSYMBOLTABLE_H
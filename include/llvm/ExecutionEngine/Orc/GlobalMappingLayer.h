@@ -15,8 +15,8 @@
 #ifndef LLVM_EXECUTIONENGINE_ORC_GLOBALMAPPINGLAYER_H
 #define LLVM_EXECUTIONENGINE_ORC_GLOBALMAPPINGLAYER_H
 
+#include "ConcurrentSymbolTable.h"
 #include "JITSymbol.h"
-#include <map>
 
 namespace llvm {
 namespace orc {
@@ -28,6 +28,8 @@ namespace orc {
 /// mappings into the JIT. Beware, however: symbols within a single IR module or
 /// object file will still resolve locally (via RuntimeDyld's symbol table) -
 /// such internal references cannot be overriden via this layer.
+///
+///   Mappings may be set, erased and looked up from several threads at once.
 template <typename BaseLayerT>
 class GlobalMappingLayer {
 public:
@@ -53,7 +55,7 @@ public:
 
   /// @brief Manually set the address to return for the given symbol.
   void setGlobalMapping(const std::string &Name, TargetAddress Addr) {
-    SymbolTable[Name] = Addr;
+    SymbolTable.set(Name, Addr);
   }
 
   /// @brief Remove the given symbol from the global mapping.
@@ -71,9 +73,9 @@ public:
   /// @param ExportedSymbolsOnly If true, search only for exported symbols.
   /// @return A handle for the given named symbol, if it exists.
   JITSymbol findSymbol(const std::string &Name, bool ExportedSymbolsOnly) {
-    auto I = SymbolTable.find(Name);
-    if (I != SymbolTable.end())
-      return JITSymbol(I->second, JITSymbolFlags::Exported);
+    TargetAddress Addr;
+    if (SymbolTable.lookup(Name, Addr))
+      return JITSymbol(Addr, JITSymbolFlags::Exported);
     return BaseLayer.findSymbol(Name, ExportedSymbolsOnly);
   }
 
@@ -99,7 +101,7 @@ public:
 
 private:
   BaseLayerT &BaseLayer;
-  std::map<std::string, TargetAddress> SymbolTable;
+  ConcurrentSymbolTable<TargetAddress> SymbolTable;
 };
 
 } // End namespace orc.
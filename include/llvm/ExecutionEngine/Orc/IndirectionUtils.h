@@ -16,17 +16,27 @@
 
 #include "JITSymbol.h"
 #include "LambdaResolver.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
 
 namespace llvm {
 namespace orc {
 
 /// @brief Target-independent base class for compile callback management.
+///
+///   Each trampoline is given a callback id when it is first created, and the
+/// callbacks are kept in a table indexed by that id, so reserving, running
+/// and releasing a callback never allocates. The manager may be used from
+/// several threads at once; compile actions run without its lock held.
 class JITCompileCallbackManager {
 public:
   typedef std::function<TargetAddress()> CompileFtor;
@@ -60,42 +70,47 @@ public:
   /// @brief Execute the callback for the given trampoline id. Called by the JIT
   ///        to compile functions on demand.
   TargetAddress executeCompileCallback(TargetAddress TrampolineAddr) {
-    auto I = ActiveTrampolines.find(TrampolineAddr);
-    // FIXME: Also raise an error in the Orc error-handler when we finally have
-    //        one.
-    if (I == ActiveTrampolines.end())
-      return ErrorHandlerAddress;
-
-    // Found a callback handler. Yank this trampoline out of the active list and
-    // put it back in the available trampolines list, then try to run the
-    // handler's compile and update actions.
-    // Moving the trampoline ID back to the available list first means there's
-    // at
-    // least one available trampoline if the compile action triggers a request
-    // for
-    // a new one.
-    auto Compile = std::move(I->second);
-    ActiveTrampolines.erase(I);
-    AvailableTrampolines.push_back(TrampolineAddr);
-
-    if (auto Addr = Compile())
-      return Addr;
+    CompileFtor Compile;
+    {
+      std::lock_guard<std::mutex> Lock(CallbacksMutex);
+      auto I = TrampolineIds.find(TrampolineAddr);
+      // FIXME: Also raise an error in the Orc error-handler when we finally
+      //        have one.
+      if (I == TrampolineIds.end() || !Callbacks[I->second].Active)
+        return ErrorHandlerAddress;
+
+      // Found a callback handler. Put the trampoline back in the available
+      // list before running the compile action, so that there's at least one
+      // available trampoline if the action requests a new one.
+      Compile = std::move(Callbacks[I->second].Compile);
+      releaseCallback(I->second);
+    }
+
+    if (Compile)
+      if (auto Addr = Compile())
+        return Addr;
 
     return ErrorHandlerAddress;
   }
 
   /// @brief Reserve a compile callback.
   CompileCallbackInfo getCompileCallback() {
-    TargetAddress TrampolineAddr = getAvailableTrampolineAddr();
-    auto &Compile = this->ActiveTrampolines[TrampolineAddr];
-    return CompileCallbackInfo(TrampolineAddr, Compile);
+    std::lock_guard<std::mutex> Lock(CallbacksMutex);
+    if (AvailableTrampolines.empty())
+      grow();
+    assert(!AvailableTrampolines.empty() &&
+           "Failed to grow available trampolines.");
+    unsigned Id = AvailableTrampolines.back();
+    AvailableTrampolines.pop_back();
+    Callbacks[Id].Active = true;
+    return CompileCallbackInfo(TrampolineAddrs[Id], Callbacks[Id].Compile);
   }
 
   /// @brief Get a CompileCallbackInfo for an existing callback.
   CompileCallbackInfo getCompileCallbackInfo(TargetAddress TrampolineAddr) {
-    auto I = ActiveTrampolines.find(TrampolineAddr);
-    assert(I != ActiveTrampolines.end() && "Not an active trampoline.");
-    return CompileCallbackInfo(I->first, I->second);
+    std::lock_guard<std::mutex> Lock(CallbacksMutex);
+    unsigned Id = getActiveCallbackId(TrampolineAddr);
+    return CompileCallbackInfo(TrampolineAddr, Callbacks[Id].Compile);
   }
 
   /// @brief Release a compile callback.
@@ -104,34 +119,57 @@ public:
   /// only be called to manually release a callback that is not going to
   /// execute.
   void releaseCompileCallback(TargetAddress TrampolineAddr) {
-    auto I = ActiveTrampolines.find(TrampolineAddr);
-    assert(I != ActiveTrampolines.end() && "Not an active trampoline.");
-    ActiveTrampolines.erase(I);
-    AvailableTrampolines.push_back(TrampolineAddr);
+    std::lock_guard<std::mutex> Lock(CallbacksMutex);
+    releaseCallback(getActiveCallbackId(TrampolineAddr));
   }
 
 protected:
-  TargetAddress ErrorHandlerAddress;
+  /// @brief Make a newly created trampoline available for use. Called by
+  ///        grow(), which runs with the manager's lock held.
+  void addTrampoline(TargetAddress TrampolineAddr) {
+    unsigned Id = TrampolineAddrs.size();
+    assert(!TrampolineIds.count(TrampolineAddr) && "Duplicate trampoline");
+    TrampolineIds[TrampolineAddr] = Id;
+    TrampolineAddrs.push_back(TrampolineAddr);
+    Callbacks.emplace_back();
+    AvailableTrampolines.push_back(Id);
+  }
 
-  typedef std::map<TargetAddress, CompileFtor> TrampolineMapT;
-  TrampolineMapT ActiveTrampolines;
-  std::vector<TargetAddress> AvailableTrampolines;
+  TargetAddress ErrorHandlerAddress;
 
 private:
-  TargetAddress getAvailableTrampolineAddr() {
-    if (this->AvailableTrampolines.empty())
-      grow();
-    assert(!this->AvailableTrampolines.empty() &&
-           "Failed to grow available trampolines.");
-    TargetAddress TrampolineAddr = this->AvailableTrampolines.back();
-    this->AvailableTrampolines.pop_back();
-    return TrampolineAddr;
+  struct CallbackEntry {
+    CallbackEntry() : Active(false) {}
+    CompileFtor Compile;
+    bool Active;
+  };
+
+  unsigned getActiveCallbackId(TargetAddress TrampolineAddr) const {
+    auto I = TrampolineIds.find(TrampolineAddr);
+    assert(I != TrampolineIds.end() && Callbacks[I->second].Active &&
+           "Not an active trampoline.");
+    return I->second;
   }
 
-  // Create new trampolines - to be implemented in subclasses.
+  void releaseCallback(unsigned Id) {
+    Callbacks[Id].Compile = nullptr;
+    Callbacks[Id].Active = false;
+    AvailableTrampolines.push_back(Id);
+  }
+
+  // Create new trampolines and pass each one to addTrampoline - to be
+  // implemented in subclasses.
   virtual void grow() = 0;
 
   virtual void anchor();
+
+  std::mutex CallbacksMutex;
+  DenseMap<TargetAddress, unsigned> TrampolineIds;
+  std::vector<TargetAddress> TrampolineAddrs;
+  // A deque, so that the CompileFtor references handed out in
+  // CompileCallbackInfos stay valid as more trampolines are added.
+  std::deque<CallbackEntry> Callbacks;
+  std::vector<unsigned> AvailableTrampolines;
 };
 
 /// @brief Manage compile callbacks for in-process JITs.
@@ -169,8 +207,6 @@ private:
   }
 
   void grow() override {
-    assert(this->AvailableTrampolines.empty() && "Growing prematurely?");
-
     std::error_code EC;
     auto TrampolineBlock =
         sys::OwningMemoryBlock(sys::Memory::allocateMappedMemory(
@@ -187,7 +223,7 @@ private:
                               NumTrampolines);
 
     for (unsigned I = 0; I < NumTrampolines; ++I)
-      this->AvailableTrampolines.push_back(
+      this->addTrampoline(
           static_cast<TargetAddress>(reinterpret_cast<uintptr_t>(
               TrampolineMem + (I * TargetT::TrampolineSize))));
 
@@ -234,38 +270,128 @@ private:
   virtual void anchor();
 };
 
+/// @brief A pool of indirect stubs for the host architecture, e.g.
+///        OrcX86_64_SysV. (See OrcABISupport.h).
+///
+///   LocalIndirectStubsManagers that share a pool take their stubs from the
+/// same blocks, so that a manager holding a handful of stubs doesn't tie up
+/// whole pages of them. Blocks grow geometrically, so creating many stubs
+/// takes a logarithmic number of allocations. The pool is thread safe.
+template <typename TargetT> class LocalIndirectStubsPool {
+public:
+  /// @brief A stub: the index of its block, and its index in the block.
+  typedef std::pair<uint32_t, uint32_t> StubKey;
+
+  /// @brief Append NumStubs free stubs to Keys.
+  Error allocateStubs(unsigned NumStubs, std::vector<StubKey> &Keys) {
+    std::lock_guard<std::mutex> Lock(PoolMutex);
+    if (NumStubs > FreeStubs.size()) {
+      unsigned NewStubsRequired = NumStubs - FreeStubs.size();
+      unsigned NewBlockId = IndirectStubsInfos.size();
+      typename TargetT::IndirectStubsInfo ISI;
+      unsigned MinStubs = std::max<unsigned>(
+          NewStubsRequired, std::min<unsigned>(NumAllocated, MaxGrowth));
+      if (auto Err = TargetT::emitIndirectStubsBlock(ISI, MinStubs, nullptr))
+        return Err;
+      NumAllocated += ISI.getNumStubs();
+      // Push the new stubs in reverse, so they're handed out in address order.
+      for (unsigned I = ISI.getNumStubs(); I != 0; --I)
+        FreeStubs.push_back(std::make_pair(NewBlockId, I - 1));
+      IndirectStubsInfos.push_back(std::move(ISI));
+    }
+    Keys.insert(Keys.end(), FreeStubs.end() - NumStubs, FreeStubs.end());
+    FreeStubs.resize(FreeStubs.size() - NumStubs);
+    return Error::success();
+  }
+
+  /// @brief Return stubs to the pool.
+  void releaseStubs(const std::vector<StubKey> &Keys) {
+    std::lock_guard<std::mutex> Lock(PoolMutex);
+    FreeStubs.insert(FreeStubs.end(), Keys.begin(), Keys.end());
+  }
+
+  /// @brief Get the address of a stub.
+  void *getStub(StubKey Key) {
+    std::lock_guard<std::mutex> Lock(PoolMutex);
+    return IndirectStubsInfos[Key.first].getStub(Key.second);
+  }
+
+  /// @brief Get the address of a stub's implementation pointer.
+  void **getPtr(StubKey Key) {
+    std::lock_guard<std::mutex> Lock(PoolMutex);
+    return IndirectStubsInfos[Key.first].getPtr(Key.second);
+  }
+
+private:
+  // Stop doubling once a block holds this many stubs.
+  enum : unsigned { MaxGrowth = 1 << 16 };
+
+  std::mutex PoolMutex;
+  std::vector<typename TargetT::IndirectStubsInfo> IndirectStubsInfos;
+  std::vector<StubKey> FreeStubs;
+  unsigned NumAllocated = 0;
+};
+
 /// @brief IndirectStubsManager implementation for the host architecture, e.g.
 ///        OrcX86_64. (See OrcArchitectureSupport.h).
+///
+///   Stubs come from a LocalIndirectStubsPool, which may be shared with other
+/// managers, and go back to it when the manager is destroyed. Stubs may be
+/// created, found and updated from several threads at once. Updating a stub
+/// is a single pointer-sized store, so code calling through the stub at the
+/// same time jumps to either the old or the new address.
 template <typename TargetT>
 class LocalIndirectStubsManager : public IndirectStubsManager {
 public:
+  typedef LocalIndirectStubsPool<TargetT> PoolT;
+
+  /// @brief Construct a manager with a pool of its own.
+  LocalIndirectStubsManager() : Pool(std::make_shared<PoolT>()) {}
+
+  /// @brief Construct a manager that takes its stubs from the given pool.
+  LocalIndirectStubsManager(std::shared_ptr<PoolT> Pool)
+      : Pool(std::move(Pool)) {}
+
+  ~LocalIndirectStubsManager() override {
+    std::vector<StubKey> Keys;
+    Keys.reserve(StubIndexes.size());
+    for (auto &Entry : StubIndexes)
+      Keys.push_back(Entry.second.first);
+    Pool->releaseStubs(Keys);
+  }
+
   Error createStub(StringRef StubName, TargetAddress StubAddr,
                    JITSymbolFlags StubFlags) override {
-    if (auto Err = reserveStubs(1))
+    std::lock_guard<std::mutex> Lock(StubsMutex);
+    std::vector<StubKey> Keys;
+    if (auto Err = Pool->allocateStubs(1, Keys))
       return Err;
 
-    createStubInternal(StubName, StubAddr, StubFlags);
+    createStubInternal(StubName, StubAddr, StubFlags, Keys[0]);
 
     return Error::success();
   }
 
   Error createStubs(const StubInitsMap &StubInits) override {
-    if (auto Err = reserveStubs(StubInits.size()))
+    std::lock_guard<std::mutex> Lock(StubsMutex);
+    std::vector<StubKey> Keys;
+    if (auto Err = Pool->allocateStubs(StubInits.size(), Keys))
       return Err;
 
+    unsigned I = 0;
     for (auto &Entry : StubInits)
       createStubInternal(Entry.first(), Entry.second.first,
-                         Entry.second.second);
+                         Entry.second.second, Keys[I++]);
 
     return Error::success();
   }
 
   JITSymbol findStub(StringRef Name, bool ExportedStubsOnly) override {
+    std::lock_guard<std::mutex> Lock(StubsMutex);
     auto I = StubIndexes.find(Name);
     if (I == StubIndexes.end())
       return nullptr;
-    auto Key = I->second.first;
-    void *StubAddr = IndirectStubsInfos[Key.first].getStub(Key.second);
+    void *StubAddr = Pool->getStub(I->second.first);
     assert(StubAddr && "Missing stub address");
     auto StubTargetAddr =
         static_cast<TargetAddress>(reinterpret_cast<uintptr_t>(StubAddr));
@@ -276,11 +402,11 @@ public:
   }
 
   JITSymbol findPointer(StringRef Name) override {
+    std::lock_guard<std::mutex> Lock(StubsMutex);
     auto I = StubIndexes.find(Name);
     if (I == StubIndexes.end())
       return nullptr;
-    auto Key = I->second.first;
-    void *PtrAddr = IndirectStubsInfos[Key.first].getPtr(Key.second);
+    void **PtrAddr = Pool->getPtr(I->second.first);
     assert(PtrAddr && "Missing pointer address");
     auto PtrTargetAddr =
         static_cast<TargetAddress>(reinterpret_cast<uintptr_t>(PtrAddr));
@@ -288,43 +414,32 @@ public:
   }
 
   Error updatePointer(StringRef Name, TargetAddress NewAddr) override {
+    std::lock_guard<std::mutex> Lock(StubsMutex);
     auto I = StubIndexes.find(Name);
     assert(I != StubIndexes.end() && "No stub pointer for symbol");
-    auto Key = I->second.first;
-    *IndirectStubsInfos[Key.first].getPtr(Key.second) =
+    *Pool->getPtr(I->second.first) =
         reinterpret_cast<void *>(static_cast<uintptr_t>(NewAddr));
     return Error::success();
   }
 
 private:
-  Error reserveStubs(unsigned NumStubs) {
-    if (NumStubs <= FreeStubs.size())
-      return Error::success();
-
-    unsigned NewStubsRequired = NumStubs - FreeStubs.size();
-    unsigned NewBlockId = IndirectStubsInfos.size();
-    typename TargetT::IndirectStubsInfo ISI;
-    if (auto Err =
-            TargetT::emitIndirectStubsBlock(ISI, NewStubsRequired, nullptr))
-      return Err;
-    for (unsigned I = 0; I < ISI.getNumStubs(); ++I)
-      FreeStubs.push_back(std::make_pair(NewBlockId, I));
-    IndirectStubsInfos.push_back(std::move(ISI));
-    return Error::success();
-  }
+  typedef typename PoolT::StubKey StubKey;
 
   void createStubInternal(StringRef StubName, TargetAddress InitAddr,
-                          JITSymbolFlags StubFlags) {
-    auto Key = FreeStubs.back();
-    FreeStubs.pop_back();
-    *IndirectStubsInfos[Key.first].getPtr(Key.second) =
+                          JITSymbolFlags StubFlags, StubKey Key) {
+    *Pool->getPtr(Key) =
         reinterpret_cast<void *>(static_cast<uintptr_t>(InitAddr));
-    StubIndexes[StubName] = std::make_pair(Key, StubFlags);
+    auto Result = StubIndexes.insert(
+        std::make_pair(StubName, std::make_pair(Key, StubFlags)));
+    // Re-creating a stub replaces it; give the old one back to the pool.
+    if (!Result.second) {
+      Pool->releaseStubs(std::vector<StubKey>(1, Result.first->second.first));
+      Result.first->second = std::make_pair(Key, StubFlags);
+    }
   }
 
-  std::vector<typename TargetT::IndirectStubsInfo> IndirectStubsInfos;
-  typedef std::pair<uint16_t, uint16_t> StubKey;
-  std::vector<StubKey> FreeStubs;
+  std::shared_ptr<PoolT> Pool;
+  std::mutex StubsMutex;
   StringMap<std::pair<StubKey, JITSymbolFlags>> StubIndexes;
 };
 
@@ -339,7 +454,8 @@ createLocalCompileCallbackManager(const Triple &T,
 
 /// @brief Create a local indriect stubs manager builder.
 ///
-/// The given target triple will determine the ABI.
+/// The given target triple will determine the ABI. The managers created by
+/// the builder share one LocalIndirectStubsPool.
 std::function<std::unique_ptr<IndirectStubsManager>()>
 createLocalIndirectStubsManagerBuilder(const Triple &T);
 
@@ -410,6 +526,18 @@ void moveGlobalVariableInitializer(GlobalVariable &OrigGV,
                                    ValueMaterializer *Materializer = nullptr,
                                    GlobalVariable *NewGV = nullptr);
 
+/// @brief Partition F together with the functions it calls directly.
+///
+///   Returns F plus every function defined in F's module that is reachable
+/// from F through at most 'Depth' levels of direct calls. Functions whose
+/// bodies have already been moved out of the module (i.e. that are now
+/// declarations) are skipped. Suitable for use as a CompileOnDemandLayer
+/// partitioning functor: callees are compiled speculatively along with F, and
+/// their stubs are updated at the same time, so the first call to each of
+/// them does not have to go through the compile callback.
+std::set<Function*> partitionWithDirectCallees(Function &F,
+                                               unsigned Depth = 1);
+
 /// @brief Clone
 GlobalAlias *cloneGlobalAliasDecl(Module &Dst, const GlobalAlias &OrigA,
                                   ValueToValueMapTy &VMap);
@@ -14,7 +14,9 @@
 #ifndef LLVM_EXECUTIONENGINE_ORC_LOGICALDYLIB_H
 #define LLVM_EXECUTIONENGINE_ORC_LOGICALDYLIB_H
 
+#include "llvm/ExecutionEngine/Orc/ConcurrentSymbolTable.h"
 #include "llvm/ExecutionEngine/Orc/JITSymbol.h"
+#include <list>
 #include <string>
 #include <vector>
 
@@ -41,7 +43,8 @@ private:
     LogicalModuleResources Resources;
     BaseLayerHandleList BaseLayerHandles;
   };
-  typedef std::vector<LogicalModule> LogicalModuleList;
+  // A list, so that handles stay valid as modules are added.
+  typedef std::list<LogicalModule> LogicalModuleList;
 
 public:
 
@@ -59,8 +62,9 @@ public:
   // If possible, remove this and ~LogicalDylib once the work in the dtor is
   // moved to members (eg: self-unregistering base layer handles).
   LogicalDylib(LogicalDylib &&RHS)
-      : BaseLayer(std::move(RHS.BaseLayer)),
+      : BaseLayer(RHS.BaseLayer),
         LogicalModules(std::move(RHS.LogicalModules)),
+        SymbolIndex(std::move(RHS.SymbolIndex)),
         DylibResources(std::move(RHS.DylibResources)) {}
 
   LogicalModuleHandle createLogicalModule() {
@@ -73,6 +77,27 @@ public:
     LMH->BaseLayerHandles.push_back(BaseLayerHandle);
   }
 
+  /// @brief Record that the logical module LMH defines the symbol Name.
+  ///
+  ///   Lookups by name only search the module that defines the name, so every
+  /// symbol that should be found outside its own logical module has to be
+  /// recorded here. If several modules define a name, the first one wins.
+  void addSymbolToLogicalModule(LogicalModuleHandle LMH, StringRef Name) {
+    SymbolIndex.insert(Name, LMH);
+  }
+
+  /// @brief Return true if some logical module defines the symbol Name.
+  bool definesSymbol(StringRef Name) const {
+    LogicalModuleHandle LMH;
+    return SymbolIndex.lookup(Name, LMH);
+  }
+
+  /// @brief Call Fn(Name) for each symbol defined by this logical dylib.
+  template <typename FnT> void forEachSymbol(FnT Fn) const {
+    SymbolIndex.forEach(
+        [&](StringRef Name, const LogicalModuleHandle &) { Fn(Name); });
+  }
+
   LogicalModuleResources& getLogicalModuleResources(LogicalModuleHandle LMH) {
     return LMH->Resources;
   }
@@ -100,32 +125,40 @@ public:
 
   JITSymbol findSymbolInternally(LogicalModuleHandle LMH,
                                  const std::string &Name) {
+    // LMH may also resolve names it does not define, e.g. stub pointers.
     if (auto Symbol = findSymbolInLogicalModule(LMH, Name, false))
       return Symbol;
 
-    for (auto LMI = LogicalModules.begin(), LME = LogicalModules.end();
-           LMI != LME; ++LMI) {
-      if (LMI != LMH)
-        if (auto Symbol = findSymbolInLogicalModule(LMI, Name, false))
-          return Symbol;
-    }
+    LogicalModuleHandle DefLMH;
+    if (SymbolIndex.lookup(Name, DefLMH) && DefLMH != LMH)
+      return findSymbolInLogicalModule(DefLMH, Name, false);
 
     return nullptr;
   }
 
   JITSymbol findSymbol(const std::string &Name, bool ExportedSymbolsOnly) {
-    for (auto LMI = LogicalModules.begin(), LME = LogicalModules.end();
-         LMI != LME; ++LMI)
-      if (auto Sym = findSymbolInLogicalModule(LMI, Name, ExportedSymbolsOnly))
-        return Sym;
+    LogicalModuleHandle LMH;
+    if (SymbolIndex.lookup(Name, LMH))
+      return findSymbolInLogicalModule(LMH, Name, ExportedSymbolsOnly);
+    return nullptr;
+  }
+
+  LogicalModuleResources*
+  getLogicalModuleResourcesForSymbol(const std::string &Name,
+                                     bool ExportedSymbolsOnly) {
+    LogicalModuleHandle LMH;
+    if (SymbolIndex.lookup(Name, LMH))
+      if (auto Sym = LMH->Resources.findSymbol(Name, ExportedSymbolsOnly))
+        return &LMH->Resources;
     return nullptr;
   }
 
   LogicalDylibResources& getDylibResources() { return DylibResources; }
 
 protected:
-  BaseLayerT BaseLayer;
+  BaseLayerT &BaseLayer;
   LogicalModuleList LogicalModules;
+  ConcurrentSymbolTable<LogicalModuleHandle> SymbolIndex;
   LogicalDylibResources DylibResources;
 };
 
@@ -29,6 +29,8 @@ enum class OrcErrorCode : int {
   RemoteIndirectStubsOwnerIdAlreadyInUse,
   UnexpectedRPCCall,
   UnexpectedRPCResponse,
+  // JIT errors
+  JITSymbolNotFound,
 };
 
 Error orcError(OrcErrorCode ErrCode);
@@ -578,7 +578,7 @@ public:
 
       uint32_t TrampolineSize = Remote.getTrampolineSize();
       for (unsigned I = 0; I < NumTrampolines; ++I)
-        this->AvailableTrampolines.push_back(BlockAddr + (I * TrampolineSize));
+        this->addTrampoline(BlockAddr + (I * TrampolineSize));
     }
 
     OrcRemoteTargetClient &Remote;
@@ -0,0 +1,92 @@
+//===- PersistentObjectCache.h - On-disk JIT object cache -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains an ObjectCache that keeps compiled objects in a directory, keyed
+// by a hash of the module and of the target it was compiled for.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include <string>
+
+namespace llvm {
+
+class TargetMachine;
+
+namespace orc {
+
+/// @brief ObjectCache that stores compiled objects on disk.
+///
+///   Each entry is named after the SHA1 of the compiler version, the target
+/// triple, CPU, features, optimization level, relocation and code model of
+/// the TargetMachine given at construction, and the bitcode of the module.
+/// A module is found in the cache across runs as long as its IR, which
+/// includes its source file name, and the code generation options don't
+/// change. Options of the TargetMachine that are not listed above are not
+/// hashed, so JITs that vary them should use separate cache directories.
+///
+///   Attach the cache to an IRCompileLayer with setObjectCache. The cache
+/// directory is pruned with CachePruning according to the policy set below
+/// after each object is stored, and when prune() is called.
+class PersistentObjectCache : public ObjectCache {
+public:
+  /// @brief Create a cache in directory CacheDir, which is created if it
+  ///        doesn't exist, for objects compiled by TM.
+  PersistentObjectCache(std::string CacheDir, const TargetMachine &TM);
+
+  /// @brief Minimum number of seconds between two scans of the cache
+  ///        directory. A negative value disables pruning.
+  PersistentObjectCache &setPruningInterval(int Interval) {
+    PruningInterval = Interval;
+    return *this;
+  }
+
+  /// @brief Remove entries that haven't been used for ExpireAfter seconds.
+  ///        0 disables expiration.
+  PersistentObjectCache &setEntryExpiration(unsigned ExpireAfter) {
+    Expiration = ExpireAfter;
+    return *this;
+  }
+
+  /// @brief Keep the cache below Percentage percent of the available disk
+  ///        space. 0 disables the size limit.
+  PersistentObjectCache &setMaxSize(unsigned Percentage) {
+    MaxPercentageOfAvailableSpace = Percentage;
+    return *this;
+  }
+
+  /// @brief Prune the cache directory according to the current policy.
+  void prune();
+
+  /// @brief Return the path of the cache entry for M.
+  std::string getEntryPath(const Module &M) const;
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+private:
+  std::string CacheDir;
+  std::string TargetKey;
+  // Entry paths computed by getObject, so that storing the object compiled
+  // after a miss doesn't hash the module again.
+  DenseMap<const Module *, std::string> PendingEntries;
+  int PruningInterval = 1200;
+  unsigned Expiration = 7 * 24 * 3600;
+  unsigned MaxPercentageOfAvailableSpace = 75;
+};
+
+} // End namespace orc.
+} // End namespace llvm.
+
+#endif // LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
@@ -211,8 +211,18 @@ inline Error deserialize(RPCChannel &C, std::tuple<ArgTs...> &V) {
   return deserializeTupleHelper(C, V, llvm::index_sequence_for<ArgTs...>());
 }
 
+/// Element types that arrays of are sent as raw bytes, rather than one element
+/// at a time.
+template <typename T>
+struct RPCByteType
+    : std::integral_constant<bool, std::is_same<T, char>::value ||
+                                       std::is_same<T, uint8_t>::value ||
+                                       std::is_same<T, int8_t>::value> {};
+
 /// RPC channel serialization for ArrayRef<T>.
-template <typename T> Error serialize(RPCChannel &C, const ArrayRef<T> &A) {
+template <typename T>
+typename std::enable_if<!RPCByteType<T>::value, Error>::type
+serialize(RPCChannel &C, const ArrayRef<T> &A) {
   if (auto Err = serialize(C, static_cast<uint64_t>(A.size())))
     return Err;
 
@@ -223,13 +233,24 @@ template <typename T> Error serialize(RPCChannel &C, const ArrayRef<T> &A) {
   return Error::success();
 }
 
+/// RPC channel serialization for byte ArrayRefs.
+template <typename T>
+typename std::enable_if<RPCByteType<T>::value, Error>::type
+serialize(RPCChannel &C, const ArrayRef<T> &A) {
+  if (auto Err = serialize(C, static_cast<uint64_t>(A.size())))
+    return Err;
+  return C.appendBytes(reinterpret_cast<const char *>(A.data()), A.size());
+}
+
 /// RPC channel serialization for std::array<T>.
 template <typename T> Error serialize(RPCChannel &C, const std::vector<T> &V) {
   return serialize(C, ArrayRef<T>(V));
 }
 
 /// RPC channel deserialization for std::array<T>.
-template <typename T> Error deserialize(RPCChannel &C, std::vector<T> &V) {
+template <typename T>
+typename std::enable_if<!RPCByteType<T>::value, Error>::type
+deserialize(RPCChannel &C, std::vector<T> &V) {
   uint64_t Count = 0;
   if (auto Err = deserialize(C, Count))
     return Err;
@@ -242,6 +263,18 @@ template <typename T> Error deserialize(RPCChannel &C, std::vector<T> &V) {
   return Error::success();
 }
 
+/// RPC channel deserialization for byte vectors.
+template <typename T>
+typename std::enable_if<RPCByteType<T>::value, Error>::type
+deserialize(RPCChannel &C, std::vector<T> &V) {
+  uint64_t Count = 0;
+  if (auto Err = deserialize(C, Count))
+    return Err;
+
+  V.resize(Count);
+  return C.readBytes(reinterpret_cast<char *>(V.data()), Count);
+}
+
 } // end namespace remote
 } // end namespace orc
 } // end namespace llvm
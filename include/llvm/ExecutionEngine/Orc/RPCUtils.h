@@ -133,7 +133,9 @@ protected:
         return Err;
       if (auto Err = serializeSeq(C, ResponseId, SeqNo, *Result))
         return Err;
-      return endSendMessage(C);
+      if (auto Err = endSendMessage(C))
+        return Err;
+      return C.send();
     }
   };
 
@@ -180,7 +182,9 @@ protected:
         return Err;
       if (auto Err = serializeSeq(C, ResponseId, SeqNo))
         return Err;
-      return endSendMessage(C);
+      if (auto Err = endSendMessage(C))
+        return Err;
+      return C.send();
     }
   };
 
@@ -0,0 +1,88 @@
+//===- SharedMemoryRPCChannel.h - RPC channel over shared memory -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// An RPCChannel for JIT clients and servers that run on the same host. Bytes
+// move through a pair of ring buffers in a shared file mapping rather than
+// through system calls.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_SHAREDMEMORYRPCCHANNEL_H
+#define LLVM_EXECUTIONENGINE_ORC_SHAREDMEMORYRPCCHANNEL_H
+
+#include "RPCChannel.h"
+#include "llvm/Support/FileSystem.h"
+#include <memory>
+
+namespace llvm {
+namespace orc {
+namespace remote {
+
+/// RPC channel backed by two single-producer, single-consumer ring buffers
+/// in a file that both ends of the channel map.
+///
+/// Appended bytes are copied straight into the outgoing ring, but only become
+/// visible to the other end on send(), so a sequence of appends (for example
+/// several asynchronous calls made with RPC::appendCallAsync) is delivered as
+/// one batch. A reader that finds its ring empty spins briefly before backing
+/// off, which keeps round trips short when both processes are busy.
+///
+/// The side that calls create() owns the file and removes it when the channel
+/// is destroyed. The other side attaches with open(). Destroying either end,
+/// or calling close(), makes reads and writes that would block on the other
+/// end fail instead of waiting forever.
+class SharedMemoryRPCChannel : public RPCChannel {
+public:
+  /// Create (or overwrite) the file at Path, sized for two rings of RingSize
+  /// bytes each, and return the creating end of the channel. RingSize must be
+  /// a power of two.
+  static Expected<std::unique_ptr<SharedMemoryRPCChannel>>
+  create(StringRef Path, uint64_t RingSize = 1 << 20);
+
+  /// Attach to a channel that was created at Path.
+  static Expected<std::unique_ptr<SharedMemoryRPCChannel>>
+  open(StringRef Path);
+
+  ~SharedMemoryRPCChannel() override;
+
+  Error readBytes(char *Dst, unsigned Size) override;
+  Error appendBytes(const char *Src, unsigned Size) override;
+
+  /// Make everything appended so far visible to the other end. Must not be
+  /// called with the write lock held.
+  Error send() override;
+
+  /// Shut the channel down in both directions.
+  void close();
+
+private:
+  struct ChannelHeader;
+  struct RingHeader;
+
+  SharedMemoryRPCChannel(std::unique_ptr<sys::fs::mapped_file_region> Region,
+                         bool IsCreator, std::string Path);
+
+  Error waitForReader(uint64_t &Head);
+  Error waitForWriter(uint64_t Head, uint64_t &Tail);
+
+  std::unique_ptr<sys::fs::mapped_file_region> Region;
+  std::string OwnedPath;
+  uint64_t RingSize;
+  RingHeader *InRing, *OutRing;
+  char *InData, *OutData;
+
+  // End of the bytes appended to the outgoing ring but not yet sent.
+  uint64_t PendingTail;
+};
+
+} // end namespace remote
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_SHAREDMEMORYRPCCHANNEL_H
@@ -0,0 +1,411 @@
+//===- TieredCompileLayer.h - Recompile hot code at a higher tier -*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains the definition for a compiling layer that first compiles code
+// quickly, and recompiles the functions that turn out to be hot with a slower,
+// optimizing compiler on a background thread.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILELAYER_H
+#define LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILELAYER_H
+
+#include "IndirectionUtils.h"
+#include "JITSymbol.h"
+#include "LambdaResolver.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/ExecutionEngine/RuntimeDyld.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Mangler.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace llvm {
+namespace orc {
+
+/// @brief Count the calls to F, and call Callback(CallbackCtx, Key) from F's
+///        entry when the count reaches Threshold, then every PollInterval
+///        calls after that.
+///
+///   PollInterval must be a power of two. The counter is a private global
+/// added to F's module.
+void addTierUpCounter(Function &F, unsigned Threshold, unsigned PollInterval,
+                      TargetAddress Callback, TargetAddress CallbackCtx,
+                      uint64_t Key);
+
+/// @brief Tiered IR compiling layer.
+///
+///   This layer accepts sets of LLVM IR Modules (via addModuleSet) and
+/// compiles each of them at once with a fast compiler, typically an -O0
+/// FastISel pipeline, after adding a call counter to each function that it
+/// defines. The resulting objects are added to the layer below, which must
+/// implement the object layer concept.
+///
+///   When a function has been called HotThreshold times, the uninstrumented
+/// IR of its module is recompiled with the optimizing compiler on a
+/// background thread. The optimized object is linked the next time the JIT'd
+/// code calls back into this layer, or when installOptimizedCode is called,
+/// and the UpdatePointer functor is then called with the mangled name and new
+/// address of each function in the module. Placed under a
+/// CompileOnDemandLayer, the functor should forward to
+/// CompileOnDemandLayer::updatePointer, so that calls through the function's
+/// stub reach the optimized body from then on.
+///
+///   The unoptimized code stays mapped until the module set is removed, since
+/// it may still be running. The counters call back into this process, so
+/// this layer only supports in-process JITs.
+template <typename BaseLayerT> class TieredCompileLayer {
+public:
+  typedef std::function<object::OwningBinary<object::ObjectFile>(Module &)>
+      CompileFtor;
+
+  typedef std::function<Error(const std::string &, TargetAddress)>
+      UpdatePointerFtor;
+
+private:
+  typedef typename BaseLayerT::ObjSetHandleT ObjSetHandleT;
+
+  struct ModuleSetInfo {
+    std::shared_ptr<RuntimeDyld::MemoryManager> MemMgr;
+    std::shared_ptr<RuntimeDyld::SymbolResolver> Resolver;
+    // Resolves the optimized code against the unoptimized set first.
+    std::unique_ptr<RuntimeDyld::SymbolResolver> OptimizedResolver;
+    ObjSetHandleT BaseHandle;
+    std::vector<ObjSetHandleT> OptimizedHandles;
+    std::vector<uint64_t> Keys;
+  };
+
+  typedef std::list<ModuleSetInfo> ModuleSetList;
+
+  // A module that can still be recompiled.
+  struct TierUpCandidate {
+    typename ModuleSetList::iterator ModuleSet;
+    std::string Bitcode;
+    std::vector<std::string> FunctionNames;
+    bool Requested = false;
+  };
+
+public:
+  /// @brief Handle to a set of compiled modules.
+  typedef typename ModuleSetList::iterator ModuleSetHandleT;
+
+  /// @brief Construct a TieredCompileLayer.
+  ///
+  ///   FastCompile is called on the thread that adds the modules. Optimize is
+  /// called on a single background thread, on modules in a context of their
+  /// own, so it needs a TargetMachine that isn't used elsewhere.
+  TieredCompileLayer(BaseLayerT &BaseLayer, CompileFtor FastCompile,
+                     CompileFtor Optimize, UpdatePointerFtor UpdatePointer,
+                     unsigned HotThreshold = 1000, unsigned PollInterval = 1024)
+      : BaseLayer(BaseLayer), FastCompile(std::move(FastCompile)),
+        Optimize(std::move(Optimize)), UpdatePointer(std::move(UpdatePointer)),
+        HotThreshold(HotThreshold), PollInterval(PollInterval), Recompiler(1) {
+    assert(HotThreshold && "The threshold must be at least one call");
+    assert(isPowerOf2_32(PollInterval) &&
+           "The poll interval must be a power of two");
+  }
+
+  ~TieredCompileLayer() {
+    // Don't let the background thread outlive the compiler it uses.
+    Recompiler.wait();
+  }
+
+  /// @brief Instrument and compile each module in the given module set, then
+  ///        add the resulting set of objects to the base layer along with the
+  ///        memory manager and symbol resolver.
+  ///
+  /// @return A handle for the added modules.
+  template <typename ModuleSetT, typename MemoryManagerPtrT,
+            typename SymbolResolverPtrT>
+  ModuleSetHandleT addModuleSet(ModuleSetT Ms, MemoryManagerPtrT MemMgr,
+                                SymbolResolverPtrT Resolver) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+
+    ModuleSets.push_back(ModuleSetInfo());
+    auto H = std::prev(ModuleSets.end());
+    H->MemMgr = shareOwnership<RuntimeDyld::MemoryManager>(std::move(MemMgr));
+    H->Resolver =
+      shareOwnership<RuntimeDyld::SymbolResolver>(std::move(Resolver));
+
+    std::vector<std::unique_ptr<object::OwningBinary<object::ObjectFile>>>
+      Objects;
+
+    for (const auto &M : Ms) {
+      uint64_t Key = NextKey++;
+      TierUpCandidate &Candidate = Candidates[Key];
+      Candidate.ModuleSet = H;
+      H->Keys.push_back(Key);
+
+      // The optimized code refers to the globals of the unoptimized code by
+      // name, so they all need one that the object layer can find.
+      makeAllSymbolsExternallyAccessible(*M);
+
+      // Keep the IR as it was given, before adding the counters.
+      {
+        raw_string_ostream BitcodeOS(Candidate.Bitcode);
+        WriteBitcodeToFile(&*M, BitcodeOS);
+      }
+
+      const DataLayout &DL = M->getDataLayout();
+      for (auto &F : *M) {
+        if (F.isDeclaration() || F.hasAvailableExternallyLinkage() ||
+            F.hasFnAttribute(Attribute::Naked))
+          continue;
+        Candidate.FunctionNames.push_back(mangle(F.getName(), DL));
+        addTierUpCounter(F, HotThreshold, PollInterval,
+                         static_cast<TargetAddress>(
+                           reinterpret_cast<uintptr_t>(&tierUpCallback)),
+                         static_cast<TargetAddress>(
+                           reinterpret_cast<uintptr_t>(this)),
+                         Key);
+      }
+
+      Objects.push_back(
+        llvm::make_unique<object::OwningBinary<object::ObjectFile>>(
+          FastCompile(*M)));
+    }
+
+    H->BaseHandle = BaseLayer.addObjectSet(std::move(Objects),
+                                           H->MemMgr.get(),
+                                           H->Resolver.get());
+    return H;
+  }
+
+  /// @brief Remove the module set associated with the handle H, along with
+  ///        any optimized code compiled for it.
+  void removeModuleSet(ModuleSetHandleT H) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+    for (uint64_t Key : H->Keys)
+      Candidates.erase(Key);
+    for (auto OptH : H->OptimizedHandles)
+      BaseLayer.removeObjectSet(OptH);
+    BaseLayer.removeObjectSet(H->BaseHandle);
+    ModuleSets.erase(H);
+  }
+
+  /// @brief Search for the given named symbol.
+  /// @param Name The name of the symbol to search for.
+  /// @param ExportedSymbolsOnly If true, search only for exported symbols.
+  /// @return A handle for the given named symbol, if it exists.
+  JITSymbol findSymbol(const std::string &Name, bool ExportedSymbolsOnly) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+    return BaseLayer.findSymbol(Name, ExportedSymbolsOnly);
+  }
+
+  /// @brief Get the address of the given symbol in the context of the set of
+  ///        compiled modules represented by the handle H. The optimized
+  ///        version of the symbol is returned once it has been installed.
+  /// @param H The handle for the module set to search in.
+  /// @param Name The name of the symbol to search for.
+  /// @param ExportedSymbolsOnly If true, search only for exported symbols.
+  /// @return A handle for the given named symbol, if it is found in the
+  ///         given module set.
+  JITSymbol findSymbolIn(ModuleSetHandleT H, const std::string &Name,
+                         bool ExportedSymbolsOnly) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+    for (auto OptH : H->OptimizedHandles)
+      if (auto Sym = BaseLayer.findSymbolIn(OptH, Name, ExportedSymbolsOnly))
+        return Sym;
+    return BaseLayer.findSymbolIn(H->BaseHandle, Name, ExportedSymbolsOnly);
+  }
+
+  /// @brief Immediately emit and finalize the module set represented by the
+  ///        given handle.
+  /// @param H Handle for module set to emit/finalize.
+  void emitAndFinalize(ModuleSetHandleT H) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+    BaseLayer.emitAndFinalize(H->BaseHandle);
+  }
+
+  /// @brief Link the modules that the background thread has finished
+  ///        optimizing, and redirect their functions to the optimized code.
+  ///
+  ///   This runs on the calling thread, which should be one that may also run
+  /// compile callbacks.
+  void installOptimizedCode() {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+
+    std::vector<std::pair<uint64_t, object::OwningBinary<object::ObjectFile>>>
+      Optimized;
+    {
+      std::lock_guard<std::mutex> Lock(OptimizedMutex);
+      std::swap(Optimized, OptimizedObjects);
+    }
+
+    for (auto &KV : Optimized) {
+      auto I = Candidates.find(KV.first);
+      // Skip modules that have been removed since, or that failed to compile.
+      if (I == Candidates.end() || !KV.second.getBinary())
+        continue;
+      auto SetH = I->second.ModuleSet;
+      if (!SetH->OptimizedResolver)
+        SetH->OptimizedResolver = createOptimizedResolver(SetH);
+
+      std::vector<std::unique_ptr<object::OwningBinary<object::ObjectFile>>>
+        Objects;
+      Objects.push_back(
+        llvm::make_unique<object::OwningBinary<object::ObjectFile>>(
+          std::move(KV.second)));
+      auto OptH = BaseLayer.addObjectSet(std::move(Objects),
+                                         SetH->MemMgr.get(),
+                                         SetH->OptimizedResolver.get());
+      SetH->OptimizedHandles.push_back(OptH);
+
+      for (const auto &Name : I->second.FunctionNames)
+        if (auto Sym = BaseLayer.findSymbolIn(OptH, Name, false))
+          if (auto Err = UpdatePointer(Name, Sym.getAddress()))
+            // Calls keep going to the unoptimized code, which still works.
+            consumeError(std::move(Err));
+
+      Candidates.erase(I);
+    }
+  }
+
+  /// @brief Wait for the background thread to finish the modules that have
+  ///        been queued for optimization, then install them.
+  void waitForOptimizedCode() {
+    Recompiler.wait();
+    installOptimizedCode();
+  }
+
+private:
+  template <typename ResourceT, typename ResourcePtrT>
+  static std::shared_ptr<ResourceT> shareOwnership(ResourcePtrT ResourcePtr) {
+    return std::shared_ptr<ResourceT>(std::move(ResourcePtr));
+  }
+
+  template <typename ResourceT, typename ResourcePtrT>
+  static std::shared_ptr<ResourceT> shareOwnership(ResourcePtrT *ResourcePtr) {
+    // Not owned by this layer.
+    return std::shared_ptr<ResourceT>(ResourcePtr, [](ResourceT *) {});
+  }
+
+  static std::string mangle(StringRef Name, const DataLayout &DL) {
+    std::string MangledName;
+    {
+      raw_string_ostream MangledNameStream(MangledName);
+      Mangler::getNameWithPrefix(MangledNameStream, Name, DL);
+    }
+    return MangledName;
+  }
+
+  std::unique_ptr<RuntimeDyld::SymbolResolver>
+  createOptimizedResolver(ModuleSetHandleT H) {
+    return createLambdaResolver(
+        [this, H](const std::string &Name) {
+          if (auto Sym = BaseLayer.findSymbolIn(H->BaseHandle, Name, false))
+            return Sym.toRuntimeDyldSymbol();
+          return H->Resolver->findSymbolInLogicalDylib(Name);
+        },
+        [H](const std::string &Name) {
+          return H->Resolver->findSymbol(Name);
+        });
+  }
+
+  // Turn the global variables and aliases of M into declarations, so that
+  // the optimized code shares the state of the unoptimized code. Constants
+  // whose address doesn't matter are kept, so that they can be folded.
+  static void declareGlobals(Module &M) {
+    for (auto &GV : M.globals()) {
+      if (GV.isDeclaration() ||
+          (GV.isConstant() && GV.hasGlobalUnnamedAddr()))
+        continue;
+      GV.setInitializer(nullptr);
+      GV.setLinkage(GlobalValue::ExternalLinkage);
+      GV.setComdat(nullptr);
+    }
+
+    for (auto AI = M.alias_begin(), AE = M.alias_end(); AI != AE;) {
+      GlobalAlias &A = *AI++;
+      GlobalValue *Decl;
+      if (auto *FTy = dyn_cast<FunctionType>(A.getValueType()))
+        Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "", &M);
+      else
+        Decl = new GlobalVariable(M, A.getValueType(), false,
+                                  GlobalValue::ExternalLinkage, nullptr, "",
+                                  nullptr, GlobalValue::NotThreadLocal,
+                                  A.getType()->getAddressSpace());
+      Decl->takeName(&A);
+      Decl->setVisibility(A.getVisibility());
+      A.replaceAllUsesWith(ConstantExpr::getBitCast(Decl, A.getType()));
+      A.eraseFromParent();
+    }
+  }
+
+  // Called by the counters in the JIT'd code.
+  static void tierUpCallback(void *Layer, uint64_t Key) {
+    static_cast<TieredCompileLayer *>(Layer)->tierUp(Key);
+  }
+
+  void tierUp(uint64_t Key) {
+    {
+      std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+      auto I = Candidates.find(Key);
+      if (I != Candidates.end() && !I->second.Requested) {
+        I->second.Requested = true;
+        std::string Bitcode = I->second.Bitcode;
+        Recompiler.async([this, Key, Bitcode]() {
+          this->optimize(Key, Bitcode);
+        });
+      }
+    }
+    installOptimizedCode();
+  }
+
+  // Runs on the background thread.
+  void optimize(uint64_t Key, const std::string &Bitcode) {
+    LLVMContext Context;
+    object::OwningBinary<object::ObjectFile> Obj;
+    auto M = parseBitcodeFile(MemoryBufferRef(Bitcode, "tiered"), Context);
+    if (M) {
+      declareGlobals(**M);
+      Obj = Optimize(**M);
+    }
+
+    std::lock_guard<std::mutex> Lock(OptimizedMutex);
+    OptimizedObjects.push_back(std::make_pair(Key, std::move(Obj)));
+  }
+
+  BaseLayerT &BaseLayer;
+  CompileFtor FastCompile;
+  CompileFtor Optimize;
+  UpdatePointerFtor UpdatePointer;
+  unsigned HotThreshold;
+  unsigned PollInterval;
+
+  // Guards everything but OptimizedObjects. It is recursive because linking
+  // an object may resolve symbols through the layers above, and back into
+  // findSymbolIn.
+  std::recursive_mutex LayerMutex;
+  ModuleSetList ModuleSets;
+  std::map<uint64_t, TierUpCandidate> Candidates;
+  uint64_t NextKey = 0;
+
+  std::mutex OptimizedMutex;
+  std::vector<std::pair<uint64_t, object::OwningBinary<object::ObjectFile>>>
+    OptimizedObjects;
+
+  // Declared last, so that the thread is joined before anything it uses is
+  // destroyed.
+  ThreadPool Recompiler;
+};
+
+} // End namespace orc.
+} // End namespace llvm.
+
+#endif // LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILELAYER_H
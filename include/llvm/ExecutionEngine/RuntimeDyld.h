@@ -22,6 +22,7 @@
 #include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
@@ -216,6 +217,18 @@ public:
     /// for handling them manually.
     virtual SymbolInfo findSymbol(const std::string &Name) = 0;
 
+    /// This method returns the addresses of a list of symbols that are needed
+    /// to link an object, in the same order as Names. Each symbol is searched
+    /// for with findSymbolInLogicalDylib first, and with findSymbol if that
+    /// fails.
+    ///
+    /// RuntimeDyld makes one call to this method for all the unresolved
+    /// symbols of the objects it has loaded, rather than one query per symbol.
+    /// Resolvers that have a fixed cost per query, such as ones that search a
+    /// remote process, can override it to answer the queries together.
+    virtual std::vector<SymbolInfo>
+    findSymbolsForLinking(ArrayRef<std::string> Names);
+
   private:
     virtual void anchor();
   };
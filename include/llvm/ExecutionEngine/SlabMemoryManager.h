@@ -0,0 +1,137 @@
+//===- SlabMemoryManager.h - Pooled memory manager for JITs -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares SlabAllocator, a pool of page-granular memory shared
+// between JIT memory managers, and SlabMemoryManager, which sub-allocates the
+// sections of the objects it loads from such a pool.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_SLABMEMORYMANAGER_H
+#define LLVM_EXECUTIONENGINE_SLABMEMORYMANAGER_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
+#include "llvm/Support/Memory.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+
+/// A thread-safe pool of read-write memory. Memory is requested from the
+/// system in large mappings ("slabs") and handed out in whole pages, so that
+/// many small JIT'd objects cost a handful of mmap calls instead of several
+/// each. Pages returned with deallocate are reused by later allocations, and
+/// a slab that becomes entirely free is unmapped, except for one spare slab
+/// kept to avoid remapping when objects are repeatedly added and removed.
+class SlabAllocator {
+  SlabAllocator(const SlabAllocator&) = delete;
+  void operator=(const SlabAllocator&) = delete;
+
+public:
+  /// Create a pool that maps memory in slabs of (at least) \p SlabSize bytes.
+  explicit SlabAllocator(size_t SlabSize = 1024 * 1024);
+  ~SlabAllocator();
+
+  /// \brief Return a read-write block of at least \p Size bytes. The block is
+  /// page aligned and its size is a multiple of the page size.
+  ///
+  /// Requests larger than the slab size get a slab of their own.
+  sys::MemoryBlock allocate(size_t Size, std::error_code &EC);
+
+  /// \brief Return a block obtained from allocate to the pool. The block must
+  /// be read-write again by the time it is deallocated.
+  void deallocate(sys::MemoryBlock Block);
+
+  /// Number of slabs currently mapped.
+  size_t getNumSlabs() const;
+
+private:
+  struct Slab {
+    sys::MemoryBlock Memory;
+    // Free page ranges, start address to size, never adjacent to each other.
+    std::map<uintptr_t, size_t> FreeRanges;
+    size_t FreeSize;
+  };
+
+  void releaseSlab(std::vector<Slab>::iterator S);
+
+  mutable std::mutex Lock;
+  size_t SlabSize;
+  std::vector<Slab> Slabs;
+};
+
+/// A memory manager that sub-allocates sections from a shared SlabAllocator.
+///
+/// It asks RuntimeDyld for the total size of each object up front, so that
+/// every object normally takes a single block from the pool, split into page
+/// aligned code, read-only and read-write parts that never share a page.
+/// finalizeMemory then changes permissions with one call per contiguous run
+/// of pages, instead of one per allocation. All memory goes back to the pool
+/// when the manager is destroyed, which for ObjectLinkingLayer happens when
+/// the object set is removed.
+class SlabMemoryManager : public RTDyldMemoryManager {
+  SlabMemoryManager(const SlabMemoryManager&) = delete;
+  void operator=(const SlabMemoryManager&) = delete;
+
+public:
+  /// Create a manager that allocates from \p Slabs, which must outlive it.
+  explicit SlabMemoryManager(SlabAllocator &Slabs) : Slabs(Slabs) {}
+  ~SlabMemoryManager() override;
+
+  bool needsToReserveAllocationSpace() override { return true; }
+
+  void reserveAllocationSpace(uintptr_t CodeSize, uint32_t CodeAlign,
+                              uintptr_t RODataSize, uint32_t RODataAlign,
+                              uintptr_t RWDataSize,
+                              uint32_t RWDataAlign) override;
+
+  uint8_t *allocateCodeSection(uintptr_t Size, unsigned Alignment,
+                               unsigned SectionID,
+                               StringRef SectionName) override;
+
+  uint8_t *allocateDataSection(uintptr_t Size, unsigned Alignment,
+                               unsigned SectionID, StringRef SectionName,
+                               bool IsReadOnly) override;
+
+  /// \brief Make code read-execute and read-only data read-only, and
+  /// invalidate the instruction cache for the code.
+  ///
+  /// \returns true if an error occurred, false otherwise.
+  bool finalizeMemory(std::string *ErrMsg = nullptr) override;
+
+private:
+  struct MemoryGroup {
+    // Unused memory at the end of the last block given to this group.
+    sys::MemoryBlock Free;
+    // Allocated memory whose permissions haven't been applied yet.
+    SmallVector<sys::MemoryBlock, 4> PendingMem;
+    // Page ranges whose permissions have been changed, to be made read-write
+    // again before they go back to the pool.
+    SmallVector<sys::MemoryBlock, 4> ProtectedMem;
+  };
+
+  uint8_t *allocateSection(MemoryGroup &MemGroup, uintptr_t Size,
+                           unsigned Alignment);
+
+  std::error_code applyMemoryGroupPermissions(MemoryGroup &MemGroup,
+                                              unsigned Permissions);
+
+  SlabAllocator &Slabs;
+  // Blocks obtained from Slabs.
+  SmallVector<sys::MemoryBlock, 4> AllocatedMem;
+  MemoryGroup CodeMem;
+  MemoryGroup RWDataMem;
+  MemoryGroup RODataMem;
+};
+
+} // namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_SLABMEMORYMANAGER_H
@@ -149,6 +149,14 @@ protected:
     return cast_or_null<Ty>(getOperand(I));
   }
 
+  /// Get an operand that may have been left off the end of the node.
+  ///
+  /// Trailing null operands that are never replaced are not allocated, so
+  /// reading one past the end gives null.
+  Metadata *getOptionalOperand(unsigned I) const {
+    return I < getNumOperands() ? getOperand(I).get() : nullptr;
+  }
+
   StringRef getStringOperand(unsigned I) const {
     if (auto *S = getOperandAs<MDString>(I))
       return S->getString();
@@ -730,7 +738,7 @@ public:
   /// TODO: Separate out types that need this extra operand: pointer-to-member
   /// types and member fields (static members and ivars).
   Metadata *getExtraData() const { return getRawExtraData(); }
-  Metadata *getRawExtraData() const { return getOperand(4); }
+  Metadata *getRawExtraData() const { return getOptionalOperand(4); }
 
   /// \brief Get casted version of extra data.
   /// @{
@@ -1422,11 +1430,11 @@ public:
   DIScopeRef getScope() const { return DIScopeRef(getRawScope()); }
 
   StringRef getName() const { return getStringOperand(2); }
-  StringRef getDisplayName() const { return getStringOperand(3); }
-  StringRef getLinkageName() const { return getStringOperand(4); }
+  StringRef getDisplayName() const { return getName(); }
+  StringRef getLinkageName() const { return getStringOperand(3); }
 
   MDString *getRawName() const { return getOperandAs<MDString>(2); }
-  MDString *getRawLinkageName() const { return getOperandAs<MDString>(4); }
+  MDString *getRawLinkageName() const { return getOperandAs<MDString>(3); }
 
   DISubroutineType *getType() const {
     return cast_or_null<DISubroutineType>(getRawType());
@@ -1439,7 +1447,7 @@ public:
     return cast_or_null<DICompileUnit>(getRawUnit());
   }
   void replaceUnit(DICompileUnit *CU) {
-    replaceOperandWith(7, CU);
+    replaceOperandWith(6, CU);
   }
   DITemplateParameterArray getTemplateParams() const {
     return cast_or_null<MDTuple>(getRawTemplateParams());
@@ -1452,12 +1460,12 @@ public:
   }
 
   Metadata *getRawScope() const { return getOperand(1); }
-  Metadata *getRawType() const { return getOperand(5); }
-  Metadata *getRawContainingType() const { return getOperand(6); }
-  Metadata *getRawUnit() const { return getOperand(7); }
-  Metadata *getRawTemplateParams() const { return getOperand(8); }
-  Metadata *getRawDeclaration() const { return getOperand(9); }
-  Metadata *getRawVariables() const { return getOperand(10); }
+  Metadata *getRawType() const { return getOperand(4); }
+  Metadata *getRawContainingType() const { return getOperand(5); }
+  Metadata *getRawUnit() const { return getOperand(6); }
+  Metadata *getRawTemplateParams() const { return getOptionalOperand(7); }
+  Metadata *getRawDeclaration() const { return getOptionalOperand(8); }
+  Metadata *getRawVariables() const { return getOptionalOperand(9); }
 
   /// \brief Check if this subprogram describes the given function.
   ///
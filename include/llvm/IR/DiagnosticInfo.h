@@ -15,10 +15,12 @@
 #ifndef LLVM_IR_DIAGNOSTICINFO_H
 #define LLVM_IR_DIAGNOSTICINFO_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/IR/DebugLoc.h"
 #include "llvm/Support/CBindingWrapping.h"
+#include "llvm/Support/YAMLTraits.h"
 #include "llvm-c/Types.h"
 #include <functional>
 #include <string>
@@ -397,9 +399,19 @@ public:
   /// in BackendConsumer::OptimizationRemarkHandler).
   virtual bool isEnabled() const = 0;
 
+  /// Return true if this remark should be written to the file given with
+  /// -pass-remarks-output, that is if its pass matches -pass-remarks-filter.
+  /// Unlike isEnabled, this does not depend on the kind of the remark.
+  bool isSerializationEnabled() const;
+
   const char *getPassName() const { return PassName; }
   const Twine &getMsg() const { return Msg; }
 
+  /// Return the execution count of the code this remark is about, if known.
+  /// Unless the pass set it, this is the entry count of the function.
+  Optional<uint64_t> getHotness() const;
+  void setHotness(Optional<uint64_t> H) { Hotness = H; }
+
   static bool classof(const DiagnosticInfo *DI) {
     return DI->getKind() >= DK_FirstRemark &&
            DI->getKind() <= DK_LastRemark;
@@ -413,6 +425,9 @@ private:
 
   /// Message to report.
   const Twine &Msg;
+
+  /// Execution count of the code, if set by the pass.
+  Optional<uint64_t> Hotness;
 };
 
 /// Diagnostic information for applied optimization remarks.
@@ -696,6 +711,13 @@ void emitLoopVectorizeWarning(LLVMContext &Ctx, const Function &Fn,
 void emitLoopInterleaveWarning(LLVMContext &Ctx, const Function &Fn,
                                const DebugLoc &DLoc, const Twine &Msg);
 
+namespace yaml {
+/// Writes an optimization remark as one YAML document, tagged with its kind.
+template <> struct MappingTraits<DiagnosticInfoOptimizationBase *> {
+  static void mapping(IO &io, DiagnosticInfoOptimizationBase *&OptDiag);
+};
+} // end namespace yaml
+
 } // end namespace llvm
 
 #endif // LLVM_IR_DIAGNOSTICINFO_H
@@ -127,6 +127,48 @@ public:
   /// This should only be used for debugging as it aborts the program if the
   /// verification fails.
   void verifyDomTree() const;
+
+  /// \brief Handle invalidation explicitly.
+  ///
+  /// The tree only depends on the CFG, so it survives any pass which preserves
+  /// \c CFGAnalyses as well as those which preserve it directly.
+  bool invalidate(Function &F, const PreservedAnalyses &PA);
+};
+
+/// \brief Collect the CFG changes of a transform and apply them to a
+/// DominatorTree lazily, in one batch.
+///
+/// A transform that rewires many edges before it needs dominance again can
+/// report each edge to insertEdge or deleteEdge once the CFG reflects the
+/// change, and call flush() before its next query. Edges that come and go in
+/// between cost nothing. The updates must be flushed before a block they
+/// mention is erased from the function.
+class DeferredDominance {
+  DominatorTree &DT;
+  SmallVector<DominatorTree::UpdateType, 16> PendingUpdates;
+
+public:
+  explicit DeferredDominance(DominatorTree &DT) : DT(DT) {}
+  ~DeferredDominance() {
+    assert(PendingUpdates.empty() && "Dominator tree updates were dropped!");
+  }
+
+  void insertEdge(BasicBlock *From, BasicBlock *To) {
+    PendingUpdates.push_back({DominatorTree::Insert, From, To});
+  }
+  void deleteEdge(BasicBlock *From, BasicBlock *To) {
+    PendingUpdates.push_back({DominatorTree::Delete, From, To});
+  }
+
+  /// \brief Return true if there are updates still to be applied.
+  bool pending() const { return !PendingUpdates.empty(); }
+
+  /// \brief Apply the pending updates and return the up to date tree.
+  DominatorTree &flush() {
+    DT.applyUpdates(PendingUpdates);
+    PendingUpdates.clear();
+    return DT;
+  }
 };
 
 //===-------------------------------------
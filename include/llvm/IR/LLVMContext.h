@@ -34,6 +34,9 @@ template <typename T> class SmallVectorImpl;
 class Function;
 class DebugLoc;
 class OptBisect;
+namespace yaml {
+class Output;
+}
 
 /// This is an important class for using LLVM in a threaded context.  It
 /// (opaquely) owns and manages the core "global" data of LLVM's core
@@ -174,6 +177,23 @@ public:
   /// setDiagnosticContext.
   void *getDiagnosticContext() const;
 
+  /// \brief Return the YAML file optimization remarks are written to, or null
+  /// if they are not written to a file.
+  yaml::Output *getDiagnosticsOutputFile();
+
+  /// \brief Write every optimization remark to \p F in addition to reporting
+  /// it as usual. The remarks can be restricted to some passes with
+  /// -pass-remarks-filter.
+  void setDiagnosticsOutputFile(std::unique_ptr<yaml::Output> F);
+
+  /// \brief Drop the optimization remarks about code executed fewer than
+  /// \p Threshold times, before anything formats them. The execution count
+  /// is the one set by the pass, or else the entry count of the function;
+  /// remarks without a count are dropped by any nonzero threshold. Warnings
+  /// about failed optimizations are always kept.
+  void setDiagnosticsHotnessThreshold(uint64_t Threshold);
+  uint64_t getDiagnosticsHotnessThreshold() const;
+
   /// \brief Get the prefix that should be printed in front of a diagnostic of
   ///        the given \p Severity
   static const char *getDiagnosticMessagePrefix(DiagnosticSeverity Severity);
@@ -499,6 +499,11 @@ public:
   PassManagerType getPassManagerType() const override {
     return PMT_FunctionPassManager;
   }
+
+private:
+  /// Run the contained passes on the function definition \p F, assuming the
+  /// inherited analysis has already been populated.
+  bool runOnFunctionImpl(Function &F);
 };
 
 Timer *getPassTimer(Pass *);
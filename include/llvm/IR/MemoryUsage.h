@@ -0,0 +1,89 @@
+//===- llvm/IR/MemoryUsage.h - Report the memory used by the IR -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a report of the memory used by a module and its context,
+// broken down by the kind of object that uses it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_IR_MEMORYUSAGE_H
+#define LLVM_IR_MEMORYUSAGE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include <cstdint>
+
+namespace llvm {
+
+class Module;
+class raw_ostream;
+
+/// \brief The number of values of one kind, the bytes taken by their objects,
+/// not counting their operands, and the number of their operands.
+struct ValueUsage {
+  uint64_t Count = 0;
+  uint64_t Bytes = 0;
+  uint64_t Operands = 0;
+};
+
+/// \brief The memory used by a module and the context it lives in.
+///
+/// The sizes are computed from the objects and the tables that hold them, so
+/// they are estimates: they do not include malloc overhead, and objects whose
+/// size varies in ways the IR does not expose, such as the reserved operands
+/// of a PHI, are counted by their current size.
+///
+/// Everything owned by the context, such as constants, types and metadata, is
+/// counted in full, even if other modules in the same context use some of it.
+class IRMemoryUsage {
+public:
+  struct Entry {
+    const char *Name;
+    uint64_t Count;
+    uint64_t Bytes;
+  };
+
+  /// The values of a module by kind, and the constants they refer to.
+  struct ValueKinds {
+    ValueUsage Functions;
+    /// Global variables, aliases and ifuncs.
+    ValueUsage GlobalVariables;
+    ValueUsage Arguments;
+    ValueUsage BasicBlocks;
+    ValueUsage Instructions;
+    /// The constants, other than globals, that the values of the module refer
+    /// to, directly or through other constants.
+    ValueUsage Constants;
+  };
+
+private:
+  ValueKinds Values;
+  SmallVector<Entry, 32> Module;
+  SmallVector<Entry, 32> Context;
+
+public:
+  explicit IRMemoryUsage(const llvm::Module &M);
+
+  /// The values of the module by kind.
+  const ValueKinds &getValues() const { return Values; }
+
+  /// The objects owned by the module, such as instructions and symbol tables.
+  ArrayRef<Entry> getModuleEntries() const { return Module; }
+
+  /// The objects owned by the context, such as constants, types and metadata.
+  ArrayRef<Entry> getContextEntries() const { return Context; }
+
+  uint64_t getTotalBytes() const;
+
+  void print(raw_ostream &OS) const;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_IR_MEMORYUSAGE_H
@@ -233,18 +233,54 @@ public:
   /// <CalleeValueInfo, CalleeInfo> call edge pair.
   typedef std::pair<ValueInfo, CalleeInfo> EdgeTy;
 
+  /// The function attributes that the thin link propagates across modules,
+  /// as a bitmask. ReadNone implies ReadOnly.
+  enum AttrKind : unsigned {
+    ReadNone = 1 << 0,
+    ReadOnly = 1 << 1,
+    NoUnwind = 1 << 2,
+    NoRecurse = 1 << 3,
+    AllAttrs = (1 << 4) - 1
+  };
+
+  /// Flags specific to function summaries, each a set of AttrKinds.
+  struct FFlags {
+    /// The attributes known to hold for the function: its IR attributes when
+    /// the summary is built, and after the thin link also the attributes
+    /// inferred from the call graph of the combined index.
+    unsigned Attrs : 4;
+
+    /// The attributes that hold for the instructions of the function other
+    /// than the calls recorded as call graph edges.
+    unsigned BodyAttrs : 4;
+
+    /// The attributes that hold for the call graph edges to functions only
+    /// declared in the module, according to the attributes of the calls.
+    /// Used for the callees that have no summary in the combined index.
+    unsigned DeclCalleeAttrs : 4;
+
+    FFlags() : Attrs(0), BodyAttrs(0), DeclCalleeAttrs(0) {}
+    FFlags(unsigned Attrs, unsigned BodyAttrs, unsigned DeclCalleeAttrs)
+        : Attrs(Attrs), BodyAttrs(BodyAttrs),
+          DeclCalleeAttrs(DeclCalleeAttrs) {}
+  };
+
 private:
   /// Number of instructions (ignoring debug instructions, e.g.) computed
   /// during the initial compile step when the summary index is first built.
   unsigned InstCount;
 
+  /// Function attribute flags (see \p struct FFlags).
+  FFlags FunFlags;
+
   /// List of <CalleeValueInfo, CalleeInfo> call edge pairs from this function.
   std::vector<EdgeTy> CallGraphEdgeList;
 
 public:
   /// Summary constructors.
-  FunctionSummary(GVFlags Flags, unsigned NumInsts)
-      : GlobalValueSummary(FunctionKind, Flags), InstCount(NumInsts) {}
+  FunctionSummary(GVFlags Flags, unsigned NumInsts, FFlags FunFlags = FFlags())
+      : GlobalValueSummary(FunctionKind, Flags), InstCount(NumInsts),
+        FunFlags(FunFlags) {}
 
   /// Check if this is a function summary.
   static bool classof(const GlobalValueSummary *GVS) {
@@ -254,6 +290,16 @@ public:
   /// Get the instruction count recorded for this function.
   unsigned instCount() const { return InstCount; }
 
+  /// Get the function attribute flags (see \p struct FFlags).
+  FFlags fflags() const { return FunFlags; }
+
+  /// Return the set of AttrKinds known to hold for this function.
+  unsigned attrs() const { return FunFlags.Attrs; }
+
+  /// Sets the attributes determined by global summary-based analysis. Will be
+  /// applied in the ThinLTO backends.
+  void setAttrs(unsigned Attrs) { FunFlags.Attrs = Attrs; }
+
   /// Record a call graph edge from this function to the function identified
   /// by \p CalleeGUID, with \p CalleeInfo including the cumulative profile
   /// count (across all calls from this function) or 0 if no PGO.
@@ -399,6 +445,11 @@ public:
     return Summary->get();
   }
 
+  /// Returns the FunctionSummary::AttrKinds recorded for all the copies of
+  /// the function \p ValueGUID, or 0 if one of its summaries is not a
+  /// function summary or there is none.
+  unsigned getFunctionAttrs(GlobalValue::GUID ValueGUID) const;
+
   /// Returns the first GlobalValueSummary for \p GV, asserting that there
   /// is only one if \p PerModuleIndex.
   GlobalValueSummary *getGlobalValueSummary(const GlobalValue &GV,
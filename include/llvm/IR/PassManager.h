@@ -44,6 +44,7 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManagerInternal.h"
+#include "llvm/IR/PassTimingInfo.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/TypeName.h"
 #include "llvm/Support/raw_ostream.h"
@@ -100,6 +101,15 @@ public:
       PreservedPassIDs.insert(PassID);
   }
 
+  /// \brief Mark a set of analyses, such as \c CFGAnalyses, as preserved.
+  ///
+  /// The set is not expanded into the analyses it contains. Instead, each
+  /// analysis that belongs to a set checks for it in its own \c invalidate
+  /// method.
+  template <typename AnalysisSetT> void preserveSet() {
+    preserve(AnalysisSetT::ID());
+  }
+
   /// \brief Intersect this set with another in place.
   ///
   /// This is a mutating operation on this preserved set, removing all
@@ -144,6 +154,12 @@ public:
            PreservedPassIDs.count(PassID);
   }
 
+  /// \brief Query whether a set of analyses is marked as preserved by this
+  /// set.
+  template <typename AnalysisSetT> bool preservedSet() const {
+    return preserved(AnalysisSetT::ID());
+  }
+
   /// \brief Query whether all of the analyses in the set are preserved.
   bool preserved(PreservedAnalyses Arg) {
     if (Arg.areAllPreserved())
@@ -170,6 +186,21 @@ private:
   SmallPtrSet<void *, 2> PreservedPassIDs;
 };
 
+/// \brief The set of analyses which only depend on the CFG of a function.
+///
+/// A pass which changes instructions but never adds, removes or redirects
+/// blocks or edges should preserve this set, so that the dominator trees and
+/// the loop info survive it. Analyses computed from the CFG check for this set
+/// in their \c invalidate methods.
+class CFGAnalyses {
+public:
+  /// Returns an opaque, unique ID for this set.
+  static void *ID() { return (void *)&SetID; }
+
+private:
+  static char SetID;
+};
+
 // Forward declare the analysis manager template.
 template <typename IRUnitT> class AnalysisManager;
 
@@ -252,7 +283,12 @@ public:
         dbgs() << "Running pass: " << Passes[Idx]->name() << " on "
                << IR.getName() << "\n";
 
-      PreservedAnalyses PassPA = Passes[Idx]->run(IR, AM);
+      PreservedAnalyses PassPA;
+      {
+        PassTimingInfo::Scope Timing(Passes[Idx]->name(),
+                                     PassTimingInfo::Kind::Pass);
+        PassPA = Passes[Idx]->run(IR, AM);
+      }
 
       // Update the analysis manager as each pass runs and potentially
       // invalidates analyses. We also update the preserved set of analyses
@@ -304,6 +340,14 @@ typedef PassManager<Function> FunctionPassManager;
 
 namespace detail {
 
+/// \brief Bump the -stats counters of the analysis managers.
+///
+/// These are defined out of line so that there is one set of counters rather
+/// than one per instantiation of \c AnalysisManager.
+void countAnalysisRun();
+void countAnalysisInvalidated();
+void countAnalysisKept();
+
 /// \brief A CRTP base used to implement analysis managers.
 ///
 /// This class template serves as the boiler plate of an analysis manager. Any
@@ -535,7 +579,11 @@ private:
       if (DebugLogging)
         dbgs() << "Running analysis: " << P.name() << "\n";
       AnalysisResultListT &ResultList = AnalysisResultLists[&IR];
-      ResultList.emplace_back(PassID, P.run(IR, *this));
+      {
+        PassTimingInfo::Scope Timing(P.name(), PassTimingInfo::Kind::Analysis);
+        ResultList.emplace_back(PassID, P.run(IR, *this));
+      }
+      detail::countAnalysisRun();
 
       // P.run may have inserted elements into AnalysisResults and invalidated
       // RI.
@@ -565,6 +613,7 @@ private:
     if (DebugLogging)
       dbgs() << "Invalidating analysis: " << this->lookupPass(PassID).name()
              << "\n";
+    PassTimingInfo::recordInvalidation(this->lookupPass(PassID).name());
     AnalysisResultLists[&IR].erase(RI->second);
     AnalysisResults.erase(RI);
   }
@@ -579,6 +628,11 @@ private:
       dbgs() << "Invalidating all non-preserved analyses for: " << IR.getName()
              << "\n";
 
+    // Each result is checked against the set the pass returned rather than
+    // against PA, which is updated below. This way a result that holds on to
+    // another one which was just invalidated sees that dependency as lost.
+    const PreservedAnalyses PassPA = PA;
+
     // Clear all the invalidated results associated specifically with this
     // function.
     SmallVector<void *, 8> InvalidatedPassIDs;
@@ -591,14 +645,17 @@ private:
       // Pass the invalidation down to the pass itself to see if it thinks it is
       // necessary. The analysis pass can return false if no action on the part
       // of the analysis manager is required for this invalidation event.
-      if (I->second->invalidate(IR, PA)) {
+      if (I->second->invalidate(IR, PassPA)) {
         if (DebugLogging)
           dbgs() << "Invalidating analysis: " << this->lookupPass(PassID).name()
                  << "\n";
 
+        PassTimingInfo::recordInvalidation(this->lookupPass(PassID).name());
+        detail::countAnalysisInvalidated();
         InvalidatedPassIDs.push_back(I->first);
         I = ResultsList.erase(I);
       } else {
+        detail::countAnalysisKept();
         ++I;
       }
 
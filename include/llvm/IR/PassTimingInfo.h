@@ -0,0 +1,96 @@
+//===- PassTimingInfo.h - Profiling of the new pass manager -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This header defines the hooks the new pass manager uses to implement
+/// -time-passes. Every pass run by a PassManager and every analysis computed
+/// by an AnalysisManager is attributed the time it took, the change in malloc
+/// usage, the growth of the peak resident set size, and the number of times
+/// its results were invalidated. Time and memory are exclusive: a nested pass
+/// manager or adaptor is only charged for its own overhead, not for the
+/// passes it runs.
+///
+/// The report is printed when the process shuts down, to the
+/// -info-output-file like the legacy timing report. With
+/// -time-passes-json=<file> it is also written to that file as JSON.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_IR_PASSTIMINGINFO_H
+#define LLVM_IR_PASSTIMINGINFO_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Timer.h"
+#include <cstddef>
+
+namespace llvm {
+
+class raw_ostream;
+
+class PassTimingInfo {
+public:
+  enum class Kind { Pass, Analysis };
+
+  /// \brief Returns true when -time-passes is given.
+  static bool isEnabled() { return TimePassesIsEnabled; }
+
+  /// \brief Charges the time and memory used while this object is alive to a
+  /// pass or an analysis.
+  ///
+  /// Does nothing unless -time-passes is enabled. Scopes on one thread must
+  /// nest.
+  class Scope {
+    StringRef Name;
+    Kind K;
+    bool Active;
+    Scope *Parent;
+    /// When this scope last started or resumed running.
+    TimeRecord Resumed;
+    size_t ResumedPeakRSS;
+    /// What this scope has used so far, excluding its nested scopes.
+    TimeRecord Used;
+    size_t PeakRSSGrowth;
+
+    void start();
+    void stop();
+    void pause(const TimeRecord &Now, size_t PeakRSS);
+    void resume(const TimeRecord &Now, size_t PeakRSS);
+
+  public:
+    Scope(StringRef Name, Kind K) : Name(Name), K(K), Active(isEnabled()) {
+      if (Active)
+        start();
+    }
+    ~Scope() {
+      if (Active)
+        stop();
+    }
+  };
+
+  /// \brief Counts one invalidation of the results of an analysis.
+  static void recordInvalidation(StringRef AnalysisName) {
+    if (isEnabled())
+      recordInvalidationImpl(AnalysisName);
+  }
+
+  /// \brief Prints the report collected so far, writes it to the
+  /// -time-passes-json file if there is one, and clears it.
+  static void report();
+
+  /// \brief Prints the collected data as JSON.
+  static void printJSON(raw_ostream &OS);
+
+private:
+  static void recordInvalidationImpl(StringRef AnalysisName);
+};
+
+} // end namespace llvm
+
+#endif
@@ -22,6 +22,7 @@
 #define LLVM_IR_VERIFIER_H
 
 #include "llvm/IR/PassManager.h"
+#include <memory>
 
 namespace llvm {
 
@@ -30,6 +31,7 @@ class FunctionPass;
 class ModulePass;
 class Module;
 class raw_ostream;
+struct VerifierFunctionState;
 
 /// \brief Check a function for errors, useful for use when debugging a
 /// pass.
@@ -52,6 +54,17 @@ bool verifyFunction(const Function &F, raw_ostream *OS = nullptr);
 bool verifyModule(const Module &M, raw_ostream *OS = nullptr,
                   bool *BrokenDebugInfo = nullptr);
 
+/// \brief Check a module for errors, verifying its functions on several
+/// threads.
+///
+/// This behaves as verifyModule, except that the function bodies are checked
+/// concurrently before the module-level checks, so it must not run while
+/// other threads use the module's context. The messages are printed in the
+/// order of the module, though a broken metadata node shared by functions
+/// of different threads may be reported more than once.
+bool verifyModuleInParallel(const Module &M, raw_ostream *OS = nullptr,
+                            bool *BrokenDebugInfo = nullptr);
+
 FunctionPass *createVerifierPass(bool FatalErrors = true);
 
 /// Check a module for errors, and report separate error states for IR
@@ -62,7 +75,9 @@ class VerifierAnalysis : public AnalysisInfoMixin<VerifierAnalysis> {
 
 public:
   struct Result {
-    bool IRBroken, DebugInfoBroken;
+    bool IRBroken = false, DebugInfoBroken = false;
+    /// For a function, what the module-level checks need from its body.
+    std::shared_ptr<const VerifierFunctionState> FunctionState;
   };
   static void *ID() { return (void *)&PassID; }
   Result run(Module &M, ModuleAnalysisManager &);
@@ -82,13 +97,20 @@ bool verifyModule(bool &BrokenDebugInfo, const Module &M, raw_ostream *OS);
 /// printed to stderr, and by default they are fatal. You can override that by
 /// passing \c false to \p FatalErrors.
 ///
+/// With \p Incremental, the module version only re-verifies the functions
+/// whose \c VerifierAnalysis result the passes since the last verification
+/// didn't preserve, and otherwise reuses the cached function results along
+/// with what they recorded for the module-level checks.
+///
 /// Note that this creates a pass suitable for the legacy pass manager. It has
 /// nothing to do with \c VerifierPass.
 class VerifierPass : public PassInfoMixin<VerifierPass> {
   bool FatalErrors;
+  bool Incremental;
 
 public:
-  explicit VerifierPass(bool FatalErrors = true) : FatalErrors(FatalErrors) {}
+  explicit VerifierPass(bool FatalErrors = true, bool Incremental = false)
+      : FatalErrors(FatalErrors), Incremental(Incremental) {}
 
   PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
   PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
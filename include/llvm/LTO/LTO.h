@@ -70,6 +70,16 @@ void thinLTOResolveWeakForLinkerInIndex(
 void thinLTOInternalizeAndPromoteInIndex(
     ModuleSummaryIndex &Index,
     function_ref<bool(StringRef, GlobalValue::GUID)> isExported);
+
+/// Compute the readnone, readonly, nounwind and norecurse attributes of the
+/// functions in the given \p Index from their summaries and the call graph,
+/// and record them in the summaries. The ThinLTO backends must apply them to
+/// the Module via thinLTOApplyFunctionAttrsModule.
+///
+/// This must run on an index merged from per-module summaries: the combined
+/// index written to bitcode drops the call edges to the functions that don't
+/// have a summary.
+void thinLTOPropagateFunctionAttrsInIndex(ModuleSummaryIndex &Index);
 }
 
 #endif
@@ -172,6 +172,23 @@ struct LTOCodeGenerator {
   /// Calls \a verifyMergedModuleOnce().
   bool compileOptimized(ArrayRef<raw_pwrite_stream *> Out);
 
+  /// Compiles the merged optimized module into \p ParallelismLevel object
+  /// files in memory, each representing a linkable partition of the module,
+  /// with code generation done in parallel with one thread per partition.
+  /// Returns an empty vector if the compilation was not successful.
+  ///
+  /// If \p ParallelismLevel is greater than one, the merged module is
+  /// consumed by the splitting and cannot be compiled or written again.
+  std::vector<std::unique_ptr<MemoryBuffer>>
+  compileOptimizedParallel(unsigned ParallelismLevel);
+
+  /// Optimizes the merged module, then compiles it as
+  /// compileOptimizedParallel() does.
+  std::vector<std::unique_ptr<MemoryBuffer>>
+  compileParallel(unsigned ParallelismLevel, bool DisableVerify,
+                  bool DisableInline, bool DisableGVNLoadPRE,
+                  bool DisableVectorization);
+
   void setDiagnosticHandler(lto_diagnostic_handler_t, void *);
 
   LLVMContext &getContext() { return Context; }
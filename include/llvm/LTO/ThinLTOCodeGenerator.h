@@ -112,6 +112,8 @@ public:
     int PruningInterval = 1200;          // seconds, -1 to disable pruning.
     unsigned int Expiration = 7 * 24 * 3600;     // seconds (1w default).
     unsigned MaxPercentageOfAvailableSpace = 75; // percentage.
+    uint64_t MaxSizeBytes = 0;           // bytes, 0 for no limit.
+    bool PruneInBackground = false;
   };
 
   /// Provide a path to a directory where to store the cached files for
@@ -150,6 +152,19 @@ public:
       CacheOptions.MaxPercentageOfAvailableSpace = Percentage;
   }
 
+  /// Cache policy: the maximum size of the cache in bytes. When it is
+  /// exceeded, the least recently used entries are removed first. A value of 0
+  /// (default) sets no limit beyond the percentage of the available space.
+  void setMaxCacheSizeBytes(uint64_t Bytes) {
+    CacheOptions.MaxSizeBytes = Bytes;
+  }
+
+  /// Cache policy: prune the cache on a separate thread while the modules are
+  /// optimized and code generated, instead of after they are done.
+  void setCachePruningInBackground(bool Enable) {
+    CacheOptions.PruneInBackground = Enable;
+  }
+
   /**@}*/
 
   /// Set the path to a directory where to save temporaries at various stages of
@@ -238,6 +253,16 @@ public:
    */
   std::unique_ptr<MemoryBuffer> codegen(Module &Module);
 
+  /**
+   * Perform a complete distributed ThinLTO backend for \p Module: promotion,
+   * cross-module importing, optimization and CodeGen. \p Index is the
+   * individual index produced for this module during the thin-link (see
+   * gatherImportedSummariesForModule()), the full combined index is not
+   * needed. The modules to import from must have been added with addModule().
+   */
+  std::unique_ptr<MemoryBuffer> distributedBackend(Module &Module,
+                                                   ModuleSummaryIndex &Index);
+
   /**@}*/
 
 private:
@@ -12,9 +12,11 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/MC/MCValue.h"
 
 namespace llvm {
 class MCAssembler;
+class MCExpr;
 class MCFragment;
 class MCSection;
 class MCSymbol;
@@ -44,6 +46,33 @@ class MCAsmLayout {
   /// \brief Is the layout for this fragment valid?
   bool isFragmentValid(const MCFragment *F) const;
 
+public:
+  /// The sections whose fragment offsets an expression value was computed
+  /// from, with the generation of each section at the time.
+  typedef SmallVector<std::pair<const MCSection *, unsigned>, 2> ValueDepsTy;
+
+private:
+  /// Number of times the fragments of each section have been invalidated.
+  /// Offsets of valid fragments never change in between, so neither do the
+  /// values of expressions computed from them.
+  DenseMap<const MCSection *, unsigned> SectionGenerations;
+
+  struct CachedValue {
+    MCValue Value;
+    ValueDepsTy Deps;
+  };
+
+  /// Values of expressions successfully evaluated against this layout, keyed
+  /// by the expression and the InSet flag it was evaluated with.
+  mutable DenseMap<std::pair<const MCExpr *, unsigned>, CachedValue>
+      ValueCache;
+
+  /// Where to record the sections read by the expression being evaluated.
+  mutable ValueDepsTy *CurrentDeps = nullptr;
+
+  void addValueDep(const MCSection *Sec, unsigned Gen) const;
+  void addValueDeps(const ValueDepsTy &Deps) const;
+
 public:
   MCAsmLayout(MCAssembler &Assembler);
 
@@ -75,6 +104,28 @@ public:
   /// \brief Get the offset of the given fragment inside its containing section.
   uint64_t getFragmentOffset(const MCFragment *F) const;
 
+  /// @}
+  /// \name Expression Value Cache
+  /// @{
+
+  /// \brief Look up the value of \p E, evaluated with \p InSet, recorded by
+  /// cacheValue(). It is only returned if none of the sections it was
+  /// computed from have been invalidated since.
+  bool getCachedValue(const MCExpr *E, bool InSet, MCValue &Res) const;
+
+  /// \brief Make fragment offset queries record their section in \p Deps,
+  /// until the previous destination, which is returned, is restored.
+  ValueDepsTy *setValueDeps(ValueDepsTy *Deps) const {
+    ValueDepsTy *Old = CurrentDeps;
+    CurrentDeps = Deps;
+    return Old;
+  }
+
+  /// \brief Finish the evaluation of \p E, whose sections were recorded in
+  /// \p Deps. If \p Res is non-null it is cached as the value of \p E.
+  void finishValue(const MCExpr *E, bool InSet, const MCValue *Res,
+                   ValueDepsTy &Deps, ValueDepsTy *OuterDeps) const;
+
   /// @}
   /// \name Utility Functions
   /// @{
@@ -178,9 +178,14 @@ private:
   /// were adjusted.
   bool layoutOnce(MCAsmLayout &Layout);
 
-  /// \brief Perform one layout iteration of the given section and return true
-  /// if any offsets were adjusted.
-  bool layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec);
+  /// \brief Perform one layout iteration over the relaxation candidates of a
+  /// section and return true if any offsets were adjusted.
+  ///
+  /// \p Worklist holds the fragments of the section that may still change
+  /// size, in layout order. Fragments that can no longer be relaxed are
+  /// removed from it, so later iterations only revisit live candidates.
+  bool layoutSectionOnce(MCAsmLayout &Layout,
+                         SmallVectorImpl<MCFragment *> &Worklist);
 
   bool relaxInstruction(MCAsmLayout &Layout, MCRelaxableFragment &IF);
 
@@ -76,6 +76,9 @@ namespace llvm {
     /// objects.
     BumpPtrAllocator Allocator;
 
+    /// Reports the memory held by Allocator for -print-memory-usage.
+    MemoryUsageReporter AllocatorUsage;
+
     SpecificBumpPtrAllocator<MCSectionCOFF> COFFAllocator;
     SpecificBumpPtrAllocator<MCSectionELF> ELFAllocator;
     SpecificBumpPtrAllocator<MCSectionMachO> MachOAllocator;
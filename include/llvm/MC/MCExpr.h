@@ -55,6 +55,12 @@ private:
                           const MCAsmLayout *Layout,
                           const SectionAddrMap *Addrs, bool InSet) const;
 
+  bool evaluateAsRelocatableUncached(MCValue &Res, const MCAssembler *Asm,
+                                     const MCAsmLayout *Layout,
+                                     const MCFixup *Fixup,
+                                     const SectionAddrMap *Addrs,
+                                     bool InSet) const;
+
 protected:
   explicit MCExpr(ExprKind Kind) : Kind(Kind) {}
 
@@ -25,7 +25,9 @@ enum DecoderOps {
   OPC_TryDecode,        // OPC_TryDecode(uleb128 Opcode, uleb128 DIdx,
                         //               uint16_t NumToSkip)
   OPC_SoftFail,         // OPC_SoftFail(uleb128 PMask, uleb128 NMask)
-  OPC_Fail              // OPC_Fail()
+  OPC_Fail,             // OPC_Fail()
+  OPC_FilterSwitch      // OPC_FilterSwitch(uint8_t Start, uint8_t Len,
+                        //                  uint16_t NumToSkip[1 << Len])
 };
 
 } // namespace MCDecode
@@ -38,8 +38,13 @@ public:
   /// Can only be used before the table is finalized.
   size_t add(StringRef S);
 
+  /// \brief Add a string whose hash value the caller has already computed with
+  /// DenseMapInfo<StringRef>::getHashValue. Behaves like add(StringRef).
+  size_t add(CachedHash<StringRef> S);
+
   /// \brief Analyze the strings and build the final table. No more strings can
-  /// be added after this point.
+  /// be added after this point. Large tables are sorted on the threads of the
+  /// default parallel pool; the result does not depend on the thread count.
   void finalize();
 
   /// Finalize the string table without reording it. In this mode, offsets
@@ -14,6 +14,9 @@
 #ifndef LLVM_OBJECT_ARCHIVE_H
 #define LLVM_OBJECT_ARCHIVE_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Object/Binary.h"
@@ -21,6 +24,8 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <mutex>
 
 namespace llvm {
 namespace object {
@@ -210,6 +215,11 @@ public:
   // check if a symbol is in the archive
   child_iterator findSym(StringRef name) const;
 
+  /// Look up each of \p Names in the symbol table. On return, Result[i] is
+  /// the member defining Names[i], or child_end() if there is none.
+  void findSyms(ArrayRef<StringRef> Names,
+                SmallVectorImpl<child_iterator> &Result) const;
+
   bool hasSymbolTable() const;
   StringRef getSymbolTable() const { return SymbolTable; }
   uint32_t getNumberOfSymbols() const;
@@ -229,6 +239,15 @@ private:
   unsigned Format : 3;
   unsigned IsThin : 1;
   mutable std::vector<std::unique_ptr<MemoryBuffer>> ThinBuffers;
+
+  /// Maps each symbol name to its first entry in the symbol table. Built on
+  /// the first lookup so that resolving many names against a large archive
+  /// does not rescan the whole symbol table each time.
+  typedef DenseMap<StringRef, Symbol> SymbolIndexTy;
+  mutable std::unique_ptr<SymbolIndexTy> SymbolIndex;
+  mutable std::mutex SymbolIndexLock;
+  const SymbolIndexTy &getSymbolIndex() const;
+  child_iterator getSymbolMember(const Symbol &S) const;
 };
 
 }
@@ -205,6 +205,12 @@ protected:
   const Elf_Shdr *DotSymtabSec = nullptr; // Symbol table section.
   ArrayRef<Elf_Word> ShndxTable;
 
+  // The string tables of DotDynSymSec and DotSymtabSec, so that naming a
+  // symbol doesn't look them up and check them again. Empty if the link is
+  // invalid; getSymbolName then reports the error.
+  StringRef DotDynSymStrTab;
+  StringRef DotSymtabStrTab;
+
   void moveSymbolNext(DataRefImpl &Symb) const override;
   Expected<StringRef> getSymbolName(DataRefImpl Symb) const override;
   Expected<uint64_t> getSymbolAddress(DataRefImpl Symb) const override;
@@ -364,10 +370,18 @@ void ELFObjectFile<ELFT>::moveSymbolNext(DataRefImpl &Sym) const {
 template <class ELFT>
 Expected<StringRef> ELFObjectFile<ELFT>::getSymbolName(DataRefImpl Sym) const {
   const Elf_Sym *ESym = getSymbol(Sym);
-  const Elf_Shdr *SymTableSec = *EF.getSection(Sym.d.a);
-  const Elf_Shdr *StringTableSec = *EF.getSection(SymTableSec->sh_link);
-  StringRef SymTable = *EF.getStringTable(StringTableSec);
-  return ESym->getName(SymTable);
+  ErrorOr<const Elf_Shdr *> SymTableSecOrErr = EF.getSection(Sym.d.a);
+  if (std::error_code EC = SymTableSecOrErr.getError())
+    return errorCodeToError(EC);
+  const Elf_Shdr *SymTableSec = *SymTableSecOrErr;
+  if (SymTableSec == DotSymtabSec && !DotSymtabStrTab.empty())
+    return ESym->getName(DotSymtabStrTab);
+  if (SymTableSec == DotDynSymSec && !DotDynSymStrTab.empty())
+    return ESym->getName(DotDynSymStrTab);
+  ErrorOr<StringRef> StrTabOrErr = EF.getStringTableForSymtab(*SymTableSec);
+  if (std::error_code EC = StrTabOrErr.getError())
+    return errorCodeToError(EC);
+  return ESym->getName(*StrTabOrErr);
 }
 
 template <class ELFT>
@@ -785,6 +799,17 @@ ELFObjectFile<ELFT>::ELFObjectFile(MemoryBufferRef Object, std::error_code &EC)
     }
     }
   }
+
+  if (DotDynSymSec) {
+    ErrorOr<StringRef> StrTabOrErr = EF.getStringTableForSymtab(*DotDynSymSec);
+    if (StrTabOrErr)
+      DotDynSymStrTab = *StrTabOrErr;
+  }
+  if (DotSymtabSec) {
+    ErrorOr<StringRef> StrTabOrErr = EF.getStringTableForSymtab(*DotSymtabSec);
+    if (StrTabOrErr)
+      DotSymtabStrTab = *StrTabOrErr;
+  }
 }
 
 template <class ELFT>
@@ -77,6 +77,15 @@ public:
 
   static ErrorOr<std::unique_ptr<IRObjectFile>> create(MemoryBufferRef Object,
                                                        LLVMContext &Context);
+
+  /// \brief Reads the names and flags of the symbols of \p Object from the
+  /// symbol table block of its bitcode, without parsing the module. The names
+  /// point into \p Object and the flags are BasicSymbolRef::Flags. Returns
+  /// false if the bitcode has no symbol table block; create() must then be
+  /// used to list the symbols.
+  static ErrorOr<bool>
+  readSymbolTable(MemoryBufferRef Object,
+                  std::vector<std::pair<StringRef, uint32_t>> &Symbols);
 };
 }
 }
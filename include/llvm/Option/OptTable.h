@@ -65,6 +65,12 @@ private:
   StringSet<> PrefixesUnion;
   std::string PrefixChars;
 
+  /// The perfect hash table of option spellings emitted by OptParserEmitter,
+  /// if the table was given one. Each bucket has a displacement, and each slot
+  /// holds the index in OptionInfos plus one, or zero if it is empty.
+  ArrayRef<unsigned> HashDisplacements;
+  ArrayRef<unsigned> HashSlots;
+
 private:
   const Info &getInfo(OptSpecifier Opt) const {
     unsigned id = Opt.getID();
@@ -72,8 +78,20 @@ private:
     return OptionInfos[id - 1];
   }
 
+  /// \brief Find the option spelled exactly like \p Str, using the hash table.
+  ///
+  /// \param Name - \p Str without its prefix characters.
+  /// \return The option, or null if there is none or no hash table.
+  const Info *findExactOption(StringRef Str, StringRef Name) const;
+
 protected:
-  OptTable(ArrayRef<Info> OptionInfos, bool IgnoreCase = false);
+  /// \param HashDisplacements, HashSlots - The perfect hash table of option
+  /// spellings that OptParserEmitter emits as OPTION_HASH_DISPLACEMENT and
+  /// OPTION_HASH_SLOT. It lets arguments that spell an option exactly be
+  /// parsed without searching the table. It is optional.
+  OptTable(ArrayRef<Info> OptionInfos, bool IgnoreCase = false,
+           ArrayRef<unsigned> HashDisplacements = None,
+           ArrayRef<unsigned> HashSlots = None);
 
 public:
   ~OptTable();
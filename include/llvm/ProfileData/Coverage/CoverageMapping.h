@@ -18,6 +18,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/ProfileData/InstrProf.h"
@@ -36,7 +37,8 @@ enum class coveragemap_error {
   no_data_found,
   unsupported_version,
   truncated,
-  malformed
+  malformed,
+  decompression_failed
 };
 
 const std::error_category &coveragemap_category();
@@ -432,12 +434,25 @@ public:
 /// fill out execution counts.
 class CoverageMapping {
   std::vector<FunctionRecord> Functions;
+  /// \brief For each file, the indices in Functions of the functions that
+  /// have regions in it, in ascending order.
+  StringMap<std::vector<unsigned>> FileFunctions;
   unsigned MismatchedFunctionCount;
 
   CoverageMapping() : MismatchedFunctionCount(0) {}
 
+  /// \brief Fill in FileFunctions once all the functions are loaded.
+  void buildFileIndex();
+
+  /// \brief The indices of the functions with regions in \p Filename.
+  ArrayRef<unsigned> getFileFunctions(StringRef Filename) const;
+
 public:
   /// \brief Load the coverage mapping using the given readers.
+  ///
+  /// If \p CoverageReader supports random access, the records are decoded
+  /// and matched with their counts in parallel. The result is the same as
+  /// reading them in sequence.
   static Expected<std::unique_ptr<CoverageMapping>>
   load(CoverageMappingReader &CoverageReader,
        IndexedInstrProfReader &ProfileReader);
@@ -451,7 +466,7 @@ public:
   ///
   /// This is a count of functions whose profile is out of date or otherwise
   /// can't be associated with any coverage information.
-  unsigned getMismatchedCount() { return MismatchedFunctionCount; }
+  unsigned getMismatchedCount() const { return MismatchedFunctionCount; }
 
   /// \brief Returns the list of files that are covered.
   std::vector<StringRef> getUniqueSourceFiles() const;
@@ -461,7 +476,7 @@ public:
   /// The given filename must be the name as recorded in the coverage
   /// information. That is, only names returned from getUniqueSourceFiles will
   /// yield a result.
-  CoverageData getCoverageForFile(StringRef Filename);
+  CoverageData getCoverageForFile(StringRef Filename) const;
 
   /// \brief Gets all of the functions covered by this profile.
   iterator_range<FunctionRecordIterator> getCoveredFunctions() const {
@@ -480,13 +495,15 @@ public:
   ///
   /// Functions that are instantiated more than once, such as C++ template
   /// specializations, have distinct coverage records for each instantiation.
-  std::vector<const FunctionRecord *> getInstantiations(StringRef Filename);
+  std::vector<const FunctionRecord *>
+  getInstantiations(StringRef Filename) const;
 
   /// \brief Get the coverage for a particular function.
-  CoverageData getCoverageForFunction(const FunctionRecord &Function);
+  CoverageData getCoverageForFunction(const FunctionRecord &Function) const;
 
   /// \brief Get the coverage for an expansion within a coverage set.
-  CoverageData getCoverageForExpansion(const ExpansionRecord &Expansion);
+  CoverageData
+  getCoverageForExpansion(const ExpansionRecord &Expansion) const;
 };
 
 // Profile coverage map has the following layout:
@@ -580,7 +597,10 @@ enum CovMapVersion {
   // name string pointer to MD5 to support name section compression. Name
   // section is also compressed.
   Version2 = 1,
-  // The current version is Version2
+  // The filenames and the coverage mapping data of a translation unit may be
+  // compressed with zlib.
+  Version3 = 2,
+  // The current version is Version3
   CurrentVersion = INSTR_PROF_COVMAP_VERSION
 };
 
@@ -16,14 +16,17 @@
 #define LLVM_PROFILEDATA_COVERAGEMAPPINGREADER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/ProfileData/Coverage/CoverageMapping.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include <iterator>
+#include <memory>
 
 namespace llvm {
 namespace coverage {
@@ -69,12 +72,36 @@ public:
 
 class CoverageMappingReader {
 public:
+  /// \brief Storage for the arrays of a decoded CoverageMappingRecord.
+  struct RecordBuffers {
+    std::vector<StringRef> Filenames;
+    std::vector<CounterExpression> Expressions;
+    std::vector<CounterMappingRegion> MappingRegions;
+  };
+
   virtual Error readNextRecord(CoverageMappingRecord &Record) = 0;
+
+  /// \brief The number of records that readRecord can decode, or 0 if the
+  /// records can only be read in sequence with readNextRecord.
+  virtual size_t getNumRecords() const { return 0; }
+
+  /// \brief Decode the record at \p Index into \p Record, whose arrays are
+  /// kept in \p Buffers. This doesn't change the state of the reader, so
+  /// different threads may decode records at once, each with its own buffers.
+  virtual Error readRecord(size_t Index, CoverageMappingRecord &Record,
+                           RecordBuffers &Buffers) const {
+    llvm_unreachable("reader does not support random access");
+  }
+
   CoverageMappingIterator begin() { return CoverageMappingIterator(this); }
   CoverageMappingIterator end() { return CoverageMappingIterator(); }
   virtual ~CoverageMappingReader() {}
 };
 
+/// \brief Storage for the coverage data that had to be decompressed, which
+/// the decoded strings and records point into.
+typedef std::vector<std::unique_ptr<SmallVector<char, 0>>> DecompressedData;
+
 /// \brief Base class for the raw coverage mapping and filenames data readers.
 class RawCoverageReader {
 protected:
@@ -83,9 +110,16 @@ protected:
   RawCoverageReader(StringRef Data) : Data(Data) {}
 
   Error readULEB128(uint64_t &Result);
+  /// Read \p Count consecutive ULEB128 values at once.
+  Error readULEB128s(uint64_t *Results, size_t Count);
   Error readIntMax(uint64_t &Result, uint64_t MaxPlus1);
   Error readSize(uint64_t &Result);
   Error readString(StringRef &Result);
+  /// Read a block of data that may be compressed: its uncompressed size, its
+  /// compressed size, or 0 if it is stored uncompressed, and the data itself.
+  /// \p Block is set to the uncompressed data, which is kept in \p Decompressed
+  /// if it had to be decompressed.
+  Error readCompressibleBlock(StringRef &Block, DecompressedData &Decompressed);
 };
 
 /// \brief Reader for the raw coverage filenames.
@@ -96,11 +130,30 @@ class RawCoverageFilenamesReader : public RawCoverageReader {
   RawCoverageFilenamesReader &
   operator=(const RawCoverageFilenamesReader &) = delete;
 
+  Error readFilenames(uint64_t NumFilenames);
+
 public:
   RawCoverageFilenamesReader(StringRef Data, std::vector<StringRef> &Filenames)
       : RawCoverageReader(Data), Filenames(Filenames) {}
 
+  /// \brief Read filenames that are stored uncompressed, as they are before
+  /// Version3.
   Error read();
+
+  /// \brief Read filenames encoded in the given format version. Filenames
+  /// that had to be decompressed are kept in \p Decompressed.
+  Error read(CovMapVersion Version, DecompressedData &Decompressed);
+};
+
+/// \brief Reader for the coverage mapping data of a translation unit, which
+/// is stored as a compressible block since Version3.
+class RawCoverageMappingDataReader : public RawCoverageReader {
+public:
+  RawCoverageMappingDataReader(StringRef Data) : RawCoverageReader(Data) {}
+
+  /// \brief Set \p MappingData to the uncompressed mapping data, kept in
+  /// \p Decompressed if it had to be decompressed.
+  Error read(StringRef &MappingData, DecompressedData &Decompressed);
 };
 
 /// \brief Checks if the given coverage mapping data is exported for
@@ -170,9 +223,8 @@ private:
   std::vector<ProfileMappingRecord> MappingRecords;
   InstrProfSymtab ProfileNames;
   size_t CurrentRecord;
-  std::vector<StringRef> FunctionsFilenames;
-  std::vector<CounterExpression> Expressions;
-  std::vector<CounterMappingRegion> MappingRegions;
+  RecordBuffers Buffers;
+  DecompressedData Decompressed;
 
   BinaryCoverageReader(const BinaryCoverageReader &) = delete;
   BinaryCoverageReader &operator=(const BinaryCoverageReader &) = delete;
@@ -185,6 +237,9 @@ public:
          StringRef Arch);
 
   Error readNextRecord(CoverageMappingRecord &Record) override;
+  size_t getNumRecords() const override { return MappingRecords.size(); }
+  Error readRecord(size_t Index, CoverageMappingRecord &Record,
+                   RecordBuffers &Buffers) const override;
 };
 
 } // end namespace coverage
@@ -32,8 +32,26 @@ public:
   CoverageFilenamesSectionWriter(ArrayRef<StringRef> Filenames)
       : Filenames(Filenames) {}
 
-  /// \brief Write encoded filenames to the given output stream.
-  void write(raw_ostream &OS);
+  /// \brief Write encoded filenames to the given output stream, in the
+  /// Version3 format. Unless \p Compress is false, the names are compressed
+  /// when zlib is available and it makes them smaller.
+  void write(raw_ostream &OS, bool Compress = true);
+};
+
+/// \brief Writer of the coverage mapping data of a translation unit, which
+/// follows its filenames in the coverage mapping section.
+class CoverageMappingDataWriter {
+  StringRef MappingData;
+
+public:
+  /// \p MappingData is the concatenation of what CoverageMappingWriter wrote
+  /// for each function of the translation unit, in the order of their records.
+  CoverageMappingDataWriter(StringRef MappingData) : MappingData(MappingData) {}
+
+  /// \brief Write the mapping data to the given output stream, in the
+  /// Version3 format. Unless \p Compress is false, the data is compressed when
+  /// zlib is available and it makes it smaller.
+  void write(raw_ostream &OS, bool Compress = true);
 };
 
 /// \brief Writer for instrumentation based coverage mapping data.
@@ -297,6 +297,11 @@ public:
                               const unsigned char *const End);
   data_type ReadData(StringRef K, const unsigned char *D, offset_type N);
 
+  /// Locate the counters of the record with structural hash \p FuncHash in
+  /// the \p N bytes of payload at \p D without decoding any record.
+  Error findCounts(const unsigned char *D, offset_type N, uint64_t FuncHash,
+                   ArrayRef<support::ulittle64_t> &Counts);
+
   // Used for testing purpose only.
   void setValueProfDataEndianness(support::endianness Endianness) {
     ValueProfDataEndianness = Endianness;
@@ -310,6 +315,13 @@ struct InstrProfReaderIndexBase {
   // Read all the profile records with the key equal to FuncName
   virtual Error getRecords(StringRef FuncName,
                                      ArrayRef<InstrProfRecord> &Data) = 0;
+  // Point Counts at the on-disk counters of the record with the key equal
+  // to FuncName and the given structural hash.
+  virtual Error getCounts(StringRef FuncName, uint64_t FuncHash,
+                          ArrayRef<support::ulittle64_t> &Counts) = 0;
+  // Touch the hash table entries for FuncNames in the order they appear in
+  // the profile data.
+  virtual void prefetch(ArrayRef<StringRef> FuncNames) = 0;
   virtual void advanceToNextKey() = 0;
   virtual bool atEnd() const = 0;
   virtual void setValueProfDataEndianness(support::endianness Endianness) = 0;
@@ -339,6 +351,9 @@ public:
   Error getRecords(ArrayRef<InstrProfRecord> &Data) override;
   Error getRecords(StringRef FuncName,
                    ArrayRef<InstrProfRecord> &Data) override;
+  Error getCounts(StringRef FuncName, uint64_t FuncHash,
+                  ArrayRef<support::ulittle64_t> &Counts) override;
+  void prefetch(ArrayRef<StringRef> FuncNames) override;
   void advanceToNextKey() override { RecordIterator++; }
   bool atEnd() const override {
     return RecordIterator == HashTable->data_end();
@@ -398,6 +413,21 @@ public:
   Error getFunctionCounts(StringRef FuncName, uint64_t FuncHash,
                           std::vector<uint64_t> &Counts);
 
+  /// Point Counts at the profile data for the given function name without
+  /// copying it.  The counters live in the profile buffer and remain valid
+  /// for the lifetime of the reader.  Unlike getInstrProfRecord, this does
+  /// not decode value profile data or the other records sharing the name.
+  /// It does not change the state of the reader either, so it may be called
+  /// from several threads at once.
+  Error getFunctionCounts(StringRef FuncName, uint64_t FuncHash,
+                          ArrayRef<support::ulittle64_t> &Counts) const;
+
+  /// Prepare for looking up the records of many functions, e.g. all the
+  /// functions defined in a module.  The hash table entries for FuncNames are
+  /// touched in file order so that a memory mapped profile is paged in
+  /// sequentially rather than in the order the functions are visited.
+  void prefetchRecords(ArrayRef<StringRef> FuncNames);
+
   /// Return the maximum of all known function counts.
   uint64_t getMaximumFunctionCount() { return Summary->getMaxFunctionCount(); }
 
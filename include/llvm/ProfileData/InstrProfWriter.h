@@ -20,6 +20,7 @@
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <vector>
 
 namespace llvm {
 
@@ -47,6 +48,12 @@ public:
   /// for this function and the hash and number of counts match, each counter is
   /// summed. Optionally scale counts by \p Weight.
   Error addRecord(InstrProfRecord &&I, uint64_t Weight = 1);
+  /// Merge all the function counts from \p IPW into this writer, leaving
+  /// \p IPW empty.  Errors from merging individual records are passed to
+  /// \p Warn along with the name of the offending function.  Report an error
+  /// if \p IPW holds a different kind of profile than this writer.
+  Error mergeRecordsFromWriter(InstrProfWriter &&IPW,
+                               function_ref<void(Error, StringRef)> Warn);
   /// Write the profile to \c OS
   void write(raw_fd_ostream &OS);
   /// Write the profile in text format to \c OS
@@ -75,6 +82,8 @@ public:
 
 private:
   bool shouldEncodeData(const ProfilingData &PD);
+  /// Return the functions to write, in name order.
+  std::vector<const StringMapEntry<ProfilingData> *> getOrderedFunctionData();
   void writeImpl(ProfOStream &OS);
 };
 
@@ -74,6 +74,15 @@ static inline uint64_t SPMagic() {
          uint64_t('2') << (64 - 56) | uint64_t(0xff);
 }
 
+/// Magic number of the indexed binary encoding, which adds a function offset
+/// table to the binary encoding so that profiles can be read one at a time.
+static inline uint64_t SPIndexedMagic() {
+  return uint64_t('S') << (64 - 8) | uint64_t('P') << (64 - 16) |
+         uint64_t('R') << (64 - 24) | uint64_t('O') << (64 - 32) |
+         uint64_t('F') << (64 - 40) | uint64_t('I') << (64 - 48) |
+         uint64_t('X') << (64 - 56) | uint64_t(0xff);
+}
+
 static inline uint64_t SPVersion() { return 103; }
 
 /// Represents the relative location of an instruction.
@@ -323,6 +332,34 @@ private:
 
 raw_ostream &operator<<(raw_ostream &OS, const FunctionSamples &FS);
 
+/// One frame of a calling context: a function and, unless it is the last
+/// frame, the location of its call to the next frame.
+struct SampleContextFrame {
+  SampleContextFrame(StringRef FuncName, LineLocation CallSite)
+      : FuncName(FuncName), CallSite(CallSite) {}
+
+  StringRef FuncName;
+  LineLocation CallSite;
+};
+
+/// Calling contexts of context-sensitive profiles.
+///
+/// The profile of a function in one calling context is named after that
+/// context, as in "[main:3 @ _Z3bari:2.1 @ _Z3fooi]". The frames go from the
+/// outermost caller to the function itself, and each caller is followed by
+/// the line offset and discriminator of its call to the next frame.
+class SampleContext {
+public:
+  /// Return true if \p Name is the name of a context-sensitive profile.
+  static bool isContext(StringRef Name) { return Name.startswith("["); }
+
+  /// Split the context \p Name into \p Frames.
+  ///
+  /// \returns false if \p Name is not a well-formed context.
+  static bool parse(StringRef Name,
+                    SmallVectorImpl<SampleContextFrame> &Frames);
+};
+
 /// Sort a LocationT->SampleT map by LocationT.
 ///
 /// It produces a sorted list of <LocationT, SampleT> records by ascending
@@ -48,6 +48,17 @@
 // in the prologue of the function (second number). This head sample
 // count provides an indicator of how frequently the function is invoked.
 //
+// A function can also have profiles for some of its calling contexts, kept
+// apart from its other samples. The header of such a profile names the
+// context instead of the function:
+//
+//     [caller1:offset1[.discriminator] @ ... @ function1]:total_samples:0
+//
+// The frames go from the outermost caller to the function, and each caller
+// is followed by the location of its call to the next frame. The loader
+// inlines the hot contexts into their outermost caller, and merges the others
+// into the profile of the function.
+//
 // There are two types of lines in the function body.
 //
 // * Sampled line represents the profile information of a source location.
@@ -204,10 +215,37 @@
 //          in the text format documentation above).
 //        FUNCTION BODY
 //          A FUNCTION BODY entry describing the inlined function.
+//
+//
+// Indexed binary format
+// ---------------------
+//
+// This is the binary format with an index of the top-level functions, so that
+// a compiler can decode the profiles of the functions it is compiling and skip
+// the rest of the file. It has the same MAGIC (computed by SPIndexedMagic()
+// instead), VERSION, SUMMARY and NAME TABLE sections as the binary format,
+// followed by:
+//
+// FUNCTION OFFSET TABLE
+//    NUM_FUNCTIONS (uint32_t)
+//        Number of top-level functions in the profile.
+//    FUNCTION OFFSETS
+//      A list of NUM_FUNCTIONS entries. Each entry contains:
+//        NAME_IDX (uint32_t)
+//          Index into the name table indicating the function name.
+//        SAMPLES (uint64_t)
+//          Total number of samples collected in this function.
+//        OFFSET (uint64_t)
+//          Offset of the function from the start of the function bodies.
+//
+// FUNCTION BODIES
+//    The HEAD_SAMPLES and FUNCTION BODY of every top-level function, encoded
+//    as in the binary format.
 //===----------------------------------------------------------------------===//
 #ifndef LLVM_PROFILEDATA_SAMPLEPROFREADER_H
 #define LLVM_PROFILEDATA_SAMPLEPROFREADER_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
@@ -253,7 +291,9 @@ namespace sampleprof {
 ///
 /// The reader supports two file formats: text and binary. The text format
 /// is useful for debugging and testing, while the binary format is more
-/// compact and I/O efficient. They can both be used interchangeably.
+/// compact and I/O efficient. They can both be used interchangeably. The
+/// binary format also has an indexed variant, whose functions can be read
+/// one at a time.
 class SampleProfileReader {
 public:
   SampleProfileReader(std::unique_ptr<MemoryBuffer> B, LLVMContext &C)
@@ -267,6 +307,11 @@ public:
   /// \brief Read sample profiles from the associated file.
   virtual std::error_code read() = 0;
 
+  /// \brief Prepare to read only the profiles asked for with getSamplesFor.
+  ///
+  /// Formats without an index of their functions read the whole file here.
+  virtual std::error_code readOnDemand() { return read(); }
+
   /// \brief Print the profile for \p FName on stream \p OS.
   void dumpFunctionProfile(StringRef FName, raw_ostream &OS = dbgs());
 
@@ -275,7 +320,21 @@ public:
 
   /// \brief Return the samples collected for function \p F.
   FunctionSamples *getSamplesFor(const Function &F) {
-    return &Profiles[F.getName()];
+    return getSamplesFor(F.getName());
+  }
+
+  /// \brief Return the samples collected for the function or calling context
+  /// named \p FName.
+  virtual FunctionSamples *getSamplesFor(StringRef FName) {
+    return &Profiles[FName];
+  }
+
+  /// \brief Return the total number of samples collected in the profile.
+  virtual uint64_t getTotalSamples() {
+    uint64_t Total = 0;
+    for (const auto &I : Profiles)
+      Total += I.second.getTotalSamples();
+    return Total;
   }
 
   /// \brief Return all the profiles.
@@ -371,9 +430,15 @@ protected:
   /// \brief Return true if we've reached the end of file.
   bool at_eof() const { return Data >= End; }
 
+  /// \brief Return the magic number expected at the start of the file.
+  virtual uint64_t getMagic() const { return SPMagic(); }
+
   /// Read the contents of the given profile instance.
   std::error_code readProfile(FunctionSamples &FProfile);
 
+  /// Read the next top-level function profile into Profiles.
+  std::error_code readFuncProfile();
+
   /// \brief Points to the current location in the buffer.
   const uint8_t *Data;
 
@@ -390,6 +455,53 @@ private:
   std::error_code readSummary();
 };
 
+class SampleProfileReaderIndexedBinary : public SampleProfileReaderBinary {
+public:
+  SampleProfileReaderIndexedBinary(std::unique_ptr<MemoryBuffer> B,
+                                   LLVMContext &C)
+      : SampleProfileReaderBinary(std::move(B), C), Bodies(nullptr),
+        TotalSamples(0) {}
+
+  /// \brief Read and validate the file header and the function offset table.
+  std::error_code readHeader() override;
+
+  /// \brief Read the profiles of every function in the file.
+  std::error_code read() override;
+
+  /// \brief Decode the calling contexts, and leave the other profiles to be
+  /// decoded by getSamplesFor.
+  std::error_code readOnDemand() override;
+
+  using SampleProfileReader::getSamplesFor;
+
+  /// \brief Return the samples collected for \p FName, decoding them from the
+  /// file the first time they are asked for.
+  FunctionSamples *getSamplesFor(StringRef FName) override;
+
+  /// \brief Return the total number of samples, from the function offset
+  /// table.
+  uint64_t getTotalSamples() override { return TotalSamples; }
+
+  /// \brief Return true if \p Buffer is in the format supported by this class.
+  static bool hasFormat(const MemoryBuffer &Buffer);
+
+protected:
+  uint64_t getMagic() const override { return SPIndexedMagic(); }
+
+private:
+  /// \brief Decode the profile of the function at \p Offset into Profiles.
+  std::error_code readFuncProfileAt(uint64_t Offset);
+
+  /// \brief Points to the first function body in the buffer.
+  const uint8_t *Bodies;
+
+  /// \brief Offset of each function body from Bodies, by function name.
+  DenseMap<StringRef, uint64_t> FuncOffsets;
+
+  /// \brief Total number of samples of the functions in the profile.
+  uint64_t TotalSamples;
+};
+
 typedef SmallVector<FunctionSamples *, 10> InlineCallStack;
 
 // Supported histogram types in GCC.  Currently, we only need support for
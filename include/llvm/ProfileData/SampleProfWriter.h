@@ -25,7 +25,13 @@ namespace llvm {
 
 namespace sampleprof {
 
-enum SampleProfileFormat { SPF_None = 0, SPF_Text, SPF_Binary, SPF_GCC };
+enum SampleProfileFormat {
+  SPF_None = 0,
+  SPF_Text,
+  SPF_Binary,
+  SPF_GCC,
+  SPF_Indexed_Binary
+};
 
 /// \brief Sample-based profile writer. Base class.
 class SampleProfileWriter {
@@ -40,7 +46,7 @@ public:
   /// Write all the sample profiles in the given map of samples.
   ///
   /// \returns status code of the file update operation.
-  std::error_code write(const StringMap<FunctionSamples> &ProfileMap) {
+  virtual std::error_code write(const StringMap<FunctionSamples> &ProfileMap) {
     if (std::error_code EC = writeHeader(ProfileMap))
       return EC;
     for (const auto &I : ProfileMap) {
@@ -118,6 +124,10 @@ protected:
 
   std::error_code
   writeHeader(const StringMap<FunctionSamples> &ProfileMap) override;
+
+  /// \brief Return the magic number to start the file with.
+  virtual uint64_t getMagic() const { return SPMagic(); }
+
   std::error_code writeSummary();
   std::error_code writeNameIdx(StringRef FName);
   std::error_code writeBody(const FunctionSamples &S);
@@ -133,6 +143,25 @@ private:
                               SampleProfileFormat Format);
 };
 
+/// \brief Sample-based profile writer (indexed binary format).
+class SampleProfileWriterIndexedBinary : public SampleProfileWriterBinary {
+public:
+  using SampleProfileWriterBinary::write;
+
+  /// Write the profiles in \p ProfileMap, preceded by their offset table.
+  std::error_code write(const StringMap<FunctionSamples> &ProfileMap) override;
+
+protected:
+  SampleProfileWriterIndexedBinary(std::unique_ptr<raw_ostream> &OS)
+      : SampleProfileWriterBinary(OS) {}
+
+  uint64_t getMagic() const override { return SPIndexedMagic(); }
+
+  friend ErrorOr<std::unique_ptr<SampleProfileWriter>>
+  SampleProfileWriter::create(std::unique_ptr<raw_ostream> &OS,
+                              SampleProfileFormat Format);
+};
+
 } // End namespace sampleprof
 
 } // End namespace llvm
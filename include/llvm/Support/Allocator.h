@@ -32,6 +32,7 @@
 #include <cstdlib>
 
 namespace llvm {
+class raw_ostream;
 
 /// \brief CRTP base class providing obvious overloads for the core \c
 /// Allocate() methods of LLVM-style allocators.
@@ -153,41 +154,55 @@ public:
   BumpPtrAllocatorImpl(BumpPtrAllocatorImpl &&Old)
       : CurPtr(Old.CurPtr), End(Old.End), Slabs(std::move(Old.Slabs)),
         CustomSizedSlabs(std::move(Old.CustomSizedSlabs)),
+        RetainedSlabs(std::move(Old.RetainedSlabs)),
         BytesAllocated(Old.BytesAllocated),
         Allocator(std::move(Old.Allocator)) {
     Old.CurPtr = Old.End = nullptr;
     Old.BytesAllocated = 0;
     Old.Slabs.clear();
     Old.CustomSizedSlabs.clear();
+    Old.RetainedSlabs.clear();
   }
 
   ~BumpPtrAllocatorImpl() {
     DeallocateSlabs(Slabs.begin(), Slabs.end());
     DeallocateCustomSizedSlabs();
+    DeallocateRetainedSlabs(RetainedSlabs.size());
   }
 
   BumpPtrAllocatorImpl &operator=(BumpPtrAllocatorImpl &&RHS) {
     DeallocateSlabs(Slabs.begin(), Slabs.end());
     DeallocateCustomSizedSlabs();
+    DeallocateRetainedSlabs(RetainedSlabs.size());
 
     CurPtr = RHS.CurPtr;
     End = RHS.End;
     BytesAllocated = RHS.BytesAllocated;
     Slabs = std::move(RHS.Slabs);
     CustomSizedSlabs = std::move(RHS.CustomSizedSlabs);
+    RetainedSlabs = std::move(RHS.RetainedSlabs);
     Allocator = std::move(RHS.Allocator);
 
     RHS.CurPtr = RHS.End = nullptr;
     RHS.BytesAllocated = 0;
     RHS.Slabs.clear();
     RHS.CustomSizedSlabs.clear();
+    RHS.RetainedSlabs.clear();
     return *this;
   }
 
   /// \brief Deallocate all but the current slab and reset the current pointer
   /// to the beginning of it, freeing all memory allocated so far.
-  void Reset() {
-    // Deallocate all but the first slab, and deallocate all custom-sized slabs.
+  void Reset() { Reset(1); }
+
+  /// \brief Free all memory allocated so far, but keep up to \p MaxSlabs
+  /// slabs around to serve the next allocations instead of returning them to
+  /// the underlying allocator.
+  ///
+  /// This lets a long-lived allocator be reused, e.g. once per module, without
+  /// paying for fresh slabs every time while still bounding how much memory it
+  /// holds on to. Custom-sized slabs are always freed.
+  void Reset(size_t MaxSlabs) {
     DeallocateCustomSizedSlabs();
     CustomSizedSlabs.clear();
 
@@ -196,12 +211,29 @@ public:
 
     // Reset the state.
     BytesAllocated = 0;
+
+    // Move all but the first slab to the retained slabs, keeping them sorted
+    // by decreasing index so that the next slab to use is at the back, then
+    // free the ones past the limit.
+    RetainedSlabs.append(Slabs.rbegin(), std::prev(Slabs.rend()));
+    Slabs.erase(std::next(Slabs.begin()), Slabs.end());
+    if (MaxSlabs == 0) {
+      DeallocateRetainedSlabs(RetainedSlabs.size());
+      DeallocateSlabs(Slabs.begin(), Slabs.end());
+      Slabs.clear();
+      CurPtr = End = nullptr;
+      return;
+    }
+    if (RetainedSlabs.size() > MaxSlabs - 1)
+      DeallocateRetainedSlabs(RetainedSlabs.size() - (MaxSlabs - 1));
+
     CurPtr = (char *)Slabs.front();
     End = CurPtr + SlabSize;
 
     __asan_poison_memory_region(*Slabs.begin(), computeSlabSize(0));
-    DeallocateSlabs(std::next(Slabs.begin()), Slabs.end());
-    Slabs.erase(std::next(Slabs.begin()), Slabs.end());
+    for (size_t I = 0, E = RetainedSlabs.size(); I != E; ++I)
+      __asan_poison_memory_region(RetainedSlabs[I],
+                                  computeSlabSize(getRetainedSlabIndex(I)));
   }
 
   /// \brief Allocate space at the specified alignment.
@@ -269,12 +301,19 @@ public:
 
   size_t GetNumSlabs() const { return Slabs.size() + CustomSizedSlabs.size(); }
 
+  /// \brief Number of slabs kept by Reset(size_t) for reuse.
+  size_t getNumRetainedSlabs() const { return RetainedSlabs.size(); }
+
+  /// \brief Memory obtained from the underlying allocator, including the
+  /// slabs retained for reuse.
   size_t getTotalMemory() const {
     size_t TotalMemory = 0;
     for (auto I = Slabs.begin(), E = Slabs.end(); I != E; ++I)
       TotalMemory += computeSlabSize(std::distance(Slabs.begin(), I));
     for (auto &PtrAndSize : CustomSizedSlabs)
       TotalMemory += PtrAndSize.second;
+    for (size_t I = 0, E = RetainedSlabs.size(); I != E; ++I)
+      TotalMemory += computeSlabSize(getRetainedSlabIndex(I));
     return TotalMemory;
   }
 
@@ -300,6 +339,10 @@ private:
   /// \brief Custom-sized slabs allocated for too-large allocation requests.
   SmallVector<std::pair<void *, size_t>, 0> CustomSizedSlabs;
 
+  /// \brief Unused slabs kept by Reset(size_t), in decreasing order of the
+  /// index they had in Slabs. The back one is the next to be used.
+  SmallVector<void *, 0> RetainedSlabs;
+
   /// \brief How many bytes we've allocated.
   ///
   /// Used so that we can compute how much space was wasted.
@@ -321,7 +364,11 @@ private:
   void StartNewSlab() {
     size_t AllocatedSlabSize = computeSlabSize(Slabs.size());
 
-    void *NewSlab = Allocator.Allocate(AllocatedSlabSize, 0);
+    // Reuse a retained slab if there is one; it has the right size since it
+    // had the same index before the allocator was reset.
+    void *NewSlab = RetainedSlabs.empty()
+                        ? Allocator.Allocate(AllocatedSlabSize, 0)
+                        : RetainedSlabs.pop_back_val();
     // We own the new slab and don't want anyone reading anything other than
     // pieces returned from this method.  So poison the whole slab.
     __asan_poison_memory_region(NewSlab, AllocatedSlabSize);
@@ -350,6 +397,19 @@ private:
     }
   }
 
+  /// \brief The index in Slabs that the retained slab \p I will get.
+  size_t getRetainedSlabIndex(size_t I) const {
+    return Slabs.size() + RetainedSlabs.size() - 1 - I;
+  }
+
+  /// \brief Deallocate the \p N largest retained slabs.
+  void DeallocateRetainedSlabs(size_t N) {
+    for (size_t I = 0; I != N; ++I)
+      Allocator.Deallocate(RetainedSlabs[I],
+                           computeSlabSize(getRetainedSlabIndex(I)));
+    RetainedSlabs.erase(RetainedSlabs.begin(), RetainedSlabs.begin() + N);
+  }
+
   template <typename T> friend class SpecificBumpPtrAllocator;
 };
 
@@ -357,6 +417,55 @@ private:
 /// paramaters.
 typedef BumpPtrAllocatorImpl<> BumpPtrAllocator;
 
+/// \brief Registers an allocator under a name, so that its memory usage shows
+/// up in the report printed by PrintMemoryUsage() and -print-memory-usage.
+///
+/// Declare the reporter right after the allocator it reports on: it is then
+/// destroyed first and can record the final usage of the allocator.
+/// Allocators of the same name are reported together. Reporters may be
+/// destroyed after llvm_shutdown; the registry itself is never destroyed.
+class MemoryUsageReporter {
+  typedef size_t (*QueryFn)(const void *);
+
+  const char *Name;
+  const void *Allocator;
+  QueryFn GetTotalMemory;
+  QueryFn GetBytesAllocated;
+
+  template <typename AllocatorT> static size_t getTotal(const void *A) {
+    return static_cast<const AllocatorT *>(A)->getTotalMemory();
+  }
+  template <typename AllocatorT> static size_t getAllocated(const void *A) {
+    return static_cast<const AllocatorT *>(A)->getBytesAllocated();
+  }
+
+  void registerReporter();
+  void unregisterReporter();
+
+  MemoryUsageReporter(const MemoryUsageReporter &) = delete;
+  void operator=(const MemoryUsageReporter &) = delete;
+
+public:
+  template <typename AllocatorT>
+  MemoryUsageReporter(const char *Name, const AllocatorT &A)
+      : Name(Name), Allocator(&A), GetTotalMemory(&getTotal<AllocatorT>),
+        GetBytesAllocated(&getAllocated<AllocatorT>) {
+    registerReporter();
+  }
+  ~MemoryUsageReporter() { unregisterReporter(); }
+
+  const char *getName() const { return Name; }
+  size_t getTotalMemory() const { return GetTotalMemory(Allocator); }
+  size_t getBytesAllocated() const { return GetBytesAllocated(Allocator); }
+};
+
+/// \brief Print the memory usage of the registered allocators to the stream
+/// specified by -info-output-file.
+void PrintMemoryUsage();
+
+/// \brief Print the memory usage of the registered allocators to \p OS.
+void PrintMemoryUsage(raw_ostream &OS);
+
 /// \brief A BumpPtrAllocator that allows only elements of a specific type to be
 /// allocated.
 ///
@@ -52,8 +52,20 @@ public:
     return *this;
   }
 
+  /// Define the maximum size for the cache directory, in bytes. When both this
+  /// and the percentage are set, the smaller limit applies. A value of 0
+  /// disable this limit.
+  CachePruning &setMaxSizeBytes(uint64_t Bytes) {
+    MaxSizeBytes = Bytes;
+    return *this;
+  }
+
   /// Peform pruning using the supplied options, returns true if pruning
   /// occured, i.e. if PruningInterval was expired.
+  ///
+  /// Files that have expired are removed first. If the cache is still over
+  /// one of the size limits, the least recently accessed files are then
+  /// removed until it fits.
   bool prune();
 
 private:
@@ -62,6 +74,7 @@ private:
   unsigned Expiration = 0;
   unsigned Interval = 0;
   unsigned PercentageOfAvailableSpace = 0;
+  uint64_t MaxSizeBytes = 0;
 };
 
 } // namespace llvm
@@ -314,6 +314,31 @@ public:
   ///     The extracted signed integer value.
   int64_t getSLEB128(uint32_t *offset_ptr) const;
 
+  /// Extract \a count signed LEB128 values from \a *offset_ptr.
+  ///
+  /// Extract \a count consecutive signed LEB128 numbers from the binary
+  /// data at the offset pointed to by \a offset_ptr, and advance the offset
+  /// on success. The extracted values are copied into \a dst. This is faster
+  /// than extracting the values one at a time.
+  ///
+  /// @param[in,out] offset_ptr
+  ///     A pointer to an offset within the data that will be advanced
+  ///     by the appropriate number of bytes if the values are extracted
+  ///     correctly. If the offset is out of bounds or the data ends in
+  ///     the middle of a value, the offset will be left unmodified.
+  ///
+  /// @param[out] dst
+  ///     A buffer to copy \a count int64_t values into. \a dst must
+  ///     be large enough to hold all requested data.
+  ///
+  /// @param[in] count
+  ///     The number of signed LEB128 values to extract.
+  ///
+  /// @return
+  ///     \a dst if all values were properly extracted and copied,
+  ///     NULL otherwise.
+  int64_t *getSLEB128(uint32_t *offset_ptr, int64_t *dst, uint32_t count) const;
+
   /// Extract a unsigned LEB128 value from \a *offset_ptr.
   ///
   /// Extracts an unsigned LEB128 number from this object's data
@@ -332,6 +357,32 @@ public:
   ///     The extracted unsigned integer value.
   uint64_t getULEB128(uint32_t *offset_ptr) const;
 
+  /// Extract \a count unsigned LEB128 values from \a *offset_ptr.
+  ///
+  /// Extract \a count consecutive unsigned LEB128 numbers from the binary
+  /// data at the offset pointed to by \a offset_ptr, and advance the offset
+  /// on success. The extracted values are copied into \a dst. This is faster
+  /// than extracting the values one at a time.
+  ///
+  /// @param[in,out] offset_ptr
+  ///     A pointer to an offset within the data that will be advanced
+  ///     by the appropriate number of bytes if the values are extracted
+  ///     correctly. If the offset is out of bounds or the data ends in
+  ///     the middle of a value, the offset will be left unmodified.
+  ///
+  /// @param[out] dst
+  ///     A buffer to copy \a count uint64_t values into. \a dst must
+  ///     be large enough to hold all requested data.
+  ///
+  /// @param[in] count
+  ///     The number of unsigned LEB128 values to extract.
+  ///
+  /// @return
+  ///     \a dst if all values were properly extracted and copied,
+  ///     NULL otherwise.
+  uint64_t *getULEB128(uint32_t *offset_ptr, uint64_t *dst,
+                       uint32_t count) const;
+
   /// Test the validity of \a offset.
   ///
   /// @return
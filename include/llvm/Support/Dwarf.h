@@ -311,6 +311,10 @@ enum Form : uint16_t {
   DW_FORM_flag_present = 0x19,
   DW_FORM_ref_sig8 = 0x20,
 
+  // New in DWARF 5:
+  DW_FORM_strx = 0x1a,
+  DW_FORM_addrx = 0x1b,
+
   // Extensions for Fission proposal
   DW_FORM_GNU_addr_index = 0x1f01,
   DW_FORM_GNU_str_index = 0x1f02,
@@ -19,8 +19,12 @@
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
+#include <atomic>
+#include <future>
 
 namespace llvm {
+class ThreadPool;
+
 /// FileOutputBuffer - This interface provides simple way to create an in-memory
 /// buffer which will be written to a file. During the lifetime of these
 /// objects, the content or existence of the specified file is undefined. That
@@ -61,6 +65,26 @@ public:
     return FinalPath;
   }
 
+  /// Reserve \p Size bytes of the buffer, at an offset aligned to
+  /// \p Alignment, which must be a power of two. Reserved regions never
+  /// overlap, and reserve() may be called from several threads at once, so
+  /// each thread can serialize its part of the output directly into the
+  /// buffer. Regions are reserved in increasing address order, starting at
+  /// the start of the buffer. Returns null if the rest of the buffer is too
+  /// small.
+  uint8_t *reserve(size_t Size, size_t Alignment = 1);
+
+  /// Returns the number of bytes up to the end of the last reserved region.
+  size_t getReservedSize() const {
+    return NextOffset.load(std::memory_order_relaxed);
+  }
+
+  /// Start writing the pages holding [\p Start, \p Start + \p Size) back to
+  /// the file without waiting for them to be written. Calling this on each
+  /// region once it is complete keeps the dirty pages of a large output from
+  /// piling up until commit().
+  std::error_code flushRange(const uint8_t *Start, size_t Size);
+
   /// Flushes the content of the buffer to its file and deallocates the
   /// buffer.  If commit() is not called before this object's destructor
   /// is called, the file is deleted in the destructor. The optional parameter
@@ -68,6 +92,11 @@ public:
   /// initially requested.
   std::error_code commit();
 
+  /// Like commit(), but run on \p Pool, so that unmapping the buffer and
+  /// renaming the file overlap with the caller's work. The buffer must not be
+  /// accessed, nor destroyed, before the returned future is ready.
+  std::shared_future<std::error_code> commitAsync(ThreadPool &Pool);
+
   /// If this object was previously committed, the destructor just deletes
   /// this object.  If this object was not committed, the destructor
   /// deallocates the buffer and the target file is never written.
@@ -83,6 +112,9 @@ private:
   std::unique_ptr<llvm::sys::fs::mapped_file_region> Region;
   SmallString<128>    FinalPath;
   SmallString<128>    TempPath;
+
+  /// The offset past the last region handed out by reserve().
+  std::atomic<size_t> NextOffset;
 };
 } // end namespace llvm
 
@@ -18,7 +18,9 @@
 #ifndef LLVM_SUPPORT_GENERICDOMTREE_H
 #define LLVM_SUPPORT_GENERICDOMTREE_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/STLExtras.h"
@@ -608,6 +610,76 @@ public:
       this->Split<NodeT *, GraphTraits<NodeT *>>(*this, NewBB);
   }
 
+  /// The kind of a CFG change reported to applyUpdates.
+  enum UpdateKind { Insert, Delete };
+
+  /// \brief An edge that was inserted into or deleted from the CFG.
+  struct UpdateType {
+    UpdateKind Kind;
+    NodeT *From;
+    NodeT *To;
+
+    UpdateType(UpdateKind Kind, NodeT *From, NodeT *To)
+        : Kind(Kind), From(From), To(To) {}
+  };
+
+  /// insertEdge - Inform the dominator tree that the edge From -> To has been
+  /// added to the CFG, which must already contain it. Only the part of the
+  /// tree below the nearest common dominator of From and To is recomputed,
+  /// and nothing at all if the immediate dominator of To doesn't change.
+  void insertEdge(NodeT *From, NodeT *To) {
+    assert(From && To && "Cannot insert an edge to or from a null node!");
+    insertEdgeImpl(From, To, nullptr);
+  }
+
+  /// deleteEdge - Inform the dominator tree that the edge From -> To has been
+  /// removed from the CFG. Blocks that become unreachable lose their tree
+  /// nodes, but are not erased from the function.
+  void deleteEdge(NodeT *From, NodeT *To) {
+    assert(From && To && "Cannot delete an edge to or from a null node!");
+    deleteEdgeImpl(From, To, nullptr);
+  }
+
+  /// applyUpdates - Inform the dominator tree about a batch of CFG changes
+  /// made since it was last up to date, in the order they were made. Edges
+  /// that were inserted and deleted again cancel out, and a batch that
+  /// touches a large part of the CFG recalculates the tree instead.
+  void applyUpdates(ArrayRef<UpdateType> Updates) {
+    // Work out the net change of each edge: whether it existed before the
+    // first update of the batch, and whether it exists now.
+    SmallVector<UpdateType, 8> NetUpdates;
+    DenseSet<std::pair<NodeT *, NodeT *>> Seen;
+    for (const UpdateType &U : Updates) {
+      if (!Seen.insert(std::make_pair(U.From, U.To)).second)
+        continue;
+      if ((U.Kind == Insert) == hasCFGEdge(U.From, U.To, nullptr))
+        NetUpdates.push_back(U);
+    }
+    if (NetUpdates.empty())
+      return;
+    if (NetUpdates.size() == 1) {
+      applyUpdate(NetUpdates.front(), nullptr);
+      return;
+    }
+    if (this->IsPostDominators ||
+        NetUpdates.size() > DomTreeNodes.size() / 8 + 1) {
+      recalculate(*NetUpdates.front().From->getParent());
+      return;
+    }
+
+    // Apply the updates one at a time, hiding from each one the CFG changes
+    // that come after it.
+    BatchUpdateInfo BUI;
+    for (const UpdateType &U : NetUpdates)
+      BUI.addPending(U);
+    for (const UpdateType &U : NetUpdates) {
+      BUI.removePending(U);
+      // A recalculation takes all of the remaining updates into account.
+      if (applyUpdate(U, &BUI))
+        return;
+    }
+  }
+
   /// print - Convert to human readable form
   ///
   void print(raw_ostream &o) const {
@@ -661,6 +733,290 @@ protected:
 
   void addRoot(NodeT *BB) { this->Roots.push_back(BB); }
 
+private:
+  /// The CFG changes of a batch that are not yet reflected in the tree: the
+  /// edges the CFG has but the tree must not see yet, and the edges the tree
+  /// must still see although the CFG no longer has them.
+  struct BatchUpdateInfo {
+    DenseMap<NodeT *, SmallVector<NodeT *, 2>> HiddenSuccs, HiddenPreds;
+    DenseMap<NodeT *, SmallVector<NodeT *, 2>> ExtraSuccs, ExtraPreds;
+
+    void addPending(const UpdateType &U) {
+      auto &Succs = U.Kind == Insert ? HiddenSuccs : ExtraSuccs;
+      auto &Preds = U.Kind == Insert ? HiddenPreds : ExtraPreds;
+      Succs[U.From].push_back(U.To);
+      Preds[U.To].push_back(U.From);
+    }
+
+    void removePending(const UpdateType &U) {
+      auto &Succs = U.Kind == Insert ? HiddenSuccs : ExtraSuccs;
+      auto &Preds = U.Kind == Insert ? HiddenPreds : ExtraPreds;
+      auto Remove = [](SmallVectorImpl<NodeT *> &V, NodeT *N) {
+        V.erase(std::remove(V.begin(), V.end(), N), V.end());
+      };
+      Remove(Succs[U.From], U.To);
+      Remove(Preds[U.To], U.From);
+    }
+  };
+
+  /// Set Result to the successors of N, or to its predecessors if IsInverse
+  /// is set, as the tree should see them while applying a batch of updates.
+  static void getCFGChildren(NodeT *N, bool IsInverse,
+                             const BatchUpdateInfo *BUI,
+                             SmallVectorImpl<NodeT *> &Result) {
+    Result.clear();
+    if (IsInverse) {
+      typedef GraphTraits<Inverse<NodeT *>> InvTraits;
+      Result.append(InvTraits::child_begin(N), InvTraits::child_end(N));
+    } else {
+      typedef GraphTraits<NodeT *> Traits;
+      Result.append(Traits::child_begin(N), Traits::child_end(N));
+    }
+    if (!BUI)
+      return;
+
+    const auto &HiddenMap = IsInverse ? BUI->HiddenPreds : BUI->HiddenSuccs;
+    auto Hidden = HiddenMap.find(N);
+    if (Hidden != HiddenMap.end())
+      for (NodeT *H : Hidden->second)
+        Result.erase(std::remove(Result.begin(), Result.end(), H),
+                     Result.end());
+    const auto &ExtraMap = IsInverse ? BUI->ExtraPreds : BUI->ExtraSuccs;
+    auto Extra = ExtraMap.find(N);
+    if (Extra != ExtraMap.end())
+      Result.append(Extra->second.begin(), Extra->second.end());
+  }
+
+  /// Return true if the tree should see the edge From -> To.
+  static bool hasCFGEdge(NodeT *From, NodeT *To, const BatchUpdateInfo *BUI) {
+    SmallVector<NodeT *, 8> Succs;
+    getCFGChildren(From, /*IsInverse=*/false, BUI, Succs);
+    return std::find(Succs.begin(), Succs.end(), To) != Succs.end();
+  }
+
+  /// Apply a single update. Return true if the tree was recalculated from
+  /// scratch, which also reflects the updates still pending in BUI.
+  bool applyUpdate(const UpdateType &U, const BatchUpdateInfo *BUI) {
+    if (U.Kind == Insert)
+      return insertEdgeImpl(U.From, U.To, BUI);
+    return deleteEdgeImpl(U.From, U.To, BUI);
+  }
+
+  bool insertEdgeImpl(NodeT *From, NodeT *To, const BatchUpdateInfo *BUI) {
+    // A new edge can change the roots of a post-dominator tree.
+    if (this->IsPostDominators) {
+      recalculate(*From->getParent());
+      return true;
+    }
+
+    // Edges out of unreachable blocks don't change anything.
+    if (!getNode(From))
+      return false;
+
+    NodeT *Top;
+    if (DomTreeNodeBase<NodeT> *ToNode = getNode(To)) {
+      // Only the blocks reachable from To through blocks below the nearest
+      // common dominator of From and To can have their idoms raised, to that
+      // common dominator. If it is To or already its idom, none of them do.
+      Top = findNearestCommonDominator(From, To);
+      if (Top == To || getNode(Top) == ToNode->getIDom())
+        return false;
+    } else {
+      // To and the blocks that can only be reached through it become
+      // reachable, below From. Any block they lead back to now gets a path
+      // through From, which its nearest common dominator with From dominates.
+      Top = From;
+      SmallVector<NodeT *, 8> Worklist, Succs;
+      SmallPtrSet<NodeT *, 8> Visited;
+      Worklist.push_back(To);
+      Visited.insert(To);
+      while (!Worklist.empty()) {
+        NodeT *N = Worklist.pop_back_val();
+        getCFGChildren(N, /*IsInverse=*/false, BUI, Succs);
+        for (NodeT *Succ : Succs) {
+          if (getNode(Succ))
+            Top = findNearestCommonDominator(Top, Succ);
+          else if (Visited.insert(Succ).second)
+            Worklist.push_back(Succ);
+        }
+      }
+    }
+    return rebuildSubtree(getNode(Top), BUI);
+  }
+
+  bool deleteEdgeImpl(NodeT *From, NodeT *To, const BatchUpdateInfo *BUI) {
+    // Removing an edge can change the roots of a post-dominator tree.
+    if (this->IsPostDominators) {
+      recalculate(*From->getParent());
+      return true;
+    }
+
+    DomTreeNodeBase<NodeT> *FromNode = getNode(From);
+    DomTreeNodeBase<NodeT> *ToNode = getNode(To);
+    if (!FromNode || !ToNode)
+      return false;
+
+    // The CFG may still have another edge From -> To, from a switch say.
+    if (hasCFGEdge(From, To, BUI))
+      return false;
+
+    // Removing an edge to a dominator of From, like a loop back edge, doesn't
+    // change any dominators. Otherwise, the blocks whose idoms can sink all
+    // lie below the nearest common dominator of From and To.
+    NodeT *Top = findNearestCommonDominator(From, To);
+    if (Top == To)
+      return false;
+
+    // Unless To becomes unreachable together with the blocks it dominates.
+    // The blocks those lead to then lose paths, and their idoms can sink from
+    // as high as their nearest common dominator with To.
+    if (ToNode->getIDom() == FromNode && !hasProperSupport(To, BUI)) {
+      SmallVector<NodeT *, 8> Subtree, Succs;
+      getDescendants(To, Subtree);
+      SmallPtrSet<NodeT *, 8> InSubtree(Subtree.begin(), Subtree.end());
+      for (NodeT *N : Subtree) {
+        getCFGChildren(N, /*IsInverse=*/false, BUI, Succs);
+        for (NodeT *Succ : Succs)
+          if (!InSubtree.count(Succ) && getNode(Succ)) {
+            NodeT *NCD = findNearestCommonDominator(Succ, To);
+            if (NCD != Succ)
+              Top = findNearestCommonDominator(Top, NCD);
+          }
+      }
+    }
+    return rebuildSubtree(getNode(Top), BUI);
+  }
+
+  /// Return true if To has a reachable predecessor that it doesn't dominate,
+  /// so it stays reachable.
+  bool hasProperSupport(NodeT *To, const BatchUpdateInfo *BUI) {
+    SmallVector<NodeT *, 8> Preds;
+    getCFGChildren(To, /*IsInverse=*/true, BUI, Preds);
+    for (NodeT *Pred : Preds)
+      if (getNode(Pred) && findNearestCommonDominator(To, Pred) != To)
+        return true;
+    return false;
+  }
+
+  /// Recompute the idoms of the blocks that Top dominates, after a CFG change
+  /// that leaves the idom of Top alone and can only add blocks below Top that
+  /// were unreachable, or make unreachable some of the blocks it dominates.
+  /// The subtree is small next to the whole tree in the common case, so the
+  /// simple iterative algorithm by Cooper, Harvey and Kennedy is used on it.
+  /// Return true if the whole tree was recalculated instead.
+  bool rebuildSubtree(DomTreeNodeBase<NodeT> *Top,
+                      const BatchUpdateInfo *BUI) {
+    assert(Top && "Rebuilding the subtree of an unreachable block?");
+    // The subtree of the root is the whole tree, which recalculate builds
+    // faster.
+    if (!Top->getIDom()) {
+      recalculate(*Top->getBlock()->getParent());
+      return true;
+    }
+    DFSInfoValid = false;
+
+    // The blocks the tree currently shows under Top.
+    SmallVector<NodeT *, 32> OldSubtree;
+    getDescendants(Top->getBlock(), OldSubtree);
+    SmallPtrSet<NodeT *, 32> InOldSubtree(OldSubtree.begin(),
+                                          OldSubtree.end());
+
+    // Number the blocks that are reachable from Top without leaving the
+    // blocks it dominated or the blocks that were unreachable, in postorder.
+    SmallVector<NodeT *, 32> PostOrder;
+    DenseMap<NodeT *, unsigned> PostNum;
+    struct StackEntry {
+      NodeT *N;
+      SmallVector<NodeT *, 4> Succs;
+      unsigned NextSucc;
+    };
+    SmallVector<StackEntry, 32> Stack;
+    SmallPtrSet<NodeT *, 32> Visited;
+    auto Push = [&](NodeT *N) {
+      Visited.insert(N);
+      Stack.push_back(StackEntry{N, {}, 0});
+      getCFGChildren(N, /*IsInverse=*/false, BUI, Stack.back().Succs);
+    };
+    Push(Top->getBlock());
+    while (!Stack.empty()) {
+      StackEntry &E = Stack.back();
+      if (E.NextSucc == E.Succs.size()) {
+        PostNum[E.N] = PostOrder.size();
+        PostOrder.push_back(E.N);
+        Stack.pop_back();
+        continue;
+      }
+      NodeT *Succ = E.Succs[E.NextSucc++];
+      if ((InOldSubtree.count(Succ) || !getNode(Succ)) &&
+          !Visited.count(Succ))
+        Push(Succ);
+    }
+
+    // Every predecessor of a block that Top dominates is dominated by Top as
+    // well, or unreachable, so the numbered blocks hold all of them.
+    unsigned TopNum = PostOrder.size() - 1;
+    std::vector<SmallVector<unsigned, 4>> Preds(TopNum);
+    SmallVector<NodeT *, 8> Children;
+    for (unsigned I = 0; I != TopNum; ++I) {
+      getCFGChildren(PostOrder[I], /*IsInverse=*/true, BUI, Children);
+      for (NodeT *Pred : Children) {
+        auto It = PostNum.find(Pred);
+        if (It != PostNum.end())
+          Preds[I].push_back(It->second);
+      }
+    }
+
+    // Iterate the idoms to a fixed point, visiting the blocks in reverse
+    // postorder so that each one has a predecessor that was visited before.
+    const unsigned Undefined = ~0U;
+    std::vector<unsigned> IDomNum(PostOrder.size(), Undefined);
+    IDomNum[TopNum] = TopNum;
+    auto Intersect = [&](unsigned A, unsigned B) {
+      while (A != B) {
+        while (A < B)
+          A = IDomNum[A];
+        while (B < A)
+          B = IDomNum[B];
+      }
+      return A;
+    };
+    bool Changed = true;
+    while (Changed) {
+      Changed = false;
+      for (unsigned I = TopNum; I-- != 0;) {
+        unsigned NewIDom = Undefined;
+        for (unsigned Pred : Preds[I])
+          if (IDomNum[Pred] != Undefined)
+            NewIDom = NewIDom == Undefined ? Pred : Intersect(Pred, NewIDom);
+        assert(NewIDom != Undefined && "Block has no visited predecessor?");
+        if (IDomNum[I] != NewIDom) {
+          IDomNum[I] = NewIDom;
+          Changed = true;
+        }
+      }
+    }
+
+    // Relink the subtree, dropping the nodes of the blocks that became
+    // unreachable and creating nodes for the blocks that became reachable.
+    for (NodeT *N : OldSubtree) {
+      getNode(N)->Children.clear();
+      if (!PostNum.count(N))
+        DomTreeNodes.erase(N);
+    }
+    for (unsigned I = TopNum; I-- != 0;) {
+      NodeT *N = PostOrder[I];
+      DomTreeNodeBase<NodeT> *IDomNode = getNode(PostOrder[IDomNum[I]]);
+      if (DomTreeNodeBase<NodeT> *Node = getNode(N)) {
+        Node->IDom = IDomNode;
+        IDomNode->Children.push_back(Node);
+      } else {
+        DomTreeNodes[N] = IDomNode->addChild(
+            llvm::make_unique<DomTreeNodeBase<NodeT>>(N, IDomNode));
+      }
+    }
+    return false;
+  }
+
 public:
   /// updateDFSNumbers - Assign In and Out numbers to the nodes while walking
   /// dominator tree in dfs order.
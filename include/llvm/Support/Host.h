@@ -52,7 +52,8 @@ namespace sys {
 
   /// getHostCPUName - Get the LLVM name for the host CPU. The particular format
   /// of the name is target dependent, and suitable for passing as -mcpu to the
-  /// target which matches the host.
+  /// target which matches the host. The host is only examined the first time
+  /// this is called.
   ///
   /// \return - The host CPU name, or empty if the CPU could not be determined.
   StringRef getHostCPUName();
@@ -64,7 +65,8 @@ namespace sys {
   /// \param Features - A string mapping feature names to either
   /// true (if enabled) or false (if disabled). This routine makes no guarantees
   /// about exactly which features may appear in this map, except that they are
-  /// all valid LLVM feature names.
+  /// all valid LLVM feature names. The host is only examined the first time
+  /// this is called.
   ///
   /// \return - True on success.
   bool getHostCPUFeatures(StringMap<bool> &Features);
@@ -98,17 +98,29 @@ inline int64_t decodeSLEB128(const uint8_t *p, unsigned *n = nullptr) {
   uint8_t Byte;
   do {
     Byte = *p++;
-    Value |= ((Byte & 0x7f) << Shift);
+    Value |= (uint64_t(Byte & 0x7f) << Shift);
     Shift += 7;
   } while (Byte >= 128);
   // Sign extend negative numbers.
-  if (Byte & 0x40)
+  if (Byte & 0x40 && Shift < 64)
     Value |= (-1ULL) << Shift;
   if (n)
     *n = (unsigned)(p - orig_p);
   return Value;
 }
 
+/// Decode \p Count consecutive ULEB128 values from [\p p, \p end) into
+/// \p Values. Values of up to 8 bytes are decoded a word at a time rather
+/// than a byte at a time, which makes this much faster than calling
+/// decodeULEB128 in a loop. Returns a pointer past the last decoded value, or
+/// null if the buffer ends in the middle of a value.
+const uint8_t *decodeULEB128Array(const uint8_t *p, const uint8_t *end,
+                                  uint64_t *Values, size_t Count);
+
+/// Decode \p Count consecutive SLEB128 values from [\p p, \p end) into
+/// \p Values, in the same way as decodeULEB128Array.
+const uint8_t *decodeSLEB128Array(const uint8_t *p, const uint8_t *end,
+                                  int64_t *Values, size_t Count);
 
 /// Utility function to get the size of the ULEB128-encoded value.
 extern unsigned getULEB128Size(uint64_t Value);
@@ -0,0 +1,213 @@
+//===- llvm/Support/Parallel.h - Parallel algorithms ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines parallel versions of a few common algorithms, built on a
+// process-wide ThreadPool. The results never depend on how the work gets
+// scheduled: parallel_sort produces the same order on every run, and
+// parallel_transform_reduce combines partial results in input order.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PARALLEL_H
+#define LLVM_SUPPORT_PARALLEL_H
+
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ThreadPool.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace llvm {
+
+namespace parallel {
+/// The pool used by the parallel algorithms below. It is created on first
+/// use with one thread per hardware thread.
+ThreadPool &getDefaultPool();
+
+/// Number of threads of the default pool, or 1 if threads are disabled.
+unsigned getThreadCount();
+
+namespace detail {
+/// Inputs smaller than this are processed sequentially.
+const ptrdiff_t MinParallelSize = 1024;
+
+/// Split the work into about this many tasks per thread, to balance uneven
+/// items without paying for one task per item.
+const unsigned TasksPerThread = 4;
+
+/// Number of items each task should process for an input of \p N items.
+inline ptrdiff_t getTaskSize(ptrdiff_t N) {
+  ptrdiff_t NumTasks = ptrdiff_t(getThreadCount()) * TasksPerThread;
+  return std::max<ptrdiff_t>(1, (N + NumTasks - 1) / NumTasks);
+}
+
+template <class RandomAccessIterator, class Comparator>
+RandomAccessIterator medianOf3(RandomAccessIterator Start,
+                               RandomAccessIterator End,
+                               const Comparator &Comp) {
+  auto Mid = Start + (std::distance(Start, End) / 2);
+  return Comp(*Start, *(End - 1))
+             ? (Comp(*Mid, *(End - 1)) ? (Comp(*Start, *Mid) ? Mid : Start)
+                                       : End - 1)
+             : (Comp(*Mid, *Start) ? (Comp(*(End - 1), *Mid) ? Mid : End - 1)
+                                   : Start);
+}
+
+template <class RandomAccessIterator, class Comparator>
+void parallelQuickSort(RandomAccessIterator Start, RandomAccessIterator End,
+                       const Comparator &Comp, ThreadPoolTaskGroup &TG,
+                       unsigned Depth) {
+  // Do a sequential sort for small inputs, or once the recursion is deep
+  // enough to have produced plenty of tasks.
+  if (std::distance(Start, End) < MinParallelSize || Depth == 0) {
+    std::sort(Start, End, Comp);
+    return;
+  }
+
+  // Partition around the median of three, parked at the end meanwhile.
+  auto Pivot = medianOf3(Start, End, Comp);
+  std::swap(*(End - 1), *Pivot);
+  typedef typename std::iterator_traits<RandomAccessIterator>::value_type
+      ValueTy;
+  Pivot = std::partition(Start, End - 1, [&Comp, End](const ValueTy &V) {
+    return Comp(V, *(End - 1));
+  });
+  std::swap(*Pivot, *(End - 1));
+
+  // Sort both halves. The split only depends on the data, so the result is
+  // the same however the tasks end up being scheduled.
+  TG.async([=, &Comp, &TG] {
+    parallelQuickSort(Start, Pivot, Comp, TG, Depth - 1);
+  });
+  parallelQuickSort(Pivot + 1, End, Comp, TG, Depth - 1);
+}
+} // end namespace detail
+} // end namespace parallel
+
+/// Call \p Fn on every element of [\p Begin, \p End), in no particular order
+/// and possibly concurrently.
+template <class IterTy, class FuncTy>
+void parallel_for_each(IterTy Begin, IterTy End, FuncTy Fn) {
+  ptrdiff_t N = std::distance(Begin, End);
+  if (N < parallel::detail::MinParallelSize ||
+      parallel::getThreadCount() == 1) {
+    std::for_each(Begin, End, Fn);
+    return;
+  }
+
+  ptrdiff_t TaskSize = parallel::detail::getTaskSize(N);
+  ThreadPoolTaskGroup TG(parallel::getDefaultPool());
+  while (N > TaskSize) {
+    IterTy Next = std::next(Begin, TaskSize);
+    TG.async([=, &Fn] { std::for_each(Begin, Next, Fn); });
+    Begin = Next;
+    N -= TaskSize;
+  }
+  std::for_each(Begin, End, Fn);
+  TG.wait();
+}
+
+/// Call \p Fn on every index in [\p Begin, \p End), in no particular order
+/// and possibly concurrently.
+template <class IndexTy, class FuncTy>
+void parallel_for(IndexTy Begin, IndexTy End, FuncTy Fn) {
+  if (End <= Begin)
+    return;
+  ptrdiff_t N = ptrdiff_t(End - Begin);
+  if (N < parallel::detail::MinParallelSize ||
+      parallel::getThreadCount() == 1) {
+    for (IndexTy I = Begin; I != End; ++I)
+      Fn(I);
+    return;
+  }
+
+  ptrdiff_t TaskSize = parallel::detail::getTaskSize(N);
+  ThreadPoolTaskGroup TG(parallel::getDefaultPool());
+  while (N > TaskSize) {
+    IndexTy Next = Begin + IndexTy(TaskSize);
+    TG.async([=, &Fn] {
+      for (IndexTy I = Begin; I != Next; ++I)
+        Fn(I);
+    });
+    Begin = Next;
+    N -= TaskSize;
+  }
+  for (IndexTy I = Begin; I != End; ++I)
+    Fn(I);
+  TG.wait();
+}
+
+/// Sort [\p Start, \p End) with \p Comp. Like std::sort the sort is not
+/// stable, but the resulting order is deterministic.
+template <class RandomAccessIterator,
+          class Comparator = std::less<
+              typename std::iterator_traits<RandomAccessIterator>::value_type>>
+void parallel_sort(RandomAccessIterator Start, RandomAccessIterator End,
+                   const Comparator &Comp = Comparator()) {
+  if (std::distance(Start, End) < parallel::detail::MinParallelSize ||
+      parallel::getThreadCount() == 1) {
+    std::sort(Start, End, Comp);
+    return;
+  }
+
+  ThreadPoolTaskGroup TG(parallel::getDefaultPool());
+  parallel::detail::parallelQuickSort(Start, End, Comp, TG,
+                                      Log2_64(std::distance(Start, End)) + 1);
+  TG.wait();
+}
+
+/// Apply \p Transform to every element of [\p Begin, \p End) and fold the
+/// results into \p Init with \p Reduce. The input is split into chunks that
+/// are reduced concurrently, and the chunk results are then combined in input
+/// order, so the result is deterministic for an associative \p Reduce even if
+/// it is not commutative.
+template <class IterTy, class ResultTy, class ReduceFuncTy,
+          class TransformFuncTy>
+ResultTy parallel_transform_reduce(IterTy Begin, IterTy End, ResultTy Init,
+                                   ReduceFuncTy Reduce,
+                                   TransformFuncTy Transform) {
+  ptrdiff_t N = std::distance(Begin, End);
+  if (N < parallel::detail::MinParallelSize ||
+      parallel::getThreadCount() == 1) {
+    for (IterTy I = Begin; I != End; ++I)
+      Init = Reduce(std::move(Init), Transform(*I));
+    return Init;
+  }
+
+  ptrdiff_t TaskSize = parallel::detail::getTaskSize(N);
+  std::vector<ResultTy> Results((N + TaskSize - 1) / TaskSize, Init);
+  {
+    ThreadPoolTaskGroup TG(parallel::getDefaultPool());
+    for (ResultTy &Result : Results) {
+      IterTy Next = std::next(Begin, std::min(TaskSize, N));
+      N -= std::min(TaskSize, N);
+      TG.async([=, &Result, &Reduce, &Transform] {
+        // Each chunk starts from its first element rather than from Init, so
+        // that Init is only folded in once.
+        IterTy I = Begin;
+        ResultTy R = Transform(*I);
+        for (++I; I != Next; ++I)
+          R = Reduce(std::move(R), Transform(*I));
+        Result = std::move(R);
+      });
+      Begin = Next;
+    }
+    TG.wait();
+  }
+
+  for (ResultTy &Result : Results)
+    Init = Reduce(std::move(Init), std::move(Result));
+  return Init;
+}
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_PARALLEL_H
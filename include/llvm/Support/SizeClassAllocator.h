@@ -0,0 +1,135 @@
+//===- llvm/Support/SizeClassAllocator.h - Size-class recycling -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file defines the SizeClassAllocator class, an LLVM-style allocator
+/// that recycles deallocated blocks by size class on top of another allocator,
+/// typically a BumpPtrAllocator. It suits node-based containers, which keep
+/// allocating and freeing a few distinct node sizes.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_SIZECLASSALLOCATOR_H
+#define LLVM_SUPPORT_SIZECLASSALLOCATOR_H
+
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
+
+namespace llvm {
+
+/// \brief Recycle blocks of up to \p MaxSize bytes, rounded up to a multiple
+/// of \p Granularity, through one free list per size class.
+///
+/// Larger blocks are handed out and deallocated by the wrapped allocator
+/// directly. Recycled blocks are never given back to the wrapped allocator
+/// before it is destroyed or reset, so it should be one that frees all of its
+/// memory at once, like BumpPtrAllocator.
+template <typename AllocatorT = BumpPtrAllocator, size_t MaxSize = 256,
+          size_t Granularity = 16>
+class SizeClassAllocator
+    : public AllocatorBase<
+          SizeClassAllocator<AllocatorT, MaxSize, Granularity>> {
+  static_assert((Granularity & (Granularity - 1)) == 0,
+                "Granularity must be a power of two");
+  static_assert(Granularity >= sizeof(void *),
+                "Granularity must be large enough to hold a free list link");
+  static_assert(MaxSize % Granularity == 0,
+                "MaxSize must be a multiple of Granularity");
+
+  static const size_t NumSizeClasses = MaxSize / Granularity;
+
+  struct FreeNode {
+    FreeNode *Next;
+  };
+
+  /// The free lists, indexed by size class.
+  FreeNode *FreeLists[NumSizeClasses];
+
+  /// The wrapped allocator.
+  AllocatorT Allocator;
+
+  static size_t getSizeClass(size_t Size) {
+    return Size == 0 ? 0 : (Size - 1) / Granularity;
+  }
+
+public:
+  SizeClassAllocator() {
+    std::fill(FreeLists, FreeLists + NumSizeClasses, nullptr);
+  }
+  template <typename T>
+  SizeClassAllocator(T &&Allocator) : Allocator(std::forward<T &&>(Allocator)) {
+    std::fill(FreeLists, FreeLists + NumSizeClasses, nullptr);
+  }
+
+  /// \brief Allocate space at the specified alignment, reusing a block of the
+  /// same size class if one was deallocated.
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                size_t Alignment) {
+    if (Size > MaxSize)
+      return Allocator.Allocate(Size, Alignment);
+
+    size_t SizeClass = getSizeClass(Size);
+    FreeNode *N = FreeLists[SizeClass];
+    if (N && Alignment <= Granularity) {
+      FreeLists[SizeClass] = N->Next;
+      __msan_allocated_memory(N, Size);
+      return N;
+    }
+    // Allocate the whole size class, so that the block can be recycled.
+    return Allocator.Allocate((SizeClass + 1) * Granularity,
+                              std::max(Alignment, Granularity));
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<SizeClassAllocator>::Allocate;
+
+  /// \brief Put a block back on the free list of its size class. \p Size must
+  /// be the size it was allocated with.
+  void Deallocate(const void *Ptr, size_t Size) {
+    if (Size > MaxSize) {
+      Allocator.Deallocate(Ptr, Size);
+      return;
+    }
+
+    size_t SizeClass = getSizeClass(Size);
+    FreeNode *N = static_cast<FreeNode *>(const_cast<void *>(Ptr));
+    N->Next = FreeLists[SizeClass];
+    FreeLists[SizeClass] = N;
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<SizeClassAllocator>::Deallocate;
+
+  /// \brief Forget all the recycled blocks and reset the wrapped allocator.
+  void Reset() {
+    std::fill(FreeLists, FreeLists + NumSizeClasses, nullptr);
+    Allocator.Reset();
+  }
+
+  /// \brief Number of blocks of \p Size bytes ready to be reused.
+  size_t getNumFreeBlocks(size_t Size) const {
+    assert(Size <= MaxSize && "Size is not recycled");
+    size_t N = 0;
+    for (FreeNode *I = FreeLists[getSizeClass(Size)]; I; I = I->Next)
+      ++N;
+    return N;
+  }
+
+  AllocatorT &getAllocator() { return Allocator; }
+  const AllocatorT &getAllocator() const { return Allocator; }
+
+  size_t getTotalMemory() const { return Allocator.getTotalMemory(); }
+  size_t getBytesAllocated() const { return Allocator.getBytesAllocated(); }
+
+  void PrintStats() const { Allocator.PrintStats(); }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_SIZECLASSALLOCATOR_H
@@ -10,6 +10,7 @@
 #ifndef LLVM_SUPPORT_STRINGSAVER_H
 #define LLVM_SUPPORT_STRINGSAVER_H
 
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Allocator.h"
@@ -28,5 +29,34 @@ public:
   const char *save(const Twine &S) { return save(StringRef(S.str())); }
   const char *save(std::string &S) { return save(StringRef(S)); }
 };
+
+/// \brief Saves strings in stable storage like StringSaver, but keeps only one
+/// copy of each distinct string.
+///
+/// The hash of a saved string is computed once and handed back along with it,
+/// so that a caller keying its own DenseMap on CachedHash<StringRef> does not
+/// hash the string a second time. Callers that already have the hash can pass
+/// it in the same way. Saved strings are null terminated.
+///
+/// Like StringSaver, this class is not thread-safe.
+class UniqueStringSaver final {
+  StringSaver Strings;
+  DenseSet<CachedHash<StringRef>> Unique;
+
+public:
+  UniqueStringSaver(BumpPtrAllocator &Alloc) : Strings(Alloc) {}
+
+  StringRef save(const char *S) { return save(StringRef(S)); }
+  StringRef save(StringRef S) { return save(CachedHash<StringRef>(S)).Val; }
+  StringRef save(const Twine &S) { return save(StringRef(S.str())); }
+  StringRef save(std::string &S) { return save(StringRef(S)); }
+
+  /// Save \p S, whose hash has already been computed, and return the saved
+  /// copy along with the same hash.
+  CachedHash<StringRef> save(CachedHash<StringRef> S);
+
+  /// The number of distinct strings saved so far.
+  size_t size() const { return Unique.size(); }
+};
 }
 #endif
@@ -37,17 +37,27 @@
 #include <condition_variable>
 #include <functional>
 #include <memory>
+#include <deque>
+#include <map>
 #include <mutex>
-#include <queue>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
+class ThreadPoolTaskGroup;
+
 /// A ThreadPool for asynchronous parallel execution on a defined number of
 /// threads.
 ///
 /// The pool keeps a vector of threads alive, waiting on a condition variable
 /// for some work to become available.
+///
+/// Tasks can optionally be submitted as part of a ThreadPoolTaskGroup, which
+/// allows waiting for just that subset of tasks. Waiting on a group from
+/// inside a task running on the pool does not block the worker: it keeps
+/// executing queued tasks until the group is done. This makes it safe for
+/// nested users to share one pool, and therefore one concurrency limit.
 class ThreadPool {
 public:
 #ifndef _MSC_VER
@@ -78,60 +88,131 @@ public:
   inline std::shared_future<VoidTy> async(Function &&F, Args &&... ArgList) {
     auto Task =
         std::bind(std::forward<Function>(F), std::forward<Args>(ArgList)...);
-#ifndef _MSC_VER
-    return asyncImpl(std::move(Task));
-#else
-    // This lambda has to be marked mutable because MSVC 2013's std::bind call
-    // operator isn't const qualified.
-    return asyncImpl([Task](VoidTy) mutable -> VoidTy {
-      Task();
-      return VoidTy();
-    });
-#endif
+    return asyncInGroup(nullptr, std::move(Task));
   }
 
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
   template <typename Function>
   inline std::shared_future<VoidTy> async(Function &&F) {
-#ifndef _MSC_VER
-    return asyncImpl(std::forward<Function>(F));
-#else
-    return asyncImpl([F] (VoidTy) -> VoidTy { F(); return VoidTy(); });
-#endif
+    return asyncInGroup(nullptr, std::forward<Function>(F));
+  }
+
+  /// Asynchronous submission of a task to the pool as part of \p Group. The
+  /// returned future can be used to wait for the task to finish and is
+  /// *non-blocking* on destruction.
+  template <typename Function, typename... Args>
+  inline std::shared_future<VoidTy> async(ThreadPoolTaskGroup &Group,
+                                          Function &&F, Args &&... ArgList) {
+    auto Task =
+        std::bind(std::forward<Function>(F), std::forward<Args>(ArgList)...);
+    return asyncInGroup(&Group, std::move(Task));
+  }
+
+  /// Asynchronous submission of a task to the pool as part of \p Group. The
+  /// returned future can be used to wait for the task to finish and is
+  /// *non-blocking* on destruction.
+  template <typename Function>
+  inline std::shared_future<VoidTy> async(ThreadPoolTaskGroup &Group,
+                                          Function &&F) {
+    return asyncInGroup(&Group, std::forward<Function>(F));
   }
 
   /// Blocking wait for all the threads to complete and the queue to be empty.
-  /// It is an error to try to add new tasks while blocking on this call.
+  /// It is an error to try to add new tasks while blocking on this call, and
+  /// to call this from a task running on the pool.
   void wait();
 
+  /// Blocking wait for all the tasks of \p Group to complete. When called from
+  /// a task running on this pool, the calling worker executes queued tasks
+  /// while it waits instead of blocking. A task must not wait on its own
+  /// group.
+  void wait(ThreadPoolTaskGroup &Group);
+
+  /// Returns true if the current thread is one of the pool's workers.
+  bool isWorkerThread() const;
+
 private:
+  template <typename Function>
+  inline std::shared_future<VoidTy> asyncInGroup(ThreadPoolTaskGroup *Group,
+                                                 Function &&F) {
+#ifndef _MSC_VER
+    return asyncImpl(std::forward<Function>(F), Group);
+#else
+    // This lambda has to be marked mutable because MSVC 2013's std::bind call
+    // operator isn't const qualified.
+    return asyncImpl([F](VoidTy) mutable -> VoidTy {
+      F();
+      return VoidTy();
+    }, Group);
+#endif
+  }
+
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
-  std::shared_future<VoidTy> asyncImpl(TaskTy F);
+  std::shared_future<VoidTy> asyncImpl(TaskTy F, ThreadPoolTaskGroup *Group);
+
+  /// Returns true if all the tasks of \p Group (or of the whole pool when
+  /// \p Group is null) have completed. QueueLock must be held.
+  bool workCompletedUnlocked(ThreadPoolTaskGroup *Group) const;
+
+#if LLVM_ENABLE_THREADS
+  /// Run queued tasks on the current thread. Worker threads call this with a
+  /// null \p WaitingForGroup and only return on pool destruction; a worker
+  /// waiting on a group returns once that group has completed.
+  void processTasks(ThreadPoolTaskGroup *WaitingForGroup);
+#endif
 
   /// Threads in flight
   std::vector<llvm::thread> Threads;
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// Tasks waiting for execution in the pool, with the group they belong to.
+  std::deque<std::pair<PackagedTaskTy, ThreadPoolTaskGroup *>> Tasks;
 
   /// Locking and signaling for accessing the Tasks queue.
   std::mutex QueueLock;
   std::condition_variable QueueCondition;
 
-  /// Locking and signaling for job completion
-  std::mutex CompletionLock;
+  /// Signaling for job completion (uses QueueLock).
   std::condition_variable CompletionCondition;
 
   /// Keep track of the number of thread actually busy
-  std::atomic<unsigned> ActiveThreads;
+  unsigned ActiveThreads;
+
+  /// Number of running tasks for each group that has any.
+  std::map<ThreadPoolTaskGroup *, unsigned> ActiveGroups;
 
 #if LLVM_ENABLE_THREADS // avoids warning for unused variable
   /// Signal for the destruction of the pool, asking thread to exit.
   bool EnableFlag;
 #endif
 };
+
+/// A group of tasks to be run on a ThreadPool. Waiting on a group only waits
+/// for the tasks submitted through it, so independent users of a shared pool
+/// do not wait for each other. The destructor waits for the group.
+class ThreadPoolTaskGroup {
+public:
+  explicit ThreadPoolTaskGroup(ThreadPool &Pool) : Pool(Pool) {}
+
+  ~ThreadPoolTaskGroup() { wait(); }
+
+  /// Submit a task to the pool as part of this group.
+  template <typename Function, typename... Args>
+  inline std::shared_future<ThreadPool::VoidTy> async(Function &&F,
+                                                      Args &&... ArgList) {
+    return Pool.async(*this, std::forward<Function>(F),
+                      std::forward<Args>(ArgList)...);
+  }
+
+  /// Blocking wait for all the tasks of this group to complete.
+  void wait() { Pool.wait(*this); }
+
+  ThreadPool &getPool() { return Pool; }
+
+private:
+  ThreadPool &Pool;
+};
 }
 
 #endif // LLVM_SUPPORT_THREAD_POOL_H
@@ -0,0 +1,96 @@
+//===- llvm/Support/TimeProfiler.h - Hierarchical Time Profiler -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides a low-overhead, hierarchical time profiler. Scoped
+// events are recorded per thread and written out in the Chrome trace_event
+// JSON format, which can be loaded into chrome://tracing or speedscope.
+//
+// Unlike Timer/TimerGroup, an event only reads a steady clock when it begins
+// and ends, and nothing is recorded unless the profiler has been initialized,
+// so scopes can be left in production builds.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_TIMEPROFILER_H
+#define LLVM_SUPPORT_TIMEPROFILER_H
+
+#include "llvm/ADT/StringRef.h"
+#include <atomic>
+#include <string>
+#include <system_error>
+
+namespace llvm {
+
+class raw_ostream;
+
+namespace detail {
+class TimeTraceProfiler;
+extern std::atomic<TimeTraceProfiler *> TimeTraceProfilerInstance;
+}
+
+/// Initialize the time trace profiler. Events shorter than
+/// \p TimeTraceGranularity microseconds are dropped when they end.
+void timeTraceProfilerInitialize(unsigned TimeTraceGranularity = 500);
+
+/// Discard the recorded events and disable the profiler. Must not be called
+/// while other threads are still recording events.
+void timeTraceProfilerCleanup();
+
+/// Is the time trace profiler enabled, i.e. initialized?
+inline bool timeTraceProfilerEnabled() {
+  return detail::TimeTraceProfilerInstance.load(std::memory_order_relaxed) !=
+         nullptr;
+}
+
+/// Write the events recorded by all threads to \p OS as Chrome trace JSON.
+/// Per-name totals are appended as extra rows so that the time spent in each
+/// kind of event can be compared at a glance.
+void timeTraceProfilerWrite(raw_ostream &OS);
+
+/// Write the trace to \p PreferredFileName, or, if it is empty, to
+/// \p FallbackFileName with ".time-trace.json" appended ("out.time-trace.json"
+/// when the fallback is empty or "-", i.e. standard output).
+std::error_code timeTraceProfilerWrite(StringRef PreferredFileName,
+                                       StringRef FallbackFileName);
+
+/// Manually begin a time section, with the given \p Name and \p Detail.
+/// Profiler copies the strings, so they do not need to outlive the call.
+/// Time sections must be ended with timeTraceProfilerEnd() on the same thread,
+/// and properly nested.
+void timeTraceProfilerBegin(StringRef Name, StringRef Detail);
+
+/// Manually end the last time section begun on this thread.
+void timeTraceProfilerEnd();
+
+/// The TimeTraceScope is a helper class to call the begin and end functions
+/// of the time trace profiler. When the object is constructed, it begins the
+/// section; and when it is destroyed, it stops it. If the profiler is not
+/// initialized, the overhead is a single atomic load.
+struct TimeTraceScope {
+  TimeTraceScope(StringRef Name, StringRef Detail = StringRef()) {
+    if (timeTraceProfilerEnabled()) {
+      Active = true;
+      timeTraceProfilerBegin(Name, Detail);
+    }
+  }
+  ~TimeTraceScope() {
+    if (Active)
+      timeTraceProfilerEnd();
+  }
+
+private:
+  TimeTraceScope(const TimeTraceScope &) = delete;
+  void operator=(const TimeTraceScope &) = delete;
+
+  bool Active = false;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_TIMEPROFILER_H
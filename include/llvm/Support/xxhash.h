@@ -0,0 +1,46 @@
+//===- llvm/Support/xxhash.h - Fast non-cryptographic hashing ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares xxHash64, Yann Collet's fast non-cryptographic hash
+// function, and a 128-bit content hash built on it. They are several times
+// faster than MD5 or SHA1 and suit cache keys and deduplication, where the
+// input is not chosen by an attacker.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_XXHASH_H
+#define LLVM_SUPPORT_XXHASH_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+
+#include <utility>
+
+namespace llvm {
+
+/// Compute the 64-bit xxHash64 of \p Data with \p Seed. The result is the
+/// one of the reference implementation, so it is stable across hosts and
+/// releases.
+uint64_t xxHash64(ArrayRef<uint8_t> Data, uint64_t Seed = 0);
+inline uint64_t xxHash64(StringRef Data, uint64_t Seed = 0) {
+  return xxHash64(makeArrayRef(Data.bytes_begin(), Data.size()), Seed);
+}
+
+/// Compute a 128-bit hash of \p Data: the xxHash64 of \p Data with seed 0,
+/// followed by its xxHash64 with a second, fixed seed. Both halves are
+/// computed in a single pass over the data.
+std::pair<uint64_t, uint64_t> xxHash128(ArrayRef<uint8_t> Data);
+inline std::pair<uint64_t, uint64_t> xxHash128(StringRef Data) {
+  return xxHash128(makeArrayRef(Data.bytes_begin(), Data.size()));
+}
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_XXHASH_H
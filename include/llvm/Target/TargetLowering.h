@@ -1014,6 +1014,17 @@ public:
     return MinimumJumpTableEntries;
   }
 
+  /// Return the minimum percentage of the values in the range of a switch
+  /// that must be cases for the switch to be lowered through a table.
+  unsigned getMinimumJumpTableDensity(bool OptForSize) const;
+
+  /// Return true if \p NumCases cases spread over \p Range values are dense
+  /// enough for \p SI to be lowered through a table. SelectionDAG uses the
+  /// same density for jump tables, and TargetTransformInfo reports this to
+  /// the IR passes that turn switches into lookup tables.
+  virtual bool isSuitableForJumpTable(const SwitchInst *SI, uint64_t NumCases,
+                                      uint64_t Range) const;
+
   /// If a physical register, this specifies the register that
   /// llvm.savestack/llvm.restorestack should save and restore.
   unsigned getStackPointerRegisterToSaveRestore() const {
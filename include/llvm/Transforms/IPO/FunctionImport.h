@@ -10,6 +10,7 @@
 #ifndef LLVM_FUNCTIONIMPORT_H
 #define LLVM_FUNCTIONIMPORT_H
 
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/IR/GlobalValue.h"
 #include "llvm/IR/ModuleSummaryIndex.h"
@@ -75,11 +76,26 @@ private:
 /// \p ExportLists contains for each Module the set of globals (GUID) that will
 /// be imported by another module, or referenced by such a function. I.e. this
 /// is the set of globals that need to be promoted/renamed appropriately.
+///
+/// If \p DeadSymbols is provided, the dead globals it contains are not used as
+/// roots for the import and therefore don't cause any import or export.
+///
+/// The import lists of the different modules are computed concurrently, the
+/// export lists are derived from them afterward.
 void ComputeCrossModuleImport(
     const ModuleSummaryIndex &Index,
     const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
-    StringMap<FunctionImporter::ExportSetTy> &ExportLists);
+    StringMap<FunctionImporter::ExportSetTy> &ExportLists,
+    const DenseSet<GlobalValue::GUID> *DeadSymbols = nullptr);
+
+/// Compute the set of globals in \p Index that are not reachable through the
+/// reference and call edges from any of the \p GUIDPreservedSymbols (or from a
+/// global with appending linkage). An empty set is returned when there is no
+/// preserved symbol, as nothing is known about the liveness in this case.
+DenseSet<GlobalValue::GUID>
+computeDeadSymbols(const ModuleSummaryIndex &Index,
+                   const DenseSet<GlobalValue::GUID> &GUIDPreservedSymbols);
 
 /// Compute all the imports for the given module using the Index.
 ///
@@ -118,6 +134,13 @@ void thinLTOResolveWeakForLinkerModule(Module &TheModule,
 /// during global summary-based analysis.
 void thinLTOInternalizeModule(Module &TheModule,
                               const GVSummaryMapTy &DefinedGlobals);
+
+/// Add to the functions of \p TheModule, defined or declared, the attributes
+/// recorded in the summaries of \p Index during global summary-based analysis
+/// (see thinLTOPropagateFunctionAttrsInIndex). Returns true if any attribute
+/// was added.
+bool thinLTOApplyFunctionAttrsModule(Module &TheModule,
+                                     const ModuleSummaryIndex &Index);
 }
 
 #endif // LLVM_FUNCTIONIMPORT_H
@@ -0,0 +1,29 @@
+//===- FunctionOrdering.h - Order functions by call affinity ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass reorders the functions of a module so that hot functions which
+// call each other end up next to each other in the output.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_FUNCTIONORDERING_H
+#define LLVM_TRANSFORMS_IPO_FUNCTIONORDERING_H
+
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+/// Pass to lay out functions by their profiled call graph.
+class FunctionOrderingPass : public PassInfoMixin<FunctionOrderingPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+};
+}
+#endif // LLVM_TRANSFORMS_IPO_FUNCTIONORDERING_H
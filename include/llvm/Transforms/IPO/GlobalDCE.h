@@ -18,9 +18,11 @@
 #ifndef LLVM_TRANSFORMS_IPO_GLOBALDCE_H
 #define LLVM_TRANSFORMS_IPO_GLOBALDCE_H
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
-#include <unordered_map>
 
 namespace llvm {
 
@@ -32,12 +34,19 @@ public:
 private:
   SmallPtrSet<GlobalValue*, 32> AliveGlobals;
   SmallPtrSet<Constant *, 8> SeenConstants;
-  std::unordered_multimap<Comdat *, GlobalValue *> ComdatMembers;
-
-  /// Mark the specific global value as needed, and
-  /// recursively mark anything that it uses as also needed.
+  DenseMap<Comdat *, SmallVector<GlobalValue *, 4>> ComdatMembers;
+  /// Comdats whose members have all been marked as needed.
+  SmallPtrSet<Comdat *, 8> AliveComdats;
+  /// Globals marked as needed whose references have not been scanned yet.
+  SmallVector<GlobalValue *, 64> Worklist;
+
+  /// Mark the specific global value as needed, and queue it so that
+  /// anything it uses is marked as needed too.
   void GlobalIsNeeded(GlobalValue *GV);
   void MarkUsedGlobalsAsNeeded(Constant *C);
+  /// Mark the other members of the comdat of \p GV and everything \p GV
+  /// uses as needed.
+  void MarkReferencesAsNeeded(GlobalValue *GV);
   bool RemoveUnusedGlobalValue(GlobalValue &GV);
 };
 
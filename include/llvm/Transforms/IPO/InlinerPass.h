@@ -17,10 +17,13 @@
 #ifndef LLVM_TRANSFORMS_IPO_INLINERPASS_H
 #define LLVM_TRANSFORMS_IPO_INLINERPASS_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
+#include <memory>
 
 namespace llvm {
 class AssumptionCacheTracker;
+class BlockFrequencyInfo;
 class CallSite;
 class DataLayout;
 class InlineCost;
@@ -33,6 +36,7 @@ template <class PtrType, unsigned SmallSize> class SmallPtrSet;
 struct Inliner : public CallGraphSCCPass {
   explicit Inliner(char &ID);
   explicit Inliner(char &ID, bool InsertLifetime);
+  ~Inliner() override;
 
   /// getAnalysisUsage - For this class, we declare that we require and preserve
   /// the call graph.  If the derived class implements this method, it should
@@ -43,6 +47,9 @@ struct Inliner : public CallGraphSCCPass {
   // Pass class.
   bool runOnSCC(CallGraphSCC &SCC) override;
 
+  using llvm::Pass::doInitialization;
+  bool doInitialization(CallGraph &CG) override;
+
   using llvm::Pass::doFinalization;
   // doFinalization - Remove now-dead linkonce functions at the end of
   // processing to avoid breaking the SCC traversal.
@@ -74,8 +81,8 @@ private:
   bool InsertLifetime;
 
   /// shouldInline - Return true if the inliner should attempt to
-  /// inline at the given CallSite.
-  bool shouldInline(CallSite CS);
+  /// inline at the given CallSite, and set \p InlinedCost to its cost.
+  bool shouldInline(CallSite CS, int &InlinedCost);
   /// Return true if inlining of CS can block the caller from being
   /// inlined which is proved to be more beneficial. \p IC is the
   /// estimated inline cost associated with callsite \p CS.
@@ -84,7 +91,20 @@ private:
   bool shouldBeDeferred(Function *Caller, CallSite CS, InlineCost IC,
                         int &TotalAltCost);
 
+  /// The analyses the block frequencies of a caller are computed from.
+  struct CallerProfile;
+  /// The profiles of the callers seen so far in the current SCC, which are
+  /// dropped when a call is inlined into them.
+  DenseMap<Function *, std::unique_ptr<CallerProfile>> CallerProfiles;
+  /// The cost of the hot call sites inlined in the module so far.
+  unsigned HotCallSiteCostSpent;
+
 protected:
+  /// Return the block frequencies of \p Caller for getInlineCost to adjust the
+  /// thresholds of its call sites by profile counts, or null if there is no
+  /// profile or the -inline-hot-callsite-budget is spent.
+  BlockFrequencyInfo *getCallerBFI(Function *Caller);
+
   AssumptionCacheTracker *ACT;
   ProfileSummaryInfo *PSI;
 };
@@ -176,6 +176,15 @@ public:
   void populateModulePassManager(legacy::PassManagerBase &MPM);
   void populateLTOPassManager(legacy::PassManagerBase &PM);
   void populateThinLTOPassManager(legacy::PassManagerBase &PM);
+
+  /// populateJITPassManager - This sets up a short pipeline for code that is
+  /// compiled just in time, a module at a time.  It only cleans up within
+  /// functions: at OptLevel 1 it runs SROA, EarlyCSE, InstCombine and
+  /// SimplifyCFG, and higher levels add GVN and dead store elimination.  The
+  /// interprocedural, loop and vectorization passes of
+  /// populateModulePassManager are left out, since they cost more than
+  /// small, short-lived modules gain from them.
+  void populateJITPassManager(legacy::PassManagerBase &PM);
 };
 
 /// Registers a function for adding a standard set of passes.  This should be
@@ -14,6 +14,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -26,7 +27,9 @@ namespace llvm {
 /// InstCombine.
 class InstCombineWorklist {
   SmallVector<Instruction*, 256> Worklist;
-  DenseMap<Instruction*, unsigned> WorklistMap;
+  DenseMap<Instruction *, unsigned, MixedPtrDenseMapInfo<Instruction>>
+      WorklistMap;
+  SmallVectorImpl<WeakVH> *AddedInsts = nullptr;
 
   void operator=(const InstCombineWorklist&RHS) = delete;
   InstCombineWorklist(const InstCombineWorklist&) = delete;
@@ -44,12 +47,18 @@ public:
 
   bool isEmpty() const { return Worklist.empty(); }
 
+  /// Record every instruction added from now on in \p List, or stop
+  /// recording if it is null.
+  void setAddedInstsList(SmallVectorImpl<WeakVH> *List) { AddedInsts = List; }
+
   /// Add - Add the specified instruction to the worklist if it isn't already
   /// in it.
   void Add(Instruction *I) {
     if (WorklistMap.insert(std::make_pair(I, Worklist.size())).second) {
       DEBUG(dbgs() << "IC: ADD: " << *I << '\n');
       Worklist.push_back(I);
+      if (AddedInsts)
+        AddedInsts->push_back(I);
     }
   }
 
@@ -75,7 +84,7 @@ public:
 
   // Remove - remove I from the worklist if it exists.
   void Remove(Instruction *I) {
-    DenseMap<Instruction*, unsigned>::iterator It = WorklistMap.find(I);
+    auto It = WorklistMap.find(I);
     if (It == WorklistMap.end()) return; // Not in worklist.
 
     // Don't bother moving everything down, just null out the slot.
@@ -45,12 +45,29 @@ private:
   };
   DenseMap<GlobalVariable *, PerFunctionProfileData> ProfileDataMap;
   std::vector<Value *> UsedVars;
+  // The counter loads and stores made by lowering the increments of the
+  // current function, for counter promotion.
+  std::vector<std::pair<LoadInst *, StoreInst *>> PromotionCandidates;
   std::vector<GlobalVariable *> ReferencedNames;
   GlobalVariable *NamesVar;
   size_t NamesSize;
 
   bool isMachO() const;
 
+  /// Return true if counters in loops should be promoted to registers.
+  bool isCounterPromotionEnabled() const;
+
+  /// Return true if counters should be updated atomically.
+  bool isAtomic() const;
+
+  /// Lower the instrumentation intrinsics in F.
+  /// \returns true if there were any.
+  bool lowerIntrinsics(Function *F);
+
+  /// Keep the counters lowered in loops of F in registers, adding them to the
+  /// counters in memory on the loop exits instead.
+  void promoteCounterLoadStores(Function *F);
+
   /// Get the section name for the counter variables.
   StringRef getCountersSection() const;
 
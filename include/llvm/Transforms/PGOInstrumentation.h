@@ -44,5 +44,11 @@ private:
   bool InLTO;
 };
 
+/// The memory intrinsic size specialization pass.
+class PGOMemOPSizeOpt : public PassInfoMixin<PGOMemOPSizeOpt> {
+public:
+  PreservedAnalyses run(Function &F, AnalysisManager<Function> &FAM);
+};
+
 } // End llvm namespace
 #endif
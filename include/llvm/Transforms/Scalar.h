@@ -145,6 +145,13 @@ Pass *createLICMPass();
 //
 Pass *createLoopInterchangePass();
 
+//===----------------------------------------------------------------------===//
+//
+// LoopFusion - This pass fuses adjacent loops with the same trip count, so
+// that the second one reuses the data the first one brought into the cache.
+//
+FunctionPass *createLoopFusionPass();
+
 //===----------------------------------------------------------------------===//
 //
 // LoopStrengthReduce - This pass is strength reduces GEP instructions that use
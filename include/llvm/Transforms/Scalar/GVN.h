@@ -26,6 +26,7 @@
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/PassManager.h"
+#include "llvm/Transforms/Utils/MemorySSA.h"
 
 namespace llvm {
 
@@ -110,6 +111,20 @@ private:
   AssumptionCache *AC;
   SetVector<BasicBlock *> DeadBlocks;
 
+  /// When loads are eliminated with MemorySSA rather than with memdep, the
+  /// MemorySSA of the function, built by the first iteration and rebuilt by
+  /// the first one after the CFG changes.
+  bool UseMemorySSA = false;
+  bool MSSAIsStale = false;
+  std::unique_ptr<MemorySSA> MSSA;
+  MemorySSAWalker *MSSAWalker = nullptr;
+
+  /// The loads seen so far in this iteration that no earlier value was found
+  /// for, by clobbering access and value number of the pointer. A later load
+  /// with the same key that one of them dominates reads the same value.
+  DenseMap<std::pair<MemoryAccess *, uint32_t>, SmallVector<LoadInst *, 2>>
+      AvailableLoads;
+
   ValueTable VN;
 
   /// A mapping from value numbers to lists of Value*'s that
@@ -134,7 +149,7 @@ private:
 
   bool runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
                const TargetLibraryInfo &RunTLI, AAResults &RunAA,
-               MemoryDependenceResults *RunMD);
+               MemoryDependenceResults *RunMD, bool RunUseMemorySSA = false);
 
   /// Push a new Value to the LeaderTable onto the list for its value number.
   void addToLeaderTable(uint32_t N, Value *V, const BasicBlock *BB) {
@@ -187,6 +202,10 @@ private:
   // Helper functions of redundant load elimination
   bool processLoad(LoadInst *L);
   bool processNonLocalLoad(LoadInst *L);
+  /// Eliminate a load from the value that its clobbering MemorySSA access
+  /// stores or that a dominating load with the same clobber reads.
+  bool processLoadWithMemorySSA(LoadInst *L);
+  void removeFromMemorySSA(Instruction *I);
   bool processAssumeIntrinsic(IntrinsicInst *II);
   /// Given a local dependency (Def or Clobber) determine if a value is
   /// available for the load.  Returns true if an value is known to be
@@ -497,6 +497,11 @@ public:
   MemorySSA(MemorySSA &&);
   ~MemorySSA();
 
+  /// \brief Handle invalidation explicitly. MemorySSA holds on to the alias
+  /// analysis and the dominator tree, so it is invalidated along with them
+  /// even when a pass claims to preserve it.
+  bool invalidate(Function &F, const PreservedAnalyses &PA);
+
   MemorySSAWalker *getWalker();
 
   /// \brief Given a memory Mod/Ref'ing instruction, get the MemorySSA
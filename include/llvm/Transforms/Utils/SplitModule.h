@@ -27,6 +27,11 @@ class StringRef;
 /// Splits the module M into N linkable partitions. The function ModuleCallback
 /// is called N times passing each individual partition as the MPart argument.
 ///
+/// If ClusterCallGraph is set, the functions of each strongly connected
+/// component of the call graph are kept in the same partition, and all
+/// definitions are packed into partitions by estimated code size instead of
+/// being assigned by the hash of their names.
+///
 /// FIXME: This function does not deal with the somewhat subtle symbol
 /// visibility issues around module splitting, including (but not limited to):
 ///
@@ -37,7 +42,7 @@ class StringRef;
 void SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals = false);
+    bool PreserveLocals = false, bool ClusterCallGraph = false);
 
 } // End llvm namespace
 
@@ -82,6 +82,26 @@ AliasResult AAResults::alias(const MemoryLocation &LocA,
   return MayAlias;
 }
 
+SmallVector<AliasResult, 8> AAResults::alias(ArrayRef<MemoryLocation> Locs,
+                                             const MemoryLocation &Loc) {
+  BatchQueryScope Batch(*this);
+  SmallVector<AliasResult, 8> Results;
+  Results.reserve(Locs.size());
+  for (const MemoryLocation &L : Locs)
+    Results.push_back(alias(L, Loc));
+  return Results;
+}
+
+void AAResults::beginBatch() {
+  for (const auto &AA : AAs)
+    AA->beginBatch();
+}
+
+void AAResults::endBatch() {
+  for (const auto &AA : AAs)
+    AA->endBatch();
+}
+
 bool AAResults::pointsToConstantMemory(const MemoryLocation &Loc,
                                        bool OrLocal) {
   for (const auto &AA : AAs)
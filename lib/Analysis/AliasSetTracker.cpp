@@ -398,6 +398,7 @@ bool AliasSetTracker::add(Instruction *I) {
 }
 
 void AliasSetTracker::add(BasicBlock &BB) {
+  AliasAnalysis::BatchQueryScope Batch(AA);
   for (auto &I : BB)
     add(&I);
 }
@@ -405,6 +406,7 @@ void AliasSetTracker::add(BasicBlock &BB) {
 void AliasSetTracker::add(const AliasSetTracker &AST) {
   assert(&AA == &AST.AA &&
          "Merging AliasSetTracker objects with different Alias Analyses!");
+  AliasAnalysis::BatchQueryScope Batch(AA);
 
   // Loop over all of the alias sets in AST, adding the pointers contained
   // therein into the current alias sets.  This can cause alias sets to be
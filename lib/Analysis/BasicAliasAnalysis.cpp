@@ -1011,6 +1011,22 @@ bool BasicAAResult::isGEPBaseAtNegativeOffset(const GEPOperator *GEPOp,
   return (GEPBaseOffset >= ObjectBaseOffset + (int64_t)ObjectAccessSize);
 }
 
+bool BasicAAResult::decomposeGEPExpression(const Value *V,
+                                           DecomposedGEP &Decomposed) {
+  if (!BatchDepth)
+    return DecomposeGEPExpression(V, Decomposed, DL, &AC, DT);
+
+  auto I = DecomposedGEPCache.find(V);
+  if (I != DecomposedGEPCache.end()) {
+    Decomposed = I->second.first;
+    return I->second.second;
+  }
+  bool MaxLookupReached = DecomposeGEPExpression(V, Decomposed, DL, &AC, DT);
+  DecomposedGEPCache.insert(
+      std::make_pair(V, std::make_pair(Decomposed, MaxLookupReached)));
+  return MaxLookupReached;
+}
+
 /// Provides a bunch of ad-hoc rules to disambiguate a GEP instruction against
 /// another pointer.
 ///
@@ -1023,10 +1039,8 @@ AliasResult BasicAAResult::aliasGEP(const GEPOperator *GEP1, uint64_t V1Size,
                                     const Value *UnderlyingV1,
                                     const Value *UnderlyingV2) {
   DecomposedGEP DecompGEP1, DecompGEP2;
-  bool GEP1MaxLookupReached =
-    DecomposeGEPExpression(GEP1, DecompGEP1, DL, &AC, DT);
-  bool GEP2MaxLookupReached =
-    DecomposeGEPExpression(V2, DecompGEP2, DL, &AC, DT);
+  bool GEP1MaxLookupReached = decomposeGEPExpression(GEP1, DecompGEP1);
+  bool GEP2MaxLookupReached = decomposeGEPExpression(V2, DecompGEP2);
 
   int64_t GEP1BaseOffset = DecompGEP1.StructOffset + DecompGEP1.OtherOffset;
   int64_t GEP2BaseOffset = DecompGEP2.StructOffset + DecompGEP2.OtherOffset;
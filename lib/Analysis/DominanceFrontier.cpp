@@ -56,6 +56,11 @@ LLVM_DUMP_METHOD void DominanceFrontierWrapperPass::dump() const {
 }
 #endif
 
+bool DominanceFrontier::invalidate(Function &F, const PreservedAnalyses &PA) {
+  return !(PA.preserved<DominanceFrontierAnalysis>() ||
+           PA.preservedSet<CFGAnalyses>());
+}
+
 char DominanceFrontierAnalysis::PassID;
 
 DominanceFrontier DominanceFrontierAnalysis::run(Function &F,
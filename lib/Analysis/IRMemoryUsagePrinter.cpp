@@ -0,0 +1,94 @@
+//===-- IRMemoryUsagePrinter.cpp - Prints the memory used by the IR -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass estimates how much memory the values of a module take, by kind of
+// value, and how much of it goes to their operands, which are also the entries
+// of the use lists. Metadata, value names and the reserved but unused
+// operands of PHI nodes and switches are not counted.
+//
+// For example, run this pass from opt along with the -analyze option, and
+// it'll print to standard output.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/Passes.h"
+#include "llvm/IR/MemoryUsage.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Use.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace llvm;
+
+namespace {
+  class IRMemoryUsagePrinter : public ModulePass {
+    IRMemoryUsage::ValueKinds Values;
+
+  public:
+    static char ID; // Pass identification, replacement for typeid
+    IRMemoryUsagePrinter() : ModulePass(ID) {
+      initializeIRMemoryUsagePrinterPass(*PassRegistry::getPassRegistry());
+    }
+
+    bool runOnModule(Module &M) override {
+      Values = IRMemoryUsage(M).getValues();
+      return false;
+    }
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.setPreservesAll();
+    }
+    void print(raw_ostream &O, const Module *M) const override;
+  };
+}
+
+char IRMemoryUsagePrinter::ID = 0;
+INITIALIZE_PASS(IRMemoryUsagePrinter, "ir-memory-usage",
+                "Print the memory used by the IR of a module", false, true)
+
+ModulePass *llvm::createIRMemoryUsagePrinterPass() {
+  return new IRMemoryUsagePrinter();
+}
+
+void IRMemoryUsagePrinter::print(raw_ostream &O, const Module *M) const {
+  O << left_justify("Kind", 14) << ' ' << right_justify("Count", 10) << ' '
+    << right_justify("Bytes", 12) << ' ' << right_justify("Operands", 10)
+    << ' ' << right_justify("Use bytes", 12) << '\n';
+  ValueUsage Globals = Values.Functions;
+  Globals.Count += Values.GlobalVariables.Count;
+  Globals.Bytes += Values.GlobalVariables.Bytes;
+  Globals.Operands += Values.GlobalVariables.Operands;
+
+  ValueUsage Total;
+  auto PrintRow = [&](const char *Kind, const ValueUsage &Usage) {
+    uint64_t UseBytes = Usage.Operands * sizeof(Use);
+    O << format("%-14s %10" PRIu64 " %12" PRIu64 " %10" PRIu64 " %12" PRIu64
+                "\n",
+                Kind, Usage.Count, Usage.Bytes + UseBytes, Usage.Operands,
+                UseBytes);
+  };
+  std::pair<const char *, const ValueUsage *> Rows[] = {
+      {"Globals", &Globals},
+      {"Arguments", &Values.Arguments},
+      {"BasicBlocks", &Values.BasicBlocks},
+      {"Instructions", &Values.Instructions},
+      {"Constants", &Values.Constants}};
+  for (const auto &Row : Rows) {
+    PrintRow(Row.first, *Row.second);
+    Total.Count += Row.second->Count;
+    Total.Bytes += Row.second->Bytes;
+    Total.Operands += Row.second->Operands;
+  }
+  PrintRow("Total", Total);
+
+  uint64_t UseBytes = Total.Operands * sizeof(Use);
+  uint64_t TotalBytes = Total.Bytes + UseBytes;
+  O << format("Operands and use lists take %" PRIu64 "%% of the memory.\n",
+              TotalBytes ? UseBytes * 100 / TotalBytes : 0);
+}
@@ -66,6 +66,14 @@ static cl::opt<int> ColdThreshold(
     "inlinecold-threshold", cl::Hidden, cl::init(225),
     cl::desc("Threshold for inlining functions with cold attribute"));
 
+static cl::opt<int> HotCallSiteThreshold(
+    "hot-callsite-threshold", cl::Hidden, cl::init(3000), cl::ZeroOrMore,
+    cl::desc("Threshold for inlining call sites that the profile finds hot"));
+
+static cl::opt<int> ColdCallSiteThreshold(
+    "inline-cold-callsite-threshold", cl::Hidden, cl::init(45),
+    cl::desc("Threshold for inlining call sites that the profile finds cold"));
+
 namespace {
 
 class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
@@ -81,6 +89,9 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
   /// Profile summary information.
   ProfileSummaryInfo *PSI;
 
+  /// The block frequencies of the caller, if its profile is to be used.
+  BlockFrequencyInfo *CallerBFI;
+
   // The called function.
   Function &F;
 
@@ -204,9 +215,10 @@ class CallAnalyzer : public InstVisitor<CallAnalyzer, bool> {
 
 public:
   CallAnalyzer(const TargetTransformInfo &TTI, AssumptionCacheTracker *ACT,
-               ProfileSummaryInfo *PSI, Function &Callee, int Threshold,
-               CallSite CSArg)
-      : TTI(TTI), ACT(ACT), PSI(PSI), F(Callee), CandidateCS(CSArg),
+               ProfileSummaryInfo *PSI, BlockFrequencyInfo *CallerBFI,
+               Function &Callee, int Threshold, CallSite CSArg)
+      : TTI(TTI), ACT(ACT), PSI(PSI), CallerBFI(CallerBFI), F(Callee),
+        CandidateCS(CSArg),
         Threshold(Threshold), Cost(0), IsCallerRecursive(false),
         IsRecursiveCall(false), ExposesReturnsTwice(false),
         HasDynamicAlloca(false), ContainsNoDuplicateCall(false),
@@ -650,6 +662,18 @@ void CallAnalyzer::updateThreshold(CallSite CS, Function &Callee) {
       ColdCallee && ColdThreshold < Threshold)
     Threshold = ColdThreshold;
 
+  // The profile count of the call site itself says more than the entry counts
+  // of the callee, so let it raise or lower the threshold again.
+  if (PSI->isHotCallSite(CS, CallerBFI)) {
+    if (HotCallSiteThreshold > Threshold && !Caller->optForMinSize())
+      Threshold = HotCallSiteThreshold;
+  } else if ((DefaultInlineThreshold.getNumOccurrences() == 0 ||
+              ColdCallSiteThreshold.getNumOccurrences() > 0) &&
+             PSI->isColdCallSite(CS, CallerBFI) &&
+             ColdCallSiteThreshold < Threshold) {
+    Threshold = ColdCallSiteThreshold;
+  }
+
   // Finally, take the target-specific inlining threshold multiplier into
   // account.
   Threshold *= TTI.getInliningThresholdMultiplier();
@@ -950,8 +974,8 @@ bool CallAnalyzer::visitCallSite(CallSite CS) {
   // during devirtualization and so we want to give it a hefty bonus for
   // inlining, but cap that bonus in the event that inlining wouldn't pan
   // out. Pretend to inline the function, with a custom threshold.
-  CallAnalyzer CA(TTI, ACT, PSI, *F, InlineConstants::IndirectCallThreshold,
-                  CS);
+  CallAnalyzer CA(TTI, ACT, PSI, /*CallerBFI=*/nullptr, *F,
+                  InlineConstants::IndirectCallThreshold, CS);
   if (CA.analyzeCall(CS)) {
     // We were able to inline the indirect call! Subtract the cost from the
     // threshold to get the bonus we want to apply, but don't go below zero.
@@ -1440,9 +1464,10 @@ static bool functionsHaveCompatibleAttributes(Function *Caller,
 InlineCost llvm::getInlineCost(CallSite CS, int DefaultThreshold,
                                TargetTransformInfo &CalleeTTI,
                                AssumptionCacheTracker *ACT,
-                               ProfileSummaryInfo *PSI) {
+                               ProfileSummaryInfo *PSI,
+                               BlockFrequencyInfo *CallerBFI) {
   return getInlineCost(CS, CS.getCalledFunction(), DefaultThreshold, CalleeTTI,
-                       ACT, PSI);
+                       ACT, PSI, CallerBFI);
 }
 
 int llvm::computeThresholdFromOptLevels(unsigned OptLevel,
@@ -1462,7 +1487,8 @@ InlineCost llvm::getInlineCost(CallSite CS, Function *Callee,
                                int DefaultThreshold,
                                TargetTransformInfo &CalleeTTI,
                                AssumptionCacheTracker *ACT,
-                               ProfileSummaryInfo *PSI) {
+                               ProfileSummaryInfo *PSI,
+                               BlockFrequencyInfo *CallerBFI) {
 
   // Cannot inline indirect calls.
   if (!Callee)
@@ -1496,7 +1522,8 @@ InlineCost llvm::getInlineCost(CallSite CS, Function *Callee,
   DEBUG(llvm::dbgs() << "      Analyzing call of " << Callee->getName()
                      << "...\n");
 
-  CallAnalyzer CA(CalleeTTI, ACT, PSI, *Callee, DefaultThreshold, CS);
+  CallAnalyzer CA(CalleeTTI, ACT, PSI, CallerBFI, *Callee, DefaultThreshold,
+                  CS);
   bool ShouldInline = CA.analyzeCall(CS);
 
   DEBUG(CA.dump());
@@ -15,6 +15,7 @@
 #include "llvm/Analysis/LazyValueInfo.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/ConstantFolding.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
@@ -29,15 +30,29 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/PatternMatch.h"
 #include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
-#include <map>
+#include <list>
 #include <stack>
 using namespace llvm;
 using namespace PatternMatch;
 
 #define DEBUG_TYPE "lazy-value-info"
 
+STATISTIC(NumQueryHits, "Number of LVI queries answered from the cache");
+STATISTIC(NumQueryMisses, "Number of LVI queries that ran the solver");
+STATISTIC(NumBlockValuesSolved, "Number of block values computed by LVI");
+STATISTIC(NumOverdefinedShortcuts,
+          "Number of block values found overdefined without solving all "
+          "predecessors");
+STATISTIC(NumBlocksEvicted, "Number of blocks evicted from the LVI cache");
+
+static cl::opt<unsigned> MaxCachedValues(
+    "lvi-max-cached-values", cl::init(100000), cl::Hidden,
+    cl::desc("Maximum number of lattice values LVI keeps cached before it "
+             "evicts the least recently used blocks (0 = unlimited)"));
+
 char LazyValueInfoWrapperPass::ID = 0;
 INITIALIZE_PASS_BEGIN(LazyValueInfoWrapperPass, "lazy-value-info",
                 "Lazy Value Information Analysis", false, true)
@@ -368,7 +383,7 @@ namespace {
   struct LVIValueHandle final : public CallbackVH {
     LazyValueInfoCache *Parent;
 
-    LVIValueHandle(Value *V, LazyValueInfoCache *P)
+    LVIValueHandle(Value *V, LazyValueInfoCache *P = nullptr)
       : CallbackVH(V), Parent(P) { }
 
     void deleted() override;
@@ -381,28 +396,38 @@ namespace {
 namespace {
   /// This is the cache kept by LazyValueInfo which
   /// maintains information about queries across the clients' queries.
+  ///
+  /// The cache is organized by block, so that the blocks that were used least
+  /// recently can be evicted as a whole once it holds more than
+  /// MaxCachedValues lattice values. Evicted values are simply solved again
+  /// when they are next needed.
   class LazyValueInfoCache {
-    /// This is all of the cached block information for exactly one Value*.
-    /// The entries are sorted by the BasicBlock* of the
-    /// entries, allowing us to do a lookup with a binary search.
-    /// Over-defined lattice values are recorded in OverDefinedCache to reduce
-    /// memory overhead.
-    typedef SmallDenseMap<AssertingVH<BasicBlock>, LVILatticeVal, 4>
-        ValueCacheEntryTy;
-
-    /// This is all of the cached information for all values,
-    /// mapped from Value* to key information.
-    std::map<LVIValueHandle, ValueCacheEntryTy> ValueCache;
-
-    /// This tracks, on a per-block basis, the set of values that are
-    /// over-defined at the end of that block.
-    typedef DenseMap<AssertingVH<BasicBlock>, SmallPtrSet<Value *, 4>>
-        OverDefinedCacheTy;
-    OverDefinedCacheTy OverDefinedCache;
-
-    /// Keep track of all blocks that we have ever seen, so we
-    /// don't spend time removing unused blocks from our caches.
-    DenseSet<AssertingVH<BasicBlock> > SeenBlocks;
+    /// This is all of the cached information for exactly one block.
+    struct BlockCacheEntry {
+      /// The lattice values at the end of the block, other than overdefined.
+      SmallDenseMap<Value *, LVILatticeVal, 4> LatticeElements;
+      /// The values that are over-defined at the end of the block, which are
+      /// recorded apart to reduce memory overhead.
+      SmallPtrSet<Value *, 4> OverDefined;
+      /// The position of the block in LRUBlocks.
+      std::list<BasicBlock *>::iterator LRUPos;
+    };
+
+    /// This is all of the cached information for all blocks.
+    typedef DenseMap<AssertingVH<BasicBlock>, std::unique_ptr<BlockCacheEntry>>
+        BlockCacheTy;
+    BlockCacheTy BlockCache;
+
+    /// The blocks in BlockCache, the most recently used first.
+    std::list<BasicBlock *> LRUBlocks;
+
+    /// The number of lattice values in BlockCache, including the overdefined
+    /// ones.
+    unsigned NumCachedValues = 0;
+
+    /// The handles of the values that have cached information, which erase
+    /// it when the values go away.
+    DenseSet<LVIValueHandle, DenseMapInfo<Value *>> ValueHandles;
 
     /// This stack holds the state of the value solver during a query.
     /// It basically emulates the callstack of the naive
@@ -430,21 +455,72 @@ namespace {
 
     friend struct LVIValueHandle;
 
-    void insertResult(Value *Val, BasicBlock *BB, const LVILatticeVal &Result) {
-      SeenBlocks.insert(BB);
+    /// Return the cache entry of BB, if there is one, and mark BB as the most
+    /// recently used block.
+    BlockCacheEntry *getBlockEntry(BasicBlock *BB) {
+      auto I = BlockCache.find(BB);
+      if (I == BlockCache.end())
+        return nullptr;
+      BlockCacheEntry *Entry = I->second.get();
+      LRUBlocks.splice(LRUBlocks.begin(), LRUBlocks, Entry->LRUPos);
+      return Entry;
+    }
+
+    BlockCacheEntry &getOrCreateBlockEntry(BasicBlock *BB) {
+      if (BlockCacheEntry *Entry = getBlockEntry(BB))
+        return *Entry;
+      auto &Entry = BlockCache[BB];
+      Entry = llvm::make_unique<BlockCacheEntry>();
+      Entry->LRUPos = LRUBlocks.insert(LRUBlocks.begin(), BB);
+      return *Entry;
+    }
 
-      // Insert over-defined values into their own cache to reduce memory
+    void insertResult(Value *Val, BasicBlock *BB, const LVILatticeVal &Result) {
+      BlockCacheEntry &Entry = getOrCreateBlockEntry(BB);
+      ValueHandles.insert(LVIValueHandle(Val, this));
+      ++NumBlockValuesSolved;
+
+      // A value that is solved again replaces its previous result, which is
+      // only counted once.
+      bool Existed = Entry.OverDefined.erase(Val);
+      Existed |= Entry.LatticeElements.erase(Val);
+      if (!Existed)
+        ++NumCachedValues;
+
+      // Insert over-defined values into their own set to reduce memory
       // overhead.
       if (Result.isOverdefined())
-        OverDefinedCache[BB].insert(Val);
+        Entry.OverDefined.insert(Val);
       else
-        lookup(Val)[BB] = Result;
+        Entry.LatticeElements.insert(std::make_pair(Val, Result));
+    }
+
+    /// Drop the cache entry of BB.
+    void eraseBlockEntry(BlockCacheTy::iterator I) {
+      BlockCacheEntry &Entry = *I->second;
+      NumCachedValues -=
+          Entry.LatticeElements.size() + Entry.OverDefined.size();
+      LRUBlocks.erase(Entry.LRUPos);
+      BlockCache.erase(I);
+    }
+
+    /// Evict the least recently used blocks until the cache is within its
+    /// limit. This must only happen between queries, as the solver expects
+    /// the values it has pushed to stay cached once they are computed.
+    void pruneCache() {
+      assert(BlockValueStack.empty() && "Pruning the cache during a query!");
+      if (!MaxCachedValues)
+        return;
+      while (NumCachedValues > MaxCachedValues && LRUBlocks.size() > 1) {
+        eraseBlockEntry(BlockCache.find(LRUBlocks.back()));
+        ++NumBlocksEvicted;
+      }
     }
 
     LVILatticeVal getBlockValue(Value *Val, BasicBlock *BB);
     bool getEdgeValue(Value *V, BasicBlock *F, BasicBlock *T,
-                      LVILatticeVal &Result,
-                      Instruction *CxtI = nullptr);
+                      LVILatticeVal &Result, Instruction *CxtI = nullptr,
+                      bool PushMissing = true);
     bool hasBlockValue(Value *Val, BasicBlock *BB);
 
     // These methods process one work item and may add more. A false value
@@ -466,36 +542,20 @@ namespace {
 
     void solve();
 
-    ValueCacheEntryTy &lookup(Value *V) {
-      return ValueCache[LVIValueHandle(V, this)];
-    }
-
-    bool isOverdefined(Value *V, BasicBlock *BB) const {
-      auto ODI = OverDefinedCache.find(BB);
-
-      if (ODI == OverDefinedCache.end())
-        return false;
-
-      return ODI->second.count(V);
-    }
-
     bool hasCachedValueInfo(Value *V, BasicBlock *BB) {
-      if (isOverdefined(V, BB))
-        return true;
-
-      LVIValueHandle ValHandle(V, this);
-      auto I = ValueCache.find(ValHandle);
-      if (I == ValueCache.end())
+      BlockCacheEntry *Entry = getBlockEntry(BB);
+      if (!Entry)
         return false;
-
-      return I->second.count(BB);
+      return Entry->OverDefined.count(V) || Entry->LatticeElements.count(V);
     }
 
     LVILatticeVal getCachedValueInfo(Value *V, BasicBlock *BB) {
-      if (isOverdefined(V, BB))
+      BlockCacheEntry *Entry = getBlockEntry(BB);
+      if (!Entry)
+        return LVILatticeVal();
+      if (Entry->OverDefined.count(V))
         return LVILatticeVal::getOverdefined();
-
-      return lookup(V)[BB];
+      return Entry->LatticeElements.lookup(V);
     }
     
   public:
@@ -524,9 +584,10 @@ namespace {
 
     /// clear - Empty the cache.
     void clear() {
-      SeenBlocks.clear();
-      ValueCache.clear();
-      OverDefinedCache.clear();
+      BlockCache.clear();
+      LRUBlocks.clear();
+      NumCachedValues = 0;
+      ValueHandles.clear();
     }
 
     LazyValueInfoCache(AssumptionCache *AC, const DataLayout &DL,
@@ -536,35 +597,27 @@ namespace {
 } // end anonymous namespace
 
 void LVIValueHandle::deleted() {
-  SmallVector<AssertingVH<BasicBlock>, 4> ToErase;
-  for (auto &I : Parent->OverDefinedCache) {
-    SmallPtrSetImpl<Value *> &ValueSet = I.second;
-    if (ValueSet.count(getValPtr()))
-      ValueSet.erase(getValPtr());
-    if (ValueSet.empty())
+  Value *V = getValPtr();
+  SmallVector<BasicBlock *, 4> ToErase;
+  for (auto &I : Parent->BlockCache) {
+    auto &Entry = *I.second;
+    Parent->NumCachedValues -=
+        Entry.OverDefined.erase(V) + Entry.LatticeElements.erase(V);
+    if (Entry.OverDefined.empty() && Entry.LatticeElements.empty())
       ToErase.push_back(I.first);
   }
-  for (auto &BB : ToErase)
-    Parent->OverDefinedCache.erase(BB);
+  for (BasicBlock *BB : ToErase)
+    Parent->eraseBlockEntry(Parent->BlockCache.find(BB));
 
   // This erasure deallocates *this, so it MUST happen after we're done
   // using any and all members of *this.
-  Parent->ValueCache.erase(*this);
+  Parent->ValueHandles.erase(*this);
 }
 
 void LazyValueInfoCache::eraseBlock(BasicBlock *BB) {
-  // Shortcut if we have never seen this block.
-  DenseSet<AssertingVH<BasicBlock> >::iterator I = SeenBlocks.find(BB);
-  if (I == SeenBlocks.end())
-    return;
-  SeenBlocks.erase(I);
-
-  auto ODI = OverDefinedCache.find(BB);
-  if (ODI != OverDefinedCache.end())
-    OverDefinedCache.erase(ODI);
-
-  for (auto &I : ValueCache)
-    I.second.erase(BB);
+  auto I = BlockCache.find(BB);
+  if (I != BlockCache.end())
+    eraseBlockEntry(I);
 }
 
 void LazyValueInfoCache::solve() {
@@ -603,7 +656,6 @@ LVILatticeVal LazyValueInfoCache::getBlockValue(Value *Val, BasicBlock *BB) {
   if (Constant *VC = dyn_cast<Constant>(Val))
     return LVILatticeVal::get(VC);
 
-  SeenBlocks.insert(BB);
   return getCachedValueInfo(Val, BB);
 }
 
@@ -633,8 +685,8 @@ bool LazyValueInfoCache::solveBlockValue(Value *Val, BasicBlock *BB) {
                  << "' val=" << getCachedValueInfo(Val, BB) << '\n');
 
     // Since we're reusing a cached value, we don't need to update the
-    // OverDefinedCache. The cache will have been properly updated whenever the
-    // cached value was inserted.
+    // cache. It will have been properly updated whenever the cached value was
+    // inserted.
     return true;
   }
 
@@ -773,13 +825,16 @@ bool LazyValueInfoCache::solveBlockValueNonLocal(LVILatticeVal &BBLV,
   }
 
   // Loop over all of our predecessors, merging what we know from them into
-  // result.
-  bool EdgesMissing = false;
+  // result. Edges whose values still need solving are only pushed once the
+  // known ones are merged in, as an overdefined one makes them unnecessary.
+  SmallVector<BasicBlock *, 4> MissingPreds;
   for (pred_iterator PI = pred_begin(BB), E = pred_end(BB); PI != E; ++PI) {
     LVILatticeVal EdgeResult;
-    EdgesMissing |= !getEdgeValue(Val, *PI, BB, EdgeResult);
-    if (EdgesMissing)
+    if (!getEdgeValue(Val, *PI, BB, EdgeResult, nullptr,
+                      /*PushMissing=*/false)) {
+      MissingPreds.push_back(*PI);
       continue;
+    }
 
     Result.mergeIn(EdgeResult, DL);
 
@@ -788,6 +843,8 @@ bool LazyValueInfoCache::solveBlockValueNonLocal(LVILatticeVal &BBLV,
     if (Result.isOverdefined()) {
       DEBUG(dbgs() << " compute BB '" << BB->getName()
             << "' - overdefined because of pred (non local).\n");
+      if (!MissingPreds.empty())
+        ++NumOverdefinedShortcuts;
       // Bofore giving up, see if we can prove the pointer non-null local to
       // this particular block.
       if (Val->getType()->isPointerTy() &&
@@ -800,8 +857,14 @@ bool LazyValueInfoCache::solveBlockValueNonLocal(LVILatticeVal &BBLV,
       return true;
     }
   }
-  if (EdgesMissing)
+  if (!MissingPreds.empty()) {
+    // Solve the missing edges first, then come back.
+    for (BasicBlock *Pred : MissingPreds) {
+      LVILatticeVal EdgeResult;
+      getEdgeValue(Val, Pred, BB, EdgeResult);
+    }
     return false;
+  }
 
   // Return the merged value, which is more precise than 'overdefined'.
   assert(!Result.isOverdefined());
@@ -814,8 +877,9 @@ bool LazyValueInfoCache::solveBlockValuePHINode(LVILatticeVal &BBLV,
   LVILatticeVal Result;  // Start Undefined.
 
   // Loop over all of our predecessors, merging what we know from them into
-  // result.
-  bool EdgesMissing = false;
+  // result. As for non-local values, the incoming values that still need
+  // solving are only pushed if the known ones aren't overdefined.
+  SmallVector<unsigned, 4> MissingIncoming;
   for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i) {
     BasicBlock *PhiBB = PN->getIncomingBlock(i);
     Value *PhiVal = PN->getIncomingValue(i);
@@ -823,9 +887,11 @@ bool LazyValueInfoCache::solveBlockValuePHINode(LVILatticeVal &BBLV,
     // Note that we can provide PN as the context value to getEdgeValue, even
     // though the results will be cached, because PN is the value being used as
     // the cache key in the caller.
-    EdgesMissing |= !getEdgeValue(PhiVal, PhiBB, BB, EdgeResult, PN);
-    if (EdgesMissing)
+    if (!getEdgeValue(PhiVal, PhiBB, BB, EdgeResult, PN,
+                      /*PushMissing=*/false)) {
+      MissingIncoming.push_back(i);
       continue;
+    }
 
     Result.mergeIn(EdgeResult, DL);
 
@@ -834,13 +900,21 @@ bool LazyValueInfoCache::solveBlockValuePHINode(LVILatticeVal &BBLV,
     if (Result.isOverdefined()) {
       DEBUG(dbgs() << " compute BB '" << BB->getName()
             << "' - overdefined because of pred (local).\n");
+      if (!MissingIncoming.empty())
+        ++NumOverdefinedShortcuts;
 
       BBLV = Result;
       return true;
     }
   }
-  if (EdgesMissing)
+  if (!MissingIncoming.empty()) {
+    for (unsigned i : MissingIncoming) {
+      LVILatticeVal EdgeResult;
+      getEdgeValue(PN->getIncomingValue(i), PN->getIncomingBlock(i), BB,
+                   EdgeResult, PN);
+    }
     return false;
+  }
 
   // Return the merged value, which is more precise than 'overdefined'.
   assert(!Result.isOverdefined() && "Possible PHI in entry block?");
@@ -1271,9 +1345,12 @@ static bool getEdgeValueLocal(Value *Val, BasicBlock *BBFrom,
 
 /// \brief Compute the value of Val on the edge BBFrom -> BBTo or the value at
 /// the basic block if the edge does not constrain Val.
+///
+/// Return false if the value of Val at the end of BBFrom must be solved first,
+/// in which case it is pushed on the solver's stack if PushMissing is set.
 bool LazyValueInfoCache::getEdgeValue(Value *Val, BasicBlock *BBFrom,
                                       BasicBlock *BBTo, LVILatticeVal &Result,
-                                      Instruction *CxtI) {
+                                      Instruction *CxtI, bool PushMissing) {
   // If already a constant, there is nothing to compute.
   if (Constant *VC = dyn_cast<Constant>(Val)) {
     Result = LVILatticeVal::get(VC);
@@ -1293,7 +1370,8 @@ bool LazyValueInfoCache::getEdgeValue(Value *Val, BasicBlock *BBFrom,
   }
 
   if (!hasBlockValue(Val, BBFrom)) {
-    if (pushBlockValue(std::make_pair(BBFrom, Val)))
+    auto BV = std::make_pair(BBFrom, Val);
+    if (!PushMissing ? !BlockValueSet.count(BV) : pushBlockValue(BV))
       return false;
     // No new information.
     Result = LocalResult;
@@ -1324,11 +1402,15 @@ LVILatticeVal LazyValueInfoCache::getValueInBlock(Value *V, BasicBlock *BB,
 
   assert(BlockValueStack.empty() && BlockValueSet.empty());
   if (!hasBlockValue(V, BB)) {
+    ++NumQueryMisses;
     pushBlockValue(std::make_pair(BB, V)); 
     solve();
+  } else {
+    ++NumQueryHits;
   }
   LVILatticeVal Result = getBlockValue(V, BB);
   intersectAssumeBlockValueConstantRange(V, Result, CxtI);
+  pruneCache();
 
   DEBUG(dbgs() << "  Result = " << Result << "\n");
   return Result;
@@ -1358,10 +1440,14 @@ getValueOnEdge(Value *V, BasicBlock *FromBB, BasicBlock *ToBB,
 
   LVILatticeVal Result;
   if (!getEdgeValue(V, FromBB, ToBB, Result, CxtI)) {
+    ++NumQueryMisses;
     solve();
     bool WasFastQuery = getEdgeValue(V, FromBB, ToBB, Result, CxtI);
     (void)WasFastQuery;
     assert(WasFastQuery && "More work to do after problem solved?");
+    pruneCache();
+  } else {
+    ++NumQueryHits;
   }
 
   DEBUG(dbgs() << "  Result = " << Result << "\n");
@@ -1383,10 +1469,11 @@ void LazyValueInfoCache::threadEdge(BasicBlock *PredBB, BasicBlock *OldSucc,
   std::vector<BasicBlock*> worklist;
   worklist.push_back(OldSucc);
 
-  auto I = OverDefinedCache.find(OldSucc);
-  if (I == OverDefinedCache.end())
+  BlockCacheEntry *OldEntry = getBlockEntry(OldSucc);
+  if (!OldEntry || OldEntry->OverDefined.empty())
     return; // Nothing to process here.
-  SmallVector<Value *, 4> ValsToClear(I->second.begin(), I->second.end());
+  SmallVector<Value *, 4> ValsToClear(OldEntry->OverDefined.begin(),
+                                      OldEntry->OverDefined.end());
 
   // Use a worklist to perform a depth-first search of OldSucc's successors.
   // NOTE: We do not need a visited list since any blocks we have already
@@ -1399,24 +1486,24 @@ void LazyValueInfoCache::threadEdge(BasicBlock *PredBB, BasicBlock *OldSucc,
     // Skip blocks only accessible through NewSucc.
     if (ToUpdate == NewSucc) continue;
 
+    auto OI = BlockCache.find(ToUpdate);
+    if (OI == BlockCache.end())
+      continue;
+    BlockCacheEntry &Entry = *OI->second;
+
     bool changed = false;
     for (Value *V : ValsToClear) {
       // If a value was marked overdefined in OldSucc, and is here too...
-      auto OI = OverDefinedCache.find(ToUpdate);
-      if (OI == OverDefinedCache.end())
+      if (!Entry.OverDefined.erase(V))
         continue;
-      SmallPtrSetImpl<Value *> &ValueSet = OI->second;
-      if (!ValueSet.count(V))
-        continue;
-
-      ValueSet.erase(V);
-      if (ValueSet.empty())
-        OverDefinedCache.erase(OI);
+      --NumCachedValues;
 
       // If we removed anything, then we potentially need to update
       // blocks successors too.
       changed = true;
     }
+    if (Entry.OverDefined.empty() && Entry.LatticeElements.empty())
+      eraseBlockEntry(OI);
 
     if (!changed) continue;
 
@@ -1475,6 +1562,13 @@ void LazyValueInfo::releaseMemory() {
 
 void LazyValueInfoWrapperPass::releaseMemory() { Info.releaseMemory(); }
 
+bool LazyValueInfo::invalidate(Function &F, const PreservedAnalyses &PA) {
+  if (!PA.preserved<LazyValueAnalysis>())
+    return true;
+  return DT && !(PA.preserved<DominatorTreeAnalysis>() ||
+                 PA.preservedSet<CFGAnalyses>());
+}
+
 LazyValueInfo LazyValueAnalysis::run(Function &F, FunctionAnalysisManager &FAM) {
   auto &AC = FAM.getResult<AssumptionAnalysis>(F);
   auto &TLI = FAM.getResult<TargetLibraryAnalysis>(F);
@@ -18,6 +18,33 @@
 
 using namespace llvm;
 
+/// \brief Compute, or look up, what SCEV tells about \param I on any
+/// iteration.
+const UnrolledInstAnalyzer::SCEVInfo &
+UnrolledInstAnalyzer::getSCEVInfo(Instruction *I) {
+  auto Inserted = SCEVInfos.insert({I, SCEVInfo()});
+  SCEVInfo &Info = Inserted.first->second;
+  if (!Inserted.second)
+    return Info;
+
+  const SCEV *S = SE.getSCEV(I);
+  if (auto *SC = dyn_cast<SCEVConstant>(S)) {
+    Info.C = SC->getValue();
+    return Info;
+  }
+
+  auto *AR = dyn_cast<SCEVAddRecExpr>(S);
+  if (!AR || AR->getLoop() != L)
+    return Info;
+  Info.AR = AR;
+
+  if (auto *Base = dyn_cast<SCEVUnknown>(SE.getPointerBase(S))) {
+    Info.Base = Base->getValue();
+    Info.Offset = SE.getMinusSCEV(AR, Base);
+  }
+  return Info;
+}
+
 /// \brief Try to simplify instruction \param I using its SCEV expression.
 ///
 /// The idea is that some AddRec expressions become constants, which then
@@ -30,33 +57,40 @@ bool UnrolledInstAnalyzer::simplifyInstWithSCEV(Instruction *I) {
   if (!SE.isSCEVable(I->getType()))
     return false;
 
-  const SCEV *S = SE.getSCEV(I);
-  if (auto *SC = dyn_cast<SCEVConstant>(S)) {
-    SimplifiedValues[I] = SC->getValue();
+  const SCEVInfo &Info = getSCEVInfo(I);
+  if (Info.C) {
+    SimplifiedValues[I] = Info.C;
     return true;
   }
 
-  auto *AR = dyn_cast<SCEVAddRecExpr>(S);
-  if (!AR || AR->getLoop() != L)
+  if (!Info.AR)
     return false;
 
-  const SCEV *ValueAtIteration = AR->evaluateAtIteration(IterationNumber, SE);
+  const SCEV *ValueAtIteration =
+      Info.AR->evaluateAtIteration(IterationNumber, SE);
   // Check if the AddRec expression becomes a constant.
   if (auto *SC = dyn_cast<SCEVConstant>(ValueAtIteration)) {
     SimplifiedValues[I] = SC->getValue();
     return true;
   }
 
-  // Check if the offset from the base address becomes a constant.
-  auto *Base = dyn_cast<SCEVUnknown>(SE.getPointerBase(S));
-  if (!Base)
+  // Check if the offset from the base address becomes a constant. The offset
+  // is normally a recurrence of the loop itself, which is cheaper to evaluate
+  // than subtracting the base from the value at this iteration.
+  if (!Info.Base)
     return false;
-  auto *Offset =
-      dyn_cast<SCEVConstant>(SE.getMinusSCEV(ValueAtIteration, Base));
+  const SCEV *OffsetAtIteration;
+  auto *OffsetAR = dyn_cast<SCEVAddRecExpr>(Info.Offset);
+  if (OffsetAR && OffsetAR->getLoop() == L)
+    OffsetAtIteration = OffsetAR->evaluateAtIteration(IterationNumber, SE);
+  else
+    OffsetAtIteration = SE.getMinusSCEV(ValueAtIteration,
+                                        SE.getUnknown(Info.Base));
+  auto *Offset = dyn_cast<SCEVConstant>(OffsetAtIteration);
   if (!Offset)
     return false;
   SimplifiedAddress Address;
-  Address.Base = Base->getValue();
+  Address.Base = Info.Base;
   Address.Offset = Offset->getValue();
   SimplifiedAddresses[I] = Address;
   return false;
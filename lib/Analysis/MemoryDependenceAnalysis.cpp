@@ -1659,6 +1659,14 @@ void MemoryDependenceResults::verifyRemoved(Instruction *D) const {
 #endif
 }
 
+bool MemoryDependenceResults::invalidate(Function &F,
+                                         const PreservedAnalyses &PA) {
+  return !PA.preserved<MemoryDependenceAnalysis>() ||
+         !PA.preserved<AAManager>() ||
+         !(PA.preserved<DominatorTreeAnalysis>() ||
+           PA.preservedSet<CFGAnalyses>());
+}
+
 char MemoryDependenceAnalysis::PassID;
 
 MemoryDependenceResults
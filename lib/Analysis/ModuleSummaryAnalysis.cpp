@@ -17,6 +17,7 @@
 #include "llvm/Analysis/BlockFrequencyInfoImpl.h"
 #include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/InstIterator.h"
@@ -62,6 +63,93 @@ static void findRefEdges(const User *CurUser, DenseSet<const Value *> &RefEdges,
   }
 }
 
+/// Return the FunctionSummary::AttrKinds given by the IR attributes of \p F.
+static unsigned getFunctionAttrs(const Function &F) {
+  unsigned Attrs = 0;
+  if (F.doesNotAccessMemory())
+    Attrs |= FunctionSummary::ReadNone | FunctionSummary::ReadOnly;
+  else if (F.onlyReadsMemory())
+    Attrs |= FunctionSummary::ReadOnly;
+  if (F.doesNotThrow())
+    Attrs |= FunctionSummary::NoUnwind;
+  if (F.doesNotRecurse())
+    Attrs |= FunctionSummary::NoRecurse;
+  return Attrs;
+}
+
+/// Return true if \p Ptr points to an alloca of the function, or, when
+/// \p AllowConstant is set, to a constant global.
+static bool isLocalMemory(const Value *Ptr, const DataLayout &DL,
+                          bool AllowConstant) {
+  const Value *Obj = GetUnderlyingObject(Ptr, DL);
+  if (isa<AllocaInst>(Obj))
+    return true;
+  if (auto *GV = dyn_cast<GlobalVariable>(Obj))
+    return AllowConstant && GV->isConstant();
+  return false;
+}
+
+/// Return the FunctionSummary::AttrKinds that a call to \p CS does not break,
+/// judging by the attributes of the call and of the callee.
+static unsigned getCallSiteAttrs(ImmutableCallSite CS, const DataLayout &DL) {
+  unsigned Attrs = 0;
+  if (CS.doesNotAccessMemory())
+    Attrs |= FunctionSummary::ReadNone | FunctionSummary::ReadOnly;
+  else if (CS.onlyAccessesArgMemory() &&
+           std::all_of(CS.arg_begin(), CS.arg_end(), [&](const Value *Arg) {
+             return !Arg->getType()->isPointerTy() ||
+                    isLocalMemory(Arg, DL, /*AllowConstant=*/false);
+           }))
+    Attrs |= FunctionSummary::ReadNone | FunctionSummary::ReadOnly;
+  else if (CS.onlyReadsMemory())
+    Attrs |= FunctionSummary::ReadOnly;
+  if (CS.doesNotThrow())
+    Attrs |= FunctionSummary::NoUnwind;
+
+  // Intrinsics don't call back into the program, except the ones that take
+  // the function to call as an operand.
+  const Function *Callee = CS.getCalledFunction();
+  bool IsIntrinsicCall = false;
+  if (Callee && Callee->isIntrinsic()) {
+    switch (Callee->getIntrinsicID()) {
+    case Intrinsic::experimental_gc_statepoint:
+    case Intrinsic::experimental_patchpoint_void:
+    case Intrinsic::experimental_patchpoint_i64:
+      break;
+    default:
+      IsIntrinsicCall = true;
+      break;
+    }
+  }
+  if (IsIntrinsicCall || CS.hasFnAttr(Attribute::NoRecurse))
+    Attrs |= FunctionSummary::NoRecurse;
+  return Attrs;
+}
+
+/// Return the FunctionSummary::AttrKinds that \p I, which is not a call, does
+/// not break. Accesses to the allocas of the function are not observable by
+/// its callers and are ignored, like FunctionAttrs does.
+static unsigned getInstructionAttrs(const Instruction &I,
+                                    const DataLayout &DL) {
+  unsigned Attrs = FunctionSummary::AllAttrs;
+  if (I.mayThrow())
+    Attrs &= ~FunctionSummary::NoUnwind;
+  if (auto *LI = dyn_cast<LoadInst>(&I)) {
+    if (!LI->isVolatile() &&
+        isLocalMemory(LI->getPointerOperand(), DL, /*AllowConstant=*/true))
+      return Attrs;
+  } else if (auto *SI = dyn_cast<StoreInst>(&I)) {
+    if (!SI->isVolatile() &&
+        isLocalMemory(SI->getPointerOperand(), DL, /*AllowConstant=*/false))
+      return Attrs;
+  }
+  if (I.mayWriteToMemory())
+    Attrs &= ~(FunctionSummary::ReadNone | FunctionSummary::ReadOnly);
+  else if (I.mayReadFromMemory())
+    Attrs &= ~FunctionSummary::ReadNone;
+  return Attrs;
+}
+
 void ModuleSummaryIndexBuilder::computeFunctionSummary(
     const Function &F, BlockFrequencyInfo *BFI) {
   // Summary not currently supported for anonymous functions, they must
@@ -74,6 +162,12 @@ void ModuleSummaryIndexBuilder::computeFunctionSummary(
   // counts for all static calls to a given callee.
   DenseMap<const Value *, CalleeInfo> CallGraphEdges;
   DenseSet<const Value *> RefEdges;
+  // The function attributes that hold for the instructions other than the
+  // call graph edges, and for the edges to functions declared in the module.
+  // The thin link combines them with the attributes of the callees.
+  const DataLayout &DL = M->getDataLayout();
+  unsigned BodyAttrs = FunctionSummary::AllAttrs;
+  unsigned DeclCalleeAttrs = FunctionSummary::AllAttrs;
 
   SmallPtrSet<const User *, 8> Visited;
   for (const BasicBlock &BB : F)
@@ -90,14 +184,20 @@ void ModuleSummaryIndexBuilder::computeFunctionSummary(
               M->getValueSymbolTable().lookup(CalledFunction->getName());
           CallGraphEdges[CalleeId] +=
               (ScaledCount ? ScaledCount.getValue() : 0);
-        }
-      }
+          if (CalledFunction->isDeclaration())
+            DeclCalleeAttrs &= getCallSiteAttrs(CS, DL);
+        } else
+          BodyAttrs &= getCallSiteAttrs(CS, DL);
+      } else
+        BodyAttrs &= getInstructionAttrs(I, DL);
       findRefEdges(&I, RefEdges, Visited);
     }
 
   GlobalValueSummary::GVFlags Flags(F);
+  FunctionSummary::FFlags FunFlags(getFunctionAttrs(F), BodyAttrs,
+                                   DeclCalleeAttrs);
   std::unique_ptr<FunctionSummary> FuncSummary =
-      llvm::make_unique<FunctionSummary>(Flags, NumInsts);
+      llvm::make_unique<FunctionSummary>(Flags, NumInsts, FunFlags);
   FuncSummary->addCallGraphEdges(CallGraphEdges);
   FuncSummary->addRefEdges(RefEdges);
   Index->addGlobalValueSummary(F.getName(), std::move(FuncSummary));
@@ -44,6 +44,11 @@ FunctionPass* llvm::createPostDomTree() {
   return new PostDominatorTreeWrapperPass();
 }
 
+bool PostDominatorTree::invalidate(Function &F, const PreservedAnalyses &PA) {
+  return !(PA.preserved<PostDominatorTreeAnalysis>() ||
+           PA.preservedSet<CFGAnalyses>());
+}
+
 char PostDominatorTreeAnalysis::PassID;
 
 PostDominatorTree PostDominatorTreeAnalysis::run(Function &F,
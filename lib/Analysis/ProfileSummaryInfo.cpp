@@ -13,6 +13,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/IR/CallSite.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/ProfileSummary.h"
@@ -63,6 +65,11 @@ void ProfileSummaryInfo::computeSummary() {
   Summary.reset(ProfileSummary::getFromMD(SummaryMD));
 }
 
+bool ProfileSummaryInfo::hasProfileSummary() {
+  computeSummary();
+  return Summary != nullptr;
+}
+
 // Returns true if the function is a hot function. If it returns false, it
 // either means it is not hot or it is unknown whether F is hot or not (for
 // example, no profile data is available).
@@ -125,6 +132,24 @@ bool ProfileSummaryInfo::isColdCount(uint64_t C) {
   return ColdCountThreshold && C <= ColdCountThreshold.getValue();
 }
 
+bool ProfileSummaryInfo::isHotCallSite(const CallSite &CS,
+                                       BlockFrequencyInfo *CallerBFI) {
+  if (!CallerBFI)
+    return false;
+  auto Count =
+      CallerBFI->getBlockProfileCount(CS.getInstruction()->getParent());
+  return Count && isHotCount(*Count);
+}
+
+bool ProfileSummaryInfo::isColdCallSite(const CallSite &CS,
+                                        BlockFrequencyInfo *CallerBFI) {
+  if (!CallerBFI)
+    return false;
+  auto Count =
+      CallerBFI->getBlockProfileCount(CS.getInstruction()->getParent());
+  return Count && isColdCount(*Count);
+}
+
 ProfileSummaryInfo *ProfileSummaryInfoWrapperPass::getPSI(Module &M) {
   if (!PSI)
     PSI.reset(new ProfileSummaryInfo(M));
@@ -103,6 +103,17 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumArithDepthLimited,
+          "Number of add and mul expressions not folded past the depth limit");
+STATISTIC(NumArithOperandLimited,
+          "Number of add and mul expressions not folded past the operand "
+          "limit");
+STATISTIC(NumArithBudgetLimited,
+          "Number of add and mul expressions not folded over budget");
+STATISTIC(NumFunctionsOverBudget,
+          "Number of functions that used up their folding budget");
+STATISTIC(NumValuesOverBudget,
+          "Number of values left unknown in functions over budget");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -111,6 +122,31 @@ MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
                                  "derived loop"),
                         cl::init(100));
 
+static cl::opt<unsigned>
+MaxArithDepth("scalar-evolution-max-arith-depth", cl::Hidden,
+              cl::desc("Maximum depth of nested add and mul expressions "
+                       "that are canonicalized"),
+              cl::init(32));
+
+static cl::opt<unsigned>
+MaxAddOperands("scalar-evolution-max-add-operands", cl::Hidden,
+               cl::desc("Maximum number of operands of an add expression "
+                        "whose operands are folded together"),
+               cl::init(128));
+
+static cl::opt<unsigned>
+MaxMulOperands("scalar-evolution-max-mul-operands", cl::Hidden,
+               cl::desc("Maximum number of operands of a mul expression "
+                        "whose operands are folded together"),
+               cl::init(64));
+
+static cl::opt<unsigned>
+ArithFunctionBudget("scalar-evolution-arith-budget", cl::Hidden,
+                    cl::desc("Maximum number of add and mul expressions "
+                             "folded in a function, after which the values "
+                             "not analyzed yet are left unknown"),
+                    cl::init(500000));
+
 // FIXME: Enable this with EXPENSIVE_CHECKS when the test suite is clean.
 static cl::opt<bool>
 VerifySCEV("verify-scev",
@@ -2059,6 +2095,18 @@ const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
     if (Ops.size() == 1) return Ops[0];
   }
 
+  // Give up on canonicalizing deeply nested expressions and the expressions
+  // of functions over budget.
+  if (ArithDepth > MaxArithDepth) {
+    ++NumArithDepthLimited;
+    return getOrCreateAddExpr(Ops, Flags);
+  }
+  if (!consumeArithBudget()) {
+    ++NumArithBudgetLimited;
+    return getOrCreateAddExpr(Ops, Flags);
+  }
+  SaveAndRestore<unsigned> NestArith(ArithDepth, ArithDepth + 1);
+
   // Okay, check to see if the same value occurs in the operand list more than
   // once.  If so, merge them together into an multiply expression.  Since we
   // sorted the list, these values are required to be adjacent.
@@ -2159,6 +2207,12 @@ const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
       return getAddExpr(Ops);
   }
 
+  // The folds below are quadratic in the number of operands.
+  if (Ops.size() > MaxAddOperands) {
+    ++NumArithOperandLimited;
+    return getOrCreateAddExpr(Ops, Flags);
+  }
+
   // Skip over the add expression until we get to a multiply.
   while (Idx < Ops.size() && Ops[Idx]->getSCEVType() < scMulExpr)
     ++Idx;
@@ -2359,8 +2413,14 @@ const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
     // next one.
   }
 
-  // Okay, it looks like we really DO need an add expr.  Check to see if we
-  // already have one, otherwise create a new one.
+  // Okay, it looks like we really DO need an add expr.
+  return getOrCreateAddExpr(Ops, Flags);
+}
+
+const SCEV *
+ScalarEvolution::getOrCreateAddExpr(SmallVectorImpl<const SCEV *> &Ops,
+                                    SCEV::NoWrapFlags Flags) {
+  // Check to see if we already have one, otherwise create a new one.
   FoldingSetNodeID ID;
   ID.AddInteger(scAddExpr);
   for (unsigned i = 0, e = Ops.size(); i != e; ++i)
@@ -2379,6 +2439,17 @@ const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
   return S;
 }
 
+bool ScalarEvolution::consumeArithBudget() {
+  if (!ArithBudget)
+    return false;
+  if (--ArithBudget == 0) {
+    ++NumFunctionsOverBudget;
+    DEBUG(dbgs() << "SCEV: " << F.getName()
+                 << " used up its folding budget\n");
+  }
+  return true;
+}
+
 static uint64_t umul_ov(uint64_t i, uint64_t j, bool &Overflow) {
   uint64_t k = i*j;
   if (j > 1 && k / j != i) Overflow = true;
@@ -2448,6 +2519,18 @@ const SCEV *ScalarEvolution::getMulExpr(SmallVectorImpl<const SCEV *> &Ops,
 
   Flags = StrengthenNoWrapFlags(this, scMulExpr, Ops, Flags);
 
+  // Give up on canonicalizing deeply nested expressions and the expressions
+  // of functions over budget.
+  if (ArithDepth > MaxArithDepth) {
+    ++NumArithDepthLimited;
+    return getOrCreateMulExpr(Ops, Flags);
+  }
+  if (!consumeArithBudget()) {
+    ++NumArithBudgetLimited;
+    return getOrCreateMulExpr(Ops, Flags);
+  }
+  SaveAndRestore<unsigned> NestArith(ArithDepth, ArithDepth + 1);
+
   // If there are any constants, fold them together.
   unsigned Idx = 0;
   if (const SCEVConstant *LHSC = dyn_cast<SCEVConstant>(Ops[0])) {
@@ -2532,6 +2615,12 @@ const SCEV *ScalarEvolution::getMulExpr(SmallVectorImpl<const SCEV *> &Ops,
       return getMulExpr(Ops);
   }
 
+  // The folds below are quadratic in the number of operands.
+  if (Ops.size() > MaxMulOperands) {
+    ++NumArithOperandLimited;
+    return getOrCreateMulExpr(Ops, Flags);
+  }
+
   // If there are any add recurrences in the operands list, see if any other
   // added values are loop invariant.  If so, we can fold them into the
   // recurrence.
@@ -2649,8 +2738,14 @@ const SCEV *ScalarEvolution::getMulExpr(SmallVectorImpl<const SCEV *> &Ops,
     // next one.
   }
 
-  // Okay, it looks like we really DO need an mul expr.  Check to see if we
-  // already have one, otherwise create a new one.
+  // Okay, it looks like we really DO need an mul expr.
+  return getOrCreateMulExpr(Ops, Flags);
+}
+
+const SCEV *
+ScalarEvolution::getOrCreateMulExpr(SmallVectorImpl<const SCEV *> &Ops,
+                                    SCEV::NoWrapFlags Flags) {
+  // Check to see if we already have one, otherwise create a new one.
   FoldingSetNodeID ID;
   ID.AddInteger(scMulExpr);
   for (unsigned i = 0, e = Ops.size(); i != e; ++i)
@@ -4938,6 +5033,12 @@ const SCEV *ScalarEvolution::createSCEV(Value *V) {
     // analysis depends on.
     if (!DT.isReachableFromEntry(I->getParent()))
       return getUnknown(V);
+    // Don't analyze any more instructions once the function used up its
+    // budget.
+    if (!ArithBudget) {
+      ++NumValuesOverBudget;
+      return getUnknown(V);
+    }
   } else if (ConstantInt *CI = dyn_cast<ConstantInt>(V))
     return getConstant(CI);
   else if (isa<ConstantPointerNull>(V))
@@ -9464,8 +9565,8 @@ ScalarEvolution::ScalarEvolution(Function &F, TargetLibraryInfo &TLI,
     : F(F), TLI(TLI), AC(AC), DT(DT), LI(LI),
       CouldNotCompute(new SCEVCouldNotCompute()),
       WalkingBEDominatingConds(false), ProvingSplitPredicate(false),
-      ValuesAtScopes(64), LoopDispositions(64), BlockDispositions(64),
-      FirstUnknown(nullptr) {
+      ArithDepth(0), ArithBudget(ArithFunctionBudget), ValuesAtScopes(64),
+      LoopDispositions(64), BlockDispositions(64), FirstUnknown(nullptr) {
 
   // To use guards for proving predicates, we need to scan every instruction in
   // relevant basic blocks, and not just terminators.  Doing this is a waste of
@@ -9487,6 +9588,7 @@ ScalarEvolution::ScalarEvolution(ScalarEvolution &&Arg)
       LI(Arg.LI), CouldNotCompute(std::move(Arg.CouldNotCompute)),
       ValueExprMap(std::move(Arg.ValueExprMap)),
       WalkingBEDominatingConds(false), ProvingSplitPredicate(false),
+      ArithDepth(0), ArithBudget(Arg.ArithBudget),
       BackedgeTakenCounts(std::move(Arg.BackedgeTakenCounts)),
       PredicatedBackedgeTakenCounts(
           std::move(Arg.PredicatedBackedgeTakenCounts)),
@@ -10001,6 +10103,13 @@ void ScalarEvolution::verify() const {
   // TODO: Verify more things.
 }
 
+bool ScalarEvolution::invalidate(Function &F, const PreservedAnalyses &PA) {
+  bool CFGPreserved = PA.preservedSet<CFGAnalyses>();
+  return !PA.preserved<ScalarEvolutionAnalysis>() ||
+         !(CFGPreserved || PA.preserved<DominatorTreeAnalysis>()) ||
+         !(CFGPreserved || PA.preserved<LoopAnalysis>());
+}
+
 char ScalarEvolutionAnalysis::PassID;
 
 ScalarEvolution ScalarEvolutionAnalysis::run(Function &F,
@@ -17,6 +17,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/InstructionSimplify.h"
+#include "llvm/Analysis/KnownBitsCache.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/Loads.h"
 #include "llvm/Analysis/LoopInfo.h"
@@ -70,6 +71,8 @@ struct Query {
   AssumptionCache *AC;
   const Instruction *CxtI;
   const DominatorTree *DT;
+  /// The cache of the results that don't depend on the context, if any.
+  KnownBitsCache *KBC;
 
   /// Set of assumptions that should be excluded from further queries.
   /// This is because of the potential for mutual recursion to cause
@@ -84,11 +87,12 @@ struct Query {
   unsigned NumExcluded;
 
   Query(const DataLayout &DL, AssumptionCache *AC, const Instruction *CxtI,
-        const DominatorTree *DT)
-      : DL(DL), AC(AC), CxtI(CxtI), DT(DT), NumExcluded(0) {}
+        const DominatorTree *DT, KnownBitsCache *KBC = nullptr)
+      : DL(DL), AC(AC), CxtI(CxtI), DT(DT), KBC(KBC), NumExcluded(0) {}
 
   Query(const Query &Q, const Value *NewExcl)
-      : DL(Q.DL), AC(Q.AC), CxtI(Q.CxtI), DT(Q.DT), NumExcluded(Q.NumExcluded) {
+      : DL(Q.DL), AC(Q.AC), CxtI(Q.CxtI), DT(Q.DT), KBC(Q.KBC),
+        NumExcluded(Q.NumExcluded) {
     Excluded = Q.Excluded;
     Excluded[NumExcluded++] = NewExcl;
     assert(NumExcluded <= Excluded.size());
@@ -119,15 +123,121 @@ static const Instruction *safeCxtI(const Value *V, const Instruction *CxtI) {
   return nullptr;
 }
 
+/// Return the cache that may hold the result of a query about \p V, if any.
+/// Only the results of instructions that don't depend on an assumption, and
+/// so on the context instruction, are cached.
+static KnownBitsCache *getKnownBitsCache(const Value *V, const Query &Q) {
+  if (!Q.KBC || !isa<Instruction>(V) || Q.NumExcluded != 0)
+    return nullptr;
+  if (Q.AC && Q.CxtI && !Q.AC->assumptions().empty())
+    return nullptr;
+  return Q.KBC;
+}
+
+void KnownBitsCache::ValueHandle::deleted() {
+  assert(Cache && "ValueHandle called with a null KnownBitsCache!");
+  Cache->Entries.erase(Cache->Entries.find_as(getValPtr()));
+  // this now dangles!
+}
+
+void KnownBitsCache::ValueHandle::allUsesReplacedWith(Value *) {
+  assert(Cache && "ValueHandle called with a null KnownBitsCache!");
+  Cache->invalidate(getValPtr());
+  // this may dangle now.
+}
+
+KnownBitsCache::Entry &KnownBitsCache::getEntry(const Value *V) {
+  Value *Key = const_cast<Value *>(V);
+  auto I = Entries.find_as(Key);
+  if (I != Entries.end())
+    return I->second;
+  return Entries.insert(std::make_pair(ValueHandle(Key, this), Entry()))
+      .first->second;
+}
+
+bool KnownBitsCache::lookupKnownBits(const Value *V, unsigned Depth,
+                                     APInt &KnownZero, APInt &KnownOne) const {
+  auto I = Entries.find_as(const_cast<Value *>(V));
+  if (I == Entries.end() || I->second.KnownBitsDepth > Depth)
+    return false;
+  KnownZero = I->second.KnownZero;
+  KnownOne = I->second.KnownOne;
+  return true;
+}
+
+void KnownBitsCache::insertKnownBits(const Value *V, unsigned Depth,
+                                     const APInt &KnownZero,
+                                     const APInt &KnownOne) {
+  Entry &E = getEntry(V);
+  if (E.KnownBitsDepth <= Depth)
+    return;
+  E.KnownZero = KnownZero;
+  E.KnownOne = KnownOne;
+  E.KnownBitsDepth = Depth;
+}
+
+bool KnownBitsCache::lookupNumSignBits(const Value *V, unsigned Depth,
+                                       unsigned &NumSignBits) const {
+  auto I = Entries.find_as(const_cast<Value *>(V));
+  if (I == Entries.end() || I->second.NumSignBitsDepth > Depth)
+    return false;
+  NumSignBits = I->second.NumSignBits;
+  return true;
+}
+
+void KnownBitsCache::insertNumSignBits(const Value *V, unsigned Depth,
+                                       unsigned NumSignBits) {
+  Entry &E = getEntry(V);
+  if (E.NumSignBitsDepth <= Depth)
+    return;
+  E.NumSignBits = NumSignBits;
+  E.NumSignBitsDepth = Depth;
+}
+
+void KnownBitsCache::invalidate(const Value *V) {
+  // A query looks at the values up to MaxDepth operands away, and reads the
+  // cached results of the instructions it finds, which were derived the same
+  // way. So forget the cached users of V, and the users up to MaxDepth uses
+  // away from V or from any of them, which covers the users reached through
+  // uncached values.
+  SmallDenseMap<const Value *, unsigned, 16> Distances;
+  SmallVector<std::pair<const Value *, unsigned>, 16> Worklist;
+  Worklist.push_back(std::make_pair(V, 0u));
+  Distances[V] = 0;
+  while (!Worklist.empty()) {
+    const Value *Cur = Worklist.back().first;
+    unsigned Distance = Worklist.pop_back_val().second;
+    auto I = Entries.find_as(const_cast<Value *>(Cur));
+    if (I != Entries.end()) {
+      Entries.erase(I);
+      Distance = 0;
+    }
+    if (Distance == MaxDepth)
+      continue;
+
+    for (const User *U : Cur->users()) {
+      if (!isa<Instruction>(U))
+        continue;
+      auto Inserted = Distances.insert(std::make_pair(U, Distance + 1));
+      if (!Inserted.second) {
+        if (Inserted.first->second <= Distance + 1)
+          continue;
+        Inserted.first->second = Distance + 1;
+      }
+      Worklist.push_back(std::make_pair(U, Distance + 1));
+    }
+  }
+}
+
 static void computeKnownBits(Value *V, APInt &KnownZero, APInt &KnownOne,
                              unsigned Depth, const Query &Q);
 
 void llvm::computeKnownBits(Value *V, APInt &KnownZero, APInt &KnownOne,
                             const DataLayout &DL, unsigned Depth,
                             AssumptionCache *AC, const Instruction *CxtI,
-                            const DominatorTree *DT) {
+                            const DominatorTree *DT, KnownBitsCache *KBC) {
   ::computeKnownBits(V, KnownZero, KnownOne, Depth,
-                     Query(DL, AC, safeCxtI(V, CxtI), DT));
+                     Query(DL, AC, safeCxtI(V, CxtI), DT, KBC));
 }
 
 bool llvm::haveNoCommonBitsSet(Value *LHS, Value *RHS, const DataLayout &DL,
@@ -151,9 +261,9 @@ static void ComputeSignBit(Value *V, bool &KnownZero, bool &KnownOne,
 void llvm::ComputeSignBit(Value *V, bool &KnownZero, bool &KnownOne,
                           const DataLayout &DL, unsigned Depth,
                           AssumptionCache *AC, const Instruction *CxtI,
-                          const DominatorTree *DT) {
+                          const DominatorTree *DT, KnownBitsCache *KBC) {
   ::ComputeSignBit(V, KnownZero, KnownOne, Depth,
-                   Query(DL, AC, safeCxtI(V, CxtI), DT));
+                   Query(DL, AC, safeCxtI(V, CxtI), DT, KBC));
 }
 
 static bool isKnownToBeAPowerOfTwo(Value *V, bool OrZero, unsigned Depth,
@@ -218,9 +328,10 @@ static bool MaskedValueIsZero(Value *V, const APInt &Mask, unsigned Depth,
 
 bool llvm::MaskedValueIsZero(Value *V, const APInt &Mask, const DataLayout &DL,
                              unsigned Depth, AssumptionCache *AC,
-                             const Instruction *CxtI, const DominatorTree *DT) {
+                             const Instruction *CxtI, const DominatorTree *DT,
+                             KnownBitsCache *KBC) {
   return ::MaskedValueIsZero(V, Mask, Depth,
-                             Query(DL, AC, safeCxtI(V, CxtI), DT));
+                             Query(DL, AC, safeCxtI(V, CxtI), DT, KBC));
 }
 
 static unsigned ComputeNumSignBits(Value *V, unsigned Depth, const Query &Q);
@@ -228,8 +339,10 @@ static unsigned ComputeNumSignBits(Value *V, unsigned Depth, const Query &Q);
 unsigned llvm::ComputeNumSignBits(Value *V, const DataLayout &DL,
                                   unsigned Depth, AssumptionCache *AC,
                                   const Instruction *CxtI,
-                                  const DominatorTree *DT) {
-  return ::ComputeNumSignBits(V, Depth, Query(DL, AC, safeCxtI(V, CxtI), DT));
+                                  const DominatorTree *DT,
+                                  KnownBitsCache *KBC) {
+  return ::ComputeNumSignBits(V, Depth,
+                              Query(DL, AC, safeCxtI(V, CxtI), DT, KBC));
 }
 
 static void computeKnownBitsAddSub(bool Add, Value *Op0, Value *Op1, bool NSW,
@@ -1438,6 +1551,10 @@ void computeKnownBits(Value *V, APInt &KnownZero, APInt &KnownOne,
   if (Depth == MaxDepth)
     return;
 
+  KnownBitsCache *KBC = getKnownBitsCache(V, Q);
+  if (KBC && KBC->lookupKnownBits(V, Depth, KnownZero, KnownOne))
+    return;
+
   // A weak GlobalAlias is totally unknown. A non-weak GlobalAlias has
   // the bits of its aliasee.
   if (GlobalAlias *GA = dyn_cast<GlobalAlias>(V)) {
@@ -1463,6 +1580,8 @@ void computeKnownBits(Value *V, APInt &KnownZero, APInt &KnownOne,
   computeKnownBitsFromAssume(V, KnownZero, KnownOne, Depth, Q);
 
   assert((KnownZero & KnownOne) == 0 && "Bits known to be one AND zero?");
+  if (KBC)
+    KBC->insertKnownBits(V, Depth, KnownZero, KnownOne);
 }
 
 /// Determine whether the sign bit is known to be zero or one.
@@ -1951,7 +2070,8 @@ static unsigned computeNumSignBitsVectorConstant(Value *V, unsigned TyBits) {
 /// after an "ashr X, 2", we know that the top 3 bits are all equal to each
 /// other, so we return 3. For vectors, return the number of sign bits for the
 /// vector element with the mininum number of known sign bits.
-unsigned ComputeNumSignBits(Value *V, unsigned Depth, const Query &Q) {
+static unsigned computeNumSignBitsImpl(Value *V, unsigned Depth,
+                                       const Query &Q) {
   unsigned TyBits = Q.DL.getTypeSizeInBits(V->getType()->getScalarType());
   unsigned Tmp, Tmp2;
   unsigned FirstAnswer = 1;
@@ -2167,6 +2287,17 @@ unsigned ComputeNumSignBits(Value *V, unsigned Depth, const Query &Q) {
   return FirstAnswer;
 }
 
+unsigned ComputeNumSignBits(Value *V, unsigned Depth, const Query &Q) {
+  KnownBitsCache *KBC = Depth < MaxDepth ? getKnownBitsCache(V, Q) : nullptr;
+  unsigned NumSignBits;
+  if (KBC && KBC->lookupNumSignBits(V, Depth, NumSignBits))
+    return NumSignBits;
+  NumSignBits = computeNumSignBitsImpl(V, Depth, Q);
+  if (KBC)
+    KBC->insertNumSignBits(V, Depth, NumSignBits);
+  return NumSignBits;
+}
+
 /// This function computes the integer multiple of Base that equals V.
 /// If successful, it returns true and returns the multiple in
 /// Multiple. If unsuccessful, it returns false. It looks
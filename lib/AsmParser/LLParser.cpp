@@ -37,6 +37,18 @@
 #include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
+/// Return the entry of a forward reference table that was referenced first in
+/// the file: the tables are hash maps, the diagnostics shouldn't depend on
+/// their iteration order.
+template <typename MapTy>
+static typename MapTy::const_iterator getFirstForwardRef(const MapTy &Map) {
+  auto First = Map.begin();
+  for (auto I = Map.begin(), E = Map.end(); I != E; ++I)
+    if (I->second.second.getPointer() < First->second.second.getPointer())
+      First = I;
+  return First;
+}
+
 static std::string getTypeString(Type *T) {
   std::string Result;
   raw_string_ostream Tmp(Result);
@@ -184,20 +196,23 @@ bool LLParser::ValidateEndOfModule() {
                  "use of undefined comdat '$" +
                      ForwardRefComdats.begin()->first + "'");
 
-  if (!ForwardRefVals.empty())
-    return Error(ForwardRefVals.begin()->second.second,
-                 "use of undefined value '@" + ForwardRefVals.begin()->first +
-                 "'");
+  if (!ForwardRefVals.empty()) {
+    auto I = getFirstForwardRef(ForwardRefVals);
+    return Error(I->second.second,
+                 "use of undefined value '@" + I->getKey() + "'");
+  }
 
-  if (!ForwardRefValIDs.empty())
-    return Error(ForwardRefValIDs.begin()->second.second,
-                 "use of undefined value '@" +
-                 Twine(ForwardRefValIDs.begin()->first) + "'");
+  if (!ForwardRefValIDs.empty()) {
+    auto I = getFirstForwardRef(ForwardRefValIDs);
+    return Error(I->second.second,
+                 "use of undefined value '@" + Twine(I->first) + "'");
+  }
 
-  if (!ForwardRefMDNodes.empty())
-    return Error(ForwardRefMDNodes.begin()->second.second,
-                 "use of undefined metadata '!" +
-                 Twine(ForwardRefMDNodes.begin()->first) + "'");
+  if (!ForwardRefMDNodes.empty()) {
+    auto I = getFirstForwardRef(ForwardRefMDNodes);
+    return Error(I->second.second,
+                 "use of undefined metadata '!" + Twine(I->first) + "'");
+  }
 
   // Resolve metadata cycles.
   for (auto &N : NumberedMetadata) {
@@ -2467,14 +2482,16 @@ LLParser::PerFunctionState::~PerFunctionState() {
 }
 
 bool LLParser::PerFunctionState::FinishFunction() {
-  if (!ForwardRefVals.empty())
-    return P.Error(ForwardRefVals.begin()->second.second,
-                   "use of undefined value '%" + ForwardRefVals.begin()->first +
-                   "'");
-  if (!ForwardRefValIDs.empty())
-    return P.Error(ForwardRefValIDs.begin()->second.second,
-                   "use of undefined value '%" +
-                   Twine(ForwardRefValIDs.begin()->first) + "'");
+  if (!ForwardRefVals.empty()) {
+    auto I = getFirstForwardRef(ForwardRefVals);
+    return P.Error(I->second.second,
+                   "use of undefined value '%" + I->getKey() + "'");
+  }
+  if (!ForwardRefValIDs.empty()) {
+    auto I = getFirstForwardRef(ForwardRefValIDs);
+    return P.Error(I->second.second,
+                   "use of undefined value '%" + Twine(I->first) + "'");
+  }
   return false;
 }
 
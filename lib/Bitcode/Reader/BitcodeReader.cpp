@@ -727,6 +727,16 @@ static GlobalValueSummary::GVFlags getDecodedGVSummaryFlags(uint64_t RawFlags,
   return GlobalValueSummary::GVFlags(Linkage, HasSection);
 }
 
+// Decode the function attribute flags in the summary
+static FunctionSummary::FFlags getDecodedFFlags(uint64_t RawFlags) {
+  unsigned Attrs = RawFlags & 0xF; // 4 bits
+  RawFlags = RawFlags >> 4;
+  unsigned BodyAttrs = RawFlags & 0xF; // 4 bits
+  RawFlags = RawFlags >> 4;
+  unsigned DeclCalleeAttrs = RawFlags & 0xF; // 4 bits
+  return FunctionSummary::FFlags(Attrs, BodyAttrs, DeclCalleeAttrs);
+}
+
 static GlobalValue::VisibilityTypes getDecodedVisibility(unsigned Val) {
   switch (Val) {
   default: // Map unknown visibilities to default.
@@ -2156,7 +2166,7 @@ std::error_code BitcodeReader::parseMetadata(bool ModuleLevel) {
         if (auto *SPs = dyn_cast_or_null<MDTuple>(CU_SP.second))
           for (auto &Op : SPs->operands())
             if (auto *SP = dyn_cast_or_null<MDNode>(Op))
-              SP->replaceOperandWith(7, CU_SP.first);
+              SP->replaceOperandWith(6, CU_SP.first);
 
       MetadataList.tryToResolveCycles();
       Placeholders.flush(MetadataList);
@@ -3396,6 +3406,11 @@ std::error_code BitcodeReader::rememberAndSkipMetadata() {
   return std::error_code();
 }
 
+/// The deferred blocks are parsed whole. Loading only the nodes some functions
+/// reference would need an index of record offsets in the bitcode, but it
+/// wouldn't save anything for its main client: FunctionImport materializes
+/// and upgrades all the metadata of a source module before it selects the
+/// functions to import, and those walk everything reachable from llvm.dbg.cu.
 std::error_code BitcodeReader::materializeMetadata() {
   for (uint64_t BitPos : DeferredMetadataInfo) {
     // Move the bit stream to the saved position.
@@ -5649,6 +5664,14 @@ std::error_code BitcodeReader::materializeModule() {
 
   // Iterate over the module, deserializing any functions that are still on
   // disk.
+  //
+  // The bodies are parsed one at a time even though DeferredFunctionInfo gives
+  // the offset of each of them. Parsing a body creates constants, types and
+  // metadata that are uniqued in the LLVMContext and adds uses to the globals
+  // of the module, none of which can be done concurrently. It also goes through
+  // the module-level ValueList and MetadataList and a single bitstream cursor.
+  // Clients that want to use several threads should read independent modules
+  // in separate contexts.
   for (Function &F : *TheModule) {
     if (std::error_code EC = materialize(&F))
       return EC;
@@ -6039,8 +6062,9 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
       return error("Invalid Summary Block: version expected");
   }
   const uint64_t Version = Record[0];
-  if (Version != 1)
-    return error("Invalid summary version " + Twine(Version) + ", 1 expected");
+  if (Version < 1 || Version > 2)
+    return error("Invalid summary version " + Twine(Version) +
+                 ", 1 or 2 expected");
   Record.clear();
 
   // Keep around the last seen summary to be used when we see an optional
@@ -6083,20 +6107,27 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
     switch (BitCode) {
     default: // Default behavior: ignore.
       break;
-    // FS_PERMODULE: [valueid, flags, instcount, numrefs, numrefs x valueid,
-    //                n x (valueid, callsitecount)]
-    // FS_PERMODULE_PROFILE: [valueid, flags, instcount, numrefs,
+    // FS_PERMODULE: [valueid, flags, instcount, fflags, numrefs,
+    //                numrefs x valueid, n x (valueid, callsitecount)]
+    // FS_PERMODULE_PROFILE: [valueid, flags, instcount, fflags, numrefs,
     //                        numrefs x valueid,
     //                        n x (valueid, callsitecount, profilecount)]
+    // The fflags field is only present from version 2 on.
     case bitc::FS_PERMODULE:
     case bitc::FS_PERMODULE_PROFILE: {
       unsigned ValueID = Record[0];
       uint64_t RawFlags = Record[1];
       unsigned InstCount = Record[2];
-      unsigned NumRefs = Record[3];
+      unsigned RefListStartIndex = 4;
+      FunctionSummary::FFlags FunFlags;
+      if (Version >= 2) {
+        FunFlags = getDecodedFFlags(Record[3]);
+        ++RefListStartIndex;
+      }
+      unsigned NumRefs = Record[RefListStartIndex - 1];
       auto Flags = getDecodedGVSummaryFlags(RawFlags, Version);
       std::unique_ptr<FunctionSummary> FS =
-          llvm::make_unique<FunctionSummary>(Flags, InstCount);
+          llvm::make_unique<FunctionSummary>(Flags, InstCount, FunFlags);
       // The module path string ref set in the summary must be owned by the
       // index's module string table. Since we don't have a module path
       // string table section in the per-module index, we create a single
@@ -6104,11 +6135,11 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
       // ownership.
       FS->setModulePath(
           TheIndex->addModulePath(Buffer->getBufferIdentifier(), 0)->first());
-      static int RefListStartIndex = 4;
-      int CallGraphEdgeStartIndex = RefListStartIndex + NumRefs;
+      unsigned CallGraphEdgeStartIndex = RefListStartIndex + NumRefs;
       assert(Record.size() >= RefListStartIndex + NumRefs &&
              "Record size inconsistent with number of references");
-      for (unsigned I = 4, E = CallGraphEdgeStartIndex; I != E; ++I) {
+      for (unsigned I = RefListStartIndex, E = CallGraphEdgeStartIndex; I != E;
+           ++I) {
         unsigned RefValueId = Record[I];
         GlobalValue::GUID RefGUID = getGUIDFromValueId(RefValueId).first;
         FS->addRefEdge(RefGUID);
@@ -6175,25 +6206,31 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
       TheIndex->addGlobalValueSummary(GUID.first, std::move(FS));
       break;
     }
-    // FS_COMBINED: [valueid, modid, flags, instcount, numrefs,
+    // FS_COMBINED: [valueid, modid, flags, instcount, fflags, numrefs,
     //               numrefs x valueid, n x (valueid, callsitecount)]
-    // FS_COMBINED_PROFILE: [valueid, modid, flags, instcount, numrefs,
+    // FS_COMBINED_PROFILE: [valueid, modid, flags, instcount, fflags, numrefs,
     //                       numrefs x valueid,
     //                       n x (valueid, callsitecount, profilecount)]
+    // The fflags field is only present from version 2 on.
     case bitc::FS_COMBINED:
     case bitc::FS_COMBINED_PROFILE: {
       unsigned ValueID = Record[0];
       uint64_t ModuleId = Record[1];
       uint64_t RawFlags = Record[2];
       unsigned InstCount = Record[3];
-      unsigned NumRefs = Record[4];
+      unsigned RefListStartIndex = 5;
+      FunctionSummary::FFlags FunFlags;
+      if (Version >= 2) {
+        FunFlags = getDecodedFFlags(Record[4]);
+        ++RefListStartIndex;
+      }
+      unsigned NumRefs = Record[RefListStartIndex - 1];
       auto Flags = getDecodedGVSummaryFlags(RawFlags, Version);
       std::unique_ptr<FunctionSummary> FS =
-          llvm::make_unique<FunctionSummary>(Flags, InstCount);
+          llvm::make_unique<FunctionSummary>(Flags, InstCount, FunFlags);
       LastSeenSummary = FS.get();
       FS->setModulePath(ModuleIdMap[ModuleId]);
-      static int RefListStartIndex = 5;
-      int CallGraphEdgeStartIndex = RefListStartIndex + NumRefs;
+      unsigned CallGraphEdgeStartIndex = RefListStartIndex + NumRefs;
       assert(Record.size() >= RefListStartIndex + NumRefs &&
              "Record size inconsistent with number of references");
       for (unsigned I = RefListStartIndex, E = CallGraphEdgeStartIndex; I != E;
@@ -6556,6 +6593,67 @@ std::string llvm::getBitcodeProducerString(MemoryBufferRef Buffer,
   return ProducerString.get();
 }
 
+ErrorOr<bool>
+llvm::readBitcodeSymbolTable(MemoryBufferRef Buffer,
+                             std::vector<BitcodeSymbol> &Symbols) {
+  const unsigned char *BufPtr = (const unsigned char *)Buffer.getBufferStart();
+  const unsigned char *BufEnd = BufPtr + Buffer.getBufferSize();
+
+  if (Buffer.getBufferSize() & 3)
+    return BitcodeError::InvalidBitcodeSignature;
+  if (isBitcodeWrapper(BufPtr, BufEnd))
+    if (SkipBitcodeWrapperHeader(BufPtr, BufEnd, true))
+      return BitcodeError::InvalidBitcodeSignature;
+
+  BitstreamReader StreamFile(BufPtr, BufEnd);
+  BitstreamCursor Stream(StreamFile);
+  if (!hasValidBitcodeHeader(Stream))
+    return BitcodeError::InvalidBitcodeSignature;
+
+  // The symbol table follows the module block, so skip over every top-level
+  // block until we find it.
+  while (!Stream.AtEndOfStream()) {
+    BitstreamEntry Entry =
+        Stream.advance(BitstreamCursor::AF_DontAutoprocessAbbrevs);
+    if (Entry.Kind != BitstreamEntry::SubBlock)
+      return BitcodeError::CorruptedBitcode;
+
+    if (Entry.ID != bitc::SYMTAB_BLOCK_ID) {
+      if (Stream.SkipBlock())
+        return BitcodeError::CorruptedBitcode;
+      continue;
+    }
+
+    if (Stream.EnterSubBlock(bitc::SYMTAB_BLOCK_ID))
+      return BitcodeError::CorruptedBitcode;
+
+    SmallVector<uint64_t, 1> Record;
+    while (1) {
+      Entry = Stream.advanceSkippingSubblocks();
+      switch (Entry.Kind) {
+      case BitstreamEntry::SubBlock: // Handled for us already.
+      case BitstreamEntry::Error:
+        return BitcodeError::CorruptedBitcode;
+      case BitstreamEntry::EndBlock:
+        return true;
+      case BitstreamEntry::Record:
+        break;
+      }
+
+      Record.clear();
+      StringRef Blob;
+      unsigned Code = Stream.readRecord(Entry.ID, Record, &Blob);
+      if (Code != bitc::SYMTAB_CODE_ENTRY)
+        continue;
+      // SYMTAB_CODE_ENTRY: [flags, namechar x N]
+      if (Record.size() != 1)
+        return BitcodeError::CorruptedBitcode;
+      Symbols.push_back({Blob, uint32_t(Record[0])});
+    }
+  }
+  return false;
+}
+
 // Parse the specified bitcode buffer, returning the function info index.
 ErrorOr<std::unique_ptr<ModuleSummaryIndex>> llvm::getModuleSummaryIndex(
     MemoryBufferRef Buffer,
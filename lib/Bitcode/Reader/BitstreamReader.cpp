@@ -224,6 +224,13 @@ unsigned BitstreamCursor::readRecord(unsigned AbbrevID,
         report_fatal_error(
             "Array element type has to be an encoding of a type");
 
+      // Each element takes at least one bit, so a count that fits in the
+      // rest of the buffer is safe to reserve for.
+      ArrayRef<uint8_t> Buffer = getBitStreamReader()->getBuffer();
+      if (!Buffer.empty() &&
+          NumElts <= Buffer.size() * 8 - GetCurrentBitNo())
+        Vals.reserve(Vals.size() + NumElts);
+
       // Read all the elements.
       switch (EltEnc.getEncoding()) {
       default:
@@ -233,6 +240,13 @@ unsigned BitstreamCursor::readRecord(unsigned AbbrevID,
           Vals.push_back(Read((unsigned)EltEnc.getEncodingData()));
         break;
       case BitCodeAbbrevOp::VBR:
+        // VBR6 is what the writer uses for most arrays. Reading it with a
+        // constant width lets ReadVBR64 fold its masks.
+        if (EltEnc.getEncodingData() == 6) {
+          for (; NumElts; --NumElts)
+            Vals.push_back(ReadVBR64(6));
+          break;
+        }
         for (; NumElts; --NumElts)
           Vals.push_back(ReadVBR64((unsigned)EltEnc.getEncodingData()));
         break;
@@ -271,8 +285,8 @@ unsigned BitstreamCursor::readRecord(unsigned AbbrevID,
       *Blob = StringRef(Ptr, NumElts);
     } else {
       // Otherwise, unpack into Vals with zero extension.
-      for (; NumElts; --NumElts)
-        Vals.push_back((unsigned char)*Ptr++);
+      auto *UPtr = reinterpret_cast<const unsigned char *>(Ptr);
+      Vals.append(UPtr, UPtr + NumElts);
     }
   }
 
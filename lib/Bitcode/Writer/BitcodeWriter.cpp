@@ -24,10 +24,12 @@
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/UseListOrder.h"
 #include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Program.h"
@@ -37,6 +39,18 @@
 #include <map>
 using namespace llvm;
 
+static cl::opt<unsigned>
+    FlushThreshold("bitcode-flush-threshold", cl::Hidden, cl::init(512),
+                   cl::desc("When writing bitcode to a seekable file, flush "
+                            "the buffered bitstream to it once it grows past "
+                            "this size (in MB)"));
+
+static cl::opt<bool>
+    WriteSymtab("bitcode-symtab", cl::Hidden, cl::init(true),
+                cl::desc("Write a symbol table block after the module block, "
+                         "so that tools can list the module's symbols "
+                         "without parsing it"));
+
 namespace {
 /// These are manifest constants used by the bitcode writer. They do not need to
 /// be kept in sync with the reader, but need to be consistent within this file.
@@ -81,9 +95,11 @@ protected:
 
 public:
   /// Constructs a BitcodeWriter object, and initializes a BitstreamRecord,
-  /// writing to the provided \p Buffer.
-  BitcodeWriter(SmallVectorImpl<char> &Buffer)
-      : Buffer(Buffer), Stream(Buffer) {}
+  /// writing to the provided \p Buffer. If \p FS is provided, the buffer is
+  /// regularly flushed to it instead of holding the whole bitcode.
+  BitcodeWriter(SmallVectorImpl<char> &Buffer, raw_pwrite_stream *FS = nullptr)
+      : Buffer(Buffer),
+        Stream(Buffer, FS, static_cast<uint64_t>(FlushThreshold) << 20) {}
 
   virtual ~BitcodeWriter() = default;
 
@@ -121,12 +137,14 @@ class ModuleBitcodeWriter : public BitcodeWriter {
 
 public:
   /// Constructs a ModuleBitcodeWriter object for the given Module,
-  /// writing to the provided \p Buffer.
+  /// writing to the provided \p Buffer, and streaming to \p FS if not null.
   ModuleBitcodeWriter(const Module *M, SmallVectorImpl<char> &Buffer,
-                      bool ShouldPreserveUseListOrder,
+                      raw_pwrite_stream *FS, bool ShouldPreserveUseListOrder,
                       const ModuleSummaryIndex *Index, bool GenerateHash)
-      : BitcodeWriter(Buffer), M(*M), VE(*M, ShouldPreserveUseListOrder),
+      : BitcodeWriter(Buffer, FS), M(*M), VE(*M, ShouldPreserveUseListOrder),
         Index(Index), GenerateHash(GenerateHash) {
+    assert((!FS || !GenerateHash) &&
+           "The module hash needs the whole module block in memory");
     // Save the start bit of the actual bitcode, in case there is space
     // saved at the start for the darwin header above. The reader stream
     // will start at the bitcode, and we need the offset of the VST
@@ -146,6 +164,10 @@ private:
   /// Emit the current module to the bitstream.
   void writeModule();
 
+  /// Emit the "SYMTAB_BLOCK_ID" listing the mangled name and flags of every
+  /// function, global variable and alias, in that order.
+  void writeSymtab();
+
   uint64_t bitcodeStartBit() { return BitcodeStartBit; }
 
   void writeStringRecord(unsigned Code, StringRef Str, unsigned AbbrevToUse);
@@ -951,6 +973,14 @@ static uint64_t getEncodedGVSummaryFlags(GlobalValueSummary::GVFlags Flags) {
   return RawFlags;
 }
 
+// Encode the function attribute flags in the summary
+static uint64_t getEncodedFFlags(FunctionSummary::FFlags Flags) {
+  uint64_t RawFlags = Flags.DeclCalleeAttrs;     // 4 bits
+  RawFlags = (RawFlags << 4) | Flags.BodyAttrs; // 4 bits
+  RawFlags = (RawFlags << 4) | Flags.Attrs;     // 4 bits
+  return RawFlags;
+}
+
 static unsigned getEncodedVisibility(const GlobalValue &GV) {
   switch (GV.getVisibility()) {
   case GlobalValue::DefaultVisibility:   return 0;
@@ -1044,6 +1074,7 @@ void BitcodeWriter::writeValueSymbolTableForwardDecl() {
   // patched when the real VST is written. We can simply subtract the 32-bit
   // fixed size from the current bit number to get the location to backpatch.
   VSTOffsetPlaceholder = Stream.GetCurrentBitNo() - 32;
+  Stream.RegisterBackpatchWord(VSTOffsetPlaceholder);
 }
 
 enum StringEncoding { SE_Char6, SE_Fixed7, SE_Fixed8 };
@@ -3205,6 +3236,7 @@ void ModuleBitcodeWriter::writePerModuleFunctionSummaryRecord(
   FunctionSummary *FS = cast<FunctionSummary>(Summary);
   NameVals.push_back(getEncodedGVSummaryFlags(FS->flags()));
   NameVals.push_back(FS->instCount());
+  NameVals.push_back(getEncodedFFlags(FS->fflags()));
   NameVals.push_back(FS->refs().size());
 
   unsigned SizeBeforeRefs = NameVals.size();
@@ -3267,7 +3299,8 @@ void ModuleBitcodeWriter::writeModuleLevelReferences(
 // Current version for the summary.
 // This is bumped whenever we introduce changes in the way some record are
 // interpreted, like flags for instance.
-static const uint64_t INDEX_VERSION = 1;
+// Version 2 adds the function attribute flags to the function records.
+static const uint64_t INDEX_VERSION = 2;
 
 /// Emit the per-module summary section alongside the rest of
 /// the module's bitcode.
@@ -3285,6 +3318,7 @@ void ModuleBitcodeWriter::writePerModuleGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // valueid
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // instcount
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // fflags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // numrefs
   // numrefs x valueid, n x (valueid, callsitecount)
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
@@ -3297,6 +3331,7 @@ void ModuleBitcodeWriter::writePerModuleGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // valueid
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // instcount
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // fflags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // numrefs
   // numrefs x valueid, n x (valueid, callsitecount, profilecount)
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
@@ -3370,6 +3405,7 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // modid
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // instcount
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // fflags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // numrefs
   // numrefs x valueid, n x (valueid, callsitecount)
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
@@ -3383,6 +3419,7 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // modid
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // instcount
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // fflags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // numrefs
   // numrefs x valueid, n x (valueid, callsitecount, profilecount)
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
@@ -3463,6 +3500,7 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
     NameVals.push_back(Index.getModuleId(FS->modulePath()));
     NameVals.push_back(getEncodedGVSummaryFlags(FS->flags()));
     NameVals.push_back(FS->instCount());
+    NameVals.push_back(getEncodedFFlags(FS->fflags()));
     NameVals.push_back(FS->refs().size());
 
     for (auto &RI : FS->refs()) {
@@ -3539,6 +3577,82 @@ void ModuleBitcodeWriter::writeIdentificationBlock() {
   Stream.ExitBlock();
 }
 
+/// Compute the SYMTAB_CODE_ENTRY flags of \p GV. These follow the flags that
+/// IRObjectFile reports for it.
+static uint64_t getSymtabFlags(const GlobalValue &GV) {
+  uint64_t Flags = 0;
+  if (GV.isDeclarationForLinker())
+    Flags |= bitc::SYMTAB_FLAG_UNDEFINED;
+  else if (GV.hasHiddenVisibility() && !GV.hasLocalLinkage())
+    Flags |= bitc::SYMTAB_FLAG_HIDDEN;
+  if (auto *GVar = dyn_cast<GlobalVariable>(&GV)) {
+    if (GVar->isConstant())
+      Flags |= bitc::SYMTAB_FLAG_CONST;
+    if (GVar->getSection() == "llvm.metadata")
+      Flags |= bitc::SYMTAB_FLAG_FORMAT_SPECIFIC;
+  }
+  if (GV.hasPrivateLinkage() || GV.getName().startswith("llvm."))
+    Flags |= bitc::SYMTAB_FLAG_FORMAT_SPECIFIC;
+  if (!GV.hasLocalLinkage())
+    Flags |= bitc::SYMTAB_FLAG_GLOBAL;
+  if (GV.hasCommonLinkage())
+    Flags |= bitc::SYMTAB_FLAG_COMMON;
+  if (GV.hasLinkOnceLinkage() || GV.hasWeakLinkage() ||
+      GV.hasExternalWeakLinkage())
+    Flags |= bitc::SYMTAB_FLAG_WEAK;
+  return Flags;
+}
+
+void ModuleBitcodeWriter::writeSymtab() {
+  // Symbols defined or referenced by module-level inline asm are only known
+  // to the target's asm parser, and unnamed globals are numbered by whichever
+  // Mangler prints them first. Leave such modules to readers that parse the
+  // module; they recognize the missing block.
+  if (!M.getModuleInlineAsm().empty())
+    return;
+  for (const Function &F : M)
+    if (!F.hasName())
+      return;
+  for (const GlobalVariable &GV : M.globals())
+    if (!GV.hasName())
+      return;
+  for (const GlobalAlias &GA : M.aliases())
+    if (!GA.hasName())
+      return;
+
+  Stream.EnterSubblock(bitc::SYMTAB_BLOCK_ID, 3);
+
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::SYMTAB_CODE_ENTRY));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  unsigned EntryAbbrev = Stream.EmitAbbrev(Abbv);
+
+  Mangler Mang;
+  SmallString<64> Name;
+  SmallVector<uint64_t, 2> Vals;
+  auto WriteSymbol = [&](const GlobalValue &GV) {
+    // SYMTAB_CODE_ENTRY: [flags, namechar x N]
+    Name.clear();
+    raw_svector_ostream OS(Name);
+    if (GV.hasDLLImportStorageClass())
+      OS << "__imp_";
+    Mang.getNameWithPrefix(OS, &GV, false);
+    Vals.push_back(bitc::SYMTAB_CODE_ENTRY);
+    Vals.push_back(getSymtabFlags(GV));
+    Stream.EmitRecordWithBlob(EntryAbbrev, Vals, Name);
+    Vals.clear();
+  };
+  for (const Function &F : M)
+    WriteSymbol(F);
+  for (const GlobalVariable &GV : M.globals())
+    WriteSymbol(GV);
+  for (const GlobalAlias &GA : M.aliases())
+    WriteSymbol(GA);
+
+  Stream.ExitBlock();
+}
+
 void ModuleBitcodeWriter::writeModuleHash(size_t BlockStartPos) {
   // Emit the module's hash.
   // MODULE_CODE_HASH: [5*i32]
@@ -3570,6 +3684,8 @@ void BitcodeWriter::write() {
 void ModuleBitcodeWriter::writeBlocks() {
   writeIdentificationBlock();
   writeModule();
+  if (WriteSymtab)
+    writeSymtab();
 }
 
 void IndexBitcodeWriter::writeBlocks() {
@@ -3718,29 +3834,51 @@ void BitcodeWriter::writeBitcodeHeader() {
 
 /// WriteBitcodeToFile - Write the specified module to the specified output
 /// stream.
-void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out,
-                              bool ShouldPreserveUseListOrder,
-                              const ModuleSummaryIndex *Index,
-                              bool GenerateHash) {
+static void writeBitcode(const Module *M, raw_ostream &Out,
+                         raw_pwrite_stream *FS, bool ShouldPreserveUseListOrder,
+                         const ModuleSummaryIndex *Index, bool GenerateHash) {
   SmallVector<char, 0> Buffer;
   Buffer.reserve(256*1024);
 
   // If this is darwin or another generic macho target, reserve space for the
   // header.
   Triple TT(M->getTargetTriple());
-  if (TT.isOSDarwin() || TT.isOSBinFormatMachO())
+  bool IsMachO = TT.isOSDarwin() || TT.isOSBinFormatMachO();
+  if (IsMachO)
     Buffer.insert(Buffer.begin(), BWH_HeaderSize, 0);
 
-  // Emit the module into the buffer.
-  ModuleBitcodeWriter ModuleWriter(M, Buffer, ShouldPreserveUseListOrder, Index,
-                                   GenerateHash);
+  // The darwin wrapper header and the module hash are computed from the whole
+  // bitstream held in memory.
+  if (IsMachO || GenerateHash)
+    FS = nullptr;
+
+  // Emit the module into the buffer, or through the buffer into FS.
+  ModuleBitcodeWriter ModuleWriter(M, Buffer, FS, ShouldPreserveUseListOrder,
+                                   Index, GenerateHash);
   ModuleWriter.write();
 
-  if (TT.isOSDarwin() || TT.isOSBinFormatMachO())
+  if (IsMachO)
     emitDarwinBCHeaderAndTrailer(Buffer, TT);
 
-  // Write the generated bitstream to "Out".
-  Out.write((char*)&Buffer.front(), Buffer.size());
+  // Write the generated bitstream (or what remains of it) to "Out".
+  Out.write(Buffer.data(), Buffer.size());
+}
+
+void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out,
+                              bool ShouldPreserveUseListOrder,
+                              const ModuleSummaryIndex *Index,
+                              bool GenerateHash) {
+  writeBitcode(M, Out, /*FS=*/nullptr, ShouldPreserveUseListOrder, Index,
+               GenerateHash);
+}
+
+void llvm::WriteBitcodeToFile(const Module *M, raw_fd_ostream &Out,
+                              bool ShouldPreserveUseListOrder,
+                              const ModuleSummaryIndex *Index,
+                              bool GenerateHash) {
+  // Stream to the file when we can seek back to backpatch the block sizes.
+  writeBitcode(M, Out, Out.supportsSeeking() ? &Out : nullptr,
+               ShouldPreserveUseListOrder, Index, GenerateHash);
 }
 
 void IndexBitcodeWriter::writeIndex() {
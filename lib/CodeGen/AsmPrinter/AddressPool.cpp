@@ -24,13 +24,27 @@ unsigned AddressPool::getIndex(const MCSymbol *Sym, bool TLS) {
 }
 
 // Emit addresses into the section given.
-void AddressPool::emit(AsmPrinter &Asm, MCSection *AddrSection) {
+void AddressPool::emit(AsmPrinter &Asm, MCSection *AddrSection,
+                       MCSymbol *Base) {
   if (Pool.empty())
     return;
 
   // Start the dwarf addr section.
   Asm.OutStreamer->SwitchSection(AddrSection);
 
+  unsigned AddrSize = Asm.getDataLayout().getPointerSize();
+  if (Base) {
+    Asm.OutStreamer->AddComment("Length of Address Table");
+    Asm.EmitInt32(4 + Pool.size() * AddrSize);
+    Asm.OutStreamer->AddComment("DWARF version number");
+    Asm.EmitInt16(5);
+    Asm.OutStreamer->AddComment("Address Size (in bytes)");
+    Asm.EmitInt8(AddrSize);
+    Asm.OutStreamer->AddComment("Segment Selector Size");
+    Asm.EmitInt8(0);
+    Asm.OutStreamer->EmitLabel(Base);
+  }
+
   // Order the address pool entries by ID
   SmallVector<const MCExpr *, 64> Entries(Pool.size());
 
@@ -41,5 +55,5 @@ void AddressPool::emit(AsmPrinter &Asm, MCSection *AddrSection) {
             : MCSymbolRefExpr::create(I.first, Asm.OutContext);
 
   for (const MCExpr *Entry : Entries)
-    Asm.OutStreamer->EmitValue(Entry, Asm.getDataLayout().getPointerSize());
+    Asm.OutStreamer->EmitValue(Entry, AddrSize);
 }
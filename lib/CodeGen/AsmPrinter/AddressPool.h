@@ -40,7 +40,10 @@ public:
   /// label/symbol.
   unsigned getIndex(const MCSymbol *Sym, bool TLS = false);
 
-  void emit(AsmPrinter &Asm, MCSection *AddrSection);
+  /// Emit the addresses into \p AddrSection. If \p Base is given they form a
+  /// DWARF 5 address table: they are preceded by its header, and Base, the
+  /// value of DW_AT_addr_base, labels the first one.
+  void emit(AsmPrinter &Asm, MCSection *AddrSection, MCSymbol *Base = nullptr);
 
   bool isEmpty() { return Pool.empty(); }
 
@@ -344,7 +344,10 @@ void AsmPrinter::getNameWithPrefix(SmallVectorImpl<char> &Name,
 }
 
 MCSymbol *AsmPrinter::getSymbol(const GlobalValue *GV) const {
-  return TM.getSymbol(GV, *Mang);
+  MCSymbol *&Sym = GlobalSymbols[GV];
+  if (!Sym)
+    Sym = TM.getSymbol(GV, *Mang);
+  return Sym;
 }
 
 /// EmitGlobalVariable - Emit the specified global variable to the .s file.
@@ -1247,6 +1250,7 @@ bool AsmPrinter::doFinalization(Module &M) {
   EmitEndOfAsmFile(M);
 
   delete Mang; Mang = nullptr;
+  GlobalSymbols.clear();
   MMI = nullptr;
 
   OutStreamer->Finish();
@@ -261,6 +261,8 @@ void DIEInteger::EmitValue(const AsmPrinter *Asm, dwarf::Form Form) const {
   case dwarf::DW_FORM_data8: Size = 8; break;
   case dwarf::DW_FORM_GNU_str_index: Asm->EmitULEB128(Integer); return;
   case dwarf::DW_FORM_GNU_addr_index: Asm->EmitULEB128(Integer); return;
+  case dwarf::DW_FORM_strx: Asm->EmitULEB128(Integer); return;
+  case dwarf::DW_FORM_addrx: Asm->EmitULEB128(Integer); return;
   case dwarf::DW_FORM_udata: Asm->EmitULEB128(Integer); return;
   case dwarf::DW_FORM_sdata: Asm->EmitSLEB128(Integer); return;
   case dwarf::DW_FORM_addr:
@@ -293,6 +295,8 @@ unsigned DIEInteger::SizeOf(const AsmPrinter *AP, dwarf::Form Form) const {
   case dwarf::DW_FORM_data8: return sizeof(int64_t);
   case dwarf::DW_FORM_GNU_str_index: return getULEB128Size(Integer);
   case dwarf::DW_FORM_GNU_addr_index: return getULEB128Size(Integer);
+  case dwarf::DW_FORM_strx: return getULEB128Size(Integer);
+  case dwarf::DW_FORM_addrx: return getULEB128Size(Integer);
   case dwarf::DW_FORM_udata: return getULEB128Size(Integer);
   case dwarf::DW_FORM_sdata: return getSLEB128Size(Integer);
   case dwarf::DW_FORM_addr:
@@ -389,12 +393,12 @@ void DIEDelta::print(raw_ostream &O) const {
 /// EmitValue - Emit string value.
 ///
 void DIEString::EmitValue(const AsmPrinter *AP, dwarf::Form Form) const {
-  assert(
-      (Form == dwarf::DW_FORM_strp || Form == dwarf::DW_FORM_GNU_str_index) &&
-      "Expected valid string form");
+  assert((Form == dwarf::DW_FORM_strp || Form == dwarf::DW_FORM_GNU_str_index ||
+          Form == dwarf::DW_FORM_strx) &&
+         "Expected valid string form");
 
   // Index of string in symbol table.
-  if (Form == dwarf::DW_FORM_GNU_str_index) {
+  if (Form == dwarf::DW_FORM_GNU_str_index || Form == dwarf::DW_FORM_strx) {
     DIEInteger(S.getIndex()).EmitValue(AP, Form);
     return;
   }
@@ -413,12 +417,12 @@ void DIEString::EmitValue(const AsmPrinter *AP, dwarf::Form Form) const {
 /// SizeOf - Determine size of delta value in bytes.
 ///
 unsigned DIEString::SizeOf(const AsmPrinter *AP, dwarf::Form Form) const {
-  assert(
-      (Form == dwarf::DW_FORM_strp || Form == dwarf::DW_FORM_GNU_str_index) &&
-      "Expected valid string form");
+  assert((Form == dwarf::DW_FORM_strp || Form == dwarf::DW_FORM_GNU_str_index ||
+          Form == dwarf::DW_FORM_strx) &&
+         "Expected valid string form");
 
   // Index of string in symbol table.
-  if (Form == dwarf::DW_FORM_GNU_str_index)
+  if (Form == dwarf::DW_FORM_GNU_str_index || Form == dwarf::DW_FORM_strx)
     return DIEInteger(S.getIndex()).SizeOf(AP, Form);
 
   // Relocatable symbol.
@@ -74,11 +74,14 @@ void DwarfAccelTable::FinalizeTable(AsmPrinter *Asm, StringRef Prefix) {
   for (StringMap<DataArray>::iterator EI = Entries.begin(), EE = Entries.end();
        EI != EE; ++EI) {
 
-    // Unique the entries.
-    std::stable_sort(EI->second.Values.begin(), EI->second.Values.end(), compareDIEs);
-    EI->second.Values.erase(
-        std::unique(EI->second.Values.begin(), EI->second.Values.end()),
-        EI->second.Values.end());
+    // Unique the entries. Most names only have a single DIE.
+    if (EI->second.Values.size() > 1) {
+      std::stable_sort(EI->second.Values.begin(), EI->second.Values.end(),
+                       compareDIEs);
+      EI->second.Values.erase(
+          std::unique(EI->second.Values.begin(), EI->second.Values.end()),
+          EI->second.Values.end());
+    }
 
     HashData *Entry = new (Allocator) HashData(EI->getKey(), EI->second);
     Data.push_back(Entry);
@@ -91,22 +94,27 @@ void DwarfAccelTable::FinalizeTable(AsmPrinter *Asm, StringRef Prefix) {
   // later, we'll emit them when we emit the data.
   ComputeBucketCount();
 
-  // Compute bucket contents and final ordering.
-  Buckets.resize(Header.bucket_count);
-  for (size_t i = 0, e = Data.size(); i < e; ++i) {
-    uint32_t bucket = Data[i]->HashValue % Header.bucket_count;
-    Buckets[bucket].push_back(Data[i]);
-    Data[i]->Sym = Asm->createTempSymbol(Prefix);
-  }
+  // Compute the final ordering with a single sort by bucket, then by hash
+  // value so that hash collisions end up together, instead of sorting every
+  // bucket on its own. Stable sort makes testing easier and doesn't cost much
+  // more.
+  uint32_t BucketCount = Header.bucket_count;
+  std::vector<HashData *> Sorted(Data.begin(), Data.end());
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [BucketCount](HashData *LHS, HashData *RHS) {
+                     uint32_t LBucket = LHS->HashValue % BucketCount;
+                     uint32_t RBucket = RHS->HashValue % BucketCount;
+                     if (LBucket != RBucket)
+                       return LBucket < RBucket;
+                     return LHS->HashValue < RHS->HashValue;
+                   });
 
-  // Sort the contents of the buckets by hash value so that hash
-  // collisions end up together. Stable sort makes testing easier and
-  // doesn't cost much more.
-  for (size_t i = 0; i < Buckets.size(); ++i)
-    std::stable_sort(Buckets[i].begin(), Buckets[i].end(),
-                     [] (HashData *LHS, HashData *RHS) {
-                       return LHS->HashValue < RHS->HashValue;
-                     });
+  // Compute bucket contents.
+  Buckets.resize(BucketCount);
+  for (HashData *D : Sorted)
+    Buckets[D->HashValue % BucketCount].push_back(D);
+  for (HashData *D : Data)
+    D->Sym = Asm->createTempSymbol(Prefix);
 }
 
 // Emits the header for the table via the AsmPrinter.
@@ -97,6 +97,13 @@ SplitDwarf("split-dwarf", cl::Hidden,
                       clEnumVal(Disable, "Disabled"), clEnumValEnd),
            cl::init(Default));
 
+static cl::opt<bool>
+DwarfIndexedForms("dwarf-indexed-forms", cl::Hidden,
+                  cl::desc("Refer to strings and addresses through the DWARF 5 "
+                           ".debug_str_offsets and .debug_addr tables in "
+                           "non-split DWARF."),
+                  cl::init(false));
+
 static cl::opt<DefaultOnOff>
 DwarfPubSections("generate-dwarf-pub-sections", cl::Hidden,
                  cl::desc("Generate DWARF pubnames and pubtypes sections"),
@@ -242,6 +249,14 @@ DwarfDebug::DwarfDebug(AsmPrinter *A, Module *M)
   else
     HasSplitDwarf = SplitDwarf == Enable;
 
+  // The string offsets table is only available on ELF.
+  HasIndexedForms = DwarfIndexedForms && !HasSplitDwarf &&
+                    Asm->getObjFileLowering().getDwarfStrOffSection();
+  if (HasIndexedForms) {
+    StringOffsetsBase = Asm->createTempSymbol("str_offsets_base");
+    AddrTableBase = Asm->createTempSymbol("addr_table_base");
+  }
+
   // Pubnames/pubtypes on by default for GDB.
   if (DwarfPubSections == Default)
     HasDwarfPubSections = tuneForGDB();
@@ -550,6 +565,13 @@ void DwarfDebug::finalizeModuleInfo() {
     // If we're splitting the dwarf out now that we've got the entire
     // CU then add the dwo id to it.
     auto *SkCU = TheCU.getSkeleton();
+    if (useIndexedForms()) {
+      addStringOffsetsBase(TheCU);
+      if (!AddrPool.isEmpty())
+        TheCU.addSectionLabel(TheCU.getUnitDie(), dwarf::DW_AT_addr_base,
+                              AddrTableBase,
+                              TLOF.getDwarfAddrSection()->getBeginSymbol());
+    }
     if (useSplitDwarf()) {
       // Emit a unique identifier for this CU.
       uint64_t ID = DIEHash(Asm).computeCUSignature(TheCU.getUnitDie());
@@ -650,6 +672,9 @@ void DwarfDebug::endModule() {
     emitDebugLineDWO();
     // Emit DWO addresses.
     AddrPool.emit(*Asm, Asm->getObjFileLowering().getDwarfAddrSection());
+  } else if (useIndexedForms()) {
+    AddrPool.emit(*Asm, Asm->getObjFileLowering().getDwarfAddrSection(),
+                  AddrTableBase);
   }
 
   // Emit info into the dwarf accelerator table sections.
@@ -1380,8 +1405,23 @@ void DwarfDebug::emitDebugPubTypes(bool GnuStyle) {
 
 /// Emit null-terminated strings into a debug str section.
 void DwarfDebug::emitDebugStr() {
+  const TargetLoweringObjectFile &TLOF = Asm->getObjFileLowering();
+  if (useIndexedForms()) {
+    InfoHolder.emitStrings(TLOF.getDwarfStrSection(),
+                           TLOF.getDwarfStrOffSection(), StringOffsetsBase);
+    return;
+  }
   DwarfFile &Holder = useSplitDwarf() ? SkeletonHolder : InfoHolder;
-  Holder.emitStrings(Asm->getObjFileLowering().getDwarfStrSection());
+  Holder.emitStrings(TLOF.getDwarfStrSection());
+}
+
+void DwarfDebug::addStringOffsetsBase(DwarfUnit &U) {
+  // Indexed forms are only used on ELF, which always uses relocations to
+  // refer across debug sections.
+  U.addLabel(U.getUnitDie(), dwarf::DW_AT_str_offsets_base,
+             getDwarfVersion() >= 4 ? dwarf::DW_FORM_sec_offset
+                                    : dwarf::DW_FORM_data4,
+             StringOffsetsBase);
 }
 
 void DwarfDebug::emitDebugLocEntry(ByteStreamer &Streamer,
@@ -1903,6 +1943,8 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
     NewTU.initSection(Asm->getObjFileLowering().getDwarfTypesDWOSection());
   else {
     CU.applyStmtList(UnitDie);
+    if (useIndexedForms())
+      addStringOffsetsBase(NewTU);
     NewTU.initSection(
         Asm->getObjFileLowering().getDwarfTypesSection(Signature));
   }
@@ -262,6 +262,12 @@ class DwarfDebug : public DebugHandlerBase {
   bool HasDwarfAccelTables;
   bool HasAppleExtensionAttributes;
   bool HasSplitDwarf;
+  bool HasIndexedForms;
+
+  /// Labels of the first entries of the DWARF 5 string offsets and address
+  /// tables, when using indexed forms outside of split DWARF.
+  MCSymbol *StringOffsetsBase = nullptr;
+  MCSymbol *AddrTableBase = nullptr;
 
   /// Separated Dwarf Variables
   /// In general these will all be for bits that are left in the
@@ -514,6 +520,14 @@ public:
   /// split dwarf proposal support.
   bool useSplitDwarf() const { return HasSplitDwarf; }
 
+  /// Returns whether strings and addresses are referred to with DW_FORM_strx
+  /// and DW_FORM_addrx in non-split DWARF. Each unique string or address then
+  /// needs a single relocation in the module, instead of one per reference.
+  bool useIndexedForms() const { return HasIndexedForms; }
+
+  /// Add DW_AT_str_offsets_base to the unit DIE of \p U.
+  void addStringOffsetsBase(DwarfUnit &U);
+
   /// Returns the Dwarf Version.
   unsigned getDwarfVersion() const { return DwarfVersion; }
 
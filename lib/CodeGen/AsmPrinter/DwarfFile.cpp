@@ -138,8 +138,9 @@ void DwarfFile::emitAbbrevs(MCSection *Section) {
 }
 
 // Emit strings into a string section.
-void DwarfFile::emitStrings(MCSection *StrSection, MCSection *OffsetSection) {
-  StrPool.emit(*Asm, StrSection, OffsetSection);
+void DwarfFile::emitStrings(MCSection *StrSection, MCSection *OffsetSection,
+                            MCSymbol *OffsetsBase) {
+  StrPool.emit(*Asm, StrSection, OffsetSection, OffsetsBase);
 }
 
 bool DwarfFile::addScopeVariable(LexicalScope *LS, DbgVariable *Var) {
@@ -35,7 +35,7 @@ DwarfStringPool::EntryRef DwarfStringPool::getEntry(AsmPrinter &Asm,
 }
 
 void DwarfStringPool::emit(AsmPrinter &Asm, MCSection *StrSection,
-                           MCSection *OffsetSection) {
+                           MCSection *OffsetSection, MCSymbol *OffsetsBase) {
   if (Pool.empty())
     return;
 
@@ -68,7 +68,21 @@ void DwarfStringPool::emit(AsmPrinter &Asm, MCSection *StrSection,
   if (OffsetSection) {
     Asm.OutStreamer->SwitchSection(OffsetSection);
     unsigned size = 4; // FIXME: DWARF64 is 8.
-    for (const auto &Entry : Entries)
-      Asm.OutStreamer->EmitIntValue(Entry->getValue().Offset, size);
+    if (OffsetsBase) {
+      Asm.OutStreamer->AddComment("Length of String Offsets Set");
+      Asm.EmitInt32(4 + Entries.size() * size);
+      Asm.OutStreamer->AddComment("DWARF version number");
+      Asm.EmitInt16(5);
+      Asm.OutStreamer->AddComment("Padding");
+      Asm.EmitInt16(0);
+      Asm.OutStreamer->EmitLabel(OffsetsBase);
+    }
+    for (const auto &Entry : Entries) {
+      // Unlike in a .dwo file, these offsets are relocated by the linker.
+      if (OffsetsBase && ShouldCreateSymbols)
+        Asm.emitDwarfSymbolReference(Entry->getValue().Symbol);
+      else
+        Asm.OutStreamer->EmitIntValue(Entry->getValue().Offset, size);
+    }
   }
 }
@@ -37,8 +37,13 @@ public:
 
   DwarfStringPool(BumpPtrAllocator &A, AsmPrinter &Asm, StringRef Prefix);
 
+  /// Emit the strings into \p StrSection and, if \p OffsetSection is given,
+  /// their offsets into it. If \p OffsetsBase is also given the offsets form
+  /// a DWARF 5 string offsets table: they are preceded by its header, and
+  /// OffsetsBase, the value of DW_AT_str_offsets_base, labels the first one.
   void emit(AsmPrinter &Asm, MCSection *StrSection,
-            MCSection *OffsetSection = nullptr);
+            MCSection *OffsetSection = nullptr,
+            MCSymbol *OffsetsBase = nullptr);
 
   bool empty() const { return Pool.empty(); }
 
@@ -216,8 +216,12 @@ void DwarfUnit::addSInt(DIELoc &Die, Optional<dwarf::Form> Form,
 
 void DwarfUnit::addString(DIE &Die, dwarf::Attribute Attribute,
                           StringRef String) {
-  Die.addValue(DIEValueAllocator, Attribute,
-               isDwoUnit() ? dwarf::DW_FORM_GNU_str_index : dwarf::DW_FORM_strp,
+  dwarf::Form Form = dwarf::DW_FORM_strp;
+  if (isDwoUnit())
+    Form = dwarf::DW_FORM_GNU_str_index;
+  else if (DD->useIndexedForms())
+    Form = dwarf::DW_FORM_strx;
+  Die.addValue(DIEValueAllocator, Attribute, Form,
                DIEString(DU->getStringPool().getEntry(*Asm, String)));
 }
 
@@ -69,7 +69,7 @@ DFAPacketizer::DFAPacketizer(const InstrItineraryData *I,
 }
 
 
-// Read the DFA transition table and update CachedTable.
+// Read the transitions out of a state from the DFA transition table.
 //
 // Format of the transition tables:
 // DFAStateInputTable[][2] = pairs of <Input, Transition> for all valid
@@ -78,16 +78,56 @@ DFAPacketizer::DFAPacketizer(const InstrItineraryData *I,
 //                         for the ith state
 //
 void DFAPacketizer::ReadTable(unsigned int state) {
+  if (state >= StatesRead.size()) {
+    StatesRead.resize(state + 1);
+    Transitions.resize(state + 1);
+  }
+  if (StatesRead[state])
+    return;
+  StatesRead[state] = true;
+
   unsigned ThisState = DFAStateEntryTable[state];
   unsigned NextStateInTable = DFAStateEntryTable[state+1];
-  // Early exit in case CachedTable has already contains this
-  // state's transitions.
-  if (CachedTable.count(UnsignPair(state, DFAStateInputTable[ThisState][0])))
-    return;
+  std::vector<int> &Row = Transitions[state];
+  for (unsigned i = ThisState; i < NextStateInTable; i++) {
+    // Skip the sentinel of a state without transitions.
+    if (DFAStateInputTable[i][1] < 0)
+      continue;
+    unsigned Input = getInputNumber(DFAStateInputTable[i][0]);
+    if (Input >= Row.size())
+      Row.resize(Input + 1, -1);
+    Row[Input] = DFAStateInputTable[i][1];
+  }
+}
 
-  for (unsigned i = ThisState; i < NextStateInTable; i++)
-    CachedTable[UnsignPair(state, DFAStateInputTable[i][0])] =
-      DFAStateInputTable[i][1];
+
+// Return the number of an input, numbering it if it has not been seen.
+// An input that is first seen after a state has been read cannot be one of
+// that state's transitions, so its number is past the end of the state's row.
+unsigned DFAPacketizer::getInputNumber(DFAInput Input) {
+  return InputNumbers.insert(std::make_pair(Input, InputNumbers.size()))
+      .first->second;
+}
+
+
+// Return the input number of a scheduling class.
+unsigned DFAPacketizer::getSchedClassInput(unsigned SchedClass) {
+  if (SchedClass >= SchedClassInputs.size())
+    SchedClassInputs.resize(SchedClass + 1, -1);
+  int &Input = SchedClassInputs[SchedClass];
+  if (Input < 0)
+    Input = getInputNumber(getInsnInput(SchedClass));
+  return Input;
+}
+
+
+// Return the state reached from the current state by an instruction of the
+// given scheduling class, or -1 if its resources are not available.
+int DFAPacketizer::getNextState(unsigned SchedClass) {
+  unsigned Input = getSchedClassInput(SchedClass);
+  ReadTable(CurrentState);
+  const std::vector<int> &Row = Transitions[CurrentState];
+  return Input < Row.size() ? Row[Input] : -1;
 }
 
 
@@ -115,23 +155,16 @@ DFAInput DFAPacketizer::getInsnInput(const std::vector<unsigned> &InsnClass) {
 // Check if the resources occupied by a MCInstrDesc are available in the
 // current state.
 bool DFAPacketizer::canReserveResources(const llvm::MCInstrDesc *MID) {
-  unsigned InsnClass = MID->getSchedClass();
-  DFAInput InsnInput = getInsnInput(InsnClass);
-  UnsignPair StateTrans = UnsignPair(CurrentState, InsnInput);
-  ReadTable(CurrentState);
-  return CachedTable.count(StateTrans) != 0;
+  return getNextState(MID->getSchedClass()) >= 0;
 }
 
 
 // Reserve the resources occupied by a MCInstrDesc and change the current
 // state to reflect that change.
 void DFAPacketizer::reserveResources(const llvm::MCInstrDesc *MID) {
-  unsigned InsnClass = MID->getSchedClass();
-  DFAInput InsnInput = getInsnInput(InsnClass);
-  UnsignPair StateTrans = UnsignPair(CurrentState, InsnInput);
-  ReadTable(CurrentState);
-  assert(CachedTable.count(StateTrans) != 0);
-  CurrentState = CachedTable[StateTrans];
+  int NextState = getNextState(MID->getSchedClass());
+  assert(NextState >= 0 && "Resources are not available");
+  CurrentState = NextState;
 }
 
 
@@ -39,7 +39,6 @@ namespace {
     // RewindFunction - _Unwind_Resume or the target equivalent.
     Constant *RewindFunction;
 
-    DominatorTree *DT;
     const TargetLowering *TLI;
 
     bool InsertUnwindResumeCalls(Function &Fn);
@@ -55,12 +54,11 @@ namespace {
     // INITIALIZE_TM_PASS requires a default constructor, but it isn't used in
     // practice.
     DwarfEHPrepare()
-        : FunctionPass(ID), TM(nullptr), RewindFunction(nullptr), DT(nullptr),
+        : FunctionPass(ID), TM(nullptr), RewindFunction(nullptr),
           TLI(nullptr) {}
 
     DwarfEHPrepare(const TargetMachine *TM)
-        : FunctionPass(ID), TM(TM), RewindFunction(nullptr), DT(nullptr),
-          TLI(nullptr) {}
+        : FunctionPass(ID), TM(TM), RewindFunction(nullptr), TLI(nullptr) {}
 
     bool runOnFunction(Function &Fn) override;
 
@@ -80,7 +78,6 @@ namespace {
 char DwarfEHPrepare::ID = 0;
 INITIALIZE_TM_PASS_BEGIN(DwarfEHPrepare, "dwarfehprepare",
                          "Prepare DWARF exceptions", false, false)
-INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
 INITIALIZE_TM_PASS_END(DwarfEHPrepare, "dwarfehprepare",
                        "Prepare DWARF exceptions", false, false)
@@ -91,7 +88,6 @@ FunctionPass *llvm::createDwarfEHPass(const TargetMachine *TM) {
 
 void DwarfEHPrepare::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<TargetTransformInfoWrapperPass>();
-  AU.addRequired<DominatorTreeWrapperPass>();
 }
 
 /// GetExceptionObject - Return the exception object from the value passed into
@@ -139,11 +135,14 @@ Value *DwarfEHPrepare::GetExceptionObject(ResumeInst *RI) {
 size_t DwarfEHPrepare::pruneUnreachableResumes(
     Function &Fn, SmallVectorImpl<ResumeInst *> &Resumes,
     SmallVectorImpl<LandingPadInst *> &CleanupLPads) {
+  // Only functions with resumes get here, so build the dominator tree for
+  // them alone instead of requiring it for every function in the module.
+  DominatorTree DT(Fn);
   BitVector ResumeReachable(Resumes.size());
   size_t ResumeIndex = 0;
   for (auto *RI : Resumes) {
     for (auto *LP : CleanupLPads) {
-      if (isPotentiallyReachable(LP, RI, DT)) {
+      if (isPotentiallyReachable(LP, RI, &DT)) {
         ResumeReachable.set(ResumeIndex);
         break;
       }
@@ -255,10 +254,8 @@ bool DwarfEHPrepare::InsertUnwindResumeCalls(Function &Fn) {
 
 bool DwarfEHPrepare::runOnFunction(Function &Fn) {
   assert(TM && "DWARF EH preparation requires a target machine");
-  DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
   TLI = TM->getSubtargetImpl(Fn)->getTargetLowering();
   bool Changed = InsertUnwindResumeCalls(Fn);
-  DT = nullptr;
   TLI = nullptr;
   return Changed;
 }
@@ -0,0 +1,82 @@
+//===-- FreeFunctionBodies.cpp - Release IR once it has been emitted ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass runs after the AsmPrinter and throws away the body of each
+// function it has emitted, so that the IR of a large module does not stay in
+// memory for the rest of code generation. The MachineFunction is already gone
+// by then; it is released when the AsmPrinter, its last user, is done.
+//
+// The function itself is kept, along with its linkage, attributes and
+// metadata, because the functions emitted after it and the AsmPrinter's
+// finalization still refer to it. Its body is replaced by a single
+// unreachable block rather than removed, so that it is still a definition:
+// code generated for later references to it must not change.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Pass.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "free-function-bodies"
+
+STATISTIC(NumBodiesFreed, "Number of function bodies freed after emission");
+
+namespace {
+
+class FreeFunctionBodies : public FunctionPass {
+public:
+  static char ID;
+  FreeFunctionBodies() : FunctionPass(ID) {
+    initializeFreeFunctionBodiesPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnFunction(Function &F) override;
+
+  const char *getPassName() const override { return "Free Function Bodies"; }
+};
+
+} // end anonymous namespace
+
+char FreeFunctionBodies::ID = 0;
+
+INITIALIZE_PASS(FreeFunctionBodies, "free-function-bodies",
+                "Free function bodies after emission", false, false)
+
+FunctionPass *llvm::createFreeFunctionBodiesPass() {
+  return new FreeFunctionBodies();
+}
+
+bool FreeFunctionBodies::runOnFunction(Function &F) {
+  if (F.isDeclaration())
+    return false;
+
+  // The body may already have been reduced to a single unreachable.
+  if (F.size() == 1 && isa<UnreachableInst>(F.front().front()))
+    return false;
+
+  // Code and data not yet emitted may still take the address of a block.
+  for (const BasicBlock &BB : F)
+    if (BB.hasAddressTaken())
+      return false;
+
+  for (BasicBlock &BB : F)
+    BB.dropAllReferences();
+  while (!F.empty())
+    F.begin()->eraseFromParent();
+
+  BasicBlock *Entry = BasicBlock::Create(F.getContext(), "", &F);
+  new UnreachableInst(F.getContext(), Entry);
+  ++NumBodiesFreed;
+  return true;
+}
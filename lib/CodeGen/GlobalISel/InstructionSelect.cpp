@@ -0,0 +1,90 @@
+//===- llvm/CodeGen/GlobalISel/InstructionSelect.cpp - InstructionSelect ---==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the InstructionSelect class.
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/InstructionSelect.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+
+#define DEBUG_TYPE "instruction-select"
+
+using namespace llvm;
+
+char InstructionSelect::ID = 0;
+INITIALIZE_PASS(InstructionSelect, DEBUG_TYPE,
+                "Select target instructions out of generic instructions",
+                false, false);
+
+InstructionSelect::InstructionSelect() : MachineFunctionPass(ID) {
+  initializeInstructionSelectPass(*PassRegistry::getPassRegistry());
+}
+
+static void reportSelectionError(const MachineInstr &MI, const Twine &Message) {
+  const MachineFunction &MF = *MI.getParent()->getParent();
+  std::string ErrStorage;
+  raw_string_ostream Err(ErrStorage);
+  Err << Message << ":\nIn function: " << MF.getName() << '\n' << MI << '\n';
+  report_fatal_error(Err.str());
+}
+
+bool InstructionSelect::runOnMachineFunction(MachineFunction &MF) {
+  DEBUG(dbgs() << "Selecting function: " << MF.getName() << '\n');
+  // The instructions may already have been selected, e.g. when the function
+  // was read from a cache.
+  if (MF.getProperties().hasProperty(
+          MachineFunctionProperties::Property::Selected))
+    return false;
+
+  const InstructionSelector *ISel = MF.getSubtarget().getInstructionSelector();
+  assert(ISel && "Cannot work without InstructionSelector");
+
+  // Visit blocks in post-order and instructions bottom-up, so that the uses of
+  // a value are selected before its definition. The selector may replace the
+  // instruction it is given, but must not touch the ones before it.
+  for (MachineBasicBlock *MBB : post_order(&MF)) {
+    for (MachineBasicBlock::iterator MII = MBB->end(); MII != MBB->begin();) {
+      MachineInstr &MI = *--MII;
+      bool AtBegin = MII == MBB->begin();
+      MachineBasicBlock::iterator Prev;
+      if (!AtBegin)
+        Prev = std::prev(MII);
+
+      DEBUG(dbgs() << "Selecting: " << MI << '\n');
+
+      if (!ISel->select(MI))
+        reportSelectionError(MI, "Cannot select");
+
+      // Resume right after the instruction before MI: anything between it and
+      // the end of the block has been selected.
+      MII = AtBegin ? MBB->begin() : std::next(Prev);
+    }
+  }
+
+  // Every virtual register now has to be constrained to a register class for
+  // the register allocator.
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  for (unsigned I = 0, E = MRI.getNumVirtRegs(); I != E; ++I) {
+    unsigned Reg = TargetRegisterInfo::index2VirtReg(I);
+    if (!MRI.getRegClassOrNull(Reg) && !MRI.reg_nodbg_empty(Reg))
+      reportSelectionError(*MRI.reg_instr_nodbg_begin(Reg),
+                           "VReg has no regclass after selection");
+  }
+
+  // Now that selection is complete, there are no more generic vregs and their
+  // sizes are meaningless.
+  MF.getRegInfo().clearVirtRegSizes();
+
+  return true;
+}
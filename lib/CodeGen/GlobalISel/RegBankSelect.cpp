@@ -537,6 +537,11 @@ void RegBankSelect::assignInstr(MachineInstr &MI) {
 
 bool RegBankSelect::runOnMachineFunction(MachineFunction &MF) {
   DEBUG(dbgs() << "Assign register banks for: " << MF.getName() << '\n');
+  // The instructions may already have been selected, e.g. when the function
+  // was read from a cache.
+  if (MF.getProperties().hasProperty(
+          MachineFunctionProperties::Property::Selected))
+    return false;
   const Function *F = MF.getFunction();
   Mode SaveOptMode = OptMode;
   if (F->hasFnAttribute(Attribute::OptimizeNone))
@@ -16,12 +16,15 @@
 //
 // to
 //
-//   faulting_load_op("movl (%r10), %esi", throw_npe)
+//   faulting_op("movl (%r10), %esi", throw_npe)
 //   ...
 //
 // With the help of a runtime that understands the .fault_maps section,
-// faulting_load_op branches to throw_npe if executing movl (%r10), %esi incurs
-// a page fault.
+// faulting_op branches to throw_npe if executing movl (%r10), %esi incurs
+// a page fault.  Loads, stores and read-modify-write instructions can all be
+// used this way, and they may be a few blocks away from the null check as long
+// as they are reached unconditionally once the pointer is known not to be
+// null.
 //
 //===----------------------------------------------------------------------===//
 
@@ -29,6 +32,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/CodeGen/FaultMaps.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineMemOperand.h"
@@ -51,6 +55,13 @@ static cl::opt<int> PageSize("imp-null-check-page-size",
                              cl::desc("The page size of the target in bytes"),
                              cl::init(4096));
 
+static cl::opt<unsigned> MaxBlocksToSearch(
+    "imp-null-check-max-blocks",
+    cl::desc("The maximum number of blocks, starting with the not-null "
+             "successor, to search for a memory operation to fold the null "
+             "check into"),
+    cl::init(4));
+
 #define DEBUG_TYPE "implicit-null-checks"
 
 STATISTIC(NumImplicitNullChecks,
@@ -58,6 +69,8 @@ STATISTIC(NumImplicitNullChecks,
 
 namespace {
 
+class HazardDetector;
+
 class ImplicitNullChecks : public MachineFunctionPass {
   /// Represents one null check that can be made implicit.
   class NullCheck {
@@ -110,8 +123,14 @@ class ImplicitNullChecks : public MachineFunctionPass {
 
   bool analyzeBlockForNullChecks(MachineBasicBlock &MBB,
                                  SmallVectorImpl<NullCheck> &NullCheckList);
-  MachineInstr *insertFaultingLoad(MachineInstr *LoadMI, MachineBasicBlock *MBB,
-                                   MachineBasicBlock *HandlerMBB);
+  bool analyzeMemOperation(MachineInstr &MI, MachineBasicBlock &MBB,
+                           MachineBasicBlock *NotNullSucc,
+                           MachineBasicBlock *NullSucc,
+                           MachineInstr *CheckOperation, unsigned PointerReg,
+                           HazardDetector &HD,
+                           SmallVectorImpl<NullCheck> &NullCheckList);
+  MachineInstr *insertFaultingOp(MachineInstr *MemMI, MachineBasicBlock *MBB,
+                                 MachineBasicBlock *HandlerMBB);
   void rewriteNullChecks(ArrayRef<NullCheck> NullCheckList);
 
 public:
@@ -150,11 +169,12 @@ class HazardDetector {
   DenseSet<unsigned> RegUses;
   const TargetRegisterInfo &TRI;
   bool hasSeenClobber;
+  bool hasSeenLoad;
   AliasAnalysis &AA;
 
 public:
   explicit HazardDetector(const TargetRegisterInfo &TRI, AliasAnalysis &AA)
-      : TRI(TRI), hasSeenClobber(false), AA(AA) {}
+      : TRI(TRI), hasSeenClobber(false), hasSeenLoad(false), AA(AA) {}
 
   /// \brief Make a note of \p MI for later queries to isSafeToHoist.
   ///
@@ -192,6 +212,9 @@ void HazardDetector::rememberInstruction(MachineInstr *MI) {
     return;
   }
 
+  if (MI->mayLoad())
+    hasSeenLoad = true;
+
   for (auto *MMO : MI->memoperands()) {
     // Right now we don't want to worry about LLVM's memory model.
     if (!MMO->isUnordered()) {
@@ -228,6 +251,10 @@ bool HazardDetector::isSafeToHoist(MachineInstr *MI,
     if (!MMO->isUnordered())
       return false;
 
+  // A store must not move above a load that may read the memory it writes.
+  if (MI->mayStore() && hasSeenLoad)
+    return false;
+
   for (auto &MO : MI->operands()) {
     if (MO.isReg() && MO.getReg()) {
       for (auto &RegDef : RegDefs) {
@@ -379,7 +406,7 @@ bool ImplicitNullChecks::analyzeBlockForNullChecks(
   //
   // we want to end up with
   //
-  //   Def = FaultingLoad (%RAX + <offset>), LblNull
+  //   Def = FaultingOp (%RAX + <offset>), LblNull
   //   jmp LblNotNull ;; explicit or fallthrough
   //
   //  LblNotNull:
@@ -393,9 +420,9 @@ bool ImplicitNullChecks::analyzeBlockForNullChecks(
   //
   // To see why this is legal, consider the two possibilities:
   //
-  //  1. %RAX is null: since we constrain <offset> to be less than PageSize, the
-  //     load instruction dereferences the null page, causing a segmentation
-  //     fault.
+  //  1. %RAX is null: since we constrain the magnitude of <offset> to be less
+  //     than PageSize, the load instruction dereferences the null page (or the
+  //     top of the address space), causing a segmentation fault.
   //
   //  2. %RAX is not null: in this case we know that the load cannot fault, as
   //     otherwise the load would've faulted in the original program too and the
@@ -414,103 +441,151 @@ bool ImplicitNullChecks::analyzeBlockForNullChecks(
   // the safety of ptr->field can be dependent on some_cond; and, for instance,
   // ptr could be some non-null invalid reference that never gets loaded from
   // because some_cond is always true.
+  //
+  // It does extend to a straight chain of blocks after LblNotNull, each of
+  // which is the only successor of the one before it and has no other
+  // predecessor: once control reaches LblNotNull it runs through all of them.
+  // The same goes for stores, as long as they are not moved above a load that
+  // could read the memory they write.
 
   unsigned PointerReg = MBP.LHS.getReg();
 
   HazardDetector HD(*TRI, *AA);
 
-  for (auto MII = NotNullSucc->begin(), MIE = NotNullSucc->end(); MII != MIE;
-       ++MII) {
-    MachineInstr &MI = *MII;
-    unsigned BaseReg;
-    int64_t Offset;
-    MachineInstr *Dependency = nullptr;
-    if (TII->getMemOpBaseRegImmOfs(MI, BaseReg, Offset, TRI))
-      if (MI.mayLoad() && !MI.isPredicable() && BaseReg == PointerReg &&
-          Offset < PageSize && MI.getDesc().getNumDefs() <= 1 &&
-          HD.isSafeToHoist(&MI, Dependency)) {
-
-        auto DependencyOperandIsOk = [&](MachineOperand &MO) {
-          assert(!(MO.isReg() && MO.isUse()) &&
-                 "No transitive dependendencies please!");
-          if (!MO.isReg() || !MO.getReg() || !MO.isDef())
-            return true;
+  MachineBasicBlock *CurrentBlock = NotNullSucc;
+  for (unsigned NumBlocks = 1;; ++NumBlocks) {
+    for (MachineInstr &MI : *CurrentBlock) {
+      if (analyzeMemOperation(MI, MBB, NotNullSucc, NullSucc, MBP.ConditionDef,
+                              PointerReg, HD, NullCheckList))
+        return true;
 
-          // Make sure that we won't clobber any live ins to the sibling block
-          // by hoisting Dependency.  For instance, we can't hoist INST to
-          // before the null check (even if it safe, and does not violate any
-          // dependencies in the non_null_block) if %rdx is live in to
-          // _null_block.
-          //
-          //    test %rcx, %rcx
-          //    je _null_block
-          //  _non_null_block:
-          //    %rdx<def> = INST
-          //    ...
-          if (AnyAliasLiveIn(TRI, NullSucc, MO.getReg()))
-            return false;
+      HD.rememberInstruction(&MI);
+      if (HD.isClobbered())
+        return false;
+    }
 
-          // Make sure Dependency isn't re-defining the base register.  Then we
-          // won't get the memory operation on the address we want.
-          if (TRI->regsOverlap(MO.getReg(), BaseReg))
-            return false;
+    if (NumBlocks >= MaxBlocksToSearch || CurrentBlock->succ_size() != 1)
+      return false;
 
-          return true;
-        };
+    MachineBasicBlock *Next = *CurrentBlock->succ_begin();
+    if (Next->pred_size() != 1 || Next == &MBB || Next->isEHPad())
+      return false;
+    CurrentBlock = Next;
+  }
+}
 
-        bool DependencyOperandsAreOk =
-            !Dependency ||
-            all_of(Dependency->operands(), DependencyOperandIsOk);
+/// Check whether MI, found on the chain of blocks starting at NotNullSucc
+/// after all the instructions already in HD, can be turned into the implicit
+/// null check of PointerReg done at the end of MBB.  If so, append it to
+/// NullCheckList and return true.
+bool ImplicitNullChecks::analyzeMemOperation(
+    MachineInstr &MI, MachineBasicBlock &MBB, MachineBasicBlock *NotNullSucc,
+    MachineBasicBlock *NullSucc, MachineInstr *CheckOperation,
+    unsigned PointerReg, HazardDetector &HD,
+    SmallVectorImpl<NullCheck> &NullCheckList) {
+  unsigned BaseReg;
+  int64_t Offset;
+  MachineInstr *Dependency = nullptr;
+  if (!TII->getMemOpBaseRegImmOfs(MI, BaseReg, Offset, TRI))
+    return false;
 
-        if (DependencyOperandsAreOk) {
-          NullCheckList.emplace_back(&MI, MBP.ConditionDef, &MBB, NotNullSucc,
-                                     NullSucc, Dependency);
-          return true;
-        }
-      }
+  if (!(MI.mayLoad() || MI.mayStore()) || MI.isPredicable() ||
+      BaseReg != PointerReg || Offset <= -PageSize || Offset >= PageSize ||
+      MI.getDesc().getNumDefs() > 1 || !HD.isSafeToHoist(&MI, Dependency))
+    return false;
+
+  auto DependencyOperandIsOk = [&](MachineOperand &MO) {
+    assert(!(MO.isReg() && MO.isUse()) &&
+           "No transitive dependendencies please!");
+    if (!MO.isReg() || !MO.getReg() || !MO.isDef())
+      return true;
 
-    HD.rememberInstruction(&MI);
-    if (HD.isClobbered())
+    // Make sure that we won't clobber any live ins to the sibling block
+    // by hoisting Dependency.  For instance, we can't hoist INST to
+    // before the null check (even if it safe, and does not violate any
+    // dependencies in the non_null_block) if %rdx is live in to
+    // _null_block.
+    //
+    //    test %rcx, %rcx
+    //    je _null_block
+    //  _non_null_block:
+    //    %rdx<def> = INST
+    //    ...
+    if (AnyAliasLiveIn(TRI, NullSucc, MO.getReg()))
       return false;
-  }
 
-  return false;
+    // Make sure Dependency isn't re-defining the base register.  Then we
+    // won't get the memory operation on the address we want.
+    if (TRI->regsOverlap(MO.getReg(), BaseReg))
+      return false;
+
+    return true;
+  };
+
+  if (Dependency && !all_of(Dependency->operands(), DependencyOperandIsOk))
+    return false;
+
+  NullCheckList.emplace_back(&MI, CheckOperation, &MBB, NotNullSucc, NullSucc,
+                             Dependency);
+  return true;
 }
 
-/// Wrap a machine load instruction, LoadMI, into a FAULTING_LOAD_OP machine
-/// instruction.  The FAULTING_LOAD_OP instruction does the same load as LoadMI
-/// (defining the same register), and branches to HandlerMBB if the load
-/// faults.  The FAULTING_LOAD_OP instruction is inserted at the end of MBB.
+/// Wrap a machine memory instruction, MemMI, into a FAULTING_OP machine
+/// instruction.  The FAULTING_OP instruction does the same memory operation as
+/// MemMI (defining the same register, if any), and branches to HandlerMBB if
+/// the operation faults.  The FAULTING_OP instruction is inserted at the end
+/// of MBB.
 MachineInstr *
-ImplicitNullChecks::insertFaultingLoad(MachineInstr *LoadMI,
-                                       MachineBasicBlock *MBB,
-                                       MachineBasicBlock *HandlerMBB) {
+ImplicitNullChecks::insertFaultingOp(MachineInstr *MemMI,
+                                     MachineBasicBlock *MBB,
+                                     MachineBasicBlock *HandlerMBB) {
   const unsigned NoRegister = 0; // Guaranteed to be the NoRegister value for
                                  // all targets.
 
   DebugLoc DL;
-  unsigned NumDefs = LoadMI->getDesc().getNumDefs();
+  unsigned NumDefs = MemMI->getDesc().getNumDefs();
   assert(NumDefs <= 1 && "other cases unhandled!");
 
   unsigned DefReg = NoRegister;
   if (NumDefs != 0) {
-    DefReg = LoadMI->defs().begin()->getReg();
-    assert(std::distance(LoadMI->defs().begin(), LoadMI->defs().end()) == 1 &&
+    DefReg = MemMI->defs().begin()->getReg();
+    assert(std::distance(MemMI->defs().begin(), MemMI->defs().end()) == 1 &&
            "expected exactly one def!");
   }
 
-  auto MIB = BuildMI(MBB, DL, TII->get(TargetOpcode::FAULTING_LOAD_OP), DefReg)
+  FaultMaps::FaultKind FK;
+  if (MemMI->mayLoad())
+    FK = MemMI->mayStore() ? FaultMaps::FaultingLoadStore
+                           : FaultMaps::FaultingLoad;
+  else
+    FK = FaultMaps::FaultingStore;
+
+  auto MIB = BuildMI(MBB, DL, TII->get(TargetOpcode::FAULTING_OP), DefReg)
+                 .addImm(FK)
                  .addMBB(HandlerMBB)
-                 .addImm(LoadMI->getOpcode());
+                 .addImm(MemMI->getOpcode());
 
-  for (auto &MO : LoadMI->uses())
+  for (auto &MO : MemMI->uses())
     MIB.addOperand(MO);
 
-  MIB.setMemRefs(LoadMI->memoperands_begin(), LoadMI->memoperands_end());
+  MIB.setMemRefs(MemMI->memoperands_begin(), MemMI->memoperands_end());
 
   return MIB;
 }
 
+/// Add Reg as a live-in of each block from From to To, both included.  All the
+/// blocks before To have To on their only path forward.
+static void addLiveInAlongPath(MachineBasicBlock *From, MachineBasicBlock *To,
+                               unsigned Reg) {
+  for (MachineBasicBlock *MBB = From;; MBB = *MBB->succ_begin()) {
+    if (!MBB->isLiveIn(Reg))
+      MBB->addLiveIn(Reg);
+    if (MBB == To)
+      break;
+    assert(MBB->succ_size() == 1 && "Not on the path to the memory operation!");
+  }
+}
+
 /// Rewrite the null checks in NullCheckList into implicit null checks.
 void ImplicitNullChecks::rewriteNullChecks(
     ArrayRef<ImplicitNullChecks::NullCheck> NullCheckList) {
@@ -522,37 +597,38 @@ void ImplicitNullChecks::rewriteNullChecks(
     (void)BranchesRemoved;
     assert(BranchesRemoved > 0 && "expected at least one branch!");
 
+    MachineBasicBlock *DepMBB = nullptr;
     if (auto *DepMI = NC.getOnlyDependency()) {
+      DepMBB = DepMI->getParent();
       DepMI->removeFromParent();
       NC.getCheckBlock()->insert(NC.getCheckBlock()->end(), DepMI);
     }
 
-    // Insert a faulting load where the conditional branch was originally.  We
-    // check earlier ensures that this bit of code motion is legal.  We do not
-    // touch the successors list for any basic block since we haven't changed
-    // control flow, we've just made it implicit.
-    MachineInstr *FaultingLoad = insertFaultingLoad(
+    // Insert a faulting operation where the conditional branch was originally.
+    // We check earlier ensures that this bit of code motion is legal.  We do
+    // not touch the successors list for any basic block since we haven't
+    // changed control flow, we've just made it implicit.
+    MachineInstr *FaultingOp = insertFaultingOp(
         NC.getMemOperation(), NC.getCheckBlock(), NC.getNullSucc());
     // Now the values defined by MemOperation, if any, are live-in of
-    // the block of MemOperation.
-    // The original load operation may define implicit-defs alongside
+    // the blocks from NotNullSucc to the block of MemOperation.
+    // The original memory operation may define implicit-defs alongside
     // the loaded value.
     MachineBasicBlock *MBB = NC.getMemOperation()->getParent();
-    for (const MachineOperand &MO : FaultingLoad->operands()) {
+    for (const MachineOperand &MO : FaultingOp->operands()) {
       if (!MO.isReg() || !MO.isDef())
         continue;
       unsigned Reg = MO.getReg();
-      if (!Reg || MBB->isLiveIn(Reg))
+      if (!Reg)
         continue;
-      MBB->addLiveIn(Reg);
+      addLiveInAlongPath(NC.getNotNullSucc(), MBB, Reg);
     }
 
     if (auto *DepMI = NC.getOnlyDependency()) {
       for (auto &MO : DepMI->operands()) {
         if (!MO.isReg() || !MO.getReg() || !MO.isDef())
           continue;
-        if (!NC.getNotNullSucc()->isLiveIn(MO.getReg()))
-          NC.getNotNullSucc()->addLiveIn(MO.getReg());
+        addLiveInAlongPath(NC.getNotNullSucc(), DepMBB, MO.getReg());
       }
     }
 
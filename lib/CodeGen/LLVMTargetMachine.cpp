@@ -16,6 +16,7 @@
 #include "llvm/CodeGen/AsmPrinter.h"
 #include "llvm/CodeGen/BasicTTIImpl.h"
 #include "llvm/CodeGen/MachineFunctionAnalysis.h"
+#include "llvm/CodeGen/MachineFunctionInitializer.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
@@ -47,6 +48,14 @@ static cl::opt<bool>
     EnableGlobalISel("global-isel", cl::Hidden, cl::init(false),
                      cl::desc("Enable the \"global\" instruction selector"));
 
+// Release the IR of each function once it has been emitted. This lowers the
+// peak memory use of code generation for large modules, such as in LTO, but
+// leaves the module unusable to the caller afterwards.
+static cl::opt<bool>
+    FreeIRAfterCodeGen("free-ir-after-codegen", cl::Hidden, cl::init(false),
+                       cl::desc("Free the IR of each function once it has "
+                                "been emitted"));
+
 void LLVMTargetMachine::initAsmInfo() {
   MRI = TheTarget.createMCRegInfo(getTargetTriple().str());
   MII = TheTarget.createMCInstrInfo();
@@ -170,9 +179,15 @@ addPassesToGenerateCode(LLVMTargetMachine *TM, PassManagerBase &PM,
     if (PassConfig->addRegBankSelect())
       return nullptr;
 
+    if (PassConfig->addGlobalInstructionSelect())
+      return nullptr;
+
   } else if (PassConfig->addInstSelector())
     return nullptr;
 
+  if (MFInitializer)
+    MFInitializer->addPostISelPasses(PM);
+
   PassConfig->addMachinePasses();
 
   PassConfig->setInitialized();
@@ -259,6 +274,8 @@ bool LLVMTargetMachine::addPassesToEmitFile(
     return true;
 
   PM.add(Printer);
+  if (FreeIRAfterCodeGen)
+    PM.add(createFreeFunctionBodiesPass());
 
   return false;
 }
@@ -191,6 +191,10 @@ private:
     }
   };
 
+  /// The VarLocs described by each register, so that a register definition
+  /// only looks at the ranges it may end rather than at all open ranges.
+  DenseMap<unsigned, VarLocSet> VarLocsByReg;
+
   void transferDebugValue(const MachineInstr &MI, OpenRangesSet &OpenRanges,
                           VarLocMap &VarLocIDs);
   void transferRegisterDef(MachineInstr &MI, OpenRangesSet &OpenRanges,
@@ -295,7 +299,10 @@ void LiveDebugValues::transferDebugValue(const MachineInstr &MI,
   // TODO: Currently handles DBG_VALUE which has only reg as location.
   if (isDbgValueDescribedByReg(MI)) {
     VarLoc VL(MI);
+    unsigned NumVarLocs = VarLocIDs.size();
     unsigned ID = VarLocIDs.insert(VL);
+    if (VarLocIDs.size() != NumVarLocs && VL.isDescribedByReg())
+      VarLocsByReg[VL.isDescribedByReg()].set(ID);
     OpenRanges.insert(ID, VL.Var);
   }
 }
@@ -304,6 +311,8 @@ void LiveDebugValues::transferDebugValue(const MachineInstr &MI,
 void LiveDebugValues::transferRegisterDef(MachineInstr &MI,
                                           OpenRangesSet &OpenRanges,
                                           const VarLocMap &VarLocIDs) {
+  if (OpenRanges.empty())
+    return;
   MachineFunction *MF = MI.getParent()->getParent();
   const TargetLowering *TLI = MF->getSubtarget().getTargetLowering();
   unsigned SP = TLI->getStackPointerRegisterToSaveRestore();
@@ -312,23 +321,28 @@ void LiveDebugValues::transferRegisterDef(MachineInstr &MI,
     if (MO.isReg() && MO.isDef() && MO.getReg() &&
         TRI->isPhysicalRegister(MO.getReg())) {
       // Remove ranges of all aliased registers.
-      for (MCRegAliasIterator RAI(MO.getReg(), TRI, true); RAI.isValid(); ++RAI)
-        for (unsigned ID : OpenRanges.getVarLocs())
-          if (VarLocIDs[ID].isDescribedByReg() == *RAI)
-            KillSet.set(ID);
+      for (MCRegAliasIterator RAI(MO.getReg(), TRI, true); RAI.isValid();
+           ++RAI) {
+        auto It = VarLocsByReg.find(*RAI);
+        if (It != VarLocsByReg.end())
+          KillSet |= It->second;
+      }
     } else if (MO.isRegMask()) {
       // Remove ranges of all clobbered registers. Register masks don't usually
       // list SP as preserved.  While the debug info may be off for an
       // instruction or two around callee-cleanup calls, transferring the
       // DEBUG_VALUE across the call is still a better user experience.
-      for (unsigned ID : OpenRanges.getVarLocs()) {
-        unsigned Reg = VarLocIDs[ID].isDescribedByReg();
-        if (Reg && Reg != SP && MO.clobbersPhysReg(Reg))
-          KillSet.set(ID);
+      for (const auto &RegVarLocs : VarLocsByReg) {
+        unsigned Reg = RegVarLocs.first;
+        if (Reg != SP && MO.clobbersPhysReg(Reg))
+          KillSet |= RegVarLocs.second;
       }
     }
   }
-  OpenRanges.erase(KillSet, VarLocIDs);
+  // Only the open ranges are ended.
+  KillSet &= OpenRanges.getVarLocs();
+  if (!KillSet.empty())
+    OpenRanges.erase(KillSet, VarLocIDs);
 }
 
 /// Terminate all open ranges at the end of the current basic block.
@@ -501,6 +515,7 @@ bool LiveDebugValues::ExtendRanges(MachineFunction &MF) {
 
   DEBUG(printVarLocInMBB(MF, OutLocs, VarLocIDs, "Final OutLocs", dbgs()));
   DEBUG(printVarLocInMBB(MF, InLocs, VarLocIDs, "Final InLocs", dbgs()));
+  VarLocsByReg.clear();
   return Changed;
 }
 
@@ -158,6 +158,14 @@ void LiveRangeCalc::extendToUses(LiveRange &LR, unsigned Reg,
                                  LaneBitmask Mask) {
   // Visit all operands that read Reg. This may include partial defs.
   const TargetRegisterInfo &TRI = *MRI->getTargetRegisterInfo();
+
+  // A virtual register with a single def only ever has one value, so the much
+  // cheaper SSA liveness computation can be used instead of extend().
+  VNInfo *SingleDef = nullptr;
+  if (TargetRegisterInfo::isVirtualRegister(Reg) && LR.getNumValNums() == 1 &&
+      MRI->hasOneDef(Reg))
+    SingleDef = LR.getValNumInfo(0);
+
   for (MachineOperand &MO : MRI->reg_nodbg_operands(Reg)) {
     // Clear all kill flags. They will be reinserted after register allocation
     // by LiveIntervalAnalysis::addKillFlags().
@@ -205,7 +213,10 @@ void LiveRangeCalc::extendToUses(LiveRange &LR, unsigned Reg,
 
     // MI is reading Reg. We may have visited MI before if it happens to be
     // reading Reg multiple times. That is OK, extend() is idempotent.
-    extend(LR, UseIdx, Reg);
+    if (SingleDef)
+      extendSingleDef(LR, UseIdx, SingleDef);
+    else
+      extend(LR, UseIdx, Reg);
   }
 }
 
@@ -260,6 +271,64 @@ void LiveRangeCalc::extend(LiveRange &LR, SlotIndex Use, unsigned PhysReg) {
 }
 
 
+void LiveRangeCalc::extendSingleDef(LiveRange &LR, SlotIndex Use,
+                                    VNInfo *VNI) {
+  assert(Use.isValid() && "Invalid SlotIndex");
+  assert(Indexes && "Missing SlotIndexes");
+
+  MachineBasicBlock *UseMBB = Indexes->getMBBFromIndex(Use.getPrevSlot());
+  assert(UseMBB && "No MBB at Use");
+
+  // Is there a def in the same MBB we can extend?
+  if (LR.extendInBlock(Indexes->getMBBStartIdx(UseMBB), Use))
+    return;
+
+  // Walk backwards from UseMBB until the def block is reached. Every block on
+  // the way is live-through, except that UseMBB is only live up to Use unless
+  // a loop brings us back to it. The Seen bits are shared by all uses of the
+  // register, so every block is visited at most once per live range.
+  const MachineBasicBlock *DefMBB = Indexes->getMBBFromIndex(VNI->def);
+  unsigned UseMBBNum = UseMBB->getNumber();
+  SmallVector<unsigned, 16> WorkList(1, UseMBBNum);
+  for (unsigned i = 0; i != WorkList.size(); ++i) {
+    MachineBasicBlock *MBB = MF->getBlockNumbered(WorkList[i]);
+    assert(!MBB->pred_empty() && "Use not dominated by its single def");
+    for (MachineBasicBlock *Pred : MBB->predecessors()) {
+      if (Seen.test(Pred->getNumber()))
+        continue;
+      setLiveOutValue(Pred, VNI);
+
+      // The def block is only live from the def to its end.
+      if (Pred == DefMBB) {
+        SlotIndex Start, End;
+        std::tie(Start, End) = Indexes->getMBBRange(Pred);
+        LR.extendInBlock(Start, End);
+        continue;
+      }
+
+      if (Pred != UseMBB)
+        WorkList.push_back(Pred->getNumber());
+      else
+        // Loopback to UseMBB, so value is really live through.
+        Use = SlotIndex();
+    }
+  }
+
+  if (WorkList.size() > 4)
+    array_pod_sort(WorkList.begin(), WorkList.end());
+
+  LiveRangeUpdater Updater(&LR);
+  for (unsigned BlockNum : WorkList) {
+    SlotIndex Start, End;
+    std::tie(Start, End) = Indexes->getMBBRange(BlockNum);
+    // Trim the live range in UseMBB.
+    if (BlockNum == UseMBBNum && Use.isValid())
+      End = Use;
+    Updater.add(Start, End, VNI);
+  }
+}
+
+
 // This function is called by a client after using the low-level API to add
 // live-out and live-in blocks.  The unique value optimization is not
 // available, SplitEditor::transferValues handles that case directly anyway.
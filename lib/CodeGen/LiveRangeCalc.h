@@ -114,6 +114,14 @@ class LiveRangeCalc {
   bool findReachingDefs(LiveRange &LR, MachineBasicBlock &UseMBB,
                         SlotIndex Kill, unsigned PhysReg);
 
+  /// Extend @p LR, whose only value is @p VNI, to be live at @p Use.
+  ///
+  /// This is the fast path of extend() for a virtual register with a single
+  /// def. In SSA form that def dominates every use, so LR is live through every
+  /// block on a path from the def to @p Use, and there is no need to look up
+  /// live-out values or insert PHI-defs.
+  void extendSingleDef(LiveRange &LR, SlotIndex Use, VNInfo *VNI);
+
   /// updateSSA - Compute the values that will be live in to all requested
   /// blocks in LiveIn.  Create PHI-def values as required to preserve SSA form.
   ///
@@ -54,6 +54,9 @@ class MIRParserImpl {
   LLVMContext &Context;
   StringMap<std::unique_ptr<yaml::MachineFunction>> Functions;
   SlotMapping IRSlots;
+  /// The module that holds the embedded LLVM IR when the machine functions are
+  /// parsed into an existing module.
+  std::unique_ptr<Module> EmbeddedModule;
   /// Maps from register class names to register classes.
   StringMap<const TargetRegisterClass *> Names2RegClasses;
   /// Maps from register bank names to register banks.
@@ -87,6 +90,15 @@ public:
   /// Return null if an error occurred.
   std::unique_ptr<Module> parse();
 
+  /// Parse the machine functions in the MIR file for the functions that are
+  /// already defined in the given module.
+  ///
+  /// The embedded LLVM IR is parsed into a separate module, and only the
+  /// metadata it defines is used by the machine functions.
+  ///
+  /// Return true if an error occurred.
+  bool parseMachineFunctions(Module &M);
+
   /// Parse the machine function in the current YAML document.
   ///
   /// \param NoLLVMIR - set to true when the MIR file doesn't have LLVM IR.
@@ -258,6 +270,40 @@ std::unique_ptr<Module> MIRParserImpl::parse() {
   return M;
 }
 
+bool MIRParserImpl::parseMachineFunctions(Module &M) {
+  yaml::Input In(SM.getMemoryBuffer(SM.getMainFileID())->getBuffer(),
+                 /*Ctxt=*/nullptr, handleYAMLDiag, this);
+  In.setContext(&In);
+
+  if (!In.setCurrentDocument())
+    return static_cast<bool>(In.error());
+
+  if (const auto *BSN =
+          dyn_cast_or_null<yaml::BlockScalarNode>(In.getCurrentNode())) {
+    SMDiagnostic Error;
+    EmbeddedModule = parseAssembly(MemoryBufferRef(BSN->getValue(), Filename),
+                                   Error, Context, &IRSlots);
+    if (!EmbeddedModule) {
+      reportDiagnostic(diagFromBlockStringDiag(Error, BSN->getSourceRange()));
+      return true;
+    }
+    // The global values must come from the given module, which doesn't number
+    // its unnamed globals the same way.
+    IRSlots.GlobalValues.clear();
+    In.nextDocument();
+    if (!In.setCurrentDocument())
+      return false;
+  }
+
+  do {
+    if (parseMachineFunction(In, M, /*NoLLVMIR=*/false))
+      return true;
+    In.nextDocument();
+  } while (In.setCurrentDocument());
+
+  return false;
+}
+
 bool MIRParserImpl::parseMachineFunction(yaml::Input &In, Module &M,
                                          bool NoLLVMIR) {
   auto MF = llvm::make_unique<yaml::MachineFunction>();
@@ -767,6 +813,10 @@ MIRParser::~MIRParser() {}
 
 std::unique_ptr<Module> MIRParser::parseLLVMModule() { return Impl->parse(); }
 
+bool MIRParser::parseMachineFunctions(Module &M) {
+  return Impl->parseMachineFunctions(M);
+}
+
 bool MIRParser::initializeMachineFunction(MachineFunction &MF) {
   return Impl->initializeMachineFunction(MF);
 }
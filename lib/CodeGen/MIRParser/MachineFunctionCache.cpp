@@ -0,0 +1,488 @@
+//===- MachineFunctionCache.cpp - Cache of selected functions -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the cache of machine functions that have just been
+// selected.
+//
+// An entry is a MIR file with a single machine function. Its embedded LLVM IR
+// only defines the metadata that the memory operands of the function refer to;
+// the IR function and the globals come from the module being compiled, which
+// the entry name guarantees to be equivalent.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/MIRParser/MachineFunctionCache.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/CodeGen/MIRParser/MIRParser.h"
+#include "llvm/CodeGen/MIRPrinter.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineMemOperand.h"
+#include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/ModuleSlotTracker.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "machine-function-cache"
+
+STATISTIC(NumHits, "Number of machine functions read from the cache");
+STATISTIC(NumMisses, "Number of machine functions missed in the cache");
+STATISTIC(NumStored, "Number of machine functions stored in the cache");
+
+static void addUint64(SmallVectorImpl<char> &Key, uint64_t I) {
+  for (unsigned N = 0; N < 8; ++N)
+    Key.push_back(I >> (N * 8));
+}
+
+static void addString(SmallVectorImpl<char> &Key, StringRef Str) {
+  addUint64(Key, Str.size());
+  Key.append(Str.begin(), Str.end());
+}
+
+template <typename T> static void addPrinted(SmallVectorImpl<char> &Key,
+                                             const T &Value) {
+  std::string Str;
+  raw_string_ostream OS(Str);
+  Value.print(OS);
+  addString(Key, OS.str());
+}
+
+static void addAttributes(SmallVectorImpl<char> &Key, AttributeSet Attrs) {
+  addUint64(Key, Attrs.getNumSlots());
+  for (unsigned I = 0, E = Attrs.getNumSlots(); I != E; ++I) {
+    unsigned Index = Attrs.getSlotIndex(I);
+    addUint64(Key, Index);
+    addString(Key, Attrs.getSlotAttributes(I).getAsString(Index));
+  }
+}
+
+/// Add the given metadata and everything it refers to. The nodes are numbered
+/// in the order they are reached, so that the key doesn't depend on the rest
+/// of the module.
+static void addMetadata(SmallVectorImpl<char> &Key, const Metadata *MD,
+                        DenseMap<const MDNode *, unsigned> &Numbers) {
+  const auto *N = dyn_cast_or_null<MDNode>(MD);
+  if (!N) {
+    if (MD)
+      addPrinted(Key, *MD);
+    else
+      addString(Key, "null");
+    return;
+  }
+
+  auto Inserted = Numbers.insert(std::make_pair(N, Numbers.size()));
+  addUint64(Key, Inserted.first->second);
+  if (!Inserted.second)
+    return;
+  addUint64(Key, N->getMetadataID());
+  addUint64(Key, N->isDistinct());
+  addUint64(Key, N->getNumOperands());
+  for (const MDOperand &Op : N->operands())
+    addMetadata(Key, Op.get(), Numbers);
+}
+
+static void
+addAttachments(SmallVectorImpl<char> &Key,
+               ArrayRef<std::pair<unsigned, MDNode *>> MDs,
+               ArrayRef<StringRef> KindNames,
+               DenseMap<const MDNode *, unsigned> &Numbers) {
+  addUint64(Key, MDs.size());
+  for (const auto &MD : MDs) {
+    addString(Key, KindNames[MD.first]);
+    addMetadata(Key, MD.second, Numbers);
+  }
+}
+
+/// Add everything instruction selection may look at in a global that the
+/// function refers to.
+static void addGlobalValue(SmallVectorImpl<char> &Key, const GlobalValue &GV) {
+  addString(Key, GV.getName());
+  addPrinted(Key, *GV.getValueType());
+  addUint64(Key, GV.getLinkage());
+  addUint64(Key, GV.getVisibility());
+  addUint64(Key, GV.getDLLStorageClass());
+  addUint64(Key, GV.getThreadLocalMode());
+  addUint64(Key, unsigned(GV.getUnnamedAddr()));
+  addUint64(Key, GV.getAlignment());
+  addString(Key, GV.getSection());
+  const Comdat *C = GV.getComdat();
+  addString(Key, C ? C->getName() : "");
+  addUint64(Key, GV.isDeclaration());
+  if (const auto *F = dyn_cast<Function>(&GV)) {
+    addUint64(Key, F->getCallingConv());
+    addAttributes(Key, F->getAttributes());
+  } else if (const auto *GVar = dyn_cast<GlobalVariable>(&GV)) {
+    // Copies from constant globals are folded into the code.
+    addUint64(Key, GVar->isConstant());
+    if (GVar->isConstant() && GVar->hasDefinitiveInitializer())
+      addPrinted(Key, *GVar->getInitializer());
+  }
+}
+
+static void collectGlobalValues(const Function &F,
+                                SetVector<const GlobalValue *> &GVs) {
+  SmallPtrSet<const Constant *, 16> Visited;
+  SmallVector<const Constant *, 16> Worklist;
+  for (const BasicBlock &BB : F)
+    for (const Instruction &I : BB)
+      for (const Value *Op : I.operands())
+        if (const auto *C = dyn_cast<Constant>(Op))
+          if (Visited.insert(C).second)
+            Worklist.push_back(C);
+
+  while (!Worklist.empty()) {
+    const Constant *C = Worklist.pop_back_val();
+    if (const auto *GV = dyn_cast<GlobalValue>(C)) {
+      GVs.insert(GV);
+      continue;
+    }
+    for (const Value *Op : C->operands())
+      if (Visited.insert(cast<Constant>(Op)).second)
+        Worklist.push_back(cast<Constant>(Op));
+  }
+}
+
+/// Return true if the function may be stored at all, before selecting it.
+static bool isCandidate(const Function &F) {
+  if (F.hasPersonalityFn() || F.hasGC() || F.isVarArg())
+    return false;
+  // The stack protector records its guard slot outside the machine function.
+  if (F.hasFnAttribute(Attribute::StackProtect) ||
+      F.hasFnAttribute(Attribute::StackProtectStrong) ||
+      F.hasFnAttribute(Attribute::StackProtectReq))
+    return false;
+  if (F.getSubprogram())
+    return false;
+  for (const BasicBlock &BB : F)
+    for (const Instruction &I : BB)
+      if (I.getDebugLoc())
+        return false;
+  return true;
+}
+
+/// Return true if the MIR of the selected function describes all of the state
+/// that instruction selection left behind.
+static bool isCacheable(const MachineFunction &MF) {
+  if (const MachineFunctionInfo *Info = MF.getInfoIfCreated())
+    if (!Info->isInInitialState())
+      return false;
+
+  MachineModuleInfo &MMI = MF.getMMI();
+  if (MMI.callsEHReturn() || MMI.callsUnwindInit() ||
+      !MMI.getVariableDbgInfo().empty())
+    return false;
+
+  const MachineFrameInfo &MFI = *MF.getFrameInfo();
+  if (MFI.hasCopyImplyingStackAdjustment())
+    return false;
+  // Stack objects refer to their allocas by name.
+  for (int I = MFI.getObjectIndexBegin(), E = MFI.getObjectIndexEnd(); I != E;
+       ++I)
+    if (const AllocaInst *Alloca = MFI.getObjectAllocation(I))
+      if (!Alloca->hasName())
+        return false;
+
+  for (const MachineBasicBlock &MBB : MF) {
+    if (MBB.isEHPad() || MBB.hasAddressTaken())
+      return false;
+    for (const MachineInstr &MI : MBB) {
+      if (MI.getDebugLoc() || MI.isLabel())
+        return false;
+      for (const MachineOperand &MO : MI.operands())
+        if (MO.isMetadata() || MO.isMCSymbol())
+          return false;
+    }
+  }
+  return true;
+}
+
+/// Collect the metadata that the memory operands of MF refer to, directly or
+/// not.
+static void collectMetadata(const MachineFunction &MF,
+                            SetVector<const MDNode *> &Nodes) {
+  SmallVector<const MDNode *, 16> Worklist;
+  auto Add = [&](const MDNode *N) {
+    if (N && Nodes.insert(N))
+      Worklist.push_back(N);
+  };
+  for (const MachineBasicBlock &MBB : MF)
+    for (const MachineInstr &MI : MBB)
+      for (const MachineMemOperand *MMO : MI.memoperands()) {
+        AAMDNodes AAInfo = MMO->getAAInfo();
+        Add(AAInfo.TBAA);
+        Add(AAInfo.Scope);
+        Add(AAInfo.NoAlias);
+        Add(MMO->getRanges());
+      }
+
+  while (!Worklist.empty()) {
+    const MDNode *N = Worklist.pop_back_val();
+    for (const MDOperand &Op : N->operands())
+      Add(dyn_cast_or_null<MDNode>(Op.get()));
+  }
+}
+
+static void trapDiagnostic(const DiagnosticInfo &DI, void *Context) {
+  if (DI.getSeverity() == DS_Error)
+    *static_cast<bool *>(Context) = true;
+}
+
+namespace {
+
+/// This pass stores the machine functions that were missed in the cache.
+class StoreMachineFunction : public MachineFunctionPass {
+  MachineFunctionCache &Cache;
+
+public:
+  static char ID;
+  StoreMachineFunction(MachineFunctionCache &Cache)
+      : MachineFunctionPass(ID), Cache(Cache) {}
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesAll();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override {
+    Cache.storeMachineFunction(MF);
+    return false;
+  }
+
+  const char *getPassName() const override {
+    return "Store Machine Function In Cache";
+  }
+};
+
+} // end anonymous namespace
+
+char StoreMachineFunction::ID = 0;
+
+MachineFunctionCache::MachineFunctionCache(StringRef CacheDir,
+                                           const TargetMachine &TM)
+    : CacheDir(CacheDir), TM(TM) {
+  // Everything that identifies the code generator, serialized once so that
+  // each lookup only has to hash it along with the function. The floating
+  // point options that are reset from the attributes of each function are
+  // left out, since the function attributes are hashed.
+  SmallString<128> Key;
+  addString(Key, LLVM_VERSION_STRING);
+#ifdef HAVE_LLVM_REVISION
+  addString(Key, LLVM_REVISION);
+#endif
+  addString(Key, TM.getTargetTriple().str());
+  addString(Key, TM.getTargetCPU());
+  addString(Key, TM.getTargetFeatureString());
+  addUint64(Key, TM.getOptLevel());
+  addUint64(Key, TM.getRelocationModel());
+  addUint64(Key, TM.getCodeModel());
+  const TargetOptions &Options = TM.Options;
+  addUint64(Key, Options.HonorSignDependentRoundingFPMathOption);
+  addUint64(Key, Options.GuaranteedTailCallOpt);
+  addUint64(Key, Options.StackAlignmentOverride);
+  addUint64(Key, Options.EnableFastISel);
+  addUint64(Key, Options.TrapUnreachable);
+  addUint64(Key, Options.EmulatedTLS);
+  addUint64(Key, unsigned(Options.FloatABIType));
+  addUint64(Key, unsigned(Options.AllowFPOpFusion));
+  addUint64(Key, unsigned(Options.JTType));
+  addUint64(Key, unsigned(Options.ThreadModel));
+  addUint64(Key, unsigned(Options.EABIVersion));
+  addUint64(Key, unsigned(Options.ExceptionModel));
+  TargetKey = Key.str();
+
+  sys::fs::create_directories(this->CacheDir);
+}
+
+MachineFunctionCache::~MachineFunctionCache() {}
+
+std::string MachineFunctionCache::getEntryPath(const Function &F) const {
+  const Module &M = *F.getParent();
+  SmallString<1024> Key;
+  addString(Key, M.getDataLayoutStr());
+
+  SmallVector<StringRef, 32> KindNames;
+  F.getContext().getMDKindNames(KindNames);
+  DenseMap<const MDNode *, unsigned> Numbers;
+  if (const NamedMDNode *Flags = M.getModuleFlagsMetadata()) {
+    addUint64(Key, Flags->getNumOperands());
+    for (const MDNode *Flag : Flags->operands())
+      addMetadata(Key, Flag, Numbers);
+  }
+
+  // The text of the function names its globals and its values. Metadata and
+  // attribute groups are only printed as references, so they are added
+  // separately. Slots for the metadata of other functions aren't tracked, so
+  // that changes elsewhere in the module renumber as little as possible.
+  {
+    std::string Text;
+    raw_string_ostream OS(Text);
+    ModuleSlotTracker MST(&M, /*ShouldInitializeAllMetadata=*/false);
+    static_cast<const Value &>(F).print(OS, MST);
+    addString(Key, OS.str());
+  }
+  addAttributes(Key, F.getAttributes());
+  SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
+  F.getAllMetadata(MDs);
+  addAttachments(Key, MDs, KindNames, Numbers);
+  for (const BasicBlock &BB : F)
+    for (const Instruction &I : BB) {
+      MDs.clear();
+      I.getAllMetadataOtherThanDebugLoc(MDs);
+      addAttachments(Key, MDs, KindNames, Numbers);
+      if (auto CS = ImmutableCallSite(&I))
+        addAttributes(Key, CS.getAttributes());
+    }
+
+  SetVector<const GlobalValue *> GVs;
+  collectGlobalValues(F, GVs);
+  addUint64(Key, GVs.size());
+  for (const GlobalValue *GV : GVs)
+    addGlobalValue(Key, *GV);
+
+  SHA1 Hasher;
+  Hasher.update(TargetKey);
+  Hasher.update(ArrayRef<uint8_t>((const uint8_t *)Key.data(), Key.size()));
+
+  SmallString<128> EntryPath;
+  sys::path::append(EntryPath, CacheDir, toHex(Hasher.result()) + ".mir");
+  return EntryPath.str();
+}
+
+bool MachineFunctionCache::initializeMachineFunction(MachineFunction &MF) {
+  const Function &F = *MF.getFunction();
+  if (TM.getTargetTriple().isWindowsMSVCEnvironment() || !isCandidate(F))
+    return false;
+
+  std::string EntryPath = getEntryPath(F);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+      MemoryBuffer::getFile(EntryPath);
+  if (!Buffer) {
+    // A miss is followed by a call to storeMachineFunction once the function
+    // has been selected.
+    ++NumMisses;
+    PendingEntries[&F] = std::move(EntryPath);
+    return false;
+  }
+
+  // Entries are checked before they are stored, so one that doesn't parse
+  // was damaged and there is no way to select the function anymore.
+  std::unique_ptr<MIRParser> Parser =
+      createMIRParser(std::move(*Buffer), F.getContext());
+  if (!Parser ||
+      Parser->parseMachineFunctions(*const_cast<Module *>(F.getParent())) ||
+      Parser->initializeMachineFunction(MF))
+    report_fatal_error("invalid machine function cache entry '" + EntryPath +
+                       "'");
+  MF.getProperties().set(MachineFunctionProperties::Property::Selected);
+  ++NumHits;
+  return false;
+}
+
+void MachineFunctionCache::addPostISelPasses(legacy::PassManagerBase &PM) {
+  PM.add(new StoreMachineFunction(*this));
+}
+
+void MachineFunctionCache::storeMachineFunction(const MachineFunction &MF) {
+  const Function &F = *MF.getFunction();
+  auto I = PendingEntries.find(&F);
+  if (I == PendingEntries.end())
+    return;
+  std::string EntryPath = std::move(I->second);
+  PendingEntries.erase(I);
+  if (!isCacheable(MF))
+    return;
+
+  std::string Entry;
+  raw_string_ostream OS(Entry);
+  SetVector<const MDNode *> Nodes;
+  collectMetadata(MF, Nodes);
+  if (!Nodes.empty()) {
+    // Number the nodes the same way the machine function printer does.
+    const Module &M = *F.getParent();
+    ModuleSlotTracker MST(&M);
+    OS << "--- |\n";
+    for (const MDNode *N : Nodes) {
+      std::string Line;
+      raw_string_ostream LineOS(Line);
+      N->print(LineOS, MST, &M);
+      OS << "  " << LineOS.str() << "\n";
+    }
+    OS << "...\n";
+  }
+  std::string Body;
+  raw_string_ostream BodyOS(Body);
+  printMIR(BodyOS, MF);
+  OS << BodyOS.str();
+  OS.flush();
+
+  // Read the entry back into a scratch machine function, and only store it if
+  // that gives the same function again. The parser reports its errors to the
+  // context, which mustn't reach the user.
+  LLVMContext &Context = F.getContext();
+  LLVMContext::DiagnosticHandlerTy OldHandler = Context.getDiagnosticHandler();
+  void *OldContext = Context.getDiagnosticContext();
+  bool Failed = false;
+  Context.setDiagnosticHandler(trapDiagnostic, &Failed);
+  std::string Reread;
+  {
+    std::unique_ptr<MIRParser> Parser =
+        createMIRParser(MemoryBuffer::getMemBuffer(Entry, EntryPath), Context);
+    MachineFunction Scratch(&F, TM, MF.getFunctionNumber(), MF.getMMI());
+    if (Parser &&
+        !Parser->parseMachineFunctions(*const_cast<Module *>(F.getParent())) &&
+        !Parser->initializeMachineFunction(Scratch) && !Failed) {
+      raw_string_ostream RereadOS(Reread);
+      printMIR(RereadOS, Scratch);
+    }
+  }
+  Context.setDiagnosticHandler(OldHandler, OldContext);
+  if (Failed || Reread != Body)
+    return;
+
+  // Write to a temporary file in the cache directory and rename it into
+  // place, so that concurrent compiles sharing the directory never see a
+  // partial entry. Failing to store a function only costs a miss next time.
+  SmallString<128> TempPath;
+  int TempFD;
+  if (sys::fs::createUniqueFile(EntryPath + ".tmp%%%%%%", TempFD, TempPath))
+    return;
+  {
+    raw_fd_ostream FileOS(TempFD, /*shouldClose=*/true);
+    FileOS << Entry;
+    FileOS.close();
+    if (FileOS.has_error()) {
+      FileOS.clear_error();
+      sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (sys::fs::rename(TempPath, EntryPath)) {
+    sys::fs::remove(TempPath);
+    return;
+  }
+  ++NumStored;
+}
@@ -124,6 +124,12 @@ BranchFoldPlacement("branch-fold-placement",
                        "Reduces code size."),
               cl::init(true), cl::Hidden);
 
+static cl::opt<bool> ProfileLayout(
+    "profile-guided-block-placement",
+    cl::desc("Lay out functions with profile data by merging chains along "
+             "the hottest edges instead of using the loop-based algorithm."),
+    cl::init(false), cl::Hidden);
+
 extern cl::opt<unsigned> StaticLikelyProb;
 extern cl::opt<unsigned> ProfileLikelyProb;
 
@@ -331,6 +337,8 @@ class MachineBlockPlacement : public MachineFunctionPass {
   void rotateLoopWithProfile(BlockChain &LoopChain, MachineLoop &L,
                              const BlockFilterSet &LoopBlockSet);
   void collectMustExecuteBBs();
+  bool shouldUseProfileLayout();
+  void buildProfileChain(BlockChain &FunctionChain);
   void buildCFGChains();
   void optimizeBranches();
   void alignBlocks();
@@ -1404,6 +1412,98 @@ void MachineBlockPlacement::collectMustExecuteBBs() {
   }
 }
 
+/// \brief Decide whether the function is laid out by buildProfileChain().
+///
+/// The profile-guided layout trusts the block frequencies completely, so it is
+/// only used when they come from real profile data. It is enabled for all such
+/// functions with -profile-guided-block-placement, or for a single function
+/// with the "block-placement"="profile" attribute.
+bool MachineBlockPlacement::shouldUseProfileLayout() {
+  const Function *Fn = F->getFunction();
+  if (!Fn->getEntryCount())
+    return false;
+  if (Fn->hasFnAttribute("block-placement"))
+    return Fn->getFnAttribute("block-placement").getValueAsString() ==
+           "profile";
+  return ProfileLayout;
+}
+
+/// \brief Lay out the whole function from the profile.
+///
+/// This is a bottom-up chain merging layout which maximizes the fall-through
+/// weight: edges are visited from the hottest to the coldest, and an edge
+/// joins two chains when it goes from the tail of one to the head of the
+/// other. The resulting chains are then placed by decreasing execution
+/// density, which keeps the hot code together and pushes the cold chains
+/// towards the end of the function. Chains starting with an EH pad go last,
+/// like they do in buildChain().
+void MachineBlockPlacement::buildProfileChain(BlockChain &FunctionChain) {
+  struct LayoutEdge {
+    BlockFrequency Freq;
+    MachineBasicBlock *Src;
+    MachineBasicBlock *Dst;
+  };
+  SmallVector<LayoutEdge, 32> Edges;
+  for (MachineBasicBlock &MBB : *F) {
+    BlockFrequency Freq = MBFI->getBlockFreq(&MBB);
+    for (MachineBasicBlock *Succ : MBB.successors()) {
+      // The entry block must stay at the top, and EH pads are never fallen
+      // into.
+      if (Succ == &MBB || Succ == &F->front() || Succ->isEHPad())
+        continue;
+      BlockFrequency EdgeFreq = Freq * MBPI->getEdgeProbability(&MBB, Succ);
+      if (EdgeFreq.getFrequency() == 0)
+        continue;
+      Edges.push_back({EdgeFreq, &MBB, Succ});
+    }
+  }
+  std::stable_sort(Edges.begin(), Edges.end(),
+                   [](const LayoutEdge &A, const LayoutEdge &B) {
+                     return A.Freq > B.Freq;
+                   });
+
+  for (const LayoutEdge &E : Edges) {
+    BlockChain *SrcChain = BlockToChain[E.Src];
+    BlockChain *DstChain = BlockToChain[E.Dst];
+    if (SrcChain == DstChain || *std::prev(SrcChain->end()) != E.Src ||
+        *DstChain->begin() != E.Dst)
+      continue;
+    DEBUG(dbgs() << "Merging along profile edge: " << getBlockName(E.Src)
+                 << " -> " << getBlockName(E.Dst) << "\n");
+    SrcChain->merge(E.Dst, DstChain);
+  }
+
+  // Collect the remaining chains in their original order, with the execution
+  // density of each one.
+  SmallVector<std::pair<BlockChain *, uint64_t>, 16> Chains;
+  SmallPtrSet<BlockChain *, 16> SeenChains;
+  SeenChains.insert(&FunctionChain);
+  for (MachineBasicBlock &MBB : *F) {
+    BlockChain *Chain = BlockToChain[&MBB];
+    if (!SeenChains.insert(Chain).second)
+      continue;
+    uint64_t Freq = 0;
+    unsigned Size = 0;
+    for (MachineBasicBlock *ChainBB : *Chain) {
+      Freq += MBFI->getBlockFreq(ChainBB).getFrequency();
+      ++Size;
+    }
+    Chains.push_back(std::make_pair(Chain, Freq / Size));
+  }
+  std::stable_sort(Chains.begin(), Chains.end(),
+                   [](const std::pair<BlockChain *, uint64_t> &A,
+                      const std::pair<BlockChain *, uint64_t> &B) {
+                     bool AIsEHPad = (*A.first->begin())->isEHPad();
+                     bool BIsEHPad = (*B.first->begin())->isEHPad();
+                     if (AIsEHPad != BIsEHPad)
+                       return BIsEHPad;
+                     return A.second > B.second;
+                   });
+
+  for (auto &C : Chains)
+    FunctionChain.merge(*C.first->begin(), C.first);
+}
+
 void MachineBlockPlacement::buildCFGChains() {
   // Ensure that every BB in the function has an associated chain to simplify
   // the assumptions of the remaining algorithm.
@@ -1435,22 +1535,26 @@ void MachineBlockPlacement::buildCFGChains() {
     }
   }
 
-  // Turned on with OutlineOptionalBranches option
-  collectMustExecuteBBs();
+  BlockChain &FunctionChain = *BlockToChain[&F->front()];
+  if (shouldUseProfileLayout()) {
+    buildProfileChain(FunctionChain);
+  } else {
+    // Turned on with OutlineOptionalBranches option
+    collectMustExecuteBBs();
 
-  // Build any loop-based chains.
-  for (MachineLoop *L : *MLI)
-    buildLoopChains(*L);
+    // Build any loop-based chains.
+    for (MachineLoop *L : *MLI)
+      buildLoopChains(*L);
 
-  assert(BlockWorkList.empty());
-  assert(EHPadWorkList.empty());
+    assert(BlockWorkList.empty());
+    assert(EHPadWorkList.empty());
 
-  SmallPtrSet<BlockChain *, 4> UpdatedPreds;
-  for (MachineBasicBlock &MBB : *F)
-    fillWorkLists(&MBB, UpdatedPreds);
+    SmallPtrSet<BlockChain *, 4> UpdatedPreds;
+    for (MachineBasicBlock &MBB : *F)
+      fillWorkLists(&MBB, UpdatedPreds);
 
-  BlockChain &FunctionChain = *BlockToChain[&F->front()];
-  buildChain(&F->front(), FunctionChain);
+    buildChain(&F->front(), FunctionChain);
+  }
 
 #ifndef NDEBUG
   typedef SmallPtrSet<MachineBasicBlock *, 16> FunctionBlockSetType;
@@ -71,6 +71,9 @@ void MachineFunctionProperties::print(raw_ostream &ROS, bool OnlySet) const {
       case Property::AllVRegsAllocated:
         ROS << (HasProperty ? "AllVRegsAllocated" : "HasVRegs");
         break;
+      case Property::Selected:
+        ROS << (HasProperty ? "Selected, " : "");
+        break;
       default:
         break;
     }
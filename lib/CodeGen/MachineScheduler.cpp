@@ -70,6 +70,19 @@ static bool ViewMISchedDAGs = false;
 static cl::opt<unsigned> ReadyListLimit("misched-limit", cl::Hidden,
   cl::desc("Limit ready list to N instructions"), cl::init(256));
 
+/// Avoid building huge dependence graphs by cutting scheduling regions that
+/// have more than this many instructions into several smaller regions.
+static cl::opt<unsigned> MaxRegionInstrs("misched-max-region-size", cl::Hidden,
+  cl::desc("Split scheduling regions larger than N instructions (0 = never)"),
+  cl::init(0));
+
+/// Regions with more than this many instructions are scheduled bottom-up
+/// without register pressure tracking, which is much cheaper per node.
+static cl::opt<unsigned> CheapRegionInstrs("misched-cheap-region-size",
+  cl::Hidden,
+  cl::desc("Use cheap heuristics for regions larger than N instructions "
+           "(0 = never)"), cl::init(0));
+
 static cl::opt<bool> EnableRegPressure("misched-regpressure", cl::Hidden,
   cl::desc("Enable register pressure scheduling."), cl::init(true));
 
@@ -444,22 +457,33 @@ void MachineSchedulerBase::scheduleRegions(ScheduleDAGInstrs &Scheduler,
     //
     // MBB::size() uses instr_iterator to count. Here we need a bundle to count
     // as a single instruction.
+    //
+    // Regions larger than -misched-max-region-size are cut without a boundary
+    // instruction. The top instruction of the region below then serves as
+    // RegionEnd of the region above it, and is not skipped.
+    bool SplitRegion = false;
     for(MachineBasicBlock::iterator RegionEnd = MBB->end();
         RegionEnd != MBB->begin(); RegionEnd = Scheduler.begin()) {
 
       // Avoid decrementing RegionEnd for blocks with no terminator.
-      if (RegionEnd != MBB->end() ||
-          isSchedBoundary(&*std::prev(RegionEnd), &*MBB, MF, TII)) {
+      if (!SplitRegion && (RegionEnd != MBB->end() ||
+          isSchedBoundary(&*std::prev(RegionEnd), &*MBB, MF, TII))) {
         --RegionEnd;
       }
 
       // The next region starts above the previous region. Look backward in the
       // instruction stream until we find the nearest boundary.
       unsigned NumRegionInstrs = 0;
+      SplitRegion = false;
       MachineBasicBlock::iterator I = RegionEnd;
       for (;I != MBB->begin(); --I) {
         if (isSchedBoundary(&*std::prev(I), &*MBB, MF, TII))
           break;
+        if (MaxRegionInstrs && NumRegionInstrs >= MaxRegionInstrs &&
+            !I->isDebugValue()) {
+          SplitRegion = true;
+          break;
+        }
         if (!I->isDebugValue())
           ++NumRegionInstrs;
       }
@@ -2589,6 +2613,14 @@ void GenericScheduler::initPolicy(MachineBasicBlock::iterator Begin,
   // Allow the subtarget to override default policy.
   MF.getSubtarget().overrideSchedPolicy(RegionPolicy, NumRegionInstrs);
 
+  // Pressure tracking dominates the cost of picking each node, so don't do it
+  // in huge regions.
+  if (CheapRegionInstrs && NumRegionInstrs > CheapRegionInstrs) {
+    RegionPolicy.ShouldTrackPressure = false;
+    RegionPolicy.OnlyBottomUp = true;
+    RegionPolicy.OnlyTopDown = false;
+  }
+
   // After subtarget overrides, apply command line options.
   if (!EnableRegPressure)
     RegionPolicy.ShouldTrackPressure = false;
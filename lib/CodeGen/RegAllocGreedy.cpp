@@ -55,6 +55,9 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumSplitAttempts, "Number of live range splitting attempts");
+STATISTIC(NumOverSplitBudget,
+          "Number of functions exceeding the live range splitting budget");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -101,6 +104,29 @@ CSRFirstTimeCost("regalloc-csr-first-time-cost",
               cl::desc("Cost for first time use of callee-saved register."),
               cl::init(0), cl::Hidden);
 
+// Compile-time controls for huge functions. Once one of the budgets is
+// exceeded, the remaining live ranges of the function skip region and local
+// splitting, which run SpillPlacement and the interference cache over large
+// parts of the function, and only try the cheaper per-block and
+// per-instruction splits before being spilled.
+static cl::opt<unsigned> SplitBudget(
+    "regalloc-split-budget", cl::Hidden,
+    cl::desc("Number of live range splitting attempts per function after "
+             "which only cheap splitting is tried (0 = unlimited)"),
+    cl::init(0));
+
+static cl::opt<unsigned> SplitTimeBudget(
+    "regalloc-split-time-budget", cl::Hidden,
+    cl::desc("Milliseconds spent allocating a function after which only "
+             "cheap splitting is tried (0 = unlimited)"),
+    cl::init(0));
+
+static cl::opt<unsigned> MaxEvictionsPerVReg(
+    "regalloc-max-evictions", cl::Hidden,
+    cl::desc("Number of times a live range may be evicted before it stops "
+             "trying to evict others (0 = unlimited)"),
+    cl::init(0));
+
 static RegisterRegAlloc greedyRegAlloc("greedy", "greedy register allocator",
                                        createGreedyRegisterAllocator);
 
@@ -192,6 +218,22 @@ class RAGreedy : public MachineFunctionPass,
 
   uint8_t CutOffInfo;
 
+  // Compile-time accounting for the current function, see SplitBudget.
+  unsigned FuncSplitAttempts;
+  unsigned FuncEvictions;
+  double FuncStartTime;
+  bool OverSplitBudget;
+
+  /// Return true if only cheap splitting should be attempted for the rest of
+  /// the current function.
+  bool isOverSplitBudget();
+
+  /// Return true if VirtReg has been evicted too often to evict others.
+  bool hasExceededEvictions(const LiveInterval &VirtReg) const {
+    return MaxEvictionsPerVReg &&
+           ExtraRegInfo[VirtReg.reg].Evictions >= MaxEvictionsPerVReg;
+  }
+
 #ifndef NDEBUG
   static const char *const StageName[];
 #endif
@@ -203,7 +245,11 @@ class RAGreedy : public MachineFunctionPass,
     // Cascade - Eviction loop prevention. See canEvictInterference().
     unsigned Cascade;
 
-    RegInfo() : Stage(RS_New), Cascade(0) {}
+    // Evictions - Number of times this live range has been evicted. See
+    // -regalloc-max-evictions.
+    unsigned Evictions;
+
+    RegInfo() : Stage(RS_New), Cascade(0), Evictions(0) {}
   };
 
   IndexedMap<RegInfo, VirtReg2IndexFunctor> ExtraRegInfo;
@@ -835,7 +881,9 @@ void RAGreedy::evictInterference(LiveInterval &VirtReg, unsigned PhysReg,
             VirtReg.isSpillable() < Intf->isSpillable()) &&
            "Cannot decrease cascade number, illegal eviction");
     ExtraRegInfo[Intf->reg].Cascade = Cascade;
+    ++ExtraRegInfo[Intf->reg].Evictions;
     ++NumEvicted;
+    ++FuncEvictions;
     NewVRegs.push_back(Intf->reg);
   }
 }
@@ -1945,6 +1993,23 @@ unsigned RAGreedy::tryLocalSplit(LiveInterval &VirtReg, AllocationOrder &Order,
 //                          Live Range Splitting
 //===----------------------------------------------------------------------===//
 
+bool RAGreedy::isOverSplitBudget() {
+  if (OverSplitBudget)
+    return true;
+  if (SplitBudget && FuncSplitAttempts > SplitBudget)
+    OverSplitBudget = true;
+  else if (SplitTimeBudget &&
+           (TimeRecord::getCurrentTime(false).getWallTime() - FuncStartTime) *
+                   1000 > SplitTimeBudget)
+    OverSplitBudget = true;
+  if (OverSplitBudget) {
+    ++NumOverSplitBudget;
+    DEBUG(dbgs() << "Over the splitting budget after " << FuncSplitAttempts
+                 << " attempts, only trying cheap splits from now on\n");
+  }
+  return OverSplitBudget;
+}
+
 /// trySplit - Try to split VirtReg or one of its interferences, making it
 /// assignable.
 /// @return Physreg when VirtReg may be assigned and/or new NewVRegs.
@@ -1954,13 +2019,19 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   if (getStage(VirtReg) >= RS_Spill)
     return 0;
 
+  ++NumSplitAttempts;
+  ++FuncSplitAttempts;
+  bool CheapOnly = isOverSplitBudget();
+
   // Local intervals are handled separately.
   if (LIS->intervalIsInOneMBB(VirtReg)) {
     NamedRegionTimer T("Local Splitting", TimerGroupName, TimePassesIsEnabled);
     SA->analyze(&VirtReg);
-    unsigned PhysReg = tryLocalSplit(VirtReg, Order, NewVRegs);
-    if (PhysReg || !NewVRegs.empty())
-      return PhysReg;
+    if (!CheapOnly) {
+      unsigned PhysReg = tryLocalSplit(VirtReg, Order, NewVRegs);
+      if (PhysReg || !NewVRegs.empty())
+        return PhysReg;
+    }
     return tryInstructionSplit(VirtReg, Order, NewVRegs);
   }
 
@@ -1982,7 +2053,7 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   // First try to split around a region spanning multiple blocks. RS_Split2
   // ranges already made dubious progress with region splitting, so they go
   // straight to single block splitting.
-  if (getStage(VirtReg) < RS_Split2) {
+  if (getStage(VirtReg) < RS_Split2 && !CheapOnly) {
     unsigned PhysReg = tryRegionSplit(VirtReg, Order, NewVRegs);
     if (PhysReg || !NewVRegs.empty())
       return PhysReg;
@@ -2503,8 +2574,9 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
 
   // Try to evict a less worthy live range, but only for ranges from the primary
   // queue. The RS_Split ranges already failed to do this, and they should not
-  // get a second chance until they have been split.
-  if (Stage != RS_Split)
+  // get a second chance until they have been split. Ranges which keep being
+  // evicted are not allowed to evict back.
+  if (Stage != RS_Split && !hasExceededEvictions(VirtReg))
     if (unsigned PhysReg =
             tryEvict(VirtReg, Order, NewVRegs, CostPerUseLimit)) {
       unsigned Hint = MRI->getSimpleHint(VirtReg.reg);
@@ -2607,11 +2679,22 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   IntfCache.init(MF, Matrix->getLiveUnions(), Indexes, LIS, TRI);
   GlobalCand.resize(32);  // This will grow as needed.
   SetOfBrokenHints.clear();
+  FuncSplitAttempts = 0;
+  FuncEvictions = 0;
+  FuncStartTime = TimeRecord::getCurrentTime(false).getWallTime();
+  OverSplitBudget = false;
 
   allocatePhysRegs();
   tryHintsRecoloring();
   postOptimization();
 
+  DEBUG(dbgs() << "Greedy allocation of " << mf.getName() << ": "
+               << FuncSplitAttempts << " split attempts, " << FuncEvictions
+               << " evictions, "
+               << TimeRecord::getCurrentTime(false).getWallTime() -
+                      FuncStartTime
+               << "s\n");
+
   releaseMemory();
   return true;
 }
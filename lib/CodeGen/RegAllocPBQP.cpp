@@ -84,7 +84,8 @@ namespace {
 /// PBQP based allocators solve the register allocation problem by mapping
 /// register allocation problems to Partitioned Boolean Quadratic
 /// Programming problems.
-class RegAllocPBQP : public MachineFunctionPass {
+class RegAllocPBQP : public MachineFunctionPass,
+                     private LiveRangeEdit::Delegate {
 public:
 
   static char ID;
@@ -129,12 +130,27 @@ private:
   /// always available for the remat of all the siblings of the original reg.
   SmallPtrSet<MachineInstr *, 32> DeadRemats;
 
+  /// The allowed registers computed for each vreg in an earlier round. They
+  /// only change if the vreg's live interval does, so they are reused by the
+  /// graphs built after spilling.
+  DenseMap<unsigned, PBQP::RegAlloc::GraphMetadata::AllowedRegVecRef>
+    AllowedRegsCache;
+
+  void LRE_WillShrinkVirtReg(unsigned VReg) override {
+    AllowedRegsCache.erase(VReg);
+  }
+
   /// \brief Finds the initial set of vreg intervals to allocate.
   void findVRegIntervalsToAlloc(const MachineFunction &MF, LiveIntervals &LIS);
 
   /// \brief Constructs an initial graph.
   void initializeGraph(PBQPRAGraph &G, VirtRegMap &VRM, Spiller &VRegSpiller);
 
+  /// \brief Adds the node for \p VReg, which may use the registers in
+  /// \p Allowed.
+  void addNodeForVReg(PBQPRAGraph &G, unsigned VReg,
+                      PBQP::RegAlloc::GraphMetadata::AllowedRegVecRef Allowed);
+
   /// \brief Spill the given VReg.
   void spillVReg(unsigned VReg, SmallVectorImpl<unsigned> &NewIntervals,
                  MachineFunction &MF, LiveIntervals &LIS, VirtRegMap &VRM,
@@ -192,9 +208,27 @@ private:
   typedef std::pair<PBQP::GraphBase::NodeId, PBQP::GraphBase::NodeId> IEdgeKey;
   typedef DenseSet<IEdgeKey> IEdgeCache;
 
+  // Interference matrices are incredibly regular - they're only a function of
+  // the allowed sets, so we cache them to avoid the overhead of constructing
+  // and uniquing them. The caches are kept across rounds of allocation: the
+  // allowed sets are uniqued in a pool shared by the graphs of all rounds.
+  IMatrixCache C;
+
+  // Cache known disjoint allowed registers pairs
+  DisjointAllowedRegsCache D;
+
+  // The allowed sets used as keys above, kept alive so that their addresses
+  // are not reused for other sets.
+  std::vector<PBQP::RegAlloc::GraphMetadata::AllowedRegVecRef> CachedKeys;
+
+  void keepKeyAlive(const PBQPRAGraph &G, PBQPRAGraph::NodeId NId,
+                    PBQPRAGraph::NodeId MId) {
+    CachedKeys.push_back(G.getNodeMetadata(NId).getAllowedRegsPtr());
+    CachedKeys.push_back(G.getNodeMetadata(MId).getAllowedRegsPtr());
+  }
+
   bool haveDisjointAllowedRegs(const PBQPRAGraph &G, PBQPRAGraph::NodeId NId,
-                               PBQPRAGraph::NodeId MId,
-                               const DisjointAllowedRegsCache &D) const {
+                               PBQPRAGraph::NodeId MId) const {
     const auto *NRegs = &G.getNodeMetadata(NId).getAllowedRegs();
     const auto *MRegs = &G.getNodeMetadata(MId).getAllowedRegs();
 
@@ -208,12 +242,12 @@ private:
   }
 
   void setDisjointAllowedRegs(const PBQPRAGraph &G, PBQPRAGraph::NodeId NId,
-                              PBQPRAGraph::NodeId MId,
-                              DisjointAllowedRegsCache &D) {
+                              PBQPRAGraph::NodeId MId) {
     const auto *NRegs = &G.getNodeMetadata(NId).getAllowedRegs();
     const auto *MRegs = &G.getNodeMetadata(MId).getAllowedRegs();
 
     assert(NRegs != MRegs && "AllowedRegs can not be disjoint with itself");
+    keepKeyAlive(G, NId, MId);
 
     if (NRegs < MRegs)
       D.insert(IKey(NRegs, MRegs));
@@ -282,18 +316,10 @@ public:
     // graph. Still, we expect this to be better than N^2.
     LiveIntervals &LIS = G.getMetadata().LIS;
 
-    // Interferenc matrices are incredibly regular - they're only a function of
-    // the allowed sets, so we cache them to avoid the overhead of constructing
-    // and uniquing them.
-    IMatrixCache C;
-
     // Finding an edge is expensive in the worst case (O(max_clique(G))). So
     // cache locally edges we have already seen.
     IEdgeCache EC;
 
-    // Cache known disjoint allowed registers pairs
-    DisjointAllowedRegsCache D;
-
     typedef std::set<IntervalInfo, decltype(&lowestEndPoint)> IntervalSet;
     typedef std::priority_queue<IntervalInfo, std::vector<IntervalInfo>,
                                 decltype(&lowestStartPoint)> IntervalQueue;
@@ -339,7 +365,7 @@ public:
 
         // Do not add an edge when the nodes' allowed registers do not
         // intersect: there is obviously no interference.
-        if (haveDisjointAllowedRegs(G, NId, MId, D))
+        if (haveDisjointAllowedRegs(G, NId, MId))
           continue;
 
         // Check that we haven't already added this edge
@@ -348,8 +374,8 @@ public:
           continue;
 
         // This is a new edge - add it to the graph.
-        if (!createInterferenceEdge(G, NId, MId, C))
-          setDisjointAllowedRegs(G, NId, MId, D);
+        if (!createInterferenceEdge(G, NId, MId))
+          setDisjointAllowedRegs(G, NId, MId);
         else
           EC.insert(EK);
       }
@@ -367,8 +393,7 @@ private:
   // point registers for example.
   // return true iff both nodes interferes.
   bool createInterferenceEdge(PBQPRAGraph &G,
-                              PBQPRAGraph::NodeId NId, PBQPRAGraph::NodeId MId,
-                              IMatrixCache &C) {
+                              PBQPRAGraph::NodeId NId, PBQPRAGraph::NodeId MId) {
 
     const TargetRegisterInfo &TRI =
         *G.getMetadata().MF.getSubtarget().getRegisterInfo();
@@ -401,6 +426,7 @@ private:
 
     PBQPRAGraph::EdgeId EId = G.addEdge(NId, MId, std::move(M));
     C[K] = G.getEdgeCostsPtr(EId);
+    keepKeyAlive(G, NId, MId);
 
     return true;
   }
@@ -573,6 +599,14 @@ void RegAllocPBQP::initializeGraph(PBQPRAGraph &G, VirtRegMap &VRM,
     unsigned VReg = Worklist.back();
     Worklist.pop_back();
 
+    // Reuse the allowed set from an earlier round if the vreg's live interval
+    // has not changed since.
+    auto CachedAllowed = AllowedRegsCache.find(VReg);
+    if (CachedAllowed != AllowedRegsCache.end()) {
+      addNodeForVReg(G, VReg, CachedAllowed->second);
+      continue;
+    }
+
     const TargetRegisterClass *TRC = MRI.getRegClass(VReg);
     LiveInterval &VRegLI = LIS.getInterval(VReg);
 
@@ -616,20 +650,30 @@ void RegAllocPBQP::initializeGraph(PBQPRAGraph &G, VirtRegMap &VRM,
       continue;
     }
 
-    PBQPRAGraph::RawVector NodeCosts(VRegAllowed.size() + 1, 0);
+    auto Allowed = G.getMetadata().getAllowedRegs(std::move(VRegAllowed));
+    AllowedRegsCache[VReg] = Allowed;
+    addNodeForVReg(G, VReg, std::move(Allowed));
+  }
+}
 
-    // Tweak cost of callee saved registers, as using then force spilling and
-    // restoring them. This would only happen in the prologue / epilogue though.
-    for (unsigned i = 0; i != VRegAllowed.size(); ++i)
-      if (isACalleeSavedRegister(VRegAllowed[i], TRI, MF))
-        NodeCosts[1 + i] += 1.0;
+void RegAllocPBQP::addNodeForVReg(
+    PBQPRAGraph &G, unsigned VReg,
+    PBQP::RegAlloc::GraphMetadata::AllowedRegVecRef Allowed) {
+  MachineFunction &MF = G.getMetadata().MF;
+  const TargetRegisterInfo &TRI = *MF.getSubtarget().getRegisterInfo();
 
-    PBQPRAGraph::NodeId NId = G.addNode(std::move(NodeCosts));
-    G.getNodeMetadata(NId).setVReg(VReg);
-    G.getNodeMetadata(NId).setAllowedRegs(
-      G.getMetadata().getAllowedRegs(std::move(VRegAllowed)));
-    G.getMetadata().setNodeIdForVReg(VReg, NId);
-  }
+  PBQPRAGraph::RawVector NodeCosts(Allowed->size() + 1, 0);
+
+  // Tweak cost of callee saved registers, as using then force spilling and
+  // restoring them. This would only happen in the prologue / epilogue though.
+  for (unsigned i = 0; i != Allowed->size(); ++i)
+    if (isACalleeSavedRegister((*Allowed)[i], TRI, MF))
+      NodeCosts[1 + i] += 1.0;
+
+  PBQPRAGraph::NodeId NId = G.addNode(std::move(NodeCosts));
+  G.getNodeMetadata(NId).setVReg(VReg);
+  G.getNodeMetadata(NId).setAllowedRegs(std::move(Allowed));
+  G.getMetadata().setNodeIdForVReg(VReg, NId);
 }
 
 void RegAllocPBQP::spillVReg(unsigned VReg,
@@ -638,8 +682,9 @@ void RegAllocPBQP::spillVReg(unsigned VReg,
                              VirtRegMap &VRM, Spiller &VRegSpiller) {
 
   VRegsToAlloc.erase(VReg);
+  AllowedRegsCache.erase(VReg);
   LiveRangeEdit LRE(&LIS.getInterval(VReg), NewIntervals, MF, LIS, &VRM,
-                    nullptr, &DeadRemats);
+                    this, &DeadRemats);
   VRegSpiller.spill(LRE);
 
   const TargetRegisterInfo &TRI = *MF.getSubtarget().getRegisterInfo();
@@ -787,10 +832,16 @@ bool RegAllocPBQP::runOnMachineFunction(MachineFunction &MF) {
     bool PBQPAllocComplete = false;
     unsigned Round = 0;
 
+    // The allowed sets are uniqued across rounds, so that the costs derived
+    // from them can be cached by the constraints.
+    auto AllowedRegVecs =
+        std::make_shared<PBQPRAGraph::GraphMetadata::AllowedRegVecPool>();
+
     while (!PBQPAllocComplete) {
       DEBUG(dbgs() << "  PBQP Regalloc round " << Round << ":\n");
 
-      PBQPRAGraph G(PBQPRAGraph::GraphMetadata(MF, LIS, MBFI));
+      PBQPRAGraph G(
+          PBQPRAGraph::GraphMetadata(MF, LIS, MBFI, AllowedRegVecs));
       initializeGraph(G, VRM, *VRegSpiller);
       ConstraintsRoot->apply(G);
 
@@ -819,6 +870,7 @@ bool RegAllocPBQP::runOnMachineFunction(MachineFunction &MF) {
   postOptimization(*VRegSpiller, LIS);
   VRegsToAlloc.clear();
   EmptyIntervalVRegs.clear();
+  AllowedRegsCache.clear();
 
   DEBUG(dbgs() << "Post alloc VirtRegMap:\n" << VRM << "\n");
 
@@ -0,0 +1,58 @@
+//===-- SafeStackAccessAnalysis.h - Safety of stack accesses ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_CODEGEN_SAFESTACKACCESSANALYSIS_H
+#define LLVM_LIB_CODEGEN_SAFESTACKACCESSANALYSIS_H
+
+#include "llvm/IR/Use.h"
+#include <cstdint>
+
+namespace llvm {
+
+class AllocaInst;
+class DataLayout;
+class MemIntrinsic;
+class ScalarEvolution;
+class Value;
+
+namespace safestack {
+
+/// Decide whether all the accesses to a stack object, an alloca or a byval
+/// argument, are statically known to be memory safe: they stay within the
+/// bounds of the object, as computed by ScalarEvolution, and the address of
+/// the object doesn't escape.
+///
+/// SafeStack keeps such objects on the safe stack, and StackProtector doesn't
+/// need a canary to protect them.
+class AccessAnalysis {
+  const DataLayout &DL;
+  ScalarEvolution &SE;
+
+  bool isAccessSafe(Value *Addr, uint64_t AccessSize, const Value *AllocaPtr,
+                    uint64_t AllocaSize);
+  bool isMemIntrinsicSafe(const MemIntrinsic *MI, const Use &U,
+                          const Value *AllocaPtr, uint64_t AllocaSize);
+
+public:
+  AccessAnalysis(const DataLayout &DL, ScalarEvolution &SE) : DL(DL), SE(SE) {}
+
+  /// Calculate the allocation size of a given alloca. Returns 0 if the size
+  /// can not be statically determined.
+  static uint64_t getStaticAllocaAllocationSize(const DataLayout &DL,
+                                                const AllocaInst *AI);
+
+  /// Check whether all the accesses through \p AllocaPtr to the object of
+  /// \p AllocaSize bytes it points to are memory safe.
+  bool isSafeStackObject(const Value *AllocaPtr, uint64_t AllocaSize);
+};
+
+} // end namespace safestack
+} // end namespace llvm
+
+#endif // LLVM_LIB_CODEGEN_SAFESTACKACCESSANALYSIS_H
@@ -66,6 +66,13 @@ static cl::opt<unsigned> ReductionSize(
     cl::desc("A huge scheduling region will have maps reduced by this many "
              "nodes at a time. Defaults to HugeRegion / 2."));
 
+// Once this many pairs of memory operations in a region have been checked
+// with alias analysis, the remaining pairs get conservative chain edges.
+static cl::opt<unsigned> MaxAAQueries("dag-max-alias-queries", cl::Hidden,
+    cl::init(0), cl::desc("The number of alias analysis queries per "
+                          "scheduling region after which aliasing is assumed "
+                          "(0 = unlimited)."));
+
 static unsigned getReductionSize() {
   // Always reduce a huge region with half of the elements, except
   // when user sets this number explicitly.
@@ -91,7 +98,8 @@ ScheduleDAGInstrs::ScheduleDAGInstrs(MachineFunction &mf,
                                      bool RemoveKillFlags)
     : ScheduleDAG(mf), MLI(mli), MFI(mf.getFrameInfo()),
       RemoveKillFlags(RemoveKillFlags), CanHandleTerminators(false),
-      TrackLaneMasks(false), AAForDep(nullptr), BarrierChain(nullptr),
+      TrackLaneMasks(false), AAForDep(nullptr), NumAAQueries(0),
+      BarrierChain(nullptr),
       UnknownValue(UndefValue::get(
                      Type::getVoidTy(mf.getFunction()->getContext()))),
       FirstDbgValue(nullptr) {
@@ -621,7 +629,10 @@ static bool MIsNeedChainEdge(AliasAnalysis *AA, const MachineFrameInfo *MFI,
 /// Check whether two objects need a chain edge and add it if needed.
 void ScheduleDAGInstrs::addChainDependency (SUnit *SUa, SUnit *SUb,
                                             unsigned Latency) {
-  if (MIsNeedChainEdge(AAForDep, MFI, MF.getDataLayout(), SUa->getInstr(),
+  AliasAnalysis *AA = AAForDep;
+  if (AA && MaxAAQueries && NumAAQueries++ >= MaxAAQueries)
+    AA = nullptr;
+  if (MIsNeedChainEdge(AA, MFI, MF.getDataLayout(), SUa->getInstr(),
 		       SUb->getInstr())) {
     SDep Dep(SUa, SDep::MayAliasMem);
     Dep.setLatency(Latency);
@@ -852,6 +863,7 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
   bool UseAA = EnableAASchedMI.getNumOccurrences() > 0 ? EnableAASchedMI
                                                        : ST.useAA();
   AAForDep = UseAA ? AA : nullptr;
+  NumAAQueries = 0;
 
   BarrierChain = nullptr;
 
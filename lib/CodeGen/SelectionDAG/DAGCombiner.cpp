@@ -33,6 +33,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetLowering.h"
 #include "llvm/Target/TargetOptions.h"
@@ -49,6 +50,8 @@ STATISTIC(PostIndexedNodes, "Number of post-indexed nodes created");
 STATISTIC(OpsNarrowed     , "Number of load/op/store narrowed");
 STATISTIC(LdStFP2Int      , "Number of fp load/store pairs transformed to int");
 STATISTIC(SlicedLoads, "Number of load sliced");
+STATISTIC(CombineAttempts, "Number of dag nodes visited by the combiner");
+STATISTIC(CombinesSkipped, "Number of known failing combines skipped");
 
 namespace {
   static cl::opt<bool>
@@ -82,6 +85,22 @@ namespace {
     MaySplitLoadIndex("combiner-split-load-index", cl::Hidden, cl::init(true),
                       cl::desc("DAG combiner may split indexing from loads"));
 
+  /// Remember the nodes no combine applied to, and don't visit them again
+  /// until one of their operands is replaced. This ignores changes which
+  /// don't touch the node itself, such as a drop in the number of uses of
+  /// an operand, so it may miss some folds.
+  static cl::opt<bool>
+    MemoizeFailedCombines("combiner-memoize-failures", cl::Hidden,
+                  cl::init(false),
+                  cl::desc("Don't revisit dag nodes which failed to combine "
+                           "until one of their operands changes"));
+
+  static cl::opt<bool>
+    TimeCombinesPerOpcode("combiner-time-per-opcode", cl::Hidden,
+                  cl::init(false),
+                  cl::desc("Time the DAG combiner separately for each node "
+                           "opcode"));
+
 //------------------------------ DAGCombiner ---------------------------------//
 
   class DAGCombiner {
@@ -115,8 +134,14 @@ namespace {
     /// which have not yet been combined to the worklist.
     SmallPtrSet<SDNode *, 32> CombinedNodes;
 
-    // AA - Used for DAG load/store alias analysis.
-    AliasAnalysis &AA;
+    /// \brief Set of nodes which nothing could be combined into.
+    ///
+    /// Only used with -combiner-memoize-failures. A node leaves the set when
+    /// it is updated in place or deleted.
+    SmallPtrSet<SDNode *, 32> FailedNodes;
+
+    // AA - Used for DAG load/store alias analysis. Null at -O0.
+    AliasAnalysis *AA;
 
     /// When an instruction is simplified, add all users of the instruction to
     /// the work lists because they might get more simplified now.
@@ -144,6 +169,7 @@ namespace {
     /// Remove all instances of N from the worklist.
     void removeFromWorklist(SDNode *N) {
       CombinedNodes.erase(N);
+      FailedNodes.erase(N);
 
       auto It = WorklistMap.find(N);
       if (It == WorklistMap.end())
@@ -154,6 +180,9 @@ namespace {
       WorklistMap.erase(It);
     }
 
+    /// N has been modified in place, so a combine may now apply to it.
+    void nodeUpdated(SDNode *N) { FailedNodes.erase(N); }
+
     void deleteAndRecombine(SDNode *N);
     bool recursivelyDeleteUnusedNodes(SDNode *N);
 
@@ -472,7 +501,7 @@ namespace {
     SDValue distributeTruncateThroughAnd(SDNode *N);
 
   public:
-    DAGCombiner(SelectionDAG &D, AliasAnalysis &A, CodeGenOpt::Level OL)
+    DAGCombiner(SelectionDAG &D, AliasAnalysis *A, CodeGenOpt::Level OL)
         : DAG(D), TLI(D.getTargetLoweringInfo()), Level(BeforeLegalizeTypes),
           OptLevel(OL), LegalOperations(false), LegalTypes(false), AA(A) {
       ForCodeSize = DAG.getMachineFunction().getFunction()->optForSize();
@@ -521,6 +550,10 @@ public:
   void NodeDeleted(SDNode *N, SDNode *E) override {
     DC.removeFromWorklist(N);
   }
+
+  void NodeUpdated(SDNode *N) override {
+    DC.nodeUpdated(N);
+  }
 };
 }
 
@@ -1302,6 +1335,11 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
         continue;
     }
 
+    if (MemoizeFailedCombines && FailedNodes.count(N)) {
+      ++CombinesSkipped;
+      continue;
+    }
+
     DEBUG(dbgs() << "\nCombining: "; N->dump(&DAG));
 
     // Add any operands of the new node which have not yet been combined to the
@@ -1312,10 +1350,21 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
       if (!CombinedNodes.count(ChildN.getNode()))
         AddToWorklist(ChildN.getNode());
 
-    SDValue RV = combine(N);
+    ++CombineAttempts;
+    SDValue RV;
+    if (TimeCombinesPerOpcode) {
+      NamedRegionTimer T(N->getOperationName(&DAG), "DAG Combiner",
+                         /*Enabled=*/true);
+      RV = combine(N);
+    } else {
+      RV = combine(N);
+    }
 
-    if (!RV.getNode())
+    if (!RV.getNode()) {
+      if (MemoizeFailedCombines)
+        FailedNodes.insert(N);
       continue;
+    }
 
     ++NodesCombined;
 
@@ -14814,7 +14863,7 @@ bool DAGCombiner::isAlias(LSBaseSDNode *Op0, LSBaseSDNode *Op1) const {
       CombinerAAOnlyFunc != DAG.getMachineFunction().getName())
     UseAA = false;
 #endif
-  if (UseAA &&
+  if (UseAA && AA &&
       Op0->getMemOperand()->getValue() && Op1->getMemOperand()->getValue()) {
     // Use alias analysis information.
     int64_t MinOffset = std::min(Op0->getSrcValueOffset(),
@@ -14824,7 +14873,7 @@ bool DAGCombiner::isAlias(LSBaseSDNode *Op0, LSBaseSDNode *Op1) const {
     int64_t Overlap2 = (Op1->getMemoryVT().getSizeInBits() >> 3) +
         Op1->getSrcValueOffset() - MinOffset;
     AliasResult AAResult =
-        AA.alias(MemoryLocation(Op0->getMemOperand()->getValue(), Overlap1,
+        AA->alias(MemoryLocation(Op0->getMemOperand()->getValue(), Overlap1,
                                 UseTBAA ? Op0->getAAInfo() : AAMDNodes()),
                  MemoryLocation(Op1->getMemOperand()->getValue(), Overlap2,
                                 UseTBAA ? Op1->getAAInfo() : AAMDNodes()));
@@ -15019,7 +15068,7 @@ bool DAGCombiner::findBetterNeighborChains(StoreSDNode* St) {
 }
 
 /// This is the entry point for the file.
-void SelectionDAG::Combine(CombineLevel Level, AliasAnalysis &AA,
+void SelectionDAG::Combine(CombineLevel Level, AliasAnalysis *AA,
                            CodeGenOpt::Level OptLevel) {
   /// This is the main entry point to this class.
   DAGCombiner(*this, AA, OptLevel).Run(Level);
@@ -356,6 +356,7 @@ void FunctionLoweringInfo::clear() {
   ByValArgFrameIndexMap.clear();
   RegFixups.clear();
   StatepointStackSlots.clear();
+  StatepointStackSlotIndices.clear();
   StatepointSpillMaps.clear();
   PreferredExtendType.clear();
 }
@@ -358,6 +358,18 @@ private:
                      MachineBasicBlock *SwitchMBB,
                      MachineBasicBlock *DefaultMBB);
 
+  /// If one case cluster of SI is taken more often than -switch-peel-threshold,
+  /// test it on its own in the current block and remove it from Clusters.
+  /// Return the block the rest of the switch is lowered in, and set
+  /// PeeledCaseProb to the probability of the peeled case.
+  MachineBasicBlock *peelDominantCaseCluster(const SwitchInst &SI,
+                                             CaseClusterVector &Clusters,
+                                             BranchProbability &PeeledCaseProb);
+
+  /// Emit a switch-lowering remark describing the clusters SI was split into.
+  void reportSwitchLowering(const SwitchInst &SI,
+                            const CaseClusterVector &Clusters, bool Peeled);
+
 
   /// A class which encapsulates all of the information needed to generate a
   /// stack protector check and signals to isel via its state being initialized
@@ -612,7 +624,7 @@ public:
       HasTailCall(false) {
   }
 
-  void init(GCFunctionInfo *gfi, AliasAnalysis &aa,
+  void init(GCFunctionInfo *gfi, AliasAnalysis *aa,
             const TargetLibraryInfo *li);
 
   /// clear - Clear out the current SelectionDAG and the associated
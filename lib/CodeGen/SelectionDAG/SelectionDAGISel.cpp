@@ -68,10 +68,22 @@ STATISTIC(NumFastIselFailures, "Number of instructions fast isel failed on");
 STATISTIC(NumFastIselSuccess, "Number of instructions fast isel selected");
 STATISTIC(NumFastIselBlocks, "Number of blocks selected entirely by fast isel");
 STATISTIC(NumDAGBlocks, "Number of blocks selected using DAG");
+STATISTIC(NumDAGRegionSplits, "Number of times a block was split between DAGs");
 STATISTIC(NumDAGIselRetries,"Number of times dag isel has to try another path");
 STATISTIC(NumEntryBlocks, "Number of entry blocks encountered");
 STATISTIC(NumFastIselFailLowerArguments,
           "Number of entry blocks where fast isel failed to lower arguments");
+// Why fast isel handed an instruction to SelectionDAG. Calls are selected on
+// their own and fast isel resumes above them; any other miss sends the rest
+// of the block to SelectionDAG.
+STATISTIC(NumFastIselMissCall, "Number of calls fast isel missed");
+STATISTIC(NumFastIselMissIntrinsic,
+          "Number of intrinsic calls fast isel missed");
+STATISTIC(NumFastIselMissSwitch, "Number of switches fast isel missed");
+STATISTIC(NumFastIselMissTerminator,
+          "Number of other terminators fast isel missed");
+STATISTIC(NumFastIselMissOther,
+          "Number of other instructions fast isel missed");
 
 #ifndef NDEBUG
 static cl::opt<bool>
@@ -179,6 +191,11 @@ static cl::opt<int> EnableFastISelAbort(
              "abort for argument lowering, and 3 will never fallback "
              "to SelectionDAG."));
 
+static cl::opt<unsigned>
+MaxDAGRegionSize("max-dag-region-size", cl::Hidden, cl::init(0),
+          cl::desc("Split basic blocks into separate DAGs of about this many "
+                   "instructions (0 = build one DAG per block)"));
+
 static cl::opt<bool>
 UseMBPI("use-mbpi",
         cl::desc("use Machine Branch Probability Info"),
@@ -375,7 +392,8 @@ SelectionDAGISel::~SelectionDAGISel() {
 }
 
 void SelectionDAGISel::getAnalysisUsage(AnalysisUsage &AU) const {
-  AU.addRequired<AAResultsWrapperPass>();
+  if (OptLevel != CodeGenOpt::None)
+    AU.addRequired<AAResultsWrapperPass>();
   AU.addRequired<GCModuleInfo>();
   AU.addRequired<StackProtector>();
   AU.addPreserved<StackProtector>();
@@ -441,6 +459,13 @@ bool SelectionDAGISel::runOnMachineFunction(MachineFunction &mf) {
   // codegen looking at the optimization level explicitly when
   // it wants to look at it.
   TM.resetTargetOptions(Fn);
+
+  // The instructions may already have been selected, e.g. when the function
+  // was read from a cache. The target options are still reset above, as the
+  // passes that follow rely on them.
+  if (mf.getProperties().hasProperty(
+          MachineFunctionProperties::Property::Selected))
+    return false;
   // Reset OptLevel to None for optnone functions.
   CodeGenOpt::Level NewOptLevel = OptLevel;
   if (Fn.hasFnAttribute(Attribute::OptimizeNone))
@@ -450,7 +475,12 @@ bool SelectionDAGISel::runOnMachineFunction(MachineFunction &mf) {
   TII = MF->getSubtarget().getInstrInfo();
   TLI = MF->getSubtarget().getTargetLowering();
   RegInfo = &MF->getRegInfo();
-  AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
+  // Alias analysis is only used to relax chains and to combine memory
+  // operations. At -O0 neither is worth building the dominator tree for.
+  if (OptLevel != CodeGenOpt::None)
+    AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
+  else
+    AA = nullptr;
   LibInfo = &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
   GFI = Fn.hasGC() ? &getAnalysis<GCModuleInfo>().getFunctionInfo(Fn) : nullptr;
 
@@ -466,7 +496,7 @@ bool SelectionDAGISel::runOnMachineFunction(MachineFunction &mf) {
   else
     FuncInfo->BPI = nullptr;
 
-  SDB->init(GFI, *AA, LibInfo);
+  SDB->init(GFI, AA, LibInfo);
 
   MF->setHasInlineAsm(false);
 
@@ -662,21 +692,108 @@ bool SelectionDAGISel::runOnMachineFunction(MachineFunction &mf) {
   return true;
 }
 
+/// Returns true if V is used by an instruction of BB which hasn't been lowered
+/// yet. PHI nodes don't count, their operands are always exported.
+static bool
+isUsedLaterInBlock(const Value *V, const BasicBlock *BB,
+                   const SmallPtrSetImpl<const Instruction *> &Lowered) {
+  for (const User *U : V->users()) {
+    const Instruction *UI = dyn_cast<Instruction>(U);
+    if (UI && UI->getParent() == BB && !isa<PHINode>(UI) && !Lowered.count(UI))
+      return true;
+  }
+  return false;
+}
+
+/// Returns true if the DAG can be ended after the instructions from \p Begin
+/// to \p End, i.e. if every value they define which is used by the rest of
+/// the block can be carried over in virtual registers.
+static bool canEndDAGRegion(BasicBlock::const_iterator Begin,
+                            BasicBlock::const_iterator End,
+                            const SmallPtrSetImpl<const Instruction *> &Lowered,
+                            const SelectionDAGBuilder &SDB,
+                            const FunctionLoweringInfo &FuncInfo) {
+  for (BasicBlock::const_iterator I = Begin; I != End; ++I) {
+    if (I->getType()->isVoidTy() || FuncInfo.ValueMap.count(&*I))
+      continue;
+    if (const AllocaInst *AI = dyn_cast<AllocaInst>(I))
+      if (FuncInfo.StaticAllocaMap.count(AI))
+        continue;
+    if (!isUsedLaterInBlock(&*I, I->getParent(), Lowered))
+      continue;
+    if (I->getType()->isTokenTy() || I->getType()->isEmptyTy() ||
+        !SDB.findValue(&*I))
+      return false;
+  }
+  return true;
+}
+
 void SelectionDAGISel::SelectBasicBlock(BasicBlock::const_iterator Begin,
                                         BasicBlock::const_iterator End,
                                         bool &HadTailCall) {
-  // Lower the instructions. If a call is emitted as a tail call, cease emitting
-  // nodes for this block.
-  for (BasicBlock::const_iterator I = Begin; I != End && !SDB->HasTailCall; ++I)
-    SDB->visit(*I);
-
-  // Make sure the root of the DAG is up-to-date.
-  CurDAG->setRoot(SDB->getControlRoot());
-  HadTailCall = SDB->HasTailCall;
-  SDB->clear();
-
-  // Final step, emit the lowered DAG as machine code.
-  CodeGenAndEmitDAG();
+  // The instructions lowered so far, only tracked when huge blocks may be split
+  // into several DAGs.
+  SmallPtrSet<const Instruction *, 32> Lowered;
+  BasicBlock::const_iterator I = Begin;
+
+  while (true) {
+    // Lower the instructions. If a call is emitted as a tail call, cease
+    // emitting nodes for this block.
+    BasicBlock::const_iterator RegionBegin = I;
+    bool EndRegion = false;
+    for (unsigned RegionSize = 0; I != End && !SDB->HasTailCall; ++I) {
+      SDB->visit(*I);
+      if (!MaxDAGRegionSize)
+        continue;
+      Lowered.insert(&*I);
+      if (++RegionSize >= MaxDAGRegionSize && std::next(I) != End &&
+          canEndDAGRegion(RegionBegin, std::next(I), Lowered, *SDB,
+                          *FuncInfo)) {
+        EndRegion = true;
+        ++I;
+        break;
+      }
+    }
+
+    if (EndRegion) {
+      // Scheduling and combining are super-linear in the size of the DAG, so
+      // select the rest of the block in a new one. Values it uses from this
+      // region are copied to virtual registers, exactly as for values used in
+      // other blocks. The regions are emitted in order, so memory operations
+      // stay ordered without a chain between the DAGs.
+      ++NumDAGRegionSplits;
+      const BasicBlock *BB = I->getParent();
+      if (BB == &BB->getParent()->getEntryBlock())
+        for (const Argument &Arg : BB->getParent()->args())
+          if (!FuncInfo->ValueMap.count(&Arg) &&
+              isUsedLaterInBlock(&Arg, BB, Lowered)) {
+            FuncInfo->InitializeRegForValue(&Arg);
+            SDB->CopyToExportRegsIfNeeded(&Arg);
+          }
+      for (BasicBlock::const_iterator J = RegionBegin; J != I; ++J) {
+        if (J->getType()->isVoidTy() || FuncInfo->ValueMap.count(&*J))
+          continue;
+        if (const AllocaInst *AI = dyn_cast<AllocaInst>(J))
+          if (FuncInfo->StaticAllocaMap.count(AI))
+            continue;
+        if (isUsedLaterInBlock(&*J, BB, Lowered)) {
+          FuncInfo->InitializeRegForValue(&*J);
+          SDB->CopyToExportRegsIfNeeded(&*J);
+        }
+      }
+    }
+
+    // Make sure the root of the DAG is up-to-date.
+    CurDAG->setRoot(SDB->getControlRoot());
+    HadTailCall = SDB->HasTailCall;
+    SDB->clear();
+
+    // Final step, emit the lowered DAG as machine code.
+    CodeGenAndEmitDAG();
+
+    if (!EndRegion)
+      return;
+  }
 }
 
 void SelectionDAGISel::ComputeLiveOutVRegInfo() {
@@ -752,7 +869,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   // Run the DAG combiner in pre-legalize mode.
   {
     NamedRegionTimer T("DAG Combining 1", GroupName, TimePassesIsEnabled);
-    CurDAG->Combine(BeforeLegalizeTypes, *AA, OptLevel);
+    CurDAG->Combine(BeforeLegalizeTypes, AA, OptLevel);
   }
 
   DEBUG(dbgs() << "Optimized lowered selection DAG: BB#" << BlockNumber
@@ -782,7 +899,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
     {
       NamedRegionTimer T("DAG Combining after legalize types", GroupName,
                          TimePassesIsEnabled);
-      CurDAG->Combine(AfterLegalizeTypes, *AA, OptLevel);
+      CurDAG->Combine(AfterLegalizeTypes, AA, OptLevel);
     }
 
     DEBUG(dbgs() << "Optimized type-legalized selection DAG: BB#" << BlockNumber
@@ -808,7 +925,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
     {
       NamedRegionTimer T("DAG Combining after legalize vectors", GroupName,
                          TimePassesIsEnabled);
-      CurDAG->Combine(AfterLegalizeVectorOps, *AA, OptLevel);
+      CurDAG->Combine(AfterLegalizeVectorOps, AA, OptLevel);
     }
 
     DEBUG(dbgs() << "Optimized vector-legalized selection DAG: BB#"
@@ -832,7 +949,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   // Run the DAG combiner in post-legalize mode.
   {
     NamedRegionTimer T("DAG Combining 2", GroupName, TimePassesIsEnabled);
-    CurDAG->Combine(AfterLegalizeDAG, *AA, OptLevel);
+    CurDAG->Combine(AfterLegalizeDAG, AA, OptLevel);
   }
 
   DEBUG(dbgs() << "Optimized legalized selection DAG: BB#" << BlockNumber
@@ -1396,6 +1513,10 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
 
         // Then handle certain instructions as single-LLVM-Instruction blocks.
         if (isa<CallInst>(Inst)) {
+          if (isa<IntrinsicInst>(Inst))
+            ++NumFastIselMissIntrinsic;
+          else
+            ++NumFastIselMissCall;
 
           if (EnableFastISelVerbose || EnableFastISelAbort) {
             dbgs() << "FastISel missed call: ";
@@ -1433,6 +1554,13 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
           continue;
         }
 
+        if (isa<SwitchInst>(Inst))
+          ++NumFastIselMissSwitch;
+        else if (isa<TerminatorInst>(Inst))
+          ++NumFastIselMissTerminator;
+        else
+          ++NumFastIselMissOther;
+
         bool ShouldAbort = EnableFastISelAbort;
         if (EnableFastISelVerbose || EnableFastISelAbort) {
           if (isa<TerminatorInst>(Inst)) {
@@ -52,7 +52,7 @@ void StatepointLoweringState::startNewStatepoint(SelectionDAGBuilder &Builder) {
   assert(PendingGCRelocateCalls.empty() &&
          "Trying to visit statepoint before finished processing previous one");
   Locations.clear();
-  NextSlotToAllocate = 0;
+  NextSlotToAllocate.clear();
   // Need to resize this on each safepoint - we need the two to stay in sync and
   // the clear patterns of a SelectionDAGBuilder have no relation to
   // FunctionLoweringInfo.  SmallBitVector::reset initializes all bits to false.
@@ -80,18 +80,19 @@ StatepointLoweringState::allocateStackSlot(EVT ValueType,
   // reserved), or to create a new stack slot and use it.
 
   const size_t NumSlots = AllocatedStackSlots.size();
-  assert(NextSlotToAllocate <= NumSlots && "Broken invariant");
+  unsigned &NextSlot = NextSlotToAllocate[SpillSize];
+  assert(NextSlot <= NumSlots && "Broken invariant");
 
   // The stack slots in StatepointStackSlots beyond the first NumSlots were
   // added in this instance of StatepointLoweringState, and cannot be re-used.
   assert(NumSlots <= Builder.FuncInfo.StatepointStackSlots.size() &&
          "Broken invariant");
 
-  for (; NextSlotToAllocate < NumSlots; NextSlotToAllocate++) {
-    if (!AllocatedStackSlots.test(NextSlotToAllocate)) {
-      const int FI = Builder.FuncInfo.StatepointStackSlots[NextSlotToAllocate];
+  for (; NextSlot < NumSlots; NextSlot++) {
+    if (!AllocatedStackSlots.test(NextSlot)) {
+      const int FI = Builder.FuncInfo.StatepointStackSlots[NextSlot];
       if (MFI->getObjectSize(FI) == SpillSize) {
-        AllocatedStackSlots.set(NextSlotToAllocate);
+        AllocatedStackSlots.set(NextSlot);
         return Builder.DAG.getFrameIndex(FI, ValueType);
       }
     }
@@ -103,6 +104,8 @@ StatepointLoweringState::allocateStackSlot(EVT ValueType,
   const unsigned FI = cast<FrameIndexSDNode>(SpillSlot)->getIndex();
   MFI->markAsStatepointSpillSlotObjectIndex(FI);
 
+  Builder.FuncInfo.StatepointStackSlotIndices[FI] =
+      Builder.FuncInfo.StatepointStackSlots.size();
   Builder.FuncInfo.StatepointStackSlots.push_back(FI);
 
   StatepointMaxSlotsRequired = std::max<unsigned long>(
@@ -215,14 +218,14 @@ static void reservePreviousStackSlotForValue(const Value *IncomingValue,
   if (!Index.hasValue())
     return;
 
-  const auto &StatepointSlots = Builder.FuncInfo.StatepointStackSlots;
+  const auto &SlotIndices = Builder.FuncInfo.StatepointStackSlotIndices;
 
-  auto SlotIt = find(StatepointSlots, *Index);
-  assert(SlotIt != StatepointSlots.end() &&
+  auto SlotIt = SlotIndices.find(*Index);
+  assert(SlotIt != SlotIndices.end() &&
          "Value spilled to the unknown stack slot");
 
   // This is one of our dedicated lowering slots
-  const int Offset = std::distance(StatepointSlots.begin(), SlotIt);
+  const int Offset = SlotIt->second;
   if (Builder.StatepointLowering.isStackSlotAllocated(Offset)) {
     // stack slot already assigned to someone else, can't use it!
     // TODO: currently we reserve space for gc arguments after doing
@@ -30,7 +30,7 @@ class SelectionDAGBuilder;
 /// works in concert with information in FunctionLoweringInfo.
 class StatepointLoweringState {
 public:
-  StatepointLoweringState() : NextSlotToAllocate(0) {}
+  StatepointLoweringState() {}
 
   /// Reset all state tracking for a newly encountered safepoint.  Also
   /// performs some consistency checking.
@@ -86,7 +86,6 @@ public:
     assert(Offset >= 0 && Offset < (int)AllocatedStackSlots.size() &&
            "out of bounds");
     assert(!AllocatedStackSlots.test(Offset) && "already reserved!");
-    assert(NextSlotToAllocate <= (unsigned)Offset && "consistency!");
     AllocatedStackSlots.set(Offset);
   }
 
@@ -107,8 +106,11 @@ private:
   /// slots have been allocated.
   SmallBitVector AllocatedStackSlots;
 
-  /// Points just beyond the last slot known to have been allocated
-  unsigned NextSlotToAllocate;
+  /// For each spill size, points just beyond the last slot of that size known
+  /// to have been allocated.  Slots below it are either allocated or of a
+  /// different size, so the search for a free slot never rescans them, and
+  /// allocating one size doesn't skip over free slots of another.
+  SmallDenseMap<unsigned, unsigned, 4> NextSlotToAllocate;
 
   /// Keep track of pending gcrelocate calls for consistency check
   SmallVector<const CallInst *, 10> PendingGCRelocateCalls;
@@ -24,6 +24,8 @@
 #include "llvm/Target/TargetRegisterInfo.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
 #include <iterator>
+#include <map>
+#include <tuple>
 
 using namespace llvm;
 
@@ -31,7 +33,8 @@ using namespace llvm;
 
 static cl::opt<int> StackMapVersion(
     "stackmap-version", cl::init(1),
-    cl::desc("Specify the stackmap encoding version (default = 1)"));
+    cl::desc("Specify the stackmap encoding version (default = 1). Version 2 "
+             "shares identical locations between records"));
 
 const char *StackMaps::WSMP = "Stack Maps: ";
 
@@ -70,7 +73,7 @@ unsigned PatchPointOpers::getNextScratchIdx(unsigned StartIdx) const {
 }
 
 StackMaps::StackMaps(AsmPrinter &AP) : AP(AP) {
-  if (StackMapVersion != 1)
+  if (StackMapVersion != 1 && StackMapVersion != 2)
     llvm_unreachable("Unsupported stackmap version!");
 }
 
@@ -384,13 +387,15 @@ void StackMaps::recordStatepoint(const MachineInstr &MI) {
 /// Emit the stackmap header.
 ///
 /// Header {
-///   uint8  : Stack Map Version (currently 1)
+///   uint8  : Stack Map Version (1 or 2)
 ///   uint8  : Reserved (expected to be 0)
 ///   uint16 : Reserved (expected to be 0)
 /// }
 /// uint32 : NumFunctions
 /// uint32 : NumConstants
 /// uint32 : NumRecords
+/// uint32 : NumLocations (version 2 only)
+/// uint32 : Reserved (version 2 only)
 void StackMaps::emitStackmapHeader(MCStreamer &OS) {
   // Header.
   OS.EmitIntValue(StackMapVersion, 1); // Version.
@@ -406,6 +411,12 @@ void StackMaps::emitStackmapHeader(MCStreamer &OS) {
   // Num callsites.
   DEBUG(dbgs() << WSMP << "#callsites = " << CSInfos.size() << '\n');
   OS.EmitIntValue(CSInfos.size(), 4);
+  if (StackMapVersion == 2) {
+    // Num locations, and padding to keep the records aligned to 8 bytes.
+    DEBUG(dbgs() << WSMP << "#locations = " << LocationTable.size() << '\n');
+    OS.EmitIntValue(LocationTable.size(), 4);
+    OS.EmitIntValue(0, 4);
+  }
 }
 
 /// Emit the function frame record for each function.
@@ -437,6 +448,45 @@ void StackMaps::emitConstantPoolEntries(MCStreamer &OS) {
   }
 }
 
+/// Give each distinct location a slot in the location table. Statepoints in
+/// particular tend to repeat the same spill slots and constants over and over,
+/// so version 2 records refer to the table instead of repeating them inline.
+void StackMaps::buildLocationTable() {
+  typedef std::tuple<unsigned, unsigned, unsigned, int64_t> LocationKey;
+  std::map<LocationKey, unsigned> Indices;
+  for (auto &CSI : CSInfos) {
+    CSI.LocationIndices.clear();
+    // Records that overflow are emitted without locations.
+    if (CSI.Locations.size() > UINT16_MAX || CSI.LiveOuts.size() > UINT16_MAX)
+      continue;
+    for (const auto &Loc : CSI.Locations) {
+      auto Inserted = Indices.insert(std::make_pair(
+          LocationKey(Loc.Type, Loc.Size, Loc.Reg, Loc.Offset),
+          LocationTable.size()));
+      if (Inserted.second)
+        LocationTable.push_back(Loc);
+      CSI.LocationIndices.push_back(Inserted.first->second);
+    }
+  }
+}
+
+/// Emit the location table.
+///
+/// Location[NumLocations] {
+///   uint8  : Register | Direct | Indirect | Constant | ConstantIndex
+///   uint8  : Size in Bytes
+///   uint16 : Dwarf RegNum
+///   int32  : Offset
+/// }
+void StackMaps::emitLocationTable(MCStreamer &OS) {
+  for (const auto &Loc : LocationTable) {
+    OS.EmitIntValue(Loc.Type, 1);
+    OS.EmitIntValue(Loc.Size, 1);
+    OS.EmitIntValue(Loc.Reg, 2);
+    OS.EmitIntValue(Loc.Offset, 4);
+  }
+}
+
 /// Emit the callsite info for each callsite.
 ///
 /// StkMapRecord[NumRecords] {
@@ -460,6 +510,9 @@ void StackMaps::emitConstantPoolEntries(MCStreamer &OS) {
 ///   uint32 : Padding (only if required to align to 8 byte)
 /// }
 ///
+/// In version 2, each record holds a uint32 index into the location table
+/// for each of its NumLocations locations instead of the Location itself.
+///
 /// Location Encoding, Type, Value:
 ///   0x1, Register, Reg                 (value in register)
 ///   0x2, Direct, Reg + Offset          (frame index)
@@ -495,11 +548,16 @@ void StackMaps::emitCallsiteEntries(MCStreamer &OS) {
     OS.EmitIntValue(0, 2);
     OS.EmitIntValue(CSLocs.size(), 2);
 
-    for (const auto &Loc : CSLocs) {
-      OS.EmitIntValue(Loc.Type, 1);
-      OS.EmitIntValue(Loc.Size, 1);
-      OS.EmitIntValue(Loc.Reg, 2);
-      OS.EmitIntValue(Loc.Offset, 4);
+    if (StackMapVersion == 2) {
+      for (unsigned Index : CSI.LocationIndices)
+        OS.EmitIntValue(Index, 4);
+    } else {
+      for (const auto &Loc : CSLocs) {
+        OS.EmitIntValue(Loc.Type, 1);
+        OS.EmitIntValue(Loc.Size, 1);
+        OS.EmitIntValue(Loc.Reg, 2);
+        OS.EmitIntValue(Loc.Offset, 4);
+      }
     }
 
     // Num live-out registers and padding to align to 4 byte.
@@ -540,13 +598,18 @@ void StackMaps::serializeToStackMapSection() {
 
   // Serialize data.
   DEBUG(dbgs() << "********** Stack Map Output **********\n");
+  if (StackMapVersion == 2)
+    buildLocationTable();
   emitStackmapHeader(OS);
   emitFunctionFrameRecords(OS);
   emitConstantPoolEntries(OS);
+  if (StackMapVersion == 2)
+    emitLocationTable(OS);
   emitCallsiteEntries(OS);
   OS.AddBlankLine();
 
   // Clean up.
   CSInfos.clear();
   ConstPool.clear();
+  LocationTable.clear();
 }
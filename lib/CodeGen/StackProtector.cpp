@@ -15,10 +15,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/CodeGen/StackProtector.h"
+#include "SafeStackAccessAnalysis.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/EHPersonalities.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/IR/Attributes.h"
@@ -45,10 +50,63 @@ using namespace llvm;
 STATISTIC(NumFunProtected, "Number of functions protected");
 STATISTIC(NumAddrTaken, "Number of local variables that have their address"
                         " taken.");
+STATISTIC(NumSafeAllocas, "Number of local variables that don't need a "
+                          "protector because all their accesses are safe");
 
 static cl::opt<bool> EnableSelectionDAGSP("enable-selectiondag-sp",
                                           cl::init(true), cl::Hidden);
 
+static cl::opt<bool>
+    SkipSafeAllocas("stack-protector-skip-safe-allocas", cl::init(true),
+                    cl::Hidden,
+                    cl::desc("Don't protect the local variables whose "
+                             "accesses are all proven to be in bounds"));
+
+namespace {
+/// Proves that all the accesses to an alloca stay in its bounds, with the
+/// analysis that SafeStack uses to keep objects on the safe stack. Such an
+/// alloca can't be overflowed, so it doesn't require a protector.
+///
+/// ScalarEvolution and the analyses it needs are only computed for the
+/// functions that have an alloca which would otherwise be protected.
+class SafeAllocaChecker {
+  Function &F;
+  DominatorTree *DT;
+  std::unique_ptr<DominatorTree> LocalDT;
+  std::unique_ptr<LoopInfo> LI;
+  std::unique_ptr<TargetLibraryInfoImpl> TLII;
+  std::unique_ptr<TargetLibraryInfo> LibInfo;
+  std::unique_ptr<AssumptionCache> AC;
+  std::unique_ptr<ScalarEvolution> SE;
+  std::unique_ptr<safestack::AccessAnalysis> Accesses;
+
+public:
+  SafeAllocaChecker(Function &F, DominatorTree *DT) : F(F), DT(DT) {}
+
+  bool isSafe(const AllocaInst *AI) {
+    const DataLayout &DL = F.getParent()->getDataLayout();
+    uint64_t Size =
+        safestack::AccessAnalysis::getStaticAllocaAllocationSize(DL, AI);
+    if (Size == 0)
+      return false;
+    if (!Accesses) {
+      if (!DT) {
+        LocalDT.reset(new DominatorTree(F));
+        DT = LocalDT.get();
+      }
+      LI.reset(new LoopInfo(*DT));
+      TLII.reset(
+          new TargetLibraryInfoImpl(Triple(F.getParent()->getTargetTriple())));
+      LibInfo.reset(new TargetLibraryInfo(*TLII));
+      AC.reset(new AssumptionCache(F));
+      SE.reset(new ScalarEvolution(F, *LibInfo, *AC, *DT, *LI));
+      Accesses.reset(new safestack::AccessAnalysis(DL, *SE));
+    }
+    return Accesses->isSafeStackObject(AI, Size);
+  }
+};
+} // end anonymous namespace
+
 char StackProtector::ID = 0;
 INITIALIZE_PASS(StackProtector, "stack-protector", "Insert stack protectors",
                 false, true)
@@ -211,6 +269,7 @@ bool StackProtector::HasAddressTaken(const Instruction *AI) {
 bool StackProtector::RequiresStackProtector() {
   bool Strong = false;
   bool NeedsProtector = false;
+  bool Required = false;
   for (const BasicBlock &BB : *F)
     for (const Instruction &I : BB)
       if (const CallInst *CI = dyn_cast<CallInst>(&I))
@@ -224,6 +283,7 @@ bool StackProtector::RequiresStackProtector() {
 
   if (F->hasFnAttribute(Attribute::StackProtectReq)) {
     NeedsProtector = true;
+    Required = true;
     Strong = true; // Use the same heuristic as strong to determine SSPLayout
   } else if (F->hasFnAttribute(Attribute::StackProtectStrong))
     Strong = true;
@@ -232,10 +292,23 @@ bool StackProtector::RequiresStackProtector() {
   else if (!F->hasFnAttribute(Attribute::StackProtect))
     return false;
 
+  // Unless a protector is required anyway, an alloca that can't be overflowed
+  // doesn't trigger one.
+  SafeAllocaChecker Checker(*F, DT);
+  auto IsSafe = [&](const AllocaInst *AI) {
+    if (Required || !SkipSafeAllocas || !Checker.isSafe(AI))
+      return false;
+    ++NumSafeAllocas;
+    return true;
+  };
+
   for (const BasicBlock &BB : *F) {
     for (const Instruction &I : BB) {
       if (const AllocaInst *AI = dyn_cast<AllocaInst>(&I)) {
         if (AI->isArrayAllocation()) {
+          if (IsSafe(AI))
+            continue;
+
           // SSP-Strong: Enable protectors for any call to alloca, regardless
           // of size.
           if (Strong)
@@ -262,13 +335,15 @@ bool StackProtector::RequiresStackProtector() {
 
         bool IsLarge = false;
         if (ContainsProtectableArray(AI->getAllocatedType(), IsLarge, Strong)) {
+          if (IsSafe(AI))
+            continue;
           Layout.insert(std::make_pair(AI, IsLarge ? SSPLK_LargeArray
                                                    : SSPLK_SmallArray));
           NeedsProtector = true;
           continue;
         }
 
-        if (Strong && HasAddressTaken(AI)) {
+        if (Strong && HasAddressTaken(AI) && !IsSafe(AI)) {
           ++NumAddrTaken;
           Layout.insert(std::make_pair(AI, SSPLK_AddrOf));
           NeedsProtector = true;
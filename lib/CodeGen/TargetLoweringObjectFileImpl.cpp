@@ -292,9 +292,14 @@ selectELFSectionForGlobal(MCContext &Ctx, const GlobalValue *GV,
     Name += utostr(EntrySize);
   } else {
     Name = getSectionPrefixForGlobal(Kind);
+    // Group the cold functions together, away from the hot text.
+    if (Kind.isText())
+      if (const auto *F = dyn_cast<Function>(GV))
+        if (F->hasFnAttribute(llvm::Attribute::Cold))
+          Name += ".unlikely";
   }
   // FIXME: Extend the section prefix to include hotness catagories such as .hot
-  //  or .unlikely for functions.
+  //  for functions.
 
   if (EmitUniqueSection && UniqueSectionNames) {
     Name.push_back('.');
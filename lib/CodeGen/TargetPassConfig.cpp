@@ -422,7 +422,11 @@ void TargetPassConfig::addIRPasses() {
     addPass(createCFLAAWrapperPass());
   addPass(createTypeBasedAAWrapperPass());
   addPass(createScopedNoAliasAAWrapperPass());
-  addPass(createBasicAAWrapperPass());
+  // BasicAA needs the dominator tree. At -O0 nothing asks for alias analysis,
+  // so don't build either for every function; a pass which does require
+  // AAResultsWrapperPass still gets BasicAA scheduled as its dependency.
+  if (getOptLevel() != CodeGenOpt::None)
+    addPass(createBasicAAWrapperPass());
 
   // Before running any passes, run the verifier to determine if the input
   // coming from the front-end and/or optimizer is valid.
@@ -155,7 +155,7 @@ public:
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.setPreservesCFG();
-    AU.addRequired<AAResultsWrapperPass>();
+    AU.addUsedIfAvailable<AAResultsWrapperPass>();
     AU.addUsedIfAvailable<LiveVariables>();
     AU.addPreserved<LiveVariables>();
     AU.addPreserved<SlotIndexes>();
@@ -1615,8 +1615,13 @@ bool TwoAddressInstructionPass::runOnMachineFunction(MachineFunction &Func) {
   InstrItins = MF->getSubtarget().getInstrItineraryData();
   LV = getAnalysisIfAvailable<LiveVariables>();
   LIS = getAnalysisIfAvailable<LiveIntervals>();
-  AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
   OptLevel = TM.getOptLevel();
+  // Alias analysis only helps the rescheduling done when optimizing. At -O0
+  // nothing else in the pipeline asks for it, so don't force it to be built.
+  AA = nullptr;
+  if (OptLevel != CodeGenOpt::None)
+    if (auto *AAPass = getAnalysisIfAvailable<AAResultsWrapperPass>())
+      AA = &AAPass->getAAResults();
 
   bool MadeChange = false;
 
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/DebugInfo/CodeView/MemoryTypeTableBuilder.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/DebugInfo/CodeView/TypeIndex.h"
 
 using namespace llvm;
@@ -15,7 +16,8 @@ using namespace codeview;
 
 TypeIndex MemoryTypeTableBuilder::writeRecord(StringRef Data) {
   assert(Data.size() <= UINT16_MAX);
-  auto I = HashedRecords.find(Data);
+  unsigned Hash = static_cast<unsigned>(hash_value(Data));
+  auto I = HashedRecords.find({Data, Hash});
   if (I != HashedRecords.end()) {
     return I->second;
   }
@@ -39,7 +41,8 @@ TypeIndex MemoryTypeTableBuilder::writeRecord(StringRef Data) {
 
   // Use only the data supplied by the user as a key to the hash table, so that
   // future lookups will succeed.
-  HashedRecords.insert(std::make_pair(StringRef(Mem + SizeOfRecLen, Data.size()), TI));
+  HashedRecords.insert(std::make_pair(
+      HashedRecord{StringRef(Mem + SizeOfRecLen, Data.size()), Hash}, TI));
   Records.push_back(StringRef(Mem, TotalSize));
 
   return TI;
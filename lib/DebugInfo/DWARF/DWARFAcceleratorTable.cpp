@@ -129,4 +129,74 @@ void DWARFAcceleratorTable::dump(raw_ostream &OS) const {
     }
   }
 }
+
+/// The hash function for DW_hash_function_djb tables.
+static uint32_t djbHash(StringRef Buffer) {
+  uint32_t H = 5381;
+  for (unsigned char C : Buffer.bytes())
+    H = (H << 5) + H + C;
+  return H;
+}
+
+void DWARFAcceleratorTable::lookup(StringRef Key,
+                                   SmallVectorImpl<uint32_t> &DIEOffsets) const {
+  if (Hdr.HashFunction != dwarf::DW_hash_function_djb || !Hdr.NumBuckets)
+    return;
+
+  // Find the atom that holds the DIE offset; tables without one cannot be
+  // used to find DIEs.
+  unsigned DIEOffsetAtom = HdrData.Atoms.size();
+  SmallVector<DWARFFormValue, 3> AtomForms;
+  for (unsigned i = 0, e = HdrData.Atoms.size(); i != e; ++i) {
+    if (HdrData.Atoms[i].first == dwarf::DW_ATOM_die_offset)
+      DIEOffsetAtom = i;
+    AtomForms.push_back(DWARFFormValue(HdrData.Atoms[i].second));
+  }
+  if (DIEOffsetAtom == HdrData.Atoms.size())
+    return;
+
+  uint32_t Hash = djbHash(Key);
+  unsigned Bucket = Hash % Hdr.NumBuckets;
+  uint32_t Offset = sizeof(Hdr) + Hdr.HeaderDataLength + Bucket * 4;
+  unsigned HashesBase = sizeof(Hdr) + Hdr.HeaderDataLength + Hdr.NumBuckets * 4;
+  unsigned OffsetsBase = HashesBase + Hdr.NumHashes * 4;
+
+  unsigned Index = AccelSection.getU32(&Offset);
+  if (Index == UINT32_MAX)
+    return;
+
+  for (unsigned HashIdx = Index; HashIdx < Hdr.NumHashes; ++HashIdx) {
+    unsigned HashOffset = HashesBase + HashIdx*4;
+    uint32_t EntryHash = AccelSection.getU32(&HashOffset);
+    if (EntryHash % Hdr.NumBuckets != Bucket)
+      break;
+    if (EntryHash != Hash)
+      continue;
+
+    unsigned OffsetsOffset = OffsetsBase + HashIdx*4;
+    unsigned DataOffset = AccelSection.getU32(&OffsetsOffset);
+    while (AccelSection.isValidOffsetForDataOfSize(DataOffset, 4)) {
+      unsigned StringOffset = AccelSection.getU32(&DataOffset);
+      RelocAddrMap::const_iterator Reloc = Relocs.find(DataOffset-4);
+      if (Reloc != Relocs.end())
+        StringOffset += Reloc->second.second;
+      if (!StringOffset)
+        break;
+      const char *Name = StringSection.getCStr(&StringOffset);
+      bool Match = Name && Key == Name;
+      unsigned NumData = AccelSection.getU32(&DataOffset);
+      for (unsigned Data = 0; Data < NumData; ++Data) {
+        for (unsigned i = 0, e = AtomForms.size(); i != e; ++i) {
+          DWARFFormValue &Atom = AtomForms[i];
+          if (!Atom.extractValue(AccelSection, &DataOffset, nullptr))
+            return;
+          if (!Match || i != DIEOffsetAtom)
+            continue;
+          if (Optional<uint64_t> DIEOffset = Atom.getAsUnsignedConstant())
+            DIEOffsets.push_back(HdrData.DIEOffsetBase + *DIEOffset);
+        }
+      }
+    }
+  }
+}
 }
@@ -73,6 +73,17 @@ static void dumpAccelSection(raw_ostream &OS, StringRef Name,
   Accel.dump(OS);
 }
 
+static void lookupAccelSection(StringRef Name, const DWARFSection &Section,
+                               StringRef StringSection, bool LittleEndian,
+                               SmallVectorImpl<uint32_t> &DIEOffsets) {
+  DataExtractor AccelSection(Section.Data, LittleEndian, 0);
+  DataExtractor StrData(StringSection, LittleEndian, 0);
+  DWARFAcceleratorTable Accel(AccelSection, StrData, Section.Relocs);
+  if (!Accel.extract())
+    return;
+  Accel.lookup(Name, DIEOffsets);
+}
+
 void DWARFContext::dump(raw_ostream &OS, DIDumpType DumpType, bool DumpEH) {
   if (DumpType == DIDT_All || DumpType == DIDT_Abbrev) {
     OS << ".debug_abbrev contents:\n";
@@ -340,8 +351,12 @@ const DWARFDebugAranges *DWARFContext::getDebugAranges() {
   if (Aranges)
     return Aranges.get();
 
+  // Parse the units up front: the address map may be built from several
+  // threads, which must only see immutable shared state.
+  parseCompileUnits();
+
   Aranges.reset(new DWARFDebugAranges());
-  Aranges->generate(this);
+  Aranges->generate(this, NumThreads);
   return Aranges.get();
 }
 
@@ -449,6 +464,23 @@ DWARFCompileUnit *DWARFContext::getCompileUnitForAddress(uint64_t Address) {
   return getCompileUnitForOffset(CUOffset);
 }
 
+void DWARFContext::lookupAppleName(StringRef Name,
+                                   SmallVectorImpl<uint32_t> &DIEOffsets) {
+  StringRef StringSection = getStringSection();
+  bool LittleEndian = isLittleEndian();
+  lookupAccelSection(Name, getAppleNamesSection(), StringSection, LittleEndian,
+                     DIEOffsets);
+  lookupAccelSection(Name, getAppleTypesSection(), StringSection, LittleEndian,
+                     DIEOffsets);
+  lookupAccelSection(Name, getAppleNamespacesSection(), StringSection,
+                     LittleEndian, DIEOffsets);
+  lookupAccelSection(Name, getAppleObjCSection(), StringSection, LittleEndian,
+                     DIEOffsets);
+  std::sort(DIEOffsets.begin(), DIEOffsets.end());
+  DIEOffsets.erase(std::unique(DIEOffsets.begin(), DIEOffsets.end()),
+                   DIEOffsets.end());
+}
+
 static bool getFunctionNameForAddress(DWARFCompileUnit *CU, uint64_t Address,
                                       FunctionNameKind Kind,
                                       std::string &FunctionName) {
@@ -631,9 +663,8 @@ static bool consumeCompressedZLibHeader(StringRef &Data, uint64_t &OriginalSize,
   return true;
 }
 
-static bool tryDecompress(StringRef &Name, StringRef &Data,
-                          SmallString<32> &Out, bool ZLibStyle, bool IsLE,
-                          bool Is64Bit) {
+static bool tryDecompress(StringRef Data, SmallVectorImpl<char> &Out,
+                          bool ZLibStyle, bool IsLE, bool Is64Bit) {
   if (!zlib::isAvailable())
     return false;
 
@@ -642,13 +673,7 @@ static bool tryDecompress(StringRef &Name, StringRef &Data,
       ZLibStyle ? consumeCompressedZLibHeader(Data, OriginalSize, IsLE, Is64Bit)
                 : consumeCompressedGnuHeader(Data, OriginalSize);
 
-  if (!Result || zlib::uncompress(Data, Out, OriginalSize) != zlib::StatusOK)
-    return false;
-
-  // gnu-style names are started from "z", consume that.
-  if (!ZLibStyle)
-    Name = Name.substr(1);
-  return true;
+  return Result && zlib::uncompress(Data, Out, OriginalSize) == zlib::StatusOK;
 }
 
 DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj,
@@ -677,14 +702,11 @@ DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj,
     name = name.substr(name.find_first_not_of("._")); // Skip . and _ prefixes.
 
     bool ZLibStyleCompressed = Section.isCompressed();
-    if (ZLibStyleCompressed || name.startswith("zdebug_")) {
-      SmallString<32> Out;
-      if (!tryDecompress(name, data, Out, ZLibStyleCompressed, IsLittleEndian,
-                         AddressSize == 8))
-        continue;
-      UncompressedSections.emplace_back(std::move(Out));
-      data = UncompressedSections.back();
-    }
+    bool GnuStyleCompressed =
+        !ZLibStyleCompressed && name.startswith("zdebug_");
+    // gnu-style names are started from "z", consume that.
+    if (GnuStyleCompressed)
+      name = name.substr(1);
 
     StringRef *SectionData =
         StringSwitch<StringRef *>(name)
@@ -708,7 +730,8 @@ DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj,
             .Case("debug_line.dwo", &LineDWOSection.Data)
             .Case("debug_str.dwo", &StringDWOSection)
             .Case("debug_str_offsets.dwo", &StringOffsetDWOSection)
-            .Case("debug_addr", &AddrSection)
+            .Case("debug_addr", &AddrSection.Data)
+            .Case("debug_str_offsets", &StringOffsetSection.Data)
             .Case("apple_names", &AppleNamesSection.Data)
             .Case("apple_types", &AppleTypesSection.Data)
             .Case("apple_namespaces", &AppleNamespacesSection.Data)
@@ -718,18 +741,33 @@ DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj,
             .Case("debug_tu_index", &TUIndexSection)
             // Any more debug info sections go here.
             .Default(nullptr);
+    // Find debug_types data by section rather than name as there are
+    // multiple, comdat grouped, debug_types sections.
+    if (!SectionData && name == "debug_types")
+      SectionData = &TypesSections[Section].Data;
+    else if (!SectionData && name == "debug_types.dwo")
+      SectionData = &TypesDWOSections[Section].Data;
+
+    // Only decompress the sections this context knows how to use; other
+    // compressed sections, such as those of the program itself, are never
+    // read and decompressing them would only cost time and memory.
+    if (SectionData && (ZLibStyleCompressed || GnuStyleCompressed)) {
+      UncompressedSections.emplace_back();
+      if (!tryDecompress(data, UncompressedSections.back(),
+                         ZLibStyleCompressed, IsLittleEndian,
+                         AddressSize == 8)) {
+        UncompressedSections.pop_back();
+        continue;
+      }
+      data = UncompressedSections.back();
+    }
+
     if (SectionData) {
       *SectionData = data;
       if (name == "debug_ranges") {
         // FIXME: Use the other dwo range section when we emit it.
         RangeDWOSection = data;
       }
-    } else if (name == "debug_types") {
-      // Find debug_types data by section rather than name as there are
-      // multiple, comdat grouped, debug_types sections.
-      TypesSections[Section].Data = data;
-    } else if (name == "debug_types.dwo") {
-      TypesDWOSections[Section].Data = data;
     }
 
     if (RelocatedSection == Obj.section_end())
@@ -763,6 +801,8 @@ DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj,
         .Case("debug_loc", &LocSection.Relocs)
         .Case("debug_info.dwo", &InfoDWOSection.Relocs)
         .Case("debug_line", &LineSection.Relocs)
+        .Case("debug_addr", &AddrSection.Relocs)
+        .Case("debug_str_offsets", &StringOffsetSection.Relocs)
         .Case("apple_names", &AppleNamesSection.Relocs)
         .Case("apple_types", &AppleTypesSection.Relocs)
         .Case("apple_namespaces", &AppleNamespacesSection.Relocs)
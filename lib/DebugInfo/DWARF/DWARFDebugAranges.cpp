@@ -12,6 +12,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugArangeSet.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -35,7 +36,7 @@ void DWARFDebugAranges::extract(DataExtractor DebugArangesData) {
   }
 }
 
-void DWARFDebugAranges::generate(DWARFContext *CTX) {
+void DWARFDebugAranges::generate(DWARFContext *CTX, unsigned NumThreads) {
   clear();
   if (!CTX)
     return;
@@ -47,15 +48,31 @@ void DWARFDebugAranges::generate(DWARFContext *CTX) {
   // Generate aranges from DIEs: even if .debug_aranges section is present,
   // it may describe only a small subset of compilation units, so we need to
   // manually build aranges for the rest of them.
-  for (const auto &CU : CTX->compile_units()) {
-    uint32_t CUOffset = CU->getOffset();
-    if (ParsedCUOffsets.insert(CUOffset).second) {
-      DWARFAddressRangesVector CURanges;
-      CU->collectAddressRanges(CURanges);
-      for (const auto &R : CURanges) {
-        appendRange(CUOffset, R.first, R.second);
-      }
-    }
+  std::vector<DWARFCompileUnit *> UnitsToScan;
+  for (const auto &CU : CTX->compile_units())
+    if (ParsedCUOffsets.insert(CU->getOffset()).second)
+      UnitsToScan.push_back(CU.get());
+
+  // Each unit only touches its own DIEs while collecting its ranges, so the
+  // units can be scanned concurrently.  The results are appended in unit
+  // order to keep the map independent of the scheduling.
+  std::vector<DWARFAddressRangesVector> UnitRanges(UnitsToScan.size());
+  if (NumThreads > 1 && UnitsToScan.size() > 1) {
+    ThreadPool Pool(std::min<size_t>(NumThreads, UnitsToScan.size()));
+    for (size_t I = 0, E = UnitsToScan.size(); I != E; ++I)
+      Pool.async([&UnitsToScan, &UnitRanges, I] {
+        UnitsToScan[I]->collectAddressRanges(UnitRanges[I]);
+      });
+    Pool.wait();
+  } else {
+    for (size_t I = 0, E = UnitsToScan.size(); I != E; ++I)
+      UnitsToScan[I]->collectAddressRanges(UnitRanges[I]);
+  }
+
+  for (size_t I = 0, E = UnitsToScan.size(); I != E; ++I) {
+    uint32_t CUOffset = UnitsToScan[I]->getOffset();
+    for (const auto &R : UnitRanges[I])
+      appendRange(CUOffset, R.first, R.second);
   }
 
   construct();
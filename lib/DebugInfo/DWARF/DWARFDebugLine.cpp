@@ -17,6 +17,24 @@ using namespace llvm;
 using namespace dwarf;
 typedef DILineInfoSpecifier::FileLineInfoKind FileLineInfoKind;
 
+/// Read the directory index, modification time and length that follow the
+/// name of a file entry.
+static void readFileEntryFields(const DataExtractor &debug_line_data,
+                                uint32_t *offset_ptr,
+                                DWARFDebugLine::FileNameEntry &fileEntry) {
+  uint64_t fields[3];
+  if (debug_line_data.getULEB128(offset_ptr, fields, 3)) {
+    fileEntry.DirIdx = fields[0];
+    fileEntry.ModTime = fields[1];
+    fileEntry.Length = fields[2];
+    return;
+  }
+  // The entry is truncated.
+  fileEntry.DirIdx = debug_line_data.getULEB128(offset_ptr);
+  fileEntry.ModTime = debug_line_data.getULEB128(offset_ptr);
+  fileEntry.Length = debug_line_data.getULEB128(offset_ptr);
+}
+
 DWARFDebugLine::Prologue::Prologue() { clear(); }
 
 void DWARFDebugLine::Prologue::clear() {
@@ -110,9 +128,7 @@ bool DWARFDebugLine::Prologue::parse(DataExtractor debug_line_data,
     if (name && name[0]) {
       FileNameEntry fileEntry;
       fileEntry.Name = name;
-      fileEntry.DirIdx = debug_line_data.getULEB128(offset_ptr);
-      fileEntry.ModTime = debug_line_data.getULEB128(offset_ptr);
-      fileEntry.Length = debug_line_data.getULEB128(offset_ptr);
+      readFileEntryFields(debug_line_data, offset_ptr, fileEntry);
       FileNames.push_back(fileEntry);
     } else {
       break;
@@ -329,9 +345,7 @@ bool DWARFDebugLine::LineTable::parse(DataExtractor debug_line_data,
         {
           FileNameEntry fileEntry;
           fileEntry.Name = debug_line_data.getCStr(offset_ptr);
-          fileEntry.DirIdx = debug_line_data.getULEB128(offset_ptr);
-          fileEntry.ModTime = debug_line_data.getULEB128(offset_ptr);
-          fileEntry.Length = debug_line_data.getULEB128(offset_ptr);
+          readFileEntryFields(debug_line_data, offset_ptr, fileEntry);
           Prologue.FileNames.push_back(fileEntry);
         }
         break;
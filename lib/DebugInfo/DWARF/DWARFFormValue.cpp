@@ -118,8 +118,10 @@ bool DWARFFormValue::isFormClass(DWARFFormValue::FormClass FC) const {
   case DW_FORM_ref_sig8:
   case DW_FORM_GNU_ref_alt:
     return (FC == FC_Reference);
+  case DW_FORM_addrx:
   case DW_FORM_GNU_addr_index:
     return (FC == FC_Address);
+  case DW_FORM_strx:
   case DW_FORM_GNU_str_index:
   case DW_FORM_GNU_strp_alt:
     return (FC == FC_String);
@@ -231,6 +233,8 @@ bool DWARFFormValue::extractValue(DataExtractor data, uint32_t *offset_ptr,
     case DW_FORM_ref_sig8:
       Value.uval = data.getU64(offset_ptr);
       break;
+    case DW_FORM_addrx:
+    case DW_FORM_strx:
     case DW_FORM_GNU_addr_index:
     case DW_FORM_GNU_str_index:
       Value.uval = data.getULEB128(offset_ptr);
@@ -342,6 +346,8 @@ bool DWARFFormValue::skipValue(uint16_t form, DataExtractor debug_info_data,
     case DW_FORM_sdata:
     case DW_FORM_udata:
     case DW_FORM_ref_udata:
+    case DW_FORM_strx:
+    case DW_FORM_addrx:
     case DW_FORM_GNU_str_index:
     case DW_FORM_GNU_addr_index:
       debug_info_data.getULEB128(offset_ptr);
@@ -374,6 +380,7 @@ DWARFFormValue::dump(raw_ostream &OS, const DWARFUnit *cu) const {
 
   switch (Form) {
   case DW_FORM_addr:      OS << format("0x%016" PRIx64, uvalue); break;
+  case DW_FORM_addrx:
   case DW_FORM_GNU_addr_index: {
     OS << format(" indexed (%8.8x) address = ", (uint32_t)uvalue);
     uint64_t Address;
@@ -431,6 +438,7 @@ DWARFFormValue::dump(raw_ostream &OS, const DWARFUnit *cu) const {
     dumpString(OS, cu);
     break;
   }
+  case DW_FORM_strx:
   case DW_FORM_GNU_str_index: {
     OS << format(" indexed (%8.8x) string = ", (uint32_t)uvalue);
     dumpString(OS, cu);
@@ -511,7 +519,7 @@ Optional<const char *> DWARFFormValue::getAsCString(const DWARFUnit *U) const {
   if (Form == DW_FORM_GNU_strp_alt || U == nullptr)
     return None;
   uint32_t Offset = Value.uval;
-  if (Form == DW_FORM_GNU_str_index) {
+  if (Form == DW_FORM_GNU_str_index || Form == DW_FORM_strx) {
     uint32_t StrOffset;
     if (!U->getStringOffsetSectionItem(Offset, StrOffset))
       return None;
@@ -526,7 +534,7 @@ Optional<const char *> DWARFFormValue::getAsCString(const DWARFUnit *U) const {
 Optional<uint64_t> DWARFFormValue::getAsAddress(const DWARFUnit *U) const {
   if (!isFormClass(FC_Address))
     return None;
-  if (Form == DW_FORM_GNU_addr_index) {
+  if (Form == DW_FORM_GNU_addr_index || Form == DW_FORM_addrx) {
     uint32_t Index = Value.uval;
     uint64_t Result;
     if (!U || !U->getAddrOffsetSectionItem(Index, Result))
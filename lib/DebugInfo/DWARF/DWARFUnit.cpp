@@ -19,8 +19,9 @@ using namespace dwarf;
 
 void DWARFUnitSectionBase::parse(DWARFContext &C, const DWARFSection &Section) {
   parseImpl(C, Section, C.getDebugAbbrev(), C.getRangeSection(),
-            C.getStringSection(), StringRef(), C.getAddrSection(),
-            C.getLineSection().Data, C.isLittleEndian(), false);
+            C.getStringSection(), C.getStringOffsetSection().Data,
+            C.getAddrSection().Data, C.getLineSection().Data,
+            C.isLittleEndian(), false);
 }
 
 void DWARFUnitSectionBase::parseDWO(DWARFContext &C,
@@ -28,8 +29,8 @@ void DWARFUnitSectionBase::parseDWO(DWARFContext &C,
                                     DWARFUnitIndex *Index) {
   parseImpl(C, DWOSection, C.getDebugAbbrevDWO(), C.getRangeDWOSection(),
             C.getStringDWOSection(), C.getStringOffsetDWOSection(),
-            C.getAddrSection(), C.getLineDWOSection().Data, C.isLittleEndian(),
-            true);
+            C.getAddrSection().Data, C.getLineDWOSection().Data,
+            C.isLittleEndian(), true);
 }
 
 DWARFUnit::DWARFUnit(DWARFContext &DC, const DWARFSection &Section,
@@ -52,13 +53,27 @@ DWARFUnit::DWARFUnit(DWARFContext &DC, const DWARFSection &Section,
 DWARFUnit::~DWARFUnit() {
 }
 
+uint64_t DWARFUnit::getRelocatedValue(const RelocAddrMap &Relocs,
+                                      uint32_t Offset, uint64_t Value) const {
+  // Units from .dwo files are never relocated. In an object file, the
+  // .debug_addr and .debug_str_offsets tables of non-split units are.
+  if (isDWO)
+    return Value;
+  RelocAddrMap::const_iterator AI = Relocs.find(Offset);
+  if (AI != Relocs.end())
+    Value += AI->second.second;
+  return Value;
+}
+
 bool DWARFUnit::getAddrOffsetSectionItem(uint32_t Index,
                                                 uint64_t &Result) const {
   uint32_t Offset = AddrOffsetSectionBase + Index * AddrSize;
   if (AddrOffsetSection.size() < Offset + AddrSize)
     return false;
   DataExtractor DA(AddrOffsetSection, isLittleEndian, AddrSize);
-  Result = DA.getAddress(&Offset);
+  uint32_t ItemOffset = Offset;
+  Result = getRelocatedValue(Context.getAddrSection().Relocs, ItemOffset,
+                             DA.getAddress(&Offset));
   return true;
 }
 
@@ -66,11 +81,13 @@ bool DWARFUnit::getStringOffsetSectionItem(uint32_t Index,
                                                   uint32_t &Result) const {
   // FIXME: string offset section entries are 8-byte for DWARF64.
   const uint32_t ItemSize = 4;
-  uint32_t Offset = Index * ItemSize;
+  uint32_t Offset = StringOffsetSectionBase + Index * ItemSize;
   if (StringOffsetSection.size() < Offset + ItemSize)
     return false;
   DataExtractor DA(StringOffsetSection, isLittleEndian, 0);
-  Result = DA.getU32(&Offset);
+  uint32_t ItemOffset = Offset;
+  Result = getRelocatedValue(Context.getStringOffsetSection().Relocs,
+                             ItemOffset, DA.getU32(&Offset));
   return true;
 }
 
@@ -136,6 +153,7 @@ void DWARFUnit::clear() {
   BaseAddr = 0;
   RangeSectionBase = 0;
   AddrOffsetSectionBase = 0;
+  StringOffsetSectionBase = 0;
   clearDIEs(false);
   DWO.reset();
 }
@@ -255,7 +273,11 @@ size_t DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
       BaseAddr = DieArray[0].getAttributeValueAsAddress(this, DW_AT_entry_pc, 0);
     setBaseAddress(BaseAddr);
     AddrOffsetSectionBase = DieArray[0].getAttributeValueAsSectionOffset(
-        this, DW_AT_GNU_addr_base, 0);
+        this, DW_AT_GNU_addr_base,
+        DieArray[0].getAttributeValueAsSectionOffset(this, DW_AT_addr_base,
+                                                     0));
+    StringOffsetSectionBase = DieArray[0].getAttributeValueAsSectionOffset(
+        this, DW_AT_str_offsets_base, 0);
     RangeSectionBase = DieArray[0].getAttributeValueAsSectionOffset(
         this, DW_AT_ranges_base, 0);
     // Don't fall back to DW_AT_GNU_ranges_base: it should be ignored for
@@ -50,6 +50,7 @@ Error MappedBlockStream::readBytes(uint32_t Offset, uint32_t Size,
   if (tryReadContiguously(Offset, Size, Buffer))
     return Error::success();
 
+  std::lock_guard<std::mutex> Lock(CacheMutex);
   auto CacheIter = CacheMap.find(Offset);
   if (CacheIter != CacheMap.end()) {
     // Try to find an alloc that was large enough for this request.
@@ -63,31 +64,26 @@ Error MappedBlockStream::readBytes(uint32_t Offset, uint32_t Size,
 
   // We couldn't find a buffer that started at the correct offset (the most
   // common scenario).  Try to see if there is a buffer that starts at some
-  // other offset but overlaps the desired range.
-  for (auto &CacheItem : CacheMap) {
-    Interval RequestExtent = std::make_pair(Offset, Offset + Size);
-
-    // We already checked this one on the fast path above.
-    if (CacheItem.first == Offset)
-      continue;
-    // If the initial extent of the cached item is beyond the ending extent
-    // of the request, there is no overlap.
-    if (CacheItem.first >= Offset + Size)
-      continue;
+  // earlier offset but contains the desired range.  No allocation is larger
+  // than MaxCachedSize, so anything starting before Offset + Size -
+  // MaxCachedSize cannot reach the end of the request.
+  Interval RequestExtent = std::make_pair(Offset, Offset + Size);
+  uint32_t Earliest = 0;
+  if (RequestExtent.second > MaxCachedSize)
+    Earliest = RequestExtent.second - MaxCachedSize;
+  for (auto I = CacheMap.lower_bound(Offset); I != CacheMap.begin();) {
+    --I;
+    if (I->first < Earliest)
+      break;
 
     // We really only have to check the last item in the list, since we append
     // in order of increasing length.
-    if (CacheItem.second.empty())
+    if (I->second.empty())
       continue;
 
-    auto CachedAlloc = CacheItem.second.back();
-    // If the initial extent of the request is beyond the ending extent of
-    // the cached item, there is no overlap.
+    auto CachedAlloc = I->second.back();
     Interval CachedExtent =
-        std::make_pair(CacheItem.first, CacheItem.first + CachedAlloc.size());
-    if (RequestExtent.first >= CachedExtent.first + CachedExtent.second)
-      continue;
-
+        std::make_pair(I->first, I->first + uint32_t(CachedAlloc.size()));
     Interval Intersection = intersect(CachedExtent, RequestExtent);
     // Only use this if the entire request extent is contained in the cached
     // extent.
@@ -108,13 +104,8 @@ Error MappedBlockStream::readBytes(uint32_t Offset, uint32_t Size,
   if (auto EC = readBytes(Offset, MutableArrayRef<uint8_t>(WriteBuffer, Size)))
     return EC;
 
-  if (CacheIter != CacheMap.end()) {
-    CacheIter->second.emplace_back(WriteBuffer, Size);
-  } else {
-    std::vector<CacheEntry> List;
-    List.emplace_back(WriteBuffer, Size);
-    CacheMap.insert(std::make_pair(Offset, List));
-  }
+  CacheMap[Offset].emplace_back(WriteBuffer, Size);
+  MaxCachedSize = std::max(MaxCachedSize, Size);
   Buffer = ArrayRef<uint8_t>(WriteBuffer, Size);
   return Error::success();
 }
@@ -248,6 +239,7 @@ Error MappedBlockStream::writeBytes(uint32_t Offset,
   // someone may still be holding a pointer to that alloc which is now invalid.
   // Compute the overlapping range and update the cache entry, so any
   // outstanding buffers are automatically updated.
+  std::lock_guard<std::mutex> Lock(CacheMutex);
   for (const auto &MapEntry : CacheMap) {
     // If the end of the written extent precedes the beginning of the cached
     // extent, ignore this map entry.
@@ -281,6 +273,7 @@ Error MappedBlockStream::writeBytes(uint32_t Offset,
 }
 
 uint32_t MappedBlockStream::getNumBytesCopied() const {
+  std::lock_guard<std::mutex> Lock(CacheMutex);
   return static_cast<uint32_t>(Pool.getBytesAllocated());
 }
 
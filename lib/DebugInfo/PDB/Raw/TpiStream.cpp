@@ -23,6 +23,7 @@
 #include "llvm/DebugInfo/PDB/Raw/RawTypes.h"
 
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Parallel.h"
 
 using namespace llvm;
 using namespace llvm::codeview;
@@ -92,9 +93,10 @@ static uint32_t getTpiHash(T &Rec, const CVRecord<TypeLeafKind> &RawRec) {
 namespace {
 class TpiHashVerifier : public TypeVisitorCallbacks {
 public:
-  TpiHashVerifier(FixedStreamArray<support::ulittle32_t> &HashValues,
-                  uint32_t NumHashBuckets)
-      : HashValues(HashValues), NumHashBuckets(NumHashBuckets) {}
+  TpiHashVerifier(const FixedStreamArray<support::ulittle32_t> &HashValues,
+                  uint32_t NumHashBuckets, uint32_t FirstRecord = 0)
+      : HashValues(HashValues), NumHashBuckets(NumHashBuckets),
+        Index(FirstRecord - 1) {}
 
   Error visitUdtSourceLine(UdtSourceLineRecord &Rec) override {
     return verifySourceLine(Rec);
@@ -140,16 +142,46 @@ private:
   FixedStreamArray<support::ulittle32_t> HashValues;
   const CVRecord<TypeLeafKind> *RawRecord;
   uint32_t NumHashBuckets;
-  uint32_t Index = -1;
+  uint32_t Index;
 };
 }
 
 // Verifies that a given type record matches with a given hash value.
 // Currently we only verify SRC_LINE records.
 Error TpiStream::verifyHashValues() {
-  TpiHashVerifier Verifier(HashValues, Header->NumHashBuckets);
-  CVTypeVisitor Visitor(Verifier);
-  return Visitor.visitTypeStream(TypeRecords);
+  // Reading the records goes through the stream, so do that up front. After
+  // that each record is deserialized and hashed from its own bytes, which can
+  // be done on several threads.
+  std::vector<CVType> Records;
+  Records.reserve(NumTypeRecords());
+  for (const CVType &Rec : TypeRecords)
+    Records.push_back(Rec);
+
+  const uint32_t RecordsPerTask = 4096;
+  uint32_t NumTasks = (Records.size() + RecordsPerTask - 1) / RecordsPerTask;
+  std::vector<Error> Errors(NumTasks);
+  parallel_for(0U, NumTasks, [&](uint32_t Task) {
+    uint32_t Begin = Task * RecordsPerTask;
+    uint32_t End = std::min<uint32_t>(Begin + RecordsPerTask, Records.size());
+    TpiHashVerifier Verifier(HashValues, Header->NumHashBuckets, Begin);
+    CVTypeVisitor Visitor(Verifier);
+    ErrorAsOutParameter ErrAsOutParam(Errors[Task]);
+    for (uint32_t I = Begin; I != End; ++I)
+      if ((Errors[Task] = Visitor.visitTypeRecord(Records[I])))
+        return;
+  });
+
+  // Report the failure with the lowest type index, as a serial walk would.
+  Error Result = Error::success();
+  for (Error &E : Errors) {
+    if (!E)
+      continue;
+    if (Result)
+      consumeError(std::move(E));
+    else
+      Result = std::move(E);
+  }
+  return Result;
 }
 
 Error TpiStream::reload() {
@@ -265,6 +297,47 @@ TpiStream::getHashAdjustments() const {
   return HashAdjustments;
 }
 
+Expected<CVType> TpiStream::getTypeRecord(TypeIndex Index) const {
+  uint32_t TI = Index.getIndex();
+  if (TI < TypeIndexBegin() || TI >= TypeIndexEnd())
+    return make_error<RawError>(raw_error_code::index_out_of_bounds,
+                                "Type index is 0x" + utohexstr(TI));
+
+  // Find the last indexed record at or before the one we want. The entries
+  // are sorted by type index, and their offsets are relative to the start of
+  // the type records.
+  uint32_t StartTI = TypeIndexBegin();
+  uint32_t StartOffset = 0;
+  uint32_t Lo = 0, Hi = TypeIndexOffsets.size();
+  while (Lo < Hi) {
+    uint32_t Mid = Lo + (Hi - Lo) / 2;
+    const TypeIndexOffset &Entry = TypeIndexOffsets[Mid];
+    if (Entry.Type.getIndex() > TI) {
+      Hi = Mid;
+      continue;
+    }
+    StartTI = Entry.Type.getIndex();
+    StartOffset = Entry.Offset;
+    Lo = Mid + 1;
+  }
+
+  StreamRef Records = TypeRecords.getUnderlyingStream();
+  if (StartOffset >= Records.getLength())
+    return make_error<RawError>(raw_error_code::corrupt_file,
+                                "Invalid TPI index offset.");
+
+  // Walk forward from there; only the records in between are parsed.
+  CVTypeArray Tail(Records.drop_front(StartOffset));
+  bool HadError = false;
+  auto I = Tail.begin(&HadError);
+  for (uint32_t Skip = TI - StartTI; Skip && I != Tail.end(); --Skip)
+    ++I;
+  if (HadError || I == Tail.end())
+    return make_error<RawError>(raw_error_code::corrupt_file,
+                                "Type index is 0x" + utohexstr(TI));
+  return *I;
+}
+
 iterator_range<CVTypeArray::Iterator>
 TpiStream::types(bool *HadError) const {
   return llvm::make_range(TypeRecords.begin(HadError), TypeRecords.end());
@@ -135,6 +135,7 @@ void LLVMSymbolizer::flush() {
   BinaryForPath.clear();
   ObjectPairForPathArch.clear();
   Modules.clear();
+  ModuleLastUse.clear();
 }
 
 namespace {
@@ -364,8 +365,14 @@ Expected<SymbolizableModule *>
 LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   const auto &I = Modules.find(ModuleName);
   if (I != Modules.end()) {
+    if (Opts.MaxCachedModules)
+      ModuleLastUse[ModuleName] = ++ModuleUseCounter;
     return I->second.get();
   }
+  if (Opts.MaxCachedModules) {
+    pruneModuleCache();
+    ModuleLastUse[ModuleName] = ++ModuleUseCounter;
+  }
   std::string BinaryName = ModuleName;
   std::string ArchName = Opts.DefaultArch;
   size_t ColonPos = ModuleName.find_last_of(':');
@@ -405,8 +412,11 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
       Context.reset(new PDBContext(*CoffObject, std::move(Session)));
     }
   }
-  if (!Context)
-    Context.reset(new DWARFContextInMemory(*Objects.second));
+  if (!Context) {
+    auto DWARFCtx = llvm::make_unique<DWARFContextInMemory>(*Objects.second);
+    DWARFCtx->setNumThreads(Opts.DWARFThreads);
+    Context = std::move(DWARFCtx);
+  }
   assert(Context);
   auto InfoOrErr =
       SymbolizableObjectFile::create(Objects.first, std::move(Context));
@@ -421,6 +431,17 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   return InsertResult.first->second.get();
 }
 
+void LLVMSymbolizer::pruneModuleCache() {
+  while (Modules.size() >= Opts.MaxCachedModules) {
+    auto Oldest = ModuleLastUse.begin();
+    for (auto I = ModuleLastUse.begin(), E = ModuleLastUse.end(); I != E; ++I)
+      if (I->second < Oldest->second)
+        Oldest = I;
+    Modules.erase(Oldest->first);
+    ModuleLastUse.erase(Oldest);
+  }
+}
+
 namespace {
 
 // Undo these various manglings for Win32 extern "C" functions:
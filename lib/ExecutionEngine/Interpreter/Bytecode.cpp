@@ -0,0 +1,916 @@
+//===-- Bytecode.cpp - Decode and run functions as register bytecode ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file decodes functions into the register bytecode described in
+// Bytecode.h and contains the loop that executes it.  Functions using types or
+// instructions that the bytecode doesn't cover (vectors, aggregates, integers
+// wider than 64 bits, varargs, invoke, most intrinsics, ...) are left to the
+// instruction visitors in Execution.cpp.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Interpreter.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/IR/InlineAsm.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+using namespace llvm;
+
+#define DEBUG_TYPE "interpreter"
+
+STATISTIC(NumBytecodeFunctions, "Number of functions decoded into bytecode");
+STATISTIC(NumBytecodeInsts, "Number of bytecode instructions executed");
+
+static uint64_t lowBitsMask(unsigned Bits) {
+  return Bits >= 64 ? ~0ULL : (1ULL << Bits) - 1;
+}
+
+uint64_t BytecodeType::toRaw(const GenericValue &V) const {
+  switch (Kind) {
+  case Void:
+    return 0;
+  case Int:
+    return V.IntVal.zextOrTrunc(Bits).getZExtValue();
+  case Pointer:
+    return (uintptr_t)V.PointerVal;
+  case Float:
+    return FloatToBits(V.FloatVal);
+  case Double:
+    return DoubleToBits(V.DoubleVal);
+  }
+  llvm_unreachable("Unknown bytecode type");
+}
+
+GenericValue BytecodeType::toGenericValue(uint64_t Raw) const {
+  GenericValue V;
+  switch (Kind) {
+  case Void:
+    break;
+  case Int:
+    V.IntVal = APInt(Bits, Raw);
+    break;
+  case Pointer:
+    V.PointerVal = (void *)(uintptr_t)Raw;
+    break;
+  case Float:
+    V.FloatVal = BitsToFloat(Raw);
+    break;
+  case Double:
+    V.DoubleVal = BitsToDouble(Raw);
+    break;
+  }
+  return V;
+}
+
+//===----------------------------------------------------------------------===//
+//                        Decoding functions
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+class BytecodeBuilder {
+public:
+  BytecodeBuilder(Function &F, const DataLayout &DL,
+                  function_ref<GenericValue(Constant *)> EvaluateConstant,
+                  BytecodeFunction &BC)
+      : F(F), DL(DL), EvaluateConstant(EvaluateConstant), BC(BC) {}
+
+  /// Fill in BC, returning false if F can't be expressed as bytecode.
+  bool build();
+
+private:
+  bool getType(Type *Ty, BytecodeType &T);
+  bool getReg(Value *V, uint32_t &Reg);
+  bool getEdge(BasicBlock *From, BasicBlock *To, uint32_t &Edge);
+  BytecodeInst &emit(BytecodeInst::Opcode Op, Instruction &I);
+
+  bool emitInstruction(Instruction &I);
+  bool emitBinaryOperator(BinaryOperator &I);
+  bool emitCmp(CmpInst &I);
+  bool emitCast(CastInst &I);
+  bool emitGEP(GetElementPtrInst &I);
+  bool emitCall(CallInst &I);
+  bool emitTerminator(TerminatorInst &I);
+
+  Function &F;
+  const DataLayout &DL;
+  function_ref<GenericValue(Constant *)> EvaluateConstant;
+  BytecodeFunction &BC;
+
+  DenseMap<Value *, uint32_t> Regs;
+  DenseMap<BasicBlock *, uint32_t> BlockStarts;
+  // The destination block of each edge, until the blocks have been laid out.
+  std::vector<BasicBlock *> EdgeTargets;
+};
+
+} // end anonymous namespace
+
+bool BytecodeBuilder::getType(Type *Ty, BytecodeType &T) {
+  switch (Ty->getTypeID()) {
+  case Type::VoidTyID:
+    T = BytecodeType(BytecodeType::Void);
+    return true;
+  case Type::IntegerTyID: {
+    unsigned Bits = cast<IntegerType>(Ty)->getBitWidth();
+    if (Bits > 64)
+      return false;
+    T = BytecodeType(BytecodeType::Int, Bits);
+    return true;
+  }
+  case Type::PointerTyID:
+    // Pointers are kept as host addresses, so they have to be host sized.
+    if (DL.getPointerTypeSizeInBits(Ty) != 8 * sizeof(void *))
+      return false;
+    T = BytecodeType(BytecodeType::Pointer);
+    return true;
+  case Type::FloatTyID:
+    T = BytecodeType(BytecodeType::Float);
+    return true;
+  case Type::DoubleTyID:
+    T = BytecodeType(BytecodeType::Double);
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool BytecodeBuilder::getReg(Value *V, uint32_t &Reg) {
+  auto I = Regs.find(V);
+  if (I != Regs.end()) {
+    Reg = I->second;
+    return true;
+  }
+
+  // Anything without a register yet has to be a constant, which gets one
+  // initialized in InitialRegs.
+  Constant *C = dyn_cast<Constant>(V);
+  BytecodeType T;
+  if (!C || isa<BlockAddress>(C) || !getType(C->getType(), T))
+    return false;
+  uint64_t Raw = isa<UndefValue>(C) ? 0 : T.toRaw(EvaluateConstant(C));
+  Reg = BC.InitialRegs.size();
+  BC.InitialRegs.push_back(Raw);
+  Regs[V] = Reg;
+  return true;
+}
+
+bool BytecodeBuilder::getEdge(BasicBlock *From, BasicBlock *To,
+                              uint32_t &Edge) {
+  BytecodeEdge E;
+  E.Target = 0;
+  E.FirstMove = BC.Moves.size();
+  E.NeedsTemps = false;
+  for (BasicBlock::iterator I = To->begin(); PHINode *PN = dyn_cast<PHINode>(I);
+       ++I) {
+    uint32_t Src;
+    if (!getReg(PN->getIncomingValueForBlock(From), Src))
+      return false;
+    BC.Moves.push_back(std::make_pair(Regs[PN], Src));
+  }
+  E.NumMoves = BC.Moves.size() - E.FirstMove;
+
+  for (unsigned i = E.FirstMove, e = BC.Moves.size(); i != e; ++i)
+    for (unsigned j = E.FirstMove; j != e; ++j)
+      if (i != j && BC.Moves[i].second == BC.Moves[j].first)
+        E.NeedsTemps = true;
+
+  Edge = BC.Edges.size();
+  BC.Edges.push_back(E);
+  EdgeTargets.push_back(To);
+  return true;
+}
+
+BytecodeInst &BytecodeBuilder::emit(BytecodeInst::Opcode Op, Instruction &I) {
+  BC.Code.push_back(BytecodeInst(Op));
+  BytecodeInst &BI = BC.Code.back();
+  if (!I.getType()->isVoidTy())
+    BI.Dst = Regs[&I];
+  return BI;
+}
+
+bool BytecodeBuilder::build() {
+  // Registers and GenericValues are converted by copying the low bytes of the
+  // host value, and loads and stores do the same with memory.
+  if (!sys::IsLittleEndianHost || !DL.isLittleEndian())
+    return false;
+  if (F.isVarArg() || !getType(F.getReturnType(), BC.RetType))
+    return false;
+
+  for (Argument &A : F.args()) {
+    BytecodeType T;
+    if (!getType(A.getType(), T))
+      return false;
+    Regs[&A] = BC.ArgTypes.size();
+    BC.ArgTypes.push_back(T);
+  }
+  uint32_t NumRegs = BC.ArgTypes.size();
+  for (BasicBlock &BB : F)
+    for (Instruction &I : BB)
+      if (!I.getType()->isVoidTy()) {
+        BytecodeType T;
+        if (!getType(I.getType(), T))
+          return false;
+        Regs[&I] = NumRegs++;
+      }
+  BC.InitialRegs.resize(NumRegs);
+
+  for (BasicBlock &BB : F) {
+    BlockStarts[&BB] = BC.Code.size();
+    for (Instruction &I : BB)
+      if (!isa<PHINode>(I) && !emitInstruction(I))
+        return false;
+  }
+
+  for (unsigned i = 0, e = BC.Edges.size(); i != e; ++i)
+    BC.Edges[i].Target = BlockStarts[EdgeTargets[i]];
+  return true;
+}
+
+bool BytecodeBuilder::emitInstruction(Instruction &I) {
+  if (auto *BO = dyn_cast<BinaryOperator>(&I))
+    return emitBinaryOperator(*BO);
+  if (auto *CI = dyn_cast<CmpInst>(&I))
+    return emitCmp(*CI);
+  if (auto *CI = dyn_cast<CastInst>(&I))
+    return emitCast(*CI);
+  if (auto *GEP = dyn_cast<GetElementPtrInst>(&I))
+    return emitGEP(*GEP);
+  if (auto *CI = dyn_cast<CallInst>(&I))
+    return emitCall(*CI);
+  if (auto *TI = dyn_cast<TerminatorInst>(&I))
+    return emitTerminator(*TI);
+
+  uint32_t A, B, C;
+  switch (I.getOpcode()) {
+  case Instruction::Select: {
+    if (!getReg(I.getOperand(0), A) || !getReg(I.getOperand(1), B) ||
+        !getReg(I.getOperand(2), C))
+      return false;
+    BytecodeInst &BI = emit(BytecodeInst::Select, I);
+    BI.A = A;
+    BI.B = B;
+    BI.C = C;
+    return true;
+  }
+  case Instruction::Alloca: {
+    auto &AI = cast<AllocaInst>(I);
+    if (!getReg(AI.getArraySize(), A))
+      return false;
+    BytecodeInst &BI = emit(BytecodeInst::Alloca, I);
+    BI.A = A;
+    BI.Imm = DL.getTypeAllocSize(AI.getAllocatedType());
+    return true;
+  }
+  case Instruction::Load: {
+    if (!getReg(I.getOperand(0), A))
+      return false;
+    BytecodeInst &BI = emit(BytecodeInst::Load, I);
+    BI.A = A;
+    BI.Aux = DL.getTypeStoreSize(I.getType());
+    BI.Imm = I.getType()->isIntegerTy()
+                 ? lowBitsMask(I.getType()->getIntegerBitWidth())
+                 : ~0ULL;
+    return true;
+  }
+  case Instruction::Store: {
+    Value *Val = I.getOperand(0);
+    BytecodeType T;
+    if (!getType(Val->getType(), T) || !getReg(Val, A) ||
+        !getReg(I.getOperand(1), B))
+      return false;
+    BytecodeInst &BI = emit(BytecodeInst::Store, I);
+    BI.A = A;
+    BI.B = B;
+    BI.Aux = DL.getTypeStoreSize(Val->getType());
+    return true;
+  }
+  default:
+    DEBUG(dbgs() << "Can't decode " << I << " into bytecode\n");
+    return false;
+  }
+}
+
+bool BytecodeBuilder::emitBinaryOperator(BinaryOperator &I) {
+  uint32_t A, B;
+  if (!getReg(I.getOperand(0), A) || !getReg(I.getOperand(1), B))
+    return false;
+
+  typedef BytecodeInst BI;
+  BI::Opcode Op;
+  Type *Ty = I.getType();
+  if (Ty->isIntegerTy()) {
+    switch (I.getOpcode()) {
+    case Instruction::Add:  Op = BI::Add; break;
+    case Instruction::Sub:  Op = BI::Sub; break;
+    case Instruction::Mul:  Op = BI::Mul; break;
+    case Instruction::UDiv: Op = BI::UDiv; break;
+    case Instruction::SDiv: Op = BI::SDiv; break;
+    case Instruction::URem: Op = BI::URem; break;
+    case Instruction::SRem: Op = BI::SRem; break;
+    case Instruction::And:  Op = BI::And; break;
+    case Instruction::Or:   Op = BI::Or; break;
+    case Instruction::Xor:  Op = BI::Xor; break;
+    case Instruction::Shl:  Op = BI::Shl; break;
+    case Instruction::LShr: Op = BI::LShr; break;
+    case Instruction::AShr: Op = BI::AShr; break;
+    default: return false;
+    }
+  } else {
+    bool IsFloat = Ty->isFloatTy();
+    switch (I.getOpcode()) {
+    case Instruction::FAdd: Op = IsFloat ? BI::FAddF : BI::FAddD; break;
+    case Instruction::FSub: Op = IsFloat ? BI::FSubF : BI::FSubD; break;
+    case Instruction::FMul: Op = IsFloat ? BI::FMulF : BI::FMulD; break;
+    case Instruction::FDiv: Op = IsFloat ? BI::FDivF : BI::FDivD; break;
+    case Instruction::FRem: Op = IsFloat ? BI::FRemF : BI::FRemD; break;
+    default: return false;
+    }
+  }
+
+  BytecodeInst &Inst = emit(Op, I);
+  Inst.A = A;
+  Inst.B = B;
+  if (Ty->isIntegerTy()) {
+    unsigned Bits = Ty->getIntegerBitWidth();
+    Inst.Width = Bits;
+    Inst.Imm = lowBitsMask(Bits);
+    // Shifts by the bit width or more are undefined; do what the visitors do
+    // and mask the amount to the next power of two.
+    Inst.Aux = NextPowerOf2(Bits - 1) - 1;
+  }
+  return true;
+}
+
+bool BytecodeBuilder::emitCmp(CmpInst &I) {
+  uint32_t A, B;
+  if (!getReg(I.getOperand(0), A) || !getReg(I.getOperand(1), B))
+    return false;
+
+  typedef BytecodeInst BI;
+  Type *OpTy = I.getOperand(0)->getType();
+  BI::Opcode Op;
+  if (isa<FCmpInst>(I)) {
+    Op = OpTy->isFloatTy() ? BI::FCmpF : BI::FCmpD;
+  } else {
+    switch (I.getPredicate()) {
+    case ICmpInst::ICMP_EQ:  Op = BI::ICmpEQ; break;
+    case ICmpInst::ICMP_NE:  Op = BI::ICmpNE; break;
+    case ICmpInst::ICMP_UGT: Op = BI::ICmpUGT; break;
+    case ICmpInst::ICMP_UGE: Op = BI::ICmpUGE; break;
+    case ICmpInst::ICMP_ULT: Op = BI::ICmpULT; break;
+    case ICmpInst::ICMP_ULE: Op = BI::ICmpULE; break;
+    case ICmpInst::ICMP_SGT: Op = BI::ICmpSGT; break;
+    case ICmpInst::ICMP_SGE: Op = BI::ICmpSGE; break;
+    case ICmpInst::ICMP_SLT: Op = BI::ICmpSLT; break;
+    case ICmpInst::ICMP_SLE: Op = BI::ICmpSLE; break;
+    default: return false;
+    }
+  }
+
+  BytecodeInst &Inst = emit(Op, I);
+  Inst.A = A;
+  Inst.B = B;
+  Inst.Aux = I.getPredicate();
+  Inst.Width = OpTy->isIntegerTy() ? OpTy->getIntegerBitWidth()
+                                   : 8 * sizeof(void *);
+  return true;
+}
+
+bool BytecodeBuilder::emitCast(CastInst &I) {
+  uint32_t A;
+  if (!getReg(I.getOperand(0), A))
+    return false;
+
+  typedef BytecodeInst BI;
+  Type *SrcTy = I.getSrcTy(), *DstTy = I.getDestTy();
+  unsigned SrcBits = SrcTy->isIntegerTy() ? SrcTy->getIntegerBitWidth()
+                                          : 8 * sizeof(void *);
+  unsigned DstBits = DstTy->isIntegerTy() ? DstTy->getIntegerBitWidth()
+                                          : 8 * sizeof(void *);
+  BI::Opcode Op;
+  switch (I.getOpcode()) {
+  case Instruction::ZExt:
+  case Instruction::BitCast:
+    Op = BI::Move;
+    break;
+  case Instruction::Trunc:
+  case Instruction::PtrToInt:
+  case Instruction::IntToPtr:
+    Op = DstBits < SrcBits ? BI::Trunc : BI::Move;
+    break;
+  case Instruction::SExt:
+    Op = BI::SExt;
+    break;
+  case Instruction::FPTrunc:
+    Op = BI::FPTrunc;
+    break;
+  case Instruction::FPExt:
+    Op = BI::FPExt;
+    break;
+  case Instruction::FPToUI:
+    Op = SrcTy->isFloatTy() ? BI::FPToUIF : BI::FPToUID;
+    break;
+  case Instruction::FPToSI:
+    Op = SrcTy->isFloatTy() ? BI::FPToSIF : BI::FPToSID;
+    break;
+  case Instruction::UIToFP:
+    Op = DstTy->isFloatTy() ? BI::UIToFPF : BI::UIToFPD;
+    break;
+  case Instruction::SIToFP:
+    Op = DstTy->isFloatTy() ? BI::SIToFPF : BI::SIToFPD;
+    break;
+  default:
+    return false;
+  }
+
+  // FPTrunc and FPExt only go between float and double here.
+  if ((Op == BI::FPTrunc && !DstTy->isFloatTy()) ||
+      (Op == BI::FPExt && !SrcTy->isFloatTy()))
+    return false;
+
+  BytecodeInst &Inst = emit(Op, I);
+  Inst.A = A;
+  Inst.Width = SrcBits;
+  Inst.Imm = lowBitsMask(DstBits);
+  return true;
+}
+
+bool BytecodeBuilder::emitGEP(GetElementPtrInst &I) {
+  uint32_t Base;
+  if (I.getType()->isVectorTy() || !getReg(I.getPointerOperand(), Base))
+    return false;
+
+  int64_t Offset = 0;
+  uint32_t FirstIndex = BC.GEPIndices.size();
+  for (gep_type_iterator GTI = gep_type_begin(I), E = gep_type_end(I);
+       GTI != E; ++GTI) {
+    Value *Idx = GTI.getOperand();
+    if (StructType *STy = dyn_cast<StructType>(*GTI)) {
+      unsigned Field = cast<ConstantInt>(Idx)->getZExtValue();
+      Offset += DL.getStructLayout(STy)->getElementOffset(Field);
+      continue;
+    }
+
+    int64_t Scale =
+        DL.getTypeAllocSize(cast<SequentialType>(*GTI)->getElementType());
+    if (auto *CI = dyn_cast<ConstantInt>(Idx)) {
+      if (CI->getBitWidth() > 64)
+        return false;
+      Offset += Scale * CI->getSExtValue();
+      continue;
+    }
+
+    BytecodeGEPIndex Index;
+    if (Idx->getType()->getIntegerBitWidth() > 64 || !getReg(Idx, Index.Reg))
+      return false;
+    Index.Bits = Idx->getType()->getIntegerBitWidth();
+    Index.Scale = Scale;
+    BC.GEPIndices.push_back(Index);
+  }
+
+  BytecodeInst &Inst = emit(BytecodeInst::GEP, I);
+  Inst.A = Base;
+  Inst.B = FirstIndex;
+  Inst.C = BC.GEPIndices.size() - FirstIndex;
+  Inst.Imm = Offset;
+  return true;
+}
+
+bool BytecodeBuilder::emitCall(CallInst &I) {
+  Value *CalledValue = I.getCalledValue();
+  if (isa<InlineAsm>(CalledValue))
+    return false;
+
+  Function *Callee = I.getCalledFunction();
+  if (Callee && Callee->isDeclaration()) {
+    switch (Callee->getIntrinsicID()) {
+    case Intrinsic::not_intrinsic:
+      break;
+    case Intrinsic::dbg_declare:
+    case Intrinsic::dbg_value:
+    case Intrinsic::lifetime_start:
+    case Intrinsic::lifetime_end:
+    case Intrinsic::invariant_end:
+    case Intrinsic::assume:
+    case Intrinsic::var_annotation:
+    case Intrinsic::prefetch:
+      // These have no effect on the program.
+      return true;
+    case Intrinsic::memcpy:
+    case Intrinsic::memmove:
+    case Intrinsic::memset: {
+      uint32_t A, B, C;
+      if (!getReg(I.getArgOperand(0), A) || !getReg(I.getArgOperand(1), B) ||
+          !getReg(I.getArgOperand(2), C))
+        return false;
+      BytecodeInst::Opcode Op =
+          Callee->getIntrinsicID() == Intrinsic::memcpy
+              ? BytecodeInst::MemCpy
+              : Callee->getIntrinsicID() == Intrinsic::memmove
+                    ? BytecodeInst::MemMove
+                    : BytecodeInst::MemSet;
+      BytecodeInst &Inst = emit(Op, I);
+      Inst.A = A;
+      Inst.B = B;
+      Inst.C = C;
+      return true;
+    }
+    default:
+      // Leave the rest to the visitors, which lower them as they go.
+      return false;
+    }
+  }
+
+  BytecodeCall Call;
+  Call.Callee = Callee;
+  Call.CalleeReg = BytecodeFunction::NoReg;
+  Call.Dst = BytecodeFunction::NoReg;
+  if (!Callee && !getReg(CalledValue, Call.CalleeReg))
+    return false;
+  if (!getType(I.getType(), Call.RetType))
+    return false;
+  for (Value *Arg : I.arg_operands()) {
+    uint32_t Reg;
+    BytecodeType T;
+    if (!getType(Arg->getType(), T) || !getReg(Arg, Reg))
+      return false;
+    Call.ArgRegs.push_back(Reg);
+    Call.ArgTypes.push_back(T);
+  }
+
+  BytecodeInst &Inst = emit(BytecodeInst::Call, I);
+  if (!I.getType()->isVoidTy())
+    Call.Dst = Inst.Dst;
+  Inst.A = BC.Calls.size();
+  BC.Calls.push_back(std::move(Call));
+  return true;
+}
+
+bool BytecodeBuilder::emitTerminator(TerminatorInst &I) {
+  BasicBlock *BB = I.getParent();
+  switch (I.getOpcode()) {
+  case Instruction::Ret: {
+    uint32_t A = BytecodeFunction::NoReg;
+    if (I.getNumOperands() && !getReg(I.getOperand(0), A))
+      return false;
+    emit(BytecodeInst::Ret, I).A = A;
+    return true;
+  }
+  case Instruction::Br: {
+    auto &BI = cast<BranchInst>(I);
+    if (BI.isUnconditional()) {
+      uint32_t E;
+      if (!getEdge(BB, BI.getSuccessor(0), E))
+        return false;
+      emit(BytecodeInst::Br, I).A = E;
+      return true;
+    }
+    uint32_t Cond, T, F;
+    if (!getReg(BI.getCondition(), Cond) ||
+        !getEdge(BB, BI.getSuccessor(0), T) ||
+        !getEdge(BB, BI.getSuccessor(1), F))
+      return false;
+    BytecodeInst &Inst = emit(BytecodeInst::CondBr, I);
+    Inst.A = Cond;
+    Inst.B = T;
+    Inst.C = F;
+    return true;
+  }
+  case Instruction::Switch: {
+    auto &SI = cast<SwitchInst>(I);
+    BytecodeSwitch Switch;
+    uint32_t Cond;
+    if (SI.getCondition()->getType()->getIntegerBitWidth() > 64 ||
+        !getReg(SI.getCondition(), Cond) ||
+        !getEdge(BB, SI.getDefaultDest(), Switch.DefaultEdge))
+      return false;
+    for (auto Case : SI.cases()) {
+      uint32_t E;
+      if (!getEdge(BB, Case.getCaseSuccessor(), E))
+        return false;
+      Switch.Cases.push_back(
+          std::make_pair(Case.getCaseValue()->getZExtValue(), E));
+    }
+    std::sort(Switch.Cases.begin(), Switch.Cases.end());
+
+    BytecodeInst &Inst = emit(BytecodeInst::Switch, I);
+    Inst.A = Cond;
+    Inst.B = BC.Switches.size();
+    BC.Switches.push_back(std::move(Switch));
+    return true;
+  }
+  case Instruction::Unreachable:
+    emit(BytecodeInst::Unreachable, I);
+    return true;
+  default:
+    return false;
+  }
+}
+
+const BytecodeFunction *Interpreter::getBytecode(Function *F) {
+  auto I = BytecodeCache.find(F);
+  if (I != BytecodeCache.end())
+    return I->second.get();
+
+  auto EvaluateConstant = [this](Constant *C) {
+    ExecutionContext SF;
+    return getOperandValue(C, SF);
+  };
+  auto BC = llvm::make_unique<BytecodeFunction>();
+  if (BytecodeBuilder(*F, getDataLayout(), EvaluateConstant, *BC).build()) {
+    ++NumBytecodeFunctions;
+    DEBUG(dbgs() << "Decoded " << F->getName() << " into " << BC->Code.size()
+                 << " bytecode instructions\n");
+  } else {
+    BC.reset();
+  }
+  return (BytecodeCache[F] = std::move(BC)).get();
+}
+
+//===----------------------------------------------------------------------===//
+//                        Running bytecode
+//===----------------------------------------------------------------------===//
+
+static bool evaluateFCmp(unsigned Pred, double X, double Y) {
+  bool Unordered = std::isnan(X) || std::isnan(Y);
+  switch (Pred) {
+  case FCmpInst::FCMP_FALSE: return false;
+  case FCmpInst::FCMP_OEQ:   return !Unordered && X == Y;
+  case FCmpInst::FCMP_OGT:   return !Unordered && X > Y;
+  case FCmpInst::FCMP_OGE:   return !Unordered && X >= Y;
+  case FCmpInst::FCMP_OLT:   return !Unordered && X < Y;
+  case FCmpInst::FCMP_OLE:   return !Unordered && X <= Y;
+  case FCmpInst::FCMP_ONE:   return !Unordered && X != Y;
+  case FCmpInst::FCMP_ORD:   return !Unordered;
+  case FCmpInst::FCMP_UNO:   return Unordered;
+  case FCmpInst::FCMP_UEQ:   return Unordered || X == Y;
+  case FCmpInst::FCMP_UGT:   return Unordered || X > Y;
+  case FCmpInst::FCMP_UGE:   return Unordered || X >= Y;
+  case FCmpInst::FCMP_ULT:   return Unordered || X < Y;
+  case FCmpInst::FCMP_ULE:   return Unordered || X <= Y;
+  case FCmpInst::FCMP_UNE:   return Unordered || X != Y;
+  case FCmpInst::FCMP_TRUE:  return true;
+  }
+  llvm_unreachable("Invalid floating point predicate");
+}
+
+/// Do the PHI moves of an edge and return the bytecode index it leads to.
+static unsigned takeEdge(const BytecodeFunction &BC, unsigned EdgeIdx,
+                         uint64_t *R) {
+  const BytecodeEdge &E = BC.Edges[EdgeIdx];
+  const std::pair<uint32_t, uint32_t> *Moves = BC.Moves.data() + E.FirstMove;
+  if (!E.NeedsTemps) {
+    for (unsigned i = 0; i != E.NumMoves; ++i)
+      R[Moves[i].first] = R[Moves[i].second];
+  } else {
+    SmallVector<uint64_t, 8> Temps;
+    for (unsigned i = 0; i != E.NumMoves; ++i)
+      Temps.push_back(R[Moves[i].second]);
+    for (unsigned i = 0; i != E.NumMoves; ++i)
+      R[Moves[i].first] = Temps[i];
+  }
+  return E.Target;
+}
+
+static float asFloat(uint64_t Raw) { return BitsToFloat(Raw); }
+static double asDouble(uint64_t Raw) { return BitsToDouble(Raw); }
+static uint64_t fromFloat(float F) { return FloatToBits(F); }
+static uint64_t fromDouble(double D) { return DoubleToBits(D); }
+
+void Interpreter::runBytecode(ExecutionContext &SF) {
+  typedef BytecodeInst BI;
+  const BytecodeFunction &BC = *SF.Bytecode;
+  const BytecodeInst *Code = BC.Code.data();
+  uint64_t *R = SF.Regs.data();
+  unsigned PC = SF.PC;
+  unsigned NumExecuted = 0;
+
+  // Both ways out of the loop, calls and returns, may grow or shrink ECStack
+  // and so invalidate SF: save the state first, and return straight away.
+  for (;;) {
+    const BytecodeInst &I = Code[PC++];
+    ++NumExecuted;
+
+    switch (I.Op) {
+    // Integer arithmetic.
+    case BI::Add: R[I.Dst] = (R[I.A] + R[I.B]) & I.Imm; break;
+    case BI::Sub: R[I.Dst] = (R[I.A] - R[I.B]) & I.Imm; break;
+    case BI::Mul: R[I.Dst] = (R[I.A] * R[I.B]) & I.Imm; break;
+    case BI::UDiv: R[I.Dst] = R[I.A] / R[I.B]; break;
+    case BI::URem: R[I.Dst] = R[I.A] % R[I.B]; break;
+    case BI::SDiv:
+    case BI::SRem: {
+      int64_t X = SignExtend64(R[I.A], I.Width);
+      int64_t Y = SignExtend64(R[I.B], I.Width);
+      // Avoid trapping on INT64_MIN / -1; the result wraps like APInt's.
+      uint64_t Res;
+      if (Y == -1)
+        Res = I.Op == BI::SDiv ? 0 - (uint64_t)X : 0;
+      else
+        Res = I.Op == BI::SDiv ? X / Y : X % Y;
+      R[I.Dst] = Res & I.Imm;
+      break;
+    }
+    case BI::And: R[I.Dst] = R[I.A] & R[I.B]; break;
+    case BI::Or:  R[I.Dst] = R[I.A] | R[I.B]; break;
+    case BI::Xor: R[I.Dst] = R[I.A] ^ R[I.B]; break;
+    case BI::Shl:
+    case BI::LShr:
+    case BI::AShr: {
+      uint64_t Amt = R[I.B];
+      if (Amt >= I.Width)
+        Amt &= I.Aux;
+      uint64_t Res;
+      if (I.Op == BI::AShr) {
+        int64_t X = SignExtend64(R[I.A], I.Width);
+        Res = Amt >= I.Width ? X >> 63 : X >> Amt;
+      } else if (Amt >= I.Width) {
+        Res = 0;
+      } else {
+        Res = I.Op == BI::Shl ? R[I.A] << Amt : R[I.A] >> Amt;
+      }
+      R[I.Dst] = Res & I.Imm;
+      break;
+    }
+
+    // Floating point arithmetic.
+    case BI::FAddF:
+      R[I.Dst] = fromFloat(asFloat(R[I.A]) + asFloat(R[I.B]));
+      break;
+    case BI::FSubF:
+      R[I.Dst] = fromFloat(asFloat(R[I.A]) - asFloat(R[I.B]));
+      break;
+    case BI::FMulF:
+      R[I.Dst] = fromFloat(asFloat(R[I.A]) * asFloat(R[I.B]));
+      break;
+    case BI::FDivF:
+      R[I.Dst] = fromFloat(asFloat(R[I.A]) / asFloat(R[I.B]));
+      break;
+    case BI::FRemF:
+      R[I.Dst] = fromFloat(fmod(asFloat(R[I.A]), asFloat(R[I.B])));
+      break;
+    case BI::FAddD:
+      R[I.Dst] = fromDouble(asDouble(R[I.A]) + asDouble(R[I.B]));
+      break;
+    case BI::FSubD:
+      R[I.Dst] = fromDouble(asDouble(R[I.A]) - asDouble(R[I.B]));
+      break;
+    case BI::FMulD:
+      R[I.Dst] = fromDouble(asDouble(R[I.A]) * asDouble(R[I.B]));
+      break;
+    case BI::FDivD:
+      R[I.Dst] = fromDouble(asDouble(R[I.A]) / asDouble(R[I.B]));
+      break;
+    case BI::FRemD:
+      R[I.Dst] = fromDouble(fmod(asDouble(R[I.A]), asDouble(R[I.B])));
+      break;
+
+    // Comparisons.
+    case BI::ICmpEQ:  R[I.Dst] = R[I.A] == R[I.B]; break;
+    case BI::ICmpNE:  R[I.Dst] = R[I.A] != R[I.B]; break;
+    case BI::ICmpUGT: R[I.Dst] = R[I.A] > R[I.B]; break;
+    case BI::ICmpUGE: R[I.Dst] = R[I.A] >= R[I.B]; break;
+    case BI::ICmpULT: R[I.Dst] = R[I.A] < R[I.B]; break;
+    case BI::ICmpULE: R[I.Dst] = R[I.A] <= R[I.B]; break;
+    case BI::ICmpSGT:
+      R[I.Dst] = SignExtend64(R[I.A], I.Width) > SignExtend64(R[I.B], I.Width);
+      break;
+    case BI::ICmpSGE:
+      R[I.Dst] = SignExtend64(R[I.A], I.Width) >= SignExtend64(R[I.B], I.Width);
+      break;
+    case BI::ICmpSLT:
+      R[I.Dst] = SignExtend64(R[I.A], I.Width) < SignExtend64(R[I.B], I.Width);
+      break;
+    case BI::ICmpSLE:
+      R[I.Dst] = SignExtend64(R[I.A], I.Width) <= SignExtend64(R[I.B], I.Width);
+      break;
+    case BI::FCmpF:
+      R[I.Dst] = evaluateFCmp(I.Aux, asFloat(R[I.A]), asFloat(R[I.B]));
+      break;
+    case BI::FCmpD:
+      R[I.Dst] = evaluateFCmp(I.Aux, asDouble(R[I.A]), asDouble(R[I.B]));
+      break;
+
+    case BI::Select: R[I.Dst] = (R[I.A] & 1) ? R[I.B] : R[I.C]; break;
+
+    // Casts.
+    case BI::Move:  R[I.Dst] = R[I.A]; break;
+    case BI::Trunc: R[I.Dst] = R[I.A] & I.Imm; break;
+    case BI::SExt:  R[I.Dst] = SignExtend64(R[I.A], I.Width) & I.Imm; break;
+    case BI::FPTrunc: R[I.Dst] = fromFloat((float)asDouble(R[I.A])); break;
+    case BI::FPExt:   R[I.Dst] = fromDouble((double)asFloat(R[I.A])); break;
+    case BI::FPToUIF:
+    case BI::FPToUID:
+    case BI::FPToSIF:
+    case BI::FPToSID: {
+      double X = I.Op == BI::FPToUIF || I.Op == BI::FPToSIF ? asFloat(R[I.A])
+                                                            : asDouble(R[I.A]);
+      // Only 64-bit unsigned results can be out of range of int64_t.
+      bool IsUnsigned64 = (I.Op == BI::FPToUIF || I.Op == BI::FPToUID) &&
+                          I.Imm == ~0ULL;
+      R[I.Dst] = (IsUnsigned64 ? (uint64_t)X : (uint64_t)(int64_t)X) & I.Imm;
+      break;
+    }
+    case BI::UIToFPF: R[I.Dst] = fromFloat((float)R[I.A]); break;
+    case BI::UIToFPD: R[I.Dst] = fromDouble((double)R[I.A]); break;
+    case BI::SIToFPF:
+      R[I.Dst] = fromFloat((float)SignExtend64(R[I.A], I.Width));
+      break;
+    case BI::SIToFPD:
+      R[I.Dst] = fromDouble((double)SignExtend64(R[I.A], I.Width));
+      break;
+
+    // Memory.
+    case BI::Load: {
+      uint64_t V = 0;
+      memcpy(&V, (void *)(uintptr_t)R[I.A], I.Aux);
+      R[I.Dst] = V & I.Imm;
+      break;
+    }
+    case BI::Store:
+      memcpy((void *)(uintptr_t)R[I.B], &R[I.A], I.Aux);
+      break;
+    case BI::Alloca: {
+      // Use the same (32-bit) arithmetic as visitAllocaInst.
+      unsigned NumElements = R[I.A];
+      unsigned MemToAlloc = std::max(1U, NumElements * unsigned(I.Imm));
+      void *Memory = malloc(MemToAlloc);
+      assert(Memory && "Null pointer returned by malloc!");
+      SF.Allocas.add(Memory);
+      R[I.Dst] = (uintptr_t)Memory;
+      break;
+    }
+    case BI::GEP: {
+      uint64_t Ptr = R[I.A] + I.Imm;
+      for (unsigned i = 0; i != I.C; ++i) {
+        const BytecodeGEPIndex &Idx = BC.GEPIndices[I.B + i];
+        Ptr += SignExtend64(R[Idx.Reg], Idx.Bits) * Idx.Scale;
+      }
+      R[I.Dst] = Ptr;
+      break;
+    }
+    case BI::MemCpy:
+      memcpy((void *)(uintptr_t)R[I.A], (void *)(uintptr_t)R[I.B], R[I.C]);
+      break;
+    case BI::MemMove:
+      memmove((void *)(uintptr_t)R[I.A], (void *)(uintptr_t)R[I.B], R[I.C]);
+      break;
+    case BI::MemSet:
+      memset((void *)(uintptr_t)R[I.A], (int)(R[I.B] & 0xff), R[I.C]);
+      break;
+
+    // Control flow.
+    case BI::Br: PC = takeEdge(BC, I.A, R); break;
+    case BI::CondBr: PC = takeEdge(BC, (R[I.A] & 1) ? I.B : I.C, R); break;
+    case BI::Switch: {
+      const BytecodeSwitch &S = BC.Switches[I.B];
+      auto Case = std::lower_bound(
+          S.Cases.begin(), S.Cases.end(), R[I.A],
+          [](const std::pair<uint64_t, uint32_t> &C, uint64_t V) {
+            return C.first < V;
+          });
+      bool Found = Case != S.Cases.end() && Case->first == R[I.A];
+      PC = takeEdge(BC, Found ? Case->second : S.DefaultEdge, R);
+      break;
+    }
+    case BI::Call: {
+      const BytecodeCall &Call = BC.Calls[I.A];
+      SmallVector<GenericValue, 8> ArgVals;
+      for (unsigned i = 0, e = Call.ArgRegs.size(); i != e; ++i)
+        ArgVals.push_back(Call.ArgTypes[i].toGenericValue(R[Call.ArgRegs[i]]));
+      Function *Callee = Call.Callee ? Call.Callee
+                                     : (Function *)(uintptr_t)R[Call.CalleeReg];
+      SF.PC = PC;
+      SF.PendingCall = &Call;
+      NumBytecodeInsts += NumExecuted;
+      callFunction(Callee, ArgVals);
+      return;
+    }
+    case BI::Ret: {
+      Type *RetTy = SF.CurFunction->getReturnType();
+      GenericValue Result;
+      if (I.A != BytecodeFunction::NoReg)
+        Result = BC.RetType.toGenericValue(R[I.A]);
+      NumBytecodeInsts += NumExecuted;
+      popStackAndReturnValueToCaller(RetTy, Result);
+      return;
+    }
+    case BI::Unreachable:
+      report_fatal_error("Program executed an 'unreachable' instruction!");
+    }
+  }
+}
@@ -0,0 +1,147 @@
+//===-- Bytecode.h - Register bytecode for the interpreter ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This header defines the register based bytecode that the interpreter decodes
+// functions into before running them.  Every argument, instruction result and
+// constant of a function is given a slot in a flat array of 64-bit registers,
+// so executing an instruction is a couple of array accesses instead of map
+// lookups and GenericValue copies.  GenericValues are only built where values
+// cross into or out of a bytecode frame: arguments, return values and calls.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_EXECUTIONENGINE_INTERPRETER_BYTECODE_H
+#define LLVM_LIB_EXECUTIONENGINE_INTERPRETER_BYTECODE_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ExecutionEngine/GenericValue.h"
+#include "llvm/Support/DataTypes.h"
+#include <vector>
+
+namespace llvm {
+
+class Function;
+
+/// How a value of one of the first class types the bytecode supports is kept
+/// in a register.  Integers are zero extended to 64 bits, pointers hold the
+/// host address and floating point values hold their bit pattern.
+struct BytecodeType {
+  enum KindTy : uint8_t { Void, Int, Pointer, Float, Double };
+
+  KindTy Kind;
+  uint8_t Bits; // Width of an integer type.
+
+  BytecodeType() : Kind(Void), Bits(0) {}
+  BytecodeType(KindTy Kind, unsigned Bits = 0) : Kind(Kind), Bits(Bits) {}
+
+  uint64_t toRaw(const GenericValue &V) const;
+  GenericValue toGenericValue(uint64_t Raw) const;
+};
+
+/// A single bytecode instruction.  Dst, A, B and C are register numbers unless
+/// the opcode says otherwise; integer results are masked with Imm.
+struct BytecodeInst {
+  enum Opcode : uint8_t {
+    // Integer arithmetic.  Width is the bit width of the operands, Aux the
+    // mask applied to oversized shift amounts.
+    Add, Sub, Mul, UDiv, SDiv, URem, SRem, And, Or, Xor, Shl, LShr, AShr,
+
+    // Floating point arithmetic on float and double registers.
+    FAddF, FSubF, FMulF, FDivF, FRemF,
+    FAddD, FSubD, FMulD, FDivD, FRemD,
+
+    // Comparisons.  Signed integer compares sign extend from Width bits,
+    // floating point compares take the predicate in Aux.
+    ICmpEQ, ICmpNE, ICmpUGT, ICmpUGE, ICmpULT, ICmpULE,
+    ICmpSGT, ICmpSGE, ICmpSLT, ICmpSLE,
+    FCmpF, FCmpD,
+
+    // Dst = A ? B : C
+    Select,
+
+    // Casts.  Move covers every cast that leaves the register unchanged.
+    // Width is the source width of SExt and of the integer to floating point
+    // conversions.
+    Move, Trunc, SExt, FPTrunc, FPExt,
+    FPToUIF, FPToUID, FPToSIF, FPToSID,
+    UIToFPF, UIToFPD, SIToFPF, SIToFPD,
+
+    // Memory.  Load and Store move Aux bytes, Alloca allocates A elements of
+    // Imm bytes each.  GEP adds the constant offset Imm and the C scaled
+    // indices starting at GEPIndices[B] to the pointer in A.
+    Load, Store, Alloca, GEP, MemCpy, MemMove, MemSet,
+
+    // Control flow.  Br takes edge A; CondBr takes edge B if A is true and
+    // edge C otherwise; Switch looks the value in A up in Switches[B]; Call
+    // makes call Calls[A]; Ret returns A, or nothing if A is NoReg.
+    Br, CondBr, Switch, Call, Ret, Unreachable
+  };
+
+  Opcode Op;
+  uint8_t Width;
+  uint8_t Aux;
+  uint32_t Dst, A, B, C;
+  uint64_t Imm;
+
+  BytecodeInst(Opcode Op)
+      : Op(Op), Width(0), Aux(0), Dst(0), A(0), B(0), C(0), Imm(0) {}
+};
+
+/// A CFG edge: where it goes, and the moves that implement the PHI nodes at
+/// its destination.
+struct BytecodeEdge {
+  uint32_t Target;
+  uint32_t FirstMove, NumMoves;
+  // Set if some move reads a register another one writes, so that all of the
+  // sources have to be read before any of the destinations are written.
+  bool NeedsTemps;
+};
+
+struct BytecodeSwitch {
+  uint32_t DefaultEdge;
+  // Case values and their edges, sorted by value.
+  std::vector<std::pair<uint64_t, uint32_t>> Cases;
+};
+
+struct BytecodeGEPIndex {
+  uint32_t Reg;
+  uint8_t Bits;
+  int64_t Scale;
+};
+
+struct BytecodeCall {
+  Function *Callee;   // Null for indirect calls, which call CalleeReg.
+  uint32_t CalleeReg;
+  uint32_t Dst;
+  BytecodeType RetType;
+  SmallVector<uint32_t, 4> ArgRegs;
+  SmallVector<BytecodeType, 4> ArgTypes;
+};
+
+/// A function decoded into bytecode.  Registers [0, ArgTypes.size()) hold the
+/// arguments.  InitialRegs is copied into every new frame and has the
+/// function's constants already in their registers.
+struct BytecodeFunction {
+  static const uint32_t NoReg = ~0U;
+
+  std::vector<BytecodeInst> Code;
+  std::vector<uint64_t> InitialRegs;
+  std::vector<BytecodeType> ArgTypes;
+  BytecodeType RetType;
+
+  std::vector<BytecodeEdge> Edges;
+  std::vector<std::pair<uint32_t, uint32_t>> Moves; // (Dst, Src)
+  std::vector<BytecodeSwitch> Switches;
+  std::vector<BytecodeGEPIndex> GEPIndices;
+  std::vector<BytecodeCall> Calls;
+};
+
+} // End llvm namespace
+
+#endif
@@ -35,6 +35,11 @@ STATISTIC(NumDynamicInsts, "Number of dynamic instructions executed");
 static cl::opt<bool> PrintVolatile("interpreter-print-volatile", cl::Hidden,
           cl::desc("make the interpreter print every volatile load and store"));
 
+static cl::opt<bool> UseBytecode("interpreter-use-bytecode", cl::Hidden,
+          cl::init(true),
+          cl::desc("decode functions into register bytecode before running "
+                   "them"));
+
 //===----------------------------------------------------------------------===//
 //                     Various Helper Functions
 //===----------------------------------------------------------------------===//
@@ -849,7 +854,11 @@ void Interpreter::popStackAndReturnValueToCaller(Type *RetTy,
     // If we have a previous stack frame, and we have a previous call,
     // fill in the return value...
     ExecutionContext &CallingSF = ECStack.back();
-    if (Instruction *I = CallingSF.Caller.getInstruction()) {
+    if (const BytecodeCall *Call = CallingSF.PendingCall) {
+      if (Call->RetType.Kind != BytecodeType::Void)
+        CallingSF.Regs[Call->Dst] = Call->RetType.toRaw(Result);
+      CallingSF.PendingCall = nullptr;
+    } else if (Instruction *I = CallingSF.Caller.getInstruction()) {
       // Save result...
       if (!CallingSF.Caller.getType()->isVoidTy())
         SetValue(I, Result, CallingSF);
@@ -2090,6 +2099,19 @@ void Interpreter::callFunction(Function *F, ArrayRef<GenericValue> ArgVals) {
     return;
   }
 
+  // Run the function from bytecode if it can be decoded.  The visitors print
+  // volatile accesses, so leave them to it if that was asked for.
+  if (UseBytecode && !PrintVolatile)
+    if (const BytecodeFunction *BC = getBytecode(F)) {
+      assert(ArgVals.size() == BC->ArgTypes.size() &&
+             "Invalid number of values passed to function invocation!");
+      StackFrame.Bytecode = BC;
+      StackFrame.Regs = BC->InitialRegs;
+      for (unsigned i = 0, e = ArgVals.size(); i != e; ++i)
+        StackFrame.Regs[i] = BC->ArgTypes[i].toRaw(ArgVals[i]);
+      return;
+    }
+
   // Get pointers to first LLVM BB & Instruction in function.
   StackFrame.CurBB     = &F->front();
   StackFrame.CurInst   = StackFrame.CurBB->begin();
@@ -2114,6 +2136,10 @@ void Interpreter::run() {
   while (!ECStack.empty()) {
     // Interpret a single instruction & increment the "PC".
     ExecutionContext &SF = ECStack.back();  // Current stack frame
+    if (SF.Bytecode) {
+      runBytecode(SF);
+      continue;
+    }
     Instruction &I = *SF.CurInst++;         // Increment before execute
 
     // Track the number of dynamic instructions executed.
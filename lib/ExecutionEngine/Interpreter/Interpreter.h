@@ -14,6 +14,8 @@
 #ifndef LLVM_LIB_EXECUTIONENGINE_INTERPRETER_INTERPRETER_H
 #define LLVM_LIB_EXECUTIONENGINE_INTERPRETER_INTERPRETER_H
 
+#include "Bytecode.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/IR/CallSite.h"
@@ -71,12 +73,23 @@ struct ExecutionContext {
   std::vector<GenericValue>  VarArgs; // Values passed through an ellipsis
   AllocaHolder Allocas;            // Track memory allocated by alloca
 
-  ExecutionContext() : CurFunction(nullptr), CurBB(nullptr), CurInst(nullptr) {}
+  // Frames of functions that were decoded into bytecode use these instead of
+  // CurBB, CurInst, Caller and Values.
+  const BytecodeFunction *Bytecode; // The decoded function, or null
+  unsigned PC;                      // The next bytecode instruction to execute
+  std::vector<uint64_t> Regs;       // The bytecode register file
+  const BytecodeCall *PendingCall;  // The call waiting for a return value
+
+  ExecutionContext()
+      : CurFunction(nullptr), CurBB(nullptr), CurInst(nullptr),
+        Bytecode(nullptr), PC(0), PendingCall(nullptr) {}
 
   ExecutionContext(ExecutionContext &&O)
       : CurFunction(O.CurFunction), CurBB(O.CurBB), CurInst(O.CurInst),
         Caller(O.Caller), Values(std::move(O.Values)),
-        VarArgs(std::move(O.VarArgs)), Allocas(std::move(O.Allocas)) {}
+        VarArgs(std::move(O.VarArgs)), Allocas(std::move(O.Allocas)),
+        Bytecode(O.Bytecode), PC(O.PC), Regs(std::move(O.Regs)),
+        PendingCall(O.PendingCall) {}
 
   ExecutionContext &operator=(ExecutionContext &&O) {
     CurFunction = O.CurFunction;
@@ -86,6 +99,10 @@ struct ExecutionContext {
     Values = std::move(O.Values);
     VarArgs = std::move(O.VarArgs);
     Allocas = std::move(O.Allocas);
+    Bytecode = O.Bytecode;
+    PC = O.PC;
+    Regs = std::move(O.Regs);
+    PendingCall = O.PendingCall;
     return *this;
   }
 };
@@ -104,6 +121,10 @@ class Interpreter : public ExecutionEngine, public InstVisitor<Interpreter> {
   // registered with the atexit() library function.
   std::vector<Function*> AtExitHandlers;
 
+  // Functions decoded into bytecode.  Functions that use something the
+  // bytecode can't express map to null and are run by the visitors instead.
+  DenseMap<Function *, std::unique_ptr<BytecodeFunction>> BytecodeCache;
+
 public:
   explicit Interpreter(std::unique_ptr<Module> M);
   ~Interpreter() override;
@@ -138,6 +159,13 @@ public:
   void callFunction(Function *F, ArrayRef<GenericValue> ArgVals);
   void run();                // Execute instructions until nothing left to do
 
+  /// Return the bytecode for F, decoding it on first use, or null if F has to
+  /// be run by the visitors.
+  const BytecodeFunction *getBytecode(Function *F);
+
+  /// Run the bytecode frame SF until it makes a call or returns.
+  void runBytecode(ExecutionContext &SF);
+
   // Opcode Implementations
   void visitReturnInst(ReturnInst &I);
   void visitBranchInst(BranchInst &I);
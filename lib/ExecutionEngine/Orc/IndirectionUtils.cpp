@@ -45,29 +45,29 @@ createLocalCompileCallbackManager(const Triple &T,
   }
 }
 
+template <typename TargetT>
+static std::function<std::unique_ptr<IndirectStubsManager>()>
+createPooledIndirectStubsManagerBuilder() {
+  // Every manager the builder creates shares one pool of stubs.
+  auto Pool = std::make_shared<LocalIndirectStubsPool<TargetT>>();
+  return [Pool]() {
+    return llvm::make_unique<LocalIndirectStubsManager<TargetT>>(Pool);
+  };
+}
+
 std::function<std::unique_ptr<IndirectStubsManager>()>
 createLocalIndirectStubsManagerBuilder(const Triple &T) {
   switch (T.getArch()) {
     default: return nullptr;
 
     case Triple::x86:
-      return [](){
-        return llvm::make_unique<
-                       orc::LocalIndirectStubsManager<orc::OrcI386>>();
-      };
+      return createPooledIndirectStubsManagerBuilder<orc::OrcI386>();
 
     case Triple::x86_64:
-      if (T.getOS() == Triple::OSType::Win32) {
-        return [](){
-          return llvm::make_unique<
-                     orc::LocalIndirectStubsManager<orc::OrcX86_64_Win32>>();
-        };
-      } else {
-        return [](){
-          return llvm::make_unique<
-                     orc::LocalIndirectStubsManager<orc::OrcX86_64_SysV>>();
-        };
-      }
+      if (T.getOS() == Triple::OSType::Win32)
+        return createPooledIndirectStubsManagerBuilder<orc::OrcX86_64_Win32>();
+      else
+        return createPooledIndirectStubsManagerBuilder<orc::OrcX86_64_SysV>();
   }
 }
 
@@ -230,6 +230,33 @@ void moveGlobalVariableInitializer(GlobalVariable &OrigGV,
                                  nullptr, Materializer));
 }
 
+std::set<Function*> partitionWithDirectCallees(Function &F, unsigned Depth) {
+  std::set<Function*> Partition;
+  Partition.insert(&F);
+
+  std::vector<Function*> Worklist;
+  Worklist.push_back(&F);
+  for (unsigned Level = 0; Level != Depth && !Worklist.empty(); ++Level) {
+    std::vector<Function*> NextWorklist;
+    for (auto *Caller : Worklist)
+      for (auto &BB : *Caller)
+        for (auto &I : BB) {
+          CallSite CS(&I);
+          if (!CS)
+            continue;
+          auto *Callee = CS.getCalledFunction();
+          if (!Callee || Callee->isDeclaration() ||
+              Callee->getParent() != F.getParent())
+            continue;
+          if (Partition.insert(Callee).second)
+            NextWorklist.push_back(Callee);
+        }
+    Worklist = std::move(NextWorklist);
+  }
+
+  return Partition;
+}
+
 GlobalAlias* cloneGlobalAliasDecl(Module &Dst, const GlobalAlias &OrigA,
                                   ValueToValueMapTy &VMap) {
   assert(OrigA.getAliasee() && "Original alias doesn't have an aliasee?");
@@ -84,7 +84,7 @@ public:
                     IndirectStubsManagerBuilder IndirectStubsMgrBuilder)
       : DL(TM.createDataLayout()), IndirectStubsMgr(IndirectStubsMgrBuilder()),
         CCMgr(std::move(CCMgr)), ObjectLayer(),
-        CompileLayer(ObjectLayer, orc::SimpleCompiler(TM)),
+        CompileLayer(ObjectLayer, orc::ReusableCompiler(TM)),
         CODLayer(CompileLayer,
                  [](Function &F) { return std::set<Function *>({&F}); },
                  *this->CCMgr, std::move(IndirectStubsMgrBuilder), false),
@@ -43,6 +43,8 @@ public:
       return "Unexpected RPC call";
     case OrcErrorCode::UnexpectedRPCResponse:
       return "Unexpected RPC response";
+    case OrcErrorCode::JITSymbolNotFound:
+      return "Symbol not found in the JIT";
     }
     llvm_unreachable("Unhandled error code");
   }
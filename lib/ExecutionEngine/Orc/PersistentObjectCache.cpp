@@ -0,0 +1,133 @@
+//===- PersistentObjectCache.cpp - On-disk object cache for the JIT -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+static void addUint64(SmallVectorImpl<char> &Key, uint64_t I) {
+  for (unsigned N = 0; N < 8; ++N)
+    Key.push_back(I >> (N * 8));
+}
+
+static void addString(SmallVectorImpl<char> &Key, StringRef Str) {
+  addUint64(Key, Str.size());
+  Key.append(Str.begin(), Str.end());
+}
+
+PersistentObjectCache::PersistentObjectCache(std::string CacheDir,
+                                             const TargetMachine &TM)
+    : CacheDir(std::move(CacheDir)) {
+  // Everything that identifies the code generator, serialized once so that
+  // each lookup only has to hash it along with the module.
+  SmallString<128> Key;
+  addString(Key, LLVM_VERSION_STRING);
+#ifdef HAVE_LLVM_REVISION
+  addString(Key, LLVM_REVISION);
+#endif
+  addString(Key, TM.getTargetTriple().str());
+  addString(Key, TM.getTargetCPU());
+  addString(Key, TM.getTargetFeatureString());
+  addUint64(Key, TM.getOptLevel());
+  addUint64(Key, TM.getRelocationModel());
+  addUint64(Key, TM.getCodeModel());
+  TargetKey = Key.str();
+
+  sys::fs::create_directories(this->CacheDir);
+}
+
+void PersistentObjectCache::prune() {
+  if (PruningInterval < 0)
+    return;
+  CachePruning(CacheDir)
+      .setPruningInterval(PruningInterval)
+      .setEntryExpiration(Expiration)
+      .setMaxSize(MaxPercentageOfAvailableSpace)
+      .prune();
+}
+
+std::string PersistentObjectCache::getEntryPath(const Module &M) const {
+  SmallVector<char, 0> Bitcode;
+  {
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(&M, OS);
+  }
+
+  SHA1 Hasher;
+  Hasher.update(TargetKey);
+  Hasher.update(ArrayRef<uint8_t>((const uint8_t *)Bitcode.data(),
+                                  Bitcode.size()));
+
+  SmallString<128> EntryPath;
+  sys::path::append(EntryPath, CacheDir, toHex(Hasher.result()) + ".o");
+  return EntryPath.str();
+}
+
+std::unique_ptr<MemoryBuffer>
+PersistentObjectCache::getObject(const Module *M) {
+  std::string EntryPath = getEntryPath(*M);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+      MemoryBuffer::getFile(EntryPath, -1, /*RequiresNullTerminator=*/false);
+  if (Buffer) {
+    PendingEntries.erase(M);
+    return std::move(*Buffer);
+  }
+
+  // A miss is followed by a call to notifyObjectCompiled for the same module
+  // once it has been compiled.
+  PendingEntries[M] = std::move(EntryPath);
+  return nullptr;
+}
+
+void PersistentObjectCache::notifyObjectCompiled(const Module *M,
+                                                 MemoryBufferRef Obj) {
+  std::string EntryPath;
+  auto I = PendingEntries.find(M);
+  if (I != PendingEntries.end()) {
+    EntryPath = std::move(I->second);
+    PendingEntries.erase(I);
+  } else {
+    EntryPath = getEntryPath(*M);
+  }
+
+  // Write to a temporary file in the cache directory and rename it into
+  // place, so that concurrent JITs sharing the directory never see a partial
+  // entry. Failing to store an object only costs a recompile next time.
+  SmallString<128> TempPath;
+  int TempFD;
+  if (sys::fs::createUniqueFile(EntryPath + ".tmp%%%%%%", TempFD, TempPath))
+    return;
+  {
+    raw_fd_ostream OS(TempFD, /*shouldClose=*/true);
+    OS << Obj.getBuffer();
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (sys::fs::rename(TempPath, EntryPath)) {
+    sys::fs::remove(TempPath);
+    return;
+  }
+
+  prune();
+}
@@ -0,0 +1,234 @@
+//===---- SharedMemoryRPCChannel.cpp - RPC channel over shared memory -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/SharedMemoryRPCChannel.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Process.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace llvm {
+namespace orc {
+namespace remote {
+
+// The indices only ever grow; they are reduced modulo the ring size when
+// bytes are copied. Head is written by the reader and Tail by the writer, so
+// they live on separate cache lines.
+struct SharedMemoryRPCChannel::RingHeader {
+  std::atomic<uint64_t> Head;
+  char HeadPad[56];
+  std::atomic<uint64_t> Tail;
+  char TailPad[56];
+  std::atomic<uint32_t> Closed;
+  char ClosedPad[60];
+};
+
+struct SharedMemoryRPCChannel::ChannelHeader {
+  uint64_t Magic;
+  uint64_t RingSize;
+  char Pad[48];
+  // Rings[0] carries bytes from the creator to the other end, Rings[1] the
+  // replies.
+  RingHeader Rings[2];
+};
+
+static const uint64_t ChannelMagic = 0x4f52435348524d31ULL; // "ORCSHRM1"
+
+static Error channelClosedError() {
+  return errorCodeToError(std::make_error_code(std::errc::broken_pipe));
+}
+
+// Spin for a while before yielding, and yield for a while before sleeping,
+// so that a busy peer is picked up quickly without burning a core forever
+// when the peer is idle.
+static void backOff(unsigned &Iteration) {
+  ++Iteration;
+  if (Iteration < 1024)
+    return;
+  if (Iteration < 2048)
+    std::this_thread::yield();
+  else
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+Expected<std::unique_ptr<SharedMemoryRPCChannel>>
+SharedMemoryRPCChannel::create(StringRef Path, uint64_t RingSize) {
+  assert(isPowerOf2_64(RingSize) && "Ring size must be a power of two");
+
+  int FD;
+  if (auto EC = sys::fs::openFileForWrite(Path, FD,
+                                          sys::fs::F_RW))
+    return errorCodeToError(EC);
+
+  uint64_t Size = sizeof(ChannelHeader) + 2 * RingSize;
+  std::error_code EC = sys::fs::resize_file(FD, Size);
+  std::unique_ptr<sys::fs::mapped_file_region> Region;
+  if (!EC)
+    Region = llvm::make_unique<sys::fs::mapped_file_region>(
+        FD, sys::fs::mapped_file_region::readwrite, Size, 0, EC);
+  sys::Process::SafelyCloseFileDescriptor(FD);
+  if (EC) {
+    sys::fs::remove(Path);
+    return errorCodeToError(EC);
+  }
+
+  auto *Header = reinterpret_cast<ChannelHeader *>(Region->data());
+  Header->Magic = ChannelMagic;
+  Header->RingSize = RingSize;
+  for (RingHeader &Ring : Header->Rings) {
+    new (&Ring.Head) std::atomic<uint64_t>(0);
+    new (&Ring.Tail) std::atomic<uint64_t>(0);
+    new (&Ring.Closed) std::atomic<uint32_t>(0);
+  }
+
+  return std::unique_ptr<SharedMemoryRPCChannel>(
+      new SharedMemoryRPCChannel(std::move(Region), true, Path));
+}
+
+Expected<std::unique_ptr<SharedMemoryRPCChannel>>
+SharedMemoryRPCChannel::open(StringRef Path) {
+  uint64_t Size;
+  if (auto EC = sys::fs::file_size(Path, Size))
+    return errorCodeToError(EC);
+  if (Size < sizeof(ChannelHeader))
+    return errorCodeToError(
+        std::make_error_code(std::errc::invalid_argument));
+
+  // Open for appending, so that the rings the creator set up aren't
+  // truncated. The mapping ignores the file offset anyway.
+  int FD;
+  if (auto EC = sys::fs::openFileForWrite(Path, FD,
+                                          sys::fs::F_RW | sys::fs::F_Append))
+    return errorCodeToError(EC);
+
+  std::error_code EC;
+  auto Region = llvm::make_unique<sys::fs::mapped_file_region>(
+      FD, sys::fs::mapped_file_region::readwrite, Size, 0, EC);
+  sys::Process::SafelyCloseFileDescriptor(FD);
+  if (EC)
+    return errorCodeToError(EC);
+
+  auto *Header = reinterpret_cast<ChannelHeader *>(Region->data());
+  if (Header->Magic != ChannelMagic ||
+      Size != sizeof(ChannelHeader) + 2 * Header->RingSize)
+    return errorCodeToError(
+        std::make_error_code(std::errc::invalid_argument));
+
+  return std::unique_ptr<SharedMemoryRPCChannel>(
+      new SharedMemoryRPCChannel(std::move(Region), false, ""));
+}
+
+SharedMemoryRPCChannel::SharedMemoryRPCChannel(
+    std::unique_ptr<sys::fs::mapped_file_region> Region, bool IsCreator,
+    std::string Path)
+    : Region(std::move(Region)), OwnedPath(std::move(Path)) {
+  auto *Header = reinterpret_cast<ChannelHeader *>(this->Region->data());
+  RingSize = Header->RingSize;
+  char *Data = this->Region->data() + sizeof(ChannelHeader);
+  unsigned In = IsCreator ? 1 : 0, Out = IsCreator ? 0 : 1;
+  InRing = &Header->Rings[In];
+  OutRing = &Header->Rings[Out];
+  InData = Data + In * RingSize;
+  OutData = Data + Out * RingSize;
+  PendingTail = OutRing->Tail.load(std::memory_order_relaxed);
+}
+
+SharedMemoryRPCChannel::~SharedMemoryRPCChannel() {
+  close();
+  Region.reset();
+  if (!OwnedPath.empty())
+    sys::fs::remove(OwnedPath);
+}
+
+void SharedMemoryRPCChannel::close() {
+  InRing->Closed.store(1, std::memory_order_release);
+  OutRing->Closed.store(1, std::memory_order_release);
+}
+
+Error SharedMemoryRPCChannel::readBytes(char *Dst, unsigned Size) {
+  assert(Dst && "Attempt to read into null.");
+  uint64_t Head = InRing->Head.load(std::memory_order_relaxed);
+  while (Size != 0) {
+    uint64_t Tail;
+    if (auto Err = waitForWriter(Head, Tail))
+      return Err;
+
+    uint64_t Offset = Head & (RingSize - 1);
+    uint64_t N = std::min<uint64_t>(
+        std::min<uint64_t>(Tail - Head, Size), RingSize - Offset);
+    memcpy(Dst, InData + Offset, N);
+    Dst += N;
+    Size -= N;
+    Head += N;
+    InRing->Head.store(Head, std::memory_order_release);
+  }
+  return Error::success();
+}
+
+Error SharedMemoryRPCChannel::appendBytes(const char *Src, unsigned Size) {
+  assert(Src && "Attempt to append from null.");
+  while (Size != 0) {
+    uint64_t Head = OutRing->Head.load(std::memory_order_acquire);
+    if (PendingTail - Head == RingSize) {
+      // The message doesn't fit. Let the reader see what we have so far, and
+      // wait for it to make room.
+      OutRing->Tail.store(PendingTail, std::memory_order_release);
+      if (auto Err = waitForReader(Head))
+        return Err;
+    }
+
+    uint64_t Offset = PendingTail & (RingSize - 1);
+    uint64_t N = std::min<uint64_t>(
+        std::min<uint64_t>(RingSize - (PendingTail - Head), Size),
+        RingSize - Offset);
+    memcpy(OutData + Offset, Src, N);
+    Src += N;
+    Size -= N;
+    PendingTail += N;
+  }
+  return Error::success();
+}
+
+Error SharedMemoryRPCChannel::send() {
+  std::lock_guard<std::mutex> Lock(getWriteLock());
+  if (OutRing->Closed.load(std::memory_order_acquire))
+    return channelClosedError();
+  OutRing->Tail.store(PendingTail, std::memory_order_release);
+  return Error::success();
+}
+
+Error SharedMemoryRPCChannel::waitForReader(uint64_t &Head) {
+  unsigned Iteration = 0;
+  while ((Head = OutRing->Head.load(std::memory_order_acquire)) +
+             RingSize == PendingTail) {
+    if (OutRing->Closed.load(std::memory_order_acquire))
+      return channelClosedError();
+    backOff(Iteration);
+  }
+  return Error::success();
+}
+
+Error SharedMemoryRPCChannel::waitForWriter(uint64_t Head, uint64_t &Tail) {
+  unsigned Iteration = 0;
+  while ((Tail = InRing->Tail.load(std::memory_order_acquire)) == Head) {
+    // Bytes sent before the ring was closed can still be read.
+    if (InRing->Closed.load(std::memory_order_acquire) &&
+        InRing->Tail.load(std::memory_order_acquire) == Head)
+      return channelClosedError();
+    backOff(Iteration);
+  }
+  return Error::success();
+}
+
+} // end namespace remote
+} // end namespace orc
+} // end namespace llvm
@@ -0,0 +1,70 @@
+//===--- TieredCompileLayer.cpp - Recompile hot code at a higher tier -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TieredCompileLayer.h"
+#include "llvm/IR/IRBuilder.h"
+
+namespace llvm {
+namespace orc {
+
+void addTierUpCounter(Function &F, unsigned Threshold, unsigned PollInterval,
+                      TargetAddress Callback, TargetAddress CallbackCtx,
+                      uint64_t Key) {
+  assert(!F.isDeclaration() && "Can't count calls to a declaration");
+  Module &M = *F.getParent();
+  LLVMContext &Ctx = M.getContext();
+  Type *Int32Ty = Type::getInt32Ty(Ctx);
+  Type *Int64Ty = Type::getInt64Ty(Ctx);
+
+  auto *Counter =
+    new GlobalVariable(M, Int32Ty, false, GlobalValue::PrivateLinkage,
+                       ConstantInt::get(Int32Ty, 0), F.getName() + "$calls");
+
+  // Count after the static allocas, so that they stay in the entry block.
+  BasicBlock &Entry = F.getEntryBlock();
+  BasicBlock::iterator SplitPt = Entry.begin();
+  while (isa<AllocaInst>(SplitPt))
+    ++SplitPt;
+  BasicBlock *Body = Entry.splitBasicBlock(SplitPt, "tierup.body");
+  BasicBlock *TierUp = BasicBlock::Create(Ctx, "tierup", &F, Body);
+  Entry.getTerminator()->eraseFromParent();
+
+  //   Calls = atomic ++Counter
+  //   if (Calls == Threshold ||
+  //       (Calls > Threshold && Calls % PollInterval == 0))
+  //     Callback(CallbackCtx, Key)
+  IRBuilder<> Builder(&Entry);
+  Value *OldCalls =
+    Builder.CreateAtomicRMW(AtomicRMWInst::Add, Counter, Builder.getInt32(1),
+                            AtomicOrdering::Monotonic);
+  Value *Calls = Builder.CreateAdd(OldCalls, Builder.getInt32(1));
+  Value *Reached = Builder.CreateICmpEQ(Calls, Builder.getInt32(Threshold));
+  Value *Poll = Builder.CreateAnd(
+    Builder.CreateICmpUGT(Calls, Builder.getInt32(Threshold)),
+    Builder.CreateICmpEQ(Builder.CreateAnd(Calls, PollInterval - 1),
+                         Builder.getInt32(0)));
+  Builder.CreateCondBr(Builder.CreateOr(Reached, Poll), TierUp, Body);
+
+  Builder.SetInsertPoint(TierUp);
+  Type *ArgTys[] = {Type::getInt8PtrTy(Ctx), Int64Ty};
+  FunctionType *CallbackTy =
+    FunctionType::get(Type::getVoidTy(Ctx), ArgTys, false);
+  Value *Args[] = {
+    ConstantExpr::getIntToPtr(ConstantInt::get(Int64Ty, CallbackCtx),
+                              ArgTys[0]),
+    ConstantInt::get(Int64Ty, Key)};
+  Builder.CreateCall(
+    ConstantExpr::getIntToPtr(ConstantInt::get(Int64Ty, Callback),
+                              CallbackTy->getPointerTo()),
+    Args);
+  Builder.CreateBr(Body);
+}
+
+} // End namespace orc.
+} // End namespace llvm.
@@ -0,0 +1,407 @@
+//===-- PerfJITEventListener.cpp - Tell Linux perf about JITted code ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a JITEventListener object that tells Linux perf about
+// JITted functions in two ways:
+//
+//  * /tmp/perf-PID.map, the simple symbol map that perf report reads on its
+//    own, with one "START SIZE name" line per function.
+//
+//  * The jitdump format read by 'perf inject --jit', which carries a copy of
+//    the code and its source line information so that perf annotate works
+//    too.  Profiles need to be recorded with 'perf record -k mono' for the
+//    timestamps to line up.
+//
+// Records are collected in buffered streams and flushed once per object, so
+// the cost is a couple of write(2) calls per object no matter how many
+// functions it contains.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Config/config.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Object/SymbolSize.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ELF.h"
+#include "llvm/Support/Errno.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace llvm;
+using namespace llvm::object;
+
+#define DEBUG_TYPE "perf-jit-event-listener"
+
+static std::string getPerfMapPath() {
+  return ("/tmp/perf-" + Twine(::getpid()) + ".map").str();
+}
+
+static std::string getJitDumpPath() {
+  SmallString<128> Path;
+  if (const char *Dir = ::getenv("JITDUMPDIR"))
+    Path = Dir;
+  else
+    Path = "/tmp";
+  sys::path::append(Path, "jit-" + Twine(::getpid()) + ".dump");
+  return Path.str();
+}
+
+namespace {
+
+// The jitdump format, as described in tools/perf/Documentation/jitdump-
+// specification.txt in the Linux sources.  Everything is in host byte order.
+namespace jitdump {
+
+const uint32_t Magic = 0x4A695444; // "JiTD"
+const uint32_t Version = 1;
+
+struct FileHeader {
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t TotalSize;
+  uint32_t ElfMach;
+  uint32_t Pad1;
+  uint32_t Pid;
+  uint64_t Timestamp;
+  uint64_t Flags;
+};
+
+enum RecordType : uint32_t {
+  CodeLoad = 0,
+  CodeMove = 1,
+  CodeDebugInfo = 2,
+  CodeClose = 3
+};
+
+struct RecordHeader {
+  uint32_t Id;
+  uint32_t TotalSize;
+  uint64_t Timestamp;
+};
+
+// Followed by the NUL terminated function name and the code.
+struct CodeLoadRecord {
+  RecordHeader Header;
+  uint32_t Pid;
+  uint32_t Tid;
+  uint64_t VMA;
+  uint64_t CodeAddr;
+  uint64_t CodeSize;
+  uint64_t CodeIndex;
+};
+
+// Followed by NumEntries DebugEntries.
+struct DebugInfoRecord {
+  RecordHeader Header;
+  uint64_t CodeAddr;
+  uint64_t NumEntries;
+};
+
+// Followed by the NUL terminated source file name.
+struct DebugEntry {
+  uint64_t Addr;
+  int32_t Line;
+  int32_t Discrim;
+};
+
+} // end namespace jitdump
+
+class PerfJITEventListener : public JITEventListener {
+public:
+  PerfJITEventListener()
+      : PerfJITEventListener(getPerfMapPath(), getJitDumpPath()) {}
+  PerfJITEventListener(StringRef PerfMapPath, StringRef JitDumpPath);
+  ~PerfJITEventListener() override;
+
+  void NotifyObjectEmitted(const ObjectFile &Obj,
+                           const RuntimeDyld::LoadedObjectInfo &L) override;
+
+  // perf has no way to say that code went away: its records stay valid until
+  // the address range is reused, at which point newer records take priority.
+
+private:
+  bool openPerfMap(StringRef Path);
+  bool openJitDump(StringRef Path);
+
+  void writeDebugInfo(uint64_t Addr, const DILineInfoTable &Lines);
+  void writeCodeLoad(StringRef Name, uint64_t Addr, StringRef Code);
+
+  std::mutex Mutex;
+  uint32_t Pid;
+  uint64_t CodeIndex = 0;
+
+  std::unique_ptr<raw_fd_ostream> PerfMap;
+  std::unique_ptr<raw_fd_ostream> JitDump;
+  // perf finds the jitdump file through an executable mapping of it.
+  void *JitDumpMarker = nullptr;
+  size_t JitDumpMarkerSize = 0;
+};
+
+} // end anonymous namespace
+
+// Buffer up to this much before writing, or until the end of an object.
+static const size_t StreamBufferSize = 64 * 1024;
+
+static uint64_t getTimestamp() {
+  // perf record -k mono uses CLOCK_MONOTONIC.
+  struct timespec TS;
+  if (clock_gettime(CLOCK_MONOTONIC, &TS))
+    return 0;
+  return uint64_t(TS.tv_sec) * 1000000000 + TS.tv_nsec;
+}
+
+static uint32_t getHostELFMachine() {
+  switch (Triple(sys::getProcessTriple()).getArch()) {
+  case Triple::x86:         return ELF::EM_386;
+  case Triple::x86_64:      return ELF::EM_X86_64;
+  case Triple::arm:
+  case Triple::armeb:
+  case Triple::thumb:
+  case Triple::thumbeb:     return ELF::EM_ARM;
+  case Triple::aarch64:
+  case Triple::aarch64_be:  return ELF::EM_AARCH64;
+  case Triple::mips:
+  case Triple::mipsel:
+  case Triple::mips64:
+  case Triple::mips64el:    return ELF::EM_MIPS;
+  case Triple::ppc:         return ELF::EM_PPC;
+  case Triple::ppc64:
+  case Triple::ppc64le:     return ELF::EM_PPC64;
+  case Triple::systemz:     return ELF::EM_S390;
+  default:                  return ELF::EM_NONE;
+  }
+}
+
+// The code is copied from the object rather than read from Addr, which may be
+// in another process when the JIT is remote.
+static StringRef getCode(const SymbolRef &Sym, uint64_t Addr, uint64_t Size) {
+  Expected<section_iterator> SecOrErr = Sym.getSection();
+  if (!SecOrErr) {
+    consumeError(SecOrErr.takeError());
+    return StringRef();
+  }
+  StringRef Contents;
+  if ((*SecOrErr)->getContents(Contents))
+    return StringRef();
+  uint64_t Offset = Addr - (*SecOrErr)->getAddress();
+  if (Offset > Contents.size())
+    return StringRef();
+  return Contents.substr(Offset, Size);
+}
+
+template <typename T> static void writeStruct(raw_ostream &OS, const T &Value) {
+  OS.write(reinterpret_cast<const char *>(&Value), sizeof(T));
+}
+
+static void writeString(raw_ostream &OS, StringRef Str) {
+  OS << Str;
+  OS.write('\0');
+}
+
+PerfJITEventListener::PerfJITEventListener(StringRef PerfMapPath,
+                                           StringRef JitDumpPath)
+    : Pid(::getpid()) {
+  if (!openPerfMap(PerfMapPath))
+    PerfMap.reset();
+  if (!openJitDump(JitDumpPath))
+    JitDump.reset();
+}
+
+PerfJITEventListener::~PerfJITEventListener() {
+  if (JitDump) {
+    jitdump::RecordHeader Close;
+    Close.Id = jitdump::CodeClose;
+    Close.TotalSize = sizeof(Close);
+    Close.Timestamp = getTimestamp();
+    writeStruct(*JitDump, Close);
+    JitDump->flush();
+  }
+  if (JitDumpMarker)
+    ::munmap(JitDumpMarker, JitDumpMarkerSize);
+}
+
+bool PerfJITEventListener::openPerfMap(StringRef Path) {
+  std::error_code EC;
+  PerfMap = llvm::make_unique<raw_fd_ostream>(
+      Path, EC, sys::fs::F_Append | sys::fs::F_Text);
+  if (EC) {
+    DEBUG(dbgs() << "Failed to open " << Path << ": " << EC.message() << "\n");
+    return false;
+  }
+  PerfMap->SetBufferSize(StreamBufferSize);
+  return true;
+}
+
+bool PerfJITEventListener::openJitDump(StringRef Path) {
+  int FD;
+  if (std::error_code EC = sys::fs::openFileForWrite(Path, FD, sys::fs::F_RW)) {
+    DEBUG(dbgs() << "Failed to open " << Path << ": " << EC.message() << "\n");
+    return false;
+  }
+
+  // perf inject only looks at files it saw being mapped executable.
+  JitDumpMarkerSize = sys::Process::getPageSize();
+  void *Marker = ::mmap(nullptr, JitDumpMarkerSize, PROT_READ | PROT_EXEC,
+                        MAP_PRIVATE, FD, 0);
+  if (Marker == MAP_FAILED) {
+    DEBUG(dbgs() << "Failed to map " << Path << ": " << sys::StrError()
+                 << "\n");
+    ::close(FD);
+    return false;
+  }
+  JitDumpMarker = Marker;
+
+  JitDump = llvm::make_unique<raw_fd_ostream>(FD, /*shouldClose=*/true);
+  JitDump->SetBufferSize(StreamBufferSize);
+
+  jitdump::FileHeader Header;
+  Header.Magic = jitdump::Magic;
+  Header.Version = jitdump::Version;
+  Header.TotalSize = sizeof(Header);
+  Header.ElfMach = getHostELFMachine();
+  Header.Pad1 = 0;
+  Header.Pid = Pid;
+  Header.Timestamp = getTimestamp();
+  Header.Flags = 0;
+  writeStruct(*JitDump, Header);
+  JitDump->flush();
+  return true;
+}
+
+void PerfJITEventListener::writeDebugInfo(uint64_t Addr,
+                                          const DILineInfoTable &Lines) {
+  uint64_t Size = sizeof(jitdump::DebugInfoRecord);
+  for (const auto &Line : Lines)
+    Size += sizeof(jitdump::DebugEntry) + Line.second.FileName.size() + 1;
+
+  jitdump::DebugInfoRecord Record;
+  Record.Header.Id = jitdump::CodeDebugInfo;
+  Record.Header.TotalSize = Size;
+  Record.Header.Timestamp = getTimestamp();
+  Record.CodeAddr = Addr;
+  Record.NumEntries = Lines.size();
+  writeStruct(*JitDump, Record);
+
+  for (const auto &Line : Lines) {
+    jitdump::DebugEntry Entry;
+    Entry.Addr = Line.first;
+    Entry.Line = Line.second.Line;
+    Entry.Discrim = 0;
+    writeStruct(*JitDump, Entry);
+    writeString(*JitDump, Line.second.FileName);
+  }
+}
+
+void PerfJITEventListener::writeCodeLoad(StringRef Name, uint64_t Addr,
+                                         StringRef Code) {
+  jitdump::CodeLoadRecord Record;
+  Record.Header.Id = jitdump::CodeLoad;
+  Record.Header.TotalSize = sizeof(Record) + Name.size() + 1 + Code.size();
+  Record.Header.Timestamp = getTimestamp();
+  Record.Pid = Pid;
+  Record.Tid = ::syscall(SYS_gettid);
+  Record.VMA = Addr;
+  Record.CodeAddr = Addr;
+  Record.CodeSize = Code.size();
+  Record.CodeIndex = CodeIndex++;
+  writeStruct(*JitDump, Record);
+  writeString(*JitDump, Name);
+  *JitDump << Code;
+}
+
+void PerfJITEventListener::NotifyObjectEmitted(
+                                       const ObjectFile &Obj,
+                                       const RuntimeDyld::LoadedObjectInfo &L) {
+  if (!PerfMap && !JitDump)
+    return;
+
+  OwningBinary<ObjectFile> DebugObjOwner = L.getObjectForDebug(Obj);
+  const ObjectFile &DebugObj = *DebugObjOwner.getBinary();
+  DWARFContextInMemory Context(DebugObj);
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+
+  // Use symbol info to iterate functions in the object.
+  for (const std::pair<SymbolRef, uint64_t> &P : computeSymbolSizes(DebugObj)) {
+    SymbolRef Sym = P.first;
+    Expected<SymbolRef::Type> SymTypeOrErr = Sym.getType();
+    if (!SymTypeOrErr) {
+      consumeError(SymTypeOrErr.takeError());
+      continue;
+    }
+    if (*SymTypeOrErr != SymbolRef::ST_Function)
+      continue;
+
+    Expected<StringRef> Name = Sym.getName();
+    if (!Name) {
+      consumeError(Name.takeError());
+      continue;
+    }
+    Expected<uint64_t> AddrOrErr = Sym.getAddress();
+    if (!AddrOrErr) {
+      consumeError(AddrOrErr.takeError());
+      continue;
+    }
+    uint64_t Addr = *AddrOrErr;
+    uint64_t Size = P.second;
+    if (Size == 0)
+      continue;
+
+    if (PerfMap)
+      *PerfMap << format_hex_no_prefix(Addr, 1) << ' '
+               << format_hex_no_prefix(Size, 1) << ' ' << *Name << '\n';
+
+    if (JitDump) {
+      // perf inject wants the line table before the code it describes.
+      DILineInfoTable Lines = Context.getLineInfoForAddressRange(
+          Addr, Size, DILineInfoSpecifier(
+                          DILineInfoSpecifier::FileLineInfoKind::
+                              AbsoluteFilePath));
+      if (!Lines.empty())
+        writeDebugInfo(Addr, Lines);
+      writeCodeLoad(*Name, Addr, getCode(Sym, Addr, Size));
+    }
+  }
+
+  if (PerfMap)
+    PerfMap->flush();
+  if (JitDump)
+    JitDump->flush();
+}
+
+// There's one pair of files per process, so share one listener between all of
+// the engines that ask for it.
+static ManagedStatic<PerfJITEventListener> PerfListener;
+
+namespace llvm {
+JITEventListener *JITEventListener::createPerfJITEventListener() {
+  return &*PerfListener;
+}
+
+JITEventListener *
+JITEventListener::createPerfJITEventListener(StringRef PerfMapPath,
+                                             StringRef JitDumpPath) {
+  return new PerfJITEventListener(PerfMapPath, JitDumpPath);
+}
+
+} // namespace llvm
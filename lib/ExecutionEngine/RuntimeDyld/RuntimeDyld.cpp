@@ -129,15 +129,16 @@ void RuntimeDyldImpl::resolveRelocations() {
   resolveExternalSymbols();
 
   // Iterate over all outstanding relocations
-  for (auto it = Relocations.begin(), e = Relocations.end(); it != e; ++it) {
+  for (unsigned Idx = 0, e = Relocations.size(); Idx != e; ++Idx) {
+    if (Relocations[Idx].empty())
+      continue;
     // The Section here (Sections[i]) refers to the section in which the
     // symbol for the relocation is located.  The SectionID in the relocation
     // entry provides the section to which the relocation will be applied.
-    int Idx = it->first;
     uint64_t Addr = Sections[Idx].getLoadAddress();
     DEBUG(dbgs() << "Resolving relocations Section #" << Idx << "\t"
                  << format("%p", (uintptr_t)Addr) << "\n");
-    resolveRelocationList(it->second, Addr);
+    resolveRelocationList(Relocations[Idx], Addr);
   }
   Relocations.clear();
 
@@ -426,8 +427,9 @@ Error RuntimeDyldImpl::computeTotalAllocSize(const ObjectFile &Obj,
 
     bool IsRequired = isRequiredForExecution(Section);
 
-    // Consider only the sections that are required to be loaded for execution
-    if (IsRequired) {
+    // Consider only the sections that are required to be loaded for execution,
+    // unless all of them are being processed.
+    if (IsRequired || ProcessAllSections) {
       uint64_t DataSize = Section.getSize();
       uint64_t Alignment64 = Section.getAlignment();
       unsigned Alignment = (unsigned)Alignment64 & 0xffffffffL;
@@ -698,8 +700,8 @@ RuntimeDyldImpl::emitSection(const ObjectFile &Obj,
     Alignment = std::max(Alignment, getStubAlignment());
 
   // Some sections, such as debug info, don't need to be loaded for execution.
-  // Leave those where they are.
-  if (IsRequired) {
+  // Leave those where they are, unless all sections were asked for.
+  if (IsRequired || ProcessAllSections) {
     Allocate = DataSize + PaddingSize + StubBufSize;
     if (!Allocate)
       Allocate = 1;
@@ -771,6 +773,8 @@ RuntimeDyldImpl::findOrEmitSection(const ObjectFile &Obj,
 
 void RuntimeDyldImpl::addRelocationForSection(const RelocationEntry &RE,
                                               unsigned SectionID) {
+  if (SectionID >= Relocations.size())
+    Relocations.resize(std::max<size_t>(SectionID + 1, Sections.size()));
   Relocations[SectionID].push_back(RE);
 }
 
@@ -787,7 +791,7 @@ void RuntimeDyldImpl::addRelocationForSymbol(const RelocationEntry &RE,
     RelocationEntry RECopy = RE;
     const auto &SymInfo = Loc->second;
     RECopy.Addend += SymInfo.getOffset();
-    Relocations[SymInfo.getSectionID()].push_back(RECopy);
+    addRelocationForSection(RECopy, SymInfo.getSectionID());
   }
 }
 
@@ -901,59 +905,66 @@ void RuntimeDyldImpl::resolveRelocationList(const RelocationList &Relocs,
 
 void RuntimeDyldImpl::resolveExternalSymbols() {
   while (!ExternalSymbolRelocations.empty()) {
-    StringMap<RelocationList>::iterator i = ExternalSymbolRelocations.begin();
-
-    StringRef Name = i->first();
-    if (Name.size() == 0) {
-      // This is an absolute symbol, use an address of zero.
-      DEBUG(dbgs() << "Resolving absolute relocations."
-                   << "\n");
-      RelocationList &Relocs = i->second;
-      resolveRelocationList(Relocs, 0);
-    } else {
+    // Take the names that are outstanding now. Looking symbols up may cause
+    // additional modules to be loaded, which may add new entries to the
+    // ExternalSymbolRelocations map; those are picked up on the next round.
+    std::vector<std::string> Names;
+    Names.reserve(ExternalSymbolRelocations.size());
+    for (const auto &Entry : ExternalSymbolRelocations)
+      Names.push_back(Entry.first());
+
+    // Ask the resolver for every symbol that isn't in our global table in a
+    // single query.
+    std::vector<std::string> ExternalNames;
+    for (const std::string &Name : Names)
+      if (!Name.empty() && !GlobalSymbolTable.count(Name))
+        ExternalNames.push_back(Name);
+    std::vector<RuntimeDyld::SymbolInfo> ExternalSyms;
+    if (!ExternalNames.empty())
+      ExternalSyms = Resolver.findSymbolsForLinking(ExternalNames);
+    assert(ExternalSyms.size() == ExternalNames.size() &&
+           "Resolver returned the wrong number of symbols");
+
+    unsigned NextExternal = 0;
+    for (const std::string &Name : Names) {
       uint64_t Addr = 0;
-      RTDyldSymbolTable::const_iterator Loc = GlobalSymbolTable.find(Name);
-      if (Loc == GlobalSymbolTable.end()) {
-        // This is an external symbol, try to get its address from the symbol
-        // resolver.
-        // First search for the symbol in this logical dylib.
-        Addr = Resolver.findSymbolInLogicalDylib(Name.data()).getAddress();
-        // If that fails, try searching for an external symbol.
-        if (!Addr)
-          Addr = Resolver.findSymbol(Name.data()).getAddress();
-        // The call to getSymbolAddress may have caused additional modules to
-        // be loaded, which may have added new entries to the
-        // ExternalSymbolRelocations map.  Consquently, we need to update our
-        // iterator.  This is also why retrieval of the relocation list
-        // associated with this symbol is deferred until below this point.
-        // New entries may have been added to the relocation list.
-        i = ExternalSymbolRelocations.find(Name);
+      if (Name.empty()) {
+        // This is an absolute symbol, use an address of zero.
+        DEBUG(dbgs() << "Resolving absolute relocations."
+                     << "\n");
+      } else if (NextExternal != ExternalNames.size() &&
+                 ExternalNames[NextExternal] == Name) {
+        // This is an external symbol, found by the symbol resolver.
+        Addr = ExternalSyms[NextExternal++].getAddress();
       } else {
         // We found the symbol in our global table.  It was probably in a
         // Module that we loaded previously.
-        const auto &SymInfo = Loc->second;
+        const auto &SymInfo = GlobalSymbolTable.find(Name)->second;
         Addr = getSectionLoadAddress(SymInfo.getSectionID()) +
                SymInfo.getOffset();
       }
 
       // FIXME: Implement error handling that doesn't kill the host program!
-      if (!Addr)
+      if (!Addr && !Name.empty())
         report_fatal_error("Program used external function '" + Name +
                            "' which could not be resolved!");
 
+      // The resolver may have added relocations to this symbol's list, so
+      // don't change this code to get the list earlier.
+      StringMap<RelocationList>::iterator i =
+          ExternalSymbolRelocations.find(Name);
+
       // If Resolver returned UINT64_MAX, the client wants to handle this symbol
       // manually and we shouldn't resolve its relocations.
       if (Addr != UINT64_MAX) {
-        DEBUG(dbgs() << "Resolving relocations Name: " << Name << "\t"
-                     << format("0x%lx", Addr) << "\n");
-        // This list may have been updated when we called getSymbolAddress, so
-        // don't change this code to get the list earlier.
-        RelocationList &Relocs = i->second;
-        resolveRelocationList(Relocs, Addr);
+        if (!Name.empty())
+          DEBUG(dbgs() << "Resolving relocations Name: " << Name << "\t"
+                       << format("0x%lx", Addr) << "\n");
+        resolveRelocationList(i->second, Addr);
       }
-    }
 
-    ExternalSymbolRelocations.erase(i);
+      ExternalSymbolRelocations.erase(i);
+    }
   }
 }
 
@@ -973,6 +984,20 @@ uint64_t RuntimeDyld::LoadedObjectInfo::getSectionLoadAddress(
 void RuntimeDyld::MemoryManager::anchor() {}
 void RuntimeDyld::SymbolResolver::anchor() {}
 
+std::vector<RuntimeDyld::SymbolInfo>
+RuntimeDyld::SymbolResolver::findSymbolsForLinking(
+    ArrayRef<std::string> Names) {
+  std::vector<SymbolInfo> Result;
+  Result.reserve(Names.size());
+  for (const std::string &Name : Names) {
+    auto Sym = findSymbolInLogicalDylib(Name);
+    if (!Sym)
+      Sym = findSymbol(Name);
+    Result.push_back(Sym);
+  }
+  return Result;
+}
+
 RuntimeDyld::RuntimeDyld(RuntimeDyld::MemoryManager &MemMgr,
                          RuntimeDyld::SymbolResolver &Resolver)
     : MemMgr(MemMgr), Resolver(Resolver) {
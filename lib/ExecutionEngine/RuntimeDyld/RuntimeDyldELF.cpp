@@ -1752,15 +1752,26 @@ RuntimeDyldELF::processRelocationRef(
     } else if (RelType == ELF::R_X86_64_GOTPCREL ||
                RelType == ELF::R_X86_64_GOTPCRELX ||
                RelType == ELF::R_X86_64_REX_GOTPCRELX) {
-      uint64_t GOTOffset = allocateGOTEntries(SectionID, 1);
-      resolveGOTOffsetRelocation(SectionID, Offset, GOTOffset + Addend);
+      // The GOT entry holds the target without the relocation's addend, so
+      // reuse the entry of any earlier reference to the same target.
+      RelocationValueRef GOTTarget = Value;
+      GOTTarget.Addend = 0;
+      auto GOTEntry = GOTPCRelOffsets.find(GOTTarget);
+      uint64_t GOTOffset;
+      if (GOTEntry != GOTPCRelOffsets.end()) {
+        GOTOffset = GOTEntry->second;
+      } else {
+        GOTOffset = allocateGOTEntries(SectionID, 1);
+        GOTPCRelOffsets[GOTTarget] = GOTOffset;
 
-      // Fill in the value of the symbol we're targeting into the GOT
-      RelocationEntry RE = computeGOTOffsetRE(SectionID, GOTOffset, Value.Offset, ELF::R_X86_64_64);
-      if (Value.SymbolName)
-        addRelocationForSymbol(RE, Value.SymbolName);
-      else
-        addRelocationForSection(RE, Value.SectionID);
+        // Fill in the value of the symbol we're targeting into the GOT
+        RelocationEntry RE = computeGOTOffsetRE(SectionID, GOTOffset, Value.Offset, ELF::R_X86_64_64);
+        if (Value.SymbolName)
+          addRelocationForSymbol(RE, Value.SymbolName);
+        else
+          addRelocationForSection(RE, Value.SectionID);
+      }
+      resolveGOTOffsetRelocation(SectionID, Offset, GOTOffset + Addend);
     } else if (RelType == ELF::R_X86_64_PC32) {
       Value.Addend += support::ulittle32_t::ref(computePlaceholderAddress(SectionID, Offset));
       processSimpleRelocation(SectionID, Offset, RelType, Value);
@@ -1896,6 +1907,7 @@ Error RuntimeDyldELF::finalizeLoad(const ObjectFile &Obj,
 
   GOTSectionID = 0;
   CurrentGOTIndex = 0;
+  GOTPCRelOffsets.clear();
 
   return Error::success();
 }
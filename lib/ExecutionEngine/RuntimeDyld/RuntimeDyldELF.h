@@ -142,6 +142,11 @@ class RuntimeDyldELF : public RuntimeDyldImpl {
   // A map to avoid duplicate got entries (Mips64 specific)
   StringMap<uint64_t> GOTSymbolOffsets;
 
+  // The GOT entries allocated for GOTPCREL relocations, indexed by the target
+  // they hold, so that all references to a target share one entry.
+  // (X86_64 specific)
+  std::map<RelocationValueRef, uint64_t> GOTPCRelOffsets;
+
   // *HI16 relocations will be added for resolving when we find matching
   // *LO16 part. (Mips specific)
   SmallVector<std::pair<RelocationValueRef, RelocationEntry>, 8> PendingRelocs;
@@ -28,7 +28,6 @@
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/SwapByteOrder.h"
 #include <map>
-#include <unordered_map>
 #include <system_error>
 
 using namespace llvm;
@@ -255,11 +254,11 @@ protected:
   // the relocations get re-resolved.
   // The symbol (or section) the relocation is sourced from is the Key
   // in the relocation list where it's stored.
-  typedef SmallVector<RelocationEntry, 64> RelocationList;
+  typedef SmallVector<RelocationEntry, 4> RelocationList;
   // Relocations to sections already loaded. Indexed by SectionID which is the
   // source of the address. The target where the address will be written is
   // SectionID/Offset in the relocation itself.
-  std::unordered_map<unsigned, RelocationList> Relocations;
+  std::vector<RelocationList> Relocations;
 
   // Relocations to external symbols that are not yet resolved.  Symbols are
   // external when they aren't found in the global symbol table of all loaded
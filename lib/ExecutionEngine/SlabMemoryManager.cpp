@@ -0,0 +1,299 @@
+//===- SlabMemoryManager.cpp - Pooled memory manager for JITs -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements SlabAllocator and SlabMemoryManager.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/SlabMemoryManager.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Process.h"
+
+namespace llvm {
+
+static size_t getPageSize() {
+  static const size_t PageSize = sys::Process::getPageSize();
+  return PageSize;
+}
+
+SlabAllocator::SlabAllocator(size_t SlabSize)
+    : SlabSize(alignTo(std::max<size_t>(SlabSize, 1), getPageSize())) {}
+
+SlabAllocator::~SlabAllocator() {
+  for (Slab &S : Slabs)
+    sys::Memory::releaseMappedMemory(S.Memory);
+}
+
+sys::MemoryBlock SlabAllocator::allocate(size_t Size, std::error_code &EC) {
+  Size = alignTo(std::max<size_t>(Size, 1), getPageSize());
+  EC = std::error_code();
+
+  std::lock_guard<std::mutex> Guard(Lock);
+
+  // First fit in the slabs that are already mapped.
+  for (Slab &S : Slabs) {
+    if (S.FreeSize < Size)
+      continue;
+    for (auto I = S.FreeRanges.begin(), E = S.FreeRanges.end(); I != E; ++I) {
+      if (I->second < Size)
+        continue;
+      uintptr_t Addr = I->first;
+      size_t Remaining = I->second - Size;
+      S.FreeRanges.erase(I);
+      if (Remaining)
+        S.FreeRanges[Addr + Size] = Remaining;
+      S.FreeSize -= Size;
+      return sys::MemoryBlock((void *)Addr, Size);
+    }
+  }
+
+  // Map a new slab, next to the previous one if possible so that JIT'd code
+  // stays within range of near calls.
+  const sys::MemoryBlock *Near = Slabs.empty() ? nullptr : &Slabs.back().Memory;
+  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(
+      std::max(Size, SlabSize), Near,
+      sys::Memory::MF_READ | sys::Memory::MF_WRITE, EC);
+  if (EC)
+    return sys::MemoryBlock();
+
+  Slab S;
+  S.Memory = MB;
+  S.FreeSize = MB.size() - Size;
+  if (S.FreeSize)
+    S.FreeRanges[(uintptr_t)MB.base() + Size] = S.FreeSize;
+  Slabs.push_back(std::move(S));
+  return sys::MemoryBlock(MB.base(), Size);
+}
+
+void SlabAllocator::deallocate(sys::MemoryBlock Block) {
+  uintptr_t Addr = (uintptr_t)Block.base();
+  size_t Size = Block.size();
+
+  std::lock_guard<std::mutex> Guard(Lock);
+
+  auto S = find_if(Slabs, [&](const Slab &S) {
+    uintptr_t Base = (uintptr_t)S.Memory.base();
+    return Base <= Addr && Addr < Base + S.Memory.size();
+  });
+  assert(S != Slabs.end() && "Block was not allocated from this pool");
+  assert(Addr + Size <= (uintptr_t)S->Memory.base() + S->Memory.size() &&
+         "Block spans several slabs");
+  S->FreeSize += Size;
+
+  // Merge the block with the free ranges around it.
+  std::map<uintptr_t, size_t> &FreeRanges = S->FreeRanges;
+  auto Next = FreeRanges.lower_bound(Addr);
+  if (Next != FreeRanges.begin()) {
+    auto Prev = std::prev(Next);
+    assert(Prev->first + Prev->second <= Addr && "Block freed twice");
+    if (Prev->first + Prev->second == Addr) {
+      Addr = Prev->first;
+      Size += Prev->second;
+      FreeRanges.erase(Prev);
+    }
+  }
+  if (Next != FreeRanges.end() && Addr + Size == Next->first) {
+    Size += Next->second;
+    FreeRanges.erase(Next);
+  }
+  FreeRanges[Addr] = Size;
+
+  if (S->FreeSize != S->Memory.size())
+    return;
+
+  // Keep one empty slab around, but never one mapped for a large request.
+  bool HaveSpare = any_of(Slabs, [&](const Slab &Other) {
+    return &Other != &*S && Other.FreeSize == Other.Memory.size();
+  });
+  if (HaveSpare || S->Memory.size() > SlabSize)
+    releaseSlab(S);
+}
+
+size_t SlabAllocator::getNumSlabs() const {
+  std::lock_guard<std::mutex> Guard(Lock);
+  return Slabs.size();
+}
+
+void SlabAllocator::releaseSlab(std::vector<Slab>::iterator S) {
+  sys::Memory::releaseMappedMemory(S->Memory);
+  Slabs.erase(S);
+}
+
+SlabMemoryManager::~SlabMemoryManager() {
+  for (MemoryGroup *Group : {&CodeMem, &RODataMem})
+    for (sys::MemoryBlock &Block : Group->ProtectedMem)
+      sys::Memory::protectMappedMemory(Block, sys::Memory::MF_READ |
+                                                  sys::Memory::MF_WRITE);
+  for (sys::MemoryBlock &Block : AllocatedMem)
+    Slabs.deallocate(Block);
+}
+
+void SlabMemoryManager::reserveAllocationSpace(
+    uintptr_t CodeSize, uint32_t CodeAlign, uintptr_t RODataSize,
+    uint32_t RODataAlign, uintptr_t RWDataSize, uint32_t RWDataAlign) {
+  // Each part starts on a page of its own, which takes care of any alignment
+  // up to the page size, and so that the parts never share a page whose
+  // permissions have to differ.
+  const size_t PageSize = getPageSize();
+  auto PartSize = [&](uintptr_t Size, uint32_t Align) -> uintptr_t {
+    if (!Size)
+      return 0;
+    return alignTo(Size + (Align > PageSize ? Align : 0), PageSize);
+  };
+  uintptr_t CodePart = PartSize(CodeSize, CodeAlign);
+  uintptr_t ROPart = PartSize(RODataSize, RODataAlign);
+  uintptr_t RWPart = PartSize(RWDataSize, RWDataAlign);
+  if (!CodePart && !ROPart && !RWPart)
+    return;
+
+  std::error_code EC;
+  sys::MemoryBlock MB = Slabs.allocate(CodePart + ROPart + RWPart, EC);
+  if (EC)
+    // allocateSection asks for the memory again, and fails if it can't.
+    return;
+  AllocatedMem.push_back(MB);
+
+  uintptr_t Addr = (uintptr_t)MB.base();
+  CodeMem.Free = sys::MemoryBlock((void *)Addr, CodePart);
+  RODataMem.Free = sys::MemoryBlock((void *)(Addr + CodePart), ROPart);
+  RWDataMem.Free =
+      sys::MemoryBlock((void *)(Addr + CodePart + ROPart), RWPart);
+}
+
+uint8_t *SlabMemoryManager::allocateDataSection(uintptr_t Size,
+                                                unsigned Alignment,
+                                                unsigned SectionID,
+                                                StringRef SectionName,
+                                                bool IsReadOnly) {
+  if (IsReadOnly)
+    return allocateSection(RODataMem, Size, Alignment);
+  return allocateSection(RWDataMem, Size, Alignment);
+}
+
+uint8_t *SlabMemoryManager::allocateCodeSection(uintptr_t Size,
+                                                unsigned Alignment,
+                                                unsigned SectionID,
+                                                StringRef SectionName) {
+  return allocateSection(CodeMem, Size, Alignment);
+}
+
+uint8_t *SlabMemoryManager::allocateSection(MemoryGroup &MemGroup,
+                                            uintptr_t Size,
+                                            unsigned Alignment) {
+  if (!Alignment)
+    Alignment = 16;
+
+  assert(!(Alignment & (Alignment - 1)) && "Alignment must be a power of two.");
+
+  uintptr_t FreeBase = (uintptr_t)MemGroup.Free.base();
+  uintptr_t EndOfBlock = FreeBase + MemGroup.Free.size();
+  uintptr_t Addr = alignTo(FreeBase, Alignment);
+
+  if (!FreeBase || Addr + Size > EndOfBlock) {
+    // Sections that weren't part of the reservation, such as the GOT that
+    // RuntimeDyldELF allocates after loading, or all sections when objects
+    // are loaded without one, get a block of their own.
+    std::error_code EC;
+    sys::MemoryBlock MB = Slabs.allocate(Size + Alignment, EC);
+    if (EC) {
+      // FIXME: Add error propagation to the interface.
+      return nullptr;
+    }
+    AllocatedMem.push_back(MB);
+    FreeBase = (uintptr_t)MB.base();
+    EndOfBlock = FreeBase + MB.size();
+    Addr = alignTo(FreeBase, Alignment);
+  }
+
+  // Sections placed one after the other in a block form a single pending
+  // region, so that finalizeMemory protects them together.
+  if (!MemGroup.PendingMem.empty() &&
+      (uintptr_t)MemGroup.PendingMem.back().base() +
+              MemGroup.PendingMem.back().size() == FreeBase) {
+    sys::MemoryBlock &PendingMB = MemGroup.PendingMem.back();
+    PendingMB = sys::MemoryBlock(PendingMB.base(),
+                                 Addr + Size - (uintptr_t)PendingMB.base());
+  } else {
+    MemGroup.PendingMem.push_back(sys::MemoryBlock((void *)Addr, Size));
+  }
+
+  MemGroup.Free =
+      sys::MemoryBlock((void *)(Addr + Size), EndOfBlock - Addr - Size);
+  return (uint8_t *)Addr;
+}
+
+bool SlabMemoryManager::finalizeMemory(std::string *ErrMsg) {
+  // Some platforms with separate data cache and instruction cache require
+  // explicit cache flush, otherwise JIT code manipulations (like resolved
+  // relocations) will get to the data cache but not to the instruction cache.
+  for (sys::MemoryBlock &Block : CodeMem.PendingMem)
+    sys::Memory::InvalidateInstructionCache(Block.base(), Block.size());
+
+  std::error_code EC = applyMemoryGroupPermissions(
+      CodeMem, sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+  if (!EC)
+    EC = applyMemoryGroupPermissions(RODataMem, sys::Memory::MF_READ);
+  if (EC) {
+    if (ErrMsg)
+      *ErrMsg = EC.message();
+    return true;
+  }
+
+  // Read-write data memory already has the correct permissions.
+  RWDataMem.PendingMem.clear();
+  return false;
+}
+
+std::error_code
+SlabMemoryManager::applyMemoryGroupPermissions(MemoryGroup &MemGroup,
+                                               unsigned Permissions) {
+  const size_t PageSize = getPageSize();
+
+  // Widen the pending regions to whole pages and merge the ones that touch,
+  // so that each run of contiguous pages takes a single call.
+  SmallVector<sys::MemoryBlock, 4> Ranges;
+  for (sys::MemoryBlock &MB : MemGroup.PendingMem) {
+    uintptr_t Start = alignDown((uintptr_t)MB.base(), PageSize);
+    uintptr_t End = alignTo((uintptr_t)MB.base() + MB.size(), PageSize);
+    Ranges.push_back(sys::MemoryBlock((void *)Start, End - Start));
+  }
+  std::sort(Ranges.begin(), Ranges.end(),
+            [](const sys::MemoryBlock &A, const sys::MemoryBlock &B) {
+              return A.base() < B.base();
+            });
+
+  MemGroup.PendingMem.clear();
+  for (unsigned I = 0, E = Ranges.size(); I != E;) {
+    uintptr_t Start = (uintptr_t)Ranges[I].base();
+    uintptr_t End = Start + Ranges[I].size();
+    for (++I; I != E && (uintptr_t)Ranges[I].base() <= End; ++I)
+      End = std::max<uintptr_t>(End, (uintptr_t)Ranges[I].base() +
+                                         Ranges[I].size());
+
+    sys::MemoryBlock Range((void *)Start, End - Start);
+    if (std::error_code EC =
+            sys::Memory::protectMappedMemory(Range, Permissions))
+      return EC;
+    MemGroup.ProtectedMem.push_back(Range);
+  }
+
+  // The rest of the last page that was protected can't take new sections.
+  uintptr_t FreeBase = alignTo((uintptr_t)MemGroup.Free.base(), PageSize);
+  uintptr_t EndOfBlock =
+      (uintptr_t)MemGroup.Free.base() + MemGroup.Free.size();
+  if (FreeBase < EndOfBlock)
+    MemGroup.Free = sys::MemoryBlock((void *)FreeBase, EndOfBlock - FreeBase);
+  else
+    MemGroup.Free = sys::MemoryBlock();
+
+  return std::error_code();
+}
+
+} // namespace llvm
@@ -316,6 +316,8 @@ int FuzzerDriver(int *argc, char ***argv, UserCallback Callback) {
   Options.OutputCSV = Flags.output_csv;
   Options.DetectLeaks = Flags.detect_leaks;
   Options.RssLimitMb = Flags.rss_limit_mb;
+  Options.NumThreads = Flags.threads;
+  Options.ForkServerBatchSize = Flags.fork_server;
   if (Flags.runs >= 0)
     Options.MaxNumberOfRuns = Flags.runs;
   if (!Inputs->empty())
@@ -389,7 +391,18 @@ int FuzzerDriver(int *argc, char ***argv, UserCallback Callback) {
   if (Flags.merge) {
     if (Options.MaxLen == 0)
       F.SetMaxLen(kMaxSaneLen);
-    F.Merge(*Inputs);
+    if (Flags.merge_control_file && Flags.merge_shard >= 0) {
+      F.RunMergeShard(Flags.merge_control_file, Flags.merge_shard);
+    } else if (Flags.merge_control_file) {
+      std::string Cmd;
+      for (auto &S : Args)
+        Cmd += S + " ";
+      MergeWithControlFile(Cmd, *Inputs, Flags.merge_control_file,
+                           std::max(1, Flags.workers),
+                           Options.MaxLen ? Options.MaxLen : kMaxSaneLen);
+    } else {
+      F.Merge(*Inputs);
+    }
     exit(0);
   }
 
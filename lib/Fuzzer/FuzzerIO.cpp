@@ -60,6 +60,17 @@ static void ListFilesInDirRecursive(const std::string &Dir, long *Epoch,
     *Epoch = E;
 }
 
+void ListFilesInDir(const std::string &Dir, std::vector<std::string> *V) {
+  ListFilesInDirRecursive(Dir, nullptr, V, /*TopDir*/true);
+}
+
+size_t FileSize(const std::string &Path) {
+  struct stat St;
+  if (stat(Path.c_str(), &St))
+    return 0;
+  return St.st_size;
+}
+
 Unit FileToVector(const std::string &Path, size_t MaxSize) {
   std::ifstream T(Path);
   if (!T) {
@@ -19,6 +19,7 @@
 #include <climits>
 #include <cstddef>
 #include <cstdlib>
+#include <deque>
 #include <random>
 #include <string.h>
 #include <string>
@@ -83,6 +84,9 @@ private:
 typedef FixedWord<27> Word; // 28 bytes.
 
 bool IsFile(const std::string &Path);
+// Appends the files under Dir, recursively, to V.
+void ListFilesInDir(const std::string &Dir, std::vector<std::string> *V);
+size_t FileSize(const std::string &Path);
 std::string FileToString(const std::string &Path);
 Unit FileToVector(const std::string &Path, size_t MaxSize = 0);
 void ReadDirToVectorOfUnits(const char *Path, std::vector<Unit> *V,
@@ -151,6 +155,77 @@ bool ParseOneDictionaryEntry(const std::string &Str, Unit *U);
 // were parsed succesfully.
 bool ParseDictionaryFile(const std::string &Text, std::vector<Unit> *Units);
 
+// Merge.
+
+// The state of a merge with -merge_control_file. The control file lists the
+// files to merge, those of the first corpus first. Each shard of the merge
+// runs a part of the files and records it in a file of its own, with a
+// "STARTED <index> <size>" line before running a file and a
+// "DONE <index> <features>..." line after it.
+struct MergeControl {
+  std::vector<std::string> Files;
+  size_t NumFilesInFirstCorpus = 0;
+  size_t NumShards = 1;
+  // Set by ParseShard() for each file, by index. A file that was started
+  // and not done crashed the shard, and is skipped.
+  std::vector<bool> Done;
+  std::vector<size_t> Sizes;
+  std::vector<std::vector<uint32_t>> Features;
+
+  std::string HeaderText() const;
+  // Returns false if Text is not a control file.
+  bool ParseHeader(const std::string &Text);
+  // Records the lines of a shard file. Returns the index of the file that
+  // was started and not done, or Files.size().
+  size_t ParseShard(const std::string &Text);
+  // Returns the files from extra corpora that add features to the first
+  // corpus, in the order of a greedy set cover: each one adds the most
+  // features to those of the first corpus and the files before it.
+  std::vector<size_t> ChooseFilesToAdd() const;
+};
+
+std::string MergeShardPath(const std::string &ControlFile, size_t Shard);
+// Merges Corpora[1:] into Corpora[0], running the shards with Cmd, the
+// command line of this process.
+void MergeWithControlFile(const std::string &Cmd,
+                          const std::vector<std::string> &Corpora,
+                          const std::string &ControlFile, size_t NumShards,
+                          size_t MaxLen);
+
+// Trace-based mutations.
+
+// A ring of the operands of recent comparisons, which the trace hooks fill
+// from any thread without locks. A slot may be read while it is written, and
+// then only gives a less useful mutation.
+template <class T, size_t kSizeT> struct TableOfRecentCompares {
+  static const size_t kSize = kSizeT;
+  struct Pair {
+    T A, B;
+  };
+  void Insert(const T &Arg1, const T &Arg2) {
+    size_t Idx = Next.fetch_add(1, std::memory_order_relaxed) % kSize;
+    Table[Idx].A = Arg1;
+    Table[Idx].B = Arg2;
+  }
+  size_t size() const {
+    return std::min(Next.load(std::memory_order_relaxed), kSize);
+  }
+  const Pair &operator[](size_t Idx) const { return Table[Idx]; }
+  void clear() { Next = 0; }
+
+  std::atomic<size_t> Next{0};
+  Pair Table[kSize];
+};
+
+// The operands of the recent 4- and 8-byte comparisons and memcmp-like
+// calls of the user callback, see FuzzerTraceState.cpp.
+extern TableOfRecentCompares<uint32_t, 32> TORC4;
+extern TableOfRecentCompares<uint64_t, 32> TORC8;
+extern TableOfRecentCompares<Word, 32> TORCW;
+// Set while the user callback runs in this thread, so that the comparisons of
+// libFuzzer itself are not recorded.
+extern thread_local bool RunningUserCallback;
+
 class DictionaryEntry {
  public:
   DictionaryEntry() {}
@@ -235,11 +310,16 @@ struct FuzzingOptions {
   bool DetectLeaks = true;
   bool TruncateUnits = false;
   bool PruneCorpus = true;
+  int NumThreads = 0;
+  int ForkServerBatchSize = 0;
 };
 
 class MutationDispatcher {
 public:
   MutationDispatcher(Random &Rand, const FuzzingOptions &Options);
+  /// Creates a dispatcher with the options and the dictionaries of Other,
+  /// to mutate with Rand in another thread.
+  MutationDispatcher(Random &Rand, const MutationDispatcher &Other);
   ~MutationDispatcher() {}
   /// Indicate that we are about to start a new sequence of mutations.
   void StartMutationSequence();
@@ -274,6 +354,10 @@ public:
   size_t Mutate_AddWordFromPersistentAutoDictionary(uint8_t *Data, size_t Size,
                                                     size_t MaxSize);
 
+  /// Mutates data by replacing an operand of a recent comparison with the
+  /// other one, or by adding an operand.
+  size_t Mutate_AddWordFromTORC(uint8_t *Data, size_t Size, size_t MaxSize);
+
   /// Tries to find an ASCII integer in Data, changes it to another ASCII int.
   size_t Mutate_ChangeASCIIInteger(uint8_t *Data, size_t Size, size_t MaxSize);
 
@@ -310,6 +394,8 @@ private:
 
   size_t AddWordFromDictionary(Dictionary &D, uint8_t *Data, size_t Size,
                                size_t MaxSize);
+  size_t ApplyDictionaryEntry(uint8_t *Data, size_t Size, size_t MaxSize,
+                              DictionaryEntry &DE);
   size_t MutateImpl(uint8_t *Data, size_t Size, size_t MaxSize,
                     const std::vector<Mutator> &Mutators);
 
@@ -326,6 +412,8 @@ private:
   Dictionary PersistentAutoDictionary;
   std::vector<Mutator> CurrentMutatorSequence;
   std::vector<DictionaryEntry *> CurrentDictionaryEntrySequence;
+  // The words of the current sequence that came from the comparison tables.
+  std::deque<DictionaryEntry> TORCEntries;
   const std::vector<Unit> *Corpus = nullptr;
   std::vector<uint8_t> MutateInPlaceHere;
 
@@ -333,6 +421,8 @@ private:
   std::vector<Mutator> DefaultMutators;
 };
 
+struct FuzzingThreadState;
+
 class Fuzzer {
 public:
 
@@ -347,6 +437,8 @@ public:
       CounterBitmapBits = 0;
       PcBufferLen = 0;
       CounterBitmap.clear();
+      InlineCounterBits = 0;
+      InlineCounterBitmap.clear();
       PCMap.Reset();
     }
 
@@ -359,6 +451,9 @@ public:
     // Precalculated number of bits in CounterBitmap.
     size_t CounterBitmapBits;
     std::vector<uint8_t> CounterBitmap;
+    // Precalculated number of bits in InlineCounterBitmap.
+    size_t InlineCounterBits;
+    std::vector<uint8_t> InlineCounterBitmap;
     // Precalculated number of bits in PCMap.
     size_t PcMapBits;
     PcCoverageMap PCMap;
@@ -373,6 +468,10 @@ public:
   const Unit &ChooseUnitToMutate() { return Corpus[ChooseUnitIdxToMutate()]; };
   void TruncateUnits(std::vector<Unit> *NewCorpus);
   void Loop();
+  // Runs Loop() in Options.NumThreads fuzzing threads.
+  void LoopInThreads();
+  // Runs Loop() in child processes, Options.ForkServerBatchSize inputs each.
+  void LoopInForkServer();
   void Drill();
   void ShuffleAndMinimize();
   void InitializeTraceState();
@@ -409,6 +508,9 @@ public:
   void Merge(const std::vector<std::string> &Corpora);
   // Returns a subset of 'Extra' that adds coverage to 'Initial'.
   UnitVector FindExtraUnits(const UnitVector &Initial, const UnitVector &Extra);
+  // Runs the files of one shard of a merge with a control file, after the
+  // last one it ran before.
+  void RunMergeShard(const std::string &ControlFile, size_t Shard);
   MutationDispatcher &GetMD() { return MD; }
   void PrintFinalStats();
   void SetMaxLen(size_t MaxLen);
@@ -454,8 +556,15 @@ private:
   void SetDeathCallback();
   static void StaticDeathCallback();
   void DumpCurrentUnit(const char *Prefix);
+  void DumpUnit(const char *Prefix, const uint8_t *Data, size_t Size);
   void DeathCallback();
 
+  void FuzzingThreadLoop(FuzzingThreadState *T);
+  void RunForkServerBatch();
+  void MergeForkServerBatch();
+  // True while LoopInThreads() runs.
+  bool FuzzingInThreads = false;
+
   void LazyAllocateCurrentUnitData();
   uint8_t *CurrentUnitData = nullptr;
   std::atomic<size_t> CurrentUnitSize;
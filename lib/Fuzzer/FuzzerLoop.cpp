@@ -11,8 +11,15 @@
 
 #include "FuzzerInternal.h"
 #include <algorithm>
+#include <condition_variable>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
 
 #if defined(__has_include)
 #if __has_include(<sanitizer / coverage_interface.h>)
@@ -37,6 +44,116 @@ static const size_t TruncateMaxRuns = 1000;
 
 thread_local bool Fuzzer::IsMyThread;
 
+// In-process fuzzing threads, see LoopInThreads().
+struct FuzzingThreadState {
+  explicit FuzzingThreadState(unsigned Seed) : Seed(Seed) {}
+  const unsigned Seed;
+  // The unit being run, for the timeout report of the main thread.
+  std::vector<uint8_t> Data;
+  std::atomic<size_t> Size{0};
+  // When the run of the unit started, in milliseconds, or 0.
+  std::atomic<long> StartTimeMs{0};
+  std::atomic<size_t> NumRuns{0};
+  // Set while the thread may run a unit. Only this thread writes it, so it
+  // gets a cache line of its own.
+  char Padding[64];
+  std::atomic<bool> Running{false};
+  char Padding2[64];
+};
+
+static std::vector<std::unique_ptr<FuzzingThreadState>> FuzzingThreads;
+// The main thread closes the gate to run units alone.
+static std::atomic<bool> GateClosed;
+static std::atomic<bool> StopFuzzingThreads;
+static std::mutex GateMutex;
+static std::condition_variable GateCV;
+// Units that may have new coverage, for the main thread to run again.
+static UnitVector Candidates;
+static std::mutex CandidatesMutex;
+static std::condition_variable CandidatesCV;
+// Guards Fuzzer::Corpus, which is copied by the fuzzing threads each time
+// CorpusVersion changes.
+static std::mutex CorpusMutex;
+static std::atomic<size_t> CorpusVersion;
+// The dispatcher and the current unit of a fuzzing thread.
+static thread_local MutationDispatcher *ThreadMD;
+static thread_local const uint8_t *ThreadUnitData;
+static thread_local size_t ThreadUnitSize;
+
+static long NowMs() {
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Returns false if the fuzzing threads are stopping. Entering the gate and
+// checking that it is open, in this order, and closing it then waiting for
+// the threads to leave, in this order, make sure that no unit runs in a
+// fuzzing thread while the main thread runs its own.
+static bool EnterGate(FuzzingThreadState *T) {
+  while (true) {
+    T->Running = true;
+    if (!GateClosed)
+      return true;
+    T->Running = false;
+    std::unique_lock<std::mutex> Lock(GateMutex);
+    GateCV.wait(Lock, [] { return !GateClosed || StopFuzzingThreads; });
+    if (StopFuzzingThreads)
+      return false;
+  }
+}
+
+static void LeaveGate(FuzzingThreadState *T) { T->Running = false; }
+
+static void CloseGate() {
+  GateClosed = true;
+  for (auto &T : FuzzingThreads)
+    while (T->Running)
+      std::this_thread::yield();
+}
+
+static void OpenGate() {
+  {
+    std::lock_guard<std::mutex> Lock(GateMutex);
+    GateClosed = false;
+  }
+  GateCV.notify_all();
+}
+
+// What a fork server child hands back to its parent, see LoopInForkServer().
+// It is followed in the shared memory by the counter bitmap, the inline
+// counter bitmap and the new units, each one a size_t and its bytes.
+struct ForkServerState {
+  PcCoverageMap PCMap;
+  size_t PcMapBits;
+  size_t CounterBitmapBits;
+  size_t InlineCounterBits;
+  size_t TotalNumberOfRuns;
+  long EpochOfLastReadOfOutputCorpus;
+  size_t NumUnits;
+  size_t UnitBytes;
+  // False if the child did not get to the end of its batch.
+  bool BatchDone;
+};
+
+static ForkServerState *ForkServer;
+static uint8_t *ForkServerUnits;
+static size_t ForkServerUnitsCapacity;
+static bool InForkServerChild;
+
+// Returns false if there is no space left for U.
+static bool AddToForkServerUnits(const Unit &U) {
+  if (ForkServer->UnitBytes + sizeof(size_t) + U.size() >
+      ForkServerUnitsCapacity)
+    return false;
+  size_t Size = U.size();
+  uint8_t *P = ForkServerUnits + ForkServer->UnitBytes;
+  memcpy(P, &Size, sizeof(Size));
+  memcpy(P + sizeof(Size), U.data(), Size);
+  ForkServer->UnitBytes += sizeof(Size) + Size;
+  ForkServer->NumUnits++;
+  return true;
+}
+
 static void MissingExternalApiFunction(const char *FnName) {
   Printf("ERROR: %s is not defined. Exiting.\n"
          "Did you use -fsanitize-coverage=... to build your code?\n",
@@ -58,12 +175,16 @@ struct CoverageController {
     CHECK_EXTERNAL_FUNCTION(__sanitizer_reset_coverage);
     EF->__sanitizer_reset_coverage();
     PcMapResetCurrent();
+    InlineCountersResetCurrent();
   }
 
   static void ResetCounters(const FuzzingOptions &Options) {
     if (Options.UseCounters) {
       EF->__sanitizer_update_counter_bitset_and_clear_counters(0);
     }
+    // The fuzzing threads leave their counts behind.
+    if (Options.NumThreads > 1)
+      InlineCountersResetCurrent();
   }
 
   static void Prepare(const FuzzingOptions &Options, Fuzzer::Coverage *C) {
@@ -71,6 +192,7 @@ struct CoverageController {
       size_t NumCounters = EF->__sanitizer_get_number_of_counters();
       C->CounterBitmap.resize(NumCounters);
     }
+    C->InlineCounterBitmap.resize(InlineCountersNum());
   }
 
   // Records data to a maximum coverage tracker. Returns true if additional
@@ -104,6 +226,15 @@ struct CoverageController {
       }
     }
 
+    if (!C->InlineCounterBitmap.empty()) {
+      size_t InlineCounterDelta = InlineCountersMergeInto(
+          C->InlineCounterBitmap.data(), Options.PrintNewCovPcs);
+      if (InlineCounterDelta > 0) {
+        Res = true;
+        C->InlineCounterBits += InlineCounterDelta;
+      }
+    }
+
     uint64_t NewPcMapBits = PcMapMergeInto(&C->PCMap);
     if (NewPcMapBits > C->PcMapBits) {
       Res = true;
@@ -172,14 +303,18 @@ void Fuzzer::StaticDeathCallback() {
 }
 
 void Fuzzer::DumpCurrentUnit(const char *Prefix) {
+  if (ThreadUnitData) // A fuzzing thread.
+    return DumpUnit(Prefix, ThreadUnitData, ThreadUnitSize);
   if (!CurrentUnitData) return;  // Happens when running individual inputs.
-  size_t UnitSize = CurrentUnitSize;
-  if (UnitSize <= kMaxUnitSizeToPrint) {
-    PrintHexArray(CurrentUnitData, UnitSize, "\n");
-    PrintASCII(CurrentUnitData, UnitSize, "\n");
+  DumpUnit(Prefix, CurrentUnitData, CurrentUnitSize);
+}
+
+void Fuzzer::DumpUnit(const char *Prefix, const uint8_t *Data, size_t Size) {
+  if (Size <= kMaxUnitSizeToPrint) {
+    PrintHexArray(Data, Size, "\n");
+    PrintASCII(Data, Size, "\n");
   }
-  WriteUnitToFileWithPrefix({CurrentUnitData, CurrentUnitData + UnitSize},
-                            Prefix);
+  WriteUnitToFileWithPrefix({Data, Data + Size}, Prefix);
 }
 
 NO_SANITIZE_MEMORY
@@ -226,10 +361,27 @@ NO_SANITIZE_MEMORY
 void Fuzzer::AlarmCallback() {
   assert(Options.UnitTimeoutSec > 0);
   if (!InFuzzingThread()) return;
-  if (!CurrentUnitSize)
-    return; // We have not started running units yet.
+  const uint8_t *Data = CurrentUnitData;
+  size_t Size = CurrentUnitSize;
   size_t Seconds =
       duration_cast<seconds>(system_clock::now() - UnitStartTime).count();
+  if (FuzzingInThreads && !Size) {
+    // Look for the fuzzing thread that has been running its unit the longest.
+    long OldestStartTimeMs = 0;
+    for (auto &T : FuzzingThreads) {
+      long StartTimeMs = T->StartTimeMs;
+      if (StartTimeMs && (!OldestStartTimeMs || StartTimeMs < OldestStartTimeMs)) {
+        OldestStartTimeMs = StartTimeMs;
+        Data = T->Data.data();
+        Size = T->Size;
+      }
+    }
+    if (!OldestStartTimeMs)
+      return;
+    Seconds = (NowMs() - OldestStartTimeMs) / 1000;
+  }
+  if (!Size)
+    return; // We have not started running units yet.
   if (Seconds == 0)
     return;
   if (Options.Verbosity >= 2)
@@ -238,7 +390,7 @@ void Fuzzer::AlarmCallback() {
     Printf("ALARM: working on the last Unit for %zd seconds\n", Seconds);
     Printf("       and the timeout value is %d (use -timeout=N to change)\n",
            Options.UnitTimeoutSec);
-    DumpCurrentUnit("timeout-");
+    DumpUnit("timeout-", Data, Size);
     Printf("==%d== ERROR: libFuzzer: timeout after %d seconds\n", GetPid(),
            Seconds);
     if (EF->__sanitizer_print_stack_trace)
@@ -284,6 +436,8 @@ void Fuzzer::PrintStats(const char *Where, const char *End) {
     Printf(" path: %zd", MaxCoverage.PcMapBits);
   if (auto TB = MaxCoverage.CounterBitmapBits)
     Printf(" bits: %zd", TB);
+  if (auto IB = MaxCoverage.InlineCounterBits)
+    Printf(" ibits: %zd", IB);
   if (MaxCoverage.CallerCalleeCoverage)
     Printf(" indir: %zd", MaxCoverage.CallerCalleeCoverage);
   Printf(" units: %zd exec/s: %zd", Corpus.size(), ExecPerSec);
@@ -337,6 +491,8 @@ void Fuzzer::RereadOutputCorpus(size_t MaxSize) {
         Corpus.push_back(X);
         UpdateCorpusDistribution();
         PrintStats("RELOAD");
+        if (InForkServerChild)
+          AddToForkServerUnits(X);
       }
     }
   }
@@ -485,7 +641,9 @@ void Fuzzer::ExecuteCallback(const uint8_t *Data, size_t Size) {
   AssignTaintLabels(DataCopy.get(), Size);
   CurrentUnitSize = Size;
   AllocTracer.Start();
+  RunningUserCallback = true;
   int Res = CB(DataCopy.get(), Size);
+  RunningUserCallback = false;
   (void)Res;
   HasMoreMallocsThanFrees = AllocTracer.Stop();
   CurrentUnitSize = 0;
@@ -497,7 +655,8 @@ std::string Fuzzer::Coverage::DebugString() const {
       std::string("Coverage{") + "BlockCoverage=" +
       std::to_string(BlockCoverage) + " CallerCalleeCoverage=" +
       std::to_string(CallerCalleeCoverage) + " CounterBitmapBits=" +
-      std::to_string(CounterBitmapBits) + " PcMapBits=" +
+      std::to_string(CounterBitmapBits) + " InlineCounterBits=" +
+      std::to_string(InlineCounterBits) + " PcMapBits=" +
       std::to_string(PcMapBits) + "}";
   return Result;
 }
@@ -542,7 +701,9 @@ void Fuzzer::PrintStatusForNewUnit(const Unit &U) {
   PrintStats("NEW   ", "");
   if (Options.Verbosity) {
     Printf(" L: %zd ", U.size());
-    MD.PrintMutationSequence();
+    // The unit of a fuzzing thread was made by the dispatcher of that thread.
+    if (!FuzzingInThreads)
+      MD.PrintMutationSequence();
     Printf("\n");
   }
 }
@@ -551,10 +712,14 @@ void Fuzzer::ReportNewCoverage(const Unit &U) {
   Corpus.push_back(U);
   UpdateCorpusDistribution();
   UnitHashesAddedToCorpus.insert(Hash(U));
-  MD.RecordSuccessfulMutationSequence();
+  if (!FuzzingInThreads)
+    MD.RecordSuccessfulMutationSequence();
   PrintStatusForNewUnit(U);
   WriteToOutputCorpus(U);
   NumberOfNewUnitsAdded++;
+  // The unit is in the output corpus if there is no space left for it.
+  if (InForkServerChild)
+    AddToForkServerUnits(U);
 }
 
 // Finds minimal number of units in 'Extra' that add coverage to 'Initial'.
@@ -747,6 +912,14 @@ void Fuzzer::Drill() {
 }
 
 void Fuzzer::Loop() {
+  if (Options.ForkServerBatchSize > 0)
+    return LoopInForkServer();
+  if (Options.NumThreads > 1) {
+    if (InlineCountersNum())
+      return LoopInThreads();
+    Printf("INFO: -threads needs inline 8-bit counters, using one thread\n");
+    Options.NumThreads = 0;
+  }
   system_clock::time_point LastCorpusReload = system_clock::now();
   if (Options.DoCrossOver)
     MD.SetCorpus(&Corpus);
@@ -770,6 +943,310 @@ void Fuzzer::Loop() {
   MD.PrintRecommendedDictionary();
 }
 
+// The fuzzing threads run their units at the same time, so they share the
+// inline 8-bit counters. After its run, a thread only looks for counters of
+// blocks that MaxCoverage does not have yet, and hands its unit to the main
+// thread if there are any. The main thread closes the gate, so that no unit
+// runs in the fuzzing threads, and runs the unit again alone for its own
+// coverage. It then adds the unit to the corpus if it is new. Units found
+// only this way wait for the main thread, so the counters that some other
+// unit set are still unchanged when its thread looks at them.
+//
+// The fuzzing threads do not share anything else than the corpus, the
+// coverage and the gate while they fuzz: they mutate with their own
+// dispatchers and copies of the corpus, and count their own runs.
+void Fuzzer::LoopInThreads() {
+  FuzzingInThreads = true;
+  StopFuzzingThreads = false;
+  CorpusVersion++;
+  for (int I = 0; I < Options.NumThreads; I++)
+    FuzzingThreads.emplace_back(
+        new FuzzingThreadState(MD.GetRand().Rand()));
+  std::vector<std::thread> Threads;
+  for (auto &T : FuzzingThreads)
+    Threads.emplace_back(&Fuzzer::FuzzingThreadLoop, this, T.get());
+  if (Options.Verbosity)
+    Printf("INFO: fuzzing in %d threads\n", Options.NumThreads);
+
+  system_clock::time_point LastCorpusReload = system_clock::now();
+  while (true) {
+    UnitVector Units;
+    {
+      std::unique_lock<std::mutex> Lock(CandidatesMutex);
+      CandidatesCV.wait_for(Lock, seconds(1),
+                            [] { return !Candidates.empty(); });
+      Units.swap(Candidates);
+    }
+    CandidatesCV.notify_all();
+
+    auto Now = system_clock::now();
+    bool Reload = duration_cast<seconds>(Now - LastCorpusReload).count() > 0;
+    if (!Units.empty() || Reload) {
+      CloseGate();
+      {
+        std::lock_guard<std::mutex> Lock(CorpusMutex);
+        size_t OldCorpusSize = Corpus.size();
+        for (auto &U : Units)
+          RunOneAndUpdateCorpus(U.data(), U.size());
+        if (Reload) {
+          RereadOutputCorpus(Options.MaxLen);
+          LastCorpusReload = Now;
+        }
+        if (Corpus.size() != OldCorpusSize)
+          CorpusVersion++;
+      }
+      OpenGate();
+    }
+
+    size_t OldNumberOfRuns = TotalNumberOfRuns;
+    for (auto &T : FuzzingThreads)
+      TotalNumberOfRuns += T->NumRuns.exchange(0);
+    // The pulse of RunOne(), for the runs of the fuzzing threads.
+    if ((TotalNumberOfRuns ^ OldNumberOfRuns) > OldNumberOfRuns &&
+        secondsSinceProcessStartUp() >= 2)
+      PrintStats("pulse ");
+    if (TotalNumberOfRuns >= Options.MaxNumberOfRuns)
+      break;
+    if (Options.MaxTotalTimeSec > 0 &&
+        secondsSinceProcessStartUp() >=
+            static_cast<size_t>(Options.MaxTotalTimeSec))
+      break;
+  }
+
+  {
+    std::lock_guard<std::mutex> Lock(GateMutex);
+    StopFuzzingThreads = true;
+  }
+  GateCV.notify_all();
+  CandidatesCV.notify_all();
+  for (auto &T : Threads)
+    T.join();
+  FuzzingThreads.clear();
+  Candidates.clear();
+  FuzzingInThreads = false;
+
+  PrintStats("DONE  ", "\n");
+  MD.PrintRecommendedDictionary();
+}
+
+void Fuzzer::FuzzingThreadLoop(FuzzingThreadState *T) {
+  // Timeouts are for the main thread to report.
+  sigset_t Signals;
+  sigemptyset(&Signals);
+  sigaddset(&Signals, SIGALRM);
+  pthread_sigmask(SIG_BLOCK, &Signals, nullptr);
+
+  Random Rand(T->Seed);
+  MutationDispatcher TMD(Rand, MD);
+  ThreadMD = &TMD;
+  UnitVector LocalCorpus;
+  size_t LocalCorpusVersion = 0;
+  std::piecewise_constant_distribution<double> LocalCorpusDistribution;
+  if (Options.DoCrossOver)
+    TMD.SetCorpus(&LocalCorpus);
+  T->Data.resize(Options.MaxLen);
+  uint8_t *Data = T->Data.data();
+  ThreadUnitData = Data;
+
+  while (!StopFuzzingThreads) {
+    if (LocalCorpusVersion != CorpusVersion) {
+      {
+        std::lock_guard<std::mutex> Lock(CorpusMutex);
+        LocalCorpus = Corpus;
+        LocalCorpusVersion = CorpusVersion;
+      }
+      // The weights of UpdateCorpusDistribution().
+      std::vector<double> Intervals(LocalCorpus.size() + 1);
+      std::vector<double> Weights(LocalCorpus.size());
+      std::iota(Intervals.begin(), Intervals.end(), 0);
+      std::iota(Weights.begin(), Weights.end(), 1);
+      LocalCorpusDistribution = std::piecewise_constant_distribution<double>(
+          Intervals.begin(), Intervals.end(), Weights.begin());
+    }
+    const Unit &U = LocalCorpus[static_cast<size_t>(
+        LocalCorpusDistribution(Rand.Get_mt19937()))];
+    size_t Size = U.size();
+    memcpy(Data, U.data(), Size);
+    TMD.StartMutationSequence();
+
+    for (int i = 0; i < Options.MutateDepth; i++) {
+      Size = TMD.Mutate(Data, Size, Options.MaxLen);
+      assert(Size > 0 && Size <= Options.MaxLen);
+      ThreadUnitSize = Size;
+      T->Size = Size;
+      if (!EnterGate(T))
+        break;
+      T->StartTimeMs = NowMs();
+      // Copy the unit to find buffer overflows, as ExecuteCallback() does.
+      std::unique_ptr<uint8_t[]> DataCopy(new uint8_t[Size]);
+      memcpy(DataCopy.get(), Data, Size);
+      RunningUserCallback = true;
+      int Res = CB(DataCopy.get(), Size);
+      RunningUserCallback = false;
+      (void)Res;
+      assert(Res == 0);
+      T->StartTimeMs = 0;
+      bool MayHaveNewCoverage =
+          InlineCountersHaveNew(MaxCoverage.InlineCounterBitmap.data());
+      LeaveGate(T);
+      T->NumRuns++;
+      if (!MayHaveNewCoverage)
+        continue;
+      std::unique_lock<std::mutex> Lock(CandidatesMutex);
+      Candidates.push_back(Unit(Data, Data + Size));
+      CandidatesCV.notify_all();
+      CandidatesCV.wait(Lock, [] {
+        return Candidates.empty() || StopFuzzingThreads;
+      });
+    }
+  }
+  ThreadUnitData = nullptr;
+  ThreadMD = nullptr;
+}
+
+// The parent process only initializes the target and runs the initial
+// corpus. It then forks a child for each batch of inputs, which fuzzes as
+// Loop() does with the corpus and the coverage of the parent, and exits. The
+// child hands the new units and its coverage to the parent through shared
+// memory, so the next child starts from them, with the target as the parent
+// left it.
+//
+// The coverage kept by the sanitizer runtime itself, for cov: and indir:,
+// cannot be handed back, and starts from that of the parent in each child.
+// A crash, a timeout or a leak ends the child with a report of its own, and
+// the parent then exits with the same status, as it does if the target
+// exits.
+void Fuzzer::LoopInForkServer() {
+  const size_t kMinUnitsCapacity = 1 << 20;
+  ForkServerUnitsCapacity = std::max(
+      kMinUnitsCapacity, 64 * (Options.MaxLen + sizeof(size_t)));
+  size_t CounterBitmapSize = MaxCoverage.CounterBitmap.size();
+  size_t InlineCounterBitmapSize = MaxCoverage.InlineCounterBitmap.size();
+  size_t SharedSize = sizeof(ForkServerState) + CounterBitmapSize +
+                      InlineCounterBitmapSize + ForkServerUnitsCapacity;
+  void *Shared = mmap(nullptr, SharedSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (Shared == MAP_FAILED) {
+    Printf("ERROR: -fork_server could not map %zd bytes of shared memory\n",
+           SharedSize);
+    exit(1);
+  }
+  ForkServer = new (Shared) ForkServerState();
+  uint8_t *SharedCounterBitmap = reinterpret_cast<uint8_t *>(ForkServer + 1);
+  uint8_t *SharedInlineCounterBitmap = SharedCounterBitmap + CounterBitmapSize;
+  ForkServerUnits = SharedInlineCounterBitmap + InlineCounterBitmapSize;
+  if (Options.Verbosity)
+    Printf("INFO: fuzzing in child processes, %d inputs each\n",
+           Options.ForkServerBatchSize);
+  if (Options.DoCrossOver)
+    MD.SetCorpus(&Corpus);
+
+  while (true) {
+    if (TotalNumberOfRuns >= Options.MaxNumberOfRuns)
+      break;
+    if (Options.MaxTotalTimeSec > 0 &&
+        secondsSinceProcessStartUp() >
+            static_cast<size_t>(Options.MaxTotalTimeSec))
+      break;
+    ForkServer->NumUnits = 0;
+    ForkServer->UnitBytes = 0;
+    ForkServer->BatchDone = false;
+    // Each child mutates with different random numbers.
+    unsigned Seed = MD.GetRand().Rand();
+    pid_t Pid = fork();
+    if (Pid < 0) {
+      Printf("ERROR: -fork_server could not fork\n");
+      exit(1);
+    }
+    if (Pid == 0) {
+      MD.GetRand().Get_mt19937().seed(Seed);
+      RunForkServerBatch();
+    }
+    int Status = 0;
+    while (waitpid(Pid, &Status, 0) < 0 && errno == EINTR) {
+    }
+    if (!WIFEXITED(Status) || WEXITSTATUS(Status) || !ForkServer->BatchDone) {
+      // The child has printed its report, or the target exited.
+      int ExitCode = WIFEXITED(Status) ? WEXITSTATUS(Status)
+                                       : Options.ErrorExitCode;
+      if (WIFSIGNALED(Status))
+        Printf("==%d== ERROR: libFuzzer: fork server child killed by "
+               "signal %d\n", GetPid(), WTERMSIG(Status));
+      _Exit(ExitCode);
+    }
+    memcpy(MaxCoverage.CounterBitmap.data(), SharedCounterBitmap,
+           CounterBitmapSize);
+    memcpy(MaxCoverage.InlineCounterBitmap.data(), SharedInlineCounterBitmap,
+           InlineCounterBitmapSize);
+    MergeForkServerBatch();
+  }
+
+  munmap(Shared, SharedSize);
+  ForkServer = nullptr;
+  PrintStats("DONE  ", "\n");
+  MD.PrintRecommendedDictionary();
+}
+
+void Fuzzer::RunForkServerBatch() {
+  InForkServerChild = true;
+  // Interval timers are not inherited by fork().
+  if (Options.UnitTimeoutSec > 0)
+    SetTimer(Options.UnitTimeoutSec / 2 + 1);
+  RereadOutputCorpus(Options.MaxLen);
+  size_t LastRun =
+      std::min(TotalNumberOfRuns + Options.ForkServerBatchSize,
+               Options.MaxNumberOfRuns);
+  while (TotalNumberOfRuns < LastRun) {
+    if (Options.MaxTotalTimeSec > 0 &&
+        secondsSinceProcessStartUp() >
+            static_cast<size_t>(Options.MaxTotalTimeSec))
+      break;
+    // Leave the rest of the batch to the next child rather than new units
+    // to the output corpus only.
+    if (ForkServer->UnitBytes + sizeof(size_t) + Options.MaxLen >
+        ForkServerUnitsCapacity)
+      break;
+    MutateAndTestOne();
+  }
+  ForkServer->PCMap = MaxCoverage.PCMap;
+  ForkServer->PcMapBits = MaxCoverage.PcMapBits;
+  ForkServer->CounterBitmapBits = MaxCoverage.CounterBitmapBits;
+  ForkServer->InlineCounterBits = MaxCoverage.InlineCounterBits;
+  ForkServer->TotalNumberOfRuns = TotalNumberOfRuns;
+  ForkServer->EpochOfLastReadOfOutputCorpus = EpochOfLastReadOfOutputCorpus;
+  uint8_t *SharedCounterBitmap = reinterpret_cast<uint8_t *>(ForkServer + 1);
+  memcpy(SharedCounterBitmap, MaxCoverage.CounterBitmap.data(),
+         MaxCoverage.CounterBitmap.size());
+  memcpy(SharedCounterBitmap + MaxCoverage.CounterBitmap.size(),
+         MaxCoverage.InlineCounterBitmap.data(),
+         MaxCoverage.InlineCounterBitmap.size());
+  ForkServer->BatchDone = true;
+  _Exit(0); // Do not run the destructors and the leak check of the parent.
+}
+
+void Fuzzer::MergeForkServerBatch() {
+  MaxCoverage.PCMap = ForkServer->PCMap;
+  MaxCoverage.PcMapBits = ForkServer->PcMapBits;
+  MaxCoverage.CounterBitmapBits = ForkServer->CounterBitmapBits;
+  MaxCoverage.InlineCounterBits = ForkServer->InlineCounterBits;
+  TotalNumberOfRuns = ForkServer->TotalNumberOfRuns;
+  EpochOfLastReadOfOutputCorpus = ForkServer->EpochOfLastReadOfOutputCorpus;
+  const uint8_t *P = ForkServerUnits;
+  for (size_t I = 0; I < ForkServer->NumUnits; I++) {
+    size_t Size;
+    memcpy(&Size, P, sizeof(Size));
+    Unit U(P + sizeof(Size), P + sizeof(Size) + Size);
+    P += sizeof(Size) + Size;
+    // The child has written the unit to the output corpus.
+    if (UnitHashesAddedToCorpus.insert(Hash(U)).second) {
+      Corpus.push_back(U);
+      NumberOfNewUnitsAdded++;
+    }
+  }
+  if (ForkServer->NumUnits)
+    UpdateCorpusDistribution();
+}
+
 void Fuzzer::UpdateCorpusDistribution() {
   size_t N = Corpus.size();
   std::vector<double> Intervals(N + 1);
@@ -786,6 +1263,8 @@ extern "C" {
 
 size_t LLVMFuzzerMutate(uint8_t *Data, size_t Size, size_t MaxSize) {
   assert(fuzzer::F);
+  if (fuzzer::ThreadMD)
+    return fuzzer::ThreadMD->DefaultMutate(Data, Size, MaxSize);
   return fuzzer::F->GetMD().DefaultMutate(Data, Size, MaxSize);
 }
 }  // extern "C"
@@ -0,0 +1,278 @@
+//===- FuzzerMerge.cpp - merging corpora ----------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+// Merging corpora with a control file: the coverage of each file is recorded
+// by child processes, so that a merge resumes after a crash and runs in
+// several processes, and the files to keep are chosen from the records.
+//===----------------------------------------------------------------------===//
+
+#include "FuzzerInternal.h"
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
+
+namespace fuzzer {
+
+std::string MergeShardPath(const std::string &ControlFile, size_t Shard) {
+  return ControlFile + "." + std::to_string(Shard);
+}
+
+std::string MergeControl::HeaderText() const {
+  std::string Res = "MERGE " + std::to_string(Files.size()) + " " +
+                    std::to_string(NumFilesInFirstCorpus) + " " +
+                    std::to_string(NumShards) + "\n";
+  for (auto &Path : Files)
+    Res += Path + "\n";
+  return Res;
+}
+
+bool MergeControl::ParseHeader(const std::string &Text) {
+  std::istringstream IS(Text);
+  std::string Line, Magic;
+  size_t NumFiles;
+  if (!std::getline(IS, Line))
+    return false;
+  std::istringstream LS(Line);
+  if (!(LS >> Magic >> NumFiles >> NumFilesInFirstCorpus >> NumShards) ||
+      Magic != "MERGE" || NumFilesInFirstCorpus > NumFiles || !NumShards)
+    return false;
+  Files.clear();
+  while (Files.size() < NumFiles && std::getline(IS, Line))
+    Files.push_back(Line);
+  return Files.size() == NumFiles;
+}
+
+size_t MergeControl::ParseShard(const std::string &Text) {
+  Done.resize(Files.size());
+  Sizes.resize(Files.size());
+  Features.resize(Files.size());
+  size_t Started = Files.size();
+  std::istringstream IS(Text);
+  std::string Line, Kind;
+  while (std::getline(IS, Line)) {
+    std::istringstream LS(Line);
+    size_t Idx;
+    if (!(LS >> Kind >> Idx) || Idx >= Files.size())
+      continue;
+    if (Kind == "STARTED") {
+      LS >> Sizes[Idx];
+      // Skipped, unless its run is done.
+      Done[Idx] = true;
+      Started = Idx;
+    } else if (Kind == "DONE") {
+      Features[Idx].clear();
+      uint32_t F;
+      while (LS >> F)
+        Features[Idx].push_back(F);
+      Started = Files.size();
+    }
+  }
+  return Started;
+}
+
+std::vector<size_t> MergeControl::ChooseFilesToAdd() const {
+  std::unordered_set<uint32_t> Covered;
+  for (size_t I = 0; I < NumFilesInFirstCorpus && I < Features.size(); I++)
+    Covered.insert(Features[I].begin(), Features[I].end());
+
+  struct Candidate {
+    size_t Gain, Size, Idx;
+  };
+  // More new features first, then smaller files.
+  auto Worse = [](const Candidate &A, const Candidate &B) {
+    if (A.Gain != B.Gain)
+      return A.Gain < B.Gain;
+    if (A.Size != B.Size)
+      return A.Size > B.Size;
+    return A.Idx > B.Idx;
+  };
+  std::priority_queue<Candidate, std::vector<Candidate>, decltype(Worse)>
+      Queue(Worse);
+  for (size_t I = NumFilesInFirstCorpus; I < Features.size(); I++)
+    if (!Features[I].empty())
+      Queue.push({Features[I].size(), Sizes[I], I});
+
+  // The gain of a file only goes down as more features are covered, so a
+  // file whose gain is up to date and no worse than the old gains of the
+  // others is the best one.
+  std::vector<size_t> Res;
+  while (!Queue.empty()) {
+    Candidate C = Queue.top();
+    Queue.pop();
+    const std::vector<uint32_t> &FS = Features[C.Idx];
+    C.Gain = std::count_if(FS.begin(), FS.end(),
+                           [&](uint32_t F) { return !Covered.count(F); });
+    if (!C.Gain)
+      continue;
+    if (!Queue.empty() && Worse(C, Queue.top())) {
+      Queue.push(C);
+      continue;
+    }
+    Res.push_back(C.Idx);
+    Covered.insert(FS.begin(), FS.end());
+  }
+  return Res;
+}
+
+void Fuzzer::RunMergeShard(const std::string &ControlFile, size_t Shard) {
+  MergeControl M;
+  if (!M.ParseHeader(FileToString(ControlFile)) || Shard >= M.NumShards) {
+    Printf("ERROR: %s is not a merge control file with shard %zd\n",
+           ControlFile.c_str(), Shard);
+    exit(1);
+  }
+  std::string ShardFile = MergeShardPath(ControlFile, Shard);
+  size_t Crashed = M.ParseShard(FileToString(ShardFile));
+  if (Crashed < M.Files.size())
+    Printf("INFO: skipping %s, it did not finish in the last run\n",
+           M.Files[Crashed].c_str());
+
+  std::ofstream Out(ShardFile, std::ios::app);
+  std::vector<uint32_t> Features;
+  size_t NumRuns = 0;
+  for (size_t I = Shard; I < M.Files.size(); I += M.NumShards) {
+    if (M.Done[I])
+      continue;
+    // The file is mapped rather than read, and not kept after its run.
+    int FD = open(M.Files[I].c_str(), O_RDONLY);
+    struct stat St;
+    if (FD < 0 || fstat(FD, &St)) {
+      if (FD >= 0)
+        close(FD);
+      Out << "STARTED " << I << " 0\n" << std::flush;
+      continue;
+    }
+    size_t Size = std::min(static_cast<size_t>(St.st_size), Options.MaxLen);
+    static const uint8_t Empty = 0;
+    const uint8_t *Data = &Empty;
+    void *Map = nullptr;
+    if (Size) {
+      Map = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, FD, 0);
+      if (Map == MAP_FAILED) {
+        Printf("ERROR: could not map %s\n", M.Files[I].c_str());
+        exit(1);
+      }
+      Data = static_cast<const uint8_t *>(Map);
+    }
+    close(FD);
+
+    Out << "STARTED " << I << " " << Size << "\n" << std::flush;
+    PcMapResetCurrent();
+    InlineCountersResetCurrent();
+    ExecuteCallback(Data, Size);
+    Features.clear();
+    CollectCurrentFeatures(&Features);
+    Out << "DONE " << I;
+    for (uint32_t F : Features)
+      Out << " " << F;
+    Out << "\n" << std::flush;
+    if (Map)
+      munmap(Map, Size);
+
+    NumRuns++;
+    TotalNumberOfRuns++;
+    if (!(NumRuns & (NumRuns - 1)))
+      Printf("#%zd\tMERGE  shard: %zd\n", NumRuns, Shard);
+  }
+  Printf("=== Merge shard %zd: ran %zd files\n", Shard, NumRuns);
+}
+
+void MergeWithControlFile(const std::string &Cmd,
+                          const std::vector<std::string> &Corpora,
+                          const std::string &ControlFile, size_t NumShards,
+                          size_t MaxLen) {
+  if (Corpora.size() <= 1) {
+    Printf("Merge requires two or more corpus dirs\n");
+    return;
+  }
+  // A resumed merge must list the files in the same order.
+  MergeControl M;
+  M.NumShards = NumShards;
+  ListFilesInDir(Corpora[0], &M.Files);
+  std::sort(M.Files.begin(), M.Files.end());
+  M.NumFilesInFirstCorpus = M.Files.size();
+  std::vector<std::pair<size_t, std::string>> Extra;
+  for (size_t I = 1; I < Corpora.size(); I++) {
+    std::vector<std::string> Files;
+    ListFilesInDir(Corpora[I], &Files);
+    for (auto &Path : Files)
+      Extra.push_back({FileSize(Path), Path});
+  }
+  std::sort(Extra.begin(), Extra.end());
+  for (auto &E : Extra)
+    M.Files.push_back(E.second);
+
+  std::string Header = M.HeaderText();
+  if (FileToString(ControlFile) == Header) {
+    Printf("=== Resuming the merge of %zd files with %s\n", M.Files.size(),
+           ControlFile.c_str());
+  } else {
+    WriteToFile(Unit(Header.begin(), Header.end()), ControlFile);
+    for (size_t S = 0; S < NumShards; S++)
+      unlink(MergeShardPath(ControlFile, S).c_str());
+    Printf("=== Merging %zd files into %zd in %zd shard(s)\n", Extra.size(),
+           M.NumFilesInFirstCorpus, NumShards);
+  }
+
+  // A shard that exits with an error ran into a file that crashes, times out
+  // or leaks. Running it again resumes after that file.
+  std::mutex Mu;
+  std::atomic<bool> HasErrors(false);
+  auto RunShard = [&](size_t S) {
+    std::string ShardFile = MergeShardPath(ControlFile, S);
+    std::string Log = "merge-" + std::to_string(S) + ".log";
+    std::string ToRun =
+        Cmd + " -merge_shard=" + std::to_string(S) + " > " + Log + " 2>&1\n";
+    size_t LastSize = FileSize(ShardFile);
+    while (int ExitCode = ExecuteCommand(ToRun)) {
+      size_t Size = FileSize(ShardFile);
+      std::lock_guard<std::mutex> Lock(Mu);
+      if (Size == LastSize) {
+        Printf("ERROR: merge shard %zd exited with code %d before running "
+               "a file, see %s\n", S, ExitCode, Log.c_str());
+        HasErrors = true;
+        return;
+      }
+      Printf("INFO: merge shard %zd exited with code %d, resuming it\n", S,
+             ExitCode);
+      LastSize = Size;
+    }
+  };
+  std::vector<std::thread> Threads;
+  for (size_t S = 0; S < NumShards; S++)
+    Threads.emplace_back(RunShard, S);
+  for (auto &T : Threads)
+    T.join();
+  if (HasErrors)
+    exit(1);
+
+  for (size_t S = 0; S < NumShards; S++)
+    M.ParseShard(FileToString(MergeShardPath(ControlFile, S)));
+  if (std::all_of(M.Features.begin(), M.Features.end(),
+                  [](const std::vector<uint32_t> &F) { return F.empty(); }))
+    Printf("WARNING: no coverage was recorded, -merge_control_file needs "
+           "inline 8-bit counters or -fsanitize-coverage=trace-pc\n");
+
+  std::vector<size_t> ToAdd = M.ChooseFilesToAdd();
+  for (size_t I : ToAdd) {
+    Unit U = FileToVector(M.Files[I], MaxLen);
+    WriteToFile(U, DirPlusFile(Corpora[0], Hash(U)));
+  }
+  Printf("=== Merge: written %zd units\n", ToAdd.size());
+}
+
+} // namespace fuzzer
@@ -37,6 +37,7 @@ MutationDispatcher::MutationDispatcher(Random &Rand,
            "AddFromTempAutoDict"},
           {&MutationDispatcher::Mutate_AddWordFromPersistentAutoDictionary,
            "AddFromPersAutoDict"},
+          {&MutationDispatcher::Mutate_AddWordFromTORC, "AddFromTORC"},
       });
 
   if (EF->LLVMFuzzerCustomMutator)
@@ -49,6 +50,13 @@ MutationDispatcher::MutationDispatcher(Random &Rand,
         {&MutationDispatcher::Mutate_CustomCrossOver, "CustomCrossOver"});
 }
 
+MutationDispatcher::MutationDispatcher(Random &Rand,
+                                       const MutationDispatcher &Other)
+    : MutationDispatcher(Rand, Other.Options) {
+  ManualDictionary = Other.ManualDictionary;
+  PersistentAutoDictionary = Other.PersistentAutoDictionary;
+}
+
 static char FlipRandomBit(char X, Random &Rand) {
   int Bit = Rand(8);
   char Mask = 1 << Bit;
@@ -153,10 +161,60 @@ size_t MutationDispatcher::Mutate_AddWordFromPersistentAutoDictionary(
   return AddWordFromDictionary(PersistentAutoDictionary, Data, Size, MaxSize);
 }
 
+size_t MutationDispatcher::Mutate_AddWordFromTORC(uint8_t *Data, size_t Size,
+                                                  size_t MaxSize) {
+  Word X, Y;
+  switch (Rand(3)) {
+  case 0: {
+    if (!TORC4.size()) return 0;
+    auto &P = TORC4[Rand(TORC4.size())];
+    X.Set(reinterpret_cast<const uint8_t *>(&P.A), sizeof(P.A));
+    Y.Set(reinterpret_cast<const uint8_t *>(&P.B), sizeof(P.B));
+    break;
+  }
+  case 1: {
+    if (!TORC8.size()) return 0;
+    auto &P = TORC8[Rand(TORC8.size())];
+    X.Set(reinterpret_cast<const uint8_t *>(&P.A), sizeof(P.A));
+    Y.Set(reinterpret_cast<const uint8_t *>(&P.B), sizeof(P.B));
+    break;
+  }
+  case 2: {
+    if (!TORCW.size()) return 0;
+    auto &P = TORCW[Rand(TORCW.size())];
+    X = P.A;
+    Y = P.B;
+    break;
+  }
+  default: assert(0);
+  }
+  if (Rand.RandBool())
+    std::swap(X, Y);
+  if (!Y.size()) return 0;
+  // Replace X with Y where the input has X, else add Y anywhere.
+  auto *Pos = X.size() ? static_cast<uint8_t *>(
+                             memmem(Data, Size, X.data(), X.size()))
+                       : nullptr;
+  TORCEntries.push_back(Pos ? DictionaryEntry(Y, Pos - Data)
+                            : DictionaryEntry(Y));
+  DictionaryEntry &DE = TORCEntries.back();
+  if (!Pos || Pos + Y.size() > Data + Size)
+    return ApplyDictionaryEntry(Data, Size, MaxSize, DE);
+  memcpy(Pos, Y.data(), Y.size());
+  DE.IncUseCount();
+  CurrentDictionaryEntrySequence.push_back(&DE);
+  return Size;
+}
+
 size_t MutationDispatcher::AddWordFromDictionary(Dictionary &D, uint8_t *Data,
                                                  size_t Size, size_t MaxSize) {
   if (D.empty()) return 0;
-  DictionaryEntry &DE = D[Rand(D.size())];
+  return ApplyDictionaryEntry(Data, Size, MaxSize, D[Rand(D.size())]);
+}
+
+size_t MutationDispatcher::ApplyDictionaryEntry(uint8_t *Data, size_t Size,
+                                                size_t MaxSize,
+                                                DictionaryEntry &DE) {
   const Word &W = DE.GetW();
   bool UsePositionHint = DE.HasPositionHint() &&
                          DE.GetPositionHint() + W.size() < Size && Rand.RandBool();
@@ -228,6 +286,7 @@ size_t MutationDispatcher::Mutate_CrossOver(uint8_t *Data, size_t Size,
 void MutationDispatcher::StartMutationSequence() {
   CurrentMutatorSequence.clear();
   CurrentDictionaryEntrySequence.clear();
+  TORCEntries.clear();
 }
 
 // Copy successful dictionary entries to PersistentAutoDictionary.
@@ -8,7 +8,8 @@
 //===----------------------------------------------------------------------===//
 // Trace PCs.
 // This module implements __sanitizer_cov_trace_pc, a callback required
-// for -fsanitize-coverage=trace-pc instrumentation.
+// for -fsanitize-coverage=trace-pc instrumentation, and collects the inline
+// 8-bit counters of -sanitizer-coverage-inline-8bit-counters.
 //
 //===----------------------------------------------------------------------===//
 
@@ -55,6 +56,134 @@ static void HandlePC(uint32_t PC) {
   Prev = Next;
 }
 
+// The counters, and their PC table, registered by each instrumented module.
+// These are plain arrays as the module constructors may run before ours.
+struct CounterRegion {
+  uint8_t *Start, *Stop;
+  const uintptr_t *PCs; // A PC and flags for each counter, or null.
+};
+static const size_t kMaxNumCounterRegions = 4096;
+static CounterRegion CounterRegions[kMaxNumCounterRegions];
+static size_t NumCounterRegions;
+static size_t NumInlineCounters;
+
+static void AddCounterRegion(uint8_t *Start, uint8_t *Stop) {
+  if (Start == Stop || NumCounterRegions == kMaxNumCounterRegions)
+    return;
+  CounterRegions[NumCounterRegions++] = {Start, Stop, nullptr};
+  NumInlineCounters += Stop - Start;
+}
+
+static void AddPCTable(const uintptr_t *Start, const uintptr_t *Stop) {
+  if (!NumCounterRegions)
+    return;
+  // The table comes right after the counters of its module.
+  CounterRegion &R = CounterRegions[NumCounterRegions - 1];
+  if (Stop - Start == 2 * (R.Stop - R.Start))
+    R.PCs = Start;
+}
+
+// Returns the index of the range of values of a nonzero Counter.
+static inline unsigned CounterRange(uint8_t Counter) {
+  return Counter >= 128 ? 7 : Counter >= 32 ? 6 : Counter >= 16 ? 5
+       : Counter >= 8 ? 4 : Counter >= 4 ? 3 : Counter >= 3 ? 2
+       : Counter >= 2 ? 1 : 0;
+}
+
+static inline size_t UpdateCounterBit(uint8_t Counter, uint8_t *Bits) {
+  if (!Counter)
+    return 0;
+  uint8_t Bit = 1 << CounterRange(Counter);
+  if (*Bits & Bit)
+    return 0;
+  *Bits |= Bit;
+  return 1;
+}
+
+size_t UpdateCounterBitmapAndClear(uint8_t *Counters, size_t N,
+                                   uint8_t *Bitmap) {
+  // Most counters stay zero in a run, so look at them a word at a time and
+  // only go through the bytes of the words that are not zero.
+  const size_t kStep = sizeof(uint64_t);
+  size_t Res = 0;
+  size_t I = 0;
+  for (; I + kStep <= N; I += kStep) {
+    uint64_t Word;
+    memcpy(&Word, Counters + I, kStep);
+    if (!Word)
+      continue;
+    for (size_t J = I; J < I + kStep; J++)
+      Res += UpdateCounterBit(Counters[J], &Bitmap[J]);
+    memset(Counters + I, 0, kStep);
+  }
+  for (; I < N; I++) {
+    Res += UpdateCounterBit(Counters[I], &Bitmap[I]);
+    Counters[I] = 0;
+  }
+  return Res;
+}
+
+size_t InlineCountersNum() { return NumInlineCounters; }
+
+bool InlineCountersHaveNew(const uint8_t *Bitmap) {
+  const size_t kStep = sizeof(uint64_t);
+  for (size_t I = 0; I < NumCounterRegions; I++) {
+    const uint8_t *Counters = CounterRegions[I].Start;
+    size_t N = CounterRegions[I].Stop - Counters;
+    for (size_t J = 0; J < N; J += kStep) {
+      size_t End = std::min(J + kStep, N);
+      uint64_t Word = 0;
+      memcpy(&Word, Counters + J, End - J);
+      if (!Word)
+        continue;
+      for (size_t K = J; K < End; K++)
+        if (Counters[K] && !Bitmap[K])
+          return true;
+    }
+    Bitmap += N;
+  }
+  return false;
+}
+
+void CollectCurrentFeatures(std::vector<uint32_t> *Features) {
+  uint32_t Base = 0;
+  for (size_t I = 0; I < NumCounterRegions; I++) {
+    const CounterRegion &R = CounterRegions[I];
+    size_t N = R.Stop - R.Start;
+    for (size_t J = 0; J < N; J++)
+      if (R.Start[J])
+        Features->push_back(Base + J * 8 + CounterRange(R.Start[J]));
+    Base += N * 8;
+  }
+  if (!Prev)
+    return;
+  for (size_t I = 0; I < PcCoverageMap::kMapSizeInWords; I++)
+    for (uintptr_t W = CurrentMap.Map[I]; W; W &= W - 1)
+      Features->push_back(Base + I * PcCoverageMap::kBitsInWord +
+                          __builtin_ctzl(W));
+}
+
+void InlineCountersResetCurrent() {
+  for (size_t I = 0; I < NumCounterRegions; I++)
+    memset(CounterRegions[I].Start, 0,
+           CounterRegions[I].Stop - CounterRegions[I].Start);
+}
+
+size_t InlineCountersMergeInto(uint8_t *Bitmap, bool PrintNewPCs) {
+  size_t Res = 0;
+  for (size_t I = 0; I < NumCounterRegions; I++) {
+    const CounterRegion &R = CounterRegions[I];
+    size_t N = R.Stop - R.Start;
+    if (PrintNewPCs && R.PCs)
+      for (size_t J = 0; J < N; J++)
+        if (R.Start[J] && !Bitmap[J])
+          Printf("%p\n", R.PCs[2 * J]);
+    Res += UpdateCounterBitmapAndClear(R.Start, N, Bitmap);
+    Bitmap += N;
+  }
+  return Res;
+}
+
 } // namespace fuzzer
 
 extern "C" {
@@ -63,6 +192,14 @@ void __sanitizer_cov_trace_pc() {
       reinterpret_cast<uintptr_t>(__builtin_return_address(0))));
 }
 
+void __sanitizer_cov_8bit_counters_init(uint8_t *Start, uint8_t *Stop) {
+  fuzzer::AddCounterRegion(Start, Stop);
+}
+
+void __sanitizer_cov_pcs_init(const uintptr_t *Start, const uintptr_t *Stop) {
+  fuzzer::AddPCTable(Start, Stop);
+}
+
 void __sanitizer_cov_trace_pc_indir(int *) {
   // Stub to allow linking with code built with
   // -fsanitize=indirect-calls,trace-pc.
@@ -8,7 +8,8 @@
 //===----------------------------------------------------------------------===//
 // Trace PCs.
 // This module implements __sanitizer_cov_trace_pc, a callback required
-// for -fsanitize-coverage=trace-pc instrumentation.
+// for -fsanitize-coverage=trace-pc instrumentation, and collects the inline
+// 8-bit counters of -sanitizer-coverage-inline-8bit-counters.
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_FUZZER_TRACE_PC_H
@@ -32,6 +33,28 @@ struct PcCoverageMap {
 void PcMapResetCurrent();
 // Merges the current PC Map into the combined one, and clears the former.
 size_t PcMapMergeInto(PcCoverageMap *Map);
+
+// Folds the N counters into Bitmap, one byte per counter, and clears them.
+// A counter sets one bit of its byte for each of the ranges of values
+// 1, 2, 3, 4-7, 8-15, 16-31, 32-127 and 128-255 it has been seen in.
+// Returns the number of bits that were not set in Bitmap before.
+size_t UpdateCounterBitmapAndClear(uint8_t *Counters, size_t N,
+                                   uint8_t *Bitmap);
+// Returns the number of inline 8-bit counters of the instrumented modules.
+size_t InlineCountersNum();
+// Clears the inline 8-bit counters.
+void InlineCountersResetCurrent();
+// Folds the inline 8-bit counters into Bitmap, of InlineCountersNum() bytes,
+// and clears them. Prints the PC of the counters seen for the first time if
+// PrintNewPCs is set and their module has a PC table.
+size_t InlineCountersMergeInto(uint8_t *Bitmap, bool PrintNewPCs);
+// Returns true if an inline 8-bit counter is set and its byte in Bitmap is
+// not, that is if a block not seen before ran. Leaves the counters as they
+// are.
+bool InlineCountersHaveNew(const uint8_t *Bitmap);
+// Appends to Features one feature for each inline 8-bit counter that is set,
+// by the range of its value, and one for each bit of the current PC Map.
+void CollectCurrentFeatures(std::vector<uint32_t> *Features);
 }
 
 #endif
@@ -21,6 +21,11 @@
 // we try to insert 12345, 12344, 12346 into bytes
 // {4,5,6,7} of the next fuzzed inputs.
 //
+// Independently of -use_traces, the operands of the 4- and 8-byte comparisons
+// and of the memcmp-like calls made by the user callback are kept in the
+// tables of recent compares (TORC4, TORC8, TORCW), which the AddFromTORC
+// mutator reads.
+//
 // The fuzzer can work only with the traces, or with both traces and DFSan.
 //
 // DataFlowSanitizer (DFSan) is a tool for
@@ -476,6 +481,24 @@ void TraceState::TraceSwitchCallback(uintptr_t PC, size_t ValSizeInBits,
 
 static TraceState *TS;
 
+TableOfRecentCompares<uint32_t, 32> TORC4;
+TableOfRecentCompares<uint64_t, 32> TORC8;
+TableOfRecentCompares<Word, 32> TORCW;
+thread_local bool RunningUserCallback;
+
+static void AddToTORC(uint64_t CmpSize, uint64_t Arg1, uint64_t Arg2) {
+  if (CmpSize == 4)
+    TORC4.Insert(Arg1, Arg2);
+  else if (CmpSize == 8)
+    TORC8.Insert(Arg1, Arg2);
+}
+
+static void AddToTORC(const void *S1, const void *S2, size_t N) {
+  N = std::min(N, Word::GetMaxSize());
+  TORCW.Insert(Word(static_cast<const uint8_t *>(S1), N),
+               Word(static_cast<const uint8_t *>(S2), N));
+}
+
 void Fuzzer::StartTraceRecording() {
   if (!TS) return;
   TS->StartTraceRecording();
@@ -510,6 +533,7 @@ static size_t InternalStrnlen(const char *S, size_t MaxLen) {
 using fuzzer::TS;
 using fuzzer::RecordingTraces;
 using fuzzer::RecordingMemcmp;
+using fuzzer::RunningUserCallback;
 
 extern "C" {
 void __dfsw___sanitizer_cov_trace_cmp(uint64_t SizeAndType, uint64_t Arg1,
@@ -573,34 +597,42 @@ void dfsan_weak_hook_strcmp(void *caller_pc, const char *s1, const char *s2,
 #if LLVM_FUZZER_DEFINES_SANITIZER_WEAK_HOOOKS
 void __sanitizer_weak_hook_memcmp(void *caller_pc, const void *s1,
                                   const void *s2, size_t n, int result) {
-  if (!RecordingMemcmp) return;
   if (result == 0) return;  // No reason to mutate.
   if (n <= 1) return;  // Not interesting.
+  if (RunningUserCallback)
+    fuzzer::AddToTORC(s1, s2, n);
+  if (!RecordingMemcmp) return;
   TS->TraceMemcmpCallback(n, reinterpret_cast<const uint8_t *>(s1),
                           reinterpret_cast<const uint8_t *>(s2));
 }
 
 void __sanitizer_weak_hook_strncmp(void *caller_pc, const char *s1,
                                    const char *s2, size_t n, int result) {
-  if (!RecordingMemcmp) return;
+  if (!RecordingMemcmp && !RunningUserCallback) return;
   if (result == 0) return;  // No reason to mutate.
   size_t Len1 = fuzzer::InternalStrnlen(s1, n);
   size_t Len2 = fuzzer::InternalStrnlen(s2, n);
   n = std::min(n, Len1);
   n = std::min(n, Len2);
   if (n <= 1) return;  // Not interesting.
+  if (RunningUserCallback)
+    fuzzer::AddToTORC(s1, s2, n);
+  if (!RecordingMemcmp) return;
   TS->TraceMemcmpCallback(n, reinterpret_cast<const uint8_t *>(s1),
                           reinterpret_cast<const uint8_t *>(s2));
 }
 
 void __sanitizer_weak_hook_strcmp(void *caller_pc, const char *s1,
                                    const char *s2, int result) {
-  if (!RecordingMemcmp) return;
+  if (!RecordingMemcmp && !RunningUserCallback) return;
   if (result == 0) return;  // No reason to mutate.
   size_t Len1 = strlen(s1);
   size_t Len2 = strlen(s2);
   size_t N = std::min(Len1, Len2);
   if (N <= 1) return;  // Not interesting.
+  if (RunningUserCallback)
+    fuzzer::AddToTORC(s1, s2, N);
+  if (!RecordingMemcmp) return;
   TS->TraceMemcmpCallback(N, reinterpret_cast<const uint8_t *>(s1),
                           reinterpret_cast<const uint8_t *>(s2));
 }
@@ -610,9 +642,12 @@ void __sanitizer_weak_hook_strcmp(void *caller_pc, const char *s1,
 __attribute__((visibility("default")))
 void __sanitizer_cov_trace_cmp(uint64_t SizeAndType, uint64_t Arg1,
                                uint64_t Arg2) {
+  if (!RecordingTraces && !RunningUserCallback) return;
+  uint64_t CmpSize = (SizeAndType >> 32) / 8;
+  if (RunningUserCallback && Arg1 != Arg2)
+    fuzzer::AddToTORC(CmpSize, Arg1, Arg2);
   if (!RecordingTraces) return;
   uintptr_t PC = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
-  uint64_t CmpSize = (SizeAndType >> 32) / 8;
   uint64_t Type = (SizeAndType << 32) >> 32;
   TS->TraceCmpCallback(PC, CmpSize, Type, Arg1, Arg2);
 }
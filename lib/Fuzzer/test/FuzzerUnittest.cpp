@@ -304,6 +304,20 @@ TEST(FuzzerMutate, AddWordFromDictionary2) {
   TestAddWordFromDictionary(&MutationDispatcher::Mutate, 1 << 15);
 }
 
+TEST(FuzzerMutate, CopyOfDispatcherKeepsDictionary) {
+  std::unique_ptr<ExternalFunctions> t(new ExternalFunctions());
+  fuzzer::EF = t.get();
+  Random Rand(0);
+  MutationDispatcher MD(Rand, {});
+  uint8_t W[4] = {0xAA, 0xBB, 0xCC, 0xDD};
+  MD.AddWordToManualDictionary(Word(W, sizeof(W)));
+  Random Rand2(1);
+  MutationDispatcher MD2(Rand2, MD);
+  uint8_t T[7] = {0x00, 0x11, 0x22};
+  EXPECT_EQ(7U, MD2.Mutate_AddWordFromManualDictionary(T, 3, 7));
+  EXPECT_TRUE(std::search(T, T + 7, W, W + sizeof(W)) != T + 7);
+}
+
 void TestAddWordFromDictionaryWithHint(Mutator M, int NumIter) {
   std::unique_ptr<ExternalFunctions> t(new ExternalFunctions());
   fuzzer::EF = t.get();
@@ -333,6 +347,26 @@ TEST(FuzzerMutate, AddWordFromDictionaryWithHint2) {
   TestAddWordFromDictionaryWithHint(&MutationDispatcher::Mutate, 1 << 10);
 }
 
+TEST(FuzzerMutate, AddWordFromTORC) {
+  std::unique_ptr<ExternalFunctions> t(new ExternalFunctions());
+  fuzzer::EF = t.get();
+  Random Rand(0);
+  MutationDispatcher MD(Rand, {});
+  uint32_t A = 0x01020304, B = 0x0A0B0C0D;
+  TORC4.clear();
+  TORC4.Insert(A, B);
+  int FoundMask = 0;
+  for (int i = 0; i < 1 << 12; i++) {
+    uint8_t T[8] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77};
+    memcpy(T + 2, &A, sizeof(A));
+    size_t NewSize = MD.Mutate_AddWordFromTORC(T, 8, 8);
+    if (NewSize == 8 && !memcmp(T + 2, &B, sizeof(B))) FoundMask |= 1;
+    if (NewSize == 8 && memmem(T, 8, &B, sizeof(B))) FoundMask |= 2;
+  }
+  TORC4.clear();
+  EXPECT_EQ(FoundMask, 3);
+}
+
 void TestChangeASCIIInteger(Mutator M, int NumIter) {
   std::unique_ptr<ExternalFunctions> t(new ExternalFunctions());
   fuzzer::EF = t.get();
@@ -427,6 +461,31 @@ TEST(FuzzerUtil, Base64) {
   EXPECT_EQ("YWJjeHl6", Base64({'a', 'b', 'c', 'x', 'y', 'z'}));
 }
 
+TEST(FuzzerTracePC, UpdateCounterBitmapAndClear) {
+  // 19 counters: a full word of zeros, a word with a few counters and a tail.
+  uint8_t Counters[19] = {};
+  uint8_t Bitmap[19] = {};
+  EXPECT_EQ(0U, UpdateCounterBitmapAndClear(Counters, 19, Bitmap));
+  Counters[9] = 1;
+  Counters[10] = 5;
+  Counters[18] = 200;
+  EXPECT_EQ(3U, UpdateCounterBitmapAndClear(Counters, 19, Bitmap));
+  for (size_t i = 0; i < 19; i++)
+    EXPECT_EQ(0, Counters[i]);
+  EXPECT_EQ(1, Bitmap[9]);
+  EXPECT_EQ(8, Bitmap[10]);
+  EXPECT_EQ(128, Bitmap[18]);
+
+  // Values in a range already seen add nothing, new ranges add a bit.
+  Counters[9] = 1;
+  Counters[10] = 6;
+  Counters[18] = 2;
+  EXPECT_EQ(1U, UpdateCounterBitmapAndClear(Counters, 19, Bitmap));
+  EXPECT_EQ(1, Bitmap[9]);
+  EXPECT_EQ(8, Bitmap[10]);
+  EXPECT_EQ(130, Bitmap[18]);
+}
+
 TEST(Corpus, Distribution) {
   std::unique_ptr<ExternalFunctions> t(new ExternalFunctions());
   fuzzer::EF = t.get();
@@ -447,3 +506,39 @@ TEST(Corpus, Distribution) {
     EXPECT_GT(Hist[i], TriesPerUnit / N / 3);
   }
 }
+
+TEST(Merge, ParseControl) {
+  MergeControl M;
+  EXPECT_FALSE(M.ParseHeader(""));
+  EXPECT_FALSE(M.ParseHeader("MERGE 2 1 1\nA\n"));
+  M.Files = {"A", "B", "C"};
+  M.NumFilesInFirstCorpus = 1;
+  M.NumShards = 2;
+  MergeControl P;
+  EXPECT_TRUE(P.ParseHeader(M.HeaderText()));
+  EXPECT_EQ(M.Files, P.Files);
+  EXPECT_EQ(1U, P.NumFilesInFirstCorpus);
+  EXPECT_EQ(2U, P.NumShards);
+
+  // C was started and not done.
+  EXPECT_EQ(2U, P.ParseShard("STARTED 0 10\nDONE 0 1 2\nSTARTED 2 5\n"));
+  EXPECT_EQ(3U, P.ParseShard("STARTED 1 7\nDONE 1 3\n"));
+  EXPECT_TRUE(P.Done[0] && P.Done[1] && P.Done[2]);
+  EXPECT_EQ(std::vector<uint32_t>({1, 2}), P.Features[0]);
+  EXPECT_EQ(std::vector<uint32_t>({3}), P.Features[1]);
+  EXPECT_TRUE(P.Features[2].empty());
+  EXPECT_EQ(7U, P.Sizes[1]);
+}
+
+TEST(Merge, ChooseFilesToAdd) {
+  MergeControl M;
+  M.Files = {"A", "B", "C", "D", "E", "F"};
+  M.NumFilesInFirstCorpus = 1;
+  M.Sizes = {1, 1, 1, 1, 2, 1};
+  M.Features = {{1, 2}, {1, 3}, {3, 4, 5}, {2}, {4, 5, 6, 7}, {3, 6, 7}};
+  // E adds the most, then B and C add one each, and B is first.
+  EXPECT_EQ(std::vector<size_t>({4, 1}), M.ChooseFilesToAdd());
+  // With the same gain, the smaller file wins.
+  M.Features[5] = {3, 4, 5, 6, 7};
+  EXPECT_EQ(std::vector<size_t>({5}), M.ChooseFilesToAdd());
+}
@@ -590,6 +590,7 @@ private:
 public:
   typename MapTy::iterator begin() { return Map.begin(); }
   typename MapTy::iterator end() { return Map.end(); }
+  size_t getMemorySize() const { return Map.getMemorySize(); }
 
   void freeConstants() {
     for (auto &I : Map)
@@ -1844,6 +1844,23 @@ void LLVMAddAttributeAtIndex(LLVMValueRef F, LLVMAttributeIndex Idx,
   unwrap<Function>(F)->addAttribute(Idx, unwrap(A));
 }
 
+static AttributeSet getAttributeSet(LLVMContext &Context,
+                                    LLVMAttributeIndex Idx,
+                                    LLVMAttributeRef *Attrs,
+                                    unsigned NumAttrs) {
+  AttrBuilder B;
+  for (unsigned I = 0; I != NumAttrs; ++I)
+    B.addAttribute(unwrap(Attrs[I]));
+  return AttributeSet::get(Context, Idx, B);
+}
+
+void LLVMAddAttributesAtIndex(LLVMValueRef F, LLVMAttributeIndex Idx,
+                              LLVMAttributeRef *Attrs, unsigned NumAttrs) {
+  Function *Func = unwrap<Function>(F);
+  Func->addAttributes(
+      Idx, getAttributeSet(Func->getContext(), Idx, Attrs, NumAttrs));
+}
+
 LLVMAttributeRef LLVMGetEnumAttributeAtIndex(LLVMValueRef F,
                                              LLVMAttributeIndex Idx,
                                              unsigned KindID) {
@@ -2216,6 +2233,14 @@ void LLVMAddCallSiteAttribute(LLVMValueRef C, LLVMAttributeIndex Idx,
   CallSite(unwrap<Instruction>(C)).addAttribute(Idx, unwrap(A));
 }
 
+void LLVMAddCallSiteAttributes(LLVMValueRef C, LLVMAttributeIndex Idx,
+                               LLVMAttributeRef *Attrs, unsigned NumAttrs) {
+  CallSite CS(unwrap<Instruction>(C));
+  LLVMContext &Context = CS->getContext();
+  CS.setAttributes(CS.getAttributes().addAttributes(
+      Context, Idx, getAttributeSet(Context, Idx, Attrs, NumAttrs)));
+}
+
 LLVMAttributeRef LLVMGetCallSiteEnumAttribute(LLVMValueRef C,
                                               LLVMAttributeIndex Idx,
                                               unsigned KindID) {
@@ -3067,6 +3092,103 @@ LLVMValueRef LLVMBuildAtomicCmpXchg(LLVMBuilderRef B, LLVMValueRef Ptr,
                 singleThread ? SingleThread : CrossThread));
 }
 
+unsigned LLVMBuildInstructions(LLVMBuilderRef B, const unsigned *Code,
+                               unsigned CodeLength, LLVMValueRef *Values,
+                               unsigned NumValues, LLVMTypeRef *Types) {
+  IRBuilder<> *Builder = unwrap(B);
+  const unsigned *P = Code, *End = Code + CodeLength;
+  unsigned NumBuilt = 0;
+
+  auto Val = [&]() {
+    assert(P != End && "Truncated instruction record!");
+    return unwrap(Values[*P++]);
+  };
+  auto Imm = [&]() {
+    assert(P != End && "Truncated instruction record!");
+    return *P++;
+  };
+  auto Ty = [&]() { return unwrap(Types[Imm()]); };
+
+  while (P != End) {
+    LLVMOpcode Op = static_cast<LLVMOpcode>(*P++);
+    Value *V;
+    switch (Op) {
+    case LLVMAdd: case LLVMFAdd: case LLVMSub: case LLVMFSub:
+    case LLVMMul: case LLVMFMul: case LLVMUDiv: case LLVMSDiv:
+    case LLVMFDiv: case LLVMURem: case LLVMSRem: case LLVMFRem:
+    case LLVMShl: case LLVMLShr: case LLVMAShr:
+    case LLVMAnd: case LLVMOr: case LLVMXor: {
+      Value *LHS = Val();
+      Value *RHS = Val();
+      V = Builder->CreateBinOp(
+          Instruction::BinaryOps(map_from_llvmopcode(Op)), LHS, RHS);
+      break;
+    }
+    case LLVMTrunc: case LLVMZExt: case LLVMSExt: case LLVMFPToUI:
+    case LLVMFPToSI: case LLVMUIToFP: case LLVMSIToFP: case LLVMFPTrunc:
+    case LLVMFPExt: case LLVMPtrToInt: case LLVMIntToPtr: case LLVMBitCast:
+    case LLVMAddrSpaceCast: {
+      Value *Src = Val();
+      V = Builder->CreateCast(Instruction::CastOps(map_from_llvmopcode(Op)),
+                              Src, Ty());
+      break;
+    }
+    case LLVMICmp:
+    case LLVMFCmp: {
+      auto Pred = static_cast<CmpInst::Predicate>(Imm());
+      Value *LHS = Val();
+      Value *RHS = Val();
+      V = Op == LLVMICmp ? Builder->CreateICmp(Pred, LHS, RHS)
+                         : Builder->CreateFCmp(Pred, LHS, RHS);
+      break;
+    }
+    case LLVMSelect: {
+      Value *If = Val();
+      Value *Then = Val();
+      V = Builder->CreateSelect(If, Then, Val());
+      break;
+    }
+    case LLVMAlloca:
+      V = Builder->CreateAlloca(Ty());
+      break;
+    case LLVMLoad:
+      V = Builder->CreateLoad(Val());
+      break;
+    case LLVMStore: {
+      Value *Stored = Val();
+      V = Builder->CreateStore(Stored, Val());
+      break;
+    }
+    case LLVMGetElementPtr: {
+      Value *Ptr = Val();
+      SmallVector<Value *, 4> Idxs(Imm());
+      for (Value *&Idx : Idxs)
+        Idx = Val();
+      V = Builder->CreateGEP(nullptr, Ptr, Idxs);
+      break;
+    }
+    case LLVMExtractValue: {
+      Value *Agg = Val();
+      V = Builder->CreateExtractValue(Agg, Imm());
+      break;
+    }
+    case LLVMInsertValue: {
+      Value *Agg = Val();
+      Value *Elt = Val();
+      V = Builder->CreateInsertValue(Agg, Elt, Imm());
+      break;
+    }
+    case LLVMRet:
+      V = Imm() ? Builder->CreateRet(Val()) : Builder->CreateRetVoid();
+      break;
+    default:
+      llvm_unreachable("Unsupported opcode in instruction record!");
+    }
+    Values[NumValues + NumBuilt++] = wrap(V);
+  }
+  return NumBuilt;
+}
+
 
 LLVMBool LLVMIsAtomicSingleThread(LLVMValueRef AtomicInst) {
   Value *P = unwrap<Value>(AtomicInst);
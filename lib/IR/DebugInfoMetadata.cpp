@@ -205,6 +205,10 @@ void GenericDINode::recalculateHash() {
   return storeImpl(new (array_lengthof(OPS))                                   \
                        CLASS(Context, Storage, UNWRAP_ARGS(ARGS), OPS),        \
                    Storage, Context.pImpl->CLASS##s)
+#define DEFINE_GETIMPL_STORE_N(CLASS, ARGS, OPS, NUM_OPS)                     \
+  return storeImpl(new (NUM_OPS)                                               \
+                       CLASS(Context, Storage, UNWRAP_ARGS(ARGS), OPS),        \
+                   Storage, Context.pImpl->CLASS##s)
 #define DEFINE_GETIMPL_STORE_NO_OPS(CLASS, ARGS)                               \
   return storeImpl(new (0u) CLASS(Context, Storage, UNWRAP_ARGS(ARGS)),        \
                    Storage, Context.pImpl->CLASS##s)
@@ -248,10 +252,12 @@ DIDerivedType *DIDerivedType::getImpl(
   DEFINE_GETIMPL_LOOKUP(DIDerivedType,
                         (Tag, Name, File, Line, Scope, BaseType, SizeInBits,
                          AlignInBits, OffsetInBits, Flags, ExtraData));
+  // Only pointer-to-member types and some members have extra data.
   Metadata *Ops[] = {File, Scope, Name, BaseType, ExtraData};
-  DEFINE_GETIMPL_STORE(
+  unsigned NumOps = ExtraData ? 5 : 4;
+  DEFINE_GETIMPL_STORE_N(
       DIDerivedType, (Tag, Line, SizeInBits, AlignInBits, OffsetInBits, Flags),
-      Ops);
+      makeArrayRef(Ops, NumOps), NumOps);
 }
 
 DICompositeType *DICompositeType::getImpl(
@@ -422,13 +428,20 @@ DISubprogram *DISubprogram::getImpl(
       (Scope, Name, LinkageName, File, Line, Type, IsLocalToUnit, IsDefinition,
        ScopeLine, ContainingType, Virtuality, VirtualIndex, ThisAdjustment,
        Flags, IsOptimized, Unit, TemplateParams, Declaration, Variables));
-  Metadata *Ops[] = {File,           Scope,       Name,           Name,
-                     LinkageName,    Type,        ContainingType, Unit,
+  // The display name is the same as the name, so it isn't stored. The last
+  // three operands are null for most declarations and for functions without
+  // locals or template parameters, so null ones at the end are left off.
+  Metadata *Ops[] = {File,           Scope,       Name,     LinkageName,
+                     Type,           ContainingType,        Unit,
                      TemplateParams, Declaration, Variables};
-  DEFINE_GETIMPL_STORE(DISubprogram, (Line, ScopeLine, Virtuality, VirtualIndex,
-                                      ThisAdjustment, Flags, IsLocalToUnit,
-                                      IsDefinition, IsOptimized),
-                       Ops);
+  unsigned NumOps = array_lengthof(Ops);
+  while (NumOps > 7 && !Ops[NumOps - 1])
+    --NumOps;
+  DEFINE_GETIMPL_STORE_N(DISubprogram,
+                         (Line, ScopeLine, Virtuality, VirtualIndex,
+                          ThisAdjustment, Flags, IsLocalToUnit, IsDefinition,
+                          IsOptimized),
+                         makeArrayRef(Ops, NumOps), NumOps);
 }
 
 bool DISubprogram::describes(const Function *F) const {
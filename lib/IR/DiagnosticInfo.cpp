@@ -84,6 +84,18 @@ PassRemarksAnalysis(
         "the given regular expression"),
     cl::Hidden, cl::location(PassRemarksAnalysisOptLoc), cl::ValueRequired,
     cl::ZeroOrMore);
+
+static PassRemarksOpt PassRemarksFilterOptLoc;
+
+// -pass-remarks-filter
+//    Command line flag to restrict the remarks written to the remarks file
+static cl::opt<PassRemarksOpt, true, cl::parser<std::string>>
+PassRemarksFilter(
+    "pass-remarks-filter", cl::value_desc("pattern"),
+    cl::desc("Only write the remarks of passes whose name match the given "
+             "regular expression to the remarks output file"),
+    cl::Hidden, cl::location(PassRemarksFilterOptLoc), cl::ValueRequired,
+    cl::ZeroOrMore);
 }
 
 int llvm::getNextAvailablePluginDiagnosticKind() {
@@ -174,6 +186,18 @@ void DiagnosticInfoOptimizationBase::print(DiagnosticPrinter &DP) const {
   DP << getLocationStr() << ": " << getMsg();
 }
 
+bool DiagnosticInfoOptimizationBase::isSerializationEnabled() const {
+  if (!PassRemarksFilterOptLoc.Pattern)
+    return true;
+  return getPassName() && PassRemarksFilterOptLoc.Pattern->match(getPassName());
+}
+
+Optional<uint64_t> DiagnosticInfoOptimizationBase::getHotness() const {
+  if (Hotness)
+    return Hotness;
+  return getFunction().getEntryCount();
+}
+
 bool DiagnosticInfoOptimizationRemark::isEnabled() const {
   return PassRemarksOptLoc.Pattern &&
          PassRemarksOptLoc.Pattern->match(getPassName());
@@ -190,6 +214,68 @@ bool DiagnosticInfoOptimizationRemarkAnalysis::isEnabled() const {
           PassRemarksAnalysisOptLoc.Pattern->match(getPassName()));
 }
 
+namespace llvm {
+namespace yaml {
+
+template <> struct MappingTraits<DebugLoc> {
+  static void mapping(IO &io, DebugLoc &DL) {
+    assert(io.outputting() && "input not yet implemented");
+    auto *Scope = cast<DIScope>(DL.getScope());
+    StringRef File = Scope->getFilename();
+    unsigned Line = DL.getLine();
+    unsigned Col = DL.getCol();
+    io.mapRequired("File", File);
+    io.mapRequired("Line", Line);
+    io.mapRequired("Column", Col);
+  }
+
+  static const bool flow = true;
+};
+
+void MappingTraits<DiagnosticInfoOptimizationBase *>::mapping(
+    IO &io, DiagnosticInfoOptimizationBase *&OptDiag) {
+  assert(io.outputting() && "input not yet implemented");
+
+  if (io.mapTag("!Passed", OptDiag->getKind() == DK_OptimizationRemark))
+    ;
+  else if (io.mapTag("!Missed",
+                     OptDiag->getKind() == DK_OptimizationRemarkMissed))
+    ;
+  else if (io.mapTag("!Analysis",
+                     isa<DiagnosticInfoOptimizationRemarkAnalysis>(OptDiag)))
+    ;
+  else if (io.mapTag("!Failure",
+                     OptDiag->getKind() == DK_OptimizationFailure))
+    ;
+  else
+    llvm_unreachable("Unknown remark kind");
+
+  // Failures are reported by helpers such as emitLoopVectorizeWarning and
+  // have no pass name.
+  if (OptDiag->getPassName()) {
+    StringRef PassName = OptDiag->getPassName();
+    io.mapRequired("Pass", PassName);
+  }
+
+  DebugLoc DL = OptDiag->getDebugLoc();
+  if (DL)
+    io.mapRequired("DebugLoc", DL);
+
+  StringRef FN = GlobalValue::getRealLinkageName(
+      OptDiag->getFunction().getName());
+  io.mapRequired("Function", FN);
+
+  Optional<uint64_t> Hotness = OptDiag->getHotness();
+  io.mapOptional("Hotness", Hotness);
+
+  // The message is only formatted here, for the remarks that are written.
+  std::string Msg = OptDiag->getMsg().str();
+  io.mapRequired("Message", Msg);
+}
+
+} // end namespace yaml
+} // end namespace llvm
+
 void DiagnosticInfoMIRParser::print(DiagnosticPrinter &DP) const {
   DP << Diagnostic;
 }
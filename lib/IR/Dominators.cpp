@@ -277,6 +277,11 @@ bool DominatorTree::isReachableFromEntry(const Use &U) const {
   return isReachableFromEntry(I->getParent());
 }
 
+bool DominatorTree::invalidate(Function &F, const PreservedAnalyses &PA) {
+  return !(PA.preserved<DominatorTreeAnalysis>() ||
+           PA.preservedSet<CFGAnalyses>());
+}
+
 void DominatorTree::verifyDomTree() const {
   Function &F = *getRoot()->getParent();
 
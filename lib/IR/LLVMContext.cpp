@@ -204,6 +204,22 @@ void *LLVMContext::getDiagnosticContext() const {
   return pImpl->DiagnosticContext;
 }
 
+yaml::Output *LLVMContext::getDiagnosticsOutputFile() {
+  return pImpl->DiagnosticsOutputFile.get();
+}
+
+void LLVMContext::setDiagnosticsOutputFile(std::unique_ptr<yaml::Output> F) {
+  pImpl->DiagnosticsOutputFile = std::move(F);
+}
+
+void LLVMContext::setDiagnosticsHotnessThreshold(uint64_t Threshold) {
+  pImpl->DiagnosticsHotnessThreshold = Threshold;
+}
+
+uint64_t LLVMContext::getDiagnosticsHotnessThreshold() const {
+  return pImpl->DiagnosticsHotnessThreshold;
+}
+
 void LLVMContext::setYieldCallback(YieldCallbackTy Callback, void *OpaqueHandle)
 {
   pImpl->YieldCallback = Callback;
@@ -251,6 +267,20 @@ LLVMContext::getDiagnosticMessagePrefix(DiagnosticSeverity Severity) {
 }
 
 void LLVMContext::diagnose(const DiagnosticInfo &DI) {
+  if (auto *Remark = dyn_cast<DiagnosticInfoOptimizationBase>(&DI)) {
+    // Drop remarks about cold code before any consumer formats them.
+    uint64_t Threshold = pImpl->DiagnosticsHotnessThreshold;
+    if (Threshold && DI.getSeverity() == DS_Remark &&
+        Remark->getHotness().getValueOr(0) < Threshold)
+      return;
+
+    if (yaml::Output *Out = pImpl->DiagnosticsOutputFile.get())
+      if (Remark->isSerializationEnabled()) {
+        auto *P = const_cast<DiagnosticInfoOptimizationBase *>(Remark);
+        *Out << P;
+      }
+  }
+
   // If there is a report handler, use it.
   if (pImpl->DiagnosticHandler) {
     if (!pImpl->RespectDiagnosticFilters || isDiagnosticEnabled(DI))
@@ -13,6 +13,7 @@
 
 #include "LLVMContextImpl.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Module.h"
@@ -142,19 +143,23 @@ LLVMContextImpl::~LLVMContextImpl() {
 }
 
 void LLVMContextImpl::dropTriviallyDeadConstantArrays() {
-  bool Changed;
-  do {
-    Changed = false;
-
-    for (auto I = ArrayConstants.begin(), E = ArrayConstants.end(); I != E;) {
-      auto *C = *I++;
-      if (C->use_empty()) {
-        Changed = true;
-        C->destroyConstant();
-      }
+  // Scan the arrays once. Destroying an array can only make its operands dead,
+  // so follow those instead of rescanning all the arrays of the context until
+  // nothing changes. This runs after every IRMover::move().
+  SmallSetVector<ConstantArray *, 4> WorkList;
+  for (ConstantArray *C : ArrayConstants)
+    if (C->use_empty())
+      WorkList.insert(C);
+
+  while (!WorkList.empty()) {
+    ConstantArray *C = WorkList.pop_back_val();
+    if (C->use_empty()) {
+      for (const Use &Op : C->operands())
+        if (auto *COp = dyn_cast<ConstantArray>(Op))
+          WorkList.insert(COp);
+      C->destroyConstant();
     }
-
-  } while (Changed);
+  }
 }
 
 void Module::dropTriviallyDeadConstantArrays() {
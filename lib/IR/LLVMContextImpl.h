@@ -33,6 +33,7 @@
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/Support/Dwarf.h"
+#include "llvm/Support/YAMLTraits.h"
 #include <vector>
 
 namespace llvm {
@@ -1043,6 +1044,8 @@ public:
   LLVMContext::DiagnosticHandlerTy DiagnosticHandler;
   void *DiagnosticContext;
   bool RespectDiagnosticFilters;
+  std::unique_ptr<yaml::Output> DiagnosticsOutputFile;
+  uint64_t DiagnosticsHotnessThreshold = 0;
 
   LLVMContext::YieldCallbackTy YieldCallback;
   void *YieldOpaqueHandle;
@@ -1058,6 +1061,8 @@ public:
   FoldingSet<AttributeSetNode> AttrsSetNodes;
 
   StringMap<MDString, BumpPtrAllocator> MDStringCache;
+  MemoryUsageReporter MDStringUsage{"MDString",
+                                    MDStringCache.getAllocator()};
   DenseMap<Value *, ValueAsMetadata *> ValuesAsMetadata;
   DenseMap<Metadata *, MetadataAsValue *> MetadataAsValues;
 
@@ -1113,6 +1118,7 @@ public:
   /// TypeAllocator - All dynamically allocated types are allocated from this.
   /// They live forever until the context is torn down.
   BumpPtrAllocator TypeAllocator;
+  MemoryUsageReporter TypeAllocatorUsage{"LLVMContext types", TypeAllocator};
   
   DenseMap<unsigned, IntegerType*> IntegerTypes;
 
@@ -23,6 +23,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -1505,11 +1506,17 @@ bool FPPassManager::runOnFunction(Function &F) {
   if (F.isDeclaration())
     return false;
 
-  bool Changed = false;
-
   // Collect inherited analysis from Module level pass manager.
   populateInheritedAnalysis(TPM->activeStack);
 
+  return runOnFunctionImpl(F);
+}
+
+bool FPPassManager::runOnFunctionImpl(Function &F) {
+  bool Changed = false;
+
+  TimeTraceScope FunctionScope("OptFunction", F.getName());
+
   for (unsigned Index = 0; Index < getNumContainedPasses(); ++Index) {
     FunctionPass *FP = getContainedPass(Index);
     bool LocalChanged = false;
@@ -1522,6 +1529,7 @@ bool FPPassManager::runOnFunction(Function &F) {
     {
       PassManagerPrettyStackEntry X(FP, F);
       TimeRegion PassTimer(getPassTimer(FP));
+      TimeTraceScope PassScope(FP->getPassName(), F.getName());
 
       LocalChanged |= FP->runOnFunction(F);
     }
@@ -1543,8 +1551,14 @@ bool FPPassManager::runOnFunction(Function &F) {
 bool FPPassManager::runOnModule(Module &M) {
   bool Changed = false;
 
+  // The active pass manager stack does not change while we walk the module,
+  // so the inherited analysis only needs to be collected once rather than
+  // once per function.
+  populateInheritedAnalysis(TPM->activeStack);
+
   for (Function &F : M)
-    Changed |= runOnFunction(F);
+    if (!F.isDeclaration())
+      Changed |= runOnFunctionImpl(F);
 
   return Changed;
 }
@@ -1599,6 +1613,7 @@ MPPassManager::runOnModule(Module &M) {
     {
       PassManagerPrettyStackEntry X(MP, M);
       TimeRegion PassTimer(getPassTimer(MP));
+      TimeTraceScope PassScope(MP->getPassName(), M.getModuleIdentifier());
 
       LocalChanged |= MP->runOnModule(M);
     }
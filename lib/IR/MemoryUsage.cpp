@@ -0,0 +1,322 @@
+//===-- MemoryUsage.cpp - Report the memory used by the IR ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements IRMemoryUsage, which walks a module and its context and
+// adds up the memory used by each kind of object.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/MemoryUsage.h"
+#include "LLVMContextImpl.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+
+using namespace llvm;
+
+/// The size of an instruction object, not counting its operands.
+static size_t getInstructionSize(const Instruction &I) {
+  switch (I.getOpcode()) {
+#define HANDLE_INST(N, OPC, CLASS)                                             \
+  case Instruction::OPC:                                                       \
+    return sizeof(CLASS);
+#include "llvm/IR/Instruction.def"
+  }
+  llvm_unreachable("Unknown instruction");
+}
+
+/// The size of a constant object, not counting its operands, including the
+/// elements that simple arrays and vectors keep out of line.
+static size_t getConstantSize(const Constant &C) {
+  size_t Size;
+  switch (C.getValueID()) {
+  default:
+    llvm_unreachable("Unknown constant");
+#define HANDLE_CONSTANT(Name)                                                  \
+  case Value::Name##Val:                                                       \
+    Size = sizeof(Name);                                                       \
+    break;
+#include "llvm/IR/Value.def"
+  }
+  if (const auto *CDS = dyn_cast<ConstantDataSequential>(&C))
+    Size += CDS->getRawDataValues().size();
+  return Size;
+}
+
+/// The size of a metadata node, including its operands.
+static size_t getMDNodeSize(const MDNode &N) {
+  size_t Size = N.getNumOperands() * sizeof(MDOperand);
+  switch (N.getMetadataID()) {
+  default:
+    llvm_unreachable("Unknown metadata node");
+#define HANDLE_MDNODE_LEAF(CLASS)                                              \
+  case Metadata::CLASS##Kind:                                                  \
+    return Size + sizeof(CLASS);
+#include "llvm/IR/Metadata.def"
+  }
+}
+
+/// The memory used by the buckets of a symbol table and the entries in it.
+static size_t getSymbolTableSize(const ValueSymbolTable &ST) {
+  size_t Size = 0;
+  for (const ValueName &VN : ST)
+    Size += sizeof(ValueName) + VN.getKeyLength() + 1;
+  // A StringMap bucket is a pointer and a full hash, and the map is kept at
+  // most three-quarters full.
+  return Size + ST.size() * 4 / 3 * (sizeof(void *) + sizeof(unsigned));
+}
+
+template <class MapTy> static size_t getStringMapSize(const MapTy &Map) {
+  size_t Size = Map.getNumBuckets() * (sizeof(void *) + sizeof(unsigned));
+  for (const auto &Entry : Map)
+    Size += sizeof(Entry) + Entry.getKeyLength() + 1;
+  return Size;
+}
+
+namespace {
+/// Adds up the values of a module, and the constants they refer to, by kind.
+class ValueWalker {
+  IRMemoryUsage::ValueKinds &Values;
+  SmallPtrSet<const Constant *, 32> VisitedConstants;
+
+  void addUser(ValueUsage &Usage, const User &U, size_t Bytes) {
+    ++Usage.Count;
+    Usage.Bytes += Bytes;
+    Usage.Operands += U.getNumOperands();
+    for (const Use &Op : U.operands())
+      if (const auto *C = dyn_cast<Constant>(Op))
+        if (!isa<GlobalValue>(C) && VisitedConstants.insert(C).second)
+          addUser(Values.Constants, *C, getConstantSize(*C));
+  }
+
+public:
+  ValueWalker(IRMemoryUsage::ValueKinds &Values) : Values(Values) {}
+
+  void addGlobal(const GlobalValue &GV, size_t Bytes) {
+    addUser(Values.GlobalVariables, GV, Bytes);
+  }
+
+  void addFunction(const Function &F) {
+    addUser(Values.Functions, F, sizeof(Function));
+    Values.Arguments.Count += F.arg_size();
+    Values.Arguments.Bytes += F.arg_size() * sizeof(Argument);
+    for (const BasicBlock &BB : F) {
+      ++Values.BasicBlocks.Count;
+      Values.BasicBlocks.Bytes += sizeof(BasicBlock);
+      for (const Instruction &I : BB)
+        addUser(Values.Instructions, I, getInstructionSize(I));
+    }
+  }
+};
+
+class EntryList {
+  SmallVectorImpl<IRMemoryUsage::Entry> &Entries;
+
+public:
+  EntryList(SmallVectorImpl<IRMemoryUsage::Entry> &Entries)
+      : Entries(Entries) {}
+
+  void add(const char *Name, uint64_t Count, uint64_t Bytes) {
+    Entries.push_back({Name, Count, Bytes});
+  }
+
+  /// Add the objects in a uniquing map of constants, and the map itself.
+  template <class MapTy>
+  void addConstants(const char *Name, MapTy &Map, size_t MapSize,
+                    size_t ObjectSize) {
+    uint64_t Count = 0, Bytes = MapSize;
+    for (auto &I : Map) {
+      const Constant *C = getConstant(I);
+      ++Count;
+      Bytes += ObjectSize + C->getNumOperands() * sizeof(Use);
+    }
+    Entries.push_back({Name, Count, Bytes});
+  }
+
+private:
+  template <class T> static const Constant *getConstant(T *C) { return C; }
+  template <class K, class T>
+  static const Constant *getConstant(const detail::DenseMapPair<K, T *> &I) {
+    return I.second;
+  }
+};
+} // end anonymous namespace
+
+IRMemoryUsage::IRMemoryUsage(const llvm::Module &M) {
+  ValueWalker Walker(Values);
+  for (const GlobalVariable &GV : M.globals())
+    Walker.addGlobal(GV, sizeof(GlobalVariable));
+  for (const GlobalAlias &GA : M.aliases())
+    Walker.addGlobal(GA, sizeof(GlobalAlias));
+  for (const GlobalIFunc &GI : M.ifuncs())
+    Walker.addGlobal(GI, sizeof(GlobalIFunc));
+  size_t SymbolTableBytes = getSymbolTableSize(M.getValueSymbolTable());
+  uint64_t NumSymbols = M.getValueSymbolTable().size();
+  for (const Function &F : M) {
+    Walker.addFunction(F);
+    NumSymbols += F.getValueSymbolTable().size();
+    SymbolTableBytes +=
+        sizeof(ValueSymbolTable) + getSymbolTableSize(F.getValueSymbolTable());
+  }
+
+  EntryList ModuleEntries(Module);
+  auto AddWithOperands = [&](const char *Name, const ValueUsage &Usage) {
+    ModuleEntries.add(Name, Usage.Count,
+                      Usage.Bytes + Usage.Operands * sizeof(Use));
+  };
+  AddWithOperands("Functions", Values.Functions);
+  ModuleEntries.add("Arguments", Values.Arguments.Count,
+                    Values.Arguments.Bytes);
+  ModuleEntries.add("Basic blocks", Values.BasicBlocks.Count,
+                    Values.BasicBlocks.Bytes);
+  ModuleEntries.add("Instructions", Values.Instructions.Count,
+                    Values.Instructions.Bytes);
+  ModuleEntries.add("Instruction operands (uses)", Values.Instructions.Operands,
+                    Values.Instructions.Operands * sizeof(Use));
+  AddWithOperands("Global variables and aliases", Values.GlobalVariables);
+  ModuleEntries.add("Value symbol tables", NumSymbols, SymbolTableBytes);
+
+  // Everything else is owned by the context.
+  LLVMContextImpl &C = *M.getContext().pImpl;
+  EntryList ContextEntries(Context);
+
+  ContextEntries.addConstants("Integer constants", C.IntConstants,
+                              C.IntConstants.getMemorySize(),
+                              sizeof(ConstantInt));
+  ContextEntries.addConstants("FP constants", C.FPConstants,
+                              C.FPConstants.getMemorySize(),
+                              sizeof(ConstantFP));
+  ContextEntries.addConstants("Array constants", C.ArrayConstants,
+                              C.ArrayConstants.getMemorySize(),
+                              sizeof(ConstantArray));
+  ContextEntries.addConstants("Struct constants", C.StructConstants,
+                              C.StructConstants.getMemorySize(),
+                              sizeof(ConstantStruct));
+  ContextEntries.addConstants("Vector constants", C.VectorConstants,
+                              C.VectorConstants.getMemorySize(),
+                              sizeof(ConstantVector));
+  ContextEntries.addConstants("Constant expressions", C.ExprConstants,
+                              C.ExprConstants.getMemorySize(),
+                              sizeof(ConstantExpr));
+  ContextEntries.add("Constant data arrays", C.CDSConstants.getNumItems(),
+                     getStringMapSize(C.CDSConstants) +
+                         C.CDSConstants.getNumItems() *
+                             sizeof(ConstantDataArray));
+
+  uint64_t NumOtherConstants = C.CAZConstants.size() +
+                               C.CPNConstants.size() + C.UVConstants.size() +
+                               C.BlockAddresses.size();
+  ContextEntries.add(
+      "Zero, null, undef constants and block addresses", NumOtherConstants,
+      C.CAZConstants.getMemorySize() + C.CPNConstants.getMemorySize() +
+          C.UVConstants.getMemorySize() + C.BlockAddresses.getMemorySize() +
+          C.CAZConstants.size() * sizeof(ConstantAggregateZero) +
+          C.CPNConstants.size() * sizeof(ConstantPointerNull) +
+          C.UVConstants.size() * sizeof(UndefValue) +
+          C.BlockAddresses.size() *
+              (sizeof(BlockAddress) + 2 * sizeof(Use)));
+
+  size_t TypeBytes = C.TypeAllocator.getTotalMemory() +
+                     C.IntegerTypes.getMemorySize() +
+                     C.FunctionTypes.getMemorySize() +
+                     C.AnonStructTypes.getMemorySize() +
+                     getStringMapSize(C.NamedStructTypes) +
+                     C.ArrayTypes.getMemorySize() +
+                     C.VectorTypes.getMemorySize() +
+                     C.PointerTypes.getMemorySize() +
+                     C.ASPointerTypes.getMemorySize();
+  uint64_t NumTypes =
+      C.IntegerTypes.size() + C.FunctionTypes.size() +
+      C.AnonStructTypes.size() + C.NamedStructTypes.getNumItems() +
+      C.ArrayTypes.size() + C.VectorTypes.size() + C.PointerTypes.size() +
+      C.ASPointerTypes.size();
+  ContextEntries.add("Types", NumTypes, TypeBytes);
+
+  ContextEntries.add("Metadata strings", C.MDStringCache.getNumItems(),
+                     C.MDStringCache.getAllocator().getTotalMemory() +
+                         C.MDStringCache.getNumBuckets() *
+                             (sizeof(void *) + sizeof(unsigned)));
+
+  // Report the uniqued nodes of each class separately: debug info is usually
+  // dominated by one or two of them.
+#define HANDLE_MDNODE_LEAF_UNIQUABLE(CLASS)                                    \
+  if (!C.CLASS##s.empty()) {                                                   \
+    uint64_t Bytes = C.CLASS##s.getMemorySize();                               \
+    for (const MDNode *N : C.CLASS##s)                                         \
+      Bytes += getMDNodeSize(*N);                                              \
+    ContextEntries.add("Uniqued " #CLASS " nodes", C.CLASS##s.size(), Bytes);  \
+  }
+#include "llvm/IR/Metadata.def"
+
+  uint64_t DistinctBytes = C.DistinctMDNodes.capacity() * sizeof(MDNode *);
+  for (const MDNode *N : C.DistinctMDNodes)
+    DistinctBytes += getMDNodeSize(*N);
+  ContextEntries.add("Distinct metadata nodes", C.DistinctMDNodes.size(),
+                     DistinctBytes);
+
+  ContextEntries.add(
+      "Values as metadata and back",
+      C.ValuesAsMetadata.size() + C.MetadataAsValues.size(),
+      C.ValuesAsMetadata.getMemorySize() + C.MetadataAsValues.getMemorySize() +
+          C.ValuesAsMetadata.size() * sizeof(ConstantAsMetadata) +
+          C.MetadataAsValues.size() * sizeof(MetadataAsValue));
+
+  uint64_t NumAttachments = 0;
+  size_t AttachmentBytes = C.InstructionMetadata.getMemorySize() +
+                           C.GlobalObjectMetadata.getMemorySize();
+  for (const auto &I : C.InstructionMetadata)
+    NumAttachments += I.second.size();
+  SmallVector<std::pair<unsigned, MDNode *>, 4> GlobalMDs;
+  for (const auto &I : C.GlobalObjectMetadata) {
+    GlobalMDs.clear();
+    I.second.getAll(GlobalMDs);
+    NumAttachments += GlobalMDs.size();
+  }
+  ContextEntries.add("Metadata attachments", NumAttachments, AttachmentBytes);
+
+  ContextEntries.add("Value name map", C.ValueNames.size(),
+                     C.ValueNames.getMemorySize());
+  ContextEntries.add("Value handles", C.ValueHandles.size(),
+                     C.ValueHandles.getMemorySize());
+}
+
+uint64_t IRMemoryUsage::getTotalBytes() const {
+  uint64_t Total = 0;
+  for (const Entry &E : Module)
+    Total += E.Bytes;
+  for (const Entry &E : Context)
+    Total += E.Bytes;
+  return Total;
+}
+
+static void printEntries(raw_ostream &OS, const char *Title,
+                         ArrayRef<IRMemoryUsage::Entry> Entries) {
+  uint64_t Total = 0;
+  OS << "  " << Title << ":\n";
+  for (const IRMemoryUsage::Entry &E : Entries) {
+    OS << format_decimal(E.Count, 12) << format_decimal(E.Bytes, 14) << "  "
+       << E.Name << '\n';
+    Total += E.Bytes;
+  }
+  OS << format_decimal(Total, 26) << "  Total\n\n";
+}
+
+void IRMemoryUsage::print(raw_ostream &OS) const {
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "                            ... IR memory usage ...\n"
+     << "===" << std::string(73, '-') << "===\n\n"
+     << "       Count         Bytes\n";
+  printEntries(OS, "Module", Module);
+  printEntries(OS, "Context", Context);
+  OS << format_decimal(getTotalBytes(), 26) << "  Total\n\n";
+  OS.flush();
+}
@@ -105,3 +105,18 @@ ModuleSummaryIndex::getGlobalValueSummary(uint64_t ValueGUID,
   auto &Summary = SummaryList->second[0];
   return Summary.get();
 }
+
+unsigned
+ModuleSummaryIndex::getFunctionAttrs(GlobalValue::GUID ValueGUID) const {
+  auto SummaryList = findGlobalValueSummaryList(ValueGUID);
+  if (SummaryList == end() || SummaryList->second.empty())
+    return 0;
+  unsigned Attrs = FunctionSummary::AllAttrs;
+  for (auto &Summary : SummaryList->second) {
+    auto *FS = dyn_cast<FunctionSummary>(Summary.get());
+    if (!FS)
+      return 0;
+    Attrs &= FS->attrs();
+  }
+  return Attrs;
+}
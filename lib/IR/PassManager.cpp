@@ -9,10 +9,24 @@
 
 #include "llvm/IR/PassManager.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/IR/LLVMContext.h"
 
 using namespace llvm;
 
+#define DEBUG_TYPE "analysis-manager"
+
+STATISTIC(NumAnalysesRun, "Number of analysis results computed");
+STATISTIC(NumAnalysesInvalidated, "Number of analysis results invalidated");
+STATISTIC(NumAnalysesKept,
+          "Number of analysis results kept across a pass that changed the IR");
+
+char CFGAnalyses::SetID;
+
+void detail::countAnalysisRun() { ++NumAnalysesRun; }
+void detail::countAnalysisInvalidated() { ++NumAnalysesInvalidated; }
+void detail::countAnalysisKept() { ++NumAnalysesKept; }
+
 // Explicit template instantiations for core template typedefs.
 namespace llvm {
 template class PassManager<Module>;
@@ -0,0 +1,227 @@
+//===- PassTimingInfo.cpp - Profiling of the new pass manager -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the -time-passes report of the new pass manager.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/PassTimingInfo.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string> TimePassesJSON(
+    "time-passes-json", cl::value_desc("filename"),
+    cl::desc("With -time-passes, also write the timing report of the new "
+             "pass manager to this file as JSON"));
+
+namespace {
+
+struct PassRecord {
+  PassTimingInfo::Kind K = PassTimingInfo::Kind::Pass;
+  unsigned Runs = 0;
+  unsigned Invalidations = 0;
+  TimeRecord Used;
+  size_t PeakRSSGrowth = 0;
+};
+
+struct PassTimingData {
+  sys::SmartMutex<true> Lock;
+  StringMap<PassRecord> Records;
+
+  ~PassTimingData();
+};
+
+} // end anonymous namespace
+
+static ManagedStatic<PassTimingData> TimingData;
+
+/// The innermost scope that is running on this thread.
+static LLVM_THREAD_LOCAL PassTimingInfo::Scope *CurrentScope;
+
+void PassTimingInfo::Scope::start() {
+  Used = TimeRecord();
+  PeakRSSGrowth = 0;
+  Resumed = TimeRecord::getCurrentTime(/*Start=*/true);
+  ResumedPeakRSS = sys::Process::GetPeakMemoryUsage();
+  Parent = CurrentScope;
+  if (Parent)
+    Parent->pause(Resumed, ResumedPeakRSS);
+  CurrentScope = this;
+}
+
+void PassTimingInfo::Scope::stop() {
+  TimeRecord Now = TimeRecord::getCurrentTime(/*Start=*/false);
+  size_t PeakRSS = sys::Process::GetPeakMemoryUsage();
+  pause(Now, PeakRSS);
+  assert(CurrentScope == this && "Pass timing scopes must nest");
+  CurrentScope = Parent;
+  if (Parent)
+    Parent->resume(Now, PeakRSS);
+
+  PassTimingData &Data = *TimingData;
+  sys::SmartScopedLock<true> Guard(Data.Lock);
+  PassRecord &R = Data.Records[Name];
+  R.K = K;
+  ++R.Runs;
+  R.Used += Used;
+  R.PeakRSSGrowth += PeakRSSGrowth;
+}
+
+void PassTimingInfo::Scope::pause(const TimeRecord &Now, size_t PeakRSS) {
+  TimeRecord Elapsed = Now;
+  Elapsed -= Resumed;
+  Used += Elapsed;
+  if (PeakRSS > ResumedPeakRSS)
+    PeakRSSGrowth += PeakRSS - ResumedPeakRSS;
+}
+
+void PassTimingInfo::Scope::resume(const TimeRecord &Now, size_t PeakRSS) {
+  Resumed = Now;
+  ResumedPeakRSS = PeakRSS;
+}
+
+void PassTimingInfo::recordInvalidationImpl(StringRef AnalysisName) {
+  PassTimingData &Data = *TimingData;
+  sys::SmartScopedLock<true> Guard(Data.Lock);
+  PassRecord &R = Data.Records[AnalysisName];
+  R.K = Kind::Analysis;
+  ++R.Invalidations;
+}
+
+typedef std::pair<StringRef, const PassRecord *> NamedRecord;
+
+/// The records sorted by decreasing wall time, then by name so that the
+/// report is stable.
+static std::vector<NamedRecord> getSortedRecords(PassTimingData &Data) {
+  std::vector<NamedRecord> Sorted;
+  for (const auto &I : Data.Records)
+    Sorted.push_back(NamedRecord(I.getKey(), &I.getValue()));
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const NamedRecord &A, const NamedRecord &B) {
+              if (A.second->Used.getWallTime() != B.second->Used.getWallTime())
+                return A.second->Used.getWallTime() >
+                       B.second->Used.getWallTime();
+              return A.first < B.first;
+            });
+  return Sorted;
+}
+
+static const char *getKindName(PassTimingInfo::Kind K) {
+  return K == PassTimingInfo::Kind::Pass ? "pass" : "analysis";
+}
+
+static void printJSONString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  for (char C : S) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (static_cast<unsigned char>(C) < 0x20)
+      OS << format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+static void printJSONImpl(raw_ostream &OS, PassTimingData &Data) {
+  OS << "{\n  \"peak_rss_bytes\": " << sys::Process::GetPeakMemoryUsage()
+     << ",\n  \"passes\": [";
+  bool First = true;
+  for (const NamedRecord &NR : getSortedRecords(Data)) {
+    const PassRecord &R = *NR.second;
+    OS << (First ? "\n" : ",\n") << "    {\"name\": ";
+    printJSONString(OS, NR.first);
+    OS << ", \"kind\": \"" << getKindName(R.K) << "\", \"runs\": " << R.Runs
+       << ", \"invalidations\": " << R.Invalidations
+       << format(", \"wall_seconds\": %.6f, \"user_seconds\": %.6f, "
+                 "\"system_seconds\": %.6f",
+                 R.Used.getWallTime(), R.Used.getUserTime(),
+                 R.Used.getSystemTime())
+       << ", \"malloc_bytes\": " << static_cast<int64_t>(R.Used.getMemUsed())
+       << ", \"peak_rss_growth_bytes\": " << R.PeakRSSGrowth << "}";
+    First = false;
+  }
+  OS << "\n  ]\n}\n";
+}
+
+void PassTimingInfo::printJSON(raw_ostream &OS) {
+  PassTimingData &Data = *TimingData;
+  sys::SmartScopedLock<true> Guard(Data.Lock);
+  printJSONImpl(OS, Data);
+}
+
+static void reportImpl(PassTimingData &Data) {
+  if (Data.Records.empty())
+    return;
+
+  TimeRecord Total;
+  for (const auto &I : Data.Records)
+    Total += I.getValue().Used;
+
+  std::unique_ptr<raw_fd_ostream> OutStream = CreateInfoOutputFile();
+  raw_ostream &OS = *OutStream;
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "      ... Pass execution timing report (new pass manager) ...\n"
+     << "===" << std::string(73, '-') << "===\n";
+  OS << format("  Total Execution Time: %.4f seconds (%.4f wall clock)\n",
+               Total.getProcessTime(), Total.getWallTime());
+  OS << format("  Peak resident set size: %.1f MB\n\n",
+               sys::Process::GetPeakMemoryUsage() / (1024.0 * 1024.0));
+  OS << "   --Wall Time--   --User Time--  --Sys Time--  --Malloc KB--"
+        "  --RSS KB--   Runs  Inval  Name\n";
+  double TotalWall = Total.getWallTime();
+  for (const NamedRecord &NR : getSortedRecords(Data)) {
+    const PassRecord &R = *NR.second;
+    double Wall = R.Used.getWallTime();
+    OS << format("  %8.4f (%5.1f%%)  %8.4f       %8.4f", Wall,
+                 TotalWall > 0 ? Wall * 100 / TotalWall : 0.0,
+                 R.Used.getUserTime(), R.Used.getSystemTime())
+       << format("  %12lld  %10llu  %5u  %5u  ",
+                 static_cast<long long>(R.Used.getMemUsed() / 1024),
+                 static_cast<unsigned long long>(R.PeakRSSGrowth / 1024),
+                 R.Runs, R.Invalidations)
+       << (R.K == PassTimingInfo::Kind::Analysis ? "Analysis: " : "")
+       << NR.first << "\n";
+  }
+  OS << "\n";
+  OS.flush();
+
+  if (!TimePassesJSON.empty()) {
+    std::error_code EC;
+    raw_fd_ostream JSONOS(TimePassesJSON, EC, sys::fs::F_Text);
+    if (EC)
+      errs() << "warning: could not open " << TimePassesJSON << ": "
+             << EC.message() << "\n";
+    else
+      printJSONImpl(JSONOS, Data);
+  }
+
+  Data.Records.clear();
+}
+
+void PassTimingInfo::report() {
+  PassTimingData &Data = *TimingData;
+  sys::SmartScopedLock<true> Guard(Data.Lock);
+  reportImpl(Data);
+}
+
+// Print whatever was not reported yet when the process shuts down.
+PassTimingData::~PassTimingData() { reportImpl(*this); }
@@ -71,16 +71,42 @@
 #include "llvm/IR/ModuleSlotTracker.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/Statepoint.h"
+#include "llvm/IR/TypeFinder.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdarg>
 using namespace llvm;
 
 static cl::opt<bool> VerifyDebugInfo("verify-debug-info", cl::init(true));
+static cl::opt<bool>
+    VerifyInParallel("verify-in-parallel", cl::init(false), cl::Hidden,
+                     cl::desc("Verify the functions of a module on several "
+                              "threads in the new pass manager"));
+
+/// Serializes the few context updates that reporting a failed check needs, as
+/// verifyModuleInParallel may report failures from several threads.
+static ManagedStatic<sys::SmartMutex<true>> ReportLock;
+
+/// verifyModuleInParallel splits the functions into about this many ranges
+/// per thread, to balance uneven functions without a task per function.
+static const unsigned VerifyTasksPerThread = 4;
+
+namespace llvm {
+/// What verifying a function body finds that the module-level checks need.
+struct VerifierFunctionState {
+  bool BrokenDebugInfo = false;
+  SmallVector<const Metadata *, 1> CUVisited;
+  SmallVector<std::pair<Function *, std::pair<unsigned, unsigned>>, 1>
+      FrameEscapeInfo;
+};
+} // end namespace llvm
 
 namespace {
 struct VerifierSupport {
@@ -271,6 +297,36 @@ public:
 
   bool hasBrokenDebugInfo() const { return BrokenDebugInfo; }
 
+  /// Fold the per-function state that \p Other gathered while verifying other
+  /// functions of the same module into this verifier, so that a following
+  /// verify(M) checks them as if this verifier had visited them itself.
+  void mergeFunctionState(const Verifier &Other) {
+    MDNodes.insert(Other.MDNodes.begin(), Other.MDNodes.end());
+    mergeFunctionState(Other.getFunctionState());
+  }
+
+  /// Fold the state of \p S into this verifier, as above. The metadata nodes
+  /// that were checked aren't part of it, so a following verify(M) may check
+  /// some of them again.
+  void mergeFunctionState(const VerifierFunctionState &S) {
+    BrokenDebugInfo |= S.BrokenDebugInfo;
+    CUVisited.insert(S.CUVisited.begin(), S.CUVisited.end());
+    for (const auto &Counts : S.FrameEscapeInfo) {
+      auto &Entry = FrameEscapeInfo[Counts.first];
+      Entry.first = std::max(Entry.first, Counts.second.first);
+      Entry.second = std::max(Entry.second, Counts.second.second);
+    }
+  }
+
+  /// Return the state the functions verified so far leave for verify(M).
+  VerifierFunctionState getFunctionState() const {
+    VerifierFunctionState S;
+    S.BrokenDebugInfo = BrokenDebugInfo;
+    S.CUVisited.append(CUVisited.begin(), CUVisited.end());
+    S.FrameEscapeInfo.append(FrameEscapeInfo.begin(), FrameEscapeInfo.end());
+    return S;
+  }
+
   bool verify(const Function &F) {
     updateModule(F.getParent());
     Context = &M->getContext();
@@ -1388,12 +1444,19 @@ void Verifier::verifyParameterAttrs(AttributeSet Attrs, unsigned Idx, Type *Ty,
          "'noinline and alwaysinline' are incompatible!",
          V);
 
-  Assert(!AttrBuilder(Attrs, Idx)
-              .overlaps(AttributeFuncs::typeIncompatible(Ty)),
-         "Wrong types for attribute: " +
-         AttributeSet::get(*Context, Idx,
-                        AttributeFuncs::typeIncompatible(Ty)).getAsString(Idx),
-         V);
+  if (AttrBuilder(Attrs, Idx).overlaps(AttributeFuncs::typeIncompatible(Ty))) {
+    // Printing the incompatible attributes uniques an AttributeSet in the
+    // context.
+    std::string Incompatible;
+    {
+      sys::SmartScopedLock<true> Lock(*ReportLock);
+      Incompatible = AttributeSet::get(*Context, Idx,
+                                       AttributeFuncs::typeIncompatible(Ty))
+                         .getAsString(Idx);
+    }
+    CheckFailed("Wrong types for attribute: " + Incompatible, V);
+    return;
+  }
 
   if (PointerType *PTy = dyn_cast<PointerType>(Ty)) {
     SmallPtrSet<Type*, 4> Visited;
@@ -4286,6 +4349,90 @@ bool llvm::verifyModule(const Module &M, raw_ostream *OS,
   return Broken;
 }
 
+/// Match the type of the intrinsic declaration \p F against its description
+/// in the same order visitIntrinsicCallSite does, which creates in the context
+/// every type that matching the calls of \p F will look up.
+static void matchIntrinsicSignature(const Function &F) {
+  SmallVector<Intrinsic::IITDescriptor, 8> Table;
+  getIntrinsicInfoTableEntries(F.getIntrinsicID(), Table);
+  ArrayRef<Intrinsic::IITDescriptor> TableRef = Table;
+
+  FunctionType *FTy = F.getFunctionType();
+  SmallVector<Type *, 4> ArgTys;
+  if (Intrinsic::matchIntrinsicType(FTy->getReturnType(), TableRef, ArgTys))
+    return;
+  for (Type *ParamTy : FTy->params())
+    if (Intrinsic::matchIntrinsicType(ParamTy, TableRef, ArgTys))
+      return;
+}
+
+bool llvm::verifyModuleInParallel(const Module &M, raw_ostream *OS,
+                                  bool *BrokenDebugInfo) {
+  SmallVector<const Function *, 64> Functions;
+  for (const Function &F : M)
+    Functions.push_back(&F);
+  unsigned Threads = parallel::getThreadCount();
+  size_t TaskSize = std::max<size_t>(
+      1, Functions.size() / (size_t(Threads) * VerifyTasksPerThread));
+  if (Threads == 1 || TaskSize == Functions.size())
+    return verifyModule(M, OS, BrokenDebugInfo);
+
+  // Create up front what the function verifiers would otherwise create or
+  // cache lazily in shared objects: the arguments of the functions, the types
+  // that matching the intrinsic signatures builds, the none token and the
+  // sizedness of the struct types.
+  for (const Function *F : Functions) {
+    (void)F->arg_begin();
+    if (F->getIntrinsicID() != Intrinsic::not_intrinsic)
+      matchIntrinsicSignature(*F);
+  }
+  (void)ConstantTokenNone::get(M.getContext());
+  TypeFinder StructTypes;
+  StructTypes.run(M, /*onlyNamed=*/false);
+  for (StructType *STy : StructTypes)
+    (void)STy->isSized();
+
+  // Each task verifies a range of functions with its own verifier and prints
+  // into its own buffer, which are then combined in the order of the module.
+  struct Task {
+    std::unique_ptr<Verifier> V;
+    std::string Output;
+    bool Broken = false;
+  };
+  std::vector<Task> Tasks((Functions.size() + TaskSize - 1) / TaskSize);
+  {
+    ThreadPoolTaskGroup TG(parallel::getDefaultPool());
+    for (size_t I = 0, E = Tasks.size(); I != E; ++I)
+      TG.async([&, I] {
+        Task &T = Tasks[I];
+        raw_string_ostream TaskOS(T.Output);
+        T.V = llvm::make_unique<Verifier>(
+            OS ? &TaskOS : nullptr,
+            /*ShouldTreatBrokenDebugInfoAsError=*/!BrokenDebugInfo);
+        ArrayRef<const Function *> Range = makeArrayRef(Functions).slice(
+            I * TaskSize, std::min(TaskSize, Functions.size() - I * TaskSize));
+        for (const Function *F : Range)
+          T.Broken |= !T.V->verify(*F);
+        TaskOS.flush();
+      });
+    TG.wait();
+  }
+
+  Verifier V(OS, /*ShouldTreatBrokenDebugInfoAsError=*/!BrokenDebugInfo);
+  bool Broken = false;
+  for (Task &T : Tasks) {
+    if (OS)
+      *OS << T.Output;
+    Broken |= T.Broken;
+    V.mergeFunctionState(*T.V);
+  }
+
+  Broken |= !V.verify(M);
+  if (BrokenDebugInfo)
+    *BrokenDebugInfo = V.hasBrokenDebugInfo();
+  return Broken;
+}
+
 namespace {
 struct VerifierLegacyPass : public FunctionPass {
   static char ID;
@@ -4352,17 +4499,50 @@ char VerifierAnalysis::PassID;
 VerifierAnalysis::Result VerifierAnalysis::run(Module &M,
                                                ModuleAnalysisManager &) {
   Result Res;
-  Res.IRBroken = llvm::verifyModule(M, &dbgs(), &Res.DebugInfoBroken);
+  if (VerifyInParallel)
+    Res.IRBroken =
+        llvm::verifyModuleInParallel(M, &dbgs(), &Res.DebugInfoBroken);
+  else
+    Res.IRBroken = llvm::verifyModule(M, &dbgs(), &Res.DebugInfoBroken);
   return Res;
 }
 
 VerifierAnalysis::Result VerifierAnalysis::run(Function &F,
                                                FunctionAnalysisManager &) {
-  return { llvm::verifyFunction(F, &dbgs()), false };
+  Verifier V(&dbgs(), /*ShouldTreatBrokenDebugInfoAsError=*/false);
+  Result Res;
+  Res.IRBroken = !V.verify(F);
+  Res.DebugInfoBroken = V.hasBrokenDebugInfo();
+  Res.FunctionState =
+      std::make_shared<VerifierFunctionState>(V.getFunctionState());
+  return Res;
+}
+
+/// Verify \p M reusing the function results that \p AM still has cached, and
+/// merging the state they recorded for the module phase.
+static VerifierAnalysis::Result verifyModuleIncrementally(
+    Module &M, ModuleAnalysisManager &AM) {
+  auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  VerifierAnalysis::Result Res;
+  Verifier V(&dbgs(), /*ShouldTreatBrokenDebugInfoAsError=*/false);
+  for (Function &F : M) {
+    if (F.isDeclaration()) {
+      Res.IRBroken |= !V.verify(F);
+      continue;
+    }
+    auto &FRes = FAM.getResult<VerifierAnalysis>(F);
+    Res.IRBroken |= FRes.IRBroken;
+    V.mergeFunctionState(*FRes.FunctionState);
+  }
+
+  Res.IRBroken |= !V.verify(M);
+  Res.DebugInfoBroken = V.hasBrokenDebugInfo();
+  return Res;
 }
 
 PreservedAnalyses VerifierPass::run(Module &M, ModuleAnalysisManager &AM) {
-  auto Res = AM.getResult<VerifierAnalysis>(M);
+  auto Res = Incremental ? verifyModuleIncrementally(M, AM)
+                         : AM.getResult<VerifierAnalysis>(M);
   if (FatalErrors) {
     if (Res.IRBroken)
       report_fatal_error("Broken module found, compilation aborted!");
@@ -4380,8 +4560,8 @@ PreservedAnalyses VerifierPass::run(Module &M, ModuleAnalysisManager &AM) {
 }
 
 PreservedAnalyses VerifierPass::run(Function &F, FunctionAnalysisManager &AM) {
-  auto res = AM.getResult<VerifierAnalysis>(F);
-  if (res.IRBroken && FatalErrors)
+  auto &Res = AM.getResult<VerifierAnalysis>(F);
+  if ((Res.IRBroken || Res.DebugInfoBroken) && FatalErrors)
     report_fatal_error("Broken function found, compilation aborted!");
 
   return PreservedAnalyses::all();
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/LTO/LTO.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
@@ -130,4 +131,143 @@ void thinLTOInternalizeAndPromoteInIndex(
   for (auto &I : Index)
     thinLTOInternalizeAndPromoteGUID(I.second, I.first, isExported);
 }
+
+namespace {
+/// A function of the combined index, during the propagation of the function
+/// attributes.
+struct FunctionAttrsNode {
+  /// The attributes known to hold whatever the callees do.
+  unsigned KnownAttrs = FunctionSummary::AllAttrs;
+  /// The attributes that hold if the callees have them too.
+  unsigned CandidateAttrs = FunctionSummary::AllAttrs;
+  /// The current attributes, only ever decreasing towards the result.
+  unsigned Attrs = 0;
+  /// Whether the definition that prevails may not be one of the summaries.
+  bool Interposable = false;
+  /// Whether the function is on the worklist.
+  bool Queued = false;
+  /// The number of callees not known to be norecurse yet.
+  unsigned PendingCallees = 0;
+  std::vector<unsigned> Callees;
+  std::vector<unsigned> Callers;
+};
+} // end anonymous namespace
+
+// Infer the function attributes bottom-up on the call graph of the index. The
+// memory and unwind attributes are a greatest fixpoint: the functions of a
+// cycle are assumed to have them until a function of the cycle or one of their
+// callees is found not to, like FunctionAttrs does for an SCC. A function is
+// norecurse only if all its callees are and it is not on a cycle.
+void thinLTOPropagateFunctionAttrsInIndex(ModuleSummaryIndex &Index) {
+  const unsigned MemoryAttrs = FunctionSummary::ReadNone |
+                               FunctionSummary::ReadOnly |
+                               FunctionSummary::NoUnwind;
+
+  std::vector<FunctionAttrsNode> Nodes;
+  DenseMap<GlobalValue::GUID, unsigned> NodeIds;
+  for (auto &I : Index) {
+    bool IsFunction = !I.second.empty();
+    for (auto &S : I.second)
+      IsFunction &= isa<FunctionSummary>(S.get());
+    if (!IsFunction)
+      continue;
+    NodeIds[I.first] = Nodes.size();
+    Nodes.emplace_back();
+  }
+
+  // Combine the copies of each function. They all have to agree: which of the
+  // ODR copies prevails isn't known yet.
+  for (auto &I : Index) {
+    auto NodeId = NodeIds.find(I.first);
+    if (NodeId == NodeIds.end())
+      continue;
+    FunctionAttrsNode &Node = Nodes[NodeId->second];
+    for (auto &S : I.second) {
+      auto *FS = cast<FunctionSummary>(S.get());
+      FunctionSummary::FFlags FunFlags = FS->fflags();
+      Node.KnownAttrs &= FunFlags.Attrs;
+      Node.CandidateAttrs &= FunFlags.BodyAttrs;
+      Node.Interposable |= GlobalValue::isInterposableLinkage(FS->linkage());
+      for (auto &Call : FS->calls()) {
+        auto CalleeId = NodeIds.find(Call.first.getGUID());
+        if (CalleeId == NodeIds.end())
+          // The callee is only declared in that module: rely on its
+          // declaration.
+          Node.CandidateAttrs &= FunFlags.DeclCalleeAttrs;
+        else
+          Node.Callees.push_back(CalleeId->second);
+      }
+    }
+    std::sort(Node.Callees.begin(), Node.Callees.end());
+    Node.Callees.erase(std::unique(Node.Callees.begin(), Node.Callees.end()),
+                       Node.Callees.end());
+    // Nothing is inferred for a definition that may be replaced.
+    if (Node.Interposable)
+      Node.CandidateAttrs = 0;
+    Node.CandidateAttrs |= Node.KnownAttrs;
+  }
+  for (unsigned Id = 0, E = Nodes.size(); Id != E; ++Id)
+    for (unsigned Callee : Nodes[Id].Callees)
+      Nodes[Callee].Callers.push_back(Id);
+
+  // Start from the optimistic memory and unwind attributes and remove the ones
+  // that a callee doesn't have until nothing changes.
+  std::vector<unsigned> Worklist;
+  for (unsigned Id = 0, E = Nodes.size(); Id != E; ++Id) {
+    Nodes[Id].Attrs = Nodes[Id].CandidateAttrs & MemoryAttrs;
+    Nodes[Id].Queued = true;
+    Worklist.push_back(Id);
+  }
+  while (!Worklist.empty()) {
+    FunctionAttrsNode &Node = Nodes[Worklist.back()];
+    Worklist.pop_back();
+    Node.Queued = false;
+    unsigned Attrs = Node.CandidateAttrs & MemoryAttrs;
+    for (unsigned Callee : Node.Callees)
+      Attrs &= Nodes[Callee].Attrs;
+    Attrs |= Node.KnownAttrs & MemoryAttrs;
+    if (Attrs == Node.Attrs)
+      continue;
+    Node.Attrs = Attrs;
+    for (unsigned Caller : Node.Callers)
+      if (!Nodes[Caller].Queued) {
+        Nodes[Caller].Queued = true;
+        Worklist.push_back(Caller);
+      }
+  }
+
+  // A function is norecurse once all its callees are. The functions of a
+  // cycle never get there.
+  for (unsigned Id = 0, E = Nodes.size(); Id != E; ++Id) {
+    FunctionAttrsNode &Node = Nodes[Id];
+    Node.PendingCallees = Node.Callees.size();
+    if ((Node.KnownAttrs & FunctionSummary::NoRecurse) ||
+        ((Node.CandidateAttrs & FunctionSummary::NoRecurse) &&
+         Node.Callees.empty())) {
+      Node.Attrs |= FunctionSummary::NoRecurse;
+      Worklist.push_back(Id);
+    }
+  }
+  while (!Worklist.empty()) {
+    FunctionAttrsNode &Node = Nodes[Worklist.back()];
+    Worklist.pop_back();
+    for (unsigned Caller : Node.Callers) {
+      FunctionAttrsNode &CallerNode = Nodes[Caller];
+      if (--CallerNode.PendingCallees == 0 &&
+          (CallerNode.CandidateAttrs & FunctionSummary::NoRecurse) &&
+          !(CallerNode.Attrs & FunctionSummary::NoRecurse)) {
+        CallerNode.Attrs |= FunctionSummary::NoRecurse;
+        Worklist.push_back(Caller);
+      }
+    }
+  }
+
+  for (auto &I : Index) {
+    auto NodeId = NodeIds.find(I.first);
+    if (NodeId == NodeIds.end())
+      continue;
+    for (auto &S : I.second)
+      cast<FunctionSummary>(S.get())->setAttrs(Nodes[NodeId->second].Attrs);
+  }
+}
 }
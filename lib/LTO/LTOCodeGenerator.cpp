@@ -313,6 +313,39 @@ LTOCodeGenerator::compile(bool DisableVerify, bool DisableInline,
   return compileOptimized();
 }
 
+std::vector<std::unique_ptr<MemoryBuffer>>
+LTOCodeGenerator::compileOptimizedParallel(unsigned ParallelismLevel) {
+  ParallelismLevel = std::max(ParallelismLevel, 1u);
+
+  std::vector<SmallString<0>> Buffers(ParallelismLevel);
+  std::vector<std::unique_ptr<raw_svector_ostream>> Streams;
+  std::vector<raw_pwrite_stream *> Out;
+  for (SmallString<0> &Buffer : Buffers) {
+    Streams.push_back(llvm::make_unique<raw_svector_ostream>(Buffer));
+    Out.push_back(Streams.back().get());
+  }
+
+  std::vector<std::unique_ptr<MemoryBuffer>> Objects;
+  if (!compileOptimized(Out))
+    return Objects;
+
+  for (const SmallString<0> &Buffer : Buffers)
+    Objects.push_back(MemoryBuffer::getMemBufferCopy(Buffer, "lto-object"));
+  return Objects;
+}
+
+std::vector<std::unique_ptr<MemoryBuffer>>
+LTOCodeGenerator::compileParallel(unsigned ParallelismLevel,
+                                  bool DisableVerify, bool DisableInline,
+                                  bool DisableGVNLoadPRE,
+                                  bool DisableVectorization) {
+  if (!optimize(DisableVerify, DisableInline, DisableGVNLoadPRE,
+                DisableVectorization))
+    return {};
+
+  return compileOptimizedParallel(ParallelismLevel);
+}
+
 bool LTOCodeGenerator::determineTarget() {
   if (TargetMach)
     return true;
@@ -554,6 +587,12 @@ bool LTOCodeGenerator::optimize(bool DisableVerify, bool DisableInline,
 }
 
 bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_pwrite_stream *> Out) {
+  // Parallel code generation consumes the merged module.
+  if (!MergedModule) {
+    emitError("merged module has already been split for code generation");
+    return false;
+  }
+
   if (!this->determineTarget())
     return false;
 
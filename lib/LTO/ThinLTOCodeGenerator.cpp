@@ -42,6 +42,7 @@
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/FunctionImport.h"
@@ -151,6 +152,10 @@ crossImportIntoModule(Module &TheModule, const ModuleSummaryIndex &Index,
   ModuleLoader Loader(TheModule.getContext(), ModuleMap);
   FunctionImporter Importer(Index, Loader);
   Importer.importFunctions(TheModule, ImportList);
+
+  // Apply the function attributes computed during the thin-link, to the
+  // imported functions and the declarations as well.
+  thinLTOApplyFunctionAttrsModule(TheModule, Index);
 }
 
 static void optimizeModule(Module &TheModule, TargetMachine &TM) {
@@ -229,16 +234,35 @@ public:
       const FunctionImporter::ExportSetTy &ExportList,
       const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
       const GVSummaryMapTy &DefinedFunctions,
-      const DenseSet<GlobalValue::GUID> &PreservedSymbols) {
+      const DenseSet<GlobalValue::GUID> &PreservedSymbols,
+      const TargetMachineBuilder &TMBuilder, bool DisableCodeGen) {
     if (CachePath.empty())
       return;
 
     // Compute the unique hash for this entry
     // This is based on the current compiler version, the module itself, the
-    // export list, the hash for every single module in the import list, the
-    // list of ResolvedODR for the module, and the list of preserved symbols.
+    // export list, the exact set of functions imported from every module
+    // along with that module's hash, the list of ResolvedODR for the module,
+    // the list of preserved symbols, and the code generation options.
+    //
+    // The import and export sets are unordered containers; hash them in a
+    // canonical order so that the key only changes when their contents do.
 
     SHA1 Hasher;
+    auto AddUint64 = [&](uint64_t I) {
+      uint8_t Data[8];
+      for (unsigned N = 0; N < 8; ++N)
+        Data[N] = I >> (N * 8);
+      Hasher.update(ArrayRef<uint8_t>(Data));
+    };
+    auto AddString = [&](StringRef Str) {
+      AddUint64(Str.size());
+      Hasher.update(Str);
+    };
+    auto AddModuleHash = [&](StringRef ID) {
+      auto ModHash = Index.getModuleHash(ID);
+      Hasher.update(ArrayRef<uint8_t>((uint8_t *)&ModHash[0], sizeof(ModHash)));
+    };
 
     // Start with the compiler revision
     Hasher.update(LLVM_VERSION_STRING);
@@ -246,33 +270,83 @@ public:
     Hasher.update(LLVM_REVISION);
 #endif
 
+    // The code generation options change the produced object.
+    AddString(TMBuilder.TheTriple.str());
+    AddString(TMBuilder.MCpu);
+    AddString(TMBuilder.MAttr);
+    AddUint64(TMBuilder.CGOptLevel);
+    AddUint64(TMBuilder.RelocModel.hasValue() ? *TMBuilder.RelocModel + 1 : 0);
+    AddUint64(DisableCodeGen);
+
     // Include the hash for the current module
-    auto ModHash = Index.getModuleHash(ModuleID);
-    Hasher.update(ArrayRef<uint8_t>((uint8_t *)&ModHash[0], sizeof(ModHash)));
-    for (auto F : ExportList)
-      // The export list can impact the internalization, be conservative here
-      Hasher.update(ArrayRef<uint8_t>((uint8_t *)&F, sizeof(F)));
-
-    // Include the hash for every module we import functions from
-    for (auto &Entry : ImportList) {
-      auto ModHash = Index.getModuleHash(Entry.first());
-      Hasher.update(ArrayRef<uint8_t>((uint8_t *)&ModHash[0], sizeof(ModHash)));
+    AddModuleHash(ModuleID);
+
+    // The export list can impact the internalization, be conservative here
+    std::vector<GlobalValue::GUID> Exports(ExportList.begin(),
+                                           ExportList.end());
+    std::sort(Exports.begin(), Exports.end());
+    AddUint64(Exports.size());
+    for (auto F : Exports)
+      AddUint64(F);
+
+    // Include the hash for every module we import functions from, and the
+    // functions we import from it: a different import decision produces a
+    // different module even if no input changed.
+    std::vector<StringRef> ImportModules;
+    for (auto &Entry : ImportList)
+      ImportModules.push_back(Entry.first());
+    std::sort(ImportModules.begin(), ImportModules.end());
+    for (StringRef ImportModule : ImportModules) {
+      AddModuleHash(ImportModule);
+      const auto &Functions = ImportList.find(ImportModule)->second;
+      AddUint64(Functions.size());
+      // FunctionsToImportTy is a std::map, already sorted by GUID.
+      for (auto &F : Functions)
+        AddUint64(F.first);
+    }
+
+    // Include the function attributes computed during the thin-link for the
+    // functions defined and imported, and for their callees: they depend on
+    // modules that are not otherwise part of the hash.
+    std::vector<GlobalValue::GUID> AttrGUIDs;
+    auto AddFunctionAndCallees = [&](GlobalValue::GUID GUID,
+                                     const GlobalValueSummary *Summary) {
+      AttrGUIDs.push_back(GUID);
+      if (auto *FS = dyn_cast_or_null<FunctionSummary>(Summary))
+        for (auto &Call : FS->calls())
+          AttrGUIDs.push_back(Call.first.getGUID());
+    };
+    for (auto &Def : DefinedFunctions)
+      AddFunctionAndCallees(Def.first, Def.second);
+    for (auto &Entry : ImportList)
+      for (auto &F : Entry.second)
+        AddFunctionAndCallees(F.first,
+                              Index.findSummaryInModule(F.first, Entry.first()));
+    std::sort(AttrGUIDs.begin(), AttrGUIDs.end());
+    AttrGUIDs.erase(std::unique(AttrGUIDs.begin(), AttrGUIDs.end()),
+                    AttrGUIDs.end());
+    for (auto GUID : AttrGUIDs) {
+      if (unsigned Attrs = Index.getFunctionAttrs(GUID)) {
+        AddUint64(GUID);
+        AddUint64(Attrs);
+      }
     }
 
     // Include the hash for the resolved ODR.
     for (auto &Entry : ResolvedODR) {
-      Hasher.update(ArrayRef<uint8_t>((const uint8_t *)&Entry.first,
-                                      sizeof(GlobalValue::GUID)));
-      Hasher.update(ArrayRef<uint8_t>((const uint8_t *)&Entry.second,
-                                      sizeof(GlobalValue::LinkageTypes)));
+      AddUint64(Entry.first);
+      AddUint64(Entry.second);
     }
 
     // Include the hash for the preserved symbols.
-    for (auto &Entry : PreservedSymbols) {
+    std::vector<GlobalValue::GUID> Preserved;
+    for (auto &Entry : PreservedSymbols)
       if (DefinedFunctions.count(Entry))
-        Hasher.update(
-            ArrayRef<uint8_t>((const uint8_t *)&Entry, sizeof(GlobalValue::GUID)));
-    }
+        Preserved.push_back(Entry);
+    std::sort(Preserved.begin(), Preserved.end());
+    AddUint64(Preserved.size());
+    for (auto GUID : Preserved)
+      AddUint64(GUID);
 
     sys::path::append(EntryPath, CachePath, toHex(Hasher.result()));
   }
@@ -516,6 +590,10 @@ std::unique_ptr<ModuleSummaryIndex> ThinLTOCodeGenerator::linkCombinedIndex() {
       CombinedIndex = std::move(Index);
     }
   }
+  // Infer the function attributes across modules while the index still has
+  // every call edge.
+  if (CombinedIndex)
+    thinLTOPropagateFunctionAttrsInIndex(*CombinedIndex);
   return CombinedIndex;
 }
 
@@ -680,6 +758,43 @@ std::unique_ptr<MemoryBuffer> ThinLTOCodeGenerator::codegen(Module &TheModule) {
   return codegenModule(TheModule, *TMBuilder.create());
 }
 
+/**
+ * Perform a complete ThinLTO backend using an individual index.
+ */
+std::unique_ptr<MemoryBuffer>
+ThinLTOCodeGenerator::distributedBackend(Module &TheModule,
+                                         ModuleSummaryIndex &Index) {
+  initTMBuilder(TMBuilder, Triple(TheModule.getTargetTriple()));
+  auto ModuleMap = generateModuleMap(Modules);
+  auto ModuleIdentifier = TheModule.getModuleIdentifier();
+
+  // The individual index contains the summaries of this module and of the
+  // globals it imports, so computing the import list from it gives back the
+  // decisions made during the thin-link.
+  FunctionImporter::ImportMapTy ImportList;
+  ComputeCrossModuleImportForModule(ModuleIdentifier, Index, ImportList);
+
+  StringMap<GVSummaryMapTy> ModuleToDefinedGVSummaries;
+  Index.collectDefinedGVSummariesPerModule(ModuleToDefinedGVSummaries);
+
+  // Other modules may import from this one even if it doesn't import anything
+  // itself: unlike the in-process backend, always promote. Internalization
+  // requires the export lists of the combined index and is skipped.
+  promoteModule(TheModule, Index);
+  thinLTOResolveWeakForLinkerModule(
+      TheModule, ModuleToDefinedGVSummaries[ModuleIdentifier]);
+  saveTempBitcode(TheModule, SaveTempsDir, 0, ".1.promoted.bc");
+
+  crossImportIntoModule(TheModule, Index, ModuleMap, ImportList);
+  saveTempBitcode(TheModule, SaveTempsDir, 0, ".3.imported.bc");
+
+  auto TM = TMBuilder.create();
+  optimizeModule(TheModule, *TM);
+  saveTempBitcode(TheModule, SaveTempsDir, 0, ".4.opt.bc");
+
+  return codegenModule(TheModule, *TM);
+}
+
 // Main entry point for the ThinLTO processing
 void ThinLTOCodeGenerator::run() {
   if (CodeGenOnly) {
@@ -704,6 +819,23 @@ void ThinLTOCodeGenerator::run() {
     return;
   }
 
+  auto PruneCache = [this]() {
+    CachePruning(CacheOptions.Path)
+        .setPruningInterval(CacheOptions.PruningInterval)
+        .setEntryExpiration(CacheOptions.Expiration)
+        .setMaxSize(CacheOptions.MaxPercentageOfAvailableSpace)
+        .setMaxSizeBytes(CacheOptions.MaxSizeBytes)
+        .prune();
+  };
+
+  // Pruning concurrently with the threads below can at worst remove an entry
+  // that would have been a hit, or one that was just written.
+  std::unique_ptr<ThreadPool> PruningPool;
+  if (CacheOptions.PruneInBackground) {
+    PruningPool = llvm::make_unique<ThreadPool>(1);
+    PruningPool->async(PruneCache);
+  }
+
   // Sequential linking phase
   auto Index = linkCombinedIndex();
 
@@ -730,17 +862,21 @@ void ThinLTOCodeGenerator::run() {
   StringMap<GVSummaryMapTy> ModuleToDefinedGVSummaries(ModuleCount);
   Index->collectDefinedGVSummariesPerModule(ModuleToDefinedGVSummaries);
 
+  // Convert the preserved symbols set from string to GUID, this is needed for
+  // computing the dead symbols, the caching hash and the internalization.
+  auto GUIDPreservedSymbols =
+      computeGUIDPreservedSymbols(PreservedSymbols, TMBuilder.TheTriple);
+
+  // Symbols that can't be reached from the preserved ones don't need to be
+  // imported from or exported, they will be internalized and removed.
+  auto DeadSymbols = computeDeadSymbols(*Index, GUIDPreservedSymbols);
+
   // Collect the import/export lists for all modules from the call-graph in the
   // combined index.
   StringMap<FunctionImporter::ImportMapTy> ImportLists(ModuleCount);
   StringMap<FunctionImporter::ExportSetTy> ExportLists(ModuleCount);
   ComputeCrossModuleImport(*Index, ModuleToDefinedGVSummaries, ImportLists,
-                           ExportLists);
-
-  // Convert the preserved symbols set from string to GUID, this is needed for
-  // computing the caching hash and the internalization.
-  auto GUIDPreservedSymbols =
-      computeGUIDPreservedSymbols(PreservedSymbols, TMBuilder.TheTriple);
+                           ExportLists, &DeadSymbols);
 
   // We use a std::map here to be able to have a defined ordering when
   // producing a hash for the cache entry.
@@ -800,7 +936,8 @@ void ThinLTOCodeGenerator::run() {
         ModuleCacheEntry CacheEntry(CacheOptions.Path, *Index, ModuleIdentifier,
                                     ImportLists[ModuleIdentifier], ExportList,
                                     ResolvedODR[ModuleIdentifier],
-                                    DefinedFunctions, GUIDPreservedSymbols);
+                                    DefinedFunctions, GUIDPreservedSymbols,
+                                    TMBuilder, DisableCodeGen);
 
         {
           auto ErrOrBuffer = CacheEntry.tryLoadingBuffer();
@@ -815,6 +952,8 @@ void ThinLTOCodeGenerator::run() {
           }
         }
 
+        TimeTraceScope BackendScope("ThinLTOBackend", ModuleIdentifier);
+
         LLVMContext Context;
         Context.setDiscardValueNames(LTODiscardValueNames);
         Context.enableDebugTypeODRUniquing();
@@ -839,11 +978,10 @@ void ThinLTOCodeGenerator::run() {
     }
   }
 
-  CachePruning(CacheOptions.Path)
-      .setPruningInterval(CacheOptions.PruningInterval)
-      .setEntryExpiration(CacheOptions.Expiration)
-      .setMaxSize(CacheOptions.MaxPercentageOfAvailableSpace)
-      .prune();
+  if (PruningPool)
+    PruningPool->wait();
+  else
+    PruneCache();
 
   // If statistics were requested, print them out now.
   if (llvm::AreStatisticsEnabled())
@@ -49,9 +49,22 @@ static const llvm::opt::OptTable::Info infoTable[] = {
 #undef OPTION
 };
 
+static const unsigned hashDisplacements[] = {
+#define OPTION_HASH_DISPLACEMENT(D) D,
+#include "Options.inc"
+#undef OPTION_HASH_DISPLACEMENT
+};
+
+static const unsigned hashSlots[] = {
+#define OPTION_HASH_SLOT(S) S,
+#include "Options.inc"
+#undef OPTION_HASH_SLOT
+};
+
 class LibOptTable : public llvm::opt::OptTable {
 public:
-  LibOptTable() : OptTable(infoTable, true) {}
+  LibOptTable()
+      : OptTable(infoTable, true, hashDisplacements, hashSlots) {}
 };
 
 }
@@ -1216,11 +1216,11 @@ Error IRLinker::run() {
 
   // Append the module inline asm string.
   if (!SrcM->getModuleInlineAsm().empty()) {
-    if (DstM.getModuleInlineAsm().empty())
-      DstM.setModuleInlineAsm(SrcM->getModuleInlineAsm());
-    else
-      DstM.setModuleInlineAsm(DstM.getModuleInlineAsm() + "\n" +
-                              SrcM->getModuleInlineAsm());
+    // Append in place: rebuilding the whole string at each link step is
+    // quadratic when many modules carry inline asm.
+    if (!DstM.getModuleInlineAsm().empty())
+      DstM.appendModuleInlineAsm("\n");
+    DstM.appendModuleInlineAsm(SrcM->getModuleInlineAsm());
   }
 
   // Loop over all of the linked values to compute type mappings.
@@ -174,7 +174,7 @@ public:
                    ELFSymbolData &MSD, const MCAsmLayout &Layout);
 
   // Start and end offset of each section
-  typedef std::map<const MCSectionELF *, std::pair<uint64_t, uint64_t>>
+  typedef DenseMap<const MCSectionELF *, std::pair<uint64_t, uint64_t>>
       SectionOffsetsTy;
 
   bool shouldRelocateWithSymbol(const MCAssembler &Asm,
@@ -1221,13 +1221,19 @@ void ELFObjectWriter::writeObject(MCAssembler &Asm,
   RevGroupMapTy RevGroupMap;
   SectionIndexMapTy SectionIndexMap;
 
-  std::map<const MCSymbol *, std::vector<const MCSectionELF *>> GroupMembers;
+  DenseMap<const MCSymbol *, std::vector<const MCSectionELF *>> GroupMembers;
 
   // Write out the ELF header ...
   writeHeader(Asm);
 
   // ... then the sections ...
+  // With -ffunction-sections there can be tens of thousands of sections, each
+  // of which may also get a relocation and a group section, so size the maps
+  // up front rather than rehashing them while the sections are written.
+  SectionTable.reserve(2 * Asm.size());
+  SectionIndexMap.reserve(2 * Asm.size());
   SectionOffsetsTy SectionOffsets;
+  SectionOffsets.reserve(2 * Asm.size());
   std::vector<MCSectionELF *> Groups;
   std::vector<MCSectionELF *> Relocations;
   for (MCSection &Sec : Asm) {
@@ -847,48 +847,62 @@ bool MCAssembler::relaxCVDefRange(MCAsmLayout &Layout,
   return OldSize != F.getContents().size();
 }
 
-bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
+bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout,
+                                    SmallVectorImpl<MCFragment *> &Worklist) {
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
   // When a fragment is relaxed, all the fragments following it should get
   // invalidated because their offset is going to change.
   MCFragment *FirstRelaxedFragment = nullptr;
 
-  // Attempt to relax all the fragments in the section.
-  for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
+  // Attempt to relax all the candidate fragments in the section, compacting
+  // the worklist as we go.
+  unsigned NumLive = 0;
+  for (unsigned I = 0, E = Worklist.size(); I != E; ++I) {
+    MCFragment *F = Worklist[I];
     // Check if this is a fragment that needs relaxation.
     bool RelaxedFrag = false;
-    switch(I->getKind()) {
+    bool StillLive = true;
+    switch(F->getKind()) {
     default:
-      break;
-    case MCFragment::FT_Relaxable:
+      llvm_unreachable("Unexpected fragment in relaxation worklist");
+    case MCFragment::FT_Relaxable: {
       assert(!getRelaxAll() &&
              "Did not expect a MCRelaxableFragment in RelaxAll mode");
-      RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(I));
+      auto &RF = *cast<MCRelaxableFragment>(F);
+      RelaxedFrag = relaxInstruction(Layout, RF);
+      // Once an instruction is in a form that never needs relaxation it cannot
+      // change size again.
+      StillLive = getBackend().mayNeedRelaxation(RF.getInst());
       break;
+    }
     case MCFragment::FT_Dwarf:
       RelaxedFrag = relaxDwarfLineAddr(Layout,
-                                       *cast<MCDwarfLineAddrFragment>(I));
+                                       *cast<MCDwarfLineAddrFragment>(F));
       break;
     case MCFragment::FT_DwarfFrame:
       RelaxedFrag =
         relaxDwarfCallFrameFragment(Layout,
-                                    *cast<MCDwarfCallFrameFragment>(I));
+                                    *cast<MCDwarfCallFrameFragment>(F));
       break;
     case MCFragment::FT_LEB:
-      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(I));
+      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(F));
       break;
     case MCFragment::FT_CVInlineLines:
       RelaxedFrag =
-          relaxCVInlineLineTable(Layout, *cast<MCCVInlineLineTableFragment>(I));
+          relaxCVInlineLineTable(Layout, *cast<MCCVInlineLineTableFragment>(F));
       break;
     case MCFragment::FT_CVDefRange:
-      RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(I));
+      RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(F));
       break;
     }
     if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
+      FirstRelaxedFragment = F;
+    if (StillLive)
+      Worklist[NumLive++] = F;
   }
+  Worklist.resize(NumLive);
+
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
     return true;
@@ -900,9 +914,29 @@ bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
   ++stats::RelaxationSteps;
 
   bool WasRelaxed = false;
+  SmallVector<MCFragment *, 64> Worklist;
   for (iterator it = begin(), ie = end(); it != ie; ++it) {
     MCSection &Sec = *it;
-    while (layoutSectionOnce(Layout, Sec))
+
+    // Collect the fragments whose size may depend on the layout. Everything
+    // else has a fixed size and never needs to be revisited.
+    Worklist.clear();
+    for (MCFragment &F : Sec) {
+      switch (F.getKind()) {
+      default:
+        break;
+      case MCFragment::FT_Relaxable:
+      case MCFragment::FT_Dwarf:
+      case MCFragment::FT_DwarfFrame:
+      case MCFragment::FT_LEB:
+      case MCFragment::FT_CVInlineLines:
+      case MCFragment::FT_CVDefRange:
+        Worklist.push_back(&F);
+        break;
+      }
+    }
+
+    while (layoutSectionOnce(Layout, Worklist))
       WasRelaxed = true;
   }
 
@@ -27,6 +27,8 @@ using namespace llvm;
 namespace {
 namespace stats {
 STATISTIC(MCExprEvaluate, "Number of MCExpr evaluations");
+STATISTIC(MCExprEvaluateCached, "Number of MCExpr evaluations found in the "
+                                "layout's value cache");
 }
 }
 
@@ -599,11 +601,47 @@ static bool canExpand(const MCSymbol &Sym, bool InSet) {
   return !Sym.isInSection();
 }
 
+/// Return \p E if it refers to a label, whose value is just its address.
+static const MCSymbolRefExpr *getLabelRef(const MCExpr *E) {
+  const auto *SRE = dyn_cast<MCSymbolRefExpr>(E);
+  if (!SRE || SRE->getSymbol().isVariable())
+    return nullptr;
+  return SRE;
+}
+
 bool MCExpr::evaluateAsRelocatableImpl(MCValue &Res, const MCAssembler *Asm,
                                        const MCAsmLayout *Layout,
                                        const MCFixup *Fixup,
                                        const SectionAddrMap *Addrs,
                                        bool InSet) const {
+  // Relaxation evaluates the same symbol differences on every iteration, so
+  // remember the values of binary expressions until the sections they were
+  // computed from change. The fixup only matters to target expressions and
+  // the section addresses only to the MachO writer; evaluations that have
+  // either are not cached.
+  if (getKind() != Binary || !Layout || Fixup || Addrs)
+    return evaluateAsRelocatableUncached(Res, Asm, Layout, Fixup, Addrs,
+                                         InSet);
+
+  if (Layout->getCachedValue(this, InSet, Res)) {
+    ++stats::MCExprEvaluateCached;
+    return true;
+  }
+  MCAsmLayout::ValueDepsTy Deps;
+  MCAsmLayout::ValueDepsTy *OuterDeps = Layout->setValueDeps(&Deps);
+  bool IsRelocatable =
+      evaluateAsRelocatableUncached(Res, Asm, Layout, Fixup, Addrs, InSet);
+  Layout->finishValue(this, InSet, IsRelocatable ? &Res : nullptr, Deps,
+                      OuterDeps);
+  return IsRelocatable;
+}
+
+bool MCExpr::evaluateAsRelocatableUncached(MCValue &Res,
+                                           const MCAssembler *Asm,
+                                           const MCAsmLayout *Layout,
+                                           const MCFixup *Fixup,
+                                           const SectionAddrMap *Addrs,
+                                           bool InSet) const {
   ++stats::MCExprEvaluate;
 
   switch (getKind()) {
@@ -683,6 +721,27 @@ bool MCExpr::evaluateAsRelocatableImpl(MCValue &Res, const MCAssembler *Asm,
 
   case Binary: {
     const MCBinaryExpr *ABE = cast<MCBinaryExpr>(this);
+
+    // Fast paths for the common `label + cst`, `label - cst` and
+    // `label1 - label2` forms, which fold the same way as the general case
+    // below without evaluating the operands separately.
+    MCBinaryExpr::Opcode Op = ABE->getOpcode();
+    if (Op == MCBinaryExpr::Add || Op == MCBinaryExpr::Sub) {
+      if (const MCSymbolRefExpr *A = getLabelRef(ABE->getLHS())) {
+        if (const auto *C = dyn_cast<MCConstantExpr>(ABE->getRHS())) {
+          // The cast avoids undefined behavior if the constant is INT64_MIN.
+          uint64_t Cst = C->getValue();
+          Res = MCValue::get(A, nullptr, Op == MCBinaryExpr::Add ? Cst : -Cst);
+          return true;
+        }
+        if (Op == MCBinaryExpr::Sub)
+          if (const MCSymbolRefExpr *B = getLabelRef(ABE->getRHS()))
+            return EvaluateSymbolicAdd(Asm, Layout, Addrs, InSet,
+                                       MCValue::get(A, nullptr, 0), nullptr, B,
+                                       0, Res);
+      }
+    }
+
     MCValue LHSValue, RHSValue;
 
     if (!ABE->getLHS()->evaluateAsRelocatableImpl(LHSValue, Asm, Layout, Fixup,
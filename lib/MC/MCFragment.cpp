@@ -56,6 +56,50 @@ void MCAsmLayout::invalidateFragmentsFrom(MCFragment *F) {
   // Otherwise, reset the last valid fragment to the previous fragment
   // (if this is the first fragment, it will be NULL).
   LastValidFragment[F->getParent()] = F->getPrevNode();
+
+  // Offsets in this section are about to change, so any cached expression
+  // value computed from them is stale.
+  ++SectionGenerations[F->getParent()];
+}
+
+void MCAsmLayout::addValueDep(const MCSection *Sec, unsigned Gen) const {
+  auto Dep = std::make_pair(Sec, Gen);
+  if (std::find(CurrentDeps->begin(), CurrentDeps->end(), Dep) ==
+      CurrentDeps->end())
+    CurrentDeps->push_back(Dep);
+}
+
+void MCAsmLayout::addValueDeps(const ValueDepsTy &Deps) const {
+  if (!CurrentDeps)
+    return;
+  for (const auto &Dep : Deps)
+    addValueDep(Dep.first, Dep.second);
+}
+
+bool MCAsmLayout::getCachedValue(const MCExpr *E, bool InSet,
+                                 MCValue &Res) const {
+  auto I = ValueCache.find(std::make_pair(E, unsigned(InSet)));
+  if (I == ValueCache.end())
+    return false;
+  for (const auto &Dep : I->second.Deps)
+    if (SectionGenerations.lookup(Dep.first) != Dep.second)
+      return false;
+  Res = I->second.Value;
+  addValueDeps(I->second.Deps);
+  return true;
+}
+
+void MCAsmLayout::finishValue(const MCExpr *E, bool InSet, const MCValue *Res,
+                              ValueDepsTy &Deps,
+                              ValueDepsTy *OuterDeps) const {
+  CurrentDeps = OuterDeps;
+  // Whatever E was computed from, the expression containing it depends on.
+  addValueDeps(Deps);
+  if (!Res)
+    return;
+  CachedValue &Entry = ValueCache[std::make_pair(E, unsigned(InSet))];
+  Entry.Value = *Res;
+  Entry.Deps = std::move(Deps);
 }
 
 void MCAsmLayout::ensureValid(const MCFragment *F) const {
@@ -76,6 +120,8 @@ void MCAsmLayout::ensureValid(const MCFragment *F) const {
 
 uint64_t MCAsmLayout::getFragmentOffset(const MCFragment *F) const {
   ensureValid(F);
+  if (CurrentDeps)
+    addValueDep(F->getParent(), SectionGenerations.lookup(F->getParent()));
   assert(F->Offset != ~UINT64_C(0) && "Address not set!");
   return F->Offset;
 }
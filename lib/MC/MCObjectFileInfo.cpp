@@ -572,6 +572,9 @@ void MCObjectFileInfo::initELFMCObjectFileInfo(const Triple &T) {
       Ctx->getELFSection(".debug_str_offsets.dwo", ELF::SHT_PROGBITS, 0);
   DwarfAddrSection =
       Ctx->getELFSection(".debug_addr", ELF::SHT_PROGBITS, 0, "addr_sec");
+  DwarfStrOffSection =
+      Ctx->getELFSection(".debug_str_offsets", ELF::SHT_PROGBITS, 0,
+                         "str_offsets");
 
   // DWP Sections
   DwarfCUIndexSection =
@@ -854,6 +857,7 @@ void MCObjectFileInfo::InitMCObjectFileInfo(const Triple &TheTriple, bool PIC,
   DwarfAccelObjCSection = nullptr;      // Used only by selected targets.
   DwarfAccelNamespaceSection = nullptr; // Used only by selected targets.
   DwarfAccelTypesSection = nullptr;     // Used only by selected targets.
+  DwarfStrOffSection = nullptr;         // Used only by selected targets.
 
   TT = TheTriple;
 
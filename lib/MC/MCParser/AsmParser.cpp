@@ -2592,6 +2592,28 @@ bool AsmParser::parseDirectiveValue(unsigned Size) {
     for (;;) {
       const MCExpr *Value;
       SMLoc ExprLoc = getLexer().getLoc();
+
+      // Fast path for a bare integer operand, which is what large generated
+      // data tables consist of. This avoids allocating an MCConstantExpr in
+      // the context for every value. Anything else, including directional
+      // label references like "1f", is followed by a different token and
+      // takes the generic path below.
+      if (getLexer().is(AsmToken::Integer)) {
+        AsmToken Next = getLexer().peekTok();
+        if (Next.is(AsmToken::Comma) || Next.is(AsmToken::EndOfStatement)) {
+          assert(Size <= 8 && "Invalid size");
+          uint64_t IntValue = getTok().getIntVal();
+          if (!isUIntN(8 * Size, IntValue) && !isIntN(8 * Size, IntValue))
+            return Error(ExprLoc, "literal value out of range for directive");
+          Lex();
+          getStreamer().EmitIntValue(IntValue, Size);
+          if (getLexer().is(AsmToken::EndOfStatement))
+            break;
+          Lex();
+          continue;
+        }
+      }
+
       if (parseExpression(Value))
         return true;
 
@@ -8,20 +8,58 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/MC/MCInstrItineraries.h"
 #include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 
 using namespace llvm;
 
+namespace {
+/// The feature bits computed for each CPU and feature string, per pair of
+/// processor and feature tables. Parsing the feature string and expanding the
+/// implied features is a large part of creating a subtarget, and clients such
+/// as JITs create many subtargets with the same CPU and features.
+struct FeatureBitsCache {
+  sys::SmartMutex<true> Lock;
+  DenseMap<std::pair<const SubtargetFeatureKV *, const SubtargetFeatureKV *>,
+           StringMap<FeatureBitset>>
+      Tables;
+};
+} // end anonymous namespace
+
+static ManagedStatic<FeatureBitsCache> FeatureCache;
+
 static FeatureBitset getFeatures(StringRef CPU, StringRef FS,
                                  ArrayRef<SubtargetFeatureKV> ProcDesc,
                                  ArrayRef<SubtargetFeatureKV> ProcFeatures) {
+  // Asking for help prints the tables, so it must not be cached.
+  if (CPU == "help" || FS.find("+help") != StringRef::npos) {
+    SubtargetFeatures Features(FS);
+    return Features.getFeatureBits(CPU, ProcDesc, ProcFeatures);
+  }
+
+  std::string Key = CPU;
+  Key += '\0';
+  Key += FS;
+
+  sys::SmartScopedLock<true> Guard(FeatureCache->Lock);
+  auto Tables = std::make_pair(ProcDesc.data(), ProcFeatures.data());
+  StringMap<FeatureBitset> &Cache = FeatureCache->Tables[Tables];
+  auto I = Cache.find(Key);
+  if (I != Cache.end())
+    return I->second;
+
   SubtargetFeatures Features(FS);
-  return Features.getFeatureBits(CPU, ProcDesc, ProcFeatures);
+  FeatureBitset Bits = Features.getFeatureBits(CPU, ProcDesc, ProcFeatures);
+  Cache[Key] = Bits;
+  return Bits;
 }
 
 void MCSubtargetInfo::InitMCProcessorInfo(StringRef CPU, StringRef FS) {
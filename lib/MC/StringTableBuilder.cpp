@@ -11,6 +11,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/COFF.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Parallel.h"
 
 #include <vector>
 
@@ -46,7 +47,14 @@ static int charTailAt(StringPair *P, size_t Pos) {
 
 // Three-way radix quicksort. This is much faster than std::sort with strcmp
 // because it does not compare characters that we already know the same.
-static void multikey_qsort(StringPair **Begin, StringPair **End, int Pos) {
+//
+// If \p TG is non-null, the greater and lesser partitions of large ranges are
+// sorted as separate tasks of the group, until \p Depth levels of recursion
+// have been split off. All strings are distinct, so the sorted order is the
+// same however the tasks are scheduled.
+static void multikey_qsort(StringPair **Begin, StringPair **End, int Pos,
+                           ThreadPoolTaskGroup *TG = nullptr,
+                           unsigned Depth = 0) {
 tailcall:
   if (End - Begin <= 1)
     return;
@@ -66,8 +74,14 @@ tailcall:
       R++;
   }
 
-  multikey_qsort(Begin, P, Pos);
-  multikey_qsort(Q, End, Pos);
+  if (TG && Depth && End - Begin >= parallel::detail::MinParallelSize) {
+    --Depth;
+    TG->async([=] { multikey_qsort(Begin, P, Pos, TG, Depth); });
+    TG->async([=] { multikey_qsort(Q, End, Pos, TG, Depth); });
+  } else {
+    multikey_qsort(Begin, P, Pos, TG, Depth);
+    multikey_qsort(Q, End, Pos, TG, Depth);
+  }
   if (Pivot != -1) {
     // qsort(P, Q, Pos + 1), but with tail call optimization.
     Begin = P;
@@ -96,7 +110,16 @@ void StringTableBuilder::finalizeStringTable(bool Optimize) {
     // If we're optimizing, sort by name. If not, sort by previously assigned
     // offset.
     if (Optimize) {
-      multikey_qsort(&Strings[0], &Strings[0] + Strings.size(), 0);
+      StringOffsetPair **Begin = &Strings[0];
+      StringOffsetPair **End = Begin + Strings.size();
+      if (Strings.size() < size_t(parallel::detail::MinParallelSize) ||
+          parallel::getThreadCount() == 1) {
+        multikey_qsort(Begin, End, 0);
+      } else {
+        ThreadPoolTaskGroup TG(parallel::getDefaultPool());
+        multikey_qsort(Begin, End, 0, &TG, Log2_64(Strings.size()) + 1);
+        TG.wait();
+      }
     } else {
       std::sort(Strings.begin(), Strings.end(),
                 [](const StringOffsetPair *LHS, const StringOffsetPair *RHS) {
@@ -182,10 +205,14 @@ size_t StringTableBuilder::getOffset(StringRef S) const {
 }
 
 size_t StringTableBuilder::add(StringRef S) {
+  return add(CachedHash<StringRef>(S));
+}
+
+size_t StringTableBuilder::add(CachedHash<StringRef> S) {
   assert(!isFinalized());
   size_t Start = alignTo(Size, Alignment);
   auto P = StringIndexMap.insert(std::make_pair(S, Start));
   if (P.second)
-    Size = Start + S.size() + (K != RAW);
+    Size = Start + S.Val.size() + (K != RAW);
   return P.first->second;
 }
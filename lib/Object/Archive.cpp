@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Object/Archive.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Endian.h"
@@ -659,21 +660,48 @@ uint32_t Archive::getNumberOfSymbols() const {
   return read32le(buf);
 }
 
+const Archive::SymbolIndexTy &Archive::getSymbolIndex() const {
+  std::lock_guard<std::mutex> Lock(SymbolIndexLock);
+  if (SymbolIndex)
+    return *SymbolIndex;
+
+  SymbolIndex = llvm::make_unique<SymbolIndexTy>();
+  // Every name takes at least its terminating null, which bounds the symbol
+  // count even when the header of a corrupt table claims otherwise.
+  SymbolIndex->reserve(
+      std::min<uint64_t>(getNumberOfSymbols(), getSymbolTable().size()));
+  // Keep the first definition of each name, as a linear scan would find it.
+  for (const Symbol &S : symbols())
+    SymbolIndex->insert(std::make_pair(S.getName(), S));
+  return *SymbolIndex;
+}
+
+Archive::child_iterator Archive::getSymbolMember(const Symbol &S) const {
+  ErrorOr<Archive::child_iterator> ResultOrErr = S.getMember();
+  // FIXME: Should we really eat the error?
+  if (ResultOrErr.getError())
+    return child_end();
+  return ResultOrErr.get();
+}
+
 Archive::child_iterator Archive::findSym(StringRef name) const {
-  Archive::symbol_iterator bs = symbol_begin();
-  Archive::symbol_iterator es = symbol_end();
-
-  for (; bs != es; ++bs) {
-    StringRef SymName = bs->getName();
-    if (SymName == name) {
-      ErrorOr<Archive::child_iterator> ResultOrErr = bs->getMember();
-      // FIXME: Should we really eat the error?
-      if (ResultOrErr.getError())
-        return child_end();
-      return ResultOrErr.get();
-    }
+  const SymbolIndexTy &Index = getSymbolIndex();
+  auto I = Index.find(name);
+  if (I == Index.end())
+    return child_end();
+  return getSymbolMember(I->second);
+}
+
+void Archive::findSyms(ArrayRef<StringRef> Names,
+                       SmallVectorImpl<child_iterator> &Result) const {
+  const SymbolIndexTy &Index = getSymbolIndex();
+  Result.clear();
+  Result.reserve(Names.size());
+  for (StringRef Name : Names) {
+    auto I = Index.find(Name);
+    Result.push_back(I == Index.end() ? child_end()
+                                      : getSymbolMember(I->second));
   }
-  return child_end();
 }
 
 bool Archive::hasSymbolTable() const { return !SymbolTable.empty(); }
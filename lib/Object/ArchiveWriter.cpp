@@ -16,12 +16,14 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Object/Archive.h"
+#include "llvm/Object/IRObjectFile.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Object/SymbolicFile.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
@@ -235,6 +237,105 @@ static sys::TimeValue now(bool Deterministic) {
   return TV;
 }
 
+namespace {
+// The global symbols defined by one archive member.
+struct MemberSymbols {
+  // Whether the member is an object or bitcode file at all. The symbol table
+  // is written if any member is, even if none of them define a symbol.
+  bool IsSymbolic = false;
+  // The names of the symbols, each followed by a null.
+  std::string Names;
+  unsigned NumSyms = 0;
+  std::error_code EC;
+};
+}
+
+// Whether a symbol with the given flags goes into the archive symbol table.
+static bool isArchiveSymbol(uint32_t Symflags) {
+  if (Symflags & object::SymbolRef::SF_FormatSpecific)
+    return false;
+  if (!(Symflags & object::SymbolRef::SF_Global))
+    return false;
+  if (Symflags & object::SymbolRef::SF_Undefined)
+    return false;
+  return true;
+}
+
+static void computeMemberSymbols(MemoryBufferRef MemberBuffer,
+                                 LLVMContext &Context, MemberSymbols &Result) {
+  // Bitcode written with a symbol table block can be handled without parsing
+  // the module.
+  if (sys::fs::identify_magic(MemberBuffer.getBuffer()) ==
+      sys::fs::file_magic::bitcode) {
+    std::vector<std::pair<StringRef, uint32_t>> Syms;
+    ErrorOr<bool> HasSymtab =
+        object::IRObjectFile::readSymbolTable(MemberBuffer, Syms);
+    if (HasSymtab && *HasSymtab) {
+      Result.IsSymbolic = true;
+      for (const auto &Sym : Syms) {
+        if (!isArchiveSymbol(Sym.second))
+          continue;
+        Result.Names += Sym.first;
+        Result.Names += '\0';
+        ++Result.NumSyms;
+      }
+      return;
+    }
+  }
+
+  Expected<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
+      object::SymbolicFile::createSymbolicFile(
+          MemberBuffer, sys::fs::file_magic::unknown, &Context);
+  if (!ObjOrErr) {
+    // FIXME: check only for "not an object file" errors.
+    consumeError(ObjOrErr.takeError());
+    return;
+  }
+  object::SymbolicFile &Obj = *ObjOrErr.get();
+  Result.IsSymbolic = true;
+
+  raw_string_ostream NameOS(Result.Names);
+  for (const object::BasicSymbolRef &S : Obj.symbols()) {
+    if (!isArchiveSymbol(S.getFlags()))
+      continue;
+
+    if (auto EC = S.printName(NameOS)) {
+      Result.EC = EC;
+      return;
+    }
+    NameOS << '\0';
+    ++Result.NumSyms;
+  }
+}
+
+// Parse the members to find the symbols they define. Parsing is independent
+// for each member, so it is spread over the default thread pool. Each task
+// uses its own LLVMContext for the bitcode members in its range.
+static std::vector<MemberSymbols>
+computeSymbols(ArrayRef<NewArchiveMember> Members) {
+  std::vector<MemberSymbols> Symbols(Members.size());
+  auto ComputeRange = [&](size_t Begin, size_t End) {
+    LLVMContext Context;
+    for (size_t I = Begin; I != End; ++I)
+      computeMemberSymbols(Members[I].Buf->getMemBufferRef(), Context,
+                           Symbols[I]);
+  };
+
+  size_t TaskSize = parallel::detail::getTaskSize(Members.size());
+  if (parallel::getThreadCount() == 1 || TaskSize >= Members.size()) {
+    ComputeRange(0, Members.size());
+    return Symbols;
+  }
+
+  ThreadPoolTaskGroup TG(parallel::getDefaultPool());
+  for (size_t Begin = 0; Begin < Members.size(); Begin += TaskSize) {
+    size_t End = std::min(Begin + TaskSize, Members.size());
+    TG.async([=, &ComputeRange] { ComputeRange(Begin, End); });
+  }
+  TG.wait();
+  return Symbols;
+}
+
 // Returns the offset of the first reference to a member offset.
 static ErrorOr<unsigned>
 writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
@@ -244,18 +345,11 @@ writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
   unsigned BodyStartOffset = 0;
   SmallString<128> NameBuf;
   raw_svector_ostream NameOS(NameBuf);
-  LLVMContext Context;
+  std::vector<MemberSymbols> Symbols = computeSymbols(Members);
   for (unsigned MemberNum = 0, N = Members.size(); MemberNum < N; ++MemberNum) {
-    MemoryBufferRef MemberBuffer = Members[MemberNum].Buf->getMemBufferRef();
-    Expected<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
-        object::SymbolicFile::createSymbolicFile(
-            MemberBuffer, sys::fs::file_magic::unknown, &Context);
-    if (!ObjOrErr) {
-      // FIXME: check only for "not an object file" errors.
-      consumeError(ObjOrErr.takeError());
+    const MemberSymbols &MS = Symbols[MemberNum];
+    if (!MS.IsSymbolic)
       continue;
-    }
-    object::SymbolicFile &Obj = *ObjOrErr.get();
 
     if (!HeaderStartOffset) {
       HeaderStartOffset = Out.tell();
@@ -267,24 +361,19 @@ writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
       print32(Out, Kind, 0); // number of entries or bytes
     }
 
-    for (const object::BasicSymbolRef &S : Obj.symbols()) {
-      uint32_t Symflags = S.getFlags();
-      if (Symflags & object::SymbolRef::SF_FormatSpecific)
-        continue;
-      if (!(Symflags & object::SymbolRef::SF_Global))
-        continue;
-      if (Symflags & object::SymbolRef::SF_Undefined)
-        continue;
-
+    StringRef Names = MS.Names;
+    for (unsigned I = 0; I != MS.NumSyms; ++I) {
       unsigned NameOffset = NameOS.tell();
-      if (auto EC = S.printName(NameOS))
-        return EC;
-      NameOS << '\0';
+      size_t NameEnd = Names.find('\0');
+      NameOS << Names.substr(0, NameEnd + 1);
+      Names = Names.substr(NameEnd + 1);
       MemberOffsetRefs.push_back(MemberNum);
       if (Kind == object::Archive::K_BSD)
         print32(Out, Kind, NameOffset);
       print32(Out, Kind, 0); // member offset
     }
+    if (MS.EC)
+      return MS.EC;
   }
 
   if (HeaderStartOffset == 0)
@@ -14,6 +14,7 @@
 #include "llvm/Object/IRObjectFile.h"
 #include "RecordStreamer.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Bitcode/LLVMBitCodes.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/GVMaterializer.h"
 #include "llvm/IR/LLVMContext.h"
@@ -326,3 +327,34 @@ llvm::object::IRObjectFile::create(MemoryBufferRef Object,
   std::unique_ptr<Module> &M = MOrErr.get();
   return llvm::make_unique<IRObjectFile>(Object, std::move(M));
 }
+
+ErrorOr<bool> llvm::object::IRObjectFile::readSymbolTable(
+    MemoryBufferRef Object,
+    std::vector<std::pair<StringRef, uint32_t>> &Symbols) {
+  ErrorOr<MemoryBufferRef> BCOrErr = findBitcodeInMemBuffer(Object);
+  if (!BCOrErr)
+    return BCOrErr.getError();
+
+  std::vector<BitcodeSymbol> BitcodeSymbols;
+  ErrorOr<bool> HasSymtab = readBitcodeSymbolTable(*BCOrErr, BitcodeSymbols);
+  if (!HasSymtab || !*HasSymtab)
+    return HasSymtab;
+
+  static const std::pair<uint32_t, uint32_t> FlagMap[] = {
+      {bitc::SYMTAB_FLAG_UNDEFINED, BasicSymbolRef::SF_Undefined},
+      {bitc::SYMTAB_FLAG_GLOBAL, BasicSymbolRef::SF_Global},
+      {bitc::SYMTAB_FLAG_WEAK, BasicSymbolRef::SF_Weak},
+      {bitc::SYMTAB_FLAG_COMMON, BasicSymbolRef::SF_Common},
+      {bitc::SYMTAB_FLAG_HIDDEN, BasicSymbolRef::SF_Hidden},
+      {bitc::SYMTAB_FLAG_CONST, BasicSymbolRef::SF_Const},
+      {bitc::SYMTAB_FLAG_FORMAT_SPECIFIC, BasicSymbolRef::SF_FormatSpecific}};
+  Symbols.reserve(Symbols.size() + BitcodeSymbols.size());
+  for (const BitcodeSymbol &Sym : BitcodeSymbols) {
+    uint32_t Flags = BasicSymbolRef::SF_None;
+    for (const auto &KV : FlagMap)
+      if (Sym.Flags & KV.first)
+        Flags |= KV.second;
+    Symbols.emplace_back(Sym.Name, Flags);
+  }
+  return true;
+}
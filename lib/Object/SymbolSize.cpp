@@ -51,6 +51,9 @@ llvm::object::computeSymbolSizes(const ObjectFile &O) {
     auto Syms = E->symbols();
     if (Syms.begin() == Syms.end())
       Syms = E->getDynamicSymbolIterators();
+    // Stepping over the symbols is cheap, so count them first rather than
+    // growing the result as we go.
+    Ret.reserve(std::distance(Syms.begin(), Syms.end()));
     for (ELFSymbolRef Sym : Syms)
       Ret.push_back({Sym, Sym.getSize()});
     return Ret;
@@ -59,6 +62,8 @@ llvm::object::computeSymbolSizes(const ObjectFile &O) {
   // Collect sorted symbol addresses. Include dummy addresses for the end
   // of each section.
   std::vector<SymEntry> Addresses;
+  Addresses.reserve(std::distance(O.symbol_begin(), O.symbol_end()) +
+                    std::distance(O.section_begin(), O.section_end()));
   unsigned SymNum = 0;
   for (symbol_iterator I = O.symbol_begin(), E = O.symbol_end(); I != E; ++I) {
     SymbolRef Sym = *I;
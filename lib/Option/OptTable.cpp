@@ -12,6 +12,7 @@
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
@@ -82,11 +83,26 @@ static inline bool operator<(const OptTable::Info &I, const char *Name) {
 }
 }
 
+// Hash of an option spelling, a prefix followed by the option name. The logic
+// should match with the emitter-side function in
+// utils/TableGen/OptParserEmitter.cpp.
+static uint32_t hashOptionSpelling(StringRef Spelling, uint32_t Seed) {
+  uint32_t Hash = Seed ^ 2166136261u;
+  for (char C : Spelling) {
+    Hash ^= (unsigned char)tolower((unsigned char)C);
+    Hash *= 16777619u;
+  }
+  return Hash;
+}
+
 OptSpecifier::OptSpecifier(const Option *Opt) : ID(Opt->getID()) {}
 
-OptTable::OptTable(ArrayRef<Info> OptionInfos, bool IgnoreCase)
+OptTable::OptTable(ArrayRef<Info> OptionInfos, bool IgnoreCase,
+                   ArrayRef<unsigned> HashDisplacements,
+                   ArrayRef<unsigned> HashSlots)
     : OptionInfos(OptionInfos), IgnoreCase(IgnoreCase), TheInputOptionID(0),
-      TheUnknownOptionID(0), FirstSearchableIndex(0) {
+      TheUnknownOptionID(0), FirstSearchableIndex(0),
+      HashDisplacements(HashDisplacements), HashSlots(HashSlots) {
   // Explicitly zero initialize the error to work around a bug in array
   // value-initialization on MinGW with gcc 4.3.5.
 
@@ -124,6 +140,29 @@ OptTable::OptTable(ArrayRef<Info> OptionInfos, bool IgnoreCase)
       llvm_unreachable("Options are not in order!");
     }
   }
+
+  // Check that the hash table belongs to these options.
+  assert(HashDisplacements.empty() == HashSlots.empty() &&
+         "Incomplete option hash table!");
+  assert((HashSlots.empty() || isPowerOf2_32(HashSlots.size())) &&
+         "Option hash table size isn't a power of 2!");
+  for (unsigned Slot = 0, e = HashSlots.size(); Slot != e; ++Slot) {
+    if (!HashSlots[Slot])
+      continue;
+    assert(HashSlots[Slot] - 1 < getNumOptions() &&
+           "Option hash table doesn't match the options!");
+    const Info &I = OptionInfos[HashSlots[Slot] - 1];
+    bool Found = false;
+    for (const char *const *P = I.Prefixes; *P && !Found; ++P) {
+      std::string Spelling = (Twine(*P) + I.Name).str();
+      unsigned Bucket =
+          hashOptionSpelling(Spelling, 0) % HashDisplacements.size();
+      Found = (hashOptionSpelling(Spelling, HashDisplacements[Bucket]) &
+               (e - 1)) == Slot;
+    }
+    if (!Found)
+      llvm_unreachable("Option hash table doesn't match the options!");
+  }
 #endif
 
   // Build prefixes.
@@ -186,6 +225,29 @@ static unsigned matchOption(const OptTable::Info *I, StringRef Str,
   return 0;
 }
 
+const OptTable::Info *OptTable::findExactOption(StringRef Str,
+                                                StringRef Name) const {
+  if (HashSlots.empty())
+    return nullptr;
+
+  unsigned Bucket = hashOptionSpelling(Str, 0) % HashDisplacements.size();
+  unsigned Slot = hashOptionSpelling(Str, HashDisplacements[Bucket]) &
+                  (HashSlots.size() - 1);
+  if (!HashSlots[Slot])
+    return nullptr;
+
+  // The slot holds the first option in the table whose spelling is Str when
+  // case is ignored, if any option has it. Check that the option is spelled
+  // exactly like Str, and that Str has no more prefix characters than its
+  // prefix; an option whose name starts with prefix characters can only be
+  // found by searching the table.
+  const Info *I = &OptionInfos[HashSlots[Slot] - 1];
+  if (matchOption(I, Str, IgnoreCase) != Str.size() ||
+      !Name.equals_lower(I->Name))
+    return nullptr;
+  return I;
+}
+
 Arg *OptTable::ParseOneArg(const ArgList &Args, unsigned &Index,
                            unsigned FlagsToInclude,
                            unsigned FlagsToExclude) const {
@@ -201,8 +263,13 @@ Arg *OptTable::ParseOneArg(const ArgList &Args, unsigned &Index,
   const Info *End = OptionInfos.end();
   StringRef Name = StringRef(Str).ltrim(PrefixChars);
 
-  // Search for the first next option which could be a prefix.
-  Start = std::lower_bound(Start, End, Name.data());
+  // Search for the first next option which could be a prefix. The options
+  // that precede one spelled exactly like the argument can't match it, so
+  // when there is such an option the search starts there.
+  if (const Info *Exact = findExactOption(Str, Name))
+    Start = Exact;
+  else
+    Start = std::lower_bound(Start, End, Name.data());
 
   // Options are stored in sorted order, with '\0' at the end of the
   // alphabet. Since the only options which can accept a string must
@@ -22,6 +22,7 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -183,56 +184,146 @@ void FunctionRecordIterator::skipOtherFiles() {
     *this = FunctionRecordIterator();
 }
 
+/// Match the mapping \p Record with its counts from \p ProfileReader, using
+/// \p Counts as scratch space. \p Function is left empty if the record can't
+/// be mapped to its profile. Returns the error that should stop the load, if
+/// any.
+static instrprof_error
+loadFunctionRecord(const CoverageMappingRecord &Record,
+                   const IndexedInstrProfReader &ProfileReader,
+                   std::vector<uint64_t> &Counts,
+                   Optional<FunctionRecord> &Function) {
+  CounterMappingContext Ctx(Record.Expressions);
+
+  Counts.clear();
+  ArrayRef<support::ulittle64_t> ProfileCounts;
+  if (Error E = ProfileReader.getFunctionCounts(
+          Record.FunctionName, Record.FunctionHash, ProfileCounts)) {
+    instrprof_error IPE = InstrProfError::take(std::move(E));
+    if (IPE == instrprof_error::hash_mismatch)
+      return instrprof_error::success;
+    else if (IPE != instrprof_error::unknown_function)
+      return IPE;
+    Counts.assign(Record.MappingRegions.size(), 0);
+  } else
+    Counts.assign(ProfileCounts.begin(), ProfileCounts.end());
+  Ctx.setCounts(Counts);
+
+  assert(!Record.MappingRegions.empty() && "Function has no regions");
+
+  StringRef OrigFuncName = Record.FunctionName;
+  if (Record.Filenames.empty())
+    OrigFuncName = getFuncNameWithoutPrefix(OrigFuncName);
+  else
+    OrigFuncName = getFuncNameWithoutPrefix(OrigFuncName, Record.Filenames[0]);
+  Function.emplace(OrigFuncName, Record.Filenames);
+  for (const auto &Region : Record.MappingRegions) {
+    Expected<int64_t> ExecutionCount = Ctx.evaluate(Region.Count);
+    if (auto E = ExecutionCount.takeError()) {
+      llvm::consumeError(std::move(E));
+      break;
+    }
+    Function->pushRegion(Region, *ExecutionCount);
+  }
+  if (Function->CountedRegions.size() != Record.MappingRegions.size())
+    Function.reset();
+  return instrprof_error::success;
+}
+
 Expected<std::unique_ptr<CoverageMapping>>
 CoverageMapping::load(CoverageMappingReader &CoverageReader,
                       IndexedInstrProfReader &ProfileReader) {
   auto Coverage = std::unique_ptr<CoverageMapping>(new CoverageMapping());
 
-  std::vector<uint64_t> Counts;
-  for (const auto &Record : CoverageReader) {
-    CounterMappingContext Ctx(Record.Expressions);
-
-    Counts.clear();
-    if (Error E = ProfileReader.getFunctionCounts(
-            Record.FunctionName, Record.FunctionHash, Counts)) {
-      instrprof_error IPE = InstrProfError::take(std::move(E));
-      if (IPE == instrprof_error::hash_mismatch) {
-        Coverage->MismatchedFunctionCount++;
-        continue;
-      } else if (IPE != instrprof_error::unknown_function)
+  size_t NumRecords = CoverageReader.getNumRecords();
+  size_t TaskSize = parallel::detail::getTaskSize(NumRecords);
+  if (NumRecords < size_t(parallel::detail::MinParallelSize) ||
+      parallel::getThreadCount() == 1) {
+    std::vector<uint64_t> Counts;
+    for (const auto &Record : CoverageReader) {
+      Optional<FunctionRecord> Function;
+      instrprof_error IPE =
+          loadFunctionRecord(Record, ProfileReader, Counts, Function);
+      if (IPE != instrprof_error::success)
         return make_error<InstrProfError>(IPE);
-      Counts.assign(Record.MappingRegions.size(), 0);
-    }
-    Ctx.setCounts(Counts);
-
-    assert(!Record.MappingRegions.empty() && "Function has no regions");
-
-    StringRef OrigFuncName = Record.FunctionName;
-    if (Record.Filenames.empty())
-      OrigFuncName = getFuncNameWithoutPrefix(OrigFuncName);
-    else
-      OrigFuncName =
-          getFuncNameWithoutPrefix(OrigFuncName, Record.Filenames[0]);
-    FunctionRecord Function(OrigFuncName, Record.Filenames);
-    for (const auto &Region : Record.MappingRegions) {
-      Expected<int64_t> ExecutionCount = Ctx.evaluate(Region.Count);
-      if (auto E = ExecutionCount.takeError()) {
-        llvm::consumeError(std::move(E));
-        break;
-      }
-      Function.pushRegion(Region, *ExecutionCount);
-    }
-    if (Function.CountedRegions.size() != Record.MappingRegions.size()) {
-      Coverage->MismatchedFunctionCount++;
-      continue;
+      if (Function)
+        Coverage->Functions.push_back(std::move(*Function));
+      else
+        Coverage->MismatchedFunctionCount++;
     }
+    Coverage->buildFileIndex();
+    return std::move(Coverage);
+  }
 
-    Coverage->Functions.push_back(std::move(Function));
+  // Each task loads a range of records with its own buffers, and the results
+  // are then combined in the order of the records.
+  struct Task {
+    std::vector<FunctionRecord> Functions;
+    unsigned MismatchedFunctionCount = 0;
+    coveragemap_error CME = coveragemap_error::success;
+    instrprof_error IPE = instrprof_error::success;
+  };
+  std::vector<Task> Tasks((NumRecords + TaskSize - 1) / TaskSize);
+  {
+    ThreadPoolTaskGroup TG(parallel::getDefaultPool());
+    for (size_t I = 0, E = Tasks.size(); I != E; ++I)
+      TG.async([&, I] {
+        Task &T = Tasks[I];
+        CoverageMappingReader::RecordBuffers Buffers;
+        std::vector<uint64_t> Counts;
+        for (size_t R = I * TaskSize, RE = std::min(R + TaskSize, NumRecords);
+             R != RE; ++R) {
+          CoverageMappingRecord Record;
+          if (Error Err = CoverageReader.readRecord(R, Record, Buffers)) {
+            handleAllErrors(std::move(Err), [&](const CoverageMapError &CME) {
+              T.CME = CME.get();
+            });
+            return;
+          }
+          Optional<FunctionRecord> Function;
+          T.IPE = loadFunctionRecord(Record, ProfileReader, Counts, Function);
+          if (T.IPE != instrprof_error::success)
+            return;
+          if (Function)
+            T.Functions.push_back(std::move(*Function));
+          else
+            T.MismatchedFunctionCount++;
+        }
+      });
+    TG.wait();
   }
 
+  for (Task &T : Tasks) {
+    if (T.CME != coveragemap_error::success)
+      return make_error<CoverageMapError>(T.CME);
+    if (T.IPE != instrprof_error::success)
+      return make_error<InstrProfError>(T.IPE);
+    Coverage->MismatchedFunctionCount += T.MismatchedFunctionCount;
+    Coverage->Functions.insert(Coverage->Functions.end(),
+                               std::make_move_iterator(T.Functions.begin()),
+                               std::make_move_iterator(T.Functions.end()));
+  }
+  Coverage->buildFileIndex();
   return std::move(Coverage);
 }
 
+void CoverageMapping::buildFileIndex() {
+  for (unsigned I = 0, E = Functions.size(); I != E; ++I)
+    for (const auto &Filename : Functions[I].Filenames) {
+      auto &Indices = FileFunctions[Filename];
+      if (Indices.empty() || Indices.back() != I)
+        Indices.push_back(I);
+    }
+}
+
+ArrayRef<unsigned>
+CoverageMapping::getFileFunctions(StringRef Filename) const {
+  auto I = FileFunctions.find(Filename);
+  if (I == FileFunctions.end())
+    return None;
+  return I->second;
+}
+
 Expected<std::unique_ptr<CoverageMapping>>
 CoverageMapping::load(StringRef ObjectFilename, StringRef ProfileFilename,
                       StringRef Arch) {
@@ -412,12 +503,9 @@ public:
 
 std::vector<StringRef> CoverageMapping::getUniqueSourceFiles() const {
   std::vector<StringRef> Filenames;
-  for (const auto &Function : getCoveredFunctions())
-    Filenames.insert(Filenames.end(), Function.Filenames.begin(),
-                     Function.Filenames.end());
+  for (const auto &Entry : FileFunctions)
+    Filenames.push_back(Entry.first());
   std::sort(Filenames.begin(), Filenames.end());
-  auto Last = std::unique(Filenames.begin(), Filenames.end());
-  Filenames.erase(Last, Filenames.end());
   return Filenames;
 }
 
@@ -456,11 +544,12 @@ static bool isExpansion(const CountedRegion &R, unsigned FileID) {
   return R.Kind == CounterMappingRegion::ExpansionRegion && R.FileID == FileID;
 }
 
-CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) {
+CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
   CoverageData FileCoverage(Filename);
   std::vector<coverage::CountedRegion> Regions;
 
-  for (const auto &Function : Functions) {
+  for (unsigned FunctionIndex : getFileFunctions(Filename)) {
+    const FunctionRecord &Function = Functions[FunctionIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     auto FileIDs = gatherFileIDs(Filename, Function);
     for (const auto &CR : Function.CountedRegions)
@@ -478,9 +567,10 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) {
 }
 
 std::vector<const FunctionRecord *>
-CoverageMapping::getInstantiations(StringRef Filename) {
+CoverageMapping::getInstantiations(StringRef Filename) const {
   FunctionInstantiationSetCollector InstantiationSetCollector;
-  for (const auto &Function : Functions) {
+  for (unsigned FunctionIndex : getFileFunctions(Filename)) {
+    const FunctionRecord &Function = Functions[FunctionIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     if (!MainFileID)
       continue;
@@ -498,7 +588,7 @@ CoverageMapping::getInstantiations(StringRef Filename) {
 }
 
 CoverageData
-CoverageMapping::getCoverageForFunction(const FunctionRecord &Function) {
+CoverageMapping::getCoverageForFunction(const FunctionRecord &Function) const {
   auto MainFileID = findMainViewFileID(Function);
   if (!MainFileID)
     return CoverageData();
@@ -518,8 +608,8 @@ CoverageMapping::getCoverageForFunction(const FunctionRecord &Function) {
   return FunctionCoverage;
 }
 
-CoverageData
-CoverageMapping::getCoverageForExpansion(const ExpansionRecord &Expansion) {
+CoverageData CoverageMapping::getCoverageForExpansion(
+    const ExpansionRecord &Expansion) const {
   CoverageData ExpansionCoverage(
       Expansion.Function.Filenames[Expansion.FileID]);
   std::vector<coverage::CountedRegion> Regions;
@@ -552,6 +642,8 @@ std::string getCoverageMapErrString(coveragemap_error Err) {
     return "Truncated coverage data";
   case coveragemap_error::malformed:
     return "Malformed coverage data";
+  case coveragemap_error::decompression_failed:
+    return "Failed to decompress coverage data (zlib)";
   }
   llvm_unreachable("A value of coveragemap_error has no message.");
 }
@@ -16,6 +16,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/Object/MachOUniversal.h"
 #include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/LEB128.h"
@@ -44,14 +45,27 @@ void CoverageMappingIterator::increment() {
 Error RawCoverageReader::readULEB128(uint64_t &Result) {
   if (Data.size() < 1)
     return make_error<CoverageMapError>(coveragemap_error::truncated);
-  unsigned N = 0;
-  Result = decodeULEB128(reinterpret_cast<const uint8_t *>(Data.data()), &N);
-  if (N > Data.size())
+  const uint8_t *Next =
+      decodeULEB128Array(Data.bytes_begin(), Data.bytes_end(), &Result, 1);
+  if (!Next)
     return make_error<CoverageMapError>(coveragemap_error::malformed);
-  Data = Data.substr(N);
+  Data = Data.substr(Next - Data.bytes_begin());
   return Error::success();
 }
 
+Error RawCoverageReader::readULEB128s(uint64_t *Results, size_t Count) {
+  if (const uint8_t *Next = decodeULEB128Array(
+          Data.bytes_begin(), Data.bytes_end(), Results, Count)) {
+    Data = Data.substr(Next - Data.bytes_begin());
+    return Error::success();
+  }
+  // Read the values one at a time to find out what went wrong.
+  for (size_t I = 0; I != Count; ++I)
+    if (auto Err = readULEB128(Results[I]))
+      return Err;
+  llvm_unreachable("bulk decoding failed on valid data");
+}
+
 Error RawCoverageReader::readIntMax(uint64_t &Result, uint64_t MaxPlus1) {
   if (auto Err = readULEB128(Result))
     return Err;
@@ -78,10 +92,62 @@ Error RawCoverageReader::readString(StringRef &Result) {
   return Error::success();
 }
 
+Error RawCoverageReader::readCompressibleBlock(StringRef &Block,
+                                              DecompressedData &Decompressed) {
+  uint64_t UncompressedSize, CompressedSize;
+  if (auto Err = readULEB128(UncompressedSize))
+    return Err;
+  if (auto Err = readSize(CompressedSize))
+    return Err;
+  if (!CompressedSize) {
+    if (UncompressedSize > Data.size())
+      return make_error<CoverageMapError>(coveragemap_error::malformed);
+    Block = Data.substr(0, UncompressedSize);
+    Data = Data.substr(UncompressedSize);
+    return Error::success();
+  }
+
+  if (!zlib::isAvailable())
+    return make_error<CoverageMapError>(
+        coveragemap_error::decompression_failed);
+  auto Buffer = llvm::make_unique<SmallVector<char, 0>>();
+  if (zlib::uncompress(Data.substr(0, CompressedSize), *Buffer,
+                       UncompressedSize) != zlib::StatusOK)
+    return make_error<CoverageMapError>(
+        coveragemap_error::decompression_failed);
+  Block = StringRef(Buffer->data(), Buffer->size());
+  Decompressed.push_back(std::move(Buffer));
+  Data = Data.substr(CompressedSize);
+  return Error::success();
+}
+
 Error RawCoverageFilenamesReader::read() {
   uint64_t NumFilenames;
   if (auto Err = readSize(NumFilenames))
     return Err;
+  return readFilenames(NumFilenames);
+}
+
+Error RawCoverageFilenamesReader::read(CovMapVersion Version,
+                                       DecompressedData &Decompressed) {
+  if (Version < CovMapVersion::Version3)
+    return read();
+
+  // The count can't be checked against the size of the data, which may be
+  // compressed.
+  uint64_t NumFilenames;
+  if (auto Err = readULEB128(NumFilenames))
+    return Err;
+  StringRef Names;
+  if (auto Err = readCompressibleBlock(Names, Decompressed))
+    return Err;
+  Data = Names;
+  return readFilenames(NumFilenames);
+}
+
+Error RawCoverageFilenamesReader::readFilenames(uint64_t NumFilenames) {
+  if (NumFilenames > Data.size())
+    return make_error<CoverageMapError>(coveragemap_error::malformed);
   for (size_t I = 0; I < NumFilenames; ++I) {
     StringRef Filename;
     if (auto Err = readString(Filename))
@@ -91,6 +157,11 @@ Error RawCoverageFilenamesReader::read() {
   return Error::success();
 }
 
+Error RawCoverageMappingDataReader::read(StringRef &MappingData,
+                                        DecompressedData &Decompressed) {
+  return readCompressibleBlock(MappingData, Decompressed);
+}
+
 Error RawCoverageMappingReader::decodeCounter(unsigned Value, Counter &C) {
   auto Tag = Value & Counter::EncodingTagMask;
   switch (Tag) {
@@ -181,18 +252,16 @@ Error RawCoverageMappingReader::readMappingRegionsSubArray(
     }
 
     // Read the source range.
-    uint64_t LineStartDelta, ColumnStart, NumLines, ColumnEnd;
-    if (auto Err =
-            readIntMax(LineStartDelta, std::numeric_limits<unsigned>::max()))
+    uint64_t Range[4];
+    if (auto Err = readULEB128s(Range, 4))
       return Err;
-    if (auto Err = readULEB128(ColumnStart))
-      return Err;
-    if (ColumnStart > std::numeric_limits<unsigned>::max())
+    uint64_t LineStartDelta = Range[0], ColumnStart = Range[1],
+             NumLines = Range[2], ColumnEnd = Range[3];
+    if (LineStartDelta >= std::numeric_limits<unsigned>::max() ||
+        ColumnStart > std::numeric_limits<unsigned>::max() ||
+        NumLines >= std::numeric_limits<unsigned>::max() ||
+        ColumnEnd >= std::numeric_limits<unsigned>::max())
       return make_error<CoverageMapError>(coveragemap_error::malformed);
-    if (auto Err = readIntMax(NumLines, std::numeric_limits<unsigned>::max()))
-      return Err;
-    if (auto Err = readIntMax(ColumnEnd, std::numeric_limits<unsigned>::max()))
-      return Err;
     LineStart += LineStartDelta;
     // Adjust the column locations for the empty regions that are supposed to
     // cover whole lines. Those regions should be encoded with the
@@ -364,7 +433,7 @@ struct CovMapFuncRecordReader {
   static Expected<std::unique_ptr<CovMapFuncRecordReader>>
   get(coverage::CovMapVersion Version, InstrProfSymtab &P,
       std::vector<BinaryCoverageReader::ProfileMappingRecord> &R,
-      std::vector<StringRef> &F);
+      std::vector<StringRef> &F, DecompressedData &D);
 };
 
 // A class for reading coverage mapping function records for a module.
@@ -382,6 +451,7 @@ class VersionedCovMapFuncRecordReader : public CovMapFuncRecordReader {
   InstrProfSymtab &ProfileNames;
   std::vector<StringRef> &Filenames;
   std::vector<BinaryCoverageReader::ProfileMappingRecord> &Records;
+  DecompressedData &Decompressed;
 
   // Add the record to the collection if we don't already have a record that
   // points to the same function name. This is useful to ignore the redundant
@@ -430,8 +500,8 @@ public:
   VersionedCovMapFuncRecordReader(
       InstrProfSymtab &P,
       std::vector<BinaryCoverageReader::ProfileMappingRecord> &R,
-      std::vector<StringRef> &F)
-      : ProfileNames(P), Filenames(F), Records(R) {}
+      std::vector<StringRef> &F, DecompressedData &D)
+      : ProfileNames(P), Filenames(F), Records(R), Decompressed(D) {}
   ~VersionedCovMapFuncRecordReader() override {}
 
   Expected<const char *> readFunctionRecords(const char *Buf,
@@ -456,7 +526,7 @@ public:
       return make_error<CoverageMapError>(coveragemap_error::malformed);
     size_t FilenamesBegin = Filenames.size();
     RawCoverageFilenamesReader Reader(StringRef(Buf, FilenamesSize), Filenames);
-    if (auto Err = Reader.read())
+    if (auto Err = Reader.read(Version, Decompressed))
       return std::move(Err);
     Buf += FilenamesSize;
 
@@ -467,6 +537,14 @@ public:
 
     if (Buf > End)
       return make_error<CoverageMapError>(coveragemap_error::malformed);
+    if (Version >= CovMapVersion::Version3) {
+      StringRef MappingData;
+      RawCoverageMappingDataReader DataReader(StringRef(CovBuf, CoverageSize));
+      if (auto Err = DataReader.read(MappingData, Decompressed))
+        return std::move(Err);
+      CovBuf = MappingData.begin();
+      CovEnd = MappingData.end();
+    }
     // Each coverage map has an alignment of 8, so we need to adjust alignment
     // before reading the next map.
     Buf += alignmentAdjustment(Buf, 8);
@@ -496,18 +574,22 @@ template <class IntPtrT, support::endianness Endian>
 Expected<std::unique_ptr<CovMapFuncRecordReader>> CovMapFuncRecordReader::get(
     coverage::CovMapVersion Version, InstrProfSymtab &P,
     std::vector<BinaryCoverageReader::ProfileMappingRecord> &R,
-    std::vector<StringRef> &F) {
+    std::vector<StringRef> &F, DecompressedData &D) {
   using namespace coverage;
   switch (Version) {
   case CovMapVersion::Version1:
     return llvm::make_unique<VersionedCovMapFuncRecordReader<
-        CovMapVersion::Version1, IntPtrT, Endian>>(P, R, F);
+        CovMapVersion::Version1, IntPtrT, Endian>>(P, R, F, D);
   case CovMapVersion::Version2:
+  case CovMapVersion::Version3:
     // Decompress the name data.
     if (Error E = P.create(P.getNameData()))
       return std::move(E);
+    if (Version == CovMapVersion::Version2)
+      return llvm::make_unique<VersionedCovMapFuncRecordReader<
+          CovMapVersion::Version2, IntPtrT, Endian>>(P, R, F, D);
     return llvm::make_unique<VersionedCovMapFuncRecordReader<
-        CovMapVersion::Version2, IntPtrT, Endian>>(P, R, F);
+        CovMapVersion::Version3, IntPtrT, Endian>>(P, R, F, D);
   }
   llvm_unreachable("Unsupported version");
 }
@@ -516,7 +598,7 @@ template <typename T, support::endianness Endian>
 static Error readCoverageMappingData(
     InstrProfSymtab &ProfileNames, StringRef Data,
     std::vector<BinaryCoverageReader::ProfileMappingRecord> &Records,
-    std::vector<StringRef> &Filenames) {
+    std::vector<StringRef> &Filenames, DecompressedData &Decompressed) {
   using namespace coverage;
   // Read the records in the coverage data section.
   auto CovHeader =
@@ -526,7 +608,7 @@ static Error readCoverageMappingData(
     return make_error<CoverageMapError>(coveragemap_error::unsupported_version);
   Expected<std::unique_ptr<CovMapFuncRecordReader>> ReaderExpected =
       CovMapFuncRecordReader::get<T, Endian>(Version, ProfileNames, Records,
-                                             Filenames);
+                                             Filenames, Decompressed);
   if (Error E = ReaderExpected.takeError())
     return E;
   auto Reader = std::move(ReaderExpected.get());
@@ -663,19 +745,19 @@ BinaryCoverageReader::create(std::unique_ptr<MemoryBuffer> &ObjectBuffer,
   if (BytesInAddress == 4 && Endian == support::endianness::little)
     E = readCoverageMappingData<uint32_t, support::endianness::little>(
         Reader->ProfileNames, Coverage, Reader->MappingRecords,
-        Reader->Filenames);
+        Reader->Filenames, Reader->Decompressed);
   else if (BytesInAddress == 4 && Endian == support::endianness::big)
     E = readCoverageMappingData<uint32_t, support::endianness::big>(
         Reader->ProfileNames, Coverage, Reader->MappingRecords,
-        Reader->Filenames);
+        Reader->Filenames, Reader->Decompressed);
   else if (BytesInAddress == 8 && Endian == support::endianness::little)
     E = readCoverageMappingData<uint64_t, support::endianness::little>(
         Reader->ProfileNames, Coverage, Reader->MappingRecords,
-        Reader->Filenames);
+        Reader->Filenames, Reader->Decompressed);
   else if (BytesInAddress == 8 && Endian == support::endianness::big)
     E = readCoverageMappingData<uint64_t, support::endianness::big>(
         Reader->ProfileNames, Coverage, Reader->MappingRecords,
-        Reader->Filenames);
+        Reader->Filenames, Reader->Decompressed);
   else
     return make_error<CoverageMapError>(coveragemap_error::malformed);
   if (E)
@@ -686,24 +768,31 @@ BinaryCoverageReader::create(std::unique_ptr<MemoryBuffer> &ObjectBuffer,
 Error BinaryCoverageReader::readNextRecord(CoverageMappingRecord &Record) {
   if (CurrentRecord >= MappingRecords.size())
     return make_error<CoverageMapError>(coveragemap_error::eof);
+  if (auto Err = readRecord(CurrentRecord, Record, Buffers))
+    return Err;
+  ++CurrentRecord;
+  return Error::success();
+}
 
-  FunctionsFilenames.clear();
-  Expressions.clear();
-  MappingRegions.clear();
-  auto &R = MappingRecords[CurrentRecord];
+Error BinaryCoverageReader::readRecord(size_t Index,
+                                       CoverageMappingRecord &Record,
+                                       RecordBuffers &Buffers) const {
+  assert(Index < MappingRecords.size() && "Record index out of range");
+  Buffers.Filenames.clear();
+  Buffers.Expressions.clear();
+  Buffers.MappingRegions.clear();
+  auto &R = MappingRecords[Index];
   RawCoverageMappingReader Reader(
       R.CoverageMapping,
       makeArrayRef(Filenames).slice(R.FilenamesBegin, R.FilenamesSize),
-      FunctionsFilenames, Expressions, MappingRegions);
+      Buffers.Filenames, Buffers.Expressions, Buffers.MappingRegions);
   if (auto Err = Reader.read())
     return Err;
 
   Record.FunctionName = R.FunctionName;
   Record.FunctionHash = R.FunctionHash;
-  Record.Filenames = FunctionsFilenames;
-  Record.Expressions = Expressions;
-  Record.MappingRegions = MappingRegions;
-
-  ++CurrentRecord;
+  Record.Filenames = Buffers.Filenames;
+  Record.Expressions = Buffers.Expressions;
+  Record.MappingRegions = Buffers.MappingRegions;
   return Error::success();
 }
@@ -13,17 +13,47 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ProfileData/Coverage/CoverageMappingWriter.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/LEB128.h"
 
 using namespace llvm;
 using namespace coverage;
 
-void CoverageFilenamesSectionWriter::write(raw_ostream &OS) {
-  encodeULEB128(Filenames.size(), OS);
-  for (const auto &Filename : Filenames) {
-    encodeULEB128(Filename.size(), OS);
-    OS << Filename;
+/// \brief Write \p Data as its uncompressed size, its compressed size and the
+/// data itself. The compressed size is 0 if the data is stored uncompressed.
+static void writeCompressibleBlock(StringRef Data, raw_ostream &OS,
+                                   bool Compress) {
+  SmallString<128> CompressedData;
+  if (Compress && zlib::isAvailable() &&
+      zlib::compress(Data, CompressedData, zlib::BestSizeCompression) ==
+          zlib::StatusOK &&
+      CompressedData.size() < Data.size()) {
+    encodeULEB128(Data.size(), OS);
+    encodeULEB128(CompressedData.size(), OS);
+    OS << CompressedData;
+    return;
+  }
+  encodeULEB128(Data.size(), OS);
+  encodeULEB128(0, OS);
+  OS << Data;
+}
+
+void CoverageFilenamesSectionWriter::write(raw_ostream &OS, bool Compress) {
+  std::string Names;
+  {
+    raw_string_ostream NamesOS(Names);
+    for (const auto &Filename : Filenames) {
+      encodeULEB128(Filename.size(), NamesOS);
+      NamesOS << Filename;
+    }
   }
+  encodeULEB128(Filenames.size(), OS);
+  writeCompressibleBlock(Names, OS, Compress);
+}
+
+void CoverageMappingDataWriter::write(raw_ostream &OS, bool Compress) {
+  writeCompressibleBlock(MappingData, OS, Compress);
 }
 
 namespace {
@@ -19,9 +19,9 @@
 using namespace llvm;
 
 static Expected<std::unique_ptr<MemoryBuffer>>
-setupMemoryBuffer(const Twine &Path) {
+setupMemoryBuffer(const Twine &Path, bool RequiresNullTerminator = true) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
-      MemoryBuffer::getFileOrSTDIN(Path);
+      MemoryBuffer::getFileOrSTDIN(Path, -1, RequiresNullTerminator);
   if (std::error_code EC = BufferOrErr.getError())
     return errorCodeToError(EC);
   return std::move(BufferOrErr.get());
@@ -68,8 +68,11 @@ InstrProfReader::create(std::unique_ptr<MemoryBuffer> Buffer) {
 
 Expected<std::unique_ptr<IndexedInstrProfReader>>
 IndexedInstrProfReader::create(const Twine &Path) {
-  // Set up the buffer to read.
-  auto BufferOrError = setupMemoryBuffer(Path);
+  // Set up the buffer to read.  The indexed format is binary and does not
+  // need a null terminator, which lets large profiles always be mapped
+  // rather than read into a heap copy.
+  auto BufferOrError =
+      setupMemoryBuffer(Path, /*RequiresNullTerminator=*/false);
   if (Error E = BufferOrError.takeError())
     return std::move(E);
   return IndexedInstrProfReader::create(std::move(BufferOrError.get()));
@@ -170,7 +173,7 @@ TextInstrProfReader::readValueProfileData(InstrProfRecord &Record) {
     if (!NumValueSites)
       continue;
 
-    Record.reserveSites(VK, NumValueSites);
+    Record.reserveSites(ValueKind, NumValueSites);
     for (uint32_t S = 0; S < NumValueSites; S++) {
       VP_READ_ADVANCE(NumValueData);
 
@@ -179,7 +182,7 @@ TextInstrProfReader::readValueProfileData(InstrProfRecord &Record) {
         CHECK_LINE_END(Line);
         std::pair<StringRef, StringRef> VD = Line->rsplit(':');
         uint64_t TakenCount, Value;
-        if (VK == IPVK_IndirectCallTarget) {
+        if (ValueKind == IPVK_IndirectCallTarget) {
           Symtab->addFuncName(VD.first);
           Value = IndexedInstrProf::ComputeHash(VD.first);
         } else {
@@ -189,7 +192,8 @@ TextInstrProfReader::readValueProfileData(InstrProfRecord &Record) {
         CurrentValues.push_back({Value, TakenCount});
         Line++;
       }
-      Record.addValueData(VK, S, CurrentValues.data(), NumValueData, nullptr);
+      Record.addValueData(ValueKind, S, CurrentValues.data(), NumValueData,
+                          nullptr);
     }
   }
   return success();
@@ -523,6 +527,52 @@ data_type InstrProfLookupTrait::ReadData(StringRef K, const unsigned char *D,
   return DataBuffer;
 }
 
+Error InstrProfLookupTrait::findCounts(const unsigned char *D, offset_type N,
+                                       uint64_t FuncHash,
+                                       ArrayRef<support::ulittle64_t> &Counts) {
+  // This mirrors the layout walked by ReadData, but only decodes the record
+  // headers and skips over the value profile data of the other records.
+  if (N % sizeof(uint64_t))
+    return make_error<InstrProfError>(instrprof_error::malformed);
+
+  using namespace support;
+  const unsigned char *End = D + N;
+  while (D < End) {
+    if (D + sizeof(uint64_t) >= End)
+      return make_error<InstrProfError>(instrprof_error::malformed);
+    uint64_t Hash = endian::readNext<uint64_t, little, unaligned>(D);
+
+    uint64_t CountsSize = N / sizeof(uint64_t) - 1;
+    if (GET_VERSION(FormatVersion) != IndexedInstrProf::ProfVersion::Version1) {
+      if (D + sizeof(uint64_t) > End)
+        return make_error<InstrProfError>(instrprof_error::malformed);
+      CountsSize = endian::readNext<uint64_t, little, unaligned>(D);
+    }
+    if (D + CountsSize * sizeof(uint64_t) > End)
+      return make_error<InstrProfError>(instrprof_error::malformed);
+
+    const ulittle64_t *CountsBegin = reinterpret_cast<const ulittle64_t *>(D);
+    D += CountsSize * sizeof(uint64_t);
+    if (Hash == FuncHash) {
+      Counts = makeArrayRef(CountsBegin, CountsSize);
+      return Error::success();
+    }
+
+    if (GET_VERSION(FormatVersion) > IndexedInstrProf::ProfVersion::Version2) {
+      if (D + sizeof(ValueProfData) > End)
+        return make_error<InstrProfError>(instrprof_error::malformed);
+      uint32_t TotalSize =
+          ValueProfDataEndianness == little
+              ? endian::read<uint32_t, little, unaligned>(D)
+              : endian::read<uint32_t, big, unaligned>(D);
+      if (TotalSize < sizeof(ValueProfData) || D + TotalSize > End)
+        return make_error<InstrProfError>(instrprof_error::malformed);
+      D += TotalSize;
+    }
+  }
+  return make_error<InstrProfError>(instrprof_error::hash_mismatch);
+}
+
 template <typename HashTableImpl>
 Error InstrProfReaderIndex<HashTableImpl>::getRecords(
     StringRef FuncName, ArrayRef<InstrProfRecord> &Data) {
@@ -551,6 +601,44 @@ Error InstrProfReaderIndex<HashTableImpl>::getRecords(
   return Error::success();
 }
 
+template <typename HashTableImpl>
+Error InstrProfReaderIndex<HashTableImpl>::getCounts(
+    StringRef FuncName, uint64_t FuncHash,
+    ArrayRef<support::ulittle64_t> &Counts) {
+  auto Iter = HashTable->find(FuncName);
+  if (Iter == HashTable->end())
+    return make_error<InstrProfError>(instrprof_error::unknown_function);
+
+  return HashTable->getInfoObj().findCounts(Iter.getDataPtr(),
+                                            Iter.getDataLen(), FuncHash,
+                                            Counts);
+}
+
+template <typename HashTableImpl>
+void InstrProfReaderIndex<HashTableImpl>::prefetch(
+    ArrayRef<StringRef> FuncNames) {
+  typedef typename HashTableImpl::offset_type offset_type;
+  using namespace support;
+
+  const unsigned char *Buckets = HashTable->getBuckets();
+  offset_type NumBuckets = HashTable->getNumBuckets();
+  std::vector<const unsigned char *> Items;
+  Items.reserve(FuncNames.size());
+  for (StringRef Name : FuncNames) {
+    offset_type Idx =
+        HashTable->getInfoObj().ComputeHash(Name) & (NumBuckets - 1);
+    offset_type Offset = endian::read<offset_type, little, aligned>(
+        Buckets + sizeof(offset_type) * Idx);
+    if (Offset)
+      Items.push_back(HashTable->getBase() + Offset);
+  }
+
+  std::sort(Items.begin(), Items.end());
+  Items.erase(std::unique(Items.begin(), Items.end()), Items.end());
+  for (const unsigned char *Item : Items)
+    (void)*static_cast<const volatile unsigned char *>(Item);
+}
+
 template <typename HashTableImpl>
 InstrProfReaderIndex<HashTableImpl>::InstrProfReaderIndex(
     const unsigned char *Buckets, const unsigned char *const Payload,
@@ -694,14 +782,24 @@ IndexedInstrProfReader::getInstrProfRecord(StringRef FuncName,
 Error IndexedInstrProfReader::getFunctionCounts(StringRef FuncName,
                                                 uint64_t FuncHash,
                                                 std::vector<uint64_t> &Counts) {
-  Expected<InstrProfRecord> Record = getInstrProfRecord(FuncName, FuncHash);
-  if (Error E = Record.takeError())
+  ArrayRef<support::ulittle64_t> CountsRef;
+  if (Error E = getFunctionCounts(FuncName, FuncHash, CountsRef))
     return error(std::move(E));
 
-  Counts = Record.get().Counts;
+  Counts.assign(CountsRef.begin(), CountsRef.end());
   return success();
 }
 
+Error IndexedInstrProfReader::getFunctionCounts(
+    StringRef FuncName, uint64_t FuncHash,
+    ArrayRef<support::ulittle64_t> &Counts) const {
+  return Index->getCounts(FuncName, FuncHash, Counts);
+}
+
+void IndexedInstrProfReader::prefetchRecords(ArrayRef<StringRef> FuncNames) {
+  Index->prefetch(FuncNames);
+}
+
 Error IndexedInstrProfReader::readNextRecord(InstrProfRecord &Record) {
   static unsigned RecordIndex = 0;
 
@@ -16,6 +16,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/OnDiskHashTable.h"
+#include <algorithm>
 #include <tuple>
 
 using namespace llvm;
@@ -72,6 +73,20 @@ public:
   support::endian::Writer<support::little> LE;
 };
 
+/// Return the records of a function in hash order, so that the output does
+/// not depend on the order in which they were added to the writer.
+static SmallVector<const InstrProfRecord *, 1>
+getOrderedRecords(const InstrProfWriter::ProfilingData &PD) {
+  SmallVector<const InstrProfRecord *, 1> Records;
+  for (const auto &ProfileData : PD)
+    Records.push_back(&ProfileData.second);
+  std::sort(Records.begin(), Records.end(),
+            [](const InstrProfRecord *L, const InstrProfRecord *R) {
+              return L->Hash < R->Hash;
+            });
+  return Records;
+}
+
 class InstrProfRecordWriterTrait {
 public:
   typedef StringRef key_type;
@@ -121,18 +136,19 @@ public:
   void EmitData(raw_ostream &Out, key_type_ref, data_type_ref V, offset_type) {
     using namespace llvm::support;
     endian::Writer<little> LE(Out);
-    for (const auto &ProfileData : *V) {
-      const InstrProfRecord &ProfRecord = ProfileData.second;
+
+    for (const InstrProfRecord *Record : getOrderedRecords(*V)) {
+      const InstrProfRecord &ProfRecord = *Record;
       SummaryBuilder->addRecord(ProfRecord);
 
-      LE.write<uint64_t>(ProfileData.first); // Function hash
+      LE.write<uint64_t>(ProfRecord.Hash); // Function hash
       LE.write<uint64_t>(ProfRecord.Counts.size());
       for (uint64_t I : ProfRecord.Counts)
         LE.write<uint64_t>(I);
 
       // Write value data
       std::unique_ptr<ValueProfData> VDataPtr =
-          ValueProfData::serializeFrom(ProfileData.second);
+          ValueProfData::serializeFrom(ProfRecord);
       uint32_t S = VDataPtr->getSize();
       VDataPtr->swapBytesFromHost(ValueProfDataEndianness);
       Out.write((const char *)VDataPtr.get(), S);
@@ -182,6 +198,20 @@ Error InstrProfWriter::addRecord(InstrProfRecord &&I, uint64_t Weight) {
   return Dest.takeError();
 }
 
+Error InstrProfWriter::mergeRecordsFromWriter(
+    InstrProfWriter &&IPW, function_ref<void(Error, StringRef)> Warn) {
+  if (IPW.ProfileKind != PF_Unknown)
+    if (Error E = setIsIRLevelProfile(IPW.ProfileKind == PF_IRLevel))
+      return E;
+
+  for (auto &I : IPW.FunctionData)
+    for (auto &Func : I.getValue())
+      if (Error E = addRecord(std::move(Func.second)))
+        Warn(std::move(E), I.getKey());
+  IPW.FunctionData.clear();
+  return Error::success();
+}
+
 bool InstrProfWriter::shouldEncodeData(const ProfilingData &PD) {
   if (!Sparse)
     return true;
@@ -210,6 +240,21 @@ static void setSummary(IndexedInstrProf::Summary *TheSummary,
     TheSummary->setEntry(I, Res[I]);
 }
 
+std::vector<const StringMapEntry<InstrProfWriter::ProfilingData> *>
+InstrProfWriter::getOrderedFunctionData() {
+  std::vector<const StringMapEntry<ProfilingData> *> OrderedData;
+  OrderedData.reserve(FunctionData.size());
+  for (const auto &I : FunctionData)
+    if (shouldEncodeData(I.getValue()))
+      OrderedData.push_back(&I);
+  std::sort(OrderedData.begin(), OrderedData.end(),
+            [](const StringMapEntry<ProfilingData> *L,
+               const StringMapEntry<ProfilingData> *R) {
+              return L->getKey() < R->getKey();
+            });
+  return OrderedData;
+}
+
 void InstrProfWriter::writeImpl(ProfOStream &OS) {
   OnDiskChainedHashTableGenerator<InstrProfRecordWriterTrait> Generator;
 
@@ -217,10 +262,11 @@ void InstrProfWriter::writeImpl(ProfOStream &OS) {
   InstrProfSummaryBuilder ISB(ProfileSummaryBuilder::DefaultCutoffs);
   InfoObj->SummaryBuilder = &ISB;
 
-  // Populate the hash table generator.
-  for (const auto &I : FunctionData)
-    if (shouldEncodeData(I.getValue()))
-      Generator.insert(I.getKey(), &I.getValue());
+  // Populate the hash table generator in name order.  Entries that share a
+  // bucket are laid out in insertion order, so this keeps the output
+  // independent of how the records were merged into FunctionData.
+  for (const auto *I : getOrderedFunctionData())
+    Generator.insert(I->getKey(), &I->getValue());
   // Write the header.
   IndexedInstrProf::Header Header;
   Header.Magic = IndexedInstrProf::Magic;
@@ -336,14 +382,14 @@ void InstrProfWriter::writeRecordInText(const InstrProfRecord &Func,
 void InstrProfWriter::writeText(raw_fd_ostream &OS) {
   if (ProfileKind == PF_IRLevel)
     OS << "# IR level Instrumentation Flag\n:ir\n";
+  std::vector<const StringMapEntry<ProfilingData> *> OrderedData =
+      getOrderedFunctionData();
   InstrProfSymtab Symtab;
-  for (const auto &I : FunctionData)
-    if (shouldEncodeData(I.getValue()))
-      Symtab.addFuncName(I.getKey());
+  for (const auto *I : OrderedData)
+    Symtab.addFuncName(I->getKey());
   Symtab.finalizeSymtab();
 
-  for (const auto &I : FunctionData)
-    if (shouldEncodeData(I.getValue()))
-      for (const auto &Func : I.getValue())
-        writeRecordInText(Func.second, Symtab, OS);
+  for (const auto *I : OrderedData)
+    for (const InstrProfRecord *Record : getOrderedRecords(I->getValue()))
+      writeRecordInText(*Record, Symtab, OS);
 }
@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ProfileData/SampleProf.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 
@@ -137,3 +138,32 @@ raw_ostream &llvm::sampleprof::operator<<(raw_ostream &OS,
 }
 
 void FunctionSamples::dump(void) const { print(dbgs(), 0); }
+
+bool SampleContext::parse(StringRef Name,
+                          SmallVectorImpl<SampleContextFrame> &Frames) {
+  Frames.clear();
+  if (!Name.startswith("[") || !Name.endswith("]"))
+    return false;
+
+  SmallVector<StringRef, 4> Parts;
+  Name.substr(1, Name.size() - 2).split(Parts, " @ ");
+  if (Parts.size() < 2 || Parts.back().empty())
+    return false;
+
+  // Every frame but the last is "caller:offset[.discriminator]".
+  for (StringRef Part : makeArrayRef(Parts).drop_back()) {
+    size_t Colon = Part.rfind(':');
+    if (Colon == StringRef::npos || Colon == 0)
+      return false;
+    StringRef Offset, Discriminator;
+    std::tie(Offset, Discriminator) = Part.substr(Colon + 1).split('.');
+    uint32_t LineOffset, Discr = 0;
+    if (Offset.getAsInteger(10, LineOffset))
+      return false;
+    if (!Discriminator.empty() && Discriminator.getAsInteger(10, Discr))
+      return false;
+    Frames.emplace_back(Part.substr(0, Colon), LineLocation(LineOffset, Discr));
+  }
+  Frames.emplace_back(Parts.back(), LineLocation(0, 0));
+  return true;
+}
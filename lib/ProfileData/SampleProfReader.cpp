@@ -8,7 +8,7 @@
 //===----------------------------------------------------------------------===//
 //
 // This file implements the class that reads LLVM sample profiles. It
-// supports three file formats: text, binary and gcov.
+// supports three file formats: text, binary (plain or indexed) and gcov.
 //
 // The textual representation is useful for debugging and testing purposes. The
 // binary representation is more compact, resulting in smaller file sizes.
@@ -71,6 +71,13 @@ static bool ParseHead(const StringRef &Input, StringRef &FName,
 /// \brief Returns true if line offset \p L is legal (only has 16 bits).
 static bool isOffsetLegal(unsigned L) { return (L & 0xffff) == L; }
 
+/// \brief Returns true if \p FName is a function name or a well-formed
+/// calling context.
+static bool isProfileNameLegal(StringRef FName) {
+  SmallVector<SampleContextFrame, 4> Frames;
+  return !SampleContext::isContext(FName) || SampleContext::parse(FName, Frames);
+}
+
 /// \brief Parse \p Input as line sample.
 ///
 /// \param Input input line.
@@ -175,6 +182,12 @@ std::error_code SampleProfileReaderText::read() {
                     "Expected 'mangled_name:NUM:NUM', found " + *LineIt);
         return sampleprof_error::malformed;
       }
+      if (!isProfileNameLegal(FName)) {
+        reportError(LineIt.line_number(),
+                    "Expected '[mangled_name:NUM[.NUM] @ ... @ mangled_name]'"
+                    ", found " + FName);
+        return sampleprof_error::malformed;
+      }
       Profiles[FName] = FunctionSamples();
       FunctionSamples &FProfile = Profiles[FName];
       FProfile.setName(FName);
@@ -362,23 +375,32 @@ SampleProfileReaderBinary::readProfile(FunctionSamples &FProfile) {
   return sampleprof_error::success;
 }
 
-std::error_code SampleProfileReaderBinary::read() {
-  while (!at_eof()) {
-    auto NumHeadSamples = readNumber<uint64_t>();
-    if (std::error_code EC = NumHeadSamples.getError())
-      return EC;
+std::error_code SampleProfileReaderBinary::readFuncProfile() {
+  auto NumHeadSamples = readNumber<uint64_t>();
+  if (std::error_code EC = NumHeadSamples.getError())
+    return EC;
 
-    auto FName(readStringFromTable());
-    if (std::error_code EC = FName.getError())
-      return EC;
+  auto FName(readStringFromTable());
+  if (std::error_code EC = FName.getError())
+    return EC;
 
-    Profiles[*FName] = FunctionSamples();
-    FunctionSamples &FProfile = Profiles[*FName];
-    FProfile.setName(*FName);
+  if (!isProfileNameLegal(*FName)) {
+    reportError(0, "Malformed calling context " + *FName);
+    return sampleprof_error::malformed;
+  }
 
-    FProfile.addHeadSamples(*NumHeadSamples);
+  Profiles[*FName] = FunctionSamples();
+  FunctionSamples &FProfile = Profiles[*FName];
+  FProfile.setName(*FName);
 
-    if (std::error_code EC = readProfile(FProfile))
+  FProfile.addHeadSamples(*NumHeadSamples);
+
+  return readProfile(FProfile);
+}
+
+std::error_code SampleProfileReaderBinary::read() {
+  while (!at_eof()) {
+    if (std::error_code EC = readFuncProfile())
       return EC;
   }
 
@@ -393,7 +415,7 @@ std::error_code SampleProfileReaderBinary::readHeader() {
   auto Magic = readNumber<uint64_t>();
   if (std::error_code EC = Magic.getError())
     return EC;
-  else if (*Magic != SPMagic())
+  else if (*Magic != getMagic())
     return sampleprof_error::bad_magic;
 
   // Read the version number.
@@ -484,6 +506,83 @@ bool SampleProfileReaderBinary::hasFormat(const MemoryBuffer &Buffer) {
   return Magic == SPMagic();
 }
 
+std::error_code SampleProfileReaderIndexedBinary::readHeader() {
+  if (std::error_code EC = SampleProfileReaderBinary::readHeader())
+    return EC;
+
+  // Read the function offset table. The bodies follow it.
+  auto NumFunctions = readNumber<uint32_t>();
+  if (std::error_code EC = NumFunctions.getError())
+    return EC;
+  FuncOffsets.reserve(*NumFunctions);
+  for (uint32_t I = 0; I < *NumFunctions; ++I) {
+    auto FName(readStringFromTable());
+    if (std::error_code EC = FName.getError())
+      return EC;
+
+    auto NumSamples = readNumber<uint64_t>();
+    if (std::error_code EC = NumSamples.getError())
+      return EC;
+
+    auto Offset = readNumber<uint64_t>();
+    if (std::error_code EC = Offset.getError())
+      return EC;
+
+    FuncOffsets[*FName] = *Offset;
+    TotalSamples += *NumSamples;
+  }
+  Bodies = Data;
+
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileReaderIndexedBinary::read() {
+  Data = Bodies;
+  return SampleProfileReaderBinary::read();
+}
+
+std::error_code
+SampleProfileReaderIndexedBinary::readFuncProfileAt(uint64_t Offset) {
+  if (Offset >= static_cast<uint64_t>(End - Bodies)) {
+    reportError(0, "Function offset is out of the profile");
+    return sampleprof_error::malformed;
+  }
+  Data = Bodies + Offset;
+  return readFuncProfile();
+}
+
+std::error_code SampleProfileReaderIndexedBinary::readOnDemand() {
+  // The calling contexts of a function are not named after it, so decode
+  // them all up front for the loader to look through.
+  for (const auto &I : FuncOffsets)
+    if (SampleContext::isContext(I.first))
+      if (std::error_code EC = readFuncProfileAt(I.second))
+        return EC;
+  return sampleprof_error::success;
+}
+
+FunctionSamples *
+SampleProfileReaderIndexedBinary::getSamplesFor(StringRef FName) {
+  auto I = Profiles.find(FName);
+  if (I != Profiles.end())
+    return &I->second;
+
+  // Decode the function the first time it is asked for. The profile is not
+  // usable if it was only partly decoded.
+  FunctionSamples &FProfile = Profiles[FName];
+  auto Offset = FuncOffsets.find(FName);
+  if (Offset != FuncOffsets.end() && readFuncProfileAt(Offset->second))
+    FProfile = FunctionSamples();
+  return &FProfile;
+}
+
+bool SampleProfileReaderIndexedBinary::hasFormat(const MemoryBuffer &Buffer) {
+  const uint8_t *Data =
+      reinterpret_cast<const uint8_t *>(Buffer.getBufferStart());
+  uint64_t Magic = decodeULEB128(Data);
+  return Magic == SPIndexedMagic();
+}
+
 std::error_code SampleProfileReaderGCC::skipNextWord() {
   uint32_t dummy;
   if (!GcovBuffer.readInt(dummy))
@@ -775,7 +874,9 @@ SampleProfileReader::create(const Twine &Filename, LLVMContext &C) {
 ErrorOr<std::unique_ptr<SampleProfileReader>>
 SampleProfileReader::create(std::unique_ptr<MemoryBuffer> &B, LLVMContext &C) {
   std::unique_ptr<SampleProfileReader> Reader;
-  if (SampleProfileReaderBinary::hasFormat(*B))
+  if (SampleProfileReaderIndexedBinary::hasFormat(*B))
+    Reader.reset(new SampleProfileReaderIndexedBinary(std::move(B), C));
+  else if (SampleProfileReaderBinary::hasFormat(*B))
     Reader.reset(new SampleProfileReaderBinary(std::move(B), C));
   else if (SampleProfileReaderGCC::hasFormat(*B))
     Reader.reset(new SampleProfileReaderGCC(std::move(B), C));
@@ -114,7 +114,7 @@ std::error_code SampleProfileWriterBinary::writeHeader(
   auto &OS = *OutputStream;
 
   // Write file magic identifier.
-  encodeULEB128(SPMagic(), OS);
+  encodeULEB128(getMagic(), OS);
   encodeULEB128(SPVersion(), OS);
 
   computeSummary(ProfileMap);
@@ -200,6 +200,44 @@ std::error_code SampleProfileWriterBinary::write(const FunctionSamples &S) {
   return writeBody(S);
 }
 
+/// \brief Write all the profiles to an indexed binary file.
+///
+/// The function offset table goes before the function bodies, so the bodies
+/// are first encoded into a buffer to learn where each of them starts.
+std::error_code SampleProfileWriterIndexedBinary::write(
+    const StringMap<FunctionSamples> &ProfileMap) {
+  if (std::error_code EC = writeHeader(ProfileMap))
+    return EC;
+
+  std::string Bodies;
+  std::vector<uint64_t> Offsets;
+  Offsets.reserve(ProfileMap.size());
+  std::unique_ptr<raw_ostream> BodiesOS(new raw_string_ostream(Bodies));
+  std::swap(OutputStream, BodiesOS);
+  for (const auto &I : ProfileMap) {
+    Offsets.push_back(OutputStream->tell());
+    if (std::error_code EC = write(I.second)) {
+      std::swap(OutputStream, BodiesOS);
+      return EC;
+    }
+  }
+  std::swap(OutputStream, BodiesOS);
+  BodiesOS->flush();
+
+  auto &OS = *OutputStream;
+  encodeULEB128(ProfileMap.size(), OS);
+  auto Offset = Offsets.begin();
+  for (const auto &I : ProfileMap) {
+    const FunctionSamples &Profile = I.second;
+    if (std::error_code EC = writeNameIdx(Profile.getName()))
+      return EC;
+    encodeULEB128(Profile.getTotalSamples(), OS);
+    encodeULEB128(*Offset++, OS);
+  }
+  OS << Bodies;
+  return sampleprof_error::success;
+}
+
 /// \brief Create a sample profile file writer based on the specified format.
 ///
 /// \param Filename The file to create.
@@ -213,7 +251,7 @@ ErrorOr<std::unique_ptr<SampleProfileWriter>>
 SampleProfileWriter::create(StringRef Filename, SampleProfileFormat Format) {
   std::error_code EC;
   std::unique_ptr<raw_ostream> OS;
-  if (Format == SPF_Binary)
+  if (Format == SPF_Binary || Format == SPF_Indexed_Binary)
     OS.reset(new raw_fd_ostream(Filename, EC, sys::fs::F_None));
   else
     OS.reset(new raw_fd_ostream(Filename, EC, sys::fs::F_Text));
@@ -240,6 +278,8 @@ SampleProfileWriter::create(std::unique_ptr<raw_ostream> &OS,
 
   if (Format == SPF_Binary)
     Writer.reset(new SampleProfileWriterBinary(OS));
+  else if (Format == SPF_Indexed_Binary)
+    Writer.reset(new SampleProfileWriterIndexedBinary(OS));
   else if (Format == SPF_Text)
     Writer.reset(new SampleProfileWriterText(OS));
   else if (Format == SPF_GCC)
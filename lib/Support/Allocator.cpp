@@ -7,15 +7,125 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file implements the BumpPtrAllocator interface.
+// This file implements the BumpPtrAllocator interface, and the registry of
+// allocators reported by -print-memory-usage.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
+#include <map>
+#include <string>
+#include <vector>
 
 namespace llvm {
 
+static cl::opt<bool> PrintMemoryUsageAtExit(
+    "print-memory-usage",
+    cl::desc("Print the memory held by the registered allocators"));
+
+namespace {
+/// The memory usage of all allocators registered under one name.
+struct AllocatorUsage {
+  unsigned NumLive = 0;
+  unsigned NumDestroyed = 0;
+  /// The largest total memory seen for a single allocator, sampled when it
+  /// is destroyed and when the report is printed.
+  size_t MaxTotalMemory = 0;
+};
+
+/// The allocators registered so far, and the usage recorded for each name.
+struct MemoryUsageRegistry {
+  sys::SmartMutex<true> Lock;
+  std::vector<const MemoryUsageReporter *> Live;
+  std::map<std::string, AllocatorUsage> Usage;
+};
+
+/// MemoryUsagePrinter - This class is used in a ManagedStatic so that it is
+/// destroyed only when llvm_shutdown is called.  We print the report from the
+/// destructor.
+struct MemoryUsagePrinter {
+  ~MemoryUsagePrinter() {
+    if (PrintMemoryUsageAtExit)
+      PrintMemoryUsage();
+  }
+};
+} // end anonymous namespace
+
+/// Return the registry. It is never destroyed, since allocators can be
+/// destroyed after llvm_shutdown, e.g. those of an LLVMContext declared before
+/// the llvm_shutdown_obj, and static allocators are destroyed in no particular
+/// order at exit.
+static MemoryUsageRegistry &getRegistry() {
+  static MemoryUsageRegistry *Registry = new MemoryUsageRegistry();
+  return *Registry;
+}
+
+static ManagedStatic<MemoryUsagePrinter> Printer;
+
+void MemoryUsageReporter::registerReporter() {
+  // Make sure the report is printed on llvm_shutdown.
+  (void)*Printer;
+  MemoryUsageRegistry &Registry = getRegistry();
+  sys::SmartScopedLock<true> Guard(Registry.Lock);
+  Registry.Live.push_back(this);
+  ++Registry.Usage[Name].NumLive;
+}
+
+void MemoryUsageReporter::unregisterReporter() {
+  MemoryUsageRegistry &Registry = getRegistry();
+  sys::SmartScopedLock<true> Guard(Registry.Lock);
+  auto &Live = Registry.Live;
+  auto I = std::find(Live.begin(), Live.end(), this);
+  assert(I != Live.end() && "Reporter was not registered!");
+  Live.erase(I);
+  AllocatorUsage &U = Registry.Usage[Name];
+  --U.NumLive;
+  ++U.NumDestroyed;
+  U.MaxTotalMemory = std::max(U.MaxTotalMemory, getTotalMemory());
+}
+
+void PrintMemoryUsage(raw_ostream &OS) {
+  MemoryUsageRegistry &Registry = getRegistry();
+  sys::SmartScopedLock<true> Guard(Registry.Lock);
+
+  // Sum up the live allocators of each name.
+  std::map<std::string, std::pair<size_t, size_t>> Current;
+  for (const MemoryUsageReporter *R : Registry.Live) {
+    size_t Total = R->getTotalMemory();
+    std::pair<size_t, size_t> &C = Current[R->getName()];
+    C.first += Total;
+    C.second += R->getBytesAllocated();
+    AllocatorUsage &U = Registry.Usage[R->getName()];
+    U.MaxTotalMemory = std::max(U.MaxTotalMemory, Total);
+  }
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "                          ... Allocator memory usage ...\n"
+     << "===" << std::string(73, '-') << "===\n\n"
+     << "  Live  Freed   Bytes held   Bytes used    Max bytes  Allocator\n";
+  for (const auto &NameAndUsage : Registry.Usage) {
+    const AllocatorUsage &U = NameAndUsage.second;
+    std::pair<size_t, size_t> C = Current[NameAndUsage.first];
+    OS << format_decimal(U.NumLive, 6) << format_decimal(U.NumDestroyed, 7)
+       << format_decimal(C.first, 13) << format_decimal(C.second, 13)
+       << format_decimal(U.MaxTotalMemory, 13) << "  " << NameAndUsage.first
+       << '\n';
+  }
+  OS << '\n';
+  OS.flush();
+}
+
+void PrintMemoryUsage() {
+  std::unique_ptr<raw_ostream> OutStream = CreateInfoOutputFile();
+  PrintMemoryUsage(*OutStream);
+}
+
 namespace detail {
 
 void printBumpPtrAllocatorStats(unsigned NumSlabs, size_t BytesAllocated,
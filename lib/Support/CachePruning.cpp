@@ -21,7 +21,9 @@
 
 #define DEBUG_TYPE "cache-pruning"
 
+#include <limits>
 #include <set>
+#include <tuple>
 
 using namespace llvm;
 
@@ -44,7 +46,8 @@ bool CachePruning::prune() {
   if (!isPathDir)
     return false;
 
-  if (Expiration == 0 && PercentageOfAvailableSpace == 0) {
+  if (Expiration == 0 && PercentageOfAvailableSpace == 0 &&
+      MaxSizeBytes == 0) {
     DEBUG(dbgs() << "No pruning settings set, exit early\n");
     // Nothing will be pruned, early exit
     return false;
@@ -82,20 +85,22 @@ bool CachePruning::prune() {
     writeTimestampFile(TimestampFile);
   }
 
-  bool ShouldComputeSize = (PercentageOfAvailableSpace > 0);
+  bool ShouldComputeSize =
+      (PercentageOfAvailableSpace > 0 || MaxSizeBytes > 0);
 
   // Keep track of space
-  std::set<std::pair<uint64_t, std::string>> FileSizes;
+  std::set<std::tuple<sys::TimeValue, uint64_t, std::string>> FileAccesses;
   uint64_t TotalSize = 0;
   // Helper to add a path to the set of files to consider for size-based
-  // pruning, sorted by size.
+  // pruning, sorted by last access time.
   auto AddToFileListForSizePruning =
       [&](StringRef Path) {
         if (!ShouldComputeSize)
           return;
         TotalSize += FileStatus.getSize();
-        FileSizes.insert(
-            std::make_pair(FileStatus.getSize(), std::string(Path)));
+        FileAccesses.insert(std::make_tuple(FileStatus.getLastAccessedTime(),
+                                            FileStatus.getSize(),
+                                            std::string(Path)));
       };
 
   // Walk the entire directory cache, looking for unused files.
@@ -120,7 +125,7 @@ bool CachePruning::prune() {
     // If the file hasn't been used recently enough, delete it
     sys::TimeValue FileAccessTime = FileStatus.getLastAccessedTime();
     auto FileAge = CurrentTime - FileAccessTime;
-    if (FileAge > TimeExpiration) {
+    if (Expiration && FileAge > TimeExpiration) {
       DEBUG(dbgs() << "Remove " << File->path() << " (" << FileAge.seconds()
                    << "s old)\n");
       sys::fs::remove(File->path());
@@ -133,26 +138,33 @@ bool CachePruning::prune() {
 
   // Prune for size now if needed
   if (ShouldComputeSize) {
-    auto ErrOrSpaceInfo = sys::fs::disk_space(Path);
-    if (!ErrOrSpaceInfo) {
-      report_fatal_error("Can't get available size");
+    uint64_t TargetSize = std::numeric_limits<uint64_t>::max();
+    if (PercentageOfAvailableSpace) {
+      auto ErrOrSpaceInfo = sys::fs::disk_space(Path);
+      if (!ErrOrSpaceInfo) {
+        report_fatal_error("Can't get available size");
+      }
+      sys::fs::space_info SpaceInfo = ErrOrSpaceInfo.get();
+      auto AvailableSpace = TotalSize + SpaceInfo.free;
+      TargetSize = AvailableSpace / 100 * PercentageOfAvailableSpace;
     }
-    sys::fs::space_info SpaceInfo = ErrOrSpaceInfo.get();
-    auto AvailableSpace = TotalSize + SpaceInfo.free;
-    auto FileAndSize = FileSizes.rbegin();
-    DEBUG(dbgs() << "Occupancy: " << ((100 * TotalSize) / AvailableSpace)
-                 << "% target is: " << PercentageOfAvailableSpace << "\n");
-    // Remove the oldest accessed files first, till we get below the threshold
-    while (((100 * TotalSize) / AvailableSpace) > PercentageOfAvailableSpace &&
-           FileAndSize != FileSizes.rend()) {
+    if (MaxSizeBytes)
+      TargetSize = std::min(TargetSize, MaxSizeBytes);
+    DEBUG(dbgs() << "Occupancy: " << TotalSize << " bytes, target is: "
+                 << TargetSize << " bytes\n");
+    // Remove the least recently accessed files first, till we get below the
+    // threshold
+    for (auto FileAccess = FileAccesses.begin();
+         TotalSize > TargetSize && FileAccess != FileAccesses.end();
+         ++FileAccess) {
+      uint64_t FileSize = std::get<1>(*FileAccess);
+      const std::string &FilePath = std::get<2>(*FileAccess);
       // Remove the file.
-      sys::fs::remove(FileAndSize->second);
+      sys::fs::remove(FilePath);
       // Update size
-      TotalSize -= FileAndSize->first;
-      DEBUG(dbgs() << " - Remove " << FileAndSize->second << " (size "
-                   << FileAndSize->first << "), new occupancy is " << TotalSize
-                   << "%\n");
-      ++FileAndSize;
+      TotalSize -= FileSize;
+      DEBUG(dbgs() << " - Remove " << FilePath << " (size " << FileSize
+                   << "), new occupancy is " << TotalSize << " bytes\n");
     }
   }
   return true;
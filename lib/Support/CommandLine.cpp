@@ -191,6 +191,21 @@ public:
     }
   }
 
+  /// Queue \p O to be added by the next registerPendingOptions().
+  void addPendingOption(Option *O) { PendingOptions.push_back(O); }
+
+  /// Add the options queued by addPendingOption(), in the order they were
+  /// queued. This must be called before looking at the option maps of the
+  /// subcommands.
+  void registerPendingOptions() {
+    if (LLVM_LIKELY(PendingOptions.empty()))
+      return;
+    std::vector<Option *> Pending;
+    Pending.swap(PendingOptions);
+    for (Option *O : Pending)
+      addOption(O);
+  }
+
   void removeOption(Option *O, SubCommand *SC) {
     SmallVector<StringRef, 16> OptionNames;
     O->getExtraOptionNames(OptionNames);
@@ -221,6 +236,7 @@ public:
   }
 
   void removeOption(Option *O) {
+    registerPendingOptions();
     if (O->Subs.empty())
       removeOption(O, &*TopLevelSubCommand);
     else {
@@ -260,6 +276,7 @@ public:
   }
 
   void updateArgStr(Option *O, StringRef NewName) {
+    registerPendingOptions();
     if (O->Subs.empty())
       updateArgStr(O, NewName, &*TopLevelSubCommand);
     else {
@@ -287,6 +304,9 @@ public:
                              (Sub->getName() == sub->getName());
                     }) == 0 &&
            "Duplicate subcommands");
+    // Add the queued options first: like options added eagerly, they are
+    // then added to this subcommand by the loop below, if at all.
+    registerPendingOptions();
     RegisteredSubCommands.insert(sub);
 
     // For all options that have been registered for all subcommands, add the
@@ -304,6 +324,7 @@ public:
   }
 
   void unregisterSubCommand(SubCommand *sub) {
+    registerPendingOptions();
     RegisteredSubCommands.erase(sub);
   }
 
@@ -316,6 +337,7 @@ public:
     RegisteredOptionCategories.clear();
 
     ResetAllOptionOccurrences();
+    PendingOptions.clear();
     RegisteredSubCommands.clear();
 
     TopLevelSubCommand->reset();
@@ -327,6 +349,12 @@ public:
 private:
   SubCommand *ActiveSubCommand;
 
+  // Options are not added to the option maps when they are constructed, but
+  // queued here until the maps are first needed. Adding an option takes a
+  // few StringMap insertions, which adds up for tools that link in thousands
+  // of options, all constructed at startup.
+  std::vector<Option *> PendingOptions;
+
   Option *LookupOption(SubCommand &Sub, StringRef &Arg, StringRef &Value);
   SubCommand *LookupSubCommand(const char *Name);
 };
@@ -344,7 +372,7 @@ extrahelp::extrahelp(const char *Help) : morehelp(Help) {
 }
 
 void Option::addArgument() {
-  GlobalParser->addOption(this);
+  GlobalParser->addPendingOption(this);
   FullyInitialized = true;
 }
 
@@ -403,6 +431,9 @@ Option *CommandLineParser::LookupOption(SubCommand &Sub, StringRef &Arg,
     return nullptr;
   assert(&Sub != &*AllSubCommands);
 
+  // Options may have been created while parsing, e.g. by loading a plugin.
+  registerPendingOptions();
+
   size_t EqualPos = Arg.find('=');
 
   // If we have an equals sign, remember the value.
@@ -998,6 +1029,7 @@ bool cl::ParseCommandLineOptions(int argc, const char *const *argv,
 void CommandLineParser::ResetAllOptionOccurrences() {
   // So that we can parse different command lines multiple times in succession
   // we reset all option values to look like they have never been seen before.
+  registerPendingOptions();
   for (auto SC : RegisteredSubCommands) {
     for (auto &O : SC->OptionsMap)
       O.second->reset();
@@ -1008,8 +1040,6 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
                                                 const char *const *argv,
                                                 const char *Overview,
                                                 bool IgnoreErrors) {
-  assert(hasOptions() && "No options specified!");
-
   // Expand response files.
   SmallVector<const char *, 20> newArgv(argv, argv + argc);
   BumpPtrAllocator A;
@@ -1021,6 +1051,9 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
   // Copy the program name into ProgName, making sure not to overflow it.
   ProgramName = sys::path::filename(argv[0]);
 
+  registerPendingOptions();
+  assert(hasOptions() && "No options specified!");
+
   ProgramOverview = Overview;
   bool ErrorParsing = false;
 
@@ -1751,6 +1784,7 @@ public:
     if (!Value)
       return;
 
+    GlobalParser->registerPendingOptions();
     SubCommand *Sub = GlobalParser->getActiveSubCommand();
     auto &OptionsMap = Sub->OptionsMap;
     auto &PositionalOpts = Sub->PositionalOpts;
@@ -2005,6 +2039,7 @@ void CommandLineParser::printOptionValues() {
   if (!PrintOptions && !PrintAllOptions)
     return;
 
+  registerPendingOptions();
   SmallVector<std::pair<const char *, Option *>, 128> Opts;
   sortOpts(ActiveSubCommand->OptionsMap, Opts, /*ShowHidden*/ true);
 
@@ -2119,10 +2154,12 @@ StringMap<Option *> &cl::getRegisteredOptions(SubCommand &Sub) {
   auto &Subs = GlobalParser->RegisteredSubCommands;
   (void)Subs;
   assert(std::find(Subs.begin(), Subs.end(), &Sub) != Subs.end());
+  GlobalParser->registerPendingOptions();
   return Sub.OptionsMap;
 }
 
 void cl::HideUnrelatedOptions(cl::OptionCategory &Category, SubCommand &Sub) {
+  GlobalParser->registerPendingOptions();
   for (auto &I : Sub.OptionsMap) {
     if (I.second->Category != &Category &&
         I.second->Category != &GenericCategory)
@@ -2134,6 +2171,7 @@ void cl::HideUnrelatedOptions(ArrayRef<const cl::OptionCategory *> Categories,
                               SubCommand &Sub) {
   auto CategoriesBegin = Categories.begin();
   auto CategoriesEnd = Categories.end();
+  GlobalParser->registerPendingOptions();
   for (auto &I : Sub.OptionsMap) {
     if (std::find(CategoriesBegin, CategoriesEnd, I.second->Category) ==
             CategoriesEnd &&
@@ -10,6 +10,7 @@
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/LEB128.h"
 #include "llvm/Support/SwapByteOrder.h"
 using namespace llvm;
 
@@ -133,6 +134,16 @@ uint64_t DataExtractor::getULEB128(uint32_t *offset_ptr) const {
   if (Data.empty())
     return 0;
 
+  if (isValidOffset(*offset_ptr)) {
+    const uint8_t *Next = decodeULEB128Array(
+        Data.bytes_begin() + *offset_ptr, Data.bytes_end(), &result, 1);
+    if (Next) {
+      *offset_ptr = Next - Data.bytes_begin();
+      return result;
+    }
+  }
+
+  // The value is truncated: consume what is left of it.
   unsigned shift = 0;
   uint32_t offset = *offset_ptr;
   uint8_t byte = 0;
@@ -154,6 +165,16 @@ int64_t DataExtractor::getSLEB128(uint32_t *offset_ptr) const {
   if (Data.empty())
     return 0;
 
+  if (isValidOffset(*offset_ptr)) {
+    const uint8_t *Next = decodeSLEB128Array(
+        Data.bytes_begin() + *offset_ptr, Data.bytes_end(), &result, 1);
+    if (Next) {
+      *offset_ptr = Next - Data.bytes_begin();
+      return result;
+    }
+  }
+
+  // The value is truncated: consume what is left of it.
   unsigned shift = 0;
   uint32_t offset = *offset_ptr;
   uint8_t byte = 0;
@@ -173,3 +194,27 @@ int64_t DataExtractor::getSLEB128(uint32_t *offset_ptr) const {
   *offset_ptr = offset;
   return result;
 }
+
+uint64_t *DataExtractor::getULEB128(uint32_t *offset_ptr, uint64_t *dst,
+                                    uint32_t count) const {
+  if (count == 0 || !isValidOffset(*offset_ptr))
+    return nullptr;
+  const uint8_t *Next = decodeULEB128Array(Data.bytes_begin() + *offset_ptr,
+                                           Data.bytes_end(), dst, count);
+  if (!Next)
+    return nullptr;
+  *offset_ptr = Next - Data.bytes_begin();
+  return dst;
+}
+
+int64_t *DataExtractor::getSLEB128(uint32_t *offset_ptr, int64_t *dst,
+                                   uint32_t count) const {
+  if (count == 0 || !isValidOffset(*offset_ptr))
+    return nullptr;
+  const uint8_t *Next = decodeSLEB128Array(Data.bytes_begin() + *offset_ptr,
+                                           Data.bytes_end(), dst, count);
+  if (!Next)
+    return nullptr;
+  *offset_ptr = Next - Data.bytes_begin();
+  return dst;
+}
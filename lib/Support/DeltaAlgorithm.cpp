@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/DeltaAlgorithm.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
 #include <iterator>
 using namespace llvm;
@@ -25,6 +26,34 @@ bool DeltaAlgorithm::GetTestResult(const changeset_ty &Changes) {
   return Result;
 }
 
+void DeltaAlgorithm::GetTestResults(const changesetlist_ty &Batch,
+                                    std::vector<bool> &Results) {
+  Results.assign(Batch.size(), false);
+  if (NumThreads == 1 || Batch.size() == 1) {
+    for (unsigned i = 0, e = Batch.size(); i != e; ++i)
+      Results[i] = GetTestResult(Batch[i]);
+    return;
+  }
+
+  // The tests write into their own slot; the cache is only touched here.
+  std::vector<char> Passed(Batch.size(), 0);
+  {
+    ThreadPool Pool(std::min<unsigned>(NumThreads, Batch.size()));
+    for (unsigned i = 0, e = Batch.size(); i != e; ++i)
+      if (!FailedTestsCache.count(Batch[i]))
+        Pool.async([this, &Batch, &Passed, i] {
+          Passed[i] = ExecuteOneTest(Batch[i]);
+        });
+    Pool.wait();
+  }
+
+  for (unsigned i = 0, e = Batch.size(); i != e; ++i) {
+    Results[i] = Passed[i];
+    if (!Passed[i])
+      FailedTestsCache.insert(Batch[i]);
+  }
+}
+
 void DeltaAlgorithm::Split(const changeset_ty &S, changesetlist_ty &Res) {
   // FIXME: Allow clients to provide heuristics for improved splitting.
 
@@ -69,32 +98,52 @@ DeltaAlgorithm::Delta(const changeset_ty &Changes,
 bool DeltaAlgorithm::Search(const changeset_ty &Changes,
                             const changesetlist_ty &Sets,
                             changeset_ty &Res) {
-  // FIXME: Parallelize.
-  for (changesetlist_ty::const_iterator it = Sets.begin(),
-         ie = Sets.end(); it != ie; ++it) {
-    // If the test passes on this subset alone, recurse.
-    if (GetTestResult(*it)) {
-      changesetlist_ty Sets;
-      Split(*it, Sets);
-      Res = Delta(*it, Sets);
-      return true;
-    }
-
-    // Otherwise, if we have more than two sets, see if test passes on the
-    // complement.
-    if (Sets.size() > 2) {
+  // The candidates are tried in order: each subset alone and then, if we
+  // have more than two sets, its complement. They are tested NumThreads at a
+  // time, and the first passing candidate in that order is taken.
+  bool TryComplements = Sets.size() > 2;
+  unsigned NumCandidates = TryComplements ? 2 * Sets.size() : Sets.size();
+  changesetlist_ty Batch;
+  std::vector<bool> Results;
+  for (unsigned Begin = 0; Begin < NumCandidates; Begin += NumThreads) {
+    unsigned End = std::min(Begin + NumThreads, NumCandidates);
+    Batch.clear();
+    for (unsigned i = Begin; i != End; ++i) {
+      if (!TryComplements || i % 2 == 0) {
+        Batch.push_back(Sets[TryComplements ? i / 2 : i]);
+        continue;
+      }
       // FIXME: This is really slow.
+      const changeset_ty &S = Sets[i / 2];
       changeset_ty Complement;
       std::set_difference(
-        Changes.begin(), Changes.end(), it->begin(), it->end(),
+        Changes.begin(), Changes.end(), S.begin(), S.end(),
         std::insert_iterator<changeset_ty>(Complement, Complement.begin()));
-      if (GetTestResult(Complement)) {
-        changesetlist_ty ComplementSets;
-        ComplementSets.insert(ComplementSets.end(), Sets.begin(), it);
-        ComplementSets.insert(ComplementSets.end(), it + 1, Sets.end());
-        Res = Delta(Complement, ComplementSets);
+      Batch.push_back(std::move(Complement));
+    }
+
+    GetTestResults(Batch, Results);
+    for (unsigned i = Begin; i != End; ++i) {
+      if (!Results[i - Begin])
+        continue;
+      const changeset_ty &Passing = Batch[i - Begin];
+
+      // If the test passes on this subset alone, recurse.
+      if (!TryComplements || i % 2 == 0) {
+        changesetlist_ty SubSets;
+        Split(Passing, SubSets);
+        Res = Delta(Passing, SubSets);
         return true;
       }
+
+      // Otherwise the test passes on the complement.
+      changesetlist_ty ComplementSets;
+      ComplementSets.insert(ComplementSets.end(), Sets.begin(),
+                            Sets.begin() + i / 2);
+      ComplementSets.insert(ComplementSets.end(), Sets.begin() + i / 2 + 1,
+                            Sets.end());
+      Res = Delta(Passing, ComplementSets);
+      return true;
     }
   }
 
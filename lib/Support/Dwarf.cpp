@@ -251,6 +251,10 @@ const char *llvm::dwarf::FormEncodingString(unsigned Encoding) {
   case DW_FORM_flag_present:             return "DW_FORM_flag_present";
   case DW_FORM_ref_sig8:                 return "DW_FORM_ref_sig8";
 
+  // DWARF5 forms.
+  case DW_FORM_strx:                     return "DW_FORM_strx";
+  case DW_FORM_addrx:                    return "DW_FORM_addrx";
+
     // DWARF5 Fission Extension Forms
   case DW_FORM_GNU_addr_index:           return "DW_FORM_GNU_addr_index";
   case DW_FORM_GNU_str_index:            return "DW_FORM_GNU_str_index";
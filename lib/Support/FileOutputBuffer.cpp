@@ -14,8 +14,12 @@
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Errc.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include <system_error>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -24,12 +28,20 @@
 #include <io.h>
 #endif
 
+#ifdef LLVM_ON_WIN32
+#include "Windows/WindowsSupport.h"
+#include "llvm/Support/WindowsError.h"
+#else
+#include <sys/mman.h>
+#endif
+
 using llvm::sys::fs::mapped_file_region;
 
 namespace llvm {
 FileOutputBuffer::FileOutputBuffer(std::unique_ptr<mapped_file_region> R,
                                    StringRef Path, StringRef TmpPath)
-    : Region(std::move(R)), FinalPath(Path), TempPath(TmpPath) {}
+    : Region(std::move(R)), FinalPath(Path), TempPath(TmpPath),
+      NextOffset(0) {}
 
 FileOutputBuffer::~FileOutputBuffer() {
   sys::fs::remove(Twine(TempPath));
@@ -101,6 +113,55 @@ FileOutputBuffer::create(StringRef FilePath, size_t Size, unsigned Flags) {
   return std::move(Buf);
 }
 
+uint8_t *FileOutputBuffer::reserve(size_t Size, size_t Alignment) {
+  assert(Alignment && isPowerOf2_64(Alignment) &&
+         "Alignment is not a power of two!");
+  size_t Offset = NextOffset.load(std::memory_order_relaxed);
+  size_t Start;
+  do {
+    Start = alignTo(Offset, Alignment);
+    if (Start < Offset || Start > getBufferSize() ||
+        Size > getBufferSize() - Start)
+      return nullptr;
+  } while (!NextOffset.compare_exchange_weak(Offset, Start + Size,
+                                             std::memory_order_relaxed));
+  return getBufferStart() + Start;
+}
+
+std::error_code FileOutputBuffer::flushRange(const uint8_t *Start,
+                                             size_t Size) {
+  assert(Start >= getBufferStart() && Start + Size <= getBufferEnd() &&
+         "Range is not in the buffer!");
+  if (Size == 0)
+    return std::error_code();
+
+  // The range must start at a page boundary.
+  uintptr_t PageSize = sys::Process::getPageSize();
+  uintptr_t Begin = uintptr_t(Start) & ~(PageSize - 1);
+  Size += uintptr_t(Start) - Begin;
+#ifdef LLVM_ON_WIN32
+  if (!::FlushViewOfFile(reinterpret_cast<void *>(Begin), Size))
+    return mapWindowsError(::GetLastError());
+#else
+  if (::msync(reinterpret_cast<void *>(Begin), Size, MS_ASYNC))
+    return std::error_code(errno, std::generic_category());
+#endif
+  return std::error_code();
+}
+
+std::shared_future<std::error_code>
+FileOutputBuffer::commitAsync(ThreadPool &Pool) {
+  auto Result = std::make_shared<std::promise<std::error_code>>();
+  std::shared_future<std::error_code> Future = Result->get_future().share();
+#if LLVM_ENABLE_THREADS
+  Pool.async([this, Result] { Result->set_value(commit()); });
+#else
+  // Tasks only run when the pool is waited on, so commit right away.
+  Result->set_value(commit());
+#endif
+  return Future;
+}
+
 std::error_code FileOutputBuffer::commit() {
   // Unmap buffer, letting OS flush dirty pages to file on disk.
   Region.reset();
@@ -25,9 +25,9 @@ using namespace llvm;
 //===----------------------------------------------------------------------===//
 // FoldingSetNodeIDRef Implementation
 
-/// ComputeHash - Compute a strong hash value for this FoldingSetNodeIDRef,
-/// used to lookup the node in the FoldingSetImpl.
-unsigned FoldingSetNodeIDRef::ComputeHash() const {
+/// ComputeHashSlowCase - Compute the hash of the data the first time
+/// ComputeHash is called.
+unsigned FoldingSetNodeIDRef::ComputeHashSlowCase() const {
   return static_cast<unsigned>(hash_combine_range(Data, Data+Size));
 }
 
@@ -19,6 +19,7 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/raw_ostream.h"
 #include <string.h>
 
@@ -739,7 +740,7 @@ unsigned getAvailableFeatures(unsigned int ECX, unsigned int EDX,
   return Features;
 }
 
-StringRef sys::getHostCPUName() {
+static StringRef getHostCPUNameImpl() {
   unsigned EAX = 0, EBX = 0, ECX = 0, EDX = 0;
   unsigned MaxLeaf, Vendor;
 
@@ -906,7 +907,7 @@ StringRef sys::getHostCPUName() {
 }
 
 #elif defined(__APPLE__) && (defined(__ppc__) || defined(__powerpc__))
-StringRef sys::getHostCPUName() {
+static StringRef getHostCPUNameImpl() {
   host_basic_info_data_t hostInfo;
   mach_msg_type_number_t infoCount;
 
@@ -948,7 +949,7 @@ StringRef sys::getHostCPUName() {
   return "generic";
 }
 #elif defined(__linux__) && (defined(__ppc__) || defined(__powerpc__))
-StringRef sys::getHostCPUName() {
+static StringRef getHostCPUNameImpl() {
   // Access to the Processor Version Register (PVR) on PowerPC is privileged,
   // and so we must use an operating-system interface to determine the current
   // processor type. On Linux, this is exposed through the /proc/cpuinfo file.
@@ -1031,7 +1032,7 @@ StringRef sys::getHostCPUName() {
       .Default(generic);
 }
 #elif defined(__linux__) && defined(__arm__)
-StringRef sys::getHostCPUName() {
+static StringRef getHostCPUNameImpl() {
   // The cpuid register on arm is not accessible from user space. On Linux,
   // it is exposed through the /proc/cpuinfo file.
 
@@ -1088,7 +1089,7 @@ StringRef sys::getHostCPUName() {
   return "generic";
 }
 #elif defined(__linux__) && defined(__s390x__)
-StringRef sys::getHostCPUName() {
+static StringRef getHostCPUNameImpl() {
   // STIDP is a privileged operation, so use /proc/cpuinfo instead.
 
   // The "processor 0:" line comes after a fair amount of other information,
@@ -1145,13 +1146,13 @@ StringRef sys::getHostCPUName() {
   return "generic";
 }
 #else
-StringRef sys::getHostCPUName() { return "generic"; }
+static StringRef getHostCPUNameImpl() { return "generic"; }
 #endif
 
 #if defined(i386) || defined(__i386__) || defined(__x86__) ||                  \
     defined(_M_IX86) || defined(__x86_64__) || defined(_M_AMD64) ||            \
     defined(_M_X64)
-bool sys::getHostCPUFeatures(StringMap<bool> &Features) {
+static bool getHostCPUFeaturesImpl(StringMap<bool> &Features) {
   unsigned EAX = 0, EBX = 0, ECX = 0, EDX = 0;
   unsigned MaxLevel;
   union {
@@ -1256,7 +1257,7 @@ bool sys::getHostCPUFeatures(StringMap<bool> &Features) {
   return true;
 }
 #elif defined(__linux__) && (defined(__arm__) || defined(__aarch64__))
-bool sys::getHostCPUFeatures(StringMap<bool> &Features) {
+static bool getHostCPUFeaturesImpl(StringMap<bool> &Features) {
   // Read 1024 bytes from /proc/cpuinfo, which should contain the Features line
   // in all cases.
   char buffer[1024];
@@ -1327,9 +1328,39 @@ bool sys::getHostCPUFeatures(StringMap<bool> &Features) {
   return true;
 }
 #else
-bool sys::getHostCPUFeatures(StringMap<bool> &Features) { return false; }
+static bool getHostCPUFeaturesImpl(StringMap<bool> &Features) {
+  return false;
+}
 #endif
 
+namespace {
+// Detecting the host may execute cpuid or read /proc/cpuinfo, and the answer
+// cannot change while the process runs, so it is only done once.
+struct HostCPUNameInfo {
+  StringRef Name;
+  HostCPUNameInfo() : Name(getHostCPUNameImpl()) {}
+};
+
+struct HostCPUFeaturesInfo {
+  StringMap<bool> Features;
+  bool Detected;
+  HostCPUFeaturesInfo() : Detected(getHostCPUFeaturesImpl(Features)) {}
+};
+} // end anonymous namespace
+
+static ManagedStatic<HostCPUNameInfo> HostCPUName;
+static ManagedStatic<HostCPUFeaturesInfo> HostCPUFeatures;
+
+StringRef sys::getHostCPUName() { return HostCPUName->Name; }
+
+bool sys::getHostCPUFeatures(StringMap<bool> &Features) {
+  if (!HostCPUFeatures->Detected)
+    return false;
+  for (const auto &F : HostCPUFeatures->Features)
+    Features[F.getKey()] = F.getValue();
+  return true;
+}
+
 std::string sys::getProcessTriple() {
   Triple PT(Triple::normalize(LLVM_HOST_TRIPLE));
 
@@ -8,11 +8,14 @@
 //===----------------------------------------------------------------------===//
 //
 // This file implements some utility functions for encoding SLEB128 and
-// ULEB128 values.
+// ULEB128 values, and for decoding arrays of them.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/LEB128.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
 
 namespace llvm {
 
@@ -41,4 +44,85 @@ unsigned getSLEB128Size(int64_t Value) {
   return Size;
 }
 
+/// Gather the low 7 bits of each byte of \p W into a single value, the first
+/// byte providing the least significant bits.
+static inline uint64_t compactLEB128Word(uint64_t W) {
+  W &= 0x7f7f7f7f7f7f7f7fULL;
+  W = (W & 0x007f007f007f007fULL) | ((W & 0x7f007f007f007f00ULL) >> 1);
+  W = (W & 0x00003fff00003fffULL) | ((W & 0x3fff00003fff0000ULL) >> 2);
+  W = (W & 0x000000000fffffffULL) | ((W & 0x0fffffff00000000ULL) >> 4);
+  return W;
+}
+
+/// Decode the LEB128 value at \p p into \p Value, and return a pointer past
+/// it or null if it runs past \p end.
+template <bool IsSigned>
+static inline const uint8_t *decodeLEB128(const uint8_t *p, const uint8_t *end,
+                                          uint64_t &Value) {
+  if (LLVM_LIKELY(end - p >= 8)) {
+    // Find the last byte of the value from the clear continuation bits of a
+    // whole word, and decode all of its bytes at once.
+    uint64_t W = support::endian::read64le(p);
+    uint64_t Stops = ~W & 0x8080808080808080ULL;
+    if (LLVM_LIKELY(Stops != 0)) {
+      unsigned Length = countTrailingZeros(Stops) / 8 + 1;
+      Value = compactLEB128Word(W & (Stops ^ (Stops - 1)));
+      if (IsSigned) {
+        unsigned Unused = 64 - 7 * Length;
+        Value = uint64_t(int64_t(Value << Unused) >> Unused);
+      }
+      return p + Length;
+    }
+  }
+
+  // Values near the end of the buffer or longer than 8 bytes.
+  uint64_t Result = 0;
+  unsigned Shift = 0;
+  uint8_t Byte;
+  do {
+    if (p == end)
+      return nullptr;
+    Byte = *p++;
+    if (Shift < 64)
+      Result |= uint64_t(Byte & 0x7f) << Shift;
+    Shift += 7;
+  } while (Byte & 0x80);
+  if (IsSigned && (Byte & 0x40) && Shift < 64)
+    Result |= (-1ULL) << Shift;
+  Value = Result;
+  return p;
+}
+
+const uint8_t *decodeULEB128Array(const uint8_t *p, const uint8_t *end,
+                                  uint64_t *Values, size_t Count) {
+  for (size_t I = 0; I != Count; ++I) {
+    // Most values in debug info and coverage mappings fit in one byte.
+    if (LLVM_LIKELY(p != end && *p < 0x80)) {
+      Values[I] = *p++;
+      continue;
+    }
+    p = decodeLEB128<false>(p, end, Values[I]);
+    if (!p)
+      return nullptr;
+  }
+  return p;
+}
+
+const uint8_t *decodeSLEB128Array(const uint8_t *p, const uint8_t *end,
+                                  int64_t *Values, size_t Count) {
+  for (size_t I = 0; I != Count; ++I) {
+    if (LLVM_LIKELY(p != end && *p < 0x80)) {
+      Values[I] = int64_t(*p & 0x3f) - int64_t(*p & 0x40);
+      ++p;
+      continue;
+    }
+    uint64_t Value;
+    p = decodeLEB128<true>(p, end, Value);
+    if (!p)
+      return nullptr;
+    Values[I] = int64_t(Value);
+  }
+  return p;
+}
+
 }  // namespace llvm
@@ -0,0 +1,28 @@
+//===- llvm/Support/Parallel.cpp - Parallel algorithms --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/Parallel.h"
+#include "llvm/Config/llvm-config.h"
+
+using namespace llvm;
+
+ThreadPool &parallel::getDefaultPool() {
+  static ThreadPool Pool;
+  return Pool;
+}
+
+unsigned parallel::getThreadCount() {
+#if LLVM_ENABLE_THREADS
+  static unsigned ThreadCount =
+      std::max(1U, std::thread::hardware_concurrency());
+  return ThreadCount;
+#else
+  return 1;
+#endif
+}
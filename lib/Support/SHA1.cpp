@@ -16,8 +16,11 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Compiler.h"
 using namespace llvm;
 
+#include <algorithm>
 #include <stdint.h>
 #include <string.h>
 
@@ -25,6 +28,14 @@ using namespace llvm;
 #define SHA_BIG_ENDIAN
 #endif
 
+// The x86 SHA extensions are used when the host has them, if the compiler
+// can target them from a single function.
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (__has_builtin(__builtin_ia32_sha1rnds4) || LLVM_GNUC_PREREQ(5, 0, 0))
+#define SHA_X86_SHANI
+#include <immintrin.h>
+#endif
+
 /* code */
 #define SHA1_K0 0x5a827999
 #define SHA1_K20 0x6ed9eba1
@@ -51,52 +62,162 @@ static uint32_t rol32(uint32_t number, uint8_t bits) {
   return ((number << bits) | (number >> (32 - bits)));
 }
 
-void SHA1::hashBlock() {
-  uint8_t i;
-  uint32_t a, b, c, d, e, t;
-
-  a = InternalState.State[0];
-  b = InternalState.State[1];
-  c = InternalState.State[2];
-  d = InternalState.State[3];
-  e = InternalState.State[4];
-  for (i = 0; i < 80; i++) {
-    if (i >= 16) {
-      t = InternalState.Buffer[(i + 13) & 15] ^
-          InternalState.Buffer[(i + 8) & 15] ^
-          InternalState.Buffer[(i + 2) & 15] ^ InternalState.Buffer[i & 15];
-      InternalState.Buffer[i & 15] = rol32(t, 1);
-    }
-    if (i < 20) {
-      t = (d ^ (b & (c ^ d))) + SHA1_K0;
-    } else if (i < 40) {
-      t = (b ^ c ^ d) + SHA1_K20;
-    } else if (i < 60) {
-      t = ((b & c) | (d & (b | c))) + SHA1_K40;
-    } else {
-      t = (b ^ c ^ d) + SHA1_K60;
+/// Hash \p NumBlocks 64-byte blocks starting at \p Data into \p State.
+typedef void HashBlocksFn(uint32_t *State, const uint8_t *Data,
+                          size_t NumBlocks);
+
+static void hashBlocksPortable(uint32_t *State, const uint8_t *Data,
+                               size_t NumBlocks) {
+  uint32_t W[16];
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    uint8_t i;
+    uint32_t a, b, c, d, e, t;
+
+    for (i = 0; i < 16; i++)
+      W[i] = uint32_t(Data[4 * i]) << 24 | uint32_t(Data[4 * i + 1]) << 16 |
+             uint32_t(Data[4 * i + 2]) << 8 | uint32_t(Data[4 * i + 3]);
+
+    a = State[0];
+    b = State[1];
+    c = State[2];
+    d = State[3];
+    e = State[4];
+    for (i = 0; i < 80; i++) {
+      if (i >= 16) {
+        t = W[(i + 13) & 15] ^ W[(i + 8) & 15] ^ W[(i + 2) & 15] ^ W[i & 15];
+        W[i & 15] = rol32(t, 1);
+      }
+      if (i < 20) {
+        t = (d ^ (b & (c ^ d))) + SHA1_K0;
+      } else if (i < 40) {
+        t = (b ^ c ^ d) + SHA1_K20;
+      } else if (i < 60) {
+        t = ((b & c) | (d & (b | c))) + SHA1_K40;
+      } else {
+        t = (b ^ c ^ d) + SHA1_K60;
+      }
+      t += rol32(a, 5) + e + W[i & 15];
+      e = d;
+      d = c;
+      c = rol32(b, 30);
+      b = a;
+      a = t;
     }
-    t += rol32(a, 5) + e + InternalState.Buffer[i & 15];
-    e = d;
-    d = c;
-    c = rol32(b, 30);
-    b = a;
-    a = t;
+    State[0] += a;
+    State[1] += b;
+    State[2] += c;
+    State[3] += d;
+    State[4] += e;
+  }
+}
+
+#ifdef SHA_X86_SHANI
+// Four rounds, from the 4-round group that uses the message words in M0. This
+// also advances the message schedule: M1 gets its last step, M2 its second
+// and M3 its first, so every group after the fourth one looks the same.
+#define SHA1_ROUNDS4(E, NextE, Func, M0, M1, M2, M3)                           \
+  E = _mm_sha1nexte_epu32(E, M0);                                              \
+  NextE = ABCD;                                                                \
+  M1 = _mm_sha1msg2_epu32(M1, M0);                                             \
+  ABCD = _mm_sha1rnds4_epu32(ABCD, E, Func);                                   \
+  M3 = _mm_sha1msg1_epu32(M3, M0);                                             \
+  M2 = _mm_xor_si128(M2, M0);
+
+__attribute__((target("sha,sse4.1")))
+static void hashBlocksSHANI(uint32_t *State, const uint8_t *Data,
+                            size_t NumBlocks) {
+  // Loads the big-endian message words.
+  const __m128i Mask = _mm_set_epi64x(0x0001020304050607ULL,
+                                      0x08090a0b0c0d0e0fULL);
+
+  // The instructions want A in the highest lane and E on its own in the
+  // highest lane of another register.
+  __m128i ABCD = _mm_loadu_si128(reinterpret_cast<const __m128i *>(State));
+  ABCD = _mm_shuffle_epi32(ABCD, 0x1B);
+  __m128i E0 = _mm_set_epi32(State[4], 0, 0, 0);
+
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    __m128i ABCDSave = ABCD, E0Save = E0, E1;
+    const __m128i *Block = reinterpret_cast<const __m128i *>(Data);
+    __m128i Msg0 = _mm_shuffle_epi8(_mm_loadu_si128(Block), Mask);
+    __m128i Msg1 = _mm_shuffle_epi8(_mm_loadu_si128(Block + 1), Mask);
+    __m128i Msg2 = _mm_shuffle_epi8(_mm_loadu_si128(Block + 2), Mask);
+    __m128i Msg3 = _mm_shuffle_epi8(_mm_loadu_si128(Block + 3), Mask);
+
+    // Rounds 0-11 start the message schedule.
+    E0 = _mm_add_epi32(E0, Msg0);
+    E1 = ABCD;
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+
+    E1 = _mm_sha1nexte_epu32(E1, Msg1);
+    E0 = ABCD;
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 0);
+    Msg0 = _mm_sha1msg1_epu32(Msg0, Msg1);
+
+    E0 = _mm_sha1nexte_epu32(E0, Msg2);
+    E1 = ABCD;
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+    Msg1 = _mm_sha1msg1_epu32(Msg1, Msg2);
+    Msg0 = _mm_xor_si128(Msg0, Msg2);
+
+    SHA1_ROUNDS4(E1, E0, 0, Msg3, Msg0, Msg1, Msg2) // 12-15
+    SHA1_ROUNDS4(E0, E1, 0, Msg0, Msg1, Msg2, Msg3) // 16-19
+    SHA1_ROUNDS4(E1, E0, 1, Msg1, Msg2, Msg3, Msg0) // 20-23
+    SHA1_ROUNDS4(E0, E1, 1, Msg2, Msg3, Msg0, Msg1) // 24-27
+    SHA1_ROUNDS4(E1, E0, 1, Msg3, Msg0, Msg1, Msg2) // 28-31
+    SHA1_ROUNDS4(E0, E1, 1, Msg0, Msg1, Msg2, Msg3) // 32-35
+    SHA1_ROUNDS4(E1, E0, 1, Msg1, Msg2, Msg3, Msg0) // 36-39
+    SHA1_ROUNDS4(E0, E1, 2, Msg2, Msg3, Msg0, Msg1) // 40-43
+    SHA1_ROUNDS4(E1, E0, 2, Msg3, Msg0, Msg1, Msg2) // 44-47
+    SHA1_ROUNDS4(E0, E1, 2, Msg0, Msg1, Msg2, Msg3) // 48-51
+    SHA1_ROUNDS4(E1, E0, 2, Msg1, Msg2, Msg3, Msg0) // 52-55
+    SHA1_ROUNDS4(E0, E1, 2, Msg2, Msg3, Msg0, Msg1) // 56-59
+    SHA1_ROUNDS4(E1, E0, 3, Msg3, Msg0, Msg1, Msg2) // 60-63
+    SHA1_ROUNDS4(E0, E1, 3, Msg0, Msg1, Msg2, Msg3) // 64-67
+    SHA1_ROUNDS4(E1, E0, 3, Msg1, Msg2, Msg3, Msg0) // 68-71
+    SHA1_ROUNDS4(E0, E1, 3, Msg2, Msg3, Msg0, Msg1) // 72-75
+
+    // Rounds 76-79.
+    E1 = _mm_sha1nexte_epu32(E1, Msg3);
+    E0 = ABCD;
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E1, 3);
+
+    E0 = _mm_sha1nexte_epu32(E0, E0Save);
+    ABCD = _mm_add_epi32(ABCD, ABCDSave);
   }
-  InternalState.State[0] += a;
-  InternalState.State[1] += b;
-  InternalState.State[2] += c;
-  InternalState.State[3] += d;
-  InternalState.State[4] += e;
+
+  ABCD = _mm_shuffle_epi32(ABCD, 0x1B);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(State), ABCD);
+  State[4] = _mm_extract_epi32(E0, 3);
+}
+
+#undef SHA1_ROUNDS4
+#endif
+
+static HashBlocksFn *selectHashBlocks() {
+#ifdef SHA_X86_SHANI
+  StringMap<bool> Features;
+  if (sys::getHostCPUFeatures(Features) && Features.lookup("sha") &&
+      Features.lookup("ssse3") && Features.lookup("sse4.1"))
+    return hashBlocksSHANI;
+#endif
+  return hashBlocksPortable;
+}
+
+/// The block function for the host, picked the first time a block is hashed.
+static HashBlocksFn *getHashBlocks() {
+  static HashBlocksFn *const HashBlocks = selectHashBlocks();
+  return HashBlocks;
+}
+
+void SHA1::hashBlock() {
+  getHashBlocks()(InternalState.State,
+                  reinterpret_cast<const uint8_t *>(InternalState.Buffer), 1);
 }
 
 void SHA1::addUncounted(uint8_t data) {
   uint8_t *const b = (uint8_t *)InternalState.Buffer;
-#ifdef SHA_BIG_ENDIAN
   b[InternalState.BufferOffset] = data;
-#else
-  b[InternalState.BufferOffset ^ 3] = data;
-#endif
   InternalState.BufferOffset++;
   if (InternalState.BufferOffset == BLOCK_LENGTH) {
     hashBlock();
@@ -104,14 +225,26 @@ void SHA1::addUncounted(uint8_t data) {
   }
 }
 
-void SHA1::writebyte(uint8_t data) {
-  ++InternalState.ByteCount;
-  addUncounted(data);
-}
-
 void SHA1::update(ArrayRef<uint8_t> Data) {
-  for (auto &C : Data)
-    writebyte(C);
+  InternalState.ByteCount += Data.size();
+
+  // Finish the buffered block first.
+  if (InternalState.BufferOffset) {
+    size_t Rest = std::min<size_t>(Data.size(),
+                                   BLOCK_LENGTH - InternalState.BufferOffset);
+    for (uint8_t C : Data.slice(0, Rest))
+      addUncounted(C);
+    Data = Data.drop_front(Rest);
+  }
+
+  // Hash the whole blocks in place.
+  if (size_t NumBlocks = Data.size() / BLOCK_LENGTH) {
+    getHashBlocks()(InternalState.State, Data.data(), NumBlocks);
+    Data = Data.drop_front(NumBlocks * BLOCK_LENGTH);
+  }
+
+  for (uint8_t C : Data)
+    addUncounted(C);
 }
 
 void SHA1::pad() {
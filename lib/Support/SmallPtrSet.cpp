@@ -86,7 +86,8 @@ bool SmallPtrSetImplBase::erase_imp(const void * Ptr) {
 }
 
 const void * const *SmallPtrSetImplBase::FindBucketFor(const void *Ptr) const {
-  unsigned Bucket = DenseMapInfo<void *>::getHashValue(Ptr) & (CurArraySize-1);
+  unsigned Bucket =
+      MixedPtrDenseMapInfo<const void>::getHashValue(Ptr) & (CurArraySize - 1);
   unsigned ArraySize = CurArraySize;
   unsigned ProbeAmt = 1;
   const void *const *Array = CurArray;
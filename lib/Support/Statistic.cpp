@@ -76,16 +76,13 @@ void Statistic::RegisterStatistic() {
   // If stats are enabled, inform StatInfo that this statistic should be
   // printed.
   sys::SmartScopedLock<true> Writer(*StatLock);
-  if (!Initialized) {
+  if (!Initialized.load(std::memory_order_relaxed)) {
     if (Enabled)
       StatInfo->addStatistic(this);
 
-    TsanHappensBefore(this);
-    sys::MemoryFence();
-    // Remember we have been registered.
-    TsanIgnoreWritesBegin();
-    Initialized = true;
-    TsanIgnoreWritesEnd();
+    // Remember we have been registered. The release store pairs with the
+    // acquire load in Statistic::init().
+    Initialized.store(true, std::memory_order_release);
   }
 }
 
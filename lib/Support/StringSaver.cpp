@@ -17,3 +17,13 @@ const char *StringSaver::save(StringRef S) {
   P[S.size()] = '\0';
   return P;
 }
+
+CachedHash<StringRef> UniqueStringSaver::save(CachedHash<StringRef> S) {
+  auto R = Unique.insert(S);
+  if (R.second) {
+    // The set holds the caller's string. Replace it with a stable copy; the
+    // hash and the contents stay the same, so the bucket is still right.
+    R.first->Val = StringRef(Strings.save(S.Val), S.Val.size());
+  }
+  return *R.first;
+}
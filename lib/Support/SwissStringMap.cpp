@@ -0,0 +1,387 @@
+//===--- SwissStringMap.cpp - Group-probed string hash table --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the SwissStringMap class.
+//
+// Every bucket has a control byte that is either empty, deleted, or holds a
+// 7-bit tag derived from the hash of its key. A probe loads the control bytes
+// of GroupWidth consecutive buckets and compares them all against the tag of
+// the key at once, so that only the few buckets whose tag matched have their
+// full hash and key looked at. The probe sequence moves by a growing number of
+// groups, which visits every group once for power of two table sizes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SwissStringMap.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LLVM_SWISSMAP_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LLVM_SWISSMAP_NEON 1
+#endif
+
+using namespace llvm;
+
+namespace {
+const unsigned GroupWidth = 16;
+const int8_t CtrlEmpty = -128;
+const int8_t CtrlDeleted = -2;
+
+/// The tag stored in the control byte of a full bucket. The low bits of the
+/// hash already pick the bucket, so take the tag from the other end of a
+/// mixed copy of the hash.
+inline int8_t getTag(unsigned FullHash) {
+  return int8_t((FullHash * 0x9E3779B1U) >> 25);
+}
+
+/// Set of buckets of a group, as returned by the Group matchers. Each bucket
+/// is represented by 1 << Shift bits, of which only the lowest is set.
+template <unsigned Shift> class BucketMask {
+  uint64_t Mask;
+
+public:
+  explicit BucketMask(uint64_t Mask) : Mask(Mask) {}
+
+  explicit operator bool() const { return Mask != 0; }
+
+  /// Index in the group of the first bucket of the set.
+  unsigned first() const {
+    return unsigned(countTrailingZeros(Mask, ZB_Undefined)) >> Shift;
+  }
+
+  void dropFirst() { Mask &= Mask - 1; }
+};
+
+/// The control bytes of GroupWidth consecutive buckets.
+#if defined(LLVM_SWISSMAP_SSE2)
+class Group {
+  __m128i Ctrl;
+
+public:
+  typedef BucketMask<0> Mask;
+
+  explicit Group(const int8_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  Mask match(int8_t Tag) const {
+    return Mask(uint32_t(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(Tag), Ctrl))));
+  }
+
+  Mask matchEmpty() const { return match(CtrlEmpty); }
+
+  // Empty and deleted buckets are the ones with the sign bit set.
+  Mask matchEmptyOrDeleted() const {
+    return Mask(uint32_t(_mm_movemask_epi8(Ctrl)));
+  }
+};
+#elif defined(LLVM_SWISSMAP_NEON)
+class Group {
+  int8x16_t Ctrl;
+
+  // There is no movemask on NEON: narrow each 0x00/0xFF byte of the
+  // comparison result to a nibble instead, and keep one bit per nibble.
+  static uint64_t toMask(uint8x16_t Cmp) {
+    uint8x8_t Narrowed = vshrn_n_u16(vreinterpretq_u16_u8(Cmp), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(Narrowed), 0) &
+           0x8888888888888888ULL;
+  }
+
+public:
+  typedef BucketMask<2> Mask;
+
+  explicit Group(const int8_t *Pos) : Ctrl(vld1q_s8(Pos)) {}
+
+  Mask match(int8_t Tag) const {
+    return Mask(toMask(vceqq_s8(Ctrl, vdupq_n_s8(Tag))));
+  }
+
+  Mask matchEmpty() const { return match(CtrlEmpty); }
+
+  Mask matchEmptyOrDeleted() const {
+    return Mask(toMask(vcltq_s8(Ctrl, vdupq_n_s8(0))));
+  }
+};
+#else
+class Group {
+  const int8_t *Ctrl;
+
+public:
+  typedef BucketMask<0> Mask;
+
+  explicit Group(const int8_t *Pos) : Ctrl(Pos) {}
+
+  Mask match(int8_t Tag) const {
+    uint64_t M = 0;
+    for (unsigned I = 0; I != GroupWidth; ++I)
+      if (Ctrl[I] == Tag)
+        M |= uint64_t(1) << I;
+    return Mask(M);
+  }
+
+  Mask matchEmpty() const { return match(CtrlEmpty); }
+
+  Mask matchEmptyOrDeleted() const {
+    uint64_t M = 0;
+    for (unsigned I = 0; I != GroupWidth; ++I)
+      if (Ctrl[I] < 0)
+        M |= uint64_t(1) << I;
+    return Mask(M);
+  }
+};
+#endif
+
+/// The sequence of group positions probed for a hash value.
+class ProbeSeq {
+  unsigned Mask;
+  unsigned Offset;
+  unsigned Stride;
+
+public:
+  ProbeSeq(unsigned FullHash, unsigned Mask)
+      : Mask(Mask), Offset(FullHash & Mask), Stride(0) {}
+
+  unsigned offset() const { return Offset; }
+  unsigned bucket(unsigned Index) const { return (Offset + Index) & Mask; }
+
+  void next() {
+    Stride += GroupWidth;
+    Offset = (Offset + Stride) & Mask;
+  }
+};
+
+/// Layout of the table allocated by init() and RehashTable().
+inline unsigned *getHashTable(StringMapEntryBase **Table, unsigned NumBuckets) {
+  return reinterpret_cast<unsigned *>(Table + NumBuckets + 1);
+}
+
+inline int8_t *getCtrl(StringMapEntryBase **Table, unsigned NumBuckets) {
+  return reinterpret_cast<int8_t *>(getHashTable(Table, NumBuckets) +
+                                    NumBuckets);
+}
+
+inline size_t getTableSize(unsigned NumBuckets) {
+  return (NumBuckets + 1) * sizeof(StringMapEntryBase *) +
+         NumBuckets * sizeof(unsigned) + NumBuckets + GroupWidth - 1;
+}
+
+/// Allocate an empty table of \p NumBuckets buckets.
+StringMapEntryBase **allocateTable(unsigned NumBuckets) {
+  StringMapEntryBase **Table =
+      (StringMapEntryBase **)calloc(getTableSize(NumBuckets), 1);
+  memset(getCtrl(Table, NumBuckets), CtrlEmpty, NumBuckets + GroupWidth - 1);
+
+  // Allocate one extra bucket, set it to look filled so the iterators stop at
+  // end.
+  Table[NumBuckets] = (StringMapEntryBase*)2;
+  return Table;
+}
+
+/// Set the control byte of \p BucketNo, and its copy past the end of the
+/// table if it is one of the first GroupWidth - 1 buckets.
+inline void setCtrl(int8_t *Ctrl, unsigned NumBuckets, unsigned BucketNo,
+                    int8_t Value) {
+  Ctrl[BucketNo] = Value;
+  Ctrl[((BucketNo - (GroupWidth - 1)) & (NumBuckets - 1)) + GroupWidth - 1] =
+      Value;
+}
+
+/// Returns the number of buckets to allocate to ensure that the map can
+/// accommodate \p NumEntries without need to grow().
+unsigned getMinBucketToReserveForEntries(unsigned NumEntries) {
+  // Ensure that "NumEntries * 8 <= NumBuckets * 7"
+  if (NumEntries == 0)
+    return 0;
+  return std::max(GroupWidth, unsigned(NextPowerOf2(NumEntries * 8 / 7)));
+}
+} // end anonymous namespace
+
+SwissStringMapImpl::SwissStringMapImpl(unsigned InitSize, unsigned itemSize)
+    : TheTable(nullptr), NumBuckets(0), NumItems(0), NumTombstones(0),
+      ItemSize(itemSize) {
+  // If a size is specified, initialize the table with enough buckets to hold
+  // that many entries without growing.
+  if (InitSize)
+    init(getMinBucketToReserveForEntries(InitSize));
+}
+
+void SwissStringMapImpl::init(unsigned InitSize) {
+  assert((InitSize & (InitSize-1)) == 0 &&
+         "Init Size must be a power of 2 or zero!");
+  NumBuckets = std::max(InitSize, GroupWidth);
+  NumItems = 0;
+  NumTombstones = 0;
+  TheTable = allocateTable(NumBuckets);
+}
+
+void SwissStringMapImpl::resetBuckets() {
+  memset(TheTable, 0, NumBuckets * sizeof(StringMapEntryBase *));
+  memset(getCtrl(TheTable, NumBuckets), CtrlEmpty,
+         NumBuckets + GroupWidth - 1);
+  NumItems = 0;
+  NumTombstones = 0;
+}
+
+void SwissStringMapImpl::copyLayoutFrom(const SwissStringMapImpl &RHS) {
+  init(RHS.NumBuckets);
+  memcpy(getHashTable(TheTable, NumBuckets),
+         getHashTable(RHS.TheTable, NumBuckets),
+         getTableSize(NumBuckets) -
+             (NumBuckets + 1) * sizeof(StringMapEntryBase *));
+  NumItems = RHS.NumItems;
+  NumTombstones = RHS.NumTombstones;
+}
+
+unsigned SwissStringMapImpl::LookupBucketFor(StringRef Name) {
+  if (NumBuckets == 0)  // Hash table unallocated so far?
+    init(GroupWidth);
+  unsigned FullHashValue = HashString(Name);
+  int8_t Tag = getTag(FullHashValue);
+  unsigned *HashTable = getHashTable(TheTable, NumBuckets);
+  int8_t *Ctrl = getCtrl(TheTable, NumBuckets);
+
+  int FirstFree = -1;
+  for (ProbeSeq Seq(FullHashValue, NumBuckets - 1);; Seq.next()) {
+    Group G(Ctrl + Seq.offset());
+    for (Group::Mask M = G.match(Tag); M; M.dropFirst()) {
+      unsigned BucketNo = Seq.bucket(M.first());
+      if (LLVM_LIKELY(HashTable[BucketNo] == FullHashValue)) {
+        // Do the comparison like this because Name isn't necessarily
+        // null-terminated!
+        StringMapEntryBase *BucketItem = TheTable[BucketNo];
+        char *ItemStr = (char*)BucketItem+ItemSize;
+        if (Name == StringRef(ItemStr, BucketItem->getKeyLength()))
+          return BucketNo;
+      }
+    }
+
+    // Remember the first deleted or empty bucket, to reuse tombstones instead
+    // of empty buckets and keep probe sequences short.
+    if (FirstFree == -1)
+      if (Group::Mask M = G.matchEmptyOrDeleted())
+        FirstFree = Seq.bucket(M.first());
+
+    // An empty bucket ends the probe sequence of every key.
+    if (LLVM_LIKELY(bool(G.matchEmpty())))
+      break;
+  }
+
+  HashTable[FirstFree] = FullHashValue;
+  setCtrl(Ctrl, NumBuckets, FirstFree, Tag);
+  return FirstFree;
+}
+
+int SwissStringMapImpl::FindKey(StringRef Key) const {
+  if (NumBuckets == 0) return -1;  // Really empty table?
+  unsigned FullHashValue = HashString(Key);
+  int8_t Tag = getTag(FullHashValue);
+  const unsigned *HashTable = getHashTable(TheTable, NumBuckets);
+  const int8_t *Ctrl = getCtrl(TheTable, NumBuckets);
+
+  for (ProbeSeq Seq(FullHashValue, NumBuckets - 1);; Seq.next()) {
+    Group G(Ctrl + Seq.offset());
+    for (Group::Mask M = G.match(Tag); M; M.dropFirst()) {
+      unsigned BucketNo = Seq.bucket(M.first());
+      if (LLVM_LIKELY(HashTable[BucketNo] == FullHashValue)) {
+        StringMapEntryBase *BucketItem = TheTable[BucketNo];
+        char *ItemStr = (char*)BucketItem+ItemSize;
+        if (Key == StringRef(ItemStr, BucketItem->getKeyLength()))
+          return BucketNo;
+      }
+    }
+
+    if (LLVM_LIKELY(bool(G.matchEmpty())))
+      return -1;
+  }
+}
+
+void SwissStringMapImpl::RemoveKey(StringMapEntryBase *V) {
+  const char *VStr = (char*)V + ItemSize;
+  StringMapEntryBase *V2 = RemoveKey(StringRef(VStr, V->getKeyLength()));
+  (void)V2;
+  assert(V == V2 && "Didn't find key?");
+}
+
+StringMapEntryBase *SwissStringMapImpl::RemoveKey(StringRef Key) {
+  int Bucket = FindKey(Key);
+  if (Bucket == -1) return nullptr;
+
+  StringMapEntryBase *Result = TheTable[Bucket];
+  TheTable[Bucket] = StringMapImpl::getTombstoneVal();
+  setCtrl(getCtrl(TheTable, NumBuckets), NumBuckets, Bucket, CtrlDeleted);
+  --NumItems;
+  ++NumTombstones;
+  assert(NumItems + NumTombstones <= NumBuckets);
+
+  return Result;
+}
+
+/// RehashTable - Grow the table, redistributing values into the buckets with
+/// the appropriate mod-of-hashtable-size.
+unsigned SwissStringMapImpl::RehashTable(unsigned BucketNo) {
+  unsigned NewSize;
+
+  // If the hash table is now more than 7/8 full, grow it. If it is only that
+  // full because of tombstones, rehash it in place: every probe sequence
+  // needs an empty bucket to stop at.
+  if (LLVM_UNLIKELY(NumItems * 8 > NumBuckets * 7)) {
+    NewSize = NumBuckets*2;
+  } else if (LLVM_UNLIKELY((NumItems + NumTombstones) * 8 > NumBuckets * 7)) {
+    NewSize = NumBuckets;
+  } else {
+    return BucketNo;
+  }
+
+  StringMapEntryBase **NewTable = allocateTable(NewSize);
+  unsigned *NewHashTable = getHashTable(NewTable, NewSize);
+  int8_t *NewCtrl = getCtrl(NewTable, NewSize);
+  unsigned *HashTable = getHashTable(TheTable, NumBuckets);
+  unsigned NewBucketNo = BucketNo;
+
+  // Rehash all the items into their new buckets.  Luckily :) we already have
+  // the hash values available, so we don't have to rehash any strings. The
+  // new table has no tombstones, so the first free bucket of the probe
+  // sequence is the right one.
+  for (unsigned I = 0, E = NumBuckets; I != E; ++I) {
+    StringMapEntryBase *Bucket = TheTable[I];
+    if (!Bucket || Bucket == StringMapImpl::getTombstoneVal())
+      continue;
+
+    unsigned FullHash = HashTable[I];
+    ProbeSeq Seq(FullHash, NewSize - 1);
+    Group::Mask M = Group(NewCtrl + Seq.offset()).matchEmpty();
+    while (!M) {
+      Seq.next();
+      M = Group(NewCtrl + Seq.offset()).matchEmpty();
+    }
+
+    unsigned NewBucket = Seq.bucket(M.first());
+    NewTable[NewBucket] = Bucket;
+    NewHashTable[NewBucket] = FullHash;
+    setCtrl(NewCtrl, NewSize, NewBucket, getTag(FullHash));
+    if (I == BucketNo)
+      NewBucketNo = NewBucket;
+  }
+
+  free(TheTable);
+
+  TheTable = NewTable;
+  NumBuckets = NewSize;
+  NumTombstones = 0;
+  return NewBucketNo;
+}
@@ -15,9 +15,21 @@
 
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 using namespace llvm;
 
+bool ThreadPool::workCompletedUnlocked(ThreadPoolTaskGroup *Group) const {
+  if (!Group)
+    return !ActiveThreads && Tasks.empty();
+  return !ActiveGroups.count(Group) &&
+         std::none_of(Tasks.begin(), Tasks.end(),
+                      [Group](const std::pair<PackagedTaskTy,
+                                              ThreadPoolTaskGroup *> &T) {
+                        return T.second == Group;
+                      });
+}
+
 #if LLVM_ENABLE_THREADS
 
 // Default to std::thread::hardware_concurrency
@@ -28,61 +40,105 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
   // Create ThreadCount threads that will loop forever, wait on QueueCondition
   // for tasks to be queued or the Pool to be destroyed.
   Threads.reserve(ThreadCount);
-  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
-    Threads.emplace_back([&] {
-      while (true) {
-        PackagedTaskTy Task;
-        {
-          std::unique_lock<std::mutex> LockGuard(QueueLock);
-          // Wait for tasks to be pushed in the queue
-          QueueCondition.wait(LockGuard,
-                              [&] { return !EnableFlag || !Tasks.empty(); });
-          // Exit condition
-          if (!EnableFlag && Tasks.empty())
-            return;
-          // Yeah, we have a task, grab it and release the lock on the queue
-
-          // We first need to signal that we are active before popping the queue
-          // in order for wait() to properly detect that even if the queue is
-          // empty, there is still a task in flight.
-          {
-            ++ActiveThreads;
-            std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          }
-          Task = std::move(Tasks.front());
-          Tasks.pop();
-        }
-        // Run the task we just grabbed
+  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID)
+    Threads.emplace_back([&] { processTasks(nullptr); });
+}
+
+void ThreadPool::processTasks(ThreadPoolTaskGroup *WaitingForGroup) {
+  while (true) {
+    PackagedTaskTy Task;
+    ThreadPoolTaskGroup *GroupOfTask;
+    {
+      std::unique_lock<std::mutex> LockGuard(QueueLock);
+      bool GroupCompleted = false;
+      // Wait for tasks to be pushed in the queue, or for the group we are
+      // helping with to be done.
+      QueueCondition.wait(LockGuard, [&] {
+        if (WaitingForGroup &&
+            (GroupCompleted = workCompletedUnlocked(WaitingForGroup)))
+          return true;
+        return !EnableFlag || !Tasks.empty();
+      });
+      // Exit conditions
+      if (GroupCompleted)
+        return;
+      if (!EnableFlag && Tasks.empty())
+        return;
+      // Yeah, we have a task, grab it and release the lock on the queue
+
+      // We first need to signal that we are active before popping the queue
+      // in order for wait() to properly detect that even if the queue is
+      // empty, there is still a task in flight.
+      ++ActiveThreads;
+      Task = std::move(Tasks.front().first);
+      GroupOfTask = Tasks.front().second;
+      // Track running tasks per group too: a worker waiting on a group counts
+      // as active, so ActiveThreads alone can never tell that a group is done.
+      if (GroupOfTask)
+        ++ActiveGroups[GroupOfTask];
+      Tasks.pop_front();
+    }
+    // Run the task we just grabbed
 #ifndef _MSC_VER
-        Task();
+    Task();
 #else
-        Task(/* unused */ false);
+    Task(/* unused */ false);
 #endif
 
-        {
-          // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
-          std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          --ActiveThreads;
-        }
-
-        // Notify task completion, in case someone waits on ThreadPool::wait()
-        CompletionCondition.notify_all();
+    bool Notify;
+    {
+      // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
+      std::unique_lock<std::mutex> LockGuard(QueueLock);
+      --ActiveThreads;
+      if (GroupOfTask) {
+        auto I = ActiveGroups.find(GroupOfTask);
+        if (--I->second == 0)
+          ActiveGroups.erase(I);
       }
-    });
+      Notify = workCompletedUnlocked(GroupOfTask);
+    }
+
+    if (Notify) {
+      // Notify task completion, in case someone waits on ThreadPool::wait()
+      CompletionCondition.notify_all();
+      // Workers helping out while waiting on this group sleep on
+      // QueueCondition; wake them up so that they can return.
+      if (GroupOfTask)
+        QueueCondition.notify_all();
+    }
   }
 }
 
+bool ThreadPool::isWorkerThread() const {
+  std::thread::id CurrentThreadId = std::this_thread::get_id();
+  for (const llvm::thread &Thread : Threads)
+    if (CurrentThreadId == Thread.get_id())
+      return true;
+  return false;
+}
+
 void ThreadPool::wait() {
+  assert(!isWorkerThread() && "Waiting for the whole pool from a worker");
   // Wait for all threads to complete and the queue to be empty
-  std::unique_lock<std::mutex> LockGuard(CompletionLock);
-  // The order of the checks for ActiveThreads and Tasks.empty() matters because
-  // any active threads might be modifying the Tasks queue, and this would be a
-  // race.
+  std::unique_lock<std::mutex> LockGuard(QueueLock);
   CompletionCondition.wait(LockGuard,
-                           [&] { return !ActiveThreads && Tasks.empty(); });
+                           [&] { return workCompletedUnlocked(nullptr); });
+}
+
+void ThreadPool::wait(ThreadPoolTaskGroup &Group) {
+  if (!isWorkerThread()) {
+    std::unique_lock<std::mutex> LockGuard(QueueLock);
+    CompletionCondition.wait(LockGuard,
+                             [&] { return workCompletedUnlocked(&Group); });
+    return;
+  }
+  // Called from a task: keep this worker busy with queued tasks until the
+  // group is done, rather than blocking it and possibly deadlocking the pool.
+  processTasks(&Group);
 }
 
-std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
+std::shared_future<ThreadPool::VoidTy>
+ThreadPool::asyncImpl(TaskTy Task, ThreadPoolTaskGroup *Group) {
   /// Wrap the Task in a packaged_task to return a future object.
   PackagedTaskTy PackagedTask(std::move(Task));
   auto Future = PackagedTask.get_future();
@@ -93,7 +149,7 @@ std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
     // Don't allow enqueueing after disabling the pool
     assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
 
-    Tasks.push(std::move(PackagedTask));
+    Tasks.emplace_back(std::move(PackagedTask), Group);
   }
   QueueCondition.notify_one();
   return Future.share();
@@ -123,11 +179,13 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
   }
 }
 
+bool ThreadPool::isWorkerThread() const { return false; }
+
 void ThreadPool::wait() {
   // Sequential implementation running the tasks
   while (!Tasks.empty()) {
-    auto Task = std::move(Tasks.front());
-    Tasks.pop();
+    auto Task = std::move(Tasks.front().first);
+    Tasks.pop_front();
 #ifndef _MSC_VER
         Task();
 #else
@@ -136,7 +194,29 @@ void ThreadPool::wait() {
   }
 }
 
-std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
+void ThreadPool::wait(ThreadPoolTaskGroup &Group) {
+  // Sequential implementation running only the tasks of the group. Tasks may
+  // queue more tasks, so look for the next one each time.
+  while (true) {
+    auto I = std::find_if(Tasks.begin(), Tasks.end(),
+                          [&Group](const std::pair<PackagedTaskTy,
+                                                   ThreadPoolTaskGroup *> &T) {
+                            return T.second == &Group;
+                          });
+    if (I == Tasks.end())
+      return;
+    auto Task = std::move(I->first);
+    Tasks.erase(I);
+#ifndef _MSC_VER
+    Task();
+#else
+    Task(/* unused */ false);
+#endif
+  }
+}
+
+std::shared_future<ThreadPool::VoidTy>
+ThreadPool::asyncImpl(TaskTy Task, ThreadPoolTaskGroup *Group) {
 #ifndef _MSC_VER
   // Get a Future with launch::deferred execution using std::async
   auto Future = std::async(std::launch::deferred, std::move(Task)).share();
@@ -147,7 +227,7 @@ std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
   auto Future = std::async(std::launch::deferred, std::move(Task), false).share();
   PackagedTaskTy PackagedTask([Future](bool) -> bool { Future.get(); return false; });
 #endif
-  Tasks.push(std::move(PackagedTask));
+  Tasks.emplace_back(std::move(PackagedTask), Group);
   return Future;
 }
 
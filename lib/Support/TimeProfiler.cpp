@@ -0,0 +1,252 @@
+//===-- TimeProfiler.cpp - Hierarchical Time Profiler ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the hierarchical time profiler declared in
+// TimeProfiler.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+typedef std::chrono::steady_clock ClockType;
+typedef ClockType::time_point TimePointType;
+typedef std::chrono::microseconds DurationType;
+
+struct Entry {
+  TimePointType Start;
+  DurationType Duration;
+  std::string Name;
+  std::string Detail;
+
+  Entry(TimePointType Start, std::string Name, std::string Detail)
+      : Start(Start), Duration(0), Name(std::move(Name)),
+        Detail(std::move(Detail)) {}
+};
+
+/// The events recorded by one thread. Only that thread touches it until the
+/// trace is written out.
+struct ThreadTrace {
+  explicit ThreadTrace(unsigned Tid) : Tid(Tid) {}
+
+  unsigned Tid;
+  std::vector<Entry> Stack;
+  std::vector<Entry> Entries;
+  /// Number of outermost occurrences and total duration of each event name.
+  StringMap<std::pair<unsigned, DurationType>> Totals;
+};
+} // end anonymous namespace
+
+namespace llvm {
+namespace detail {
+std::atomic<TimeTraceProfiler *> TimeTraceProfilerInstance(nullptr);
+
+class TimeTraceProfiler {
+public:
+  TimeTraceProfiler(unsigned Granularity, unsigned Generation)
+      : StartTime(ClockType::now()), Granularity(Granularity),
+        Generation(Generation) {}
+
+  /// Get the trace of the calling thread, creating it on first use.
+  ThreadTrace &getThreadTrace();
+
+  void begin(std::string Name, std::string Detail) {
+    getThreadTrace().Stack.emplace_back(ClockType::now(), std::move(Name),
+                                        std::move(Detail));
+  }
+
+  void end();
+
+  void write(raw_ostream &OS);
+
+private:
+  std::mutex Lock;
+  std::vector<std::unique_ptr<ThreadTrace>> Threads;
+  const TimePointType StartTime;
+  const DurationType Granularity;
+  const unsigned Generation;
+};
+} // end namespace detail
+} // end namespace llvm
+
+using llvm::detail::TimeTraceProfiler;
+using llvm::detail::TimeTraceProfilerInstance;
+
+/// Each initialization gets a new generation, so that threads notice that the
+/// trace they cached belongs to a profiler that has since been cleaned up.
+static std::atomic<unsigned> ProfilerGeneration(0);
+static LLVM_THREAD_LOCAL unsigned CachedGeneration = 0;
+static LLVM_THREAD_LOCAL ThreadTrace *CachedThreadTrace = nullptr;
+
+ThreadTrace &TimeTraceProfiler::getThreadTrace() {
+  if (CachedGeneration == Generation)
+    return *CachedThreadTrace;
+
+  std::lock_guard<std::mutex> Guard(Lock);
+  Threads.push_back(llvm::make_unique<ThreadTrace>(Threads.size()));
+  CachedGeneration = Generation;
+  CachedThreadTrace = Threads.back().get();
+  return *CachedThreadTrace;
+}
+
+void TimeTraceProfiler::end() {
+  ThreadTrace &Trace = getThreadTrace();
+  assert(!Trace.Stack.empty() && "Must call begin() first");
+  Entry &E = Trace.Stack.back();
+  E.Duration =
+      std::chrono::duration_cast<DurationType>(ClockType::now() - E.Start);
+
+  // Only count the outermost of nested events with the same name, so that
+  // recursive events do not inflate the totals.
+  if (std::none_of(Trace.Stack.begin(), Trace.Stack.end() - 1,
+                   [&](const Entry &Outer) { return Outer.Name == E.Name; })) {
+    auto &Total = Trace.Totals[E.Name];
+    ++Total.first;
+    Total.second += E.Duration;
+  }
+
+  // Only keep the sections that are at least as long as the granularity.
+  if (E.Duration >= Granularity)
+    Trace.Entries.push_back(std::move(E));
+  Trace.Stack.pop_back();
+}
+
+static void writeEscapedString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  for (unsigned char C : S) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+void TimeTraceProfiler::write(raw_ostream &OS) {
+  std::lock_guard<std::mutex> Guard(Lock);
+
+  OS << "{\"traceEvents\":[";
+  const char *Delim = "\n";
+  auto writeEvent = [&](unsigned Tid, int64_t Start, int64_t Duration,
+                        StringRef Name, StringRef ArgName, StringRef Arg) {
+    OS << Delim << "{\"pid\":1,\"tid\":" << Tid << ",\"ph\":\"X\",\"ts\":"
+       << Start << ",\"dur\":" << Duration << ",\"name\":";
+    writeEscapedString(OS, Name);
+    if (!Arg.empty()) {
+      OS << ",\"args\":{";
+      writeEscapedString(OS, ArgName);
+      OS << ':';
+      writeEscapedString(OS, Arg);
+      OS << '}';
+    }
+    OS << '}';
+    Delim = ",\n";
+  };
+
+  StringMap<std::pair<unsigned, DurationType>> Totals;
+  for (const auto &Trace : Threads) {
+    assert(Trace->Stack.empty() &&
+           "All profiler sections should be ended when calling write");
+    for (const Entry &E : Trace->Entries) {
+      int64_t Start =
+          std::chrono::duration_cast<DurationType>(E.Start - StartTime).count();
+      writeEvent(Trace->Tid, Start, E.Duration.count(), E.Name, "detail",
+                 E.Detail);
+    }
+    for (const auto &T : Trace->Totals) {
+      auto &Total = Totals[T.getKey()];
+      Total.first += T.getValue().first;
+      Total.second += T.getValue().second;
+    }
+  }
+
+  // Emit the totals as one row each, longest first, after the thread rows.
+  std::vector<const StringMapEntry<std::pair<unsigned, DurationType>> *>
+      SortedTotals;
+  for (const auto &T : Totals)
+    SortedTotals.push_back(&T);
+  std::sort(SortedTotals.begin(), SortedTotals.end(),
+            [](const StringMapEntry<std::pair<unsigned, DurationType>> *A,
+               const StringMapEntry<std::pair<unsigned, DurationType>> *B) {
+              if (A->getValue().second != B->getValue().second)
+                return A->getValue().second > B->getValue().second;
+              return A->getKey() < B->getKey();
+            });
+  unsigned Tid = Threads.size();
+  for (const auto *T : SortedTotals) {
+    int64_t Duration = T->getValue().second.count();
+    std::string Count = utostr(T->getValue().first);
+    writeEvent(Tid++, 0, Duration, ("Total " + T->getKey()).str(), "count",
+               Count);
+  }
+
+  OS << "\n]}\n";
+}
+
+void llvm::timeTraceProfilerInitialize(unsigned TimeTraceGranularity) {
+  assert(!timeTraceProfilerEnabled() && "Profiler should not be initialized");
+  TimeTraceProfilerInstance = new TimeTraceProfiler(
+      TimeTraceGranularity, ++ProfilerGeneration);
+}
+
+void llvm::timeTraceProfilerCleanup() {
+  delete TimeTraceProfilerInstance.exchange(nullptr);
+}
+
+void llvm::timeTraceProfilerWrite(raw_ostream &OS) {
+  assert(timeTraceProfilerEnabled() && "Profiler object can't be null");
+  TimeTraceProfilerInstance.load()->write(OS);
+}
+
+std::error_code llvm::timeTraceProfilerWrite(StringRef PreferredFileName,
+                                             StringRef FallbackFileName) {
+  assert(timeTraceProfilerEnabled() && "Profiler object can't be null");
+
+  std::string Path = PreferredFileName;
+  if (Path.empty())
+    Path = FallbackFileName.empty() || FallbackFileName == "-"
+               ? "out"
+               : FallbackFileName.str();
+  if (PreferredFileName.empty())
+    Path += ".time-trace.json";
+
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::F_Text);
+  if (EC)
+    return EC;
+  timeTraceProfilerWrite(OS);
+  return std::error_code();
+}
+
+void llvm::timeTraceProfilerBegin(StringRef Name, StringRef Detail) {
+  if (TimeTraceProfiler *P = TimeTraceProfilerInstance.load())
+    P->begin(Name, Detail);
+}
+
+void llvm::timeTraceProfilerEnd() {
+  if (TimeTraceProfiler *P = TimeTraceProfilerInstance.load())
+    P->end();
+}
@@ -0,0 +1,140 @@
+//===- xxhash.cpp - Fast non-cryptographic hashing ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements xxHash64, following the reference implementation at
+// https://github.com/Cyan4973/xxHash (BSD 2-Clause License,
+// Copyright (C) 2012-2016, Yann Collet).
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/xxhash.h"
+#include "llvm/Support/Endian.h"
+
+using namespace llvm;
+using namespace llvm::support;
+
+static const uint64_t PRIME64_1 = 11400714785074694791ULL;
+static const uint64_t PRIME64_2 = 14029467366897019727ULL;
+static const uint64_t PRIME64_3 = 1609587929392839161ULL;
+static const uint64_t PRIME64_4 = 9650029242287828579ULL;
+static const uint64_t PRIME64_5 = 2870177450012600261ULL;
+
+/// The seed of the second half of xxHash128.
+static const uint64_t SecondSeed = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rotl64(uint64_t X, unsigned R) {
+  return (X << R) | (X >> (64 - R));
+}
+
+static uint64_t round(uint64_t Acc, uint64_t Input) {
+  Acc += Input * PRIME64_2;
+  Acc = rotl64(Acc, 31);
+  Acc *= PRIME64_1;
+  return Acc;
+}
+
+static uint64_t mergeRound(uint64_t Acc, uint64_t Val) {
+  Val = round(0, Val);
+  Acc ^= Val;
+  Acc = Acc * PRIME64_1 + PRIME64_4;
+  return Acc;
+}
+
+namespace {
+/// The four accumulators that consume the input 32 bytes at a time.
+struct Accumulators {
+  uint64_t V1, V2, V3, V4;
+
+  explicit Accumulators(uint64_t Seed)
+      : V1(Seed + PRIME64_1 + PRIME64_2), V2(Seed + PRIME64_2), V3(Seed),
+        V4(Seed - PRIME64_1) {}
+
+  void consume(uint64_t W1, uint64_t W2, uint64_t W3, uint64_t W4) {
+    V1 = round(V1, W1);
+    V2 = round(V2, W2);
+    V3 = round(V3, W3);
+    V4 = round(V4, W4);
+  }
+
+  uint64_t merge() const {
+    uint64_t H64 =
+        rotl64(V1, 1) + rotl64(V2, 7) + rotl64(V3, 12) + rotl64(V4, 18);
+    H64 = mergeRound(H64, V1);
+    H64 = mergeRound(H64, V2);
+    H64 = mergeRound(H64, V3);
+    H64 = mergeRound(H64, V4);
+    return H64;
+  }
+};
+} // end anonymous namespace
+
+/// Hash the last, less than 32, bytes [\p P, \p End) of an input of \p Len
+/// bytes into \p H64 and mix the result.
+static uint64_t finalize(uint64_t H64, const uint8_t *P, const uint8_t *End,
+                         uint64_t Len) {
+  H64 += Len;
+
+  for (; End - P >= 8; P += 8) {
+    H64 ^= round(0, endian::read64le(P));
+    H64 = rotl64(H64, 27) * PRIME64_1 + PRIME64_4;
+  }
+  if (End - P >= 4) {
+    H64 ^= uint64_t(endian::read32le(P)) * PRIME64_1;
+    H64 = rotl64(H64, 23) * PRIME64_2 + PRIME64_3;
+    P += 4;
+  }
+  for (; P != End; ++P) {
+    H64 ^= *P * PRIME64_5;
+    H64 = rotl64(H64, 11) * PRIME64_1;
+  }
+
+  H64 ^= H64 >> 33;
+  H64 *= PRIME64_2;
+  H64 ^= H64 >> 29;
+  H64 *= PRIME64_3;
+  H64 ^= H64 >> 32;
+  return H64;
+}
+
+uint64_t llvm::xxHash64(ArrayRef<uint8_t> Data, uint64_t Seed) {
+  const uint8_t *P = Data.begin(), *End = Data.end();
+  uint64_t H64 = Seed + PRIME64_5;
+
+  if (Data.size() >= 32) {
+    Accumulators Acc(Seed);
+    for (; End - P >= 32; P += 32)
+      Acc.consume(endian::read64le(P), endian::read64le(P + 8),
+                  endian::read64le(P + 16), endian::read64le(P + 24));
+    H64 = Acc.merge();
+  }
+
+  return finalize(H64, P, End, Data.size());
+}
+
+std::pair<uint64_t, uint64_t> llvm::xxHash128(ArrayRef<uint8_t> Data) {
+  const uint8_t *P = Data.begin(), *End = Data.end();
+  uint64_t Low = PRIME64_5, High = SecondSeed + PRIME64_5;
+
+  if (Data.size() >= 32) {
+    // Feed each stripe to both sets of accumulators, whose independent
+    // dependency chains then run in parallel.
+    Accumulators LowAcc(0), HighAcc(SecondSeed);
+    for (; End - P >= 32; P += 32) {
+      uint64_t W1 = endian::read64le(P), W2 = endian::read64le(P + 8),
+               W3 = endian::read64le(P + 16), W4 = endian::read64le(P + 24);
+      LowAcc.consume(W1, W2, W3, W4);
+      HighAcc.consume(W1, W2, W3, W4);
+    }
+    Low = LowAcc.merge();
+    High = HighAcc.merge();
+  }
+
+  return std::make_pair(finalize(Low, P, End, Data.size()),
+                        finalize(High, P, End, Data.size()));
+}
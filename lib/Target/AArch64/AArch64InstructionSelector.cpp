@@ -0,0 +1,187 @@
+//===- AArch64InstructionSelector.cpp ----------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the InstructionSelector class for
+/// AArch64.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "AArch64InstructionSelector.h"
+#include "AArch64InstrInfo.h"
+#include "AArch64RegisterBankInfo.h"
+#include "AArch64RegisterInfo.h"
+#include "AArch64Subtarget.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Type.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "aarch64-isel"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "This shouldn't be built without GISel"
+#endif
+
+AArch64InstructionSelector::AArch64InstructionSelector(
+    const AArch64Subtarget &STI, const AArch64RegisterBankInfo &RBI)
+    : InstructionSelector(), TII(*STI.getInstrInfo()),
+      TRI(*STI.getRegisterInfo()), RBI(RBI) {}
+
+/// Returns the register class able to hold a \p Size bits value living in
+/// the register bank \p RB, or nullptr if there is none.
+static const TargetRegisterClass *
+getRegClassForBank(const RegisterBank &RB, unsigned Size) {
+  switch (RB.getID()) {
+  case AArch64::GPRRegBankID:
+    if (Size <= 32)
+      return &AArch64::GPR32RegClass;
+    if (Size == 64)
+      return &AArch64::GPR64RegClass;
+    return nullptr;
+  case AArch64::FPRRegBankID:
+    if (Size == 32)
+      return &AArch64::FPR32RegClass;
+    if (Size == 64)
+      return &AArch64::FPR64RegClass;
+    if (Size == 128)
+      return &AArch64::FPR128RegClass;
+    return nullptr;
+  default:
+    return nullptr;
+  }
+}
+
+/// Constrain every generic virtual register used or defined by \p I to the
+/// register class matching its register bank and size.
+/// \returns false if one of them cannot be constrained.
+static bool constrainGenericRegs(MachineInstr &I, MachineRegisterInfo &MRI,
+                                 const TargetRegisterInfo &TRI,
+                                 const RegisterBankInfo &RBI) {
+  for (MachineOperand &MO : I.operands()) {
+    if (!MO.isReg() || !MO.getReg() ||
+        !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+      continue;
+    unsigned Reg = MO.getReg();
+    if (MRI.getRegClassOrNull(Reg))
+      continue;
+    const RegisterBank *RB = RBI.getRegBank(Reg, MRI, TRI);
+    if (!RB) {
+      DEBUG(dbgs() << "Generic register has no bank\n");
+      return false;
+    }
+    const TargetRegisterClass *RC = getRegClassForBank(*RB, MRI.getSize(Reg));
+    if (!RC) {
+      DEBUG(dbgs() << "No register class for " << MRI.getSize(Reg)
+                   << "-bit values on bank " << RB->getName() << '\n');
+      return false;
+    }
+    MRI.setRegClass(Reg, RC);
+  }
+  return true;
+}
+
+/// Select the AArch64 opcode for the generic binary instruction \p GenericOpc,
+/// operating on values of type \p Ty and size \p OpSize living in the register
+/// bank \p RegBankID.
+/// \returns \p GenericOpc if the combination is unsupported.
+static unsigned selectBinaryOp(unsigned GenericOpc, unsigned RegBankID,
+                               unsigned OpSize, const Type *Ty) {
+  switch (RegBankID) {
+  case AArch64::GPRRegBankID:
+    if (OpSize != 32 && OpSize != 64)
+      return GenericOpc;
+    switch (GenericOpc) {
+    case TargetOpcode::G_ADD:
+      return OpSize == 32 ? AArch64::ADDWrr : AArch64::ADDXrr;
+    case TargetOpcode::G_OR:
+      return OpSize == 32 ? AArch64::ORRWrr : AArch64::ORRXrr;
+    default:
+      return GenericOpc;
+    }
+  case AArch64::FPRRegBankID:
+    if (OpSize != 64 && OpSize != 128)
+      return GenericOpc;
+    switch (GenericOpc) {
+    case TargetOpcode::G_OR:
+      return OpSize == 64 ? AArch64::ORRv8i8 : AArch64::ORRv16i8;
+    case TargetOpcode::G_ADD: {
+      if (!Ty || !Ty->isVectorTy())
+        return GenericOpc;
+      unsigned EltSize = Ty->getScalarSizeInBits();
+      if (OpSize == 64) {
+        switch (EltSize) {
+        case 8:  return AArch64::ADDv8i8;
+        case 16: return AArch64::ADDv4i16;
+        case 32: return AArch64::ADDv2i32;
+        case 64: return AArch64::ADDv1i64;
+        default: return GenericOpc;
+        }
+      }
+      switch (EltSize) {
+      case 8:  return AArch64::ADDv16i8;
+      case 16: return AArch64::ADDv8i16;
+      case 32: return AArch64::ADDv4i32;
+      case 64: return AArch64::ADDv2i64;
+      default: return GenericOpc;
+      }
+    }
+    default:
+      return GenericOpc;
+    }
+  default:
+    return GenericOpc;
+  }
+}
+
+bool AArch64InstructionSelector::select(MachineInstr &I) const {
+  assert(I.getParent() && "Instruction should be in a basic block!");
+  assert(I.getParent()->getParent() && "Instruction should be in a function!");
+
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineFunction &MF = *MBB.getParent();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  // Target instructions, e.g. the copies created by the call lowering, only
+  // need their generic registers to be constrained.
+  if (!isPreISelGenericOpcode(I.getOpcode()))
+    return constrainGenericRegs(I, MRI, TRI, RBI);
+
+  switch (I.getOpcode()) {
+  case TargetOpcode::G_BR:
+    I.setType(nullptr);
+    I.setDesc(TII.get(AArch64::B));
+    return true;
+
+  case TargetOpcode::G_ADD:
+  case TargetOpcode::G_OR: {
+    const unsigned DefReg = I.getOperand(0).getReg();
+    const RegisterBank *RB = RBI.getRegBank(DefReg, MRI, TRI);
+    if (!RB)
+      return false;
+
+    const unsigned NewOpc = selectBinaryOp(I.getOpcode(), RB->getID(),
+                                           MRI.getSize(DefReg), I.getType());
+    if (NewOpc == I.getOpcode())
+      return false;
+
+    I.setType(nullptr);
+    I.setDesc(TII.get(NewOpc));
+    return constrainGenericRegs(I, MRI, TRI, RBI);
+  }
+
+  default:
+    return false;
+  }
+}
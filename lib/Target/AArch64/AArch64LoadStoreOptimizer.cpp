@@ -18,6 +18,7 @@
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstr.h"
@@ -51,6 +52,11 @@ static cl::opt<unsigned> LdStLimit("aarch64-load-store-scan-limit",
 static cl::opt<unsigned> UpdateLimit("aarch64-update-scan-limit", cl::init(100),
                                      cl::Hidden);
 
+// Use alias analysis to tell apart memory accesses with different base
+// registers, e.g., the loads and stores of a copy between two objects.
+static cl::opt<bool> EnableLdStAA("aarch64-load-store-aa", cl::init(true),
+                                  cl::Hidden);
+
 static cl::opt<bool> EnableNarrowLdMerge("enable-narrow-ld-merge", cl::Hidden,
                                          cl::init(false),
                                          cl::desc("Enable narrow load merge"));
@@ -94,6 +100,7 @@ struct AArch64LoadStoreOpt : public MachineFunctionPass {
   const AArch64InstrInfo *TII;
   const TargetRegisterInfo *TRI;
   const AArch64Subtarget *Subtarget;
+  AliasAnalysis *AA;
 
   // Track which registers have been modified and used.
   BitVector ModifiedRegs, UsedRegs;
@@ -164,6 +171,11 @@ struct AArch64LoadStoreOpt : public MachineFunctionPass {
 
   bool runOnMachineFunction(MachineFunction &Fn) override;
 
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<AAResultsWrapperPass>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
   MachineFunctionProperties getRequiredProperties() const override {
     return MachineFunctionProperties().set(
         MachineFunctionProperties::Property::AllVRegsAllocated);
@@ -176,8 +188,11 @@ struct AArch64LoadStoreOpt : public MachineFunctionPass {
 char AArch64LoadStoreOpt::ID = 0;
 } // namespace
 
-INITIALIZE_PASS(AArch64LoadStoreOpt, "aarch64-ldst-opt",
-                AARCH64_LOAD_STORE_OPT_NAME, false, false)
+INITIALIZE_PASS_BEGIN(AArch64LoadStoreOpt, "aarch64-ldst-opt",
+                      AARCH64_LOAD_STORE_OPT_NAME, false, false)
+INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
+INITIALIZE_PASS_END(AArch64LoadStoreOpt, "aarch64-ldst-opt",
+                    AARCH64_LOAD_STORE_OPT_NAME, false, false)
 
 static unsigned getBitExtrOpcode(MachineInstr *MI) {
   switch (MI->getOpcode()) {
@@ -449,34 +464,49 @@ static unsigned getPreIndexedOpcode(unsigned Opc) {
   default:
     llvm_unreachable("Opcode has no pre-indexed equivalent!");
   case AArch64::STRSui:
+  case AArch64::STURSi:
     return AArch64::STRSpre;
   case AArch64::STRDui:
+  case AArch64::STURDi:
     return AArch64::STRDpre;
   case AArch64::STRQui:
+  case AArch64::STURQi:
     return AArch64::STRQpre;
   case AArch64::STRBBui:
+  case AArch64::STURBBi:
     return AArch64::STRBBpre;
   case AArch64::STRHHui:
+  case AArch64::STURHHi:
     return AArch64::STRHHpre;
   case AArch64::STRWui:
+  case AArch64::STURWi:
     return AArch64::STRWpre;
   case AArch64::STRXui:
+  case AArch64::STURXi:
     return AArch64::STRXpre;
   case AArch64::LDRSui:
+  case AArch64::LDURSi:
     return AArch64::LDRSpre;
   case AArch64::LDRDui:
+  case AArch64::LDURDi:
     return AArch64::LDRDpre;
   case AArch64::LDRQui:
+  case AArch64::LDURQi:
     return AArch64::LDRQpre;
   case AArch64::LDRBBui:
+  case AArch64::LDURBBi:
     return AArch64::LDRBBpre;
   case AArch64::LDRHHui:
+  case AArch64::LDURHHi:
     return AArch64::LDRHHpre;
   case AArch64::LDRWui:
+  case AArch64::LDURWi:
     return AArch64::LDRWpre;
   case AArch64::LDRXui:
+  case AArch64::LDURXi:
     return AArch64::LDRXpre;
   case AArch64::LDRSWui:
+  case AArch64::LDURSWi:
     return AArch64::LDRSWpre;
   case AArch64::LDPSi:
     return AArch64::LDPSpre;
@@ -508,34 +538,49 @@ static unsigned getPostIndexedOpcode(unsigned Opc) {
   default:
     llvm_unreachable("Opcode has no post-indexed wise equivalent!");
   case AArch64::STRSui:
+  case AArch64::STURSi:
     return AArch64::STRSpost;
   case AArch64::STRDui:
+  case AArch64::STURDi:
     return AArch64::STRDpost;
   case AArch64::STRQui:
+  case AArch64::STURQi:
     return AArch64::STRQpost;
   case AArch64::STRBBui:
+  case AArch64::STURBBi:
     return AArch64::STRBBpost;
   case AArch64::STRHHui:
+  case AArch64::STURHHi:
     return AArch64::STRHHpost;
   case AArch64::STRWui:
+  case AArch64::STURWi:
     return AArch64::STRWpost;
   case AArch64::STRXui:
+  case AArch64::STURXi:
     return AArch64::STRXpost;
   case AArch64::LDRSui:
+  case AArch64::LDURSi:
     return AArch64::LDRSpost;
   case AArch64::LDRDui:
+  case AArch64::LDURDi:
     return AArch64::LDRDpost;
   case AArch64::LDRQui:
+  case AArch64::LDURQi:
     return AArch64::LDRQpost;
   case AArch64::LDRBBui:
+  case AArch64::LDURBBi:
     return AArch64::LDRBBpost;
   case AArch64::LDRHHui:
+  case AArch64::LDURHHi:
     return AArch64::LDRHHpost;
   case AArch64::LDRWui:
+  case AArch64::LDURWi:
     return AArch64::LDRWpost;
   case AArch64::LDRXui:
+  case AArch64::LDURXi:
     return AArch64::LDRXpost;
   case AArch64::LDRSWui:
+  case AArch64::LDURSWi:
     return AArch64::LDRSWpost;
   case AArch64::LDPSi:
     return AArch64::LDPSpost;
@@ -1073,7 +1118,7 @@ static int alignTo(int Num, int PowOf2) {
 }
 
 static bool mayAlias(MachineInstr &MIa, MachineInstr &MIb,
-                     const AArch64InstrInfo *TII) {
+                     const AArch64InstrInfo *TII, AliasAnalysis *AA) {
   // One of the instructions must modify memory.
   if (!MIa.mayStore() && !MIb.mayStore())
     return false;
@@ -1082,14 +1127,34 @@ static bool mayAlias(MachineInstr &MIa, MachineInstr &MIb,
   if (!MIa.mayLoadOrStore() && !MIb.mayLoadOrStore())
     return false;
 
-  return !TII->areMemAccessesTriviallyDisjoint(MIa, MIb);
+  // Accesses off the same base register are told apart by their offsets,
+  // which is cheap, so only ask AA about the others.
+  if (TII->areMemAccessesTriviallyDisjoint(MIa, MIb))
+    return false;
+  if (!AA || MIa.hasOrderedMemoryRef() || MIb.hasOrderedMemoryRef() ||
+      !MIa.hasOneMemOperand() || !MIb.hasOneMemOperand())
+    return true;
+
+  MachineMemOperand *MMOa = *MIa.memoperands_begin();
+  MachineMemOperand *MMOb = *MIb.memoperands_begin();
+  if (!MMOa->getValue() || !MMOb->getValue() || MMOa->getOffset() < 0 ||
+      MMOb->getOffset() < 0)
+    return true;
+
+  // As in the scheduler's dependence check, the offsets of the memory
+  // operands only widen the locations that are queried.
+  int64_t MinOffset = std::min(MMOa->getOffset(), MMOb->getOffset());
+  int64_t Overlapa = MMOa->getSize() + MMOa->getOffset() - MinOffset;
+  int64_t Overlapb = MMOb->getSize() + MMOb->getOffset() - MinOffset;
+  return AA->alias(MemoryLocation(MMOa->getValue(), Overlapa),
+                   MemoryLocation(MMOb->getValue(), Overlapb)) != NoAlias;
 }
 
 static bool mayAlias(MachineInstr &MIa,
                      SmallVectorImpl<MachineInstr *> &MemInsns,
-                     const AArch64InstrInfo *TII) {
+                     const AArch64InstrInfo *TII, AliasAnalysis *AA) {
   for (MachineInstr *MIb : MemInsns)
-    if (mayAlias(MIa, *MIb, TII))
+    if (mayAlias(MIa, *MIb, TII, AA))
       return true;
 
   return false;
@@ -1146,7 +1211,7 @@ bool AArch64LoadStoreOpt::findMatchingStore(
       return false;
 
     // If we encounter a store aliased with the load, return early.
-    if (MI->mayStore() && mayAlias(*LoadMI, *MI, TII))
+    if (MI->mayStore() && mayAlias(*LoadMI, *MI, TII, AA))
       return false;
   } while (MBBI != B && Count < Limit);
   return false;
@@ -1314,7 +1379,7 @@ AArch64LoadStoreOpt::findMatchingInsn(MachineBasicBlock::iterator I,
         // first.
         if (!ModifiedRegs[getLdStRegOp(MI).getReg()] &&
             !(MI->mayLoad() && UsedRegs[getLdStRegOp(MI).getReg()]) &&
-            !mayAlias(*MI, MemInsns, TII)) {
+            !mayAlias(*MI, MemInsns, TII, AA)) {
           Flags.setMergeForward(false);
           return MBBI;
         }
@@ -1325,7 +1390,7 @@ AArch64LoadStoreOpt::findMatchingInsn(MachineBasicBlock::iterator I,
         // into the second.
         if (!ModifiedRegs[getLdStRegOp(FirstMI).getReg()] &&
             !(MayLoad && UsedRegs[getLdStRegOp(FirstMI).getReg()]) &&
-            !mayAlias(*FirstMI, MemInsns, TII)) {
+            !mayAlias(*FirstMI, MemInsns, TII, AA)) {
           Flags.setMergeForward(true);
           return MBBI;
         }
@@ -1478,7 +1543,9 @@ MachineBasicBlock::iterator AArch64LoadStoreOpt::findMatchingUpdateInsnForward(
   MachineBasicBlock::iterator MBBI = I;
 
   unsigned BaseReg = getLdStBaseOp(MemMI).getReg();
-  int MIUnscaledOffset = getLdStOffsetOp(MemMI).getImm() * getMemScale(MemMI);
+  int MIUnscaledOffset = getLdStOffsetOp(MemMI).getImm();
+  if (!TII->isUnscaledLdSt(*MemMI))
+    MIUnscaledOffset *= getMemScale(MemMI);
 
   // Scan forward looking for post-index opportunities.  Updating instructions
   // can't be formed if the memory instruction doesn't have the offset we're
@@ -1827,11 +1894,15 @@ bool AArch64LoadStoreOpt::optimizeBlock(MachineBasicBlock &MBB,
     case AArch64::STURQi:
     case AArch64::STURWi:
     case AArch64::STURXi:
+    case AArch64::STURHHi:
+    case AArch64::STURBBi:
     case AArch64::LDURSi:
     case AArch64::LDURDi:
     case AArch64::LDURQi:
     case AArch64::LDURWi:
     case AArch64::LDURXi:
+    case AArch64::LDURHHi:
+    case AArch64::LDURBBi:
     // Paired instructions.
     case AArch64::LDPSi:
     case AArch64::LDPSWi:
@@ -1863,13 +1934,6 @@ bool AArch64LoadStoreOpt::optimizeBlock(MachineBasicBlock &MBB,
         ++NumPostFolded;
         break;
       }
-      // Don't know how to handle pre/post-index versions, so move to the next
-      // instruction.
-      if (TII->isUnscaledLdSt(Opc)) {
-        ++MBBI;
-        break;
-      }
-
       // Look back to try to find a pre-index instruction. For example,
       // add x0, x0, #8
       // ldr x1, [x0]
@@ -1883,10 +1947,13 @@ bool AArch64LoadStoreOpt::optimizeBlock(MachineBasicBlock &MBB,
         ++NumPreFolded;
         break;
       }
-      // The immediate in the load/store is scaled by the size of the memory
-      // operation. The immediate in the add we're looking for,
-      // however, is not, so adjust here.
-      int UnscaledOffset = getLdStOffsetOp(MI).getImm() * getMemScale(MI);
+      // The immediate in a scaled load/store is scaled by the size of the
+      // memory operation. The immediate in the add we're looking for,
+      // however, is not, so adjust here. The pre-indexed forms take the
+      // same unscaled 9-bit offset as the unscaled instructions.
+      int UnscaledOffset = getLdStOffsetOp(MI).getImm();
+      if (!TII->isUnscaledLdSt(Opc))
+        UnscaledOffset *= getMemScale(MI);
 
       // Look forward to try to find a post-index instruction. For example,
       // ldr x1, [x0, #64]
@@ -1919,6 +1986,8 @@ bool AArch64LoadStoreOpt::runOnMachineFunction(MachineFunction &Fn) {
   Subtarget = &static_cast<const AArch64Subtarget &>(Fn.getSubtarget());
   TII = static_cast<const AArch64InstrInfo *>(Subtarget->getInstrInfo());
   TRI = Subtarget->getRegisterInfo();
+  AA = EnableLdStAA ? &getAnalysis<AAResultsWrapperPass>().getAAResults()
+                    : nullptr;
 
   // Resize the modified and used register bitfield trackers.  We do this once
   // per function and then clear the bitfield each time we optimize a load or
@@ -237,6 +237,13 @@ public:
   /// the given LDS memory size is the only constraint.
   unsigned getOccupancyWithLocalMemSize(uint32_t Bytes) const;
 
+  /// Return the maximum number of waves per SIMD if the number of SGPRs used
+  /// by a kernel is the only constraint.
+  unsigned getOccupancyWithNumSGPRs(unsigned SGPRs) const;
+
+  /// Return the maximum number of waves per SIMD if the number of VGPRs used
+  /// by a kernel is the only constraint.
+  unsigned getOccupancyWithNumVGPRs(unsigned VGPRs) const;
 
   bool hasFP32Denormals() const {
     return FP32Denormals;
@@ -29,6 +29,12 @@ using namespace llvm;
 
 #define DEBUG_TYPE "AMDGPUtti"
 
+static cl::opt<unsigned> UnrollMinWaves(
+  "amdgpu-unroll-min-waves",
+  cl::desc("Number of waves per SIMD partial unrolling should not make the "
+           "loaded values of a loop exceed the VGPRs of"),
+  cl::init(4),
+  cl::Hidden);
 
 void AMDGPUTTIImpl::getUnrollingPreferences(Loop *L,
                                             TTI::UnrollingPreferences &UP) {
@@ -63,6 +69,52 @@ void AMDGPUTTIImpl::getUnrollingPreferences(Loop *L,
       }
     }
   }
+
+  if (ST->getGeneration() < AMDGPUSubtarget::SOUTHERN_ISLANDS)
+    return;
+
+  // The loads of the unrolled iterations tend to be scheduled together, so
+  // each copy of the body adds its loaded values to the VGPR pressure. Stop
+  // partial unrolling before that estimate loses the occupancy the rolled
+  // loop has, or falls under UnrollMinWaves. Loads from the constant address
+  // space go to SGPRs and private loads are expected to be promoted.
+  const DataLayout &DL = L->getHeader()->getModule()->getDataLayout();
+  unsigned LiveVGPRs = 0;
+  for (const Instruction &I : *L->getHeader()) {
+    const PHINode *PN = dyn_cast<PHINode>(&I);
+    if (!PN)
+      break;
+    LiveVGPRs += (DL.getTypeStoreSize(PN->getType()) + 3) / 4;
+  }
+
+  unsigned LoadVGPRs = 0;
+  for (const BasicBlock *BB : L->getBlocks()) {
+    for (const Instruction &I : *BB) {
+      const LoadInst *Load = dyn_cast<LoadInst>(&I);
+      if (!Load)
+        continue;
+      unsigned AS = Load->getPointerAddressSpace();
+      if (AS == AMDGPUAS::CONSTANT_ADDRESS || AS == AMDGPUAS::PRIVATE_ADDRESS)
+        continue;
+      LoadVGPRs += (DL.getTypeStoreSize(Load->getType()) + 3) / 4;
+    }
+  }
+  if (!LoadVGPRs)
+    return;
+
+  const unsigned MaxVGPRs = 256;
+  unsigned MinWaves = std::min<unsigned>(
+      UnrollMinWaves, ST->getOccupancyWithNumVGPRs(LiveVGPRs + LoadVGPRs));
+  unsigned Count = 1;
+  while (Count < UP.MaxCount) {
+    unsigned VGPRs = LiveVGPRs + (Count + 1) * LoadVGPRs;
+    if (VGPRs > MaxVGPRs || ST->getOccupancyWithNumVGPRs(VGPRs) < MinWaves)
+      break;
+    ++Count;
+  }
+  DEBUG(dbgs() << "Limiting partial unrolling to " << Count
+               << " for register pressure\n");
+  UP.MaxCount = Count;
 }
 
 unsigned AMDGPUTTIImpl::getNumberOfRegisters(bool Vec) {
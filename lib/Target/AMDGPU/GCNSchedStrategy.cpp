@@ -0,0 +1,287 @@
+//===-- GCNSchedStrategy.cpp - GCN Scheduler Strategy ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// This contains a MachineSchedStrategy implementation for maximizing wave
+/// occupancy on GCN hardware.
+//===----------------------------------------------------------------------===//
+
+#include "GCNSchedStrategy.h"
+#include "AMDGPUSubtarget.h"
+#include "SIMachineFunctionInfo.h"
+#include "SIRegisterInfo.h"
+#include "llvm/CodeGen/RegisterClassInfo.h"
+#include "llvm/Support/CommandLine.h"
+
+#define DEBUG_TYPE "misched"
+
+using namespace llvm;
+
+// A region whose pressure is at most this many registers over the limit of
+// the next occupancy tier is scheduled for that tier.
+static cl::opt<unsigned> OccupancySlack(
+  "amdgpu-sched-occupancy-slack",
+  cl::desc("Number of registers the GCN scheduler tries to save to reach "
+           "the next occupancy tier"),
+  cl::init(8),
+  cl::Hidden);
+
+GCNMaxOccupancySchedStrategy::GCNMaxOccupancySchedStrategy(
+    const MachineSchedContext *C) :
+    GenericScheduler(C), SRI(nullptr), SGPRExcessLimit(0), VGPRExcessLimit(0),
+    SGPRCriticalLimit(0), VGPRCriticalLimit(0), TargetOccupancy(0) { }
+
+static unsigned getMaxWaves(unsigned SGPRs, unsigned VGPRs,
+                            const MachineFunction &MF) {
+  const SISubtarget &ST = MF.getSubtarget<SISubtarget>();
+  const SIMachineFunctionInfo *MFI = MF.getInfo<SIMachineFunctionInfo>();
+  unsigned MinRegOccupancy = std::min(ST.getOccupancyWithNumSGPRs(SGPRs),
+                                      ST.getOccupancyWithNumVGPRs(VGPRs));
+  return std::min(MinRegOccupancy,
+                  ST.getOccupancyWithLocalMemSize(MFI->LDSSize));
+}
+
+void GCNMaxOccupancySchedStrategy::initPolicy(MachineBasicBlock::iterator Begin,
+                                              MachineBasicBlock::iterator End,
+                                              unsigned NumRegionInstrs) {
+  GenericScheduler::initPolicy(Begin, End, NumRegionInstrs);
+
+  // The generic scheduler only tracks pressure in regions that are large
+  // compared to the number of registers, but any region can decide the
+  // occupancy.
+  RegionPolicy.ShouldTrackPressure = true;
+}
+
+void GCNMaxOccupancySchedStrategy::initialize(ScheduleDAGMI *dag) {
+  GenericScheduler::initialize(dag);
+
+  const MachineFunction &MF = DAG->MF;
+  const SISubtarget &ST = MF.getSubtarget<SISubtarget>();
+  SRI = static_cast<const SIRegisterInfo *>(TRI);
+
+  if (!DAG->isTrackingPressure())
+    return;
+
+  SGPRExcessLimit =
+      Context->RegClassInfo->getNumAllocatableRegs(&AMDGPU::SGPR_32RegClass);
+  VGPRExcessLimit =
+      Context->RegClassInfo->getNumAllocatableRegs(&AMDGPU::VGPR_32RegClass);
+
+  // Schedule for the occupancy the region has before scheduling, or for the
+  // next one if it is only a few registers over its limits.
+  const std::vector<unsigned> &RegionPressure =
+      DAG->getRegPressure().MaxSetPressure;
+  unsigned SGPRs = RegionPressure[SRI->getSGPR32PressureSet()];
+  unsigned VGPRs = RegionPressure[SRI->getVGPR32PressureSet()];
+  TargetOccupancy = getMaxWaves(SGPRs, VGPRs, MF);
+  if (TargetOccupancy < getMaxWaves(0, 0, MF)) {
+    unsigned Next = TargetOccupancy + 1;
+    if (SGPRs <= SRI->getNumSGPRsAllowed(ST, Next) + OccupancySlack &&
+        VGPRs <= SRI->getNumVGPRsAllowed(Next) + OccupancySlack)
+      TargetOccupancy = Next;
+  }
+
+  SGPRCriticalLimit = std::min(SRI->getNumSGPRsAllowed(ST, TargetOccupancy),
+                               SGPRExcessLimit);
+  VGPRCriticalLimit = std::min(SRI->getNumVGPRsAllowed(TargetOccupancy),
+                               VGPRExcessLimit);
+
+  DEBUG(dbgs() << "Region pressure: " << SGPRs << " SGPRs, " << VGPRs
+               << " VGPRs, scheduling for " << TargetOccupancy
+               << " waves\n");
+}
+
+/// Return how much the pressure goes over \p Limit, or comes back under it,
+/// when it changes from \p Cur to \p New.
+static int getPressureOver(unsigned Cur, unsigned New, unsigned Limit) {
+  if (Cur > Limit)
+    return (int)New - (int)Cur;
+  if (New > Limit)
+    return (int)New - (int)Limit;
+  return 0;
+}
+
+void GCNMaxOccupancySchedStrategy::initCandidate(SchedCandidate &Cand,
+                                                 SUnit *SU, bool AtTop,
+                                       const RegPressureTracker &RPTracker) {
+  Cand.SU = SU;
+  Cand.AtTop = AtTop;
+
+  // getDownwardPressure() and getUpwardPressure() make temporary changes to
+  // the tracker, so they need a non-const reference.
+  RegPressureTracker &TempTracker = const_cast<RegPressureTracker &>(RPTracker);
+  if (AtTop)
+    TempTracker.getDownwardPressure(SU->getInstr(), Pressure, MaxPressure);
+  else
+    TempTracker.getUpwardPressure(SU->getInstr(), Pressure, MaxPressure);
+
+  unsigned SGPRSet = SRI->getSGPR32PressureSet();
+  unsigned VGPRSet = SRI->getVGPR32PressureSet();
+  ArrayRef<unsigned> CurPressure = RPTracker.getRegSetPressureAtPos();
+
+  // Only one set is reported, so that the generic heuristics never weigh an
+  // SGPR against a VGPR. VGPRs are the ones that usually limit occupancy.
+  int VGPRExcess = getPressureOver(CurPressure[VGPRSet], Pressure[VGPRSet],
+                                   VGPRExcessLimit);
+  int SGPRExcess = getPressureOver(CurPressure[SGPRSet], Pressure[SGPRSet],
+                                   SGPRExcessLimit);
+  if (VGPRExcess) {
+    Cand.RPDelta.Excess = PressureChange(VGPRSet);
+    Cand.RPDelta.Excess.setUnitInc(VGPRExcess);
+  } else if (SGPRExcess) {
+    Cand.RPDelta.Excess = PressureChange(SGPRSet);
+    Cand.RPDelta.Excess.setUnitInc(SGPRExcess);
+  }
+
+  int VGPRCritical = getPressureOver(CurPressure[VGPRSet], Pressure[VGPRSet],
+                                     VGPRCriticalLimit);
+  int SGPRCritical = getPressureOver(CurPressure[SGPRSet], Pressure[SGPRSet],
+                                     SGPRCriticalLimit);
+  if (VGPRCritical) {
+    Cand.RPDelta.CriticalMax = PressureChange(VGPRSet);
+    Cand.RPDelta.CriticalMax.setUnitInc(VGPRCritical);
+  } else if (SGPRCritical) {
+    Cand.RPDelta.CriticalMax = PressureChange(SGPRSet);
+    Cand.RPDelta.CriticalMax.setUnitInc(SGPRCritical);
+  }
+}
+
+// This function is mostly cut and pasted from
+// GenericScheduler::pickNodeFromQueue()
+void GCNMaxOccupancySchedStrategy::pickNodeFromQueue(SchedBoundary &Zone,
+                                         const CandPolicy &ZonePolicy,
+                                         const RegPressureTracker &RPTracker,
+                                         SchedCandidate &Cand) {
+  ReadyQueue &Q = Zone.Available;
+  for (SUnit *SU : Q) {
+    SchedCandidate TryCand(ZonePolicy);
+    initCandidate(TryCand, SU, Zone.isTop(), RPTracker);
+    // Pass SchedBoundary only when comparing nodes from the same boundary.
+    SchedBoundary *ZoneArg = Cand.AtTop == TryCand.AtTop ? &Zone : nullptr;
+    GenericScheduler::tryCandidate(Cand, TryCand, ZoneArg);
+    if (TryCand.Reason != NoCand) {
+      // Initialize resource delta if needed in case future heuristics query it.
+      if (TryCand.ResDelta == SchedResourceDelta())
+        TryCand.initResourceDelta(Zone.DAG, SchedModel);
+      Cand.setBest(TryCand);
+    }
+  }
+}
+
+// This function is mostly cut and pasted from
+// GenericScheduler::pickNodeBidirectional()
+SUnit *GCNMaxOccupancySchedStrategy::pickNodeBidirectional(bool &IsTopNode) {
+  // Schedule as far as possible in the direction of no choice. This is most
+  // efficient, but also provides the best heuristics for CriticalPSets.
+  if (SUnit *SU = Bot.pickOnlyChoice()) {
+    IsTopNode = false;
+    return SU;
+  }
+  if (SUnit *SU = Top.pickOnlyChoice()) {
+    IsTopNode = true;
+    return SU;
+  }
+  // Set the bottom-up policy based on the state of the current bottom zone and
+  // the instructions outside the zone, including the top zone.
+  CandPolicy BotPolicy;
+  setPolicy(BotPolicy, /*IsPostRA=*/false, Bot, &Top);
+  // Set the top-down policy based on the state of the current top zone and
+  // the instructions outside the zone, including the bottom zone.
+  CandPolicy TopPolicy;
+  setPolicy(TopPolicy, /*IsPostRA=*/false, Top, &Bot);
+
+  // See if BotCand is still valid (because we previously scheduled from Top).
+  DEBUG(dbgs() << "Picking from Bot:\n");
+  if (!BotCand.isValid() || BotCand.SU->isScheduled ||
+      BotCand.Policy != BotPolicy) {
+    BotCand.reset(CandPolicy());
+    pickNodeFromQueue(Bot, BotPolicy, DAG->getBotRPTracker(), BotCand);
+    assert(BotCand.Reason != NoCand && "failed to find the first candidate");
+  } else {
+    DEBUG(traceCandidate(BotCand));
+  }
+
+  // Check if the top Q has a better candidate.
+  DEBUG(dbgs() << "Picking from Top:\n");
+  if (!TopCand.isValid() || TopCand.SU->isScheduled ||
+      TopCand.Policy != TopPolicy) {
+    TopCand.reset(CandPolicy());
+    pickNodeFromQueue(Top, TopPolicy, DAG->getTopRPTracker(), TopCand);
+    assert(TopCand.Reason != NoCand && "failed to find the first candidate");
+  } else {
+    DEBUG(traceCandidate(TopCand));
+  }
+
+  // Pick best from BotCand and TopCand.
+  DEBUG(
+    dbgs() << "Top Cand: ";
+    traceCandidate(TopCand);
+    dbgs() << "Bot Cand: ";
+    traceCandidate(BotCand);
+  );
+  SchedCandidate Cand = BotCand;
+  TopCand.Reason = NoCand;
+  GenericScheduler::tryCandidate(Cand, TopCand, nullptr);
+  if (TopCand.Reason != NoCand)
+    Cand.setBest(TopCand);
+  DEBUG(
+    dbgs() << "Picking: ";
+    traceCandidate(Cand);
+  );
+
+  IsTopNode = Cand.AtTop;
+  return Cand.SU;
+}
+
+// This function is mostly cut and pasted from
+// GenericScheduler::pickNode()
+SUnit *GCNMaxOccupancySchedStrategy::pickNode(bool &IsTopNode) {
+  if (!DAG->isTrackingPressure())
+    return GenericScheduler::pickNode(IsTopNode);
+
+  if (DAG->top() == DAG->bottom()) {
+    assert(Top.Available.empty() && Top.Pending.empty() &&
+           Bot.Available.empty() && Bot.Pending.empty() && "ReadyQ garbage");
+    return nullptr;
+  }
+  SUnit *SU;
+  do {
+    if (RegionPolicy.OnlyTopDown) {
+      SU = Top.pickOnlyChoice();
+      if (!SU) {
+        CandPolicy NoPolicy;
+        TopCand.reset(NoPolicy);
+        pickNodeFromQueue(Top, NoPolicy, DAG->getTopRPTracker(), TopCand);
+        assert(TopCand.Reason != NoCand && "failed to find a candidate");
+        SU = TopCand.SU;
+      }
+      IsTopNode = true;
+    } else if (RegionPolicy.OnlyBottomUp) {
+      SU = Bot.pickOnlyChoice();
+      if (!SU) {
+        CandPolicy NoPolicy;
+        BotCand.reset(NoPolicy);
+        pickNodeFromQueue(Bot, NoPolicy, DAG->getBotRPTracker(), BotCand);
+        assert(BotCand.Reason != NoCand && "failed to find a candidate");
+        SU = BotCand.SU;
+      }
+      IsTopNode = false;
+    } else {
+      SU = pickNodeBidirectional(IsTopNode);
+    }
+  } while (SU->isScheduled);
+
+  if (SU->isTopReady())
+    Top.removeReady(SU);
+  if (SU->isBottomReady())
+    Bot.removeReady(SU);
+
+  DEBUG(dbgs() << "Scheduling SU(" << SU->NodeNum << ") " << *SU->getInstr());
+  return SU;
+}
@@ -0,0 +1,74 @@
+//===-- GCNSchedStrategy.h - GCN Scheduler Strategy -*- C++ -*-------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// \brief A machine scheduler strategy that keeps the register pressure of a
+/// region within the limits of a target occupancy.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_AMDGPU_GCNSCHEDSTRATEGY_H
+#define LLVM_LIB_TARGET_AMDGPU_GCNSCHEDSTRATEGY_H
+
+#include "llvm/CodeGen/MachineScheduler.h"
+
+namespace llvm {
+
+class SIRegisterInfo;
+
+/// This is a minimal scheduler strategy. The main difference between this
+/// and the GenericScheduler is that GCNMaxOccupancySchedStrategy uses
+/// different heuristics to determine excess/critical pressure sets. A region
+/// is scheduled for the number of waves per SIMD its register pressure
+/// allows, or for the next tier up when it is only a few registers over, and
+/// pressure that would drop below that occupancy is treated as critical.
+class GCNMaxOccupancySchedStrategy : public GenericScheduler {
+
+  SUnit *pickNodeBidirectional(bool &IsTopNode);
+
+  void pickNodeFromQueue(SchedBoundary &Zone, const CandPolicy &ZonePolicy,
+                         const RegPressureTracker &RPTracker,
+                         SchedCandidate &Cand);
+
+  void initCandidate(SchedCandidate &Cand, SUnit *SU, bool AtTop,
+                     const RegPressureTracker &RPTracker);
+
+  const SIRegisterInfo *SRI;
+
+  // Scratch space for the pressure queries of initCandidate.
+  std::vector<unsigned> Pressure;
+  std::vector<unsigned> MaxPressure;
+
+  // Above these limits the region needs to spill.
+  unsigned SGPRExcessLimit;
+  unsigned VGPRExcessLimit;
+
+  // Above these limits the region loses its target occupancy.
+  unsigned SGPRCriticalLimit;
+  unsigned VGPRCriticalLimit;
+
+  unsigned TargetOccupancy;
+
+public:
+  GCNMaxOccupancySchedStrategy(const MachineSchedContext *C);
+
+  void initPolicy(MachineBasicBlock::iterator Begin,
+                  MachineBasicBlock::iterator End,
+                  unsigned NumRegionInstrs) override;
+
+  void initialize(ScheduleDAGMI *DAG) override;
+
+  SUnit *pickNode(bool &IsTopNode) override;
+
+  unsigned getTargetOccupancy() const { return TargetOccupancy; }
+};
+
+} // End namespace llvm
+
+#endif // LLVM_LIB_TARGET_AMDGPU_GCNSCHEDSTRATEGY_H
@@ -16,6 +16,7 @@
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/GlobalValue.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -56,8 +57,46 @@ NVPTXDAGToDAGISel::NVPTXDAGToDAGISel(NVPTXTargetMachine &tm,
   doMulWide = (OptLevel > 0);
 }
 
+// Returns true if F may write to global memory. Stores to shared and local
+// memory and barriers don't count.
+static bool mayWriteGlobalMemory(const Function &F) {
+  for (const BasicBlock &BB : F) {
+    for (const Instruction &I : BB) {
+      if (!I.mayWriteToMemory() || isa<FenceInst>(I))
+        continue;
+      unsigned AS;
+      if (auto *SI = dyn_cast<StoreInst>(&I))
+        AS = SI->getPointerAddressSpace();
+      else if (auto *RMW = dyn_cast<AtomicRMWInst>(&I))
+        AS = RMW->getPointerAddressSpace();
+      else if (auto *CX = dyn_cast<AtomicCmpXchgInst>(&I))
+        AS = CX->getPointerAddressSpace();
+      else if (auto *II = dyn_cast<IntrinsicInst>(&I)) {
+        switch (II->getIntrinsicID()) {
+        case Intrinsic::nvvm_barrier0:
+        case Intrinsic::nvvm_barrier0_popc:
+        case Intrinsic::nvvm_barrier0_and:
+        case Intrinsic::nvvm_barrier0_or:
+        case Intrinsic::nvvm_membar_cta:
+        case Intrinsic::nvvm_membar_gl:
+        case Intrinsic::nvvm_membar_sys:
+          continue;
+        default:
+          return true;
+        }
+      } else
+        return true;
+      if (AS != llvm::ADDRESS_SPACE_SHARED && AS != llvm::ADDRESS_SPACE_LOCAL)
+        return true;
+    }
+  }
+  return false;
+}
+
 bool NVPTXDAGToDAGISel::runOnMachineFunction(MachineFunction &MF) {
     Subtarget = &static_cast<const NVPTXSubtarget &>(MF.getSubtarget());
+    const Function &F = *MF.getFunction();
+    MayWriteGlobalMemory = !isKernelFunction(F) || mayWriteGlobalMemory(F);
     return SelectionDAGISel::runOnMachineFunction(MF);
 }
 
@@ -557,15 +596,17 @@ static unsigned int getCodeAddrSpace(MemSDNode *N) {
 }
 
 static bool canLowerToLDG(MemSDNode *N, const NVPTXSubtarget &Subtarget,
-                          unsigned CodeAddrSpace, MachineFunction *F) {
+                          unsigned CodeAddrSpace, MachineFunction *F,
+                          bool MayWriteGlobalMemory) {
   // To use non-coherent caching, the load has to be from global
   // memory and we have to prove that the memory area is not written
   // to anywhere for the duration of the kernel call, not even after
   // the load.
   //
   // To ensure that there are no writes to the memory, we require the
-  // underlying pointer to be a noalias (__restrict) kernel parameter
-  // that is never used for a write. We can only do this for kernel
+  // underlying pointer to be a kernel parameter that is never used for a
+  // write, and either noalias (__restrict) or of a kernel that doesn't
+  // write global memory at all. We can only do this for kernel
   // functions since from within a device function, we cannot know if
   // there were or will be writes to the memory from the caller - or we
   // could, but then we would have to do inter-procedural analysis.
@@ -583,7 +624,9 @@ static bool canLowerToLDG(MemSDNode *N, const NVPTXSubtarget &Subtarget,
                        Objs, F->getDataLayout());
   for (Value *Obj : Objs) {
     auto *A = dyn_cast<const Argument>(Obj);
-    if (!A || !A->onlyReadsMemory() || !A->hasNoAliasAttr()) return false;
+    if (!A || !A->onlyReadsMemory() ||
+        (!A->hasNoAliasAttr() && MayWriteGlobalMemory))
+      return false;
   }
 
   return true;
@@ -688,7 +731,8 @@ bool NVPTXDAGToDAGISel::tryLoad(SDNode *N) {
   // Address Space Setting
   unsigned int codeAddrSpace = getCodeAddrSpace(LD);
 
-  if (canLowerToLDG(LD, *Subtarget, codeAddrSpace, MF)) {
+  if (canLowerToLDG(LD, *Subtarget, codeAddrSpace, MF,
+                    MayWriteGlobalMemory)) {
     return tryLDGLDU(N);
   }
 
@@ -928,7 +972,8 @@ bool NVPTXDAGToDAGISel::tryLoadVector(SDNode *N) {
   // Address Space Setting
   unsigned int CodeAddrSpace = getCodeAddrSpace(MemSD);
 
-  if (canLowerToLDG(MemSD, *Subtarget, CodeAddrSpace, MF)) {
+  if (canLowerToLDG(MemSD, *Subtarget, CodeAddrSpace, MF,
+                    MayWriteGlobalMemory)) {
     return tryLDGLDU(N);
   }
 
@@ -45,6 +45,8 @@ public:
   }
   bool runOnMachineFunction(MachineFunction &MF) override;
   const NVPTXSubtarget *Subtarget;
+  // True unless the function is a kernel that never writes global memory.
+  bool MayWriteGlobalMemory;
 
   bool SelectInlineAsmMemoryOperand(const SDValue &Op,
                                     unsigned ConstraintID,
@@ -66,8 +66,9 @@
 // but proving %y2 specific circles back to %y. To address this complication,
 // the data flow analysis operates on a lattice:
 //   uninitialized > specific address spaces > generic.
-// All address expressions (our implementation only considers phi, bitcast,
-// addrspacecast, and getelementptr) start with the uninitialized address space.
+// All address expressions (our implementation only considers phi, select,
+// bitcast, addrspacecast, and getelementptr) start with the uninitialized
+// address space.
 // The monotone transfer function moves the address space of a pointer down a
 // lattice path from uninitialized to specific and then to generic. A join
 // operation of two different specific address spaces pushes the expression down
@@ -155,7 +156,7 @@ INITIALIZE_PASS(NVPTXInferAddressSpaces, "nvptx-infer-addrspace",
                 false, false)
 
 // Returns true if V is an address expression.
-// TODO: Currently, we consider only phi, bitcast, addrspacecast, and
+// TODO: Currently, we consider only phi, select, bitcast, addrspacecast, and
 // getelementptr operators.
 static bool isAddressExpression(const Value &V) {
   if (!isa<Operator>(V))
@@ -163,6 +164,7 @@ static bool isAddressExpression(const Value &V) {
 
   switch (cast<Operator>(V).getOpcode()) {
   case Instruction::PHI:
+  case Instruction::Select:
   case Instruction::BitCast:
   case Instruction::AddrSpaceCast:
   case Instruction::GetElementPtr:
@@ -184,6 +186,8 @@ static SmallVector<Value *, 2> getPointerOperands(const Value &V) {
     return SmallVector<Value *, 2>(IncomingValues.begin(),
                                    IncomingValues.end());
   }
+  case Instruction::Select:
+    return {Op.getOperand(1), Op.getOperand(2)};
   case Instruction::BitCast:
   case Instruction::AddrSpaceCast:
   case Instruction::GetElementPtr:
@@ -313,6 +317,9 @@ static Value *cloneInstructionWithNewAddressSpace(
     }
     return NewPHI;
   }
+  case Instruction::Select:
+    return SelectInst::Create(I->getOperand(0), NewPointerOperands[1],
+                              NewPointerOperands[2]);
   case Instruction::GetElementPtr: {
     GetElementPtrInst *GEP = cast<GetElementPtrInst>(I);
     GetElementPtrInst *NewGEP = GetElementPtrInst::Create(
@@ -351,8 +358,9 @@ static Value *cloneConstantExprWithNewAddressSpace(
     // If the address space of `Operand` needs to be modified, the new operand
     // with the new address space should already be in ValueWithNewAddrSpace
     // because (1) the constant expressions we consider (i.e. addrspacecast,
-    // bitcast, and getelementptr) do not incur cycles in the data flow graph
-    // and (2) this function is called on constant expressions in postorder.
+    // bitcast, select, and getelementptr) do not incur cycles in the data flow
+    // graph and (2) this function is called on constant expressions in
+    // postorder.
     if (Value *NewOperand = ValueWithNewAddrSpace.lookup(Operand)) {
       NewOperands.push_back(cast<Constant>(NewOperand));
     } else {
@@ -50,6 +50,7 @@ namespace llvm {
 
   void initializePPCVSXFMAMutatePass(PassRegistry&);
   void initializePPCBoolRetToIntPass(PassRegistry&);
+  void initializePPCVSXSwapRemovalPass(PassRegistry&);
   extern char &PPCVSXFMAMutateID;
 
   namespace PPCII {
@@ -80,6 +80,7 @@ extern "C" void LLVMInitializePowerPCTarget() {
 
   PassRegistry &PR = *PassRegistry::getPassRegistry();
   initializePPCBoolRetToIntPass(PR);
+  initializePPCVSXSwapRemovalPass(PR);
 }
 
 /// Return the datalayout string of a subtarget.
@@ -425,8 +425,13 @@ int PPCTTIImpl::getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
   // (at least in the sense that there need only be one non-loop-invariant
   // instruction). For each result vector, we need one shuffle per incoming
   // vector (except that the first shuffle can take two incoming vectors
-  // because it does not need to take itself).
-  Cost += Factor*(LT.first-1);
+  // because it does not need to take itself). Even when the whole group fits
+  // in one register, each member still needs its own shuffle. A load only
+  // needs to build the members that are used.
+  unsigned NumMembers = Factor;
+  if (Opcode == Instruction::Load && !Indices.empty())
+    NumMembers = Indices.size();
+  Cost += NumMembers * std::max(LT.first - 1, 1);
 
   return Cost;
 }
@@ -59,10 +59,6 @@ using namespace llvm;
 
 #define DEBUG_TYPE "ppc-vsx-swaps"
 
-namespace llvm {
-  void initializePPCVSXSwapRemovalPass(PassRegistry&);
-}
-
 namespace {
 
 // A PPCVSXSwapEntry is created for each machine instruction that
@@ -81,7 +77,7 @@ struct PPCVSXSwapEntry {
   unsigned int MentionsPhysVR : 1;
   unsigned int IsSwappable : 1;
   unsigned int MentionsPartialVR : 1;
-  unsigned int SpecialHandling : 3;
+  unsigned int SpecialHandling : 4;
   unsigned int WebRejected : 1;
   unsigned int WillRemove : 1;
 };
@@ -94,7 +90,8 @@ enum SHValues {
   SH_NOSWAP_ST,
   SH_SPLAT,
   SH_XXPERMDI,
-  SH_COPYWIDEN
+  SH_COPYWIDEN,
+  SH_XXSLDWI
 };
 
 struct PPCVSXSwapRemoval : public MachineFunctionPass {
@@ -335,6 +332,22 @@ bool PPCVSXSwapRemoval::gatherVectorInstructions() {
         }
         break;
       }
+      case PPC::XXSLDWI: {
+        // A shift by zero words just copies the first source, and a shift
+        // by two words selects one doubleword from each source; we can
+        // handle the latter by reversing the order of the sources.  Shift
+        // values 1 and 3 could be replaced by a general permute with a
+        // permute control vector.  However, VPERM has a more restrictive
+        // register class.
+        int immed = MI.getOperand(3).getImm();
+        if (immed == 0)
+          SwapVector[VecIdx].IsSwappable = 1;
+        else if (immed == 2) {
+          SwapVector[VecIdx].IsSwappable = 1;
+          SwapVector[VecIdx].SpecialHandling = SHValues::SH_XXSLDWI;
+        }
+        break;
+      }
       case PPC::LVX:
         // Non-permuting loads are currently unsafe.  We can use special
         // handling for this in the future.  By not marking these as
@@ -511,10 +524,6 @@ bool PPCVSXSwapRemoval::gatherVectorInstructions() {
       case PPC::VUPKLSW:
       case PPC::XXMRGHW:
       case PPC::XXMRGLW:
-      // XXSLDWI could be replaced by a general permute with one of three
-      // permute control vectors (for shift values 1, 2, 3).  However,
-      // VPERM has a more restrictive register class.
-      case PPC::XXSLDWI:
         break;
       }
     }
@@ -853,6 +862,25 @@ void PPCVSXSwapRemoval::handleSpecialSwappables(int EntryIdx) {
     break;
   }
 
+  // For an XXSLDWI that shifts by two words, each doubleword of the
+  // result comes from a different source, so reverse the order of the
+  // sources.
+  case SHValues::SH_XXSLDWI: {
+    MachineInstr *MI = SwapVector[EntryIdx].VSEMI;
+
+    DEBUG(dbgs() << "Changing XXSLDWI: ");
+    DEBUG(MI->dump());
+
+    unsigned Reg1 = MI->getOperand(1).getReg();
+    unsigned Reg2 = MI->getOperand(2).getReg();
+    MI->getOperand(1).setReg(Reg2);
+    MI->getOperand(2).setReg(Reg1);
+
+    DEBUG(dbgs() << "  Into: ");
+    DEBUG(MI->dump());
+    break;
+  }
+
   // For a copy from a scalar floating-point register to a vector
   // register, removing swaps will leave the copied value in the
   // wrong lane.  Insert a swap following the copy to fix this.
@@ -984,6 +1012,9 @@ void PPCVSXSwapRemoval::dumpSwapVector() {
       case SH_COPYWIDEN:
         DEBUG(dbgs() << "special:copywiden ");
         break;
+      case SH_XXSLDWI:
+        DEBUG(dbgs() << "special:xxsldwi ");
+        break;
       }
     }
 
@@ -1192,6 +1192,10 @@ bool SystemZDAGToDAGISel::canUseBlockOperation(StoreSDNode *Store,
   if (V1 == V2 && End1 == End2)
     return false;
 
+  // Without alias analysis (at -O0) assume the worst.
+  if (!AA)
+    return false;
+
   return !AA->alias(MemoryLocation(V1, End1, Load->getAAInfo()),
                     MemoryLocation(V2, End2, Store->getAAInfo()));
 }
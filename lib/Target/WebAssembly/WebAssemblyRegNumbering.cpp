@@ -18,6 +18,7 @@
 #include "WebAssemblyMachineFunctionInfo.h"
 #include "WebAssemblySubtarget.h"
 #include "llvm/ADT/SCCIterator.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
@@ -30,6 +31,10 @@ using namespace llvm;
 
 #define DEBUG_TYPE "wasm-reg-numbering"
 
+STATISTIC(NumLocals, "Number of locals allocated, excluding arguments");
+STATISTIC(NumLocalGets, "Number of register uses that read a local");
+STATISTIC(NumLocalSets, "Number of register defs that write a local");
+
 namespace {
 class WebAssemblyRegNumbering final : public MachineFunctionPass {
   const char *getPassName() const override {
@@ -106,8 +111,37 @@ bool WebAssemblyRegNumbering::runOnMachineFunction(MachineFunction &MF) {
     if (MFI.getWAReg(VReg) == WebAssemblyFunctionInfo::UnusedReg) {
       DEBUG(dbgs() << "VReg " << VReg << " -> WAReg " << CurReg << "\n");
       MFI.setWAReg(VReg, CurReg++);
+      ++NumLocals;
     }
   }
 
+  // Count the references to locals that are left after stackifying; each one
+  // is a get_local or set_local in the encoded function.
+  if (AreStatisticsEnabled())
+    for (const MachineBasicBlock &MBB : MF)
+      for (const MachineInstr &MI : MBB) {
+        if (MI.isDebugValue())
+          continue;
+        switch (MI.getOpcode()) {
+        case WebAssembly::ARGUMENT_I32:
+        case WebAssembly::ARGUMENT_I64:
+        case WebAssembly::ARGUMENT_F32:
+        case WebAssembly::ARGUMENT_F64:
+          continue;
+        default:
+          break;
+        }
+        for (const MachineOperand &MO : MI.explicit_operands()) {
+          if (!MO.isReg() ||
+              !TargetRegisterInfo::isVirtualRegister(MO.getReg()) ||
+              MFI.isVRegStackified(MO.getReg()))
+            continue;
+          if (MO.isDef())
+            ++NumLocalSets;
+          else
+            ++NumLocalGets;
+        }
+      }
+
   return true;
 }
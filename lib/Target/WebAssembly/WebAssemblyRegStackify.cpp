@@ -24,6 +24,7 @@
 #include "MCTargetDesc/WebAssemblyMCTargetDesc.h" // for WebAssembly::ARGUMENT_*
 #include "WebAssemblyMachineFunctionInfo.h"
 #include "WebAssemblySubtarget.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
 #include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
@@ -37,6 +38,10 @@ using namespace llvm;
 
 #define DEBUG_TYPE "wasm-reg-stackify"
 
+STATISTIC(NumMoved, "Number of single-use defs moved onto the stack");
+STATISTIC(NumRematerialized, "Number of cheap defs rematerialized");
+STATISTIC(NumTeed, "Number of multi-use defs stackified with a tee_local");
+
 namespace {
 class WebAssemblyRegStackify final : public MachineFunctionPass {
   const char *getPassName() const override {
@@ -439,6 +444,7 @@ static MachineInstr *MoveForSingleUse(unsigned Reg, MachineOperand& Op,
                                       WebAssemblyFunctionInfo &MFI,
                                       MachineRegisterInfo &MRI) {
   DEBUG(dbgs() << "Move for single use: "; Def->dump());
+  ++NumMoved;
 
   MBB.splice(Insert, &MBB, Def);
   LIS.handleMove(*Def);
@@ -481,6 +487,7 @@ static MachineInstr *RematerializeCheapDef(
     const WebAssemblyInstrInfo *TII, const WebAssemblyRegisterInfo *TRI) {
   DEBUG(dbgs() << "Rematerializing cheap def: "; Def.dump());
   DEBUG(dbgs() << " - for use in "; Op.getParent()->dump());
+  ++NumRematerialized;
 
   unsigned NewReg = MRI.createVirtualRegister(MRI.getRegClass(Reg));
   TII->reMaterialize(MBB, Insert, NewReg, 0, Def, *TRI);
@@ -539,6 +546,7 @@ static MachineInstr *MoveAndTeeForMultiUse(
     MachineInstr *Insert, LiveIntervals &LIS, WebAssemblyFunctionInfo &MFI,
     MachineRegisterInfo &MRI, const WebAssemblyInstrInfo *TII) {
   DEBUG(dbgs() << "Move and tee for multi-use:"; Def->dump());
+  ++NumTeed;
 
   // Move Def into place.
   MBB.splice(Insert, &MBB, Def);
@@ -10,6 +10,8 @@
 // This file defines the pass that finds instructions that can be
 // re-written as LEA instructions in order to reduce pipeline delays.
 // When optimizing for size it replaces suitable LEAs with INC or DEC.
+// On subtargets where 3-operand LEAs are slow it splits them into a 2-operand
+// LEA and an ADD.
 //
 //===----------------------------------------------------------------------===//
 
@@ -62,6 +64,12 @@ class FixupLEAPass : public MachineFunctionPass {
   void processInstructionForSLM(MachineBasicBlock::iterator &I,
                                 MachineFunction::iterator MFI);
 
+  /// \brief Given a 3-operand LEA (base, index and offset) which is slow on
+  /// the current subtarget, try to replace it with a 2-operand LEA or an ADD,
+  /// followed by an ADD of the offset.
+  void processInstrForSlow3OpLEA(MachineBasicBlock::iterator &I,
+                                 MachineFunction::iterator MFI);
+
   /// \brief Look for LEAs that add 1 to reg or subtract 1 from reg
   /// and convert them to INC or DEC respectively.
   bool fixupIncDec(MachineBasicBlock::iterator &I,
@@ -103,6 +111,7 @@ private:
   const X86InstrInfo *TII; // Machine instruction info.
   bool OptIncDec;
   bool OptLEA;
+  bool OptSlow3OpsLEA;
 };
 char FixupLEAPass::ID = 0;
 }
@@ -169,8 +178,9 @@ bool FixupLEAPass::runOnMachineFunction(MachineFunction &Func) {
   const X86Subtarget &ST = Func.getSubtarget<X86Subtarget>();
   OptIncDec = !ST.slowIncDec() || Func.getFunction()->optForMinSize();
   OptLEA = ST.LEAusesAG() || ST.slowLEA();
+  OptSlow3OpsLEA = ST.slow3OpsLEA() && !Func.getFunction()->optForSize();
 
-  if (!OptLEA && !OptIncDec)
+  if (!OptLEA && !OptIncDec && !OptSlow3OpsLEA)
     return false;
 
   TII = ST.getInstrInfo();
@@ -399,6 +409,97 @@ void FixupLEAPass::processInstructionForSLM(MachineBasicBlock::iterator &I,
   }
 }
 
+static inline int getADDrrFromLEA(int LEAOpcode) {
+  switch (LEAOpcode) {
+  default:
+    llvm_unreachable("Unexpected LEA instruction");
+  case X86::LEA16r:
+    return X86::ADD16rr;
+  case X86::LEA32r:
+  case X86::LEA64_32r:
+    return X86::ADD32rr;
+  case X86::LEA64r:
+    return X86::ADD64rr;
+  }
+}
+
+static inline int getADDriFromLEA(int LEAOpcode, int64_t Offset) {
+  bool IsInt8 = isInt<8>(Offset);
+  switch (LEAOpcode) {
+  default:
+    llvm_unreachable("Unexpected LEA instruction");
+  case X86::LEA16r:
+    return IsInt8 ? X86::ADD16ri8 : X86::ADD16ri;
+  case X86::LEA32r:
+  case X86::LEA64_32r:
+    return IsInt8 ? X86::ADD32ri8 : X86::ADD32ri;
+  case X86::LEA64r:
+    return IsInt8 ? X86::ADD64ri8 : X86::ADD64ri32;
+  }
+}
+
+void FixupLEAPass::processInstrForSlow3OpLEA(MachineBasicBlock::iterator &I,
+                                             MachineFunction::iterator MFI) {
+  MachineInstr *MI = I;
+  const int Opcode = MI->getOpcode();
+  if (!isLEA(Opcode))
+    return;
+
+  const MachineOperand &Dst = MI->getOperand(0);
+  const MachineOperand &Base = MI->getOperand(1 + X86::AddrBaseReg);
+  const MachineOperand &Scale = MI->getOperand(1 + X86::AddrScaleAmt);
+  const MachineOperand &Index = MI->getOperand(1 + X86::AddrIndexReg);
+  const MachineOperand &Offset = MI->getOperand(1 + X86::AddrDisp);
+  const MachineOperand &Segment = MI->getOperand(1 + X86::AddrSegmentReg);
+
+  // Only LEAs with a base, an index and an immediate offset are slow.
+  if (!Base.isReg() || Base.getReg() == 0 || !Index.isReg() ||
+      Index.getReg() == 0 || !Offset.isImm() || Offset.getImm() == 0 ||
+      Segment.getReg() != 0 || !TII->isSafeToClobberEFLAGS(*MFI, I))
+    return;
+
+  const unsigned DstR = Dst.getReg();
+  const unsigned BaseR = Base.getReg();
+  const unsigned IndexR = Index.getReg();
+  // The RBP and R13 bases can't be encoded without an offset, so the
+  // 2-operand LEA would be just as slow.
+  if (BaseR == X86::RBP || BaseR == X86::EBP || BaseR == X86::R13 ||
+      BaseR == X86::R13D)
+    return;
+  const int64_t Imm = Offset.getImm();
+  if (Opcode == X86::LEA64r && !isInt<32>(Imm))
+    return;
+
+  const DebugLoc &DL = MI->getDebugLoc();
+  DEBUG(dbgs() << "FixLEA: Candidate to replace:"; I->dump(););
+  DEBUG(dbgs() << "FixLEA: Replaced by: ";);
+  MachineInstr *NewMI;
+  if (Scale.getImm() == 1 && (DstR == BaseR || DstR == IndexR)) {
+    // lea off(%base,%index), %base => add %index, %base; add $off, %base
+    const MachineOperand &Src = DstR == BaseR ? Index : Base;
+    NewMI = BuildMI(*MFI, I, DL, TII->get(getADDrrFromLEA(Opcode)), DstR)
+                .addReg(DstR)
+                .addOperand(Src);
+  } else {
+    // lea off(%base,%index,s), %dst => lea (%base,%index,s), %dst;
+    //                                  add $off, %dst
+    NewMI = BuildMI(*MFI, I, DL, TII->get(Opcode))
+                .addOperand(Dst)
+                .addOperand(Base)
+                .addOperand(Scale)
+                .addOperand(Index)
+                .addImm(0)
+                .addOperand(Segment);
+  }
+  DEBUG(NewMI->dump(););
+  NewMI = BuildMI(*MFI, I, DL, TII->get(getADDriFromLEA(Opcode, Imm)), DstR)
+              .addReg(DstR)
+              .addImm(Imm);
+  DEBUG(NewMI->dump(););
+  MFI->erase(I);
+  I = static_cast<MachineBasicBlock::iterator>(NewMI);
+}
+
 bool FixupLEAPass::processBasicBlock(MachineFunction &MF,
                                      MachineFunction::iterator MFI) {
 
@@ -413,6 +514,9 @@ bool FixupLEAPass::processBasicBlock(MachineFunction &MF,
       else
         processInstruction(I, MFI);
     }
+
+    if (OptSlow3OpsLEA)
+      processInstrForSlow3OpLEA(I, MFI);
   }
   return false;
 }
@@ -22405,7 +22405,34 @@ X86TargetLowering::isShuffleMaskLegal(const SmallVectorImpl<int> &M,
 bool
 X86TargetLowering::isVectorClearMaskLegal(const SmallVectorImpl<int> &Mask,
                                           EVT VT) const {
-  // Just delegate to the generic legality, clear masks aren't special.
+  // A 512-bit shuffle with zero is cheap when it moves whole qwords and
+  // either takes each 256-bit half from one source (vshufi64x2), or has qword
+  // elements and does the same in every 128-bit lane (unpck). Anything else
+  // needs a vpermt2* and its index vector, or is split for bytes and words,
+  // while the AND is a single instruction with a constant of the same size.
+  if (VT.is512BitVector()) {
+    SmallVector<int, 64> QWordMask(Mask.begin(), Mask.end());
+    SmallVector<int, 32> WidenedMask;
+    while (QWordMask.size() > 8) {
+      if (!canWidenShuffleElements(QWordMask, WidenedMask))
+        return false;
+      QWordMask.swap(WidenedMask);
+    }
+
+    SmallVector<int, 4> LaneMask;
+    SmallVector<int, 2> RepeatedMask;
+    bool HalvesFromOneSource =
+        canWidenShuffleElements(QWordMask, LaneMask) &&
+        (LaneMask[0] < 4) == (LaneMask[1] < 4) &&
+        (LaneMask[2] < 4) == (LaneMask[3] < 4);
+    if (!HalvesFromOneSource &&
+        (VT.getScalarSizeInBits() != 64 ||
+         !is128BitLaneRepeatedShuffleMask(MVT::v8i64, QWordMask,
+                                          RepeatedMask)))
+      return false;
+  }
+
+  // Otherwise delegate to the generic legality, clear masks aren't special.
   return isShuffleMaskLegal(Mask, VT);
 }
 
@@ -26331,6 +26358,24 @@ static SDValue combineSelect(SDNode *N, SelectionDAG &DAG,
       DCI.AddToWorklist(Cond.getNode());
       return DAG.getNode(N->getOpcode(), DL, OpVT, Cond, LHS, RHS);
     }
+
+    // A k-mask predicates the operation that is the true value of the select,
+    // and keeps the false value where it is off. So with an operation on the
+    // false side, as in (vselect C, X, (op X, Y)) or (vselect C, 0, (op)),
+    // invert the compare and swap the sides so that the operation is masked
+    // rather than followed by a blend.
+    if (N->getOpcode() == ISD::VSELECT && DCI.isBeforeLegalizeOps() &&
+        Cond.getOpcode() == ISD::SETCC && Cond.hasOneUse() &&
+        RHS.hasOneUse() && RHS.getNumOperands() != 0 &&
+        (ISD::isBuildVectorAllZeros(LHS.getNode()) ||
+         std::find(RHS->op_begin(), RHS->op_end(), LHS) != RHS->op_end())) {
+      ISD::CondCode CC = cast<CondCodeSDNode>(Cond.getOperand(2))->get();
+      EVT CmpVT = Cond.getOperand(0).getValueType();
+      CC = ISD::getSetCCInverse(CC, CmpVT.isInteger());
+      Cond = DAG.getSetCC(SDLoc(Cond), CondVT, Cond.getOperand(0),
+                          Cond.getOperand(1), CC);
+      return DAG.getNode(ISD::VSELECT, DL, VT, Cond, RHS, LHS);
+    }
   }
   // If this is a select between two integer constants, try to do some
   // optimizations.
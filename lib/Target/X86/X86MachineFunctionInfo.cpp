@@ -15,6 +15,17 @@ using namespace llvm;
 
 void X86MachineFunctionInfo::anchor() { }
 
+bool X86MachineFunctionInfo::isInInitialState() const {
+  return !ForceFramePointer && !RestoreBasePointerOffset &&
+         !CalleeSavedFrameSize && !BytesToPopOnReturn && !ReturnAddrIndex &&
+         !FrameAddrIndex && !TailCallReturnAddrDelta && !SRetReturnReg &&
+         !GlobalBaseReg && !VarArgsFrameIndex && !RegSaveFrameIndex &&
+         !VarArgsGPOffset && !VarArgsFPOffset && !ArgumentStackSize &&
+         !NumLocalDynamics && !HasPushSequences && !HasSEHFramePtrSave &&
+         !SEHFramePtrSaveIndex && !IsSplitCSR && !UsesRedZone &&
+         !HasWinAlloca && ForwardedMustTailRegParms.empty();
+}
+
 void X86MachineFunctionInfo::setRestoreBasePointer(const MachineFunction *MF) {
   if (!RestoreBasePointerOffset) {
     const X86RegisterInfo *RegInfo = static_cast<const X86RegisterInfo *>(
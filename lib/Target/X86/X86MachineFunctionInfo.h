@@ -111,6 +111,8 @@ public:
 
   explicit X86MachineFunctionInfo(MachineFunction &MF) {}
 
+  bool isInInitialState() const override;
+
   bool getForceFramePointer() const { return ForceFramePointer;}
   void setForceFramePointer(bool forceFP) { ForceFramePointer = forceFP; }
 
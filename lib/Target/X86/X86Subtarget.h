@@ -222,9 +222,17 @@ protected:
   /// True if the LEA instruction with certain arguments is slow
   bool SlowLEA;
 
+  /// True if the LEA instruction with all three source operands (base, index
+  /// and offset) is slow
+  bool Slow3OpsLEA;
+
   /// True if INC and DEC instructions are slow when writing to flags
   bool SlowIncDec;
 
+  /// True if software prefetches should be inserted for loop accesses that
+  /// the hardware prefetchers don't cover.
+  bool UseLoopPrefetch;
+
   /// Processor has AVX-512 PreFetch Instructions
   bool HasPFI;
 
@@ -440,7 +448,9 @@ public:
   bool callRegIndirect() const { return CallRegIndirect; }
   bool LEAusesAG() const { return LEAUsesAG; }
   bool slowLEA() const { return SlowLEA; }
+  bool slow3OpsLEA() const { return Slow3OpsLEA; }
   bool slowIncDec() const { return SlowIncDec; }
+  bool useLoopPrefetch() const { return UseLoopPrefetch; }
   bool hasCDI() const { return HasCDI; }
   bool hasPFI() const { return HasPFI; }
   bool hasERI() const { return HasERI; }
@@ -85,6 +85,25 @@ unsigned X86TTIImpl::getMaxInterleaveFactor(unsigned VF) {
   return 2;
 }
 
+unsigned X86TTIImpl::getCacheLineSize() { return 64; }
+
+unsigned X86TTIImpl::getPrefetchDistance() {
+  if (!ST->useLoopPrefetch())
+    return 0;
+
+  // The distance is measured in instructions. A miss to memory takes about
+  // 200 cycles, during which the core can issue IssueWidth instructions per
+  // cycle, so a loop whose body takes N cycles should be prefetched about
+  // 200 / N iterations ahead.
+  return 200 * ST->getSchedModel().IssueWidth;
+}
+
+unsigned X86TTIImpl::getMinPrefetchStride() {
+  // The hardware prefetchers track strides within a 4K page, so only very
+  // strided (or irregular) accesses benefit from software prefetching.
+  return 2048;
+}
+
 int X86TTIImpl::getArithmeticInstrCost(
     unsigned Opcode, Type *Ty, TTI::OperandValueKind Op1Info,
     TTI::OperandValueKind Op2Info, TTI::OperandValueProperties Opd1PropInfo,
@@ -908,6 +927,15 @@ int X86TTIImpl::getCmpSelInstrCost(unsigned Opcode, Type *ValTy, Type *CondTy) {
     { ISD::SETCC,   MVT::v16f32,  1 },
   };
 
+  static const CostTblEntry AVX512BWCostTbl[] = {
+    { ISD::SETCC,   MVT::v32i16,  1 },
+    { ISD::SETCC,   MVT::v64i8,   1 },
+  };
+
+  if (ST->hasBWI())
+    if (const auto *Entry = CostTableLookup(AVX512BWCostTbl, ISD, MTy))
+      return LT.first * Entry->Cost;
+
   if (ST->hasAVX512())
     if (const auto *Entry = CostTableLookup(AVX512CostTbl, ISD, MTy))
       return LT.first * Entry->Cost;
@@ -1593,6 +1621,12 @@ bool X86TTIImpl::isLegalMaskedScatter(Type *DataType) {
   return isLegalMaskedGather(DataType);
 }
 
+bool X86TTIImpl::enableMaskedInterleavedAccessVectorization() {
+  // AVX-512 mask registers make the masked loads and stores that skip the
+  // gaps of an interleave group as cheap as plain ones.
+  return ST->hasAVX512();
+}
+
 bool X86TTIImpl::areInlineCompatible(const Function *Caller,
                                      const Function *Callee) const {
   const TargetMachine &TM = getTLI()->getTargetMachine();
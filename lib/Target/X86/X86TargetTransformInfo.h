@@ -62,6 +62,9 @@ public:
   unsigned getNumberOfRegisters(bool Vector);
   unsigned getRegisterBitWidth(bool Vector);
   unsigned getMaxInterleaveFactor(unsigned VF);
+  unsigned getCacheLineSize();
+  unsigned getPrefetchDistance();
+  unsigned getMinPrefetchStride();
   int getArithmeticInstrCost(
       unsigned Opcode, Type *Ty,
       TTI::OperandValueKind Opd1Info = TTI::OK_AnyValue,
@@ -98,6 +101,7 @@ public:
   bool isLegalMaskedStore(Type *DataType);
   bool isLegalMaskedGather(Type *DataType);
   bool isLegalMaskedScatter(Type *DataType);
+  bool enableMaskedInterleavedAccessVectorization();
   bool areInlineCompatible(const Function *Caller,
                            const Function *Callee) const;
 private:
@@ -13,6 +13,7 @@
 
 #include "llvm/Transforms/IPO/FunctionImport.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringSet.h"
@@ -28,6 +29,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 
@@ -36,6 +38,7 @@
 using namespace llvm;
 
 STATISTIC(NumImported, "Number of functions imported");
+STATISTIC(NumDeadSymbols, "Number of dead symbols found in the index");
 
 /// Limit on instruction count of imported functions.
 static cl::opt<unsigned> ImportInstrLimit(
@@ -49,6 +52,11 @@ static cl::opt<float>
                                "`import-instr-limit` threshold by this factor "
                                "before processing newly imported functions"));
 
+static cl::opt<unsigned> ImportThreads(
+    "import-threads", cl::init(0), cl::Hidden, cl::value_desc("N"),
+    cl::desc("Number of threads used to compute the cross-module imports "
+             "(0 = hardware concurrency)"));
+
 static cl::opt<bool> PrintImports("print-imports", cl::init(false), cl::Hidden,
                                   cl::desc("Print imported functions"));
 
@@ -326,7 +334,8 @@ static void computeImportForFunction(
 static void ComputeImportForModule(
     const GVSummaryMapTy &DefinedGVSummaries, const ModuleSummaryIndex &Index,
     FunctionImporter::ImportMapTy &ImportsForModule,
-    StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr) {
+    StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr,
+    const DenseSet<GlobalValue::GUID> *DeadSymbols = nullptr) {
   // Worklist contains the list of function imported in this module, for which
   // we will analyse the callees and may import further down the callgraph.
   SmallVector<EdgeInfo, 128> Worklist;
@@ -334,6 +343,10 @@ static void ComputeImportForModule(
   // Populate the worklist with the import for the functions in the current
   // module
   for (auto &GVSummary : DefinedGVSummaries) {
+    if (DeadSymbols && DeadSymbols->count(GVSummary.first)) {
+      DEBUG(dbgs() << "Ignores Dead GUID: " << GVSummary.first << "\n");
+      continue;
+    }
     auto *Summary = GVSummary.second;
     if (auto *AS = dyn_cast<AliasSummary>(Summary))
       Summary = &AS->getAliasee();
@@ -368,14 +381,82 @@ void llvm::ComputeCrossModuleImport(
     const ModuleSummaryIndex &Index,
     const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
-    StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
-  // For each module that has function defined, compute the import/export lists.
-  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
-    auto &ImportsForModule = ImportLists[DefinedGVSummaries.first()];
-    DEBUG(dbgs() << "Computing import for Module '"
-                 << DefinedGVSummaries.first() << "'\n");
-    ComputeImportForModule(DefinedGVSummaries.second, Index, ImportsForModule,
-                           &ExportLists);
+    StringMap<FunctionImporter::ExportSetTy> &ExportLists,
+    const DenseSet<GlobalValue::GUID> *DeadSymbols) {
+  // Make sure that every module has an entry in the ImportLists map so that
+  // the threads below only ever look up existing entries.
+  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries)
+    ImportLists[DefinedGVSummaries.first()];
+
+  // The import list of a module only depends on the (read-only) index, compute
+  // them in parallel. The exports are derived from the imports afterward.
+  unsigned NumThreads = ImportThreads;
+  if (!NumThreads)
+    NumThreads = std::max(1u, std::thread::hardware_concurrency());
+#ifndef NDEBUG
+  // Keep the debug output readable.
+  if (DebugFlag)
+    NumThreads = 1;
+#endif
+  NumThreads =
+      std::min<unsigned>(NumThreads, ModuleToDefinedGVSummaries.size());
+  if (NumThreads <= 1) {
+    for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
+      DEBUG(dbgs() << "Computing import for Module '"
+                   << DefinedGVSummaries.first() << "'\n");
+      ComputeImportForModule(DefinedGVSummaries.second, Index,
+                             ImportLists[DefinedGVSummaries.first()],
+                             /*ExportLists=*/nullptr, DeadSymbols);
+    }
+  } else {
+    ThreadPool Pool(NumThreads);
+    for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
+      auto &ImportsForModule = ImportLists[DefinedGVSummaries.first()];
+      const auto &Summaries = DefinedGVSummaries.second;
+      Pool.async([&Summaries, &Index, &ImportsForModule, DeadSymbols]() {
+        ComputeImportForModule(Summaries, Index, ImportsForModule,
+                               /*ExportLists=*/nullptr, DeadSymbols);
+      });
+    }
+    Pool.wait();
+  }
+
+  // Every global imported from a module is exported by this module, along with
+  // the globals defined in the same module that the imported function
+  // references.
+  for (auto &ModuleImports : ImportLists) {
+    for (auto &Src : ModuleImports.second) {
+      auto ExportModulePath = Src.first();
+      auto &ExportList = ExportLists[ExportModulePath];
+      for (auto &Import : Src.second) {
+        auto GUID = Import.first;
+        ExportList.insert(GUID);
+        auto SummaryList = Index.findGlobalValueSummaryList(GUID);
+        assert(SummaryList != Index.end() && "Imported global without summary");
+        auto SummaryIter = llvm::find_if(
+            SummaryList->second,
+            [&](const std::unique_ptr<GlobalValueSummary> &Summary) {
+              return Summary->modulePath() == ExportModulePath;
+            });
+        assert(SummaryIter != SummaryList->second.end() &&
+               "Imported global not defined in its source module");
+        const GlobalValueSummary *Summary = SummaryIter->get();
+        if (auto *AS = dyn_cast<AliasSummary>(Summary))
+          Summary = &AS->getAliasee();
+        auto *FuncSummary = cast<FunctionSummary>(Summary);
+        // Mark all functions and globals referenced by this function as
+        // exported to the outside if they are defined in the same source
+        // module.
+        for (auto &Edge : FuncSummary->calls()) {
+          auto CalleeGUID = Edge.first.getGUID();
+          exportGlobalInModule(Index, ExportModulePath, CalleeGUID, ExportList);
+        }
+        for (auto &Ref : FuncSummary->refs()) {
+          auto RefGUID = Ref.getGUID();
+          exportGlobalInModule(Index, ExportModulePath, RefGUID, ExportList);
+        }
+      }
+    }
   }
 
 #ifndef NDEBUG
@@ -396,6 +477,63 @@ void llvm::ComputeCrossModuleImport(
 #endif
 }
 
+/// Compute the set of symbols in the index that can't be reached from any of
+/// the \p GUIDPreservedSymbols.
+DenseSet<GlobalValue::GUID> llvm::computeDeadSymbols(
+    const ModuleSummaryIndex &Index,
+    const DenseSet<GlobalValue::GUID> &GUIDPreservedSymbols) {
+  // Without any root we can't tell what is live, be conservative.
+  if (GUIDPreservedSymbols.empty())
+    return DenseSet<GlobalValue::GUID>();
+
+  // Map each summary to its GUID, needed to follow the aliases.
+  DenseMap<const GlobalValueSummary *, GlobalValue::GUID> SummaryToGUID;
+  for (auto &Entry : Index)
+    for (auto &Summary : Entry.second)
+      SummaryToGUID[Summary.get()] = Entry.first;
+
+  DenseSet<GlobalValue::GUID> LiveSymbols;
+  SmallVector<GlobalValue::GUID, 128> Worklist;
+  auto MarkLive = [&](GlobalValue::GUID GUID) {
+    if (LiveSymbols.insert(GUID).second)
+      Worklist.push_back(GUID);
+  };
+
+  for (auto GUID : GUIDPreservedSymbols)
+    MarkLive(GUID);
+  // Globals with appending linkage (llvm.used, llvm.global_ctors, ...) are
+  // roots as well.
+  for (auto &Entry : Index)
+    for (auto &Summary : Entry.second)
+      if (Summary->linkage() == GlobalValue::AppendingLinkage)
+        MarkLive(Entry.first);
+
+  while (!Worklist.empty()) {
+    auto GUID = Worklist.pop_back_val();
+    auto SummaryList = Index.findGlobalValueSummaryList(GUID);
+    if (SummaryList == Index.end())
+      continue;
+    for (auto &Summary : SummaryList->second) {
+      for (auto &Ref : Summary->refs())
+        MarkLive(Ref.getGUID());
+      if (auto *FS = dyn_cast<FunctionSummary>(Summary.get()))
+        for (auto &Edge : FS->calls())
+          MarkLive(Edge.first.getGUID());
+      if (auto *AS = dyn_cast<AliasSummary>(Summary.get()))
+        MarkLive(SummaryToGUID.lookup(&AS->getAliasee()));
+    }
+  }
+
+  DenseSet<GlobalValue::GUID> DeadSymbols;
+  for (auto &Entry : Index)
+    if (!LiveSymbols.count(Entry.first))
+      DeadSymbols.insert(Entry.first);
+  NumDeadSymbols += DeadSymbols.size();
+  DEBUG(dbgs() << "Found " << DeadSymbols.size() << " dead symbols out of "
+               << SummaryToGUID.size() << " summaries\n");
+  return DeadSymbols;
+}
+
 /// Compute all the imports for the given module in the Index.
 void llvm::ComputeCrossModuleImportForModule(
     StringRef ModulePath, const ModuleSummaryIndex &Index,
@@ -490,6 +628,53 @@ void llvm::thinLTOResolveWeakForLinkerModule(
     updateLinkage(GV);
 }
 
+bool llvm::thinLTOApplyFunctionAttrsModule(Module &TheModule,
+                                           const ModuleSummaryIndex &Index) {
+  bool Changed = false;
+  for (auto &F : TheModule) {
+    if (!F.hasName() || F.isIntrinsic())
+      continue;
+    // The copy in this module may not be the one that prevails.
+    if (F.isInterposable())
+      continue;
+    auto GUID = F.getGUID();
+    if (Index.findGlobalValueSummaryList(GUID) == Index.end()) {
+      // It may be a local function of this module that was promoted: look it
+      // up under its original name.
+      StringRef OrigName =
+          ModuleSummaryIndex::getOriginalNameBeforePromote(F.getName());
+      GUID = GlobalValue::getGUID(GlobalValue::getGlobalIdentifier(
+          OrigName, GlobalValue::InternalLinkage,
+          TheModule.getSourceFileName()));
+    }
+    unsigned Attrs = Index.getFunctionAttrs(GUID);
+    if (!Attrs)
+      continue;
+    DEBUG(dbgs() << "Summary-based function attributes for `" << F.getName()
+                 << "`: " << Attrs << "\n");
+    if ((Attrs & FunctionSummary::ReadNone) && !F.doesNotAccessMemory()) {
+      F.removeFnAttr(Attribute::ReadOnly);
+      F.removeFnAttr(Attribute::ArgMemOnly);
+      F.removeFnAttr(Attribute::InaccessibleMemOnly);
+      F.removeFnAttr(Attribute::InaccessibleMemOrArgMemOnly);
+      F.setDoesNotAccessMemory();
+      Changed = true;
+    } else if ((Attrs & FunctionSummary::ReadOnly) && !F.onlyReadsMemory()) {
+      F.setOnlyReadsMemory();
+      Changed = true;
+    }
+    if ((Attrs & FunctionSummary::NoUnwind) && !F.doesNotThrow()) {
+      F.setDoesNotThrow();
+      Changed = true;
+    }
+    if ((Attrs & FunctionSummary::NoRecurse) && !F.doesNotRecurse()) {
+      F.setDoesNotRecurse();
+      Changed = true;
+    }
+  }
+  return Changed;
+}
+
 /// Run internalization on \p TheModule based on symmary analysis.
 void llvm::thinLTOInternalizeModule(Module &TheModule,
                                     const GVSummaryMapTy &DefinedGlobals) {
@@ -756,8 +941,13 @@ public:
       return loadFile(Identifier, M.getContext());
     };
     FunctionImporter Importer(*Index, ModuleLoader);
-    return Importer.importFunctions(
+    bool Changed = Importer.importFunctions(
         M, ImportList, !DontForceImportReferencedDiscardableSymbols);
+
+    // Apply the function attributes computed during the thin link, to the
+    // imported functions as well.
+    Changed |= thinLTOApplyFunctionAttrsModule(M, *Index);
+    return Changed;
   }
 };
 } // anonymous namespace
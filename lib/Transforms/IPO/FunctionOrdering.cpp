@@ -0,0 +1,244 @@
+//===- FunctionOrdering.cpp - Order functions by call affinity ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass reorders the functions of a module with the call-chain clustering
+// heuristic (C3) of Ottoni and Chen, "Optimizing Function Placement for
+// Large-Scale Data-Center Applications", CGO 2017. The weight of a call edge
+// is the profile count of the block of the call. Visiting the functions from
+// the hottest down, each one is placed right after its most frequent caller,
+// unless that would make the caller's cluster too big. The clusters are then
+// laid out by decreasing density (profile count per instruction), followed by
+// the functions without a profile in their original order.
+//
+// The code generator emits the functions in the order of the module. With
+// -function-order-file, the pass also writes the ELF text section names of
+// the functions in the new order, one per line, in the format taken by gold's
+// --section-ordering-file. That's useful for functions compiled in
+// different modules and with -ffunction-sections.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/FunctionOrdering.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO.h"
+#include <algorithm>
+using namespace llvm;
+
+#define DEBUG_TYPE "function-order"
+
+STATISTIC(NumFunctionsOrdered, "Number of profiled functions ordered");
+STATISTIC(NumClusterMerges, "Number of functions placed after their caller");
+
+static cl::opt<unsigned> MaxClusterSize(
+    "function-order-max-cluster-size", cl::init(1024), cl::Hidden,
+    cl::desc("The maximum number of instructions in a cluster of functions "
+             "placed next to each other (roughly a page of code)"));
+
+static cl::opt<std::string> OrderFile(
+    "function-order-file", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Write the text sections of the ordered functions to this file"));
+
+namespace {
+struct Cluster {
+  std::vector<Function *> Functions;
+  uint64_t Size = 0;
+  uint64_t Count = 0;
+
+  /// Return true if this cluster should be placed before \p RHS.
+  bool isDenserThan(const Cluster &RHS) const {
+    return double(Count) * RHS.Size > double(RHS.Count) * Size;
+  }
+};
+
+bool orderFunctions(Module &M,
+                    function_ref<BlockFrequencyInfo *(Function &)> LookupBFI) {
+  // Measure the profiled functions and the weights of the calls between them.
+  std::vector<Function *> Profiled;
+  std::vector<Function *> Unprofiled;
+  DenseMap<Function *, uint64_t> Counts;
+  DenseMap<Function *, uint64_t> Sizes;
+  // A MapVector, so that ties between callers are broken deterministically.
+  MapVector<std::pair<Function *, Function *>, uint64_t> CallWeights;
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+    Optional<uint64_t> EntryCount = F.getEntryCount();
+    if (!EntryCount) {
+      Unprofiled.push_back(&F);
+      continue;
+    }
+    Profiled.push_back(&F);
+    Counts[&F] = *EntryCount;
+
+    BlockFrequencyInfo *BFI = LookupBFI(F);
+    uint64_t Size = 0;
+    for (Instruction &I : instructions(F)) {
+      if (isa<DbgInfoIntrinsic>(I))
+        continue;
+      ++Size;
+      CallSite CS(&I);
+      if (!CS)
+        continue;
+      Function *Callee = CS.getCalledFunction();
+      if (!Callee || Callee == &F || Callee->isDeclaration())
+        continue;
+      if (Optional<uint64_t> Count = BFI->getBlockProfileCount(I.getParent()))
+        CallWeights[{&F, Callee}] += *Count;
+    }
+    Sizes[&F] = std::max<uint64_t>(Size, 1);
+  }
+  if (Profiled.empty())
+    return false;
+
+  // The hottest caller of each function.
+  DenseMap<Function *, std::pair<Function *, uint64_t>> HottestCaller;
+  for (auto &CW : CallWeights) {
+    Function *Caller = CW.first.first, *Callee = CW.first.second;
+    if (!Counts.count(Callee))
+      continue;
+    auto &Hottest = HottestCaller[Callee];
+    if (CW.second > Hottest.second)
+      Hottest = {Caller, CW.second};
+  }
+
+  // Start with a cluster per function.
+  std::vector<Cluster> Clusters(Profiled.size());
+  DenseMap<Function *, unsigned> ClusterOf;
+  for (unsigned I = 0, E = Profiled.size(); I != E; ++I) {
+    Function *F = Profiled[I];
+    Clusters[I].Functions.push_back(F);
+    Clusters[I].Size = Sizes[F];
+    Clusters[I].Count = Counts[F];
+    ClusterOf[F] = I;
+  }
+
+  // Visit the functions from the hottest one down, and append the cluster of
+  // each to the cluster of its hottest caller.
+  std::vector<Function *> ByCount(Profiled);
+  std::stable_sort(ByCount.begin(), ByCount.end(),
+                   [&](Function *A, Function *B) {
+                     return Counts[A] > Counts[B];
+                   });
+  for (Function *F : ByCount) {
+    auto It = HottestCaller.find(F);
+    if (It == HottestCaller.end() || !It->second.second)
+      continue;
+    unsigned To = ClusterOf[It->second.first];
+    unsigned From = ClusterOf[F];
+    if (To == From ||
+        Clusters[To].Size + Clusters[From].Size > MaxClusterSize)
+      continue;
+
+    Cluster &Dst = Clusters[To], &Src = Clusters[From];
+    for (Function *Moved : Src.Functions)
+      ClusterOf[Moved] = To;
+    Dst.Functions.insert(Dst.Functions.end(), Src.Functions.begin(),
+                         Src.Functions.end());
+    Dst.Size += Src.Size;
+    Dst.Count += Src.Count;
+    Src.Functions.clear();
+    ++NumClusterMerges;
+  }
+
+  Clusters.erase(std::remove_if(Clusters.begin(), Clusters.end(),
+                                [](const Cluster &C) {
+                                  return C.Functions.empty();
+                                }),
+                 Clusters.end());
+  std::stable_sort(Clusters.begin(), Clusters.end(),
+                   [](const Cluster &A, const Cluster &B) {
+                     return A.isDenserThan(B);
+                   });
+
+  // Move the functions to the end of the module in their new order.
+  std::vector<Function *> Order;
+  for (Cluster &C : Clusters)
+    Order.insert(Order.end(), C.Functions.begin(), C.Functions.end());
+  Order.insert(Order.end(), Unprofiled.begin(), Unprofiled.end());
+  for (Function *F : Order) {
+    M.getFunctionList().remove(F);
+    M.getFunctionList().push_back(F);
+  }
+  NumFunctionsOrdered += Profiled.size();
+
+  if (!OrderFile.empty()) {
+    std::error_code EC;
+    raw_fd_ostream OS(OrderFile, EC, sys::fs::F_Text);
+    if (EC) {
+      M.getContext().emitError("could not open function order file '" +
+                               OrderFile + "': " + EC.message());
+      return true;
+    }
+    for (Function *F : Order)
+      OS << (F->hasFnAttribute(Attribute::Cold) ? ".text.unlikely."
+                                                 : ".text.")
+         << F->getName() << "\n";
+  }
+  return true;
+}
+
+class FunctionOrderingLegacyPass : public ModulePass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  FunctionOrderingLegacyPass() : ModulePass(ID) {
+    initializeFunctionOrderingLegacyPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<BlockFrequencyInfoWrapperPass>();
+    AU.setPreservesCFG();
+  }
+
+  bool runOnModule(Module &M) override {
+    if (skipModule(M))
+      return false;
+
+    auto LookupBFI = [this](Function &F) {
+      return &this->getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+    };
+    return orderFunctions(M, LookupBFI);
+  }
+};
+} // end anonymous namespace
+
+PreservedAnalyses FunctionOrderingPass::run(Module &M,
+                                            ModuleAnalysisManager &AM) {
+  auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  auto LookupBFI = [&FAM](Function &F) {
+    return &FAM.getResult<BlockFrequencyAnalysis>(F);
+  };
+
+  if (!orderFunctions(M, LookupBFI))
+    return PreservedAnalyses::all();
+  // Only the order of the functions changed.
+  PreservedAnalyses PA;
+  PA.preserve<FunctionAnalysisManagerModuleProxy>();
+  return PA;
+}
+
+char FunctionOrderingLegacyPass::ID = 0;
+INITIALIZE_PASS_BEGIN(FunctionOrderingLegacyPass, "function-order",
+                      "Order functions by call affinity", false, false)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_END(FunctionOrderingLegacyPass, "function-order",
+                    "Order functions by call affinity", false, false)
+
+ModulePass *llvm::createFunctionOrderingPass() {
+  return new FunctionOrderingLegacyPass();
+}
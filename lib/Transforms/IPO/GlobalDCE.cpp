@@ -25,7 +25,6 @@
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/Utils/CtorUtils.h"
 #include "llvm/Transforms/Utils/GlobalStatus.h"
-#include <unordered_map>
 using namespace llvm;
 
 #define DEBUG_TYPE "globaldce"
@@ -87,13 +86,13 @@ PreservedAnalyses GlobalDCEPass::run(Module &M, ModuleAnalysisManager &) {
   // Collect the set of members for each comdat.
   for (Function &F : M)
     if (Comdat *C = F.getComdat())
-      ComdatMembers.insert(std::make_pair(C, &F));
+      ComdatMembers[C].push_back(&F);
   for (GlobalVariable &GV : M.globals())
     if (Comdat *C = GV.getComdat())
-      ComdatMembers.insert(std::make_pair(C, &GV));
+      ComdatMembers[C].push_back(&GV);
   for (GlobalAlias &GA : M.aliases())
     if (Comdat *C = GA.getComdat())
-      ComdatMembers.insert(std::make_pair(C, &GA));
+      ComdatMembers[C].push_back(&GA);
 
   // Loop over the module, adding globals which are obviously necessary.
   for (GlobalObject &GO : M.global_objects()) {
@@ -120,6 +119,10 @@ PreservedAnalyses GlobalDCEPass::run(Module &M, ModuleAnalysisManager &) {
       GlobalIsNeeded(&GIF);
   }
 
+  // Mark everything the needed globals refer to as needed.
+  while (!Worklist.empty())
+    MarkReferencesAsNeeded(Worklist.pop_back_val());
+
   // Now that all globals which are needed are in the AliveGlobals set, we loop
   // through the program, deleting those which are not alive.
   //
@@ -206,23 +209,32 @@ PreservedAnalyses GlobalDCEPass::run(Module &M, ModuleAnalysisManager &) {
   AliveGlobals.clear();
   SeenConstants.clear();
   ComdatMembers.clear();
+  AliveComdats.clear();
 
   if (Changed)
     return PreservedAnalyses::none();
   return PreservedAnalyses::all();
 }
 
-/// GlobalIsNeeded - the specific global value as needed, and
-/// recursively mark anything that it uses as also needed.
+/// GlobalIsNeeded - the specific global value as needed, and queue it so that
+/// anything it uses is marked as needed too.
 void GlobalDCEPass::GlobalIsNeeded(GlobalValue *G) {
   // If the global is already in the set, no need to reprocess it.
   if (!AliveGlobals.insert(G).second)
     return;
 
-  if (Comdat *C = G->getComdat()) {
-    for (auto &&CM : make_range(ComdatMembers.equal_range(C)))
-      GlobalIsNeeded(CM.second);
-  }
+  // Its references are scanned from the worklist rather than recursively, so
+  // that long chains of references don't exhaust the stack.
+  Worklist.push_back(G);
+}
+
+void GlobalDCEPass::MarkReferencesAsNeeded(GlobalValue *G) {
+  // A comdat is kept or dropped as a whole, so its members are marked once,
+  // by the first of them that is needed.
+  if (Comdat *C = G->getComdat())
+    if (AliveComdats.insert(C).second)
+      for (GlobalValue *CM : ComdatMembers[C])
+        GlobalIsNeeded(CM);
 
   if (GlobalVariable *GV = dyn_cast<GlobalVariable>(G)) {
     // If this is a global variable, we must make sure to add any global values
@@ -17,7 +17,6 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
-#include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/ConstantFolding.h"
@@ -1647,8 +1646,102 @@ static bool TryToShrinkGlobalToBoolean(GlobalVariable *GV, Constant *OtherVal) {
   return true;
 }
 
+namespace {
+/// The globals that a round of optimizeGlobalsInModule looks at.
+///
+/// The first round looks at every global. Each later round only looks at the
+/// globals that a change in the previous round may have affected: those
+/// referenced by a global that was deleted, by a function that used a global
+/// that was rewritten, or by the initializer of a global that used one.
+/// Changes that are harder to follow, such as evaluating static constructors,
+/// make the next round look at everything again.
+///
+/// This only decides which globals are examined; each transformation still
+/// checks that it is safe, so missing a global here can only miss an
+/// optimization.
+class GlobalWorklist {
+  bool VisitAll = false;
+  SmallPtrSet<const GlobalValue *, 16> Visit;
+  bool NextAll = true;
+  SmallPtrSet<const GlobalValue *, 16> Next;
+  SmallPtrSet<const Constant *, 16> SeenConstants;
+
+public:
+  /// Start the next round. Return false if there is nothing to look at.
+  bool startRound() {
+    VisitAll = NextAll;
+    Visit.clear();
+    Visit.swap(Next);
+    NextAll = false;
+    SeenConstants.clear();
+    return VisitAll || !Visit.empty();
+  }
+
+  bool shouldVisit(const GlobalValue &GV) const {
+    return VisitAll || Visit.count(&GV);
+  }
+
+  void revisitAll() {
+    NextAll = true;
+    Next.clear();
+  }
+
+  /// Look at \p GV in the next round. It may be deleted by then; it is only
+  /// used as a key.
+  void revisit(const GlobalValue *GV) {
+    if (!NextAll)
+      Next.insert(GV);
+  }
+
+  /// Look at the globals that \p C refers to in the next round.
+  void revisitReferencedBy(const Constant *C) {
+    if (NextAll)
+      return;
+    if (auto *GV = dyn_cast<GlobalValue>(C)) {
+      Next.insert(GV);
+      return;
+    }
+    if (!SeenConstants.insert(C).second)
+      return;
+    for (const Use &U : C->operands())
+      revisitReferencedBy(cast<Constant>(U.get()));
+  }
+
+  /// Look at the globals that the body of \p F refers to in the next round.
+  void revisitReferencedBy(const Function &F) {
+    if (NextAll)
+      return;
+    for (const Use &U : F.operands())
+      revisitReferencedBy(cast<Constant>(U.get()));
+    for (const BasicBlock &BB : F)
+      for (const Instruction &I : BB)
+        for (const Use &U : I.operands())
+          if (auto *C = dyn_cast<Constant>(U.get()))
+            revisitReferencedBy(C);
+  }
+};
+} // end anonymous namespace
+
+/// Collect the functions that use \p V and the globals whose initializer uses
+/// it, looking through constants.
+static void collectUsers(const Value *V,
+                         SmallPtrSetImpl<const Function *> &Functions,
+                         SmallPtrSetImpl<const GlobalValue *> &Globals,
+                         SmallPtrSetImpl<const Constant *> &Seen) {
+  for (const User *U : V->users()) {
+    if (auto *I = dyn_cast<Instruction>(U))
+      Functions.insert(I->getFunction());
+    else if (auto *GV = dyn_cast<GlobalValue>(U))
+      Globals.insert(GV);
+    else if (auto *C = dyn_cast<Constant>(U))
+      if (Seen.insert(C).second)
+        collectUsers(C, Functions, Globals, Seen);
+  }
+}
+
 static bool deleteIfDead(GlobalValue &GV,
-                         SmallSet<const Comdat *, 8> &NotDiscardableComdats) {
+                         SmallPtrSetImpl<const Comdat *> &NotDiscardableComdats,
+                         GlobalWorklist &Worklist) {
   GV.removeDeadConstantUsers();
 
   if (!GV.isDiscardableIfUnused())
@@ -1667,6 +1760,14 @@ static bool deleteIfDead(GlobalValue &GV,
     return false;
 
   DEBUG(dbgs() << "GLOBAL DEAD: " << GV << "\n");
+  // The globals this one refers to lose a use.
+  if (auto *F = dyn_cast<Function>(&GV))
+    Worklist.revisitReferencedBy(*F);
+  else if (auto *GVar = dyn_cast<GlobalVariable>(&GV)) {
+    if (GVar->hasInitializer())
+      Worklist.revisitReferencedBy(GVar->getInitializer());
+  } else if (auto *GIS = dyn_cast<GlobalIndirectSymbol>(&GV))
+    Worklist.revisitReferencedBy(GIS->getIndirectSymbol());
   GV.eraseFromParent();
   ++NumDeleted;
   return true;
@@ -1941,10 +2042,17 @@ static bool processInternalGlobal(
 /// make a change, return true.
 static bool
 processGlobal(GlobalValue &GV, TargetLibraryInfo *TLI,
-              function_ref<DominatorTree &(Function &)> LookupDomTree) {
+              function_ref<DominatorTree &(Function &)> LookupDomTree,
+              GlobalWorklist &Worklist) {
   if (GV.getName().startswith("llvm."))
     return false;
 
+  // All that can be done to a global that isn't internal is to make its
+  // address unnamed, so don't walk the uses of one that already is.
+  if (!GV.hasLocalLinkage() &&
+      GV.getUnnamedAddr() != GlobalValue::UnnamedAddr::None)
+    return false;
+
   GlobalStatus GS;
 
   if (GlobalStatus::analyzeGlobal(&GV, GS))
@@ -1972,7 +2080,29 @@ processGlobal(GlobalValue &GV, TargetLibraryInfo *TLI,
   if (GVar->isConstant() || !GVar->hasInitializer())
     return Changed;
 
-  return processInternalGlobal(GVar, GS, TLI, LookupDomTree) || Changed;
+  // Rewriting the global changes its users, and deleting it removes a use of
+  // whatever its initializer refers to, so remember what to look at again.
+  SmallPtrSet<const Function *, 4> UserFunctions;
+  SmallPtrSet<const GlobalValue *, 4> UserGlobals;
+  SmallPtrSet<const Constant *, 8> SeenConstants;
+  collectUsers(GVar, UserFunctions, UserGlobals, SeenConstants);
+  Constant *Init = GVar->getInitializer();
+
+  if (!processInternalGlobal(GVar, GS, TLI, LookupDomTree))
+    return Changed;
+
+  Worklist.revisit(GVar);
+  if (!isa<ConstantData>(Init))
+    Worklist.revisitReferencedBy(Init);
+  for (const Function *F : UserFunctions)
+    Worklist.revisitReferencedBy(*F);
+  for (const GlobalValue *G : UserGlobals) {
+    Worklist.revisit(G);
+    if (auto *UserVar = dyn_cast<GlobalVariable>(G))
+      if (UserVar->hasInitializer())
+        Worklist.revisitReferencedBy(UserVar->getInitializer());
+  }
+  return true;
 }
 
 /// Walk all of the direct calls of the specified function, changing them to
@@ -2022,21 +2152,25 @@ static bool isProfitableToMakeFastCC(Function *F) {
 static bool
 OptimizeFunctions(Module &M, TargetLibraryInfo *TLI,
                   function_ref<DominatorTree &(Function &)> LookupDomTree,
-                  SmallSet<const Comdat *, 8> &NotDiscardableComdats) {
+                  SmallPtrSetImpl<const Comdat *> &NotDiscardableComdats,
+                  GlobalWorklist &Worklist) {
   bool Changed = false;
   // Optimize functions.
   for (Module::iterator FI = M.begin(), E = M.end(); FI != E; ) {
     Function *F = &*FI++;
+    if (!Worklist.shouldVisit(*F))
+      continue;
+
     // Functions without names cannot be referenced outside this module.
     if (!F->hasName() && !F->isDeclaration() && !F->hasLocalLinkage())
       F->setLinkage(GlobalValue::InternalLinkage);
 
-    if (deleteIfDead(*F, NotDiscardableComdats)) {
+    if (deleteIfDead(*F, NotDiscardableComdats, Worklist)) {
       Changed = true;
       continue;
     }
 
-    Changed |= processGlobal(*F, TLI, LookupDomTree);
+    Changed |= processGlobal(*F, TLI, LookupDomTree, Worklist);
 
     if (!F->hasLocalLinkage())
       continue;
@@ -2066,12 +2200,16 @@ OptimizeFunctions(Module &M, TargetLibraryInfo *TLI,
 static bool
 OptimizeGlobalVars(Module &M, TargetLibraryInfo *TLI,
                    function_ref<DominatorTree &(Function &)> LookupDomTree,
-                   SmallSet<const Comdat *, 8> &NotDiscardableComdats) {
+                   SmallPtrSetImpl<const Comdat *> &NotDiscardableComdats,
+                   GlobalWorklist &Worklist) {
   bool Changed = false;
 
   for (Module::global_iterator GVI = M.global_begin(), E = M.global_end();
        GVI != E; ) {
     GlobalVariable *GV = &*GVI++;
+    if (!Worklist.shouldVisit(*GV))
+      continue;
+
     // Global variables without names cannot be referenced outside this module.
     if (!GV->hasName() && !GV->isDeclaration() && !GV->hasLocalLinkage())
       GV->setLinkage(GlobalValue::InternalLinkage);
@@ -2080,16 +2218,18 @@ OptimizeGlobalVars(Module &M, TargetLibraryInfo *TLI,
       if (ConstantExpr *CE = dyn_cast<ConstantExpr>(GV->getInitializer())) {
         auto &DL = M.getDataLayout();
         Constant *New = ConstantFoldConstantExpression(CE, DL, TLI);
-        if (New && New != CE)
+        if (New && New != CE) {
+          Worklist.revisitReferencedBy(CE);
           GV->setInitializer(New);
+        }
       }
 
-    if (deleteIfDead(*GV, NotDiscardableComdats)) {
+    if (deleteIfDead(*GV, NotDiscardableComdats, Worklist)) {
       Changed = true;
       continue;
     }
 
-    Changed |= processGlobal(*GV, TLI, LookupDomTree);
+    Changed |= processGlobal(*GV, TLI, LookupDomTree, Worklist);
   }
   return Changed;
 }
@@ -2332,7 +2472,8 @@ static bool hasUsesToReplace(GlobalAlias &GA, const LLVMUsed &U,
 
 static bool
 OptimizeGlobalAliases(Module &M,
-                      SmallSet<const Comdat *, 8> &NotDiscardableComdats) {
+                      SmallPtrSetImpl<const Comdat *> &NotDiscardableComdats,
+                      GlobalWorklist &Worklist) {
   bool Changed = false;
   LLVMUsed Used(M);
 
@@ -2347,7 +2488,7 @@ OptimizeGlobalAliases(Module &M,
     if (!J->hasName() && !J->isDeclaration() && !J->hasLocalLinkage())
       J->setLinkage(GlobalValue::InternalLinkage);
 
-    if (deleteIfDead(*J, NotDiscardableComdats)) {
+    if (deleteIfDead(*J, NotDiscardableComdats, Worklist)) {
       Changed = true;
       continue;
     }
@@ -2373,6 +2514,7 @@ OptimizeGlobalAliases(Module &M,
     J->replaceAllUsesWith(ConstantExpr::getBitCast(Aliasee, J->getType()));
     ++NumAliasesResolved;
     Changed = true;
+    Worklist.revisitAll();
 
     if (RenameTarget) {
       // Give the aliasee the name, linkage and other attributes of the alias.
@@ -2512,13 +2654,15 @@ static bool OptimizeEmptyGlobalCXXDtors(Function *CXAAtExitFn) {
 static bool optimizeGlobalsInModule(
     Module &M, const DataLayout &DL, TargetLibraryInfo *TLI,
     function_ref<DominatorTree &(Function &)> LookupDomTree) {
-  SmallSet<const Comdat *, 8> NotDiscardableComdats;
+  SmallPtrSet<const Comdat *, 8> NotDiscardableComdats;
+  GlobalWorklist Worklist;
   bool Changed = false;
   bool LocalChange = true;
   while (LocalChange) {
     LocalChange = false;
 
-    NotDiscardableComdats.clear();
+    SmallPtrSet<const Comdat *, 8> PrevNotDiscardableComdats;
+    PrevNotDiscardableComdats.swap(NotDiscardableComdats);
     for (const GlobalVariable &GV : M.globals())
       if (const Comdat *C = GV.getComdat())
         if (!GV.isDiscardableIfUnused() || !GV.use_empty())
@@ -2532,27 +2676,52 @@ static bool optimizeGlobalsInModule(
         if (!GA.isDiscardableIfUnused() || !GA.use_empty())
           NotDiscardableComdats.insert(C);
 
+    // The members of a comdat that became discardable may now be deleted.
+    SmallPtrSet<const Comdat *, 8> DiscardableComdats;
+    for (const Comdat *C : PrevNotDiscardableComdats)
+      if (!NotDiscardableComdats.count(C))
+        DiscardableComdats.insert(C);
+    if (!DiscardableComdats.empty()) {
+      for (const GlobalObject &GO : M.global_objects())
+        if (const Comdat *C = GO.getComdat())
+          if (DiscardableComdats.count(C))
+            Worklist.revisit(&GO);
+      for (const GlobalAlias &GA : M.aliases())
+        if (const Comdat *C = GA.getComdat())
+          if (DiscardableComdats.count(C))
+            Worklist.revisit(&GA);
+    }
+
+    if (!Worklist.startRound())
+      break;
+
     // Delete functions that are trivially dead, ccc -> fastcc
-    LocalChange |=
-        OptimizeFunctions(M, TLI, LookupDomTree, NotDiscardableComdats);
+    LocalChange |= OptimizeFunctions(M, TLI, LookupDomTree,
+                                     NotDiscardableComdats, Worklist);
 
     // Optimize global_ctors list.
-    LocalChange |= optimizeGlobalCtorsList(M, [&](Function *F) {
-      return EvaluateStaticConstructor(F, DL, TLI);
-    });
+    if (optimizeGlobalCtorsList(M, [&](Function *F) {
+          return EvaluateStaticConstructor(F, DL, TLI);
+        })) {
+      LocalChange = true;
+      Worklist.revisitAll();
+    }
 
     // Optimize non-address-taken globals.
     LocalChange |= OptimizeGlobalVars(M, TLI, LookupDomTree,
-                                      NotDiscardableComdats);
+                                      NotDiscardableComdats, Worklist);
 
     // Resolve aliases, when possible.
-    LocalChange |= OptimizeGlobalAliases(M, NotDiscardableComdats);
+    LocalChange |=
+        OptimizeGlobalAliases(M, NotDiscardableComdats, Worklist);
 
     // Try to remove trivial global destructors if they are not removed
     // already.
     Function *CXAAtExitFn = FindCXAAtExit(M, TLI);
-    if (CXAAtExitFn)
-      LocalChange |= OptimizeEmptyGlobalCXXDtors(CXAAtExitFn);
+    if (CXAAtExitFn && OptimizeEmptyGlobalCXXDtors(CXAAtExitFn)) {
+      LocalChange = true;
+      Worklist.revisitAll();
+    }
 
     Changed |= LocalChange;
   }
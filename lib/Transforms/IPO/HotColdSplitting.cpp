@@ -0,0 +1,212 @@
+//===- HotColdSplitting.cpp - Outline cold regions ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass outlines the regions of a function that the profile shows to be
+// cold into separate functions. A region is a block that is cold together
+// with all the blocks it dominates. The outlined functions are marked cold
+// and minsize, which makes the code generator optimize them for size and
+// place them in the .text.unlikely section, away from the hot code.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/HotColdSplitting.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/Utils/CodeExtractor.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "hotcoldsplit"
+
+STATISTIC(NumColdRegionsOutlined, "Number of cold regions outlined");
+
+static cl::opt<unsigned> MinSplitSize(
+    "hotcoldsplit-min-size", cl::init(4), cl::Hidden,
+    cl::desc("The minimum number of instructions in a cold region for it to "
+             "be outlined"));
+
+namespace {
+class HotColdSplitting {
+  ProfileSummaryInfo *PSI;
+  function_ref<BlockFrequencyInfo *(Function &)> LookupBFI;
+
+  bool isCold(BlockFrequencyInfo &BFI, const BasicBlock *BB) const;
+  void findColdRegions(BlockFrequencyInfo &BFI, DomTreeNode *N,
+                       std::vector<std::vector<BasicBlock *>> &Regions) const;
+  bool outlineColdRegions(Function &F);
+
+public:
+  HotColdSplitting(ProfileSummaryInfo *PSI,
+                   function_ref<BlockFrequencyInfo *(Function &)> LookupBFI)
+      : PSI(PSI), LookupBFI(LookupBFI) {}
+
+  /// Outline the cold regions of the functions in \p M, and call \p Changed
+  /// on each function that had some outlined.
+  bool run(Module &M, function_ref<void(Function &)> Changed);
+};
+
+class HotColdSplittingLegacyPass : public ModulePass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  HotColdSplittingLegacyPass() : ModulePass(ID) {
+    initializeHotColdSplittingLegacyPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<BlockFrequencyInfoWrapperPass>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+  }
+
+  bool runOnModule(Module &M) override;
+};
+} // end anonymous namespace
+
+bool HotColdSplitting::isCold(BlockFrequencyInfo &BFI,
+                              const BasicBlock *BB) const {
+  Optional<uint64_t> Count = BFI.getBlockProfileCount(BB);
+  return Count && PSI->isColdCount(*Count);
+}
+
+// Collect the cold regions of the dominator subtree rooted at N, outermost
+// first. A region is only taken whole: if any block dominated by a cold block
+// is not cold, look for regions among its children instead.
+void HotColdSplitting::findColdRegions(
+    BlockFrequencyInfo &BFI, DomTreeNode *N,
+    std::vector<std::vector<BasicBlock *>> &Regions) const {
+  BasicBlock *Head = N->getBlock();
+  if (&Head->getParent()->getEntryBlock() != Head && isCold(BFI, Head)) {
+    std::vector<BasicBlock *> Region;
+    unsigned Size = 0;
+    bool Viable = true;
+    for (DomTreeNode *D : depth_first(N)) {
+      BasicBlock *BB = D->getBlock();
+      // The extracted function can't return on behalf of its caller.
+      if (!isCold(BFI, BB) || isa<ReturnInst>(BB->getTerminator())) {
+        Viable = false;
+        break;
+      }
+      Region.push_back(BB);
+      for (Instruction &I : *BB)
+        if (!isa<DbgInfoIntrinsic>(I))
+          ++Size;
+    }
+    if (Viable) {
+      if (Size >= MinSplitSize)
+        Regions.push_back(std::move(Region));
+      return;
+    }
+  }
+
+  for (DomTreeNode *Child : *N)
+    findColdRegions(BFI, Child, Regions);
+}
+
+bool HotColdSplitting::outlineColdRegions(Function &F) {
+  std::vector<std::vector<BasicBlock *>> Regions;
+  {
+    DominatorTree DT(F);
+    findColdRegions(*LookupBFI(F), DT.getRootNode(), Regions);
+  }
+
+  bool Changed = false;
+  for (std::vector<BasicBlock *> &Region : Regions) {
+    // Each extraction restructures the function, so give the code extractor
+    // an up to date dominator tree every time. The regions are disjoint
+    // subtrees, so the blocks of the remaining ones are still there.
+    DominatorTree DT(F);
+    Function *Outlined = CodeExtractor(Region, &DT).extractCodeRegion();
+    if (!Outlined)
+      continue;
+
+    DEBUG(dbgs() << "HotColdSplitting: outlined " << Region.size()
+                 << " cold blocks of " << F.getName() << " into "
+                 << Outlined->getName() << "\n");
+    Outlined->addFnAttr(Attribute::Cold);
+    Outlined->addFnAttr(Attribute::MinSize);
+    for (User *U : Outlined->users())
+      if (auto CS = CallSite(U))
+        if (CS.getCalledFunction() == Outlined)
+          CS.setAttributes(CS.getAttributes().addAttribute(
+              F.getContext(), AttributeSet::FunctionIndex, Attribute::Cold));
+    ++NumColdRegionsOutlined;
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool HotColdSplitting::run(Module &M, function_ref<void(Function &)> Changed) {
+  if (!PSI->hasProfileSummary())
+    return false;
+
+  // Don't visit the functions created by the outlining.
+  std::vector<Function *> Worklist;
+  for (Function &F : M)
+    if (!F.isDeclaration() && F.getEntryCount() &&
+        !F.hasFnAttribute(Attribute::Cold) &&
+        !F.hasFnAttribute(Attribute::OptimizeNone) &&
+        !F.hasFnAttribute(Attribute::Naked))
+      Worklist.push_back(&F);
+
+  bool Outlined = false;
+  for (Function *F : Worklist)
+    if (outlineColdRegions(*F)) {
+      Changed(*F);
+      Outlined = true;
+    }
+  return Outlined;
+}
+
+bool HotColdSplittingLegacyPass::runOnModule(Module &M) {
+  if (skipModule(M))
+    return false;
+
+  ProfileSummaryInfo *PSI =
+      getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI(M);
+  auto LookupBFI = [this](Function &F) {
+    return &this->getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+  };
+  return HotColdSplitting(PSI, LookupBFI).run(M, [](Function &) {});
+}
+
+PreservedAnalyses HotColdSplittingPass::run(Module &M,
+                                            ModuleAnalysisManager &AM) {
+  auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  ProfileSummaryInfo *PSI = &AM.getResult<ProfileSummaryAnalysis>(M);
+  auto LookupBFI = [&FAM](Function &F) {
+    return &FAM.getResult<BlockFrequencyAnalysis>(F);
+  };
+  auto Invalidate = [&FAM](Function &F) {
+    FAM.invalidate(F, PreservedAnalyses::none());
+  };
+
+  if (!HotColdSplitting(PSI, LookupBFI).run(M, Invalidate))
+    return PreservedAnalyses::all();
+  return PreservedAnalyses::none();
+}
+
+char HotColdSplittingLegacyPass::ID = 0;
+INITIALIZE_PASS_BEGIN(HotColdSplittingLegacyPass, "hotcoldsplit",
+                      "Hot Cold Splitting", false, false)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_END(HotColdSplittingLegacyPass, "hotcoldsplit",
+                    "Hot Cold Splitting", false, false)
+
+ModulePass *llvm::createHotColdSplittingPass() {
+  return new HotColdSplittingLegacyPass();
+}
@@ -18,16 +18,22 @@
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/BlockFrequencyInfoImpl.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/InlineCost.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/ProfileSummaryInfo.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/InlinerPass.h"
@@ -41,16 +47,38 @@ STATISTIC(NumInlined, "Number of functions inlined");
 STATISTIC(NumCallsDeleted, "Number of call sites deleted, not inlined");
 STATISTIC(NumDeleted, "Number of functions deleted because all callers found");
 STATISTIC(NumMergedAllocas, "Number of allocas merged together");
+STATISTIC(NumHotInlined, "Number of hot call sites inlined");
+STATISTIC(NumHotNotInlined, "Number of hot call sites not inlined");
 
 // This weirdly named statistic tracks the number of times that, when attempting
 // to inline a function A into B, we analyze the callers of B in order to see
 // if those would be more profitable and blocked inline steps.
 STATISTIC(NumCallerCallersAnalyzed, "Number of caller-callers analyzed");
 
-Inliner::Inliner(char &ID) : CallGraphSCCPass(ID), InsertLifetime(true) {}
+static cl::opt<unsigned> HotCallSiteBudget(
+    "inline-hot-callsite-budget", cl::Hidden, cl::init(0),
+    cl::desc("The total inline cost of hot call sites that the profile may "
+             "get inlined in a module, after which the static thresholds "
+             "are used (0 = unlimited)"));
+
+struct Inliner::CallerProfile {
+  DominatorTree DT;
+  LoopInfo LI;
+  BranchProbabilityInfo BPI;
+  BlockFrequencyInfo BFI;
+
+  explicit CallerProfile(Function &F)
+      : DT(F), LI(DT), BPI(F, LI), BFI(F, BPI, LI) {}
+};
+
+Inliner::Inliner(char &ID)
+    : CallGraphSCCPass(ID), InsertLifetime(true), HotCallSiteCostSpent(0) {}
 
 Inliner::Inliner(char &ID, bool InsertLifetime)
-    : CallGraphSCCPass(ID), InsertLifetime(InsertLifetime) {}
+    : CallGraphSCCPass(ID), InsertLifetime(InsertLifetime),
+      HotCallSiteCostSpent(0) {}
+
+Inliner::~Inliner() {}
 
 /// For this class, we declare that we require and preserve the call graph.
 /// If the derived class implements this method, it should
@@ -222,6 +250,17 @@ static bool InlineCallIfPossible(Pass &P, CallSite CS, InlineFunctionInfo &IFI,
   return true;
 }
 
+BlockFrequencyInfo *Inliner::getCallerBFI(Function *Caller) {
+  if (!PSI->hasProfileSummary() || !Caller->getEntryCount())
+    return nullptr;
+  if (HotCallSiteBudget && HotCallSiteCostSpent >= HotCallSiteBudget)
+    return nullptr;
+  std::unique_ptr<CallerProfile> &Profile = CallerProfiles[Caller];
+  if (!Profile)
+    Profile.reset(new CallerProfile(*Caller));
+  return &Profile->BFI;
+}
+
 static void emitAnalysis(CallSite CS, const Twine &Msg) {
   Function *Caller = CS.getCaller();
   LLVMContext &Ctx = Caller->getContext();
@@ -300,8 +339,9 @@ bool Inliner::shouldBeDeferred(Function *Caller, CallSite CS, InlineCost IC,
 }
 
 /// Return true if the inliner should attempt to inline at the given CallSite.
-bool Inliner::shouldInline(CallSite CS) {
+bool Inliner::shouldInline(CallSite CS, int &InlinedCost) {
   InlineCost IC = getInlineCost(CS);
+  InlinedCost = IC.isVariable() ? std::max(IC.getCost(), 0) : 0;
   
   if (IC.isAlways()) {
     DEBUG(dbgs() << "    Inlining: cost=always"
@@ -367,6 +407,11 @@ static bool InlineHistoryIncludes(Function *F, int InlineHistoryID,
   return false;
 }
 
+bool Inliner::doInitialization(CallGraph &CG) {
+  HotCallSiteCostSpent = 0;
+  return false;
+}
+
 bool Inliner::runOnSCC(CallGraphSCC &SCC) {
   if (skipSCC(SCC))
     return false;
@@ -484,9 +529,27 @@ bool Inliner::inlineCalls(CallGraphSCC &SCC) {
         // Get DebugLoc to report. CS will be invalid after Inliner.
         DebugLoc DLoc = CS.getInstruction()->getDebugLoc();
 
+        // Note whether the profile finds the call site hot before inlining
+        // invalidates the caller's block frequencies.
+        BlockFrequencyInfo *CallerBFI = getCallerBFI(Caller);
+        bool IsHot = PSI->isHotCallSite(CS, CallerBFI);
+
         // If the policy determines that we should inline this function,
         // try to do so.
-        if (!shouldInline(CS)) {
+        int InlinedCost;
+        if (!shouldInline(CS, InlinedCost)) {
+          if (IsHot) {
+            ++NumHotNotInlined;
+            emitOptimizationRemarkMissed(
+                CallerCtx, DEBUG_TYPE, *Caller, DLoc,
+                Twine(Callee->getName() + " will not be inlined into " +
+                      Caller->getName() + " although the call site is hot " +
+                      "(count=" +
+                      Twine(*CallerBFI->getBlockProfileCount(
+                          CS.getInstruction()->getParent())) +
+                      ")"));
+            continue;
+          }
           emitOptimizationRemarkMissed(CallerCtx, DEBUG_TYPE, *Caller, DLoc,
                                        Twine(Callee->getName() +
                                              " will not be inlined into " +
@@ -504,6 +567,11 @@ bool Inliner::inlineCalls(CallGraphSCC &SCC) {
           continue;
         }
         ++NumInlined;
+        CallerProfiles.erase(Caller);
+        if (IsHot) {
+          ++NumHotInlined;
+          HotCallSiteCostSpent += InlinedCost;
+        }
 
         // Report the inline decision.
         emitOptimizationRemark(
@@ -536,6 +604,7 @@ bool Inliner::inlineCalls(CallGraphSCC &SCC) {
         DEBUG(dbgs() << "    -> Deleting dead function: "
               << Callee->getName() << "\n");
         CallGraphNode *CalleeNode = CG[Callee];
+        CallerProfiles.erase(Callee);
 
         // Remove any call graph edges from the callee to its callees.
         CalleeNode->removeAllCalledFunctions();
@@ -562,6 +631,8 @@ bool Inliner::inlineCalls(CallGraphSCC &SCC) {
     }
   } while (LocalChange);
 
+  // The functions may change before the next SCC is visited.
+  CallerProfiles.clear();
   return Changed;
 }
 
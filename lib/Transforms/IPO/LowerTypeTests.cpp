@@ -241,6 +241,9 @@ struct LowerTypeTests : public ModulePass {
   lowerBitSetCall(CallInst *CI, BitSetInfo &BSI, ByteArrayInfo *&BAI,
                   Constant *CombinedGlobal,
                   const DenseMap<GlobalObject *, uint64_t> &GlobalLayout);
+  Value *lowerBitSetCallForBranch(CallInst *CI, BranchInst *Br,
+                                  BitSetInfo &BSI, ByteArrayInfo *&BAI,
+                                  Value *OffsetInRange, Value *BitOffset);
   void buildBitSetsFromGlobalVariables(ArrayRef<Metadata *> TypeIds,
                                        ArrayRef<GlobalVariable *> Globals);
   unsigned getJumpTableEntrySize();
@@ -494,6 +497,24 @@ Value *LowerTypeTests::lowerBitSetCall(
   if (BSI.isAllOnes())
     return OffsetInRange;
 
+  // If the bits fit in an immediate, the bit test doesn't load anything, and
+  // createMaskedBitTest masks the bit index, so it is safe to do it whether or
+  // not the offset is in range. Combining both tests avoids a branch.
+  if (BSI.BitSize <= 64)
+    return B.CreateAnd(OffsetInRange,
+                       createBitSetTest(B, BSI, BAI, BitOffset));
+
+  // See if the intrinsic is used in the common pattern
+  //   br(llvm.type.test(...), thenbb, elsebb)
+  // with nothing in between. If so, branch to elsebb directly when the offset
+  // is out of range, rather than merging the results of both tests in a phi
+  // that is then branched on.
+  if (CI->hasOneUse())
+    if (auto *Br = dyn_cast<BranchInst>(*CI->user_begin()))
+      if (CI->getNextNode() == Br && Br->getSuccessor(0) != Br->getSuccessor(1))
+        return lowerBitSetCallForBranch(CI, Br, BSI, BAI, OffsetInRange,
+                                        BitOffset);
+
   TerminatorInst *Term = SplitBlockAndInsertIfThen(OffsetInRange, CI, false);
   IRBuilder<> ThenB(Term);
 
@@ -511,6 +532,34 @@ Value *LowerTypeTests::lowerBitSetCall(
   return P;
 }
 
+/// Lower a llvm.type.test call CI whose only user is the conditional branch
+/// Br that follows it. The block is split in front of CI, and the first half
+/// branches to the false successor of Br when OffsetInRange is false. Returns
+/// the value to replace the call with, which is only computed in the second
+/// half.
+Value *LowerTypeTests::lowerBitSetCallForBranch(CallInst *CI, BranchInst *Br,
+                                                BitSetInfo &BSI,
+                                                ByteArrayInfo *&BAI,
+                                                Value *OffsetInRange,
+                                                Value *BitOffset) {
+  BasicBlock *InitialBB = CI->getParent();
+  BasicBlock *Else = Br->getSuccessor(1);
+  BasicBlock *Then = InitialBB->splitBasicBlock(CI->getIterator());
+
+  BranchInst *NewBr = BranchInst::Create(Then, Else, OffsetInRange);
+  NewBr->setMetadata(LLVMContext::MD_prof,
+                     Br->getMetadata(LLVMContext::MD_prof));
+  ReplaceInstWithInst(InitialBB->getTerminator(), NewBr);
+
+  // Else is now also reached from InitialBB, with the same values as from
+  // Then, which is where the original branch ended up.
+  for (auto I = Else->begin(); PHINode *Phi = dyn_cast<PHINode>(I); ++I)
+    Phi->addIncoming(Phi->getIncomingValueForBlock(Then), InitialBB);
+
+  IRBuilder<> ThenB(CI);
+  return createBitSetTest(ThenB, BSI, BAI, BitOffset);
+}
+
 /// Given a disjoint set of type identifiers and globals, lay out the globals,
 /// build the bit sets and lower the llvm.type.test calls.
 void LowerTypeTests::buildBitSetsFromGlobalVariables(
@@ -120,6 +120,8 @@ STATISTIC(NumFunctionsMerged, "Number of functions merged");
 STATISTIC(NumThunksWritten, "Number of thunks generated");
 STATISTIC(NumAliasesWritten, "Number of aliases generated");
 STATISTIC(NumDoubleWeak, "Number of new functions created");
+STATISTIC(NumUniqueHashes,
+          "Number of functions skipped because of their unique hash");
 
 static cl::opt<unsigned> NumFunctionsForSanityCheck(
     "mergefunc-sanity",
@@ -1320,20 +1322,94 @@ public:
 };
 } // end anonymous namespace
 
-// A function hash is calculated by considering only the number of arguments and
-// whether a function is varargs, the order of basic blocks (given by the
-// successors of each basic block in depth first order), and the order of
-// opcodes of each instruction within each of these basic blocks. This mirrors
-// the strategy compare() uses to compare functions by walking the BBs in depth
-// first order and comparing each instruction in sequence. Because this hash
-// does not look at the operands, it is insensitive to things such as the
-// target of calls and the constants used in the function, which makes it useful
-// when possibly merging functions which are the same modulo constants and call
-// targets.
+// Hash the outermost level of a type the way cmpTypes() sees it, i.e. with
+// pointers in address space zero treated as integers of the same width.
+static void hashType(HashAccumulator64 &H, Type *Ty, const DataLayout &DL) {
+  if (auto *PTy = dyn_cast<PointerType>(Ty))
+    if (PTy->getAddressSpace() == 0)
+      Ty = DL.getIntPtrType(Ty);
+
+  H.add(Ty->getTypeID());
+  switch (Ty->getTypeID()) {
+  default:
+    break;
+  case Type::IntegerTyID:
+    H.add(Ty->getIntegerBitWidth());
+    break;
+  case Type::PointerTyID:
+    H.add(Ty->getPointerAddressSpace());
+    break;
+  case Type::VectorTyID:
+    H.add(Ty->getVectorNumElements());
+    break;
+  case Type::ArrayTyID:
+    H.add(Ty->getArrayNumElements());
+    break;
+  case Type::StructTyID:
+    H.add(Ty->getStructNumElements());
+    break;
+  case Type::FunctionTyID:
+    H.add(Ty->getFunctionNumParams());
+    break;
+  }
+}
+
+// Hash the parts of an instruction that cmpBasicBlocks() requires to be equal
+// for equal functions. GEPs are compared by the offset they compute, so only
+// their address space is stable. Operands are hashed by kind: null and
+// integer constants by value, other constants (including globals, so that
+// call targets don't matter) by nothing but their type, and arguments by
+// number, since compare() enumerates them first.
+static void hashInstruction(HashAccumulator64 &H, const Instruction &Inst,
+                            const DataLayout &DL) {
+  if (const auto *GEP = dyn_cast<GetElementPtrInst>(&Inst)) {
+    H.add(GEP->getPointerAddressSpace());
+    return;
+  }
+
+  H.add(Inst.getNumOperands());
+  hashType(H, Inst.getType(), DL);
+  H.add(Inst.getRawSubclassOptionalData());
+  if (const auto *CI = dyn_cast<CmpInst>(&Inst))
+    H.add(CI->getPredicate());
+
+  for (const Value *Op : Inst.operands()) {
+    hashType(H, Op->getType(), DL);
+    if (const auto *C = dyn_cast<Constant>(Op)) {
+      if (C->isNullValue())
+        H.add(1);
+      else if (const auto *CI = dyn_cast<ConstantInt>(C))
+        H.add(hash_value(CI->getValue()));
+      else
+        H.add(2);
+    } else if (const auto *A = dyn_cast<Argument>(Op)) {
+      H.add(3);
+      H.add(A->getArgNo());
+    } else {
+      H.add(4);
+    }
+  }
+}
+
+// A function hash is calculated by considering the signature and calling
+// convention of a function, the order of basic blocks (given by the successors
+// of each basic block in depth first order), and the opcodes, types and the
+// kinds of operands of each instruction within each of these basic blocks.
+// This mirrors the strategy compare() uses to compare functions by walking the
+// BBs in depth first order and comparing each instruction in sequence. On
+// large modules most functions end up with a unique hash and are never
+// compared at all, and the remaining ones are only compared with the
+// functions in the same hash bucket. The hash doesn't look at the globals a
+// function references, so it is insensitive to the target of calls.
 FunctionComparator::FunctionHash FunctionComparator::functionHash(Function &F) {
   HashAccumulator64 H;
+  const DataLayout &DL = F.getParent()->getDataLayout();
   H.add(F.isVarArg());
   H.add(F.arg_size());
+  H.add(F.getCallingConv());
+  hashType(H, F.getReturnType(), DL);
+  for (const Argument &A : F.args())
+    hashType(H, A.getType(), DL);
   
   SmallVector<const BasicBlock *, 8> BBs;
   SmallSet<const BasicBlock *, 16> VisitedBBs;
@@ -1349,6 +1425,7 @@ FunctionComparator::FunctionHash FunctionComparator::functionHash(Function &F) {
     H.add(45798); 
     for (auto &Inst : *BB) {
       H.add(Inst.getOpcode());
+      hashInstruction(H, Inst, DL);
     }
     const TerminatorInst *Term = BB->getTerminator();
     for (unsigned i = 0, e = Term->getNumSuccessors(); i != e; ++i) {
@@ -1565,6 +1642,8 @@ bool MergeFunctions::runOnModule(Module &M) {
     if ((I != S && std::prev(I)->first == I->first) ||
         (std::next(I) != IE && std::next(I)->first == I->first) ) {
       Deferred.push_back(WeakVH(I->second));
+    } else {
+      ++NumUniqueHashes;
     }
   }
   
@@ -229,6 +229,12 @@ void PassManagerBuilder::addFunctionSimplificationPasses(
   addInstructionCombiningPass(MPM);
   addExtensionsToPM(EP_Peephole, MPM);
 
+  // Specialize the memory intrinsics for their hottest profiled sizes. This
+  // stays in the function pipeline so that it does not split it, and is not
+  // repeated after the ThinLTO link.
+  if (SizeLevel == 0 && !PerformThinLTO)
+    MPM.add(createPGOMemOPSizeOptLegacyPass());
+
   MPM.add(createTailCallEliminationPass()); // Eliminate tail calls
   MPM.add(createCFGSimplificationPass());     // Merge & remove BBs
   MPM.add(createReassociatePass());           // Reassociate expressions
@@ -734,6 +740,53 @@ void PassManagerBuilder::populateThinLTOPassManager(
   PerformThinLTO = false;
 }
 
+void PassManagerBuilder::populateJITPassManager(legacy::PassManagerBase &PM) {
+  if (VerifyInput)
+    PM.add(createVerifierPass());
+
+  if (OptLevel == 0) {
+    if (Inliner) {
+      PM.add(Inliner);
+      Inliner = nullptr;
+    }
+    addExtensionsToPM(EP_EnabledOnOptLevel0, PM);
+  } else {
+    // Add LibraryInfo if we have some.
+    if (LibraryInfo)
+      PM.add(new TargetLibraryInfoWrapperPass(*LibraryInfo));
+
+    addInitialAliasAnalysisPasses(PM);
+    addExtensionsToPM(EP_EarlyAsPossible, PM);
+
+    if (Inliner) {
+      PM.add(Inliner);
+      Inliner = nullptr;
+    }
+
+    PM.add(createSROAPass());
+    PM.add(createEarlyCSEPass());
+    PM.add(createLowerExpectIntrinsicPass());
+    addInstructionCombiningPass(PM);
+    addExtensionsToPM(EP_Peephole, PM);
+    PM.add(createCFGSimplificationPass());
+
+    if (OptLevel > 1) {
+      PM.add(createReassociatePass());
+      PM.add(createGVNPass(DisableGVNLoadPRE));
+      PM.add(createDeadStoreEliminationPass());
+      addInstructionCombiningPass(PM);
+      addExtensionsToPM(EP_Peephole, PM);
+      PM.add(createCFGSimplificationPass());
+    }
+
+    addExtensionsToPM(EP_ScalarOptimizerLate, PM);
+    addExtensionsToPM(EP_OptimizerLast, PM);
+  }
+
+  if (VerifyOutput)
+    PM.add(createVerifierPass());
+}
+
 void PassManagerBuilder::populateLTOPassManager(legacy::PassManagerBase &PM) {
   if (LibraryInfo)
     PM.add(new TargetLibraryInfoWrapperPass(*LibraryInfo));
@@ -124,6 +124,7 @@ protected:
   ErrorOr<uint64_t> getBlockWeight(const BasicBlock *BB) const;
   const FunctionSamples *findCalleeFunctionSamples(const CallInst &I) const;
   const FunctionSamples *findFunctionSamples(const Instruction &I) const;
+  void preInlineContexts();
   bool inlineHotFunctions(Function &F);
   bool emitInlineHints(Function &F);
   void printEdgeWeight(raw_ostream &OS, Edge E);
@@ -728,6 +729,70 @@ bool SampleProfileLoader::inlineHotFunctions(Function &F) {
   return Changed;
 }
 
+/// \brief Fold the context-sensitive profiles into the function profiles.
+///
+/// A calling context that is hot in its outermost caller is nested in the
+/// caller's profile as a chain of inlined callsites. inlineHotFunctions then
+/// inlines the calls along the context, and the inlined body is annotated
+/// with the samples of that context alone. The samples of the other contexts
+/// are merged into the profile of the function itself.
+void SampleProfileLoader::preInlineContexts() {
+  typedef std::pair<SmallVector<SampleContextFrame, 4>, const FunctionSamples *>
+      ContextProfile;
+  std::vector<ContextProfile> Contexts;
+  for (const auto &I : Reader->getProfiles()) {
+    if (!SampleContext::isContext(I.first()))
+      continue;
+    ContextProfile CP;
+    if (!SampleContext::parse(I.first(), CP.first))
+      continue;
+    CP.second = &I.second;
+    Contexts.push_back(std::move(CP));
+  }
+
+  // Visit the shorter contexts first, so the longer ones can be nested into
+  // them. Break ties by name, since the profile map is unordered.
+  std::sort(Contexts.begin(), Contexts.end(),
+            [](const ContextProfile &A, const ContextProfile &B) {
+              if (A.first.size() != B.first.size())
+                return A.first.size() < B.first.size();
+              return A.second->getName() < B.second->getName();
+            });
+
+  for (const auto &CP : Contexts) {
+    ArrayRef<SampleContextFrame> Frames = CP.first;
+    const FunctionSamples &ContextFS = *CP.second;
+    StringRef Callee = Frames.back().FuncName;
+    FunctionSamples *RootFS = Reader->getSamplesFor(Frames.front().FuncName);
+
+    // The context can only be nested if no other function was inlined at
+    // its callsites in the profiled binary.
+    bool Nest = callsiteIsHot(RootFS, &ContextFS);
+    const FunctionSamples *Existing = RootFS;
+    for (unsigned I = 1, E = Frames.size(); Nest && Existing && I != E; ++I) {
+      Existing = Existing->findFunctionSamplesAt(Frames[I - 1].CallSite);
+      Nest = !Existing || Existing->getName() == Frames[I].FuncName;
+    }
+
+    FunctionSamples *FS;
+    if (Nest) {
+      // The samples of an inlined instance are also counted in its callers.
+      FS = RootFS;
+      for (unsigned I = 1, E = Frames.size(); I != E; ++I) {
+        FS->addTotalSamples(ContextFS.getTotalSamples());
+        FS = &FS->functionSamplesAt(Frames[I - 1].CallSite);
+        FS->setName(Frames[I].FuncName);
+      }
+      DEBUG(dbgs() << "Nested context " << ContextFS.getName() << " in "
+                   << RootFS->getName() << "\n");
+    } else {
+      FS = Reader->getSamplesFor(Callee);
+    }
+    FS->merge(ContextFS);
+    FS->setName(Callee);
+  }
+}
+
 /// \brief Find equivalence classes for the given block.
 ///
 /// This finds all the blocks that are guaranteed to execute the same
@@ -1249,7 +1314,7 @@ bool SampleProfileLoader::doInitialization(Module &M) {
     return false;
   }
   Reader = std::move(ReaderOrErr.get());
-  ProfileIsValid = (Reader->read() == sampleprof_error::success);
+  ProfileIsValid = (Reader->readOnDemand() == sampleprof_error::success);
   return true;
 }
 
@@ -1266,8 +1331,8 @@ bool SampleProfileLoader::runOnModule(Module &M) {
     return false;
 
   // Compute the total number of samples collected in this profile.
-  for (const auto &I : Reader->getProfiles())
-    TotalCollectedSamples += I.second.getTotalSamples();
+  TotalCollectedSamples = Reader->getTotalSamples();
+  preInlineContexts();
 
   bool retval = false;
   for (auto &F : M)
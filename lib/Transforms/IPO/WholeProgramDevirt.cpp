@@ -24,6 +24,11 @@
 //   for virtual constant propagation hold and a single vtable's function
 //   returns 0, or a single vtable's function returns 1, replace each virtual
 //   call with a comparison of the vptr against that vtable's address.
+// - Speculative devirtualization: if none of the above applies and the value
+//   profile of a virtual call shows that it mostly calls one of the possible
+//   callees, guard a direct call to that callee with a comparison of the vptr
+//   against the vtables that contain it, and keep the virtual call as the
+//   fallback.
 //
 //===----------------------------------------------------------------------===//
 
@@ -38,10 +43,14 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
+#include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/Evaluator.h"
 #include "llvm/Transforms/Utils/Local.h"
 
@@ -52,6 +61,17 @@ using namespace wholeprogramdevirt;
 
 #define DEBUG_TYPE "wholeprogramdevirt"
 
+static cl::opt<unsigned> SpeculateMinPercent(
+    "wholeprogramdevirt-speculate-percent", cl::init(30), cl::Hidden,
+    cl::desc("The percentage of the profiled calls of a virtual call site "
+             "that must go to a single target for it to be called directly "
+             "(100 disables speculative devirtualization)"));
+
+static cl::opt<unsigned> SpeculateMaxVTables(
+    "wholeprogramdevirt-speculate-max-vtables", cl::init(4), cl::Hidden,
+    cl::desc("The maximum number of vtables compared against the vptr to "
+             "guard a speculatively devirtualized call"));
+
 // Find the minimum offset that we may store a value of size Size bits at. If
 // IsAfter is set, look for an offset before the object, otherwise look for an
 // offset after the object.
@@ -274,6 +294,8 @@ struct DevirtModule {
                           MutableArrayRef<VirtualCallSite> CallSites);
   bool tryVirtualConstProp(MutableArrayRef<VirtualCallTarget> TargetsForSlot,
                            ArrayRef<VirtualCallSite> CallSites);
+  bool trySpeculativeDevirt(ArrayRef<VirtualCallTarget> TargetsForSlot,
+                            MutableArrayRef<VirtualCallSite> CallSites);
 
   void rebuildGlobal(VTableBits &B);
 
@@ -600,6 +622,93 @@ bool DevirtModule::tryVirtualConstProp(
   return true;
 }
 
+bool DevirtModule::trySpeculativeDevirt(
+    ArrayRef<VirtualCallTarget> TargetsForSlot,
+    MutableArrayRef<VirtualCallSite> CallSites) {
+  if (SpeculateMinPercent >= 100)
+    return false;
+
+  // The value profile identifies the callees by the hash of their PGO names.
+  DenseMap<uint64_t, Function *> TargetsByHash;
+  for (const VirtualCallTarget &Target : TargetsForSlot)
+    TargetsByHash[IndexedInstrProf::ComputeHash(
+        getPGOFuncName(*Target.Fn, /*InLTO=*/true))] = Target.Fn;
+
+  const uint32_t MaxNumValueData = 8;
+  bool Changed = false;
+  for (auto &&VCallSite : CallSites) {
+    // Invokes are left to indirect call promotion.
+    auto *CI = dyn_cast<CallInst>(VCallSite.CS.getInstruction());
+    if (!CI)
+      continue;
+
+    InstrProfValueData ValueData[MaxNumValueData];
+    uint32_t NumValueData;
+    uint64_t TotalCount;
+    if (!getValueProfDataFromInst(*CI, IPVK_IndirectCallTarget,
+                                  MaxNumValueData, ValueData, NumValueData,
+                                  TotalCount))
+      continue;
+
+    // The values are sorted by decreasing count, so the first one is the
+    // hottest target.
+    uint64_t Count = ValueData[0].Count;
+    if (Count * 100 < TotalCount * SpeculateMinPercent)
+      continue;
+    Function *Fn = TargetsByHash.lookup(ValueData[0].Value);
+    if (!Fn)
+      continue;
+
+    // Collect the address points of the vtables whose slot holds Fn.
+    SmallVector<const TypeMemberInfo *, 4> Members;
+    for (const VirtualCallTarget &Target : TargetsForSlot)
+      if (Target.Fn == Fn)
+        Members.push_back(Target.TM);
+    if (Members.size() > SpeculateMaxVTables)
+      continue;
+
+    IRBuilder<> B(CI);
+    Value *Cond = nullptr;
+    for (const TypeMemberInfo *TM : Members) {
+      Value *Addr = B.CreateBitCast(TM->Bits->GV, Int8PtrTy);
+      Addr = B.CreateConstGEP1_64(Addr, TM->Offset);
+      Value *Cmp = B.CreateICmpEQ(VCallSite.VTable, Addr);
+      Cond = Cond ? B.CreateOr(Cond, Cmp) : Cmp;
+    }
+
+    // Branch weights are 32 bits wide; scale the counts down to fit.
+    uint64_t ElseCount = TotalCount - Count;
+    uint64_t Scale = std::max(Count, ElseCount) / UINT32_MAX + 1;
+    MDBuilder MDB(M.getContext());
+    MDNode *Weights = MDB.createBranchWeights(Count / Scale, ElseCount / Scale);
+    TerminatorInst *ThenTerm, *ElseTerm;
+    SplitBlockAndInsertIfThenElse(Cond, CI, &ThenTerm, &ElseTerm, Weights);
+
+    auto *DirectCall = cast<CallInst>(CI->clone());
+    DirectCall->setCalledFunction(
+        ConstantExpr::getBitCast(Fn, CI->getCalledValue()->getType()));
+    DirectCall->setMetadata(LLVMContext::MD_prof, nullptr);
+    DirectCall->insertBefore(ThenTerm);
+    CI->moveBefore(ElseTerm);
+
+    if (!CI->getType()->isVoidTy()) {
+      BasicBlock *MergeBB = ThenTerm->getSuccessor(0);
+      PHINode *PN = PHINode::Create(CI->getType(), 2, "", &MergeBB->front());
+      CI->replaceAllUsesWith(PN);
+      PN->addIncoming(DirectCall, DirectCall->getParent());
+      PN->addIncoming(CI, CI->getParent());
+    }
+
+    // The virtual call now only sees the calls to the other targets.
+    CI->setMetadata(LLVMContext::MD_prof, nullptr);
+    if (NumValueData > 1)
+      annotateValueSite(M, *CI, makeArrayRef(ValueData + 1, NumValueData - 1),
+                        ElseCount, IPVK_IndirectCallTarget, MaxNumValueData);
+    Changed = true;
+  }
+  return Changed;
+}
+
 void DevirtModule::rebuildGlobal(VTableBits &B) {
   if (B.Before.Bytes.empty() && B.After.Bytes.empty())
     return;
@@ -808,7 +917,12 @@ bool DevirtModule::run() {
     if (trySingleImplDevirt(TargetsForSlot, S.second))
       continue;
 
-    DidVirtualConstProp |= tryVirtualConstProp(TargetsForSlot, S.second);
+    if (tryVirtualConstProp(TargetsForSlot, S.second)) {
+      DidVirtualConstProp = true;
+      continue;
+    }
+
+    trySpeculativeDevirt(TargetsForSlot, S.second);
   }
 
   // If we were able to eliminate all unsafe uses for a type checked load,
@@ -2383,6 +2383,9 @@ Instruction *InstCombiner::tryOptimizeCall(CallInst *CI) {
   LibCallSimplifier Simplifier(DL, TLI, InstCombineRAUW);
   if (Value *With = Simplifier.optimizeCall(CI)) {
     ++NumSimplified;
+    // The simplifier builds its replacement with its own IRBuilder, which
+    // doesn't add the new instructions to the worklist.
+    MadeUntrackedChange = true;
     return CI->use_empty() ? CI : replaceInstUsesWith(*CI, With);
   }
 
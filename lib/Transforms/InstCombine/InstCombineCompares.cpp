@@ -1749,6 +1749,7 @@ Instruction *InstCombiner::visitICmpInstWithInstAndIntCst(ICmpInst &ICI,
               NewAndCst = ConstantExpr::getShl(AndCst, ShAmt);
             LHSI->setOperand(1, NewAndCst);
             LHSI->setOperand(0, Shift->getOperand(0));
+            invalidateKnownBits(LHSI);
             Worklist.Add(Shift); // Shift is dead.
             return &ICI;
           }
@@ -2850,8 +2851,10 @@ static Instruction *ProcessUMulZExtIdiom(ICmpInst &I, Value *MulVal,
       if (TruncInst *TI = dyn_cast<TruncInst>(U)) {
         if (TI->getType()->getPrimitiveSizeInBits() == MulWidth)
           IC.replaceInstUsesWith(*TI, Mul);
-        else
+        else {
           TI->setOperand(0, Mul);
+          IC.invalidateKnownBits(TI);
+        }
       } else if (BinaryOperator *BO = dyn_cast<BinaryOperator>(U)) {
         assert(BO->getOpcode() == Instruction::And);
         // Replace (mul & mask) --> zext (mul.with.overflow & short_mask)
@@ -17,6 +17,7 @@
 
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/KnownBitsCache.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/TargetFolder.h"
 #include "llvm/Analysis/ValueTracking.h"
@@ -193,22 +194,36 @@ private:
   // combining and will be updated to reflect any changes.
   LoopInfo *LI;
 
+  /// Optional cache of the known bits, which must be told about every
+  /// instruction changed in place through invalidateKnownBits.
+  KnownBitsCache *KBC;
+
   bool MadeIRChange;
 
+  /// Whether a combine changed instructions without putting them on the
+  /// worklist, as the library call simplifier does with its own IRBuilder.
+  bool MadeUntrackedChange;
+
 public:
   InstCombiner(InstCombineWorklist &Worklist, BuilderTy *Builder,
                bool MinimizeSize, bool ExpensiveCombines, AliasAnalysis *AA,
                AssumptionCache *AC, TargetLibraryInfo *TLI,
-               DominatorTree *DT, const DataLayout &DL, LoopInfo *LI)
+               DominatorTree *DT, const DataLayout &DL, LoopInfo *LI,
+               KnownBitsCache *KBC = nullptr)
       : Worklist(Worklist), Builder(Builder), MinimizeSize(MinimizeSize),
         ExpensiveCombines(ExpensiveCombines), AA(AA), AC(AC), TLI(TLI), DT(DT),
-        DL(DL), LI(LI), MadeIRChange(false) {}
+        DL(DL), LI(LI), KBC(KBC), MadeIRChange(false),
+        MadeUntrackedChange(false) {}
 
   /// \brief Run the combiner over the entire worklist until it is empty.
   ///
   /// \returns true if the IR is changed.
   bool run();
 
+  /// \brief Return true if run() changed instructions that the worklist
+  /// didn't see, so that only a sweep of the whole function finds them.
+  bool madeUntrackedChange() const { return MadeUntrackedChange; }
+
   AssumptionCache *getAssumptionCache() const { return AC; }
 
   const DataLayout &getDataLayout() const { return DL; }
@@ -477,21 +492,27 @@ public:
   void computeKnownBits(Value *V, APInt &KnownZero, APInt &KnownOne,
                         unsigned Depth, Instruction *CxtI) const {
     return llvm::computeKnownBits(V, KnownZero, KnownOne, DL, Depth, AC, CxtI,
-                                  DT);
+                                  DT, KBC);
   }
 
   bool MaskedValueIsZero(Value *V, const APInt &Mask, unsigned Depth = 0,
                          Instruction *CxtI = nullptr) const {
-    return llvm::MaskedValueIsZero(V, Mask, DL, Depth, AC, CxtI, DT);
+    return llvm::MaskedValueIsZero(V, Mask, DL, Depth, AC, CxtI, DT, KBC);
   }
   unsigned ComputeNumSignBits(Value *Op, unsigned Depth = 0,
                               Instruction *CxtI = nullptr) const {
-    return llvm::ComputeNumSignBits(Op, DL, Depth, AC, CxtI, DT);
+    return llvm::ComputeNumSignBits(Op, DL, Depth, AC, CxtI, DT, KBC);
   }
   void ComputeSignBit(Value *V, bool &KnownZero, bool &KnownOne,
                       unsigned Depth = 0, Instruction *CxtI = nullptr) const {
     return llvm::ComputeSignBit(V, KnownZero, KnownOne, DL, Depth, AC, CxtI,
-                                DT);
+                                DT, KBC);
+  }
+
+  /// Forget the known bits derived from \p V, which was changed in place.
+  void invalidateKnownBits(Value *V) {
+    if (KBC)
+      KBC->invalidate(V);
   }
   OverflowResult computeOverflowForUnsignedMul(Value *LHS, Value *RHS,
                                                const Instruction *CxtI) {
@@ -495,6 +495,7 @@ Instruction *InstCombiner::visitSelectInstWithICmp(SelectInst &SI,
         ICI->setPredicate(Pred);
         ICI->setOperand(0, CmpLHS);
         ICI->setOperand(1, CmpRHS);
+        invalidateKnownBits(ICI);
         SI.setOperand(1, TrueVal);
         SI.setOperand(2, FalseVal);
 
@@ -75,7 +75,15 @@ bool InstCombiner::SimplifyDemandedBits(Use &U, const APInt &DemandedMask,
   Value *NewVal = SimplifyDemandedUseBits(U.get(), DemandedMask, KnownZero,
                                           KnownOne, Depth, UserI);
   if (!NewVal) return false;
+  // Either the operand was changed in place, or the user now has a new one,
+  // and the old operand may be dead.
+  if (NewVal == U.get())
+    invalidateKnownBits(NewVal);
+  else if (auto *OldI = dyn_cast<Instruction>(U.get()))
+    Worklist.Add(OldI);
   U = NewVal;
+  if (UserI)
+    invalidateKnownBits(UserI);
   return true;
 }
 
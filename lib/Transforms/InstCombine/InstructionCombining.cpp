@@ -55,6 +55,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/PatternMatch.h"
 #include "llvm/IR/ValueHandle.h"
@@ -77,11 +78,25 @@ STATISTIC(NumSunkInst , "Number of instructions sunk");
 STATISTIC(NumExpand,    "Number of expansions");
 STATISTIC(NumFactor   , "Number of factorizations");
 STATISTIC(NumReassoc  , "Number of reassociations");
+STATISTIC(NumIterations, "Number of instcombine iterations");
+STATISTIC(NumIncrementalIterations,
+          "Number of instcombine iterations seeded from modified instructions");
 
 static cl::opt<bool>
 EnableExpensiveCombines("expensive-combines",
                         cl::desc("Enable expensive instruction combines"));
 
+static cl::opt<bool>
+CacheKnownBits("instcombine-cache-known-bits", cl::Hidden,
+               cl::desc("Reuse the known bits of instructions across the "
+                        "queries of an instcombine iteration"));
+
+static cl::opt<bool>
+IncrementalIterations("instcombine-incremental", cl::Hidden,
+                      cl::desc("Revisit only the instructions the previous "
+                               "iteration queued, and sweep the whole "
+                               "function only to confirm it is done"));
+
 Value *InstCombiner::EmitGEPOffset(User *GEP) {
   return llvm::EmitGEPOffset(Builder, DL, GEP);
 }
@@ -1198,6 +1213,7 @@ Value *InstCombiner::Descale(Value *Val, APInt Scale, bool &NoSignedWrap) {
   assert(Op != Parent.first->getOperand(Parent.second) &&
          "Descaling was a no-op?");
   Parent.first->setOperand(Parent.second, Op);
+  invalidateKnownBits(Parent.first);
   Worklist.Add(Parent.first);
 
   // Now work back up the expression correcting nsw flags.  The logic is based
@@ -2895,6 +2911,8 @@ bool InstCombiner::run() {
                      << "    New = " << *I << '\n');
 #endif
 
+        invalidateKnownBits(I);
+
         // If the instruction was modified, it's possible that it is now dead.
         // if so, remove it.
         if (isInstructionTriviallyDead(I, TLI)) {
@@ -3075,24 +3093,70 @@ combineInstructionsOverFunction(Function &F, InstCombineWorklist &Worklist,
   // by instcombiner.
   bool DbgDeclaresChanged = LowerDbgDeclare(F);
 
+  KnownBitsCache KBC;
+
+  // In incremental mode, the instructions the combines of the last iteration
+  // put on the worklist: the ones they created or changed and the users and
+  // operands of those. The next iteration only revisits these, unless it has
+  // to sweep the whole function.
+  SmallVector<WeakVH, 32> ModifiedInsts;
+  bool FullSweep = true;
+
   // Iterate while there is work to do.
+  bool MadeIRChange = DbgDeclaresChanged;
   int Iteration = 0;
   for (;;) {
     ++Iteration;
+    ++NumIterations;
     DEBUG(dbgs() << "\n\nINSTCOMBINE ITERATION #" << Iteration << " on "
                  << F.getName() << "\n");
 
-    bool Changed = prepareICWorklistFromFunction(F, DL, &TLI, Worklist);
+    bool Changed = false;
+    if (FullSweep) {
+      Changed = prepareICWorklistFromFunction(F, DL, &TLI, Worklist);
+      ModifiedInsts.clear();
+    } else {
+      ++NumIncrementalIterations;
+      // Queue them in the order of the function, as a sweep would, since the
+      // result of the combines depends on the order they see instructions in.
+      SmallPtrSet<Instruction *, 32> Seeds;
+      for (WeakVH &V : ModifiedInsts)
+        if (auto *I = dyn_cast_or_null<Instruction>(V))
+          Seeds.insert(I);
+      ModifiedInsts.clear();
+      SmallVector<Instruction *, 32> OrderedSeeds;
+      for (Instruction &I : instructions(F)) {
+        if (OrderedSeeds.size() == Seeds.size())
+          break;
+        if (Seeds.count(&I))
+          OrderedSeeds.push_back(&I);
+      }
+      Worklist.AddInitialGroup(OrderedSeeds);
+    }
 
     InstCombiner IC(Worklist, &Builder, F.optForMinSize(), ExpensiveCombines,
-                    AA, &AC, &TLI, &DT, DL, LI);
+                    AA, &AC, &TLI, &DT, DL, LI,
+                    CacheKnownBits ? &KBC : nullptr);
+    if (IncrementalIterations)
+      Worklist.setAddedInstsList(&ModifiedInsts);
     Changed |= IC.run();
-
-    if (!Changed)
+    Worklist.setAddedInstsList(nullptr);
+    KBC.clear();
+    MadeIRChange |= Changed;
+
+    // The function is done once a sweep over all of it changes nothing. Some
+    // combines change instructions without queueing them, such as the library
+    // call simplifier and the demanded bits and elements simplifications, and
+    // only a sweep folds the constant expression operands. So in incremental
+    // mode, revisit what the last iteration queued until that runs dry, and
+    // then sweep again to confirm.
+    if (FullSweep && !Changed)
       break;
+    FullSweep = !IncrementalIterations || !Changed || ModifiedInsts.empty() ||
+                IC.madeUntrackedChange();
   }
 
-  return DbgDeclaresChanged || Iteration > 1;
+  return MadeIRChange;
 }
 
 PreservedAnalyses InstCombinePass::run(Function &F,
@@ -3110,9 +3174,8 @@ PreservedAnalyses InstCombinePass::run(Function &F,
     return PreservedAnalyses::all();
 
   // Mark all the analyses that instcombine updates as preserved.
-  // FIXME: This should also 'preserve the CFG'.
   PreservedAnalyses PA;
-  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserveSet<CFGAnalyses>();
   return PA;
 }
 
@@ -17,12 +17,17 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/CallSite.h"
@@ -228,6 +233,15 @@ static cl::opt<bool> ClOptGlobals("asan-opt-globals",
 static cl::opt<bool> ClOptStack(
     "asan-opt-stack", cl::desc("Don't instrument scalar stack variables"),
     cl::Hidden, cl::init(false));
+static cl::opt<bool> ClOptCoalesce(
+    "asan-opt-coalesce",
+    cl::desc("Check contiguous accesses in a basic block with one check"),
+    cl::Hidden, cl::init(false));
+static cl::opt<bool> ClOptLoops(
+    "asan-opt-loops",
+    cl::desc("Check the loop invariant and unit stride accesses of a loop "
+             "once, before the loop"),
+    cl::Hidden, cl::init(false));
 
 static cl::opt<bool> ClDynamicAllocaStack(
     "asan-stack-dynamic-alloca",
@@ -263,6 +277,10 @@ STATISTIC(NumOptimizedAccessesToGlobalVar,
           "Number of optimized accesses to global vars");
 STATISTIC(NumOptimizedAccessesToStackVar,
           "Number of optimized accesses to stack vars");
+STATISTIC(NumCoalescedAccesses,
+          "Number of accesses checked together with another one");
+STATISTIC(NumHoistedLoopAccesses,
+          "Number of loop accesses checked before the loop");
 
 namespace {
 /// Frontend-provided metadata for source location.
@@ -452,6 +470,8 @@ struct AddressSanitizer : public FunctionPass {
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<DominatorTreeWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addRequired<ScalarEvolutionWrapperPass>();
   }
   uint64_t getAllocaSizeInBytes(AllocaInst *AI) const {
     uint64_t ArraySize = 1;
@@ -473,12 +493,14 @@ struct AddressSanitizer : public FunctionPass {
   Value *isInterestingMemoryAccess(Instruction *I, bool *IsWrite,
                                    uint64_t *TypeSize, unsigned *Alignment);
   void instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis, Instruction *I,
-                     bool UseCalls, const DataLayout &DL);
+                     bool UseCalls, const DataLayout &DL,
+                     Instruction *InsertBefore = nullptr);
   void instrumentPointerComparisonOrSubtraction(Instruction *I);
   void instrumentAddress(Instruction *OrigIns, Instruction *InsertBefore,
                          Value *Addr, uint32_t TypeSize, bool IsWrite,
                          Value *SizeArgument, bool UseCalls, uint32_t Exp);
-  void instrumentUnusualSizeOrAlignment(Instruction *I, Value *Addr,
+  void instrumentUnusualSizeOrAlignment(Instruction *I,
+                                        Instruction *InsertBefore, Value *Addr,
                                         uint32_t TypeSize, bool IsWrite,
                                         Value *SizeArgument, bool UseCalls,
                                         uint32_t Exp);
@@ -506,6 +528,22 @@ struct AddressSanitizer : public FunctionPass {
   bool isSafeAccess(ObjectSizeOffsetVisitor &ObjSizeVis, Value *Addr,
                     uint64_t TypeSize) const;
 
+  /// A check that covers several accesses of a basic block.
+  struct CoalescedCheck {
+    Value *Base;
+    int64_t Offset;
+    uint32_t TypeSize;
+    bool IsWrite;
+  };
+  bool mayBeOptimizedAway(Value *Addr, const DataLayout &DL) const;
+  void coalesceChecks(ArrayRef<Instruction *> Run, const DataLayout &DL,
+                      DenseMap<Instruction *, CoalescedCheck> &Leaders,
+                      SmallPtrSetImpl<Instruction *> &Covered);
+  bool hoistLoopCheck(ObjectSizeOffsetVisitor &ObjSizeVis, Instruction *I,
+                      bool UseCalls, const DataLayout &DL,
+                      SCEVExpander &Expander);
+  bool loopHasNoCalls(Loop *L);
+
   /// Helper to cleanup per-function state.
   struct FunctionStateRAII {
     AddressSanitizer *Pass;
@@ -525,6 +563,9 @@ struct AddressSanitizer : public FunctionPass {
   Type *IntptrTy;
   ShadowMapping Mapping;
   DominatorTree *DT;
+  LoopInfo *LI;
+  ScalarEvolution *SE;
+  DenseMap<Loop *, bool> LoopsWithoutCalls;
   Function *AsanCtorFunction = nullptr;
   Function *AsanInitFunction = nullptr;
   Function *AsanHandleNoReturnFunc;
@@ -799,6 +840,8 @@ INITIALIZE_PASS_BEGIN(
     false)
 INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
 INITIALIZE_PASS_END(
     AddressSanitizer, "asan",
     "AddressSanitizer: detects use-after-free and out-of-bounds bugs.", false,
@@ -1020,7 +1063,10 @@ void AddressSanitizer::instrumentPointerComparisonOrSubtraction(
 
 void AddressSanitizer::instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis,
                                      Instruction *I, bool UseCalls,
-                                     const DataLayout &DL) {
+                                     const DataLayout &DL,
+                                     Instruction *InsertBefore) {
+  if (!InsertBefore)
+    InsertBefore = I;
   bool IsWrite = false;
   unsigned Alignment = 0;
   uint64_t TypeSize = 0;
@@ -1071,10 +1117,205 @@ void AddressSanitizer::instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis,
   if ((TypeSize == 8 || TypeSize == 16 || TypeSize == 32 || TypeSize == 64 ||
        TypeSize == 128) &&
       (Alignment >= Granularity || Alignment == 0 || Alignment >= TypeSize / 8))
-    return instrumentAddress(I, I, Addr, TypeSize, IsWrite, nullptr, UseCalls,
-                             Exp);
-  instrumentUnusualSizeOrAlignment(I, Addr, TypeSize, IsWrite, nullptr,
-                                   UseCalls, Exp);
+    return instrumentAddress(I, InsertBefore, Addr, TypeSize, IsWrite, nullptr,
+                             UseCalls, Exp);
+  instrumentUnusualSizeOrAlignment(I, InsertBefore, Addr, TypeSize, IsWrite,
+                                   nullptr, UseCalls, Exp);
+}
+
+// Return true if instrumentMop may find that an access to Addr is always in
+// bounds. Such accesses are left to it by the optimizations below.
+bool AddressSanitizer::mayBeOptimizedAway(Value *Addr,
+                                          const DataLayout &DL) const {
+  Value *Obj = GetUnderlyingObject(Addr, DL);
+  return (ClOptGlobals && isa<GlobalVariable>(Obj)) ||
+         (ClOptStack && isa<AllocaInst>(Obj));
+}
+
+// Find the loads and stores of Run, a sequence of accesses of a basic block
+// with no calls in between, that read or write contiguous bytes from the same
+// base pointer. When these bytes make an access that one check handles, that
+// is a 1-, 2-, 4-, 8- or 16-byte access aligned well enough, the first of
+// them in Run gets this check, in Leaders, and the others are added to
+// Covered.
+void AddressSanitizer::coalesceChecks(
+    ArrayRef<Instruction *> Run, const DataLayout &DL,
+    DenseMap<Instruction *, CoalescedCheck> &Leaders,
+    SmallPtrSetImpl<Instruction *> &Covered) {
+  struct Access {
+    unsigned Index; // Position in Run.
+    int64_t Offset;
+    uint64_t Size;
+    unsigned Alignment;
+    bool IsWrite;
+  };
+  SmallVector<Value *, 8> Bases;
+  DenseMap<Value *, SmallVector<Access, 4>> AccessesOfBase;
+  for (unsigned Index = 0, E = Run.size(); Index != E; ++Index) {
+    Instruction *I = Run[Index];
+    if (!isa<LoadInst>(I) && !isa<StoreInst>(I))
+      continue;
+    bool IsWrite;
+    uint64_t TypeSize;
+    unsigned Alignment;
+    Value *Addr = isInterestingMemoryAccess(I, &IsWrite, &TypeSize, &Alignment);
+    if (!Addr || TypeSize % 8 != 0 || TypeSize > 128 ||
+        mayBeOptimizedAway(Addr, DL))
+      continue;
+    if (Alignment == 0)
+      Alignment = DL.getABITypeAlignment(
+          cast<PointerType>(Addr->getType())->getElementType());
+    int64_t Offset;
+    Value *Base = GetPointerBaseWithConstantOffset(Addr, Offset, DL);
+    auto &Accesses = AccessesOfBase[Base];
+    if (Accesses.empty())
+      Bases.push_back(Base);
+    Accesses.push_back({Index, Offset, TypeSize / 8, Alignment, IsWrite});
+  }
+
+  uint64_t Granularity = 1ULL << Mapping.Scale;
+  for (Value *Base : Bases) {
+    auto &Accesses = AccessesOfBase[Base];
+    if (Accesses.size() < 2)
+      continue;
+    std::stable_sort(Accesses.begin(), Accesses.end(),
+                     [](const Access &L, const Access &R) {
+                       return L.Offset < R.Offset;
+                     });
+    // Greedily gather the accesses, by offset, into groups of contiguous bytes
+    // of at most 16 bytes.
+    for (auto GroupBegin = Accesses.begin(), End = Accesses.end();
+         GroupBegin != End;) {
+      int64_t Start = GroupBegin->Offset;
+      int64_t GroupEnd = Start + GroupBegin->Size;
+      unsigned Alignment = GroupBegin->Alignment;
+      auto GroupLast = GroupBegin;
+      for (auto Next = std::next(GroupBegin); Next != End; ++Next) {
+        int64_t NewEnd = std::max<int64_t>(GroupEnd, Next->Offset + Next->Size);
+        if (Next->Offset > GroupEnd || NewEnd - Start > 16)
+          break;
+        if (Next->Offset == Start)
+          Alignment = std::max(Alignment, Next->Alignment);
+        GroupEnd = NewEnd;
+        GroupLast = Next;
+      }
+      auto GroupNext = std::next(GroupLast);
+      uint64_t Size = GroupEnd - Start;
+      if (GroupLast != GroupBegin && isPowerOf2_64(Size) &&
+          Alignment >= std::min(Size, Granularity)) {
+        auto Leader = std::min_element(
+            GroupBegin, GroupNext, [](const Access &L, const Access &R) {
+              return L.Index < R.Index;
+            });
+        bool IsWrite = std::any_of(GroupBegin, GroupNext,
+                                   [](const Access &A) { return A.IsWrite; });
+        Leaders[Run[Leader->Index]] = {Base, Start, uint32_t(Size * 8),
+                                       IsWrite};
+        for (auto A = GroupBegin; A != GroupNext; ++A)
+          if (A != Leader) {
+            Covered.insert(Run[A->Index]);
+            NumCoalescedAccesses++;
+          }
+      }
+      GroupBegin = GroupNext;
+    }
+  }
+}
+
+bool AddressSanitizer::loopHasNoCalls(Loop *L) {
+  auto It = LoopsWithoutCalls.find(L);
+  if (It != LoopsWithoutCalls.end())
+    return It->second;
+  bool NoCalls = std::none_of(L->block_begin(), L->block_end(),
+                              [](BasicBlock *BB) {
+                                for (auto &Inst : *BB)
+                                  if (isa<CallInst>(Inst) &&
+                                      !isa<DbgInfoIntrinsic>(Inst))
+                                    return true;
+                                  else if (isa<InvokeInst>(Inst))
+                                    return true;
+                                return false;
+                              });
+  LoopsWithoutCalls[L] = NoCalls;
+  return NoCalls;
+}
+
+// Check a load or store in the header of a loop without calls before the
+// loop, in its preheader, when its address is loop invariant or advances by
+// the access size on each iteration. The header runs on every iteration and
+// nothing in the loop can free memory or leave the loop early, so checking
+// the invariant address, or the whole range of addresses with one sized check,
+// finds the same bugs. Return true if I was checked this way.
+bool AddressSanitizer::hoistLoopCheck(ObjectSizeOffsetVisitor &ObjSizeVis,
+                                      Instruction *I, bool UseCalls,
+                                      const DataLayout &DL,
+                                      SCEVExpander &Expander) {
+  if (!isa<LoadInst>(I) && !isa<StoreInst>(I))
+    return false;
+  BasicBlock *BB = I->getParent();
+  Loop *L = LI->getLoopFor(BB);
+  if (!L || L->getHeader() != BB)
+    return false;
+  BasicBlock *Preheader = L->getLoopPreheader();
+  if (!Preheader || !loopHasNoCalls(L))
+    return false;
+  bool IsWrite;
+  uint64_t TypeSize;
+  unsigned Alignment;
+  Value *Addr = isInterestingMemoryAccess(I, &IsWrite, &TypeSize, &Alignment);
+  if (!Addr || mayBeOptimizedAway(Addr, DL))
+    return false;
+
+  Instruction *InsertBefore = Preheader->getTerminator();
+  if (L->isLoopInvariant(Addr)) {
+    instrumentMop(ObjSizeVis, I, UseCalls, DL, InsertBefore);
+    NumHoistedLoopAccesses++;
+    return true;
+  }
+
+  const auto *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Addr));
+  if (!AR || AR->getLoop() != L || !AR->isAffine() || TypeSize % 8 != 0)
+    return false;
+  const auto *Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+  uint64_t Size = TypeSize / 8;
+  if (!Step || Step->getAPInt().abs() != Size)
+    return false;
+  const SCEV *BackedgeTakenCount = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BackedgeTakenCount))
+    return false;
+  BackedgeTakenCount =
+      SE->getTruncateOrZeroExtend(BackedgeTakenCount, IntptrTy);
+  // The header runs once more than the backedge is taken. When the address
+  // goes down, the range starts at the last address.
+  const SCEV *Start = AR->getStart();
+  if (Step->getAPInt().isNegative())
+    Start = SE->getAddExpr(
+        Start, SE->getMulExpr(BackedgeTakenCount,
+                              SE->getConstant(IntptrTy, -Size, true)));
+  const SCEV *Length = SE->getMulExpr(
+      SE->getAddExpr(BackedgeTakenCount, SE->getOne(IntptrTy)),
+      SE->getConstant(IntptrTy, Size));
+  if (!isSafeToExpand(Start, *SE) || !isSafeToExpand(Length, *SE))
+    return false;
+
+  Value *StartV = Expander.expandCodeFor(Start, Start->getType(), InsertBefore);
+  Value *LengthV = Expander.expandCodeFor(Length, IntptrTy, InsertBefore);
+  IRBuilder<> IRB(InsertBefore);
+  StartV = IRB.CreatePointerCast(StartV, IntptrTy);
+  IRB.SetCurrentDebugLocation(I->getDebugLoc());
+  uint32_t Exp = ClForceExperiment;
+  if (Exp == 0)
+    IRB.CreateCall(AsanMemoryAccessCallbackSized[IsWrite][0],
+                   {StartV, LengthV});
+  else
+    IRB.CreateCall(AsanMemoryAccessCallbackSized[IsWrite][1],
+                   {StartV, LengthV, ConstantInt::get(IRB.getInt32Ty(), Exp)});
+  if (IsWrite)
+    NumInstrumentedWrites++;
+  else
+    NumInstrumentedReads++;
+  NumHoistedLoopAccesses++;
+  return true;
 }
 
 Instruction *AddressSanitizer::generateCrashCode(Instruction *InsertBefore,
@@ -1189,9 +1430,9 @@ void AddressSanitizer::instrumentAddress(Instruction *OrigIns,
 // and the last bytes. We call __asan_report_*_n(addr, real_size) to be able
 // to report the actual access size.
 void AddressSanitizer::instrumentUnusualSizeOrAlignment(
-    Instruction *I, Value *Addr, uint32_t TypeSize, bool IsWrite,
-    Value *SizeArgument, bool UseCalls, uint32_t Exp) {
-  IRBuilder<> IRB(I);
+    Instruction *I, Instruction *InsertBefore, Value *Addr, uint32_t TypeSize,
+    bool IsWrite, Value *SizeArgument, bool UseCalls, uint32_t Exp) {
+  IRBuilder<> IRB(InsertBefore);
   Value *Size = ConstantInt::get(IntptrTy, TypeSize / 8);
   Value *AddrLong = IRB.CreatePointerCast(Addr, IntptrTy);
   if (UseCalls) {
@@ -1205,8 +1446,8 @@ void AddressSanitizer::instrumentUnusualSizeOrAlignment(
     Value *LastByte = IRB.CreateIntToPtr(
         IRB.CreateAdd(AddrLong, ConstantInt::get(IntptrTy, TypeSize / 8 - 1)),
         Addr->getType());
-    instrumentAddress(I, I, Addr, 8, IsWrite, Size, false, Exp);
-    instrumentAddress(I, I, LastByte, 8, IsWrite, Size, false, Exp);
+    instrumentAddress(I, InsertBefore, Addr, 8, IsWrite, Size, false, Exp);
+    instrumentAddress(I, InsertBefore, LastByte, 8, IsWrite, Size, false, Exp);
   }
 }
 
@@ -1762,6 +2003,9 @@ bool AddressSanitizer::runOnFunction(Function &F) {
   initializeCallbacks(*F.getParent());
 
   DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+  LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+  LoopsWithoutCalls.clear();
 
   // If needed, insert __asan_init before checking for SanitizeAddress attr.
   maybeInsertAsanInitAtFunctionEntry(F);
@@ -1780,6 +2024,8 @@ bool AddressSanitizer::runOnFunction(Function &F) {
   // are calls between uses).
   SmallSet<Value *, 16> TempsToInstrument;
   SmallVector<Instruction *, 16> ToInstrument;
+  // Where the sequences of ToInstrument with no calls in between start.
+  SmallVector<unsigned, 16> RunStarts;
   SmallVector<Instruction *, 8> NoReturnCalls;
   SmallVector<BasicBlock *, 16> AllBlocks;
   SmallVector<Instruction *, 16> PointerComparisonsOrSubtracts;
@@ -1794,6 +2040,7 @@ bool AddressSanitizer::runOnFunction(Function &F) {
   for (auto &BB : F) {
     AllBlocks.push_back(&BB);
     TempsToInstrument.clear();
+    RunStarts.push_back(ToInstrument.size());
     int NumInsnsPerBB = 0;
     for (auto &Inst : BB) {
       if (LooksLikeCodeInBug11395(&Inst)) return false;
@@ -1815,6 +2062,7 @@ bool AddressSanitizer::runOnFunction(Function &F) {
         if (CS) {
           // A call inside BB.
           TempsToInstrument.clear();
+          RunStarts.push_back(ToInstrument.size());
           if (CS.doesNotReturn()) NoReturnCalls.push_back(CS.getInstruction());
         }
         if (CallInst *CI = dyn_cast<CallInst>(&Inst))
@@ -1835,14 +2083,54 @@ bool AddressSanitizer::runOnFunction(Function &F) {
   ObjectSizeOffsetVisitor ObjSizeVis(DL, TLI, F.getContext(),
                                      /*RoundToAlign=*/true);
 
+  // Check the accesses that allow it before their loop, and find the accesses
+  // that can share a check.
+  SmallPtrSet<Instruction *, 16> Covered;
+  DenseMap<Instruction *, CoalescedCheck> Leaders;
+  if (ClOptLoops) {
+    SCEVExpander Expander(*SE, DL, "asan");
+    for (auto Inst : ToInstrument)
+      if (hoistLoopCheck(ObjSizeVis, Inst, UseCalls, DL, Expander))
+        Covered.insert(Inst);
+  }
+  if (ClOptCoalesce) {
+    RunStarts.push_back(ToInstrument.size());
+    for (unsigned I = 0, E = RunStarts.size() - 1; I != E; ++I) {
+      SmallVector<Instruction *, 16> Run;
+      for (unsigned J = RunStarts[I]; J != RunStarts[I + 1]; ++J)
+        if (!Covered.count(ToInstrument[J]))
+          Run.push_back(ToInstrument[J]);
+      coalesceChecks(Run, DL, Leaders, Covered);
+    }
+  }
+
   // Instrument.
   int NumInstrumented = 0;
   for (auto Inst : ToInstrument) {
+    if (Covered.count(Inst)) {
+      NumInstrumented++;
+      continue;
+    }
     if (ClDebugMin < 0 || ClDebugMax < 0 ||
         (NumInstrumented >= ClDebugMin && NumInstrumented <= ClDebugMax)) {
-      if (isInterestingMemoryAccess(Inst, &IsWrite, &TypeSize, &Alignment))
-        instrumentMop(ObjSizeVis, Inst, UseCalls,
-                      F.getParent()->getDataLayout());
+      auto Leader = Leaders.find(Inst);
+      if (Leader != Leaders.end()) {
+        const CoalescedCheck &Check = Leader->second;
+        IRBuilder<> IRB(Inst);
+        Value *Addr = IRB.CreatePointerCast(
+            Check.Base,
+            IRB.getInt8PtrTy(Check.Base->getType()->getPointerAddressSpace()));
+        if (Check.Offset)
+          Addr = IRB.CreateConstGEP1_64(Addr, Check.Offset);
+        if (Check.IsWrite)
+          NumInstrumentedWrites++;
+        else
+          NumInstrumentedReads++;
+        instrumentAddress(Inst, Inst, Addr, Check.TypeSize, Check.IsWrite,
+                          nullptr, UseCalls, ClForceExperiment);
+      } else if (isInterestingMemoryAccess(Inst, &IsWrite, &TypeSize,
+                                           &Alignment))
+        instrumentMop(ObjSizeVis, Inst, UseCalls, DL);
       else
         instrumentMemIntrinsic(cast<MemIntrinsic>(Inst));
     }
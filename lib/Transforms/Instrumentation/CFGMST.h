@@ -14,9 +14,11 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Analysis/BlockFrequencyInfo.h"
 #include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/CFG.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/Support/BranchProbability.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -103,9 +105,16 @@ public:
           (BFI != nullptr ? BFI->getBlockFreq(&*BB).getFrequency() : 2);
       uint64_t Weight = 2;
       if (int successors = TI->getNumSuccessors()) {
+        SmallPtrSet<const BasicBlock *, 4> Visited;
         for (int i = 0; i != successors; ++i) {
           BasicBlock *TargetBB = TI->getSuccessor(i);
-          bool Critical = isCriticalEdge(TI, i);
+          // Identical edges, e.g. from switch cases with the same destination,
+          // always run the same number of times in total as one edge, and are
+          // counted and split as one. The edge probability below is already
+          // the sum over all of them.
+          if (!Visited.insert(TargetBB).second)
+            continue;
+          bool Critical = isCriticalEdge(TI, i, /*AllowIdenticalEdges=*/true);
           uint64_t scaleFactor = BBWeight;
           if (Critical) {
             if (scaleFactor < UINT64_MAX / CriticalEdgeMultiplier)
@@ -136,20 +145,25 @@ public:
                      });
   }
 
+  // Return true if the critical edge E cannot be split to instrument it:
+  // EH pads can't be the destination of a split edge, and indirectbr edges
+  // can't be redirected.
+  static bool isUnsplittable(const Edge &E) {
+    return E.DestBB && (E.DestBB->isEHPad() ||
+                        isa<IndirectBrInst>(E.SrcBB->getTerminator()));
+  }
+
   // Traverse all the edges and compute the Minimum Weight Spanning Tree
   // using union-find algorithm.
   void computeMinimumSpanningTree() {
-    // First, put all the critical edge with landing-pad as the Dest to MST.
-    // This works around the insufficient support of critical edges split
-    // when destination BB is a landing pad.
+    // First, put all the critical edges that can't be split into the MST, so
+    // that their counts are inferred rather than instrumented.
     for (auto &Ei : AllEdges) {
       if (Ei->Removed)
         continue;
-      if (Ei->IsCritical) {
-        if (Ei->DestBB && Ei->DestBB->isLandingPad()) {
-          if (unionGroups(Ei->SrcBB, Ei->DestBB))
-            Ei->InMST = true;
-        }
+      if (Ei->IsCritical && isUnsplittable(*Ei)) {
+        if (unionGroups(Ei->SrcBB, Ei->DestBB))
+          Ei->InMST = true;
       }
     }
 
@@ -13,17 +13,22 @@
 // The instrumentation phase is straightforward:
 //   - Take action on every memory access: either inlined instrumentation,
 //     or Inserted calls to our run-time library.
-//   - Optimizations may apply to avoid instrumenting some of the accesses.
+//   - Optimizations may apply to avoid instrumenting some of the accesses,
+//     or to only instrument a sample of them.
 //   - Turn mem{set,cpy,move} instrinsics into library calls.
 // The rest is handled by the run-time library.
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Instrumentation.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Analysis/CaptureTracking.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/IntrinsicInst.h"
@@ -70,6 +75,22 @@ static cl::opt<bool> ClAssumeIntraCacheLine(
              "better performance but with a potential loss of accuracy."),
     cl::Hidden);
 
+// The working set only needs to see enough of the accesses to each cache line
+// to mark it, so sampling trades little accuracy for a large speedup.
+static cl::opt<unsigned> ClSampleRate(
+    "esan-sample-rate", cl::init(1),
+    cl::desc("Instrument only one in this many loads and stores, counted "
+             "per thread at run time"),
+    cl::Hidden);
+
+// Stack objects that are not visible outside their frame are touched by one
+// thread only and stay in the cache while the frame is live.
+static cl::opt<bool> ClIgnoreNonEscapingStack(
+    "esan-ignore-non-escaping-stack", cl::init(true),
+    cl::desc("Do not instrument the accesses to stack objects whose address "
+             "does not escape when measuring the working set"),
+    cl::Hidden);
+
 STATISTIC(NumInstrumentedLoads, "Number of instrumented loads");
 STATISTIC(NumInstrumentedStores, "Number of instrumented stores");
 STATISTIC(NumFastpaths, "Number of instrumented fastpaths");
@@ -80,6 +101,9 @@ STATISTIC(NumIgnoredGEPs, "Number of ignored GEP instructions");
 STATISTIC(NumInstrumentedGEPs, "Number of instrumented GEP instructions");
 STATISTIC(NumAssumedIntraCacheLine,
           "Number of accesses assumed to be intra-cache-line");
+STATISTIC(NumIgnoredStackAccesses,
+          "Number of ignored accesses to non-escaping stack objects");
+STATISTIC(NumSampledAccesses, "Number of sampled loads and stores");
 
 static const uint64_t EsanCtorAndDtorPriority = 0;
 static const char *const EsanModuleCtorName = "esan.module_ctor";
@@ -91,6 +115,10 @@ static const char *const EsanExitName = "__esan_exit";
 // the ctor is called in some cases, so we set a global variable.
 static const char *const EsanWhichToolName = "__esan_which_tool";
 
+// The per-thread countdown to the next sampled access. Each module defines it
+// weakly, so that all the modules of a binary share it.
+static const char *const EsanSampleCountdownName = "__esan_sample_countdown";
+
 // We must keep these Shadow* constants consistent with the esan runtime.
 // FIXME: Try to place these shadow constants, the names of the __esan_*
 // interface functions, and the ToolType enum into a header shared between
@@ -165,11 +193,19 @@ private:
                                         Constant *UnitName);
   Constant *createEsanInitToolInfoArg(Module &M, const DataLayout &DL);
   void createDestructor(Module &M, Constant *ToolInfoArg);
+  // The field counter increments of a basic block: the first instruction
+  // that accesses each field, and the number of accesses.
+  typedef MapVector<Constant *, std::pair<Instruction *, uint64_t>>
+      CounterIncrementMap;
   bool runOnFunction(Function &F, Module &M);
   bool instrumentLoadOrStore(Instruction *I, const DataLayout &DL);
+  Instruction *insertSampleCheck(Instruction *I);
   bool instrumentMemIntrinsic(MemIntrinsic *MI);
-  bool instrumentGetElementPtr(Instruction *I, Module &M);
-  bool shouldIgnoreMemoryAccess(Instruction *I);
+  bool instrumentGetElementPtr(Instruction *I, Module &M,
+                               CounterIncrementMap &Increments);
+  bool emitCounterIncrements(CounterIncrementMap &Increments);
+  bool shouldIgnoreMemoryAccess(Instruction *I, const DataLayout &DL);
+  bool isNonEscapingStackAccess(Value *Addr, const DataLayout &DL);
   int getMemoryAccessFuncIndex(Value *Addr, const DataLayout &DL);
   Value *appToShadow(Value *Shadow, IRBuilder<> &IRB);
   bool instrumentFastpath(Instruction *I, const DataLayout &DL, bool IsStore,
@@ -195,6 +231,10 @@ private:
   Function *MemmoveFn, *MemcpyFn, *MemsetFn;
   Function *EsanCtorFunction;
   Function *EsanDtorFunction;
+  // The sampling countdown, or null if every access is instrumented.
+  GlobalVariable *SampleCountdown;
+  // Whether each stack object of the current function is known not to escape.
+  DenseMap<const AllocaInst *, bool> NonEscapingAllocas;
   // Remember the counter variable for each struct type to avoid
   // recomputing the variable name later during instrumentation.
   std::map<Type *, GlobalVariable *> StructTyMap;
@@ -335,16 +375,49 @@ GlobalVariable *EfficiencySanitizer::createCacheFragInfoGV(
     StructType::get(Int8PtrTy, Int32Ty, StructInfoPtrTy, nullptr);
 
   std::vector<StructType *> Vec = M.getIdentifiedStructTypes();
-  unsigned NumStructs = 0;
-  SmallVector<Constant *, 16> Initializers;
-
+  SmallVector<StructType *, 16> Structs;
+  unsigned NumFields = 0;
   for (auto &StructTy : Vec) {
     if (shouldIgnoreStructType(StructTy)) {
       ++NumIgnoredStructs;
       continue;
     }
-    ++NumStructs;
+    Structs.push_back(StructTy);
+    NumFields += StructTy->getNumElements();
+  }
+  unsigned NumStructs = Structs.size();
+  SmallVector<Constant *, 16> Initializers;
 
+  // We pass the field type names, offsets and sizes to the runtime for better
+  // reporting. The fields of all the structs share one table of each, which
+  // each StructInfo points into, and fields of the same type share their type
+  // name, so that the tables stay small in modules with many structs.
+  auto *TypeNameArrayTy = ArrayType::get(Int8PtrTy, NumFields);
+  GlobalVariable *TypeNames =
+    new GlobalVariable(M, TypeNameArrayTy, true,
+                       GlobalVariable::InternalLinkage, nullptr);
+  auto *OffsetArrayTy = ArrayType::get(Int32Ty, NumFields);
+  GlobalVariable *Offsets =
+    new GlobalVariable(M, OffsetArrayTy, true,
+                       GlobalVariable::InternalLinkage, nullptr);
+  auto *SizeArrayTy = ArrayType::get(Int32Ty, NumFields);
+  GlobalVariable *Sizes =
+    new GlobalVariable(M, SizeArrayTy, true,
+                       GlobalVariable::InternalLinkage, nullptr);
+  SmallVector<Constant *, 64> TypeNameVec;
+  SmallVector<Constant *, 64> OffsetVec;
+  SmallVector<Constant *, 64> SizeVec;
+  StringMap<Constant *> TypeNameStrings;
+  auto getFieldEntry = [&](GlobalVariable *Table, ArrayType *TableTy,
+                           Type *PtrTy, unsigned Field) {
+    Constant *Indices[] = {ConstantInt::get(Int32Ty, 0),
+                           ConstantInt::get(Int32Ty, Field)};
+    return ConstantExpr::getPointerCast(
+        ConstantExpr::getInBoundsGetElementPtr(TableTy, Table, Indices),
+        PtrTy);
+  };
+
+  for (auto &StructTy : Structs) {
     // StructName.
     SmallString<MaxStructCounterNameSize> CounterNameStr;
     createStructCounterName(StructTy, CounterNameStr);
@@ -365,43 +438,22 @@ GlobalVariable *EfficiencySanitizer::createCacheFragInfoGV(
     // Remember the counter variable for each struct type.
     StructTyMap.insert(std::pair<Type *, GlobalVariable *>(StructTy, Counters));
 
-    // We pass the field type name array and offset array to the runtime for
-    // better reporting.
-    // FieldTypeNames.
-    auto *TypeNameArrayTy = ArrayType::get(Int8PtrTy, StructTy->getNumElements());
-    GlobalVariable *TypeNames =
-      new GlobalVariable(M, TypeNameArrayTy, true,
-                         GlobalVariable::InternalLinkage, nullptr);
-    SmallVector<Constant *, 16> TypeNameVec;
-    // FieldOffsets.
+    unsigned FirstField = TypeNameVec.size();
     const StructLayout *SL = DL.getStructLayout(StructTy);
-    auto *OffsetArrayTy = ArrayType::get(Int32Ty, StructTy->getNumElements());
-    GlobalVariable *Offsets =
-      new GlobalVariable(M, OffsetArrayTy, true,
-                         GlobalVariable::InternalLinkage, nullptr);
-    SmallVector<Constant *, 16> OffsetVec;
-    // FieldSize
-    auto *SizeArrayTy = ArrayType::get(Int32Ty, StructTy->getNumElements());
-    GlobalVariable *Size =
-      new GlobalVariable(M, SizeArrayTy, true,
-                         GlobalVariable::InternalLinkage, nullptr);
-    SmallVector<Constant *, 16> SizeVec;
     for (unsigned i = 0; i < StructTy->getNumElements(); ++i) {
       Type *Ty = StructTy->getElementType(i);
       std::string Str;
       raw_string_ostream StrOS(Str);
       Ty->print(StrOS);
-      TypeNameVec.push_back(
-          ConstantExpr::getPointerCast(
-              createPrivateGlobalForString(M, StrOS.str(), true),
-              Int8PtrTy));
+      Constant *&TypeName = TypeNameStrings[StrOS.str()];
+      if (!TypeName)
+        TypeName = ConstantExpr::getPointerCast(
+            createPrivateGlobalForString(M, StrOS.str(), true), Int8PtrTy);
+      TypeNameVec.push_back(TypeName);
       OffsetVec.push_back(ConstantInt::get(Int32Ty, SL->getElementOffset(i)));
       SizeVec.push_back(ConstantInt::get(Int32Ty,
                                          DL.getTypeAllocSize(Ty)));
     }
-    TypeNames->setInitializer(ConstantArray::get(TypeNameArrayTy, TypeNameVec));
-    Offsets->setInitializer(ConstantArray::get(OffsetArrayTy, OffsetVec));
-    Size->setInitializer(ConstantArray::get(SizeArrayTy, SizeVec));
 
     Initializers.push_back(
         ConstantStruct::get(
@@ -409,12 +461,16 @@ GlobalVariable *EfficiencySanitizer::createCacheFragInfoGV(
             ConstantExpr::getPointerCast(StructCounterName, Int8PtrTy),
             ConstantInt::get(Int32Ty, SL->getSizeInBytes()),
             ConstantInt::get(Int32Ty, StructTy->getNumElements()),
-            ConstantExpr::getPointerCast(Offsets, Int32PtrTy),
-            ConstantExpr::getPointerCast(Size, Int32PtrTy),
+            getFieldEntry(Offsets, OffsetArrayTy, Int32PtrTy, FirstField),
+            getFieldEntry(Sizes, SizeArrayTy, Int32PtrTy, FirstField),
             ConstantExpr::getPointerCast(Counters, Int64PtrTy),
-            ConstantExpr::getPointerCast(TypeNames, Int8PtrPtrTy),
+            getFieldEntry(TypeNames, TypeNameArrayTy, Int8PtrPtrTy,
+                          FirstField),
             nullptr));
   }
+  TypeNames->setInitializer(ConstantArray::get(TypeNameArrayTy, TypeNameVec));
+  Offsets->setInitializer(ConstantArray::get(OffsetArrayTy, OffsetVec));
+  Sizes->setInitializer(ConstantArray::get(SizeArrayTy, SizeVec));
   // Structs.
   Constant *StructInfo;
   if (NumStructs == 0) {
@@ -505,6 +561,13 @@ bool EfficiencySanitizer::initOnModule(Module &M) {
                                       static_cast<int>(Options.ToolType)),
                      EsanWhichToolName);
 
+  SampleCountdown = nullptr;
+  if (ClSampleRate > 1)
+    SampleCountdown = new GlobalVariable(
+        M, OrdTy, false, GlobalValue::WeakAnyLinkage,
+        ConstantInt::get(OrdTy, 0), EsanSampleCountdownName, nullptr,
+        GlobalVariable::InitialExecTLSModel);
+
   return true;
 }
 
@@ -523,15 +586,45 @@ Value *EfficiencySanitizer::appToShadow(Value *Shadow, IRBuilder<> &IRB) {
   return Shadow;
 }
 
-bool EfficiencySanitizer::shouldIgnoreMemoryAccess(Instruction *I) {
+static Value *getMemoryAccessAddress(Instruction *I) {
+  if (LoadInst *Load = dyn_cast<LoadInst>(I))
+    return Load->getPointerOperand();
+  if (StoreInst *Store = dyn_cast<StoreInst>(I))
+    return Store->getPointerOperand();
+  if (AtomicRMWInst *RMW = dyn_cast<AtomicRMWInst>(I))
+    return RMW->getPointerOperand();
+  if (AtomicCmpXchgInst *Xchg = dyn_cast<AtomicCmpXchgInst>(I))
+    return Xchg->getPointerOperand();
+  llvm_unreachable("Unsupported mem access type");
+}
+
+bool EfficiencySanitizer::isNonEscapingStackAccess(Value *Addr,
+                                                   const DataLayout &DL) {
+  const AllocaInst *Alloca =
+      dyn_cast<AllocaInst>(GetUnderlyingObject(Addr, DL));
+  if (!Alloca)
+    return false;
+  auto It = NonEscapingAllocas.find(Alloca);
+  if (It != NonEscapingAllocas.end())
+    return It->second;
+  bool NonEscaping = !PointerMayBeCaptured(Alloca, /*ReturnCaptures=*/true,
+                                           /*StoreCaptures=*/true);
+  NonEscapingAllocas[Alloca] = NonEscaping;
+  return NonEscaping;
+}
+
+bool EfficiencySanitizer::shouldIgnoreMemoryAccess(Instruction *I,
+                                                   const DataLayout &DL) {
   if (Options.ToolType == EfficiencySanitizerOptions::ESAN_CacheFrag) {
     // We'd like to know about cache fragmentation in vtable accesses and
     // constant data references, so we do not currently ignore anything.
     return false;
   } else if (Options.ToolType == EfficiencySanitizerOptions::ESAN_WorkingSet) {
-    // TODO: the instrumentation disturbs the data layout on the stack, so we
-    // may want to add an option to ignore stack references (if we can
-    // distinguish them) to reduce overhead.
+    if (ClIgnoreNonEscapingStack &&
+        isNonEscapingStackAccess(getMemoryAccessAddress(I), DL)) {
+      ++NumIgnoredStackAccesses;
+      return true;
+    }
   }
   // TODO(bruening): future tools will be returning true for some cases.
   return false;
@@ -558,12 +651,13 @@ bool EfficiencySanitizer::runOnFunction(Function &F, Module &M) {
   const DataLayout &DL = M.getDataLayout();
   const TargetLibraryInfo *TLI =
       &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
+  NonEscapingAllocas.clear();
 
   for (auto &BB : F) {
     for (auto &Inst : BB) {
       if ((isa<LoadInst>(Inst) || isa<StoreInst>(Inst) ||
            isa<AtomicRMWInst>(Inst) || isa<AtomicCmpXchgInst>(Inst)) &&
-          !shouldIgnoreMemoryAccess(&Inst))
+          !shouldIgnoreMemoryAccess(&Inst, DL))
         LoadsAndStores.push_back(&Inst);
       else if (isa<MemIntrinsic>(Inst))
         MemIntrinCalls.push_back(&Inst);
@@ -587,17 +681,50 @@ bool EfficiencySanitizer::runOnFunction(Function &F, Module &M) {
   }
 
   if (Options.ToolType == EfficiencySanitizerOptions::ESAN_CacheFrag) {
+    // The accesses to each field within a basic block are summed up, so that
+    // each field counter is updated at most once per block.
+    CounterIncrementMap Increments;
+    BasicBlock *BB = nullptr;
     for (auto Inst : GetElementPtrs) {
-      Res |= instrumentGetElementPtr(Inst, M);
+      if (Inst->getParent() != BB) {
+        Res |= emitCounterIncrements(Increments);
+        BB = Inst->getParent();
+      }
+      instrumentGetElementPtr(Inst, M, Increments);
     }
+    Res |= emitCounterIncrements(Increments);
   }
 
   return Res;
 }
 
+// Insert the sampling countdown before I, and return the instruction before
+// which the instrumentation of I goes: I itself when every access is
+// instrumented, or the end of a block that only runs for sampled accesses.
+Instruction *EfficiencySanitizer::insertSampleCheck(Instruction *I) {
+  if (!SampleCountdown)
+    return I;
+  IRBuilder<> IRB(I);
+  // We generate the following code:
+  //
+  //   int Old = SampleCountdown;
+  //   SampleCountdown = Old == 0 ? SampleRate - 1 : Old - 1;
+  //   if (Old == 0)
+  //     <instrumentation>
+  //
+  Type *CountdownTy = SampleCountdown->getValueType();
+  Value *Old = IRB.CreateLoad(SampleCountdown);
+  Value *Take = IRB.CreateICmpEQ(Old, ConstantInt::get(CountdownTy, 0));
+  Value *New =
+      IRB.CreateSelect(Take, ConstantInt::get(CountdownTy, ClSampleRate - 1),
+                       IRB.CreateSub(Old, ConstantInt::get(CountdownTy, 1)));
+  IRB.CreateStore(New, SampleCountdown);
+  ++NumSampledAccesses;
+  return SplitBlockAndInsertIfThen(Take, I, false);
+}
+
 bool EfficiencySanitizer::instrumentLoadOrStore(Instruction *I,
                                                 const DataLayout &DL) {
-  IRBuilder<> IRB(I);
   bool IsStore;
   Value *Addr;
   unsigned Alignment;
@@ -632,6 +759,8 @@ bool EfficiencySanitizer::instrumentLoadOrStore(Instruction *I,
     NumInstrumentedStores++;
   else
     NumInstrumentedLoads++;
+  Instruction *InsertBefore = insertSampleCheck(I);
+  IRBuilder<> IRB(InsertBefore);
   int Idx = getMemoryAccessFuncIndex(Addr, DL);
   if (Idx < 0) {
     OnAccessFunc = IsStore ? EsanUnalignedStoreN : EsanUnalignedLoadN;
@@ -640,7 +769,7 @@ bool EfficiencySanitizer::instrumentLoadOrStore(Instruction *I,
                     ConstantInt::get(IntptrTy, TypeSizeBytes)});
   } else {
     if (ClInstrumentFastpath &&
-        instrumentFastpath(I, DL, IsStore, Addr, Alignment)) {
+        instrumentFastpath(InsertBefore, DL, IsStore, Addr, Alignment)) {
       NumFastpaths++;
       return true;
     }
@@ -681,7 +810,8 @@ bool EfficiencySanitizer::instrumentMemIntrinsic(MemIntrinsic *MI) {
   return Res;
 }
 
-bool EfficiencySanitizer::instrumentGetElementPtr(Instruction *I, Module &M) {
+bool EfficiencySanitizer::instrumentGetElementPtr(
+    Instruction *I, Module &M, CounterIncrementMap &Increments) {
   GetElementPtrInst *GepInst = dyn_cast<GetElementPtrInst>(I);
   bool Res = false;
   if (GepInst == nullptr || GepInst->getNumIndices() == 1) {
@@ -706,7 +836,7 @@ bool EfficiencySanitizer::instrumentGetElementPtr(Instruction *I, Module &M) {
     GlobalVariable *CounterArray = StructTyMap[StructTy];
     if (CounterArray == nullptr)
       return false;
-    IRBuilder<> IRB(I);
+    IRBuilder<> IRB(I->getContext());
     Constant *Indices[2];
     // Xref http://llvm.org/docs/LangRef.html#i-getelementptr and
     // http://llvm.org/docs/GetElementPtr.html.
@@ -719,9 +849,10 @@ bool EfficiencySanitizer::instrumentGetElementPtr(Instruction *I, Module &M) {
         ConstantExpr::getGetElementPtr(
             ArrayType::get(IRB.getInt64Ty(), StructTy->getNumElements()),
             CounterArray, Indices);
-    Value *Load = IRB.CreateLoad(Counter);
-    IRB.CreateStore(IRB.CreateAdd(Load, ConstantInt::get(IRB.getInt64Ty(), 1)),
-                    Counter);
+    auto &Increment = Increments[Counter];
+    if (!Increment.first)
+      Increment.first = I;
+    ++Increment.second;
     Res = true;
   }
   if (Res)
@@ -731,6 +862,22 @@ bool EfficiencySanitizer::instrumentGetElementPtr(Instruction *I, Module &M) {
   return Res;
 }
 
+bool EfficiencySanitizer::emitCounterIncrements(
+    CounterIncrementMap &Increments) {
+  for (auto &Increment : Increments) {
+    Constant *Counter = Increment.first;
+    IRBuilder<> IRB(Increment.second.first);
+    Value *Load = IRB.CreateLoad(Counter);
+    IRB.CreateStore(
+        IRB.CreateAdd(Load, ConstantInt::get(IRB.getInt64Ty(),
+                                             Increment.second.second)),
+        Counter);
+  }
+  bool Res = !Increments.empty();
+  Increments.clear();
+  return Res;
+}
+
 int EfficiencySanitizer::getMemoryAccessFuncIndex(Value *Addr,
                                                   const DataLayout &DL) {
   Type *OrigPtrTy = Addr->getType();
@@ -15,11 +15,14 @@
 
 #include "llvm/Transforms/InstrProfiling.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
 #include "llvm/ProfileData/InstrProf.h"
 #include "llvm/Transforms/Utils/ModuleUtils.h"
+#include "llvm/Transforms/Utils/SSAUpdater.h"
 
 using namespace llvm;
 
@@ -45,6 +48,22 @@ cl::opt<double> NumCountersPerValueSite(
     // is usually smaller than 2.
     cl::init(1.0));
 
+cl::opt<bool> DoCounterPromotion(
+    "do-counter-promotion", cl::ZeroOrMore,
+    cl::desc("Keep profile counters in registers inside loops"),
+    cl::init(false));
+cl::opt<bool> AtomicCounterUpdateAll(
+    "instrprof-atomic-counter-update-all", cl::ZeroOrMore,
+    cl::desc("Update profile counters in memory with atomic instructions"),
+    cl::init(false));
+cl::opt<unsigned> MaxNumOfPromotionsPerLoop(
+    "max-counter-promotions-per-loop", cl::init(20),
+    cl::desc("Maximum number of counters promoted to registers in a loop"));
+cl::opt<bool> IterativeCounterPromotion(
+    "iterative-counter-promotion", cl::init(true),
+    cl::desc("Promote the counter updates on the exits of an inner loop again "
+             "in the enclosing loop"));
+
 class InstrProfilingLegacyPass : public ModulePass {
   InstrProfiling InstrProf;
 
@@ -64,6 +83,40 @@ public:
   }
 };
 
+typedef std::pair<LoadInst *, StoreInst *> LoadStorePair;
+
+/// Promotes the counter updated by a load and store in a loop to a register.
+/// The register starts at zero in the loop preheader, and is added to the
+/// counter in memory in each of the loop exit blocks.
+class PGOCounterPromoterHelper : public LoadAndStorePromoter {
+public:
+  PGOCounterPromoterHelper(LoadInst *L, StoreInst *S, SSAUpdater &SSA,
+                           BasicBlock *PH, ArrayRef<BasicBlock *> ExitBlocks,
+                           std::vector<LoadStorePair> &ExitUpdates)
+      : LoadAndStorePromoter({L, S}, SSA), Store(S), ExitBlocks(ExitBlocks),
+        ExitUpdates(ExitUpdates) {
+    SSA.AddAvailableValue(PH, ConstantInt::get(L->getType(), 0));
+  }
+
+  void doExtraRewritesBeforeFinalDeletion() const override {
+    Value *Addr = Store->getPointerOperand();
+    for (BasicBlock *ExitBlock : ExitBlocks) {
+      // With more than one predecessor, this is a PHI in the exit block.
+      Value *LiveInValue = SSA.GetValueInMiddleOfBlock(ExitBlock);
+      IRBuilder<> Builder(&*ExitBlock->getFirstInsertionPt());
+      LoadInst *OldVal = Builder.CreateLoad(Addr, "pgocount.promoted");
+      Value *NewVal = Builder.CreateAdd(OldVal, LiveInValue);
+      ExitUpdates.push_back(
+          LoadStorePair(OldVal, Builder.CreateStore(NewVal, Addr)));
+    }
+  }
+
+private:
+  StoreInst *Store;
+  ArrayRef<BasicBlock *> ExitBlocks;
+  std::vector<LoadStorePair> &ExitUpdates;
+};
+
 } // anonymous namespace
 
 PreservedAnalyses InstrProfiling::run(Module &M, AnalysisManager<Module> &AM) {
@@ -87,6 +140,16 @@ bool InstrProfiling::isMachO() const {
   return Triple(M->getTargetTriple()).isOSBinFormatMachO();
 }
 
+bool InstrProfiling::isCounterPromotionEnabled() const {
+  if (DoCounterPromotion.getNumOccurrences() > 0)
+    return DoCounterPromotion;
+  return Options.DoCounterPromotion;
+}
+
+bool InstrProfiling::isAtomic() const {
+  return AtomicCounterUpdateAll || Options.Atomic;
+}
+
 /// Get the section name for the counter variables.
 StringRef InstrProfiling::getCountersSection() const {
   return getInstrProfCountersSectionName(isMachO());
@@ -135,17 +198,7 @@ bool InstrProfiling::run(Module &M) {
   }
 
   for (Function &F : M)
-    for (BasicBlock &BB : F)
-      for (auto I = BB.begin(), E = BB.end(); I != E;) {
-        auto Instr = I++;
-        if (auto *Inc = dyn_cast<InstrProfIncrementInst>(Instr)) {
-          lowerIncrement(Inc);
-          MadeChange = true;
-        } else if (auto *Ind = dyn_cast<InstrProfValueProfileInst>(Instr)) {
-          lowerValueProfileInst(Ind);
-          MadeChange = true;
-        }
-      }
+    MadeChange |= lowerIntrinsics(&F);
 
   if (GlobalVariable *CoverageNamesVar =
           M.getNamedGlobal(getCoverageUnusedNamesVarName())) {
@@ -165,6 +218,131 @@ bool InstrProfiling::run(Module &M) {
   return true;
 }
 
+bool InstrProfiling::lowerIntrinsics(Function *F) {
+  bool MadeChange = false;
+  PromotionCandidates.clear();
+  for (BasicBlock &BB : *F)
+    for (auto I = BB.begin(), E = BB.end(); I != E;) {
+      auto Instr = I++;
+      if (auto *Inc = dyn_cast<InstrProfIncrementInst>(Instr)) {
+        lowerIncrement(Inc);
+        MadeChange = true;
+      } else if (auto *Ind = dyn_cast<InstrProfValueProfileInst>(Instr)) {
+        lowerValueProfileInst(Ind);
+        MadeChange = true;
+      }
+    }
+
+  if (!MadeChange)
+    return false;
+
+  promoteCounterLoadStores(F);
+  return true;
+}
+
+/// Add the loops nested in L, innermost first, and then L itself to Loops.
+static void collectLoopsInnermostFirst(Loop *L,
+                                       SmallVectorImpl<Loop *> &Loops) {
+  for (Loop *SubL : *L)
+    collectLoopsInnermostFirst(SubL, Loops);
+  Loops.push_back(L);
+}
+
+/// Return true if the counter updates in L can be moved to its exits.
+static bool isPromotionPossible(Loop *L,
+                                const SmallVectorImpl<BasicBlock *> &Exits) {
+  if (!L->getLoopPreheader() || !L->hasDedicatedExits())
+    return false;
+  // Some EH pads, like catchswitch, have nowhere to put the update.
+  for (BasicBlock *Exit : Exits)
+    if (Exit->getFirstInsertionPt() == Exit->end())
+      return false;
+  return true;
+}
+
+/// Replace a counter load, add and store with an atomic add.
+static void makeCounterUpdateAtomic(LoadStorePair Update) {
+  LoadInst *Load = Update.first;
+  StoreInst *Store = Update.second;
+  auto *Add = cast<BinaryOperator>(Store->getValueOperand());
+  assert(Add->getOperand(0) == Load && "Not a counter update");
+  IRBuilder<> Builder(Store);
+  Builder.CreateAtomicRMW(AtomicRMWInst::Add, Store->getPointerOperand(),
+                          Add->getOperand(1), AtomicOrdering::Monotonic);
+  Store->eraseFromParent();
+  Add->eraseFromParent();
+  Load->eraseFromParent();
+}
+
+void InstrProfiling::promoteCounterLoadStores(Function *F) {
+  if (!isCounterPromotionEnabled() || PromotionCandidates.empty())
+    return;
+
+  DominatorTree DT(*F);
+  LoopInfo LI(DT);
+
+  // Updates that stay in memory, because they are not in a loop or their loop
+  // can't be promoted.
+  std::vector<LoadStorePair> Unpromoted;
+  DenseMap<Loop *, std::vector<LoadStorePair>> LoopToCandidates;
+  auto AddCandidate = [&](LoadStorePair Update) {
+    if (Loop *L = LI.getLoopFor(Update.first->getParent()))
+      LoopToCandidates[L].push_back(Update);
+    else
+      Unpromoted.push_back(Update);
+  };
+  for (const auto &Update : PromotionCandidates)
+    AddCandidate(Update);
+  PromotionCandidates.clear();
+
+  // Visit inner loops first, so that the updates put on the exits of a loop can
+  // be promoted again in the loop around it.
+  SmallVector<Loop *, 8> Loops;
+  for (Loop *L : LI)
+    collectLoopsInnermostFirst(L, Loops);
+
+  for (Loop *L : Loops) {
+    auto I = LoopToCandidates.find(L);
+    if (I == LoopToCandidates.end())
+      continue;
+    std::vector<LoadStorePair> Candidates = std::move(I->second);
+    LoopToCandidates.erase(I);
+
+    SmallVector<BasicBlock *, 8> ExitBlocks;
+    L->getExitBlocks(ExitBlocks);
+    unsigned NumPromoted = 0;
+    if (isPromotionPossible(L, ExitBlocks)) {
+      BasicBlock *PH = L->getLoopPreheader();
+      for (const auto &Cand : Candidates) {
+        if (NumPromoted == MaxNumOfPromotionsPerLoop)
+          break;
+        std::vector<LoadStorePair> ExitUpdates;
+        SmallVector<PHINode *, 4> NewPHIs;
+        SSAUpdater SSA(&NewPHIs);
+        PGOCounterPromoterHelper Promoter(Cand.first, Cand.second, SSA, PH,
+                                          ExitBlocks, ExitUpdates);
+        SmallVector<Instruction *, 2> Insts;
+        Insts.push_back(Cand.first);
+        Insts.push_back(Cand.second);
+        Promoter.run(Insts);
+        ++NumPromoted;
+
+        for (const auto &Update : ExitUpdates)
+          if (IterativeCounterPromotion)
+            AddCandidate(Update);
+          else
+            Unpromoted.push_back(Update);
+      }
+    }
+    Unpromoted.insert(Unpromoted.end(), Candidates.begin() + NumPromoted,
+                      Candidates.end());
+  }
+
+  if (isAtomic())
+    for (const auto &Update : Unpromoted)
+      makeCounterUpdateAtomic(Update);
+}
+
 static Constant *getOrInsertValueProfilingCall(Module &M) {
   LLVMContext &Ctx = M.getContext();
   auto *ReturnTy = Type::getVoidTy(M.getContext());
@@ -220,9 +398,16 @@ void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
   IRBuilder<> Builder(Inc);
   uint64_t Index = Inc->getIndex()->getZExtValue();
   Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters, 0, Index);
-  Value *Count = Builder.CreateLoad(Addr, "pgocount");
-  Count = Builder.CreateAdd(Count, Builder.getInt64(1));
-  Inc->replaceAllUsesWith(Builder.CreateStore(Count, Addr));
+  if (isAtomic() && !isCounterPromotionEnabled()) {
+    Builder.CreateAtomicRMW(AtomicRMWInst::Add, Addr, Builder.getInt64(1),
+                            AtomicOrdering::Monotonic);
+  } else {
+    LoadInst *Load = Builder.CreateLoad(Addr, "pgocount");
+    Value *Count = Builder.CreateAdd(Load, Builder.getInt64(1));
+    StoreInst *Store = Builder.CreateStore(Count, Addr);
+    if (isCounterPromotionEnabled())
+      PromotionCandidates.push_back(std::make_pair(Load, Store));
+  }
   Inc->eraseFromParent();
 }
 
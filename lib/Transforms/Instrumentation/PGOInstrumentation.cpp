@@ -61,6 +61,7 @@
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/InstIterator.h"
+#include "llvm/IR/InstVisitor.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/MDBuilder.h"
@@ -90,6 +91,7 @@ STATISTIC(NumOfPGOFunc, "Number of functions having valid profile counts.");
 STATISTIC(NumOfPGOMismatch, "Number of functions having mismatch profile.");
 STATISTIC(NumOfPGOMissing, "Number of functions without profile.");
 STATISTIC(NumOfPGOICall, "Number of indirect call value instrumentations.");
+STATISTIC(NumOfPGOMemOP, "Number of memory intrinsic size instrumentations.");
 
 // Command line option to specify the file to read profile from. This is
 // mainly used for testing.
@@ -112,6 +114,12 @@ static cl::opt<unsigned> MaxNumAnnotations(
     cl::desc("Max number of annotations for a single indirect "
              "call callsite"));
 
+// Command line option to enable/disable the profiling of the length of memory
+// intrinsic calls. It has no effect when value profiling is disabled.
+static cl::opt<bool>
+    PGOInstrMemOP("pgo-instr-memop", cl::init(true), cl::Hidden,
+                  cl::desc("Profile the size of memory intrinsic calls"));
+
 // Command line option to enable/disable the warning about missing profile
 // information.
 static cl::opt<bool> NoPGOWarnMissing("no-pgo-warn-missing", cl::init(false),
@@ -122,6 +130,26 @@ static cl::opt<bool> NoPGOWarnMissing("no-pgo-warn-missing", cl::init(false),
 static cl::opt<bool> NoPGOWarnMismatch("no-pgo-warn-mismatch", cl::init(false),
                                        cl::Hidden);
 
+namespace {
+// Visitor class that finds the memory intrinsic calls with a variable length,
+// whose length is value profiled.
+struct MemIntrinsicVisitor : public InstVisitor<MemIntrinsicVisitor> {
+  std::vector<Instruction *> MemIntrinsics;
+
+  void visitMemIntrinsic(MemIntrinsic &MI) {
+    if (!isa<ConstantInt>(MI.getLength()))
+      MemIntrinsics.push_back(&MI);
+  }
+};
+} // end anonymous namespace
+
+// Helper function that finds the memory intrinsic calls to value profile.
+static std::vector<Instruction *> findMemIntrinsicSites(Function &F) {
+  MemIntrinsicVisitor MIV;
+  MIV.visit(F);
+  return MIV.MemIntrinsics;
+}
+
 namespace {
 class PGOInstrumentationGenLegacyPass : public ModulePass {
 public:
@@ -330,8 +358,11 @@ BasicBlock *FuncPGOInstrumentation<Edge, BBInfo>::getInstrBB(Edge *E) {
   NumOfPGOSplit++;
   DEBUG(dbgs() << "Split critical edge: " << getBBInfo(SrcBB).Index << " --> "
                << getBBInfo(DestBB).Index << "\n");
+  // The edge stands for all the identical edges from SrcBB to DestBB, so move
+  // all of them to the new block.
   unsigned SuccNum = GetSuccessorNumber(SrcBB, DestBB);
-  BasicBlock *InstrBB = SplitCriticalEdge(TI, SuccNum);
+  BasicBlock *InstrBB = SplitCriticalEdge(
+      TI, SuccNum, CriticalEdgeSplittingOptions().setMergeIdenticalEdges());
   assert(InstrBB && "Critical edge is not split");
 
   E->Removed = true;
@@ -388,6 +419,25 @@ static void instrumentOneFunc(Function &F, Module *M,
          Builder.getInt32(NumIndirectCallSites++)});
   }
   NumOfPGOICall += NumIndirectCallSites;
+
+  if (!PGOInstrMemOP)
+    return;
+
+  unsigned NumMemOPSites = 0;
+  for (auto *I : findMemIntrinsicSites(F)) {
+    auto *MI = cast<MemIntrinsic>(I);
+    DEBUG(dbgs() << "Instrument one memory intrinsic: Site Index = "
+                 << NumMemOPSites << "\n");
+    IRBuilder<> Builder(MI);
+    Builder.CreateCall(
+        Intrinsic::getDeclaration(M, Intrinsic::instrprof_value_profile),
+        {llvm::ConstantExpr::getBitCast(FuncInfo.FuncNameVar, I8PtrTy),
+         Builder.getInt64(FuncInfo.FunctionHash),
+         Builder.CreateZExtOrTrunc(MI->getLength(), Builder.getInt64Ty()),
+         Builder.getInt32(llvm::InstrProfValueKind::IPVK_MemOPSize),
+         Builder.getInt32(NumMemOPSites++)});
+  }
+  NumOfPGOMemOP += NumMemOPSites;
 }
 
 // This class represents a CFG edge in profile use compilation.
@@ -470,8 +520,12 @@ public:
   // Set the branch weights based on the count values.
   void setBranchWeights();
 
-  // Annotate the indirect call sites.
-  void annotateIndirectCallSites();
+  // Annotate the indirect call sites and the memory intrinsic calls with
+  // their value profile.
+  void annotateValueSites();
+
+  // Annotate the value sites of the given kind.
+  void annotateValueSites(uint32_t Kind, ArrayRef<Instruction *> Sites);
 
   // The hotness of the function from the profile count.
   enum FuncFreqAttr { FFA_Normal, FFA_Cold, FFA_Hot };
@@ -722,8 +776,10 @@ void PGOUseFunc::setBranchWeights() {
 
     // We have a non-zero Branch BB.
     const UseBBInfo &BBCountInfo = getBBInfo(&BB);
+    // Identical edges share one out edge, whose count goes to the first of
+    // their successor numbers.
     unsigned Size = BBCountInfo.OutEdges.size();
-    SmallVector<unsigned, 2> EdgeCounts(Size, 0);
+    SmallVector<unsigned, 2> EdgeCounts(TI->getNumSuccessors(), 0);
     uint64_t MaxCount = 0;
     for (unsigned s = 0; s < Size; s++) {
       const PGOUseEdge *E = BBCountInfo.OutEdges[s];
@@ -751,21 +807,31 @@ void PGOUseFunc::setBranchWeights() {
   }
 }
 
-// Traverse all the indirect callsites and annotate the instructions.
-void PGOUseFunc::annotateIndirectCallSites() {
+// Traverse all the value sites and annotate the instructions.
+void PGOUseFunc::annotateValueSites() {
   if (DisableValueProfiling)
     return;
 
   // Create the PGOFuncName meta data.
   createPGOFuncNameMetadata(F, FuncInfo.FuncName);
 
-  unsigned IndirectCallSiteIndex = 0;
-  auto IndirectCallSites = findIndirectCallSites(F);
-  unsigned NumValueSites =
-      ProfileRecord.getNumValueSites(IPVK_IndirectCallTarget);
-  if (NumValueSites != IndirectCallSites.size()) {
+  annotateValueSites(IPVK_IndirectCallTarget, findIndirectCallSites(F));
+  if (PGOInstrMemOP)
+    annotateValueSites(IPVK_MemOPSize, findMemIntrinsicSites(F));
+}
+
+void PGOUseFunc::annotateValueSites(uint32_t Kind,
+                                    ArrayRef<Instruction *> Sites) {
+  unsigned NumValueSites = ProfileRecord.getNumValueSites(Kind);
+  // Profiles collected before the memory intrinsic sizes were profiled have
+  // no sites for them.
+  if (Kind == IPVK_MemOPSize && NumValueSites == 0)
+    return;
+  if (NumValueSites != Sites.size()) {
     std::string Msg =
-        std::string("Inconsistent number of indirect call sites: ") +
+        std::string(Kind == IPVK_IndirectCallTarget
+                        ? "Inconsistent number of indirect call sites: "
+                        : "Inconsistent number of memory intrinsic sites: ") +
         F.getName().str();
     auto &Ctx = M->getContext();
     Ctx.diagnose(
@@ -773,13 +839,14 @@ void PGOUseFunc::annotateIndirectCallSites() {
     return;
   }
 
-  for (auto &I : IndirectCallSites) {
-    DEBUG(dbgs() << "Read one indirect call instrumentation: Index="
-                 << IndirectCallSiteIndex << " out of " << NumValueSites
+  unsigned SiteIndex = 0;
+  for (auto &I : Sites) {
+    DEBUG(dbgs() << "Read one value site profile (Kind = " << Kind
+                 << "): Index = " << SiteIndex << " out of " << NumValueSites
                  << "\n");
-    annotateValueSite(*M, *I, ProfileRecord, IPVK_IndirectCallTarget,
-                      IndirectCallSiteIndex, MaxNumAnnotations);
-    IndirectCallSiteIndex++;
+    annotateValueSite(*M, *I, ProfileRecord, (InstrProfValueKind)Kind,
+                      SiteIndex, MaxNumAnnotations);
+    SiteIndex++;
   }
 }
 } // end anonymous namespace
@@ -877,6 +944,15 @@ static bool annotateAllFunctions(
     return false;
   }
 
+  // Page in the profile entries of every function we are about to look up in
+  // file order, rather than in module order.
+  std::vector<std::string> FuncNames;
+  for (auto &F : M)
+    if (!F.isDeclaration())
+      FuncNames.push_back(getPGOFuncName(F));
+  std::vector<StringRef> FuncNameRefs(FuncNames.begin(), FuncNames.end());
+  PGOReader->prefetchRecords(FuncNameRefs);
+
   std::vector<Function *> HotFunctions;
   std::vector<Function *> ColdFunctions;
   for (auto &F : M) {
@@ -889,7 +965,7 @@ static bool annotateAllFunctions(
       continue;
     Func.populateCounters();
     Func.setBranchWeights();
-    Func.annotateIndirectCallSites();
+    Func.annotateValueSites();
     PGOUseFunc::FuncFreqAttr FreqAttr = Func.getFuncFreqAttr();
     if (FreqAttr == PGOUseFunc::FFA_Cold)
       ColdFunctions.push_back(&F);
@@ -0,0 +1,278 @@
+//===-- PGOMemOPSizeOpt.cpp - Optimizations based on value profiling ===//
+//
+//                      The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the transformation that optimizes memory intrinsics
+// such as memcpy using the size value profile. When memory intrinsic size
+// value profile metadata is available, a single memory intrinsic is expanded
+// to a sequence of guarded specialized versions that are called with the
+// hottest size(s), for later expansion into more optimal inline sequences.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstVisitor.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/Pass.h"
+#include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Instrumentation.h"
+#include "llvm/Transforms/PGOInstrumentation.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include <algorithm>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "pgo-memop-opt"
+
+STATISTIC(NumOfPGOMemOPOpt, "Number of memop intrinsics optimized.");
+STATISTIC(NumOfPGOMemOPAnnotate, "Number of memop intrinsics annotated.");
+
+// Command line option to disable the memory intrinsic optimization with the
+// default as false. This is for debug purpose.
+static cl::opt<bool>
+    DisableMemOPOPT("disable-memop-opt", cl::init(false), cl::Hidden,
+                    cl::desc("Disable size specialization of memory "
+                             "intrinsics"));
+
+// The minimum count for a size to be considered for the specialization.
+static cl::opt<unsigned>
+    MemOPCountThreshold("pgo-memop-count-threshold", cl::Hidden,
+                        cl::ZeroOrMore, cl::init(1000),
+                        cl::desc("The minimum count to optimize the memory "
+                                 "intrinsic for a size"));
+
+// The percent threshold for a size (this size vs the remaining count of the
+// memory intrinsic) for it to be considered for the specialization.
+static cl::opt<unsigned>
+    MemOPPercentThreshold("pgo-memop-percent-threshold", cl::init(40),
+                          cl::Hidden, cl::ZeroOrMore,
+                          cl::desc("The percentage threshold to optimize the "
+                                   "memory intrinsic for a size"));
+
+// Set the maximum number of specialized versions for a single memory
+// intrinsic.
+static cl::opt<unsigned>
+    MemOPMaxVersion("pgo-memop-max-version", cl::init(3), cl::Hidden,
+                    cl::ZeroOrMore,
+                    cl::desc("The max version for the optimized memory "
+                             "intrinsic"));
+
+namespace {
+class PGOMemOPSizeOptLegacyPass : public FunctionPass {
+public:
+  static char ID;
+
+  PGOMemOPSizeOptLegacyPass() : FunctionPass(ID) {
+    initializePGOMemOPSizeOptLegacyPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  const char *getPassName() const override { return "PGOMemOPSize"; }
+
+private:
+  bool runOnFunction(Function &F) override;
+};
+} // end anonymous namespace
+
+char PGOMemOPSizeOptLegacyPass::ID = 0;
+INITIALIZE_PASS(PGOMemOPSizeOptLegacyPass, "pgo-memop-opt",
+                "Optimize memory intrinsic using its size value profile",
+                false, false)
+
+FunctionPass *llvm::createPGOMemOPSizeOptLegacyPass() {
+  return new PGOMemOPSizeOptLegacyPass();
+}
+
+namespace {
+// The class that specializes the memory intrinsics of one function for their
+// hottest sizes.
+class MemOPSizeOpt : public InstVisitor<MemOPSizeOpt> {
+public:
+  MemOPSizeOpt(Function &Func) : Func(Func), Changed(false) {
+    ValueDataArray =
+        llvm::make_unique<InstrProfValueData[]>(MemOPMaxVersion + 2);
+  }
+
+  bool perform() {
+    WorkList.clear();
+    visit(Func);
+
+    for (auto &MI : WorkList) {
+      ++NumOfPGOMemOPAnnotate;
+      if (perform(MI))
+        Changed = true;
+    }
+    return Changed;
+  }
+
+  void visitMemIntrinsic(MemIntrinsic &MI) {
+    // Do not touch the memory intrinsics with a constant length.
+    if (isa<ConstantInt>(MI.getLength()))
+      return;
+    WorkList.push_back(&MI);
+  }
+
+private:
+  Function &Func;
+  bool Changed;
+  std::vector<MemIntrinsic *> WorkList;
+
+  // Allocate space to read the profile annotation.
+  std::unique_ptr<InstrProfValueData[]> ValueDataArray;
+
+  // Return true if a size with Count, out of the remaining TotalCount, is hot
+  // enough to get its own version.
+  bool isProfitable(uint64_t Count, uint64_t TotalCount) {
+    if (Count < MemOPCountThreshold || TotalCount == 0)
+      return false;
+    return Count * 100 / TotalCount >= MemOPPercentThreshold;
+  }
+
+  bool perform(MemIntrinsic *MI);
+};
+} // end anonymous namespace
+
+// Specialize MI for its hottest sizes. This transforms:
+//   BB:
+//     ...
+//     memcpy(Dst, Src, Len)
+//     ...
+// into:
+//   BB:
+//     ...
+//     switch Len, label %MemOP.Default [ Size1, label %MemOP.Case.Size1 ... ]
+//   MemOP.Case.Size1:
+//     memcpy(Dst, Src, Size1)
+//     br label %MemOP.Merge
+//   ...
+//   MemOP.Default:
+//     memcpy(Dst, Src, Len)
+//     br label %MemOP.Merge
+//   MemOP.Merge:
+//     ...
+// The branch weights of the switch come from the value profile, and the
+// default memory intrinsic keeps the profile of the sizes left out.
+bool MemOPSizeOpt::perform(MemIntrinsic *MI) {
+  uint32_t NumVals, MaxNumVals = MemOPMaxVersion + 2;
+  uint64_t TotalCount;
+  if (!getValueProfDataFromInst(*MI, IPVK_MemOPSize, MaxNumVals,
+                                ValueDataArray.get(), NumVals, TotalCount))
+    return false;
+
+  std::vector<InstrProfValueData> VDs(ValueDataArray.get(),
+                                      ValueDataArray.get() + NumVals);
+  std::stable_sort(VDs.begin(), VDs.end(),
+                   [](const InstrProfValueData &L,
+                      const InstrProfValueData &R) {
+                     return L.Count > R.Count;
+                   });
+
+  // Pick the sizes in the order of their count, and stop at the first one
+  // that isn't hot enough.
+  IntegerType *LenTy = cast<IntegerType>(MI->getLength()->getType());
+  uint64_t RemainCount = TotalCount;
+  unsigned NumVersions = 0;
+  for (auto &VD : VDs) {
+    if (NumVersions == MemOPMaxVersion || !isProfitable(VD.Count, RemainCount))
+      break;
+    // The length was zero extended to 64 bits when it was profiled.
+    if (!isUIntN(LenTy->getBitWidth(), VD.Value))
+      break;
+    RemainCount -= std::min(VD.Count, RemainCount);
+    ++NumVersions;
+  }
+  if (NumVersions == 0)
+    return false;
+
+  DEBUG(dbgs() << "Optimize one memory intrinsic call to " << NumVersions
+               << " sizes: " << *MI << "\n");
+
+  BasicBlock *BB = MI->getParent();
+  BasicBlock *DefaultBB = SplitBlock(BB, MI);
+  DefaultBB->setName("MemOP.Default");
+  BasicBlock *MergeBB = SplitBlock(DefaultBB, MI->getNextNode());
+  MergeBB->setName("MemOP.Merge");
+
+  // Replace the unconditional branch the splitting left in BB.
+  BB->getTerminator()->eraseFromParent();
+  SwitchInst *SI = SwitchInst::Create(MI->getLength(), DefaultBB, NumVersions,
+                                      BB);
+
+  uint64_t MaxCount = RemainCount;
+  for (unsigned I = 0; I != NumVersions; ++I)
+    MaxCount = std::max(MaxCount, VDs[I].Count);
+  uint64_t Scale = calculateCountScale(MaxCount);
+  SmallVector<uint32_t, 4> Weights;
+  Weights.push_back(scaleBranchCount(RemainCount, Scale));
+
+  LLVMContext &Ctx = Func.getContext();
+  for (unsigned I = 0; I != NumVersions; ++I) {
+    uint64_t Size = VDs[I].Value;
+    BasicBlock *CaseBB = BasicBlock::Create(
+        Ctx, Twine("MemOP.Case.") + Twine(Size), &Func, DefaultBB);
+    auto *C = cast<MemIntrinsic>(MI->clone());
+    C->setLength(ConstantInt::get(LenTy, Size));
+    C->setMetadata(LLVMContext::MD_prof, nullptr);
+    CaseBB->getInstList().push_back(C);
+    BranchInst::Create(MergeBB, CaseBB);
+    SI->addCase(ConstantInt::get(LenTy, Size), CaseBB);
+    Weights.push_back(scaleBranchCount(VDs[I].Count, Scale));
+    DEBUG(dbgs() << "  Size " << Size << " with count " << VDs[I].Count
+                 << "\n");
+  }
+  SI->setMetadata(LLVMContext::MD_prof,
+                  MDBuilder(Ctx).createBranchWeights(Weights));
+
+  // Keep the profile of the remaining sizes on the default version.
+  MI->setMetadata(LLVMContext::MD_prof, nullptr);
+  if (RemainCount != 0 && NumVersions < VDs.size())
+    annotateValueSite(*Func.getParent(), *MI,
+                      makeArrayRef(VDs).slice(NumVersions), RemainCount,
+                      IPVK_MemOPSize, NumVals);
+
+  emitOptimizationRemark(Ctx, DEBUG_TYPE, Func, MI->getDebugLoc(),
+                         Twine("Optimize memory intrinsic for ") +
+                             Twine(NumVersions) + " sizes out of " +
+                             Twine(TotalCount) + " calls");
+  ++NumOfPGOMemOPOpt;
+  return true;
+}
+
+static bool PGOMemOPSizeOptImpl(Function &F) {
+  if (DisableMemOPOPT)
+    return false;
+
+  if (F.hasFnAttribute(Attribute::OptimizeForSize))
+    return false;
+  MemOPSizeOpt Opt(F);
+  return Opt.perform();
+}
+
+bool PGOMemOPSizeOptLegacyPass::runOnFunction(Function &F) {
+  if (skipFunction(F))
+    return false;
+  return PGOMemOPSizeOptImpl(F);
+}
+
+PreservedAnalyses PGOMemOPSizeOpt::run(Function &F,
+                                       AnalysisManager<Function> &FAM) {
+  if (!PGOMemOPSizeOptImpl(F))
+    return PreservedAnalyses::all();
+  return PreservedAnalyses::none();
+}
@@ -26,6 +26,13 @@
 // it only tells if a given function (block) was ever executed. No counters.
 // But for many use cases this is what we need and the added slowdown small.
 //
+// With inline 8-bit counters every instrumented block increments its own byte
+// of a module array instead, with no guard and no call:
+//   Counters[Idx]++;
+// The module constructor passes the array to
+// __sanitizer_cov_8bit_counters_init, and optionally a table with the PC of
+// every instrumented block to __sanitizer_cov_pcs_init.
+//
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/ArrayRef.h"
@@ -69,6 +76,9 @@ static const char *const SanCovTraceBBName =
 static const char *const SanCovTracePCName = "__sanitizer_cov_trace_pc";
 static const char *const SanCovTraceCmpName = "__sanitizer_cov_trace_cmp";
 static const char *const SanCovTraceSwitchName = "__sanitizer_cov_trace_switch";
+static const char *const SanCov8bitCountersInitName =
+    "__sanitizer_cov_8bit_counters_init";
+static const char *const SanCovPCsInitName = "__sanitizer_cov_pcs_init";
 static const char *const SanCovModuleCtorName = "sancov.module_ctor";
 static const uint64_t SanCtorAndDtorPriority = 2;
 
@@ -116,6 +126,19 @@ static cl::opt<bool> ClUse8bitCounters("sanitizer-coverage-8bit-counters",
                                        cl::desc("Experimental 8-bit counters"),
                                        cl::Hidden, cl::init(false));
 
+// 8-bit counters incremented inline, in place of any guard or callback. They
+// are racy and wrap around like the ones above, but cost a single add.
+static cl::opt<bool> ClInline8bitCounters(
+    "sanitizer-coverage-inline-8bit-counters",
+    cl::desc("Increments 8-bit counters inline instead of calling back"),
+    cl::Hidden, cl::init(false));
+
+static cl::opt<bool>
+    ClCreatePCTable("sanitizer-coverage-pc-table",
+                    cl::desc("Create a table with the PC of each block with "
+                             "an inline 8-bit counter"),
+                    cl::Hidden, cl::init(false));
+
 namespace {
 
 SanitizerCoverageOptions getOptions(int LegacyCoverageLevel) {
@@ -150,6 +173,10 @@ SanitizerCoverageOptions OverrideFromCL(SanitizerCoverageOptions Options) {
   Options.TraceCmp |= ClExperimentalCMPTracing;
   Options.Use8bitCounters |= ClUse8bitCounters;
   Options.TracePC |= ClExperimentalTracePC;
+  Options.Inline8bitCounters |= ClInline8bitCounters;
+  Options.PCTable |= ClCreatePCTable;
+  // The table lists the blocks of the inline counters.
+  Options.PCTable &= Options.Inline8bitCounters;
   return Options;
 }
 
@@ -179,6 +206,9 @@ private:
   bool InjectCoverage(Function &F, ArrayRef<BasicBlock *> AllBlocks);
   void SetNoSanitizeMetadata(Instruction *I);
   void InjectCoverageAtBlock(Function &F, BasicBlock &BB, bool UseCalls);
+  void InjectInline8bitCounterAtBlock(Function &F, BasicBlock &BB,
+                                      IRBuilder<> &IRB);
+  void CreateInline8bitCountersCtor(Module &M);
   unsigned NumberOfInstrumentedBlocks() {
     return SanCovFunction->getNumUses() +
            SanCovWithCheckFunction->getNumUses() + SanCovTraceBB->getNumUses() +
@@ -198,6 +228,10 @@ private:
 
   GlobalVariable *GuardArray;
   GlobalVariable *EightBitCounterArray;
+  GlobalVariable *InlineCounterArray;
+  // The PC and flags of each inline counter, for the PC table.
+  SmallVector<Constant *, 32> PCTableEntries;
+  unsigned NumInline8bitCounters;
 
   SanitizerCoverageOptions Options;
 };
@@ -258,6 +292,12 @@ bool SanitizerCoverageModule::runOnModule(Module &M) {
     EightBitCounterArray =
         new GlobalVariable(M, Int8Ty, false, GlobalVariable::ExternalLinkage,
                            nullptr, "__sancov_gen_cov_tmp");
+  NumInline8bitCounters = 0;
+  PCTableEntries.clear();
+  if (Options.Inline8bitCounters)
+    InlineCounterArray =
+        new GlobalVariable(M, Int8Ty, false, GlobalVariable::ExternalLinkage,
+                           nullptr, "__sancov_gen_cov_tmp");
 
   for (auto &F : M)
     runOnFunction(F);
@@ -290,6 +330,9 @@ bool SanitizerCoverageModule::runOnModule(Module &M) {
     EightBitCounterArray->eraseFromParent();
   }
 
+  if (Options.Inline8bitCounters)
+    CreateInline8bitCountersCtor(M);
+
   // Create variable for module (compilation unit) name
   Constant *ModNameStrConst =
       ConstantDataArray::getString(M.getContext(), M.getName(), true);
@@ -297,7 +340,7 @@ bool SanitizerCoverageModule::runOnModule(Module &M) {
       new GlobalVariable(M, ModNameStrConst->getType(), true,
                          GlobalValue::PrivateLinkage, ModNameStrConst);
 
-  if (!Options.TracePC) {
+  if (!Options.TracePC && !Options.Inline8bitCounters) {
     Function *CtorFunc;
     std::tie(CtorFunc, std::ignore) = createSanitizerCtorAndInitFunctions(
         M, SanCovModuleCtorName, SanCovModuleInitName,
@@ -315,6 +358,53 @@ bool SanitizerCoverageModule::runOnModule(Module &M) {
   return true;
 }
 
+// Replace the dummy counter array with one of NumInline8bitCounters counters,
+// and register it, and the PC table, from a module constructor.
+void SanitizerCoverageModule::CreateInline8bitCountersCtor(Module &M) {
+  IRBuilder<> IRB(*C);
+  Type *Int8PtrTy = IRB.getInt8PtrTy();
+  unsigned N = NumInline8bitCounters;
+  if (N == 0) {
+    InlineCounterArray->eraseFromParent();
+    return;
+  }
+  Type *Int8ArrayNTy = ArrayType::get(IRB.getInt8Ty(), N);
+  GlobalVariable *Counters = new GlobalVariable(
+      M, Int8ArrayNTy, false, GlobalValue::PrivateLinkage,
+      Constant::getNullValue(Int8ArrayNTy), "__sancov_gen_8bit_counters");
+  InlineCounterArray->replaceAllUsesWith(
+      IRB.CreatePointerCast(Counters, Int8PtrTy));
+  InlineCounterArray->eraseFromParent();
+
+  Function *CtorFunc;
+  std::tie(CtorFunc, std::ignore) = createSanitizerCtorAndInitFunctions(
+      M, SanCovModuleCtorName, SanCov8bitCountersInitName,
+      {Int8PtrTy, Int8PtrTy},
+      {IRB.CreatePointerCast(Counters, Int8PtrTy),
+       IRB.CreatePointerCast(IRB.CreateConstGEP2_64(Counters, 0, N),
+                             Int8PtrTy)});
+
+  if (Options.PCTable) {
+    Type *IntptrPtrTy = PointerType::getUnqual(IntptrTy);
+    ArrayType *TableTy = ArrayType::get(IntptrTy, PCTableEntries.size());
+    GlobalVariable *PCTable = new GlobalVariable(
+        M, TableTy, true, GlobalValue::PrivateLinkage,
+        ConstantArray::get(TableTy, PCTableEntries), "__sancov_gen_pc_table");
+    PCTable->setAlignment(DL->getPointerSize());
+    Function *PCsInit = checkSanitizerInterfaceFunction(M.getOrInsertFunction(
+        SanCovPCsInitName, IRB.getVoidTy(), IntptrPtrTy, IntptrPtrTy,
+        nullptr));
+    IRB.SetInsertPoint(CtorFunc->getEntryBlock().getTerminator());
+    IRB.CreateCall(
+        PCsInit,
+        {IRB.CreatePointerCast(PCTable, IntptrPtrTy),
+         IRB.CreatePointerCast(
+             IRB.CreateConstGEP2_64(PCTable, 0, PCTableEntries.size()),
+             IntptrPtrTy)});
+  }
+  appendToGlobalCtors(M, CtorFunc, SanCtorAndDtorPriority);
+}
+
 // True if block has successors and it dominates all of them.
 static bool isFullDominator(const BasicBlock *BB, const DominatorTree *DT) {
   if (succ_begin(BB) == succ_end(BB))
@@ -538,6 +628,8 @@ void SanitizerCoverageModule::InjectCoverageAtBlock(Function &F, BasicBlock &BB,
 
   IRBuilder<> IRB(&*IP);
   IRB.SetCurrentDebugLocation(EntryLoc);
+  if (Options.Inline8bitCounters)
+    return InjectInline8bitCounterAtBlock(F, BB, IRB);
   Value *GuardP = IRB.CreateAdd(
       IRB.CreatePointerCast(GuardArray, IntptrTy),
       ConstantInt::get(IntptrTy, (1 + NumberOfInstrumentedBlocks()) * 4));
@@ -579,6 +671,34 @@ void SanitizerCoverageModule::InjectCoverageAtBlock(Function &F, BasicBlock &BB,
   }
 }
 
+// Increment the next inline counter, at the insertion point of IRB, and
+// record the PC of BB for the PC table.
+void SanitizerCoverageModule::InjectInline8bitCounterAtBlock(Function &F,
+                                                             BasicBlock &BB,
+                                                             IRBuilder<> &IRB) {
+  Value *P = IRB.CreateConstGEP1_32(InlineCounterArray, NumInline8bitCounters++);
+  LoadInst *LI = IRB.CreateLoad(P);
+  Value *Inc = IRB.CreateAdd(LI, ConstantInt::get(IRB.getInt8Ty(), 1));
+  StoreInst *SI = IRB.CreateStore(Inc, P);
+  SetNoSanitizeMetadata(LI);
+  SetNoSanitizeMetadata(SI);
+
+  if (!Options.PCTable)
+    return;
+  // Each entry is a PC and flags, where bit 0 marks a function entry. The
+  // address of a block is only taken when this copy of the function is the one
+  // that gets linked, otherwise the function address stands for its blocks.
+  bool IsEntryBB = &BB == &F.getEntryBlock();
+  bool HasOwnCopy = !F.isWeakForLinker() && !F.hasAvailableExternallyLinkage() &&
+                    !F.hasComdat();
+  Constant *PC = IsEntryBB || !HasOwnCopy
+                     ? ConstantExpr::getPointerCast(&F, IntptrTy)
+                     : ConstantExpr::getPointerCast(BlockAddress::get(&F, &BB),
+                                                    IntptrTy);
+  PCTableEntries.push_back(PC);
+  PCTableEntries.push_back(ConstantInt::get(IntptrTy, IsEntryBB ? 1 : 0));
+}
+
 char SanitizerCoverageModule::ID = 0;
 INITIALIZE_PASS_BEGIN(SanitizerCoverageModule, "sancov",
                       "SanitizerCoverage: TODO."
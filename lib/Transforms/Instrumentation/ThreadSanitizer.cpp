@@ -20,12 +20,19 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Instrumentation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/CaptureTracking.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/DataLayout.h"
@@ -62,6 +69,14 @@ static cl::opt<bool>  ClInstrumentAtomics(
 static cl::opt<bool>  ClInstrumentMemIntrinsics(
     "tsan-instrument-memintrinsics", cl::init(true),
     cl::desc("Instrument memintrinsics (memset/memcpy/memmove)"), cl::Hidden);
+static cl::opt<bool>  ClOmitDominatedAccesses(
+    "tsan-omit-dominated-accesses", cl::init(true),
+    cl::desc("Do not instrument accesses covered by an earlier access to the "
+             "same address"), cl::Hidden);
+static cl::opt<bool>  ClHoistLoopAccesses(
+    "tsan-hoist-loop-accesses", cl::init(true),
+    cl::desc("Instrument the loop invariant and unit stride accesses of a "
+             "loop once, in its preheader"), cl::Hidden);
 
 STATISTIC(NumInstrumentedReads, "Number of instrumented reads");
 STATISTIC(NumInstrumentedWrites, "Number of instrumented writes");
@@ -74,6 +89,12 @@ STATISTIC(NumOmittedReadsFromConstantGlobals,
           "Number of reads from constant globals");
 STATISTIC(NumOmittedReadsFromVtable, "Number of vtable reads");
 STATISTIC(NumOmittedNonCaptured, "Number of accesses ignored due to capturing");
+STATISTIC(NumOmittedDominated,
+          "Number of accesses ignored due to an earlier access");
+STATISTIC(NumOmittedNonCapturedMemIntrinsics,
+          "Number of memintrinsics on non captured allocas left alone");
+STATISTIC(NumHoistedLoopAccesses,
+          "Number of loop accesses instrumented in the preheader");
 
 static const char *const kTsanModuleCtorName = "tsan.module_ctor";
 static const char *const kTsanInitName = "__tsan_init";
@@ -91,13 +112,19 @@ struct ThreadSanitizer : public FunctionPass {
 
  private:
   void initializeCallbacks(Module &M);
-  bool instrumentLoadOrStore(Instruction *I, const DataLayout &DL);
+  bool instrumentLoadOrStore(Instruction *I, const DataLayout &DL,
+                             Instruction *InsertBefore = nullptr);
   bool instrumentAtomic(Instruction *I, const DataLayout &DL);
-  bool instrumentMemIntrinsic(Instruction *I);
+  bool instrumentMemIntrinsic(Instruction *I, const DataLayout &DL);
+  void findDominatedAccesses(Function &F);
   void chooseInstructionsToInstrument(SmallVectorImpl<Instruction *> &Local,
                                       SmallVectorImpl<Instruction *> &All,
                                       const DataLayout &DL);
+  bool hoistLoopAccesses(SmallVectorImpl<Instruction *> &All,
+                         const DataLayout &DL);
+  bool isSynchronizationFreeLoop(Loop *L);
   bool addrPointsToConstantData(Value *Addr);
+  bool addrPointsToNonCapturedAlloca(Value *Addr, const DataLayout &DL);
   int getMemoryAccessFuncIndex(Value *Addr, const DataLayout &DL);
 
   Type *IntptrTy;
@@ -117,10 +144,22 @@ struct ThreadSanitizer : public FunctionPass {
   Function *TsanAtomicCAS[kNumberOfAccessSizes];
   Function *TsanAtomicThreadFence;
   Function *TsanAtomicSignalFence;
+  Function *TsanReadRange;
+  Function *TsanWriteRange;
   Function *TsanVptrUpdate;
   Function *TsanVptrLoad;
   Function *MemmoveFn, *MemcpyFn, *MemsetFn;
   Function *TsanCtorFunction;
+
+  // Per function state.
+  LoopInfo *LI;
+  ScalarEvolution *SE;
+  // Loads and stores covered by an earlier access to the same address.
+  SmallPtrSet<Instruction *, 16> DominatedAccesses;
+  // Whether each alloca seen so far is not captured.
+  SmallDenseMap<Value *, bool, 8> NonCapturedAllocas;
+  // Whether each loop seen so far has no calls and no atomics.
+  SmallDenseMap<Loop *, bool, 4> SynchronizationFreeLoops;
 };
 }  // namespace
 
@@ -130,6 +169,8 @@ INITIALIZE_PASS_BEGIN(
     "ThreadSanitizer: detects data races.",
     false, false)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
 INITIALIZE_PASS_END(
     ThreadSanitizer, "tsan",
     "ThreadSanitizer: detects data races.",
@@ -141,6 +182,8 @@ const char *ThreadSanitizer::getPassName() const {
 
 void ThreadSanitizer::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<TargetLibraryInfoWrapperPass>();
+  AU.addRequired<LoopInfoWrapperPass>();
+  AU.addRequired<ScalarEvolutionWrapperPass>();
 }
 
 FunctionPass *llvm::createThreadSanitizerPass() {
@@ -218,6 +261,12 @@ void ThreadSanitizer::initializeCallbacks(Module &M) {
     TsanAtomicCAS[i] = checkSanitizerInterfaceFunction(M.getOrInsertFunction(
         AtomicCASName, Ty, PtrTy, Ty, Ty, OrdTy, OrdTy, nullptr));
   }
+  TsanReadRange = checkSanitizerInterfaceFunction(
+      M.getOrInsertFunction("__tsan_read_range", IRB.getVoidTy(),
+                            IRB.getInt8PtrTy(), IntptrTy, nullptr));
+  TsanWriteRange = checkSanitizerInterfaceFunction(
+      M.getOrInsertFunction("__tsan_write_range", IRB.getVoidTy(),
+                            IRB.getInt8PtrTy(), IntptrTy, nullptr));
   TsanVptrUpdate = checkSanitizerInterfaceFunction(
       M.getOrInsertFunction("__tsan_vptr_update", IRB.getVoidTy(),
                             IRB.getInt8PtrTy(), IRB.getInt8PtrTy(), nullptr));
@@ -309,9 +358,26 @@ bool ThreadSanitizer::addrPointsToConstantData(Value *Addr) {
   return false;
 }
 
+// Return true if Addr points into an alloca that is not captured. Such a
+// variable cannot be referenced from a different thread and participate in a
+// data race (see llvm/Analysis/CaptureTracking.h for details).
+bool ThreadSanitizer::addrPointsToNonCapturedAlloca(Value *Addr,
+                                                    const DataLayout &DL) {
+  Value *Obj = GetUnderlyingObject(Addr, DL);
+  if (!isa<AllocaInst>(Obj))
+    return false;
+  auto It = NonCapturedAllocas.find(Obj);
+  if (It != NonCapturedAllocas.end())
+    return It->second;
+  bool NonCaptured = !PointerMayBeCaptured(Obj, true, true);
+  NonCapturedAllocas[Obj] = NonCaptured;
+  return NonCaptured;
+}
+
 // Instrumenting some of the accesses may be proven redundant.
 // Currently handled:
 //  - read-before-write (within same BB, no calls between)
+//  - accesses covered by an earlier access (see findDominatedAccesses)
 //  - not captured variables
 //
 // We do not handle some of the patterns that should not survive
@@ -347,14 +413,15 @@ void ThreadSanitizer::chooseInstructionsToInstrument(
         continue;
       }
     }
+    if (DominatedAccesses.count(I)) {
+      // An earlier access to the same address covers this one.
+      NumOmittedDominated++;
+      continue;
+    }
     Value *Addr = isa<StoreInst>(*I)
         ? cast<StoreInst>(I)->getPointerOperand()
         : cast<LoadInst>(I)->getPointerOperand();
-    if (isa<AllocaInst>(GetUnderlyingObject(Addr, DL)) &&
-        !PointerMayBeCaptured(Addr, true, true)) {
-      // The variable is addressable but not captured, so it cannot be
-      // referenced from a different thread and participate in a data race
-      // (see llvm/Analysis/CaptureTracking.h for details).
+    if (addrPointsToNonCapturedAlloca(Addr, DL)) {
       NumOmittedNonCaptured++;
       continue;
     }
@@ -377,6 +444,147 @@ static bool isAtomic(Instruction *I) {
   return false;
 }
 
+// Calls and atomics may synchronize with other threads.
+static bool mayBeSynchronization(Instruction *I) {
+  return isAtomic(I) || isa<CallInst>(I) || isa<InvokeInst>(I);
+}
+
+// Find the loads and stores that are covered by an earlier access to the same
+// address with no call or atomic in between, so any race on them is also a
+// race on the earlier access. A write covers the later reads and writes, a
+// read only covers the later reads. The scan of a block continues the scan of
+// its predecessor when it has a single one, so the earlier access may be in a
+// dominating block.
+void ThreadSanitizer::findDominatedAccesses(Function &F) {
+  // The addresses accessed since the last call or atomic, and whether they
+  // were written, at the end of the blocks that are the single predecessor of
+  // one of their successors.
+  typedef SmallDenseMap<Value *, bool, 8> AccessMap;
+  DenseMap<BasicBlock *, AccessMap> LiveOut;
+
+  ReversePostOrderTraversal<Function *> RPOT(&F);
+  for (BasicBlock *BB : RPOT) {
+    AccessMap Accesses;
+    BasicBlock *Pred = BB->getSinglePredecessor();
+    if (Pred && Pred != BB) {
+      auto It = LiveOut.find(Pred);
+      if (It != LiveOut.end())
+        Accesses = It->second;
+    }
+
+    for (auto &Inst : *BB) {
+      if (mayBeSynchronization(&Inst)) {
+        Accesses.clear();
+        continue;
+      }
+      if (!isa<LoadInst>(Inst) && !isa<StoreInst>(Inst))
+        continue;
+      // Vtable accesses are instrumented differently.
+      if (isVtableAccess(&Inst))
+        continue;
+      bool IsWrite = isa<StoreInst>(Inst);
+      Value *Addr = IsWrite ? cast<StoreInst>(Inst).getPointerOperand()
+                            : cast<LoadInst>(Inst).getPointerOperand();
+      auto Ins = Accesses.insert(std::make_pair(Addr, IsWrite));
+      if (Ins.second)
+        continue;
+      if (Ins.first->second || !IsWrite)
+        DominatedAccesses.insert(&Inst);
+      else
+        Ins.first->second = true;
+    }
+
+    for (BasicBlock *Succ : successors(BB))
+      if (Succ->getSinglePredecessor() == BB) {
+        LiveOut[BB] = std::move(Accesses);
+        break;
+      }
+  }
+}
+
+bool ThreadSanitizer::isSynchronizationFreeLoop(Loop *L) {
+  auto It = SynchronizationFreeLoops.find(L);
+  if (It != SynchronizationFreeLoops.end())
+    return It->second;
+  bool Free = std::none_of(L->block_begin(), L->block_end(),
+                           [](BasicBlock *BB) {
+                             for (auto &Inst : *BB)
+                               if (mayBeSynchronization(&Inst))
+                                 return true;
+                             return false;
+                           });
+  SynchronizationFreeLoops[L] = Free;
+  return Free;
+}
+
+// Instrument the loads and stores in the header of a loop without calls or
+// atomics once, in its preheader, when their address is loop invariant or
+// advances by the access size on each iteration. The header runs on every
+// iteration and nothing in the loop can synchronize with another thread, so
+// checking the invariant address, or the whole range of addresses, before the
+// loop finds the same races. The accesses handled here are removed from All.
+bool ThreadSanitizer::hoistLoopAccesses(SmallVectorImpl<Instruction *> &All,
+                                        const DataLayout &DL) {
+  bool Res = false;
+  SCEVExpander Expander(*SE, DL, "tsan");
+  auto NewEnd = std::remove_if(All.begin(), All.end(), [&](Instruction *I) {
+    BasicBlock *BB = I->getParent();
+    Loop *L = LI->getLoopFor(BB);
+    if (!L || L->getHeader() != BB || isVtableAccess(I))
+      return false;
+    BasicBlock *Preheader = L->getLoopPreheader();
+    if (!Preheader || !isSynchronizationFreeLoop(L))
+      return false;
+
+    bool IsWrite = isa<StoreInst>(*I);
+    Value *Addr = IsWrite
+        ? cast<StoreInst>(I)->getPointerOperand()
+        : cast<LoadInst>(I)->getPointerOperand();
+    Instruction *InsertPt = Preheader->getTerminator();
+    if (L->isLoopInvariant(Addr)) {
+      if (instrumentLoadOrStore(I, DL, InsertPt)) {
+        NumHoistedLoopAccesses++;
+        Res = true;
+      }
+      return true;
+    }
+
+    const auto *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Addr));
+    if (!AR || AR->getLoop() != L || !AR->isAffine())
+      return false;
+    Type *OrigTy = cast<PointerType>(Addr->getType())->getElementType();
+    uint64_t Size = DL.getTypeStoreSize(OrigTy);
+    const auto *Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+    if (!Step || Step->getAPInt() != Size)
+      return false;
+    const SCEV *BackedgeTakenCount = SE->getBackedgeTakenCount(L);
+    if (isa<SCEVCouldNotCompute>(BackedgeTakenCount))
+      return false;
+    // The header runs once more than the backedge is taken.
+    const SCEV *Length = SE->getMulExpr(
+        SE->getAddExpr(
+            SE->getTruncateOrZeroExtend(BackedgeTakenCount, IntptrTy),
+            SE->getOne(IntptrTy)),
+        SE->getConstant(IntptrTy, Size));
+    const SCEV *Start = AR->getStart();
+    if (!isSafeToExpand(Start, *SE) || !isSafeToExpand(Length, *SE))
+      return false;
+
+    Value *StartV = Expander.expandCodeFor(Start, Addr->getType(), InsertPt);
+    Value *LengthV = Expander.expandCodeFor(Length, IntptrTy, InsertPt);
+    IRBuilder<> IRB(InsertPt);
+    IRB.SetCurrentDebugLocation(I->getDebugLoc());
+    IRB.CreateCall(IsWrite ? TsanWriteRange : TsanReadRange,
+                   {IRB.CreatePointerCast(StartV, IRB.getInt8PtrTy()),
+                    LengthV});
+    NumHoistedLoopAccesses++;
+    Res = true;
+    return true;
+  });
+  All.erase(NewEnd, All.end());
+  return Res;
+}
+
 bool ThreadSanitizer::runOnFunction(Function &F) {
   // This is required to prevent instrumenting call to __tsan_init from within
   // the module constructor.
@@ -394,6 +602,14 @@ bool ThreadSanitizer::runOnFunction(Function &F) {
   const DataLayout &DL = F.getParent()->getDataLayout();
   const TargetLibraryInfo *TLI =
       &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
+  LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+  DominatedAccesses.clear();
+  NonCapturedAllocas.clear();
+  SynchronizationFreeLoops.clear();
+
+  if (ClOmitDominatedAccesses && SanitizeFunction)
+    findDominatedAccesses(F);
 
   // Traverse all instructions, collect loads/stores/returns, check for calls.
   for (auto &BB : F) {
@@ -418,14 +634,17 @@ bool ThreadSanitizer::runOnFunction(Function &F) {
   }
 
   // We have collected all loads and stores.
-  // FIXME: many of these accesses do not need to be checked for races
-  // (e.g. variables that do not escape, etc).
 
   // Instrument memory accesses only if we want to report bugs in the function.
-  if (ClInstrumentMemoryAccesses && SanitizeFunction)
+  // The loop accesses go first, before the instrumentation puts calls in the
+  // loops.
+  if (ClInstrumentMemoryAccesses && SanitizeFunction) {
+    if (ClHoistLoopAccesses)
+      Res |= hoistLoopAccesses(AllLoadsAndStores, DL);
     for (auto Inst : AllLoadsAndStores) {
       Res |= instrumentLoadOrStore(Inst, DL);
     }
+  }
 
   // Instrument atomic memory accesses in any case (they can be used to
   // implement synchronization).
@@ -436,7 +655,7 @@ bool ThreadSanitizer::runOnFunction(Function &F) {
 
   if (ClInstrumentMemIntrinsics && SanitizeFunction)
     for (auto Inst : MemIntrinCalls) {
-      Res |= instrumentMemIntrinsic(Inst);
+      Res |= instrumentMemIntrinsic(Inst, DL);
     }
 
   // Instrument function entry/exit points if there were instrumented accesses.
@@ -456,8 +675,10 @@ bool ThreadSanitizer::runOnFunction(Function &F) {
 }
 
 bool ThreadSanitizer::instrumentLoadOrStore(Instruction *I,
-                                            const DataLayout &DL) {
-  IRBuilder<> IRB(I);
+                                            const DataLayout &DL,
+                                            Instruction *InsertBefore) {
+  IRBuilder<> IRB(InsertBefore ? InsertBefore : I);
+  IRB.SetCurrentDebugLocation(I->getDebugLoc());
   bool IsWrite = isa<StoreInst>(*I);
   Value *Addr = IsWrite
       ? cast<StoreInst>(I)->getPointerOperand()
@@ -530,7 +751,17 @@ static ConstantInt *createOrdering(IRBuilder<> *IRB, AtomicOrdering ord) {
 // Since tsan is running after everyone else, the calls should not be
 // replaced back with intrinsics. If that becomes wrong at some point,
 // we will need to call e.g. __tsan_memset to avoid the intrinsics.
-bool ThreadSanitizer::instrumentMemIntrinsic(Instruction *I) {
+// The intrinsics that only access non captured allocas cannot race, and are
+// left alone.
+bool ThreadSanitizer::instrumentMemIntrinsic(Instruction *I,
+                                             const DataLayout &DL) {
+  MemIntrinsic *MI = cast<MemIntrinsic>(I);
+  MemTransferInst *MTI = dyn_cast<MemTransferInst>(I);
+  if (addrPointsToNonCapturedAlloca(MI->getRawDest(), DL) &&
+      (!MTI || addrPointsToNonCapturedAlloca(MTI->getRawSource(), DL))) {
+    NumOmittedNonCapturedMemIntrinsics++;
+    return false;
+  }
   IRBuilder<> IRB(I);
   if (MemSetInst *M = dyn_cast<MemSetInst>(I)) {
     IRB.CreateCall(
@@ -149,8 +149,8 @@ PreservedAnalyses ADCEPass::run(Function &F, FunctionAnalysisManager &) {
   if (!aggressiveDCE(F))
     return PreservedAnalyses::all();
 
-  // FIXME: This should also 'preserve the CFG'.
   auto PA = PreservedAnalyses();
+  PA.preserveSet<CFGAnalyses>();
   PA.preserve<GlobalsAA>();
   return PA;
 }
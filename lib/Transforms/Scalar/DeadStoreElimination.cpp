@@ -25,6 +25,7 @@
 #include "llvm/Analysis/GlobalsModRef.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Analysis/PostDominators.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Constants.h"
@@ -40,6 +41,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/MemorySSA.h"
 #include <map>
 using namespace llvm;
 
@@ -55,6 +57,16 @@ EnablePartialOverwriteTracking("enable-dse-partial-overwrite-tracking",
   cl::init(true), cl::Hidden,
   cl::desc("Enable partial-overwrite tracking in DSE"));
 
+static cl::opt<bool>
+EnableMemorySSA("enable-dse-memoryssa", cl::init(false), cl::Hidden,
+  cl::desc("Find dead stores with MemorySSA instead of memory dependence "
+           "analysis in DSE"));
+
+static cl::opt<unsigned>
+MemorySSAScanLimit("dse-memoryssa-scanlimit", cl::init(150), cl::Hidden,
+  cl::desc("The number of memory accesses DSE looks at after a store for "
+           "one that overwrites it"));
+
 
 //===----------------------------------------------------------------------===//
 // Helper functions
@@ -64,9 +76,10 @@ EnablePartialOverwriteTracking("enable-dse-partial-overwrite-tracking",
 /// operands of this instruction.  If any of them become dead, delete them and
 /// the computation tree that feeds them.
 /// If ValueSet is non-null, remove any deleted instructions from it as well.
+/// Exactly one of MD and MSSA is non-null, and is updated.
 static void
-deleteDeadInstruction(Instruction *I, MemoryDependenceResults &MD,
-                      const TargetLibraryInfo &TLI,
+deleteDeadInstruction(Instruction *I, MemoryDependenceResults *MD,
+                      MemorySSA *MSSA, const TargetLibraryInfo &TLI,
                       SmallSetVector<Value *, 16> *ValueSet = nullptr) {
   SmallVector<Instruction*, 32> NowDeadInsts;
 
@@ -81,7 +94,10 @@ deleteDeadInstruction(Instruction *I, MemoryDependenceResults &MD,
     // This instruction is dead, zap it, in stages.  Start by removing it from
     // MemDep, which needs to know the operands and needs it to be in the
     // function.
-    MD.removeInstruction(DeadInst);
+    if (MD)
+      MD->removeInstruction(DeadInst);
+    else if (MemoryAccess *MA = MSSA->getMemoryAccess(DeadInst))
+      MSSA->removeMemoryAccess(MA);
 
     for (unsigned op = 0, e = DeadInst->getNumOperands(); op != e; ++op) {
       Value *Op = DeadInst->getOperand(op);
@@ -606,7 +622,7 @@ static bool handleFree(CallInst *F, AliasAnalysis *AA,
       auto Next = ++Dependency->getIterator();
 
       // DCE instructions only used to calculate that store.
-      deleteDeadInstruction(Dependency, *MD, *TLI);
+      deleteDeadInstruction(Dependency, MD, nullptr, *TLI);
       ++NumFastStores;
       MadeChange = true;
 
@@ -720,7 +736,7 @@ static bool handleEndBlock(BasicBlock &BB, AliasAnalysis *AA,
               dbgs() << '\n');
 
         // DCE instructions only used to calculate that store.
-        deleteDeadInstruction(Dead, *MD, *TLI, &DeadStackObjects);
+        deleteDeadInstruction(Dead, MD, nullptr, *TLI, &DeadStackObjects);
         ++NumFastStores;
         MadeChange = true;
         continue;
@@ -730,7 +746,7 @@ static bool handleEndBlock(BasicBlock &BB, AliasAnalysis *AA,
     // Remove any dead non-memory-mutating instructions.
     if (isInstructionTriviallyDead(&*BBI, TLI)) {
       Instruction *Inst = &*BBI++;
-      deleteDeadInstruction(Inst, *MD, *TLI, &DeadStackObjects);
+      deleteDeadInstruction(Inst, MD, nullptr, *TLI, &DeadStackObjects);
       ++NumFastOther;
       MadeChange = true;
       continue;
@@ -836,7 +852,7 @@ static bool eliminateDeadStores(BasicBlock &BB, AliasAnalysis *AA,
         // in case we need it.
         WeakVH NextInst(&*BBI);
 
-        deleteDeadInstruction(DeadInst, *MD, *TLI);
+        deleteDeadInstruction(DeadInst, MD, nullptr, *TLI);
 
         if (!NextInst) // Next instruction deleted.
           BBI = BB.begin();
@@ -921,7 +937,7 @@ static bool eliminateDeadStores(BasicBlock &BB, AliasAnalysis *AA,
                 << *DepWrite << "\n  KILLER: " << *Inst << '\n');
 
           // Delete the store and now-dead instructions that feed it.
-          deleteDeadInstruction(DepWrite, *MD, *TLI);
+          deleteDeadInstruction(DepWrite, MD, nullptr, *TLI);
           ++NumFastStores;
           MadeChange = true;
 
@@ -1019,21 +1035,181 @@ static bool eliminateDeadStores(Function &F, AliasAnalysis *AA,
   return MadeChange;
 }
 
+//===----------------------------------------------------------------------===//
+// MemorySSA-based DSE
+//===----------------------------------------------------------------------===//
+
+/// Returns true if the write of 'Inst' to 'Loc' is completely overwritten on
+/// every path from it before anything may read it.
+///
+/// This walks down the MemorySSA def-use chains from the write, so it finds
+/// the overwriting store in whichever block it is, but gives up at the first
+/// MemoryPhi.
+static bool isOverwrittenLater(Instruction *Inst, MemoryDef *Def,
+                               const MemoryLocation &Loc, AliasAnalysis &AA,
+                               PostDominatorTree &PDT, const DataLayout &DL,
+                               const TargetLibraryInfo &TLI) {
+  // Partial overwrites of 'Inst' add up over the walk.
+  InstOverlapIntervalsTy IOL;
+  unsigned NumScanned = 0;
+
+  for (MemoryAccess *Current = Def;;) {
+    // Uses of the memory state after 'Current' must not read 'Loc', and the
+    // next write must be unique.
+    MemoryDef *Next = nullptr;
+    for (User *U : Current->users()) {
+      if (++NumScanned > MemorySSAScanLimit || isa<MemoryPhi>(U))
+        return false;
+      if (auto *Use = dyn_cast<MemoryUse>(U)) {
+        if (AA.getModRefInfo(Use->getMemoryInst(), Loc) & MRI_Ref)
+          return false;
+        continue;
+      }
+      if (Next)
+        return false;
+      Next = cast<MemoryDef>(U);
+    }
+    if (!Next)
+      return false;
+
+    // 'Next' overwrites 'Inst' if it is executed whenever 'Inst' is, and
+    // writes all of 'Loc' without first reading it.
+    Instruction *NextInst = Next->getMemoryInst();
+    if (hasMemoryWrite(NextInst, TLI) &&
+        PDT.dominates(NextInst->getParent(), Inst->getParent())) {
+      MemoryLocation NextLoc = getLocForWrite(NextInst, AA);
+      if (NextLoc.Ptr &&
+          !isPossibleSelfRead(NextInst, NextLoc, Inst, TLI, AA)) {
+        int64_t InstOffset, NextOffset;
+        if (isOverwrite(NextLoc, Loc, DL, TLI, InstOffset, NextOffset, Inst,
+                        IOL) == OverwriteComplete)
+          return true;
+      }
+    }
+
+    // Otherwise keep looking past 'Next', unless it might read 'Loc'.
+    if (AA.getModRefInfo(NextInst, Loc) & MRI_Ref)
+      return false;
+    Current = Next;
+  }
+}
+
+/// Returns true if 'Loc' holds the same value in the memory state 'Start' as
+/// right after 'Clobber', because every write on the way from 'Clobber' to
+/// 'Start' doesn't alias 'Loc'.
+///
+/// The walker stops at MemoryPhis, so this looks through them and checks each
+/// incoming state. A MemoryPhi that is reached again is on a cycle that was
+/// already found to contain no other clobber.
+static bool hasSameClobber(MemoryAccess *Start, MemoryAccess *Clobber,
+                           MemoryLocation &Loc, MemorySSAWalker *Walker) {
+  SmallPtrSet<MemoryPhi *, 8> Visited;
+  SmallVector<MemoryAccess *, 8> Worklist(1, Start);
+  unsigned NumScanned = 0;
+  while (!Worklist.empty()) {
+    MemoryAccess *MA =
+        Walker->getClobberingMemoryAccess(Worklist.pop_back_val(), Loc);
+    if (MA == Clobber)
+      continue;
+    auto *Phi = dyn_cast<MemoryPhi>(MA);
+    if (!Phi || ++NumScanned > MemorySSAScanLimit)
+      return false;
+    if (!Visited.insert(Phi).second)
+      continue;
+    for (Use &U : Phi->incoming_values())
+      Worklist.push_back(cast<MemoryAccess>(U));
+  }
+  return true;
+}
+
+static bool eliminateDeadStores(Function &F, AliasAnalysis *AA,
+                                MemorySSA *MSSA, DominatorTree *DT,
+                                PostDominatorTree *PDT,
+                                const TargetLibraryInfo *TLI) {
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  MemorySSAWalker *Walker = MSSA->getWalker();
+  bool MadeChange = false;
+
+  for (BasicBlock &BB : F) {
+    // Only check non-dead blocks.  Dead blocks may have strange pointer
+    // cycles that will confuse alias analysis.
+    if (!DT->isReachableFromEntry(&BB))
+      continue;
+
+    for (BasicBlock::iterator BBI = BB.begin(), BBE = BB.end(); BBI != BBE;) {
+      Instruction *Inst = &*BBI++;
+      if (!hasMemoryWrite(Inst, *TLI) || !isRemovable(Inst))
+        continue;
+      auto *Def = dyn_cast_or_null<MemoryDef>(MSSA->getMemoryAccess(Inst));
+      if (!Def)
+        continue;
+      MemoryLocation Loc = getLocForWrite(Inst, *AA);
+      if (!Loc.Ptr)
+        continue;
+
+      // Deleting 'Inst' only deletes the instructions that it uses, which
+      // come before it.
+      auto RemoveDeadInst = [&]() {
+        deleteDeadInstruction(Inst, nullptr, MSSA, *TLI);
+        MadeChange = true;
+      };
+
+      // If we're storing the same value back to a pointer that we loaded
+      // from, and the nearest clobber of the pointer is the same for the
+      // load and the store, then the store can be removed.
+      if (StoreInst *SI = dyn_cast<StoreInst>(Inst)) {
+        LoadInst *DepLoad = dyn_cast<LoadInst>(SI->getValueOperand());
+        if (DepLoad &&
+            SI->getPointerOperand() == DepLoad->getPointerOperand() &&
+            MSSA->getMemoryAccess(DepLoad) && DT->dominates(DepLoad, SI) &&
+            hasSameClobber(Def->getDefiningAccess(),
+                           Walker->getClobberingMemoryAccess(DepLoad), Loc,
+                           Walker)) {
+          DEBUG(dbgs() << "DSE: Remove Store Of Load from same pointer:\n  "
+                       << "LOAD: " << *DepLoad << "\n  STORE: " << *SI << '\n');
+
+          RemoveDeadInst();
+          ++NumRedundantStores;
+          continue;
+        }
+      }
+
+      if (isOverwrittenLater(Inst, Def, Loc, *AA, *PDT, DL, *TLI)) {
+        DEBUG(dbgs() << "DSE: Remove Dead Store:\n  DEAD: " << *Inst << '\n');
+
+        RemoveDeadInst();
+        ++NumFastStores;
+      }
+    }
+  }
+
+  return MadeChange;
+}
+
 //===----------------------------------------------------------------------===//
 // DSE Pass
 //===----------------------------------------------------------------------===//
 PreservedAnalyses DSEPass::run(Function &F, FunctionAnalysisManager &AM) {
   AliasAnalysis *AA = &AM.getResult<AAManager>(F);
   DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
-  MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
   const TargetLibraryInfo *TLI = &AM.getResult<TargetLibraryAnalysis>(F);
 
-  if (!eliminateDeadStores(F, AA, MD, DT, TLI))
-    return PreservedAnalyses::all();
   PreservedAnalyses PA;
-  PA.preserve<DominatorTreeAnalysis>();
+  if (EnableMemorySSA) {
+    MemorySSA *MSSA = &AM.getResult<MemorySSAAnalysis>(F);
+    PostDominatorTree *PDT = &AM.getResult<PostDominatorTreeAnalysis>(F);
+    if (!eliminateDeadStores(F, AA, MSSA, DT, PDT, TLI))
+      return PreservedAnalyses::all();
+    PA.preserve<MemorySSAAnalysis>();
+    PA.preserve<PostDominatorTreeAnalysis>();
+  } else {
+    MemoryDependenceResults *MD = &AM.getResult<MemoryDependenceAnalysis>(F);
+    if (!eliminateDeadStores(F, AA, MD, DT, TLI))
+      return PreservedAnalyses::all();
+    PA.preserve<MemoryDependenceAnalysis>();
+  }
+  PA.preserveSet<CFGAnalyses>();
   PA.preserve<GlobalsAA>();
-  PA.preserve<MemoryDependenceAnalysis>();
   return PA;
 }
 
@@ -1050,11 +1226,16 @@ public:
 
     DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
     AliasAnalysis *AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
-    MemoryDependenceResults *MD =
-        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     const TargetLibraryInfo *TLI =
         &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
 
+    if (EnableMemorySSA)
+      return eliminateDeadStores(
+          F, AA, &getAnalysis<MemorySSAWrapperPass>().getMSSA(), DT,
+          &getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree(), TLI);
+
+    MemoryDependenceResults *MD =
+        &getAnalysis<MemoryDependenceWrapperPass>().getMemDep();
     return eliminateDeadStores(F, AA, MD, DT, TLI);
   }
 
@@ -1062,11 +1243,18 @@ public:
     AU.setPreservesCFG();
     AU.addRequired<DominatorTreeWrapperPass>();
     AU.addRequired<AAResultsWrapperPass>();
-    AU.addRequired<MemoryDependenceWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addPreserved<GlobalsAAWrapperPass>();
-    AU.addPreserved<MemoryDependenceWrapperPass>();
+    if (EnableMemorySSA) {
+      AU.addRequired<MemorySSAWrapperPass>();
+      AU.addRequired<PostDominatorTreeWrapperPass>();
+      AU.addPreserved<MemorySSAWrapperPass>();
+      AU.addPreserved<PostDominatorTreeWrapperPass>();
+    } else {
+      AU.addRequired<MemoryDependenceWrapperPass>();
+      AU.addPreserved<MemoryDependenceWrapperPass>();
+    }
   }
 
   static char ID; // Pass identification, replacement for typeid
@@ -1079,6 +1267,8 @@ INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(GlobalsAAWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MemorySSAWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 INITIALIZE_PASS_END(DSELegacyPass, "dse", "Dead Store Elimination", false,
                     false)
@@ -68,6 +68,10 @@ STATISTIC(NumPRELoad,   "Number of loads PRE'd");
 static cl::opt<bool> EnablePRE("enable-pre",
                                cl::init(true), cl::Hidden);
 static cl::opt<bool> EnableLoadPRE("enable-load-pre", cl::init(true));
+static cl::opt<bool>
+    EnableMemorySSA("enable-gvn-memoryssa", cl::init(false), cl::Hidden,
+                    cl::desc("Eliminate loads with MemorySSA instead of "
+                             "memory dependence analysis in GVN"));
 
 // Maximum allowed recursion depth.
 static cl::opt<uint32_t>
@@ -592,8 +596,9 @@ PreservedAnalyses GVN::run(Function &F, AnalysisManager<Function> &AM) {
   auto &DT = AM.getResult<DominatorTreeAnalysis>(F);
   auto &TLI = AM.getResult<TargetLibraryAnalysis>(F);
   auto &AA = AM.getResult<AAManager>(F);
-  auto &MemDep = AM.getResult<MemoryDependenceAnalysis>(F);
-  bool Changed = runImpl(F, AC, DT, TLI, AA, &MemDep);
+  auto *MemDep =
+      EnableMemorySSA ? nullptr : &AM.getResult<MemoryDependenceAnalysis>(F);
+  bool Changed = runImpl(F, AC, DT, TLI, AA, MemDep, EnableMemorySSA);
   if (!Changed)
     return PreservedAnalyses::all();
   PreservedAnalyses PA;
@@ -1770,7 +1775,7 @@ static void patchAndReplaceAllUsesWith(Instruction *I, Value *Repl) {
 /// Attempt to eliminate a load, first by eliminating it
 /// locally, and then attempting non-local elimination if that fails.
 bool GVN::processLoad(LoadInst *L) {
-  if (!MD)
+  if (!MD && !UseMemorySSA)
     return false;
 
   // This code hasn't been audited for ordered or volatile memory access
@@ -1782,6 +1787,9 @@ bool GVN::processLoad(LoadInst *L) {
     return true;
   }
 
+  if (UseMemorySSA)
+    return processLoadWithMemorySSA(L);
+
   // ... to a pointer that has been loaded from before...
   MemDepResult Dep = MD->getDependency(L);
 
@@ -1819,6 +1827,76 @@ bool GVN::processLoad(LoadInst *L) {
   return false;
 }
 
+/// Unlike memdep, the MemorySSA walker finds clobbers in any dominating block
+/// at about the cost of a local query. There is no load PRE in this mode:
+/// a load is only replaced with a value available on all paths to it.
+bool GVN::processLoadWithMemorySSA(LoadInst *L) {
+  // Splitting edges leaves MemoryPhis with stale incoming blocks, so wait for
+  // the next iteration to rebuild MemorySSA.
+  if (MSSAIsStale)
+    return false;
+
+  // Loads of constant memory have no access, nothing ever clobbers them.
+  MemoryAccess *Clobber = MSSA->getMemoryAccess(L)
+                              ? MSSAWalker->getClobberingMemoryAccess(L)
+                              : MSSA->getLiveOnEntryDef();
+  Value *Address = L->getPointerOperand();
+  AvailableValue AV;
+  bool Available = false;
+
+  auto *Def = dyn_cast<MemoryDef>(Clobber);
+  if (Def && !MSSA->isLiveOnEntryDef(Def)) {
+    Instruction *DepInst = Def->getMemoryInst();
+    // The walker stops at writes that may alias the load. Only a store known
+    // to write the same address as the load defines it; for other writes the
+    // offset of the load in them has to be worked out.
+    if (auto *SI = dyn_cast<StoreInst>(DepInst)) {
+      AliasAnalysis *AA = VN.getAliasAnalysis();
+      bool IsDef = AA->alias(MemoryLocation::get(L), MemoryLocation::get(SI)) ==
+                   MustAlias;
+      Available = AnalyzeLoadAvailability(
+          L, IsDef ? MemDepResult::getDef(SI) : MemDepResult::getClobber(SI),
+          Address, AV);
+    } else if (isa<MemIntrinsic>(DepInst)) {
+      Available = AnalyzeLoadAvailability(
+          L, MemDepResult::getClobber(DepInst), Address, AV);
+    }
+  }
+
+  if (!Available) {
+    // Loads of the same pointer with the same clobber read the same value.
+    auto &Loads =
+        AvailableLoads[std::make_pair(Clobber, VN.lookupOrAdd(Address))];
+    for (LoadInst *Prev : Loads)
+      if (DT->dominates(Prev, L) &&
+          AnalyzeLoadAvailability(L, MemDepResult::getDef(Prev), Address,
+                                  AV)) {
+        Available = true;
+        break;
+      }
+    if (!Available) {
+      Loads.push_back(L);
+      return false;
+    }
+  }
+
+  Value *AvailableValue = AV.MaterializeAdjustedValue(L, L, *this);
+  patchAndReplaceAllUsesWith(L, AvailableValue);
+  markInstructionForDeletion(L);
+  ++NumGVNLoad;
+  return true;
+}
+
+void GVN::removeFromMemorySSA(Instruction *I) {
+  MemoryAccess *MA = MSSA->getMemoryAccess(I);
+  if (!MA)
+    return;
+  // AvailableLoads is keyed by clobbering accesses, which must not be reused.
+  if (!isa<MemoryUse>(MA))
+    AvailableLoads.clear();
+  MSSA->removeMemoryAccess(MA);
+}
+
 // In order to find a leader for a given value number at a
 // specific basic block, we first obtain the list of all Values for that number,
 // and then scan the list to find one whose block dominates the block in
@@ -2186,7 +2264,7 @@ bool GVN::processInstruction(Instruction *I) {
 /// runOnFunction - This is the main transformation entry point for a function.
 bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
                   const TargetLibraryInfo &RunTLI, AAResults &RunAA,
-                  MemoryDependenceResults *RunMD) {
+                  MemoryDependenceResults *RunMD, bool RunUseMemorySSA) {
   AC = &RunAC;
   DT = &RunDT;
   VN.setDomTree(DT);
@@ -2194,6 +2272,8 @@ bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
   VN.setAliasAnalysis(&RunAA);
   MD = RunMD;
   VN.setMemDep(MD);
+  UseMemorySSA = RunUseMemorySSA;
+  assert(!(MD && UseMemorySSA) && "Loads are eliminated with one or the other");
 
   bool Changed = false;
   bool ShouldContinue = true;
@@ -2238,6 +2318,9 @@ bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
   // Do not cleanup DeadBlocks in cleanupGlobalSets() as it's called for each
   // iteration.
   DeadBlocks.clear();
+  MSSA.reset();
+  MSSAWalker = nullptr;
+  MSSAIsStale = false;
 
   return Changed;
 }
@@ -2277,6 +2360,7 @@ bool GVN::processBlock(BasicBlock *BB) {
          E = InstrsToErase.end(); I != E; ++I) {
       DEBUG(dbgs() << "GVN removed: " << **I << '\n');
       if (MD) MD->removeInstruction(*I);
+      if (MSSA) removeFromMemorySSA(*I);
       DEBUG(verifyRemoved(*I));
       (*I)->eraseFromParent();
     }
@@ -2498,6 +2582,7 @@ BasicBlock *GVN::splitCriticalEdges(BasicBlock *Pred, BasicBlock *Succ) {
       SplitCriticalEdge(Pred, Succ, CriticalEdgeSplittingOptions(DT));
   if (MD)
     MD->invalidateCachedPredecessors();
+  MSSAIsStale = true;
   return BB;
 }
 
@@ -2512,6 +2597,7 @@ bool GVN::splitCriticalEdges() {
                       CriticalEdgeSplittingOptions(DT));
   } while (!toSplit.empty());
   if (MD) MD->invalidateCachedPredecessors();
+  MSSAIsStale = true;
   return true;
 }
 
@@ -2519,6 +2605,12 @@ bool GVN::splitCriticalEdges() {
 bool GVN::iterateOnFunction(Function &F) {
   cleanupGlobalSets();
 
+  if (UseMemorySSA && (!MSSA || MSSAIsStale)) {
+    MSSA = make_unique<MemorySSA>(F, VN.getAliasAnalysis(), DT);
+    MSSAWalker = MSSA->getWalker();
+    MSSAIsStale = false;
+  }
+
   // Top-down walk of the dominator tree
   bool Changed = false;
   // Save the blocks this function have before transformation begins. GVN may
@@ -2544,6 +2636,7 @@ void GVN::cleanupGlobalSets() {
   VN.clear();
   LeaderTable.clear();
   TableAllocator.Reset();
+  AvailableLoads.clear();
 }
 
 /// Verify that the specified instruction does not occur in our
@@ -2705,15 +2798,17 @@ public:
         getAnalysis<DominatorTreeWrapperPass>().getDomTree(),
         getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(),
         getAnalysis<AAResultsWrapperPass>().getAAResults(),
-        NoLoads ? nullptr
-                : &getAnalysis<MemoryDependenceWrapperPass>().getMemDep());
+        NoLoads || EnableMemorySSA
+            ? nullptr
+            : &getAnalysis<MemoryDependenceWrapperPass>().getMemDep(),
+        !NoLoads && EnableMemorySSA);
   }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<AssumptionCacheTracker>();
     AU.addRequired<DominatorTreeWrapperPass>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
-    if (!NoLoads)
+    if (!NoLoads && !EnableMemorySSA)
       AU.addRequired<MemoryDependenceWrapperPass>();
     AU.addRequired<AAResultsWrapperPass>();
 
@@ -58,6 +58,7 @@ static cl::opt<unsigned> MaxPrefetchIterationsAhead(
     cl::desc("Max number of iterations to prefetch ahead"), cl::Hidden);
 
 STATISTIC(NumPrefetches, "Number of prefetches inserted");
+STATISTIC(NumIndirectPrefetches, "Number of indirect prefetches inserted");
 
 namespace llvm {
   void initializeLoopDataPrefetchPass(PassRegistry&);
@@ -74,6 +75,7 @@ namespace {
 
     void getAnalysisUsage(AnalysisUsage &AU) const override {
       AU.addRequired<AssumptionCacheTracker>();
+      AU.addRequired<DominatorTreeWrapperPass>();
       AU.addPreserved<DominatorTreeWrapperPass>();
       AU.addRequired<LoopInfoWrapperPass>();
       AU.addPreserved<LoopInfoWrapperPass>();
@@ -93,6 +95,18 @@ namespace {
     /// warrant a prefetch.
     bool isStrideLargeEnough(const SCEVAddRecExpr *AR);
 
+    /// \brief If \p PtrValue indexes a loop-invariant base with a value
+    /// loaded from a strided address (as in A[B[i]]), return the load of the
+    /// index and set \p Ext to the extension of the index, if there is one.
+    LoadInst *getIndirectIndexLoad(Loop *L, Value *PtrValue, CastInst *&Ext);
+
+    /// \brief Prefetch the indirect access \p MemI \p ItersAhead iterations
+    /// ahead by loading its index early.
+    bool prefetchIndirect(Loop *L, Instruction *MemI, Value *PtrValue,
+                          unsigned ItersAhead);
+
+    void insertPrefetch(Instruction *MemI, Value *PrefPtrValue);
+
     unsigned getMinPrefetchStride() {
       if (MinPrefetchStride.getNumOccurrences() > 0)
         return MinPrefetchStride;
@@ -112,6 +126,7 @@ namespace {
     }
 
     AssumptionCache *AC;
+    DominatorTree *DT;
     LoopInfo *LI;
     ScalarEvolution *SE;
     const TargetTransformInfo *TTI;
@@ -123,6 +138,7 @@ char LoopDataPrefetch::ID = 0;
 INITIALIZE_PASS_BEGIN(LoopDataPrefetch, "loop-data-prefetch",
                       "Loop Data Prefetch", false, false)
 INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
@@ -147,6 +163,109 @@ bool LoopDataPrefetch::isStrideLargeEnough(const SCEVAddRecExpr *AR) {
   return TargetMinStride <= AbsStride;
 }
 
+LoadInst *LoopDataPrefetch::getIndirectIndexLoad(Loop *L, Value *PtrValue,
+                                                 CastInst *&Ext) {
+  auto *GEP = dyn_cast<GetElementPtrInst>(PtrValue);
+  if (!GEP || !L->contains(GEP) || GEP->getNumIndices() == 0)
+    return nullptr;
+
+  // Only the last index may vary in the loop.
+  for (unsigned Op = 0, E = GEP->getNumOperands() - 1; Op != E; ++Op)
+    if (!L->isLoopInvariant(GEP->getOperand(Op)))
+      return nullptr;
+
+  Value *Idx = GEP->getOperand(GEP->getNumOperands() - 1);
+  Ext = nullptr;
+  if (isa<SExtInst>(Idx) || isa<ZExtInst>(Idx)) {
+    Ext = cast<CastInst>(Idx);
+    Idx = Ext->getOperand(0);
+  }
+
+  auto *IdxLoad = dyn_cast<LoadInst>(Idx);
+  if (!IdxLoad || !IdxLoad->isSimple() || !L->contains(IdxLoad) ||
+      IdxLoad->getPointerAddressSpace())
+    return nullptr;
+
+  const auto *IdxAR =
+      dyn_cast<SCEVAddRecExpr>(SE->getSCEV(IdxLoad->getPointerOperand()));
+  if (!IdxAR || IdxAR->getLoop() != L || !IdxAR->isAffine() ||
+      !isa<SCEVConstant>(IdxAR->getStepRecurrence(*SE)))
+    return nullptr;
+
+  // The index is loaded ahead, clamped to the last iteration. That only
+  // stays within the memory the loop reads if the load executes on every
+  // iteration, up to an exit at the latch.
+  BasicBlock *Latch = L->getLoopLatch();
+  if (!Latch || L->getExitingBlock() != Latch ||
+      !DT->dominates(IdxLoad->getParent(), Latch))
+    return nullptr;
+  return IdxLoad;
+}
+
+bool LoopDataPrefetch::prefetchIndirect(Loop *L, Instruction *MemI,
+                                        Value *PtrValue, unsigned ItersAhead) {
+  CastInst *Ext;
+  LoadInst *IdxLoad = getIndirectIndexLoad(L, PtrValue, Ext);
+  if (!IdxLoad)
+    return false;
+
+  const SCEV *BTC = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BTC))
+    return false;
+
+  // Address the index ItersAhead iterations ahead, but no further than the
+  // index of the last iteration.
+  Type *CountTy = BTC->getType();
+  const SCEV *NextIter = SE->getUMinExpr(
+      SE->getAddRecExpr(SE->getConstant(CountTy, ItersAhead),
+                        SE->getOne(CountTy), L, SCEV::FlagAnyWrap),
+      BTC);
+  const auto *IdxAR =
+      cast<SCEVAddRecExpr>(SE->getSCEV(IdxLoad->getPointerOperand()));
+  const SCEV *NextIdxSCEV = IdxAR->evaluateAtIteration(NextIter, *SE);
+  if (!isSafeToExpand(NextIdxSCEV, *SE))
+    return false;
+
+  SCEVExpander SCEVE(*SE, *DL, "prefaddr");
+  Value *NextIdxPtr = SCEVE.expandCodeFor(
+      NextIdxSCEV, IdxLoad->getPointerOperand()->getType(), MemI);
+
+  // Rebuild the address of the access from the index loaded ahead.
+  IRBuilder<> Builder(MemI);
+  LoadInst *NextIdx = Builder.CreateLoad(NextIdxPtr, "prefidx");
+  NextIdx->setAlignment(IdxLoad->getAlignment());
+  Value *NextIdxVal = NextIdx;
+  if (Ext)
+    NextIdxVal =
+        Builder.CreateCast(Ext->getOpcode(), NextIdx, Ext->getDestTy());
+
+  auto *GEP = cast<GetElementPtrInst>(PtrValue);
+  SmallVector<Value *, 4> Indices(GEP->idx_begin(), GEP->idx_end());
+  Indices.back() = NextIdxVal;
+  Value *PrefPtrValue = Builder.CreateGEP(GEP->getSourceElementType(),
+                                          GEP->getPointerOperand(), Indices);
+  insertPrefetch(MemI, PrefPtrValue);
+  ++NumIndirectPrefetches;
+  return true;
+}
+
+void LoopDataPrefetch::insertPrefetch(Instruction *MemI, Value *PrefPtrValue) {
+  IRBuilder<> Builder(MemI);
+  Module *M = MemI->getModule();
+  Type *I32 = Type::getInt32Ty(MemI->getContext());
+  Value *PrefetchFunc = Intrinsic::getDeclaration(M, Intrinsic::prefetch);
+  Builder.CreateCall(
+      PrefetchFunc,
+      {Builder.CreateBitCast(PrefPtrValue, Builder.getInt8PtrTy()),
+       ConstantInt::get(I32, MemI->mayReadFromMemory() ? 0 : 1),
+       ConstantInt::get(I32, 3), ConstantInt::get(I32, 1)});
+  ++NumPrefetches;
+
+  Function *F = MemI->getFunction();
+  emitOptimizationRemark(F->getContext(), DEBUG_TYPE, *F, MemI->getDebugLoc(),
+                         "prefetched memory access");
+}
+
 bool LoopDataPrefetch::runOnFunction(Function &F) {
   if (skipFunction(F))
     return false;
@@ -155,6 +274,7 @@ bool LoopDataPrefetch::runOnFunction(Function &F) {
   SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
   DL = &F.getParent()->getDataLayout();
   AC = &getAnalysis<AssumptionCacheTracker>().getAssumptionCache(F);
+  DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
   TTI = &getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
 
   // If PrefetchDistance is not set, don't run the pass.  This gives an
@@ -185,18 +305,27 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
 
   // Calculate the number of iterations ahead to prefetch
   CodeMetrics Metrics;
+  SmallPtrSet<LoadInst *, 8> IndexLoads;
   for (Loop::block_iterator I = L->block_begin(), IE = L->block_end();
        I != IE; ++I) {
-
-    // If the loop already has prefetches, then assume that the user knows
-    // what they are doing and don't add any more.
     for (BasicBlock::iterator J = (*I)->begin(), JE = (*I)->end();
-         J != JE; ++J)
+         J != JE; ++J) {
+      // If the loop already has prefetches, then assume that the user knows
+      // what they are doing and don't add any more.
       if (CallInst *CI = dyn_cast<CallInst>(J))
         if (Function *F = CI->getCalledFunction())
           if (F->getIntrinsicID() == Intrinsic::prefetch)
             return MadeChange;
 
+      // Remember the loads that index other accesses, so that they can be
+      // prefetched further ahead than the accesses that depend on them.
+      CastInst *Ext;
+      if (LoadInst *LMemI = dyn_cast<LoadInst>(J))
+        if (LoadInst *IdxLoad =
+                getIndirectIndexLoad(L, LMemI->getPointerOperand(), Ext))
+          IndexLoads.insert(IdxLoad);
+    }
+
     Metrics.analyzeBasicBlock(*I, *TTI, EphValues);
   }
   unsigned LoopSize = Metrics.NumInsts;
@@ -210,10 +339,9 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
   if (ItersAhead > getMaxPrefetchIterationsAhead())
     return MadeChange;
 
-  Function *F = L->getHeader()->getParent();
   DEBUG(dbgs() << "Prefetching " << ItersAhead
                << " iterations ahead (loop size: " << LoopSize << ") in "
-               << F->getName() << ": " << *L);
+               << L->getHeader()->getParent()->getName() << ": " << *L);
 
   SmallVector<std::pair<Instruction *, const SCEVAddRecExpr *>, 16> PrefLoads;
   for (Loop::block_iterator I = L->block_begin(), IE = L->block_end();
@@ -241,8 +369,15 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
 
       const SCEV *LSCEV = SE->getSCEV(PtrValue);
       const SCEVAddRecExpr *LSCEVAddRec = dyn_cast<SCEVAddRecExpr>(LSCEV);
-      if (!LSCEVAddRec)
+      if (!LSCEVAddRec) {
+        // Irregular accesses aren't covered by the hardware prefetchers, so
+        // prefetch them regardless of the minimum stride.
+        if (prefetchIndirect(L, MemI, PtrValue, ItersAhead)) {
+          DEBUG(dbgs() << "  Indirect access: " << *PtrValue << "\n");
+          MadeChange = true;
+        }
         continue;
+      }
 
       // Check if the the stride of the accesses is large enough to warrant a
       // prefetch.
@@ -267,8 +402,15 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
       if (DupPref)
         continue;
 
+      // Software-pipeline the indirect accesses: an index has to arrive
+      // before the access it feeds can be prefetched, so fetch it twice as far
+      // ahead.
+      unsigned Ahead = ItersAhead;
+      if (IndexLoads.count(dyn_cast<LoadInst>(MemI)))
+        Ahead = std::min(2 * ItersAhead, getMaxPrefetchIterationsAhead());
+
       const SCEV *NextLSCEV = SE->getAddExpr(LSCEVAddRec, SE->getMulExpr(
-        SE->getConstant(LSCEVAddRec->getType(), ItersAhead),
+        SE->getConstant(LSCEVAddRec->getType(), Ahead),
         LSCEVAddRec->getStepRecurrence(*SE)));
       if (!isSafeToExpand(NextLSCEV, *SE))
         continue;
@@ -279,21 +421,9 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
       SCEVExpander SCEVE(*SE, J->getModule()->getDataLayout(), "prefaddr");
       Value *PrefPtrValue = SCEVE.expandCodeFor(NextLSCEV, I8Ptr, MemI);
 
-      IRBuilder<> Builder(MemI);
-      Module *M = (*I)->getParent()->getParent();
-      Type *I32 = Type::getInt32Ty((*I)->getContext());
-      Value *PrefetchFunc = Intrinsic::getDeclaration(M, Intrinsic::prefetch);
-      Builder.CreateCall(
-          PrefetchFunc,
-          {PrefPtrValue,
-           ConstantInt::get(I32, MemI->mayReadFromMemory() ? 0 : 1),
-           ConstantInt::get(I32, 3), ConstantInt::get(I32, 1)});
-      ++NumPrefetches;
+      insertPrefetch(MemI, PrefPtrValue);
       DEBUG(dbgs() << "  Access: " << *PtrValue << ", SCEV: " << *LSCEV
                    << "\n");
-      emitOptimizationRemark(F->getContext(), DEBUG_TYPE, *F,
-                             MemI->getDebugLoc(), "prefetched memory access");
-
 
       MadeChange = true;
     }
@@ -0,0 +1,346 @@
+//===- LoopFusion.cpp - Loop fusion pass ----------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass fuses adjacent loops that run the same number of iterations, so
+// that the data the first loop touches is reused by the second while it is
+// still in the cache.
+//
+// Two innermost loops are candidates when the exit block of the first is the
+// preheader of the second and contains nothing but the branch to it. This
+// makes the loops control flow equivalent: whenever one of them runs, so does
+// the other. Both loops must be rotated, exit only from their latch, and have
+// the same backedge-taken count according to ScalarEvolution.
+//
+// Fusing runs iteration i of the second loop before iterations i+1 and later
+// of the first, so the fusion is illegal if any of those accessed the same
+// memory and one of the accesses is a write. DependenceAnalysis proves most
+// pairs of accesses independent. The remaining ones must be affine accesses
+// to the same base with the same stride, where the second loop only touches
+// what the first one did in the same or an earlier iteration.
+//
+// The fused loop is only formed when the two loops access some common array,
+// which is where the cache reuse comes from, and when it isn't so big that its
+// registers would spill.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/GlobalsModRef.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "loop-fusion"
+
+STATISTIC(NumLoopsFused, "Number of loops fused");
+
+static cl::opt<unsigned> FusionMaxSize(
+    "loop-fusion-max-size", cl::init(200), cl::Hidden,
+    cl::desc("The maximum number of instructions in a fused loop, to keep "
+             "its register pressure in check"));
+
+static cl::opt<bool> FusionIgnoreReuse(
+    "loop-fusion-ignore-reuse", cl::init(false), cl::Hidden,
+    cl::desc("Fuse loops even when they don't access any common memory"));
+
+namespace {
+
+struct LoopFusion : public FunctionPass {
+  static char ID; // Pass identification, replacement for typeid
+  LoopFusion() : FunctionPass(ID) {
+    initializeLoopFusionPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnFunction(Function &F) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<AAResultsWrapperPass>();
+    AU.addRequired<DependenceAnalysisWrapperPass>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addRequiredID(LoopSimplifyID);
+    AU.addRequiredID(LCSSAID);
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addPreserved<GlobalsAAWrapperPass>();
+  }
+
+private:
+  DependenceInfo *DI;
+  DominatorTree *DT;
+  LoopInfo *LI;
+  ScalarEvolution *SE;
+
+  bool isCandidate(Loop *L, SmallVectorImpl<Instruction *> &MemInsts,
+                   unsigned &Size);
+  bool isSafeToReorder(Instruction *First, Instruction *Second, Loop *L1,
+                       Loop *L2);
+  bool tryToFuse(Loop *L1, Loop *L2);
+  void fuse(Loop *L1, Loop *L2);
+  bool fuseSiblings(std::vector<Loop *> Loops);
+};
+
+} // end anonymous namespace
+
+static Value *getPointerOperand(Instruction *I) {
+  if (auto *LD = dyn_cast<LoadInst>(I))
+    return LD->getPointerOperand();
+  return cast<StoreInst>(I)->getPointerOperand();
+}
+
+/// Return true if \p L has the shape fusion handles, and collect its memory
+/// accesses and its size.
+bool LoopFusion::isCandidate(Loop *L, SmallVectorImpl<Instruction *> &MemInsts,
+                             unsigned &Size) {
+  if (!L->empty() || !L->getLoopPreheader() || !L->getExitBlock())
+    return false;
+  BasicBlock *Latch = L->getLoopLatch();
+  if (!Latch || L->getExitingBlock() != Latch)
+    return false;
+  auto *BI = dyn_cast<BranchInst>(Latch->getTerminator());
+  if (!BI || !BI->isConditional())
+    return false;
+  if (isa<SCEVCouldNotCompute>(SE->getBackedgeTakenCount(L)))
+    return false;
+
+  Size = 0;
+  for (BasicBlock *BB : L->blocks())
+    for (Instruction &I : *BB) {
+      if (isa<DbgInfoIntrinsic>(I))
+        continue;
+      ++Size;
+      if (!I.mayReadOrWriteMemory())
+        continue;
+      // Only simple loads and stores can be analyzed for dependences.
+      if (auto *LD = dyn_cast<LoadInst>(&I)) {
+        if (!LD->isSimple())
+          return false;
+      } else if (auto *ST = dyn_cast<StoreInst>(&I)) {
+        if (!ST->isSimple())
+          return false;
+      } else {
+        return false;
+      }
+      MemInsts.push_back(&I);
+    }
+  return true;
+}
+
+/// Return true if \p Second, in \p L2, can run for an iteration before
+/// \p First, in \p L1, runs for the later ones.
+bool LoopFusion::isSafeToReorder(Instruction *First, Instruction *Second,
+                                 Loop *L1, Loop *L2) {
+  if (!First->mayWriteToMemory() && !Second->mayWriteToMemory())
+    return true;
+  if (!DI->depends(First, Second, /*PossiblyLoopIndependent=*/true))
+    return true;
+
+  // Both accesses must step through the same array by the same number of
+  // elements every iteration.
+  Value *Ptr1 = getPointerOperand(First);
+  Value *Ptr2 = getPointerOperand(Second);
+  auto *AR1 = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Ptr1));
+  auto *AR2 = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Ptr2));
+  if (!AR1 || !AR2 || AR1->getLoop() != L1 || AR2->getLoop() != L2 ||
+      !AR1->isAffine() || !AR2->isAffine() ||
+      SE->getPointerBase(AR1) != SE->getPointerBase(AR2))
+    return false;
+  auto *Step1 = dyn_cast<SCEVConstant>(AR1->getStepRecurrence(*SE));
+  auto *Step2 = dyn_cast<SCEVConstant>(AR2->getStepRecurrence(*SE));
+  if (!Step1 || Step1 != Step2 || Step1->getValue()->isZero())
+    return false;
+
+  // Every access must cover exactly one element, so that they never overlap
+  // partially.
+  const DataLayout &DL = First->getModule()->getDataLayout();
+  Type *Ty1 = cast<PointerType>(Ptr1->getType())->getElementType();
+  Type *Ty2 = cast<PointerType>(Ptr2->getType())->getElementType();
+  int64_t Stride = Step1->getAPInt().getSExtValue();
+  if (DL.getTypeStoreSize(Ty1) != DL.getTypeStoreSize(Ty2) ||
+      int64_t(DL.getTypeStoreSize(Ty1)) != std::abs(Stride))
+    return false;
+
+  // Iteration j of the second loop accesses the element iteration
+  // j + Offset / Stride of the first loop accessed.
+  auto *Delta = dyn_cast<SCEVConstant>(
+      SE->getMinusSCEV(AR2->getStart(), AR1->getStart()));
+  if (!Delta)
+    return false;
+  int64_t Offset = Delta->getAPInt().getSExtValue();
+  if (Offset % Stride != 0)
+    return false;
+  return Offset / Stride <= 0;
+}
+
+bool LoopFusion::tryToFuse(Loop *L1, Loop *L2) {
+  SmallVector<Instruction *, 16> MemInsts1, MemInsts2;
+  unsigned Size1, Size2;
+  if (!isCandidate(L1, MemInsts1, Size1) || !isCandidate(L2, MemInsts2, Size2))
+    return false;
+
+  // The block between the loops must be empty, and the loops must run in
+  // lock step.
+  BasicBlock *Between = L1->getExitBlock();
+  if (L2->getLoopPreheader() != Between || &Between->front() !=
+      Between->getTerminator() || !Between->getSinglePredecessor())
+    return false;
+  if (SE->getBackedgeTakenCount(L1) != SE->getBackedgeTakenCount(L2)) {
+    DEBUG(dbgs() << "LoopFusion: trip counts differ\n");
+    return false;
+  }
+
+  if (Size1 + Size2 > FusionMaxSize) {
+    DEBUG(dbgs() << "LoopFusion: fused loop would be too big\n");
+    return false;
+  }
+
+  bool Reuse = FusionIgnoreReuse;
+  for (Instruction *First : MemInsts1)
+    for (Instruction *Second : MemInsts2) {
+      if (!isSafeToReorder(First, Second, L1, L2)) {
+        DEBUG(dbgs() << "LoopFusion: fusion would reorder " << *First
+                     << " and " << *Second << "\n");
+        return false;
+      }
+      const DataLayout &DL = First->getModule()->getDataLayout();
+      Reuse |= GetUnderlyingObject(getPointerOperand(First), DL) ==
+               GetUnderlyingObject(getPointerOperand(Second), DL);
+    }
+  if (!Reuse) {
+    DEBUG(dbgs() << "LoopFusion: loops access no common memory\n");
+    return false;
+  }
+
+  fuse(L1, L2);
+  return true;
+}
+
+/// Make the latch of \p L1 branch to the header of \p L2, and the latch of
+/// \p L2 back to the header of \p L1.
+void LoopFusion::fuse(Loop *L1, Loop *L2) {
+  DEBUG(dbgs() << "LoopFusion: fusing " << *L1 << " and " << *L2);
+  SE->forgetLoop(L1);
+  SE->forgetLoop(L2);
+
+  BasicBlock *Preheader1 = L1->getLoopPreheader();
+  BasicBlock *Header1 = L1->getHeader(), *Latch1 = L1->getLoopLatch();
+  BasicBlock *Between = L1->getExitBlock();
+  BasicBlock *Header2 = L2->getHeader(), *Latch2 = L2->getLoopLatch();
+
+  // The induction variables of both loops now start in the first preheader
+  // and continue from the second latch.
+  while (PHINode *PN = dyn_cast<PHINode>(&Header2->front())) {
+    PN->setIncomingBlock(PN->getBasicBlockIndex(Between), Preheader1);
+    PN->moveBefore(&*Header1->getFirstInsertionPt());
+  }
+  for (Instruction &I : *Header1) {
+    PHINode *PN = dyn_cast<PHINode>(&I);
+    if (!PN)
+      break;
+    int Idx = PN->getBasicBlockIndex(Latch1);
+    if (Idx >= 0)
+      PN->setIncomingBlock(Idx, Latch2);
+  }
+
+  // The second loop's exit condition decides for both.
+  Latch1->getTerminator()->eraseFromParent();
+  BranchInst::Create(Header2, Latch1);
+  auto *BI = cast<BranchInst>(Latch2->getTerminator());
+  for (unsigned I = 0, E = BI->getNumSuccessors(); I != E; ++I)
+    if (BI->getSuccessor(I) == Header2)
+      BI->setSuccessor(I, Header1);
+  // The loop metadata described the second loop alone.
+  BI->setMetadata(LLVMContext::MD_loop, nullptr);
+
+  LI->removeBlock(Between);
+  Between->eraseFromParent();
+
+  // Move the blocks of the second loop into the first.
+  for (BasicBlock *BB : L2->blocks()) {
+    L1->addBlockEntry(BB);
+    LI->changeLoopFor(BB, L1);
+  }
+  if (Loop *Parent = L2->getParentLoop())
+    Parent->removeChildLoop(
+        std::find(Parent->begin(), Parent->end(), L2));
+  else
+    LI->removeLoop(std::find(LI->begin(), LI->end(), L2));
+  delete L2;
+
+  DT->recalculate(*Header1->getParent());
+  ++NumLoopsFused;
+}
+
+/// Fuse the adjacent loops of \p Loops, which have the same parent.
+bool LoopFusion::fuseSiblings(std::vector<Loop *> Loops) {
+  bool Changed = false;
+  for (bool Fused = true; Fused;) {
+    Fused = false;
+    for (Loop *L1 : Loops) {
+      BasicBlock *Exit = L1->getExitBlock();
+      if (!Exit)
+        continue;
+      auto L2 = std::find_if(Loops.begin(), Loops.end(), [&](Loop *L) {
+        return L != L1 && L->getLoopPreheader() == Exit;
+      });
+      if (L2 == Loops.end() || !tryToFuse(L1, *L2))
+        continue;
+      Loops.erase(L2);
+      Fused = Changed = true;
+      break;
+    }
+  }
+
+  for (Loop *L : Loops)
+    Changed |= fuseSiblings(std::vector<Loop *>(L->begin(), L->end()));
+  return Changed;
+}
+
+bool LoopFusion::runOnFunction(Function &F) {
+  if (skipFunction(F))
+    return false;
+
+  DI = &getAnalysis<DependenceAnalysisWrapperPass>().getDI();
+  DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+  LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+
+  return fuseSiblings(std::vector<Loop *>(LI->begin(), LI->end()));
+}
+
+char LoopFusion::ID = 0;
+INITIALIZE_PASS_BEGIN(LoopFusion, "loop-fusion", "Fuse adjacent loops", false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysisWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_DEPENDENCY(LCSSAWrapperPass)
+INITIALIZE_PASS_END(LoopFusion, "loop-fusion", "Fuse adjacent loops", false,
+                    false)
+
+FunctionPass *llvm::createLoopFusionPass() { return new LoopFusion(); }
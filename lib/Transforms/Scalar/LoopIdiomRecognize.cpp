@@ -16,11 +16,9 @@
 // TODO List:
 //
 // Future loop memory idioms to recognize:
-//   memcmp, memmove, strlen, etc.
+//   memcmp, bcmp, memmove, strchr, etc.
 // Future floating point idioms to recognize in -ffast-math mode:
 //   fpowi
-// Future integer operation idioms to recognize:
-//   ctpop, ctlz, cttz
 //
 // Beware that isel's default lowering for ctpop is highly inefficient for
 // i64 and larger types when i64 is legal and the value has few bits set.  It
@@ -62,6 +60,9 @@ using namespace llvm;
 
 STATISTIC(NumMemSet, "Number of memset's formed from loop stores");
 STATISTIC(NumMemCpy, "Number of memcpy's formed from loop load+stores");
+STATISTIC(NumPopCount, "Number of popcount loops recognized");
+STATISTIC(NumBitScan, "Number of ctlz/cttz loops recognized");
+STATISTIC(NumStrLen, "Number of strlen's formed from byte scanning loops");
 
 namespace {
 
@@ -134,6 +135,15 @@ private:
   void transformLoopToPopcount(BasicBlock *PreCondBB, Instruction *CntInst,
                                PHINode *CntPhi, Value *Var);
 
+  bool recognizeBitScan();
+  void transformLoopToBitScan(Instruction *CntInst, PHINode *CntPhi,
+                              Instruction *DefX, Value *InitX,
+                              bool IsNonZero);
+
+  bool recognizeStrLen();
+
+  void addTripCount(Value *TripCount);
+
   /// @}
 };
 
@@ -173,7 +183,7 @@ bool LoopIdiomRecognize::runOnLoop(Loop *L, LPPassManager &LPM) {
 
   // Disable loop idiom recognition if the function's name is a common idiom.
   StringRef Name = L->getHeader()->getParent()->getName();
-  if (Name == "memset" || Name == "memcpy")
+  if (Name == "memset" || Name == "memcpy" || Name == "strlen")
     return false;
 
   AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
@@ -897,7 +907,7 @@ bool LoopIdiomRecognize::processLoopStoreOfLoopLoad(StoreInst *SI,
 }
 
 bool LoopIdiomRecognize::runOnNoncountableLoop() {
-  return recognizePopcount();
+  return recognizePopcount() || recognizeBitScan() || recognizeStrLen();
 }
 
 /// Check if the given conditional branch is based on the comparison between
@@ -1111,6 +1121,7 @@ bool LoopIdiomRecognize::recognizePopcount() {
     return false;
 
   transformLoopToPopcount(PreCondBB, CntInst, CntPhi, Val);
+  ++NumPopCount;
   return true;
 }
 
@@ -1232,3 +1243,301 @@ void LoopIdiomRecognize::transformLoopToPopcount(BasicBlock *PreCondBB,
   //   loop. The loop would otherwise not be deleted even if it becomes empty.
   SE->forgetLoop(CurLoop);
 }
+
+/// Return true if \p I is used outside of \p BB, including by the PHI nodes of
+/// the blocks it branches to.
+static bool isLiveOutOf(Instruction *I, BasicBlock *BB) {
+  for (User *U : I->users())
+    if (cast<Instruction>(U)->getParent() != BB)
+      return true;
+  return false;
+}
+
+/// Give the single-block loop in question an explicit trip count, so that
+/// ScalarEvolution can compute how many times it runs. The loop is exited
+/// after exactly \p TripCount iterations, which must be what the current exit
+/// condition does; \p TripCount must be at least one and must be available in
+/// the preheader.
+///
+/// After this, a loop whose results are no longer used outside of it can be
+/// deleted, even if it was not obviously finite before.
+void LoopIdiomRecognize::addTripCount(Value *TripCount) {
+  BasicBlock *PreHead = CurLoop->getLoopPreheader();
+  BasicBlock *Body = *(CurLoop->block_begin());
+  auto *LbBr = cast<BranchInst>(Body->getTerminator());
+  auto *LbCond = cast<Instruction>(LbBr->getCondition());
+  Type *Ty = TripCount->getType();
+
+  PHINode *TcPhi = PHINode::Create(Ty, 2, "tcphi", &Body->front());
+
+  IRBuilder<> Builder(LbBr);
+  Value *TcDec =
+      Builder.CreateSub(TcPhi, ConstantInt::get(Ty, 1), "tcdec", true, false);
+
+  TcPhi->addIncoming(TripCount, PreHead);
+  TcPhi->addIncoming(TcDec, Body);
+
+  CmpInst::Predicate Pred =
+      (LbBr->getSuccessor(0) == Body) ? CmpInst::ICMP_NE : CmpInst::ICMP_EQ;
+  LbBr->setCondition(
+      Builder.CreateICmp(Pred, TcDec, ConstantInt::get(Ty, 0)));
+  RecursivelyDeleteTriviallyDeadInstructions(LbCond, TLI);
+
+  // Forget the "non-computable" trip-count SCEV associated with the loop.
+  SE->forgetLoop(CurLoop);
+}
+
+/// Return true iff a bit scanning idiom is detected in the loop.
+///
+/// Additionally:
+/// 1) \p DefX is set to the instruction shifting the scanned value.
+/// 2) \p PhiX is set to the corresponding phi node.
+/// 3) \p CntInst is set to the instruction counting the iterations.
+/// 4) \p CntPhi is set to the corresponding phi node.
+///
+/// The core idiom we are trying to detect is:
+/// \code
+///    cnt0 = init-val;
+///    do {
+///       x1 = phi (x0, x2);
+///       cnt1 = phi(cnt0, cnt2);
+///
+///       cnt2 = cnt1 + 1;
+///        ...
+///       x2 = x1 >> 1;   // or x1 << 1
+///        ...
+///    } while(x2 != 0);
+/// \endcode
+static bool detectBitScanIdiom(Loop *CurLoop, Instruction *&DefX,
+                               PHINode *&PhiX, Instruction *&CntInst,
+                               PHINode *&CntPhi) {
+  BasicBlock *LoopEntry = *(CurLoop->block_begin());
+
+  // step 1: Check if the loop-back branch is in desirable form.
+  DefX = dyn_cast_or_null<Instruction>(matchCondition(
+      dyn_cast<BranchInst>(LoopEntry->getTerminator()), LoopEntry));
+  if (!DefX)
+    return false;
+
+  // step 2: detect instructions corresponding to "x2 = x1 >> 1"
+  if (DefX->getOpcode() != Instruction::LShr &&
+      DefX->getOpcode() != Instruction::AShr &&
+      DefX->getOpcode() != Instruction::Shl)
+    return false;
+  ConstantInt *Shift = dyn_cast<ConstantInt>(DefX->getOperand(1));
+  if (!Shift || !Shift->isOne())
+    return false;
+
+  // step 3: Check the recurrence of variable X
+  PhiX = dyn_cast<PHINode>(DefX->getOperand(0));
+  if (!PhiX || PhiX->getParent() != LoopEntry ||
+      PhiX->getIncomingValueForBlock(LoopEntry) != DefX)
+    return false;
+
+  // step 4: Find the instruction which counts the iterations:
+  //   cnt2 = cnt1 + 1
+  CntInst = nullptr;
+  for (Instruction &Inst : make_range(LoopEntry->getFirstNonPHI()->getIterator(),
+                                      LoopEntry->end())) {
+    if (Inst.getOpcode() != Instruction::Add)
+      continue;
+
+    ConstantInt *Inc = dyn_cast<ConstantInt>(Inst.getOperand(1));
+    if (!Inc || !Inc->isOne())
+      continue;
+
+    PHINode *Phi = dyn_cast<PHINode>(Inst.getOperand(0));
+    if (!Phi || Phi->getParent() != LoopEntry ||
+        Phi->getIncomingValueForBlock(LoopEntry) != &Inst)
+      continue;
+
+    CntInst = &Inst;
+    CntPhi = Phi;
+    break;
+  }
+
+  return CntInst != nullptr;
+}
+
+/// Recognizes a loop that shifts a value until it becomes zero, counting the
+/// iterations, and computes the count with ctlz or cttz instead.
+///
+/// The loop is kept, but it becomes countable; if it did nothing but count,
+/// it is deleted later on.
+bool LoopIdiomRecognize::recognizeBitScan() {
+  // Give up if the loop has multiple blocks or multiple backedges.
+  if (CurLoop->getNumBackEdges() != 1 || CurLoop->getNumBlocks() != 1)
+    return false;
+
+  Instruction *DefX, *CntInst;
+  PHINode *PhiX, *CntPhi;
+  if (!detectBitScanIdiom(CurLoop, DefX, PhiX, CntInst, CntPhi))
+    return false;
+
+  // There is nothing to compute if the count is not used after the loop.
+  BasicBlock *Body = *(CurLoop->block_begin());
+  if (!isLiveOutOf(CntInst, Body) &&
+      !isLiveOutOf(CntPhi, Body))
+    return false;
+
+  BasicBlock *PH = CurLoop->getLoopPreheader();
+  Value *InitX = PhiX->getIncomingValueForBlock(PH);
+
+  // A negative value shifted right arithmetically never becomes zero.
+  if (DefX->getOpcode() == Instruction::AShr &&
+      !isKnownNonNegative(InitX, *DL))
+    return false;
+
+  // The intrinsic is cheaper if the value is known to be non-zero, as it is
+  // when the loop is guarded by "if (x0 != 0)".
+  bool IsNonZero = false;
+  if (BasicBlock *PreCondBB = PH->getSinglePredecessor())
+    if (matchCondition(dyn_cast<BranchInst>(PreCondBB->getTerminator()), PH) ==
+        InitX)
+      IsNonZero = true;
+
+  // The loop is deleted if it contains nothing but the idiom:
+  //   x1 = phi, cnt1 = phi, cnt2 = cnt1 + 1, x2 = x1 >> 1, cmp, br.
+  // Otherwise it is still run, and the intrinsic only pays off if it is cheap.
+  Intrinsic::ID IID = DefX->getOpcode() == Instruction::Shl ? Intrinsic::cttz
+                                                            : Intrinsic::ctlz;
+  LLVMContext &Ctx = InitX->getContext();
+  const Value *Args[] = {InitX, IsNonZero ? ConstantInt::getTrue(Ctx)
+                                          : ConstantInt::getFalse(Ctx)};
+  if (Body->size() != 6 &&
+      TTI->getIntrinsicCost(IID, InitX->getType(), Args) >
+          TargetTransformInfo::TCC_Basic)
+    return false;
+
+  transformLoopToBitScan(CntInst, CntPhi, DefX, InitX, IsNonZero);
+  ++NumBitScan;
+  return true;
+}
+
+void LoopIdiomRecognize::transformLoopToBitScan(Instruction *CntInst,
+                                                PHINode *CntPhi,
+                                                Instruction *DefX, Value *InitX,
+                                                bool IsNonZero) {
+  BasicBlock *PreHead = CurLoop->getLoopPreheader();
+  BasicBlock *Body = *(CurLoop->block_begin());
+  Module *M = PreHead->getModule();
+  Type *Ty = InitX->getType();
+  unsigned BitWidth = Ty->getIntegerBitWidth();
+  Intrinsic::ID IID = DefX->getOpcode() == Instruction::Shl ? Intrinsic::cttz
+                                                            : Intrinsic::ctlz;
+  Value *Func = Intrinsic::getDeclaration(M, IID, Ty);
+
+  // Step 1: Compute the trip count at the end of the preheader. The loop runs
+  // once for each significant bit of x0:
+  //   TripCnt = BitWidth - ctlz(x0)
+  // or, if x0 may be zero, in which case the loop still runs once:
+  //   TripCnt = BitWidth + 1 - ctlz(x0 >> 1)
+  IRBuilder<> Builder(PreHead->getTerminator());
+  Builder.SetCurrentDebugLocation(DefX->getDebugLoc());
+  Value *TripCnt;
+  if (IsNonZero) {
+    Value *Scan = Builder.CreateCall(Func, {InitX, Builder.getTrue()});
+    TripCnt = Builder.CreateSub(ConstantInt::get(Ty, BitWidth), Scan);
+  } else {
+    Value *Next =
+        Builder.CreateBinOp(cast<BinaryOperator>(DefX)->getOpcode(), InitX,
+                            ConstantInt::get(Ty, 1));
+    Value *Scan = Builder.CreateCall(Func, {Next, Builder.getFalse()});
+    TripCnt = Builder.CreateSub(ConstantInt::get(Ty, BitWidth + 1), Scan);
+  }
+
+  // Step 2: All the references to the counter outside the loop are replaced
+  // with its value after TripCnt iterations.
+  Value *CntInitVal = CntPhi->getIncomingValueForBlock(PreHead);
+  Value *NewCount =
+      Builder.CreateZExtOrTrunc(TripCnt, cast<IntegerType>(CntInst->getType()));
+  ConstantInt *InitConst = dyn_cast<ConstantInt>(CntInitVal);
+  if (!InitConst || !InitConst->isZero())
+    NewCount = Builder.CreateAdd(NewCount, CntInitVal);
+  if (isLiveOutOf(CntInst, Body))
+    CntInst->replaceUsesOutsideBlock(NewCount, Body);
+  if (isLiveOutOf(CntPhi, Body))
+    CntPhi->replaceUsesOutsideBlock(
+        Builder.CreateSub(NewCount, ConstantInt::get(NewCount->getType(), 1)),
+        Body);
+
+  // Step 3: Make the loop countable.
+  addTripCount(TripCnt);
+}
+
+/// Recognizes a loop that scans bytes until it finds a zero, and computes
+/// where it stops with a call to strlen instead:
+/// \code
+///    while (*p)
+///      ++p;
+/// \endcode
+///
+/// This is only done if the loop computes nothing else, so that the whole loop
+/// can be deleted: the values of its induction variables at the exit are
+/// computed from the length.
+bool LoopIdiomRecognize::recognizeStrLen() {
+  if (!TLI->has(LibFunc::strlen))
+    return false;
+
+  // Give up if the loop has multiple blocks or multiple backedges.
+  if (CurLoop->getNumBackEdges() != 1 || CurLoop->getNumBlocks() != 1)
+    return false;
+
+  // The loop must go on as long as the byte it loads is non-zero.
+  BasicBlock *Body = *(CurLoop->block_begin());
+  auto *LbBr = dyn_cast<BranchInst>(Body->getTerminator());
+  auto *Load = dyn_cast_or_null<LoadInst>(matchCondition(LbBr, Body));
+  if (!Load || Load->getParent() != Body || !Load->isSimple() ||
+      !Load->getType()->isIntegerTy(8) || Load->getPointerAddressSpace() != 0)
+    return false;
+  Instruction *LbCond = cast<Instruction>(LbBr->getCondition());
+  if (isLiveOutOf(Load, Body) || isLiveOutOf(LbCond, Body))
+    return false;
+
+  // It must load consecutive bytes.
+  auto *Ev = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Load->getPointerOperand()));
+  if (!Ev || Ev->getLoop() != CurLoop || !Ev->isAffine())
+    return false;
+  auto *Stride = dyn_cast<SCEVConstant>(Ev->getStepRecurrence(*SE));
+  if (!Stride || !Stride->getValue()->isOne())
+    return false;
+
+  // Everything else must be an induction variable, whose value at the exit
+  // can be computed from the length.
+  SmallVector<std::pair<Instruction *, const SCEVAddRecExpr *>, 4> LiveOut;
+  for (Instruction &I : *Body) {
+    if (&I == Load || &I == LbCond || &I == LbBr || isa<DbgInfoIntrinsic>(I))
+      continue;
+    if (!SE->isSCEVable(I.getType()))
+      return false;
+    auto *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(&I));
+    if (!AR || AR->getLoop() != CurLoop || !AR->isAffine())
+      return false;
+    if (isLiveOutOf(&I, Body))
+      LiveOut.push_back(std::make_pair(&I, AR));
+  }
+
+  // The loop stops at the iteration that loads the terminating zero, that is
+  // iteration strlen(start).
+  Instruction *InsertPt = CurLoop->getLoopPreheader()->getTerminator();
+  SCEVExpander Expander(*SE, *DL, "loop-idiom");
+  Value *Base = Expander.expandCodeFor(
+      Ev->getStart(), Load->getPointerOperand()->getType(), InsertPt);
+  IRBuilder<> Builder(InsertPt);
+  Builder.SetCurrentDebugLocation(Load->getDebugLoc());
+  Value *Len = emitStrLen(Base, Builder, *DL, TLI);
+  const SCEV *LenS = SE->getSCEV(Len);
+
+  DEBUG(dbgs() << "  Formed strlen: " << *Len << "\n");
+
+  for (auto &P : LiveOut) {
+    Value *ExitVal = Expander.expandCodeFor(
+        P.second->evaluateAtIteration(LenS, *SE), P.first->getType(),
+        InsertPt);
+    P.first->replaceUsesOutsideBlock(ExitVal, Body);
+  }
+
+  addTripCount(Builder.CreateAdd(Len, ConstantInt::get(Len->getType(), 1)));
+  ++NumStrLen;
+  return true;
+}
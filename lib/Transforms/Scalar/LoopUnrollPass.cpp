@@ -28,6 +28,7 @@
 #include "llvm/IR/InstVisitor.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Metadata.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -36,6 +37,7 @@
 #include "llvm/Transforms/Utils/UnrollLoop.h"
 #include <climits>
 #include <utility>
+#include <vector>
 
 using namespace llvm;
 
@@ -216,6 +218,122 @@ struct EstimatedUnrollCost {
   /// rolled form.
   int RolledDynamicCost;
 };
+
+/// \brief A cache of the results of analyzeLoopUnrollCost.
+///
+/// A loop pass sees a loop again when the function pass pipeline it belongs to
+/// is rerun on the function, e.g. by the inliner's devirtualization
+/// iterations. Simulating the iterations of the loop is by far the most
+/// expensive part of deciding whether to fully unroll it, so the result is
+/// reused if the loop hasn't changed since it was simulated.
+///
+/// Each entry keeps a snapshot of the blocks of the loop, their instructions
+/// and the operands of these, along with the initializers its loads could be
+/// folded from. The snapshot uses value handles that become null when their
+/// value is deleted, so that a value allocated at the address of a deleted one
+/// never matches it.
+class UnrollCostCache {
+  /// A value handle that doesn't follow its value when it is replaced.
+  class SnapshotVH final : public CallbackVH {
+  public:
+    SnapshotVH(Value *V) : CallbackVH(V) {}
+  };
+
+public:
+  /// The parameters of the analysis, which the result depends on.
+  struct Parameters {
+    unsigned TripCount;
+    int MaxUnrolledLoopSize;
+    unsigned Threshold;
+    unsigned PercentDynamicCostSavedThreshold;
+
+    bool operator==(const Parameters &RHS) const {
+      return TripCount == RHS.TripCount &&
+             MaxUnrolledLoopSize == RHS.MaxUnrolledLoopSize &&
+             Threshold == RHS.Threshold &&
+             PercentDynamicCostSavedThreshold ==
+                 RHS.PercentDynamicCostSavedThreshold;
+    }
+  };
+
+private:
+  struct Entry {
+    Parameters Params;
+    Optional<EstimatedUnrollCost> Cost;
+    std::vector<SnapshotVH> Snapshot;
+  };
+
+  DenseMap<const BasicBlock *, Entry> Entries;
+
+  static void snapshot(const Loop *L, ScalarEvolution &SE,
+                       function_ref<void(Value *)> Record);
+
+public:
+  /// Return the cached result for \p L, if there is one for these parameters
+  /// and the loop hasn't changed.
+  const Optional<EstimatedUnrollCost> *lookup(const Loop *L,
+                                              ScalarEvolution &SE,
+                                              const Parameters &Params) const;
+
+  void insert(const Loop *L, ScalarEvolution &SE, const Parameters &Params,
+              const Optional<EstimatedUnrollCost> &Cost);
+
+  void clear() { Entries.clear(); }
+};
+}
+
+/// Pass the values that make up the snapshot of \p L to \p Record, in order.
+void UnrollCostCache::snapshot(const Loop *L, ScalarEvolution &SE,
+                               function_ref<void(Value *)> Record) {
+  for (BasicBlock *BB : L->blocks()) {
+    Record(BB);
+    for (Instruction &I : *BB) {
+      Record(&I);
+      for (Value *Op : I.operands())
+        Record(Op);
+
+      // A load from a constant global is folded using its initializer.
+      auto *LI = dyn_cast<LoadInst>(&I);
+      if (!LI || !SE.isSCEVable(LI->getPointerOperand()->getType()))
+        continue;
+      auto *Base = dyn_cast<SCEVUnknown>(
+          SE.getPointerBase(SE.getSCEV(LI->getPointerOperand())));
+      auto *GV = Base ? dyn_cast<GlobalVariable>(Base->getValue()) : nullptr;
+      if (GV && GV->isConstant() && GV->hasDefinitiveInitializer())
+        Record(GV->getInitializer());
+      else
+        Record(nullptr);
+    }
+  }
+}
+
+const Optional<EstimatedUnrollCost> *
+UnrollCostCache::lookup(const Loop *L, ScalarEvolution &SE,
+                        const Parameters &Params) const {
+  auto I = Entries.find(L->getHeader());
+  if (I == Entries.end() || !(I->second.Params == Params))
+    return nullptr;
+
+  const std::vector<SnapshotVH> &Cached = I->second.Snapshot;
+  size_t Idx = 0;
+  bool Matches = true;
+  snapshot(L, SE, [&](Value *V) {
+    Matches = Matches && Idx < Cached.size() && Cached[Idx] == V;
+    ++Idx;
+  });
+  if (!Matches || Idx != Cached.size())
+    return nullptr;
+  return &I->second.Cost;
+}
+
+void UnrollCostCache::insert(const Loop *L, ScalarEvolution &SE,
+                             const Parameters &Params,
+                             const Optional<EstimatedUnrollCost> &Cost) {
+  Entry &E = Entries[L->getHeader()];
+  E.Params = Params;
+  E.Cost = Cost;
+  E.Snapshot.clear();
+  snapshot(L, SE, [&](Value *V) { E.Snapshot.emplace_back(V); });
 }
 
 /// \brief Figure out if the loop is worth full unrolling.
@@ -228,13 +346,16 @@ struct EstimatedUnrollCost {
 /// to be executed (i.e. if we have a branch in the loop and we know that at the
 /// given iteration its condition would be resolved to true, we won't add up the
 /// cost of the 'false'-block).
+/// The analysis stops as soon as it is clear that canUnrollCompletely will
+/// reject the loop given \p Threshold and \p PercentDynamicCostSavedThreshold.
 /// \returns Optional value, holding the RolledDynamicCost and UnrolledCost. If
 /// the analysis failed (no benefits expected from the unrolling, or the loop is
 /// too big to analyze), the returned value is None.
 static Optional<EstimatedUnrollCost>
 analyzeLoopUnrollCost(const Loop *L, unsigned TripCount, DominatorTree &DT,
                       ScalarEvolution &SE, const TargetTransformInfo &TTI,
-                      int MaxUnrolledLoopSize) {
+                      int MaxUnrolledLoopSize, unsigned Threshold,
+                      unsigned PercentDynamicCostSavedThreshold) {
   // We want to be able to scale offsets by the trip count and add more offsets
   // to them without checking for overflows, and we already don't want to
   // analyze *massive* trip counts, so we force the max to be reasonably small.
@@ -366,6 +487,17 @@ analyzeLoopUnrollCost(const Loop *L, unsigned TripCount, DominatorTree &DT,
 
   DEBUG(dbgs() << "Starting LoopUnroll profitability analysis...\n");
 
+  // The most an iteration can add to the rolled dynamic cost, which bounds the
+  // savings the remaining iterations can make.
+  uint64_t MaxIterationCost = 0;
+  for (BasicBlock *BB : L->blocks())
+    for (Instruction &I : *BB)
+      MaxIterationCost += TTI.getUserCost(&I);
+
+  // A single analyzer simulates all the iterations, so that what doesn't
+  // depend on the iteration is only computed once.
+  UnrolledInstAnalyzer Analyzer(0, SimplifiedValues, SE, L);
+
   // Simulate execution of each iteration of the loop counting instructions,
   // which would be simplified.
   // Since the same load will take different values on different iterations,
@@ -400,7 +532,7 @@ analyzeLoopUnrollCost(const Loop *L, unsigned TripCount, DominatorTree &DT,
     while (!SimplifiedInputValues.empty())
       SimplifiedValues.insert(SimplifiedInputValues.pop_back_val());
 
-    UnrolledInstAnalyzer Analyzer(Iteration, SimplifiedValues, SE, L);
+    Analyzer.setIteration(Iteration);
 
     BBWorklist.clear();
     BBWorklist.insert(L->getHeader());
@@ -501,6 +633,23 @@ analyzeLoopUnrollCost(const Loop *L, unsigned TripCount, DominatorTree &DT,
                    << "  UnrolledCost: " << UnrolledCost << "\n");
       return None;
     }
+
+    // Once the unrolled cost is over the threshold, the loop is only unrolled
+    // if enough of the dynamic cost is saved. Even if none of the remaining
+    // iterations added to the unrolled cost, they couldn't save more than
+    // their whole cost, so give up if that isn't enough.
+    if ((unsigned)UnrolledCost > Threshold) {
+      uint64_t MaxRolledDynamicCost =
+          RolledDynamicCost + (TripCount - Iteration - 1) * MaxIterationCost;
+      if ((MaxRolledDynamicCost - UnrolledCost) * 100 <
+          (uint64_t)PercentDynamicCostSavedThreshold * MaxRolledDynamicCost) {
+        DEBUG(dbgs() << "  Can't save enough of the dynamic cost.. exiting.\n"
+                     << "  UnrolledCost: " << UnrolledCost
+                     << ", MaxRolledDynamicCost: " << MaxRolledDynamicCost
+                     << "\n");
+        return None;
+      }
+    }
   }
 
   while (!ExitWorklist.empty()) {
@@ -693,7 +842,8 @@ static bool computeUnrollCount(Loop *L, const TargetTransformInfo &TTI,
                                DominatorTree &DT, LoopInfo *LI,
                                ScalarEvolution *SE, unsigned TripCount,
                                unsigned TripMultiple, unsigned LoopSize,
-                               TargetTransformInfo::UnrollingPreferences &UP) {
+                               TargetTransformInfo::UnrollingPreferences &UP,
+                               UnrollCostCache *CostCache) {
   // BEInsns represents number of instructions optimized when "back edge"
   // becomes "fall through" in unrolled loop.
   // For now we count a conditional branch on a backedge and a comparison
@@ -761,10 +911,25 @@ static bool computeUnrollCount(Loop *L, const TargetTransformInfo &TTI,
     } else {
       // The loop isn't that small, but we still can fully unroll it if that
       // helps to remove a significant number of instructions.
-      // To check that, run additional analysis on the loop.
-      if (Optional<EstimatedUnrollCost> Cost = analyzeLoopUnrollCost(
-              L, TripCount, DT, *SE, TTI,
-              UP.Threshold + UP.DynamicCostSavingsDiscount))
+      // To check that, run additional analysis on the loop, unless it was
+      // already run on the loop as it is.
+      UnrollCostCache::Parameters Params = {
+          TripCount, (int)(UP.Threshold + UP.DynamicCostSavingsDiscount),
+          UP.Threshold, UP.PercentDynamicCostSavedThreshold};
+      const Optional<EstimatedUnrollCost> *CachedCost =
+          CostCache ? CostCache->lookup(L, *SE, Params) : nullptr;
+      Optional<EstimatedUnrollCost> Cost;
+      if (CachedCost) {
+        DEBUG(dbgs() << "  Reusing the analysis of the unchanged loop.\n");
+        Cost = *CachedCost;
+      } else {
+        Cost = analyzeLoopUnrollCost(L, TripCount, DT, *SE, TTI,
+                                     Params.MaxUnrolledLoopSize, UP.Threshold,
+                                     UP.PercentDynamicCostSavedThreshold);
+        if (CostCache)
+          CostCache->insert(L, *SE, Params, Cost);
+      }
+      if (Cost)
         if (canUnrollCompletely(L, UP.Threshold,
                                 UP.PercentDynamicCostSavedThreshold,
                                 UP.DynamicCostSavingsDiscount,
@@ -802,7 +967,7 @@ static bool computeUnrollCount(Loop *L, const TargetTransformInfo &TTI,
         // largest power-of-two factor that satisfies the threshold limit.
         // As we'll create fixup loop, do the type of unrolling only if
         // remainder loop is allowed.
-        UP.Count = DefaultUnrollRuntimeCount;
+        UP.Count = std::min(DefaultUnrollRuntimeCount, UP.MaxCount);
         UnrolledSize = (LoopSize - BEInsns) * UP.Count + BEInsns;
         while (UP.Count != 0 && UnrolledSize > UP.PartialThreshold) {
           UP.Count >>= 1;
@@ -900,7 +1065,8 @@ static bool tryToUnrollLoop(Loop *L, DominatorTree &DT, LoopInfo *LI,
                             Optional<unsigned> ProvidedCount,
                             Optional<unsigned> ProvidedThreshold,
                             Optional<bool> ProvidedAllowPartial,
-                            Optional<bool> ProvidedRuntime) {
+                            Optional<bool> ProvidedRuntime,
+                            UnrollCostCache *CostCache) {
   DEBUG(dbgs() << "Loop Unroll: F[" << L->getHeader()->getParent()->getName()
                << "] Loop %" << L->getHeader()->getName() << "\n");
   if (HasUnrollDisablePragma(L)) {
@@ -961,8 +1127,8 @@ static bool tryToUnrollLoop(Loop *L, DominatorTree &DT, LoopInfo *LI,
   if (Convergent)
     UP.AllowRemainder = false;
 
-  bool IsCountSetExplicitly = computeUnrollCount(L, TTI, DT, LI, SE, TripCount,
-                                                 TripMultiple, LoopSize, UP);
+  bool IsCountSetExplicitly = computeUnrollCount(
+      L, TTI, DT, LI, SE, TripCount, TripMultiple, LoopSize, UP, CostCache);
   if (!UP.Count)
     return false;
   // Unroll factor (Count) must be less or equal to TripCount.
@@ -1000,6 +1166,9 @@ public:
   Optional<bool> ProvidedAllowPartial;
   Optional<bool> ProvidedRuntime;
 
+  /// The results of the full unroll analysis of the loops this pass has seen.
+  UnrollCostCache CostCache;
+
   bool runOnLoop(Loop *L, LPPassManager &) override {
     if (skipLoop(L))
       return false;
@@ -1016,7 +1185,12 @@ public:
 
     return tryToUnrollLoop(L, DT, LI, SE, TTI, AC, PreserveLCSSA, ProvidedCount,
                            ProvidedThreshold, ProvidedAllowPartial,
-                           ProvidedRuntime);
+                           ProvidedRuntime, &CostCache);
+  }
+
+  bool doFinalization(Module &) override {
+    CostCache.clear();
+    return false;
   }
 
   /// This transformation requires natural loop information & requires that
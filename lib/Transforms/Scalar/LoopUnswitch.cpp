@@ -251,7 +251,7 @@ namespace {
     void EmitPreheaderBranchOnCondition(Value *LIC, Constant *Val,
                                         BasicBlock *TrueDest,
                                         BasicBlock *FalseDest,
-                                        Instruction *InsertPt,
+                                        BranchInst *OldBranch,
                                         TerminatorInst *TI);
 
     void SimplifyCode(std::vector<Instruction*> &Worklist, Loop *L);
@@ -477,9 +477,9 @@ bool LoopUnswitch::runOnLoop(Loop *L, LPPassManager &LPM_Ref) {
     Changed |= processCurrentLoop();
   } while(redoLoop);
 
-  // FIXME: Reconstruct dom info, because it is not preserved properly.
+  // The dominator tree has been updated along with the CFG.
   if (Changed)
-    DT->recalculate(*F);
+    DEBUG(DT->verifyDomTree());
   return Changed;
 }
 
@@ -779,19 +779,25 @@ static void copyMetadata(Instruction *DstInst, const Instruction *SrcInst,
 }
 
 /// Emit a conditional branch on two values if LIC == Val, branch to TrueDst,
-/// otherwise branch to FalseDest. Insert the code immediately before InsertPt.
+/// otherwise branch to FalseDest. The code replaces OldBranch, an
+/// unconditional branch to one of the two destinations.
 void LoopUnswitch::EmitPreheaderBranchOnCondition(Value *LIC, Constant *Val,
                                                   BasicBlock *TrueDest,
                                                   BasicBlock *FalseDest,
-                                                  Instruction *InsertPt,
+                                                  BranchInst *OldBranch,
                                                   TerminatorInst *TI) {
+  assert(OldBranch->isUnconditional() &&
+         (OldBranch->getSuccessor(0) == TrueDest ||
+          OldBranch->getSuccessor(0) == FalseDest) &&
+         "Preheader does not branch to either destination!");
+
   // Insert a conditional branch on LIC to the two preheaders.  The original
   // code is the true version and the new code is the false version.
   Value *BranchVal = LIC;
   bool Swapped = false;
   if (!isa<ConstantInt>(Val) ||
       Val->getType() != Type::getInt1Ty(LIC->getContext()))
-    BranchVal = new ICmpInst(InsertPt, ICmpInst::ICMP_EQ, LIC, Val);
+    BranchVal = new ICmpInst(OldBranch, ICmpInst::ICMP_EQ, LIC, Val);
   else if (Val != ConstantInt::getTrue(Val->getContext())) {
     // We want to enter the new loop when the condition is true.
     std::swap(TrueDest, FalseDest);
@@ -799,9 +805,18 @@ void LoopUnswitch::EmitPreheaderBranchOnCondition(Value *LIC, Constant *Val,
   }
 
   // Insert the new branch.
-  BranchInst *BI = BranchInst::Create(TrueDest, FalseDest, BranchVal, InsertPt);
+  BranchInst *BI =
+      BranchInst::Create(TrueDest, FalseDest, BranchVal, OldBranch);
   copyMetadata(BI, TI, Swapped);
 
+  // Remove the old branch and tell the dominator tree about the new edge, so
+  // that it is up to date for the edge splitting below.
+  BasicBlock *NewDest =
+      OldBranch->getSuccessor(0) == TrueDest ? FalseDest : TrueDest;
+  LPM->deleteSimpleAnalysisValue(OldBranch, currentLoop);
+  OldBranch->eraseFromParent();
+  DT->insertEdge(BI->getParent(), NewDest);
+
   // If either edge is critical, split it. This helps preserve LoopSimplify
   // form for enclosing loops.
   auto Options = CriticalEdgeSplittingOptions(DT, LI).setPreserveLCSSA();
@@ -841,10 +856,9 @@ void LoopUnswitch::UnswitchTrivialCondition(Loop *L, Value *Cond, Constant *Val,
 
   // Okay, now we have a position to branch from and a position to branch to,
   // insert the new conditional branch.
-  EmitPreheaderBranchOnCondition(Cond, Val, NewExit, NewPH,
-                                 loopPreheader->getTerminator(), TI);
-  LPM->deleteSimpleAnalysisValue(loopPreheader->getTerminator(), L);
-  loopPreheader->getTerminator()->eraseFromParent();
+  EmitPreheaderBranchOnCondition(
+      Cond, Val, NewExit, NewPH,
+      cast<BranchInst>(loopPreheader->getTerminator()), TI);
 
   // We need to reprocess this loop, it could be unswitched again.
   redoLoop = true;
@@ -1144,8 +1158,6 @@ void LoopUnswitch::UnswitchNontrivialCondition(Value *LIC, Constant *Val,
   // Emit the new branch that selects between the two versions of this loop.
   EmitPreheaderBranchOnCondition(LIC, Val, NewBlocks[0], LoopBlocks[0], OldBR,
                                  TI);
-  LPM->deleteSimpleAnalysisValue(OldBR, L);
-  OldBR->eraseFromParent();
 
   LoopProcessWorklist.push_back(NewLoop);
   redoLoop = true;
@@ -1306,10 +1318,8 @@ void LoopUnswitch::RewriteLoopBodyWithConditionConstant(Loop *L, Value *LIC,
          PHINode *PN = dyn_cast<PHINode>(II); ++II)
       PN->setIncomingValue(PN->getBasicBlockIndex(Switch),
                            UndefValue::get(PN->getType()));
-    // Tell the domtree about the new block. We don't fully update the
-    // domtree here -- instead we force it to do a full recomputation
-    // after the pass is complete -- but we do need to inform it of
-    // new blocks.
+    // Tell the domtree about the new block. As the edge to OldSISucc stays,
+    // nothing else changes.
     DT->addNewBlock(Abort, NewSISucc);
   }
 
@@ -1383,6 +1393,15 @@ void LoopUnswitch::SimplifyCode(std::vector<Instruction*> &Worklist, Loop *L) {
         BI->eraseFromParent();
         RemoveFromWorklist(BI, Worklist);
 
+        // The blocks Succ dominated are now dominated by Pred.
+        if (DomTreeNode *SuccNode = DT->getNode(Succ)) {
+          DomTreeNode *PredNode = DT->getNode(Pred);
+          while (!SuccNode->getChildren().empty())
+            DT->changeImmediateDominator(SuccNode->getChildren().back(),
+                                         PredNode);
+          DT->eraseNode(Succ);
+        }
+
         // Remove Succ from the loop tree.
         LI->removeBlock(Succ);
         LPM->deleteSimpleAnalysisValue(Succ, L);
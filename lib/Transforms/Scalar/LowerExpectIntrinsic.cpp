@@ -172,10 +172,13 @@ static bool lowerExpectIntrinsic(Function &F) {
 
 PreservedAnalyses LowerExpectIntrinsicPass::run(Function &F,
                                                 FunctionAnalysisManager &) {
-  if (lowerExpectIntrinsic(F))
-    return PreservedAnalyses::none();
+  if (!lowerExpectIntrinsic(F))
+    return PreservedAnalyses::all();
 
-  return PreservedAnalyses::all();
+  // The branch weights change, but the CFG does not.
+  PreservedAnalyses PA;
+  PA.preserveSet<CFGAnalyses>();
+  return PA;
 }
 
 namespace {
@@ -207,9 +207,10 @@ static void computeLiveInValues(DominatorTree &DT, Function &F,
                                 GCPtrLivenessData &Data);
 
 /// Given results from the dataflow liveness computation, find the set of live
-/// Values at a particular instruction.
-static void findLiveSetAtInst(Instruction *inst, GCPtrLivenessData &Data,
-                              StatepointLiveSetTy &out);
+/// Values at each of the given call sites.
+static void findLiveSetsAtCallSites(ArrayRef<CallSite> CallSites,
+                                    GCPtrLivenessData &Data,
+                                    MutableArrayRef<StatepointLiveSetTy> Out);
 
 // TODO: Once we can get to the GCStrategy, this becomes
 // Optional<bool> isGCManagedPointer(const Type *Ty) const override {
@@ -274,14 +275,9 @@ static std::string suffixed_name_or(Value *V, StringRef Suffix,
 // given instruction. Values defined by that instruction are not considered
 // live.  Values used by that instruction are considered live.
 static void
-analyzeParsePointLiveness(DominatorTree &DT,
-                          GCPtrLivenessData &OriginalLivenessData, CallSite CS,
+analyzeParsePointLiveness(DominatorTree &DT, StatepointLiveSetTy &LiveSet,
+                          CallSite CS,
                           PartiallyConstructedSafepointRecord &Result) {
-  Instruction *Inst = CS.getInstruction();
-
-  StatepointLiveSetTy LiveSet;
-  findLiveSetAtInst(Inst, OriginalLivenessData, LiveSet);
-
   if (PrintLiveSet) {
     dbgs() << "Live Variables:\n";
     for (Value *V : LiveSet)
@@ -291,7 +287,7 @@ analyzeParsePointLiveness(DominatorTree &DT,
     dbgs() << "Safepoint For: " << CS.getCalledValue()->getName() << "\n";
     dbgs() << "Number live values: " << LiveSet.size() << "\n";
   }
-  Result.LiveSet = LiveSet;
+  Result.LiveSet = std::move(LiveSet);
 }
 
 static bool isKnownBaseResult(Value *V);
@@ -1056,10 +1052,8 @@ static void findBasePointers(DominatorTree &DT, DefiningValueMapTy &DVCache,
   result.PointerToBase = PointerToBase;
 }
 
-/// Given an updated version of the dataflow liveness results, update the
-/// liveset and base pointer maps for the call site CS.
-static void recomputeLiveInValues(GCPtrLivenessData &RevisedLivenessData,
-                                  CallSite CS,
+/// Given the updated live set at a call site, update its base pointer map.
+static void recomputeLiveInValues(StatepointLiveSetTy &Updated,
                                   PartiallyConstructedSafepointRecord &result);
 
 static void recomputeLiveInValues(
@@ -1069,9 +1063,11 @@ static void recomputeLiveInValues(
   // again.  The old values are still live and will help it stabilize quickly.
   GCPtrLivenessData RevisedLivenessData;
   computeLiveInValues(DT, F, RevisedLivenessData);
+  SmallVector<StatepointLiveSetTy, 64> LiveSets(toUpdate.size());
+  findLiveSetsAtCallSites(toUpdate, RevisedLivenessData, LiveSets);
   for (size_t i = 0; i < records.size(); i++) {
     struct PartiallyConstructedSafepointRecord &info = records[i];
-    recomputeLiveInValues(RevisedLivenessData, toUpdate[i], info);
+    recomputeLiveInValues(LiveSets[i], info);
   }
 }
 
@@ -1777,9 +1773,11 @@ static void findLiveReferences(
     MutableArrayRef<struct PartiallyConstructedSafepointRecord> records) {
   GCPtrLivenessData OriginalLivenessData;
   computeLiveInValues(DT, F, OriginalLivenessData);
+  SmallVector<StatepointLiveSetTy, 64> LiveSets(toUpdate.size());
+  findLiveSetsAtCallSites(toUpdate, OriginalLivenessData, LiveSets);
   for (size_t i = 0; i < records.size(); i++) {
     struct PartiallyConstructedSafepointRecord &info = records[i];
-    analyzeParsePointLiveness(DT, OriginalLivenessData, toUpdate[i], info);
+    analyzeParsePointLiveness(DT, LiveSets[i], toUpdate[i], info);
   }
 }
 
@@ -2533,31 +2531,45 @@ static void computeLiveInValues(DominatorTree &DT, Function &F,
 #endif
 }
 
-static void findLiveSetAtInst(Instruction *Inst, GCPtrLivenessData &Data,
-                              StatepointLiveSetTy &Out) {
-
-  BasicBlock *BB = Inst->getParent();
-
-  // Note: The copy is intentional and required
-  assert(Data.LiveOut.count(BB));
-  SetVector<Value *> LiveOut = Data.LiveOut[BB];
+static void findLiveSetsAtCallSites(ArrayRef<CallSite> CallSites,
+                                    GCPtrLivenessData &Data,
+                                    MutableArrayRef<StatepointLiveSetTy> Out) {
+  // Walk each block that contains call sites backwards once, from its live-out
+  // set, rather than once per call site: functions can have thousands of them.
+  DenseMap<Instruction *, unsigned> CallSiteIndex;
+  SmallSetVector<BasicBlock *, 32> Blocks;
+  for (unsigned i = 0, e = CallSites.size(); i != e; ++i) {
+    Instruction *Inst = CallSites[i].getInstruction();
+    CallSiteIndex[Inst] = i;
+    Blocks.insert(Inst->getParent());
+  }
+
+  for (BasicBlock *BB : Blocks) {
+    // Note: The copy is intentional and required
+    assert(Data.LiveOut.count(BB));
+    SetVector<Value *> LiveOut = Data.LiveOut[BB];
 
-  // We want to handle the statepoint itself oddly.  It's
-  // call result is not live (normal), nor are it's arguments
-  // (unless they're used again later).  This adjustment is
-  // specifically what we need to relocate
-  BasicBlock::reverse_iterator rend(Inst->getIterator());
-  computeLiveInValues(BB->rbegin(), rend, LiveOut);
-  LiveOut.remove(Inst);
-  Out.insert(LiveOut.begin(), LiveOut.end());
+    BasicBlock::reverse_iterator Begin = BB->rbegin();
+    for (auto I = BB->rbegin(), E = BB->rend(); I != E; ++I) {
+      auto It = CallSiteIndex.find(&*I);
+      if (It == CallSiteIndex.end())
+        continue;
+      // We want to handle the statepoint itself oddly.  It's
+      // call result is not live (normal), nor are it's arguments
+      // (unless they're used again later).  This adjustment is
+      // specifically what we need to relocate
+      BasicBlock::reverse_iterator End = std::next(I);
+      computeLiveInValues(Begin, End, LiveOut);
+      Begin = End;
+      StatepointLiveSetTy &LiveSet = Out[It->second];
+      LiveSet.insert(LiveOut.begin(), LiveOut.end());
+      LiveSet.remove(&*I);
+    }
+  }
 }
 
-static void recomputeLiveInValues(GCPtrLivenessData &RevisedLivenessData,
-                                  CallSite CS,
+static void recomputeLiveInValues(StatepointLiveSetTy &Updated,
                                   PartiallyConstructedSafepointRecord &Info) {
-  Instruction *Inst = CS.getInstruction();
-  StatepointLiveSetTy Updated;
-  findLiveSetAtInst(Inst, RevisedLivenessData, Updated);
 
 #ifndef NDEBUG
   DenseSet<Value *> Bases;
@@ -2594,5 +2606,5 @@ static void recomputeLiveInValues(GCPtrLivenessData &RevisedLivenessData,
     assert(Updated.count(KVPair.first) && "record for non-live value");
 #endif
 
-  Info.LiveSet = Updated;
+  Info.LiveSet = std::move(Updated);
 }
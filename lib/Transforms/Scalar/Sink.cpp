@@ -259,8 +259,7 @@ PreservedAnalyses SinkingPass::run(Function &F, AnalysisManager<Function> &AM) {
     return PreservedAnalyses::all();
 
   auto PA = PreservedAnalyses();
-  PA.preserve<DominatorTreeAnalysis>();
-  PA.preserve<LoopAnalysis>();
+  PA.preserveSet<CFGAnalyses>();
   return PA;
 }
 
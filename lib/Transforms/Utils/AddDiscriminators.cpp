@@ -254,5 +254,7 @@ PreservedAnalyses AddDiscriminatorsPass::run(Function &F,
     return PreservedAnalyses::all();
 
   // FIXME: should be all()
-  return PreservedAnalyses::none();
+  PreservedAnalyses PA;
+  PA.preserveSet<CFGAnalyses>();
+  return PA;
 }
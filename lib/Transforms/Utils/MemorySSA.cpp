@@ -395,6 +395,10 @@ void MemorySSA::buildMemorySSA() {
 
   MemorySSAWalker *Walker = getWalker();
 
+  // The IR doesn't change while the uses are optimized, so let the alias
+  // analyses cache across the queries.
+  AliasAnalysis::BatchQueryScope Batch(*AA);
+
   // Now optimize the MemoryUse's defining access to point to the nearest
   // dominating clobbering def.
   // This ensures that MemoryUse's that are killed by the same store are
@@ -880,6 +884,12 @@ void MemoryAccess::dump() const {
   dbgs() << "\n";
 }
 
+bool MemorySSA::invalidate(Function &F, const PreservedAnalyses &PA) {
+  return !PA.preserved<MemorySSAAnalysis>() || !PA.preserved<AAManager>() ||
+         !(PA.preserved<DominatorTreeAnalysis>() ||
+           PA.preservedSet<CFGAnalyses>());
+}
+
 char MemorySSAAnalysis::PassID;
 
 MemorySSA MemorySSAAnalysis::run(Function &F, AnalysisManager<Function> &AM) {
@@ -180,7 +180,9 @@ class LargeBlockInfo {
   ///
   /// The index starts out as the number of the instruction from the start of
   /// the block.
-  DenseMap<const Instruction *, unsigned> InstNumbers;
+  DenseMap<const Instruction *, unsigned,
+           MixedPtrDenseMapInfo<const Instruction>>
+      InstNumbers;
 
 public:
 
@@ -196,7 +198,7 @@ public:
            "Not a load/store to/from an alloca?");
 
     // If we already have this instruction number, return it.
-    DenseMap<const Instruction *, unsigned>::iterator It = InstNumbers.find(I);
+    auto It = InstNumbers.find(I);
     if (It != InstNumbers.end())
       return It->second;
 
@@ -262,7 +264,7 @@ struct PromoteMem2Reg {
 
   /// Contains a stable numbering of basic blocks to avoid non-determinstic
   /// behavior.
-  DenseMap<BasicBlock *, unsigned> BBNumbers;
+  DenseMap<BasicBlock *, unsigned, MixedPtrDenseMapInfo<BasicBlock>> BBNumbers;
 
   /// Lazily compute the number of predecessors a block has.
   DenseMap<const BasicBlock *, unsigned> BBNumPreds;
@@ -520,6 +522,7 @@ void PromoteMem2Reg::run() {
   if (AST)
     PointerAllocaValues.resize(Allocas.size());
   AllocaDbgDeclares.resize(Allocas.size());
+  AllocaLookup.reserve(Allocas.size());
 
   AllocaInfo Info;
   LargeBlockInfo LBI;
@@ -574,6 +577,7 @@ void PromoteMem2Reg::run() {
     // now.
     if (BBNumbers.empty()) {
       unsigned ID = 0;
+      BBNumbers.reserve(F.size());
       for (auto &BB : F)
         BBNumbers[&BB] = ID++;
     }
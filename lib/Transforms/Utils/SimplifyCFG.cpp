@@ -4714,10 +4714,13 @@ ShouldBuildLookupTable(SwitchInst *SI, uint64_t TableSize,
   if (HasIllegalType)
     return false;
 
-  // The table density should be at least 40%. This is the same criterion as for
-  // jump tables, see SelectionDAGBuilder::handleJTSwitchCase.
+  // A lookup table replaces the jump table the switch would otherwise become,
+  // so it has to be dense enough for one. It also holds a result for every
+  // value in its range rather than a block address, so require a density of
+  // at least 40% even where the target accepts sparser jump tables.
   // FIXME: Find the best cut-off.
-  return SI->getNumCases() * 10 >= TableSize * 4;
+  return SI->getNumCases() * 10 >= TableSize * 4 &&
+         TTI.isSuitableForJumpTable(SI, SI->getNumCases(), TableSize);
 }
 
 /// Try to reuse the switch table index compare. Following pattern:
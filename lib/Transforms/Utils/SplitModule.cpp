@@ -19,7 +19,9 @@
 #include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/Analysis/CallGraph.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalAlias.h"
@@ -73,12 +75,53 @@ static void addAllGlobalValueUsers(ClusterMapType &GVtoClusterMap,
   }
 }
 
+// Returns a rough estimate of the amount of code generated for GV, used to
+// balance the work done by each partition. Functions are weighted by their
+// instruction count; every other global counts as a single unit.
+static unsigned getCodeSizeEstimate(const GlobalValue *GV) {
+  const Function *F = dyn_cast<Function>(GV);
+  if (!F)
+    return 1;
+  unsigned Size = 0;
+  for (const BasicBlock &BB : *F)
+    Size += BB.size();
+  return std::max(Size, 1u);
+}
+
+// Keeps the functions of each strongly connected component of the call graph
+// in one cluster, and makes every other definition a cluster of its own, so
+// that all of them are assigned by size rather than by the hash of their name.
+static void addCallGraphClusters(Module *M, ClusterMapType &GVtoClusterMap) {
+  CallGraph CG(*M);
+  for (scc_iterator<CallGraph *> I = scc_begin(&CG); !I.isAtEnd(); ++I) {
+    const Function *Leader = nullptr;
+    for (CallGraphNode *Node : *I) {
+      const Function *F = Node->getFunction();
+      if (!F || F->isDeclaration())
+        continue;
+      if (Leader)
+        GVtoClusterMap.unionSets(Leader, F);
+      else
+        Leader = F;
+    }
+  }
+
+  auto insertGV = [&GVtoClusterMap](const GlobalValue &GV) {
+    if (!GV.isDeclaration())
+      GVtoClusterMap.insert(&GV);
+  };
+  std::for_each(M->begin(), M->end(), insertGV);
+  std::for_each(M->global_begin(), M->global_end(), insertGV);
+  std::for_each(M->alias_begin(), M->alias_end(), insertGV);
+  std::for_each(M->ifunc_begin(), M->ifunc_end(), insertGV);
+}
+
 // Find partitions for module in the way that no locals need to be
 // globalized.
 // Try to balance pack those partitions into N files since this roughly equals
 // thread balancing for the backend codegen step.
 static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
-                           unsigned N) {
+                           unsigned N, bool ClusterCallGraph) {
   // At this point module should have the proper mix of globals and locals.
   // As we attempt to partition this module, we must not change any
   // locals to globals.
@@ -129,8 +172,11 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   std::for_each(M->global_begin(), M->global_end(), recordGVSet);
   std::for_each(M->alias_begin(), M->alias_end(), recordGVSet);
 
-  // Assigned all GVs to merged clusters while balancing number of objects in
-  // each.
+  if (ClusterCallGraph)
+    addCallGraphClusters(M, GVtoClusterMap);
+
+  // Assigned all GVs to merged clusters while balancing the estimated code
+  // size of each.
   auto CompareClusters = [](const std::pair<unsigned, unsigned> &a,
                             const std::pair<unsigned, unsigned> &b) {
     if (a.second || b.second)
@@ -155,10 +201,14 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   // When size is the same, use leader's name.
   for (ClusterMapType::iterator I = GVtoClusterMap.begin(),
                                 E = GVtoClusterMap.end(); I != E; ++I)
-    if (I->isLeader())
-      Sets.push_back(
-          std::make_pair(std::distance(GVtoClusterMap.member_begin(I),
-                                       GVtoClusterMap.member_end()), I));
+    if (I->isLeader()) {
+      unsigned ClusterCost = 0;
+      for (ClusterMapType::member_iterator MI = GVtoClusterMap.member_begin(I),
+                                           ME = GVtoClusterMap.member_end();
+           MI != ME; ++MI)
+        ClusterCost += getCodeSizeEstimate(*MI);
+      Sets.push_back(std::make_pair(ClusterCost, I));
+    }
 
   std::sort(Sets.begin(), Sets.end(), [](const SortType &a, const SortType &b) {
     if (a.first == b.first)
@@ -184,9 +234,9 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
                    << ((*MI)->hasLocalLinkage() ? " l " : " e ") << "\n");
       Visited.insert(*MI);
       ClusterIDMap[*MI] = CurrentClusterID;
-      CurrentClusterSize++;
     }
-    // Add this set size to the number of entries in this cluster.
+    // Add this set's size to the size of this partition.
+    CurrentClusterSize += I.first;
     BalancinQueue.push(std::make_pair(CurrentClusterID, CurrentClusterSize));
   }
 }
@@ -228,7 +278,7 @@ static bool isInPartition(const GlobalValue *GV, unsigned I, unsigned N) {
 void llvm::SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals) {
+    bool PreserveLocals, bool ClusterCallGraph) {
   if (!PreserveLocals) {
     for (Function &F : *M)
       externalize(&F);
@@ -243,7 +293,7 @@ void llvm::SplitModule(
   // This performs splitting without a need for externalization, which might not
   // always be possible.
   ClusterIDMapType ClusterIDMap;
-  findPartitions(M.get(), ClusterIDMap, N);
+  findPartitions(M.get(), ClusterIDMap, N, ClusterCallGraph);
 
   // FIXME: We should be able to reuse M as the last partition instead of
   // cloning it.
@@ -99,6 +99,7 @@
 #include "llvm/Transforms/Utils/Local.h"
 #include "llvm/Transforms/Utils/LoopUtils.h"
 #include "llvm/Transforms/Utils/LoopVersioning.h"
+#include "llvm/Transforms/Utils/UnrollLoop.h"
 #include "llvm/Transforms/Vectorize.h"
 #include <algorithm>
 #include <functional>
@@ -113,6 +114,8 @@ using namespace llvm::PatternMatch;
 
 STATISTIC(LoopsVectorized, "Number of loops vectorized");
 STATISTIC(LoopsAnalyzed, "Number of loops analyzed for vectorization");
+STATISTIC(OuterLoopsFlattened,
+          "Number of outer loops whose inner loop was unrolled to vectorize");
 
 static cl::opt<bool>
     EnableIfConversion("enable-if-conversion", cl::init(true), cl::Hidden,
@@ -134,12 +137,27 @@ static cl::opt<bool> EnableInterleavedMemAccesses(
     "enable-interleaved-mem-accesses", cl::init(false), cl::Hidden,
     cl::desc("Enable vectorization on interleaved memory accesses in a loop"));
 
+static cl::opt<bool> EnableMaskedInterleavedMemAccesses(
+    "enable-masked-interleaved-mem-accesses", cl::init(false), cl::Hidden,
+    cl::desc("Enable vectorization on interleaved memory accesses with gaps "
+             "using masked loads and stores"));
+
 /// Maximum factor for an interleaved memory access.
 static cl::opt<unsigned> MaxInterleaveGroupFactor(
     "max-interleave-group-factor", cl::Hidden,
     cl::desc("Maximum factor for an interleaved access group (default = 8)"),
     cl::init(8));
 
+static cl::opt<bool> EnableOuterLoopVectorization(
+    "enable-outer-loop-vectorization", cl::init(false), cl::Hidden,
+    cl::desc("Vectorize outer loops whose only inner loop has a small "
+             "constant trip count, by fully unrolling the inner loop"));
+
+static cl::opt<unsigned> OuterLoopMaxInnerTripCount(
+    "outer-loop-vectorize-max-inner-trip-count", cl::init(8), cl::Hidden,
+    cl::desc("The largest trip count of an inner loop that is unrolled to "
+             "vectorize its outer loop (default = 8)"));
+
 /// We don't interleave loops with a known constant trip count below this
 /// number.
 static const unsigned TinyTripCountInterleaveThreshold = 128;
@@ -701,11 +719,13 @@ void InnerLoopVectorizer::addMetadata(ArrayRef<Value *> To,
 ///        }
 ///
 /// Note: the interleaved load group could have gaps (missing members), but
-/// the interleaved store group doesn't allow gaps.
+/// the interleaved store group doesn't allow gaps, unless the group is masked:
+/// then it is accessed with a masked load or store that skips the gaps.
 class InterleaveGroup {
 public:
   InterleaveGroup(Instruction *Instr, int Stride, unsigned Align)
-      : Align(Align), SmallestKey(0), LargestKey(0), InsertPos(Instr) {
+      : Masked(false), Align(Align), SmallestKey(0), LargestKey(0),
+        InsertPos(Instr) {
     assert(Align && "The alignment should be non-zero");
 
     Factor = std::abs(Stride);
@@ -716,6 +736,8 @@ public:
   }
 
   bool isReverse() const { return Reverse; }
+  bool isMasked() const { return Masked; }
+  void setMasked() { Masked = true; }
   unsigned getFactor() const { return Factor; }
   unsigned getAlignment() const { return Align; }
   unsigned getNumMembers() const { return Members.size(); }
@@ -781,6 +803,7 @@ public:
 private:
   unsigned Factor; // Interleave Factor.
   bool Reverse;
+  bool Masked;
   unsigned Align;
   DenseMap<int, Instruction *> Members;
   int SmallestKey;
@@ -811,8 +834,9 @@ private:
 class InterleavedAccessInfo {
 public:
   InterleavedAccessInfo(PredicatedScalarEvolution &PSE, Loop *L,
-                        DominatorTree *DT, LoopInfo *LI)
-      : PSE(PSE), TheLoop(L), DT(DT), LI(LI), LAI(nullptr),
+                        DominatorTree *DT, LoopInfo *LI,
+                        const TargetTransformInfo *TTI)
+      : PSE(PSE), TheLoop(L), DT(DT), LI(LI), TTI(TTI), LAI(nullptr),
         RequiresScalarEpilogue(false) {}
 
   ~InterleavedAccessInfo() {
@@ -825,8 +849,10 @@ public:
   }
 
   /// \brief Analyze the interleaved accesses and collect them in interleave
-  /// groups. Substitute symbolic strides using \p Strides.
-  void analyzeInterleaving(const ValueToValueMap &Strides);
+  /// groups. Substitute symbolic strides using \p Strides. If \p UseMasking
+  /// is set, the groups with gaps that the target can load or store with a
+  /// mask are kept as masked groups.
+  void analyzeInterleaving(const ValueToValueMap &Strides, bool UseMasking);
 
   /// \brief Check if \p Instr belongs to any interleave group.
   bool isInterleaved(Instruction *Instr) const {
@@ -866,6 +892,7 @@ private:
   Loop *TheLoop;
   DominatorTree *DT;
   LoopInfo *LI;
+  const TargetTransformInfo *TTI;
   const LoopAccessInfo *LAI;
 
   /// True if the loop may contain non-reversed interleaved groups with
@@ -909,6 +936,30 @@ private:
     return InterleaveGroupMap[Instr];
   }
 
+  /// \brief Returns true if the target can access the members of \p Group
+  /// with a masked load or store that skips its gaps.
+  ///
+  /// The group is accessed as a single <VF * Factor x T> vector. The
+  /// vectorization factor isn't known yet, so check every one that the cost
+  /// model may pick for T.
+  bool canMaskGroup(const InterleaveGroup *Group) const {
+    Instruction *Leader = Group->getMember(0);
+    auto *LI = dyn_cast<LoadInst>(Leader);
+    Type *EltTy = LI ? LI->getType()
+                     : cast<StoreInst>(Leader)->getValueOperand()->getType();
+    const DataLayout &DL = Leader->getModule()->getDataLayout();
+    // With MaximizeBandwidth, the smallest type in the loop bounds the VF.
+    unsigned EltBits = MaximizeBandwidth ? 8 : DL.getTypeSizeInBits(EltTy);
+    unsigned MaxVF = std::max(2u, TTI->getRegisterBitWidth(true) / EltBits);
+    for (unsigned VF = 2; VF <= MaxVF; VF *= 2) {
+      Type *WideTy = VectorType::get(EltTy, VF * Group->getFactor());
+      if (LI ? !TTI->isLegalMaskedLoad(WideTy)
+             : !TTI->isLegalMaskedStore(WideTy))
+        return false;
+    }
+    return true;
+  }
+
   /// \brief Release the group and remove all the relationships.
   void releaseGroup(InterleaveGroup *Group) {
     for (unsigned i = 0; i < Group->getFactor(); i++)
@@ -1330,7 +1381,7 @@ public:
                             LoopVectorizeHints *H)
       : NumPredStores(0), TheLoop(L), PSE(PSE), TLI(TLI), TheFunction(F),
         TTI(TTI), DT(DT), LAA(LAA), LAI(nullptr),
-        InterleaveInfo(PSE, L, DT, LI), Induction(nullptr),
+        InterleaveInfo(PSE, L, DT, LI, TTI), Induction(nullptr),
         WidestIndTy(nullptr), HasFunNoNaNAttr(false), Requirements(R),
         Hints(H) {}
 
@@ -1760,12 +1811,41 @@ private:
   Instruction *UnsafeAlgebraInst;
 };
 
-static void addInnerLoop(Loop &L, SmallVectorImpl<Loop *> &V) {
-  if (L.empty())
+/// Return the inner loop of \p L if \p L is an outer loop that should be
+/// vectorized along its own induction variable, that is if its only inner loop
+/// is innermost and has a small constant trip count. The inner loop is then
+/// fully unrolled, so its iterations become uniform code in the body of \p L.
+static Loop *getOuterLoopCandidate(Loop &L, ScalarEvolution &SE,
+                                   bool DisableUnrolling) {
+  if (L.getSubLoops().size() != 1)
+    return nullptr;
+  Loop *InnerL = L.getSubLoops().front();
+  if (!InnerL->empty())
+    return nullptr;
+
+  // Outer loops are only vectorized when asked for, either for all loops or
+  // with a pragma on this one.
+  if (!EnableOuterLoopVectorization &&
+      LoopVectorizeHints(&L, DisableUnrolling).getForce() !=
+          LoopVectorizeHints::FK_Enabled)
+    return nullptr;
+
+  unsigned TC = SE.getSmallConstantTripCount(InnerL);
+  if (TC == 0 || TC > OuterLoopMaxInnerTripCount)
+    return nullptr;
+  return InnerL;
+}
+
+/// Collect the inner loops of \p L to vectorize, or the outer loops that
+/// getOuterLoopCandidate picks instead of their inner loop.
+static void addCandidateLoop(Loop &L, ScalarEvolution &SE,
+                             bool DisableUnrolling,
+                             SmallVectorImpl<Loop *> &V) {
+  if (L.empty() || getOuterLoopCandidate(L, SE, DisableUnrolling))
     return V.push_back(&L);
 
   for (Loop *InnerL : L)
-    addInnerLoop(*InnerL, V);
+    addCandidateLoop(*InnerL, SE, DisableUnrolling, V);
 }
 
 /// The LoopVectorize Pass.
@@ -1831,7 +1911,7 @@ struct LoopVectorize : public FunctionPass {
     SmallVector<Loop *, 8> Worklist;
 
     for (Loop *L : *LI)
-      addInnerLoop(*L, Worklist);
+      addCandidateLoop(*L, *SE, DisableUnrolling, Worklist);
 
     LoopsAnalyzed += Worklist.size();
 
@@ -1878,7 +1958,35 @@ struct LoopVectorize : public FunctionPass {
     }
   }
 
+  /// Fully unroll the inner loop of the outer loop candidate \p L, so that
+  /// \p L becomes an inner loop. Return false if \p L can't be flattened.
+  ///
+  /// The unrolling is kept even if \p L then isn't vectorized, which is what
+  /// the loop unroller would do for such a small loop given a larger
+  /// threshold.
+  bool flattenOuterLoop(Loop *L) {
+    Loop *InnerL = getOuterLoopCandidate(*L, *SE, DisableUnrolling);
+    if (!InnerL || !InnerL->isLoopSimplifyForm())
+      return false;
+
+    unsigned TC = SE->getSmallConstantTripCount(InnerL);
+    unsigned TripMultiple = SE->getSmallConstantTripMultiple(InnerL);
+    DEBUG(dbgs() << "LV: Unrolling the inner loop of an outer loop with trip "
+                    "count " << TC << ".\n");
+    if (!UnrollLoop(InnerL, TC, TC, /*Force=*/true, /*AllowRuntime=*/false,
+                    /*AllowExpensiveTripCount=*/false, TripMultiple, LI, SE,
+                    DT, AC, /*PreserveLCSSA=*/true))
+      return false;
+
+    ++OuterLoopsFlattened;
+    return L->empty();
+  }
+
   bool processLoop(Loop *L) {
+    // Outer loops are vectorized as inner loops once their inner loop is
+    // unrolled.
+    if (!L->empty() && !flattenOuterLoop(L))
+      return false;
     assert(L->empty() && "Only process inner loops.");
 
 #ifndef NDEBUG
@@ -2365,6 +2473,19 @@ static Constant *getStridedMask(IRBuilder<> &Builder, unsigned Start,
   return ConstantVector::get(Mask);
 }
 
+// Get the mask of the lanes of an interleaved access of \p VF tuples that
+// belong to the members of \p Group, skipping its gaps.
+// I.e. <1, 0, 1, 1, 0, 1, ...> for a group of factor 3 missing member 1.
+static Constant *getGapMask(IRBuilder<> &Builder, const InterleaveGroup *Group,
+                            unsigned VF) {
+  SmallVector<Constant *, 16> Mask;
+  for (unsigned i = 0; i < VF; i++)
+    for (unsigned j = 0; j < Group->getFactor(); j++)
+      Mask.push_back(Builder.getInt1(Group->getMember(j) != nullptr));
+
+  return ConstantVector::get(Mask);
+}
+
 // Get a mask of two parts: The first part consists of sequential integers
 // starting from 0, The second part consists of UNDEFs.
 // I.e. <0, 1, 2, ..., NumInt - 1, undef, ..., undef>
@@ -2464,6 +2585,9 @@ static Value *ConcatenateVectors(IRBuilder<> &Builder,
 //   %interleaved.vec = shuffle %R_G.vec, %B_U.vec,
 //        <0, 4, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11>    ; Interleave R,G,B elements
 //   store <12 x i32> %interleaved.vec              ; Write 4 tuples of R,G,B
+//
+// A masked group with gaps uses a masked load or store instead, whose mask
+// only enables the lanes of the existing members.
 void InnerLoopVectorizer::vectorizeInterleaveGroup(Instruction *Instr) {
   const InterleaveGroup *Group = Legal->getInterleavedAccessGroup(Instr);
   assert(Group && "Fail to get an interleaved access group.");
@@ -2513,12 +2637,19 @@ void InnerLoopVectorizer::vectorizeInterleaveGroup(Instruction *Instr) {
 
   setDebugLocFromInst(Builder, Instr);
   Value *UndefVec = UndefValue::get(VecTy);
+  Value *GapMask = Group->isMasked() ? getGapMask(Builder, Group, VF) : nullptr;
 
   // Vectorize the interleaved load group.
   if (LI) {
     for (unsigned Part = 0; Part < UF; Part++) {
-      Instruction *NewLoadInstr = Builder.CreateAlignedLoad(
-          NewPtrs[Part], Group->getAlignment(), "wide.vec");
+      Instruction *NewLoadInstr;
+      if (GapMask)
+        NewLoadInstr =
+            Builder.CreateMaskedLoad(NewPtrs[Part], Group->getAlignment(),
+                                     GapMask, nullptr, "wide.masked.vec");
+      else
+        NewLoadInstr = Builder.CreateAlignedLoad(
+            NewPtrs[Part], Group->getAlignment(), "wide.vec");
 
       for (unsigned i = 0; i < InterleaveFactor; i++) {
         Instruction *Member = Group->getMember(i);
@@ -2555,9 +2686,15 @@ void InnerLoopVectorizer::vectorizeInterleaveGroup(Instruction *Instr) {
     // Collect the stored vector from each member.
     SmallVector<Value *, 4> StoredVecs;
     for (unsigned i = 0; i < InterleaveFactor; i++) {
-      // Interleaved store group doesn't allow a gap, so each index has a member
+      // Interleaved store group only allows a gap if it is masked, so the
+      // gap's lanes are not stored.
       Instruction *Member = Group->getMember(i);
-      assert(Member && "Fail to get a member from an interleaved store group");
+      if (!Member) {
+        assert(GapMask && "Fail to get a member from an interleaved store "
+                         "group");
+        StoredVecs.push_back(UndefValue::get(SubVT));
+        continue;
+      }
 
       Value *StoredVec =
           getVectorValue(cast<StoreInst>(Member)->getValueOperand())[Part];
@@ -2579,8 +2716,13 @@ void InnerLoopVectorizer::vectorizeInterleaveGroup(Instruction *Instr) {
     Value *IVec = Builder.CreateShuffleVector(WideVec, UndefVec, IMask,
                                               "interleaved.vec");
 
-    Instruction *NewStoreInstr =
-        Builder.CreateAlignedStore(IVec, NewPtrs[Part], Group->getAlignment());
+    Instruction *NewStoreInstr;
+    if (GapMask)
+      NewStoreInstr = Builder.CreateMaskedStore(
+          IVec, NewPtrs[Part], Group->getAlignment(), GapMask);
+    else
+      NewStoreInstr = Builder.CreateAlignedStore(IVec, NewPtrs[Part],
+                                                 Group->getAlignment());
     addMetadata(NewStoreInstr, Instr);
   }
 }
@@ -4713,9 +4855,15 @@ bool LoopVectorizationLegality::canVectorize() {
   if (EnableInterleavedMemAccesses.getNumOccurrences() > 0)
     UseInterleaved = EnableInterleavedMemAccesses;
 
+  bool UseMaskedInterleaved =
+      TTI->enableMaskedInterleavedAccessVectorization();
+  if (EnableMaskedInterleavedMemAccesses.getNumOccurrences() > 0)
+    UseMaskedInterleaved = EnableMaskedInterleavedMemAccesses;
+
   // Analyze interleaved memory accesses.
   if (UseInterleaved)
-    InterleaveInfo.analyzeInterleaving(*getSymbolicStrides());
+    InterleaveInfo.analyzeInterleaving(*getSymbolicStrides(),
+                                       UseMaskedInterleaved);
 
   unsigned SCEVThreshold = VectorizeSCEVCheckThreshold;
   if (Hints->getForce() == LoopVectorizeHints::FK_Enabled)
@@ -5267,7 +5415,7 @@ void InterleavedAccessInfo::collectConstStridedAccesses(
 // with other accesses that may precede it in program order. Note that a
 // bottom-up order does not imply that WAW dependences should not be checked.
 void InterleavedAccessInfo::analyzeInterleaving(
-    const ValueToValueMap &Strides) {
+    const ValueToValueMap &Strides, bool UseMasking) {
   DEBUG(dbgs() << "LV: Analyzing interleaved accesses...\n");
 
   // Holds all the stride accesses.
@@ -5398,19 +5546,30 @@ void InterleavedAccessInfo::analyzeInterleaving(
     } // Iteration on instruction B
   }   // Iteration on instruction A
 
-  // Remove interleaved store groups with gaps.
+  // Remove interleaved store groups with gaps, unless a masked store can skip
+  // the gaps.
   for (InterleaveGroup *Group : StoreGroups)
-    if (Group->getNumMembers() != Group->getFactor())
-      releaseGroup(Group);
+    if (Group->getNumMembers() != Group->getFactor()) {
+      if (UseMasking && canMaskGroup(Group)) {
+        DEBUG(dbgs() << "LV: Interleaved store group with gaps is masked.\n");
+        Group->setMasked();
+      } else {
+        releaseGroup(Group);
+      }
+    }
 
   // If there is a non-reversed interleaved load group with gaps, we will need
   // to execute at least one scalar epilogue iteration. This will ensure that
   // we don't speculatively access memory out-of-bounds. Note that we only need
   // to look for a member at index factor - 1, since every group must have a
-  // member at index zero.
+  // member at index zero. A masked load doesn't access the gaps, so it needs
+  // neither.
   for (InterleaveGroup *Group : LoadGroups)
     if (!Group->getMember(Group->getFactor() - 1)) {
-      if (Group->isReverse()) {
+      if (UseMasking && canMaskGroup(Group)) {
+        DEBUG(dbgs() << "LV: Interleaved load group with gaps is masked.\n");
+        Group->setMasked();
+      } else if (Group->isReverse()) {
         releaseGroup(Group);
       } else {
         DEBUG(dbgs() << "LV: Interleaved group requires epilogue iteration.\n");
@@ -6245,6 +6404,15 @@ unsigned LoopVectorizationCostModel::getInstructionCost(Instruction *I,
             Group->getNumMembers() *
             TTI.getShuffleCost(TargetTransformInfo::SK_Reverse, VectorTy, 0);
 
+      // A masked group replaces the wide load or store by a masked one.
+      if (Group->isMasked()) {
+        int MaskedCost = TTI.getMaskedMemoryOpCost(
+            I->getOpcode(), WideVecTy, Group->getAlignment(), AS);
+        int PlainCost = TTI.getMemoryOpCost(I->getOpcode(), WideVecTy,
+                                            Group->getAlignment(), AS);
+        Cost = std::max(0, int(Cost) + MaskedCost - PlainCost);
+      }
+
       // FIXME: The interleaved load group with a huge gap could be even more
       // expensive than scalar operations. Then we could ignore such group and
       // use scalar operations instead.
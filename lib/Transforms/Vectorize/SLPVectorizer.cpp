@@ -3491,8 +3491,7 @@ PreservedAnalyses SLPVectorizerPass::run(Function &F, FunctionAnalysisManager &A
   if (!Changed)
     return PreservedAnalyses::all();
   PreservedAnalyses PA;
-  PA.preserve<LoopAnalysis>();
-  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserveSet<CFGAnalyses>();
   PA.preserve<AAManager>();
   PA.preserve<GlobalsAA>();
   return PA;
@@ -4003,9 +4002,9 @@ public:
     if (ReduxWidth < 4)
       return false;
 
-    // We currently only support adds.
-    if (ReductionOpcode != Instruction::Add &&
-        ReductionOpcode != Instruction::FAdd)
+    // We currently only support adds, muls and bitwise operations, and their
+    // floating-point counterparts when fast-math lets us reassociate them.
+    if (!isSupportedReductionOpcode(ReductionOpcode))
       return false;
 
     // Post order traverse the reduction tree starting at B. We only handle true
@@ -4126,6 +4125,22 @@ public:
   }
 
 private:
+  /// \brief Return true if we can reduce a tree of \p Opcode operations.
+  static bool isSupportedReductionOpcode(unsigned Opcode) {
+    switch (Opcode) {
+    case Instruction::Add:
+    case Instruction::FAdd:
+    case Instruction::Mul:
+    case Instruction::FMul:
+    case Instruction::And:
+    case Instruction::Or:
+    case Instruction::Xor:
+      return true;
+    default:
+      return false;
+    }
+  }
+
   /// \brief Calculate the cost of a reduction.
   int getReductionCost(TargetTransformInfo *TTI, Value *FirstReducedVal) {
     Type *ScalarTy = FirstReducedVal->getType();
@@ -4153,6 +4168,8 @@ private:
                             Value *R, const Twine &Name = "") {
     if (Opcode == Instruction::FAdd)
       return Builder.CreateFAdd(L, R, Name);
+    if (Opcode == Instruction::FMul)
+      return Builder.CreateFMul(L, R, Name);
     return Builder.CreateBinOp((Instruction::BinaryOps)Opcode, L, R, Name);
   }
 
@@ -5,7 +5,8 @@
 ; RUN: opt < %s  -cost-model -analyze -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7 | FileCheck --check-prefix=CHECK --check-prefix=SSE --check-prefix=SSE42 %s
 ; RUN: opt < %s  -cost-model -analyze -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx | FileCheck --check-prefix=CHECK --check-prefix=AVX --check-prefix=AVX1 %s
 ; RUN: opt < %s  -cost-model -analyze -mtriple=x86_64-apple-macosx10.8.0 -mcpu=core-avx2 | FileCheck --check-prefix=CHECK --check-prefix=AVX --check-prefix=AVX2 %s
-; RUN: opt < %s  -cost-model -analyze -mtriple=x86_64-apple-macosx10.8.0 -mcpu=knl | FileCheck --check-prefix=CHECK --check-prefix=AVX --check-prefix=AVX512 %s
+; RUN: opt < %s  -cost-model -analyze -mtriple=x86_64-apple-macosx10.8.0 -mcpu=knl | FileCheck --check-prefix=CHECK --check-prefix=AVX --check-prefix=AVX512 --check-prefix=AVX512F %s
+; RUN: opt < %s  -cost-model -analyze -mtriple=x86_64-apple-macosx10.8.0 -mcpu=skx | FileCheck --check-prefix=CHECK --check-prefix=AVX --check-prefix=AVX512 --check-prefix=AVX512BW %s
 
 target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
 target triple = "x86_64-apple-macosx10.8.0"
@@ -140,6 +141,14 @@ define i32 @cmp(i32 %arg) {
   ; AVX512: cost of 2 {{.*}} %M3 = icmp
   %M3 = icmp eq <16 x i64> undef, undef
 
+  ; AVX512F: cost of 2 {{.*}} %M4 = icmp
+  ; AVX512BW: cost of 1 {{.*}} %M4 = icmp
+  %M4 = icmp eq <32 x i16> undef, undef
+
+  ; AVX512F: cost of 2 {{.*}} %M5 = icmp
+  ; AVX512BW: cost of 1 {{.*}} %M5 = icmp
+  %M5 = icmp eq <64 x i8> undef, undef
+
   ;CHECK: cost of 0 {{.*}} ret
   ret i32 undef
 }
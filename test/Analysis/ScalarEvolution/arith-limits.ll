@@ -0,0 +1,37 @@
+; RUN: opt < %s -analyze -scalar-evolution | FileCheck %s
+; RUN: opt < %s -analyze -scalar-evolution -scalar-evolution-max-add-operands=1 | FileCheck %s --check-prefix=OPERANDS
+; RUN: opt < %s -analyze -scalar-evolution -scalar-evolution-arith-budget=0 | FileCheck %s --check-prefix=BUDGET
+
+; Past the operand limit, the invariant isn't folded into the recurrence.
+; Once the function is over budget, its instructions are left unknown and
+; the trip count isn't computed.
+
+define void @loop(i32 %a) {
+; CHECK-LABEL: Classifying expressions for: @loop
+; CHECK: %i = phi
+; CHECK-NEXT: -->  {0,+,1}<nuw><nsw><%loop>
+; CHECK: %s = add
+; CHECK-NEXT: -->  {%a,+,1}<nw><%loop>
+; CHECK: Loop %loop: backedge-taken count is 100
+
+; OPERANDS: %s = add
+; OPERANDS-NEXT: -->  ({0,+,1}<nuw><nsw><%loop> + %a)
+
+; BUDGET: %i = phi
+; BUDGET-NEXT: -->  %i
+; BUDGET: %s = add
+; BUDGET-NEXT: -->  %s
+; BUDGET: Loop %loop: Unpredictable backedge-taken count.
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = add i32 %i, %a
+  %i.next = add nuw nsw i32 %i, 1
+  %c = icmp slt i32 %i.next, 101
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,26 @@
+; RUN: opt < %s -analyze -ir-memory-usage | FileCheck %s
+
+; CHECK: Kind                Count        Bytes   Operands    Use bytes
+; CHECK-NEXT: Globals                 2   {{ *[0-9]+}}          1 {{ *[0-9]+}}
+; CHECK-NEXT: Arguments               2   {{ *[0-9]+}}          0            0
+; CHECK-NEXT: BasicBlocks             3   {{ *[0-9]+}}          0            0
+; CHECK-NEXT: Instructions            6   {{ *[0-9]+}}         11 {{ *[0-9]+}}
+; CHECK-NEXT: Constants               2   {{ *[0-9]+}}          0            0
+; CHECK-NEXT: Total                  15   {{ *[0-9]+}}         12 {{ *[0-9]+}}
+; CHECK-NEXT: Operands and use lists take {{[0-9]+}}% of the memory.
+
+@g = global [4 x i32] [i32 1, i32 2, i32 3, i32 4]
+
+define i32 @f(i32 %a, i32 %b) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %exit
+
+then:
+  %s = add i32 %a, 1
+  br label %exit
+
+exit:
+  %r = phi i32 [ %s, %then ], [ %b, %entry ]
+  ret i32 %r
+}
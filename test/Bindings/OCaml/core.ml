@@ -1056,6 +1056,20 @@ let test_builder () =
     ignore (build_ptrdiff p1 p0 "build_ptrdiff" atentry);
   end;
 
+  group "bulk"; begin
+    (* CHECK: [[BULK_ADD:%[0-9]+]] = add i32 %P1, %P2
+     * CHECK-NEXT: [[BULK_MUL:%[0-9]+]] = mul i32 [[BULK_ADD]], %P1
+     * CHECK-NEXT: zext i32 [[BULK_MUL]] to i64
+     *)
+    let op (o : Opcode.t) : int = Obj.magic o in
+    let code = [| op Opcode.Add; 0; 1;
+                  op Opcode.Mul; 2; 0;
+                  op Opcode.ZExt; 3; 0 |] in
+    let vs = build_instructions code [| p1; p2 |] [| i64_type |] atentry in
+    insist (5 = Array.length vs);
+    insist (Opcode.Mul = instr_opcode vs.(3));
+  end;
+
   group "miscellaneous"; begin
     (* CHECK: %build_call = tail call cc63 i32 @{{.*}}(i32 signext %P2, i32 %P1)
      * CHECK: %build_select = select i1 %build_icmp, i32 %P1, i32 %P2
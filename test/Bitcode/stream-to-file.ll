@@ -0,0 +1,28 @@
+; Writing to a file flushes the bitstream as it is produced and backpatches the
+; block sizes and the VST offset in the file, this must not change the output.
+; RUN: llvm-as %s -o %t.streamed.bc -bitcode-flush-threshold=0
+; RUN: llvm-as %s -o - | cmp - %t.streamed.bc
+; RUN: llvm-dis %t.streamed.bc -o - | FileCheck %s
+
+; CHECK: @g = global i32 42
+; CHECK: define i32 @f(i32 %x)
+; CHECK: define void @h()
+
+target triple = "x86_64-unknown-linux-gnu"
+
+@g = global i32 42
+
+define i32 @f(i32 %x) {
+entry:
+  %v = load i32, i32* @g, !md !0
+  %r = add i32 %v, %x
+  ret i32 %r
+}
+
+define void @h() {
+entry:
+  %c = call i32 @f(i32 1)
+  ret void
+}
+
+!0 = !{!"int"}
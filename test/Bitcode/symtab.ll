@@ -0,0 +1,70 @@
+; RUN: llvm-as %s -o %t.bc
+; RUN: llvm-bcanalyzer -dump %t.bc | FileCheck %s --check-prefix=BCA
+
+; The archive symbol table must be the same whether llvm-ar reads the symbol
+; table block or parses the module.
+; RUN: rm -f %t.a %t.nosymtab.a
+; RUN: llvm-ar rcs %t.a %t.bc
+; RUN: llvm-nm -M %t.a | FileCheck %s --check-prefix=MAP
+; RUN: llvm-as -bitcode-symtab=false %s -o %t.bc
+; RUN: llvm-bcanalyzer -dump %t.bc | FileCheck %s --check-prefix=NOSYMTAB
+; RUN: llvm-ar rcs %t.nosymtab.a %t.bc
+; RUN: llvm-nm -M %t.nosymtab.a | FileCheck %s --check-prefix=MAP
+
+; Symbols defined by module-level inline asm are not listed in the block, so
+; it is not written at all.
+; RUN: echo 'module asm ".globl foo"' | llvm-as -o %t.asm.bc
+; RUN: llvm-bcanalyzer -dump %t.asm.bc | FileCheck %s --check-prefix=NOSYMTAB
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+; BCA:      <SYMTAB_BLOCK
+; BCA-NEXT:   <ENTRY {{.*}} op0=2/> blob data = '_f'
+; BCA-NEXT:   <ENTRY {{.*}} op0=6/> blob data = '_lo'
+; BCA-NEXT:   <ENTRY {{.*}} op0=3/> blob data = '_d'
+; BCA-NEXT:   <ENTRY {{.*}} op0=67/> blob data = '_llvm.trap'
+; BCA-NEXT:   <ENTRY {{.*}} op0=2/> blob data = '_g'
+; BCA-NEXT:   <ENTRY {{.*}} op0=34/> blob data = '_c'
+; BCA-NEXT:   <ENTRY {{.*}} op0=18/> blob data = '_h'
+; BCA-NEXT:   <ENTRY {{.*}} op0=6/> blob data = '_w'
+; BCA-NEXT:   <ENTRY {{.*}} op0=10/> blob data = '_com'
+; BCA-NEXT:   <ENTRY {{.*}} op0=64/> blob data = 'L_p'
+; BCA-NEXT:   <ENTRY {{.*}} op0=0/> blob data = '_i'
+; BCA-NEXT:   <ENTRY {{.*}} op0=3/> blob data = '_u'
+; BCA-NEXT:   <ENTRY {{.*}} op0=2/> blob data = '_al'
+; BCA-NEXT: </SYMTAB_BLOCK>
+
+; NOSYMTAB-NOT: SYMTAB_BLOCK
+
+; MAP:      Archive map
+; MAP-NEXT: _f in
+; MAP-NEXT: _lo in
+; MAP-NEXT: _g in
+; MAP-NEXT: _c in
+; MAP-NEXT: _h in
+; MAP-NEXT: _w in
+; MAP-NEXT: _com in
+; MAP-NEXT: _al in
+; MAP-NOT:  in
+
+@g = global i32 0
+@c = constant i32 1
+@h = hidden global i32 2
+@w = weak global i32 3
+@com = common global i32 0
+@p = private global i32 4
+@i = internal global i32 5
+@u = external global i32
+@al = alias i32, i32* @g
+
+define void @f() {
+  ret void
+}
+
+define linkonce_odr void @lo() {
+  ret void
+}
+
+declare void @d()
+declare void @llvm.trap()
@@ -58,3 +58,32 @@ define double @ldp_double_aa(double %a, double* %p) nounwind {
   %add = fadd double %tmp, %tmp1
   ret double %add
 }
+
+; Accesses off different base registers are told apart with alias analysis.
+
+; CHECK-LABEL: ldp_long_noalias
+; CHECK: ldp x8, x9, [x1]
+; CHECK: str x0, [x2]
+; CHECK: ret
+define i64 @ldp_long_noalias(i64 %a, i64* noalias %p, i64* noalias %q) nounwind {
+  %tmp = load i64, i64* %p, align 8
+  store i64 %a, i64* %q, align 8
+  %add.ptr = getelementptr inbounds i64, i64* %p, i64 1
+  %tmp1 = load i64, i64* %add.ptr, align 8
+  %add = add nsw i64 %tmp1, %tmp
+  ret i64 %add
+}
+
+; CHECK-LABEL: ldp_long_mayalias
+; CHECK: ldr x8, [x1]
+; CHECK: str x0, [x2]
+; CHECK: ldr x9, [x1, #8]
+; CHECK: ret
+define i64 @ldp_long_mayalias(i64 %a, i64* %p, i64* %q) nounwind {
+  %tmp = load i64, i64* %p, align 8
+  store i64 %a, i64* %q, align 8
+  %add.ptr = getelementptr inbounds i64, i64* %p, i64 1
+  %tmp1 = load i64, i64* %add.ptr, align 8
+  %add = add nsw i64 %tmp1, %tmp
+  ret i64 %add
+}
@@ -1232,3 +1232,40 @@ for.body:
 end:
   ret void
 }
+
+; Check the following transform for unscaled (negative) offsets:
+;
+; (ldur|stur) X, [x0, #-8]
+;  ...
+; sub x0, x0, #8
+;  ->
+; (ldr|str) X, [x0, #-8]!
+
+define i64* @load-pre-indexed-unscaled-doubleword(i64* %ptr, i64* %out) nounwind {
+; CHECK-LABEL: load-pre-indexed-unscaled-doubleword
+; CHECK: ldr x{{[0-9]+}}, [x0, #-8]!
+; CHECK-NOT: sub
+  %gep = getelementptr i64, i64* %ptr, i64 -1
+  %val = load i64, i64* %gep
+  store i64 %val, i64* %out
+  ret i64* %gep
+}
+
+define i32* @store-pre-indexed-unscaled-word(i32* %ptr, i32 %val) nounwind {
+; CHECK-LABEL: store-pre-indexed-unscaled-word
+; CHECK: str w1, [x0, #-12]!
+; CHECK-NOT: sub
+  %gep = getelementptr i32, i32* %ptr, i64 -3
+  store i32 %val, i32* %gep
+  ret i32* %gep
+}
+
+define i16* @load-pre-indexed-unscaled-halfword(i16* %ptr, i16* %out) nounwind {
+; CHECK-LABEL: load-pre-indexed-unscaled-halfword
+; CHECK: ldrh w{{[0-9]+}}, [x0, #-2]!
+; CHECK-NOT: sub
+  %gep = getelementptr i16, i16* %ptr, i64 -1
+  %val = load i16, i16* %gep
+  store i16 %val, i16* %out
+  ret i16* %gep
+}
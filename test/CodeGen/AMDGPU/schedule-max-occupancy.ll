@@ -0,0 +1,21 @@
+; RUN: llc -march=amdgcn -mcpu=tonga -misched=gcn-max-occupancy -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -march=amdgcn -mcpu=SI -misched=gcn-max-occupancy -verify-machineinstrs < %s | FileCheck %s
+
+; The test checks the "gcn-max-occupancy" machine scheduler works correctly.
+
+; CHECK-LABEL: {{^}}test_add_loads:
+; CHECK: buffer_load_dwordx4
+; CHECK: buffer_load_dwordx4
+; CHECK: v_add_i32
+; CHECK: buffer_store_dwordx4
+; CHECK: s_endpgm
+define void @test_add_loads(<4 x i32> addrspace(1)* %out, <4 x i32> addrspace(1)* %in) #0 {
+  %in.1 = getelementptr <4 x i32>, <4 x i32> addrspace(1)* %in, i32 1
+  %a = load <4 x i32>, <4 x i32> addrspace(1)* %in
+  %b = load <4 x i32>, <4 x i32> addrspace(1)* %in.1
+  %sum = add <4 x i32> %a, %b
+  store <4 x i32> %sum, <4 x i32> addrspace(1)* %out
+  ret void
+}
+
+attributes #0 = { nounwind }
@@ -0,0 +1,62 @@
+; RUN: opt < %s -S -nvptx-infer-addrspace | FileCheck %s --check-prefix IR
+; RUN: llc < %s -march=nvptx64 -mcpu=sm_20 -nvptx-use-infer-addrspace | FileCheck %s --check-prefix PTX
+
+@a = internal addrspace(3) global [10 x float] zeroinitializer, align 4
+@b = internal addrspace(3) global [10 x float] zeroinitializer, align 4
+@g = internal addrspace(1) global [10 x float] zeroinitializer, align 4
+
+; A select between two shared pointers points to shared memory.
+define float @select_shared(i1 %c, i32 %i) {
+; IR-LABEL: @select_shared
+; IR: select i1 %c, float addrspace(3)* {{.*}}, float addrspace(3)*
+; IR: load float, float addrspace(3)*
+; PTX-LABEL: select_shared(
+; PTX: ld.shared.f32
+  %p.a = getelementptr [10 x float], [10 x float]* addrspacecast ([10 x float] addrspace(3)* @a to [10 x float]*), i32 0, i32 %i
+  %p.b = getelementptr [10 x float], [10 x float]* addrspacecast ([10 x float] addrspace(3)* @b to [10 x float]*), i32 0, i32 %i
+  %p = select i1 %c, float* %p.a, float* %p.b
+  %v = load float, float* %p, align 4
+  ret float %v
+}
+
+; A select through a loop phi still resolves to shared memory.
+define float @select_in_loop(i1 %c, i32 %n) {
+; IR-LABEL: @select_in_loop
+; IR: phi float addrspace(3)*
+; IR: load float, float addrspace(3)*
+; IR: select i1 %c, float addrspace(3)*
+; PTX-LABEL: select_in_loop(
+; PTX: ld.shared.f32
+entry:
+  %start = getelementptr [10 x float], [10 x float]* addrspacecast ([10 x float] addrspace(3)* @a to [10 x float]*), i32 0, i32 0
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %p = phi float* [ %start, %entry ], [ %p.next, %loop ]
+  %sum = phi float [ 0.0, %entry ], [ %sum.next, %loop ]
+  %v = load float, float* %p, align 4
+  %sum.next = fadd float %sum, %v
+  %p.inc = getelementptr float, float* %p, i32 1
+  %p.next = select i1 %c, float* %p.inc, float* %p
+  %i.next = add i32 %i, 1
+  %exit = icmp eq i32 %i.next, %n
+  br i1 %exit, label %done, label %loop
+
+done:
+  ret float %sum.next
+}
+
+; A select between a shared and a global pointer stays generic.
+define float @select_mixed(i1 %c, i32 %i) {
+; IR-LABEL: @select_mixed
+; IR: select i1 %c, float* {{.*}}, float*
+; IR: load float, float*
+; PTX-LABEL: select_mixed(
+; PTX: ld.f32
+  %p.a = getelementptr [10 x float], [10 x float]* addrspacecast ([10 x float] addrspace(3)* @a to [10 x float]*), i32 0, i32 %i
+  %p.g = getelementptr [10 x float], [10 x float]* addrspacecast ([10 x float] addrspace(1)* @g to [10 x float]*), i32 0, i32 %i
+  %p = select i1 %c, float* %p.a, float* %p.g
+  %v = load float, float* %p, align 4
+  ret float %v
+}
@@ -213,6 +213,31 @@ exit:
   ret void
 }
 
+@scratch = internal addrspace(3) global float 0.000000e+00, align 4
+
+; A readonly parameter that is not noalias can still use the non-coherent
+; cache if the kernel does not write to global memory at all.
+; SM20-LABEL: .visible .entry foo20(
+; SM20: ld.global.f32
+; SM35-LABEL: .visible .entry foo20(
+; SM35: ld.global.nc.f32
+define void @foo20(float * readonly %from) {
+  %1 = load float, float * %from
+  store float %1, float addrspace(3) * @scratch
+  ret void
+}
+
+; But not if the kernel may write to global memory through another pointer.
+; SM20-LABEL: .visible .entry foo21(
+; SM20: ld.global.f32
+; SM35-LABEL: .visible .entry foo21(
+; SM35: ld.global.f32
+define void @foo21(float * readonly %from, float * %to) {
+  %1 = load float, float * %from
+  store float %1, float * %to
+  ret void
+}
+
 ; This test captures the case of a non-kernel function. In a
 ; non-kernel function, without interprocedural analysis, we do not
 ; know that the parameter is global. We also do not know that the
@@ -242,7 +267,7 @@ define void @notkernel2(float addrspace(1) * noalias readonly %from, float * %to
   ret void
 }
 
-!nvvm.annotations = !{!1 ,!2 ,!3 ,!4 ,!5 ,!6, !7 ,!8 ,!9 ,!10 ,!11 ,!12, !13, !14, !15, !16, !17, !18, !19}
+!nvvm.annotations = !{!1 ,!2 ,!3 ,!4 ,!5 ,!6, !7 ,!8 ,!9 ,!10 ,!11 ,!12, !13, !14, !15, !16, !17, !18, !19, !20, !21}
 !1 = !{void (float *, float *)* @foo1, !"kernel", i32 1}
 !2 = !{void (double *, double *)* @foo2, !"kernel", i32 1}
 !3 = !{void (i16 *, i16 *)* @foo3, !"kernel", i32 1}
@@ -262,3 +287,5 @@ define void @notkernel2(float addrspace(1) * noalias readonly %from, float * %to
 !17 = !{void (<4 x double> *, <4 x double> *)* @foo17, !"kernel", i32 1}
 !18 = !{void (float **, float **)* @foo18, !"kernel", i32 1}
 !19 = !{void (float *, float *, i32)* @foo19, !"kernel", i32 1}
+!20 = !{void (float *)* @foo20, !"kernel", i32 1}
+!21 = !{void (float *, float *)* @foo21, !"kernel", i32 1}
@@ -0,0 +1,46 @@
+; RUN: llc < %s -asm-verbose=false -stats 2>&1 | FileCheck %s
+; REQUIRES: asserts
+
+; Test the statistics that count how much local traffic is left after
+; register stackifying.
+
+target datalayout = "e-m:e-p:32:32-i64:64-n32:64-S128"
+target triple = "wasm32-unknown-unknown"
+
+; CHECK-DAG:  2 wasm-reg-numbering - Number of locals allocated, excluding arguments
+; CHECK-DAG:  3 wasm-reg-numbering - Number of register defs that write a local
+; CHECK-DAG:  7 wasm-reg-numbering - Number of register uses that read a local
+; CHECK-DAG: 13 wasm-reg-stackify - Number of single-use defs moved onto the stack
+; CHECK-DAG:  5 wasm-reg-stackify - Number of cheap defs rematerialized
+; CHECK-DAG:  1 wasm-reg-stackify - Number of multi-use defs stackified with a tee_local
+; The compares use the constants 1 and 2 twice each, so their defs get
+; rematerialized.
+define i32 @remat(i32 %x, i32 %y, i32 %z, i32 %w) {
+entry:
+  %c = icmp sle i32 %x, 0
+  %d = icmp sle i32 %y, 1
+  %e = icmp sle i32 %z, 0
+  %f = icmp sle i32 %w, 1
+  %g = xor i1 %c, %d
+  %h = xor i1 %e, %f
+  %i = xor i1 %g, %h
+  br i1 %i, label %true, label %false
+true:
+  ret i32 0
+false:
+  ret i32 1
+}
+
+; %a stays live across the load and %b across the call, so both need locals.
+; %v has two uses and gets a tee_local.
+declare i32 @red()
+declare void @callee(i32)
+@count = hidden global i32 0, align 4
+define i32 @locals() {
+  %a = call i32 @red()
+  %b = load i32, i32* @count, align 4
+  call void @callee(i32 %a)
+  %v = add i32 %b, 1
+  %m = mul i32 %v, %v
+  ret i32 %m
+}
@@ -1,4 +1,5 @@
 ; RUN: llc < %s -march=x86 | grep "(%esp)" | count 2
+; RUN: llc < %s -march=x86 -combiner-memoize-failures | grep "(%esp)" | count 2
 target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:32:64-f32:32:32-f64:32:64-v64:64:64-v128:128:128-a0:0:64-f80:128:128"
 target triple = "i386-apple-darwin9.5"
 ; a - a should be found and removed, leaving refs to only L and P
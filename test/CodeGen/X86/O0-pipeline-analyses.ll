@@ -0,0 +1,25 @@
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -O0 -debug-pass=Structure < %s -o /dev/null 2>&1 | FileCheck %s
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -O2 -debug-pass=Structure < %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=O2
+
+; At -O0 nothing in the codegen pipeline should ask for the IR dominator tree,
+; scalar evolution or alias analysis.
+
+; CHECK-NOT: Dominator Tree Construction
+; CHECK-NOT: Scalar Evolution Analysis
+; CHECK-NOT: Basic Alias Analysis (stateless AA impl)
+; CHECK-NOT: Function Alias Analysis Results
+; CHECK: Exception handling preparation
+; CHECK-NOT: Dominator Tree Construction
+; CHECK-NOT: Scalar Evolution Analysis
+; CHECK-NOT: Function Alias Analysis Results
+; CHECK: X86 DAG->DAG Instruction Selection
+
+; O2: Function Alias Analysis Results
+; O2: X86 DAG->DAG Instruction Selection
+
+define i32 @f(i32* %p, i32 %n) {
+entry:
+  %v = load i32, i32* %p
+  %r = add i32 %v, %n
+  ret i32 %r
+}
@@ -0,0 +1,120 @@
+; NOTE: Assertions have been autogenerated by utils/update_llc_test_checks.py
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=skx | FileCheck %s
+
+; The operation is on the false side of the select, so the compare is
+; inverted to mask the operation instead of blending after it.
+
+define <16 x i32> @add_on_false_side(<16 x i32> %a, <16 x i32> %b, <16 x i32> %m) {
+; CHECK-LABEL: add_on_false_side:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vpxord %zmm3, %zmm3, %zmm3
+; CHECK-NEXT:    vpcmpneqd %zmm3, %zmm2, %k1
+; CHECK-NEXT:    vpaddd %zmm1, %zmm0, %zmm0 {%k1}
+; CHECK-NEXT:    retq
+  %c = icmp eq <16 x i32> %m, zeroinitializer
+  %r = add <16 x i32> %a, %b
+  %s = select <16 x i1> %c, <16 x i32> %a, <16 x i32> %r
+  ret <16 x i32> %s
+}
+
+define <8 x i32> @add_on_false_side_256(<8 x i32> %a, <8 x i32> %b, <8 x i32> %m) {
+; CHECK-LABEL: add_on_false_side_256:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vpxord %ymm3, %ymm3, %ymm3
+; CHECK-NEXT:    vpcmpled %ymm3, %ymm2, %k1
+; CHECK-NEXT:    vpaddd %ymm1, %ymm0, %ymm0 {%k1}
+; CHECK-NEXT:    retq
+  %c = icmp sgt <8 x i32> %m, zeroinitializer
+  %r = add <8 x i32> %a, %b
+  %s = select <8 x i1> %c, <8 x i32> %a, <8 x i32> %r
+  ret <8 x i32> %s
+}
+
+define <16 x float> @fmul_on_false_side_zero(<16 x float> %a, <16 x float> %b, <16 x float> %x, <16 x float> %y) {
+; CHECK-LABEL: fmul_on_false_side_zero:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vcmpnltps %zmm3, %zmm2, %k1
+; CHECK-NEXT:    vmulps %zmm1, %zmm0, %zmm0 {%k1} {z}
+; CHECK-NEXT:    retq
+  %c = fcmp olt <16 x float> %x, %y
+  %r = fmul <16 x float> %a, %b
+  %s = select <16 x i1> %c, <16 x float> zeroinitializer, <16 x float> %r
+  ret <16 x float> %s
+}
+
+define <8 x double> @fadd_bcast_on_false_side(<8 x double> %a, double* %p, <8 x i64> %m) {
+; CHECK-LABEL: fadd_bcast_on_false_side:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vpxord %zmm2, %zmm2, %zmm2
+; CHECK-NEXT:    vpcmpeqq %zmm2, %zmm1, %k1
+; CHECK-NEXT:    vaddpd (%rdi){1to8}, %zmm0, %zmm0 {%k1}
+; CHECK-NEXT:    retq
+  %l = load double, double* %p
+  %i = insertelement <8 x double> undef, double %l, i32 0
+  %b = shufflevector <8 x double> %i, <8 x double> undef, <8 x i32> zeroinitializer
+  %c = icmp ne <8 x i64> %m, zeroinitializer
+  %r = fadd <8 x double> %a, %b
+  %s = select <8 x i1> %c, <8 x double> %a, <8 x double> %r
+  ret <8 x double> %s
+}
+
+; 512-bit ANDs with a clear mask that would need a permute with an index
+; vector stay ANDs, with the constant broadcast when it is a splat.
+
+define <16 x i32> @and_clear_bytes(<16 x i32> %a) {
+; CHECK-LABEL: and_clear_bytes:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vpandd {{.*}}(%rip){1to16}, %zmm0, %zmm0
+; CHECK-NEXT:    retq
+  %r = and <16 x i32> %a, <i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255, i32 255>
+  ret <16 x i32> %r
+}
+
+define <8 x i64> @and_clear_dwords(<8 x i64> %a) {
+; CHECK-LABEL: and_clear_dwords:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vpandq {{.*}}(%rip){1to8}, %zmm0, %zmm0
+; CHECK-NEXT:    retq
+  %r = and <8 x i64> %a, <i64 4294967295, i64 4294967295, i64 4294967295, i64 4294967295, i64 4294967295, i64 4294967295, i64 4294967295, i64 4294967295>
+  ret <8 x i64> %r
+}
+
+define <16 x i32> @and_clear_elements(<16 x i32> %a) {
+; CHECK-LABEL: and_clear_elements:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vpandd {{.*}}(%rip), %zmm0, %zmm0
+; CHECK-NEXT:    retq
+  %r = and <16 x i32> %a, <i32 -1, i32 0, i32 -1, i32 0, i32 -1, i32 0, i32 -1, i32 0, i32 -1, i32 0, i32 -1, i32 0, i32 -1, i32 0, i32 -1, i32 0>
+  ret <16 x i32> %r
+}
+
+define <32 x i16> @and_clear_words(<32 x i16> %a) {
+; CHECK-LABEL: and_clear_words:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vpandq {{.*}}(%rip), %zmm0, %zmm0
+; CHECK-NEXT:    retq
+  %r = and <32 x i16> %a, <i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0, i16 -1, i16 0>
+  ret <32 x i16> %r
+}
+
+; Clear masks that an unpck or a vshufi64x2 can apply are still shuffles.
+
+define <8 x i64> @shuffle_clear_qwords(<8 x i64> %a) {
+; CHECK-LABEL: shuffle_clear_qwords:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vpxord %zmm1, %zmm1, %zmm1
+; CHECK-NEXT:    vpunpcklqdq {{.*#+}} zmm0 = zmm0[0],zmm1[0],zmm0[2],zmm1[2],zmm0[4],zmm1[4],zmm0[6],zmm1[6]
+; CHECK-NEXT:    retq
+  %r = and <8 x i64> %a, <i64 -1, i64 0, i64 -1, i64 0, i64 -1, i64 0, i64 -1, i64 0>
+  ret <8 x i64> %r
+}
+
+define <16 x i32> @shuffle_clear_upper_half(<16 x i32> %a) {
+; CHECK-LABEL: shuffle_clear_upper_half:
+; CHECK:       # BB#0:
+; CHECK-NEXT:    vpxord %zmm1, %zmm1, %zmm1
+; CHECK-NEXT:    vshufi64x2 {{.*#+}} zmm0 = zmm0[0,1,2,3],zmm1[4,5,6,7]
+; CHECK-NEXT:    retq
+  %r = and <16 x i32> %a, <i32 -1, i32 -1, i32 -1, i32 -1, i32 -1, i32 -1, i32 -1, i32 -1, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0>
+  ret <16 x i32> %r
+}
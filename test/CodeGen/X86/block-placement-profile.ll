@@ -0,0 +1,60 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux -profile-guided-block-placement \
+; RUN:     | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-linux | FileCheck %s -check-prefix=ATTR
+;
+; Check the profile-guided block layout: blocks are merged along the hottest
+; fall-through edges, and the cold blocks end up at the bottom.
+
+declare void @a()
+declare void @b()
+declare void @c()
+
+; CHECK-LABEL: diamond:
+; CHECK: %entry
+; CHECK: %hot
+; CHECK: %join
+; CHECK: %cold
+; ATTR-LABEL: diamond:
+; ATTR: %entry
+; ATTR: %hot
+; ATTR: %join
+; ATTR: %cold
+define void @diamond(i1 %x) #0 !prof !0 {
+entry:
+  br i1 %x, label %cold, label %hot, !prof !1
+
+cold:
+  call void @a()
+  br label %join
+
+hot:
+  call void @b()
+  br label %join
+
+join:
+  call void @c()
+  ret void
+}
+
+; Without profile data the function is laid out as before.
+; CHECK-LABEL: noprofile:
+; CHECK: %entry
+; CHECK: %then
+; CHECK: %else
+define void @noprofile(i1 %x) {
+entry:
+  br i1 %x, label %then, label %else
+
+then:
+  call void @a()
+  ret void
+
+else:
+  call void @b()
+  ret void
+}
+
+attributes #0 = { "block-placement"="profile" }
+
+!0 = !{!"function_entry_count", i64 1000}
+!1 = !{!"branch_weights", i32 1, i32 1000}
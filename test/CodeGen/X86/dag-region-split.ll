@@ -0,0 +1,25 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown | FileCheck %s --check-prefix=ONE
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -max-dag-region-size=2 \
+; RUN:   | FileCheck %s --check-prefix=SPLIT
+
+; In a single DAG the stored value is forwarded to the load. Once the block is
+; split after the store, the load is selected in a separate DAG, which still
+; has to come after the store, and %x is carried over in a register.
+
+; ONE-LABEL: f:
+; ONE: movl %{{.*}}, (%rdi)
+; ONE-NOT: (%rdi)
+; ONE: retq
+
+; SPLIT-LABEL: f:
+; SPLIT: movl %{{.*}}, (%rdi)
+; SPLIT: (%rdi)
+; SPLIT: retq
+
+define i32 @f(i32* %p, i32 %a, i32 %b) {
+  %x = add i32 %a, %b
+  store i32 %x, i32* %p
+  %y = load i32, i32* %p
+  %z = mul i32 %y, %x
+  ret i32 %z
+}
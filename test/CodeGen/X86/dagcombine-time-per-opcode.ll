@@ -0,0 +1,12 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -combiner-time-per-opcode \
+; RUN:   -o /dev/null 2>&1 | FileCheck %s
+
+; CHECK: DAG Combiner
+; CHECK-DAG: add
+; CHECK-DAG: mul
+
+define i32 @f(i32 %a, i32 %b) {
+  %x = add i32 %a, %b
+  %y = mul i32 %x, %a
+  ret i32 %y
+}
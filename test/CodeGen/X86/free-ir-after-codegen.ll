@@ -0,0 +1,43 @@
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -relocation-model=pic < %s | FileCheck %s
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -relocation-model=pic -free-ir-after-codegen < %s | FileCheck %s
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -relocation-model=pic -free-ir-after-codegen < %s | FileCheck %s --check-prefix=VIS
+
+; Freeing the body of a function once it has been emitted must not change the
+; code generated for the functions after it, nor the module-level directives.
+
+; A freed definition is not mistaken for a declaration at the end of the
+; module.
+; VIS: .hidden callee
+; VIS-NOT: .hidden callee
+
+define hidden i32 @callee(i32 %x) {
+  %r = add i32 %x, 1
+  ret i32 %r
+}
+
+; The callee is still a local definition, so it is called directly.
+; CHECK-LABEL: caller:
+; CHECK: callq callee{{$}}
+define i32 @caller(i32 %x) {
+  %r = call i32 @callee(i32 %x)
+  %s = mul i32 %r, %x
+  ret i32 %s
+}
+
+; Blocks whose address is taken by a later function keep their labels.
+; CHECK-LABEL: target:
+; CHECK: [[BB:.Ltmp[0-9]+]]:
+define void @target(i1 %c) {
+entry:
+  br i1 %c, label %bb, label %exit
+bb:
+  br label %exit
+exit:
+  ret void
+}
+
+; CHECK-LABEL: addr:
+; CHECK: leaq [[BB]](%rip)
+define i8* @addr() {
+  ret i8* blockaddress(@target, %bb)
+}
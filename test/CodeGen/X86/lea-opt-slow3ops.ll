@@ -0,0 +1,47 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -mcpu=sandybridge | FileCheck %s -check-prefix=CHECK -check-prefix=SLOW
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -mattr=+slow-3ops-lea | FileCheck %s -check-prefix=CHECK -check-prefix=SLOW
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -mcpu=nehalem | FileCheck %s -check-prefix=CHECK -check-prefix=FAST
+
+; 3-operand LEAs (base, index and offset) have a 3 cycle latency on Sandy
+; Bridge and later, so they are split into a 2-operand LEA and an ADD.
+
+define i64 @lea_base_index_offset(i64 %a, i64 %b) {
+; CHECK-LABEL: lea_base_index_offset:
+; SLOW:       leaq (%rdi,%rsi,4), %rax
+; SLOW-NEXT:  addq $16, %rax
+; FAST:       leaq 16(%rdi,%rsi,4), %rax
+  %mul = shl i64 %b, 2
+  %add = add i64 %a, 16
+  %res = add i64 %add, %mul
+  ret i64 %res
+}
+
+define i32 @lea32_base_index_offset(i32 %a, i32 %b) {
+; CHECK-LABEL: lea32_base_index_offset:
+; SLOW:       leal (%rdi,%rsi), %eax
+; SLOW-NEXT:  addl $-1000, %eax
+; FAST:       leal -1000(%rdi,%rsi), %eax
+  %add = add i32 %a, %b
+  %res = add i32 %add, -1000
+  ret i32 %res
+}
+
+define i64 @lea_two_ops(i64 %a, i64 %b) {
+; CHECK-LABEL: lea_two_ops:
+; CHECK:      leaq (%rdi,%rsi,8), %rax
+; CHECK-NEXT: retq
+  %mul = shl i64 %b, 3
+  %res = add i64 %a, %mul
+  ret i64 %res
+}
+
+; The offset is kept when optimizing for size.
+define i64 @lea_optsize(i64 %a, i64 %b) optsize {
+; CHECK-LABEL: lea_optsize:
+; CHECK:      leaq 16(%rdi,%rsi,4), %rax
+; CHECK-NEXT: retq
+  %mul = shl i64 %b, 2
+  %add = add i64 %a, 16
+  %res = add i64 %add, %mul
+  ret i64 %res
+}
@@ -0,0 +1,52 @@
+; RUN: rm -rf %t.dir
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu < %s > %t.s
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -machine-function-cache-dir=%t.dir < %s > %t.miss.s
+; RUN: ls %t.dir | count 2
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -machine-function-cache-dir=%t.dir < %s > %t.hit.s
+; RUN: ls %t.dir | count 2
+; RUN: diff %t.s %t.miss.s
+; RUN: diff %t.s %t.hit.s
+
+; Functions read from the cache are compiled to the same code as the ones that
+; are selected.
+
+@g = global i32 0
+
+define i32 @load_store(i32* %p) {
+entry:
+  %v = load i32, i32* %p, align 4, !tbaa !0
+  store i32 %v, i32* @g, align 4, !tbaa !0
+  %c = icmp eq i32 %v, 0
+  br i1 %c, label %zero, label %done
+
+zero:
+  br label %done
+
+done:
+  %r = phi i32 [ 1, %zero ], [ %v, %entry ]
+  ret i32 %r
+}
+
+declare void @callee(i32*)
+
+define void @call() {
+entry:
+  %a = alloca i32, align 4
+  store i32 1, i32* %a, align 4
+  call void @callee(i32* %a)
+  ret void
+}
+
+; The stack protector isn't described by the MIR, so this one isn't stored.
+define void @protected() sspreq {
+entry:
+  %a = alloca [16 x i8], align 16
+  %p = getelementptr [16 x i8], [16 x i8]* %a, i64 0, i64 0
+  call void @callee(i32* null)
+  ret void
+}
+
+!0 = !{!1, !1, i64 0}
+!1 = !{!"int", !2, i64 0}
+!2 = !{!"omnipotent char", !3, i64 0}
+!3 = !{!"Simple C/C++ TBAA"}
@@ -0,0 +1,65 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -enable-misched \
+; RUN:     -misched-max-region-size=4 -verify-machineinstrs -debug-only=misched \
+; RUN:     2>&1 >/dev/null | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -enable-misched \
+; RUN:     -misched-cheap-region-size=2 -enable-aa-sched-mi \
+; RUN:     -dag-max-alias-queries=2 -verify-machineinstrs | FileCheck %s \
+; RUN:     -check-prefix=CHEAP
+; REQUIRES: asserts
+;
+; Check that a large block is cut into scheduling regions of at most
+; -misched-max-region-size instructions, and that the cheap scheduling
+; heuristics and the alias query limit still produce valid code.
+
+; CHECK: ********** MI Scheduling **********
+; CHECK: RegionInstrs: 4
+; CHECK: ********** MI Scheduling **********
+; CHECK: RegionInstrs: 4
+; CHECK: ********** MI Scheduling **********
+; CHECK: RegionInstrs: 4
+
+; CHEAP-LABEL: copy8:
+; CHEAP: retq
+
+define void @copy8(i32* noalias %p, i32* noalias %q, i32 %a) {
+entry:
+  %p1 = getelementptr i32, i32* %p, i64 1
+  %p2 = getelementptr i32, i32* %p, i64 2
+  %p3 = getelementptr i32, i32* %p, i64 3
+  %p4 = getelementptr i32, i32* %p, i64 4
+  %p5 = getelementptr i32, i32* %p, i64 5
+  %p6 = getelementptr i32, i32* %p, i64 6
+  %p7 = getelementptr i32, i32* %p, i64 7
+  %q1 = getelementptr i32, i32* %q, i64 1
+  %q2 = getelementptr i32, i32* %q, i64 2
+  %q3 = getelementptr i32, i32* %q, i64 3
+  %q4 = getelementptr i32, i32* %q, i64 4
+  %q5 = getelementptr i32, i32* %q, i64 5
+  %q6 = getelementptr i32, i32* %q, i64 6
+  %q7 = getelementptr i32, i32* %q, i64 7
+  %v0 = load i32, i32* %p
+  %v1 = load i32, i32* %p1
+  %v2 = load i32, i32* %p2
+  %v3 = load i32, i32* %p3
+  %v4 = load i32, i32* %p4
+  %v5 = load i32, i32* %p5
+  %v6 = load i32, i32* %p6
+  %v7 = load i32, i32* %p7
+  %a0 = add i32 %v0, %a
+  %a1 = add i32 %v1, %a
+  %a2 = add i32 %v2, %a
+  %a3 = add i32 %v3, %a
+  %a4 = add i32 %v4, %a
+  %a5 = add i32 %v5, %a
+  %a6 = add i32 %v6, %a
+  %a7 = add i32 %v7, %a
+  store i32 %a0, i32* %q
+  store i32 %a1, i32* %q1
+  store i32 %a2, i32* %q2
+  store i32 %a3, i32* %q3
+  store i32 %a4, i32* %q4
+  store i32 %a5, i32* %q5
+  store i32 %a6, i32* %q6
+  store i32 %a7, i32* %q7
+  ret void
+}
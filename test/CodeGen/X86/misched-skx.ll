@@ -0,0 +1,42 @@
+; REQUIRES: asserts
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=skx -debug-only=misched -o /dev/null 2>&1 | FileCheck %s --check-prefix=SKX
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=haswell -debug-only=misched -o /dev/null 2>&1 | FileCheck %s --check-prefix=HSW
+;
+; Check that Skylake Server uses its own machine model: FP adds, multiplies
+; and FMAs all have a latency of 4, also in their EVEX encodings.
+
+; SKX-LABEL: MI Scheduling
+; SKX:       VMULPDZrr
+; SKX:       Latency            : 4
+; SKX:       VADDPDZrr
+; SKX:       Latency            : 4
+; SKX-LABEL: MI Scheduling
+; SKX:       VFMADD213PDZr
+; SKX:       Latency            : 4
+; SKX-LABEL: MI Scheduling
+; SKX:       VDIVSDZrr
+; SKX:       Latency            : 11
+
+; HSW-LABEL: MI Scheduling
+; HSW:       VMULPDYrr
+; HSW:       Latency            : 5
+; HSW:       VADDPDYrr
+; HSW:       Latency            : 3
+
+define <8 x double> @mul_add(<8 x double> %a, <8 x double> %b, <8 x double> %c) {
+  %m = fmul <8 x double> %a, %b
+  %r = fadd <8 x double> %m, %c
+  ret <8 x double> %r
+}
+
+define <8 x double> @fma(<8 x double> %a, <8 x double> %b, <8 x double> %c) {
+  %r = call <8 x double> @llvm.fma.v8f64(<8 x double> %a, <8 x double> %b, <8 x double> %c)
+  ret <8 x double> %r
+}
+
+define double @div(double %a, double %b) {
+  %r = fdiv double %a, %b
+  ret double %r
+}
+
+declare <8 x double> @llvm.fma.v8f64(<8 x double>, <8 x double>, <8 x double>)
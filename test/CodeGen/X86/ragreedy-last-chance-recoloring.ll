@@ -14,6 +14,10 @@
 ; RUN: FileCheck --input-file=%t %s --check-prefix=CHECK-EXHAUSTIVE
 ; Test whether exhaustive-register-search can bypass the depth and interference cutoffs of last chance recoloring 
 
+; RUN: llc -regalloc=greedy -relocation-model=pic -regalloc-split-budget=1 -regalloc-max-evictions=1 -verify-machineinstrs < %s -o /dev/null
+; RUN: llc -regalloc=greedy -relocation-model=pic -regalloc-split-time-budget=1 -verify-machineinstrs < %s -o /dev/null
+; Test that the compile-time budgets for huge functions still allocate correctly.
+
 target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:32:64-f32:32:32-f64:32:64-v64:64:64-v128:128:128-a0:0:64-f80:128:128-n8:16:32-S128"
 target triple = "i386-apple-macosx"
 
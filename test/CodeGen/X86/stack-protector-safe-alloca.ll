@@ -0,0 +1,72 @@
+; RUN: llc -mtriple=x86_64-pc-linux-gnu < %s | FileCheck %s
+; RUN: llc -mtriple=x86_64-pc-linux-gnu -stack-protector-skip-safe-allocas=false < %s \
+; RUN:   | FileCheck %s --check-prefix=NOSKIP
+
+; Buffers whose accesses are all proven to be in bounds can't be overflowed, so
+; they don't trigger a protector under ssp and sspstrong.
+
+define i8 @in_bounds(i64 %i) ssp {
+entry:
+; CHECK-LABEL: in_bounds:
+; CHECK-NOT: __stack_chk_fail
+; CHECK: retq
+; NOSKIP-LABEL: in_bounds:
+; NOSKIP: callq __stack_chk_fail
+  %buf = alloca [16 x i8], align 16
+  %idx = and i64 %i, 15
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i64 0, i64 %idx
+  store volatile i8 1, i8* %p
+  %v = load volatile i8, i8* %p
+  ret i8 %v
+}
+
+define i8 @out_of_bounds(i64 %i) ssp {
+entry:
+; CHECK-LABEL: out_of_bounds:
+; CHECK: callq __stack_chk_fail
+  %buf = alloca [16 x i8], align 16
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i64 0, i64 %i
+  store volatile i8 1, i8* %p
+  %v = load volatile i8, i8* %p
+  ret i8 %v
+}
+
+define void @escapes() ssp {
+entry:
+; CHECK-LABEL: escapes:
+; CHECK: callq __stack_chk_fail
+  %buf = alloca [16 x i8], align 16
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i64 0, i64 0
+  call void @f(i8* %p)
+  ret void
+}
+
+define void @bounded_memset(i64 %n) sspstrong {
+entry:
+; CHECK-LABEL: bounded_memset:
+; CHECK-NOT: __stack_chk_fail
+; CHECK: retq
+; NOSKIP-LABEL: bounded_memset:
+; NOSKIP: callq __stack_chk_fail
+  %buf = alloca [4 x i32], align 16
+  %len = and i64 %n, 15
+  %p = bitcast [4 x i32]* %buf to i8*
+  call void @llvm.memset.p0i8.i64(i8* %p, i8 0, i64 %len, i32 16, i1 true)
+  ret void
+}
+
+; sspreq always gets a protector.
+define i8 @required(i64 %i) sspreq {
+entry:
+; CHECK-LABEL: required:
+; CHECK: callq __stack_chk_fail
+  %buf = alloca [16 x i8], align 16
+  %idx = and i64 %i, 15
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i64 0, i64 %idx
+  store volatile i8 1, i8* %p
+  %v = load volatile i8, i8* %p
+  ret i8 %v
+}
+
+declare void @f(i8*)
+declare void @llvm.memset.p0i8.i64(i8* nocapture, i8, i64, i32, i1)
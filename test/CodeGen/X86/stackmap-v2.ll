@@ -0,0 +1,81 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -stackmap-version=2 | FileCheck %s
+;
+; Version 2 stack maps keep one copy of each distinct location and refer to
+; it by index from every record.
+
+; CHECK-LABEL:	.section	__LLVM_STACKMAPS,__llvm_stackmaps
+; CHECK-NEXT: __LLVM_StackMaps:
+; version
+; CHECK-NEXT: 	.byte	2
+; reserved
+; CHECK-NEXT: 	.byte	0
+; reserved
+; CHECK-NEXT: 	.short	0
+; # functions
+; CHECK-NEXT: 	.long	1
+; # constants
+; CHECK-NEXT: 	.long	0
+; # records
+; CHECK-NEXT: 	.long	2
+; # locations
+; CHECK-NEXT: 	.long	2
+; reserved
+; CHECK-NEXT: 	.long	0
+; function address & stack size
+; CHECK-NEXT: 	.quad	_foo
+; CHECK-NEXT: 	.quad	8
+
+; Location table
+; Constant 1
+; CHECK-NEXT: 	.byte	4
+; CHECK-NEXT: 	.byte	8
+; CHECK-NEXT: 	.short	0
+; CHECK-NEXT: 	.long	1
+; Constant 2
+; CHECK-NEXT: 	.byte	4
+; CHECK-NEXT: 	.byte	8
+; CHECK-NEXT: 	.short	0
+; CHECK-NEXT: 	.long	2
+
+; Patchpoint ID
+; CHECK-NEXT: 	.quad	1
+; Instruction offset
+; CHECK-NEXT: 	.long	L{{.*}}-_foo
+; reserved
+; CHECK-NEXT: 	.short	0
+; # locations
+; CHECK-NEXT: 	.short	2
+; location indices
+; CHECK-NEXT: 	.long	0
+; CHECK-NEXT: 	.long	1
+; padding
+; CHECK-NEXT: 	.short	0
+; NumLiveOuts
+; CHECK-NEXT: 	.short	0
+; CHECK-NEXT: 	.p2align	3
+
+; Patchpoint ID
+; CHECK-NEXT: 	.quad	2
+; Instruction offset
+; CHECK-NEXT: 	.long	L{{.*}}-_foo
+; reserved
+; CHECK-NEXT: 	.short	0
+; # locations
+; CHECK-NEXT: 	.short	3
+; location indices
+; CHECK-NEXT: 	.long	1
+; CHECK-NEXT: 	.long	0
+; CHECK-NEXT: 	.long	1
+; padding
+; CHECK-NEXT: 	.short	0
+; NumLiveOuts
+; CHECK-NEXT: 	.short	0
+; CHECK-NEXT: 	.p2align	3
+
+declare void @llvm.experimental.stackmap(i64, i32, ...)
+
+define void @foo() {
+  tail call void (i64, i32, ...) @llvm.experimental.stackmap(i64 1, i32 0, i64 1, i64 2)
+  tail call void (i64, i32, ...) @llvm.experimental.stackmap(i64 2, i32 0, i64 2, i64 1, i64 2)
+  ret void
+}
@@ -0,0 +1,83 @@
+; RUN: llc -mtriple=x86_64-linux-gnu < %s | FileCheck %s
+; RUN: llc -mtriple=x86_64-linux-gnu -switch-peel-threshold=101 < %s \
+; RUN:   | FileCheck %s --check-prefix=NOPEEL
+; RUN: llc -mtriple=x86_64-linux-gnu -pass-remarks-analysis=switch-lowering \
+; RUN:   -o /dev/null < %s 2>&1 | FileCheck %s --check-prefix=REMARK
+; RUN: llc -mtriple=x86_64-linux-gnu -print-switch-lowering \
+; RUN:   -o /dev/null < %s 2>&1 | FileCheck %s --check-prefix=REMARK
+; RUN: llc -mtriple=x86_64-linux-gnu -o /dev/null < %s 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=QUIET --allow-empty
+
+; The profile says case 500 is taken almost every time, so it is tested
+; before the balanced tree of the other cases.
+
+; CHECK-LABEL: hot_case:
+; CHECK-NOT: cmpl
+; CHECK: cmpl $500, %edi
+; CHECK-NEXT: jne
+
+; NOPEEL-LABEL: hot_case:
+; NOPEEL-NOT: cmpl $500, %edi
+; NOPEEL: cmpl
+
+; REMARK: switch with 9 cases lowered to 1 jump tables, 0 bit tests and 4 compared ranges, after testing its hottest case
+; QUIET-NOT: switch with
+
+declare void @g(i32)
+
+define void @hot_case(i32 %x) {
+entry:
+  switch i32 %x, label %return [
+    i32 0, label %bb0
+    i32 1, label %bb1
+    i32 2, label %bb2
+    i32 3, label %bb3
+    i32 500, label %hot
+    i32 1000, label %bb4
+    i32 2000, label %bb5
+    i32 3000, label %bb6
+    i32 4000, label %bb7
+  ], !prof !0
+
+bb0:
+  tail call void @g(i32 0)
+  br label %return
+
+bb1:
+  tail call void @g(i32 1)
+  br label %return
+
+bb2:
+  tail call void @g(i32 2)
+  br label %return
+
+bb3:
+  tail call void @g(i32 3)
+  br label %return
+
+bb4:
+  tail call void @g(i32 4)
+  br label %return
+
+bb5:
+  tail call void @g(i32 5)
+  br label %return
+
+bb6:
+  tail call void @g(i32 6)
+  br label %return
+
+bb7:
+  tail call void @g(i32 7)
+  br label %return
+
+hot:
+  tail call void @g(i32 8)
+  br label %return
+
+return:
+  ret void
+}
+
+!0 = !{!"branch_weights", i32 1, i32 1, i32 1, i32 1, i32 1, i32 1000,
+       i32 1, i32 1, i32 1, i32 1}
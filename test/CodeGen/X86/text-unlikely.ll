@@ -0,0 +1,21 @@
+; RUN: llc -mtriple=x86_64-pc-linux < %s | FileCheck %s
+; RUN: llc -mtriple=x86_64-pc-linux -function-sections < %s | FileCheck %s --check-prefix=FSECT
+
+; Cold functions are placed in .text.unlikely, away from the hot text.
+
+; CHECK: .section .text.unlikely,"ax",@progbits
+; CHECK: cold_fn:
+; CHECK: .text
+; CHECK: hot_fn:
+; FSECT: .section .text.unlikely.cold_fn,"ax",@progbits
+; FSECT: cold_fn:
+; FSECT: .section .text.hot_fn,"ax",@progbits
+; FSECT: hot_fn:
+
+define void @cold_fn() cold {
+  ret void
+}
+
+define void @hot_fn() {
+  ret void
+}
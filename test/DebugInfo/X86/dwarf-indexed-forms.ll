@@ -0,0 +1,63 @@
+; RUN: llc -O0 -dwarf-indexed-forms %s -mtriple=x86_64-unknown-linux-gnu -o - \
+; RUN:   | FileCheck --check-prefix=ASM %s
+; RUN: llc -O0 -dwarf-indexed-forms %s -mtriple=x86_64-unknown-linux-gnu \
+; RUN:   -filetype=obj -o %t
+; RUN: llvm-dwarfdump -debug-dump=info %t | FileCheck %s
+
+; Check that -dwarf-indexed-forms makes a non-split compile unit refer to its
+; strings and addresses through .debug_str_offsets and .debug_addr.
+
+; The tables start with a DWARF 5 header; the bases point just past it.
+; ASM: .section .debug_str_offsets,"",@progbits
+; ASM: .long 20 # Length of String Offsets Set
+; ASM-NEXT: .short 5 # DWARF version number
+; ASM-NEXT: .short 0 # Padding
+; ASM-NEXT: .Lstr_offsets_base0:
+; ASM-NEXT: .long .Linfo_string0
+; ASM-NEXT: .long .Linfo_string1
+
+; ASM: .section .debug_abbrev
+; ASM: .byte 37 # DW_AT_producer
+; ASM-NEXT: .byte 26 # DW_FORM_strx
+; ASM: .byte 114 # DW_AT_str_offsets_base
+; ASM-NEXT: .byte 23 # DW_FORM_sec_offset
+; ASM-NEXT: .byte 115 # DW_AT_addr_base
+; ASM-NEXT: .byte 23 # DW_FORM_sec_offset
+; ASM-NEXT: .byte 17 # DW_AT_low_pc
+; ASM-NEXT: .byte 27 # DW_FORM_addrx
+
+; ASM: .section .debug_addr,"",@progbits
+; ASM: .long 12 # Length of Address Table
+; ASM-NEXT: .short 5 # DWARF version number
+; ASM-NEXT: .byte 8 # Address Size (in bytes)
+; ASM-NEXT: .byte 0 # Segment Selector Size
+; ASM-NEXT: .Laddr_table_base0:
+; ASM-NEXT: .quad .Lfunc_begin0
+
+; CHECK: DW_TAG_compile_unit
+; CHECK: DW_AT_producer [DW_FORM_strx] ( indexed (00000000) string = "clang")
+; CHECK: DW_AT_name [DW_FORM_strx] ( indexed (00000001) string = "foo.c")
+; CHECK: DW_AT_str_offsets_base [DW_FORM_sec_offset] (0x00000008)
+; CHECK: DW_AT_addr_base [DW_FORM_sec_offset] (0x00000008)
+; CHECK: DW_AT_low_pc [DW_FORM_addrx] ( indexed (00000000) address = 0x0000000000000000)
+; CHECK: DW_TAG_subprogram
+; CHECK: DW_AT_low_pc [DW_FORM_addrx] ( indexed (00000000) address = 0x0000000000000000)
+; CHECK: DW_AT_name [DW_FORM_strx] ( indexed ({{[0-9a-f]+}}) string = "foo")
+
+define void @foo() !dbg !4 {
+entry:
+  ret void, !dbg !8
+}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!6, !7}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, emissionKind: FullDebug)
+!1 = !DIFile(filename: "foo.c", directory: "/tmp")
+!4 = distinct !DISubprogram(name: "foo", scope: !1, file: !1, line: 1, type: !5, isLocal: false, isDefinition: true, scopeLine: 1, isOptimized: false, unit: !0, variables: !2)
+!2 = !{}
+!5 = !DISubroutineType(types: !3)
+!3 = !{null}
+!6 = !{i32 2, !"Dwarf Version", i32 4}
+!7 = !{i32 2, !"Debug Info Version", i32 3}
+!8 = !DILocation(line: 1, column: 1, scope: !4)
@@ -0,0 +1,25 @@
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-debug=funcs-to-stdout \
+; RUN:     -orc-lazy-speculation-depth=2 %s | FileCheck %s
+;
+; With a speculation depth of two, foo and bar are compiled along with main,
+; so only a single partition is ever emitted.
+;
+; CHECK: [ {{.*}}main{{.*}} ]
+; CHECK-NOT: [
+
+define i32 @bar() {
+entry:
+  ret i32 0
+}
+
+define i32 @foo() {
+entry:
+  %0 = call i32 @bar()
+  ret i32 %0
+}
+
+define i32 @main(i32 %argc, i8** nocapture readnone %argv) {
+entry:
+  %0 = call i32 @foo()
+  ret i32 %0
+}
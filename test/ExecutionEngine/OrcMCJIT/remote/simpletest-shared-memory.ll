@@ -0,0 +1,26 @@
+; RUN: %lli -jit-kind=orc-mcjit -remote-mcjit -remote-shared-memory \
+; RUN:   -mcjit-remote-process=lli-child-target%exeext %s
+; XFAIL: mingw32,win32
+; UNSUPPORTED: powerpc64-unknown-linux-gnu
+
+; Check that code and data reach the child over a shared memory channel.
+
+@count = global i32 0, align 4
+@table = internal constant [4 x i32] [i32 1, i32 2, i32 3, i32 4], align 16
+
+define i32 @sum() nounwind {
+entry:
+  %a = load i32, i32* getelementptr ([4 x i32], [4 x i32]* @table, i32 0, i32 0)
+  %b = load i32, i32* getelementptr ([4 x i32], [4 x i32]* @table, i32 0, i32 3)
+  %s = add i32 %a, %b
+  store i32 %s, i32* @count
+  ret i32 %s
+}
+
+define i32 @main() nounwind {
+entry:
+  %r = call i32 @sum()
+  %c = load i32, i32* @count
+  %d = sub i32 %r, %c
+  ret i32 %d
+}
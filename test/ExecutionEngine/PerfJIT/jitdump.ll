@@ -0,0 +1,11 @@
+; RUN: rm -rf %t && mkdir -p %t
+; RUN: env JITDUMPDIR=%t %lli %s
+; RUN: ls %t | FileCheck %s
+
+; lli registers the perf listener, which writes a jitdump file named after the
+; process into JITDUMPDIR.
+; CHECK: jit-{{[0-9]+}}.dump
+
+define i32 @main() {
+  ret i32 0
+}
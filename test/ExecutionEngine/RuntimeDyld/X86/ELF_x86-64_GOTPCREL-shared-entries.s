@@ -0,0 +1,24 @@
+# RUN: llvm-mc -triple=x86_64-pc-linux -filetype=obj -o %T/test_ELF_GOTPCREL_shared_x86-64.o %s
+# RUN: llvm-rtdyld -triple=x86_64-pc-linux -verify -check=%s \
+# RUN:   -dummy-extern G=0x12345678 -dummy-extern H=0x87654321 \
+# RUN:   %T/test_ELF_GOTPCREL_shared_x86-64.o
+
+# Check that GOTPCREL references to the same symbol share a GOT entry, and
+# that references to different symbols don't.
+
+	.text
+	.globl	foo
+	.align	16, 0x90
+foo:
+# rtdyld-check: next_pc(insn1) + decode_operand(insn1, 4) = section_addr(test_ELF_GOTPCREL_shared_x86-64.o, .got)
+# rtdyld-check: *{8}(section_addr(test_ELF_GOTPCREL_shared_x86-64.o, .got)) = G
+insn1:
+	movq	G@GOTPCREL(%rip), %rax
+# rtdyld-check: next_pc(insn2) + decode_operand(insn2, 4) = next_pc(insn1) + decode_operand(insn1, 4)
+insn2:
+	movq	G@GOTPCREL(%rip), %rcx
+# rtdyld-check: next_pc(insn3) + decode_operand(insn3, 4) = section_addr(test_ELF_GOTPCREL_shared_x86-64.o, .got) + 8
+# rtdyld-check: *{8}(section_addr(test_ELF_GOTPCREL_shared_x86-64.o, .got) + 8) = H
+insn3:
+	movq	H@GOTPCREL(%rip), %rdx
+	retq
@@ -0,0 +1,216 @@
+; RUN: %lli -force-interpreter=true %s
+; RUN: %lli -force-interpreter=true -interpreter-use-bytecode=false %s
+
+; Exercises the interpreter's bytecode, and calls between functions run from
+; bytecode and by the instruction visitors.  main returns the number of the
+; first failing check, or zero.
+
+%pair = type { i8, i32 }
+
+declare void @llvm.memset.p0i8.i64(i8*, i8, i64, i32, i1)
+declare void @llvm.memcpy.p0i8.p0i8.i64(i8*, i8*, i64, i32, i1)
+
+define i32 @fib(i32 %n) {
+entry:
+  %small = icmp slt i32 %n, 2
+  br i1 %small, label %done, label %recurse
+
+recurse:
+  %n1 = sub i32 %n, 1
+  %f1 = call i32 @fib(i32 %n1)
+  %n2 = sub i32 %n, 2
+  %f2 = call i32 @fib(i32 %n2)
+  %sum = add i32 %f1, %f2
+  ret i32 %sum
+
+done:
+  ret i32 %n
+}
+
+; The PHIs swap their values on every iteration, so their moves have to be
+; done in parallel.
+define i32 @swap(i32 %iters) {
+entry:
+  br label %loop
+
+loop:
+  %a = phi i32 [ 1, %entry ], [ %b, %loop ]
+  %b = phi i32 [ 2, %entry ], [ %a, %loop ]
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %i.next = add i32 %i, 1
+  %more = icmp ult i32 %i.next, %iters
+  br i1 %more, label %loop, label %exit
+
+exit:
+  %r = mul i32 %a, 10
+  %s = add i32 %r, %b
+  ret i32 %s
+}
+
+define i32 @classify(i64 %x) {
+entry:
+  switch i64 %x, label %other [
+    i64 -1, label %minus.one
+    i64 7, label %seven
+    i64 4294967296, label %big
+  ]
+
+minus.one:
+  br label %exit
+
+seven:
+  br label %exit
+
+big:
+  br label %exit
+
+other:
+  br label %exit
+
+exit:
+  %r = phi i32 [ 1, %minus.one ], [ 2, %seven ], [ 3, %big ], [ 4, %other ]
+  ret i32 %r
+}
+
+; Run by the visitors, since the bytecode doesn't handle vectors.
+define i32 @vector_fib(i32 %n) {
+  %v = insertelement <2 x i32> zeroinitializer, i32 %n, i32 0
+  %w = add <2 x i32> %v, <i32 0, i32 1>
+  %x = extractelement <2 x i32> %w, i32 0
+  %f = call i32 @fib(i32 %x)
+  ret i32 %f
+}
+
+define i32 @apply(i32 (i32)* %fn, i32 %x) {
+  %r = call i32 %fn(i32 %x)
+  ret i32 %r
+}
+
+define i32 @main() {
+entry:
+  %fib = call i32 @fib(i32 10)
+  %c1 = icmp eq i32 %fib, 55
+  br i1 %c1, label %t2, label %fail1
+
+t2:
+  %swap.even = call i32 @swap(i32 4)
+  %swap.odd = call i32 @swap(i32 5)
+  %c2a = icmp eq i32 %swap.even, 21
+  %c2b = icmp eq i32 %swap.odd, 12
+  %c2 = and i1 %c2a, %c2b
+  br i1 %c2, label %t3, label %fail2
+
+t3:
+  ; Narrow integers wrap and sign extend at their own width.
+  %wrap = add i8 -56, 100
+  %c3a = icmp eq i8 %wrap, 44
+  %div = sdiv i8 -128, -1
+  %c3b = icmp eq i8 %div, -128
+  %ashr = ashr i8 -16, 2
+  %c3c = icmp eq i8 %ashr, -4
+  %lshr = lshr i8 -16, 2
+  %c3d = icmp eq i8 %lshr, 60
+  %shl = shl i8 3, 7
+  %c3e = icmp slt i8 %shl, 0
+  %sext = sext i8 %ashr to i64
+  %c3f = icmp eq i64 %sext, -4
+  %trunc = trunc i64 4294967298 to i32
+  %c3g = icmp eq i32 %trunc, 2
+  %rem = srem i32 -7, 2
+  %c3h = icmp eq i32 %rem, -1
+  %c3ab = and i1 %c3a, %c3b
+  %c3cd = and i1 %c3c, %c3d
+  %c3ef = and i1 %c3e, %c3f
+  %c3gh = and i1 %c3g, %c3h
+  %c3abcd = and i1 %c3ab, %c3cd
+  %c3efgh = and i1 %c3ef, %c3gh
+  %c3 = and i1 %c3abcd, %c3efgh
+  br i1 %c3, label %t4, label %fail3
+
+t4:
+  %m1 = call i32 @classify(i64 -1)
+  %m7 = call i32 @classify(i64 7)
+  %mbig = call i32 @classify(i64 4294967296)
+  %mother = call i32 @classify(i64 8)
+  %c4a = icmp eq i32 %m1, 1
+  %c4b = icmp eq i32 %m7, 2
+  %c4c = icmp eq i32 %mbig, 3
+  %c4d = icmp eq i32 %mother, 4
+  %c4ab = and i1 %c4a, %c4b
+  %c4cd = and i1 %c4c, %c4d
+  %c4 = and i1 %c4ab, %c4cd
+  br i1 %c4, label %t5, label %fail4
+
+t5:
+  %d = fdiv double 7.0, 2.0
+  %d.int = fptosi double %d to i32
+  %c5a = icmp eq i32 %d.int, 3
+  %nan = fdiv double 0.0, 0.0
+  %c5b = fcmp uno double %nan, 1.0
+  %c5c = fcmp one double %nan, 1.0
+  %f = fptrunc double %d to float
+  %f2 = fmul float %f, 2.0
+  %f.back = fpext float %f2 to double
+  %c5d = fcmp oeq double %f.back, 7.0
+  %neg = sitofp i8 -3 to double
+  %c5e = fcmp olt double %neg, -2.5
+  %bits = bitcast float %f2 to i32
+  %c5f = icmp eq i32 %bits, 1088421888
+  %c5ab = and i1 %c5a, %c5b
+  %c5ab.notc = xor i1 %c5c, true
+  %c5abc = and i1 %c5ab, %c5ab.notc
+  %c5de = and i1 %c5d, %c5e
+  %c5def = and i1 %c5de, %c5f
+  %c5 = and i1 %c5abc, %c5def
+  br i1 %c5, label %t6, label %fail5
+
+t6:
+  %buf = alloca [4 x i16]
+  %copy = alloca [4 x i16]
+  %buf.i8 = bitcast [4 x i16]* %buf to i8*
+  %copy.i8 = bitcast [4 x i16]* %copy to i8*
+  call void @llvm.memset.p0i8.i64(i8* %buf.i8, i8 1, i64 8, i32 2, i1 false)
+  %idx = add i32 1, 1
+  %elt = getelementptr [4 x i16], [4 x i16]* %buf, i32 0, i32 %idx
+  store i16 -1, i16* %elt
+  call void @llvm.memcpy.p0i8.p0i8.i64(i8* %copy.i8, i8* %buf.i8, i64 8, i32 2, i1 false)
+  %copy.elt2 = getelementptr [4 x i16], [4 x i16]* %copy, i64 0, i64 2
+  %v2 = load i16, i16* %copy.elt2
+  %copy.elt3 = getelementptr i16, i16* %copy.elt2, i32 1
+  %v3 = load i16, i16* %copy.elt3
+  %c6a = icmp eq i16 %v2, -1
+  %c6b = icmp eq i16 %v3, 257
+  %p = alloca %pair
+  %p.second = getelementptr %pair, %pair* %p, i32 0, i32 1
+  store i32 42, i32* %p.second
+  %p.i8 = bitcast %pair* %p to i8*
+  %p.raw = getelementptr i8, i8* %p.i8, i64 4
+  %p.raw32 = bitcast i8* %p.raw to i32*
+  %v4 = load i32, i32* %p.raw32
+  %c6c = icmp eq i32 %v4, 42
+  %c6ab = and i1 %c6a, %c6b
+  %c6 = and i1 %c6ab, %c6c
+  br i1 %c6, label %t7, label %fail6
+
+t7:
+  %vf = call i32 @vector_fib(i32 9)
+  %ind = call i32 @apply(i32 (i32)* @vector_fib, i32 8)
+  %c7a = icmp eq i32 %vf, 34
+  %c7b = icmp eq i32 %ind, 21
+  %c7 = and i1 %c7a, %c7b
+  %sel = select i1 %c7, i32 0, i32 7
+  ret i32 %sel
+
+fail1:
+  ret i32 1
+fail2:
+  ret i32 2
+fail3:
+  ret i32 3
+fail4:
+  ret i32 4
+fail5:
+  ret i32 5
+fail6:
+  ret i32 6
+}
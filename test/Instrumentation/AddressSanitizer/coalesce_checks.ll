@@ -0,0 +1,89 @@
+; Test that -asan-opt-coalesce checks contiguous accesses of a basic block
+; with one check.
+; RUN: opt < %s -asan -asan-module -asan-opt-coalesce -asan-instrumentation-with-call-threshold=0 -S | FileCheck %s
+; RUN: opt < %s -asan -asan-module -asan-instrumentation-with-call-threshold=0 -S | FileCheck %s --check-prefix=NOOPT
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @foo()
+
+; The two halves of an aligned 8 byte word get one 8 byte check, which is a
+; write as one of them is stored to.
+define void @two_halves(i32* %a) sanitize_address {
+entry:
+  %a1 = getelementptr inbounds i32, i32* %a, i64 1
+  %x = load i32, i32* %a, align 8
+  store i32 %x, i32* %a1, align 4
+  ret void
+}
+; CHECK-LABEL: @two_halves
+; CHECK: [[P:%[0-9a-z.]+]] = bitcast i32* %a to i8*
+; CHECK: [[ADDR:%[0-9a-z.]+]] = ptrtoint i8* [[P]] to i64
+; CHECK-NEXT: call void @__asan_store8(i64 [[ADDR]])
+; CHECK-NEXT: %x = load i32
+; CHECK-NOT: __asan_
+; CHECK: ret void
+; NOOPT-LABEL: @two_halves
+; NOOPT: call void @__asan_load4
+; NOOPT: call void @__asan_store4
+; NOOPT: ret void
+
+; Four bytes of a 16 byte aligned block, read out of order, get one 16 byte
+; check at the first of them.
+define i32 @four_words(i32* %a) sanitize_address {
+entry:
+  %a1 = getelementptr inbounds i32, i32* %a, i64 1
+  %a2 = getelementptr inbounds i32, i32* %a, i64 2
+  %a3 = getelementptr inbounds i32, i32* %a, i64 3
+  %x2 = load i32, i32* %a2, align 8
+  %x0 = load i32, i32* %a, align 16
+  %x3 = load i32, i32* %a3, align 4
+  %x1 = load i32, i32* %a1, align 4
+  %s0 = add i32 %x0, %x1
+  %s1 = add i32 %x2, %x3
+  %s = add i32 %s0, %s1
+  ret i32 %s
+}
+; CHECK-LABEL: @four_words
+; CHECK: call void @__asan_load16
+; CHECK-NEXT: %x2 = load i32
+; CHECK-NOT: __asan_
+; CHECK: ret i32
+
+; An access that is not aligned on the whole range, or a range that is not a
+; power of two, is left alone.
+define void @unaligned(i32* %a, i8* %b) sanitize_address {
+entry:
+  %a1 = getelementptr inbounds i32, i32* %a, i64 1
+  %b1 = getelementptr inbounds i8, i8* %b, i64 1
+  %b2 = getelementptr inbounds i8, i8* %b, i64 2
+  store i32 0, i32* %a, align 4
+  store i32 0, i32* %a1, align 4
+  store i8 0, i8* %b, align 4
+  store i8 0, i8* %b1, align 1
+  store i8 0, i8* %b2, align 1
+  ret void
+}
+; CHECK-LABEL: @unaligned
+; CHECK: call void @__asan_store4
+; CHECK: call void @__asan_store4
+; CHECK: call void @__asan_store1
+; CHECK: call void @__asan_store1
+; CHECK: call void @__asan_store1
+; CHECK: ret void
+
+; A call in between starts a new group of accesses.
+define void @call_between(i32* %a) sanitize_address {
+entry:
+  %a1 = getelementptr inbounds i32, i32* %a, i64 1
+  store i32 0, i32* %a, align 8
+  call void @foo()
+  store i32 0, i32* %a1, align 4
+  ret void
+}
+; CHECK-LABEL: @call_between
+; CHECK: call void @__asan_store4
+; CHECK: call void @foo()
+; CHECK: call void @__asan_store4
+; CHECK: ret void
@@ -0,0 +1,94 @@
+; Test that -asan-opt-loops checks the invariant and unit stride accesses of
+; a loop once, before the loop.
+; RUN: opt < %s -asan -asan-module -asan-opt-loops -asan-instrumentation-with-call-threshold=0 -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @foo()
+
+; a[i] = *b for i in [0, n): one check of the n * 4 bytes of a and one check
+; of b, in the preheader.
+define void @fill(i32* %a, i32* %b, i64 %n) sanitize_address {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %ph, label %exit
+
+ph:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %ph ], [ %i.next, %loop ]
+  %x = load i32, i32* %b, align 4
+  %p = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %x, i32* %p, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+; CHECK-LABEL: @fill
+; CHECK: ph:
+; CHECK: call void @__asan_load4
+; CHECK: [[LEN:%[0-9a-z.]+]] = shl i64 %n, 2
+; CHECK: call void @__asan_storeN(i64 %{{.*}}, i64 [[LEN]])
+; CHECK-NEXT: br label %loop
+; CHECK: loop:
+; CHECK-NOT: __asan_
+; CHECK: exit:
+
+; A loop going down checks the range from its last address.
+define void @down(i64* %a) sanitize_address {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 9, %entry ], [ %i.next, %loop ]
+  %p = getelementptr inbounds i64, i64* %a, i64 %i
+  store i64 0, i64* %p, align 8
+  %i.next = add nsw i64 %i, -1
+  %done = icmp eq i64 %i, 0
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+; CHECK-LABEL: @down
+; CHECK: entry:
+; CHECK: [[ADDR:%[0-9a-z.]+]] = ptrtoint i64* %a to i64
+; CHECK: call void @__asan_storeN(i64 [[ADDR]], i64 80)
+; CHECK: loop:
+; CHECK-NOT: __asan_
+; CHECK: exit:
+
+; Loops with calls, and accesses out of the loop header, are checked on every
+; iteration.
+define void @with_call(i32* %a, i64 %n) sanitize_address {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %p = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 0, i32* %p, align 4
+  call void @foo()
+  br label %latch
+
+latch:
+  %q = getelementptr inbounds i32, i32* %a, i64 %i
+  %y = load i32, i32* %q, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+; CHECK-LABEL: @with_call
+; CHECK: loop:
+; CHECK: call void @__asan_store4
+; CHECK: latch:
+; CHECK: call void @__asan_load4
+; CHECK: exit:
@@ -0,0 +1,62 @@
+; Test EfficiencySanitizer working set sampling, and the accesses it skips.
+;
+; RUN: opt < %s -esan -esan-working-set -esan-sample-rate=4 -S | FileCheck %s
+; RUN: opt < %s -esan -esan-working-set -esan-ignore-non-escaping-stack=false -S | FileCheck %s --check-prefix=STACK
+
+; CHECK: @__esan_sample_countdown = weak thread_local(initialexec) global i32 0
+; STACK-NOT: @__esan_sample_countdown
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+; Sampling
+
+define i8 @sampled(i8* %a) {
+entry:
+  %tmp1 = load i8, i8* %a, align 1
+  ret i8 %tmp1
+; CHECK-LABEL: define i8 @sampled(
+; CHECK:        %0 = load i32, i32* @__esan_sample_countdown
+; CHECK-NEXT:   %1 = icmp eq i32 %0, 0
+; CHECK-NEXT:   %2 = sub i32 %0, 1
+; CHECK-NEXT:   %3 = select i1 %1, i32 3, i32 %2
+; CHECK-NEXT:   store i32 %3, i32* @__esan_sample_countdown
+; CHECK-NEXT:   br i1 %1, label %4, label %17
+; CHECK:        %5 = ptrtoint i8* %a to i64
+; CHECK:        br label %17
+; CHECK:        %tmp1 = load i8, i8* %a, align 1
+; CHECK-NEXT:   ret i8 %tmp1
+}
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+; Stack objects
+
+define i32 @local_stack(i32 %v) {
+entry:
+  %x = alloca i32, align 4
+  store i32 %v, i32* %x, align 4
+  %tmp1 = load i32, i32* %x, align 4
+  ret i32 %tmp1
+; CHECK-LABEL: define i32 @local_stack(
+; CHECK-NEXT:  entry:
+; CHECK-NEXT:   %x = alloca i32, align 4
+; CHECK-NEXT:   store i32 %v, i32* %x, align 4
+; CHECK-NEXT:   %tmp1 = load i32, i32* %x, align 4
+; CHECK-NEXT:   ret i32 %tmp1
+; STACK-LABEL: define i32 @local_stack(
+; STACK:        ptrtoint i32* %x to i64
+; STACK:        store i32 %v, i32* %x, align 4
+}
+
+define i32 @escaping_stack(i32 %v) {
+entry:
+  %x = alloca i32, align 4
+  call void @escape(i32* %x)
+  %tmp1 = load i32, i32* %x, align 4
+  ret i32 %tmp1
+; CHECK-LABEL: define i32 @escaping_stack(
+; CHECK:        call void @escape(i32* %x)
+; CHECK:        load i32, i32* @__esan_sample_countdown
+; CHECK:        ptrtoint i32* %x to i64
+; CHECK:        %tmp1 = load i32, i32* %x, align 4
+}
+
+declare void @escape(i32*)
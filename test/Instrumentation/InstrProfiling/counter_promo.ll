@@ -0,0 +1,99 @@
+; RUN: opt < %s -instrprof -do-counter-promotion -S | FileCheck %s --check-prefix=PROMO
+; RUN: opt < %s -passes=instrprof -do-counter-promotion -S | FileCheck %s --check-prefix=PROMO
+; RUN: opt < %s -instrprof -do-counter-promotion -iterative-counter-promotion=false -S | FileCheck %s --check-prefix=NOITER
+; RUN: opt < %s -instrprof -do-counter-promotion -instrprof-atomic-counter-update-all -S | FileCheck %s --check-prefix=ATOMIC-PROMO
+; RUN: opt < %s -instrprof -instrprof-atomic-counter-update-all -S | FileCheck %s --check-prefix=ATOMIC
+
+; Counters updated inside the loops are kept in registers and added to memory
+; on the loop exits. The update on the exit of the inner loop is promoted again
+; in the outer loop.
+
+target triple = "x86_64-unknown-linux-gnu"
+
+@__profn_foo = private constant [3 x i8] c"foo"
+
+define void @foo(i32 %n, i32 %m) {
+entry:
+; PROMO-LABEL: entry:
+; PROMO: %pgocount = load i64, {{.*}} @__profc_foo, i64 0, i64 0)
+; PROMO: store i64 {{.*}} @__profc_foo, i64 0, i64 0)
+; ATOMIC-PROMO-LABEL: entry:
+; ATOMIC-PROMO: atomicrmw add {{.*}} @__profc_foo, i64 0, i64 0), i64 1 monotonic
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 0, i32 4, i32 0)
+  br label %outer
+
+outer:
+; PROMO-LABEL: outer:
+; PROMO: %[[OUTER_INNER:.*]] = phi i64 [ 0, %entry ], [ %[[OUTER_INNER_NEXT:.*]], %outer.latch ]
+; PROMO: %[[OUTER:.*]] = phi i64 [ 0, %entry ], [ %[[OUTER_NEXT:.*]], %outer.latch ]
+; PROMO: %[[OUTER_NEXT]] = add i64 %[[OUTER]], 1
+; PROMO-NOT: @__profc_foo
+  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ]
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 0, i32 4, i32 1)
+  br label %inner
+
+inner:
+; PROMO-LABEL: inner:
+; PROMO: %[[INNER:.*]] = phi i64 [ 0, %outer ], [ %[[INNER_LATCH:.*]], %inner.latch ]
+  %j = phi i32 [ 0, %outer ], [ %j.next, %inner.latch ]
+  %odd = and i32 %j, 1
+  %isodd = icmp ne i32 %odd, 0
+  br i1 %isodd, label %then, label %inner.latch
+
+then:
+; PROMO-LABEL: then:
+; PROMO: %[[THEN:.*]] = add i64 %[[INNER]], 1
+; PROMO-NOT: @__profc_foo
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 0, i32 4, i32 2)
+  br label %inner.latch
+
+inner.latch:
+; PROMO-LABEL: inner.latch:
+; PROMO: %[[INNER_LATCH]] = phi i64 [ %[[THEN]], %then ], [ %[[INNER]], %inner ]
+  %j.next = add i32 %j, 1
+  %inner.cond = icmp slt i32 %j.next, %m
+  br i1 %inner.cond, label %inner, label %outer.latch
+
+outer.latch:
+; PROMO-LABEL: outer.latch:
+; PROMO: %[[OUTER_INNER_NEXT]] = add i64 %[[OUTER_INNER]], %[[INNER_LATCH]]
+; PROMO-NOT: @__profc_foo
+; NOITER-LABEL: outer.latch:
+; NOITER: %[[OLD:.*]] = load i64, {{.*}} @__profc_foo, i64 0, i64 2)
+; NOITER: %[[NEW:.*]] = add i64 %[[OLD]], %
+; NOITER: store i64 %[[NEW]], {{.*}} @__profc_foo, i64 0, i64 2)
+  %i.next = add i32 %i, 1
+  %outer.cond = icmp slt i32 %i.next, %n
+  br i1 %outer.cond, label %outer, label %exit
+
+exit:
+; PROMO-LABEL: exit:
+; PROMO: %[[OLD2:.*]] = load i64, {{.*}} @__profc_foo, i64 0, i64 2)
+; PROMO: %[[NEW2:.*]] = add i64 %[[OLD2]], %[[OUTER_INNER_NEXT]]
+; PROMO: store i64 %[[NEW2]], {{.*}} @__profc_foo, i64 0, i64 2)
+; PROMO: %[[OLD1:.*]] = load i64, {{.*}} @__profc_foo, i64 0, i64 1)
+; PROMO: %[[NEW1:.*]] = add i64 %[[OLD1]], %[[OUTER_NEXT]]
+; PROMO: store i64 %[[NEW1]], {{.*}} @__profc_foo, i64 0, i64 1)
+; PROMO: load i64, {{.*}} @__profc_foo, i64 0, i64 3)
+; NOITER-LABEL: exit:
+; NOITER-NOT: @__profc_foo, i64 0, i64 2)
+; NOITER: load i64, {{.*}} @__profc_foo, i64 0, i64 1)
+; ATOMIC-PROMO-LABEL: exit:
+; ATOMIC-PROMO-NEXT: atomicrmw add {{.*}} @__profc_foo, i64 0, i64 2), i64 %{{.*}} monotonic
+; ATOMIC-PROMO-NEXT: atomicrmw add {{.*}} @__profc_foo, i64 0, i64 1), i64 %{{.*}} monotonic
+; ATOMIC-PROMO-NEXT: atomicrmw add {{.*}} @__profc_foo, i64 0, i64 3), i64 1 monotonic
+; ATOMIC-PROMO-NOT: load i64, {{.*}} @__profc_foo
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 0, i32 4, i32 3)
+  ret void
+}
+
+; Without promotion, every increment is an atomic add in place.
+; ATOMIC-LABEL: define void @foo
+; ATOMIC-NOT: load i64, {{.*}} @__profc_foo
+; ATOMIC: atomicrmw add {{.*}} @__profc_foo, i64 0, i64 0), i64 1 monotonic
+; ATOMIC: atomicrmw add {{.*}} @__profc_foo, i64 0, i64 1), i64 1 monotonic
+; ATOMIC: atomicrmw add {{.*}} @__profc_foo, i64 0, i64 2), i64 1 monotonic
+; ATOMIC: atomicrmw add {{.*}} @__profc_foo, i64 0, i64 3), i64 1 monotonic
+; ATOMIC-NOT: load i64, {{.*}} @__profc_foo
+
+declare void @llvm.instrprof.increment(i8*, i64, i32, i32)
@@ -0,0 +1,56 @@
+; Test -sanitizer-coverage-inline-8bit-counters and -sanitizer-coverage-pc-table
+; RUN: opt < %s -sancov -sanitizer-coverage-level=3 -sanitizer-coverage-inline-8bit-counters -S | FileCheck %s
+; RUN: opt < %s -sancov -sanitizer-coverage-level=3 -sanitizer-coverage-inline-8bit-counters -sanitizer-coverage-pc-table -S | FileCheck %s --check-prefix=CHECK_PCS
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-unknown-linux-gnu"
+define void @foo(i32* %a) sanitize_address {
+entry:
+  %tobool = icmp eq i32* %a, null
+  br i1 %tobool, label %if.end, label %if.then
+
+  if.then:                                          ; preds = %entry
+  store i32 0, i32* %a, align 4
+  br label %if.end
+
+  if.end:                                           ; preds = %entry, %if.then
+  ret void
+}
+
+define linkonce_odr void @bar(i1 %c) sanitize_address {
+entry:
+  br i1 %c, label %t, label %f
+
+t:
+  ret void
+
+f:
+  ret void
+}
+
+; CHECK: @__sancov_gen_8bit_counters = private global [6 x i8] zeroinitializer
+; CHECK-NOT: __sanitizer_cov_pcs_init
+; CHECK-LABEL: define void @foo
+; CHECK: [[C0:%[0-9]+]] = load i8, i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__sancov_gen_8bit_counters, i32 0, i32 0), !nosanitize
+; CHECK-NEXT: [[I0:%[0-9]+]] = add i8 [[C0]], 1
+; CHECK-NEXT: store i8 [[I0]], i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__sancov_gen_8bit_counters, i32 0, i32 0), !nosanitize
+; CHECK-NOT: call
+; CHECK: load i8, i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__sancov_gen_8bit_counters, i32 0, i32 1)
+; CHECK: load i8, i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__sancov_gen_8bit_counters, i32 0, i32 2)
+; CHECK-NOT: call
+; CHECK: ret void
+; CHECK-LABEL: define linkonce_odr void @bar
+; CHECK: load i8, i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__sancov_gen_8bit_counters, i32 0, i32 3)
+; CHECK: load i8, i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__sancov_gen_8bit_counters, i32 0, i32 4)
+; CHECK: load i8, i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__sancov_gen_8bit_counters, i32 0, i32 5)
+; CHECK-LABEL: define internal void @sancov.module_ctor
+; CHECK: call void @__sanitizer_cov_8bit_counters_init(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__sancov_gen_8bit_counters, i32 0, i32 0), i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__sancov_gen_8bit_counters, i64 1, i64 0))
+; CHECK-NOT: __sanitizer_cov_module_init
+
+; The entry blocks use the function address, and so do the blocks of @bar, of
+; which another copy may be linked.
+; CHECK_PCS: @__sancov_gen_pc_table = private constant [12 x i64] [i64 ptrtoint (void (i32*)* @foo to i64), i64 1, i64 ptrtoint (i8* blockaddress(@foo, %entry.if.end_crit_edge) to i64), i64 0, i64 ptrtoint (i8* blockaddress(@foo, %if.then) to i64), i64 0,
+; CHECK_PCS-SAME: i64 ptrtoint (void (i1)* @bar to i64), i64 1, i64 ptrtoint (void (i1)* @bar to i64), i64 0, i64 ptrtoint (void (i1)* @bar to i64), i64 0]
+; CHECK_PCS-LABEL: define internal void @sancov.module_ctor
+; CHECK_PCS: call void @__sanitizer_cov_8bit_counters_init
+; CHECK_PCS: call void @__sanitizer_cov_pcs_init(i64* getelementptr inbounds ([12 x i64], [12 x i64]* @__sancov_gen_pc_table, i32 0, i32 0), i64* getelementptr inbounds ([12 x i64], [12 x i64]* @__sancov_gen_pc_table, i64 1, i64 0))
@@ -89,3 +89,31 @@ entry:
 ; CHECK: ret void
 
 
+
+declare void @llvm.memset.p0i8.i64(i8* nocapture, i8, i64, i32, i1)
+
+; Memory intrinsics on non captured allocas cannot race and are left alone.
+define void @notcapturedmemset() nounwind uwtable sanitize_thread {
+entry:
+  %buf = alloca [16 x i8], align 1
+  %ptr = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i64 0, i64 0
+  call void @llvm.memset.p0i8.i64(i8* %ptr, i8 0, i64 16, i32 1, i1 false)
+  ret void
+}
+; CHECK-LABEL: define void @notcapturedmemset
+; CHECK: call void @llvm.memset.p0i8.i64
+; CHECK-NOT: call i8* @memset
+; CHECK: ret void
+
+define void @capturedmemset() nounwind uwtable sanitize_thread {
+entry:
+  %buf = alloca [16 x i8], align 1
+  %ptr = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i64 0, i64 0
+  call void @llvm.memset.p0i8.i64(i8* %ptr, i8 0, i64 16, i32 1, i1 false)
+  %cast = bitcast [16 x i8]* %buf to i32*
+  call void @escape(i32* %cast)
+  ret void
+}
+; CHECK-LABEL: define void @capturedmemset
+; CHECK: call i8* @memset
+; CHECK: ret void
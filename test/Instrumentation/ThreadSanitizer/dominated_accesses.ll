@@ -0,0 +1,99 @@
+; RUN: opt < %s -tsan -S | FileCheck %s
+; RUN: opt < %s -tsan -tsan-omit-dominated-accesses=false -S | FileCheck %s --check-prefix=ALL
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+declare void @foo()
+
+; A write covers the later reads and writes of the same address.
+define void @WriteThenReadWrite(i32* %ptr) nounwind uwtable sanitize_thread {
+entry:
+  store i32 1, i32* %ptr, align 4
+  %0 = load i32, i32* %ptr, align 4
+  %inc = add nsw i32 %0, 1
+  store i32 %inc, i32* %ptr, align 4
+  ret void
+}
+; CHECK-LABEL: define void @WriteThenReadWrite
+; CHECK: call void @__tsan_write4
+; CHECK-NOT: call void @__tsan_{{read|write}}
+; CHECK: ret void
+; ALL-LABEL: define void @WriteThenReadWrite
+; ALL: call void @__tsan_write4
+; ALL: call void @__tsan_write4
+; ALL: ret void
+
+; A read covers the later reads only.
+define i32 @ReadTwiceThenWrite(i32* %ptr) nounwind uwtable sanitize_thread {
+entry:
+  %0 = load i32, i32* %ptr, align 4
+  %1 = load i32, i32* %ptr, align 4
+  %add = add nsw i32 %0, %1
+  call void @foo()
+  %2 = load i32, i32* %ptr, align 4
+  store i32 %add, i32* %ptr, align 4
+  ret i32 %2
+}
+; CHECK-LABEL: define i32 @ReadTwiceThenWrite
+; CHECK: call void @__tsan_read4
+; CHECK-NOT: call void @__tsan_read4
+; CHECK: call void @foo()
+; CHECK-NOT: call void @__tsan_read4
+; CHECK: call void @__tsan_write4
+; CHECK: ret i32
+
+; The earlier access may be in a dominating block, when the blocks in between
+; have a single predecessor and no calls.
+define void @DominatingBlock(i32* %ptr, i1 %c) nounwind uwtable sanitize_thread {
+entry:
+  store i32 0, i32* %ptr, align 4
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 1, i32* %ptr, align 4
+  br label %exit
+
+exit:
+  store i32 2, i32* %ptr, align 4
+  ret void
+}
+; CHECK-LABEL: define void @DominatingBlock
+; CHECK: entry:
+; CHECK: call void @__tsan_write4
+; CHECK: then:
+; CHECK-NOT: call void @__tsan_write4
+; CHECK: exit:
+; CHECK: call void @__tsan_write4
+; CHECK: ret void
+
+define void @CallInDominatingBlock(i32* %ptr, i1 %c) nounwind uwtable sanitize_thread {
+entry:
+  store i32 0, i32* %ptr, align 4
+  call void @foo()
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 1, i32* %ptr, align 4
+  br label %exit
+
+exit:
+  ret void
+}
+; CHECK-LABEL: define void @CallInDominatingBlock
+; CHECK: then:
+; CHECK: call void @__tsan_write4
+; CHECK: ret void
+
+; Atomics may synchronize, so they end the coverage too.
+define void @AtomicInBetween(i32* %ptr, i32* %flag) nounwind uwtable sanitize_thread {
+entry:
+  store i32 0, i32* %ptr, align 4
+  store atomic i32 1, i32* %flag release, align 4
+  store i32 1, i32* %ptr, align 4
+  ret void
+}
+; CHECK-LABEL: define void @AtomicInBetween
+; CHECK: call void @__tsan_write4
+; CHECK: call void @__tsan_atomic32_store
+; CHECK: call void @__tsan_write4
+; CHECK: ret void
@@ -0,0 +1,113 @@
+; RUN: opt < %s -tsan -S | FileCheck %s
+; RUN: opt < %s -tsan -tsan-hoist-loop-accesses=false -S | FileCheck %s --check-prefix=NOHOIST
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @foo()
+
+; The loop invariant read is checked once before the loop, and the reads of
+; %a are checked as one range.
+define i32 @SumArray(i32* %a, i32* %scale, i64 %n) nounwind uwtable sanitize_thread {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %sum = phi i32 [ 0, %entry ], [ %sum.next, %loop ]
+  %s = load i32, i32* %scale, align 4
+  %p = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %p, align 4
+  %m = mul nsw i32 %v, %s
+  %sum.next = add nsw i32 %sum, %m
+  %i.next = add nuw nsw i64 %i, 1
+  %cond = icmp ult i64 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret i32 %sum.next
+}
+; CHECK-LABEL: define i32 @SumArray
+; CHECK: entry:
+; CHECK-DAG: call void @__tsan_read4(i8* %{{.*}})
+; CHECK-DAG: call void @__tsan_read_range(i8* %{{.*}}, i64 %{{.*}})
+; CHECK: br label %loop
+; CHECK: loop:
+; CHECK-NOT: call void @__tsan_read
+; CHECK: exit:
+; NOHOIST-LABEL: define i32 @SumArray
+; NOHOIST: loop:
+; NOHOIST: call void @__tsan_read4
+; NOHOIST: call void @__tsan_read4
+
+; The range of a strided store is written.
+define void @FillArray(i32* %a, i64 %n) nounwind uwtable sanitize_thread {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %p = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 0, i32* %p, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond = icmp ult i64 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret void
+}
+; CHECK-LABEL: define void @FillArray
+; CHECK: entry:
+; CHECK: call void @__tsan_write_range(i8* %{{.*}}, i64 %{{.*}})
+; CHECK: loop:
+; CHECK-NOT: call void @__tsan_write
+; CHECK: exit:
+
+; A call in the loop may synchronize, so the accesses stay in the loop.
+define void @CallInLoop(i32* %a, i64 %n) nounwind uwtable sanitize_thread {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %p = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 0, i32* %p, align 4
+  call void @foo()
+  %i.next = add nuw nsw i64 %i, 1
+  %cond = icmp ult i64 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret void
+}
+; CHECK-LABEL: define void @CallInLoop
+; CHECK: loop:
+; CHECK: call void @__tsan_write4
+; CHECK: call void @foo()
+
+; Accesses that don't run on every iteration stay in the loop.
+define void @ConditionalStore(i32* %a, i64 %n, i1 %c) nounwind uwtable sanitize_thread {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  br i1 %c, label %store, label %latch
+
+store:
+  %p = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 0, i32* %p, align 4
+  br label %latch
+
+latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %cond = icmp ult i64 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret void
+}
+; CHECK-LABEL: define void @ConditionalStore
+; CHECK: store:
+; CHECK: call void @__tsan_write4
+; CHECK: latch:
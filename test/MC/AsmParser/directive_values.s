@@ -81,3 +81,19 @@ TEST9:
 # CHECK: .quad 6510615555426900570
 # CHECK: .quad 4204772546213206618
 
+
+TEST10:
+        .byte 1, 2f - 1f, -1 # comment
+1:      .short 0x10, 3 + 4; .long 5
+2:      .quad 1b, 6
+# CHECK: TEST10
+# CHECK:        .byte   1
+# CHECK-NEXT:   .byte   [[L2:.Ltmp[0-9]+]]-[[L1:.Ltmp[0-9]+]]
+# CHECK-NEXT:   .byte   -1
+# CHECK-NEXT: [[L1]]:
+# CHECK-NEXT:   .short  16
+# CHECK-NEXT:   .short  7
+# CHECK-NEXT:   .long   5
+# CHECK-NEXT: [[L2]]:
+# CHECK-NEXT:   .quad   [[L1]]
+# CHECK-NEXT:   .quad   6
@@ -0,0 +1,28 @@
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o - | llvm-readobj -s -sd | FileCheck %s
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o /dev/null -stats 2>&1 | FileCheck --check-prefix=STATS %s
+// REQUIRES: asserts
+
+// The .uleb128 in .text grows to two bytes, so layout runs a second pass in
+// which the label differences are found in the layout's value cache. The
+// difference in .data is computed from .text fragments and must see the
+// relaxed offsets.
+
+        .text
+.La:
+        .uleb128 .Lb - .Lfoo
+.Lfoo:
+        .fill 200, 1, 0x90
+.Lb:
+
+        .data
+        .uleb128 .Lb - .La
+
+// CHECK:      Name: .text
+// CHECK:      SectionData (
+// CHECK-NEXT:   0000: C8019090
+
+// CHECK:      Name: .data
+// CHECK:      SectionData (
+// CHECK-NEXT:   0000: CA01
+
+// STATS: {{[0-9]+}} mcexpr - Number of MCExpr evaluations found in the layout's value cache
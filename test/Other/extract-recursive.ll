@@ -0,0 +1,45 @@
+; RUN: llvm-as < %s > %t
+; RUN: llvm-extract -func a -recursive -S %t | FileCheck %s
+; RUN: llvm-extract -func a -S %t | FileCheck --check-prefix=NOREC %s
+
+; With -recursive, everything @a refers to is extracted as well, including
+; functions reached through constant expressions and global initializers.
+
+; CHECK: @table = global [1 x void ()*] [void ()* @c]
+; CHECK-NOT: @unused_var
+; CHECK: define void @a()
+; CHECK: define void @b()
+; CHECK: define void @c()
+; CHECK: define void @d(i32
+; CHECK-NOT: define void @unused()
+
+; NOREC: @table = external global [1 x void ()*]
+; NOREC: define void @a()
+; NOREC: declare void @b()
+
+@table = global [1 x void ()*] [void ()* @c]
+@unused_var = global i32 0
+
+define void @a() {
+  call void @b()
+  %p = load void ()*, void ()** getelementptr ([1 x void ()*], [1 x void ()*]* @table, i32 0, i32 0)
+  call void %p()
+  ret void
+}
+
+define void @b() {
+  call void bitcast (void (i32)* @d to void ()*)()
+  ret void
+}
+
+define void @c() {
+  ret void
+}
+
+define void @d(i32) {
+  ret void
+}
+
+define void @unused() {
+  ret void
+}
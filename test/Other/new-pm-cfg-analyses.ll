@@ -0,0 +1,91 @@
+; Check that passes which leave the CFG alone keep the analyses computed from
+; it, and that results holding on to an invalidated analysis go away with it.
+
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='require<domtree>,require<postdomtree>,require<loops>,require<scalar-evolution>,instcombine,require<domtree>,require<postdomtree>,require<loops>,require<scalar-evolution>' \
+; RUN:     %s 2>&1 | FileCheck %s --check-prefix=INSTCOMBINE
+; INSTCOMBINE: Running pass: InstCombinePass
+; INSTCOMBINE-NEXT: Invalidating all non-preserved analyses for: f
+; INSTCOMBINE-NOT: Invalidating analysis: DominatorTreeAnalysis
+; INSTCOMBINE-NOT: Invalidating analysis: PostDominatorTreeAnalysis
+; INSTCOMBINE-NOT: Invalidating analysis: LoopAnalysis
+; INSTCOMBINE: Invalidating analysis: ScalarEvolutionAnalysis
+; INSTCOMBINE-NOT: Running analysis: DominatorTreeAnalysis
+; INSTCOMBINE-NOT: Running analysis: PostDominatorTreeAnalysis
+; INSTCOMBINE-NOT: Running analysis: LoopAnalysis
+; INSTCOMBINE: Running analysis: ScalarEvolutionAnalysis
+; INSTCOMBINE: Finished {{.*}}Function pass manager run.
+
+; LCSSA preserves scalar evolution as well as the CFG.
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='require<scalar-evolution>,lcssa,require<scalar-evolution>' \
+; RUN:     %s 2>&1 | FileCheck %s --check-prefix=LCSSA
+; LCSSA: Running analysis: ScalarEvolutionAnalysis
+; LCSSA: Running pass: LCSSAPass
+; LCSSA-NEXT: Invalidating all non-preserved analyses for: f
+; LCSSA-NOT: Invalidating analysis: DominatorTreeAnalysis
+; LCSSA-NOT: Invalidating analysis: LoopAnalysis
+; LCSSA-NOT: Invalidating analysis: ScalarEvolutionAnalysis
+; LCSSA-NOT: Running analysis:
+; LCSSA: Finished {{.*}}Function pass manager run.
+
+; Jump threading preserves lazy value info, but not the dominator tree which
+; it holds on to when one was available.
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='require<domtree>,require<lazy-value-info>,jump-threading,require<lazy-value-info>' \
+; RUN:     %s 2>&1 | FileCheck %s --check-prefix=DEPS
+; DEPS: Running pass: JumpThreadingPass on g
+; DEPS-NEXT: Invalidating all non-preserved analyses for: g
+; DEPS-DAG: Invalidating analysis: DominatorTreeAnalysis
+; DEPS-DAG: Invalidating analysis: LazyValueAnalysis
+; DEPS: Running analysis: LazyValueAnalysis
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='require<lazy-value-info>,jump-threading,require<lazy-value-info>' \
+; RUN:     %s 2>&1 | FileCheck %s --check-prefix=NODT
+; NODT: Running pass: JumpThreadingPass on g
+; NODT-NEXT: Invalidating all non-preserved analyses for: g
+; NODT-NOT: Invalidating analysis: LazyValueAnalysis
+; NODT-NOT: Running analysis: LazyValueAnalysis
+; NODT: Finished {{.*}}Function pass manager run.
+
+define i32 @f(i32 %n, i1 %c) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %x = add i32 %i, 0
+  %i.next = add i32 %x, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  br i1 %c, label %a, label %b
+
+a:
+  br label %b
+
+b:
+  ret i32 %i.next
+}
+
+define i32 @g(i1 %c) {
+entry:
+  br i1 %c, label %b1, label %b2
+
+b1:
+  br label %m
+
+b2:
+  br label %m
+
+m:
+  %p = phi i1 [ true, %b1 ], [ false, %b2 ]
+  br i1 %p, label %t, label %e
+
+t:
+  ret i32 1
+
+e:
+  ret i32 0
+}
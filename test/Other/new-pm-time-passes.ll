@@ -0,0 +1,26 @@
+; Check the -time-passes report of the new pass manager.
+
+; RUN: opt -disable-output -disable-verify -time-passes \
+; RUN:     -time-passes-json=%t.json \
+; RUN:     -passes='function(require<domtree>,invalidate<domtree>,require<domtree>,no-op-function)' \
+; RUN:     %s 2>&1 | FileCheck %s --check-prefix=REPORT
+; RUN: FileCheck %s --check-prefix=JSON < %t.json
+
+; REPORT: Pass execution timing report (new pass manager)
+; REPORT: Total Execution Time:
+; REPORT: Peak resident set size:
+; REPORT-DAG: {{ 4 +2 +}}Analysis: DominatorTreeAnalysis
+; REPORT-DAG: {{ 2 +0 +}}NoOpFunctionPass
+
+; JSON: "peak_rss_bytes":
+; JSON: "passes": [
+; JSON-DAG: {"name": "DominatorTreeAnalysis", "kind": "analysis", "runs": 4, "invalidations": 2, "wall_seconds": {{[0-9.]+}}, "user_seconds": {{[0-9.]+}}, "system_seconds": {{[0-9.]+}}, "malloc_bytes": {{-?[0-9]+}}, "peak_rss_growth_bytes": {{[0-9]+}}}
+; JSON-DAG: {"name": "NoOpFunctionPass", "kind": "pass", "runs": 2, "invalidations": 0,
+
+define void @foo() {
+  ret void
+}
+
+define void @bar() {
+  ret void
+}
@@ -0,0 +1,11 @@
+; RUN: opt -time-trace -time-trace-granularity=0 -time-trace-file=%t.json -instcombine -S %s -o /dev/null
+; RUN: FileCheck %s < %t.json
+
+; CHECK: "traceEvents":[
+; CHECK-DAG: "name":"OptFunction","args":{"detail":"foo"}
+; CHECK-DAG: "name":"Total OptFunction"
+
+define i32 @foo(i32 %a) {
+  %b = add i32 %a, 0
+  ret i32 %b
+}
@@ -0,0 +1,10 @@
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+define void @live_callee() {
+  ret void
+}
+
+define void @dead_callee() {
+  ret void
+}
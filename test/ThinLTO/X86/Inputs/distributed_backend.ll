@@ -0,0 +1,14 @@
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+@counter = global i32 0
+
+define void @globalfunc() {
+  call void @staticfunc()
+  ret void
+}
+
+define internal void @staticfunc() noinline {
+  store i32 1, i32* @counter
+  ret void
+}
@@ -0,0 +1,53 @@
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+@g = global i32 0
+
+define i32 @pure(i32 %x) {
+  %y = add i32 %x, 1
+  ret i32 %y
+}
+
+define i32 @reads() {
+  %v = load i32, i32* @g
+  ret i32 %v
+}
+
+define void @writes(i32* %p) {
+  store i32 0, i32* %p
+  ret void
+}
+
+define double @calls_sqrt(double %x) {
+  %r = call double @sqrt(double %x)
+  ret double %r
+}
+
+declare double @sqrt(double) nounwind readnone
+
+define void @ping(i32 %n) {
+  call void @pong(i32 %n)
+  ret void
+}
+
+define void @pong(i32 %n) {
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %done, label %again
+again:
+  %m = sub i32 %n, 1
+  call void @ping(i32 %m)
+  br label %done
+done:
+  ret void
+}
+
+define void @throws() {
+  call void @ext()
+  ret void
+}
+
+declare void @ext()
+
+define weak i32 @weakfn() {
+  ret i32 0
+}
@@ -0,0 +1,42 @@
+; RUN: opt -module-summary %s -o %t1.bc
+; RUN: opt -module-summary %p/Inputs/deadstrip.ll -o %t2.bc
+; RUN: llvm-lto -thinlto-action=run -exported-symbol=_main %t1.bc %t2.bc \
+; RUN:   -debug-only=function-import -stats 2>&1 | FileCheck %s
+; RUN: llvm-lto -thinlto-action=run %t1.bc %t2.bc \
+; RUN:   -debug-only=function-import 2>&1 | FileCheck %s --check-prefix=NOROOT
+; Computing the imports concurrently gives the same result.
+; RUN: llvm-lto -thinlto-action=run -exported-symbol=_main %t1.bc %t2.bc \
+; RUN:   -import-threads=2 -stats 2>&1 | FileCheck %s --check-prefix=STATS
+
+; REQUIRES: asserts
+
+; @dead and @dead_callee can't be reached from @main: @dead isn't used as a
+; root for the import and @dead_callee isn't imported.
+; CHECK: Found 2 dead symbols out of 4 summaries
+; CHECK-DAG: Ignores Dead GUID
+; CHECK-DAG: Ignores Dead GUID
+; CHECK-DAG: exports 1 functions
+; CHECK-DAG: - 1 functions imported from
+; CHECK: 2 function-import - Number of dead symbols found in the index
+
+; Without any preserved symbol, everything is considered live.
+; NOROOT-NOT: Ignores Dead GUID
+; NOROOT: - 2 functions imported from
+
+; STATS: 2 function-import - Number of dead symbols found in the index
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+declare void @live_callee()
+declare void @dead_callee()
+
+define i32 @main() {
+  call void @live_callee()
+  ret i32 0
+}
+
+define void @dead() {
+  call void @dead_callee()
+  ret void
+}
@@ -0,0 +1,33 @@
+; RUN: opt -module-summary %s -o %t1.bc
+; RUN: opt -module-summary %p/Inputs/distributed_backend.ll -o %t2.bc
+; RUN: llvm-lto -thinlto-action=thinlink -o %t.index.bc %t1.bc %t2.bc
+; RUN: llvm-lto -thinlto-action=distributedindexes -thinlto-index %t.index.bc %t1.bc %t2.bc
+
+; Each backend only reads its individual index.
+; RUN: rm %t.index.bc
+; RUN: llvm-lto -thinlto-action=backend %t1.bc
+; RUN: llvm-lto -thinlto-action=backend %t2.bc -thinlto-index %t2.bc.thinlto.bc -o %t2.o
+; RUN: llvm-nm %t1.bc.thinlto.o | FileCheck %s --check-prefix=NM1
+; RUN: llvm-nm %t2.o | FileCheck %s --check-prefix=NM2
+
+; @globalfunc is imported and inlined in @main, which now calls the promoted
+; @staticfunc. The source module, which doesn't import anything, still
+; promotes it.
+; NM1: T _main
+; NM1: U _staticfunc.llvm.{{[0-9]+}}
+; NM2: T _globalfunc
+; NM2: T _staticfunc.llvm.
+
+; RUN: not llvm-lto -thinlto-action=backend %t1.bc %t2.bc 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=ERR
+; ERR: A distributed backend processes a single input file.
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+declare void @globalfunc()
+
+define i32 @main() {
+  call void @globalfunc()
+  ret i32 0
+}
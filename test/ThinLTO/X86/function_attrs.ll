@@ -0,0 +1,63 @@
+; Check that the thin link infers function attributes from the summaries and
+; that the backends apply them to the functions they don't import.
+; RUN: opt -module-summary %s -o %t1.bc
+; RUN: opt -module-summary %p/Inputs/function_attrs.ll -o %t2.bc
+; RUN: llvm-lto -thinlto-action=thinlink -o %t.index.bc %t1.bc %t2.bc
+; RUN: llvm-lto -thinlto-action=import -import-instr-limit=0 -thinlto-index %t.index.bc %t1.bc -o - | llvm-dis -o - | FileCheck %s
+
+; The same through the FunctionImport pass with a combined index.
+; RUN: llvm-lto -thinlto -o %t3 %t1.bc %t2.bc
+; RUN: opt -function-import -import-instr-limit=0 -summary-file %t3.thinlto.bc %t1.bc -S | FileCheck %s
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+; CHECK-DAG: define i32 @only_pure(i32 %x) [[NORECURSE_NOUNWIND_READNONE:#[0-9]+]]
+; The FunctionImport pass promotes the local function, which is found under its
+; original name.
+; CHECK-DAG: define {{.*}}i32 @local_reads{{(\.llvm\.0)?}}() [[NORECURSE_NOUNWIND_READONLY:#[0-9]+]]
+; CHECK-DAG: define void @caller(i32* %p) {
+; CHECK-DAG: declare i32 @pure(i32) [[NORECURSE_NOUNWIND_READNONE]]
+; CHECK-DAG: declare i32 @reads() [[NORECURSE_NOUNWIND_READONLY]]
+; CHECK-DAG: declare void @writes(i32*) [[NORECURSE_NOUNWIND:#[0-9]+]]
+; The declaration of sqrt is not norecurse.
+; CHECK-DAG: declare double @calls_sqrt(double) [[NOUNWIND_READNONE:#[0-9]+]]
+; Recursive functions are not norecurse.
+; CHECK-DAG: declare void @ping(i32) [[NOUNWIND_READNONE]]
+; CHECK-DAG: declare void @throws(){{$}}
+; A weak definition may be replaced by one that doesn't have the attributes.
+; CHECK-DAG: declare i32 @weakfn(){{$}}
+
+; CHECK-DAG: attributes [[NORECURSE_NOUNWIND_READNONE]] = { norecurse nounwind readnone }
+; CHECK-DAG: attributes [[NORECURSE_NOUNWIND_READONLY]] = { norecurse nounwind readonly }
+; CHECK-DAG: attributes [[NORECURSE_NOUNWIND]] = { norecurse nounwind }
+; CHECK-DAG: attributes [[NOUNWIND_READNONE]] = { nounwind readnone }
+
+define i32 @only_pure(i32 %x) {
+  %r = call i32 @pure(i32 %x)
+  ret i32 %r
+}
+
+define internal i32 @local_reads() {
+  %r = call i32 @reads()
+  ret i32 %r
+}
+
+define void @caller(i32* %p) {
+  call i32 @only_pure(i32 0)
+  call i32 @local_reads()
+  call void @writes(i32* %p)
+  call double @calls_sqrt(double 2.0)
+  call void @ping(i32 3)
+  call void @throws()
+  call i32 @weakfn()
+  ret void
+}
+
+declare i32 @pure(i32)
+declare i32 @reads()
+declare void @writes(i32*)
+declare double @calls_sqrt(double)
+declare void @ping(i32)
+declare void @throws()
+declare i32 @weakfn()
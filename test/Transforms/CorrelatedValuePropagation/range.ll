@@ -1,4 +1,6 @@
 ; RUN: opt -correlated-propagation -S < %s | FileCheck %s
+; Evicting all but the last block between queries must not lose precision.
+; RUN: opt -correlated-propagation -lvi-max-cached-values=1 -S < %s | FileCheck %s
 
 declare i32 @foo()
 
@@ -0,0 +1,109 @@
+; RUN: opt < %s -basicaa -dse -enable-dse-memoryssa -S | FileCheck %s
+; RUN: opt < %s -aa-pipeline=basic-aa -passes=dse -enable-dse-memoryssa -S | FileCheck %s
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64"
+
+declare void @use(i32)
+
+; The store in the entry block is overwritten after the diamond.
+define void @test1(i32* %P, i1 %c) {
+; CHECK-LABEL: @test1(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: br i1 %c
+entry:
+  store i32 1, i32* %P
+  br i1 %c, label %then, label %else
+
+then:
+  call void @use(i32 0) readnone
+  br label %exit
+
+else:
+  br label %exit
+
+exit:
+; CHECK: exit:
+; CHECK-NEXT: store i32 2, i32* %P
+  store i32 2, i32* %P
+  ret void
+}
+
+; The overwriting store isn't executed on every path.
+define void @test2(i32* %P, i1 %c) {
+; CHECK-LABEL: @test2(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: store i32 1, i32* %P
+entry:
+  store i32 1, i32* %P
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 2, i32* %P
+  br label %exit
+
+exit:
+  ret void
+}
+
+; The stored value is read before it is overwritten.
+define i32 @test3(i32* %P, i1 %c) {
+; CHECK-LABEL: @test3(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: store i32 1, i32* %P
+entry:
+  store i32 1, i32* %P
+  br label %next
+
+next:
+  %v = load i32, i32* %P
+  store i32 2, i32* %P
+  ret i32 %v
+}
+
+; Stores that may alias the location but don't read it are looked past.
+define void @test4(i32* %P, i32* %Q) {
+; CHECK-LABEL: @test4(
+; CHECK-NEXT: store i32 10, i32* %Q
+; CHECK-NEXT: store i32 30, i32* %P
+; CHECK-NEXT: ret void
+  store i32 20, i32* %P
+  store i32 10, i32* %Q
+  store i32 30, i32* %P
+  ret void
+}
+
+; Storing back the value loaded from the same pointer, with a store to another
+; object in between.
+define void @test5(i32* noalias %P, i32* noalias %Q, i1 %c) {
+; CHECK-LABEL: @test5(
+; CHECK-NOT: store i32 %v
+; CHECK: ret void
+entry:
+  %v = load i32, i32* %P
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 0, i32* %Q
+  br label %exit
+
+exit:
+  store i32 %v, i32* %P
+  ret void
+}
+
+; A store on the way to a loop backedge gives up at the MemoryPhi.
+define void @test6(i32* %P, i1 %c) {
+; CHECK-LABEL: @test6(
+; CHECK: loop:
+; CHECK-NEXT: store i32 1, i32* %P
+entry:
+  br label %loop
+
+loop:
+  store i32 1, i32* %P
+  call void @use(i32 1)
+  br i1 %c, label %loop, label %exit
+
+exit:
+  store i32 2, i32* %P
+  ret void
+}
@@ -0,0 +1,54 @@
+; RUN: opt -function-order -function-order-file=%t -S < %s | FileCheck %s
+; RUN: FileCheck %s --check-prefix=ORDER < %t
+; RUN: opt -passes=function-order -S < %s | FileCheck %s
+; RUN: opt -function-order -function-order-max-cluster-size=1 -S < %s | FileCheck %s --check-prefix=NOMERGE
+
+; The hot callees are placed right after their hottest caller, the densest
+; cluster comes first, and the functions without a profile come last.
+
+; CHECK: define void @main()
+; CHECK: define void @h1()
+; CHECK: define void @h2()
+; CHECK: define void @c()
+; CHECK: define void @noprofile()
+
+; ORDER: .text.main
+; ORDER-NEXT: .text.h1
+; ORDER-NEXT: .text.h2
+; ORDER-NEXT: .text.c
+; ORDER-NEXT: .text.noprofile
+
+; Without merging, the functions are ordered by entry count per instruction.
+; NOMERGE: define void @h2()
+; NOMERGE: define void @h1()
+; NOMERGE: define void @main()
+; NOMERGE: define void @c()
+; NOMERGE: define void @noprofile()
+
+define void @noprofile() {
+  ret void
+}
+
+define void @c() !prof !10 {
+  ret void
+}
+
+define void @main() !prof !11 {
+  call void @h1()
+  call void @h2()
+  ret void
+}
+
+define void @h1() !prof !12 {
+  call void @h2()
+  ret void
+}
+
+define void @h2() !prof !13 {
+  ret void
+}
+
+!10 = !{!"function_entry_count", i64 10}
+!11 = !{!"function_entry_count", i64 100}
+!12 = !{!"function_entry_count", i64 1000}
+!13 = !{!"function_entry_count", i64 1100}
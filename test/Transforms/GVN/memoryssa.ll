@@ -0,0 +1,72 @@
+; RUN: opt < %s -basicaa -gvn -enable-gvn-memoryssa -S | FileCheck %s
+; RUN: opt < %s -aa-pipeline=basic-aa -passes=gvn -enable-gvn-memoryssa -S | FileCheck %s
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64"
+
+declare void @llvm.memset.p0i8.i64(i8* nocapture, i8, i64, i32, i1)
+
+; A store forwards to a load after a diamond.
+define i32 @test1(i32* %P, i32* noalias %Q, i32 %V, i1 %c) {
+; CHECK-LABEL: @test1(
+; CHECK: exit:
+; CHECK-NEXT: ret i32 %V
+entry:
+  store i32 %V, i32* %P
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 0, i32* %Q
+  br label %exit
+
+exit:
+  %A = load i32, i32* %P
+  ret i32 %A
+}
+
+; A dominating load of the same pointer with the same clobber.
+define i32 @test2(i32* noalias %P, i32* noalias %Q, i1 %c) {
+; CHECK-LABEL: @test2(
+; CHECK: exit:
+; CHECK-NEXT: %B = add i32 %A, %A
+entry:
+  %A = load i32, i32* %P
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 0, i32* %Q
+  br label %exit
+
+exit:
+  %A2 = load i32, i32* %P
+  %B = add i32 %A, %A2
+  ret i32 %B
+}
+
+; A store on one path clobbers the second load.
+define i32 @test3(i32* %P, i1 %c) {
+; CHECK-LABEL: @test3(
+; CHECK: exit:
+; CHECK-NEXT: %A2 = load i32, i32* %P
+entry:
+  %A = load i32, i32* %P
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 0, i32* %P
+  br label %exit
+
+exit:
+  %A2 = load i32, i32* %P
+  %B = add i32 %A, %A2
+  ret i32 %B
+}
+
+; A load is forwarded from part of a memset.
+define i8 @test4(i8* %P) {
+; CHECK-LABEL: @test4(
+; CHECK: call void @llvm.memset
+; CHECK-NEXT: ret i8 42
+  %Q = getelementptr i8, i8* %P, i64 3
+  call void @llvm.memset.p0i8.i64(i8* %P, i8 42, i64 16, i32 1, i1 false)
+  %A = load i8, i8* %Q
+  ret i8 %A
+}
@@ -0,0 +1,78 @@
+; RUN: opt -hotcoldsplit -S < %s | FileCheck %s
+; RUN: opt -passes=hotcoldsplit -S < %s | FileCheck %s
+; RUN: opt -hotcoldsplit -hotcoldsplit-min-size=100 -S < %s | FileCheck %s --check-prefix=SMALL
+
+declare void @sink(i32)
+
+; The cold block is outlined and the call to it is marked cold.
+; CHECK-LABEL: define void @foo(
+; CHECK: call void @foo_cold({{.*}}) #[[CALLATTR:[0-9]+]]
+; CHECK: ret void
+; SMALL-LABEL: define void @foo(
+; SMALL-NOT: call void @foo_cold(
+; SMALL: call void @sink(
+define void @foo(i32 %x, i32* %p) !prof !20 {
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %cold, label %hot, !prof !21
+
+cold:
+  %v = load i32, i32* %p
+  %a = add i32 %v, 1
+  %m = mul i32 %a, 3
+  store i32 %m, i32* %p
+  call void @sink(i32 %m)
+  br label %exit
+
+hot:
+  store i32 %x, i32* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+; Functions without a profile are left alone.
+; CHECK-LABEL: define void @noprofile(
+; CHECK-NOT: call void @noprofile_
+; CHECK: ret void
+define void @noprofile(i32 %x, i32* %p) {
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %cold, label %exit, !prof !21
+
+cold:
+  %v = load i32, i32* %p
+  %a = add i32 %v, 1
+  %m = mul i32 %a, 3
+  store i32 %m, i32* %p
+  call void @sink(i32 %m)
+  br label %exit
+
+exit:
+  ret void
+}
+
+; CHECK: define internal void @foo_cold({{.*}}) #[[ATTR:[0-9]+]]
+; CHECK: call void @sink(
+; CHECK: attributes #[[ATTR]] = { {{.*(cold.*minsize|minsize.*cold)}}
+; CHECK: attributes #[[CALLATTR]] = { cold }
+
+!llvm.module.flags = !{!1}
+!20 = !{!"function_entry_count", i64 1000}
+!21 = !{!"branch_weights", i32 1, i32 100000}
+
+!1 = !{i32 1, !"ProfileSummary", !2}
+!2 = !{!3, !4, !5, !6, !7, !8, !9, !10}
+!3 = !{!"ProfileFormat", !"InstrProf"}
+!4 = !{!"TotalCount", i64 10000}
+!5 = !{!"MaxCount", i64 1000}
+!6 = !{!"MaxInternalCount", i64 1}
+!7 = !{!"MaxFunctionCount", i64 1000}
+!8 = !{!"NumCounts", i64 3}
+!9 = !{!"NumFunctions", i64 3}
+!10 = !{!"DetailedSummary", !11}
+!11 = !{!12, !13, !14}
+!12 = !{i32 10000, i64 100, i32 1}
+!13 = !{i32 999000, i64 100, i32 1}
+!14 = !{i32 999999, i64 1, i32 2}
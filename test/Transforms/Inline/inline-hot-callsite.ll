@@ -0,0 +1,72 @@
+; RUN: opt < %s -inline -inline-threshold=0 -hot-callsite-threshold=100 -S | FileCheck %s
+; RUN: opt < %s -inline -inline-threshold=0 -hot-callsite-threshold=100 -inline-hot-callsite-budget=1 -S | FileCheck %s --check-prefix=BUDGET
+; RUN: opt < %s -inline -inline-threshold=0 -hot-callsite-threshold=0 -pass-remarks-missed=inline -disable-output 2>&1 | FileCheck %s --check-prefix=REMARK
+
+; This tests that a call site the profile finds hot gets the (higher)
+; hot-callsite-threshold and is inlined, while a cold call site to the same
+; callee is not, and that the inline cost of the hot call sites the profile
+; gets inlined is limited by -inline-hot-callsite-budget.
+
+define i32 @callee(i32 %x) {
+  %x1 = add i32 %x, 1
+  %x2 = add i32 %x1, 1
+  %x3 = add i32 %x2, 1
+  %x4 = add i32 %x3, 1
+  %x5 = add i32 %x4, 1
+  %x6 = add i32 %x5, 1
+  %x7 = add i32 %x6, 1
+  %x8 = add i32 %x7, 1
+  %x9 = add i32 %x8, 1
+  %x10 = add i32 %x9, 1
+  ret i32 %x10
+}
+
+define i32 @caller(i32 %y, i1 %c) !prof !21 {
+; CHECK-LABEL: @caller(
+; CHECK: hot:
+; CHECK-NOT: call i32 @callee
+; CHECK: cold:
+; CHECK: call i32 @callee
+entry:
+  br i1 %c, label %hot, label %cold, !prof !22
+
+hot:
+  %y1 = call i32 @callee(i32 %y)
+  ret i32 %y1
+
+cold:
+  %y2 = call i32 @callee(i32 %y)
+  ret i32 %y2
+}
+
+define i32 @budget(i32 %y) !prof !21 {
+; CHECK-LABEL: @budget(
+; CHECK-NOT: call i32 @callee
+; CHECK: ret i32
+; BUDGET-LABEL: @budget(
+; BUDGET: call i32 @callee
+; BUDGET: ret i32
+; REMARK: callee will not be inlined into budget although the call site is hot (count=300)
+  %y1 = call i32 @callee(i32 %y)
+  %y2 = call i32 @callee(i32 %y1)
+  ret i32 %y2
+}
+
+!llvm.module.flags = !{!1}
+!21 = !{!"function_entry_count", i64 300}
+!22 = !{!"branch_weights", i32 299, i32 1}
+
+!1 = !{i32 1, !"ProfileSummary", !2}
+!2 = !{!3, !4, !5, !6, !7, !8, !9, !10}
+!3 = !{!"ProfileFormat", !"InstrProf"}
+!4 = !{!"TotalCount", i64 10000}
+!5 = !{!"MaxCount", i64 1000}
+!6 = !{!"MaxInternalCount", i64 1}
+!7 = !{!"MaxFunctionCount", i64 1000}
+!8 = !{!"NumCounts", i64 3}
+!9 = !{!"NumFunctions", i64 3}
+!10 = !{!"DetailedSummary", !11}
+!11 = !{!12, !13, !14}
+!12 = !{i32 10000, i64 100, i32 1}
+!13 = !{i32 999000, i64 100, i32 1}
+!14 = !{i32 999999, i64 1, i32 2}
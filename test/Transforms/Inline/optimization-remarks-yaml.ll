@@ -0,0 +1,48 @@
+; RUN: opt < %s -inline -pass-remarks-output=%t -disable-output
+; RUN: FileCheck %s < %t
+; RUN: opt < %s -inline -pass-remarks-output=%t -disable-output \
+; RUN:     -pass-remarks-hotness-threshold=30
+; RUN: FileCheck %s < %t
+; RUN: opt < %s -inline -pass-remarks-output=%t -disable-output \
+; RUN:     -pass-remarks-hotness-threshold=31
+; RUN: count 0 < %t
+; RUN: opt < %s -inline -pass-remarks-output=%t -disable-output \
+; RUN:     -pass-remarks-filter=no-such-pass
+; RUN: count 0 < %t
+
+; CHECK:      --- !Analysis
+; CHECK-NEXT: Pass:            inline
+; CHECK-NEXT: Function:        bar
+; CHECK-NEXT: Hotness:         30
+; CHECK-NEXT: Message:         'foo should always be inlined (cost=always)'
+; CHECK-NEXT: ...
+; CHECK-NEXT: --- !Passed
+; CHECK-NEXT: Pass:            inline
+; CHECK-NEXT: Function:        bar
+; CHECK-NEXT: Hotness:         30
+; CHECK-NEXT: Message:         foo inlined into bar
+; CHECK-NEXT: ...
+; CHECK:      --- !Missed
+; CHECK-NEXT: Pass:            inline
+; CHECK-NEXT: Function:        bar
+; CHECK-NEXT: Hotness:         30
+; CHECK-NEXT: Message:         foz will not be inlined into bar
+; CHECK-NEXT: ...
+
+define i32 @foo(i32 %x, i32 %y) alwaysinline {
+  %add = add nsw i32 %x, %y
+  ret i32 %add
+}
+
+define i32 @foz(i32 %x, i32 %y) noinline {
+  %mul = mul nsw i32 %x, %y
+  ret i32 %mul
+}
+
+define i32 @bar(i32 %j) !prof !0 {
+  %call = call i32 @foo(i32 %j, i32 2)
+  %call2 = call i32 @foz(i32 %call, i32 %j)
+  ret i32 %call2
+}
+
+!0 = !{!"function_entry_count", i64 30}
@@ -0,0 +1,25 @@
+; REQUIRES: asserts
+; RUN: opt < %s -instcombine -S | FileCheck %s
+; RUN: opt < %s -instcombine -instcombine-incremental -S | FileCheck %s
+; RUN: opt < %s -instcombine -stats -disable-output 2>&1 | FileCheck %s --check-prefix=FULL
+; RUN: opt < %s -instcombine -instcombine-incremental -stats -disable-output 2>&1 | FileCheck %s --check-prefix=INCR
+
+; The fold of the 'and' only shows up once the shift was combined. Full mode
+; needs a second sweep for it and a third to find nothing left to do. In
+; incremental mode, the iterations over the queued instructions find it and
+; only the final sweep goes over the whole function again.
+
+; CHECK-LABEL: @chain(
+; CHECK-NEXT: %toBool = icmp ne i32 %a, 0
+; CHECK-NEXT: ret i1 %toBool
+define i1 @chain(i32 %a) {
+  %shl = shl i32 1, %a
+  %and = and i32 %shl, 1
+  %toBool = icmp eq i32 %and, 0
+  ret i1 %toBool
+}
+
+; FULL-NOT: seeded from modified instructions
+; FULL: 3 instcombine - Number of instcombine iterations{{$}}
+; INCR: 2 instcombine - Number of instcombine iterations seeded from modified instructions
+; INCR: 4 instcombine - Number of instcombine iterations{{$}}
@@ -0,0 +1,71 @@
+; RUN: opt -mtriple=x86_64-unknown-linux-gnu -mcpu=haswell -loop-data-prefetch -S < %s | FileCheck %s --check-prefix=HSW --check-prefix=ALL
+; RUN: opt -mtriple=x86_64-unknown-linux-gnu -mcpu=x86-64 -loop-data-prefetch -S < %s | FileCheck %s --check-prefix=NOPREF --check-prefix=ALL
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; The index B[i] is loaded ahead, clamped to the last iteration, and used to
+; prefetch A[B[i]].
+; ALL-LABEL: @indirect(
+define i64 @indirect(i64* nocapture readonly %a, i32* nocapture readonly %b, i64 %n) {
+entry:
+  br label %for.body
+
+; ALL: for.body:
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %sum = phi i64 [ 0, %entry ], [ %add, %for.body ]
+  %arrayidx = getelementptr inbounds i32, i32* %b, i64 %iv
+  %idx = load i32, i32* %arrayidx, align 4
+  %idxprom = sext i32 %idx to i64
+  %arrayidx2 = getelementptr inbounds i64, i64* %a, i64 %idxprom
+; HSW: %prefidx = load i32, i32* %{{.*}}, align 4
+; HSW-NEXT: [[EXT:%.*]] = sext i32 %prefidx to i64
+; HSW-NEXT: [[ADDR:%.*]] = getelementptr i64, i64* %a, i64 [[EXT]]
+; HSW-NEXT: [[PTR:%.*]] = bitcast i64* [[ADDR]] to i8*
+; HSW-NEXT: call void @llvm.prefetch(i8* [[PTR]], i32 0, i32 3, i32 1)
+; NOPREF-NOT: call void @llvm.prefetch
+; ALL: load i64, i64* %arrayidx2
+  %val = load i64, i64* %arrayidx2, align 8
+  %add = add i64 %val, %sum
+  %iv.next = add nuw nsw i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i64 %add
+}
+
+; Loading B[i] ahead isn't known to be in bounds if it isn't loaded on every
+; iteration.
+; ALL-LABEL: @indirect_cond(
+; ALL-NOT: call void @llvm.prefetch
+; ALL: ret i64
+define i64 @indirect_cond(i64* nocapture readonly %a, i32* nocapture readonly %b, i1* nocapture readonly %c, i64 %n) {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.inc ]
+  %sum = phi i64 [ 0, %entry ], [ %sum.next, %for.inc ]
+  %arrayidx.c = getelementptr inbounds i1, i1* %c, i64 %iv
+  %cond = load i1, i1* %arrayidx.c, align 1
+  br i1 %cond, label %if.then, label %for.inc
+
+if.then:
+  %arrayidx = getelementptr inbounds i32, i32* %b, i64 %iv
+  %idx = load i32, i32* %arrayidx, align 4
+  %idxprom = sext i32 %idx to i64
+  %arrayidx2 = getelementptr inbounds i64, i64* %a, i64 %idxprom
+  %val = load i64, i64* %arrayidx2, align 8
+  %add = add i64 %val, %sum
+  br label %for.inc
+
+for.inc:
+  %sum.next = phi i64 [ %add, %if.then ], [ %sum, %for.body ]
+  %iv.next = add nuw nsw i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i64 %sum.next
+}
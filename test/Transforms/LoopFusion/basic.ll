@@ -0,0 +1,148 @@
+; RUN: opt -loop-fusion -S < %s | FileCheck %s
+; RUN: opt -loop-fusion -loop-fusion-ignore-reuse -S < %s | FileCheck %s --check-prefix=NOREUSE
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; for (i = 0; i < 100; ++i) a[i] += 1;
+; for (j = 0; j < 100; ++j) b[j] = a[j] + a[j - 1];
+; CHECK-LABEL: @fuse(
+; CHECK: loop1:
+; CHECK-NEXT: %i = phi i64 [ 0, %entry ], [ %i.next, %loop2 ]
+; CHECK-NEXT: %j = phi i64 [ 0, %entry ], [ %j.next, %loop2 ]
+; CHECK: br label %loop2
+; CHECK-NOT: between:
+; CHECK: loop2:
+; CHECK: br i1 %c2, label %exit, label %loop1
+define void @fuse(i32* noalias %a, i32* noalias %b) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %pa = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %pa
+  %inc = add i32 %v, 1
+  store i32 %inc, i32* %pa
+  %i.next = add nuw nsw i64 %i, 1
+  %c1 = icmp eq i64 %i.next, 100
+  br i1 %c1, label %between, label %loop1
+
+between:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %between ], [ %j.next, %loop2 ]
+  %pa2 = getelementptr inbounds i32, i32* %a, i64 %j
+  %va = load i32, i32* %pa2
+  %jm1 = add nsw i64 %j, -1
+  %pa3 = getelementptr inbounds i32, i32* %a, i64 %jm1
+  %vp = load i32, i32* %pa3
+  %sum = add i32 %va, %vp
+  %pb = getelementptr inbounds i32, i32* %b, i64 %j
+  store i32 %sum, i32* %pb
+  %j.next = add nuw nsw i64 %j, 1
+  %c2 = icmp eq i64 %j.next, 100
+  br i1 %c2, label %exit, label %loop2
+
+exit:
+  ret void
+}
+
+; The second loop reads a[j + 1] before the first loop would have written it.
+; CHECK-LABEL: @forward_dep(
+; CHECK: between:
+; CHECK-NEXT: br label %loop2
+define void @forward_dep(i32* noalias %a, i32* noalias %b) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %pa = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 0, i32* %pa
+  %i.next = add nuw nsw i64 %i, 1
+  %c1 = icmp eq i64 %i.next, 100
+  br i1 %c1, label %between, label %loop1
+
+between:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %between ], [ %j.next, %loop2 ]
+  %jp1 = add nuw nsw i64 %j, 1
+  %pa2 = getelementptr inbounds i32, i32* %a, i64 %jp1
+  %va = load i32, i32* %pa2
+  %pb = getelementptr inbounds i32, i32* %b, i64 %j
+  store i32 %va, i32* %pb
+  %j.next = add nuw nsw i64 %j, 1
+  %c2 = icmp eq i64 %j.next, 100
+  br i1 %c2, label %exit, label %loop2
+
+exit:
+  ret void
+}
+
+; The loops don't run the same number of iterations.
+; CHECK-LABEL: @trip_count(
+; CHECK: between:
+; CHECK-NEXT: br label %loop2
+define void @trip_count(i32* noalias %a) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %pa = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 0, i32* %pa
+  %i.next = add nuw nsw i64 %i, 1
+  %c1 = icmp eq i64 %i.next, 100
+  br i1 %c1, label %between, label %loop1
+
+between:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %between ], [ %j.next, %loop2 ]
+  %pa2 = getelementptr inbounds i32, i32* %a, i64 %j
+  store i32 1, i32* %pa2
+  %j.next = add nuw nsw i64 %j, 1
+  %c2 = icmp eq i64 %j.next, 50
+  br i1 %c2, label %exit, label %loop2
+
+exit:
+  ret void
+}
+
+; Fusing loops over unrelated arrays gains no cache reuse.
+; CHECK-LABEL: @no_reuse(
+; CHECK: between:
+; CHECK-NEXT: br label %loop2
+; NOREUSE-LABEL: @no_reuse(
+; NOREUSE-NOT: between:
+; NOREUSE: br i1 %c2, label %exit, label %loop1
+define void @no_reuse(i32* noalias %a, i32* noalias %b) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %pa = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 0, i32* %pa
+  %i.next = add nuw nsw i64 %i, 1
+  %c1 = icmp eq i64 %i.next, 100
+  br i1 %c1, label %between, label %loop1
+
+between:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %between ], [ %j.next, %loop2 ]
+  %pb = getelementptr inbounds i32, i32* %b, i64 %j
+  store i32 1, i32* %pb
+  %j.next = add nuw nsw i64 %j, 1
+  %c2 = icmp eq i64 %j.next, 100
+  br i1 %c2, label %exit, label %loop2
+
+exit:
+  ret void
+}
@@ -0,0 +1,118 @@
+; RUN: opt -loop-idiom < %s -mtriple=x86_64-unknown-linux-gnu -mcpu=haswell -S | FileCheck %s
+
+; int ctlz_guarded(unsigned x) {
+;   int c = 0;
+;   if (x)
+;     do {
+;       c++;
+;       x >>= 1;
+;     } while (x);
+;   return c;
+; }
+; CHECK-LABEL: @ctlz_guarded(
+; CHECK: [[CTLZ:%.*]] = call i32 @llvm.ctlz.i32(i32 %x, i1 true)
+; CHECK: [[CNT:%.*]] = sub i32 32, [[CTLZ]]
+; CHECK: %tcphi = phi i32 [ [[CNT]], %while.body.preheader ], [ %tcdec, %while.body ]
+; CHECK: %tcdec = sub nuw i32 %tcphi, 1
+; CHECK: icmp eq i32 %tcdec, 0
+; CHECK: phi i32 [ [[CNT]], %while.body ]
+define i32 @ctlz_guarded(i32 %x) {
+entry:
+  %tobool3 = icmp eq i32 %x, 0
+  br i1 %tobool3, label %while.end, label %while.body.preheader
+
+while.body.preheader:
+  br label %while.body
+
+while.body:
+  %c.05 = phi i32 [ %inc, %while.body ], [ 0, %while.body.preheader ]
+  %x.addr.04 = phi i32 [ %shr, %while.body ], [ %x, %while.body.preheader ]
+  %inc = add nsw i32 %c.05, 1
+  %shr = lshr i32 %x.addr.04, 1
+  %tobool = icmp eq i32 %shr, 0
+  br i1 %tobool, label %while.end.loopexit, label %while.body
+
+while.end.loopexit:
+  %inc.lcssa = phi i32 [ %inc, %while.body ]
+  br label %while.end
+
+while.end:
+  %c.0.lcssa = phi i32 [ 0, %entry ], [ %inc.lcssa, %while.end.loopexit ]
+  ret i32 %c.0.lcssa
+}
+
+; x may be zero on entry, in which case the loop still runs once.
+; CHECK-LABEL: @ctlz_unguarded(
+; CHECK: [[NEXT:%.*]] = lshr i64 %x, 1
+; CHECK: [[CTLZ:%.*]] = call i64 @llvm.ctlz.i64(i64 [[NEXT]], i1 false)
+; CHECK: [[CNT:%.*]] = sub i64 65, [[CTLZ]]
+; CHECK: [[TRUNC:%.*]] = trunc i64 [[CNT]] to i32
+; CHECK: [[ADD:%.*]] = add i32 [[TRUNC]], %start
+; CHECK: phi i32 [ [[ADD]], %loop ]
+define i32 @ctlz_unguarded(i64 %x, i32 %start) {
+entry:
+  br label %loop
+
+loop:
+  %c = phi i32 [ %start, %entry ], [ %c.next, %loop ]
+  %v = phi i64 [ %x, %entry ], [ %v.next, %loop ]
+  %c.next = add i32 %c, 1
+  %v.next = lshr i64 %v, 1
+  %done = icmp eq i64 %v.next, 0
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %c.lcssa = phi i32 [ %c.next, %loop ]
+  ret i32 %c.lcssa
+}
+
+; Shifting left counts the bits above the lowest set one.
+; CHECK-LABEL: @cttz(
+; CHECK: [[CTTZ:%.*]] = call i32 @llvm.cttz.i32(i32 %x, i1 true)
+; CHECK: [[CNT:%.*]] = sub i32 32, [[CTTZ]]
+; CHECK: [[PREV:%.*]] = sub i32 [[CNT]], 1
+; CHECK: phi i32 [ [[PREV]], %while.body ]
+define i32 @cttz(i32 %x) {
+entry:
+  %tobool3 = icmp eq i32 %x, 0
+  br i1 %tobool3, label %while.end, label %while.body.preheader
+
+while.body.preheader:
+  br label %while.body
+
+while.body:
+  %c.05 = phi i32 [ %inc, %while.body ], [ 0, %while.body.preheader ]
+  %x.addr.04 = phi i32 [ %shl, %while.body ], [ %x, %while.body.preheader ]
+  %inc = add nsw i32 %c.05, 1
+  %shl = shl i32 %x.addr.04, 1
+  %tobool = icmp ne i32 %shl, 0
+  br i1 %tobool, label %while.body, label %while.end.loopexit
+
+while.end.loopexit:
+  %c.lcssa = phi i32 [ %c.05, %while.body ]
+  br label %while.end
+
+while.end:
+  %c.0.lcssa = phi i32 [ 0, %entry ], [ %c.lcssa, %while.end.loopexit ]
+  ret i32 %c.0.lcssa
+}
+
+; A negative value shifted right arithmetically never becomes zero.
+; CHECK-LABEL: @ashr_negative(
+; CHECK-NOT: llvm.ctlz
+; CHECK: ret
+define i32 @ashr_negative(i32 %x) {
+entry:
+  br label %loop
+
+loop:
+  %c = phi i32 [ 0, %entry ], [ %c.next, %loop ]
+  %v = phi i32 [ %x, %entry ], [ %v.next, %loop ]
+  %c.next = add i32 %c, 1
+  %v.next = ashr i32 %v, 1
+  %done = icmp eq i32 %v.next, 0
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 %c.next
+}
@@ -0,0 +1,85 @@
+; RUN: opt -loop-idiom < %s -S | FileCheck %s
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; size_t len(const char *s) {
+;   const char *p = s;
+;   while (*p)
+;     ++p;
+;   return p - s;
+; }
+; CHECK-LABEL: @scan_pointer(
+; CHECK: [[LEN:%.*]] = call i64 @strlen(i8* %s)
+; CHECK: [[END:%.*]] = getelementptr i8, i8* %s, i64 [[LEN]]
+; CHECK: %tcphi = phi i64
+; CHECK-NOT: load
+; CHECK: br i1
+; CHECK: phi i8* [ [[END]], %while.cond ]
+define i64 @scan_pointer(i8* %s) {
+entry:
+  br label %while.cond
+
+while.cond:
+  %p = phi i8* [ %s, %entry ], [ %incdec.ptr, %while.cond ]
+  %0 = load i8, i8* %p, align 1
+  %incdec.ptr = getelementptr inbounds i8, i8* %p, i64 1
+  %tobool = icmp eq i8 %0, 0
+  br i1 %tobool, label %while.end, label %while.cond
+
+while.end:
+  %p.lcssa = phi i8* [ %p, %while.cond ]
+  %sub.ptr.lhs.cast = ptrtoint i8* %p.lcssa to i64
+  %sub.ptr.rhs.cast = ptrtoint i8* %s to i64
+  %sub.ptr.sub = sub i64 %sub.ptr.lhs.cast, %sub.ptr.rhs.cast
+  ret i64 %sub.ptr.sub
+}
+
+; int len(const char *s) {
+;   int i = 0;
+;   while (s[i])
+;     ++i;
+;   return i;
+; }
+; CHECK-LABEL: @scan_index(
+; CHECK: [[LEN:%.*]] = call i64 @strlen(i8* %s)
+; CHECK: [[I:%.*]] = trunc i64 [[LEN]] to i32
+; CHECK-NOT: load
+; CHECK: phi i32 [ [[I]], %while.cond ]
+define i32 @scan_index(i8* %s) {
+entry:
+  br label %while.cond
+
+while.cond:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %while.cond ]
+  %i.trunc = phi i32 [ 0, %entry ], [ %inc, %while.cond ]
+  %arrayidx = getelementptr inbounds i8, i8* %s, i64 %i
+  %0 = load i8, i8* %arrayidx, align 1
+  %tobool = icmp ne i8 %0, 0
+  %inc = add nsw i32 %i.trunc, 1
+  %i.next = add nuw nsw i64 %i, 1
+  br i1 %tobool, label %while.cond, label %while.end
+
+while.end:
+  %i.lcssa = phi i32 [ %i.trunc, %while.cond ]
+  ret i32 %i.lcssa
+}
+
+; The loop does more than scanning, so it is left alone.
+; CHECK-LABEL: @scan_and_store(
+; CHECK-NOT: @strlen
+; CHECK: ret
+define void @scan_and_store(i8* %s, i8* %d) {
+entry:
+  br label %while.cond
+
+while.cond:
+  %p = phi i8* [ %s, %entry ], [ %incdec.ptr, %while.cond ]
+  %0 = load i8, i8* %p, align 1
+  store i8 %0, i8* %d, align 1
+  %incdec.ptr = getelementptr inbounds i8, i8* %p, i64 1
+  %tobool = icmp eq i8 %0, 0
+  br i1 %tobool, label %while.end, label %while.cond
+
+while.end:
+  ret void
+}
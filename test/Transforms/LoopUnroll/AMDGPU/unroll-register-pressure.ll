@@ -0,0 +1,36 @@
+; RUN: opt -mtriple=amdgcn-unknown-amdhsa -mcpu=hawaii -loop-unroll -S < %s | FileCheck -check-prefix=CHECK -check-prefix=WAVES4 %s
+; RUN: opt -mtriple=amdgcn-unknown-amdhsa -mcpu=hawaii -loop-unroll -amdgpu-unroll-min-waves=2 -S < %s | FileCheck -check-prefix=CHECK -check-prefix=WAVES2 %s
+
+; Each iteration loads 32 dwords into VGPRs. Two copies of the body would
+; need more than the 64 VGPRs of 4 waves per SIMD, but fit in the 128 of 2.
+
+; CHECK-LABEL: @test_unroll_vgpr_pressure(
+; CHECK: load <16 x i32>
+; CHECK: load <16 x i32>
+; WAVES4-NOT: load <16 x i32>
+; WAVES2: load <16 x i32>
+; WAVES2: load <16 x i32>
+; WAVES2-NOT: load <16 x i32>
+; CHECK: br i1
+define void @test_unroll_vgpr_pressure(<16 x i32> addrspace(1)* noalias nocapture %out, <16 x i32> addrspace(1)* noalias nocapture %a, <16 x i32> addrspace(1)* noalias nocapture %b) #0 {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i32 [ %i.next, %for.body ], [ 0, %entry ]
+  %a.ptr = getelementptr inbounds <16 x i32>, <16 x i32> addrspace(1)* %a, i32 %i
+  %b.ptr = getelementptr inbounds <16 x i32>, <16 x i32> addrspace(1)* %b, i32 %i
+  %out.ptr = getelementptr inbounds <16 x i32>, <16 x i32> addrspace(1)* %out, i32 %i
+  %a.val = load <16 x i32>, <16 x i32> addrspace(1)* %a.ptr
+  %b.val = load <16 x i32>, <16 x i32> addrspace(1)* %b.ptr
+  %sum = add <16 x i32> %a.val, %b.val
+  store <16 x i32> %sum, <16 x i32> addrspace(1)* %out.ptr
+  %i.next = add i32 %i, 1
+  %exitcond = icmp eq i32 %i.next, 256
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+attributes #0 = { nounwind }
@@ -0,0 +1,30 @@
+; RUN: opt < %s -S -loop-unroll -unroll-allow-partial -unroll-max-count=3 | FileCheck %s
+; Checks that partial unrolling with a remainder loop still honors the
+; maximum unroll count when no count divides the trip count.
+
+; CHECK-LABEL: @foo(
+; CHECK: for.body:
+; CHECK: store i32
+; CHECK: store i32
+; CHECK: br i1
+; CHECK: for.body.2:
+; CHECK: store i32
+; CHECK-NOT: store i32
+; CHECK: br label %for.body
+define void @foo(i32* nocapture %a) {
+entry:
+  br label %for.body
+
+for.body:                                         ; preds = %for.body, %entry
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %arrayidx = getelementptr inbounds i32, i32* %a, i64 %indvars.iv
+  %0 = load i32, i32* %arrayidx, align 4
+  %inc = add nsw i32 %0, 1
+  store i32 %inc, i32* %arrayidx, align 4
+  %indvars.iv.next = add nuw nsw i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 257
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:                                          ; preds = %for.body
+  ret void
+}
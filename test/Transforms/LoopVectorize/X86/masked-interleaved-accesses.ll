@@ -0,0 +1,87 @@
+; RUN: opt -S -loop-vectorize -mcpu=knl -force-vector-width=4 -force-vector-interleave=1 -enable-interleaved-mem-accesses < %s | FileCheck %s
+; RUN: opt -S -loop-vectorize -mcpu=knl -force-vector-width=4 -force-vector-interleave=1 -enable-interleaved-mem-accesses -enable-masked-interleaved-mem-accesses=false < %s | FileCheck %s --check-prefix=NOMASK
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Check that an interleaved load group of factor 2 with 1 gap is loaded with a
+; masked load on AVX-512, which doesn't access the gaps, so that no scalar
+; epilogue iteration is required.
+
+; void even_load(int *A, int *B) {
+;  for (unsigned i = 0; i < 1024; i+=2)
+;     B[i/2] = A[i] * 2;
+; }
+
+; CHECK-LABEL: @even_load(
+; CHECK: vector.body:
+; CHECK:   %wide.masked.vec = call <8 x i32> @llvm.masked.load.v8i32{{.*}}(<8 x i32>* %{{.*}}, i32 4, <8 x i1> <i1 true, i1 false, i1 true, i1 false, i1 true, i1 false, i1 true, i1 false>, <8 x i32> undef)
+; CHECK:   %strided.vec = shufflevector <8 x i32> %wide.masked.vec, <8 x i32> undef, <4 x i32> <i32 0, i32 2, i32 4, i32 6>
+; CHECK:   icmp eq i64 %index.next, 512
+
+; NOMASK-LABEL: @even_load(
+; NOMASK: vector.body:
+; NOMASK:   %wide.vec = load <8 x i32>, <8 x i32>* %{{.*}}, align 4
+; NOMASK:   icmp eq i64 %index.next, 508
+
+define void @even_load(i32* noalias nocapture readonly %A, i32* noalias nocapture %B) {
+entry:
+  br label %for.body
+
+for.cond.cleanup:
+  ret void
+
+for.body:
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %arrayidx = getelementptr inbounds i32, i32* %A, i64 %indvars.iv
+  %tmp = load i32, i32* %arrayidx, align 4
+  %mul = shl nsw i32 %tmp, 1
+  %tmp1 = lshr exact i64 %indvars.iv, 1
+  %arrayidx2 = getelementptr inbounds i32, i32* %B, i64 %tmp1
+  store i32 %mul, i32* %arrayidx2, align 4
+  %indvars.iv.next = add nuw nsw i64 %indvars.iv, 2
+  %cmp = icmp ult i64 %indvars.iv.next, 1024
+  br i1 %cmp, label %for.body, label %for.cond.cleanup
+}
+
+; Check that an interleaved store group of factor 3 with 1 gap is stored with
+; a masked store on AVX-512 instead of being scalarized.
+
+; void store_gap(int *A, int X) {
+;   for (int i = 0; i < 1024; i++) {
+;     A[3*i] = X + i;
+;     A[3*i+2] = X - i;
+;   }
+; }
+
+; CHECK-LABEL: @store_gap(
+; CHECK: vector.body:
+; CHECK:   %interleaved.vec = shufflevector <12 x i32>
+; CHECK:   call void @llvm.masked.store.v12i32{{.*}}(<12 x i32> %interleaved.vec, <12 x i32>* %{{.*}}, i32 4, <12 x i1> <i1 true, i1 false, i1 true, i1 true, i1 false, i1 true, i1 true, i1 false, i1 true, i1 true, i1 false, i1 true>)
+
+; NOMASK-LABEL: @store_gap(
+; NOMASK-NOT: @llvm.masked.store
+; NOMASK: ret void
+
+define void @store_gap(i32* noalias nocapture %A, i32 %X) {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %t = trunc i64 %i to i32
+  %add = add nsw i32 %X, %t
+  %sub = sub nsw i32 %X, %t
+  %idx0 = mul nuw nsw i64 %i, 3
+  %p0 = getelementptr inbounds i32, i32* %A, i64 %idx0
+  store i32 %add, i32* %p0, align 4
+  %idx2 = add nuw nsw i64 %idx0, 2
+  %p2 = getelementptr inbounds i32, i32* %A, i64 %idx2
+  store i32 %sub, i32* %p2, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond = icmp eq i64 %i.next, 1024
+  br i1 %cond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
@@ -0,0 +1,100 @@
+; RUN: opt -S -loop-vectorize -force-vector-width=4 -force-vector-interleave=1 -enable-outer-loop-vectorization < %s | FileCheck %s
+; RUN: opt -S -loop-vectorize -force-vector-width=4 -force-vector-interleave=1 < %s | FileCheck %s --check-prefix=DEFAULT
+
+target datalayout = "e-m:e-i64:64-i128:128-n32:64-S128"
+
+; Check that an outer loop whose inner loop has a small constant trip count is
+; vectorized along its own induction variable, after the inner loop is fully
+; unrolled.
+
+; void outer(int *A) {
+;   for (int i = 0; i < 1024; i++) {
+;     int t = A[i];
+;     for (int j = 0; j < 3; j++)
+;       t = t * 3 + j;
+;     A[i] = t;
+;   }
+; }
+
+; CHECK-LABEL: @outer(
+; CHECK: vector.body:
+; CHECK:   load <4 x i32>
+; CHECK:   mul nsw <4 x i32>
+; CHECK:   store <4 x i32>
+
+; DEFAULT-LABEL: @outer(
+; DEFAULT-NOT: <4 x i32>
+; DEFAULT: ret void
+
+define void @outer(i32* noalias nocapture %A) {
+entry:
+  br label %outer.header
+
+outer.header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %pA = getelementptr inbounds i32, i32* %A, i64 %i
+  %t0 = load i32, i32* %pA, align 4
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer.header ], [ %j.next, %inner ]
+  %t = phi i32 [ %t0, %outer.header ], [ %t.next, %inner ]
+  %jt = trunc i64 %j to i32
+  %m = mul nsw i32 %t, 3
+  %t.next = add nsw i32 %m, %jt
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, 3
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %t.lcssa = phi i32 [ %t.next, %inner ]
+  store i32 %t.lcssa, i32* %pA, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, 1024
+  br i1 %outer.cond, label %exit, label %outer.header
+
+exit:
+  ret void
+}
+
+; Check that a vectorize(enable) pragma on the outer loop asks for the same
+; without -enable-outer-loop-vectorization.
+
+; DEFAULT-LABEL: @outer_pragma(
+; DEFAULT: vector.body:
+; DEFAULT:   load <4 x i32>
+; DEFAULT:   store <4 x i32>
+
+define void @outer_pragma(i32* noalias nocapture %A) {
+entry:
+  br label %outer.header
+
+outer.header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %pA = getelementptr inbounds i32, i32* %A, i64 %i
+  %t0 = load i32, i32* %pA, align 4
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer.header ], [ %j.next, %inner ]
+  %t = phi i32 [ %t0, %outer.header ], [ %t.next, %inner ]
+  %jt = trunc i64 %j to i32
+  %m = mul nsw i32 %t, 3
+  %t.next = add nsw i32 %m, %jt
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, 3
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %t.lcssa = phi i32 [ %t.next, %inner ]
+  store i32 %t.lcssa, i32* %pA, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, 1024
+  br i1 %outer.cond, label %exit, label %outer.header, !llvm.loop !0
+
+exit:
+  ret void
+}
+
+!0 = distinct !{!0, !1}
+!1 = !{!"llvm.loop.vectorize.enable", i1 true}
@@ -0,0 +1,36 @@
+; RUN: opt -S -lowertypetests < %s | FileCheck %s
+
+; A type test that is only used by the branch right after it jumps straight to
+; the false successor when the offset is out of range.
+
+target datalayout = "e-p:32:32"
+
+@a = constant [100 x i32] zeroinitializer, !type !0, !type !1
+
+!0 = !{i32 0, !"typeid1"}
+!1 = !{i32 396, !"typeid1"}
+
+declare i1 @llvm.type.test(i8* %ptr, metadata %bitset) nounwind readnone
+
+; CHECK: @foo(i8* [[P:%[^ ]*]])
+define i32 @foo(i8* %p) {
+entry:
+  ; CHECK: [[R5:%[^ ]*]] = icmp ult i32 [[R4:%[^ ]*]], 100
+  ; CHECK-NEXT: br i1 [[R5]], label %[[THEN:[^ ,]*]], label %fail
+  ; CHECK: [[THEN]]:
+  ; CHECK-NEXT: [[R6:%[^ ]*]] = getelementptr i8, i8* @bits_use{{(\.[0-9]*)?}}, i32 [[R4]]
+  ; CHECK-NEXT: [[R7:%[^ ]*]] = load i8, i8* [[R6]]
+  ; CHECK-NEXT: [[R8:%[^ ]*]] = and i8 [[R7]], 1
+  ; CHECK-NEXT: [[R9:%[^ ]*]] = icmp ne i8 [[R8]], 0
+  ; CHECK-NEXT: br i1 [[R9]], label %pass, label %fail
+  %x = call i1 @llvm.type.test(i8* %p, metadata !"typeid1")
+  br i1 %x, label %pass, label %fail
+
+pass:
+  br label %fail
+
+fail:
+  ; CHECK: phi i32 [ 0, %[[THEN]] ], [ 1, %pass ], [ 0, %entry ]
+  %r = phi i32 [ 0, %entry ], [ 1, %pass ]
+  ret i32 %r
+}
@@ -0,0 +1,32 @@
+; RUN: opt -S -lowertypetests < %s | FileCheck %s
+
+; Bit sets small enough to fit in an immediate are tested without a branch.
+
+target datalayout = "e-p:32:32"
+
+; CHECK-NOT: private constant [{{[1-9][0-9]*}} x i8]
+@a = constant [10 x i32] zeroinitializer, !type !0, !type !1, !type !2
+
+!0 = !{i32 0, !"typeid1"}
+!1 = !{i32 8, !"typeid1"}
+!2 = !{i32 20, !"typeid1"}
+
+declare i1 @llvm.type.test(i8* %ptr, metadata %bitset) nounwind readnone
+
+; CHECK: @foo(i8* [[P:%[^ ]*]])
+define i1 @foo(i8* %p) {
+  ; CHECK: [[R0:%[^ ]*]] = ptrtoint i8* [[P]] to i32
+  ; CHECK-NEXT: [[R1:%[^ ]*]] = sub i32 [[R0]], ptrtoint ({ [10 x i32] }* [[G:@[^ ]*]] to i32)
+  ; CHECK-NEXT: [[R2:%[^ ]*]] = lshr i32 [[R1]], 2
+  ; CHECK-NEXT: [[R3:%[^ ]*]] = shl i32 [[R1]], 30
+  ; CHECK-NEXT: [[R4:%[^ ]*]] = or i32 [[R2]], [[R3]]
+  ; CHECK-NEXT: [[R5:%[^ ]*]] = icmp ult i32 [[R4]], 6
+  ; CHECK-NEXT: [[R6:%[^ ]*]] = and i32 [[R4]], 31
+  ; CHECK-NEXT: [[R7:%[^ ]*]] = shl i32 1, [[R6]]
+  ; CHECK-NEXT: [[R8:%[^ ]*]] = and i32 37, [[R7]]
+  ; CHECK-NEXT: [[R9:%[^ ]*]] = icmp ne i32 [[R8]], 0
+  ; CHECK-NEXT: [[R10:%[^ ]*]] = and i1 [[R5]], [[R9]]
+  %x = call i1 @llvm.type.test(i8* %p, metadata !"typeid1")
+  ; CHECK-NEXT: ret i1 [[R10]]
+  ret i1 %x
+}
@@ -0,0 +1,36 @@
+; RUN: opt -S -mergefunc < %s | FileCheck %s
+; RUN: opt -disable-output -mergefunc -stats < %s 2>&1 | FileCheck %s --check-prefix=STATS
+; REQUIRES: asserts
+
+; @b differs from @a and @a2 only in a constant, so its structural hash puts
+; it in a bucket of its own and it is never compared with them.
+
+; STATS-DAG: 1 mergefunc - Number of functions merged
+; STATS-DAG: 1 mergefunc - Number of functions skipped because of their unique hash
+
+define i32 @a(i32 %x) {
+; CHECK-LABEL: define i32 @a(
+; CHECK: add i32 %x, 1
+  %add = add i32 %x, 1
+  %mul = mul i32 %add, %x
+  %sub = sub i32 %mul, %add
+  ret i32 %sub
+}
+
+define i32 @b(i32 %x) {
+; CHECK-LABEL: define i32 @b(
+; CHECK: add i32 %x, 2
+  %add = add i32 %x, 2
+  %mul = mul i32 %add, %x
+  %sub = sub i32 %mul, %add
+  ret i32 %sub
+}
+
+define i32 @a2(i32 %x) {
+; CHECK-LABEL: define i32 @a2(
+; CHECK: tail call i32 @a(i32 %0)
+  %add = add i32 %x, 1
+  %mul = mul i32 %add, %x
+  %sub = sub i32 %mul, %add
+  ret i32 %sub
+}
@@ -0,0 +1,50 @@
+; RUN: opt < %s -pgo-instr-gen -S | FileCheck %s --check-prefix=GEN
+; RUN: opt < %s -passes=pgo-instr-gen -S | FileCheck %s --check-prefix=GEN
+; RUN: llvm-profdata merge %S/Inputs/identical_edges.proftext -o %t.profdata
+; RUN: opt < %s -pgo-instr-use -pgo-test-profile-file=%t.profdata -S | FileCheck %s --check-prefix=USE
+; RUN: opt < %s -passes=pgo-instr-use -pgo-test-profile-file=%t.profdata -S | FileCheck %s --check-prefix=USE
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Identical edges out of the switch are counted as one edge. The cold edges to
+; %join are critical and get one counter in one new block between them.
+
+define i32 @test_identical_edges(i32 %i) {
+entry:
+; GEN: entry:
+; GEN-NOT: call void @llvm.instrprof.increment
+; GEN: i32 1, label %entry.join_crit_edge
+; GEN-NEXT: i32 2, label %entry.join_crit_edge
+; GEN-NEXT: i32 3, label %other
+; USE: switch
+; USE: ]
+; USE-SAME: !prof ![[BW_SWITCH:[0-9]+]]
+  switch i32 %i, label %other [
+    i32 1, label %join
+    i32 2, label %join
+    i32 3, label %other
+  ], !prof !0
+
+; GEN: entry.join_crit_edge:
+; GEN-NEXT: call void @llvm.instrprof.increment(i8* getelementptr inbounds ([20 x i8], [20 x i8]* @__profn_test_identical_edges, i32 0, i32 0), i64 22349536367, i32 2, i32 1)
+; GEN-NEXT: br label %join
+
+other:
+; GEN: other:
+; GEN-NEXT: call void @llvm.instrprof.increment(i8* getelementptr inbounds ([20 x i8], [20 x i8]* @__profn_test_identical_edges, i32 0, i32 0), i64 22349536367, i32 2, i32 0)
+  %call = call i32 @bar(i32 %i)
+  br label %join
+
+join:
+; GEN: join:
+; GEN-NOT: call void @llvm.instrprof.increment
+  %r = phi i32 [ 0, %entry ], [ 0, %entry ], [ %call, %other ]
+  ret i32 %r
+}
+
+declare i32 @bar(i32)
+
+!0 = !{!"branch_weights", i32 100000, i32 1, i32 1, i32 100000}
+
+; The count of the identical edges goes to the first of them.
+; USE: ![[BW_SWITCH]] = !{!"branch_weights", i32 5, i32 3, i32 0, i32 0}
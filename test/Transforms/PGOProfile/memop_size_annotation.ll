@@ -0,0 +1,32 @@
+; RUN: llvm-profdata merge %S/Inputs/memop_size.proftext -o %t.profdata
+; RUN: opt < %s -pgo-instr-use -pgo-test-profile-file=%t.profdata -S | FileCheck %s --check-prefix=MEMOP-ANNOTATION
+; RUN: opt < %s -passes=pgo-instr-use -pgo-test-profile-file=%t.profdata -S | FileCheck %s --check-prefix=MEMOP-ANNOTATION
+; RUN: opt < %s -pgo-instr-use -pgo-test-profile-file=%t.profdata -pgo-instr-memop=false -S | FileCheck %s --check-prefix=NOMEMOP
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define void @foo(i8* %dst, i8* %src, i32 %n, i64 %m) {
+entry:
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 %n, i32 1, i1 false)
+; MEMOP-ANNOTATION: call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 %n, i32 1, i1 false)
+; MEMOP-ANNOTATION-SAME: !prof ![[MEMOP0:[0-9]+]]
+  call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 16, i32 1, i1 false)
+; MEMOP-ANNOTATION: call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 16, i32 1, i1 false){{$}}
+  call void @llvm.memset.p0i8.i64(i8* %dst, i8 0, i64 %m, i32 1, i1 false)
+; MEMOP-ANNOTATION: call void @llvm.memset.p0i8.i64(i8* %dst, i8 0, i64 %m, i32 1, i1 false)
+; MEMOP-ANNOTATION-SAME: !prof ![[MEMOP1:[0-9]+]]
+  call void @llvm.memmove.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 %m, i32 1, i1 false)
+; MEMOP-ANNOTATION: call void @llvm.memmove.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 %m, i32 1, i1 false){{$}}
+  ret void
+}
+
+; MEMOP-ANNOTATION: ![[MEMOP0]] = !{!"VP", i32 1, i64 5000, i64 8, i64 3000, i64 16, i64 1500, i64 1, i64 500}
+; MEMOP-ANNOTATION: ![[MEMOP1]] = !{!"VP", i32 1, i64 5000, i64 100, i64 5000}
+
+; NOMEMOP-NOT: !"VP"
+
+declare void @llvm.memcpy.p0i8.p0i8.i32(i8* nocapture, i8* nocapture readonly, i32, i32, i1)
+declare void @llvm.memcpy.p0i8.p0i8.i64(i8* nocapture, i8* nocapture readonly, i64, i32, i1)
+declare void @llvm.memmove.p0i8.p0i8.i64(i8* nocapture, i8* nocapture readonly, i64, i32, i1)
+declare void @llvm.memset.p0i8.i64(i8* nocapture, i8, i64, i32, i1)
@@ -0,0 +1,59 @@
+; RUN: opt < %s -pgo-memop-opt -S | FileCheck %s
+; RUN: opt < %s -passes=pgo-memop-opt -S | FileCheck %s
+; RUN: opt < %s -pgo-memop-opt -pgo-memop-max-version=1 -S | FileCheck %s --check-prefix=MAXVER
+; RUN: opt < %s -pgo-memop-opt -disable-memop-opt -S | FileCheck %s --check-prefix=DISABLE
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define void @foo(i8* %dst, i8* %src, i32 %n) {
+entry:
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 %n, i32 1, i1 false), !prof !0
+  ret void
+}
+
+; Sizes 8 and 16 are hot enough. Size 1 is under the count threshold and stays
+; in the profile of the default version.
+; CHECK-LABEL: @foo(
+; CHECK: switch i32 %n, label %[[DEFAULT:.*]] [
+; CHECK-NEXT:   i32 8, label %[[CASE8:.*]]
+; CHECK-NEXT:   i32 16, label %[[CASE16:.*]]
+; CHECK-NEXT: ], !prof ![[SWITCH_BW:[0-9]+]]
+; CHECK: [[CASE8]]:
+; CHECK-NEXT: call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 8, i32 1, i1 false){{$}}
+; CHECK-NEXT: br label %[[MERGE:.*]]
+; CHECK: [[CASE16]]:
+; CHECK-NEXT: call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 16, i32 1, i1 false){{$}}
+; CHECK-NEXT: br label %[[MERGE]]
+; CHECK: [[DEFAULT]]:
+; CHECK-NEXT: call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 %n, i32 1, i1 false), !prof ![[NEWVP:[0-9]+]]
+; CHECK-NEXT: br label %[[MERGE]]
+; CHECK: [[MERGE]]:
+; CHECK-NEXT: ret void
+
+; MAXVER: switch i32 %n, label %{{.*}} [
+; MAXVER-NEXT:   i32 8, label %{{.*}}
+; MAXVER-NEXT: ]
+
+; DISABLE-NOT: switch
+
+define void @bar(i8* %dst, i64 %n) {
+entry:
+  call void @llvm.memset.p0i8.i64(i8* %dst, i8 0, i64 %n, i32 1, i1 false), !prof !1
+  ret void
+}
+
+; No size is hot enough.
+; CHECK-LABEL: @bar(
+; CHECK-NOT: switch
+; CHECK: call void @llvm.memset.p0i8.i64(i8* %dst, i8 0, i64 %n, i32 1, i1 false), !prof ![[BARVP:[0-9]+]]
+
+; CHECK: ![[SWITCH_BW]] = !{!"branch_weights", i32 500, i32 3000, i32 1500}
+; CHECK: ![[NEWVP]] = !{!"VP", i32 1, i64 500, i64 1, i64 500}
+; CHECK: ![[BARVP]] = !{!"VP", i32 1, i64 5000, i64 8, i64 1000, i64 16, i64 1000, i64 32, i64 1000}
+
+declare void @llvm.memcpy.p0i8.p0i8.i32(i8* nocapture, i8* nocapture readonly, i32, i32, i1)
+declare void @llvm.memset.p0i8.i64(i8* nocapture, i8, i64, i32, i1)
+
+!0 = !{!"VP", i32 1, i64 5000, i64 8, i64 3000, i64 16, i64 1500, i64 1, i64 500}
+!1 = !{!"VP", i32 1, i64 5000, i64 8, i64 1000, i64 16, i64 1000, i64 32, i64 1000}
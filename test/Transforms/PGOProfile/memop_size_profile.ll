@@ -0,0 +1,39 @@
+; RUN: opt < %s -pgo-instr-gen -S | FileCheck %s --check-prefix=GEN
+; RUN: opt < %s -passes=pgo-instr-gen -S | FileCheck %s --check-prefix=GEN
+; RUN: opt < %s -pgo-instr-gen -pgo-instr-memop=false -S | FileCheck %s --check-prefix=NOMEMOP
+; RUN: opt < %s -pgo-instr-gen -instrprof -S | FileCheck %s --check-prefix=LOWER
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The memory intrinsics with a variable length have their length value
+; profiled. The ones with a constant length don't.
+define void @foo(i8* %dst, i8* %src, i32 %n, i64 %m) {
+entry:
+; GEN: [[N:%[0-9]+]] = zext i32 %n to i64
+; GEN-NEXT: call void @llvm.instrprof.value.profile(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 12884901887, i64 [[N]], i32 1, i32 0)
+; GEN-NEXT: call void @llvm.memcpy.p0i8.p0i8.i32(
+  call void @llvm.memcpy.p0i8.p0i8.i32(i8* %dst, i8* %src, i32 %n, i32 1, i1 false)
+; GEN-NEXT: call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 16,
+  call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 16, i32 1, i1 false)
+; GEN-NEXT: call void @llvm.instrprof.value.profile(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 12884901887, i64 %m, i32 1, i32 1)
+; GEN-NEXT: call void @llvm.memset.p0i8.i64(
+  call void @llvm.memset.p0i8.i64(i8* %dst, i8 0, i64 %m, i32 1, i1 false)
+; GEN-NEXT: call void @llvm.instrprof.value.profile(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 12884901887, i64 %m, i32 1, i32 2)
+; GEN-NEXT: call void @llvm.memmove.p0i8.p0i8.i64(
+  call void @llvm.memmove.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 %m, i32 1, i1 false)
+  ret void
+}
+
+; NOMEMOP-NOT: @llvm.instrprof.value.profile
+
+; The memory intrinsic sites are counted after the indirect call sites.
+; LOWER: @__profd_foo = private global {{.*}}, [2 x i16] [i16 0, i16 3] }
+; LOWER: call void @__llvm_profile_instrument_target(i64 %{{[0-9]+}}, i8* bitcast ({{.*}}@__profd_foo to i8*), i32 0)
+; LOWER: call void @__llvm_profile_instrument_target(i64 %m, i8* bitcast ({{.*}}@__profd_foo to i8*), i32 1)
+; LOWER: call void @__llvm_profile_instrument_target(i64 %m, i8* bitcast ({{.*}}@__profd_foo to i8*), i32 2)
+
+declare void @llvm.memcpy.p0i8.p0i8.i32(i8* nocapture, i8* nocapture readonly, i32, i32, i1)
+declare void @llvm.memcpy.p0i8.p0i8.i64(i8* nocapture, i8* nocapture readonly, i64, i32, i1)
+declare void @llvm.memmove.p0i8.p0i8.i64(i8* nocapture, i8* nocapture readonly, i64, i32, i1)
+declare void @llvm.memset.p0i8.i64(i8* nocapture, i8, i64, i32, i1)
@@ -0,0 +1,100 @@
+; RUN: opt -slp-vectorizer -S < %s -mtriple=x86_64-apple-macosx -mcpu=corei7-avx | FileCheck %s
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+
+; Check that horizontal reductions are not limited to adds, but also handle
+; bitwise operations and fast-math multiplications.
+
+; int xor_red(int *A, long n) {
+;   int r = 0;
+;   for (long i = 0; i < n; ++i)
+;     r ^= 7*A[i*4] ^ 7*A[i*4+1] ^ 7*A[i*4+2] ^ 7*A[i*4+3];
+;   return r;
+; }
+
+; CHECK-LABEL: @xor_red(
+; CHECK: mul <4 x i32>
+; CHECK: shufflevector <4 x i32>
+; CHECK: xor <4 x i32>
+
+define i32 @xor_red(i32* noalias %A, i64 %n) {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.body ]
+  %r = phi i32 [ 0, %entry ], [ %r.next, %for.body ]
+  %idx0 = shl nsw i64 %i, 2
+  %p0 = getelementptr inbounds i32, i32* %A, i64 %idx0
+  %a0 = load i32, i32* %p0, align 4
+  %m0 = mul i32 %a0, 7
+  %idx1 = or i64 %idx0, 1
+  %p1 = getelementptr inbounds i32, i32* %A, i64 %idx1
+  %a1 = load i32, i32* %p1, align 4
+  %m1 = mul i32 %a1, 7
+  %x1 = xor i32 %m0, %m1
+  %idx2 = or i64 %idx0, 2
+  %p2 = getelementptr inbounds i32, i32* %A, i64 %idx2
+  %a2 = load i32, i32* %p2, align 4
+  %m2 = mul i32 %a2, 7
+  %x2 = xor i32 %x1, %m2
+  %idx3 = or i64 %idx0, 3
+  %p3 = getelementptr inbounds i32, i32* %A, i64 %idx3
+  %a3 = load i32, i32* %p3, align 4
+  %m3 = mul i32 %a3, 7
+  %x3 = xor i32 %x2, %m3
+  %r.next = xor i32 %r, %x3
+  %inc = add nsw i64 %i, 1
+  %exitcond = icmp eq i64 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i32 %r.next
+}
+
+; float fmul_red(float *A, long n) {
+;   float r = 1;
+;   for (long i = 0; i < n; ++i)
+;     r *= (A[i*4]+1) * (A[i*4+1]+1) * (A[i*4+2]+1) * (A[i*4+3]+1);
+;   return r;
+; }
+
+; CHECK-LABEL: @fmul_red(
+; CHECK: fadd <4 x float>
+; CHECK: shufflevector <4 x float>
+; CHECK: fmul fast <4 x float>
+
+define float @fmul_red(float* noalias %A, i64 %n) {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.body ]
+  %r = phi float [ 1.000000e+00, %entry ], [ %r.next, %for.body ]
+  %idx0 = shl nsw i64 %i, 2
+  %p0 = getelementptr inbounds float, float* %A, i64 %idx0
+  %a0 = load float, float* %p0, align 4
+  %s0 = fadd float %a0, 1.000000e+00
+  %idx1 = or i64 %idx0, 1
+  %p1 = getelementptr inbounds float, float* %A, i64 %idx1
+  %a1 = load float, float* %p1, align 4
+  %s1 = fadd float %a1, 1.000000e+00
+  %m1 = fmul fast float %s0, %s1
+  %idx2 = or i64 %idx0, 2
+  %p2 = getelementptr inbounds float, float* %A, i64 %idx2
+  %a2 = load float, float* %p2, align 4
+  %s2 = fadd float %a2, 1.000000e+00
+  %m2 = fmul fast float %m1, %s2
+  %idx3 = or i64 %idx0, 3
+  %p3 = getelementptr inbounds float, float* %A, i64 %idx3
+  %a3 = load float, float* %p3, align 4
+  %s3 = fadd float %a3, 1.000000e+00
+  %m3 = fmul fast float %m2, %s3
+  %r.next = fmul fast float %r, %m3
+  %inc = add nsw i64 %i, 1
+  %exitcond = icmp eq i64 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret float %r.next
+}
@@ -0,0 +1,42 @@
+; RUN: opt -safe-stack -S -mtriple=i386-pc-linux-gnu < %s -o - | FileCheck %s
+; RUN: opt -safe-stack -S -mtriple=x86_64-pc-linux-gnu < %s -o - | FileCheck %s
+
+; A memset whose length isn't a constant is safe when its largest possible
+; value fits in the alloca.
+
+define void @bounded_memset(i32 %n) nounwind uwtable safestack {
+entry:
+  ; CHECK-LABEL: @bounded_memset(
+  ; CHECK-NOT: __safestack_unsafe_stack_ptr
+  ; CHECK: ret void
+  %buf = alloca [16 x i8], align 1
+  %len = and i32 %n, 15
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i32 0, i32 0
+  call void @llvm.memset.p0i8.i32(i8* %p, i8 0, i32 %len, i32 1, i1 false)
+  ret void
+}
+
+define void @bounded_memset_offset(i32 %n) nounwind uwtable safestack {
+entry:
+  ; CHECK-LABEL: @bounded_memset_offset(
+  ; CHECK: __safestack_unsafe_stack_ptr
+  ; CHECK: ret void
+  %buf = alloca [16 x i8], align 1
+  %len = and i32 %n, 15
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i32 0, i32 4
+  call void @llvm.memset.p0i8.i32(i8* %p, i8 0, i32 %len, i32 1, i1 false)
+  ret void
+}
+
+define void @unbounded_memset(i32 %n) nounwind uwtable safestack {
+entry:
+  ; CHECK-LABEL: @unbounded_memset(
+  ; CHECK: __safestack_unsafe_stack_ptr
+  ; CHECK: ret void
+  %buf = alloca [16 x i8], align 1
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i32 0, i32 0
+  call void @llvm.memset.p0i8.i32(i8* %p, i8 0, i32 %n, i32 1, i1 false)
+  ret void
+}
+
+declare void @llvm.memset.p0i8.i32(i8* nocapture, i8, i32, i32, i1)
@@ -1,5 +1,7 @@
 ; RUN: opt < %s -instcombine -sample-profile -sample-profile-file=%S/Inputs/calls.prof | opt -analyze -branch-prob | FileCheck %s
 ; RUN: opt < %s -passes="function(instcombine),sample-profile" -sample-profile-file=%S/Inputs/calls.prof | opt -analyze -branch-prob | FileCheck %s
+; RUN: llvm-profdata merge -sample -indexed-binary %S/Inputs/calls.prof -o %t.profdata
+; RUN: opt < %s -instcombine -sample-profile -sample-profile-file=%t.profdata | opt -analyze -branch-prob | FileCheck %s
 
 ; Original C++ test case
 ;
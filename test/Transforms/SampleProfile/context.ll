@@ -0,0 +1,67 @@
+; RUN: opt < %s -sample-profile -sample-profile-file=%S/Inputs/context.prof -S | FileCheck %s
+; RUN: opt < %s -passes=sample-profile -sample-profile-file=%S/Inputs/context.prof -S | FileCheck %s
+; RUN: llvm-profdata merge -sample -indexed-binary %S/Inputs/context.prof -o %t.profdata
+; RUN: opt < %s -sample-profile -sample-profile-file=%t.profdata -S | FileCheck %s
+; RUN: opt < %s -sample-profile -sample-profile-file=%S/Inputs/context.prof -sample-profile-inline-hot-threshold=95 -S | FileCheck %s --check-prefix=COLD
+
+; The profile of foo called from main:2 is kept apart from its other samples.
+; Since that context is hot in main, the call is inlined and annotated with
+; the samples of the context, while foo itself keeps its own samples.
+
+define i32 @_Z3fooi(i32 %x) !dbg !4 {
+entry:
+  %cmp = icmp sgt i32 %x, 0, !dbg !10
+  br i1 %cmp, label %then, label %else, !dbg !10
+; CHECK-LABEL: define i32 @_Z3fooi(
+; CHECK: br i1 %cmp, label %then, label %else, !dbg !{{[0-9]+}}, !prof ![[FOO:[0-9]+]]
+; COLD-LABEL: define i32 @_Z3fooi(
+; COLD: br i1 %cmp, label %then, label %else, !dbg !{{[0-9]+}}, !prof ![[FOO:[0-9]+]]
+
+then:
+  %a = add i32 %x, 1, !dbg !11
+  br label %exit, !dbg !11
+
+else:
+  %b = sub i32 %x, 1, !dbg !12
+  br label %exit, !dbg !12
+
+exit:
+  %r = phi i32 [ %a, %then ], [ %b, %else ]
+  ret i32 %r, !dbg !13
+}
+
+define i32 @main(i32 %n) !dbg !7 {
+entry:
+  %c = call i32 @_Z3fooi(i32 %n), !dbg !14
+  ret i32 %c, !dbg !15
+; CHECK-LABEL: define i32 @main(
+; CHECK-NOT: call i32 @_Z3fooi
+; CHECK: br i1 %cmp.i, label %then.i, label %else.i, !dbg !{{[0-9]+}}, !prof ![[MAIN:[0-9]+]]
+; COLD-LABEL: define i32 @main(
+; COLD: call i32 @_Z3fooi
+}
+
+; CHECK-DAG: ![[FOO]] = !{!"branch_weights", i32 50, i32 1}
+; CHECK-DAG: ![[MAIN]] = !{!"branch_weights", i32 1, i32 400}
+
+; When the context is not hot enough to be inlined, its samples are merged
+; into the profile of foo.
+; COLD: ![[FOO]] = !{!"branch_weights", i32 51, i32 401}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!8, !9}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus, producer: "clang", isOptimized: false, emissionKind: NoDebug, file: !1, enums: !2, retainedTypes: !2, globals: !2, imports: !2)
+!1 = !DIFile(filename: "context.cc", directory: ".")
+!2 = !{}
+!4 = distinct !DISubprogram(name: "foo", linkageName: "_Z3fooi", line: 1, isLocal: false, isDefinition: true, flags: DIFlagPrototyped, isOptimized: false, unit: !0, scopeLine: 1, file: !1, scope: !1, type: !6, variables: !2)
+!6 = !DISubroutineType(types: !2)
+!7 = distinct !DISubprogram(name: "main", line: 10, isLocal: false, isDefinition: true, flags: DIFlagPrototyped, isOptimized: false, unit: !0, scopeLine: 10, file: !1, scope: !1, type: !6, variables: !2)
+!8 = !{i32 2, !"Dwarf Version", i32 4}
+!9 = !{i32 1, !"Debug Info Version", i32 3}
+!10 = !DILocation(line: 2, scope: !4)
+!11 = !DILocation(line: 3, scope: !4)
+!12 = !DILocation(line: 4, scope: !4)
+!13 = !DILocation(line: 5, scope: !4)
+!14 = !DILocation(line: 12, scope: !7)
+!15 = !DILocation(line: 13, scope: !7)
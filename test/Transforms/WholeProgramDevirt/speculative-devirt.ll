@@ -0,0 +1,72 @@
+; RUN: opt -S -wholeprogramdevirt %s | FileCheck %s
+; RUN: opt -S -wholeprogramdevirt -wholeprogramdevirt-speculate-percent=100 %s | FileCheck %s --check-prefix=NOSPEC
+
+target datalayout = "e-p:64:64"
+target triple = "x86_64-unknown-linux-gnu"
+
+@vt1 = constant [1 x i8*] [i8* bitcast (i32 (i8*)* @vf1 to i8*)], !type !0
+@vt2 = constant [1 x i8*] [i8* bitcast (i32 (i8*)* @vf2 to i8*)], !type !0
+@vt3 = constant [1 x i8*] [i8* bitcast (i32 (i8*)* @vf2 to i8*)], !type !0
+
+define i32 @vf1(i8* %this) {
+  ret i32 1
+}
+
+define i32 @vf2(i8* %this) {
+  ret i32 2
+}
+
+; CHECK-LABEL: define i32 @call_hot(
+; CHECK: [[CMP2:%.*]] = icmp eq i8* [[VT:%.*]], bitcast ([1 x i8*]* @vt2 to i8*)
+; CHECK: [[CMP3:%.*]] = icmp eq i8* [[VT]], bitcast ([1 x i8*]* @vt3 to i8*)
+; CHECK: [[COND:%.*]] = or i1 [[CMP2]], [[CMP3]]
+; CHECK: br i1 [[COND]], label %[[THEN:.*]], label %[[ELSE:.*]], !prof [[WEIGHTS:![0-9]+]]
+; CHECK: [[THEN]]:
+; CHECK-NEXT: [[DIRECT:%.*]] = call i32 @vf2(i8* %obj){{$}}
+; CHECK: [[ELSE]]:
+; CHECK-NEXT: [[INDIRECT:%.*]] = call i32 %fptr_casted(i8* %obj), !prof [[VP:![0-9]+]]
+; CHECK: phi i32 [ [[DIRECT]], %[[THEN]] ], [ [[INDIRECT]], %[[ELSE]] ]
+
+; NOSPEC-LABEL: define i32 @call_hot(
+; NOSPEC-NOT: icmp
+; NOSPEC: call i32 %fptr_casted(i8* %obj), !prof
+define i32 @call_hot(i8* %obj) {
+  %vtableptr = bitcast i8* %obj to [1 x i8*]**
+  %vtable = load [1 x i8*]*, [1 x i8*]** %vtableptr
+  %vtablei8 = bitcast [1 x i8*]* %vtable to i8*
+  %p = call i1 @llvm.type.test(i8* %vtablei8, metadata !"typeid")
+  call void @llvm.assume(i1 %p)
+  %fptrptr = getelementptr [1 x i8*], [1 x i8*]* %vtable, i32 0, i32 0
+  %fptr = load i8*, i8** %fptrptr
+  %fptr_casted = bitcast i8* %fptr to i32 (i8*)*
+  %result = call i32 %fptr_casted(i8* %obj), !prof !1
+  ret i32 %result
+}
+
+; CHECK-LABEL: define i32 @call_cold(
+; CHECK-NOT: icmp
+; CHECK: call i32 %fptr_casted(i8* %obj), !prof
+define i32 @call_cold(i8* %obj) {
+  %vtableptr = bitcast i8* %obj to [1 x i8*]**
+  %vtable = load [1 x i8*]*, [1 x i8*]** %vtableptr
+  %vtablei8 = bitcast [1 x i8*]* %vtable to i8*
+  %p = call i1 @llvm.type.test(i8* %vtablei8, metadata !"typeid")
+  call void @llvm.assume(i1 %p)
+  %fptrptr = getelementptr [1 x i8*], [1 x i8*]* %vtable, i32 0, i32 0
+  %fptr = load i8*, i8** %fptrptr
+  %fptr_casted = bitcast i8* %fptr to i32 (i8*)*
+  %result = call i32 %fptr_casted(i8* %obj), !prof !2
+  ret i32 %result
+}
+
+declare i1 @llvm.type.test(i8*, metadata)
+declare void @llvm.assume(i1)
+
+; CHECK: [[WEIGHTS]] = !{!"branch_weights", i32 90, i32 10}
+; CHECK: [[VP]] = !{!"VP", i32 0, i64 10, i64 -3120275568908219477, i64 10}
+
+!0 = !{i32 0, !"typeid"}
+; 4022062696152231116 and -3120275568908219477 are the MD5 hashes of vf2 and
+; vf1.
+!1 = !{!"VP", i32 0, i64 100, i64 4022062696152231116, i64 90, i64 -3120275568908219477, i64 10}
+!2 = !{!"VP", i32 0, i64 100, i64 4022062696152231116, i64 25}
@@ -7,6 +7,14 @@
 // RUN: llvm-cov show -format text %S/Inputs/prevent_false_instantiations.covmapping -instr-profile %t.profdata -filename-equivalence %s | FileCheck %s -check-prefix=INSTANTIATION
 // RUN: llvm-cov report %S/Inputs/prevent_false_instantiations.covmapping -instr-profile %t.profdata | FileCheck %s -check-prefix=NAN
 
+// Files rendered in parallel are printed in the same order as with one thread.
+// RUN: llvm-cov show %S/Inputs/prevent_false_instantiations.covmapping -instr-profile %t.profdata -filename-equivalence %s %S/Inputs/prevent_false_instantiations.cpp -j 1 > %t.serial
+// RUN: llvm-cov show %S/Inputs/prevent_false_instantiations.covmapping -instr-profile %t.profdata -filename-equivalence %s %S/Inputs/prevent_false_instantiations.cpp -num-threads 2 > %t.parallel
+// RUN: diff %t.serial %t.parallel
+// RUN: FileCheck %s -check-prefix=PARALLEL -input-file %t.parallel
+// PARALLEL: {{^}}/tmp/false_instantiations/./prevent_false_instantiations.h:
+// PARALLEL: {{^}}/tmp/false_instantiations/prevent_false_instantiations.cpp:
+
 #define DO_SOMETHING() \
   do {                 \
   } while (0)
@@ -0,0 +1,47 @@
+// RUN: llvm-mc %s -filetype=obj -triple=x86_64-pc-linux -o %t.o
+// RUN: llvm-objdump -d -r -num-threads=1 %t.o > %t.serial
+// RUN: llvm-objdump -d -r -num-threads=4 -disassemble-chunk-size=1 %t.o \
+// RUN:   > %t.parallel
+// RUN: cmp %t.serial %t.parallel
+// RUN: FileCheck %s < %t.parallel
+
+// Each symbol is disassembled as its own chunk, and the relocations must
+// still be printed after the instructions they apply to.
+
+// CHECK:      Disassembly of section .text:
+// CHECK:      foo:
+// CHECK-NEXT:   0: e8 0a 00 00 00 callq 10 <baz>
+// CHECK-NEXT:   5: c3 retq
+// CHECK:      bar:
+// CHECK-NEXT:   6: 90 nop
+// CHECK-NEXT:   7: 48 8b 05 00 00 00 00 movq (%rip), %rax
+// CHECK-NEXT: R_X86_64_PC32 qux-4-P
+// CHECK-NEXT:   e: c3 retq
+// CHECK:      baz:
+// CHECK-NEXT:   f: eb f5 jmp -11 <bar>
+// CHECK:      Disassembly of section .text.other:
+// CHECK:      other:
+// CHECK-NEXT:   0: e8 00 00 00 00 callq 0 <other+0x5>
+// CHECK-NEXT: R_X86_64_PC32 foo-4-P
+// CHECK-NEXT:   5: c3 retq
+
+        .text
+        .globl foo
+foo:
+        callq baz
+        retq
+
+        .globl bar
+bar:
+        nop
+        movq qux(%rip), %rax
+        retq
+
+        .globl baz
+baz:
+        jmp bar
+
+        .section .text.other,"ax",@progbits
+other:
+        callq foo
+        retq
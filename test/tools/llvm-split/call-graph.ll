@@ -0,0 +1,52 @@
+; With -cluster-call-graph, mutually recursive functions stay in the same
+; partition and the other definitions are balanced by size.
+
+; RUN: llvm-split -j=2 -cluster-call-graph -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; CHECK0: define void @even
+; CHECK0: define void @odd
+; CHECK0: declare void @leaf1
+; CHECK0: declare void @leaf2
+
+; CHECK1: declare void @even
+; CHECK1: declare void @odd
+; CHECK1: define void @leaf1
+; CHECK1: define void @leaf2
+
+define void @even(i32 %n) {
+entry:
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %done, label %rec
+
+rec:
+  %m = sub i32 %n, 1
+  call void @odd(i32 %m)
+  br label %done
+
+done:
+  ret void
+}
+
+define void @odd(i32 %n) {
+entry:
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %done, label %rec
+
+rec:
+  %m = sub i32 %n, 1
+  call void @even(i32 %m)
+  br label %done
+
+done:
+  ret void
+}
+
+define void @leaf1() {
+  ret void
+}
+
+define void @leaf2() {
+  ret void
+}
@@ -10,11 +10,11 @@
 ; CHECK0: define internal i32 @funInternal2
 ; CHECK0: define i32 @funExternal2
 
-; CHECK1: @funInternalAlias = alias
-; CHECK1: define internal i32 @funInternal
+; CHECK1: @funExternalAlias = alias
+; CHECK1: define i32 @funExternal
 
-; CHECK2: @funExternalAlias = alias
-; CHECK2: define i32 @funExternal
+; CHECK2: @funInternalAlias = alias
+; CHECK2: define internal i32 @funInternal
 
 @funInternalAlias = alias i32 (), i32 ()* @funInternal
 @funExternalAlias = alias i32 (), i32 ()* @funExternal
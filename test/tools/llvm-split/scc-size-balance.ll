@@ -0,0 +1,55 @@
+; Clusters are assigned to partitions by their estimated code size rather
+; than by the number of globals they contain.
+
+; RUN: llvm-split -j=2 -preserve-locals -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; The largest cluster gets a partition of its own.
+; CHECK0: define internal i32 @local_big
+; CHECK0: define i32 @ext_big
+; CHECK0: declare i32 @small1
+; CHECK0: declare i32 @small2
+
+; The two smaller clusters are packed together.
+; CHECK1: @g1 = internal global i32 0
+; CHECK1: @g2 = internal global i32 0
+; CHECK1: @g3 = internal global i32 0
+; CHECK1: declare i32 @local_big
+; CHECK1: declare i32 @ext_big
+; CHECK1: define i32 @small1
+; CHECK1: define i32 @small2
+
+@g1 = internal global i32 0
+@g2 = internal global i32 0
+@g3 = internal global i32 0
+
+define internal i32 @local_big(i32 %x) {
+entry:
+  %a = add i32 %x, 1
+  %b = mul i32 %a, %x
+  %c = sub i32 %b, %a
+  %d = xor i32 %c, %b
+  %e = shl i32 %d, %c
+  ret i32 %e
+}
+
+define i32 @ext_big(i32 %x) {
+entry:
+  %r = call i32 @local_big(i32 %x)
+  ret i32 %r
+}
+
+define i32 @small1() {
+entry:
+  %a = load i32, i32* @g1
+  %b = load i32, i32* @g2
+  %c = add i32 %a, %b
+  ret i32 %c
+}
+
+define i32 @small2() {
+entry:
+  %a = load i32, i32* @g3
+  ret i32 %a
+}
@@ -15,10 +15,12 @@
 #ifndef LLVM_TOOLS_BUGPOINT_LISTREDUCER_H
 #define LLVM_TOOLS_BUGPOINT_LISTREDUCER_H
 
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdlib>
+#include <set>
 #include <vector>
 
 namespace llvm {
@@ -45,6 +47,33 @@ struct ListReducer {
                             std::vector<ElTy> &Kept,
                             std::string &Error) = 0;
 
+  // Hashes of the (Prefix, Kept) pairs which were tested without detecting a
+  // failure. Backjumping out of the trimming loop repeats the splits and trims
+  // of an unchanged list, and each of those tests runs a child process.
+  // Tests which reproduce the failure are never cached, since the list is
+  // always reduced after one, so the same pair cannot be tested again.
+  std::set<size_t> NoFailureCache;
+
+  static size_t hashTest(const std::vector<ElTy> &Prefix,
+                         const std::vector<ElTy> &Kept) {
+    return hash_combine(
+        Prefix.size(), hash_combine_range(Prefix.begin(), Prefix.end()),
+        Kept.size(), hash_combine_range(Kept.begin(), Kept.end()));
+  }
+
+  // doCachedTest - Like doTest, but the outcome is taken from the cache when
+  // the same test is known not to fail.
+  TestResult doCachedTest(std::vector<ElTy> &Prefix, std::vector<ElTy> &Kept,
+                          std::string &Error) {
+    size_t Hash = hashTest(Prefix, Kept);
+    if (NoFailureCache.count(Hash))
+      return NoFailure;
+    TestResult Result = doTest(Prefix, Kept, Error);
+    if (Result == NoFailure)
+      NoFailureCache.insert(Hash);
+    return Result;
+  }
+
   // reduceList - This function attempts to reduce the length of the specified
   // list while still maintaining the "test" property.  This is the core of the
   // "work" that bugpoint does.
@@ -121,7 +150,7 @@ Backjump:
       std::vector<ElTy> Prefix(TheList.begin(), TheList.begin()+Mid);
       std::vector<ElTy> Suffix(TheList.begin()+Mid, TheList.end());
 
-      switch (doTest(Prefix, Suffix, Error)) {
+      switch (doCachedTest(Prefix, Suffix, Error)) {
       case KeepSuffix:
         // The property still holds.  We can just drop the prefix elements, and
         // shorten the list to the "kept" elements.
@@ -183,7 +212,7 @@ Backjump:
           std::vector<ElTy> TestList(TheList);
           TestList.erase(TestList.begin()+i);
 
-          if (doTest(EmptyList, TestList, Error) == KeepSuffix) {
+          if (doCachedTest(EmptyList, TestList, Error) == KeepSuffix) {
             // We can trim down the list!
             TheList.swap(TestList);
             --i;  // Don't skip an element of the list
@@ -22,10 +22,14 @@
 #include "llvm/Support/Options.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetSelect.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <thread>
 
 using namespace llvm::dsymutil;
 
@@ -82,6 +86,15 @@ static opt<bool>
           desc("Do not use ODR (One Definition Rule) for type uniquing."),
           init(false), cat(DsymCategory));
 
+static opt<unsigned> NumThreads(
+    "num-threads",
+    desc("Specifies the maximum number (n) of simultaneous threads to use\n"
+         "when linking multiple architectures (0 = number of cores).\n"
+         "Verbose output forces a single thread."),
+    value_desc("n"), init(0), cat(DsymCategory));
+static alias NumThreadsA("j", desc("Alias for --num-threads"),
+                         aliasopt(NumThreads));
+
 static opt<bool> DumpDebugMap(
     "dump-debug-map",
     desc("Parse and dump the debug map to standard output. Not DWARF link "
@@ -314,6 +327,19 @@ int main(int argc, char **argv) {
     // temporary files.
     bool NeedsTempFiles = !DumpDebugMap && (*DebugMapPtrsOrErr).size() != 1;
     llvm::SmallVector<MachOUtils::ArchAndFilename, 4> TempFiles;
+
+    // The links of the different architectures are independent, so run them
+    // concurrently. The verbose log is only readable when produced in order.
+    unsigned Threads = NumThreads;
+    if (Threads == 0)
+      Threads = std::thread::hardware_concurrency();
+    if (DumpDebugMap || Verbose)
+      Threads = 1;
+    Threads = std::min<unsigned>(
+        std::max(Threads, 1U), (*DebugMapPtrsOrErr).size());
+
+    std::atomic_bool AllOK(true);
+    llvm::ThreadPool Pool(Threads);
     for (auto &Map : *DebugMapPtrsOrErr) {
       if (Verbose || DumpDebugMap)
         Map->print(llvm::outs());
@@ -327,13 +353,29 @@ int main(int argc, char **argv) {
                      << ")\n";
 
       std::string OutputFile = getOutputFileName(InputFile, NeedsTempFiles);
-      if (OutputFile.empty() || !linkDwarf(OutputFile, *Map, Options))
+      if (OutputFile.empty()) {
+        Pool.wait();
         exitDsymutil(1);
+      }
 
       if (NeedsTempFiles)
         TempFiles.emplace_back(Map->getTriple().getArchName().str(),
                                OutputFile);
+
+      const DebugMap &LinkMap = *Map;
+      auto LinkLambda = [&AllOK, &LinkMap, &Options, OutputFile]() {
+        if (!linkDwarf(OutputFile, LinkMap, Options))
+          AllOK = false;
+      };
+      if (Threads == 1)
+        LinkLambda();
+      else
+        Pool.async(LinkLambda);
     }
+    Pool.wait();
+
+    if (!AllOK)
+      exitDsymutil(1);
 
     if (NeedsTempFiles &&
         !MachOUtils::generateUniversalBinary(
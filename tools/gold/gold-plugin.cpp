@@ -1018,6 +1018,9 @@ void CodeGen::runLTOPasses() {
     // Perform function importing.
     FunctionImporter Importer(*CombinedIndex, Loader);
     Importer.importFunctions(*M, *ImportList);
+
+    // Apply the function attributes computed during the thin link.
+    thinLTOApplyFunctionAttrsModule(*M, *CombinedIndex);
   }
 
   legacy::PassManager passes;
@@ -1114,9 +1117,13 @@ void CodeGen::runSplitCodeGen(const SmallString<128> &BCFilename) {
       }
     }
 
-    // Run backend tasks.
+    // Run backend tasks. Keeping call graph SCCs together lets calls within
+    // them stay local to a partition, and balancing every definition by size
+    // keeps one backend thread from doing most of the work.
     splitCodeGen(std::move(M), OSPtrs, BCOSPtrs,
-                 [&]() { return createTargetMachine(); });
+                 [&]() { return createTargetMachine(); },
+                 TargetMachine::CGFT_ObjectFile, /*PreserveLocals=*/false,
+                 /*ClusterCallGraph=*/true);
   }
 
   for (auto &Filename : Filenames)
@@ -1369,6 +1376,9 @@ static ld_plugin_status thinLTOLink(raw_fd_ostream *ApiFile) {
   for (auto &S : CrossReferenced)
     Internalize.erase(S);
 
+  // Infer the function attributes across modules, applied by the backends.
+  thinLTOPropagateFunctionAttrsInIndex(CombinedIndex);
+
   // Collect for each module the list of function it defines (GUID ->
   // Summary).
   StringMap<std::map<GlobalValue::GUID, GlobalValueSummary *>>
@@ -15,12 +15,14 @@
 
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/CodeGen/LinkAllAsmWriterComponents.h"
 #include "llvm/CodeGen/LinkAllCodegenComponents.h"
 #include "llvm/CodeGen/MIRParser/MIRParser.h"
+#include "llvm/CodeGen/MIRParser/MachineFunctionCache.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
@@ -30,11 +32,13 @@
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/MemoryUsage.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
@@ -47,6 +51,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
@@ -113,6 +118,17 @@ static cl::opt<bool> DiscardValueNames(
     cl::desc("Discard names from Value (other than GlobalValue)."),
     cl::init(false), cl::Hidden);
 
+static cl::opt<bool> PrintMemoryStats(
+    "print-memory-stats",
+    cl::desc("Print the memory used by the IR, by kind of object, and by the "
+             "registered allocators once the passes have run"));
+
+static cl::opt<std::string> MachineFunctionCacheDir(
+    "machine-function-cache-dir",
+    cl::desc("Reuse the machine functions selected by earlier runs, and store "
+             "the new ones, in this directory"),
+    cl::value_desc("directory"));
+
 namespace {
 static ManagedStatic<std::vector<std::string>> RunPassNames;
 
@@ -135,6 +151,21 @@ static cl::opt<RunPassOption, true, cl::parser<std::string>> RunPass(
     cl::desc("Run compiler only for specified passes (comma separated list)"),
     cl::value_desc("pass-name"), cl::ZeroOrMore, cl::location(RunPassOpt));
 
+static cl::opt<bool> TimeTrace("time-trace",
+                               cl::desc("Record a Chrome trace of the time "
+                                        "spent in each pass"));
+
+static cl::opt<unsigned> TimeTraceGranularity(
+    "time-trace-granularity",
+    cl::desc("Minimum duration (in microseconds) of the events recorded by "
+             "-time-trace"),
+    cl::init(500), cl::Hidden);
+
+static cl::opt<std::string>
+    TimeTraceFile("time-trace-file",
+                  cl::desc("File to write the -time-trace output to"),
+                  cl::value_desc("filename"));
+
 static int compileModule(char **, LLVMContext &);
 
 static std::unique_ptr<tool_output_file>
@@ -254,14 +285,34 @@ int main(int argc, char **argv) {
   bool HasError = false;
   Context.setDiagnosticHandler(DiagnosticHandler, &HasError);
 
+  if (TimeTrace)
+    timeTraceProfilerInitialize(TimeTraceGranularity);
+
   // Compile the module TimeCompilations times to give better compile time
   // metrics.
   for (unsigned I = TimeCompilations; I; --I)
     if (int RetVal = compileModule(argv, Context))
       return RetVal;
+
+  if (TimeTrace) {
+    if (std::error_code EC =
+            timeTraceProfilerWrite(TimeTraceFile, OutputFilename)) {
+      errs() << argv[0] << ": " << EC.message() << '\n';
+      return 1;
+    }
+    timeTraceProfilerCleanup();
+  }
   return 0;
 }
 
+/// Print the memory used by \p M and its context, followed by the allocator
+/// report, to the -info-output-file.
+static void printMemoryStats(const Module &M) {
+  std::unique_ptr<raw_ostream> OS = CreateInfoOutputFile();
+  IRMemoryUsage(M).print(*OS);
+  PrintMemoryUsage(*OS);
+}
+
 static int compileModule(char **argv, LLVMContext &Context) {
   // Load the module to be compiled...
   SMDiagnostic Err;
@@ -346,6 +397,15 @@ static int compileModule(char **argv, LLVMContext &Context) {
     return 0;
 
   assert(M && "Should have exited if we didn't have a module!");
+
+  // Machine functions parsed from a MIR file are never selected.
+  std::unique_ptr<MachineFunctionCache> MFCache;
+  if (!MachineFunctionCacheDir.empty() && !MIR)
+    MFCache = llvm::make_unique<MachineFunctionCache>(MachineFunctionCacheDir,
+                                                      *Target);
+  MachineFunctionInitializer *MFInitializer = MIR.get();
+  if (MFCache)
+    MFInitializer = MFCache.get();
   if (FloatABIForCalls != FloatABI::Default)
     Options.FloatABIType = FloatABIForCalls;
 
@@ -456,7 +516,7 @@ static int compileModule(char **argv, LLVMContext &Context) {
       // Ask the target to add backend passes as necessary.
       if (Target->addPassesToEmitFile(PM, *OS, FileType, NoVerify,
                                       StartBeforeID, StartAfterID, StopAfterID,
-                                      MIR.get())) {
+                                      MFInitializer)) {
         errs() << argv[0] << ": target does not support generation of this"
                << " file type!\n";
         return 1;
@@ -480,6 +540,11 @@ static int compileModule(char **argv, LLVMContext &Context) {
 
     PM.run(*M);
 
+    // The MachineFunctions are gone by now, but the allocator report shows
+    // the largest one.
+    if (PrintMemoryStats)
+      printMemoryStats(*M);
+
     auto HasError = *static_cast<bool *>(Context.getDiagnosticContext());
     if (HasError)
       return 1;
@@ -1,5 +1,6 @@
 #include "llvm/ExecutionEngine/Orc/OrcABISupport.h"
 #include "llvm/ExecutionEngine/Orc/OrcRemoteTargetServer.h"
+#include "llvm/ExecutionEngine/Orc/SharedMemoryRPCChannel.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/Process.h"
@@ -19,28 +20,7 @@ typedef OrcGenericABI HostOrcArch;
 
 ExitOnError ExitOnErr;
 
-int main(int argc, char *argv[]) {
-
-  if (argc != 3) {
-    errs() << "Usage: " << argv[0] << " <input fd> <output fd>\n";
-    return 1;
-  }
-
-  ExitOnErr.setBanner(std::string(argv[0]) + ":");
-
-  int InFD;
-  int OutFD;
-  {
-    std::istringstream InFDStream(argv[1]), OutFDStream(argv[2]);
-    InFDStream >> InFD;
-    OutFDStream >> OutFD;
-  }
-
-  if (sys::DynamicLibrary::LoadLibraryPermanently(nullptr)) {
-    errs() << "Error loading program symbols.\n";
-    return 1;
-  }
-
+template <typename ChannelT> static int runServer(ChannelT &Channel) {
   auto SymbolLookup = [](const std::string &Name) {
     return RTDyldMemoryManager::getSymbolAddressInProcess(Name);
   };
@@ -53,14 +33,13 @@ int main(int argc, char *argv[]) {
     RTDyldMemoryManager::deregisterEHFramesInProcess(Addr, Size);
   };
 
-  FDRPCChannel Channel(InFD, OutFD);
-  typedef remote::OrcRemoteTargetServer<FDRPCChannel, HostOrcArch> JITServer;
+  typedef remote::OrcRemoteTargetServer<ChannelT, HostOrcArch> JITServer;
   JITServer Server(Channel, SymbolLookup, RegisterEHFrames, DeregisterEHFrames);
 
   while (1) {
     uint32_t RawId;
     ExitOnErr(Server.startReceivingFunction(Channel, RawId));
-    auto Id = static_cast<JITServer::JITFuncId>(RawId);
+    auto Id = static_cast<typename JITServer::JITFuncId>(RawId);
     switch (Id) {
     case JITServer::TerminateSessionId:
       ExitOnErr(Server.handleTerminateSession());
@@ -70,9 +49,41 @@ int main(int argc, char *argv[]) {
       break;
     }
   }
+}
+
+int main(int argc, char *argv[]) {
+
+  if (argc != 2 && argc != 3) {
+    errs() << "Usage: " << argv[0] << " <input fd> <output fd>\n"
+           << "       " << argv[0] << " <shared memory channel file>\n";
+    return 1;
+  }
+
+  ExitOnErr.setBanner(std::string(argv[0]) + ":");
+
+  if (sys::DynamicLibrary::LoadLibraryPermanently(nullptr)) {
+    errs() << "Error loading program symbols.\n";
+    return 1;
+  }
+
+  if (argc == 2) {
+    auto Channel = ExitOnErr(remote::SharedMemoryRPCChannel::open(argv[1]));
+    return runServer(*Channel);
+  }
+
+  int InFD;
+  int OutFD;
+  {
+    std::istringstream InFDStream(argv[1]), OutFDStream(argv[2]);
+    InFDStream >> InFD;
+    OutFDStream >> OutFD;
+  }
+
+  FDRPCChannel Channel(InFD, OutFD);
+  int Result = runServer(Channel);
 
   close(InFD);
   close(OutFD);
 
-  return 0;
+  return Result;
 }
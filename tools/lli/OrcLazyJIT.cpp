@@ -44,6 +44,13 @@ namespace {
   cl::opt<bool> OrcInlineStubs("orc-lazy-inline-stubs",
                                cl::desc("Try to inline stubs"),
                                cl::init(true), cl::Hidden);
+
+  cl::opt<unsigned> OrcSpeculationDepth(
+      "orc-lazy-speculation-depth",
+      cl::desc("Compile direct callees up to this call depth together with "
+               "each lazily compiled function (0 = compile only the called "
+               "function)"),
+      cl::init(0), cl::Hidden);
 }
 
 OrcLazyJIT::TransformFtor OrcLazyJIT::createDebugDumper() {
@@ -140,7 +147,7 @@ int llvm::runOrcLazyJIT(std::unique_ptr<Module> M, int ArgC, char* ArgV[]) {
   // Everything looks good. Build the JIT.
   OrcLazyJIT J(std::move(TM), std::move(CompileCallbackMgr),
                std::move(IndirectStubsMgrBuilder),
-               OrcInlineStubs);
+               OrcInlineStubs, OrcSpeculationDepth);
 
   // Add the module, look up main and run it.
   auto MainHandle = J.addModule(std::move(M));
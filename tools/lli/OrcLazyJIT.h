@@ -43,13 +43,13 @@ public:
   OrcLazyJIT(std::unique_ptr<TargetMachine> TM,
              std::unique_ptr<CompileCallbackMgr> CCMgr,
              IndirectStubsManagerBuilder IndirectStubsMgrBuilder,
-             bool InlineStubs)
+             bool InlineStubs, unsigned SpeculationDepth = 0)
       : TM(std::move(TM)), DL(this->TM->createDataLayout()),
 	CCMgr(std::move(CCMgr)),
 	ObjectLayer(),
-        CompileLayer(ObjectLayer, orc::SimpleCompiler(*this->TM)),
+        CompileLayer(ObjectLayer, orc::ReusableCompiler(*this->TM)),
         IRDumpLayer(CompileLayer, createDebugDumper()),
-        CODLayer(IRDumpLayer, extractSingleFunction, *this->CCMgr,
+        CODLayer(IRDumpLayer, createPartitioner(SpeculationDepth), *this->CCMgr,
                  std::move(IndirectStubsMgrBuilder), InlineStubs),
         CXXRuntimeOverrides(
             [this](const std::string &S) { return mangle(S); }) {}
@@ -140,6 +140,14 @@ private:
     return Partition;
   }
 
+  static CODLayerT::PartitioningFtor createPartitioner(unsigned Depth) {
+    if (Depth == 0)
+      return extractSingleFunction;
+    return [Depth](Function &F) {
+      return orc::partitionWithDirectCallees(F, Depth);
+    };
+  }
+
   static TransformFtor createDebugDumper();
 
   std::unique_ptr<TargetMachine> TM;
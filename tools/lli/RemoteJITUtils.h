@@ -17,6 +17,7 @@
 #include "llvm/ExecutionEngine/Orc/RPCChannel.h"
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include <mutex>
+#include <vector>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
@@ -49,9 +50,18 @@ public:
 
   llvm::Error appendBytes(const char *Src, unsigned Size) override {
     assert(Src && "Attempt to append from null.");
+    OutBuffer.insert(OutBuffer.end(), Src, Src + Size);
+    return llvm::Error::success();
+  }
+
+  /// Write out everything appended since the last send, so that a message
+  /// costs one system call rather than one per field.
+  llvm::Error send() override {
+    std::lock_guard<std::mutex> Lock(getWriteLock());
     ssize_t Completed = 0;
-    while (Completed < static_cast<ssize_t>(Size)) {
-      ssize_t Written = ::write(OutFD, Src + Completed, Size - Completed);
+    while (Completed < static_cast<ssize_t>(OutBuffer.size())) {
+      ssize_t Written = ::write(OutFD, OutBuffer.data() + Completed,
+                                OutBuffer.size() - Completed);
       if (Written < 0) {
         auto ErrNo = errno;
         if (ErrNo == EAGAIN || ErrNo == EINTR)
@@ -62,17 +72,17 @@ public:
       }
       Completed += Written;
     }
+    OutBuffer.clear();
     return llvm::Error::success();
   }
 
-  llvm::Error send() override { return llvm::Error::success(); }
-
 private:
   int InFD, OutFD;
+  std::vector<char> OutBuffer;
 };
 
 // launch the remote process (see lli.cpp) and return a channel to it.
-std::unique_ptr<FDRPCChannel> launchRemote();
+std::unique_ptr<llvm::orc::remote::RPCChannel> launchRemote();
 
 namespace llvm {
 
@@ -28,6 +28,7 @@
 #include "llvm/ExecutionEngine/OrcMCJITReplacement.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/ExecutionEngine/Orc/OrcRemoteTargetClient.h"
+#include "llvm/ExecutionEngine/Orc/SharedMemoryRPCChannel.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
@@ -112,6 +113,14 @@ namespace {
                          "\n\tremote execution will be simulated in-process."),
                 cl::value_desc("filename"), cl::init(""));
 
+  // Talk to the child process through a shared file mapping instead of
+  // pipes. This only works for a child on the same host.
+  cl::opt<bool>
+  RemoteSharedMemory("remote-shared-memory",
+                     cl::desc("Communicate with the remote process through "
+                              "shared memory rather than pipes."),
+                     cl::init(false));
+
   // Determine optimization level.
   cl::opt<char>
   OptLevel("O",
@@ -540,6 +549,8 @@ int main(int argc, char **argv, char * const *envp) {
                 JITEventListener::createOProfileJITEventListener());
   EE->RegisterJITEventListener(
                 JITEventListener::createIntelJITEventListener());
+  EE->RegisterJITEventListener(
+                JITEventListener::createPerfJITEventListener());
 
   if (!NoLazyCompilation && RemoteMCJIT) {
     errs() << "warning: remote mcjit does not support lazy compilation\n";
@@ -645,7 +656,7 @@ int main(int argc, char **argv, char * const *envp) {
     // MCJIT itself. FIXME.
 
     // Lanch the remote process and get a channel to it.
-    std::unique_ptr<FDRPCChannel> C = launchRemote();
+    std::unique_ptr<orc::remote::RPCChannel> C = launchRemote();
     if (!C) {
       errs() << "Failed to launch remote JIT.\n";
       exit(1);
@@ -698,15 +709,24 @@ int main(int argc, char **argv, char * const *envp) {
   return Result;
 }
 
-std::unique_ptr<FDRPCChannel> launchRemote() {
+std::unique_ptr<orc::remote::RPCChannel> launchRemote() {
 #ifndef LLVM_ON_UNIX
   llvm_unreachable("launchRemote not supported on non-Unix platforms");
 #else
   int PipeFD[2][2];
   pid_t ChildPID;
 
-  // Create two pipes.
-  if (pipe(PipeFD[0]) != 0 || pipe(PipeFD[1]) != 0)
+  // Create the shared memory channel, or two pipes.
+  std::unique_ptr<orc::remote::SharedMemoryRPCChannel> SharedMemChannel;
+  SmallString<128> ChannelPath;
+  if (RemoteSharedMemory) {
+    if (auto EC = sys::fs::createTemporaryFile("lli-rpc", "shm", ChannelPath)) {
+      errs() << "Error creating channel file: " << EC.message() << "\n";
+      return nullptr;
+    }
+    SharedMemChannel = ExitOnErr(
+        orc::remote::SharedMemoryRPCChannel::create(ChannelPath));
+  } else if (pipe(PipeFD[0]) != 0 || pipe(PipeFD[1]) != 0)
     perror("Error creating pipe: ");
 
   ChildPID = fork();
@@ -714,28 +734,28 @@ std::unique_ptr<FDRPCChannel> launchRemote() {
   if (ChildPID == 0) {
     // In the child...
 
-    // Close the parent ends of the pipes
-    close(PipeFD[0][1]);
-    close(PipeFD[1][0]);
-
-
     // Execute the child process.
     std::unique_ptr<char[]> ChildPath, ChildIn, ChildOut;
-    {
-      ChildPath.reset(new char[ChildExecPath.size() + 1]);
-      std::copy(ChildExecPath.begin(), ChildExecPath.end(), &ChildPath[0]);
-      ChildPath[ChildExecPath.size()] = '\0';
-      std::string ChildInStr = utostr(PipeFD[0][0]);
-      ChildIn.reset(new char[ChildInStr.size() + 1]);
-      std::copy(ChildInStr.begin(), ChildInStr.end(), &ChildIn[0]);
-      ChildIn[ChildInStr.size()] = '\0';
-      std::string ChildOutStr = utostr(PipeFD[1][1]);
-      ChildOut.reset(new char[ChildOutStr.size() + 1]);
-      std::copy(ChildOutStr.begin(), ChildOutStr.end(), &ChildOut[0]);
-      ChildOut[ChildOutStr.size()] = '\0';
+    auto CopyArg = [](std::unique_ptr<char[]> &Arg, StringRef Str) {
+      Arg.reset(new char[Str.size() + 1]);
+      std::copy(Str.begin(), Str.end(), &Arg[0]);
+      Arg[Str.size()] = '\0';
+    };
+    CopyArg(ChildPath, ChildExecPath);
+
+    if (RemoteSharedMemory) {
+      CopyArg(ChildIn, ChannelPath);
+    } else {
+      // Close the parent ends of the pipes
+      close(PipeFD[0][1]);
+      close(PipeFD[1][0]);
+
+      CopyArg(ChildIn, utostr(PipeFD[0][0]));
+      CopyArg(ChildOut, utostr(PipeFD[1][1]));
     }
 
-    char * const args[] = { &ChildPath[0], &ChildIn[0], &ChildOut[0], nullptr };
+    char * const args[] = { &ChildPath[0], &ChildIn[0], ChildOut.get(),
+                            nullptr };
     int rc = execv(ChildExecPath.c_str(), args);
     if (rc != 0)
       perror("Error executing child process: ");
@@ -743,6 +763,9 @@ std::unique_ptr<FDRPCChannel> launchRemote() {
   }
   // else we're the parent...
 
+  if (RemoteSharedMemory)
+    return std::move(SharedMemChannel);
+
   // Close the child ends of the pipes
   close(PipeFD[0][0]);
   close(PipeFD[1][1]);
@@ -13,6 +13,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "CoverageExporterJson.h"
 #include "CoverageFilters.h"
 #include "CoverageReport.h"
 #include "CoverageViewOptions.h"
@@ -28,7 +29,9 @@
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
 #include <functional>
+#include <mutex>
 #include <system_error>
 
 using namespace llvm;
@@ -42,7 +45,10 @@ public:
     /// \brief The show command.
     Show,
     /// \brief The report command.
-    Report
+    Report,
+
+    /// \brief The export command.
+    Export
   };
 
   /// \brief Print the error message to the error output stream.
@@ -51,7 +57,8 @@ public:
   /// \brief Append a reference to a private copy of \p Path into SourceFiles.
   void addCollectedPath(const std::string &Path);
 
-  /// \brief Return a memory buffer for the given source file.
+  /// \brief Return a memory buffer for the given source file. This is safe to
+  /// call from several threads.
   ErrorOr<const MemoryBuffer &> getSourceFile(StringRef SourceFile);
 
   /// \brief Create source views for the expansions of the view.
@@ -80,6 +87,9 @@ public:
   int report(int argc, const char **argv,
              CommandLineParserType commandLineParser);
 
+  int export_(int argc, const char **argv,
+              CommandLineParserType commandLineParser);
+
   std::string ObjectFilename;
   CoverageViewOptions ViewOpts;
   std::string PGOFilename;
@@ -87,6 +97,8 @@ public:
   std::vector<StringRef> SourceFiles;
   std::vector<std::pair<std::string, std::unique_ptr<MemoryBuffer>>>
       LoadedSourceFiles;
+  /// Guards LoadedSourceFiles while the file views are built in parallel.
+  std::mutex LoadedSourceFilesLock;
   bool CompareFilenamesOnly;
   StringMap<std::string> RemappedFilenames;
   std::string CoverageArch;
@@ -96,11 +108,16 @@ private:
 };
 }
 
+/// While a source file is rendered in parallel, the errors are collected into
+/// this stream, to be printed in order with the rendered files.
+static LLVM_THREAD_LOCAL raw_ostream *ErrorStream = nullptr;
+
 void CodeCoverageTool::error(const Twine &Message, StringRef Whence) {
-  errs() << "error: ";
+  raw_ostream &OS = ErrorStream ? *ErrorStream : errs();
+  OS << "error: ";
   if (!Whence.empty())
-    errs() << Whence << ": ";
-  errs() << Message << "\n";
+    OS << Whence << ": ";
+  OS << Message << "\n";
 }
 
 void CodeCoverageTool::addCollectedPath(const std::string &Path) {
@@ -116,6 +133,7 @@ CodeCoverageTool::getSourceFile(StringRef SourceFile) {
     if (Loc != RemappedFilenames.end())
       SourceFile = Loc->second;
   }
+  std::lock_guard<std::mutex> Lock(LoadedSourceFilesLock);
   for (const auto &Files : LoadedSourceFiles)
     if (sys::fs::equivalent(SourceFile, Files.first))
       return *Files.second;
@@ -389,6 +407,8 @@ int CodeCoverageTool::run(Command Cmd, int argc, const char **argv) {
     return show(argc, argv, commandLineParser);
   case Report:
     return report(argc, argv, commandLineParser);
+  case Export:
+    return export_(argc, argv, commandLineParser);
   }
   return 0;
 }
@@ -428,6 +448,13 @@ int CodeCoverageTool::show(int argc, const char **argv,
   cl::alias ShowOutputDirectoryA("o", cl::desc("Alias for --output-dir"),
                                  cl::aliasopt(ShowOutputDirectory));
 
+  cl::opt<unsigned> NumThreads(
+      "num-threads", cl::init(0),
+      cl::desc("Number of threads used to render the source files "
+               "(0 = one per hardware thread)"));
+  cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
+                        cl::aliasopt(NumThreads));
+
   auto Err = commandLineParser(argc, argv);
   if (Err)
     return Err;
@@ -498,23 +525,78 @@ int CodeCoverageTool::show(int argc, const char **argv,
     }
   }
 
-  for (const auto &SourceFile : SourceFiles) {
-    auto mainView = createSourceFileView(SourceFile, *Coverage);
-    if (!mainView) {
+  // Colors are lost when rendering into a buffer, so print the views directly
+  // when they are used.
+  if (NumThreads == 1 || ViewOpts.Colors || SourceFiles.size() < 2) {
+    for (const auto &SourceFile : SourceFiles) {
+      auto mainView = createSourceFileView(SourceFile, *Coverage);
+      if (!mainView) {
+        ViewOpts.colored_ostream(errs(), raw_ostream::RED)
+            << "warning: The file '" << SourceFile << "' isn't covered.";
+        errs() << "\n";
+        continue;
+      }
+
+      auto OSOrErr = Printer->createViewFile(SourceFile, /*InToplevel=*/false);
+      if (Error E = OSOrErr.takeError()) {
+        error(toString(std::move(E)));
+        return 1;
+      }
+      auto OS = std::move(OSOrErr.get());
+      mainView->print(*OS.get(), /*Wholefile=*/true,
+                      /*ShowSourceName=*/ShowFilenames);
+      Printer->closeViewFile(std::move(OS));
+    }
+    return 0;
+  }
+
+  // Otherwise render the files in parallel into buffers, and write them out
+  // in order as they become ready.
+  struct RenderedFile {
+    std::string Output;
+    std::string Errors;
+    bool Covered = false;
+  };
+  std::vector<RenderedFile> Rendered(SourceFiles.size());
+  std::vector<std::shared_future<ThreadPool::VoidTy>> Futures;
+  Futures.reserve(SourceFiles.size());
+  ThreadPool Pool(NumThreads ? NumThreads
+                             : std::max(1U, std::thread::hardware_concurrency()));
+  for (size_t I = 0, E = SourceFiles.size(); I != E; ++I)
+    Futures.push_back(Pool.async([&, I] {
+      raw_string_ostream Errors(Rendered[I].Errors);
+      ErrorStream = &Errors;
+      auto mainView = createSourceFileView(SourceFiles[I], *Coverage);
+      ErrorStream = nullptr;
+      Errors.flush();
+      if (!mainView)
+        return;
+      raw_string_ostream OS(Rendered[I].Output);
+      mainView->print(OS, /*Wholefile=*/true,
+                      /*ShowSourceName=*/ShowFilenames);
+      OS.flush();
+      Rendered[I].Covered = true;
+    }));
+
+  for (size_t I = 0, E = SourceFiles.size(); I != E; ++I) {
+    Futures[I].wait();
+    errs() << Rendered[I].Errors;
+    if (!Rendered[I].Covered) {
       ViewOpts.colored_ostream(errs(), raw_ostream::RED)
-          << "warning: The file '" << SourceFile << "' isn't covered.";
+          << "warning: The file '" << SourceFiles[I] << "' isn't covered.";
       errs() << "\n";
       continue;
     }
 
-    auto OSOrErr = Printer->createViewFile(SourceFile, /*InToplevel=*/false);
+    auto OSOrErr = Printer->createViewFile(SourceFiles[I], /*InToplevel=*/false);
     if (Error E = OSOrErr.takeError()) {
       error(toString(std::move(E)));
+      Pool.wait();
       return 1;
     }
     auto OS = std::move(OSOrErr.get());
-    mainView->print(*OS.get(), /*Wholefile=*/true,
-                    /*ShowSourceName=*/ShowFilenames);
+    *OS << Rendered[I].Output;
+    Rendered[I].Output.clear();
     Printer->closeViewFile(std::move(OS));
   }
 
@@ -539,6 +621,21 @@ int CodeCoverageTool::report(int argc, const char **argv,
   return 0;
 }
 
+int CodeCoverageTool::export_(int argc, const char **argv,
+                              CommandLineParserType commandLineParser) {
+  auto Err = commandLineParser(argc, argv);
+  if (Err)
+    return Err;
+
+  auto Coverage = load();
+  if (!Coverage)
+    return 1;
+
+  CoverageExporterJson Exporter(*Coverage, Filters, SourceFiles, outs());
+  Exporter.print();
+  return 0;
+}
+
 int showMain(int argc, const char *argv[]) {
   CodeCoverageTool Tool;
   return Tool.run(CodeCoverageTool::Show, argc, argv);
@@ -548,3 +645,8 @@ int reportMain(int argc, const char *argv[]) {
   CodeCoverageTool Tool;
   return Tool.run(CodeCoverageTool::Report, argc, argv);
 }
+
+int exportMain(int argc, const char *argv[]) {
+  CodeCoverageTool Tool;
+  return Tool.run(CodeCoverageTool::Export, argc, argv);
+}
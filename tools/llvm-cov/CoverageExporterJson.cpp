@@ -0,0 +1,118 @@
+//===- CoverageExporterJson.cpp - Code coverage JSON exporter -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class implements the export of code coverage data as JSON.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CoverageExporterJson.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Format.h"
+
+using namespace llvm;
+using namespace coverage;
+
+void CoverageExporterJson::emitString(StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    switch (C) {
+    case '"':
+      OS << "\\\"";
+      break;
+    case '\\':
+      OS << "\\\\";
+      break;
+    case '\n':
+      OS << "\\n";
+      break;
+    case '\t':
+      OS << "\\t";
+      break;
+    default:
+      if (C < 0x20)
+        OS << "\\u" << format("%04x", C);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+void CoverageExporterJson::emitFile(CoverageData &&File) {
+  OS << "{\"filename\":";
+  emitString(File.getFilename());
+  OS << ",\"segments\":[";
+  bool First = true;
+  for (const auto &Segment : File) {
+    if (!First)
+      OS << ',';
+    First = false;
+    OS << '[' << Segment.Line << ',' << Segment.Col << ',' << Segment.Count
+       << ',' << Segment.HasCount << ',' << Segment.IsRegionEntry << ']';
+  }
+  OS << "]}";
+}
+
+void CoverageExporterJson::emitFunction(const FunctionRecord &Function) {
+  OS << "{\"name\":";
+  emitString(Function.Name);
+  OS << ",\"count\":" << Function.ExecutionCount << ",\"filenames\":[";
+  for (unsigned I = 0, E = Function.Filenames.size(); I != E; ++I) {
+    if (I)
+      OS << ',';
+    emitString(Function.Filenames[I]);
+  }
+  OS << "],\"regions\":[";
+  for (unsigned I = 0, E = Function.CountedRegions.size(); I != E; ++I) {
+    const CountedRegion &R = Function.CountedRegions[I];
+    if (I)
+      OS << ',';
+    OS << '[' << R.LineStart << ',' << R.ColumnStart << ',' << R.LineEnd << ','
+       << R.ColumnEnd << ',' << R.ExecutionCount << ',' << R.FileID << ','
+       << R.ExpandedFileID << ',' << R.Kind << ']';
+  }
+  OS << "]}";
+}
+
+bool CoverageExporterJson::isExportedFile(StringRef Filename) const {
+  return SourceFiles.empty() ||
+         std::find(SourceFiles.begin(), SourceFiles.end(), Filename) !=
+             SourceFiles.end();
+}
+
+void CoverageExporterJson::print() {
+  OS << "{\"version\":\"1.0.0\",\"type\":\"llvm.coverage.json.export\","
+        "\"data\":[{\"files\":[";
+
+  // The segments of a single file are computed, written and then dropped
+  // before moving on to the next one.
+  bool First = true;
+  for (StringRef Filename : Coverage.getUniqueSourceFiles()) {
+    if (!isExportedFile(Filename))
+      continue;
+    if (!First)
+      OS << ',';
+    First = false;
+    emitFile(Coverage.getCoverageForFile(Filename));
+    OS << '\n';
+  }
+
+  OS << "],\"functions\":[";
+  First = true;
+  for (const auto &Function : Coverage.getCoveredFunctions()) {
+    if (!isExportedFile(Function.Filenames[0]) || !Filters.matches(Function))
+      continue;
+    if (!First)
+      OS << ',';
+    First = false;
+    emitFunction(Function);
+    OS << '\n';
+  }
+  OS << "]}]}\n";
+}
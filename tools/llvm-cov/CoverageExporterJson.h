@@ -0,0 +1,62 @@
+//===- CoverageExporterJson.h - Code coverage JSON exporter ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class implements the export of code coverage data as JSON.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_COV_COVERAGEEXPORTERJSON_H
+#define LLVM_COV_COVERAGEEXPORTERJSON_H
+
+#include "CoverageFilters.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ProfileData/Coverage/CoverageMapping.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+
+/// \brief Streams the coverage data of a file or a function at a time, so
+/// that no more than one file's segments are held in memory at once.
+///
+/// The output has the form:
+///
+///   {"version":"1.0.0","type":"llvm.coverage.json.export","data":[{
+///     "files":[{"filename":F,"segments":[[Line,Col,Count,HasCount,
+///                                          IsRegionEntry],...]},...],
+///     "functions":[{"name":N,"count":C,"filenames":[F,...],
+///                   "regions":[[LineStart,ColumnStart,LineEnd,ColumnEnd,
+///                               ExecutionCount,FileID,ExpandedFileID,
+///                               Kind],...]},...]}]}
+class CoverageExporterJson {
+  const coverage::CoverageMapping &Coverage;
+  CoverageFilter &Filters;
+  ArrayRef<StringRef> SourceFiles;
+  raw_ostream &OS;
+
+  void emitString(StringRef Str);
+  void emitFile(coverage::CoverageData &&File);
+  void emitFunction(const coverage::FunctionRecord &Function);
+  bool isExportedFile(StringRef Filename) const;
+
+public:
+  /// \p SourceFiles restricts the export to the given files, unless it is
+  /// empty. Functions are exported if they pass \p Filters and are defined in
+  /// one of the exported files.
+  CoverageExporterJson(const coverage::CoverageMapping &Coverage,
+                       CoverageFilter &Filters,
+                       ArrayRef<StringRef> SourceFiles, raw_ostream &OS)
+      : Coverage(Coverage), Filters(Filters), SourceFiles(SourceFiles),
+        OS(OS) {}
+
+  void print();
+};
+
+} // end namespace llvm
+
+#endif // LLVM_COV_COVERAGEEXPORTERJSON_H
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/DebugInfo/DIContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
@@ -73,6 +74,23 @@ static cl::opt<DIDumpType> DumpType(
         clEnumValN(DIDT_CUIndex, "cu_index", ".debug_cu_index"),
         clEnumValN(DIDT_TUIndex, "tu_index", ".debug_tu_index"), clEnumValEnd));
 
+static cl::list<std::string>
+    FindNames("find", cl::desc("Print only the DIEs named <name>, found through "
+                               "the Apple accelerator tables"),
+              cl::value_desc("name"));
+
+static cl::list<unsigned long long>
+    LookupAddresses("lookup",
+                    cl::desc("Print only the compile unit and the innermost "
+                             "scope containing <address>"),
+                    cl::value_desc("address"));
+
+static cl::list<unsigned long long>
+    DIEOffsets("die-offset",
+               cl::desc("Print only the DIE at <offset> in .debug_info and "
+                        "its children"),
+               cl::value_desc("offset"));
+
 static void error(StringRef Filename, std::error_code EC) {
   if (!EC)
     return;
@@ -80,13 +98,59 @@ static void error(StringRef Filename, std::error_code EC) {
   exit(1);
 }
 
+/// Print the DIE at \p Offset, and everything below it, if it starts a DIE.
+/// Only the compile unit containing \p Offset is parsed.
+static void DumpDIEAtOffset(DWARFContext &DICtx, uint32_t Offset,
+                            raw_ostream &OS) {
+  DWARFCompileUnit *CU = DICtx.getCompileUnitForOffset(Offset);
+  if (!CU || !CU->getUnitDIE(false))
+    return;
+  const DWARFDebugInfoEntryMinimal *Die = CU->getDIEForOffset(Offset);
+  if (Die && Die->getOffset() == Offset)
+    Die->dump(OS, CU, -1U);
+}
+
+static void DumpAddress(DWARFContext &DICtx, uint64_t Address,
+                        raw_ostream &OS) {
+  DWARFCompileUnit *CU = DICtx.getCompileUnitForAddress(Address);
+  if (!CU)
+    return;
+  OS << format("\nAddress 0x%" PRIx64 ":", Address);
+  CU->getUnitDIE(false)->dump(OS, CU, 0);
+  // The first entry of the chain is the innermost scope. The chain holds
+  // copies of the DIEs, so find the original to be able to walk its children.
+  DWARFDebugInfoEntryInlinedChain Chain =
+      CU->getInlinedChainForAddress(Address);
+  if (!Chain.DIEs.empty() && Chain.U == CU)
+    DumpDIEAtOffset(DICtx, Chain.DIEs.front().getOffset(), OS);
+}
+
 static void DumpObjectFile(ObjectFile &Obj, Twine Filename) {
-  std::unique_ptr<DIContext> DICtx(new DWARFContextInMemory(Obj));
+  std::unique_ptr<DWARFContext> DICtx(new DWARFContextInMemory(Obj));
 
   outs() << Filename.str() << ":\tfile format " << Obj.getFileFormatName()
          << "\n\n";
-  // Dump the complete DWARF structure.
-  DICtx->dump(outs(), DumpType);
+  if (FindNames.empty() && LookupAddresses.empty() && DIEOffsets.empty()) {
+    // Dump the complete DWARF structure.
+    DICtx->dump(outs(), DumpType);
+    return;
+  }
+
+  // Only parse the units the lookups land in. The results are collected in
+  // memory and written out in one go.
+  SmallString<4096> Buffer;
+  raw_svector_ostream OS(Buffer);
+  for (const std::string &Name : FindNames) {
+    SmallVector<uint32_t, 4> Offsets;
+    DICtx->lookupAppleName(Name, Offsets);
+    for (uint32_t Offset : Offsets)
+      DumpDIEAtOffset(*DICtx, Offset, OS);
+  }
+  for (uint64_t Address : LookupAddresses)
+    DumpAddress(*DICtx, Address, OS);
+  for (uint64_t Offset : DIEOffsets)
+    DumpDIEAtOffset(*DICtx, Offset, OS);
+  outs() << OS.str();
 }
 
 static void DumpInput(StringRef Filename) {
@@ -2,53 +2,82 @@
 #define TOOLS_LLVM_DWP_DWPSTRINGPOOL
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/MC/MCSection.h"
 #include "llvm/MC/MCStreamer.h"
+#include "llvm/Support/Allocator.h"
 #include <cassert>
+#include <cstring>
 
 namespace llvm {
 class DWPStringPool {
 
+  /// A pooled string along with its hash, which is computed while the inputs
+  /// are being read in parallel rather than while merging.
+  struct HashedCStr {
+    const char *Str;
+    unsigned Hash;
+  };
+
   struct CStrDenseMapInfo {
-    static inline const char *getEmptyKey() {
-      return reinterpret_cast<const char *>(~static_cast<uintptr_t>(0));
+    static inline HashedCStr getEmptyKey() {
+      return {reinterpret_cast<const char *>(~static_cast<uintptr_t>(0)), 0};
     }
-    static inline const char *getTombstoneKey() {
-      return reinterpret_cast<const char *>(~static_cast<uintptr_t>(1));
+    static inline HashedCStr getTombstoneKey() {
+      return {reinterpret_cast<const char *>(~static_cast<uintptr_t>(1)), 0};
     }
-    static unsigned getHashValue(const char *Val) {
-      assert(Val != getEmptyKey() && "Cannot hash the empty key!");
-      assert(Val != getTombstoneKey() && "Cannot hash the tombstone key!");
-      return (unsigned)hash_value(StringRef(Val));
+    static unsigned getHashValue(const HashedCStr &Val) {
+      assert(Val.Str != getEmptyKey().Str && "Cannot hash the empty key!");
+      assert(Val.Str != getTombstoneKey().Str &&
+             "Cannot hash the tombstone key!");
+      return Val.Hash;
     }
-    static bool isEqual(const char *LHS, const char *RHS) {
-      if (RHS == getEmptyKey())
-        return LHS == getEmptyKey();
-      if (RHS == getTombstoneKey())
-        return LHS == getTombstoneKey();
-      return strcmp(LHS, RHS) == 0;
+    static bool isEqual(const HashedCStr &LHS, const HashedCStr &RHS) {
+      if (RHS.Str == getEmptyKey().Str)
+        return LHS.Str == getEmptyKey().Str;
+      if (RHS.Str == getTombstoneKey().Str)
+        return LHS.Str == getTombstoneKey().Str;
+      if (LHS.Str == getEmptyKey().Str || LHS.Str == getTombstoneKey().Str)
+        return false;
+      return LHS.Hash == RHS.Hash && strcmp(LHS.Str, RHS.Str) == 0;
     }
   };
 
   MCStreamer &Out;
   MCSection *Sec;
-  DenseMap<const char *, uint32_t, CStrDenseMapInfo> Pool;
+  DenseMap<HashedCStr, uint32_t, CStrDenseMapInfo> Pool;
+  /// Copies of the pooled strings. Owning them lets each input be released as
+  /// soon as it has been merged.
+  BumpPtrAllocator Alloc;
   uint32_t Offset = 0;
 
 public:
   DWPStringPool(MCStreamer &Out, MCSection *Sec) : Out(Out), Sec(Sec) {}
 
+  static unsigned hash(StringRef Str) { return (unsigned)hash_value(Str); }
+
   uint32_t getOffset(const char *Str, unsigned Length) {
+    return getOffset(Str, Length, hash(StringRef(Str, Length - 1)));
+  }
+
+  /// Return the offset of \p Str in the output section, emitting it if it is
+  /// new. \p Hash must be hash(Str).
+  uint32_t getOffset(const char *Str, unsigned Length, unsigned Hash) {
     assert(strlen(Str) + 1 == Length && "Ensure length hint is correct");
+    assert(hash(StringRef(Str, Length - 1)) == Hash && "Wrong hash");
 
-    auto Pair = Pool.insert(std::make_pair(Str, Offset));
-    if (Pair.second) {
-      Out.SwitchSection(Sec);
-      Out.EmitBytes(StringRef(Str, Length));
-      Offset += Length;
-    }
+    auto I = Pool.find({Str, Hash});
+    if (I != Pool.end())
+      return I->second;
 
-    return Pair.first->second;
+    char *Copy = Alloc.Allocate<char>(Length);
+    memcpy(Copy, Str, Length);
+    Pool.insert(std::make_pair(HashedCStr{Copy, Hash}, Offset));
+    Out.SwitchSection(Sec);
+    Out.EmitBytes(StringRef(Copy, Length));
+    uint32_t Result = Offset;
+    Offset += Length;
+    return Result;
   }
 };
 }
@@ -37,11 +37,14 @@
 #include "llvm/Support/Options.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
+#include <cstring>
 #include <deque>
 #include <iostream>
 #include <memory>
+#include <thread>
 
 using namespace llvm;
 using namespace llvm::object;
@@ -56,9 +59,42 @@ static opt<std::string> OutputFilename(Required, "o",
                                        value_desc("filename"),
                                        cat(DwpCategory));
 
+static opt<unsigned> NumThreads(
+    "num-threads",
+    desc("Specifies the maximum number (n) of simultaneous threads to use\n"
+         "when reading and decompressing inputs (0 = number of cores)."),
+    value_desc("n"), init(0), cat(DwpCategory));
+static alias NumThreadsA("j", desc("Alias for --num-threads"),
+                         aliasopt(NumThreads));
+
+/// A string of an input's .debug_str.dwo section, split out and hashed while
+/// the input is read so that merging it into the pool is a single lookup.
+struct InputString {
+  uint32_t Offset;
+  uint32_t Length; // Including the terminating null.
+  unsigned Hash;
+};
+
+static void splitStrings(StringRef StrSection,
+                         std::vector<InputString> &Strings) {
+  uint32_t Offset = 0;
+  while (Offset < StrSection.size()) {
+    const char *Start = StrSection.data() + Offset;
+    const void *End = memchr(Start, 0, StrSection.size() - Offset);
+    // Like DataExtractor::getCStr, stop at an unterminated string.
+    if (!End)
+      break;
+    uint32_t Length = static_cast<const char *>(End) - Start;
+    Strings.push_back({Offset, Length + 1,
+                       DWPStringPool::hash(StringRef(Start, Length))});
+    Offset += Length + 1;
+  }
+}
+
 static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
                                    MCSection *StrOffsetSection,
                                    StringRef CurStrSection,
+                                   ArrayRef<InputString> CurStrings,
                                    StringRef CurStrOffsetSection) {
   // Could possibly produce an error or warning if one of these was non-null but
   // the other was null.
@@ -66,17 +102,13 @@ static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
     return;
 
   DenseMap<uint32_t, uint32_t> OffsetRemapping;
+  OffsetRemapping.reserve(CurStrings.size());
 
-  DataExtractor Data(CurStrSection, true, 0);
-  uint32_t LocalOffset = 0;
-  uint32_t PrevOffset = 0;
-  while (const char *s = Data.getCStr(&LocalOffset)) {
-    OffsetRemapping[PrevOffset] =
-        Strings.getOffset(s, LocalOffset - PrevOffset);
-    PrevOffset = LocalOffset;
-  }
+  for (const InputString &S : CurStrings)
+    OffsetRemapping[S.Offset] = Strings.getOffset(
+        CurStrSection.data() + S.Offset, S.Length, S.Hash);
 
-  Data = DataExtractor(CurStrOffsetSection, true, 0);
+  DataExtractor Data(CurStrOffsetSection, true, 0);
 
   Out.SwitchSection(StrOffsetSection);
 
@@ -380,17 +412,36 @@ static Error handleCompressedSection(
   return Error();
 }
 
-static Error handleSection(
-    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
-    const MCSection *StrSection, const MCSection *StrOffsetSection,
-    const MCSection *TypesSection, const MCSection *CUIndexSection,
-    const MCSection *TUIndexSection, const SectionRef &Section, MCStreamer &Out,
-    std::deque<SmallString<32>> &UncompressedSections,
-    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
-    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
-    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
-    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
-    StringRef &CurTUIndexSection) {
+typedef StringMap<std::pair<MCSection *, DWARFSectionKind>> KnownSectionMap;
+
+/// A section of an input which goes into the output, with its contents
+/// decompressed if needed.
+struct InputSection {
+  MCSection *OutSection;
+  DWARFSectionKind Kind;
+  StringRef Contents;
+};
+
+/// An input file, read ahead of the merge (possibly on another thread). It is
+/// released as soon as it has been merged.
+struct DWOInput {
+  OwningBinary<object::ObjectFile> Obj;
+  std::deque<SmallString<32>> UncompressedSections;
+  std::vector<InputSection> Sections;
+  /// The strings of the last .debug_str.dwo section.
+  std::vector<InputString> Strings;
+  /// Set if the input could not be read. Reported when the merge reaches this
+  /// input, so that errors come out in input order.
+  Error Err;
+
+  ~DWOInput() {
+    // Inputs after one that failed are never merged.
+    consumeError(std::move(Err));
+  }
+};
+
+static Error readSection(const KnownSectionMap &KnownSections,
+                         const SectionRef &Section, DWOInput &In) {
   if (Section.isBSS())
     return Error();
 
@@ -407,14 +458,51 @@ static Error handleSection(
   if (auto Err = Section.getContents(Contents))
     return errorCodeToError(Err);
 
-  if (auto Err = handleCompressedSection(UncompressedSections, Name, Contents))
+  if (auto Err =
+          handleCompressedSection(In.UncompressedSections, Name, Contents))
     return Err;
 
   auto SectionPair = KnownSections.find(Name);
   if (SectionPair == KnownSections.end())
     return Error();
 
-  if (DWARFSectionKind Kind = SectionPair->second.second) {
+  In.Sections.push_back(
+      {SectionPair->second.first, SectionPair->second.second, Contents});
+  return Error();
+}
+
+/// Open \p Input and pull out the sections to merge. This only reads shared
+/// state, so it runs concurrently for several inputs.
+static Error readInput(StringRef Input, const KnownSectionMap &KnownSections,
+                       const MCSection *StrSection, DWOInput &In) {
+  auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
+  if (!ErrOrObj)
+    return ErrOrObj.takeError();
+  In.Obj = std::move(*ErrOrObj);
+
+  for (const auto &Section : In.Obj.getBinary()->sections())
+    if (auto Err = readSection(KnownSections, Section, In))
+      return Err;
+
+  StringRef StrContents;
+  for (const InputSection &Sec : In.Sections)
+    if (Sec.OutSection == StrSection)
+      StrContents = Sec.Contents;
+  splitStrings(StrContents, In.Strings);
+  return Error();
+}
+
+static void handleSection(
+    const InputSection &Section, const MCSection *StrSection,
+    const MCSection *StrOffsetSection, const MCSection *TypesSection,
+    const MCSection *CUIndexSection, const MCSection *TUIndexSection,
+    MCStreamer &Out, uint32_t (&ContributionOffsets)[8],
+    UnitIndexEntry &CurEntry, StringRef &CurStrSection,
+    StringRef &CurStrOffsetSection, std::vector<StringRef> &CurTypesSection,
+    StringRef &InfoSection, StringRef &AbbrevSection,
+    StringRef &CurCUIndexSection, StringRef &CurTUIndexSection) {
+  StringRef Contents = Section.Contents;
+  if (DWARFSectionKind Kind = Section.Kind) {
     auto Index = Kind - DW_SECT_INFO;
     if (Kind != DW_SECT_TYPES) {
       CurEntry.Contributions[Index].Offset = ContributionOffsets[Index];
@@ -434,7 +522,7 @@ static Error handleSection(
     }
   }
 
-  MCSection *OutSection = SectionPair->second.first;
+  MCSection *OutSection = Section.OutSection;
   if (OutSection == StrOffsetSection)
     CurStrOffsetSection = Contents;
   else if (OutSection == StrSection)
@@ -449,7 +537,6 @@ static Error handleSection(
     Out.SwitchSection(OutSection);
     Out.EmitBytes(Contents);
   }
-  return Error();
 }
 
 static Error
@@ -469,7 +556,7 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
   MCSection *const TypesSection = MCOFI.getDwarfTypesDWOSection();
   MCSection *const CUIndexSection = MCOFI.getDwarfCUIndexSection();
   MCSection *const TUIndexSection = MCOFI.getDwarfTUIndexSection();
-  const StringMap<std::pair<MCSection *, DWARFSectionKind>> KnownSections = {
+  const KnownSectionMap KnownSections = {
       {"debug_info.dwo", {MCOFI.getDwarfInfoDWOSection(), DW_SECT_INFO}},
       {"debug_types.dwo", {MCOFI.getDwarfTypesDWOSection(), DW_SECT_TYPES}},
       {"debug_str_offsets.dwo", {StrOffsetSection, DW_SECT_STR_OFFSETS}},
@@ -487,18 +574,46 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
 
   DWPStringPool Strings(Out, StrSection);
 
-  SmallVector<OwningBinary<object::ObjectFile>, 128> Objects;
-  Objects.reserve(Inputs.size());
-
-  std::deque<SmallString<32>> UncompressedSections;
-
-  for (const auto &Input : Inputs) {
-    auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
-    if (!ErrOrObj)
-      return ErrOrObj.takeError();
-
-    auto &Obj = *ErrOrObj->getBinary();
-    Objects.push_back(std::move(*ErrOrObj));
+  // Opening, mapping and decompressing the inputs runs on a pool of threads,
+  // a few inputs ahead of the merge, which emits them in order. Each input is
+  // released once merged, so memory is bounded by the inputs in flight rather
+  // than by all of them.
+  unsigned Threads = NumThreads;
+  if (Threads == 0)
+    Threads = std::thread::hardware_concurrency();
+  Threads = std::min<unsigned>(std::max(Threads, 1U), Inputs.size());
+  const size_t ReadAhead = 2 * Threads;
+
+  // Declared before the pool, whose destructor waits for the pending reads,
+  // so that an early error return doesn't free inputs being read.
+  std::vector<std::unique_ptr<DWOInput>> Loaded(Inputs.size());
+  std::vector<std::shared_future<void>> Reads(Inputs.size());
+  ThreadPool Pool(Threads);
+  size_t NextRead = 0;
+  auto ReadNext = [&] {
+    size_t I = NextRead++;
+    Loaded[I] = llvm::make_unique<DWOInput>();
+    DWOInput *In = Loaded[I].get();
+    StringRef Input = Inputs[I];
+    Reads[I] = Pool.async([&KnownSections, StrSection, Input, In] {
+      ErrorAsOutParameter ErrAsOutParam(In->Err);
+      In->Err = readInput(Input, KnownSections, StrSection, *In);
+    });
+  };
+  while (NextRead != std::min(ReadAhead, Inputs.size()))
+    ReadNext();
+
+  for (size_t InputIdx = 0; InputIdx != Inputs.size(); ++InputIdx) {
+    Reads[InputIdx].wait();
+    if (NextRead != Inputs.size())
+      ReadNext();
+
+    // Dropped when done with this input, on every path out of the iteration.
+    std::unique_ptr<DWOInput> In = std::move(Loaded[InputIdx]);
+    if (In->Err)
+      return std::move(In->Err);
+    StringRef Input = Inputs[InputIdx];
+    auto &Obj = *In->Obj.getBinary();
 
     UnitIndexEntry CurEntry = {};
 
@@ -510,20 +625,18 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
     StringRef CurCUIndexSection;
     StringRef CurTUIndexSection;
 
-    for (const auto &Section : Obj.sections())
-      if (auto Err = handleSection(
-              KnownSections, StrSection, StrOffsetSection, TypesSection,
-              CUIndexSection, TUIndexSection, Section, Out,
-              UncompressedSections, ContributionOffsets, CurEntry,
-              CurStrSection, CurStrOffsetSection, CurTypesSection, InfoSection,
-              AbbrevSection, CurCUIndexSection, CurTUIndexSection))
-        return Err;
+    for (const InputSection &Section : In->Sections)
+      handleSection(Section, StrSection, StrOffsetSection, TypesSection,
+                    CUIndexSection, TUIndexSection, Out, ContributionOffsets,
+                    CurEntry, CurStrSection, CurStrOffsetSection,
+                    CurTypesSection, InfoSection, AbbrevSection,
+                    CurCUIndexSection, CurTUIndexSection);
 
     if (InfoSection.empty())
       continue;
 
     writeStringsAndOffsets(Out, Strings, StrOffsetSection, CurStrSection,
-                           CurStrOffsetSection);
+                           In->Strings, CurStrOffsetSection);
 
     if (CurCUIndexSection.empty()) {
       Expected<CompileUnitIdentifiers> EID = getCUIdentifiers(
@@ -49,6 +49,10 @@ Force("f", cl::desc("Enable binary output on terminals"));
 static cl::opt<bool>
 DeleteFn("delete", cl::desc("Delete specified Globals from Module"));
 
+static cl::opt<bool>
+Recursive("recursive",
+          cl::desc("Also extract the globals referenced by the extracted ones"));
+
 // ExtractFuncs - The functions to extract from the module.
 static cl::list<std::string>
 ExtractFuncs("func", cl::desc("Specify function to extract"),
@@ -229,6 +233,47 @@ int main(int argc, char **argv) {
     }
   };
 
+  // Add everything the selected globals refer to, transitively. Only the
+  // bodies of the functions that are reached are read from the input.
+  if (Recursive) {
+    SmallVector<GlobalValue *, 16> Worklist(GVs.begin(), GVs.end());
+    SmallPtrSet<const Constant *, 16> VisitedConstants;
+    SmallVector<const Value *, 16> Operands;
+    auto Visit = [&](const Value *V) {
+      Operands.push_back(V);
+      while (!Operands.empty()) {
+        const Value *Op = Operands.pop_back_val();
+        auto *C = dyn_cast<Constant>(Op);
+        if (!C || !VisitedConstants.insert(C).second)
+          continue;
+        if (auto *GV = dyn_cast<GlobalValue>(C)) {
+          if (GVs.insert(const_cast<GlobalValue *>(GV)))
+            Worklist.push_back(const_cast<GlobalValue *>(GV));
+          continue;
+        }
+        Operands.append(C->op_begin(), C->op_end());
+      }
+    };
+
+    while (!Worklist.empty()) {
+      GlobalValue *GV = Worklist.pop_back_val();
+      if (auto *F = dyn_cast<Function>(GV)) {
+        Materialize(*F);
+        for (const Use &U : F->operands())
+          Visit(U);
+        for (const BasicBlock &BB : *F)
+          for (const Instruction &I : BB)
+            for (const Use &U : I.operands())
+              Visit(U);
+      } else if (auto *GVar = dyn_cast<GlobalVariable>(GV)) {
+        if (GVar->hasInitializer())
+          Visit(GVar->getInitializer());
+      } else if (auto *GA = dyn_cast<GlobalAlias>(GV)) {
+        Visit(GA->getAliasee());
+      }
+    }
+  }
+
   // Materialize requisite global values.
   if (!DeleteFn) {
     for (size_t i = 0, e = GVs.size(); i != e; ++i)
@@ -19,6 +19,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
+#include "llvm/LTO/LTO.h"
 #include "llvm/LTO/LTOCodeGenerator.h"
 #include "llvm/LTO/LTOModule.h"
 #include "llvm/LTO/ThinLTOCodeGenerator.h"
@@ -31,6 +32,7 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 #include <list>
@@ -74,6 +76,7 @@ enum ThinLTOModes {
   THININTERNALIZE,
   THINOPT,
   THINCODEGEN,
+  THINBACKEND,
   THINALL
 };
 
@@ -97,6 +100,9 @@ cl::opt<ThinLTOModes> ThinLTOMode(
                    "(requires -thinlto-index)."),
         clEnumValN(THINOPT, "optimize", "Perform ThinLTO optimizations."),
         clEnumValN(THINCODEGEN, "codegen", "CodeGen (expected to match llc)"),
+        clEnumValN(THINBACKEND, "backend",
+                   "Perform a distributed backend from the individual index "
+                   "(-thinlto-index, defaults to <input>.thinlto.bc)."),
         clEnumValN(THINALL, "run", "Perform ThinLTO end-to-end"),
         clEnumValEnd));
 
@@ -152,6 +158,21 @@ static cl::opt<bool> SetMergedModule(
 static cl::opt<unsigned> Parallelism("j", cl::Prefix, cl::init(1),
                                      cl::desc("Number of backend threads"));
 
+static cl::opt<bool> TimeTrace("time-trace",
+                               cl::desc("Record a Chrome trace of the time "
+                                        "spent in each pass"));
+
+static cl::opt<unsigned> TimeTraceGranularity(
+    "time-trace-granularity",
+    cl::desc("Minimum duration (in microseconds) of the events recorded by "
+             "-time-trace"),
+    cl::init(500), cl::Hidden);
+
+static cl::opt<std::string>
+    TimeTraceFile("time-trace-file",
+                  cl::desc("File to write the -time-trace output to"),
+                  cl::value_desc("filename"));
+
 static cl::opt<bool> RestoreGlobalsLinkage(
     "restore-linkage", cl::init(false),
     cl::desc("Restore original linkage of globals prior to CodeGen"));
@@ -293,6 +314,7 @@ static void createCombinedModuleSummaryIndex() {
       continue;
     CombinedIndex.mergeFrom(std::move(Index), ++NextModuleId);
   }
+  thinLTOPropagateFunctionAttrsInIndex(CombinedIndex);
   std::error_code EC;
   assert(!OutputFilename.empty());
   raw_fd_ostream OS(OutputFilename + ".thinlto.bc", EC,
@@ -417,6 +439,8 @@ public:
       return optimize();
     case THINCODEGEN:
       return codegen();
+    case THINBACKEND:
+      return backend();
     case THINALL:
       return runAll();
     }
@@ -647,6 +671,42 @@ private:
     }
   }
 
+  /// Load the individual index produced by distributedIndexes() for the file
+  /// mentioned on the command line and the files it references, then produce
+  /// an object file: this is a standalone distributed backend.
+  void backend() {
+    if (InputFilenames.size() != 1)
+      report_fatal_error("A distributed backend processes a single input "
+                         "file.");
+
+    auto &Filename = InputFilenames[0];
+    std::string IndexFilename = ThinLTOIndex;
+    if (IndexFilename.empty())
+      IndexFilename = Filename + ".thinlto.bc";
+    auto CurrentActivity = "loading file '" + IndexFilename + "'";
+    ErrorOr<std::unique_ptr<ModuleSummaryIndex>> IndexOrErr =
+        llvm::getModuleSummaryIndexForFile(IndexFilename, diagnosticHandler);
+    error(IndexOrErr, "error " + CurrentActivity);
+    auto Index = std::move(IndexOrErr.get());
+
+    auto InputBuffers = loadAllFilesForIndex(*Index);
+    for (auto &MemBuffer : InputBuffers)
+      ThinGenerator.addModule(MemBuffer->getBufferIdentifier(),
+                              MemBuffer->getBuffer());
+
+    LLVMContext Ctx;
+    auto TheModule = loadModule(Filename, Ctx);
+    auto Buffer = ThinGenerator.distributedBackend(*TheModule, *Index);
+
+    std::string OutputName = OutputFilename;
+    if (OutputName.empty())
+      OutputName = Filename + ".thinlto.o";
+    std::error_code EC;
+    raw_fd_ostream OS(OutputName, EC, sys::fs::OpenFlags::F_None);
+    error(EC, "error opening the file '" + OutputName + "'");
+    OS << Buffer->getBuffer();
+  }
+
   /// Full ThinLTO process
   void runAll() {
     if (!OutputFilename.empty())
@@ -689,6 +749,26 @@ private:
 
 } // namespace thinlto
 
+namespace {
+/// Records a time trace for the lifetime of the object when -time-trace is
+/// given, and writes it out on destruction so that every exit path of main()
+/// is covered.
+struct TimeTraceRAII {
+  TimeTraceRAII() {
+    if (TimeTrace)
+      timeTraceProfilerInitialize(TimeTraceGranularity);
+  }
+  ~TimeTraceRAII() {
+    if (!TimeTrace)
+      return;
+    if (std::error_code EC =
+            timeTraceProfilerWrite(TimeTraceFile, OutputFilename))
+      errs() << "llvm-lto: " << EC.message() << '\n';
+    timeTraceProfilerCleanup();
+  }
+};
+} // end anonymous namespace
+
 int main(int argc, char **argv) {
   // Print a stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal(argv[0]);
@@ -696,6 +776,7 @@ int main(int argc, char **argv) {
 
   llvm_shutdown_obj Y; // Call llvm_shutdown() on exit.
   cl::ParseCommandLineOptions(argc, argv, "llvm LTO linker\n");
+  TimeTraceRAII TimeTracer;
 
   if (OptLevel < '0' || OptLevel > '3')
     error("optimization level must be between 0 and 3");
@@ -39,8 +39,10 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cerrno>
 #include <cstring>
@@ -168,18 +170,32 @@ cl::opt<bool> FormatMachOasHex("x", cl::desc("Print symbol entry in hex, "
 cl::opt<bool> NoLLVMBitcode("no-llvm-bc",
                             cl::desc("Disable LLVM bitcode reader"));
 
+cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Read up to <n> input files at once; the output is "
+                        "still printed in input order"),
+               cl::value_desc("n"), cl::init(1));
+
 bool PrintAddress = true;
 
 bool MultipleFiles = false;
 
-bool HadError = false;
+std::atomic<bool> HadError(false);
 
 std::string ToolName;
 } // anonymous namespace
 
+/// When inputs are read on several threads, each one prints into buffers
+/// that are written out in input order once it is done.
+static LLVM_THREAD_LOCAL raw_ostream *OutputStream = nullptr;
+static LLVM_THREAD_LOCAL raw_ostream *ErrorStream = nullptr;
+
+static raw_ostream &out() { return OutputStream ? *OutputStream : outs(); }
+static raw_ostream &err() { return ErrorStream ? *ErrorStream : errs(); }
+
 static void error(Twine Message, Twine Path = Twine()) {
   HadError = true;
-  errs() << ToolName << ": " << Path << ": " << Message << ".\n";
+  err() << ToolName << ": " << Path << ": " << Message << ".\n";
 }
 
 static bool error(std::error_code EC, Twine Path = Twine()) {
@@ -196,25 +212,25 @@ static bool error(std::error_code EC, Twine Path = Twine()) {
 static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
                   StringRef ArchitectureName = StringRef()) {
   HadError = true;
-  errs() << ToolName << ": " << FileName;
+  err() << ToolName << ": " << FileName;
 
   ErrorOr<StringRef> NameOrErr = C.getName();
   // TODO: if we have a error getting the name then it would be nice to print
   // the index of which archive member this is and or its offset in the
   // archive instead of "???" as the name.
   if (NameOrErr.getError())
-    errs() << "(" << "???" << ")";
+    err() << "(" << "???" << ")";
   else
-    errs() << "(" << NameOrErr.get() << ")";
+    err() << "(" << NameOrErr.get() << ")";
 
   if (!ArchitectureName.empty())
-    errs() << " (for architecture " << ArchitectureName << ") ";
+    err() << " (for architecture " << ArchitectureName << ") ";
 
   std::string Buf;
   raw_string_ostream OS(Buf);
   logAllUnhandledErrors(std::move(E), OS, "");
   OS.flush();
-  errs() << " " << Buf << "\n";
+  err() << " " << Buf << "\n";
 }
 
 // This version of error() prints the file name and which architecture slice it
@@ -224,16 +240,16 @@ static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
 static void error(llvm::Error E, StringRef FileName,
                   StringRef ArchitectureName = StringRef()) {
   HadError = true;
-  errs() << ToolName << ": " << FileName;
+  err() << ToolName << ": " << FileName;
 
   if (!ArchitectureName.empty())
-    errs() << " (for architecture " << ArchitectureName << ") ";
+    err() << " (for architecture " << ArchitectureName << ") ";
 
   std::string Buf;
   raw_string_ostream OS(Buf);
   logAllUnhandledErrors(std::move(E), OS, "");
   OS.flush();
-  errs() << " " << Buf << "\n";
+  err() << " " << Buf << "\n";
 }
 
 namespace {
@@ -241,14 +257,16 @@ struct NMSymbol {
   uint64_t Address;
   uint64_t Size;
   char TypeChar;
+  /// Sym.getFlags(), read once rather than on every comparison.
+  uint32_t Flags;
   StringRef Name;
   BasicSymbolRef Sym;
 };
 } // anonymous namespace
 
 static bool compareSymbolAddress(const NMSymbol &A, const NMSymbol &B) {
-  bool ADefined = !(A.Sym.getFlags() & SymbolRef::SF_Undefined);
-  bool BDefined = !(B.Sym.getFlags() & SymbolRef::SF_Undefined);
+  bool ADefined = !(A.Flags & SymbolRef::SF_Undefined);
+  bool BDefined = !(B.Flags & SymbolRef::SF_Undefined);
   return std::make_tuple(ADefined, A.Address, A.Name, A.Size) <
          std::make_tuple(BDefined, B.Address, B.Name, B.Size);
 }
@@ -279,9 +297,7 @@ static char isSymbolList64Bit(SymbolicFile &Obj) {
   return cast<ELFObjectFileBase>(Obj).getBytesInAddress() == 8;
 }
 
-static StringRef CurrentFilename;
 typedef std::vector<NMSymbol> SymbolListT;
-static SymbolListT SymbolList;
 
 static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I);
 
@@ -354,16 +370,16 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
   if (FormatMachOasHex) {
     char Str[18] = "";
     format(printFormat, NValue).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    out() << Str << ' ';
     format("%02x", NType).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    out() << Str << ' ';
     format("%02x", NSect).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    out() << Str << ' ';
     format("%04x", NDesc).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    out() << Str << ' ';
     format("%08x", NStrx).print(Str, sizeof(Str));
-    outs() << Str << ' ';
-    outs() << I->Name << "\n";
+    out() << Str << ' ';
+    out() << I->Name << "\n";
     return;
   }
 
@@ -372,58 +388,58 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
       strcpy(SymbolAddrStr, printBlanks);
     if (Obj.isIR() && (NType & MachO::N_TYPE) == MachO::N_TYPE)
       strcpy(SymbolAddrStr, printDashes);
-    outs() << SymbolAddrStr << ' ';
+    out() << SymbolAddrStr << ' ';
   }
 
   switch (NType & MachO::N_TYPE) {
   case MachO::N_UNDF:
     if (NValue != 0) {
-      outs() << "(common) ";
+      out() << "(common) ";
       if (MachO::GET_COMM_ALIGN(NDesc) != 0)
-        outs() << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
+        out() << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
     } else {
       if ((NType & MachO::N_TYPE) == MachO::N_PBUD)
-        outs() << "(prebound ";
+        out() << "(prebound ";
       else
-        outs() << "(";
+        out() << "(";
       if ((NDesc & MachO::REFERENCE_TYPE) ==
           MachO::REFERENCE_FLAG_UNDEFINED_LAZY)
-        outs() << "undefined [lazy bound]) ";
+        out() << "undefined [lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_LAZY)
-        outs() << "undefined [private lazy bound]) ";
+        out() << "undefined [private lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_NON_LAZY)
-        outs() << "undefined [private]) ";
+        out() << "undefined [private]) ";
       else
-        outs() << "undefined) ";
+        out() << "undefined) ";
     }
     break;
   case MachO::N_ABS:
-    outs() << "(absolute) ";
+    out() << "(absolute) ";
     break;
   case MachO::N_INDR:
-    outs() << "(indirect) ";
+    out() << "(indirect) ";
     break;
   case MachO::N_SECT: {
     if (Obj.isIR()) {
       // For llvm bitcode files print out a fake section name using the values
       // use 1, 2 and 3 for section numbers as set above.
       if (NSect == 1)
-        outs() << "(LTO,CODE) ";
+        out() << "(LTO,CODE) ";
       else if (NSect == 2)
-        outs() << "(LTO,DATA) ";
+        out() << "(LTO,DATA) ";
       else if (NSect == 3)
-        outs() << "(LTO,RODATA) ";
+        out() << "(LTO,RODATA) ";
       else
-        outs() << "(?,?) ";
+        out() << "(?,?) ";
       break;
     }
     Expected<section_iterator> SecOrErr =
       MachO->getSymbolSection(I->Sym.getRawDataRefImpl());
     if (!SecOrErr) {
       consumeError(SecOrErr.takeError());
-      outs() << "(?,?) ";
+      out() << "(?,?) ";
       break;
     }
     section_iterator Sec = *SecOrErr;
@@ -431,67 +447,67 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
     StringRef SectionName;
     MachO->getSectionName(Ref, SectionName);
     StringRef SegmentName = MachO->getSectionFinalSegmentName(Ref);
-    outs() << "(" << SegmentName << "," << SectionName << ") ";
+    out() << "(" << SegmentName << "," << SectionName << ") ";
     break;
   }
   default:
-    outs() << "(?) ";
+    out() << "(?) ";
     break;
   }
 
   if (NType & MachO::N_EXT) {
     if (NDesc & MachO::REFERENCED_DYNAMICALLY)
-      outs() << "[referenced dynamically] ";
+      out() << "[referenced dynamically] ";
     if (NType & MachO::N_PEXT) {
       if ((NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF)
-        outs() << "weak private external ";
+        out() << "weak private external ";
       else
-        outs() << "private external ";
+        out() << "private external ";
     } else {
       if ((NDesc & MachO::N_WEAK_REF) == MachO::N_WEAK_REF ||
           (NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF) {
         if ((NDesc & (MachO::N_WEAK_REF | MachO::N_WEAK_DEF)) ==
             (MachO::N_WEAK_REF | MachO::N_WEAK_DEF))
-          outs() << "weak external automatically hidden ";
+          out() << "weak external automatically hidden ";
         else
-          outs() << "weak external ";
+          out() << "weak external ";
       } else
-        outs() << "external ";
+        out() << "external ";
     }
   } else {
     if (NType & MachO::N_PEXT)
-      outs() << "non-external (was a private external) ";
+      out() << "non-external (was a private external) ";
     else
-      outs() << "non-external ";
+      out() << "non-external ";
   }
 
   if (Filetype == MachO::MH_OBJECT &&
       (NDesc & MachO::N_NO_DEAD_STRIP) == MachO::N_NO_DEAD_STRIP)
-    outs() << "[no dead strip] ";
+    out() << "[no dead strip] ";
 
   if (Filetype == MachO::MH_OBJECT &&
       ((NType & MachO::N_TYPE) != MachO::N_UNDF) &&
       (NDesc & MachO::N_SYMBOL_RESOLVER) == MachO::N_SYMBOL_RESOLVER)
-    outs() << "[symbol resolver] ";
+    out() << "[symbol resolver] ";
 
   if (Filetype == MachO::MH_OBJECT &&
       ((NType & MachO::N_TYPE) != MachO::N_UNDF) &&
       (NDesc & MachO::N_ALT_ENTRY) == MachO::N_ALT_ENTRY)
-    outs() << "[alt entry] ";
+    out() << "[alt entry] ";
 
   if ((NDesc & MachO::N_ARM_THUMB_DEF) == MachO::N_ARM_THUMB_DEF)
-    outs() << "[Thumb] ";
+    out() << "[Thumb] ";
 
   if ((NType & MachO::N_TYPE) == MachO::N_INDR) {
-    outs() << I->Name << " (for ";
+    out() << I->Name << " (for ";
     StringRef IndirectName;
     if (!MachO ||
         MachO->getIndirectName(I->Sym.getRawDataRefImpl(), IndirectName))
-      outs() << "?)";
+      out() << "?)";
     else
-      outs() << IndirectName << ")";
+      out() << IndirectName << ")";
   } else
-    outs() << I->Name;
+    out() << I->Name;
 
   if ((Flags & MachO::MH_TWOLEVEL) == MachO::MH_TWOLEVEL &&
       (((NType & MachO::N_TYPE) == MachO::N_UNDF && NValue == 0) ||
@@ -499,21 +515,21 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
     uint32_t LibraryOrdinal = MachO::GET_LIBRARY_ORDINAL(NDesc);
     if (LibraryOrdinal != 0) {
       if (LibraryOrdinal == MachO::EXECUTABLE_ORDINAL)
-        outs() << " (from executable)";
+        out() << " (from executable)";
       else if (LibraryOrdinal == MachO::DYNAMIC_LOOKUP_ORDINAL)
-        outs() << " (dynamically looked up)";
+        out() << " (dynamically looked up)";
       else {
         StringRef LibraryName;
         if (!MachO ||
             MachO->getLibraryShortNameByIndex(LibraryOrdinal - 1, LibraryName))
-          outs() << " (from bad library ordinal " << LibraryOrdinal << ")";
+          out() << " (from bad library ordinal " << LibraryOrdinal << ")";
         else
-          outs() << " (from " << LibraryName << ")";
+          out() << " (from " << LibraryName << ")";
       }
     }
   }
 
-  outs() << "\n";
+  out() << "\n";
 }
 
 // Table that maps Darwin's Mach-O stab constants to strings to allow printing.
@@ -586,40 +602,45 @@ static void darwinPrintStab(MachOObjectFile *MachO, SymbolListT::iterator I) {
 
   char Str[18] = "";
   format("%02x", NSect).print(Str, sizeof(Str));
-  outs() << ' ' << Str << ' ';
+  out() << ' ' << Str << ' ';
   format("%04x", NDesc).print(Str, sizeof(Str));
-  outs() << Str << ' ';
+  out() << Str << ' ';
   if (const char *stabString = getDarwinStabString(NType))
     format("%5.5s", stabString).print(Str, sizeof(Str));
   else
     format("   %02x", NType).print(Str, sizeof(Str));
-  outs() << Str;
+  out() << Str;
+}
+
+template <bool (*Cmp)(const NMSymbol &, const NMSymbol &)>
+static void sortSymbolList(SymbolListT &SymbolList) {
+  if (ReverseSort)
+    std::sort(SymbolList.begin(), SymbolList.end(),
+              [](const NMSymbol &A, const NMSymbol &B) { return Cmp(B, A); });
+  else
+    std::sort(SymbolList.begin(), SymbolList.end(), Cmp);
 }
 
-static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
+static void sortAndPrintSymbolList(SymbolicFile &Obj, SymbolListT &SymbolList,
+                                   StringRef CurrentFilename, bool printName,
                                    const std::string &ArchiveName,
                                    const std::string &ArchitectureName) {
   if (!NoSort) {
-    std::function<bool(const NMSymbol &, const NMSymbol &)> Cmp;
     if (NumericSort)
-      Cmp = compareSymbolAddress;
+      sortSymbolList<compareSymbolAddress>(SymbolList);
     else if (SizeSort)
-      Cmp = compareSymbolSize;
+      sortSymbolList<compareSymbolSize>(SymbolList);
     else
-      Cmp = compareSymbolName;
-
-    if (ReverseSort)
-      Cmp = [=](const NMSymbol &A, const NMSymbol &B) { return Cmp(B, A); };
-    std::sort(SymbolList.begin(), SymbolList.end(), Cmp);
+      sortSymbolList<compareSymbolName>(SymbolList);
   }
 
   if (!PrintFileName) {
     if (OutputFormat == posix && MultipleFiles && printName) {
-      outs() << '\n' << CurrentFilename << ":\n";
+      out() << '\n' << CurrentFilename << ":\n";
     } else if (OutputFormat == bsd && MultipleFiles && printName) {
-      outs() << "\n" << CurrentFilename << ":\n";
+      out() << "\n" << CurrentFilename << ":\n";
     } else if (OutputFormat == sysv) {
-      outs() << "\n\nSymbols from " << CurrentFilename << ":\n\n"
+      out() << "\n\nSymbols from " << CurrentFilename << ":\n\n"
              << "Name                  Value   Class        Type"
              << "         Size   Line  Section\n";
     }
@@ -656,7 +677,7 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
 
   for (SymbolListT::iterator I = SymbolList.begin(), E = SymbolList.end();
        I != E; ++I) {
-    uint32_t SymFlags = I->Sym.getFlags();
+    uint32_t SymFlags = I->Flags;
     bool Undefined = SymFlags & SymbolRef::SF_Undefined;
     bool Global = SymFlags & SymbolRef::SF_Global;
     if ((!Undefined && UndefinedOnly) || (Undefined && DefinedOnly) ||
@@ -664,18 +685,18 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
       continue;
     if (PrintFileName) {
       if (!ArchitectureName.empty())
-        outs() << "(for architecture " << ArchitectureName << "):";
+        out() << "(for architecture " << ArchitectureName << "):";
       if (OutputFormat == posix && !ArchiveName.empty())
-        outs() << ArchiveName << "[" << CurrentFilename << "]: ";
+        out() << ArchiveName << "[" << CurrentFilename << "]: ";
       else {
         if (!ArchiveName.empty())
-          outs() << ArchiveName << ":";
-        outs() << CurrentFilename << ": ";
+          out() << ArchiveName << ":";
+        out() << CurrentFilename << ": ";
       }
     }
     if ((JustSymbolName || (UndefinedOnly && isa<MachOObjectFile>(Obj) &&
                             OutputFormat != darwin)) && OutputFormat != posix) {
-      outs() << I->Name << "\n";
+      out() << I->Name << "\n";
       continue;
     }
 
@@ -711,32 +732,30 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
       darwinPrintSymbol(Obj, I, SymbolAddrStr, printBlanks, printDashes,
                         printFormat);
     } else if (OutputFormat == posix) {
-      outs() << I->Name << " " << I->TypeChar << " ";
+      out() << I->Name << " " << I->TypeChar << " ";
       if (MachO)
-        outs() << SymbolAddrStr << " " << "0" /* SymbolSizeStr */ << "\n";
+        out() << SymbolAddrStr << " " << "0" /* SymbolSizeStr */ << "\n";
       else
-        outs() << SymbolAddrStr << " " << SymbolSizeStr << "\n";
+        out() << SymbolAddrStr << " " << SymbolSizeStr << "\n";
     } else if (OutputFormat == bsd || (OutputFormat == darwin && !MachO)) {
       if (PrintAddress)
-        outs() << SymbolAddrStr << ' ';
+        out() << SymbolAddrStr << ' ';
       if (PrintSize) {
-        outs() << SymbolSizeStr;
-        outs() << ' ';
+        out() << SymbolSizeStr;
+        out() << ' ';
       }
-      outs() << I->TypeChar;
+      out() << I->TypeChar;
       if (I->TypeChar == '-' && MachO)
         darwinPrintStab(MachO, I);
-      outs() << " " << I->Name << "\n";
+      out() << " " << I->Name << "\n";
     } else if (OutputFormat == sysv) {
       std::string PaddedName(I->Name);
       while (PaddedName.length() < 20)
         PaddedName += " ";
-      outs() << PaddedName << "|" << SymbolAddrStr << "|   " << I->TypeChar
+      out() << PaddedName << "|" << SymbolAddrStr << "|   " << I->TypeChar
              << "  |                  |" << SymbolSizeStr << "|     |\n";
     }
   }
-
-  SymbolList.clear();
 }
 
 static char getSymbolNMTypeChar(ELFObjectFileBase &Obj,
@@ -978,6 +997,7 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
     Symbols =
         make_range<basic_symbol_iterator>(DynSymbols.begin(), DynSymbols.end());
   }
+  SymbolListT SymbolList;
   std::string NameBuffer;
   raw_string_ostream OS(NameBuffer);
   // If a "-s segname sectname" option was specified and this is a Mach-O
@@ -1023,6 +1043,7 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
       S.Address = *AddressOrErr;
     }
     S.TypeChar = getNMTypeChar(Obj, Sym);
+    S.Flags = Sym.getFlags();
     std::error_code EC = Sym.printName(OS);
     if (EC && MachO)
       OS << "bad string index";
@@ -1040,8 +1061,8 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
     P += strlen(P) + 1;
   }
 
-  CurrentFilename = Obj.getFileName();
-  sortAndPrintSymbolList(Obj, printName, ArchiveName, ArchitectureName);
+  sortAndPrintSymbolList(Obj, SymbolList, Obj.getFileName(), printName,
+                         ArchiveName, ArchitectureName);
 }
 
 // checkMachOAndArchFlags() checks to see if the SymbolicFile is a Mach-O file
@@ -1094,7 +1115,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
       Archive::symbol_iterator I = A->symbol_begin();
       Archive::symbol_iterator E = A->symbol_end();
       if (I != E) {
-        outs() << "Archive map\n";
+        out() << "Archive map\n";
         for (; I != E; ++I) {
           ErrorOr<Archive::Child> C = I->getMember();
           if (error(C.getError()))
@@ -1103,9 +1124,9 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
           if (error(FileNameOrErr.getError()))
             return;
           StringRef SymName = I->getName();
-          outs() << SymName << " in " << FileNameOrErr.get() << "\n";
+          out() << SymName << " in " << FileNameOrErr.get() << "\n";
         }
-        outs() << "\n";
+        out() << "\n";
       }
     }
 
@@ -1124,12 +1145,12 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
         if (!checkMachOAndArchFlags(O, Filename))
           return;
         if (!PrintFileName) {
-          outs() << "\n";
+          out() << "\n";
           if (isa<MachOObjectFile>(O)) {
-            outs() << Filename << "(" << O->getFileName() << ")";
+            out() << Filename << "(" << O->getFileName() << ")";
           } else
-            outs() << O->getFileName();
-          outs() << ":\n";
+            out() << O->getFileName();
+          out() << ":\n";
         }
         dumpSymbolNamesFromObject(*O, false, Filename);
       }
@@ -1160,7 +1181,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                 if (PrintFileName)
                   ArchitectureName = I->getArchTypeName();
                 else
-                  outs() << "\n" << Obj.getFileName() << " (for architecture "
+                  out() << "\n" << Obj.getFileName() << " (for architecture "
                          << I->getArchTypeName() << ")"
                          << ":\n";
               }
@@ -1197,13 +1218,13 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                     if (ArchFlags.size() > 1)
                       ArchitectureName = I->getArchTypeName();
                   } else {
-                    outs() << "\n" << A->getFileName();
-                    outs() << "(" << O->getFileName() << ")";
+                    out() << "\n" << A->getFileName();
+                    out() << "(" << O->getFileName() << ")";
                     if (ArchFlags.size() > 1) {
-                      outs() << " (for architecture " << I->getArchTypeName()
+                      out() << " (for architecture " << I->getArchTypeName()
                              << ")";
                     }
-                    outs() << ":\n";
+                    out() << ":\n";
                   }
                   dumpSymbolNamesFromObject(*O, false, ArchiveName,
                                             ArchitectureName);
@@ -1266,7 +1287,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                 if (PrintFileName)
                   ArchiveName = A->getFileName();
                 else
-                  outs() << "\n" << A->getFileName() << "(" << O->getFileName()
+                  out() << "\n" << A->getFileName() << "(" << O->getFileName()
                          << ")"
                          << ":\n";
                 dumpSymbolNamesFromObject(*O, false, ArchiveName);
@@ -1301,11 +1322,11 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
             ArchitectureName = I->getArchTypeName();
         } else {
           if (moreThanOneArch)
-            outs() << "\n";
-          outs() << Obj.getFileName();
+            out() << "\n";
+          out() << Obj.getFileName();
           if (isa<MachOObjectFile>(Obj) && moreThanOneArch)
-            outs() << " (for architecture " << I->getArchTypeName() << ")";
-          outs() << ":\n";
+            out() << " (for architecture " << I->getArchTypeName() << ")";
+          out() << ":\n";
         }
         dumpSymbolNamesFromObject(Obj, false, ArchiveName, ArchitectureName);
       } else if (auto E = isNotObjectErrorInvalidFileType(
@@ -1336,15 +1357,15 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
               if (isa<MachOObjectFile>(O) && moreThanOneArch)
                 ArchitectureName = I->getArchTypeName();
             } else {
-              outs() << "\n" << A->getFileName();
+              out() << "\n" << A->getFileName();
               if (isa<MachOObjectFile>(O)) {
-                outs() << "(" << O->getFileName() << ")";
+                out() << "(" << O->getFileName() << ")";
                 if (moreThanOneArch)
-                  outs() << " (for architecture " << I->getArchTypeName()
+                  out() << " (for architecture " << I->getArchTypeName()
                          << ")";
               } else
-                outs() << ":" << O->getFileName();
-              outs() << ":\n";
+                out() << ":" << O->getFileName();
+              out() << ":\n";
             }
             dumpSymbolNamesFromObject(*O, false, ArchiveName, ArchitectureName);
           }
@@ -1366,6 +1387,41 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
   }
 }
 
+/// Read the inputs on NumThreads threads and print their output in input
+/// order. At most 2 * NumThreads inputs are in flight, so the buffered output
+/// stays bounded however many inputs there are.
+static void dumpSymbolNamesInParallel() {
+  struct InputOutput {
+    std::string Out;
+    std::string Err;
+  };
+  size_t NumInputs = InputFilenames.size();
+  std::vector<InputOutput> Outputs(NumInputs);
+  std::vector<std::shared_future<void>> Done(NumInputs);
+  ThreadPool Pool(NumThreads);
+  size_t Window = 2 * NumThreads;
+  size_t Next = 0;
+  for (size_t I = 0; I != NumInputs; ++I) {
+    for (; Next != NumInputs && Next < I + Window; ++Next) {
+      size_t J = Next;
+      Done[J] = Pool.async([&Outputs, J] {
+        raw_string_ostream OS(Outputs[J].Out);
+        raw_string_ostream ES(Outputs[J].Err);
+        OutputStream = &OS;
+        ErrorStream = &ES;
+        dumpSymbolNamesFromFile(InputFilenames[J]);
+        OutputStream = nullptr;
+        ErrorStream = nullptr;
+      });
+    }
+    Done[I].wait();
+    outs() << Outputs[I].Out;
+    outs().flush();
+    errs() << Outputs[I].Err;
+    Outputs[I] = InputOutput();
+  }
+}
+
 int main(int argc, char **argv) {
   // Print a stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal(argv[0]);
@@ -1417,8 +1473,11 @@ int main(int argc, char **argv) {
     error("bad number of arguments (must be two arguments)",
           "for the -s option");
 
-  std::for_each(InputFilenames.begin(), InputFilenames.end(),
-                dumpSymbolNamesFromFile);
+  if (NumThreads > 1 && InputFilenames.size() > 1)
+    dumpSymbolNamesInParallel();
+  else
+    std::for_each(InputFilenames.begin(), InputFilenames.end(),
+                  dumpSymbolNamesFromFile);
 
   if (HadError)
     return 1;
@@ -54,6 +54,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
@@ -183,6 +184,17 @@ cl::opt<bool>
 cl::opt<bool> PrintFaultMaps("fault-map-section",
                              cl::desc("Display contents of faultmap section"));
 
+static cl::opt<unsigned>
+NumThreads("num-threads",
+           cl::desc("Number of threads to disassemble with "
+                    "(0 = number of cores)"),
+           cl::value_desc("n"), cl::init(0));
+
+static cl::opt<unsigned> DisassemblyChunkSize(
+    "disassemble-chunk-size", cl::Hidden, cl::init(1 << 16),
+    cl::desc("Minimum number of bytes of a section to disassemble as one "
+             "unit of parallel work"));
+
 cl::opt<DIDumpType> llvm::DwarfDumpType(
     "dwarf", cl::init(DIDT_Null), cl::desc("Dump of dwarf debug sections:"),
     cl::values(clEnumValN(DIDT_Frames, "frames", ".debug_frame"),
@@ -985,6 +997,15 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   IP->setPrintImmHex(PrintImmHex);
   PrettyPrinter &PIP = selectPrettyPrinter(Triple(TripleName));
 
+  // Large sections are split into chunks that are disassembled concurrently,
+  // each with a disassembler and printer of its own.
+  unsigned Threads = NumThreads;
+  if (Threads == 0)
+    Threads = std::thread::hardware_concurrency();
+  std::unique_ptr<ThreadPool> Pool;
+  if (Threads > 1)
+    Pool = llvm::make_unique<ThreadPool>(Threads);
+
   StringRef Fmt = Obj->getBytesInAddress() > 4 ? "\t\t%016" PRIx64 ":  " :
                                                  "\t\t\t%08" PRIx64 ":  ";
 
@@ -1115,181 +1136,258 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
     if (Symbols.empty() || Symbols[0].first != 0)
       Symbols.insert(Symbols.begin(), std::make_pair(SectionAddr, name));
 
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
     StringRef BytesStr;
     error(Section.getContents(BytesStr));
     ArrayRef<uint8_t> Bytes(reinterpret_cast<const uint8_t *>(BytesStr.data()),
                             BytesStr.size());
 
-    uint64_t Size;
-    uint64_t Index;
-
-    std::vector<RelocationRef>::const_iterator rel_cur = Rels.begin();
-    std::vector<RelocationRef>::const_iterator rel_end = Rels.end();
-    // Disassemble symbol by symbol.
-    for (unsigned si = 0, se = Symbols.size(); si != se; ++si) {
-
-      uint64_t Start = Symbols[si].first - SectionAddr;
-      // The end is either the section end or the beginning of the next
-      // symbol.
-      uint64_t End =
-          (si == se - 1) ? SectSize : Symbols[si + 1].first - SectionAddr;
-      // Don't try to disassemble beyond the end of section contents.
-      if (End > SectSize)
-        End = SectSize;
-      // If this symbol has the same address as the next symbol, then skip it.
-      if (Start >= End)
-        continue;
-
-      if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
-        // make size 4 bytes folded
-        End = Start + ((End - Start) & ~0x3ull);
-        Start += 256; // add sizeof(amd_kernel_code_t)
-        // cut trailing zeroes - up to 256 bytes (align)
-        const uint64_t EndAlign = 256;
-        const auto Limit = End - (std::min)(EndAlign, End - Start);
-        while (End > Limit &&
-          *reinterpret_cast<const support::ulittle32_t*>(&Bytes[End - 4]) == 0)
-          End -= 4;
-      }
+    // Disassemble the symbols [SymBegin, SymEnd) into OS, printing the
+    // relocations in [RelBegin, RelEnd) along the way.
+    typedef std::vector<RelocationRef>::const_iterator RelocIter;
+    auto DisassembleSymbols = [&](unsigned SymBegin, unsigned SymEnd,
+                                  RelocIter RelBegin, RelocIter RelEnd,
+                                  MCDisassembler &DisAsm, MCInstPrinter &IP,
+                                  raw_ostream &OS) {
+      SmallString<40> Comments;
+      raw_svector_ostream CommentStream(Comments);
+
+      uint64_t Size;
+      uint64_t Index;
+
+      RelocIter rel_cur = RelBegin;
+      RelocIter rel_end = RelEnd;
+      // Disassemble symbol by symbol.
+      for (unsigned si = SymBegin, se = Symbols.size(); si != SymEnd; ++si) {
+
+        uint64_t Start = Symbols[si].first - SectionAddr;
+        // The end is either the section end or the beginning of the next
+        // symbol.
+        uint64_t End =
+            (si == se - 1) ? SectSize : Symbols[si + 1].first - SectionAddr;
+        // Don't try to disassemble beyond the end of section contents.
+        if (End > SectSize)
+          End = SectSize;
+        // If this symbol has the same address as the next symbol, then skip it.
+        if (Start >= End)
+          continue;
+
+        if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
+          // make size 4 bytes folded
+          End = Start + ((End - Start) & ~0x3ull);
+          Start += 256; // add sizeof(amd_kernel_code_t)
+          // cut trailing zeroes - up to 256 bytes (align)
+          const uint64_t EndAlign = 256;
+          const auto Limit = End - (std::min)(EndAlign, End - Start);
+          while (End > Limit &&
+                 *reinterpret_cast<const support::ulittle32_t *>(
+                     &Bytes[End - 4]) == 0)
+            End -= 4;
+        }
 
-      outs() << '\n' << Symbols[si].second << ":\n";
+        OS << '\n' << Symbols[si].second << ":\n";
 
 #ifndef NDEBUG
-      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
+        raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
 #else
-      raw_ostream &DebugOut = nulls();
+        raw_ostream &DebugOut = nulls();
 #endif
 
-      for (Index = Start; Index < End; Index += Size) {
-        MCInst Inst;
-
-        // AArch64 ELF binaries can interleave data and text in the
-        // same section. We rely on the markers introduced to
-        // understand what we need to dump.
-        if (Obj->isELF() && Obj->getArch() == Triple::aarch64) {
-          uint64_t Stride = 0;
-
-          auto DAI = std::lower_bound(DataMappingSymsAddr.begin(),
-                                      DataMappingSymsAddr.end(), Index);
-          if (DAI != DataMappingSymsAddr.end() && *DAI == Index) {
-            // Switch to data.
-            while (Index < End) {
-              outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-              outs() << "\t";
-              if (Index + 4 <= End) {
-                Stride = 4;
-                dumpBytes(Bytes.slice(Index, 4), outs());
-                outs() << "\t.word";
-              } else if (Index + 2 <= End) {
-                Stride = 2;
-                dumpBytes(Bytes.slice(Index, 2), outs());
-                outs() << "\t.short";
-              } else {
-                Stride = 1;
-                dumpBytes(Bytes.slice(Index, 1), outs());
-                outs() << "\t.byte";
+        for (Index = Start; Index < End; Index += Size) {
+          MCInst Inst;
+
+          // AArch64 ELF binaries can interleave data and text in the
+          // same section. We rely on the markers introduced to
+          // understand what we need to dump.
+          if (Obj->isELF() && Obj->getArch() == Triple::aarch64) {
+            uint64_t Stride = 0;
+
+            auto DAI = std::lower_bound(DataMappingSymsAddr.begin(),
+                                        DataMappingSymsAddr.end(), Index);
+            if (DAI != DataMappingSymsAddr.end() && *DAI == Index) {
+              // Switch to data.
+              while (Index < End) {
+                OS << format("%8" PRIx64 ":", SectionAddr + Index);
+                OS << "\t";
+                if (Index + 4 <= End) {
+                  Stride = 4;
+                  dumpBytes(Bytes.slice(Index, 4), OS);
+                  OS << "\t.word";
+                } else if (Index + 2 <= End) {
+                  Stride = 2;
+                  dumpBytes(Bytes.slice(Index, 2), OS);
+                  OS << "\t.short";
+                } else {
+                  Stride = 1;
+                  dumpBytes(Bytes.slice(Index, 1), OS);
+                  OS << "\t.byte";
+                }
+                Index += Stride;
+                OS << "\n";
+                auto TAI = std::lower_bound(TextMappingSymsAddr.begin(),
+                                            TextMappingSymsAddr.end(), Index);
+                if (TAI != TextMappingSymsAddr.end() && *TAI == Index)
+                  break;
               }
-              Index += Stride;
-              outs() << "\n";
-              auto TAI = std::lower_bound(TextMappingSymsAddr.begin(),
-                                          TextMappingSymsAddr.end(), Index);
-              if (TAI != TextMappingSymsAddr.end() && *TAI == Index)
-                break;
             }
           }
-        }
 
-        if (Index >= End)
-          break;
-
-        bool Disassembled = DisAsm->getInstruction(Inst, Size, Bytes.slice(Index),
-                                                   SectionAddr + Index, DebugOut,
-                                                   CommentStream);
-        if (Size == 0)
-          Size = 1;
-        PIP.printInst(*IP, Disassembled ? &Inst : nullptr,
-                      Bytes.slice(Index, Size),
-                      SectionAddr + Index, outs(), "", *STI);
-        outs() << CommentStream.str();
-        Comments.clear();
-
-        // Try to resolve the target of a call, tail call, etc. to a specific
-        // symbol.
-        if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
-                    MIA->isConditionalBranch(Inst))) {
-          uint64_t Target;
-          if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
-            // In a relocatable object, the target's section must reside in
-            // the same section as the call instruction or it is accessed
-            // through a relocation.
-            //
-            // In a non-relocatable object, the target may be in any section.
-            //
-            // N.B. We don't walk the relocations in the relocatable case yet.
-            auto *TargetSectionSymbols = &Symbols;
-            if (!Obj->isRelocatableObject()) {
-              auto SectionAddress = std::upper_bound(
-                  SectionAddresses.begin(), SectionAddresses.end(), Target,
-                  [](uint64_t LHS,
-                      const std::pair<uint64_t, SectionRef> &RHS) {
-                    return LHS < RHS.first;
-                  });
-              if (SectionAddress != SectionAddresses.begin()) {
-                --SectionAddress;
-                TargetSectionSymbols = &AllSymbols[SectionAddress->second];
-              } else {
+          if (Index >= End)
+            break;
+
+          bool Disassembled = DisAsm.getInstruction(
+              Inst, Size, Bytes.slice(Index), SectionAddr + Index, DebugOut,
+              CommentStream);
+          if (Size == 0)
+            Size = 1;
+          PIP.printInst(IP, Disassembled ? &Inst : nullptr,
+                        Bytes.slice(Index, Size),
+                        SectionAddr + Index, OS, "", *STI);
+          OS << CommentStream.str();
+          Comments.clear();
+
+          // Try to resolve the target of a call, tail call, etc. to a specific
+          // symbol.
+          if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
+                      MIA->isConditionalBranch(Inst))) {
+            uint64_t Target;
+            if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
+              // In a relocatable object, the target's section must reside in
+              // the same section as the call instruction or it is accessed
+              // through a relocation.
+              //
+              // In a non-relocatable object, the target may be in any section.
+              //
+              // N.B. We don't walk the relocations in the relocatable case yet.
+              auto *TargetSectionSymbols = &Symbols;
+              if (!Obj->isRelocatableObject()) {
+                auto SectionAddress = std::upper_bound(
+                    SectionAddresses.begin(), SectionAddresses.end(), Target,
+                    [](uint64_t LHS,
+                        const std::pair<uint64_t, SectionRef> &RHS) {
+                      return LHS < RHS.first;
+                    });
+                // Sections without symbols have no entry; don't add one, as
+                // other threads may be reading the map.
                 TargetSectionSymbols = nullptr;
+                if (SectionAddress != SectionAddresses.begin()) {
+                  --SectionAddress;
+                  auto SecSyms = AllSymbols.find(SectionAddress->second);
+                  if (SecSyms != AllSymbols.end())
+                    TargetSectionSymbols = &SecSyms->second;
+                }
               }
-            }
 
-            // Find the first symbol in the section whose offset is less than
-            // or equal to the target.
-            if (TargetSectionSymbols) {
-              auto TargetSym = std::upper_bound(
-                  TargetSectionSymbols->begin(), TargetSectionSymbols->end(),
-                  Target, [](uint64_t LHS,
-                              const std::pair<uint64_t, StringRef> &RHS) {
-                    return LHS < RHS.first;
-                  });
-              if (TargetSym != TargetSectionSymbols->begin()) {
-                --TargetSym;
-                uint64_t TargetAddress = std::get<0>(*TargetSym);
-                StringRef TargetName = std::get<1>(*TargetSym);
-                outs() << " <" << TargetName;
-                uint64_t Disp = Target - TargetAddress;
-                if (Disp)
-                  outs() << "+0x" << utohexstr(Disp);
-                outs() << '>';
+              // Find the first symbol in the section whose offset is less than
+              // or equal to the target.
+              if (TargetSectionSymbols) {
+                auto TargetSym = std::upper_bound(
+                    TargetSectionSymbols->begin(), TargetSectionSymbols->end(),
+                    Target, [](uint64_t LHS,
+                                const std::pair<uint64_t, StringRef> &RHS) {
+                      return LHS < RHS.first;
+                    });
+                if (TargetSym != TargetSectionSymbols->begin()) {
+                  --TargetSym;
+                  uint64_t TargetAddress = std::get<0>(*TargetSym);
+                  StringRef TargetName = std::get<1>(*TargetSym);
+                  OS << " <" << TargetName;
+                  uint64_t Disp = Target - TargetAddress;
+                  if (Disp)
+                    OS << "+0x" << utohexstr(Disp);
+                  OS << '>';
+                }
               }
             }
           }
+          OS << "\n";
+
+          // Print relocation for instruction.
+          while (rel_cur != rel_end) {
+            bool hidden = getHidden(*rel_cur);
+            uint64_t addr = rel_cur->getOffset();
+            SmallString<16> name;
+            SmallString<32> val;
+
+            // If this relocation is hidden, skip it.
+            if (hidden) goto skip_print_rel;
+
+            // Stop when rel_cur's address is past the current instruction.
+            if (addr >= Index + Size) break;
+            rel_cur->getTypeName(name);
+            error(getRelocationValueString(*rel_cur, val));
+            OS << format(Fmt.data(), SectionAddr + addr) << name
+                   << "\t" << val << "\n";
+
+          skip_print_rel:
+            ++rel_cur;
+          }
         }
-        outs() << "\n";
-
-        // Print relocation for instruction.
-        while (rel_cur != rel_end) {
-          bool hidden = getHidden(*rel_cur);
-          uint64_t addr = rel_cur->getOffset();
-          SmallString<16> name;
-          SmallString<32> val;
-
-          // If this relocation is hidden, skip it.
-          if (hidden) goto skip_print_rel;
-
-          // Stop when rel_cur's address is past the current instruction.
-          if (addr >= Index + Size) break;
-          rel_cur->getTypeName(name);
-          error(getRelocationValueString(*rel_cur, val));
-          outs() << format(Fmt.data(), SectionAddr + addr) << name
-                 << "\t" << val << "\n";
-
-        skip_print_rel:
-          ++rel_cur;
-        }
       }
+    };
+
+    // Split the section into chunks of whole symbols, each starting at least
+    // DisassemblyChunkSize bytes after the previous one, and give each chunk
+    // the relocations from its start up to the next chunk. The chunks don't
+    // depend on the number of threads, so neither does the output.
+    std::vector<unsigned> ChunkStarts(1, 0);
+    uint64_t ChunkStartOffset = Symbols[0].first - SectionAddr;
+    for (unsigned si = 1, se = Symbols.size(); si != se; ++si) {
+      uint64_t Start = Symbols[si].first - SectionAddr;
+      if (Start >= SectSize)
+        break;
+      if (Start >= ChunkStartOffset + DisassemblyChunkSize) {
+        ChunkStarts.push_back(si);
+        ChunkStartOffset = Start;
+      }
+    }
+    unsigned NumChunks = ChunkStarts.size();
+    ChunkStarts.push_back(Symbols.size());
+
+    std::vector<RelocIter> ChunkRels;
+    ChunkRels.push_back(Rels.begin());
+    for (unsigned I = 1; I != NumChunks; ++I) {
+      uint64_t Start = Symbols[ChunkStarts[I]].first - SectionAddr;
+      ChunkRels.push_back(std::lower_bound(
+          ChunkRels.back(), RelocIter(Rels.end()), Start,
+          [](const RelocationRef &R, uint64_t Offset) {
+            return R.getOffset() < Offset;
+          }));
+    }
+    ChunkRels.push_back(Rels.end());
+
+    if (!Pool || NumChunks == 1) {
+      for (unsigned I = 0; I != NumChunks; ++I)
+        DisassembleSymbols(ChunkStarts[I], ChunkStarts[I + 1], ChunkRels[I],
+                           ChunkRels[I + 1], *DisAsm, *IP, outs());
+      continue;
+    }
+
+    // Disassemble a batch of chunks at a time into separate buffers, each
+    // with its own disassembler and printer, and print them in order. This
+    // bounds the output held in memory.
+    unsigned BatchSize = Threads * 4;
+    for (unsigned Batch = 0; Batch < NumChunks; Batch += BatchSize) {
+      unsigned BatchEnd = std::min(Batch + BatchSize, NumChunks);
+      std::vector<std::string> Outputs(BatchEnd - Batch);
+      ThreadPoolTaskGroup TG(*Pool);
+      for (unsigned I = Batch; I != BatchEnd; ++I) {
+        TG.async([&, I] {
+          MCContext ChunkCtx(AsmInfo.get(), MRI.get(), MOFI.get());
+          std::unique_ptr<MCDisassembler> ChunkDisAsm(
+              TheTarget->createMCDisassembler(*STI, ChunkCtx));
+          std::unique_ptr<MCInstPrinter> ChunkIP(
+              TheTarget->createMCInstPrinter(Triple(TripleName),
+                                             AsmPrinterVariant, *AsmInfo,
+                                             *MII, *MRI));
+          ChunkIP->setPrintImmHex(PrintImmHex);
+          raw_string_ostream OS(Outputs[I - Batch]);
+          DisassembleSymbols(ChunkStarts[I], ChunkStarts[I + 1], ChunkRels[I],
+                             ChunkRels[I + 1], *ChunkDisAsm, *ChunkIP, OS);
+        });
+      }
+      TG.wait();
+      for (const std::string &Output : Outputs)
+        outs() << Output;
     }
   }
 }
@@ -27,8 +27,10 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <string>
 #include <system_error>
 
@@ -50,7 +52,9 @@ static cl::opt<OutputFormatTy> OutputFormatShort(
                clEnumValN(darwin, "m", "Darwin -m format"), clEnumValEnd),
     cl::init(berkeley));
 
-static bool BerkeleyHeaderPrinted = false;
+/// Whether the Berkeley format header has been printed. Each worker thread
+/// tracks this for the input it is processing; see printBerkeleyHeader.
+static LLVM_THREAD_LOCAL bool BerkeleyHeaderPrinted = false;
 static bool MoreThanOneFile = false;
 
 cl::opt<bool>
@@ -84,25 +88,51 @@ RadixShort(cl::desc("Print size in radix:"),
 static cl::list<std::string>
 InputFilenames(cl::Positional, cl::desc("<input files>"), cl::ZeroOrMore);
 
-bool HadError = false;
+static cl::opt<unsigned>
+NumThreads("num-threads",
+           cl::desc("Read up to <n> input files at once; the output is still "
+                    "printed in input order"),
+           cl::value_desc("n"), cl::init(1));
+
+std::atomic<bool> HadError(false);
 
 static std::string ToolName;
 
+/// When inputs are read on several threads, each one prints into buffers
+/// that are written out in input order once it is done. The Berkeley header
+/// is kept apart so that only the first input to print sizes prints it.
+static LLVM_THREAD_LOCAL raw_ostream *OutputStream = nullptr;
+static LLVM_THREAD_LOCAL raw_ostream *ErrorStream = nullptr;
+static LLVM_THREAD_LOCAL std::string *HeaderBuffer = nullptr;
+
+static raw_ostream &out() { return OutputStream ? *OutputStream : outs(); }
+static raw_ostream &err() { return ErrorStream ? *ErrorStream : errs(); }
+
+static void printBerkeleyHeader(const Twine &Header) {
+  if (BerkeleyHeaderPrinted)
+    return;
+  if (HeaderBuffer)
+    *HeaderBuffer = Header.str();
+  else
+    out() << Header;
+  BerkeleyHeaderPrinted = true;
+}
+
 /// If ec is not success, print the error and return true.
 static bool error(std::error_code ec) {
   if (!ec)
     return false;
 
   HadError = true;
-  errs() << ToolName << ": error reading file: " << ec.message() << ".\n";
-  errs().flush();
+  err() << ToolName << ": error reading file: " << ec.message() << ".\n";
+  err().flush();
   return true;
 }
 
 static bool error(Twine Message) {
   HadError = true;
-  errs() << ToolName << ": " << Message << ".\n";
-  errs().flush();
+  err() << ToolName << ": " << Message << ".\n";
+  err().flush();
   return true;
 }
 
@@ -112,25 +142,25 @@ static bool error(Twine Message) {
 static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
                   StringRef ArchitectureName = StringRef()) {
   HadError = true;
-  errs() << ToolName << ": " << FileName;
+  err() << ToolName << ": " << FileName;
 
   ErrorOr<StringRef> NameOrErr = C.getName();
   // TODO: if we have a error getting the name then it would be nice to print
   // the index of which archive member this is and or its offset in the
   // archive instead of "???" as the name.
   if (NameOrErr.getError())
-    errs() << "(" << "???" << ")";
+    err() << "(" << "???" << ")";
   else
-    errs() << "(" << NameOrErr.get() << ")";
+    err() << "(" << NameOrErr.get() << ")";
 
   if (!ArchitectureName.empty())
-    errs() << " (for architecture " << ArchitectureName << ") ";
+    err() << " (for architecture " << ArchitectureName << ") ";
 
   std::string Buf;
   raw_string_ostream OS(Buf);
   logAllUnhandledErrors(std::move(E), OS, "");
   OS.flush();
-  errs() << " " << Buf << "\n";
+  err() << " " << Buf << "\n";
 }
 
 // This version of error() prints the file name and which architecture slice it // is from, for example: "foo.o (for architecture i386)" after the ToolName
@@ -139,16 +169,16 @@ static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
 static void error(llvm::Error E, StringRef FileName,
                   StringRef ArchitectureName = StringRef()) {
   HadError = true;
-  errs() << ToolName << ": " << FileName;
+  err() << ToolName << ": " << FileName;
 
   if (!ArchitectureName.empty())
-    errs() << " (for architecture " << ArchitectureName << ") ";
+    err() << " (for architecture " << ArchitectureName << ") ";
 
   std::string Buf;
   raw_string_ostream OS(Buf);
   logAllUnhandledErrors(std::move(E), OS, "");
   OS.flush();
-  errs() << " " << Buf << "\n";
+  err() << " " << Buf << "\n";
 }
 
 /// Get the length of the string that represents @p num in Radix including the
@@ -215,61 +245,61 @@ static void printDarwinSectionSizes(MachOObjectFile *MachO) {
   for (const auto &Load : MachO->load_commands()) {
     if (Load.C.cmd == MachO::LC_SEGMENT_64) {
       MachO::segment_command_64 Seg = MachO->getSegment64LoadCommand(Load);
-      outs() << "Segment " << Seg.segname << ": "
+      out() << "Segment " << Seg.segname << ": "
              << format(fmt.str().c_str(), Seg.vmsize);
       if (DarwinLongFormat)
-        outs() << " (vmaddr 0x" << format("%" PRIx64, Seg.vmaddr) << " fileoff "
+        out() << " (vmaddr 0x" << format("%" PRIx64, Seg.vmaddr) << " fileoff "
                << Seg.fileoff << ")";
-      outs() << "\n";
+      out() << "\n";
       total += Seg.vmsize;
       uint64_t sec_total = 0;
       for (unsigned J = 0; J < Seg.nsects; ++J) {
         MachO::section_64 Sec = MachO->getSection64(Load, J);
         if (Filetype == MachO::MH_OBJECT)
-          outs() << "\tSection (" << format("%.16s", &Sec.segname) << ", "
+          out() << "\tSection (" << format("%.16s", &Sec.segname) << ", "
                  << format("%.16s", &Sec.sectname) << "): ";
         else
-          outs() << "\tSection " << format("%.16s", &Sec.sectname) << ": ";
-        outs() << format(fmt.str().c_str(), Sec.size);
+          out() << "\tSection " << format("%.16s", &Sec.sectname) << ": ";
+        out() << format(fmt.str().c_str(), Sec.size);
         if (DarwinLongFormat)
-          outs() << " (addr 0x" << format("%" PRIx64, Sec.addr) << " offset "
+          out() << " (addr 0x" << format("%" PRIx64, Sec.addr) << " offset "
                  << Sec.offset << ")";
-        outs() << "\n";
+        out() << "\n";
         sec_total += Sec.size;
       }
       if (Seg.nsects != 0)
-        outs() << "\ttotal " << format(fmt.str().c_str(), sec_total) << "\n";
+        out() << "\ttotal " << format(fmt.str().c_str(), sec_total) << "\n";
     } else if (Load.C.cmd == MachO::LC_SEGMENT) {
       MachO::segment_command Seg = MachO->getSegmentLoadCommand(Load);
       uint64_t Seg_vmsize = Seg.vmsize;
-      outs() << "Segment " << Seg.segname << ": "
+      out() << "Segment " << Seg.segname << ": "
              << format(fmt.str().c_str(), Seg_vmsize);
       if (DarwinLongFormat)
-        outs() << " (vmaddr 0x" << format("%" PRIx32, Seg.vmaddr) << " fileoff "
+        out() << " (vmaddr 0x" << format("%" PRIx32, Seg.vmaddr) << " fileoff "
                << Seg.fileoff << ")";
-      outs() << "\n";
+      out() << "\n";
       total += Seg.vmsize;
       uint64_t sec_total = 0;
       for (unsigned J = 0; J < Seg.nsects; ++J) {
         MachO::section Sec = MachO->getSection(Load, J);
         if (Filetype == MachO::MH_OBJECT)
-          outs() << "\tSection (" << format("%.16s", &Sec.segname) << ", "
+          out() << "\tSection (" << format("%.16s", &Sec.segname) << ", "
                  << format("%.16s", &Sec.sectname) << "): ";
         else
-          outs() << "\tSection " << format("%.16s", &Sec.sectname) << ": ";
+          out() << "\tSection " << format("%.16s", &Sec.sectname) << ": ";
         uint64_t Sec_size = Sec.size;
-        outs() << format(fmt.str().c_str(), Sec_size);
+        out() << format(fmt.str().c_str(), Sec_size);
         if (DarwinLongFormat)
-          outs() << " (addr 0x" << format("%" PRIx32, Sec.addr) << " offset "
+          out() << " (addr 0x" << format("%" PRIx32, Sec.addr) << " offset "
                  << Sec.offset << ")";
-        outs() << "\n";
+        out() << "\n";
         sec_total += Sec.size;
       }
       if (Seg.nsects != 0)
-        outs() << "\ttotal " << format(fmt.str().c_str(), sec_total) << "\n";
+        out() << "\ttotal " << format(fmt.str().c_str(), sec_total) << "\n";
     }
   }
-  outs() << "total " << format(fmt.str().c_str(), total) << "\n";
+  out() << "total " << format(fmt.str().c_str(), total) << "\n";
 }
 
 /// Print the summary sizes of the standard Mach-O segments in @p MachO.
@@ -338,11 +368,8 @@ static void printDarwinSegmentSizes(MachOObjectFile *MachO) {
   }
   uint64_t total = total_text + total_data + total_objc + total_others;
 
-  if (!BerkeleyHeaderPrinted) {
-    outs() << "__TEXT\t__DATA\t__OBJC\tothers\tdec\thex\n";
-    BerkeleyHeaderPrinted = true;
-  }
-  outs() << total_text << "\t" << total_data << "\t" << total_objc << "\t"
+  printBerkeleyHeader("__TEXT\t__DATA\t__OBJC\tothers\tdec\thex\n");
+  out() << total_text << "\t" << total_data << "\t" << total_objc << "\t"
          << total_others << "\t" << total << "\t" << format("%" PRIx64, total)
          << "\t";
 }
@@ -398,7 +425,7 @@ static void printObjectSectionSizes(ObjectFile *Obj) {
         << "%" << max_addr_len << "s\n";
 
     // Print header
-    outs() << format(fmt.str().c_str(), static_cast<const char *>("section"),
+    out() << format(fmt.str().c_str(), static_cast<const char *>("section"),
                      static_cast<const char *>("size"),
                      static_cast<const char *>("addr"));
     fmtbuf.clear();
@@ -419,13 +446,13 @@ static void printObjectSectionSizes(ObjectFile *Obj) {
       uint64_t addr = Section.getAddress();
       std::string namestr = name;
 
-      outs() << format(fmt.str().c_str(), namestr.c_str(), size, addr);
+      out() << format(fmt.str().c_str(), namestr.c_str(), size, addr);
     }
 
     if (ELFCommons) {
       uint64_t CommonSize = getCommonSize(Obj);
       total += CommonSize;
-      outs() << format(fmt.str().c_str(), std::string("*COM*").c_str(),
+      out() << format(fmt.str().c_str(), std::string("*COM*").c_str(),
                        CommonSize, static_cast<uint64_t>(0));
     }
 
@@ -433,7 +460,7 @@ static void printObjectSectionSizes(ObjectFile *Obj) {
     fmtbuf.clear();
     fmt << "%-" << max_name_len << "s "
         << "%#" << max_size_len << radix_fmt << "\n";
-    outs() << format(fmt.str().c_str(), static_cast<const char *>("Total"),
+    out() << format(fmt.str().c_str(), static_cast<const char *>("Total"),
                      total);
   } else {
     // The Berkeley format does not display individual section sizes. It
@@ -461,21 +488,19 @@ static void printObjectSectionSizes(ObjectFile *Obj) {
 
     total = total_text + total_data + total_bss;
 
-    if (!BerkeleyHeaderPrinted) {
-      outs() << "   text    data     bss     "
-             << (Radix == octal ? "oct" : "dec") << "     hex filename\n";
-      BerkeleyHeaderPrinted = true;
-    }
+    printBerkeleyHeader(Twine("   text    data     bss     ") +
+                        (Radix == octal ? "oct" : "dec") +
+                        "     hex filename\n");
 
     // Print result.
     fmt << "%#7" << radix_fmt << " "
         << "%#7" << radix_fmt << " "
         << "%#7" << radix_fmt << " ";
-    outs() << format(fmt.str().c_str(), total_text, total_data, total_bss);
+    out() << format(fmt.str().c_str(), total_text, total_data, total_bss);
     fmtbuf.clear();
     fmt << "%7" << (Radix == octal ? PRIo64 : PRIu64) << " "
         << "%7" PRIx64 " ";
-    outs() << format(fmt.str().c_str(), total, total);
+    out() << format(fmt.str().c_str(), total, total);
   }
 }
 
@@ -505,7 +530,7 @@ static bool checkMachOAndArchFlags(ObjectFile *o, StringRef file) {
       break;
     }
     if (!ArchFound) {
-      errs() << ToolName << ": file: " << file
+      err() << ToolName << ": file: " << file
              << " does not contain architecture: " << ArchFlags[i] << ".\n";
       return false;
     }
@@ -543,15 +568,15 @@ static void printFileSectionSizes(StringRef file) {
         if (!checkMachOAndArchFlags(o, file))
           return;
         if (OutputFormat == sysv)
-          outs() << o->getFileName() << "   (ex " << a->getFileName() << "):\n";
+          out() << o->getFileName() << "   (ex " << a->getFileName() << "):\n";
         else if (MachO && OutputFormat == darwin)
-          outs() << a->getFileName() << "(" << o->getFileName() << "):\n";
+          out() << a->getFileName() << "(" << o->getFileName() << "):\n";
         printObjectSectionSizes(o);
         if (OutputFormat == berkeley) {
           if (MachO)
-            outs() << a->getFileName() << "(" << o->getFileName() << ")\n";
+            out() << a->getFileName() << "(" << o->getFileName() << ")\n";
           else
-            outs() << o->getFileName() << " (ex " << a->getFileName() << ")\n";
+            out() << o->getFileName() << " (ex " << a->getFileName() << ")\n";
         }
       }
     }
@@ -573,18 +598,18 @@ static void printFileSectionSizes(StringRef file) {
               if (ObjectFile *o = dyn_cast<ObjectFile>(&*UO.get())) {
                 MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(o);
                 if (OutputFormat == sysv)
-                  outs() << o->getFileName() << "  :\n";
+                  out() << o->getFileName() << "  :\n";
                 else if (MachO && OutputFormat == darwin) {
                   if (MoreThanOneFile || ArchFlags.size() > 1)
-                    outs() << o->getFileName() << " (for architecture "
+                    out() << o->getFileName() << " (for architecture "
                            << I->getArchTypeName() << "): \n";
                 }
                 printObjectSectionSizes(o);
                 if (OutputFormat == berkeley) {
                   if (!MachO || MoreThanOneFile || ArchFlags.size() > 1)
-                    outs() << o->getFileName() << " (for architecture "
+                    out() << o->getFileName() << " (for architecture "
                            << I->getArchTypeName() << ")";
-                  outs() << "\n";
+                  out() << "\n";
                 }
               }
             } else if (auto E = isNotObjectErrorInvalidFileType(
@@ -615,24 +640,24 @@ static void printFileSectionSizes(StringRef file) {
                 if (ObjectFile *o = dyn_cast<ObjectFile>(&*ChildOrErr.get())) {
                   MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(o);
                   if (OutputFormat == sysv)
-                    outs() << o->getFileName() << "   (ex " << UA->getFileName()
+                    out() << o->getFileName() << "   (ex " << UA->getFileName()
                            << "):\n";
                   else if (MachO && OutputFormat == darwin)
-                    outs() << UA->getFileName() << "(" << o->getFileName()
+                    out() << UA->getFileName() << "(" << o->getFileName()
                            << ")"
                            << " (for architecture " << I->getArchTypeName()
                            << "):\n";
                   printObjectSectionSizes(o);
                   if (OutputFormat == berkeley) {
                     if (MachO) {
-                      outs() << UA->getFileName() << "(" << o->getFileName()
+                      out() << UA->getFileName() << "(" << o->getFileName()
                              << ")";
                       if (ArchFlags.size() > 1)
-                        outs() << " (for architecture " << I->getArchTypeName()
+                        out() << " (for architecture " << I->getArchTypeName()
                                << ")";
-                      outs() << "\n";
+                      out() << "\n";
                     } else
-                      outs() << o->getFileName() << " (ex " << UA->getFileName()
+                      out() << o->getFileName() << " (ex " << UA->getFileName()
                              << ")\n";
                   }
                 }
@@ -646,7 +671,7 @@ static void printFileSectionSizes(StringRef file) {
           }
         }
         if (!ArchFound) {
-          errs() << ToolName << ": file: " << file
+          err() << ToolName << ": file: " << file
                  << " does not contain architecture" << ArchFlags[i] << ".\n";
           return;
         }
@@ -666,18 +691,18 @@ static void printFileSectionSizes(StringRef file) {
             if (ObjectFile *o = dyn_cast<ObjectFile>(&*UO.get())) {
               MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(o);
               if (OutputFormat == sysv)
-                outs() << o->getFileName() << "  :\n";
+                out() << o->getFileName() << "  :\n";
               else if (MachO && OutputFormat == darwin) {
                 if (MoreThanOneFile)
-                  outs() << o->getFileName() << " (for architecture "
+                  out() << o->getFileName() << " (for architecture "
                          << I->getArchTypeName() << "):\n";
               }
               printObjectSectionSizes(o);
               if (OutputFormat == berkeley) {
                 if (!MachO || MoreThanOneFile)
-                  outs() << o->getFileName() << " (for architecture "
+                  out() << o->getFileName() << " (for architecture "
                          << I->getArchTypeName() << ")";
-                outs() << "\n";
+                out() << "\n";
               }
             }
           } else if (auto E = isNotObjectErrorInvalidFileType(UO.takeError())) {
@@ -704,19 +729,19 @@ static void printFileSectionSizes(StringRef file) {
               if (ObjectFile *o = dyn_cast<ObjectFile>(&*ChildOrErr.get())) {
                 MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(o);
                 if (OutputFormat == sysv)
-                  outs() << o->getFileName() << "   (ex " << UA->getFileName()
+                  out() << o->getFileName() << "   (ex " << UA->getFileName()
                          << "):\n";
                 else if (MachO && OutputFormat == darwin)
-                  outs() << UA->getFileName() << "(" << o->getFileName() << ")"
+                  out() << UA->getFileName() << "(" << o->getFileName() << ")"
                          << " (for architecture " << I->getArchTypeName()
                          << "):\n";
                 printObjectSectionSizes(o);
                 if (OutputFormat == berkeley) {
                   if (MachO)
-                    outs() << UA->getFileName() << "(" << o->getFileName()
+                    out() << UA->getFileName() << "(" << o->getFileName()
                            << ")\n";
                   else
-                    outs() << o->getFileName() << " (ex " << UA->getFileName()
+                    out() << o->getFileName() << " (ex " << UA->getFileName()
                            << ")\n";
                 }
               }
@@ -742,19 +767,19 @@ static void printFileSectionSizes(StringRef file) {
         if (ObjectFile *o = dyn_cast<ObjectFile>(&*UO.get())) {
           MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(o);
           if (OutputFormat == sysv)
-            outs() << o->getFileName() << "  :\n";
+            out() << o->getFileName() << "  :\n";
           else if (MachO && OutputFormat == darwin) {
             if (MoreThanOneFile || MoreThanOneArch)
-              outs() << o->getFileName() << " (for architecture "
+              out() << o->getFileName() << " (for architecture "
                      << I->getArchTypeName() << "):";
-            outs() << "\n";
+            out() << "\n";
           }
           printObjectSectionSizes(o);
           if (OutputFormat == berkeley) {
             if (!MachO || MoreThanOneFile || MoreThanOneArch)
-              outs() << o->getFileName() << " (for architecture "
+              out() << o->getFileName() << " (for architecture "
                      << I->getArchTypeName() << ")";
-            outs() << "\n";
+            out() << "\n";
           }
         }
       } else if (auto E = isNotObjectErrorInvalidFileType(UO.takeError())) {
@@ -781,19 +806,19 @@ static void printFileSectionSizes(StringRef file) {
           if (ObjectFile *o = dyn_cast<ObjectFile>(&*ChildOrErr.get())) {
             MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(o);
             if (OutputFormat == sysv)
-              outs() << o->getFileName() << "   (ex " << UA->getFileName()
+              out() << o->getFileName() << "   (ex " << UA->getFileName()
                      << "):\n";
             else if (MachO && OutputFormat == darwin)
-              outs() << UA->getFileName() << "(" << o->getFileName() << ")"
+              out() << UA->getFileName() << "(" << o->getFileName() << ")"
                      << " (for architecture " << I->getArchTypeName() << "):\n";
             printObjectSectionSizes(o);
             if (OutputFormat == berkeley) {
               if (MachO)
-                outs() << UA->getFileName() << "(" << o->getFileName() << ")"
+                out() << UA->getFileName() << "(" << o->getFileName() << ")"
                        << " (for architecture " << I->getArchTypeName()
                        << ")\n";
               else
-                outs() << o->getFileName() << " (ex " << UA->getFileName()
+                out() << o->getFileName() << " (ex " << UA->getFileName()
                        << ")\n";
             }
           }
@@ -809,21 +834,64 @@ static void printFileSectionSizes(StringRef file) {
     if (!checkMachOAndArchFlags(o, file))
       return;
     if (OutputFormat == sysv)
-      outs() << o->getFileName() << "  :\n";
+      out() << o->getFileName() << "  :\n";
     printObjectSectionSizes(o);
     if (OutputFormat == berkeley) {
       MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(o);
       if (!MachO || MoreThanOneFile)
-        outs() << o->getFileName();
-      outs() << "\n";
+        out() << o->getFileName();
+      out() << "\n";
     }
   } else {
-    errs() << ToolName << ": " << file << ": "
+    err() << ToolName << ": " << file << ": "
            << "Unrecognized file type.\n";
   }
   // System V adds an extra newline at the end of each file.
   if (OutputFormat == sysv)
-    outs() << "\n";
+    out() << "\n";
+}
+
+/// Read the inputs on NumThreads threads and print their output in input
+/// order. At most 2 * NumThreads inputs are in flight, so the buffered output
+/// stays bounded however many inputs there are.
+static void printFileSectionSizesInParallel() {
+  struct InputOutput {
+    std::string Header;
+    std::string Out;
+    std::string Err;
+  };
+  size_t NumInputs = InputFilenames.size();
+  std::vector<InputOutput> Outputs(NumInputs);
+  std::vector<std::shared_future<void>> Done(NumInputs);
+  ThreadPool Pool(NumThreads);
+  size_t Window = 2 * NumThreads;
+  size_t Next = 0;
+  for (size_t I = 0; I != NumInputs; ++I) {
+    for (; Next != NumInputs && Next < I + Window; ++Next) {
+      size_t J = Next;
+      Done[J] = Pool.async([&Outputs, J] {
+        raw_string_ostream OS(Outputs[J].Out);
+        raw_string_ostream ES(Outputs[J].Err);
+        OutputStream = &OS;
+        ErrorStream = &ES;
+        HeaderBuffer = &Outputs[J].Header;
+        BerkeleyHeaderPrinted = false;
+        printFileSectionSizes(InputFilenames[J]);
+        OutputStream = nullptr;
+        ErrorStream = nullptr;
+        HeaderBuffer = nullptr;
+      });
+    }
+    Done[I].wait();
+    if (!Outputs[I].Header.empty() && !BerkeleyHeaderPrinted) {
+      outs() << Outputs[I].Header;
+      BerkeleyHeaderPrinted = true;
+    }
+    outs() << Outputs[I].Out;
+    outs().flush();
+    errs() << Outputs[I].Err;
+    Outputs[I] = InputOutput();
+  }
 }
 
 int main(int argc, char **argv) {
@@ -856,8 +924,11 @@ int main(int argc, char **argv) {
     InputFilenames.push_back("a.out");
 
   MoreThanOneFile = InputFilenames.size() > 1;
-  std::for_each(InputFilenames.begin(), InputFilenames.end(),
-                printFileSectionSizes);
+  if (NumThreads > 1 && InputFilenames.size() > 1)
+    printFileSectionSizesInParallel();
+  else
+    std::for_each(InputFilenames.begin(), InputFilenames.end(),
+                  printFileSectionSizes);
 
   if (HadError)
     return 1;
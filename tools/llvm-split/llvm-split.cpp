@@ -40,6 +40,11 @@ static cl::opt<bool>
     PreserveLocals("preserve-locals", cl::Prefix, cl::init(false),
                    cl::desc("Split without externalizing locals"));
 
+static cl::opt<bool>
+    ClusterCallGraph("cluster-call-graph", cl::init(false),
+                     cl::desc("Keep call graph SCCs together and balance "
+                              "all definitions by size"));
+
 int main(int argc, char **argv) {
   LLVMContext Context;
   SMDiagnostic Err;
@@ -67,7 +72,7 @@ int main(int argc, char **argv) {
 
     // Declare success.
     Out->keep();
-  }, PreserveLocals);
+  }, PreserveLocals, ClusterCallGraph);
 
   return 0;
 }
@@ -86,6 +86,16 @@ static cl::opt<int> ClPrintSourceContextLines(
     "print-source-context-lines", cl::init(0),
     cl::desc("Print N number of source file context"));
 
+static cl::opt<unsigned> ClDWARFThreads(
+    "dwarf-threads", cl::init(1),
+    cl::desc("Number of threads used to index compile units that are not "
+             "described by .debug_aranges"));
+
+static cl::opt<unsigned> ClMaxCachedModules(
+    "max-cached-modules", cl::init(0),
+    cl::desc("Maximum number of modules kept loaded between queries; the "
+             "least recently used module is released first (0 = no limit)"));
+
 template<typename T>
 static bool error(Expected<T> &ResOrErr) {
   if (ResOrErr)
@@ -149,6 +159,8 @@ int main(int argc, char **argv) {
   cl::ParseCommandLineOptions(argc, argv, "llvm-symbolizer\n");
   LLVMSymbolizer::Options Opts(ClPrintFunctions, ClUseSymbolTable, ClDemangle,
                                ClUseRelativeAddress, ClDefaultArch);
+  Opts.DWARFThreads = ClDWARFThreads;
+  Opts.MaxCachedModules = ClMaxCachedModules;
 
   for (const auto &hint : ClDsymHint) {
     if (sys::path::extension(hint) == ".dSYM") {
@@ -24,6 +24,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
 // extra command-line flags needed for LTOCodeGenerator
@@ -61,10 +62,6 @@ static cl::opt<bool> DisableVerify(
 // *** Not thread safe ***
 static std::string sLastErrorString;
 
-// Holds the initialization state of the LTO module.
-// *** Not thread safe ***
-static bool initialized = false;
-
 // Holds the command-line option parsing state of the LTO module.
 static bool parsedOptions = false;
 
@@ -87,7 +84,9 @@ static void diagnosticHandler(const DiagnosticInfo &DI, void *Context) {
 
 // Initialize the configured targets if they have not been initialized.
 static void lto_initialize() {
-  if (!initialized) {
+  // Modules may be created in local contexts from several threads at once.
+  LLVM_DEFINE_ONCE_FLAG(InitializeFlag);
+  llvm::call_once(InitializeFlag, []() {
 #ifdef LLVM_ON_WIN32
     // Dialog box on crash disabling doesn't work across DLL boundaries, so do
     // it here.
@@ -104,8 +103,7 @@ static void lto_initialize() {
     static LLVMContext Context;
     LTOContext = &Context;
     LTOContext->setDiagnosticHandler(diagnosticHandler, nullptr, true);
-    initialized = true;
-  }
+  });
 }
 
 namespace {
@@ -132,6 +130,8 @@ struct LibLTOCodeGenerator : LTOCodeGenerator {
   void init() { setDiagnosticHandler(handleLibLTODiagnostic, nullptr); }
 
   std::unique_ptr<MemoryBuffer> NativeObjectFile;
+  std::vector<std::unique_ptr<MemoryBuffer>> NativeObjectFiles;
+  std::vector<LTOObjectBuffer> NativeObjectBuffers;
   std::unique_ptr<LLVMContext> OwnedContext;
 };
 
@@ -423,6 +423,24 @@ const void *lto_codegen_compile_optimized(lto_code_gen_t cg, size_t *length) {
   return CG->NativeObjectFile->getBufferStart();
 }
 
+const LTOObjectBuffer *lto_codegen_compile_parallel(lto_code_gen_t cg,
+                                                    unsigned int parallelism,
+                                                    unsigned int *num_objects) {
+  maybeParseOptions(cg);
+  LibLTOCodeGenerator *CG = unwrap(cg);
+  CG->NativeObjectBuffers.clear();
+  CG->NativeObjectFiles =
+      CG->compileParallel(parallelism, DisableVerify, DisableInline,
+                          DisableGVNLoadPRE, DisableLTOVectorization);
+  if (CG->NativeObjectFiles.empty())
+    return nullptr;
+  for (auto &MemBuffer : CG->NativeObjectFiles)
+    CG->NativeObjectBuffers.push_back(LTOObjectBuffer{
+        MemBuffer->getBufferStart(), MemBuffer->getBufferSize()});
+  *num_objects = CG->NativeObjectBuffers.size();
+  return CG->NativeObjectBuffers.data();
+}
+
 bool lto_codegen_compile_to_file(lto_code_gen_t cg, const char **name) {
   maybeParseOptions(cg);
   return !unwrap(cg)->compile_to_file(
@@ -534,6 +552,16 @@ void thinlto_codegen_set_final_cache_size_relative_to_available_space(
   return unwrap(cg)->setMaxCacheSizeRelativeToAvailableSpace(Percentage);
 }
 
+void thinlto_codegen_set_cache_size_bytes(thinlto_code_gen_t cg,
+                                          unsigned long long MaxBytes) {
+  return unwrap(cg)->setMaxCacheSizeBytes(MaxBytes);
+}
+
+void thinlto_codegen_set_cache_pruning_in_background(thinlto_code_gen_t cg,
+                                                     lto_bool_t Enable) {
+  return unwrap(cg)->setCachePruningInBackground(Enable);
+}
+
 void thinlto_codegen_set_savetemps_dir(thinlto_code_gen_t cg,
                                        const char *save_temps_dir) {
   return unwrap(cg)->setSaveTempsDir(save_temps_dir);
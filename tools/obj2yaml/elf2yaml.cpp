@@ -19,6 +19,72 @@ using namespace llvm;
 
 namespace {
 
+template <class ELFT> class ELFDumper;
+
+/// The sections of an object. Each one is dumped while the YAML output asks
+/// for it and released once the next one is requested, so that only a single
+/// section, with its relocations, is held in memory at a time.
+template <class ELFT> struct LazySections {
+  typedef typename object::ELFFile<ELFT>::Elf_Shdr Elf_Shdr;
+
+  ELFDumper<ELFT> &Dumper;
+  std::vector<const Elf_Shdr *> Headers;
+  std::unique_ptr<ELFYAML::Section> Current;
+  std::error_code EC;
+
+  LazySections(ELFDumper<ELFT> &Dumper) : Dumper(Dumper) {}
+
+  // Only used by the YAML IO to tell whether the sequence is empty.
+  size_t begin() const { return 0; }
+  size_t end() const { return Headers.size(); }
+};
+
+/// The symbols of one binding, dumped one at a time like the sections.
+template <class ELFT> struct LazySymbols {
+  typedef object::Elf_Sym_Impl<ELFT> Elf_Sym;
+
+  ELFDumper<ELFT> &Dumper;
+  std::vector<const Elf_Sym *> Syms;
+  ELFYAML::Symbol Current;
+  std::error_code EC;
+
+  LazySymbols(ELFDumper<ELFT> &Dumper) : Dumper(Dumper) {}
+
+  size_t begin() const { return 0; }
+  size_t end() const { return Syms.size(); }
+};
+
+template <class ELFT> struct StreamedSymbols {
+  LazySymbols<ELFT> Local;
+  LazySymbols<ELFT> Global;
+  LazySymbols<ELFT> Weak;
+
+  StreamedSymbols(ELFDumper<ELFT> &Dumper)
+      : Local(Dumper), Global(Dumper), Weak(Dumper) {}
+};
+
+/// An object that is written out as the same YAML document as an
+/// ELFYAML::Object, without first building all of its sections and symbols.
+template <class ELFT> struct StreamedObject {
+  /// Only the header is filled in. This is also the IO context, which the
+  /// section mappings use to look up the machine.
+  ELFYAML::Object Object;
+  LazySections<ELFT> Sections;
+  StreamedSymbols<ELFT> Symbols;
+
+  StreamedObject(ELFDumper<ELFT> &Dumper)
+      : Sections(Dumper), Symbols(Dumper) {}
+
+  /// The first error hit while the sections or symbols were dumped.
+  std::error_code getError() const {
+    for (std::error_code EC : {Sections.EC, Symbols.Local.EC, Symbols.Global.EC,
+                               Symbols.Weak.EC})
+      if (EC)
+        return EC;
+    return std::error_code();
+  }
+};
+
 template <class ELFT>
 class ELFDumper {
   typedef object::Elf_Sym_Impl<ELFT> Elf_Sym;
@@ -27,15 +93,16 @@ class ELFDumper {
 
   const object::ELFFile<ELFT> &Obj;
   ArrayRef<Elf_Word> ShndxTable;
+  const Elf_Shdr *Symtab = nullptr;
+  StringRef StrTable;
 
-  std::error_code dumpSymbol(const Elf_Sym *Sym, const Elf_Shdr *SymTab,
-                             StringRef StrTable, ELFYAML::Symbol &S);
   std::error_code dumpCommonSection(const Elf_Shdr *Shdr, ELFYAML::Section &S);
   std::error_code dumpCommonRelocationSection(const Elf_Shdr *Shdr,
                                               ELFYAML::RelocationSection &S);
   template <class RelT>
   std::error_code dumpRelocation(const RelT *Rel, const Elf_Shdr *SymTab,
-                                 ELFYAML::Relocation &R);
+                                 StringRef StrTab, ELFYAML::Relocation &R);
+  ErrorOr<StringRef> getLinkedStringTable(const Elf_Shdr *SymTab);
 
   ErrorOr<ELFYAML::RelocationSection *> dumpRelSection(const Elf_Shdr *Shdr);
   ErrorOr<ELFYAML::RelocationSection *> dumpRelaSection(const Elf_Shdr *Shdr);
@@ -47,31 +114,105 @@ class ELFDumper {
 
 public:
   ELFDumper(const object::ELFFile<ELFT> &O);
-  ErrorOr<ELFYAML::Object *> dump();
+
+  /// Fill in the header of \p Y and collect the sections and symbols to
+  /// be dumped while \p Y is written out.
+  std::error_code dump(StreamedObject<ELFT> &Y);
+  ErrorOr<std::unique_ptr<ELFYAML::Section>> dumpSection(const Elf_Shdr *Shdr);
+  std::error_code dumpSymbol(const Elf_Sym *Sym, ELFYAML::Symbol &S);
 };
 
 }
 
+namespace llvm {
+namespace yaml {
+
+template <class ELFT> struct SequenceTraits<LazySections<ELFT>> {
+  static size_t size(IO &IO, LazySections<ELFT> &Seq) {
+    return Seq.Headers.size();
+  }
+
+  static std::unique_ptr<ELFYAML::Section> &
+  element(IO &IO, LazySections<ELFT> &Seq, size_t Index) {
+    Seq.Current.reset();
+    if (!Seq.EC) {
+      auto SectionOrErr = Seq.Dumper.dumpSection(Seq.Headers[Index]);
+      if (SectionOrErr)
+        Seq.Current = std::move(*SectionOrErr);
+      else
+        Seq.EC = SectionOrErr.getError();
+    }
+    // Once an error is hit, the remaining entries are written as empty
+    // sections and the error is reported after the output is complete.
+    if (!Seq.Current) {
+      auto *S = new ELFYAML::RawContentSection();
+      S->Type = ELF::SHT_NULL;
+      S->Flags = 0;
+      S->Address = 0;
+      S->AddressAlign = 0;
+      S->Size = 0;
+      Seq.Current.reset(S);
+    }
+    return Seq.Current;
+  }
+};
+
+template <class ELFT> struct SequenceTraits<LazySymbols<ELFT>> {
+  static size_t size(IO &IO, LazySymbols<ELFT> &Seq) {
+    return Seq.Syms.size();
+  }
+
+  static ELFYAML::Symbol &element(IO &IO, LazySymbols<ELFT> &Seq,
+                                  size_t Index) {
+    Seq.Current = ELFYAML::Symbol();
+    if (!Seq.EC)
+      Seq.EC = Seq.Dumper.dumpSymbol(Seq.Syms[Index], Seq.Current);
+    return Seq.Current;
+  }
+};
+
+template <class ELFT> struct MappingTraits<StreamedSymbols<ELFT>> {
+  static void mapping(IO &IO, StreamedSymbols<ELFT> &Symbols) {
+    IO.mapOptional("Local", Symbols.Local);
+    IO.mapOptional("Global", Symbols.Global);
+    IO.mapOptional("Weak", Symbols.Weak);
+  }
+};
+
+/// Mirrors MappingTraits<ELFYAML::Object>.
+template <class ELFT> struct MappingTraits<StreamedObject<ELFT>> {
+  static void mapping(IO &IO, StreamedObject<ELFT> &Y) {
+    assert(IO.outputting() && "A streamed object can only be written");
+    IO.setContext(&Y.Object);
+    IO.mapTag("!ELF", true);
+    IO.mapRequired("FileHeader", Y.Object.Header);
+    IO.mapOptional("Sections", Y.Sections);
+    IO.mapOptional("Symbols", Y.Symbols);
+    IO.setContext(nullptr);
+  }
+};
+
+} // end namespace yaml
+} // end namespace llvm
+
 template <class ELFT>
 ELFDumper<ELFT>::ELFDumper(const object::ELFFile<ELFT> &O)
     : Obj(O) {}
 
 template <class ELFT>
-ErrorOr<ELFYAML::Object *> ELFDumper<ELFT>::dump() {
-  auto Y = make_unique<ELFYAML::Object>();
-
+std::error_code ELFDumper<ELFT>::dump(StreamedObject<ELFT> &Y) {
   // Dump header
-  Y->Header.Class = ELFYAML::ELF_ELFCLASS(Obj.getHeader()->getFileClass());
-  Y->Header.Data = ELFYAML::ELF_ELFDATA(Obj.getHeader()->getDataEncoding());
-  Y->Header.OSABI = Obj.getHeader()->e_ident[ELF::EI_OSABI];
-  Y->Header.Type = Obj.getHeader()->e_type;
-  Y->Header.Machine = Obj.getHeader()->e_machine;
-  Y->Header.Flags = Obj.getHeader()->e_flags;
-  Y->Header.Entry = Obj.getHeader()->e_entry;
-
-  const Elf_Shdr *Symtab = nullptr;
-
-  // Dump sections
+  Y.Object.Header.Class =
+      ELFYAML::ELF_ELFCLASS(Obj.getHeader()->getFileClass());
+  Y.Object.Header.Data =
+      ELFYAML::ELF_ELFDATA(Obj.getHeader()->getDataEncoding());
+  Y.Object.Header.OSABI = Obj.getHeader()->e_ident[ELF::EI_OSABI];
+  Y.Object.Header.Type = Obj.getHeader()->e_type;
+  Y.Object.Header.Machine = Obj.getHeader()->e_machine;
+  Y.Object.Header.Flags = Obj.getHeader()->e_flags;
+  Y.Object.Header.Entry = Obj.getHeader()->e_entry;
+
+  // Collect sections
   for (const Elf_Shdr &Sec : Obj.sections()) {
     switch (Sec.sh_type) {
     case ELF::SHT_NULL:
@@ -89,55 +230,19 @@ ErrorOr<ELFYAML::Object *> ELFDumper<ELFT>::dump() {
       ShndxTable = *TableOrErr;
       break;
     }
-    case ELF::SHT_RELA: {
-      ErrorOr<ELFYAML::RelocationSection *> S = dumpRelaSection(&Sec);
-      if (std::error_code EC = S.getError())
-        return EC;
-      Y->Sections.push_back(std::unique_ptr<ELFYAML::Section>(S.get()));
-      break;
-    }
-    case ELF::SHT_REL: {
-      ErrorOr<ELFYAML::RelocationSection *> S = dumpRelSection(&Sec);
-      if (std::error_code EC = S.getError())
-        return EC;
-      Y->Sections.push_back(std::unique_ptr<ELFYAML::Section>(S.get()));
-      break;
-    }
-    case ELF::SHT_GROUP: {
-      ErrorOr<ELFYAML::Group *> G = dumpGroup(&Sec);
-      if (std::error_code EC = G.getError())
-        return EC;
-      Y->Sections.push_back(std::unique_ptr<ELFYAML::Section>(G.get()));
-      break;
-    }
-    case ELF::SHT_MIPS_ABIFLAGS: {
-      ErrorOr<ELFYAML::MipsABIFlags *> G = dumpMipsABIFlags(&Sec);
-      if (std::error_code EC = G.getError())
-        return EC;
-      Y->Sections.push_back(std::unique_ptr<ELFYAML::Section>(G.get()));
-      break;
-    }
-    case ELF::SHT_NOBITS: {
-      ErrorOr<ELFYAML::NoBitsSection *> S = dumpNoBitsSection(&Sec);
-      if (std::error_code EC = S.getError())
-        return EC;
-      Y->Sections.push_back(std::unique_ptr<ELFYAML::Section>(S.get()));
-      break;
-    }
-    default: {
-      ErrorOr<ELFYAML::RawContentSection *> S = dumpContentSection(&Sec);
-      if (std::error_code EC = S.getError())
-        return EC;
-      Y->Sections.push_back(std::unique_ptr<ELFYAML::Section>(S.get()));
-    }
+    default:
+      Y.Sections.Headers.push_back(&Sec);
     }
   }
 
-  // Dump symbols
+  if (!Symtab)
+    return obj2yaml_error::success;
+
+  // Collect symbols
   ErrorOr<StringRef> StrTableOrErr = Obj.getStringTableForSymtab(*Symtab);
   if (std::error_code EC = StrTableOrErr.getError())
     return EC;
-  StringRef StrTable = *StrTableOrErr;
+  StrTable = *StrTableOrErr;
 
   bool IsFirstSym = true;
   for (const Elf_Sym &Sym : Obj.symbols(Symtab)) {
@@ -146,34 +251,55 @@ ErrorOr<ELFYAML::Object *> ELFDumper<ELFT>::dump() {
       continue;
     }
 
-    ELFYAML::Symbol S;
-    if (std::error_code EC =
-            ELFDumper<ELFT>::dumpSymbol(&Sym, Symtab, StrTable, S))
-      return EC;
-
     switch (Sym.getBinding())
     {
     case ELF::STB_LOCAL:
-      Y->Symbols.Local.push_back(S);
+      Y.Symbols.Local.Syms.push_back(&Sym);
       break;
     case ELF::STB_GLOBAL:
-      Y->Symbols.Global.push_back(S);
+      Y.Symbols.Global.Syms.push_back(&Sym);
       break;
     case ELF::STB_WEAK:
-      Y->Symbols.Weak.push_back(S);
+      Y.Symbols.Weak.Syms.push_back(&Sym);
       break;
     default:
       llvm_unreachable("Unknown ELF symbol binding");
     }
   }
 
-  return Y.release();
+  return obj2yaml_error::success;
+}
+
+template <class T>
+static ErrorOr<std::unique_ptr<ELFYAML::Section>>
+takeSection(ErrorOr<T *> SectionOrErr) {
+  if (std::error_code EC = SectionOrErr.getError())
+    return EC;
+  return std::unique_ptr<ELFYAML::Section>(SectionOrErr.get());
 }
 
 template <class ELFT>
-std::error_code
-ELFDumper<ELFT>::dumpSymbol(const Elf_Sym *Sym, const Elf_Shdr *SymTab,
-                            StringRef StrTable, ELFYAML::Symbol &S) {
+ErrorOr<std::unique_ptr<ELFYAML::Section>>
+ELFDumper<ELFT>::dumpSection(const Elf_Shdr *Shdr) {
+  switch (Shdr->sh_type) {
+  case ELF::SHT_RELA:
+    return takeSection(dumpRelaSection(Shdr));
+  case ELF::SHT_REL:
+    return takeSection(dumpRelSection(Shdr));
+  case ELF::SHT_GROUP:
+    return takeSection(dumpGroup(Shdr));
+  case ELF::SHT_MIPS_ABIFLAGS:
+    return takeSection(dumpMipsABIFlags(Shdr));
+  case ELF::SHT_NOBITS:
+    return takeSection(dumpNoBitsSection(Shdr));
+  default:
+    return takeSection(dumpContentSection(Shdr));
+  }
+}
+
+template <class ELFT>
+std::error_code ELFDumper<ELFT>::dumpSymbol(const Elf_Sym *Sym,
+                                            ELFYAML::Symbol &S) {
   S.Type = Sym->getType();
   S.Value = Sym->st_value;
   S.Size = Sym->st_size;
@@ -184,7 +310,7 @@ ELFDumper<ELFT>::dumpSymbol(const Elf_Sym *Sym, const Elf_Shdr *SymTab,
     return errorToErrorCode(SymbolNameOrErr.takeError());
   S.Name = SymbolNameOrErr.get();
 
-  ErrorOr<const Elf_Shdr *> ShdrOrErr = Obj.getSection(Sym, SymTab, ShndxTable);
+  ErrorOr<const Elf_Shdr *> ShdrOrErr = Obj.getSection(Sym, Symtab, ShndxTable);
   if (std::error_code EC = ShdrOrErr.getError())
     return EC;
   const Elf_Shdr *Shdr = *ShdrOrErr;
@@ -203,20 +329,13 @@ template <class ELFT>
 template <class RelT>
 std::error_code ELFDumper<ELFT>::dumpRelocation(const RelT *Rel,
                                                 const Elf_Shdr *SymTab,
+                                                StringRef StrTab,
                                                 ELFYAML::Relocation &R) {
   R.Type = Rel->getType(Obj.isMips64EL());
   R.Offset = Rel->r_offset;
   R.Addend = 0;
 
   const Elf_Sym *Sym = Obj.getRelocationSymbol(Rel, SymTab);
-  ErrorOr<const Elf_Shdr *> StrTabSec = Obj.getSection(SymTab->sh_link);
-  if (std::error_code EC = StrTabSec.getError())
-    return EC;
-  ErrorOr<StringRef> StrTabOrErr = Obj.getStringTable(*StrTabSec);
-  if (std::error_code EC = StrTabOrErr.getError())
-    return EC;
-  StringRef StrTab = *StrTabOrErr;
-
   Expected<StringRef> NameOrErr = Sym->getName(StrTab);
   if (!NameOrErr)
     return errorToErrorCode(NameOrErr.takeError());
@@ -225,6 +344,15 @@ std::error_code ELFDumper<ELFT>::dumpRelocation(const RelT *Rel,
   return obj2yaml_error::success;
 }
 
+template <class ELFT>
+ErrorOr<StringRef>
+ELFDumper<ELFT>::getLinkedStringTable(const Elf_Shdr *SymTab) {
+  ErrorOr<const Elf_Shdr *> StrTabSec = Obj.getSection(SymTab->sh_link);
+  if (std::error_code EC = StrTabSec.getError())
+    return EC;
+  return Obj.getStringTable(*StrTabSec);
+}
+
 template <class ELFT>
 std::error_code ELFDumper<ELFT>::dumpCommonSection(const Elf_Shdr *Shdr,
                                                    ELFYAML::Section &S) {
@@ -283,10 +411,14 @@ ELFDumper<ELFT>::dumpRelSection(const Elf_Shdr *Shdr) {
   if (std::error_code EC = SymTabOrErr.getError())
     return EC;
   const Elf_Shdr *SymTab = *SymTabOrErr;
+  ErrorOr<StringRef> StrTabOrErr = getLinkedStringTable(SymTab);
+  if (std::error_code EC = StrTabOrErr.getError())
+    return EC;
 
+  S->Relocations.reserve(Obj.rel_end(Shdr) - Obj.rel_begin(Shdr));
   for (auto RI = Obj.rel_begin(Shdr), RE = Obj.rel_end(Shdr); RI != RE; ++RI) {
     ELFYAML::Relocation R;
-    if (std::error_code EC = dumpRelocation(&*RI, SymTab, R))
+    if (std::error_code EC = dumpRelocation(&*RI, SymTab, *StrTabOrErr, R))
       return EC;
     S->Relocations.push_back(R);
   }
@@ -307,11 +439,15 @@ ELFDumper<ELFT>::dumpRelaSection(const Elf_Shdr *Shdr) {
   if (std::error_code EC = SymTabOrErr.getError())
     return EC;
   const Elf_Shdr *SymTab = *SymTabOrErr;
+  ErrorOr<StringRef> StrTabOrErr = getLinkedStringTable(SymTab);
+  if (std::error_code EC = StrTabOrErr.getError())
+    return EC;
 
+  S->Relocations.reserve(Obj.rela_end(Shdr) - Obj.rela_begin(Shdr));
   for (auto RI = Obj.rela_begin(Shdr), RE = Obj.rela_end(Shdr); RI != RE;
        ++RI) {
     ELFYAML::Relocation R;
-    if (std::error_code EC = dumpRelocation(&*RI, SymTab, R))
+    if (std::error_code EC = dumpRelocation(&*RI, SymTab, *StrTabOrErr, R))
       return EC;
     R.Addend = RI->r_addend;
     S->Relocations.push_back(R);
@@ -426,15 +562,14 @@ template <class ELFT>
 static std::error_code elf2yaml(raw_ostream &Out,
                                 const object::ELFFile<ELFT> &Obj) {
   ELFDumper<ELFT> Dumper(Obj);
-  ErrorOr<ELFYAML::Object *> YAMLOrErr = Dumper.dump();
-  if (std::error_code EC = YAMLOrErr.getError())
+  StreamedObject<ELFT> YAML(Dumper);
+  if (std::error_code EC = Dumper.dump(YAML))
     return EC;
 
-  std::unique_ptr<ELFYAML::Object> YAML(YAMLOrErr.get());
   yaml::Output Yout(Out);
-  Yout << *YAML;
+  Yout << YAML;
 
-  return std::error_code();
+  return YAML.getError();
 }
 
 std::error_code elf2yaml(raw_ostream &Out, const object::ObjectFile &Obj) {
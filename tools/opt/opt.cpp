@@ -15,6 +15,7 @@
 #include "BreakpointPrinter.h"
 #include "NewPMDriver.h"
 #include "PassPrinters.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
@@ -30,6 +31,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/LegacyPassNameParser.h"
+#include "llvm/IR/MemoryUsage.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
@@ -37,6 +39,7 @@
 #include "llvm/LinkAllIR.h"
 #include "llvm/LinkAllPasses.h"
 #include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
@@ -48,7 +51,9 @@
 #include "llvm/Support/SystemUtils.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/YAMLTraits.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/Utils/Cloning.h"
@@ -101,6 +106,11 @@ NoVerify("disable-verify", cl::desc("Do not run the verifier"), cl::Hidden);
 static cl::opt<bool>
 VerifyEach("verify-each", cl::desc("Verify after each transform"));
 
+static cl::opt<bool> PrintMemoryStats(
+    "print-memory-stats",
+    cl::desc("Print the memory used by the IR, by kind of object, and by the "
+             "registered allocators once the passes have run"));
+
 static cl::opt<bool>
     DisableDITypeMap("disable-debug-info-type-map",
                      cl::desc("Don't use a uniquing type map for debug info"));
@@ -190,6 +200,21 @@ static cl::opt<bool>
 PrintBreakpoints("print-breakpoints-for-testing",
                  cl::desc("Print select breakpoints location for testing"));
 
+static cl::opt<bool> TimeTrace("time-trace",
+                               cl::desc("Record a Chrome trace of the time "
+                                        "spent in each pass"));
+
+static cl::opt<unsigned> TimeTraceGranularity(
+    "time-trace-granularity",
+    cl::desc("Minimum duration (in microseconds) of the events recorded by "
+             "-time-trace"),
+    cl::init(500), cl::Hidden);
+
+static cl::opt<std::string>
+    TimeTraceFile("time-trace-file",
+                  cl::desc("File to write the -time-trace output to"),
+                  cl::value_desc("filename"));
+
 static cl::opt<std::string>
 DefaultDataLayout("default-data-layout",
           cl::desc("data layout string to use if not specified by module"),
@@ -215,6 +240,17 @@ static cl::opt<bool> DiscardValueNames(
     cl::desc("Discard names from Value (other than GlobalValue)."),
     cl::init(false), cl::Hidden);
 
+static cl::opt<std::string>
+    RemarksFilename("pass-remarks-output",
+                    cl::desc("YAML output filename for pass remarks"),
+                    cl::value_desc("filename"));
+
+static cl::opt<unsigned> RemarksHotnessThreshold(
+    "pass-remarks-hotness-threshold",
+    cl::desc("Drop the optimization remarks about code executed fewer times "
+             "than this"),
+    cl::value_desc("count"), cl::init(0));
+
 static inline void addPass(legacy::PassManagerBase &PM, Pass *P) {
   // Add the pass to the pass manager...
   PM.add(P);
@@ -273,6 +309,14 @@ static void AddOptimizationPasses(legacy::PassManagerBase &MPM,
   Builder.populateModulePassManager(MPM);
 }
 
+/// Print the memory used by \p M and its context, followed by the allocator
+/// report, to the -info-output-file.
+static void printMemoryStats(const Module &M) {
+  std::unique_ptr<raw_ostream> OS = CreateInfoOutputFile();
+  IRMemoryUsage(M).print(*OS);
+  PrintMemoryUsage(*OS);
+}
+
 static void AddStandardLinkPasses(legacy::PassManagerBase &PM) {
   PassManagerBuilder Builder;
   Builder.VerifyInput = true;
@@ -377,11 +421,28 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  if (TimeTrace)
+    timeTraceProfilerInitialize(TimeTraceGranularity);
+
   SMDiagnostic Err;
 
   Context.setDiscardValueNames(DiscardValueNames);
   if (!DisableDITypeMap)
     Context.enableDebugTypeODRUniquing();
+  Context.setDiagnosticsHotnessThreshold(RemarksHotnessThreshold);
+
+  std::unique_ptr<tool_output_file> YamlFile;
+  if (RemarksFilename != "") {
+    std::error_code EC;
+    YamlFile = llvm::make_unique<tool_output_file>(RemarksFilename, EC,
+                                                   sys::fs::F_None);
+    if (EC) {
+      errs() << EC.message() << '\n';
+      return 1;
+    }
+    Context.setDiagnosticsOutputFile(
+        llvm::make_unique<yaml::Output>(YamlFile->os()));
+  }
 
   // Load the input module...
   std::unique_ptr<Module> M = parseIRFile(InputFilename, Err, Context);
@@ -465,11 +526,15 @@ int main(int argc, char **argv) {
     // The user has asked to use the new pass manager and provided a pipeline
     // string. Hand off the rest of the functionality to the new code for that
     // layer.
-    return runPassPipeline(argv[0], Context, *M, TM.get(), Out.get(),
-                           PassPipeline, OK, VK, PreserveAssemblyUseListOrder,
-                           PreserveBitcodeUseListOrder)
-               ? 0
-               : 1;
+    bool Success = runPassPipeline(argv[0], Context, *M, TM.get(), Out.get(),
+                                   PassPipeline, OK, VK,
+                                   PreserveAssemblyUseListOrder,
+                                   PreserveBitcodeUseListOrder);
+    if (PrintMemoryStats)
+      printMemoryStats(*M);
+    if (YamlFile)
+      YamlFile->keep();
+    return Success ? 0 : 1;
   }
 
   // Create a PassManager to hold and optimize the collection of passes we are
@@ -669,6 +734,9 @@ int main(int argc, char **argv) {
   // Now that we have all of the passes ready, run them.
   Passes.run(*M);
 
+  if (PrintMemoryStats)
+    printMemoryStats(*M);
+
   // Compare the two outputs and make sure they're the same
   if (RunTwice) {
     assert(Out);
@@ -690,5 +758,17 @@ int main(int argc, char **argv) {
   if (!NoOutput || PrintBreakpoints)
     Out->keep();
 
+  if (YamlFile)
+    YamlFile->keep();
+
+  if (TimeTrace) {
+    if (std::error_code EC =
+            timeTraceProfilerWrite(TimeTraceFile, OutputFilename)) {
+      errs() << argv[0] << ": " << EC.message() << '\n';
+      return 1;
+    }
+    timeTraceProfilerCleanup();
+  }
+
   return 0;
 }
@@ -174,10 +174,10 @@ static inline auto group_by(const RangeTy &R, FuncTy F)
 
 template <typename T>
 static void readInts(const char *Start, const char *End,
-                     std::set<uint64_t> *Ints) {
+                     std::vector<uint64_t> *Ints) {
   const T *S = reinterpret_cast<const T *>(Start);
-  const T *E = reinterpret_cast<const T *>(End);
-  std::copy(S, E, std::inserter(*Ints, Ints->end()));
+  const T *E = S + (End - Start) / sizeof(T);
+  Ints->insert(Ints->end(), S, E);
 }
 
 struct FileLoc {
@@ -527,8 +527,10 @@ static std::string anchorName(const std::string &Anchor) {
 }
 
 static ErrorOr<bool> isCoverageFile(const std::string &FileName) {
+  // Only the header is looked at, so map the file rather than reading it.
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
-      MemoryBuffer::getFile(FileName);
+      MemoryBuffer::getFile(FileName, /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false);
   if (!BufOrErr) {
     errs() << "Warning: " << BufOrErr.getError().message() << "("
            << BufOrErr.getError().value()
@@ -566,8 +568,11 @@ public:
   // Read single file coverage data.
   static ErrorOr<std::unique_ptr<CoverageData>>
   read(const std::string &FileName) {
+    // Without a null terminator the file is always memory mapped, and the
+    // addresses are copied out of the mapping exactly once.
     ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
-        MemoryBuffer::getFile(FileName);
+        MemoryBuffer::getFile(FileName, /*FileSize=*/-1,
+                              /*RequiresNullTerminator=*/false);
     if (!BufOrErr)
       return BufOrErr.getError();
     std::unique_ptr<MemoryBuffer> Buf = std::move(BufOrErr.get());
@@ -583,7 +588,7 @@ public:
       return make_error_code(errc::illegal_byte_sequence);
     }
 
-    auto Addrs = llvm::make_unique<std::set<uint64_t>>();
+    auto Addrs = llvm::make_unique<std::vector<uint64_t>>();
 
     switch (Header->Bitness) {
     case Bitness64:
@@ -599,31 +604,36 @@ public:
       return make_error_code(errc::illegal_byte_sequence);
     }
 
+    std::sort(Addrs->begin(), Addrs->end());
+    Addrs->erase(std::unique(Addrs->begin(), Addrs->end()), Addrs->end());
     return std::unique_ptr<CoverageData>(new CoverageData(std::move(Addrs)));
   }
 
-  // Merge multiple coverage data together.
-  static std::unique_ptr<CoverageData>
-  merge(const std::vector<std::unique_ptr<CoverageData>> &Covs) {
-    auto Addrs = llvm::make_unique<std::set<uint64_t>>();
-
-    for (const auto &Cov : Covs)
-      Addrs->insert(Cov->Addrs->begin(), Cov->Addrs->end());
-
-    return std::unique_ptr<CoverageData>(new CoverageData(std::move(Addrs)));
+  // Merge the sorted addresses of Other into this coverage data.
+  void merge(const CoverageData &Other) {
+    if (std::includes(Addrs->begin(), Addrs->end(), Other.Addrs->begin(),
+                      Other.Addrs->end()))
+      return;
+    std::vector<uint64_t> Merged;
+    Merged.reserve(Addrs->size() + Other.Addrs->size());
+    std::set_union(Addrs->begin(), Addrs->end(), Other.Addrs->begin(),
+                   Other.Addrs->end(), std::back_inserter(Merged));
+    Addrs->swap(Merged);
   }
 
-  // Read list of files and merges their coverage info.
+  // Read list of files and merges their coverage info. Each file is merged
+  // as soon as it is read, so only one of them is held in memory at a time.
   static ErrorOr<std::unique_ptr<CoverageData>>
   readAndMerge(const std::vector<std::string> &FileNames) {
-    std::vector<std::unique_ptr<CoverageData>> Covs;
+    std::unique_ptr<CoverageData> Result(
+        new CoverageData(llvm::make_unique<std::vector<uint64_t>>()));
     for (const auto &FileName : FileNames) {
       auto Cov = read(FileName);
       if (!Cov)
         return Cov.getError();
-      Covs.push_back(std::move(Cov.get()));
+      Result->merge(*Cov.get());
     }
-    return merge(Covs);
+    return std::move(Result);
   }
 
   // Print coverage addresses.
@@ -636,12 +646,13 @@ public:
   }
 
 protected:
-  explicit CoverageData(std::unique_ptr<std::set<uint64_t>> Addrs)
+  explicit CoverageData(std::unique_ptr<std::vector<uint64_t>> Addrs)
       : Addrs(std::move(Addrs)) {}
 
   friend class CoverageDataWithObjectFile;
 
-  std::unique_ptr<std::set<uint64_t>> Addrs;
+  // Sorted and unique coverage addresses.
+  std::unique_ptr<std::vector<uint64_t>> Addrs;
 };
 
 // Coverage data translated into source code line-level information.
@@ -661,15 +672,27 @@ public:
     MIXED = 3
   };
 
-  SourceCoverageData(std::string ObjectFile, const std::set<uint64_t> &Addrs)
+  SourceCoverageData(std::string ObjectFile,
+                     const std::vector<uint64_t> &Addrs)
       : AllCovPoints(getCoveragePoints(ObjectFile)) {
     if (!std::includes(AllCovPoints.begin(), AllCovPoints.end(), Addrs.begin(),
                        Addrs.end())) {
       Fail("Coverage points in binary and .sancov file do not match.");
     }
 
+    // Every covered address is a coverage point, so each address is
+    // symbolized once and the covered subset is picked out of the result.
+    // Both lists are sorted by address.
     AllAddrInfo = getAddrInfo(ObjectFile, AllCovPoints, true);
-    CovAddrInfo = getAddrInfo(ObjectFile, Addrs, true);
+    auto I = Addrs.begin(), E = Addrs.end();
+    for (const auto &AI : AllAddrInfo) {
+      while (I != E && *I < AI.Addr)
+        ++I;
+      if (I == E)
+        break;
+      if (*I == AI.Addr)
+        CovAddrInfo.push_back(AI);
+    }
   }
 
   // Compute number of coverage points hit/total in a file.
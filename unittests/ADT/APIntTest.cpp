@@ -1110,3 +1110,50 @@ TEST(APIntTest, reverseBits) {
     }
   }
 }
+
+TEST(APIntTest, RValueOperators) {
+  for (unsigned BitWidth : {7, 64, 65, 128, 200}) {
+    APInt A = APInt::getLowBitsSet(BitWidth, BitWidth / 2);
+    APInt B = APInt::getOneBitSet(BitWidth, BitWidth - 1);
+    APInt One(BitWidth, 1);
+
+    EXPECT_EQ(A | B, APInt(A) | B);
+    EXPECT_EQ(A | B, A | APInt(B));
+    EXPECT_EQ(A & B, APInt(A) & B);
+    EXPECT_EQ(A & B, A & APInt(B));
+    EXPECT_EQ(A ^ B, APInt(A) ^ B);
+    EXPECT_EQ(A ^ B, A ^ APInt(B));
+    EXPECT_EQ(A + B, APInt(A) + B);
+    EXPECT_EQ(A + B, A + APInt(B));
+    EXPECT_EQ(A + One, A + 1);
+    EXPECT_EQ(A - B, APInt(A) - B);
+    EXPECT_EQ(A - B, A - APInt(B));
+    EXPECT_EQ(B - A, B - APInt(A));
+    EXPECT_EQ(A - One, A - 1);
+    EXPECT_EQ(~A, ~APInt(A));
+    EXPECT_EQ(-A, -APInt(A));
+    EXPECT_EQ(APInt(BitWidth, 0), A + -A);
+    EXPECT_EQ(APInt::getAllOnesValue(BitWidth), A ^ ~A);
+
+    APInt C = A;
+    C += 1;
+    EXPECT_EQ(A + One, C);
+    C -= 2;
+    EXPECT_EQ(A - One, C);
+    --C;
+    ++C;
+    EXPECT_EQ(A - One, C);
+  }
+
+  // Temporaries of wide values are updated in place rather than reallocated.
+  APInt A = APInt::getAllOnesValue(128);
+  APInt B = APInt::getOneBitSet(128, 70);
+  const uint64_t *Raw = A.getRawData();
+  APInt Sum = std::move(A) + B;
+  EXPECT_EQ(Raw, Sum.getRawData());
+  APInt Diff = B - std::move(Sum);
+  EXPECT_EQ(Raw, Diff.getRawData());
+  APInt Not = ~std::move(Diff);
+  EXPECT_EQ(Raw, Not.getRawData());
+  EXPECT_EQ(~APInt(128, 1), Not);
+}
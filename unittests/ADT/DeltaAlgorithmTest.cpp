@@ -10,6 +10,7 @@
 #include "gtest/gtest.h"
 #include "llvm/ADT/DeltaAlgorithm.h"
 #include <algorithm>
+#include <atomic>
 #include <cstdarg>
 using namespace llvm;
 
@@ -34,7 +35,7 @@ namespace {
 
 class FixedDeltaAlgorithm final : public DeltaAlgorithm {
   changeset_ty FailingSet;
-  unsigned NumTests;
+  std::atomic<unsigned> NumTests;
 
 protected:
   bool ExecuteOneTest(const changeset_ty &Changes) override {
@@ -48,6 +49,13 @@ public:
     : FailingSet(_FailingSet),
       NumTests(0) {}
 
+  FixedDeltaAlgorithm &operator=(FixedDeltaAlgorithm &&RHS) {
+    DeltaAlgorithm::operator=(RHS);
+    FailingSet = std::move(RHS.FailingSet);
+    NumTests = RHS.NumTests.load();
+    return *this;
+  }
+
   unsigned getNumTests() const { return NumTests; }
 };
 
@@ -96,5 +104,18 @@ TEST(DeltaAlgorithmTest, Basic) {
   EXPECT_EQ(11U, FDA.getNumTests());  
 }
 
+TEST(DeltaAlgorithmTest, Parallel) {
+  // Testing several candidates at once must not change the result.
+  for (unsigned Threads : {2, 3, 8}) {
+    FixedDeltaAlgorithm FDA(fixed_set(3, 3, 5, 7));
+    FDA.setNumThreads(Threads);
+    EXPECT_EQ(fixed_set(3, 3, 5, 7), FDA.Run(range(20)));
+    EXPECT_EQ(range(10, 20), FDA.Run(range(10, 20)));
+
+    FixedDeltaAlgorithm FDA2(range(10));
+    FDA2.setNumThreads(Threads);
+    EXPECT_EQ(range(4), FDA2.Run(range(4)));
+  }
 }
 
+}
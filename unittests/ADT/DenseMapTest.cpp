@@ -619,4 +619,29 @@ TEST(DenseMapCustomTest, SmallDenseMapGrowTest) {
   EXPECT_TRUE(map.find(32) == map.end());
 }
 
+TEST(DenseMapCustomTest, MixedPtrInfoTest) {
+  // Keys at a fixed stride, like objects allocated from an arena.
+  struct Obj {
+    char Payload[48];
+  };
+  std::vector<Obj> Arena(1000);
+  DenseMap<Obj *, unsigned, MixedPtrDenseMapInfo<Obj>> Map(Arena.size());
+  unsigned NumBuckets = Map.getMemorySize();
+  for (unsigned I = 0; I != Arena.size(); ++I)
+    Map[&Arena[I]] = I;
+
+  // The reserved map doesn't grow.
+  EXPECT_EQ(NumBuckets, Map.getMemorySize());
+  EXPECT_EQ(Arena.size(), Map.size());
+  for (unsigned I = 0; I != Arena.size(); ++I)
+    EXPECT_EQ(I, Map.lookup(&Arena[I]));
+  EXPECT_EQ(0u, Map.count(static_cast<Obj *>(nullptr)));
+
+  for (unsigned I = 0; I != Arena.size(); I += 2)
+    Map.erase(&Arena[I]);
+  EXPECT_EQ(Arena.size() / 2, Map.size());
+  for (unsigned I = 0; I != Arena.size(); ++I)
+    EXPECT_EQ(I % 2 != 0, Map.count(&Arena[I]) != 0);
+}
+
 }
@@ -168,5 +168,19 @@ TEST(FoldingSetTest, SmallReserveChangesNothing) {
   EXPECT_EQ(Trivial.capacity(), OldCapacity);
 }
 
+TEST(FoldingSetTest, InternedIDKeepsHash) {
+  BumpPtrAllocator Allocator;
+  FoldingSetNodeID ID;
+  ID.AddInteger(42);
+  ID.AddString("foo");
+  FoldingSetNodeIDRef Ref = ID.Intern(Allocator);
+  EXPECT_EQ(ID.ComputeHash(), Ref.ComputeHash());
+  EXPECT_TRUE(ID == Ref);
+
+  // A second reference to the same data hashes the same.
+  FoldingSetNodeIDRef Plain(Ref.getData(), Ref.getSize());
+  EXPECT_EQ(ID.ComputeHash(), Plain.ComputeHash());
+  EXPECT_TRUE(Plain == Ref);
 }
 
+}
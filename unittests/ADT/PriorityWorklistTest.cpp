@@ -103,4 +103,27 @@ TYPED_TEST(PriorityWorklistTest, EraseIf) {
   EXPECT_EQ(13, W.pop_back_val());
 }
 
+TYPED_TEST(PriorityWorklistTest, RepeatedReinsertion) {
+  TypeParam W;
+  for (int i = 1; i <= 4; ++i)
+    W.insert(i);
+
+  // Cycle the elements to the back many times and erase from the middle. The
+  // stale entries left behind are compacted away along the way.
+  for (int Round = 0; Round < 1000; ++Round) {
+    EXPECT_FALSE(W.insert(1 + Round % 4));
+    EXPECT_EQ(1 + Round % 4, W.back());
+  }
+  EXPECT_EQ(4u, W.size());
+  EXPECT_TRUE(W.erase(2));
+  EXPECT_FALSE(W.insert(1));
+  EXPECT_TRUE(W.insert(5));
+
+  EXPECT_EQ(5, W.pop_back_val());
+  EXPECT_EQ(1, W.pop_back_val());
+  EXPECT_EQ(4, W.pop_back_val());
+  EXPECT_EQ(3, W.pop_back_val());
+  EXPECT_TRUE(W.empty());
+}
+
 }
@@ -13,6 +13,7 @@
 
 #include "gtest/gtest.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include <vector>
 
 using namespace llvm;
 
@@ -273,3 +274,31 @@ TEST(SmallPtrSetTest, EraseTest) {
   SmallPtrSet<int *, 2> A;
   checkEraseAndIterators(A);
 }
+
+TEST(SmallPtrSetTest, AlignedPointers) {
+  // Pointers that share their low bits must still spread over the buckets of
+  // a large set.
+  std::vector<char> Storage(1 << 20);
+  SmallPtrSet<char *, 4> S;
+  for (size_t I = 0; I < Storage.size(); I += 4096)
+    EXPECT_TRUE(S.insert(&Storage[I]).second);
+  EXPECT_EQ(Storage.size() / 4096, S.size());
+  for (size_t I = 0; I < Storage.size(); I += 4096) {
+    EXPECT_TRUE(S.count(&Storage[I]));
+    EXPECT_FALSE(S.count(&Storage[I + 8]));
+  }
+}
+
+TEST(SmallPtrSetTest, SmallInsertAfterErase) {
+  int Buf[4];
+  SmallPtrSet<int *, 4> S;
+  for (int &I : Buf)
+    S.insert(&I);
+  EXPECT_TRUE(S.erase(&Buf[1]));
+  // Re-inserting an existing element must not reuse the tombstone.
+  EXPECT_FALSE(S.insert(&Buf[3]).second);
+  EXPECT_TRUE(S.insert(&Buf[1]).second);
+  EXPECT_EQ(4u, S.size());
+  for (int &I : Buf)
+    EXPECT_TRUE(S.count(&I));
+}
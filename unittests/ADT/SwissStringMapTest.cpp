@@ -0,0 +1,164 @@
+//===- llvm/unittest/ADT/SwissStringMapTest.cpp - SwissStringMap tests ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SwissStringMap.h"
+#include "llvm/ADT/Twine.h"
+#include "gtest/gtest.h"
+#include <string>
+using namespace llvm;
+
+namespace {
+
+TEST(SwissStringMapTest, EmptyMap) {
+  SwissStringMap<int> Map;
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.size());
+  EXPECT_TRUE(Map.begin() == Map.end());
+  EXPECT_EQ(0u, Map.count("key"));
+  EXPECT_TRUE(Map.find("key") == Map.end());
+  EXPECT_FALSE(Map.erase("key"));
+}
+
+TEST(SwissStringMapTest, InsertFindErase) {
+  SwissStringMap<int> Map;
+  auto Result = Map.insert(std::make_pair("key", 1));
+  EXPECT_TRUE(Result.second);
+  EXPECT_EQ("key", Result.first->getKey());
+  EXPECT_EQ(1, Result.first->getValue());
+
+  Result = Map.insert(std::make_pair("key", 2));
+  EXPECT_FALSE(Result.second);
+  EXPECT_EQ(1, Result.first->second);
+
+  Map["other"] = 3;
+  EXPECT_EQ(2u, Map.size());
+  EXPECT_EQ(3, Map.lookup("other"));
+  EXPECT_EQ(0, Map.lookup("missing"));
+
+  // Keys are compared by length and contents, not by pointer.
+  std::string Key = "key";
+  EXPECT_EQ(1u, Map.count(Key));
+  EXPECT_EQ(0u, Map.count(StringRef("keyx", 4)));
+  EXPECT_EQ(1u, Map.count(StringRef("keyx", 3)));
+
+  EXPECT_TRUE(Map.erase("key"));
+  EXPECT_EQ(0u, Map.count("key"));
+  EXPECT_EQ(1u, Map.size());
+  Map.clear();
+  EXPECT_TRUE(Map.empty());
+  EXPECT_TRUE(Map.begin() == Map.end());
+}
+
+TEST(SwissStringMapTest, EmptyKey) {
+  SwissStringMap<int> Map;
+  Map[""] = 5;
+  EXPECT_EQ(1u, Map.count(""));
+  EXPECT_EQ(5, Map.lookup(""));
+}
+
+TEST(SwissStringMapTest, ManyEntries) {
+  // Enough entries to grow the table several times, with keys that share
+  // long prefixes.
+  const unsigned N = 10000;
+  SwissStringMap<unsigned> Map;
+  for (unsigned I = 0; I != N; ++I)
+    EXPECT_TRUE(Map.insert(std::make_pair(("symbol_" + Twine(I)).str(), I))
+                    .second);
+  EXPECT_EQ(N, Map.size());
+
+  unsigned Sum = 0, Count = 0;
+  for (const auto &Entry : Map) {
+    Sum += Entry.second;
+    ++Count;
+  }
+  EXPECT_EQ(N, Count);
+  EXPECT_EQ(N * (N - 1) / 2, Sum);
+
+  // Remove every other entry, then make sure the tombstones neither hide nor
+  // duplicate anything.
+  for (unsigned I = 0; I < N; I += 2)
+    EXPECT_TRUE(Map.erase(("symbol_" + Twine(I)).str()));
+  EXPECT_EQ(N / 2, Map.size());
+  for (unsigned I = 0; I != N; ++I) {
+    auto It = Map.find(("symbol_" + Twine(I)).str());
+    if (I % 2) {
+      ASSERT_TRUE(It != Map.end());
+      EXPECT_EQ(I, It->second);
+    } else {
+      EXPECT_TRUE(It == Map.end());
+    }
+  }
+
+  // Reinsert the removed entries, which reuses or rehashes the tombstones.
+  for (unsigned I = 0; I < N; I += 2)
+    EXPECT_TRUE(Map.insert(std::make_pair(("symbol_" + Twine(I)).str(), I))
+                    .second);
+  EXPECT_EQ(N, Map.size());
+  for (unsigned I = 0; I != N; ++I)
+    EXPECT_EQ(I, Map.lookup(("symbol_" + Twine(I)).str()));
+}
+
+TEST(SwissStringMapTest, ChurnWithoutGrowing) {
+  // Repeatedly inserting and erasing keeps the number of items small, so the
+  // table must be rehashed in place rather than grown.
+  SwissStringMap<unsigned> Map;
+  for (unsigned I = 0; I != 1000; ++I) {
+    Map[("key" + Twine(I)).str()] = I;
+    EXPECT_TRUE(Map.erase(("key" + Twine(I)).str()));
+  }
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(16u, Map.getNumBuckets());
+}
+
+TEST(SwissStringMapTest, InitialSize) {
+  for (unsigned Size : {1, 7, 14, 15, 100, 1000}) {
+    SwissStringMap<unsigned> Map(Size);
+    unsigned NumBuckets = Map.getNumBuckets();
+    for (unsigned I = 0; I != Size; ++I)
+      Map[("key" + Twine(I)).str()] = I;
+    EXPECT_EQ(NumBuckets, Map.getNumBuckets());
+  }
+}
+
+TEST(SwissStringMapTest, CopyAndMove) {
+  SwissStringMap<int> Map;
+  for (int I = 0; I != 100; ++I)
+    Map[("key" + Twine(I)).str()] = I;
+  Map.erase("key7");
+
+  SwissStringMap<int> Copy(Map);
+  EXPECT_EQ(99u, Copy.size());
+  EXPECT_EQ(0u, Copy.count("key7"));
+  EXPECT_EQ(42, Copy.lookup("key42"));
+  Copy["key42"] = -1;
+  EXPECT_EQ(42, Map.lookup("key42"));
+  Copy["key7"] = 7;
+  EXPECT_EQ(100u, Copy.size());
+
+  SwissStringMap<int> Moved(std::move(Map));
+  EXPECT_EQ(99u, Moved.size());
+  EXPECT_TRUE(Map.empty());
+
+  Map = Copy;
+  EXPECT_EQ(100u, Map.size());
+  EXPECT_EQ(-1, Map.lookup("key42"));
+}
+
+TEST(SwissStringMapTest, EntryLookupFromKeyData) {
+  SwissStringMap<int> Map;
+  auto &Entry = *Map.insert(std::make_pair("abc", 1)).first;
+  EXPECT_EQ(&Entry, &StringMapEntry<int>::GetStringMapEntryFromKeyData(
+                        Entry.getKeyData()));
+  // Growing the table doesn't move the entries.
+  for (int I = 0; I != 100; ++I)
+    Map[("key" + Twine(I)).str()] = I;
+  EXPECT_EQ(&Entry, &*Map.find("abc"));
+}
+
+} // end anonymous namespace
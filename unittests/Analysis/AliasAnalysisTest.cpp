@@ -204,6 +204,48 @@ TEST_F(AliasAnalysisTest, getModRefInfo) {
   EXPECT_EQ(AA.getModRefInfo(AtomicRMW), MRI_ModRef);
 }
 
+TEST_F(AliasAnalysisTest, BatchAlias) {
+  // Setup function.
+  auto *I32 = Type::getInt32Ty(C);
+  auto *ArrTy = ArrayType::get(I32, 16);
+  FunctionType *FTy = FunctionType::get(Type::getVoidTy(C), {I32}, false);
+  auto *F = cast<Function>(M.getOrInsertFunction("g", FTy));
+  auto *BB = BasicBlock::Create(C, "entry", F);
+  auto *Alloca = new AllocaInst(ArrTy, "a", BB);
+  auto *Other = new AllocaInst(I32, "b", BB);
+  auto GEP = [&](Value *Idx) {
+    Value *Idxs[] = {ConstantInt::get(I32, 0), Idx};
+    return GetElementPtrInst::CreateInBounds(ArrTy, Alloca, Idxs, "", BB);
+  };
+  auto *GEP0 = GEP(ConstantInt::get(I32, 0));
+  auto *GEP1 = GEP(ConstantInt::get(I32, 1));
+  auto *GEPVar = GEP(&*F->arg_begin());
+  ReturnInst::Create(C, nullptr, BB);
+
+  auto &AA = getAAResults(*F);
+  MemoryLocation Locs[] = {MemoryLocation(GEP0, 4), MemoryLocation(GEP1, 4),
+                           MemoryLocation(GEPVar, 4), MemoryLocation(Other, 4),
+                           MemoryLocation(GEP0, 4)};
+  MemoryLocation Loc(GEP1, 4);
+  auto Results = AA.alias(Locs, Loc);
+  ASSERT_EQ(5u, Results.size());
+  for (unsigned I = 0; I != 5; ++I)
+    EXPECT_EQ(AA.alias(Locs[I], Loc), Results[I]);
+  EXPECT_EQ(NoAlias, Results[0]);
+  EXPECT_EQ(MustAlias, Results[1]);
+  // BasicAA answers PartialAlias for a dynamic index into the same object.
+  EXPECT_EQ(PartialAlias, Results[2]);
+  EXPECT_EQ(NoAlias, Results[3]);
+
+  // Batches nest, and the results don't depend on being in one.
+  {
+    AAResults::BatchQueryScope Batch(AA);
+    AAResults::BatchQueryScope Inner(AA);
+    EXPECT_EQ(NoAlias, AA.alias(Locs[0], Loc));
+  }
+  EXPECT_EQ(NoAlias, AA.alias(Locs[0], Loc));
+}
+
 class AAPassInfraTest : public testing::Test {
 protected:
   LLVMContext C;
@@ -19,6 +19,8 @@ namespace llvm {
 void initializeUnrollAnalyzerTestPass(PassRegistry &);
 
 static SmallVector<DenseMap<Value *, Constant *>, 16> SimplifiedValuesVector;
+static SmallVector<DenseMap<Value *, Constant *>, 16>
+    SharedSimplifiedValuesVector;
 static unsigned TripCount = 0;
 
 namespace {
@@ -35,14 +37,24 @@ struct UnrollAnalyzerTest : public FunctionPass {
     BasicBlock *Exiting = L->getExitingBlock();
 
     SimplifiedValuesVector.clear();
+    SharedSimplifiedValuesVector.clear();
     TripCount = SE->getSmallConstantTripCount(L, Exiting);
+    // Also simulate all the iterations with a single analyzer, the way the
+    // loop unroller does.
+    DenseMap<Value *, Constant *> SharedSimplifiedValues;
+    UnrolledInstAnalyzer SharedAnalyzer(0, SharedSimplifiedValues, *SE, L);
     for (unsigned Iteration = 0; Iteration < TripCount; Iteration++) {
       DenseMap<Value *, Constant *> SimplifiedValues;
       UnrolledInstAnalyzer Analyzer(Iteration, SimplifiedValues, *SE, L);
+      SharedSimplifiedValues.clear();
+      SharedAnalyzer.setIteration(Iteration);
       for (auto *BB : L->getBlocks())
-        for (Instruction &I : *BB)
+        for (Instruction &I : *BB) {
           Analyzer.visit(I);
+          SharedAnalyzer.visit(I);
+        }
       SimplifiedValuesVector.push_back(SimplifiedValues);
+      SharedSimplifiedValuesVector.push_back(SharedSimplifiedValues);
     }
     return false;
   }
@@ -320,6 +332,61 @@ TEST(UnrollAnalyzerTest, CastSimplifications) {
   EXPECT_EQ(cast<ConstantInt>((*I3).second)->getZExtValue(), 3U);
 }
 
+TEST(UnrollAnalyzerTest, SharedAnalyzer) {
+  const char *ModuleStr =
+      "target datalayout = \"e-m:o-i64:64-f80:128-n8:16:32:64-S128\"\n"
+      "@known_constant = internal unnamed_addr constant [10 x i32] [i32 0, i32 1, i32 0, i32 1, i32 0, i32 259, i32 0, i32 1, i32 0, i32 1], align 16\n"
+      "define void @const_load(i32* %a) {\n"
+      "entry:\n"
+      "  br label %loop\n"
+      "\n"
+      "loop:\n"
+      "  %iv = phi i64 [ 0, %entry ], [ %inc, %loop ]\n"
+      "  %array_const_idx = getelementptr inbounds [10 x i32], [10 x i32]* @known_constant, i64 0, i64 %iv\n"
+      "  %const_array_element = load i32, i32* %array_const_idx, align 4\n"
+      "  %a_idx = getelementptr inbounds i32, i32* %a, i64 %iv\n"
+      "  %a_element = load i32, i32* %a_idx, align 4\n"
+      "  %mul = mul i32 %a_element, %const_array_element\n"
+      "  %cmp = icmp eq i32 %const_array_element, 0\n"
+      "  %inc = add nuw nsw i64 %iv, 1\n"
+      "  %exitcond = icmp eq i64 %inc, 10\n"
+      "  br i1 %exitcond, label %loop.end, label %loop\n"
+      "\n"
+      "loop.end:\n"
+      "  ret void\n"
+      "}\n";
+
+  UnrollAnalyzerTest *P = new UnrollAnalyzerTest();
+  LLVMContext Context;
+  std::unique_ptr<Module> M = makeLLVMModule(Context, P, ModuleStr);
+  legacy::PassManager Passes;
+  Passes.add(P);
+  Passes.run(*M);
+
+  // Check that the analyzer that simulated all the iterations found the same
+  // simplifications as the ones that simulated a single iteration.
+  ASSERT_EQ(TripCount, 10U);
+  ASSERT_EQ(SharedSimplifiedValuesVector.size(), TripCount);
+  for (unsigned Iteration = 0; Iteration < TripCount; Iteration++) {
+    auto &Expected = SimplifiedValuesVector[Iteration];
+    auto &Shared = SharedSimplifiedValuesVector[Iteration];
+    EXPECT_EQ(Expected.size(), Shared.size());
+    for (auto &KV : Expected)
+      EXPECT_EQ(KV.second, Shared.lookup(KV.first));
+  }
+
+  // Check that "%mul = mul i32 %a_element, %const_array_element" is simplified
+  // to 0 on the 3rd iteration.
+  Function *F = &*M->begin();
+  BasicBlock *Header = &*std::next(F->begin());
+  BasicBlock::iterator BBI = Header->begin();
+  std::advance(BBI, 5);
+  Instruction *Mul = &*BBI;
+  auto I1 = SharedSimplifiedValuesVector[2].find(Mul);
+  EXPECT_TRUE(I1 != SharedSimplifiedValuesVector[2].end());
+  EXPECT_TRUE(cast<ConstantInt>((*I1).second)->isZero());
+}
+
 } // end namespace llvm
 
 INITIALIZE_PASS_BEGIN(UnrollAnalyzerTest, "unrollanalyzertestpass",
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Analysis/KnownBitsCache.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/InstIterator.h"
@@ -188,3 +189,52 @@ TEST_F(MatchSelectPatternTest, DoubleCastBad) {
   // The cast types here aren't the same, so we cannot match an UMIN.
   expectPattern({SPF_UNKNOWN, SPNB_NA, false});
 }
+
+TEST(KnownBitsCacheTest, InvalidateChangedInstructions) {
+  LLVMContext Context;
+  SMDiagnostic Error;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define i32 @test(i32 %a, i32 %b) {\n"
+      "  %x = shl i32 %a, 4\n"
+      "  %y = and i32 %x, 255\n"
+      "  %z = or i32 %y, 1\n"
+      "  ret i32 %z\n"
+      "}\n",
+      Error, Context);
+  ASSERT_TRUE(M != nullptr);
+  const DataLayout &DL = M->getDataLayout();
+  Function *F = M->getFunction("test");
+  auto I = inst_begin(F);
+  Instruction *X = &*I++, *Y = &*I++, *Z = &*I++;
+
+  KnownBitsCache KBC;
+  APInt KnownZero(32, 0), KnownOne(32, 0);
+  computeKnownBits(Z, KnownZero, KnownOne, DL, 0, nullptr, nullptr, nullptr,
+                   &KBC);
+  EXPECT_EQ(0xffffff0eu, KnownZero.getZExtValue());
+  EXPECT_EQ(1u, KnownOne.getZExtValue());
+  EXPECT_EQ(3u, KBC.size());
+  EXPECT_TRUE(KBC.lookupKnownBits(Y, 1, KnownZero, KnownOne));
+  EXPECT_EQ(0xffffff0fu, KnownZero.getZExtValue());
+  // Y was computed one level down, so it can't answer a query about itself.
+  EXPECT_FALSE(KBC.lookupKnownBits(Y, 0, KnownZero, KnownOne));
+
+  // Changing the shift in place must forget everything derived from it.
+  X->setOperand(1, ConstantInt::get(X->getType(), 2));
+  KBC.invalidate(X);
+  EXPECT_TRUE(KBC.empty());
+  computeKnownBits(Z, KnownZero, KnownOne, DL, 0, nullptr, nullptr, nullptr,
+                   &KBC);
+  EXPECT_EQ(0xffffff02u, KnownZero.getZExtValue());
+  EXPECT_EQ(24u,
+            ComputeNumSignBits(Y, DL, 0, nullptr, nullptr, nullptr, &KBC));
+
+  // Replacing and deleting instructions updates the cache by itself.
+  Y->replaceAllUsesWith(X);
+  EXPECT_FALSE(KBC.lookupKnownBits(Z, 0, KnownZero, KnownOne));
+  Y->eraseFromParent();
+  computeKnownBits(Z, KnownZero, KnownOne, DL, 0, nullptr, nullptr, nullptr,
+                   &KBC);
+  EXPECT_EQ(2u, KnownZero.getZExtValue());
+  EXPECT_EQ(2u, KBC.size());
+}
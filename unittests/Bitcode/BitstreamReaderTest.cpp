@@ -239,3 +239,73 @@ TEST(BitstreamReaderTest, readRecordWithBlobWhileStreaming) {
 }
 
 } // end anonymous namespace
+
+TEST(BitstreamReaderTest, readRecordInMemoryMatchesStreaming) {
+  const unsigned BlockID = bitc::FIRST_APPLICATION_BLOCKID;
+  uint64_t ArrayIn[] = {0, 31, 32, 1000, UINT64_C(1) << 40, 7};
+  StringRef BlobIn = "a blob\xff";
+
+  // Write an array of VBR6, an array of Fixed(3) and an unpacked blob.
+  SmallVector<char, 1> Buffer;
+  unsigned VBRAbbrev, FixedAbbrev, BlobAbbrev;
+  {
+    BitstreamWriter Stream(Buffer);
+    Stream.EnterSubblock(BlockID, 3);
+
+    BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
+    Abbrev->Add(BitCodeAbbrevOp(1));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));
+    VBRAbbrev = Stream.EmitAbbrev(Abbrev);
+    Abbrev = new BitCodeAbbrev();
+    Abbrev->Add(BitCodeAbbrevOp(2));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 3));
+    FixedAbbrev = Stream.EmitAbbrev(Abbrev);
+    Abbrev = new BitCodeAbbrev();
+    Abbrev->Add(BitCodeAbbrevOp(3));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+    BlobAbbrev = Stream.EmitAbbrev(Abbrev);
+
+    Stream.EmitRecord(1, makeArrayRef(ArrayIn), VBRAbbrev);
+    unsigned Small[] = {1, 2, 3, 4, 5, 6, 7};
+    Stream.EmitRecord(2, makeArrayRef(Small), FixedAbbrev);
+    unsigned Record[] = {3};
+    Stream.EmitRecordWithBlob(BlobAbbrev, makeArrayRef(Record), BlobIn);
+
+    Stream.ExitBlock();
+  }
+  StringRef Bytes(Buffer.begin(), Buffer.size());
+
+  auto ReadAll = [&](BitstreamReader &R) {
+    std::vector<SmallVector<uint64_t, 8>> Records;
+    BitstreamCursor Stream(R);
+    EXPECT_EQ(BitstreamEntry::SubBlock, Stream.advance().Kind);
+    EXPECT_FALSE(Stream.EnterSubBlock(BlockID));
+    while (true) {
+      BitstreamEntry Entry = Stream.advance();
+      if (Entry.Kind != BitstreamEntry::Record)
+        break;
+      Records.emplace_back();
+      Records.back().push_back(Stream.readRecord(Entry.ID, Records.back()));
+    }
+    return Records;
+  };
+
+  BitstreamReader InMemory((const uint8_t *)Bytes.begin(),
+                           (const uint8_t *)Bytes.end());
+  EXPECT_FALSE(InMemory.getBuffer().empty());
+  BitstreamReader Streamed(llvm::make_unique<StreamingMemoryObject>(
+      llvm::make_unique<BufferStreamer>(Bytes)));
+  EXPECT_TRUE(Streamed.getBuffer().empty());
+
+  auto Records = ReadAll(InMemory);
+  ASSERT_EQ(3u, Records.size());
+  EXPECT_EQ(makeArrayRef(ArrayIn), makeArrayRef(Records[0]).drop_back());
+  EXPECT_EQ(1u, Records[0].back());
+  EXPECT_EQ(8u, Records[1].size());
+  EXPECT_EQ(7u, Records[1][6]);
+  ASSERT_EQ(BlobIn.size() + 1, Records[2].size());
+  EXPECT_EQ(0xffu, Records[2][BlobIn.size() - 1]);
+  EXPECT_EQ(Records, ReadAll(Streamed));
+}
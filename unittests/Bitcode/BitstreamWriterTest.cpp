@@ -10,6 +10,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -56,4 +57,43 @@ TEST(BitstreamWriterTest, emitBlob4ByteAligned) {
   EXPECT_EQ(StringRef("str0"), Buffer);
 }
 
+static void writeNestedBlocks(BitstreamWriter &W) {
+  W.EnterSubblock(8, 3);
+  // Make the placeholder straddle a flushed byte with other data.
+  W.Emit(5, 3);
+  uint64_t PlaceholderBit = W.GetCurrentBitNo();
+  W.Emit(0, 32);
+  W.RegisterBackpatchWord(PlaceholderBit);
+  W.Emit(7, 3);
+  for (unsigned I = 0; I != 3; ++I) {
+    W.EnterSubblock(9, 4);
+    W.EmitVBR(I, 6);
+    W.ExitBlock();
+  }
+  W.BackpatchWord(PlaceholderBit, 0xdeadbeef);
+  W.ExitBlock();
+}
+
+TEST(BitstreamWriterTest, streamToFile) {
+  SmallString<64> Expected;
+  {
+    BitstreamWriter W(Expected);
+    writeNestedBlocks(W);
+  }
+
+  // Flush after every block: both the block sizes and the placeholder are
+  // backpatched after having been written to the stream.
+  SmallString<64> Streamed;
+  raw_svector_ostream OS(Streamed);
+  OS << "abcd";
+  SmallString<64> Buffer;
+  {
+    BitstreamWriter W(Buffer, &OS, /* FlushThreshold */ 0);
+    writeNestedBlocks(W);
+  }
+  EXPECT_TRUE(Buffer.empty());
+  EXPECT_EQ(StringRef("abcd"), Streamed.substr(0, 4));
+  EXPECT_EQ(StringRef(Expected), Streamed.substr(4));
+}
+
 } // end namespace
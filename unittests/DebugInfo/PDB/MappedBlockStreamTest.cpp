@@ -234,6 +234,32 @@ TEST(MappedBlockStreamTest, UnalignedOverlappingReadFail) {
   EXPECT_EQ(10U, S.getNumBytesCopied());
 }
 
+// Tests that a read contained in an earlier cached request is served from it
+// even when a later, closer cached request does not cover it.
+TEST(MappedBlockStreamTest, ContainedReadSkipsCloserCacheEntry) {
+  DiscontiguousFile F(BlocksAry, DataAry);
+  MappedBlockStreamImpl S(llvm::make_unique<IndexedStreamData>(0, F), F);
+  StreamReader R(S);
+  StringRef Str1;
+  StringRef Str2;
+  StringRef Str3;
+  R.setOffset(2);
+  EXPECT_NO_ERROR(R.readFixedString(Str1, 3));
+  EXPECT_EQ(Str1, StringRef("CDE"));
+  EXPECT_EQ(3U, S.getNumBytesCopied());
+
+  R.setOffset(0);
+  EXPECT_NO_ERROR(R.readFixedString(Str2, 10));
+  EXPECT_EQ(Str2, StringRef("ABCDEFGHIJ"));
+  EXPECT_EQ(13U, S.getNumBytesCopied());
+
+  R.setOffset(3);
+  EXPECT_NO_ERROR(R.readFixedString(Str3, 5));
+  EXPECT_EQ(Str3, StringRef("DEFGH"));
+  EXPECT_EQ(Str2.data() + 3, Str3.data());
+  EXPECT_EQ(13U, S.getNumBytesCopied());
+}
+
 TEST(MappedBlockStreamTest, WriteBeyondEndOfStream) {
   static uint8_t Data[] = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J'};
   static uint8_t LargeBuffer[] = {'0', '1', '2', '3', '4', '5',
@@ -0,0 +1,106 @@
+//===----- CompileUtilsTest.cpp - Unit tests for the JIT compile functors -===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OrcTestCommon.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/NullResolver.h"
+#include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Mangler.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class CompileUtilsTest : public testing::Test, public OrcExecutionTest {
+protected:
+  // Build "int32_t Name(int32_t X) { int32_t Y = X; return Y * K + G; }",
+  // where G is a global in the same module, initialized to K.
+  std::unique_ptr<Module> createModule(StringRef Name, int32_t K) {
+    ModuleBuilder MB(Context, TM->getTargetTriple().str(), "compile-utils");
+    MB.getModule()->setDataLayout(TM->createDataLayout());
+    IRBuilder<> Builder(Context);
+    auto *G = new GlobalVariable(*MB.getModule(), Builder.getInt32Ty(), false,
+                                 GlobalValue::InternalLinkage,
+                                 Builder.getInt32(K), "g");
+    Function *F = MB.createFunctionDecl<int32_t(int32_t)>(Name);
+    Builder.SetInsertPoint(BasicBlock::Create(Context, "entry", F));
+    Value *Y = Builder.CreateAlloca(Builder.getInt32Ty());
+    Builder.CreateStore(&*F->arg_begin(), Y);
+    Value *Mul = Builder.CreateMul(Builder.CreateLoad(Y),
+                                   Builder.getInt32(K));
+    Builder.CreateRet(Builder.CreateAdd(Mul, Builder.CreateLoad(G)));
+    return MB.takeModule();
+  }
+
+  static StringRef getBytes(const object::OwningBinary<object::ObjectFile> &O) {
+    return O.getBinary()->getData();
+  }
+};
+
+TEST_F(CompileUtilsTest, ReusedPipelineMatchesSimpleCompiler) {
+  if (!TM)
+    return;
+
+  // Compiling through one pipeline again and again gives the same objects as
+  // building a new pipeline for each module.
+  ReusableCompiler Reusable(*TM);
+  for (unsigned Round = 0; Round != 2; ++Round)
+    for (int32_t V = 1; V != 5; ++V) {
+      std::string Name = "f" + std::to_string(V);
+      auto Expected = SimpleCompiler(*TM)(*createModule(Name, V));
+      auto Obj = Reusable(*createModule(Name, V));
+      ASSERT_TRUE(!!Obj.getBinary()) << "Reused pipeline did not compile";
+      EXPECT_EQ(getBytes(Obj), getBytes(Expected))
+          << "Reused pipeline produced a different object";
+    }
+}
+
+TEST_F(CompileUtilsTest, JITPassPipeline) {
+  if (!TM)
+    return;
+
+  ReusableCompiler Compile(*TM, [](legacy::PassManagerBase &PM) {
+    PassManagerBuilder Builder;
+    Builder.OptLevel = 1;
+    Builder.populateJITPassManager(PM);
+  });
+
+  ObjectLinkingLayer<> ObjLayer;
+  SectionMemoryManager SMMgr;
+  NullResolver NR;
+  for (int32_t V = 2; V != 4; ++V) {
+    std::string Name = "f" + std::to_string(V);
+    auto M = createModule(Name, V);
+    auto Obj = Compile(*M);
+
+    // The IR passes ran on the module: SROA removed the alloca.
+    EXPECT_FALSE(isa<AllocaInst>(M->getFunction(Name)->getEntryBlock().front()))
+        << "JIT pass pipeline did not run";
+
+    std::vector<object::ObjectFile *> Objs;
+    Objs.push_back(Obj.getBinary());
+    auto H = ObjLayer.addObjectSet(std::move(Objs), &SMMgr, &NR);
+    std::string Mangled;
+    {
+      raw_string_ostream MangledOS(Mangled);
+      Mangler::getNameWithPrefix(MangledOS, Name, TM->createDataLayout());
+    }
+    auto Sym = ObjLayer.findSymbolIn(H, Mangled, true);
+    ASSERT_TRUE(!!Sym) << "Compiled function not found";
+    auto *Fn = (int32_t (*)(int32_t))static_cast<uintptr_t>(Sym.getAddress());
+    EXPECT_EQ(Fn(10), 10 * V + V) << "Compiled function returned wrong value";
+  }
+}
+
+} // end anonymous namespace
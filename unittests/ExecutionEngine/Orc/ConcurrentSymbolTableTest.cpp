@@ -0,0 +1,107 @@
+//===- ConcurrentSymbolTableTest.cpp - Tests for ConcurrentSymbolTable ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/ConcurrentSymbolTable.h"
+#include "llvm/Config/llvm-config.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+TEST(ConcurrentSymbolTableTest, Basic) {
+  ConcurrentSymbolTable<int> Table;
+  int V = 0;
+
+  EXPECT_FALSE(Table.lookup("foo", V)) << "Empty table should find nothing";
+
+  EXPECT_TRUE(Table.insert("foo", 1)) << "insert should add a new name";
+  EXPECT_FALSE(Table.insert("foo", 2)) << "insert should keep existing names";
+  EXPECT_TRUE(Table.lookup("foo", V) && V == 1) << "Wrong value for foo";
+
+  Table.set("foo", 3);
+  EXPECT_TRUE(Table.lookup("foo", V) && V == 3) << "set should replace foo";
+
+  EXPECT_TRUE(Table.erase("foo")) << "erase should remove foo";
+  EXPECT_FALSE(Table.erase("foo")) << "foo was already erased";
+  EXPECT_FALSE(Table.lookup("foo", V)) << "foo should be gone";
+  EXPECT_EQ(Table.size(), 0U) << "Table should be empty again";
+}
+
+TEST(ConcurrentSymbolTableTest, ManyNames) {
+  // Enough names to land in every shard.
+  ConcurrentSymbolTable<unsigned> Table;
+  const unsigned NumNames = 1000;
+  for (unsigned I = 0; I != NumNames; ++I)
+    Table.set("sym" + std::to_string(I), I);
+  EXPECT_EQ(Table.size(), NumNames) << "Wrong number of names";
+
+  for (unsigned I = 0; I != NumNames; ++I) {
+    unsigned V = ~0U;
+    EXPECT_TRUE(Table.lookup("sym" + std::to_string(I), V) && V == I)
+        << "Wrong value for sym" << I;
+  }
+
+  unsigned Count = 0, Sum = 0;
+  Table.forEach([&](StringRef Name, unsigned V) {
+    EXPECT_EQ(Name, "sym" + std::to_string(V)) << "Name and value mismatch";
+    ++Count;
+    Sum += V;
+  });
+  EXPECT_EQ(Count, NumNames) << "forEach should visit every name once";
+  EXPECT_EQ(Sum, NumNames * (NumNames - 1) / 2) << "forEach missed some names";
+
+  ConcurrentSymbolTable<unsigned> Moved(std::move(Table));
+  EXPECT_EQ(Moved.size(), NumNames) << "Move should keep every name";
+}
+
+#if LLVM_ENABLE_THREADS
+TEST(ConcurrentSymbolTableTest, ConcurrentLookups) {
+  // Readers look up a fixed set of names while a writer keeps adding and
+  // removing others. The fixed names must always be found, with their value.
+  ConcurrentSymbolTable<unsigned> Table;
+  const unsigned NumFixed = 256;
+  for (unsigned I = 0; I != NumFixed; ++I)
+    Table.set("fixed" + std::to_string(I), I);
+
+  std::atomic<bool> Done(false);
+  std::atomic<unsigned> Failures(0);
+  std::vector<std::thread> Readers;
+  for (unsigned T = 0; T != 4; ++T)
+    Readers.emplace_back([&]() {
+      while (!Done) {
+        for (unsigned I = 0; I != NumFixed; ++I) {
+          unsigned V = ~0U;
+          if (!Table.lookup("fixed" + std::to_string(I), V) || V != I)
+            ++Failures;
+        }
+      }
+    });
+
+  for (unsigned Round = 0; Round != 20; ++Round) {
+    for (unsigned I = 0; I != 200; ++I)
+      Table.set("temp" + std::to_string(I), Round);
+    for (unsigned I = 0; I != 200; ++I)
+      Table.erase("temp" + std::to_string(I));
+  }
+  Done = true;
+  for (auto &Reader : Readers)
+    Reader.join();
+
+  EXPECT_EQ(Failures, 0U) << "Lookups failed during concurrent updates";
+  EXPECT_EQ(Table.size(), NumFixed) << "Temporary names were not erased";
+}
+#endif
+
+} // end anonymous namespace
@@ -10,12 +10,27 @@
 #include "OrcTestCommon.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/Support/Host.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
+using namespace llvm::orc;
 
 namespace {
 
+// The local callback and stub managers only support x86 hosts.
+static bool isSupportedHost(const Triple &TT) {
+  return (TT.getArch() == Triple::x86_64 || TT.getArch() == Triple::x86) &&
+         !TT.isOSWindows();
+}
+
+static int32_t returnOne() { return 1; }
+static int32_t returnTwo() { return 2; }
+
+static TargetAddress addressOf(int32_t (*Fn)()) {
+  return static_cast<TargetAddress>(reinterpret_cast<uintptr_t>(Fn));
+}
+
 TEST(IndirectionUtilsTest, MakeStub) {
   LLVMContext Context;
   ModuleBuilder MB(Context, "x86_64-apple-macosx10.10", "");
@@ -46,4 +61,93 @@ TEST(IndirectionUtilsTest, MakeStub) {
     << "makeStub should propagate byval attr on 2nd argument.";
 }
 
+TEST(IndirectionUtilsTest, CompileCallbacks) {
+  Triple TT(sys::getProcessTriple());
+  if (!isSupportedHost(TT))
+    return;
+
+  const TargetAddress ErrorAddr = 0xdead;
+  auto CCMgr = createLocalCompileCallbackManager(TT, ErrorAddr);
+  ASSERT_NE(CCMgr, nullptr);
+
+  // Reserve enough callbacks to need several blocks of trampolines.
+  const unsigned NumCallbacks = 2000;
+  std::vector<TargetAddress> Trampolines;
+  for (unsigned I = 0; I != NumCallbacks; ++I) {
+    auto CCInfo = CCMgr->getCompileCallback();
+    CCInfo.setCompileAction([I]() { return TargetAddress(I + 1); });
+    Trampolines.push_back(CCInfo.getAddress());
+  }
+
+  // The compile action references handed out earlier must survive growth.
+  CCMgr->getCompileCallbackInfo(Trampolines[0])
+      .setCompileAction([]() { return TargetAddress(1000000); });
+
+  for (unsigned I = NumCallbacks; I != 0; --I) {
+    TargetAddress Expected = I == 1 ? 1000000 : I;
+    EXPECT_EQ(CCMgr->executeCompileCallback(Trampolines[I - 1]), Expected)
+        << "Wrong compile action run";
+  }
+
+  // Callbacks are released once they've run.
+  EXPECT_EQ(CCMgr->executeCompileCallback(Trampolines[0]), ErrorAddr)
+      << "Released callback ran again";
+  EXPECT_EQ(CCMgr->executeCompileCallback(0), ErrorAddr)
+      << "Unknown trampoline did not go to the error handler";
+
+  // A manually released trampoline is handed out again before a new one.
+  auto CCInfo = CCMgr->getCompileCallback();
+  TargetAddress Reused = CCInfo.getAddress();
+  CCMgr->releaseCompileCallback(Reused);
+  EXPECT_EQ(CCMgr->getCompileCallback().getAddress(), Reused)
+      << "Released trampoline was not reused";
+}
+
+TEST(IndirectionUtilsTest, PooledStubs) {
+  Triple TT(sys::getProcessTriple());
+  if (!isSupportedHost(TT))
+    return;
+
+  auto Builder = createLocalIndirectStubsManagerBuilder(TT);
+  ASSERT_TRUE(!!Builder);
+
+  auto A = Builder();
+  auto B = Builder();
+  EXPECT_FALSE(A->createStub("f", addressOf(returnOne),
+                             JITSymbolFlags::Exported));
+  IndirectStubsManager::StubInitsMap Inits;
+  Inits["g"] = std::make_pair(addressOf(returnOne), JITSymbolFlags::Exported);
+  Inits["h"] = std::make_pair(addressOf(returnTwo), JITSymbolFlags::None);
+  EXPECT_FALSE(B->createStubs(Inits));
+
+  // Both managers take their stubs from the same pool.
+  TargetAddress F = A->findStub("f", false).getAddress();
+  TargetAddress G = B->findStub("g", false).getAddress();
+  TargetAddress H = B->findStub("h", false).getAddress();
+  EXPECT_NE(F, G);
+  EXPECT_NE(G, H);
+  EXPECT_TRUE(F + 4096 > G && G + 4096 > F)
+      << "Stubs of different managers are not pooled";
+  EXPECT_FALSE(B->findStub("h", true)) << "Non-exported stub was found";
+  EXPECT_FALSE(A->findStub("g", false)) << "Stub found in the wrong manager";
+
+  // Calls through the stubs go to the current implementation pointer.
+  typedef int32_t (*FnTy)();
+  FnTy FFn = reinterpret_cast<FnTy>(static_cast<uintptr_t>(F));
+  EXPECT_EQ(FFn(), 1);
+  EXPECT_FALSE(A->updatePointer("f", addressOf(returnTwo)));
+  EXPECT_EQ(FFn(), 2);
+  EXPECT_EQ(*reinterpret_cast<TargetAddress *>(static_cast<uintptr_t>(
+                A->findPointer("f").getAddress())),
+            addressOf(returnTwo));
+
+  // Stubs go back to the pool when their manager is destroyed.
+  A.reset();
+  auto C = Builder();
+  EXPECT_FALSE(C->createStub("k", addressOf(returnOne),
+                             JITSymbolFlags::Exported));
+  EXPECT_EQ(C->findStub("k", false).getAddress(), F)
+      << "Released stub was not reused";
+}
+
 }
@@ -10,12 +10,14 @@
 #include "OrcTestCommon.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/ExecutionEngine/SlabMemoryManager.h"
 #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/LambdaResolver.h"
 #include "llvm/ExecutionEngine/Orc/NullResolver.h"
 #include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Mangler.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -60,7 +62,7 @@ TEST(ObjectLinkingLayerTest, TestSetProcessAllSections) {
                                                          IsReadOnly);
     }
   private:
-    bool DebugSeen;
+    bool &DebugSeen;
   };
 
   ObjectLinkingLayer<> ObjLayer;
@@ -99,6 +101,7 @@ TEST(ObjectLinkingLayerTest, TestSetProcessAllSections) {
   {
     // Test with ProcessAllSections = false (the default).
     auto H = ObjLayer.addObjectSet(Objs, &SMMW, &*Resolver);
+    ObjLayer.emitAndFinalize(H);
     EXPECT_EQ(DebugSectionSeen, false)
       << "Unexpected debug info section";
     ObjLayer.removeObjectSet(H);
@@ -108,6 +111,7 @@ TEST(ObjectLinkingLayerTest, TestSetProcessAllSections) {
     // Test with ProcessAllSections = true.
     ObjLayer.setProcessAllSections(true);
     auto H = ObjLayer.addObjectSet(Objs, &SMMW, &*Resolver);
+    ObjLayer.emitAndFinalize(H);
     EXPECT_EQ(DebugSectionSeen, true)
       << "Expected debug info section not seen";
     ObjLayer.removeObjectSet(H);
@@ -244,4 +248,126 @@ TEST_F(ObjectLinkingLayerExecutionTest, NoPrematureAllocation) {
          "(multiple unrelated objects loaded prior to finalization)";
 }
 
+TEST_F(ObjectLinkingLayerExecutionTest, SlabMemoryReuse) {
+  if (!TM)
+    return;
+
+  ObjectLinkingLayer<> ObjLayer;
+  SimpleCompiler Compile(*TM);
+
+  ModuleBuilder MB(Context, "", "dummy");
+  {
+    MB.getModule()->setDataLayout(TM->createDataLayout());
+    Function *FooImpl = MB.createFunctionDecl<int32_t(void)>("foo");
+    BasicBlock *FooEntry = BasicBlock::Create(Context, "entry", FooImpl);
+    IRBuilder<> Builder(FooEntry);
+    IntegerType *Int32Ty = IntegerType::get(Context, 32);
+    Builder.CreateRet(ConstantInt::getSigned(Int32Ty, 42));
+  }
+  auto Obj = Compile(*MB.getModule());
+
+  std::string Mangled;
+  {
+    raw_string_ostream MangledOS(Mangled);
+    Mangler::getNameWithPrefix(MangledOS, "foo", TM->createDataLayout());
+  }
+
+  // Each object set owns its memory manager, so removing the set gives the
+  // memory back to the pool for the next one.
+  SlabAllocator Slabs;
+  NullResolver NR;
+  for (unsigned I = 0; I != 8; ++I) {
+    std::vector<object::ObjectFile*> Objs;
+    Objs.push_back(Obj.getBinary());
+    auto H = ObjLayer.addObjectSet(std::move(Objs),
+                                   llvm::make_unique<SlabMemoryManager>(Slabs),
+                                   &NR);
+    auto FooSym = ObjLayer.findSymbolIn(H, Mangled, true);
+    ASSERT_TRUE(!!FooSym);
+    auto *Foo = (int32_t (*)())static_cast<uintptr_t>(FooSym.getAddress());
+    EXPECT_EQ(Foo(), 42);
+    ObjLayer.removeObjectSet(H);
+  }
+  EXPECT_EQ(Slabs.getNumSlabs(), 1U);
+}
+
+static int32_t returnForty() { return 40; }
+static int32_t returnTwo() { return 2; }
+
+TEST_F(ObjectLinkingLayerExecutionTest, BatchedSymbolLookup) {
+  if (!TM)
+    return;
+
+  ObjectLinkingLayer<> ObjLayer;
+  SimpleCompiler Compile(*TM);
+
+  // int forty();
+  // int two();
+  // int foo() { return forty() + two(); }
+  ModuleBuilder MB(Context, "", "dummy");
+  {
+    MB.getModule()->setDataLayout(TM->createDataLayout());
+    Function *FortyDecl = MB.createFunctionDecl<int32_t(void)>("forty");
+    Function *TwoDecl = MB.createFunctionDecl<int32_t(void)>("two");
+    Function *FooImpl = MB.createFunctionDecl<int32_t(void)>("foo");
+    BasicBlock *FooEntry = BasicBlock::Create(Context, "entry", FooImpl);
+    IRBuilder<> Builder(FooEntry);
+    Builder.CreateRet(Builder.CreateAdd(Builder.CreateCall(FortyDecl),
+                                        Builder.CreateCall(TwoDecl)));
+  }
+  auto Obj = Compile(*MB.getModule());
+  std::vector<object::ObjectFile*> Objs;
+  Objs.push_back(Obj.getBinary());
+
+  auto Mangle = [&](StringRef Name) {
+    std::string Mangled;
+    raw_string_ostream MangledOS(Mangled);
+    Mangler::getNameWithPrefix(MangledOS, Name, TM->createDataLayout());
+    return MangledOS.str();
+  };
+
+  class BatchingResolver : public RuntimeDyld::SymbolResolver {
+  public:
+    std::map<std::string, uintptr_t> Symbols;
+    std::vector<std::vector<std::string>> Batches;
+
+    RuntimeDyld::SymbolInfo
+    findSymbolInLogicalDylib(const std::string &Name) override {
+      ADD_FAILURE() << "Single lookup of " << Name;
+      return nullptr;
+    }
+
+    RuntimeDyld::SymbolInfo findSymbol(const std::string &Name) override {
+      ADD_FAILURE() << "Single lookup of " << Name;
+      return nullptr;
+    }
+
+    std::vector<RuntimeDyld::SymbolInfo>
+    findSymbolsForLinking(ArrayRef<std::string> Names) override {
+      Batches.push_back(Names);
+      std::vector<RuntimeDyld::SymbolInfo> Result;
+      for (const std::string &Name : Names)
+        Result.push_back(
+            RuntimeDyld::SymbolInfo(Symbols[Name], JITSymbolFlags::Exported));
+      return Result;
+    }
+  };
+
+  BatchingResolver Resolver;
+  Resolver.Symbols[Mangle("forty")] = reinterpret_cast<uintptr_t>(&returnForty);
+  Resolver.Symbols[Mangle("two")] = reinterpret_cast<uintptr_t>(&returnTwo);
+
+  auto H = ObjLayer.addObjectSet(std::move(Objs),
+                                 llvm::make_unique<SectionMemoryManager>(),
+                                 &Resolver);
+  auto FooSym = ObjLayer.findSymbolIn(H, Mangle("foo"), true);
+  ASSERT_TRUE(!!FooSym);
+  auto *Foo = (int32_t (*)())static_cast<uintptr_t>(FooSym.getAddress());
+  EXPECT_EQ(Foo(), 42);
+
+  // Both external symbols were looked up by a single query.
+  ASSERT_EQ(Resolver.Batches.size(), 1U);
+  EXPECT_EQ(Resolver.Batches[0].size(), 2U);
+}
+
 } // end anonymous namespace
@@ -0,0 +1,145 @@
+//===- PersistentObjectCacheTest.cpp - Unit tests for the JIT object cache ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OrcTestCommon.h"
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/LambdaResolver.h"
+#include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Mangler.h"
+#include "llvm/Support/FileSystem.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class PersistentObjectCacheTest : public testing::Test,
+                                  public OrcExecutionTest {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("orc-object-cache", CacheDir));
+  }
+
+  void TearDown() override {
+    std::error_code EC;
+    for (sys::fs::directory_iterator File(CacheDir, EC), FileEnd;
+         File != FileEnd && !EC; File.increment(EC))
+      sys::fs::remove(File->path());
+    sys::fs::remove(CacheDir);
+  }
+
+  // Build "int32_t Name() { return Value; }".
+  std::unique_ptr<Module> createModule(LLVMContext &Ctx, StringRef Name,
+                                       int32_t Value) {
+    ModuleBuilder MB(Ctx, TM->getTargetTriple().str(), "cached");
+    MB.getModule()->setDataLayout(TM->createDataLayout());
+    Function *F = MB.createFunctionDecl<int32_t(void)>(Name);
+    BasicBlock *Entry = BasicBlock::Create(Ctx, "entry", F);
+    IRBuilder<> Builder(Entry);
+    Builder.CreateRet(ConstantInt::getSigned(Builder.getInt32Ty(), Value));
+    return MB.takeModule();
+  }
+
+  SmallString<128> CacheDir;
+};
+
+TEST_F(PersistentObjectCacheTest, StoreAndLoad) {
+  if (!TM)
+    return;
+
+  PersistentObjectCache Cache(CacheDir.str(), *TM);
+  auto M = createModule(Context, "foo", 42);
+  EXPECT_EQ(Cache.getObject(M.get()), nullptr);
+
+  auto Obj = SimpleCompiler(*TM)(*M);
+  ASSERT_NE(Obj.getBinary(), nullptr);
+  MemoryBufferRef ObjBuffer = Obj.getBinary()->getMemoryBufferRef();
+  Cache.notifyObjectCompiled(M.get(), ObjBuffer);
+  EXPECT_TRUE(sys::fs::exists(Cache.getEntryPath(*M)));
+
+  std::unique_ptr<MemoryBuffer> Cached = Cache.getObject(M.get());
+  ASSERT_NE(Cached, nullptr);
+  EXPECT_EQ(Cached->getBuffer(), ObjBuffer.getBuffer());
+
+  // The same IR in another context, as after a restart, finds the entry.
+  LLVMContext OtherContext;
+  auto SameM = createModule(OtherContext, "foo", 42);
+  EXPECT_EQ(Cache.getEntryPath(*SameM), Cache.getEntryPath(*M));
+  EXPECT_NE(Cache.getObject(SameM.get()), nullptr);
+
+  // Different IR does not.
+  auto OtherM = createModule(Context, "foo", 43);
+  EXPECT_NE(Cache.getEntryPath(*OtherM), Cache.getEntryPath(*M));
+  EXPECT_EQ(Cache.getObject(OtherM.get()), nullptr);
+}
+
+TEST_F(PersistentObjectCacheTest, KeyIncludesTarget) {
+  if (!TM)
+    return;
+
+  std::unique_ptr<TargetMachine> OtherTM(EngineBuilder().setOptLevel(
+      TM->getOptLevel() == CodeGenOpt::None ? CodeGenOpt::Default
+                                            : CodeGenOpt::None)
+                                             .selectTarget());
+  ASSERT_NE(OtherTM, nullptr);
+
+  PersistentObjectCache Cache(CacheDir.str(), *TM);
+  PersistentObjectCache OtherCache(CacheDir.str(), *OtherTM);
+  auto M = createModule(Context, "foo", 42);
+  EXPECT_NE(Cache.getEntryPath(*M), OtherCache.getEntryPath(*M));
+}
+
+TEST_F(PersistentObjectCacheTest, IRCompileLayer) {
+  if (!TM)
+    return;
+
+  unsigned NumCompiles = 0;
+  SimpleCompiler Compile(*TM);
+  auto CountingCompile = [&](Module &M) {
+    ++NumCompiles;
+    return Compile(M);
+  };
+
+  for (unsigned Run = 0; Run != 2; ++Run) {
+    // Each run uses a fresh JIT and cache, only the directory is shared.
+    ObjectLinkingLayer<> ObjLayer;
+    IRCompileLayer<decltype(ObjLayer)> CompileLayer(ObjLayer, CountingCompile);
+    PersistentObjectCache Cache(CacheDir.str(), *TM);
+    CompileLayer.setObjectCache(&Cache);
+
+    LLVMContext Ctx;
+    std::vector<std::unique_ptr<Module>> Ms;
+    Ms.push_back(createModule(Ctx, "foo", 42));
+
+    auto Resolver = createLambdaResolver(
+        [](const std::string &Name) { return RuntimeDyld::SymbolInfo(nullptr); },
+        [](const std::string &Name) { return RuntimeDyld::SymbolInfo(nullptr); });
+    auto H = CompileLayer.addModuleSet(std::move(Ms),
+                                       llvm::make_unique<SectionMemoryManager>(),
+                                       std::move(Resolver));
+
+    std::string Mangled;
+    {
+      raw_string_ostream MangledOS(Mangled);
+      Mangler::getNameWithPrefix(MangledOS, "foo", TM->createDataLayout());
+    }
+    auto FooSym = CompileLayer.findSymbolIn(H, Mangled, true);
+    ASSERT_TRUE(!!FooSym);
+    auto *Foo = (int32_t (*)())static_cast<uintptr_t>(FooSym.getAddress());
+    EXPECT_EQ(Foo(), 42);
+    EXPECT_EQ(NumCompiles, 1U) << "Second run should load the cached object";
+  }
+}
+
+} // namespace
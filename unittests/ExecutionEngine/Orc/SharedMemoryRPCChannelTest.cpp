@@ -0,0 +1,122 @@
+//===- SharedMemoryRPCChannelTest.cpp - Unit tests for the shm RPC channel ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/SharedMemoryRPCChannel.h"
+#include "llvm/ExecutionEngine/Orc/RPCUtils.h"
+#include "llvm/Support/FileSystem.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+
+using namespace llvm;
+using namespace llvm::orc;
+using namespace llvm::orc::remote;
+
+namespace {
+
+class SharedMemoryRPC : public testing::Test,
+                        public RPC<SharedMemoryRPCChannel> {
+public:
+  enum FuncId : uint32_t {
+    IntIntId = RPCFunctionIdTraits<FuncId>::FirstValidId,
+    EchoBytesId
+  };
+
+  typedef Function<IntIntId, int32_t(int32_t)> IntInt;
+  typedef Function<EchoBytesId, std::vector<uint8_t>(std::vector<uint8_t>)>
+      EchoBytes;
+
+protected:
+  void createChannel(uint64_t RingSize) {
+    SmallString<128> Path;
+    ASSERT_FALSE(sys::fs::createTemporaryFile("orc-rpc", "shm", Path));
+    auto ClientOrErr = SharedMemoryRPCChannel::create(Path, RingSize);
+    ASSERT_TRUE(!!ClientOrErr) << "Could not create channel";
+    Client = std::move(*ClientOrErr);
+    auto ServerOrErr = SharedMemoryRPCChannel::open(Path);
+    ASSERT_TRUE(!!ServerOrErr) << "Could not open channel";
+    Server = std::move(*ServerOrErr);
+  }
+
+  std::unique_ptr<SharedMemoryRPCChannel> Client, Server;
+};
+
+TEST_F(SharedMemoryRPC, BatchedCalls) {
+  createChannel(1 << 16);
+
+  // Queue several calls, then make them visible to the server in one go.
+  std::vector<AsyncCallResult<IntInt>> Results;
+  uint16_t LastSeqNo = 0;
+  for (int32_t I = 0; I != 16; ++I) {
+    auto ResOrErr = appendCallAsyncWithSeq<IntInt>(*Client, I);
+    ASSERT_TRUE(!!ResOrErr) << "Could not append call";
+    Results.push_back(std::move(ResOrErr->first));
+    LastSeqNo = ResOrErr->second;
+  }
+  EXPECT_FALSE(Client->send()) << "Could not send calls";
+
+  for (int32_t I = 0; I != 16; ++I) {
+    auto EC = expect<IntInt>(*Server, [&](int32_t X) -> Expected<int32_t> {
+      EXPECT_EQ(X, I) << "Calls arrived out of order";
+      return 2 * X;
+    });
+    EXPECT_FALSE(EC) << "Could not handle call";
+  }
+
+  EXPECT_FALSE(waitForResult(*Client, LastSeqNo, handleNone))
+      << "Could not read results";
+  for (int32_t I = 0; I != 16; ++I) {
+    auto Val = Results[I].get();
+    ASSERT_TRUE(!!Val) << "Remote int function failed to execute";
+    EXPECT_EQ(*Val, 2 * I);
+  }
+}
+
+TEST_F(SharedMemoryRPC, MessagesLargerThanRing) {
+  createChannel(4096);
+
+  // The server has to drain the ring while the call is still being written.
+  std::thread ServerThread([&]() {
+    auto EC = expect<EchoBytes>(
+        *Server, [](std::vector<uint8_t> &Bytes)
+                     -> Expected<std::vector<uint8_t>> { return Bytes; });
+    EXPECT_FALSE(EC) << "Could not handle call";
+  });
+
+  std::vector<uint8_t> Bytes(3 * 4096 + 123);
+  for (unsigned I = 0; I != Bytes.size(); ++I)
+    Bytes[I] = I * 7;
+  auto Result = callST<EchoBytes>(*Client, Bytes);
+  ServerThread.join();
+
+  ASSERT_TRUE(!!Result) << "Remote echo failed";
+  EXPECT_EQ(*Result, Bytes) << "Bytes were corrupted in transit";
+}
+
+TEST_F(SharedMemoryRPC, ClosedChannel) {
+  createChannel(4096);
+
+  int32_t Val = 0;
+  EXPECT_FALSE(serialize(*Client, int32_t(42)));
+  EXPECT_FALSE(Client->send());
+  Client->close();
+
+  // Bytes sent before the channel was closed can still be read, after that
+  // reads fail rather than block.
+  EXPECT_FALSE(deserialize(*Server, Val));
+  EXPECT_EQ(Val, 42);
+  Error Err = deserialize(*Server, Val);
+  EXPECT_TRUE(!!Err) << "Read from a closed channel succeeded";
+  consumeError(std::move(Err));
+  Err = Server->send();
+  EXPECT_TRUE(!!Err) << "Send on a closed channel succeeded";
+  consumeError(std::move(Err));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,209 @@
+//===- TieredCompileLayerTest.cpp - Unit tests for tiered compilation -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OrcTestCommon.h"
+#include "llvm/ExecutionEngine/Orc/TieredCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/LambdaResolver.h"
+#include "llvm/ExecutionEngine/Orc/NullResolver.h"
+#include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Mangler.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class TieredCompileLayerTest : public testing::Test, public OrcExecutionTest {
+protected:
+  std::string mangle(StringRef Name) {
+    std::string Mangled;
+    raw_string_ostream MangledOS(Mangled);
+    Mangler::getNameWithPrefix(MangledOS, Name, TM->createDataLayout());
+    return MangledOS.str();
+  }
+
+  template <typename LayerT, typename HandleT>
+  int32_t (*getFunction(LayerT &Layer, HandleT H, StringRef Name))() {
+    auto Sym = Layer.findSymbolIn(H, mangle(Name), true);
+    EXPECT_TRUE(!!Sym) << "Missing symbol " << Name;
+    if (!Sym)
+      return nullptr;
+    return (int32_t (*)())static_cast<uintptr_t>(Sym.getAddress());
+  }
+};
+
+struct TierUpLog {
+  std::vector<uint64_t> Keys;
+
+  static void callback(void *Log, uint64_t Key) {
+    static_cast<TierUpLog *>(Log)->Keys.push_back(Key);
+  }
+};
+
+TEST_F(TieredCompileLayerTest, CallCounter) {
+  if (!TM)
+    return;
+
+  // int32_t foo() { return 42; }
+  ModuleBuilder MB(Context, TM->getTargetTriple().str(), "counted");
+  MB.getModule()->setDataLayout(TM->createDataLayout());
+  Function *Foo = MB.createFunctionDecl<int32_t(void)>("foo");
+  {
+    BasicBlock *Entry = BasicBlock::Create(Context, "entry", Foo);
+    IRBuilder<> Builder(Entry);
+    Builder.CreateAlloca(Builder.getInt32Ty());
+    Builder.CreateRet(ConstantInt::getSigned(Builder.getInt32Ty(), 42));
+  }
+
+  TierUpLog Log;
+  addTierUpCounter(*Foo, /*Threshold=*/5, /*PollInterval=*/4,
+                   static_cast<TargetAddress>(
+                     reinterpret_cast<uintptr_t>(&TierUpLog::callback)),
+                   static_cast<TargetAddress>(
+                     reinterpret_cast<uintptr_t>(&Log)),
+                   7);
+  EXPECT_TRUE(isa<AllocaInst>(Foo->getEntryBlock().front()))
+    << "Static allocas should stay in the entry block";
+
+  ObjectLinkingLayer<> ObjLayer;
+  IRCompileLayer<decltype(ObjLayer)> CompileLayer(ObjLayer,
+                                                  SimpleCompiler(*TM));
+  std::vector<std::unique_ptr<Module>> Ms;
+  Ms.push_back(MB.takeModule());
+  NullResolver NR;
+  auto H = CompileLayer.addModuleSet(std::move(Ms),
+                                     llvm::make_unique<SectionMemoryManager>(),
+                                     &NR);
+  auto *FooFn = getFunction(CompileLayer, H, "foo");
+  ASSERT_NE(FooFn, nullptr);
+
+  for (unsigned I = 0; I != 4; ++I)
+    EXPECT_EQ(FooFn(), 42);
+  EXPECT_TRUE(Log.Keys.empty()) << "Callback before the threshold";
+
+  // The fifth call reaches the threshold, then every fourth call polls.
+  EXPECT_EQ(FooFn(), 42);
+  ASSERT_EQ(Log.Keys.size(), 1U);
+  EXPECT_EQ(Log.Keys[0], 7U);
+  for (unsigned I = 0; I != 3; ++I)
+    FooFn();
+  EXPECT_EQ(Log.Keys.size(), 2U);
+}
+
+TEST_F(TieredCompileLayerTest, RecompileHotFunction) {
+  if (!TM)
+    return;
+
+  std::unique_ptr<TargetMachine> OptTM(
+    EngineBuilder().setOptLevel(CodeGenOpt::Aggressive).selectTarget());
+  ASSERT_NE(OptTM, nullptr);
+
+  typedef ObjectLinkingLayer<> ObjLayerT;
+  typedef TieredCompileLayer<ObjLayerT> TieredLayerT;
+  typedef CompileOnDemandLayer<TieredLayerT> CODLayerT;
+
+  std::map<std::string, TargetAddress> Updates;
+  CODLayerT *CODLayerPtr = nullptr;
+  unsigned NumOptimized = 0;
+
+  ObjLayerT ObjLayer;
+  TieredLayerT TieredLayer(
+    ObjLayer, SimpleCompiler(*TM),
+    [&](Module &M) {
+      ++NumOptimized;
+      return SimpleCompiler(*OptTM)(M);
+    },
+    [&](const std::string &Name, TargetAddress Addr) {
+      Updates[Name] = Addr;
+      return CODLayerPtr->updatePointer(Name, Addr);
+    },
+    /*HotThreshold=*/10, /*PollInterval=*/4);
+
+  auto CCMgr = createLocalCompileCallbackManager(TM->getTargetTriple(), 0);
+  ASSERT_NE(CCMgr, nullptr);
+  CODLayerT CODLayer(TieredLayer,
+                     [](Function &F) {
+                       std::set<Function*> Partition;
+                       Partition.insert(&F);
+                       return Partition;
+                     },
+                     *CCMgr,
+                     createLocalIndirectStubsManagerBuilder(
+                       TM->getTargetTriple()));
+  CODLayerPtr = &CODLayer;
+
+  // int32_t foo() { return 42; }
+  // int32_t bar() { return foo() + 1; }
+  ModuleBuilder MB(Context, TM->getTargetTriple().str(), "tiered");
+  MB.getModule()->setDataLayout(TM->createDataLayout());
+  {
+    Function *Foo = MB.createFunctionDecl<int32_t(void)>("foo");
+    IRBuilder<> Builder(BasicBlock::Create(Context, "entry", Foo));
+    Builder.CreateRet(ConstantInt::getSigned(Builder.getInt32Ty(), 42));
+
+    Function *Bar = MB.createFunctionDecl<int32_t(void)>("bar");
+    Builder.SetInsertPoint(BasicBlock::Create(Context, "entry", Bar));
+    Builder.CreateRet(Builder.CreateAdd(Builder.CreateCall(Foo),
+                                        Builder.getInt32(1)));
+  }
+
+  auto Resolver = createLambdaResolver(
+    [&](const std::string &Name) {
+      if (auto Sym = CODLayer.findSymbol(Name, true))
+        return Sym.toRuntimeDyldSymbol();
+      return RuntimeDyld::SymbolInfo(nullptr);
+    },
+    [](const std::string &Name) {
+      return RuntimeDyld::SymbolInfo(nullptr);
+    });
+  std::vector<std::unique_ptr<Module>> Ms;
+  Ms.push_back(MB.takeModule());
+  auto H = CODLayer.addModuleSet(std::move(Ms),
+                                 llvm::make_unique<SectionMemoryManager>(),
+                                 std::move(Resolver));
+
+  auto *BarFn = getFunction(CODLayer, H, "bar");
+  ASSERT_NE(BarFn, nullptr);
+
+  for (unsigned I = 0; I != 9; ++I)
+    EXPECT_EQ(BarFn(), 43);
+  TieredLayer.waitForOptimizedCode();
+  EXPECT_EQ(NumOptimized, 0U) << "Recompiled before the threshold";
+
+  // Both functions pass the threshold on the tenth call.
+  EXPECT_EQ(BarFn(), 43);
+  TieredLayer.waitForOptimizedCode();
+  EXPECT_EQ(NumOptimized, 2U);
+
+  // The stubs now lead to the optimized bodies.
+  for (StringRef Name : {"foo", "bar"}) {
+    std::string Mangled = mangle(Name);
+    ASSERT_EQ(Updates.count(Mangled), 1U) << Name << " was not updated";
+    auto PtrSym = CODLayer.findSymbol(Mangled + "$stub_ptr", false);
+    ASSERT_TRUE(!!PtrSym);
+    EXPECT_EQ(*reinterpret_cast<uintptr_t *>(
+                static_cast<uintptr_t>(PtrSym.getAddress())),
+              Updates[Mangled]);
+  }
+
+  for (unsigned I = 0; I != 100; ++I)
+    EXPECT_EQ(BarFn(), 43);
+  TieredLayer.waitForOptimizedCode();
+  EXPECT_EQ(NumOptimized, 2U) << "Optimized functions were recompiled";
+
+  CODLayer.removeModuleSet(H);
+}
+
+} // end anonymous namespace
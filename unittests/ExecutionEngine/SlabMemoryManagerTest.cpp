@@ -0,0 +1,140 @@
+//===- SlabMemoryManagerTest.cpp - Unit tests for the slab memory manager -===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/SlabMemoryManager.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Process.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+TEST(SlabMemoryManagerTest, ReservedAllocations) {
+  SlabAllocator Slabs;
+  SlabMemoryManager MemMgr(Slabs);
+  size_t PageSize = sys::Process::getPageSize();
+
+  MemMgr.reserveAllocationSpace(512, 16, 256, 16, 256, 16);
+  uint8_t *code1 = MemMgr.allocateCodeSection(256, 0, 1, "");
+  uint8_t *code2 = MemMgr.allocateCodeSection(256, 0, 2, "");
+  uint8_t *rodata = MemMgr.allocateDataSection(256, 0, 3, "", true);
+  uint8_t *rwdata = MemMgr.allocateDataSection(256, 0, 4, "", false);
+
+  ASSERT_NE((uint8_t*)nullptr, code1);
+  ASSERT_NE((uint8_t*)nullptr, code2);
+  ASSERT_NE((uint8_t*)nullptr, rodata);
+  ASSERT_NE((uint8_t*)nullptr, rwdata);
+  EXPECT_EQ(code1 + 256, code2);
+
+  // Memory with different permissions never shares a page.
+  uintptr_t CodePage = (uintptr_t)code1 / PageSize;
+  uintptr_t ROPage = (uintptr_t)rodata / PageSize;
+  uintptr_t RWPage = (uintptr_t)rwdata / PageSize;
+  EXPECT_NE(CodePage, ROPage);
+  EXPECT_NE(CodePage, RWPage);
+  EXPECT_NE(ROPage, RWPage);
+
+  for (unsigned i = 0; i < 256; ++i) {
+    code1[i] = 1;
+    code2[i] = 2;
+    rodata[i] = 3;
+    rwdata[i] = 4;
+  }
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr.finalizeMemory(&Error));
+
+  for (unsigned i = 0; i < 256; ++i) {
+    EXPECT_EQ(1, code1[i]);
+    EXPECT_EQ(2, code2[i]);
+    EXPECT_EQ(3, rodata[i]);
+    EXPECT_EQ(4, rwdata[i]);
+  }
+
+  // Read-write data stays writable.
+  rwdata[0] = 5;
+  EXPECT_EQ(5, rwdata[0]);
+
+  // Sections allocated after finalization don't land on protected pages.
+  uint8_t *code3 = MemMgr.allocateCodeSection(256, 0, 5, "");
+  ASSERT_NE((uint8_t*)nullptr, code3);
+  EXPECT_NE(CodePage, (uintptr_t)code3 / PageSize);
+  code3[0] = 6;
+  EXPECT_FALSE(MemMgr.finalizeMemory(&Error));
+}
+
+TEST(SlabMemoryManagerTest, UnreservedAllocations) {
+  SlabAllocator Slabs;
+  SlabMemoryManager MemMgr(Slabs);
+
+  uint8_t *code = MemMgr.allocateCodeSection(256, 64, 1, "");
+  uint8_t *data = MemMgr.allocateDataSection(0x100000, 0, 2, "", false);
+  ASSERT_NE((uint8_t*)nullptr, code);
+  ASSERT_NE((uint8_t*)nullptr, data);
+  EXPECT_EQ(0U, (uintptr_t)code % 64);
+
+  for (unsigned i = 0; i < 256; ++i)
+    code[i] = 1;
+  for (unsigned i = 0; i < 0x100000; ++i)
+    data[i] = 2;
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr.finalizeMemory(&Error));
+  EXPECT_EQ(1, code[255]);
+  EXPECT_EQ(2, data[0xfffff]);
+}
+
+TEST(SlabMemoryManagerTest, SharedSlabs) {
+  SlabAllocator Slabs;
+
+  // Many small objects fit in a single slab.
+  {
+    std::vector<std::unique_ptr<SlabMemoryManager>> MemMgrs;
+    for (unsigned i = 0; i < 32; ++i) {
+      MemMgrs.push_back(make_unique<SlabMemoryManager>(Slabs));
+      SlabMemoryManager &MemMgr = *MemMgrs.back();
+      MemMgr.reserveAllocationSpace(100, 16, 100, 8, 100, 8);
+      MemMgr.allocateCodeSection(100, 16, 1, "")[0] = 1;
+      MemMgr.allocateDataSection(100, 8, 2, "", true)[0] = 2;
+      MemMgr.allocateDataSection(100, 8, 3, "", false)[0] = 3;
+      EXPECT_FALSE(MemMgr.finalizeMemory());
+    }
+    EXPECT_EQ(1U, Slabs.getNumSlabs());
+  }
+
+  // Freed memory is reused, and is writable again.
+  SlabMemoryManager MemMgr(Slabs);
+  MemMgr.reserveAllocationSpace(100, 16, 0, 1, 0, 1);
+  uint8_t *code = MemMgr.allocateCodeSection(100, 16, 1, "");
+  ASSERT_NE((uint8_t*)nullptr, code);
+  code[0] = 4;
+  EXPECT_FALSE(MemMgr.finalizeMemory());
+  EXPECT_EQ(1U, Slabs.getNumSlabs());
+}
+
+TEST(SlabMemoryManagerTest, LargeAllocationsAreReleased) {
+  SlabAllocator Slabs(0x10000);
+
+  {
+    SlabMemoryManager Small(Slabs);
+    Small.allocateCodeSection(256, 0, 1, "")[0] = 1;
+    {
+      SlabMemoryManager Large(Slabs);
+      Large.allocateCodeSection(0x100000, 0, 1, "")[0x100000 - 1] = 2;
+      EXPECT_EQ(2U, Slabs.getNumSlabs());
+    }
+    EXPECT_EQ(1U, Slabs.getNumSlabs());
+  }
+
+  // The last empty slab is kept for reuse.
+  EXPECT_EQ(1U, Slabs.getNumSlabs());
+}
+
+} // end anonymous namespace
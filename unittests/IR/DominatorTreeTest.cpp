@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/IR/Dominators.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/PostDominators.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/Constants.h"
@@ -251,6 +252,90 @@ namespace llvm {
       Passes.add(P);
       Passes.run(*M);
     }
+
+    // A chain of blocks that all end in a switch defaulting to the exit
+    // block, so that edges can be added and removed as switch cases.
+    std::unique_ptr<Module> makeSwitchChain(LLVMContext &Context,
+                                            unsigned NumBlocks) {
+      std::string Str = "define void @f(i32 %x) {\n";
+      for (unsigned I = 0; I != NumBlocks; ++I) {
+        Str += "bb" + utostr(I) + ":\n  switch i32 %x, label %exit [\n";
+        if (I + 1 != NumBlocks)
+          Str += "    i32 0, label %bb" + utostr(I + 1) + "\n";
+        Str += "  ]\n";
+      }
+      Str += "exit:\n  ret void\n}\n";
+      SMDiagnostic Err;
+      return parseAssemblyString(Str, Err, Context);
+    }
+
+    // Make a pseudo-random change to the CFG of the switch chain F, and
+    // return it.
+    DominatorTree::UpdateType changeSwitchChain(Function &F, unsigned &Seed) {
+      auto Rand = [&Seed](unsigned N) {
+        Seed = Seed * 1103515245 + 12345;
+        return (Seed >> 16) % N;
+      };
+      std::vector<BasicBlock *> Blocks;
+      for (BasicBlock &BB : F)
+        if (isa<SwitchInst>(BB.getTerminator()))
+          Blocks.push_back(&BB);
+
+      // Leave the entry block and its edge to bb1 alone, so that bb1
+      // dominates all the changes and the tree is not just recalculated
+      // from its root.
+      BasicBlock *From = Blocks[Rand(Blocks.size() - 1) + 1];
+      SwitchInst *SI = cast<SwitchInst>(From->getTerminator());
+      if (SI->getNumCases() && Rand(2)) {
+        SwitchInst::CaseIt Case(SI, Rand(SI->getNumCases()));
+        BasicBlock *To = Case.getCaseSuccessor();
+        SI->removeCase(Case);
+        return {DominatorTree::Delete, From, To};
+      }
+      BasicBlock *To = Blocks[Rand(Blocks.size() - 2) + 2];
+      Type *Int32Ty = Type::getInt32Ty(F.getContext());
+      SI->addCase(ConstantInt::get(cast<IntegerType>(Int32Ty), Seed), To);
+      return {DominatorTree::Insert, From, To};
+    }
+
+    TEST(DominatorTree, InsertDeleteEdges) {
+      LLVMContext Context;
+      std::unique_ptr<Module> M = makeSwitchChain(Context, 16);
+      Function &F = *M->getFunction("f");
+      DominatorTree DT(F);
+      unsigned Seed = 1;
+      for (unsigned I = 0; I != 500; ++I) {
+        DominatorTree::UpdateType U = changeSwitchChain(F, Seed);
+        if (U.Kind == DominatorTree::Insert)
+          DT.insertEdge(U.From, U.To);
+        else
+          DT.deleteEdge(U.From, U.To);
+        DominatorTree Fresh(F);
+        ASSERT_FALSE(DT.compare(Fresh)) << "after update " << I;
+      }
+    }
+
+    TEST(DominatorTree, DeferredUpdates) {
+      LLVMContext Context;
+      std::unique_ptr<Module> M = makeSwitchChain(Context, 64);
+      Function &F = *M->getFunction("f");
+      DominatorTree DT(F);
+      DeferredDominance DDT(DT);
+      unsigned Seed = 7;
+      for (unsigned I = 0; I != 200; ++I) {
+        for (unsigned J = 0; J != 6; ++J) {
+          DominatorTree::UpdateType U = changeSwitchChain(F, Seed);
+          if (U.Kind == DominatorTree::Insert)
+            DDT.insertEdge(U.From, U.To);
+          else
+            DDT.deleteEdge(U.From, U.To);
+        }
+        EXPECT_TRUE(DDT.pending());
+        DominatorTree Fresh(F);
+        ASSERT_FALSE(DDT.flush().compare(Fresh)) << "after batch " << I;
+        EXPECT_FALSE(DDT.pending());
+      }
+    }
   }
 }
 
@@ -0,0 +1,96 @@
+//===- llvm/unittest/IR/MemoryUsageTest.cpp - IR memory usage tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/MemoryUsage.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+using namespace llvm;
+
+namespace {
+
+const IRMemoryUsage::Entry *findEntry(ArrayRef<IRMemoryUsage::Entry> Entries,
+                                      StringRef Name) {
+  for (const IRMemoryUsage::Entry &E : Entries)
+    if (Name == E.Name)
+      return &E;
+  return nullptr;
+}
+
+TEST(IRMemoryUsageTest, CountsInstructions) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString("define i32 @f(i32 %x) {\n"
+                                                  "  %y = add i32 %x, 1\n"
+                                                  "  ret i32 %y\n"
+                                                  "}\n",
+                                                  Err, C);
+  ASSERT_TRUE(M != nullptr);
+
+  IRMemoryUsage Before(*M);
+  const IRMemoryUsage::Entry *Insts =
+      findEntry(Before.getModuleEntries(), "Instructions");
+  ASSERT_TRUE(Insts != nullptr);
+  EXPECT_EQ(2u, Insts->Count);
+  EXPECT_LT(0u, Insts->Bytes);
+  uint64_t InstBytes = Insts->Bytes;
+  uint64_t TotalBytes = Before.getTotalBytes();
+
+  Function *F = M->getFunction("f");
+  IRBuilder<> B(&F->front().back());
+  B.CreateMul(&*F->arg_begin(), B.getInt32(3));
+
+  IRMemoryUsage After(*M);
+  Insts = findEntry(After.getModuleEntries(), "Instructions");
+  ASSERT_TRUE(Insts != nullptr);
+  EXPECT_EQ(3u, Insts->Count);
+  EXPECT_LT(InstBytes, Insts->Bytes);
+  EXPECT_LT(TotalBytes, After.getTotalBytes());
+}
+
+TEST(IRMemoryUsageTest, CountsValues) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M =
+      parseAssemblyString("@g = global [2 x i32] [i32 1, i32 2]\n"
+                          "define i32 @f(i32 %x) {\n"
+                          "  %y = add i32 %x, 1\n"
+                          "  %z = add i32 %y, 1\n"
+                          "  ret i32 %z\n"
+                          "}\n",
+                          Err, C);
+  ASSERT_TRUE(M != nullptr);
+
+  IRMemoryUsage Usage(*M);
+  const IRMemoryUsage::ValueKinds &Values = Usage.getValues();
+  EXPECT_EQ(1u, Values.Functions.Count);
+  EXPECT_EQ(1u, Values.GlobalVariables.Count);
+  EXPECT_EQ(1u, Values.Arguments.Count);
+  EXPECT_EQ(1u, Values.BasicBlocks.Count);
+  EXPECT_EQ(3u, Values.Instructions.Count);
+  EXPECT_EQ(5u, Values.Instructions.Operands);
+  // The initializer of @g and "i32 1", which is only counted once.
+  EXPECT_EQ(2u, Values.Constants.Count);
+}
+
+TEST(IRMemoryUsageTest, Print) {
+  LLVMContext C;
+  Module M("m", C);
+  std::string Str;
+  raw_string_ostream OS(Str);
+  IRMemoryUsage(M).print(OS);
+  EXPECT_NE(std::string::npos, OS.str().find("IR memory usage"));
+  EXPECT_NE(std::string::npos, OS.str().find("Types"));
+}
+
+} // end anonymous namespace
@@ -1061,6 +1061,23 @@ TEST_F(DIDerivedTypeTest, getWithLargeValues) {
   EXPECT_EQ(UINT64_MAX - 2, N->getOffsetInBits());
 }
 
+TEST_F(DIDerivedTypeTest, WithoutExtraData) {
+  DIFile *File = getFile();
+  DIScope *Scope = getSubprogram();
+  DIType *BaseType = getBasicType("basic");
+
+  auto *N = DIDerivedType::get(Context, dwarf::DW_TAG_pointer_type, "something",
+                               File, 1, Scope, BaseType, 2, 3, 4, 5);
+  EXPECT_EQ(4u, N->getNumOperands());
+  EXPECT_EQ(BaseType, N->getBaseType());
+  EXPECT_EQ(nullptr, N->getExtraData());
+  EXPECT_NE(N, DIDerivedType::get(Context, dwarf::DW_TAG_pointer_type,
+                                  "something", File, 1, Scope, BaseType, 2, 3,
+                                  4, 5, getTuple()));
+  TempDIDerivedType Temp = N->clone();
+  EXPECT_EQ(N, MDNode::replaceWithUniqued(std::move(Temp)));
+}
+
 typedef MetadataTest DICompositeTypeTest;
 
 TEST_F(DICompositeTypeTest, get) {
@@ -1559,6 +1576,41 @@ TEST_F(DISubprogramTest, get) {
   EXPECT_EQ(N, MDNode::replaceWithUniqued(std::move(Temp)));
 }
 
+TEST_F(DISubprogramTest, TrailingNullOperands) {
+  DIScope *Scope = getCompositeType();
+  DIFile *File = getFile();
+  DISubroutineType *Type = getSubroutineType();
+  DICompileUnit *Unit = getUnit();
+  MDTuple *Variables = getTuple();
+
+  // A declaration without template parameters does not store them, nor its
+  // declaration and variables.
+  auto *Decl = DISubprogram::get(Context, Scope, "name", "linkage", File, 2,
+                                 Type, false, false, 3, nullptr, 0, 0, 0, 0,
+                                 false, Unit);
+  EXPECT_EQ(7u, Decl->getNumOperands());
+  EXPECT_EQ("name", Decl->getDisplayName());
+  EXPECT_EQ("linkage", Decl->getLinkageName());
+  EXPECT_EQ(Unit, Decl->getUnit());
+  EXPECT_EQ(nullptr, Decl->getRawTemplateParams());
+  EXPECT_EQ(nullptr, Decl->getRawDeclaration());
+  EXPECT_EQ(nullptr, Decl->getRawVariables());
+
+  // Nulls before the last non-null operand are kept.
+  auto *Def = DISubprogram::get(Context, Scope, "name", "linkage", File, 2,
+                                Type, false, true, 3, nullptr, 0, 0, 0, 0,
+                                false, Unit, nullptr, nullptr, Variables);
+  EXPECT_EQ(10u, Def->getNumOperands());
+  EXPECT_EQ(nullptr, Def->getRawTemplateParams());
+  EXPECT_EQ(nullptr, Def->getRawDeclaration());
+  EXPECT_EQ(Variables, Def->getRawVariables());
+  EXPECT_NE(Decl, Def);
+
+  TempDISubprogram Temp = Decl->clone();
+  EXPECT_EQ(7u, Temp->getNumOperands());
+  EXPECT_EQ(Decl, MDNode::replaceWithUniqued(std::move(Temp)));
+}
+
 typedef MetadataTest DILexicalBlockTest;
 
 TEST_F(DILexicalBlockTest, get) {
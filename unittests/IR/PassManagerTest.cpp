@@ -74,6 +74,62 @@ private:
 
 char TestModuleAnalysis::PassID;
 
+// A test function analysis which only depends on the CFG.
+class TestCFGAnalysis : public AnalysisInfoMixin<TestCFGAnalysis> {
+public:
+  struct Result {
+    bool invalidate(Function &, const PreservedAnalyses &PA) {
+      return !(PA.preserved<TestCFGAnalysis>() ||
+               PA.preservedSet<CFGAnalyses>());
+    }
+  };
+
+  TestCFGAnalysis(int &Runs) : Runs(Runs) {}
+
+  Result run(Function &F, FunctionAnalysisManager &AM) {
+    ++Runs;
+    return Result();
+  }
+
+private:
+  friend AnalysisInfoMixin<TestCFGAnalysis>;
+  static char PassID;
+
+  int &Runs;
+};
+
+char TestCFGAnalysis::PassID;
+
+// A test function analysis whose result holds on to the result of
+// TestFunctionAnalysis.
+class TestDependentAnalysis : public AnalysisInfoMixin<TestDependentAnalysis> {
+public:
+  struct Result {
+    Result(TestFunctionAnalysis::Result &Dep) : Dep(Dep) {}
+    TestFunctionAnalysis::Result &Dep;
+
+    bool invalidate(Function &, const PreservedAnalyses &PA) {
+      return !PA.preserved<TestDependentAnalysis>() ||
+             !PA.preserved<TestFunctionAnalysis>();
+    }
+  };
+
+  TestDependentAnalysis(int &Runs) : Runs(Runs) {}
+
+  Result run(Function &F, FunctionAnalysisManager &AM) {
+    ++Runs;
+    return Result(AM.getResult<TestFunctionAnalysis>(F));
+  }
+
+private:
+  friend AnalysisInfoMixin<TestDependentAnalysis>;
+  static char PassID;
+
+  int &Runs;
+};
+
+char TestDependentAnalysis::PassID;
+
 struct TestModulePass : PassInfoMixin<TestModulePass> {
   TestModulePass(int &RunCount) : RunCount(RunCount) {}
 
@@ -214,6 +270,74 @@ TEST_F(PassManagerTest, BasicPreservedAnalyses) {
   EXPECT_FALSE(PA1.preserved<TestModuleAnalysis>());
 }
 
+TEST_F(PassManagerTest, PreservedAnalysisSets) {
+  PreservedAnalyses PA1 = PreservedAnalyses::none();
+  EXPECT_FALSE(PA1.preservedSet<CFGAnalyses>());
+  PA1.preserveSet<CFGAnalyses>();
+  EXPECT_TRUE(PA1.preservedSet<CFGAnalyses>());
+  EXPECT_FALSE(PA1.preserved<TestFunctionAnalysis>());
+  PreservedAnalyses PA2 = PreservedAnalyses::all();
+  EXPECT_TRUE(PA2.preservedSet<CFGAnalyses>());
+  PA2.intersect(PA1);
+  EXPECT_TRUE(PA2.preservedSet<CFGAnalyses>());
+  EXPECT_FALSE(PA2.preserved<TestFunctionAnalysis>());
+  PA2.intersect(PreservedAnalyses::none());
+  EXPECT_FALSE(PA2.preservedSet<CFGAnalyses>());
+}
+
+TEST_F(PassManagerTest, InvalidateCFGAnalyses) {
+  FunctionAnalysisManager FAM;
+  int CFGAnalysisRuns = 0, FunctionAnalysisRuns = 0;
+  FAM.registerPass([&] { return TestCFGAnalysis(CFGAnalysisRuns); });
+  FAM.registerPass([&] { return TestFunctionAnalysis(FunctionAnalysisRuns); });
+  Function &F = *M->getFunction("f");
+
+  FAM.getResult<TestCFGAnalysis>(F);
+  FAM.getResult<TestFunctionAnalysis>(F);
+  PreservedAnalyses PA;
+  PA.preserveSet<CFGAnalyses>();
+  FAM.invalidate(F, PA);
+  EXPECT_NE(nullptr, FAM.getCachedResult<TestCFGAnalysis>(F));
+  EXPECT_EQ(nullptr, FAM.getCachedResult<TestFunctionAnalysis>(F));
+
+  FAM.invalidate(F, PreservedAnalyses::none());
+  EXPECT_EQ(nullptr, FAM.getCachedResult<TestCFGAnalysis>(F));
+  FAM.getResult<TestCFGAnalysis>(F);
+  EXPECT_EQ(2, CFGAnalysisRuns);
+}
+
+TEST_F(PassManagerTest, InvalidateDependentAnalyses) {
+  FunctionAnalysisManager FAM;
+  int DependentAnalysisRuns = 0, FunctionAnalysisRuns = 0;
+  FAM.registerPass(
+      [&] { return TestDependentAnalysis(DependentAnalysisRuns); });
+  FAM.registerPass([&] { return TestFunctionAnalysis(FunctionAnalysisRuns); });
+  Function &F = *M->getFunction("f");
+
+  // Preserving both keeps both.
+  FAM.getResult<TestDependentAnalysis>(F);
+  PreservedAnalyses PA;
+  PA.preserve<TestDependentAnalysis>();
+  PA.preserve<TestFunctionAnalysis>();
+  FAM.invalidate(F, PA);
+  EXPECT_NE(nullptr, FAM.getCachedResult<TestDependentAnalysis>(F));
+
+  // Losing the dependency takes the dependent result with it, even though the
+  // dependency is cached first and so was already handled.
+  PA = PreservedAnalyses();
+  PA.preserve<TestDependentAnalysis>();
+  PA = FAM.invalidate(F, PA);
+  EXPECT_EQ(nullptr, FAM.getCachedResult<TestFunctionAnalysis>(F));
+  EXPECT_EQ(nullptr, FAM.getCachedResult<TestDependentAnalysis>(F));
+  // Both may be preserved again from here on.
+  EXPECT_TRUE(PA.preserved<TestFunctionAnalysis>());
+  EXPECT_TRUE(PA.preserved<TestDependentAnalysis>());
+
+  FAM.getResult<TestDependentAnalysis>(F);
+  EXPECT_EQ(2, DependentAnalysisRuns);
+  EXPECT_EQ(2, FunctionAnalysisRuns);
+}
+
 TEST_F(PassManagerTest, Basic) {
   FunctionAnalysisManager FAM;
   int FunctionAnalysisRuns = 0;
@@ -18,6 +18,7 @@
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/ADT/Twine.h"
 #include "gtest/gtest.h"
 
 namespace llvm {
@@ -197,6 +198,103 @@ TEST(VerifierTest, StripInvalidDebugInfo) {
   MPM.run(M, MAM);
   EXPECT_FALSE(verifyModule(M));
 }
+
+/// Add \p N functions returning void to \p M, the one at \p BrokenIdx with a
+/// branch on an i32.
+static void addFunctions(Module &M, unsigned N, unsigned BrokenIdx) {
+  LLVMContext &C = M.getContext();
+  FunctionType *FTy = FunctionType::get(Type::getVoidTy(C), /*isVarArg=*/false);
+  for (unsigned I = 0; I != N; ++I) {
+    Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage,
+                                   "f" + Twine(I), &M);
+    BasicBlock *Entry = BasicBlock::Create(C, "entry", F);
+    BasicBlock *Exit = BasicBlock::Create(C, "exit", F);
+    ReturnInst::Create(C, Exit);
+    BranchInst *BI =
+        BranchInst::Create(Exit, Exit, ConstantInt::getFalse(C), Entry);
+    if (I == BrokenIdx)
+      BI->setOperand(0, ConstantInt::get(Type::getInt32Ty(C), 0));
+  }
+}
+
+TEST(VerifierTest, Parallel) {
+  LLVMContext C;
+  Module M("M", C);
+  addFunctions(M, 1000, ~0U);
+  EXPECT_FALSE(verifyModuleInParallel(M));
+
+  Module BrokenM("BrokenM", C);
+  addFunctions(BrokenM, 1000, 777);
+  std::string Serial, Parallel;
+  raw_string_ostream SerialOS(Serial), ParallelOS(Parallel);
+  EXPECT_TRUE(verifyModule(BrokenM, &SerialOS));
+  EXPECT_TRUE(verifyModuleInParallel(BrokenM, &ParallelOS));
+  EXPECT_EQ(SerialOS.str(), ParallelOS.str());
+  EXPECT_TRUE(StringRef(Parallel).startswith(
+      "Branch condition is not 'i1' type!"));
+}
+
+TEST(VerifierTest, Incremental) {
+  LLVMContext C;
+  Module M("M", C);
+  addFunctions(M, 3, ~0U);
+
+  FunctionAnalysisManager FAM(true);
+  FAM.registerPass([&] { return VerifierAnalysis(); });
+  ModuleAnalysisManager MAM(true);
+  MAM.registerPass([&] { return FunctionAnalysisManagerModuleProxy(FAM); });
+  ModulePassManager MPM(true);
+  MPM.addPass(VerifierPass(/*FatalErrors=*/false, /*Incremental=*/true));
+  MPM.run(M, MAM);
+  for (Function &F : M)
+    ASSERT_TRUE(FAM.getCachedResult<VerifierAnalysis>(F));
+
+  // Break a function behind the analysis manager's back: the cached result
+  // is still used until the function is reported as changed.
+  Function &F1 = *M.getFunction("f1");
+  cast<BranchInst>(F1.getEntryBlock().getTerminator())
+      ->setOperand(0, ConstantInt::get(Type::getInt32Ty(C), 0));
+  MPM.run(M, MAM);
+  EXPECT_FALSE(FAM.getCachedResult<VerifierAnalysis>(F1)->IRBroken);
+
+  FAM.invalidate(F1, PreservedAnalyses::none());
+  EXPECT_FALSE(FAM.getCachedResult<VerifierAnalysis>(F1));
+  MPM.run(M, MAM);
+  EXPECT_TRUE(FAM.getCachedResult<VerifierAnalysis>(F1)->IRBroken);
+  EXPECT_FALSE(
+      FAM.getCachedResult<VerifierAnalysis>(*M.getFunction("f0"))->IRBroken);
+}
+
+#ifdef GTEST_HAS_DEATH_TEST
+TEST(VerifierTest, IncrementalOrphanedCompileUnit) {
+  LLVMContext C;
+  Module M("M", C);
+  addFunctions(M, 1, ~0U);
+  DIBuilder DIB(M);
+  auto *CU = DIB.createCompileUnit(dwarf::DW_LANG_C89, "orphan.c", "/",
+                                   "unittest", false, "", 0);
+  auto *File = DIB.createFile("orphan.c", "/");
+  auto *SP = DIB.createFunction(
+      CU, "f0", "f0", File, 1,
+      DIB.createSubroutineType(DIB.getOrCreateTypeArray(None)),
+      /*isLocalToUnit=*/false, /*isDefinition=*/true, 1);
+  M.getFunction("f0")->setSubprogram(SP);
+  DIB.finalize();
+  EXPECT_FALSE(verifyModule(M));
+
+  // The compile unit is only reachable from the function now.
+  M.getNamedMetadata("llvm.dbg.cu")->eraseFromParent();
+  EXPECT_TRUE(verifyModule(M));
+
+  FunctionAnalysisManager FAM(true);
+  FAM.registerPass([&] { return VerifierAnalysis(); });
+  ModuleAnalysisManager MAM(true);
+  MAM.registerPass([&] { return FunctionAnalysisManagerModuleProxy(FAM); });
+  ModulePassManager MPM(true);
+  MPM.addPass(VerifierPass(/*FatalErrors=*/true, /*Incremental=*/true));
+  EXPECT_DEATH(MPM.run(M, MAM), "Broken module found");
+}
+#endif
 #endif
 
 TEST(VerifierTest, StripInvalidDebugInfoLegacy) {
@@ -10,7 +10,9 @@
 #include "llvm/MC/StringTableBuilder.h"
 #include "llvm/Support/Endian.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <string>
+#include <vector>
 
 using namespace llvm;
 
@@ -91,4 +93,54 @@ TEST(StringTableBuilderTest, ELFInOrder) {
   EXPECT_EQ(9U, B.getOffset("foobar"));
 }
 
+TEST(StringTableBuilderTest, PrecomputedHash) {
+  StringTableBuilder B(StringTableBuilder::ELF);
+  StringRef Foo = "foo";
+  EXPECT_EQ(1U, B.add(CachedHash<StringRef>(
+                    Foo, DenseMapInfo<StringRef>::getHashValue(Foo))));
+  EXPECT_EQ(1U, B.add("foo"));
+  EXPECT_EQ(5U, B.add(CachedHash<StringRef>("bar")));
+  B.finalizeInOrder();
+  EXPECT_EQ(1U, B.getOffset("foo"));
+  EXPECT_EQ(5U, B.getOffset("bar"));
+}
+
+TEST(StringTableBuilderTest, LargeELF) {
+  // Enough strings for finalize to sort them in parallel.
+  std::vector<std::string> Strings;
+  for (unsigned I = 0; I != 20000; ++I) {
+    Strings.push_back("sym" + std::to_string(I));
+    Strings.push_back("_Z3sym" + std::to_string(I));
+  }
+
+  StringTableBuilder B(StringTableBuilder::ELF);
+  for (const std::string &S : Strings)
+    B.add(S);
+  B.finalize();
+
+  // Build the expected table: strings in descending order of their reversals,
+  // each one merged into the previous string if it is a suffix of it.
+  std::vector<std::string> Sorted = Strings;
+  for (std::string &S : Sorted)
+    std::reverse(S.begin(), S.end());
+  std::sort(Sorted.begin(), Sorted.end(), std::greater<std::string>());
+  std::string Expected(1, '\x00');
+  StringRef Previous;
+  for (std::string &S : Sorted) {
+    std::reverse(S.begin(), S.end());
+    if (Previous.endswith(S))
+      continue;
+    Expected += S;
+    Expected += '\x00';
+    Previous = S;
+  }
+  EXPECT_EQ(Expected, B.data());
+
+  for (const std::string &S : Strings) {
+    size_t Offset = B.getOffset(S);
+    EXPECT_EQ(S, B.data().substr(Offset, S.size()));
+    EXPECT_EQ('\x00', B.data()[Offset + S.size()]);
+  }
+}
+
 }
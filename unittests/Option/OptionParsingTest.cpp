@@ -44,10 +44,29 @@ static const OptTable::Info InfoTable[] = {
 #undef OPTION
 };
 
+static const unsigned OptionHashDisplacements[] = {
+#define OPTION_HASH_DISPLACEMENT(D) D,
+#include "Opts.inc"
+#undef OPTION_HASH_DISPLACEMENT
+};
+
+static const unsigned OptionHashSlots[] = {
+#define OPTION_HASH_SLOT(S) S,
+#include "Opts.inc"
+#undef OPTION_HASH_SLOT
+};
+
 namespace {
 class TestOptTable : public OptTable {
 public:
   TestOptTable(bool IgnoreCase = false)
+    : OptTable(InfoTable, IgnoreCase, OptionHashDisplacements,
+               OptionHashSlots) {}
+};
+
+class UnhashedTestOptTable : public OptTable {
+public:
+  UnhashedTestOptTable(bool IgnoreCase = false)
     : OptTable(InfoTable, IgnoreCase) {}
 };
 }
@@ -175,6 +194,34 @@ TEST(Option, DoNotIgnoreCase) {
   EXPECT_FALSE(AL.hasArg(OPT_B));
 }
 
+TEST(Option, HashTableMatchesSearch) {
+  const char *MyArgs[] = { "-A", "-a", "-Joo", "-joo", "-J", "-Jo", "/C", "x",
+                           "-C", "y", "--C=z", "-C=w", "-Bhi", "-I", "-K",
+                           "-slurpjoined", "-slurp", "-slurped", "input" };
+  for (bool IgnoreCase : { false, true }) {
+    for (unsigned FlagsToExclude : { 0u, unsigned(OptFlag1),
+                                     unsigned(OptFlag3) }) {
+      TestOptTable T(IgnoreCase);
+      UnhashedTestOptTable U(IgnoreCase);
+      unsigned MAI, MAC, UMAI, UMAC;
+      InputArgList AL = T.ParseArgs(MyArgs, MAI, MAC, 0, FlagsToExclude);
+      InputArgList UAL = U.ParseArgs(MyArgs, UMAI, UMAC, 0, FlagsToExclude);
+      EXPECT_EQ(UMAI, MAI);
+      EXPECT_EQ(UMAC, MAC);
+
+      // Both tables must pick the same options with the same values.
+      ASSERT_EQ(std::distance(UAL.begin(), UAL.end()),
+                std::distance(AL.begin(), AL.end()));
+      for (auto I = AL.begin(), UI = UAL.begin(), E = AL.end(); I != E;
+           ++I, ++UI) {
+        EXPECT_EQ((*UI)->getOption().getID(), (*I)->getOption().getID());
+        EXPECT_EQ((*UI)->getSpelling(), (*I)->getSpelling());
+        EXPECT_EQ((*UI)->getValues(), (*I)->getValues());
+      }
+    }
+  }
+}
+
 TEST(Option, SlurpEmpty) {
   TestOptTable T;
   unsigned MAI, MAC;
@@ -12,6 +12,9 @@
 #include "llvm/ProfileData/Coverage/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/ProfileData/InstrProfWriter.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/LEB128.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
@@ -81,6 +84,22 @@ struct CoverageMappingReaderMock : CoverageMappingReader {
   }
 };
 
+struct RandomAccessCoverageMappingReaderMock : CoverageMappingReaderMock {
+  ArrayRef<OutputFunctionCoverageData> AllFunctions;
+
+  RandomAccessCoverageMappingReaderMock(
+      ArrayRef<OutputFunctionCoverageData> Functions)
+      : CoverageMappingReaderMock(Functions), AllFunctions(Functions) {}
+
+  size_t getNumRecords() const override { return AllFunctions.size(); }
+
+  Error readRecord(size_t Index, CoverageMappingRecord &Record,
+                   RecordBuffers &Buffers) const override {
+    AllFunctions[Index].fillCoverageMappingRecord(Record);
+    return Error::success();
+  }
+};
+
 struct InputFunctionCoverageData {
   // Maps the global file index from CoverageMappingTest.Files
   // to the index of that file within this function. We can't just use
@@ -537,6 +556,171 @@ TEST_P(MaybeSparseCoverageMappingTest, load_coverage_for_expanded_file) {
   EXPECT_EQ(CoverageSegment(1, 10, false), Segments[1]);
 }
 
+TEST_P(MaybeSparseCoverageMappingTest, parallel_load_matches_sequential_load) {
+  // Enough functions for the records to be loaded in parallel, some of them
+  // missing from the profile or out of date.
+  const unsigned NumFunctions = 3000;
+  for (unsigned I = 0; I < NumFunctions; ++I) {
+    std::string Name = "func" + std::to_string(I);
+    if (I % 5 != 0) {
+      InstrProfRecord Record(Name, I % 7 == 0 ? I + 1 : I, {I, I / 2});
+      NoError(ProfileWriter.addRecord(std::move(Record)));
+    }
+    // Every third function is defined in a shared file, where the ones that
+    // start on the same line form instantiation sets.
+    startFunction(Name, I);
+    if (I % 3 == 0)
+      addCMR(Counter::getCounter(1), "shared", I % 50 + 1, 1, I % 50 + 1, 9);
+    std::string File = "file" + std::to_string(I % 7);
+    addCMR(Counter::getCounter(0), File, I + 1, 1, I + 1, 20);
+    addCMR(Counter::getCounter(1), File, I + 1, 5, I + 1, 10);
+  }
+
+  loadCoverageMapping();
+  std::unique_ptr<CoverageMapping> Sequential = std::move(LoadedCoverage);
+
+  RandomAccessCoverageMappingReaderMock CovReader(OutputFunctions);
+  auto CoverageOrErr = CoverageMapping::load(CovReader, *ProfileReader);
+  ASSERT_TRUE(NoError(CoverageOrErr.takeError()));
+  std::unique_ptr<CoverageMapping> Parallel = std::move(CoverageOrErr.get());
+
+  EXPECT_EQ(Sequential->getMismatchedCount(), Parallel->getMismatchedCount());
+  EXPECT_NE(0U, Parallel->getMismatchedCount());
+  auto SequentialFunctions = Sequential->getCoveredFunctions();
+  auto ParallelFunctions = Parallel->getCoveredFunctions();
+  ASSERT_EQ(std::distance(SequentialFunctions.begin(), SequentialFunctions.end()),
+            std::distance(ParallelFunctions.begin(), ParallelFunctions.end()));
+  for (auto S = SequentialFunctions.begin(), P = ParallelFunctions.begin(),
+            E = SequentialFunctions.end();
+       S != E; ++S, ++P) {
+    EXPECT_EQ((*S).Name, (*P).Name);
+    EXPECT_EQ((*S).ExecutionCount, (*P).ExecutionCount);
+  }
+
+  std::vector<StringRef> Files = Parallel->getUniqueSourceFiles();
+  EXPECT_EQ(Sequential->getUniqueSourceFiles(), Files);
+  EXPECT_EQ(8U, Files.size());
+  for (StringRef File : Files) {
+    CoverageData SequentialData = Sequential->getCoverageForFile(File);
+    CoverageData ParallelData = Parallel->getCoverageForFile(File);
+    std::vector<CoverageSegment> SequentialSegments(SequentialData.begin(),
+                                                    SequentialData.end());
+    std::vector<CoverageSegment> ParallelSegments(ParallelData.begin(),
+                                                  ParallelData.end());
+    EXPECT_EQ(SequentialSegments, ParallelSegments) << File.str();
+    EXPECT_EQ(Sequential->getInstantiations(File).size(),
+              Parallel->getInstantiations(File).size())
+        << File.str();
+  }
+  EXPECT_NE(0U, Parallel->getInstantiations("shared").size());
+}
+
+// Build a coverage mapping in the testing format of BinaryCoverageReader for
+// one translation unit, with a function for each file.
+static std::string writeTestingFormat(ArrayRef<StringRef> FuncNames,
+                                      ArrayRef<StringRef> Filenames,
+                                      bool Compress, size_t &FilenamesSize,
+                                      size_t &CoverageSize) {
+  std::string Names;
+  std::vector<std::string> NameStrs(FuncNames.begin(), FuncNames.end());
+  EXPECT_TRUE(NoError(collectPGOFuncNameStrings(NameStrs, false, Names)));
+
+  std::vector<std::string> Mappings;
+  for (unsigned I = 0; I < Filenames.size(); ++I) {
+    unsigned FileIDs[] = {I};
+    CounterMappingRegion Regions[] = {CounterMappingRegion::makeRegion(
+        Counter::getCounter(0), 0, I + 1, 1, I + 5, 5)};
+    Mappings.emplace_back();
+    raw_string_ostream OS(Mappings.back());
+    CoverageMappingWriter(FileIDs, None, Regions).write(OS);
+  }
+
+  std::string FilenamesData, CoverageData;
+  {
+    raw_string_ostream OS(FilenamesData);
+    CoverageFilenamesSectionWriter(Filenames).write(OS, Compress);
+  }
+  std::string AllMappings;
+  for (const auto &Mapping : Mappings)
+    AllMappings += Mapping;
+  {
+    raw_string_ostream OS(CoverageData);
+    CoverageMappingDataWriter(AllMappings).write(OS, Compress);
+  }
+  FilenamesSize = FilenamesData.size();
+  CoverageSize = CoverageData.size();
+
+  std::string Data = "llvmcovmtestdata";
+  raw_string_ostream OS(Data);
+  encodeULEB128(Names.size(), OS);
+  encodeULEB128(0, OS);
+  OS << Names;
+  OS.flush();
+  Data.append(alignTo(Data.size(), 8) - Data.size(), '\0');
+
+  support::endian::Writer<support::little> W(OS);
+  W.write<uint32_t>(FuncNames.size());
+  W.write<uint32_t>(FilenamesData.size());
+  W.write<uint32_t>(CoverageData.size());
+  W.write<uint32_t>(CovMapVersion::CurrentVersion);
+  for (unsigned I = 0; I < FuncNames.size(); ++I) {
+    W.write<uint64_t>(IndexedInstrProf::ComputeHash(FuncNames[I]));
+    W.write<uint32_t>(Mappings[I].size());
+    W.write<uint64_t>(I + 1);
+  }
+  OS << FilenamesData << CoverageData;
+  OS.flush();
+  Data.append(alignTo(Data.size(), 8) - Data.size(), '\0');
+  return Data;
+}
+
+TEST(CoverageMappingTest, read_compressed_filenames_and_mapping_data) {
+  // Enough functions with long, similar file names for both the names and
+  // the mapping data to compress well.
+  const unsigned NumFunctions = 64;
+  std::vector<std::string> FuncNameStrs, FilenameStrs;
+  for (unsigned I = 0; I < NumFunctions; ++I) {
+    FuncNameStrs.push_back("func" + std::to_string(I));
+    FilenameStrs.push_back(std::string(100, 'a') + "/file" +
+                           std::to_string(I) + ".c");
+  }
+  std::vector<StringRef> FuncNames(FuncNameStrs.begin(), FuncNameStrs.end());
+  std::vector<StringRef> Filenames(FilenameStrs.begin(), FilenameStrs.end());
+
+  size_t UncompressedFilenamesSize, UncompressedCoverageSize;
+  std::string Uncompressed =
+      writeTestingFormat(FuncNames, Filenames, false,
+                         UncompressedFilenamesSize, UncompressedCoverageSize);
+  for (bool Compress : {false, true}) {
+    size_t FilenamesSize, CoverageSize;
+    std::unique_ptr<MemoryBuffer> Buffer = MemoryBuffer::getMemBufferCopy(
+        writeTestingFormat(FuncNames, Filenames, Compress, FilenamesSize,
+                           CoverageSize));
+    if (Compress && zlib::isAvailable()) {
+      EXPECT_LT(FilenamesSize, UncompressedFilenamesSize);
+      EXPECT_LT(CoverageSize, UncompressedCoverageSize);
+    } else
+      EXPECT_EQ(Uncompressed, Buffer->getBuffer());
+
+    auto ReaderOrErr = BinaryCoverageReader::create(Buffer, "");
+    ASSERT_TRUE(NoError(ReaderOrErr.takeError()));
+    auto Reader = std::move(ReaderOrErr.get());
+    unsigned I = 0;
+    for (const auto &Record : *Reader) {
+      ASSERT_LT(I, NumFunctions);
+      EXPECT_EQ(FuncNames[I], Record.FunctionName);
+      EXPECT_EQ(I + 1, Record.FunctionHash);
+      ASSERT_EQ(1U, Record.Filenames.size());
+      EXPECT_EQ(Filenames[I], Record.Filenames[0]);
+      ASSERT_EQ(1U, Record.MappingRegions.size());
+      EXPECT_EQ(I + 1, Record.MappingRegions[0].LineStart);
+      EXPECT_EQ(I + 5, Record.MappingRegions[0].LineEnd);
+      ++I;
+    }
+    EXPECT_EQ(NumFunctions, I);
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(MaybeSparse, MaybeSparseCoverageMappingTest,
                         ::testing::Bool());
 
@@ -140,6 +140,42 @@ TEST_P(MaybeSparseInstrProfTest, get_function_counts) {
   ASSERT_TRUE(ErrorEquals(instrprof_error::unknown_function, std::move(E2)));
 }
 
+TEST_P(MaybeSparseInstrProfTest, get_function_counts_ref) {
+  InstrProfRecord Record1("foo", 0x1234, {1, 2});
+  InstrProfRecord Record2("foo", 0x1235, {3, 4, 5});
+  Record2.reserveSites(IPVK_IndirectCallTarget, 1);
+  InstrProfValueData VD[] = {{(uint64_t) "callee", 1}};
+  Record2.addValueData(IPVK_IndirectCallTarget, 0, VD, 1, nullptr);
+  InstrProfRecord Record3("foo", 0x1236, {6});
+  NoError(Writer.addRecord(std::move(Record1)));
+  NoError(Writer.addRecord(std::move(Record2)));
+  NoError(Writer.addRecord(std::move(Record3)));
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  StringRef Names[] = {"bar", "foo"};
+  Reader->prefetchRecords(Names);
+
+  ArrayRef<support::ulittle64_t> Counts;
+  ASSERT_TRUE(NoError(Reader->getFunctionCounts("foo", 0x1235, Counts)));
+  ASSERT_EQ(3U, Counts.size());
+  ASSERT_EQ(3U, Counts[0]);
+  ASSERT_EQ(4U, Counts[1]);
+  ASSERT_EQ(5U, Counts[2]);
+
+  // Records sharing the name with one that has value profile data are
+  // found as well.
+  ASSERT_TRUE(NoError(Reader->getFunctionCounts("foo", 0x1236, Counts)));
+  ASSERT_EQ(1U, Counts.size());
+  ASSERT_EQ(6U, Counts[0]);
+
+  Error E1 = Reader->getFunctionCounts("foo", 0x5678, Counts);
+  ASSERT_TRUE(ErrorEquals(instrprof_error::hash_mismatch, std::move(E1)));
+
+  Error E2 = Reader->getFunctionCounts("bar", 0x1234, Counts);
+  ASSERT_TRUE(ErrorEquals(instrprof_error::unknown_function, std::move(E2)));
+}
+
 // Profile data is copied from general.proftext
 TEST_F(InstrProfTest, get_profile_summary) {
   InstrProfRecord Record1("func1", 0x1234, {97531});
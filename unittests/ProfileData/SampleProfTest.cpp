@@ -9,6 +9,8 @@
 
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
@@ -170,6 +172,88 @@ TEST_F(SampleProfTest, roundtrip_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Binary);
 }
 
+TEST_F(SampleProfTest, roundtrip_indexed_binary_profile) {
+  testRoundTrip(SampleProfileFormat::SPF_Indexed_Binary);
+}
+
+TEST_F(SampleProfTest, indexed_binary_profile_on_demand) {
+  createWriter(SampleProfileFormat::SPF_Indexed_Binary);
+
+  StringRef FooName("_Z3fooi");
+  FunctionSamples FooSamples;
+  FooSamples.setName(FooName);
+  FooSamples.addTotalSamples(7711);
+  FooSamples.addHeadSamples(610);
+  FooSamples.addBodySamples(1, 0, 610);
+
+  StringRef BarName("_Z3bari");
+  FunctionSamples BarSamples;
+  BarSamples.setName(BarName);
+  BarSamples.addTotalSamples(20301);
+  BarSamples.addHeadSamples(1437);
+  BarSamples.addBodySamples(1, 0, 1437);
+  BarSamples.addCalledTargetSamples(1, 0, FooName, 1000);
+
+  StringMap<FunctionSamples> Profiles;
+  Profiles[FooName] = std::move(FooSamples);
+  Profiles[BarName] = std::move(BarSamples);
+  ASSERT_TRUE(NoError(Writer->write(Profiles)));
+  Writer->getOutputStream().flush();
+
+  auto Profile = MemoryBuffer::getMemBufferCopy(Data);
+  readProfile(Profile);
+  ASSERT_TRUE(NoError(Reader->readOnDemand()));
+
+  // Nothing is decoded until it is asked for, but the total is known.
+  ASSERT_EQ(0u, Reader->getProfiles().size());
+  ASSERT_EQ(28012u, Reader->getTotalSamples());
+
+  Module M("my_module", Context);
+  FunctionType *FnTy =
+      FunctionType::get(Type::getVoidTy(Context), /*isVarArg=*/false);
+  Function *Bar =
+      Function::Create(FnTy, GlobalValue::ExternalLinkage, BarName, &M);
+  Function *Baz =
+      Function::Create(FnTy, GlobalValue::ExternalLinkage, "_Z3bazi", &M);
+
+  FunctionSamples *ReadBarSamples = Reader->getSamplesFor(*Bar);
+  ASSERT_EQ(20301u, ReadBarSamples->getTotalSamples());
+  ASSERT_EQ(1437u, ReadBarSamples->getHeadSamples());
+  ASSERT_EQ(1000u, ReadBarSamples->getBodySamples()
+                       .find(LineLocation(1, 0))
+                       ->second.getCallTargets()
+                       .lookup(FooName));
+  ASSERT_EQ(ReadBarSamples, Reader->getSamplesFor(*Bar));
+
+  ASSERT_TRUE(Reader->getSamplesFor(*Baz)->empty());
+
+  // Only the functions asked for were decoded.
+  ASSERT_EQ(2u, Reader->getProfiles().size());
+  ASSERT_EQ(0u, Reader->getProfiles().count(FooName));
+}
+
+TEST_F(SampleProfTest, sample_context_parsing) {
+  SmallVector<SampleContextFrame, 4> Frames;
+  ASSERT_TRUE(
+      SampleContext::parse("[main:3 @ _Z3bari:2.1 @ _Z3fooi]", Frames));
+  ASSERT_EQ(3u, Frames.size());
+  ASSERT_EQ("main", Frames[0].FuncName);
+  ASSERT_EQ(3u, Frames[0].CallSite.LineOffset);
+  ASSERT_EQ(0u, Frames[0].CallSite.Discriminator);
+  ASSERT_EQ("_Z3bari", Frames[1].FuncName);
+  ASSERT_EQ(2u, Frames[1].CallSite.LineOffset);
+  ASSERT_EQ(1u, Frames[1].CallSite.Discriminator);
+  ASSERT_EQ("_Z3fooi", Frames[2].FuncName);
+
+  ASSERT_FALSE(SampleContext::isContext("_Z3fooi"));
+  ASSERT_FALSE(SampleContext::parse("_Z3fooi", Frames));
+  ASSERT_FALSE(SampleContext::parse("[_Z3fooi]", Frames));
+  ASSERT_FALSE(SampleContext::parse("[main @ _Z3fooi]", Frames));
+  ASSERT_FALSE(SampleContext::parse("[main:x @ _Z3fooi]", Frames));
+  ASSERT_FALSE(SampleContext::parse("[main:3 @ ]", Frames));
+  ASSERT_FALSE(SampleContext::parse("[main:3 @ _Z3fooi", Frames));
+}
+
 TEST_F(SampleProfTest, sample_overflow_saturation) {
   const uint64_t Max = std::numeric_limits<uint64_t>::max();
   sampleprof_error Result;
@@ -8,6 +8,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/SizeClassAllocator.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 #include <cstdlib>
 
@@ -80,6 +82,102 @@ TEST(AllocatorTest, TestReset) {
   EXPECT_EQ(2U, Alloc.GetNumSlabs());
 }
 
+// Reset with a slab limit keeps the slabs for the next allocations.
+TEST(AllocatorTest, TestResetRetainingSlabs) {
+  BumpPtrAllocator Alloc;
+  void *Slabs[4];
+  for (void *&Slab : Slabs)
+    Slab = Alloc.Allocate(3000, 1);
+  EXPECT_EQ(4U, Alloc.GetNumSlabs());
+  size_t TotalMemory = Alloc.getTotalMemory();
+
+  // Only three slabs are kept: the current one and two others.
+  Alloc.Reset(3);
+  EXPECT_EQ(1U, Alloc.GetNumSlabs());
+  EXPECT_EQ(2U, Alloc.getNumRetainedSlabs());
+  EXPECT_EQ(0U, Alloc.getBytesAllocated());
+  EXPECT_EQ(TotalMemory / 4 * 3, Alloc.getTotalMemory());
+
+  // The kept slabs are reused in the same order.
+  for (unsigned I = 0; I != 3; ++I)
+    EXPECT_EQ(Slabs[I], Alloc.Allocate(3000, 1));
+  (void)Alloc.Allocate(3000, 1);
+  EXPECT_EQ(4U, Alloc.GetNumSlabs());
+  EXPECT_EQ(0U, Alloc.getNumRetainedSlabs());
+
+  // A reset with a lower limit drops the extra retained slabs.
+  Alloc.Reset(5);
+  EXPECT_EQ(3U, Alloc.getNumRetainedSlabs());
+  (void)Alloc.Allocate(3000, 1);
+  (void)Alloc.Allocate(3000, 1);
+  Alloc.Reset(2);
+  EXPECT_EQ(1U, Alloc.GetNumSlabs());
+  EXPECT_EQ(1U, Alloc.getNumRetainedSlabs());
+
+  // Reset(0) frees everything, and the allocator remains usable.
+  Alloc.Reset(0);
+  EXPECT_EQ(0U, Alloc.GetNumSlabs());
+  EXPECT_EQ(0U, Alloc.getNumRetainedSlabs());
+  EXPECT_EQ(0U, Alloc.getTotalMemory());
+  (void)Alloc.Allocate(3000, 1);
+  EXPECT_EQ(1U, Alloc.GetNumSlabs());
+}
+
+TEST(AllocatorTest, SizeClassAllocator) {
+  SizeClassAllocator<> Alloc;
+  void *A = Alloc.Allocate(20, 8);
+  void *B = Alloc.Allocate(24, 8);
+  EXPECT_NE(A, B);
+  EXPECT_EQ(0U, uintptr_t(A) & 15);
+
+  // Blocks of the same size class are recycled, the most recent first.
+  Alloc.Deallocate(A, 20);
+  Alloc.Deallocate(B, 24);
+  EXPECT_EQ(2U, Alloc.getNumFreeBlocks(32));
+  EXPECT_EQ(0U, Alloc.getNumFreeBlocks(16));
+  EXPECT_EQ(B, Alloc.Allocate(32, 16));
+  EXPECT_EQ(A, Alloc.Allocate(17, 4));
+  EXPECT_EQ(0U, Alloc.getNumFreeBlocks(32));
+
+  // Blocks with a larger alignment are recyclable too.
+  void *C = Alloc.Allocate(20, 64);
+  EXPECT_EQ(0U, uintptr_t(C) & 63);
+  Alloc.Deallocate(C, 20);
+  EXPECT_EQ(C, Alloc.Allocate(30, 8));
+
+  // Large blocks go straight to the underlying allocator.
+  size_t BytesAllocated = Alloc.getBytesAllocated();
+  void *D = Alloc.Allocate(1000, 8);
+  EXPECT_EQ(BytesAllocated + 1000, Alloc.getBytesAllocated());
+  Alloc.Deallocate(D, 1000);
+
+  Alloc.Reset();
+  EXPECT_EQ(0U, Alloc.getNumFreeBlocks(32));
+}
+
+TEST(AllocatorTest, MemoryUsageReport) {
+  std::string Report;
+  {
+    BumpPtrAllocator Alloc;
+    MemoryUsageReporter Reporter("AllocatorTest.MemoryUsageReport", Alloc);
+    (void)Alloc.Allocate(100, 1);
+
+    raw_string_ostream OS(Report);
+    PrintMemoryUsage(OS);
+  }
+  EXPECT_NE(std::string::npos,
+            Report.find("     1      0         4096          100         4096"
+                        "  AllocatorTest.MemoryUsageReport\n"));
+
+  // Once the allocator is gone, only the largest size seen remains.
+  Report.clear();
+  raw_string_ostream OS(Report);
+  PrintMemoryUsage(OS);
+  EXPECT_NE(std::string::npos,
+            Report.find("     0      1            0            0         4096"
+                        "  AllocatorTest.MemoryUsageReport\n"));
+}
+
 // Test some allocations at varying alignments.
 TEST(AllocatorTest, TestAlignment) {
   BumpPtrAllocator Alloc;
@@ -0,0 +1,75 @@
+//===- llvm/unittest/Support/CachePruningTest.cpp - unit tests ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::sys;
+
+namespace {
+
+// Creates a file of Size bytes in Dir, last accessed Age seconds ago.
+static void createEntry(StringRef Dir, StringRef Name, unsigned Size,
+                        unsigned Age) {
+  SmallString<128> Path(Dir);
+  path::append(Path, Name);
+  int FD;
+  ASSERT_FALSE(fs::openFileForWrite(Path, FD, fs::F_None));
+  raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  OS << std::string(Size, 'x');
+  OS.flush();
+  TimeValue Time = TimeValue::now() - TimeValue(TimeValue::SecondsType(Age));
+  ASSERT_FALSE(fs::setLastModificationAndAccessTime(FD, Time));
+}
+
+static bool entryExists(StringRef Dir, StringRef Name) {
+  SmallString<128> Path(Dir);
+  path::append(Path, Name);
+  return fs::exists(Path);
+}
+
+static void removeEntry(StringRef Dir, StringRef Name) {
+  SmallString<128> Path(Dir);
+  path::append(Path, Name);
+  fs::remove(Path);
+}
+
+TEST(CachePruning, MaxSizeBytes) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(fs::createUniqueDirectory("CachePruning-test", Dir));
+
+  createEntry(Dir, "oldest", 100, 300);
+  createEntry(Dir, "middle", 100, 200);
+  createEntry(Dir, "newest", 100, 100);
+
+  // Entries do not expire, so only the least recently used one is removed to
+  // bring the cache under the limit.
+  EXPECT_TRUE(CachePruning(Dir).setMaxSizeBytes(250).prune());
+  EXPECT_FALSE(entryExists(Dir, "oldest"));
+  EXPECT_TRUE(entryExists(Dir, "middle"));
+  EXPECT_TRUE(entryExists(Dir, "newest"));
+
+  // Expiration applies before the size limit.
+  EXPECT_TRUE(CachePruning(Dir)
+                  .setEntryExpiration(150)
+                  .setMaxSizeBytes(1000)
+                  .prune());
+  EXPECT_FALSE(entryExists(Dir, "middle"));
+  EXPECT_TRUE(entryExists(Dir, "newest"));
+
+  removeEntry(Dir, "newest");
+  removeEntry(Dir, "llvmcache.timestamp");
+  ASSERT_FALSE(fs::remove(Dir));
+}
+
+} // end anonymous namespace
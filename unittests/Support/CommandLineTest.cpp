@@ -393,6 +393,22 @@ TEST(CommandLineTest, ReparseCommandLineOptions) {
   EXPECT_TRUE(TopLevelOpt);
 }
 
+TEST(CommandLineTest, OptionAddedAfterParsing) {
+  cl::ResetCommandLineParser();
+
+  StackOption<bool> FirstOpt("first-opt", cl::init(false));
+  const char *args[] = {"prog", "-first-opt"};
+  EXPECT_TRUE(cl::ParseCommandLineOptions(2, args, nullptr, true));
+  EXPECT_TRUE(FirstOpt);
+
+  // Options created later, e.g. by a plugin, are registered on the next lookup.
+  StackOption<bool> LateOpt("late-opt", cl::init(false));
+  EXPECT_EQ(1u, cl::getRegisteredOptions(*cl::TopLevelSubCommand).count("late-opt"));
+  const char *args2[] = {"prog", "-late-opt"};
+  EXPECT_TRUE(cl::ParseCommandLineOptions(2, args2, nullptr, true));
+  EXPECT_TRUE(LateOpt);
+}
+
 TEST(CommandLineTest, RemoveFromRegularSubCommand) {
   cl::ResetCommandLineParser();
 
@@ -117,4 +117,35 @@ TEST(DataExtractorTest, LEB128) {
   EXPECT_EQ(8U, offset);
 }
 
+TEST(DataExtractorTest, LEB128Arrays) {
+  // 9382, 42218325750568106 and 9382 again.
+  const char data[] = "\xA6\x49\xAA\xA9\xFF\xAA\xFF\xAA\xFF\x4A\xA6\x49";
+  DataExtractor DE(StringRef(data, sizeof(data)-1), false, 8);
+  uint32_t offset = 0;
+  uint64_t uvalues[3];
+  EXPECT_EQ(uvalues, DE.getULEB128(&offset, uvalues, 3));
+  EXPECT_EQ(12U, offset);
+  EXPECT_EQ(9382ULL, uvalues[0]);
+  EXPECT_EQ(42218325750568106ULL, uvalues[1]);
+  EXPECT_EQ(9382ULL, uvalues[2]);
+
+  offset = 0;
+  int64_t svalues[3];
+  EXPECT_EQ(svalues, DE.getSLEB128(&offset, svalues, 3));
+  EXPECT_EQ(12U, offset);
+  EXPECT_EQ(-7002LL, svalues[0]);
+  EXPECT_EQ(-29839268287359830LL, svalues[1]);
+  EXPECT_EQ(-7002LL, svalues[2]);
+
+  // The offset is left alone when the data ends in the middle of a value,
+  // whereas a single truncated value is consumed.
+  DataExtractor TDE(StringRef(data, sizeof(data)-2), false, 8);
+  offset = 2;
+  EXPECT_EQ(nullptr, TDE.getULEB128(&offset, uvalues, 2));
+  EXPECT_EQ(2U, offset);
+  offset = 10;
+  EXPECT_EQ(0x26ULL, TDE.getULEB128(&offset));
+  EXPECT_EQ(11U, offset);
+}
+
 }
@@ -11,7 +11,9 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
@@ -118,4 +120,60 @@ TEST(FileOutputBuffer, Test) {
   // Clean up.
   ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
 }
+
+TEST(FileOutputBuffer, ParallelWrites) {
+  SmallString<128> TestDirectory;
+  ASSERT_NO_ERROR(
+      fs::createUniqueDirectory("FileOutputBuffer-test", TestDirectory));
+  SmallString<128> File(TestDirectory);
+  File.append("/file");
+
+  // Each task reserves and fills a region of its own, then the buffer is
+  // committed in the background.
+  const unsigned NumTasks = 64, RegionSize = 1000;
+  {
+    ErrorOr<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File, (NumTasks + 1) * 1024);
+    ASSERT_NO_ERROR(BufferOrErr.getError());
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    memcpy(Buffer->reserve(16), "AABBCCDDEEFFGGHH", 16);
+
+    ThreadPool Pool;
+    for (unsigned I = 0; I != NumTasks; ++I)
+      Pool.async([&Buffer, I] {
+        uint8_t *Region = Buffer->reserve(RegionSize, 1024);
+        memset(Region, 'a' + I % 26, RegionSize);
+        Buffer->flushRange(Region, RegionSize);
+      });
+    Pool.wait();
+    EXPECT_EQ(NumTasks * 1024 + RegionSize, Buffer->getReservedSize());
+    // The buffer is full.
+    EXPECT_EQ(nullptr, Buffer->reserve(100, 1024));
+    EXPECT_NE(nullptr, Buffer->reserve(1024 - RegionSize));
+    EXPECT_EQ(nullptr, Buffer->reserve(1));
+
+    std::shared_future<std::error_code> Committed = Buffer->commitAsync(Pool);
+    ASSERT_NO_ERROR(Committed.get());
+  }
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(File);
+  ASSERT_NO_ERROR(MBOrErr.getError());
+  StringRef Contents = (*MBOrErr)->getBuffer();
+  ASSERT_EQ((NumTasks + 1) * 1024, Contents.size());
+  EXPECT_EQ("AABBCCDDEEFFGGHH", Contents.substr(0, 16));
+  // Every region was written once, whichever task got it.
+  unsigned Counts[26] = {};
+  for (unsigned I = 0; I != NumTasks; ++I) {
+    StringRef Region = Contents.substr(1024 * (I + 1), RegionSize);
+    EXPECT_EQ(std::string(RegionSize, Region[0]), Region);
+    ASSERT_TRUE(Region[0] >= 'a' && Region[0] <= 'z');
+    ++Counts[Region[0] - 'a'];
+  }
+  for (unsigned C = 0; C != 26; ++C)
+    EXPECT_EQ(NumTasks / 26 + (C < NumTasks % 26), Counts[C]);
+
+  ASSERT_NO_ERROR(fs::remove(File.str()));
+  ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
+}
 } // anonymous namespace
@@ -12,6 +12,7 @@
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/raw_ostream.h"
 #include <string>
+#include <vector>
 using namespace llvm;
 
 namespace {
@@ -155,6 +156,81 @@ TEST(LEB128Test, DecodeSLEB128) {
 #undef EXPECT_DECODE_SLEB128_EQ
 }
 
+TEST(LEB128Test, DecodeULEB128Array) {
+  // Every length from 1 to 10 bytes, so that both the word-at-a-time and the
+  // byte-at-a-time paths are covered.
+  std::vector<uint64_t> Values;
+  for (unsigned Bit = 0; Bit != 64; ++Bit) {
+    Values.push_back(1ULL << Bit);
+    Values.push_back((1ULL << Bit) - 1);
+  }
+  Values.push_back(UINT64_MAX);
+
+  std::string Buffer;
+  raw_string_ostream OS(Buffer);
+  for (uint64_t V : Values)
+    encodeULEB128(V, OS);
+  // Padded values are decoded like any other.
+  encodeULEB128(5, OS, 4);
+  Values.push_back(5);
+  OS.flush();
+
+  const uint8_t *Begin = reinterpret_cast<const uint8_t *>(Buffer.data());
+  const uint8_t *End = Begin + Buffer.size();
+  std::vector<uint64_t> Decoded(Values.size());
+  EXPECT_EQ(End,
+            decodeULEB128Array(Begin, End, Decoded.data(), Decoded.size()));
+  EXPECT_EQ(Values, Decoded);
+
+  // Decoding stops after the requested number of values.
+  EXPECT_EQ(Begin + 1, decodeULEB128Array(Begin, End, Decoded.data(), 1));
+  EXPECT_EQ(Begin, decodeULEB128Array(Begin, End, Decoded.data(), 0));
+
+  // A value running past the end of the buffer is an error.
+  EXPECT_EQ(nullptr, decodeULEB128Array(Begin, End - 1, Decoded.data(),
+                                        Decoded.size()));
+  const uint8_t Truncated[] = {0x80, 0x80, 0x80, 0x80, 0x80,
+                               0x80, 0x80, 0x80, 0x80};
+  EXPECT_EQ(nullptr, decodeULEB128Array(Truncated, std::end(Truncated),
+                                        Decoded.data(), 1));
+}
+
+TEST(LEB128Test, DecodeSLEB128Array) {
+  std::vector<int64_t> Values;
+  for (unsigned Bit = 0; Bit != 63; ++Bit) {
+    Values.push_back(1LL << Bit);
+    Values.push_back((1LL << Bit) - 1);
+    Values.push_back(-(1LL << Bit));
+    Values.push_back(-(1LL << Bit) - 1);
+  }
+  Values.push_back(INT64_MAX);
+  Values.push_back(INT64_MIN);
+
+  std::string Buffer;
+  raw_string_ostream OS(Buffer);
+  for (int64_t V : Values)
+    encodeSLEB128(V, OS);
+  OS.flush();
+
+  const uint8_t *Begin = reinterpret_cast<const uint8_t *>(Buffer.data());
+  const uint8_t *End = Begin + Buffer.size();
+  std::vector<int64_t> Decoded(Values.size());
+  EXPECT_EQ(End,
+            decodeSLEB128Array(Begin, End, Decoded.data(), Decoded.size()));
+  EXPECT_EQ(Values, Decoded);
+
+  // Each value agrees with decodeSLEB128.
+  const uint8_t *P = Begin;
+  for (int64_t V : Values) {
+    unsigned N;
+    EXPECT_EQ(V, decodeSLEB128(P, &N));
+    P += N;
+  }
+
+  EXPECT_EQ(nullptr, decodeSLEB128Array(Begin, End - 1, Decoded.data(),
+                                        Decoded.size()));
+}
+
 TEST(LEB128Test, SLEB128Size) {
   // Positive Value Testing Plan:
   // (1) 128 ^ n - 1 ........ need (n+1) bytes
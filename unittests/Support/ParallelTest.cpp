@@ -0,0 +1,86 @@
+//===- unittests/Support/ParallelTest.cpp - Parallel algorithm tests ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/Parallel.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <random>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(Parallel, ForEach) {
+  std::vector<unsigned> Values(10000, 1);
+  parallel_for_each(Values.begin(), Values.end(), [](unsigned &V) { V *= 2; });
+  for (unsigned V : Values)
+    EXPECT_EQ(2u, V);
+}
+
+TEST(Parallel, For) {
+  std::vector<std::atomic<unsigned>> Hits(10000);
+  for (auto &H : Hits)
+    H = 0;
+  parallel_for(size_t(0), Hits.size(), [&](size_t I) { ++Hits[I]; });
+  for (auto &H : Hits)
+    EXPECT_EQ(1u, H.load());
+}
+
+TEST(Parallel, Sort) {
+  std::mt19937 Generator(42);
+  std::vector<uint32_t> Values(100000);
+  for (auto &V : Values)
+    V = Generator();
+  std::vector<uint32_t> Expected = Values;
+  std::sort(Expected.begin(), Expected.end());
+
+  parallel_sort(Values.begin(), Values.end());
+  EXPECT_EQ(Expected, Values);
+
+  std::sort(Expected.begin(), Expected.end(), std::greater<uint32_t>());
+  parallel_sort(Values.begin(), Values.end(), std::greater<uint32_t>());
+  EXPECT_EQ(Expected, Values);
+}
+
+TEST(Parallel, TransformReduce) {
+  std::vector<unsigned> Values(10000);
+  for (unsigned I = 0; I != Values.size(); ++I)
+    Values[I] = I;
+  uint64_t Sum = parallel_transform_reduce(
+      Values.begin(), Values.end(), uint64_t(5),
+      [](uint64_t A, uint64_t B) { return A + B; },
+      [](unsigned V) { return uint64_t(V) * 2; });
+  EXPECT_EQ(5u + 2 * (9999u * 10000u / 2), Sum);
+
+  // The reduction must respect input order for non-commutative operations.
+  std::vector<std::string> Letters(2000);
+  std::string ExpectedConcat = ">";
+  for (unsigned I = 0; I != Letters.size(); ++I) {
+    Letters[I] = std::string(1, 'a' + I % 26);
+    ExpectedConcat += Letters[I];
+  }
+  std::string Concat = parallel_transform_reduce(
+      Letters.begin(), Letters.end(), std::string(">"),
+      [](std::string A, const std::string &B) { return A + B; },
+      [](const std::string &S) { return S; });
+  EXPECT_EQ(ExpectedConcat, Concat);
+}
+
+TEST(Parallel, Nested) {
+  // Nested parallel calls made from pool tasks must not deadlock.
+  std::atomic<unsigned> Count(0);
+  parallel_for(0, 2048, [&](int) {
+    parallel_for(0, 2048, [&](int) { ++Count; });
+  });
+  EXPECT_EQ(2048u * 2048u, Count.load());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,59 @@
+//===- llvm/unittest/Support/StringSaverTest.cpp - StringSaver tests ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/StringSaver.h"
+#include "gtest/gtest.h"
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(StringSaverTest, Save) {
+  BumpPtrAllocator Alloc;
+  StringSaver Saver(Alloc);
+  std::string Str = "hello";
+  const char *S = Saver.save(Str);
+  Str = "world";
+  EXPECT_STREQ("hello", S);
+  EXPECT_NE(Str.data(), S);
+}
+
+TEST(UniqueStringSaverTest, KeepsOneCopy) {
+  BumpPtrAllocator Alloc;
+  UniqueStringSaver Saver(Alloc);
+  std::string A = "hello", B = "hello", C = "world";
+  StringRef SA = Saver.save(A);
+  StringRef SB = Saver.save(B);
+  StringRef SC = Saver.save(C);
+  A = B = C = "";
+
+  EXPECT_EQ("hello", SA);
+  EXPECT_EQ(SA.data(), SB.data());
+  EXPECT_EQ("world", SC);
+  EXPECT_NE(SA.data(), SC.data());
+  EXPECT_EQ(2u, Saver.size());
+
+  // The copies are null terminated, like those made by StringSaver.
+  EXPECT_EQ('\0', SA.data()[SA.size()]);
+  EXPECT_EQ(SC.data(), Saver.save(Twine("wor") + "ld").data());
+}
+
+TEST(UniqueStringSaverTest, HashIsKept) {
+  BumpPtrAllocator Alloc;
+  UniqueStringSaver Saver(Alloc);
+  CachedHash<StringRef> In("foo");
+  CachedHash<StringRef> Out = Saver.save(In);
+  EXPECT_EQ(In.Hash, Out.Hash);
+  EXPECT_EQ("foo", Out.Val);
+  EXPECT_NE(In.Val.data(), Out.Val.data());
+  EXPECT_EQ(Out.Val.data(), Saver.save(StringRef("foo")).data());
+}
+
+} // end anonymous namespace
@@ -166,3 +166,43 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   }
   ASSERT_EQ(5, checked_in);
 }
+
+TEST_F(ThreadPoolTest, TaskGroupWait) {
+  CHECK_UNSUPPORTED();
+  // Test that waiting on a group does not wait for tasks outside of it.
+  std::atomic_int checked_in{0};
+  ThreadPool Pool{2};
+  Pool.async([this, &checked_in] {
+    waitForMainThread();
+    ++checked_in;
+  });
+  {
+    ThreadPoolTaskGroup Group(Pool);
+    for (size_t i = 0; i < 5; ++i)
+      Group.async([&checked_in] { checked_in += 10; });
+    Group.wait();
+    ASSERT_EQ(50, checked_in);
+  }
+  setMainThreadReady();
+  Pool.wait();
+  ASSERT_EQ(51, checked_in);
+}
+
+TEST_F(ThreadPoolTest, NestedTaskGroup) {
+  CHECK_UNSUPPORTED();
+  // Test that a task waiting on a nested group keeps the pool going, even
+  // when it occupies the only worker thread.
+  std::atomic_int checked_in{0};
+  ThreadPool Pool{1};
+  ThreadPoolTaskGroup Outer(Pool);
+  for (size_t i = 0; i < 3; ++i) {
+    Outer.async([&Pool, &checked_in] {
+      ThreadPoolTaskGroup Inner(Pool);
+      for (size_t j = 0; j < 4; ++j)
+        Inner.async([&checked_in] { ++checked_in; });
+      Inner.wait();
+    });
+  }
+  Outer.wait();
+  ASSERT_EQ(12, checked_in);
+}
@@ -0,0 +1,69 @@
+//===- unittests/Support/TimeProfilerTest.cpp - Time profiler tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+
+using namespace llvm;
+
+namespace {
+
+TEST(TimeProfiler, Disabled) {
+  EXPECT_FALSE(timeTraceProfilerEnabled());
+  // Scopes are no-ops while the profiler is not initialized.
+  TimeTraceScope Scope("Event", "Detail");
+}
+
+TEST(TimeProfiler, Events) {
+  timeTraceProfilerInitialize(0);
+  EXPECT_TRUE(timeTraceProfilerEnabled());
+  {
+    TimeTraceScope Outer("Outer", "\"quoted\"");
+    TimeTraceScope Inner("Inner");
+  }
+  std::thread([] { TimeTraceScope Worker("Worker", "thread"); }).join();
+
+  std::string Trace;
+  raw_string_ostream OS(Trace);
+  timeTraceProfilerWrite(OS);
+  OS.flush();
+  timeTraceProfilerCleanup();
+  EXPECT_FALSE(timeTraceProfilerEnabled());
+
+  EXPECT_EQ(0u, Trace.find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos,
+            Trace.find("\"name\":\"Outer\",\"args\":{\"detail\":"
+                       "\"\\\"quoted\\\"\"}"));
+  EXPECT_NE(std::string::npos, Trace.find("\"tid\":0,"));
+  EXPECT_NE(std::string::npos, Trace.find("\"name\":\"Inner\"}"));
+  EXPECT_NE(std::string::npos, Trace.find("\"name\":\"Worker\""));
+  EXPECT_NE(std::string::npos, Trace.find("\"tid\":1,"));
+  EXPECT_NE(std::string::npos, Trace.find("\"name\":\"Total Outer\","
+                                          "\"args\":{\"count\":\"1\"}"));
+}
+
+TEST(TimeProfiler, Granularity) {
+  // Events shorter than the granularity are only reflected in the totals.
+  timeTraceProfilerInitialize(1000000000);
+  { TimeTraceScope Short("Short"); }
+
+  std::string Trace;
+  raw_string_ostream OS(Trace);
+  timeTraceProfilerWrite(OS);
+  OS.flush();
+  timeTraceProfilerCleanup();
+
+  EXPECT_EQ(std::string::npos, Trace.find("\"name\":\"Short\""));
+  EXPECT_NE(std::string::npos, Trace.find("\"name\":\"Total Short\""));
+}
+
+} // end anonymous namespace
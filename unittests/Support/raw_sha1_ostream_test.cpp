@@ -69,3 +69,25 @@ TEST(raw_sha1_ostreamTest, Reset) {
 
   ASSERT_EQ("7447F2A5A42185C8CF91E632789C431830B59067", Hash);
 }
+
+// Whole blocks are hashed straight from the input, with the fastest code the
+// host supports, so feed data of many lengths in pieces of many sizes.
+TEST(raw_sha1_ostreamTest, LargeInput) {
+  std::string Data;
+  for (unsigned i = 0; i != 1000; ++i)
+    Data.push_back((i * 7 + 3) & 0xff);
+
+  for (size_t Step : {1, 3, 63, 64, 65, 200, 1000}) {
+    llvm::SHA1 Hasher;
+    for (size_t i = 0; i < Data.size(); i += Step)
+      Hasher.update(StringRef(Data).substr(i, Step));
+    ASSERT_EQ("4231A8A50A10FA9758DB8EC71FDEF855B751048A",
+              toHex(Hasher.final()));
+  }
+
+  // The one million "a" test vector from FIPS 180-2.
+  llvm::raw_sha1_ostream Sha1Stream;
+  Sha1Stream << std::string(1000000, 'a');
+  ASSERT_EQ("34AA973CD4C4DAA4F61EEB2BDBAD27316534016F",
+            toHex(Sha1Stream.sha1()));
+}
@@ -0,0 +1,54 @@
+//===- llvm/unittest/Support/xxhashTest.cpp - xxHash tests ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/xxhash.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+TEST(xxhashTest, Basic) {
+  EXPECT_EQ(0xef46db3751d8e999U, xxHash64(StringRef()));
+  EXPECT_EQ(0x33bf00a859c4ba3fU, xxHash64("foo"));
+  EXPECT_EQ(0x48a37c90ad27a659U, xxHash64("bar"));
+  EXPECT_EQ(0xb05a0c675e4b7edbU,
+            xxHash64("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRST"
+                     "UVWXYZ0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMN"
+                     "OPQRSTUVWXYZ"));
+}
+
+TEST(xxhashTest, Lengths) {
+  // Every code path of the reference implementation: the tails of 1, 4 and 8
+  // bytes, and inputs with and without 32-byte stripes.
+  uint8_t Data[200];
+  for (unsigned I = 0; I != sizeof(Data); ++I)
+    Data[I] = (I * 7 + 3) & 0xff;
+
+  struct {
+    size_t Length;
+    uint64_t Hash, SeededHash;
+  } Expected[] = {
+      {0, 0xef46db3751d8e999U, 0xc4349fc93c010000U},
+      {1, 0x1f25c8d0bc1f4bb6U, 0x79826bcd749d267aU},
+      {4, 0x9bb64b7d66ee9fdaU, 0x6f0a6c97d68bf353U},
+      {7, 0x9a7b149959ce60d8U, 0xd97ede93c9d66a0dU},
+      {12, 0xd52e407833af5133U, 0xbcc9f0d616ff9a7bU},
+      {31, 0xa2aa5f33cc4a6119U, 0x755437271d1d0a84U},
+      {32, 0x23c3c17ef790fd97U, 0xbf624b932c090428U},
+      {63, 0x5e3e54b431c7493cU, 0x2c8ddce5c85d0d9dU},
+      {100, 0xa61f8d4c170fe531U, 0xf6d8f65c625abb4fU},
+      {200, 0xa6cb3c09bc829b24U, 0x17e5f0aa6728f859U},
+  };
+  for (const auto &E : Expected) {
+    ArrayRef<uint8_t> Input(Data, E.Length);
+    EXPECT_EQ(E.Hash, xxHash64(Input));
+    EXPECT_EQ(E.SeededHash, xxHash64(Input, 0x9E3779B97F4A7C15ULL));
+    // xxHash128 is made of both.
+    EXPECT_EQ(std::make_pair(E.Hash, E.SeededHash), xxHash128(Input));
+  }
+}
@@ -2416,6 +2416,14 @@ CodeGenDAGPatterns::CodeGenDAGPatterns(RecordKeeper &R) :
   VerifyInstructionFlags();
 }
 
+CodeGenDAGPatterns &CodeGenDAGPatterns::get(RecordKeeper &R) {
+  static std::map<RecordKeeper *, std::unique_ptr<CodeGenDAGPatterns>> Cache;
+  std::unique_ptr<CodeGenDAGPatterns> &CGP = Cache[&R];
+  if (!CGP)
+    CGP = llvm::make_unique<CodeGenDAGPatterns>(R);
+  return *CGP;
+}
+
 Record *CodeGenDAGPatterns::getSDNodeNamed(const std::string &Name) const {
   Record *N = Records.getDef(Name);
   if (!N || !N->isSubClassOf("SDNode"))
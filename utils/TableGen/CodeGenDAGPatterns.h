@@ -738,6 +738,10 @@ class CodeGenDAGPatterns {
 public:
   CodeGenDAGPatterns(RecordKeeper &R);
 
+  /// Return the patterns of R, computing them on the first call, so that the
+  /// backends run by one llvm-tblgen invocation share them.
+  static CodeGenDAGPatterns &get(RecordKeeper &R);
+
   CodeGenTarget &getTargetInfo() { return Target; }
   const CodeGenTarget &getTargetInfo() const { return Target; }
 
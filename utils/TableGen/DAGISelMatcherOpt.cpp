@@ -181,6 +181,82 @@ static Matcher *FindNodeWithKind(Matcher *M, Matcher::KindTy Kind) {
 ///       ABC
 ///       XYZ
 ///
+/// getSwitchableTypeCheck - Return the CheckType of result #0 that M starts
+/// with or can start with, if a SwitchType can dispatch on it.
+static CheckTypeMatcher *getSwitchableTypeCheck(Matcher *M) {
+  CheckTypeMatcher *CTM =
+    cast_or_null<CheckTypeMatcher>(FindNodeWithKind(M, Matcher::CheckType));
+  if (!CTM ||
+      // iPTR checks could alias any other case without us knowing, don't
+      // bother with them.
+      CTM->getType() == MVT::iPTR ||
+      // SwitchType only works for result #0.
+      CTM->getResNo() != 0 ||
+      // If the CheckType isn't at the start of the list, see if we can move
+      // it there.
+      !CTM->canMoveBefore(M))
+    return nullptr;
+  return CTM;
+}
+
+/// createSwitchOpcode - Turn Options, which all start with a CheckOpcode for a
+/// different opcode, into a SwitchOpcode.
+static Matcher *createSwitchOpcode(ArrayRef<Matcher*> Options) {
+  StringSet<> Opcodes;
+  SmallVector<std::pair<const SDNodeInfo*, Matcher*>, 8> Cases;
+  for (Matcher *M : Options) {
+    CheckOpcodeMatcher *COM = cast<CheckOpcodeMatcher>(M);
+    assert(Opcodes.insert(COM->getOpcode().getEnumName()).second &&
+           "Duplicate opcodes not factored?");
+    Cases.push_back(std::make_pair(&COM->getOpcode(), COM->takeNext()));
+    delete COM;
+  }
+  return new SwitchOpcodeMatcher(Cases);
+}
+
+static void FactorNodes(std::unique_ptr<Matcher> &MatcherPtr);
+
+/// createSwitchType - Turn Options, for which getSwitchableTypeCheck succeeds,
+/// into a SwitchType, keeping the options with the same type in order.
+static Matcher *createSwitchType(ArrayRef<Matcher*> Options) {
+  DenseMap<unsigned, unsigned> TypeEntry;
+  SmallVector<std::pair<MVT::SimpleValueType, Matcher*>, 8> Cases;
+  for (Matcher *M : Options) {
+    CheckTypeMatcher *CTM = getSwitchableTypeCheck(M);
+    Matcher *MatcherWithoutCTM = M->unlinkNode(CTM);
+    MVT::SimpleValueType CTMTy = CTM->getType();
+    delete CTM;
+    
+    unsigned &Entry = TypeEntry[CTMTy];
+    if (Entry != 0) {
+      // If we have unfactored duplicate types, then we should factor them.
+      Matcher *PrevMatcher = Cases[Entry-1].second;
+      if (ScopeMatcher *SM = dyn_cast<ScopeMatcher>(PrevMatcher)) {
+        SM->setNumChildren(SM->getNumChildren()+1);
+        SM->resetChild(SM->getNumChildren()-1, MatcherWithoutCTM);
+        continue;
+      }
+      
+      Matcher *Entries[2] = { PrevMatcher, MatcherWithoutCTM };
+      std::unique_ptr<Matcher> Case(new ScopeMatcher(Entries));
+      FactorNodes(Case);
+      Cases[Entry-1].second = Case.release();
+      continue;
+    }
+    
+    Entry = Cases.size()+1;
+    Cases.push_back(std::make_pair(CTMTy, MatcherWithoutCTM));
+  }
+  
+  if (Cases.size() != 1)
+    return new SwitchTypeMatcher(Cases);
+
+  // If we factored and ended up with one case, create it now.
+  Matcher *Res = new CheckTypeMatcher(Cases[0].first, 0);
+  Res->setNext(Cases[0].second);
+  return Res;
+}
+
 static void FactorNodes(std::unique_ptr<Matcher> &MatcherPtr) {
   // If we reached the end of the chain, we're done.
   Matcher *N = MatcherPtr.get();
@@ -351,94 +427,67 @@ static void FactorNodes(std::unique_ptr<Matcher> &MatcherPtr) {
     }
 
     // Check to see if this breaks a series of CheckTypeMatcher's.
-    if (AllTypeChecks) {
-      CheckTypeMatcher *CTM =
-        cast_or_null<CheckTypeMatcher>(FindNodeWithKind(NewOptionsToMatch[i],
-                                                        Matcher::CheckType));
-      if (!CTM ||
-          // iPTR checks could alias any other case without us knowing, don't
-          // bother with them.
-          CTM->getType() == MVT::iPTR ||
-          // SwitchType only works for result #0.
-          CTM->getResNo() != 0 ||
-          // If the CheckType isn't at the start of the list, see if we can move
-          // it there.
-          !CTM->canMoveBefore(NewOptionsToMatch[i])) {
+    if (AllTypeChecks && !getSwitchableTypeCheck(NewOptionsToMatch[i])) {
 #if 0
-        if (i > 3 && AllTypeChecks) {
-          errs() << "FAILING TYPE #" << i << "\n";
-          NewOptionsToMatch[i]->dump();
-        }
-#endif
-        AllTypeChecks = false;
+      if (i > 3 && AllTypeChecks) {
+        errs() << "FAILING TYPE #" << i << "\n";
+        NewOptionsToMatch[i]->dump();
       }
+#endif
+      AllTypeChecks = false;
     }
   }
   
   // If all the options are CheckOpcode's, we can form the SwitchOpcode, woot.
   if (AllOpcodeChecks) {
-    StringSet<> Opcodes;
-    SmallVector<std::pair<const SDNodeInfo*, Matcher*>, 8> Cases;
-    for (unsigned i = 0, e = NewOptionsToMatch.size(); i != e; ++i) {
-      CheckOpcodeMatcher *COM = cast<CheckOpcodeMatcher>(NewOptionsToMatch[i]);
-      assert(Opcodes.insert(COM->getOpcode().getEnumName()).second &&
-             "Duplicate opcodes not factored?");
-      Cases.push_back(std::make_pair(&COM->getOpcode(), COM->takeNext()));
-      delete COM;
-    }
-    
-    MatcherPtr.reset(new SwitchOpcodeMatcher(Cases));
+    MatcherPtr.reset(createSwitchOpcode(NewOptionsToMatch));
     return;
   }
   
   // If all the options are CheckType's, we can form the SwitchType, woot.
   if (AllTypeChecks) {
-    DenseMap<unsigned, unsigned> TypeEntry;
-    SmallVector<std::pair<MVT::SimpleValueType, Matcher*>, 8> Cases;
-    for (unsigned i = 0, e = NewOptionsToMatch.size(); i != e; ++i) {
-      CheckTypeMatcher *CTM =
-        cast_or_null<CheckTypeMatcher>(FindNodeWithKind(NewOptionsToMatch[i],
-                                                        Matcher::CheckType));
-      Matcher *MatcherWithoutCTM = NewOptionsToMatch[i]->unlinkNode(CTM);
-      MVT::SimpleValueType CTMTy = CTM->getType();
-      delete CTM;
-      
-      unsigned &Entry = TypeEntry[CTMTy];
-      if (Entry != 0) {
-        // If we have unfactored duplicate types, then we should factor them.
-        Matcher *PrevMatcher = Cases[Entry-1].second;
-        if (ScopeMatcher *SM = dyn_cast<ScopeMatcher>(PrevMatcher)) {
-          SM->setNumChildren(SM->getNumChildren()+1);
-          SM->resetChild(SM->getNumChildren()-1, MatcherWithoutCTM);
-          continue;
-        }
-        
-        Matcher *Entries[2] = { PrevMatcher, MatcherWithoutCTM };
-        std::unique_ptr<Matcher> Case(new ScopeMatcher(Entries));
-        FactorNodes(Case);
-        Cases[Entry-1].second = Case.release();
-        continue;
-      }
-      
-      Entry = Cases.size()+1;
-      Cases.push_back(std::make_pair(CTMTy, MatcherWithoutCTM));
-    }
-    
-    if (Cases.size() != 1) {
-      MatcherPtr.reset(new SwitchTypeMatcher(Cases));
+    MatcherPtr.reset(createSwitchType(NewOptionsToMatch));
+    return;
+  }
+
+  // Otherwise, form switches for the runs of adjacent options that allow it.
+  // When the case of a switch fails, the scope goes on with the option after
+  // the run, which is what it would have done after failing the other options
+  // of the run: they check for a different opcode or type.
+  SmallVector<Matcher*, 32> Options;
+  for (unsigned i = 0, e = NewOptionsToMatch.size(); i != e;) {
+    ArrayRef<Matcher*> Rest = makeArrayRef(NewOptionsToMatch).slice(i);
+    unsigned NumOpcodes = 0, NumTypes = 0;
+    StringSet<> Opcodes;
+    while (NumOpcodes != Rest.size() &&
+           isa<CheckOpcodeMatcher>(Rest[NumOpcodes]) &&
+           Opcodes.insert(cast<CheckOpcodeMatcher>(Rest[NumOpcodes])
+                              ->getOpcode().getEnumName()).second)
+      ++NumOpcodes;
+    while (NumTypes != Rest.size() && getSwitchableTypeCheck(Rest[NumTypes]))
+      ++NumTypes;
+
+    if (NumOpcodes >= 2 && NumOpcodes >= NumTypes) {
+      Options.push_back(createSwitchOpcode(Rest.slice(0, NumOpcodes)));
+      i += NumOpcodes;
+    } else if (NumTypes >= 2) {
+      Options.push_back(createSwitchType(Rest.slice(0, NumTypes)));
+      i += NumTypes;
     } else {
-      // If we factored and ended up with one case, create it now.
-      MatcherPtr.reset(new CheckTypeMatcher(Cases[0].first, 0));
-      MatcherPtr->setNext(Cases[0].second);
+      Options.push_back(Rest[0]);
+      ++i;
     }
+  }
+
+  if (Options.size() == 1) {
+    MatcherPtr.reset(Options[0]);
     return;
   }
-  
 
   // Reassemble the Scope node with the adjusted children.
-  Scope->setNumChildren(NewOptionsToMatch.size());
-  for (unsigned i = 0, e = NewOptionsToMatch.size(); i != e; ++i)
-    Scope->resetChild(i, NewOptionsToMatch[i]);
+  Scope->setNumChildren(Options.size());
+  for (unsigned i = 0, e = Options.size(); i != e; ++i)
+    Scope->resetChild(i, Options[i]);
 }
 
 void
@@ -19,6 +19,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/MC/MCFixedLenDisassembler.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FormattedStream.h"
@@ -35,6 +36,16 @@ using namespace llvm;
 
 #define DEBUG_TYPE "decoder-emitter"
 
+static cl::opt<unsigned> FilterSwitchMinCases(
+    "decoder-switch-min-cases", cl::Hidden, cl::init(4),
+    cl::desc("Minimum number of field values for a filter to be decoded "
+             "through a jump table instead of a chain of value checks "
+             "(0 = never)"));
+
+// Widest field that is decoded through a jump table. The table has one
+// 16-bit entry for each possible field value.
+static const unsigned FilterSwitchMaxBits = 8;
+
 namespace {
 struct EncodingField {
   unsigned Base, Width, Offset;
@@ -73,6 +84,10 @@ struct DecoderTableInfo {
   FixupScopeList FixupStack;
   PredicateSet Predicates;
   DecoderSet Decoders;
+  // Emit OPC_FilterSwitch for filters with enough field values.
+  bool UseFilterSwitch;
+  // Set when a NumToSkip displacement doesn't fit in 16 bits.
+  bool SkipOverflow;
 };
 
 } // End anonymous namespace
@@ -269,6 +284,13 @@ public:
   // bits.
   void emitTableEntry(DecoderTableInfo &TableInfo) const;
 
+  // Emit an OPC_FilterSwitch jump table for the segment instead of a chain of
+  // OPC_FilterValue checks.
+  void emitSwitchTableEntry(DecoderTableInfo &TableInfo) const;
+
+  // Returns true if the segment is better decoded through a jump table.
+  bool useSwitchTable(const DecoderTableInfo &TableInfo) const;
+
   // Returns the number of fanout produced by the filter.  More fanout implies
   // the filter distinguishes more categories of instructions.
   unsigned usefulness() const;
@@ -584,30 +606,42 @@ void Filter::recurse() {
   }
 }
 
-static void resolveTableFixups(DecoderTable &Table, const FixupList &Fixups,
-                               uint32_t DestIdx) {
+// Backpatch the 16-bit NumToSkip entry at FixupIdx to skip to DestIdx.
+static void setNumToSkip(DecoderTableInfo &TableInfo, uint32_t FixupIdx,
+                         uint32_t DestIdx) {
+  // The Target is calculated from after the 16-bit NumToSkip entry itself,
+  // so subtract two from the displacement here to account for that.
+  uint32_t Delta = DestIdx - FixupIdx - 2;
+  // Our NumToSkip entries are 16-bits. Make sure our table isn't too big.
+  // Jump tables spread the skips of a filter over all of its cases, so a
+  // table built with them may not fit; run() then rebuilds it without.
+  if (Delta >= 65536U) {
+    assert(TableInfo.UseFilterSwitch &&
+           "disassembler decoding table too large!");
+    TableInfo.SkipOverflow = true;
+  }
+  TableInfo.Table[FixupIdx] = (uint8_t)Delta;
+  TableInfo.Table[FixupIdx + 1] = (uint8_t)(Delta >> 8);
+}
+
+static void resolveTableFixups(DecoderTableInfo &TableInfo,
+                               const FixupList &Fixups, uint32_t DestIdx) {
   // Any NumToSkip fixups in the current scope can resolve to the
   // current location.
   for (FixupList::const_reverse_iterator I = Fixups.rbegin(),
                                          E = Fixups.rend();
-       I != E; ++I) {
-    // Calculate the distance from the byte following the fixup entry byte
-    // to the destination. The Target is calculated from after the 16-bit
-    // NumToSkip entry itself, so subtract two  from the displacement here
-    // to account for that.
-    uint32_t FixupIdx = *I;
-    uint32_t Delta = DestIdx - FixupIdx - 2;
-    // Our NumToSkip entries are 16-bits. Make sure our table isn't too
-    // big.
-    assert(Delta < 65536U && "disassembler decoding table too large!");
-    Table[FixupIdx] = (uint8_t)Delta;
-    Table[FixupIdx + 1] = (uint8_t)(Delta >> 8);
-  }
+       I != E; ++I)
+    setNumToSkip(TableInfo, *I, DestIdx);
 }
 
 // Emit table entries to decode instructions given a segment or segments
 // of bits.
 void Filter::emitTableEntry(DecoderTableInfo &TableInfo) const {
+  if (useSwitchTable(TableInfo)) {
+    emitSwitchTableEntry(TableInfo);
+    return;
+  }
+
   TableInfo.Table.push_back(MCD::OPC_ExtractField);
   TableInfo.Table.push_back(StartBit);
   TableInfo.Table.push_back(NumBits);
@@ -630,7 +664,7 @@ void Filter::emitTableEntry(DecoderTableInfo &TableInfo) const {
       assert(PrevFilter != 0 && "empty filter set!");
       FixupList &CurScope = TableInfo.FixupStack.back();
       // Resolve any NumToSkip fixups in the current scope.
-      resolveTableFixups(Table, CurScope, Table.size());
+      resolveTableFixups(TableInfo, CurScope, Table.size());
       CurScope.clear();
       PrevFilter = 0;  // Don't re-process the filter's fallthrough.
     } else {
@@ -653,14 +687,9 @@ void Filter::emitTableEntry(DecoderTableInfo &TableInfo) const {
     Filter.second->emitTableEntries(TableInfo);
 
     // Now that we've emitted the body of the handler, update the NumToSkip
-    // of the filter itself to be able to skip forward when false. Subtract
-    // two as to account for the width of the NumToSkip field itself.
-    if (PrevFilter) {
-      uint32_t NumToSkip = Table.size() - PrevFilter - 2;
-      assert(NumToSkip < 65536U && "disassembler decoding table too large!");
-      Table[PrevFilter] = (uint8_t)NumToSkip;
-      Table[PrevFilter + 1] = (uint8_t)(NumToSkip >> 8);
-    }
+    // of the filter itself to be able to skip forward when false.
+    if (PrevFilter)
+      setNumToSkip(TableInfo, PrevFilter, Table.size());
   }
 
   // Any remaining unresolved fixups bubble up to the parent fixup scope.
@@ -676,6 +705,58 @@ void Filter::emitTableEntry(DecoderTableInfo &TableInfo) const {
     TableInfo.FixupStack.back().push_back(PrevFilter);
 }
 
+bool Filter::useSwitchTable(const DecoderTableInfo &TableInfo) const {
+  if (!TableInfo.UseFilterSwitch || FilterSwitchMinCases == 0 ||
+      NumBits > FilterSwitchMaxBits ||
+      FilteredInstructions.size() < FilterSwitchMinCases)
+    return false;
+  // Each OPC_FilterValue check takes at least four bytes and each jump table
+  // entry two, so don't let a sparse table grow past twice the size of the
+  // chain it replaces.
+  return (1U << NumBits) <= 4 * FilteredInstructions.size();
+}
+
+// Emit a jump table with a 16-bit NumToSkip entry for every value of the
+// segment. Values without instructions of their own skip to the same place
+// the last OPC_FilterValue check of a chain would: the variable instructions
+// if there are any, otherwise the enclosing scope.
+void Filter::emitSwitchTableEntry(DecoderTableInfo &TableInfo) const {
+  DecoderTable &Table = TableInfo.Table;
+  Table.push_back(MCD::OPC_FilterSwitch);
+  Table.push_back(StartBit);
+  Table.push_back(NumBits);
+
+  uint32_t SwitchTable = Table.size();
+  Table.resize(SwitchTable + 2 * (1U << NumBits), 0);
+
+  // A new filter entry begins a new scope for fixup resolution.
+  TableInfo.FixupStack.emplace_back();
+  for (unsigned Val = 0, E = 1U << NumBits; Val != E; ++Val)
+    if (!FilterChooserMap.count(Val))
+      TableInfo.FixupStack.back().push_back(SwitchTable + 2 * Val);
+
+  for (auto &Filter : FilterChooserMap) {
+    // Field value -1 implies a non-empty set of variable instructions, which
+    // is always the last entry of the map.
+    if (Filter.first == (unsigned)-1) {
+      FixupList &CurScope = TableInfo.FixupStack.back();
+      resolveTableFixups(TableInfo, CurScope, Table.size());
+      CurScope.clear();
+    } else {
+      setNumToSkip(TableInfo, SwitchTable + 2 * Filter.first, Table.size());
+    }
+
+    Filter.second->emitTableEntries(TableInfo);
+  }
+
+  // Any remaining unresolved fixups bubble up to the parent fixup scope.
+  assert(TableInfo.FixupStack.size() > 1 && "fixup stack underflow!");
+  FixupScopeList::iterator Source = TableInfo.FixupStack.end() - 1;
+  FixupScopeList::iterator Dest = Source - 1;
+  Dest->insert(Dest->end(), Source->begin(), Source->end());
+  TableInfo.FixupStack.pop_back();
+}
+
 // Returns the number of fanout produced by the filter.  More fanout implies
 // the filter distinguishes more categories of instructions.
 unsigned Filter::usefulness() const {
@@ -727,6 +808,30 @@ void FixedLenDecoderEmitter::emitTable(formatted_raw_ostream &OS,
       OS << Start << "} ...\n";
       break;
     }
+    case MCD::OPC_FilterSwitch: {
+      ++I;
+      unsigned Start = *I++;
+      unsigned Len = *I++;
+      OS.indent(Indentation) << "MCD::OPC_FilterSwitch, " << Start << ", "
+        << Len << ",  // Inst{";
+      if (Len > 1)
+        OS << (Start + Len - 1) << "-";
+      OS << Start << "} ...\n";
+      // One 16-bit numtoskip value for each field value.
+      for (unsigned Val = 0, E = 1U << Len; Val != E; ++Val) {
+        uint8_t Byte = *I++;
+        uint32_t NumToSkip = Byte;
+        OS << "/* " << (I - 1 - Table.begin()) << " */";
+        OS.PadToColumn(12);
+        OS.indent(Indentation + 2) << (unsigned)Byte << ", ";
+        Byte = *I++;
+        OS << (unsigned)Byte << ", ";
+        NumToSkip |= Byte << 8;
+        OS << "// " << Val << ": skip to: "
+           << ((I - Table.begin()) + NumToSkip) << "\n";
+      }
+      break;
+    }
     case MCD::OPC_FilterValue: {
       ++I;
       OS.indent(Indentation) << "MCD::OPC_FilterValue, ";
@@ -1395,7 +1500,7 @@ void FilterChooser::emitSingletonTableEntry(DecoderTableInfo &TableInfo,
 
   emitSingletonTableEntry(TableInfo, Opc);
 
-  resolveTableFixups(TableInfo.Table, TableInfo.FixupStack.back(),
+  resolveTableFixups(TableInfo, TableInfo.FixupStack.back(),
                      TableInfo.Table.size());
   TableInfo.FixupStack.pop_back();
 
@@ -2105,6 +2210,21 @@ static void emitDecodeInstruction(formatted_raw_ostream &OS) {
      << "                   << Len << \"): \" << CurFieldValue << \"\\n\");\n"
      << "      break;\n"
      << "    }\n"
+     << "    case MCD::OPC_FilterSwitch: {\n"
+     << "      unsigned Start = *++Ptr;\n"
+     << "      unsigned Len = *++Ptr;\n"
+     << "      ++Ptr;\n"
+     << "      CurFieldValue = fieldFromInstruction(insn, Start, Len);\n"
+     << "      // Each field value has its own 16-bit NumToSkip entry.\n"
+     << "      Ptr += 2 * CurFieldValue;\n"
+     << "      unsigned NumToSkip = *Ptr++;\n"
+     << "      NumToSkip |= (*Ptr++) << 8;\n"
+     << "      Ptr += NumToSkip;\n"
+     << "      DEBUG(dbgs() << Loc << \": OPC_FilterSwitch(\" << Start << \", \"\n"
+     << "                   << Len << \"): \" << CurFieldValue\n"
+     << "                   << \", continuing at \" << (Ptr - DecodeTable) << \"\\n\");\n"
+     << "      break;\n"
+     << "    }\n"
      << "    case MCD::OPC_FilterValue: {\n"
      << "      // Decode the field value.\n"
      << "      unsigned Len;\n"
@@ -2286,23 +2406,32 @@ void FixedLenDecoderEmitter::run(raw_ostream &o) {
     FilterChooser FC(NumberedInstructions, Opc.second, Operands,
                      8*Opc.first.second, this);
 
-    // The decode table is cleared for each top level decoder function. The
-    // predicates and decoders themselves, however, are shared across all
-    // decoders to give more opportunities for uniqueing.
-    TableInfo.Table.clear();
-    TableInfo.FixupStack.clear();
-    TableInfo.Table.reserve(16384);
-    TableInfo.FixupStack.emplace_back();
-    FC.emitTableEntries(TableInfo);
-    // Any NumToSkip fixups in the top level scope can resolve to the
-    // OPC_Fail at the end of the table.
-    assert(TableInfo.FixupStack.size() == 1 && "fixup stack phasing error!");
-    // Resolve any NumToSkip fixups in the current scope.
-    resolveTableFixups(TableInfo.Table, TableInfo.FixupStack.back(),
-                       TableInfo.Table.size());
-    TableInfo.FixupStack.clear();
-
-    TableInfo.Table.push_back(MCD::OPC_Fail);
+    // Build the table with jump tables first. If that makes a NumToSkip
+    // displacement too large, build it again with value checks only.
+    TableInfo.UseFilterSwitch = true;
+    do {
+      // The decode table is cleared for each top level decoder function. The
+      // predicates and decoders themselves, however, are shared across all
+      // decoders to give more opportunities for uniqueing.
+      TableInfo.SkipOverflow = false;
+      TableInfo.Table.clear();
+      TableInfo.FixupStack.clear();
+      TableInfo.Table.reserve(16384);
+      TableInfo.FixupStack.emplace_back();
+      FC.emitTableEntries(TableInfo);
+      // Any NumToSkip fixups in the top level scope can resolve to the
+      // OPC_Fail at the end of the table.
+      assert(TableInfo.FixupStack.size() == 1 && "fixup stack phasing error!");
+      // Resolve any NumToSkip fixups in the current scope.
+      resolveTableFixups(TableInfo, TableInfo.FixupStack.back(),
+                         TableInfo.Table.size());
+      TableInfo.FixupStack.clear();
+
+      TableInfo.Table.push_back(MCD::OPC_Fail);
+      if (!TableInfo.SkipOverflow)
+        break;
+      TableInfo.UseFilterSwitch = false;
+    } while (true);
 
     // Print the table to the output stream.
     emitTable(OS, TableInfo.Table, 0, FC.getBitWidth(), Opc.first.first);
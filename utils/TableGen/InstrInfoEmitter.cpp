@@ -31,12 +31,13 @@ using namespace llvm;
 namespace {
 class InstrInfoEmitter {
   RecordKeeper &Records;
-  CodeGenDAGPatterns CDP;
+  CodeGenDAGPatterns &CDP;
   const CodeGenSchedModels &SchedModels;
 
 public:
   InstrInfoEmitter(RecordKeeper &R):
-    Records(R), CDP(R), SchedModels(CDP.getTargetInfo().getSchedModels()) {}
+    Records(R), CDP(CodeGenDAGPatterns::get(R)),
+    SchedModels(CDP.getTargetInfo().getSchedModels()) {}
 
   // run - Output the instruction set description.
   void run(raw_ostream &OS);
@@ -10,9 +10,12 @@
 #include "llvm/TableGen/Error.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/TableGen/Record.h"
 #include "llvm/TableGen/TableGenBackend.h"
+#include <algorithm>
 #include <cctype>
 #include <cstring>
 #include <map>
@@ -86,6 +89,74 @@ static int CompareOptionRecords(Record *const *Av, Record *const *Bv) {
   return APrec < BPrec ? -1 : 1;
 }
 
+// Hash of an option spelling, a prefix followed by the option name. The logic
+// should match with the consumer-side function in lib/Option/OptTable.cpp.
+static uint32_t hashOptionSpelling(StringRef Spelling, uint32_t Seed) {
+  uint32_t Hash = Seed ^ 2166136261u;
+  for (char C : Spelling) {
+    Hash ^= (unsigned char)tolower((unsigned char)C);
+    Hash *= 16777619u;
+  }
+  return Hash;
+}
+
+/// Build a perfect hash table of the spellings of the options, which maps each
+/// spelling to the index of the first option in Info table order that has it.
+///
+/// Keys are hashed once to pick a bucket, and then again with the
+/// displacement of their bucket to pick a slot. Buckets are placed from the
+/// largest to the smallest, each with the first displacement that sends its
+/// keys to distinct free slots. Slots hold the index plus one, or zero.
+///
+/// \returns false if no displacement could be found for some bucket.
+static bool buildOptionHashTable(const StringMap<unsigned> &Spellings,
+                                 std::vector<unsigned> &Displacements,
+                                 std::vector<unsigned> &Slots) {
+  unsigned NumKeys = Spellings.size();
+  Displacements.assign(std::max(1u, NumKeys / 4), 0);
+  Slots.assign(NextPowerOf2(NumKeys), 0);
+
+  std::vector<std::vector<const StringMapEntry<unsigned> *>> Buckets(
+      Displacements.size());
+  for (const auto &S : Spellings)
+    Buckets[hashOptionSpelling(S.getKey(), 0) % Displacements.size()]
+        .push_back(&S);
+
+  std::vector<unsigned> Order(Buckets.size());
+  for (unsigned I = 0, E = Order.size(); I != E; ++I)
+    Order[I] = I;
+  std::stable_sort(Order.begin(), Order.end(), [&](unsigned A, unsigned B) {
+    return Buckets[A].size() > Buckets[B].size();
+  });
+
+  std::vector<unsigned> BucketSlots;
+  for (unsigned B : Order) {
+    if (Buckets[B].empty())
+      break;
+    bool Placed = false;
+    for (unsigned D = 1; D != (1u << 20) && !Placed; ++D) {
+      BucketSlots.clear();
+      for (const auto *S : Buckets[B]) {
+        unsigned Slot =
+            hashOptionSpelling(S->getKey(), D) & (Slots.size() - 1);
+        if (Slots[Slot] || std::find(BucketSlots.begin(), BucketSlots.end(),
+                                     Slot) != BucketSlots.end())
+          break;
+        BucketSlots.push_back(Slot);
+      }
+      if (BucketSlots.size() != Buckets[B].size())
+        continue;
+      for (unsigned I = 0, E = BucketSlots.size(); I != E; ++I)
+        Slots[BucketSlots[I]] = Buckets[B][I]->getValue() + 1;
+      Displacements[B] = D;
+      Placed = true;
+    }
+    if (!Placed)
+      return false;
+  }
+  return true;
+}
+
 static const std::string getOptionName(const Record &R) {
   // Use the record name unless EnumName is defined.
   if (isa<UnsetInit>(R.getValueInit("EnumName")))
@@ -286,5 +357,41 @@ void EmitOptParser(RecordKeeper &Records, raw_ostream &OS) {
     OS << ")\n";
   }
   OS << "#endif // OPTION\n";
+
+  // Map the spelling of each option to its index in the Info table, which has
+  // the groups before the options. Options that come first in the table take
+  // precedence, as they do when OptTable searches the table.
+  StringMap<unsigned> Spellings;
+  for (unsigned i = 0, e = Opts.size(); i != e; ++i) {
+    const Record &R = *Opts[i];
+    if (R.getValueAsDef("Kind")->getValueAsBit("Sentinel"))
+      continue;
+    std::string Name = StringRef(R.getValueAsString("Name")).lower();
+    for (const std::string &Prefix : R.getValueAsListOfStrings("Prefixes"))
+      Spellings.insert(
+          std::make_pair(StringRef(Prefix).lower() + Name, Groups.size() + i));
+  }
+
+  // Emit the perfect hash table OptTable can use to find an option spelled
+  // exactly like an argument without searching the table. It is left empty in
+  // the unlikely case that the keys can't be placed.
+  std::vector<unsigned> Displacements, Slots;
+  if (Spellings.empty() ||
+      !buildOptionHashTable(Spellings, Displacements, Slots)) {
+    Displacements.clear();
+    Slots.clear();
+  }
+
+  OS << "\n";
+  OS << "/////////\n";
+  OS << "// Option hash table\n\n";
+  OS << "#ifdef OPTION_HASH_DISPLACEMENT\n";
+  for (unsigned D : Displacements)
+    OS << "OPTION_HASH_DISPLACEMENT(" << D << ")\n";
+  OS << "#endif // OPTION_HASH_DISPLACEMENT\n\n";
+  OS << "#ifdef OPTION_HASH_SLOT\n";
+  for (unsigned S : Slots)
+    OS << "OPTION_HASH_SLOT(" << S << ")\n";
+  OS << "#endif // OPTION_HASH_SLOT\n";
 }
 } // end namespace llvm
@@ -12,10 +12,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "TableGenBackends.h" // Declares all backends.
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ToolOutputFile.h"
 #include "llvm/TableGen/Error.h"
 #include "llvm/TableGen/Main.h"
 #include "llvm/TableGen/Record.h"
@@ -95,8 +98,14 @@ namespace {
   Class("class", cl::desc("Print Enum list for this class"),
           cl::value_desc("class name"));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
-  switch (Action) {
+  cl::list<std::string>
+  ExtraOutputs("emit",
+               cl::desc("Also run the backend of another action on the same "
+                        "records and write its output to a file"),
+               cl::value_desc("action=filename"));
+
+bool runAction(ActionType A, raw_ostream &OS, RecordKeeper &Records) {
+  switch (A) {
   case PrintRecords:
     OS << Records;           // No argument, dump all contents
     break;
@@ -176,6 +185,53 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+  // Parse all of the extra outputs first, so that a bad one is reported before
+  // any backend runs.
+  std::vector<std::pair<ActionType, std::string>> Extra;
+  auto &Parser = Action.getParser();
+  for (StringRef Spec : ExtraOutputs) {
+    StringRef Name, Filename;
+    std::tie(Name, Filename) = Spec.split('=');
+    if (Name.startswith("-"))
+      Name = Name.drop_front();
+    unsigned I = 0, E = Parser.getNumOptions();
+    while (I != E && Name != Parser.getOption(I))
+      ++I;
+    ActionType A;
+    if (I == E || Filename.empty() || Parser.parse(Action, Name, Name, A)) {
+      errs() << "Invalid -emit value '" << Spec
+             << "', expected <action>=<filename>\n";
+      return true;
+    }
+    Extra.emplace_back(A, Filename);
+  }
+
+  if (runAction(Action, OS, Records))
+    return true;
+
+  // The backends share the parsed records, and the analyses they cache on
+  // them, such as CodeGenDAGPatterns.
+  std::vector<std::unique_ptr<tool_output_file>> Outs;
+  for (auto &AF : Extra) {
+    std::error_code EC;
+    Outs.push_back(
+        llvm::make_unique<tool_output_file>(AF.second, EC, sys::fs::F_Text));
+    if (EC) {
+      errs() << "error opening " << AF.second << ":" << EC.message() << "\n";
+      return true;
+    }
+    if (runAction(AF.first, Outs.back()->os(), Records))
+      return true;
+  }
+  // TableGenMain reports the errors, and the outputs are removed.
+  if (ErrorsPrinted > 0)
+    return false;
+  for (auto &Out : Outs)
+    Out->keep();
+  return false;
+}
 }
 
 int main(int argc, char **argv) {